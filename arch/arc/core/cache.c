@@ -71,23 +71,28 @@ static void dcache_enable(void)
 
 /**
  *
- * @brief Flush multiple d-cache lines to memory
+ * @brief Apply a d-cache line operation to multiple lines
  *
  * No alignment is required for either <start_addr> or <size>, but since
- * dcache_flush_mlines() iterates on the d-cache lines, a cache line
+ * dcache_op_mlines() iterates on the d-cache lines, a cache line
  * alignment for both is optimal.
  *
  * The d-cache line size is specified either via the CONFIG_CACHE_LINE_SIZE
  * kconfig option or it is detected at runtime.
  *
- * @param start_addr the pointer to start the multi-line flush
- * @param size the number of bytes that are to be flushed
+ * @param start_addr the pointer to start the multi-line operation
+ * @param size the number of bytes that are to be operated on
+ * @param op_reg _ARC_V2_DC_FLDL to flush, _ARC_V2_DC_IVDL to invalidate
+ * @param invalid_mode DC_CTRL_INVALID_FLUSH for invalidates to flush dirty
+ *                     lines first, DC_CTRL_INVALID_ONLY otherwise
  *
  * @return N/A
  */
-static void dcache_flush_mlines(uint32_t start_addr, uint32_t size)
+static void dcache_op_mlines(uint32_t start_addr, uint32_t size,
+			     uint32_t op_reg, uint32_t invalid_mode)
 {
 	uint32_t end_addr;
+	uint32_t ctrl;
 	unsigned int key;
 
 	if (!dcache_available() || (size == 0)) {
@@ -99,8 +104,15 @@ static void dcache_flush_mlines(uint32_t start_addr, uint32_t size)
 
 	key = irq_lock(); /* --enter critical section-- */
 
+	ctrl = _arc_v2_aux_reg_read(_ARC_V2_DC_CTRL);
+	if ((ctrl & DC_CTRL_INVALID_FLUSH) != invalid_mode) {
+		_arc_v2_aux_reg_write(_ARC_V2_DC_CTRL,
+				      (ctrl & ~DC_CTRL_INVALID_FLUSH) |
+				      invalid_mode);
+	}
+
 	do {
-		_arc_v2_aux_reg_write(_ARC_V2_DC_FLDL, start_addr);
+		_arc_v2_aux_reg_write(op_reg, start_addr);
 		__asm__ volatile("nop_s");
 		__asm__ volatile("nop_s");
 		__asm__ volatile("nop_s");
@@ -113,6 +125,10 @@ static void dcache_flush_mlines(uint32_t start_addr, uint32_t size)
 		start_addr += DCACHE_LINE_SIZE;
 	} while (start_addr <= end_addr);
 
+	if ((ctrl & DC_CTRL_INVALID_FLUSH) != invalid_mode) {
+		_arc_v2_aux_reg_write(_ARC_V2_DC_CTRL, ctrl);
+	}
+
 	irq_unlock(key); /* --exit critical section-- */
 
 }
@@ -137,7 +153,43 @@ static void dcache_flush_mlines(uint32_t start_addr, uint32_t size)
 
 void sys_cache_flush(vaddr_t start_addr, size_t size)
 {
-	dcache_flush_mlines((uint32_t)start_addr, (uint32_t)size);
+	dcache_op_mlines((uint32_t)start_addr, (uint32_t)size,
+			 _ARC_V2_DC_FLDL, DC_CTRL_INVALID_ONLY);
+}
+
+/**
+ *
+ * @brief Invalidate d-cache lines, discarding what they hold
+ *
+ * Dirty lines are not written back: the CPU writes to the lines covered by
+ * the range, including the parts of them outside of it, are lost.
+ *
+ * @param start_addr the pointer to start the multi-line invalidate
+ * @param size the number of bytes that are to be invalidated
+ *
+ * @return N/A
+ */
+
+void sys_cache_invd(vaddr_t start_addr, size_t size)
+{
+	dcache_op_mlines((uint32_t)start_addr, (uint32_t)size,
+			 _ARC_V2_DC_IVDL, DC_CTRL_INVALID_ONLY);
+}
+
+/**
+ *
+ * @brief Flush d-cache lines to main memory and invalidate them
+ *
+ * @param start_addr the pointer to start the multi-line operation
+ * @param size the number of bytes that are to be flushed and invalidated
+ *
+ * @return N/A
+ */
+
+void sys_cache_flush_invd(vaddr_t start_addr, size_t size)
+{
+	dcache_op_mlines((uint32_t)start_addr, (uint32_t)size,
+			 _ARC_V2_DC_IVDL, DC_CTRL_INVALID_FLUSH);
 }
 
 
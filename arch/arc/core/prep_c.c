@@ -101,6 +101,42 @@ static void adjust_vector_table_base(void)
 	}
 }
 
+#if defined(CONFIG_XIP) && defined(CONFIG_ARCH_HAS_RAMFUNC)
+#define DC_CTRL_FLUSH_STATUS 0x100
+
+/**
+ *
+ * @brief Copy the RAM functions and make them visible to instruction fetch
+ *
+ * The code is copied through the d-cache, which is flushed so that it is
+ * in memory when the i-cache, still disabled and invalidated since reset,
+ * fetches it.
+ *
+ * @return N/A
+ */
+
+static void ramfunc_setup(void)
+{
+	unsigned int val;
+
+	_ramfunc_copy();
+
+	val = _arc_v2_aux_reg_read(_ARC_V2_D_CACHE_BUILD);
+	val &= 0xff; /* version field */
+	if (val == 0) {
+		return; /* skip if d-cache is not present */
+	}
+	_arc_v2_aux_reg_write(_ARC_V2_DC_FLSH, 1);
+	while (_arc_v2_aux_reg_read(_ARC_V2_DC_CTRL) & DC_CTRL_FLUSH_STATUS) {
+		/* wait for the flush to complete */
+	}
+}
+#else
+static inline void ramfunc_setup(void)
+{
+}
+#endif
+
 extern FUNC_NORETURN void _Cstart(void);
 /**
  *
@@ -113,6 +149,7 @@ extern FUNC_NORETURN void _Cstart(void);
 
 void _PrepC(void)
 {
+	ramfunc_setup();
 	_icache_setup();
 	adjust_vector_table_base();
 	_bss_zero();
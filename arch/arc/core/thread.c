@@ -86,7 +86,10 @@ void _new_thread(char *pStackMem, size_t stackSize,
 	struct k_thread *thread = (struct k_thread *) pStackMem;
 
 #ifdef CONFIG_INIT_STACKS
-	memset(pStackMem, 0xaa, stackSize);
+	/* a reused stack is still filled where it was never used */
+	if (!(options & K_NO_STACK_FILL)) {
+		memset(pStackMem, 0xaa, stackSize);
+	}
 #endif
 
 	/* carve the thread entry struct from the "base" of the stack */
@@ -119,6 +122,14 @@ void _new_thread(char *pStackMem, size_t stackSize,
 	thread->init_data = NULL;
 	thread->fn_abort = NULL;
 
+#ifdef CONFIG_THREAD_POOL
+	thread->pool = NULL;
+#endif
+
+#ifdef CONFIG_HEAP_ARENAS
+	thread->heap_arena = NULL;
+#endif
+
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	/* Initialize custom data field (value is opaque to kernel) */
 
@@ -12,8 +12,9 @@
  * This file contains the IRQ part of the vector table. It is meant to be used
  * for one of two cases:
  *
- * a) When software-managed ISRs (SW_ISR_TABLE) is enabled, and in that case it
- *    binds _isr_wrapper() to all the IRQ entries in the vector table.
+ * a) When software-managed ISRs (SW_ISR_TABLE) is enabled, and in that case
+ *    sw_isr_table.S binds _isr_wrapper() to all the IRQ entries in the vector
+ *    table but those connected with IRQ_DIRECT_CONNECT().
  *
  * b) When the platform is written so that device ISRs are installed directly in
  *    the vector table, they are enumerated here.
@@ -27,9 +28,10 @@ typedef void (*vth)(void); /* Vector Table Handler */
 
 #if defined(CONFIG_SW_ISR_TABLE)
 
-vth __irq_vector_table _irq_vector_table[CONFIG_NUM_IRQS] = {
-	[0 ...(CONFIG_NUM_IRQS - 1)] = _isr_wrapper,
-};
+/*
+ * Declared in sw_isr_table.S, one section per entry, so that
+ * IRQ_DIRECT_CONNECT() can install ISRs in place of _isr_wrapper().
+ */
 
 #elif !defined(CONFIG_IRQ_VECTOR_TABLE_CUSTOM)
 
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ARM CORTEX-M performance counters
+ *
+ * The Data Watchpoint and Trace unit of ARMv7-M has a 32-bit cycle counter
+ * and 8-bit profiling counters, counting the extra cycles of multi-cycle
+ * and load/store instructions, the cycles of exception overhead and sleep,
+ * and the folded instructions. Each can be enabled on its own.
+ */
+
+#include <kernel.h>
+#include <arch/cpu.h>
+#include <nano_internal.h>
+#include <errno.h>
+
+#define DEMCR		0xE000EDFC
+#define DEMCR_TRCENA	(1 << 24)
+
+#define DWT_CTRL	(_PPB_INT_DWT + 0x000)
+#define DWT_CYCCNT	(_PPB_INT_DWT + 0x004)
+#define DWT_CPICNT	(_PPB_INT_DWT + 0x008)
+#define DWT_EXCCNT	(_PPB_INT_DWT + 0x00C)
+#define DWT_SLEEPCNT	(_PPB_INT_DWT + 0x010)
+#define DWT_LSUCNT	(_PPB_INT_DWT + 0x014)
+#define DWT_FOLDCNT	(_PPB_INT_DWT + 0x018)
+#define DWT_LAR		(_PPB_INT_DWT + 0xFB0)
+
+#define DWT_LAR_KEY	0xC5ACCE55
+
+#define DWT_CTRL_CYCCNTENA	(1 << 0)
+#define DWT_CTRL_CPIEVTENA	(1 << 17)
+#define DWT_CTRL_EXCEVTENA	(1 << 18)
+#define DWT_CTRL_SLEEPEVTENA	(1 << 19)
+#define DWT_CTRL_LSUEVTENA	(1 << 20)
+#define DWT_CTRL_FOLDEVTENA	(1 << 21)
+#define DWT_CTRL_NOPRFCNT	(1 << 24)
+#define DWT_CTRL_NOCYCCNT	(1 << 25)
+
+#define DWT_CTRL_EVENTS	(DWT_CTRL_CYCCNTENA | DWT_CTRL_CPIEVTENA | \
+			 DWT_CTRL_EXCEVTENA | DWT_CTRL_SLEEPEVTENA | \
+			 DWT_CTRL_LSUEVTENA | DWT_CTRL_FOLDEVTENA)
+
+#define DWT_PROFILING_EVENTS (PERF_EVENT_BIT(PERF_EVENT_STALL_CYCLES) | \
+			      PERF_EVENT_BIT(PERF_EVENT_LSU_CYCLES) | \
+			      PERF_EVENT_BIT(PERF_EVENT_EXC_CYCLES) | \
+			      PERF_EVENT_BIT(PERF_EVENT_SLEEP_CYCLES) | \
+			      PERF_EVENT_BIT(PERF_EVENT_FOLDED))
+
+/* counter register and enable bit of each event, by enum perf_event */
+static const struct {
+	mem_addr_t reg;
+	uint32_t enable;
+} dwt_counters[PERF_EVENT_COUNT] = {
+	[PERF_EVENT_CYCLES] = { DWT_CYCCNT, DWT_CTRL_CYCCNTENA },
+	[PERF_EVENT_STALL_CYCLES] = { DWT_CPICNT, DWT_CTRL_CPIEVTENA },
+	[PERF_EVENT_LSU_CYCLES] = { DWT_LSUCNT, DWT_CTRL_LSUEVTENA },
+	[PERF_EVENT_EXC_CYCLES] = { DWT_EXCCNT, DWT_CTRL_EXCEVTENA },
+	[PERF_EVENT_SLEEP_CYCLES] = { DWT_SLEEPCNT, DWT_CTRL_SLEEPEVTENA },
+	[PERF_EVENT_FOLDED] = { DWT_FOLDCNT, DWT_CTRL_FOLDEVTENA },
+};
+
+static void dwt_enable(void)
+{
+	/* the DWT registers are only accessible with trace enabled */
+	sys_write32(sys_read32(DEMCR) | DEMCR_TRCENA, DEMCR);
+
+#if defined(CONFIG_CPU_CORTEX_M7)
+	sys_write32(DWT_LAR_KEY, DWT_LAR);
+#endif
+}
+
+uint32_t _arch_perf_counter_events(void)
+{
+	uint32_t ctrl, events = 0;
+
+	dwt_enable();
+	ctrl = sys_read32(DWT_CTRL);
+
+	if (!(ctrl & DWT_CTRL_NOCYCCNT)) {
+		events |= PERF_EVENT_BIT(PERF_EVENT_CYCLES);
+	}
+
+	if (!(ctrl & DWT_CTRL_NOPRFCNT)) {
+		events |= DWT_PROFILING_EVENTS;
+	}
+
+	return events;
+}
+
+int _arch_perf_counter_start(uint32_t events)
+{
+	uint32_t ctrl = 0;
+	int event;
+
+	dwt_enable();
+
+	for (event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (events & PERF_EVENT_BIT(event)) {
+			ctrl |= dwt_counters[event].enable;
+		}
+	}
+
+	sys_write32((sys_read32(DWT_CTRL) & ~DWT_CTRL_EVENTS) | ctrl,
+		    DWT_CTRL);
+
+	return 0;
+}
+
+void _arch_perf_counter_stop(void)
+{
+	sys_write32(sys_read32(DWT_CTRL) & ~DWT_CTRL_EVENTS, DWT_CTRL);
+}
+
+uint32_t _arch_perf_counter_read(enum perf_event event)
+{
+	return sys_read32(dwt_counters[event].reg);
+}
+
+uint32_t _arch_perf_counter_mask(enum perf_event event)
+{
+	return event == PERF_EVENT_CYCLES ? 0xffffffff : 0xff;
+}
@@ -52,23 +52,16 @@ static inline void enable_floating_point(void)
 	/*
 	 * Upon reset, the FPU Context Control Register is 0xC0000000
 	 * (both Automatic and Lazy state preservation is enabled).
-	 * Disable lazy state preservation so the volatile FP registers are
-	 * always saved on exception.
+	 * Keep it that way: only contexts that executed an FP instruction
+	 * get an exception stack frame with room for the volatile FP
+	 * registers, and these are only stored there if the exception
+	 * handler uses them too. Threads are switched to such frames, and
+	 * have their other FP registers saved on context switches, from
+	 * their first FP instruction on.
 	 */
-	FPU->FPCCR = FPU_FPCCR_ASPEN_Msk; /* FPU_FPCCR_LSPEN = 0 */
-
-	/*
-	 * Although automatic state preservation is enabled, the processor
-	 * does not automatically save the volatile FP registers until they
-	 * have first been touched. Perform a dummy move operation so that
-	 * the stack frames are created as expected before any task or fiber
-	 * context switching can occur.
-	 */
-	__asm__ volatile(
-		"vmov s0, s0;\n\t"
-		"dsb;\n\t"
-		"isb;\n\t"
-		);
+	FPU->FPCCR = FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+	__DSB();
+	__ISB();
 }
 #else
 static inline void enable_floating_point(void)
@@ -88,6 +81,10 @@ extern FUNC_NORETURN void _Cstart(void);
 
 void _PrepC(void)
 {
+	_ramfunc_copy();
+	/* Fetch the copied code, not what was there before */
+	__DSB();
+	__ISB();
 	relocate_vector_table();
 	enable_floating_point();
 	_bss_zero();
@@ -21,6 +21,8 @@
 #include <sections.h>
 #include <sw_isr_table.h>
 #include <irq.h>
+#include <kernel_structs.h>
+#include <logging/kernel_event_logger.h>
 
 extern void __reserved(void);
 
@@ -127,3 +129,47 @@ void _irq_spurious(void *unused)
 	__reserved();
 }
 
+#if defined(CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT) || \
+	defined(CONFIG_KERNEL_EVENT_LOGGER_SLEEP)
+/**
+ *
+ * @brief Kernel housekeeping when entering a direct interrupt
+ *
+ * Does the event logging _isr_wrapper() does for ISRs in the software
+ * table. See ISR_DIRECT_HEADER().
+ *
+ * @return N/A
+ */
+void _arch_isr_direct_header(void)
+{
+	_sys_k_event_logger_interrupt();
+	_sys_k_event_logger_exit_sleep();
+}
+#endif
+
+#if defined(CONFIG_SYS_POWER_MANAGEMENT)
+/**
+ *
+ * @brief Exit the kernel idle state from a direct interrupt
+ *
+ * Same as _isr_wrapper(): _sys_power_save_idle_exit() is called with
+ * interrupts disabled, so that the next timer deadline is computed and
+ * programmed without being interrupted. See ISR_DIRECT_PM().
+ *
+ * @return N/A
+ */
+void _arch_isr_direct_pm(void)
+{
+	int32_t idle_val;
+
+	__asm__ volatile("cpsid i" : : : "memory");
+
+	idle_val = _kernel.idle;
+	if (idle_val) {
+		_kernel.idle = 0;
+		_sys_power_save_idle_exit(idle_val);
+	}
+
+	__asm__ volatile("cpsie i" : : : "memory");
+}
+#endif
@@ -30,6 +30,7 @@ GEN_OFFSET_SYM(_thread_arch_t, basepri);
 GEN_OFFSET_SYM(_thread_arch_t, swap_return_value);
 
 #ifdef CONFIG_FLOAT
+GEN_OFFSET_SYM(_thread_arch_t, exc_return);
 GEN_OFFSET_SYM(_thread_arch_t, preempt_float);
 #endif
 
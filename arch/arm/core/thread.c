@@ -15,9 +15,9 @@
 #include <toolchain.h>
 #include <kernel_structs.h>
 #include <wait_q.h>
-#ifdef CONFIG_INIT_STACKS
+#if defined(CONFIG_INIT_STACKS) || defined(CONFIG_PERF_COUNTER_THREAD)
 #include <string.h>
-#endif /* CONFIG_INIT_STACKS */
+#endif
 
 #if defined(CONFIG_THREAD_MONITOR)
 /*
@@ -84,7 +84,10 @@ void _new_thread(char *pStackMem, size_t stackSize,
 	struct tcs *tcs = (struct tcs *) pStackMem;
 
 #ifdef CONFIG_INIT_STACKS
-	memset(pStackMem, 0xaa, stackSize);
+	/* a reused stack is still filled where it was never used */
+	if (!(options & K_NO_STACK_FILL)) {
+		memset(pStackMem, 0xaa, stackSize);
+	}
 #endif
 
 	/* carve the thread entry struct from the "base" of the stack */
@@ -106,6 +109,18 @@ void _new_thread(char *pStackMem, size_t stackSize,
 	tcs->init_data = NULL;
 	tcs->fn_abort = NULL;
 
+#ifdef CONFIG_THREAD_POOL
+	tcs->pool = NULL;
+#endif
+
+#ifdef CONFIG_HEAP_ARENAS
+	tcs->heap_arena = NULL;
+#endif
+
+#ifdef CONFIG_PERF_COUNTER_THREAD
+	memset(tcs->perf_counts, 0, sizeof(tcs->perf_counts));
+#endif
+
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	/* Initialize custom data field (value is opaque to kernel) */
 
@@ -123,6 +138,14 @@ void _new_thread(char *pStackMem, size_t stackSize,
 	tcs->callee_saved.psp = (uint32_t)pInitCtx;
 	tcs->arch.basepri = 0;
 
+#ifdef CONFIG_FLOAT
+	/*
+	 * Threads start with a basic stack frame, the processor switching
+	 * them to extended ones after their first FP instruction.
+	 */
+	tcs->arch.exc_return = _EXC_RETURN_THREAD_PSP;
+#endif
+
 	/* swap_return_value can contain garbage */
 
 	/* initial values in all other registers/TCS entries are irrelevant */
@@ -86,6 +86,14 @@ typedef struct __esf _esf_t;
 #include <cortex_m/exc.h>
 #endif
 
+/*
+ * EXC_RETURN value of a thread that never used the FP registers, bit 4
+ * being cleared by the processor in the EXC_RETURN of contexts that did,
+ * telling their exception stack frame has room for the FP registers.
+ */
+#define _EXC_RETURN_THREAD_PSP 0xfffffffd
+#define _EXC_RETURN_NO_FP (1 << 4)
+
 #ifndef _ASMLANGUAGE
 
 #ifdef CONFIG_FLOAT
@@ -118,6 +126,13 @@ struct _thread_arch {
 	uint32_t swap_return_value;
 
 #ifdef CONFIG_FLOAT
+	/*
+	 * EXC_RETURN of the thread when it was switched out, telling if its
+	 * exception stack frame holds the FP registers and if preempt_float
+	 * has to be restored.
+	 */
+	uint32_t exc_return;
+
 	/*
 	 * No cooperative floating point register set structure exists for
 	 * the Cortex-M as it automatically saves the necessary registers
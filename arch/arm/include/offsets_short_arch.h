@@ -23,6 +23,9 @@
 #define _thread_offset_to_swap_return_value \
 	(___thread_t_arch_OFFSET + ___thread_arch_t_swap_return_value_OFFSET)
 
+#define _thread_offset_to_exc_return \
+	(___thread_t_arch_OFFSET + ___thread_arch_t_exc_return_OFFSET)
+
 #define _thread_offset_to_preempt_float \
 	(___thread_t_arch_OFFSET + ___thread_arch_t_preempt_float_OFFSET)
 
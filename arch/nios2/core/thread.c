@@ -61,7 +61,10 @@ void _new_thread(char *stack_memory, size_t stack_size,
 	struct init_stack_frame *iframe;
 
 #ifdef CONFIG_INIT_STACKS
-	memset(stack_memory, 0xaa, stack_size);
+	/* a reused stack is still filled where it was never used */
+	if (!(options & K_NO_STACK_FILL)) {
+		memset(stack_memory, 0xaa, stack_size);
+	}
 #endif
 	/* Initial stack frame data, stored at the base of the stack */
 	iframe = (struct init_stack_frame *)
@@ -82,6 +85,14 @@ void _new_thread(char *stack_memory, size_t stack_size,
 	thread->init_data = NULL;
 	thread->fn_abort = NULL;
 
+#ifdef CONFIG_THREAD_POOL
+	thread->pool = NULL;
+#endif
+
+#ifdef CONFIG_HEAP_ARENAS
+	thread->heap_arena = NULL;
+#endif
+
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	/* Initialize custom data field (value is opaque to kernel) */
 	thread->custom_data = NULL;
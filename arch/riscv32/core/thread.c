@@ -45,7 +45,10 @@ void _new_thread(char *stack_memory, size_t stack_size,
 	struct __esf *stack_init;
 
 #ifdef CONFIG_INIT_STACKS
-	memset(stack_memory, 0xaa, stack_size);
+	/* a reused stack is still filled where it was never used */
+	if (!(options & K_NO_STACK_FILL)) {
+		memset(stack_memory, 0xaa, stack_size);
+	}
 #endif
 	/* Initial stack frame for thread */
 	stack_init = (struct __esf *)
@@ -92,6 +95,14 @@ void _new_thread(char *stack_memory, size_t stack_size,
 	thread->init_data = NULL;
 	thread->fn_abort = NULL;
 
+#ifdef CONFIG_THREAD_POOL
+	thread->pool = NULL;
+#endif
+
+#ifdef CONFIG_HEAP_ARENAS
+	thread->heap_arena = NULL;
+#endif
+
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	/* Initialize custom data field (value is opaque to kernel) */
 	thread->custom_data = NULL;
@@ -35,18 +35,20 @@
  * The cache line size is specified either via the CONFIG_CACHE_LINE_SIZE
  * kconfig option or it is detected at runtime.
  *
+ * CLFLUSH writes the line back and invalidates it, so this also serves as
+ * sys_cache_invd() and sys_cache_flush_invd().
+ *
  * @return N/A
  */
 
 _sys_cache_flush_sig(_cache_flush_clflush)
 {
-	int end;
+	vaddr_t end = virt + size;
 
-	size = ROUND_UP(size, sys_cache_line_size);
-	end = virt + size;
+	virt &= ~(vaddr_t)(sys_cache_line_size - 1);
 
 	for (; virt < end; virt += sys_cache_line_size) {
-		__asm__ volatile("clflush %0;\n\t" :  : "m"(virt));
+		__asm__ volatile("clflush %0;\n\t" :  : "m"(*(char *)virt));
 	}
 
 	__asm__ volatile("mfence;\n\t");
@@ -60,6 +62,8 @@ _sys_cache_flush_sig(_cache_flush_clflush)
 
 #if defined(CONFIG_CLFLUSH_DETECT)
 _sys_cache_flush_t *sys_cache_flush;
+_sys_cache_flush_t *sys_cache_invd;
+_sys_cache_flush_t *sys_cache_flush_invd;
 static void init_cache_flush(void)
 {
 	if (_is_clflush_available()) {
@@ -67,12 +71,18 @@ static void init_cache_flush(void)
 	} else {
 		sys_cache_flush = _cache_flush_wbinvd;
 	}
+
+	/* Lines are always written back before being discarded */
+	sys_cache_invd = sys_cache_flush;
+	sys_cache_flush_invd = sys_cache_flush;
 }
 #else
 #define init_cache_flush() do { } while ((0))
 
 #if defined(CONFIG_CLFLUSH_INSTRUCTION_SUPPORTED)
 FUNC_ALIAS(_cache_flush_clflush, sys_cache_flush, void);
+FUNC_ALIAS(_cache_flush_clflush, sys_cache_invd, void);
+FUNC_ALIAS(_cache_flush_clflush, sys_cache_flush_invd, void);
 #endif
 
 #endif /* CONFIG_CLFLUSH_DETECT */
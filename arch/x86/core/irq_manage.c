@@ -20,6 +20,8 @@
 #include <misc/__assert.h>
 #include <misc/printk.h>
 #include <irq.h>
+#include <nano_internal.h>
+#include <logging/kernel_event_logger.h>
 
 extern void _SpuriousIntHandler(void *);
 extern void _SpuriousIntNoErrCodeHandler(void *);
@@ -45,3 +47,119 @@ void *__attribute__((section(".spurNoErrIsr")))
 	MK_ISR_NAME(_SpuriousIntNoErrCodeHandler) =
 		&_SpuriousIntNoErrCodeHandler;
 
+/**
+ *
+ * @brief Kernel housekeeping when entering a direct interrupt
+ *
+ * Does the latency measurement and event logging _interrupt_enter() does,
+ * and increments the nesting level so that k_is_in_isr() holds. Direct
+ * interrupts stay on the stack of the interrupted thread. See
+ * ISR_DIRECT_HEADER().
+ *
+ * @return N/A
+ */
+void _arch_isr_direct_header(void)
+{
+	_int_latency_start();
+	_sys_k_event_logger_interrupt();
+	_sys_k_event_logger_exit_sleep();
+
+	++_kernel.nested;
+}
+
+/**
+ *
+ * @brief Kernel housekeeping when exiting a direct interrupt
+ *
+ * Sends the EOI and, if @a maybe_swap is set and the interrupt is not
+ * nested, switches to the thread the ISR made ready with _Swap(), the way
+ * _interrupt_enter() does. The interrupted thread resumes in this
+ * routine, then returns from the interrupt. See ISR_DIRECT_FOOTER().
+ *
+ * @param maybe_swap Nonzero to invoke the scheduler.
+ *
+ * @return N/A
+ */
+void _arch_isr_direct_footer(int maybe_swap)
+{
+	_irq_controller_eoi();
+	_int_latency_stop();
+	--_kernel.nested;
+
+	if (maybe_swap && !_kernel.nested &&
+	    _current->base.preempt < _NON_PREEMPT_THRESHOLD &&
+	    _kernel.ready_q.cache != _current) {
+		unsigned int flags;
+
+		/* the EFLAGS of the ISR, interrupts locked, for _Swap() */
+		__asm__ volatile("pushfl\n\t"
+				 "popl %0\n\t"
+				 : "=g" (flags) : : "memory");
+
+#if defined(CONFIG_FP_SHARING) || defined(CONFIG_GDB_INFO)
+		_current->base.thread_state |= _INT_ACTIVE;
+		_Swap(flags);
+		_current->base.thread_state &= ~_INT_ACTIVE;
+#else
+		_Swap(flags);
+#endif
+	}
+}
+
+#ifdef CONFIG_SYS_POWER_MANAGEMENT
+/**
+ *
+ * @brief Exit the kernel idle state from a direct interrupt
+ *
+ * See ISR_DIRECT_PM().
+ *
+ * @return N/A
+ */
+void _arch_isr_direct_pm(void)
+{
+	int32_t idle_val = _kernel.idle;
+
+	/* interrupts are still locked */
+	if (idle_val) {
+		_kernel.idle = 0;
+		_sys_power_save_idle_exit(idle_val);
+	}
+}
+#endif
+
+#ifdef CONFIG_IRQ_STATS
+#include <arch/x86/irq_controller.h>
+
+/* Deeper nesting levels share the last timestamp */
+#define IRQ_STATS_NESTING 16
+
+static uint32_t irq_stats_entered[IRQ_STATS_NESTING];
+
+/*
+ * Called by _interrupt_enter() with interrupts locked, before the nesting
+ * level is incremented.
+ */
+void _irq_stats_enter(void)
+{
+	irq_stats_entered[min(_kernel.nested, IRQ_STATS_NESTING - 1)] =
+		k_cycle_get_32();
+}
+
+/* Called by _interrupt_enter() instead of the ISR */
+void _irq_stats_dispatch(void *isr_param, void (*isr)(void *))
+{
+	uint32_t entered, start, end;
+
+	entered = irq_stats_entered[min(_kernel.nested - 1,
+					IRQ_STATS_NESTING - 1)];
+	start = k_cycle_get_32();
+
+	isr(isr_param);
+
+	end = k_cycle_get_32();
+
+	/* the vector stays in service until the EOI that follows */
+	_irq_stats_record(_irq_controller_isr_vector_get(), isr, entered,
+			  start, end);
+}
+#endif /* CONFIG_IRQ_STATS */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief x86 performance counters
+ *
+ * The architectural performance monitoring of Intel CPUs, found on Atom,
+ * has general purpose counters which can each count any event, selected by
+ * the IA32_PERFEVTSELx MSR of the counter. Leaf 0xA of CPUID tells the
+ * version of the PMU, its number of counters and the architectural events
+ * it does not support.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <nano_internal.h>
+#include <errno.h>
+
+#define PERFEVTSEL_USR	(1 << 16)
+#define PERFEVTSEL_OS	(1 << 17)
+#define PERFEVTSEL_EN	(1 << 22)
+
+/* at most IA32_PMC0 to IA32_PMC3, though Atom has 2 */
+#define PMU_MAX_COUNTERS 4
+
+/* architectural event of each event, by enum perf_event */
+static const struct {
+	uint8_t select;
+	uint8_t umask;
+	/* bit of the event in EBX of CPUID leaf 0xA, set if unsupported */
+	int8_t cpuid_bit;
+} pmu_events[PERF_EVENT_COUNT] = {
+	[PERF_EVENT_CYCLES] = { 0x3c, 0x00, 0 },
+	[PERF_EVENT_INSTRUCTIONS] = { 0xc0, 0x00, 1 },
+	[PERF_EVENT_CACHE_MISSES] = { 0x2e, 0x41, 4 },
+	[PERF_EVENT_BRANCH_MISSES] = { 0xc5, 0x00, 6 },
+	[PERF_EVENT_STALL_CYCLES] = { 0, 0, -1 },
+	[PERF_EVENT_LSU_CYCLES] = { 0, 0, -1 },
+	[PERF_EVENT_EXC_CYCLES] = { 0, 0, -1 },
+	[PERF_EVENT_SLEEP_CYCLES] = { 0, 0, -1 },
+	[PERF_EVENT_FOLDED] = { 0, 0, -1 },
+};
+
+static uint8_t pmu_version;
+static uint8_t pmu_num_counters;
+static uint32_t pmu_supported;
+
+/* counter assigned to each started event */
+static uint8_t pmu_counter[PERF_EVENT_COUNT];
+
+static void pmu_probe(void)
+{
+	uint32_t eax, ebx, ecx, edx;
+	int event;
+
+	if (pmu_version) {
+		return;
+	}
+
+	__asm__ volatile ("cpuid"
+			  : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+			  : "a" (0xa));
+
+	pmu_version = eax & 0xff;
+	pmu_num_counters = min((eax >> 8) & 0xff, PMU_MAX_COUNTERS);
+
+	for (event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (pmu_events[event].cpuid_bit >= 0 &&
+		    !(ebx & (1 << pmu_events[event].cpuid_bit))) {
+			pmu_supported |= PERF_EVENT_BIT(event);
+		}
+	}
+}
+
+uint32_t _arch_perf_counter_events(void)
+{
+	pmu_probe();
+
+	return pmu_version ? pmu_supported : 0;
+}
+
+int _arch_perf_counter_start(uint32_t events)
+{
+	int event, counter = 0;
+
+	pmu_probe();
+
+	if (popcount(events) > pmu_num_counters) {
+		return -EINVAL;
+	}
+
+	_arch_perf_counter_stop();
+
+	for (event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (!(events & PERF_EVENT_BIT(event))) {
+			continue;
+		}
+
+		pmu_counter[event] = counter;
+
+		_MsrWrite(IA32_PMC0_MSR + counter, 0);
+		_MsrWrite(IA32_PERFEVTSEL0_MSR + counter,
+			  pmu_events[event].select |
+			  (pmu_events[event].umask << 8) |
+			  PERFEVTSEL_USR | PERFEVTSEL_OS | PERFEVTSEL_EN);
+
+		counter++;
+	}
+
+	/* version 2 added a global enable, all set on reset */
+	if (pmu_version >= 2) {
+		_MsrWrite(IA32_PERF_GLOBAL_CTRL_MSR,
+			  _MsrRead(IA32_PERF_GLOBAL_CTRL_MSR) |
+			  ((1 << pmu_num_counters) - 1));
+	}
+
+	return 0;
+}
+
+void _arch_perf_counter_stop(void)
+{
+	int counter;
+
+	for (counter = 0; counter < pmu_num_counters; counter++) {
+		_MsrWrite(IA32_PERFEVTSEL0_MSR + counter, 0);
+	}
+}
+
+uint32_t _arch_perf_counter_read(enum perf_event event)
+{
+	/* the counters are 40-bit wide at least, their low half wraps */
+	return (uint32_t)_MsrRead(IA32_PMC0_MSR + pmu_counter[event]);
+}
+
+uint32_t _arch_perf_counter_mask(enum perf_event event)
+{
+	ARG_UNUSED(event);
+
+	return 0xffffffff;
+}
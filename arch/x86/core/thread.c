@@ -12,9 +12,9 @@
  * processor architecture.
  */
 
-#ifdef CONFIG_INIT_STACKS
+#if defined(CONFIG_INIT_STACKS) || defined(CONFIG_PERF_COUNTER_THREAD)
 #include <string.h>
-#endif /* CONFIG_INIT_STACKS */
+#endif
 
 #include <toolchain.h>
 #include <sections.h>
@@ -83,6 +83,18 @@ static void _new_thread_internal(char *pStackMem, unsigned stackSize,
 	thread->init_data = NULL;
 	thread->fn_abort = NULL;
 
+#ifdef CONFIG_THREAD_POOL
+	thread->pool = NULL;
+#endif
+
+#ifdef CONFIG_HEAP_ARENAS
+	thread->heap_arena = NULL;
+#endif
+
+#ifdef CONFIG_PERF_COUNTER_THREAD
+	memset(thread->perf_counts, 0, sizeof(thread->perf_counts));
+#endif
+
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	/* Initialize custom data field (value is opaque to kernel) */
 
@@ -237,7 +249,10 @@ void _new_thread(char *pStackMem, size_t stackSize,
 	unsigned long *pInitialThread;
 
 #ifdef CONFIG_INIT_STACKS
-	memset(pStackMem, 0xaa, stackSize);
+	/* a reused stack is still filled where it was never used */
+	if (!(options & K_NO_STACK_FILL)) {
+		memset(pStackMem, 0xaa, stackSize);
+	}
 #endif
 
 	/* carve the thread entry struct from the "base" of the stack */
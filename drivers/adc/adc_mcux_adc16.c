@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Kinetis ADC16 driver
+ *
+ * Sequence reads are software triggered and polled. Continuous
+ * acquisitions are triggered by the programmable delay block (PDB) and
+ * the results moved by an eDMA channel looping over the two halves of the
+ * buffer, so the CPU is only involved once per half.
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <adc.h>
+#include <dma.h>
+#include <soc.h>
+#include <atomic.h>
+#include <fsl_adc16.h>
+#include <fsl_pdb.h>
+#include <fsl_clock.h>
+
+/* PDB counter and modulus are 16 bits */
+#define ADC_MCUX_PDB_MAX_MOD 0xffff
+#define ADC_MCUX_PDB_MAX_PRESCALER 7
+
+struct adc_mcux_config {
+	ADC_Type *base;
+	PDB_Type *pdb;
+	uint32_t pdb_channel;
+	uint32_t dma_request;
+};
+
+struct adc_mcux_data {
+	struct k_sem lock;
+	atomic_t streaming;
+	struct device *dma;
+	struct dma_block_config block[2];
+	/* Half of the buffer the DMA fills */
+	uint8_t half;
+	struct adc_stream_config stream;
+};
+
+static void adc_mcux_enable(struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+static void adc_mcux_disable(struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+static int adc_mcux_read(struct device *dev, struct adc_seq_table *seq_table)
+{
+	const struct adc_mcux_config *config = dev->config->config_info;
+	struct adc_mcux_data *data = dev->driver_data;
+	adc16_channel_config_t channel = { 0 };
+	struct adc_seq_entry *entry;
+	uint16_t *sample;
+	uint32_t i, n;
+
+	if (atomic_get(&data->streaming)) {
+		return -EBUSY;
+	}
+
+	k_sem_take(&data->lock, K_FOREVER);
+
+	for (i = 0; i < seq_table->num_entries; i++) {
+		entry = &seq_table->entries[i];
+		channel.channelNumber = entry->channel_id;
+		sample = (uint16_t *)entry->buffer;
+
+		for (n = 0; n < entry->buffer_length / sizeof(*sample); n++) {
+			/* Writing the channel starts the conversion */
+			ADC16_SetChannelConfig(config->base, 0, &channel);
+
+			while (!(ADC16_GetChannelStatusFlags(config->base, 0) &
+				 kADC16_ChannelConversionDoneFlag)) {
+			}
+
+			sample[n] = ADC16_GetChannelConversionValue(config->base,
+								    0);
+		}
+	}
+
+	k_sem_give(&data->lock);
+
+	return 0;
+}
+
+#ifdef CONFIG_ADC_MCUX_ADC16_STREAM
+static void adc_mcux_dma_done(struct device *dma, void *arg)
+{
+	struct device *dev = arg;
+	struct adc_mcux_data *data = dev->driver_data;
+	struct dma_block_config *block = &data->block[data->half];
+
+	ARG_UNUSED(dma);
+
+	data->half ^= 1;
+
+	data->stream.callback(dev, (uint8_t *)block->destination_address,
+			      block->block_size, data->stream.user_data);
+}
+
+static void adc_mcux_dma_error(struct device *dma, void *arg)
+{
+	struct device *dev = arg;
+
+	adc_stream_stop(dev);
+}
+
+/* Period of the PDB counter, as prescaler and modulus */
+static int adc_mcux_pdb_period(uint32_t rate, uint32_t *prescaler,
+			       uint32_t *mod)
+{
+	uint32_t clock = CLOCK_GetFreq(kCLOCK_BusClk);
+	uint32_t p;
+
+	if (!rate) {
+		return -EINVAL;
+	}
+
+	for (p = 0; p <= ADC_MCUX_PDB_MAX_PRESCALER; p++) {
+		*mod = (clock >> p) / rate;
+		if (*mod && *mod <= ADC_MCUX_PDB_MAX_MOD) {
+			*prescaler = p;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static int adc_mcux_stream_start(struct device *dev,
+				 const struct adc_stream_config *stream)
+{
+	const struct adc_mcux_config *config = dev->config->config_info;
+	struct adc_mcux_data *data = dev->driver_data;
+	struct dma_channel_config dma_cfg = { 0 };
+	pdb_adc_pretrigger_config_t pretrigger = { 0 };
+	adc16_channel_config_t channel = { 0 };
+	pdb_config_t pdb_cfg;
+	uint32_t half = stream->buffer_length / 2;
+	uint32_t prescaler, mod;
+	int ret;
+
+	if (!stream->callback || !half || half % sizeof(uint16_t) ||
+	    adc_mcux_pdb_period(stream->sample_rate, &prescaler, &mod)) {
+		return -EINVAL;
+	}
+
+	if (!atomic_cas(&data->streaming, 0, 1)) {
+		return -EBUSY;
+	}
+
+	k_sem_take(&data->lock, K_FOREVER);
+
+	data->stream = *stream;
+	data->half = 0;
+
+	data->block[0].block_size = half;
+	data->block[0].source_address = (uint32_t *)&config->base->R[0];
+	data->block[0].destination_address = (uint32_t *)stream->buffer;
+	data->block[0].next_block = &data->block[1];
+	data->block[1].block_size = half;
+	data->block[1].source_address = (uint32_t *)&config->base->R[0];
+	data->block[1].destination_address =
+		(uint32_t *)(stream->buffer + half);
+	data->block[1].next_block = NULL;
+
+	/* The low half word of the result register holds the sample */
+	dma_cfg.handshake_interface = config->dma_request;
+	dma_cfg.channel_direction = PERIPHERAL_TO_MEMORY;
+	dma_cfg.source_transfer_width = TRANS_WIDTH_16;
+	dma_cfg.destination_transfer_width = TRANS_WIDTH_16;
+	dma_cfg.source_burst_length = BURST_TRANS_LENGTH_1;
+	dma_cfg.destination_burst_length = BURST_TRANS_LENGTH_1;
+	dma_cfg.transfer_type = TRANSFER_TYPE_CIRCULAR;
+	dma_cfg.dma_transfer = adc_mcux_dma_done;
+	dma_cfg.dma_error = adc_mcux_dma_error;
+	dma_cfg.callback_data = dev;
+
+	ret = dma_channel_config(data->dma, CONFIG_ADC_MCUX_ADC16_DMA_CHANNEL,
+				 &dma_cfg);
+	if (!ret) {
+		ret = dma_block_config(data->dma,
+				       CONFIG_ADC_MCUX_ADC16_DMA_CHANNEL,
+				       data->block);
+	}
+
+	if (!ret) {
+		ret = dma_transfer_start(data->dma,
+					 CONFIG_ADC_MCUX_ADC16_DMA_CHANNEL);
+	}
+
+	if (ret) {
+		k_sem_give(&data->lock);
+		atomic_clear(&data->streaming);
+		return ret;
+	}
+
+	/* Every hardware trigger converts the channel, requesting DMA */
+	ADC16_EnableHardwareTrigger(config->base, true);
+	ADC16_EnableDMA(config->base, true);
+	channel.channelNumber = stream->channel_id;
+	ADC16_SetChannelConfig(config->base, 0, &channel);
+
+	PDB_GetDefaultConfig(&pdb_cfg);
+	pdb_cfg.prescalerDivider = (pdb_prescaler_divider_t)prescaler;
+	pdb_cfg.enableContinuousMode = true;
+	PDB_Init(config->pdb, &pdb_cfg);
+
+	pretrigger.enablePreTriggerMask = BIT(0);
+	pretrigger.enableOutputMask = BIT(0);
+	PDB_SetADCPreTriggerConfig(config->pdb, config->pdb_channel,
+				   &pretrigger);
+	PDB_SetADCPreTriggerDelayValue(config->pdb, config->pdb_channel, 0, 0);
+	PDB_SetModulusValue(config->pdb, mod - 1);
+	PDB_SetCounterDelayValue(config->pdb, 0);
+	PDB_DoLoadValues(config->pdb);
+
+	PDB_DoSoftwareTrigger(config->pdb);
+
+	return 0;
+}
+
+static int adc_mcux_stream_stop(struct device *dev)
+{
+	const struct adc_mcux_config *config = dev->config->config_info;
+	struct adc_mcux_data *data = dev->driver_data;
+
+	if (!atomic_get(&data->streaming)) {
+		return 0;
+	}
+
+	PDB_Deinit(config->pdb);
+	dma_transfer_stop(data->dma, CONFIG_ADC_MCUX_ADC16_DMA_CHANNEL);
+
+	ADC16_EnableDMA(config->base, false);
+	ADC16_EnableHardwareTrigger(config->base, false);
+
+	atomic_clear(&data->streaming);
+	k_sem_give(&data->lock);
+
+	return 0;
+}
+#endif /* CONFIG_ADC_MCUX_ADC16_STREAM */
+
+static const struct adc_driver_api adc_mcux_driver_api = {
+	.enable = adc_mcux_enable,
+	.disable = adc_mcux_disable,
+	.read = adc_mcux_read,
+#ifdef CONFIG_ADC_MCUX_ADC16_STREAM
+	.stream_start = adc_mcux_stream_start,
+	.stream_stop = adc_mcux_stream_stop,
+#endif
+};
+
+static int adc_mcux_init(struct device *dev)
+{
+	const struct adc_mcux_config *config = dev->config->config_info;
+	struct adc_mcux_data *data = dev->driver_data;
+	adc16_config_t adc_cfg;
+
+	k_sem_init(&data->lock, 1, 1);
+
+#ifdef CONFIG_ADC_MCUX_ADC16_STREAM
+	data->dma = device_get_binding(CONFIG_ADC_MCUX_ADC16_DMA_NAME);
+	if (!data->dma) {
+		return -ENODEV;
+	}
+#endif
+
+	ADC16_GetDefaultConfig(&adc_cfg);
+	adc_cfg.resolution = kADC16_ResolutionSE12Bit;
+	ADC16_Init(config->base, &adc_cfg);
+
+	ADC16_EnableHardwareTrigger(config->base, false);
+	ADC16_DoAutoCalibration(config->base);
+
+	return 0;
+}
+
+static const struct adc_mcux_config adc_mcux_config_0 = {
+	.base = ADC0,
+	.pdb = PDB0,
+	/* PDB channel 0 triggers ADC0 */
+	.pdb_channel = 0,
+	.dma_request = kDmaRequestMux0ADC0 & 0xff,
+};
+
+static struct adc_mcux_data adc_mcux_data_0;
+
+DEVICE_AND_API_INIT(adc_mcux_0, CONFIG_ADC_0_NAME, &adc_mcux_init,
+		    &adc_mcux_data_0, &adc_mcux_config_0,
+		    POST_KERNEL, CONFIG_ADC_INIT_PRIORITY,
+		    &adc_mcux_driver_api);
@@ -0,0 +1,463 @@
+/* h4_dma.c - H:4 UART based Bluetooth driver using DMA */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stddef.h>
+
+#include <zephyr.h>
+#include <arch/cpu.h>
+
+#include <init.h>
+#include <uart.h>
+#include <dma.h>
+#include <misc/util.h>
+#include <misc/byteorder.h>
+#include <string.h>
+
+#define BT_DBG_ENABLED IS_ENABLED(CONFIG_BLUETOOTH_DEBUG_HCI_DRIVER)
+#include <bluetooth/log.h>
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/hci.h>
+#include <bluetooth/hci_driver.h>
+
+#define H4_NONE 0x00
+#define H4_CMD  0x01
+#define H4_ACL  0x02
+#define H4_SCO  0x03
+#define H4_EVT  0x04
+
+#define H4_DISCARD_LEN 32
+
+#define UART_DATA_REG ((void *)CONFIG_BLUETOOTH_H4_DMA_UART_DATA_REG)
+
+/* The packets are received with one DMA transfer for the packet type, one
+ * for the header and one for the payload, which goes straight into the
+ * receive buffer. While no buffer is available no transfer is started, so
+ * that the UART hardware flow control holds the controller off.
+ */
+static BT_STACK_NOINIT(rx_thread_stack, CONFIG_BLUETOOTH_RX_STACK_SIZE);
+
+static struct {
+	enum {
+		RX_TYPE,
+		RX_HDR,
+		RX_PAYLOAD,
+		RX_DISCARD,
+	} state;
+
+	/* Buffer being received, and the next one ready for the ISR */
+	struct net_buf *buf;
+	struct net_buf *spare;
+	struct k_fifo   fifo;
+	/* Given for each received packet and for a stall */
+	struct k_sem    sem;
+
+	/* Waiting in the header state for a buffer */
+	bool     stalled;
+
+	uint16_t remaining;
+
+	uint8_t  type;
+	union {
+		struct bt_hci_evt_hdr evt;
+		struct bt_hci_acl_hdr acl;
+	};
+
+	uint8_t  discard[H4_DISCARD_LEN];
+} rx = {
+	.fifo = K_FIFO_INITIALIZER(rx.fifo),
+	.sem = K_SEM_INITIALIZER(rx.sem, 0, UINT_MAX),
+};
+
+static struct {
+	struct net_buf *buf;
+	struct k_fifo   fifo;
+} tx = {
+	.fifo = K_FIFO_INITIALIZER(tx.fifo),
+};
+
+static struct device *h4_dev;
+static struct device *dma_dev;
+
+static int dma_start(uint32_t channel, void *src, void *dst, size_t len)
+{
+	struct dma_transfer_config cfg = {
+		.block_size = len,
+		.source_address = src,
+		.destination_address = dst,
+	};
+	int err;
+
+	err = dma_transfer_config(dma_dev, channel, &cfg);
+	if (err) {
+		return err;
+	}
+
+	return dma_transfer_start(dma_dev, channel);
+}
+
+static void rx_start(void *dst, size_t len)
+{
+	int err;
+
+	err = dma_start(CONFIG_BLUETOOTH_H4_DMA_RX_CHANNEL, UART_DATA_REG, dst,
+			len);
+	if (err) {
+		BT_ERR("Unable to start RX DMA (err %d)", err);
+	}
+}
+
+static void rx_type(void)
+{
+	rx.state = RX_TYPE;
+	rx.type = H4_NONE;
+	rx_start(&rx.type, sizeof(rx.type));
+}
+
+static void rx_discard(void)
+{
+	rx.state = RX_DISCARD;
+	rx_start(rx.discard, min(rx.remaining, sizeof(rx.discard)));
+}
+
+static void rx_deliver(void)
+{
+	struct net_buf *buf = rx.buf;
+
+	rx.buf = NULL;
+
+	if (rx.type == H4_EVT) {
+		bt_buf_set_type(buf, BT_BUF_EVT);
+
+		if (bt_hci_evt_is_prio(rx.evt.evt)) {
+			BT_DBG("Calling bt_recv_prio(%p)", buf);
+			bt_recv_prio(buf);
+			return;
+		}
+	} else {
+		bt_buf_set_type(buf, BT_BUF_ACL_IN);
+	}
+
+	BT_DBG("Putting buf %p to rx fifo", buf);
+	net_buf_put(&rx.fifo, buf);
+	k_sem_give(&rx.sem);
+}
+
+/* Called with the header received, and again from the RX thread when a
+ * buffer became available after a stall.
+ */
+static void rx_payload(void)
+{
+	size_t hdr_len;
+
+	if (!rx.buf) {
+		rx.buf = rx.spare;
+		rx.spare = NULL;
+
+		if (!rx.buf) {
+			rx.buf = bt_buf_get_rx(K_NO_WAIT);
+		}
+
+		if (!rx.buf) {
+			BT_DBG("No buffer, deferring to rx_thread");
+			rx.stalled = true;
+			k_sem_give(&rx.sem);
+			return;
+		}
+	}
+
+	rx.stalled = false;
+
+	hdr_len = (rx.type == H4_EVT) ? sizeof(rx.evt) : sizeof(rx.acl);
+	if (hdr_len + rx.remaining > net_buf_tailroom(rx.buf)) {
+		BT_ERR("Not enough space in buffer");
+		/* Keep the buffer for the next packet */
+		rx.spare = rx.buf;
+		rx.buf = NULL;
+		rx_discard();
+		return;
+	}
+
+	net_buf_add_mem(rx.buf, &rx.evt, hdr_len);
+
+	if (!rx.remaining) {
+		rx_deliver();
+		rx_type();
+		return;
+	}
+
+	rx.state = RX_PAYLOAD;
+	rx_start(net_buf_tail(rx.buf), rx.remaining);
+}
+
+static void rx_done(struct device *dev, void *data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(data);
+
+	switch (rx.state) {
+	case RX_TYPE:
+		switch (rx.type) {
+		case H4_EVT:
+			rx.state = RX_HDR;
+			rx_start(&rx.evt, sizeof(rx.evt));
+			break;
+		case H4_ACL:
+			rx.state = RX_HDR;
+			rx_start(&rx.acl, sizeof(rx.acl));
+			break;
+		default:
+			BT_ERR("Unknown H:4 type 0x%02x", rx.type);
+			rx_type();
+			break;
+		}
+		break;
+	case RX_HDR:
+		if (rx.type == H4_EVT) {
+			rx.remaining = rx.evt.len;
+		} else {
+			rx.remaining = sys_le16_to_cpu(rx.acl.len);
+		}
+
+		BT_DBG("Got header. Payload %u bytes", rx.remaining);
+		rx_payload();
+		break;
+	case RX_PAYLOAD:
+		net_buf_add(rx.buf, rx.remaining);
+		rx_deliver();
+		rx_type();
+		break;
+	case RX_DISCARD:
+		rx.remaining -= min(rx.remaining, sizeof(rx.discard));
+		if (rx.remaining) {
+			rx_discard();
+		} else {
+			rx_type();
+		}
+		break;
+	}
+}
+
+static void rx_error(struct device *dev, void *data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(data);
+
+	BT_ERR("RX DMA error in state %u", rx.state);
+
+	if (rx.buf) {
+		/* Keep the buffer for the next packet */
+		rx.buf->len = 0;
+		rx.spare = rx.buf;
+		rx.buf = NULL;
+	}
+
+	rx_type();
+}
+
+static void rx_thread(void *p1, void *p2, void *p3)
+{
+	struct net_buf *buf;
+	unsigned int key;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	BT_DBG("started");
+
+	while (1) {
+		k_sem_take(&rx.sem, K_FOREVER);
+
+		while ((buf = net_buf_get(&rx.fifo, K_NO_WAIT))) {
+			BT_DBG("Calling bt_recv(%p)", buf);
+			bt_recv(buf);
+
+			/* Give other threads a chance to run if packets
+			 * are received so fast that rx.fifo never or very
+			 * rarely goes empty.
+			 */
+			k_yield();
+		}
+
+		/* Keep a buffer ready, and resume a stalled reception once
+		 * buffers are freed.
+		 */
+		if (!rx.spare) {
+			buf = bt_buf_get_rx(K_FOREVER);
+
+			key = irq_lock();
+			if (rx.stalled) {
+				rx.buf = buf;
+				rx_payload();
+			} else {
+				rx.spare = buf;
+			}
+			irq_unlock(key);
+		}
+	}
+}
+
+static void tx_start(void)
+{
+	int err;
+
+	BT_DBG("buf %p len %u", tx.buf, tx.buf->len);
+
+	err = dma_start(CONFIG_BLUETOOTH_H4_DMA_TX_CHANNEL, tx.buf->data,
+			UART_DATA_REG, tx.buf->len);
+	if (err) {
+		BT_ERR("Unable to start TX DMA (err %d)", err);
+	}
+}
+
+static void tx_done(struct device *dev, void *data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(data);
+
+	net_buf_unref(tx.buf);
+
+	tx.buf = net_buf_get(&tx.fifo, K_NO_WAIT);
+	if (tx.buf) {
+		tx_start();
+	}
+}
+
+static void tx_error(struct device *dev, void *data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(data);
+
+	BT_ERR("TX DMA error");
+
+	tx_done(dev, data);
+}
+
+static int h4_send(struct net_buf *buf)
+{
+	unsigned int key;
+
+	BT_DBG("buf %p type %u len %u", buf, bt_buf_get_type(buf), buf->len);
+
+	/* The packet type goes in the reserved head room so that the whole
+	 * packet is sent with a single transfer.
+	 */
+	switch (bt_buf_get_type(buf)) {
+	case BT_BUF_ACL_OUT:
+		net_buf_push_u8(buf, H4_ACL);
+		break;
+	case BT_BUF_CMD:
+		net_buf_push_u8(buf, H4_CMD);
+		break;
+	default:
+		BT_ERR("Unknown buffer type");
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (tx.buf) {
+		net_buf_put(&tx.fifo, buf);
+	} else {
+		tx.buf = buf;
+		tx_start();
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+static int dma_channel_setup(uint32_t channel, uint32_t handshake,
+			     enum dma_channel_direction dir,
+			     void (*done)(struct device *dev, void *data),
+			     void (*error)(struct device *dev, void *data))
+{
+	struct dma_channel_config cfg = {
+		.handshake_interface = handshake,
+		/* UART handshake signals are active low */
+		.handshake_polarity = HANDSHAKE_POLARITY_LOW,
+		.channel_direction = dir,
+		.source_transfer_width = TRANS_WIDTH_8,
+		.destination_transfer_width = TRANS_WIDTH_8,
+		/* Single bytes, headers are shorter than the UART FIFO
+		 * threshold.
+		 */
+		.source_burst_length = BURST_TRANS_LENGTH_1,
+		.destination_burst_length = BURST_TRANS_LENGTH_1,
+		.dma_transfer = done,
+		.dma_error = error,
+	};
+
+	return dma_channel_config(dma_dev, channel, &cfg);
+}
+
+static int h4_open(void)
+{
+	unsigned char c;
+	int err;
+
+	BT_DBG("");
+
+	/* The UART is only polled for draining, the data goes through DMA */
+	while (!uart_poll_in(h4_dev, &c)) {
+		continue;
+	}
+
+	err = dma_channel_setup(CONFIG_BLUETOOTH_H4_DMA_RX_CHANNEL,
+				CONFIG_BLUETOOTH_H4_DMA_RX_HANDSHAKE,
+				PERIPHERAL_TO_MEMORY, rx_done, rx_error);
+	if (err) {
+		BT_ERR("Unable to configure RX DMA channel (err %d)", err);
+		return -EIO;
+	}
+
+	err = dma_channel_setup(CONFIG_BLUETOOTH_H4_DMA_TX_CHANNEL,
+				CONFIG_BLUETOOTH_H4_DMA_TX_HANDSHAKE,
+				MEMORY_TO_PERIPHERAL, tx_done, tx_error);
+	if (err) {
+		BT_ERR("Unable to configure TX DMA channel (err %d)", err);
+		return -EIO;
+	}
+
+	k_thread_spawn(rx_thread_stack, sizeof(rx_thread_stack), rx_thread,
+		       NULL, NULL, NULL, K_PRIO_COOP(7), 0, K_NO_WAIT);
+
+	rx_type();
+
+	return 0;
+}
+
+static struct bt_hci_driver drv = {
+	.name		= "H:4 DMA",
+	.bus		= BT_HCI_DRIVER_BUS_UART,
+	.open		= h4_open,
+	.send		= h4_send,
+};
+
+static int _bt_uart_init(struct device *unused)
+{
+	ARG_UNUSED(unused);
+
+	h4_dev = device_get_binding(CONFIG_BLUETOOTH_UART_ON_DEV_NAME);
+	if (!h4_dev) {
+		return -EINVAL;
+	}
+
+	dma_dev = device_get_binding(CONFIG_BLUETOOTH_H4_DMA_DEV_NAME);
+	if (!dma_dev) {
+		return -EINVAL;
+	}
+
+	bt_hci_driver_register(&drv);
+
+	return 0;
+}
+
+SYS_INIT(_bt_uart_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE);
@@ -57,6 +57,7 @@ static bool reliable_packet(uint8_t type)
 /* FIXME: Correct timeout */
 #define H5_RX_ACK_TIMEOUT	K_MSEC(250)
 #define H5_TX_ACK_TIMEOUT	K_MSEC(250)
+#define H5_LINK_TIMEOUT		K_MSEC(250)
 
 #define SLIP_DELIMITER	0xc0
 #define SLIP_ESC	0xdb
@@ -66,6 +67,12 @@ static bool reliable_packet(uint8_t type)
 #define H5_RX_ESC	1
 #define H5_TX_ACK_PEND	2
 
+/* Configuration field */
+#define H5_CONF_WIN(conf)	((conf) & 0x07)
+#define H5_CONF_CRC		BIT(4)
+
+#define H5_RX_CHUNK_LEN	16
+
 #define H5_HDR_SEQ(hdr)		((hdr)[0] & 0x07)
 #define H5_HDR_ACK(hdr)		(((hdr)[0] >> 3) & 0x07)
 #define H5_HDR_CRC(hdr)		(((hdr)[0] >> 6) & 0x01)
@@ -75,6 +82,7 @@ static bool reliable_packet(uint8_t type)
 
 #define H5_SET_SEQ(hdr, seq)	((hdr)[0] |= (seq))
 #define H5_SET_ACK(hdr, ack)	((hdr)[0] |= (ack) << 3)
+#define H5_SET_CRC(hdr)		((hdr)[0] |= 1 << 6)
 #define H5_SET_RELIABLE(hdr)	((hdr)[0] |= 1 << 7)
 #define H5_SET_TYPE(hdr, type)	((hdr)[1] |= type)
 #define H5_SET_LEN(hdr, len)	(((hdr)[1] |= ((len) & 0x0f) << 4), \
@@ -93,6 +101,17 @@ static struct h5 {
 
 	uint8_t			rx_ack;
 
+	/* Free slots of the sliding window */
+	struct k_sem		tx_win_sem;
+	/* Data integrity check agreed on for sending */
+	bool			tx_crc;
+
+	uint8_t			rx_flags;
+	uint8_t			rx_hdr[4];
+	uint16_t		rx_remaining;
+	uint16_t		rx_crc;
+	uint8_t			rx_crc_recv[2];
+
 	enum {
 		UNINIT,
 		INIT,
@@ -103,6 +122,7 @@ static struct h5 {
 		START,
 		HEADER,
 		PAYLOAD,
+		CRC,
 		END,
 	}			rx_state;
 } h5;
@@ -133,33 +153,34 @@ static void h5_reset_rx(void)
 	}
 
 	h5.rx_state = START;
+	h5.rx_flags = 0;
 }
 
-static int h5_unslip_byte(uint8_t *byte)
+/* CRC-CCITT of the data integrity check, computed LSB first */
+static uint16_t h5_crc_update(uint16_t crc, uint8_t byte)
 {
-	int count;
+	static const uint16_t table[16] = {
+		0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+		0x8408, 0x9489, 0xa50a, 0xb58b, 0xc60c, 0xd68d, 0xe70e, 0xf78f,
+	};
 
-	if (*byte != SLIP_ESC) {
-		return 0;
-	}
+	crc = (crc >> 4) ^ table[(crc ^ byte) & 0x0f];
+	crc = (crc >> 4) ^ table[(crc ^ (byte >> 4)) & 0x0f];
 
-	do {
-		count = uart_fifo_read(h5_dev, byte, sizeof(*byte));
-	} while (!count);
+	return crc;
+}
 
-	switch (*byte) {
-	case SLIP_ESC_DELIM:
-		*byte = SLIP_DELIMITER;
-		break;
-	case SLIP_ESC_ESC:
-		*byte = SLIP_ESC;
-		break;
-	default:
-		BT_ERR("Invalid escape byte %x\n", *byte);
-		return -EIO;
+/* The check is sent MSB first, with the bits in the reverse order */
+static uint16_t h5_crc_final(uint16_t crc)
+{
+	uint16_t rev = 0;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		rev = (rev << 1) | ((crc >> i) & 0x01);
 	}
 
-	return 0;
+	return rev;
 }
 
 static void process_unack(void)
@@ -208,6 +229,7 @@ static void process_unack(void)
 		net_buf_unref(buf);
 		unack_queue_len--;
 		number_removed--;
+		k_sem_give(&h5.tx_win_sem);
 	}
 }
 
@@ -279,6 +301,7 @@ static uint8_t h5_slip_byte(uint8_t byte)
 
 static void h5_send(const uint8_t *payload, uint8_t type, int len)
 {
+	uint16_t crc = 0xffff;
 	uint8_t hdr[4];
 	int i;
 
@@ -299,6 +322,10 @@ static void h5_send(const uint8_t *payload, uint8_t type, int len)
 	H5_SET_TYPE(hdr, type);
 	H5_SET_LEN(hdr, len);
 
+	if (h5.tx_crc) {
+		H5_SET_CRC(hdr);
+	}
+
 	/* Calculate CRC */
 	hdr[3] = ~((hdr[0] + hdr[1] + hdr[2]) & 0xff);
 
@@ -308,10 +335,18 @@ static void h5_send(const uint8_t *payload, uint8_t type, int len)
 
 	for (i = 0; i < 4; i++) {
 		h5_slip_byte(hdr[i]);
+		crc = h5_crc_update(crc, hdr[i]);
 	}
 
 	for (i = 0; i < len; i++) {
 		h5_slip_byte(payload[i]);
+		crc = h5_crc_update(crc, payload[i]);
+	}
+
+	if (h5.tx_crc) {
+		crc = h5_crc_final(crc);
+		h5_slip_byte(crc >> 8);
+		h5_slip_byte(crc & 0xff);
 	}
 
 	uart_poll_out(h5_dev, SLIP_DELIMITER);
@@ -342,6 +377,7 @@ static void retx_timeout(struct k_work *work)
 			net_buf_put(&h5.tx_queue, buf);
 			h5.tx_seq = (h5.tx_seq - 1) & 0x07;
 			unack_queue_len--;
+			k_sem_give(&h5.tx_win_sem);
 		}
 
 		/* Queue saved packets from temp queue */
@@ -402,142 +438,235 @@ static void h5_process_complete_packet(uint8_t *hdr)
 	}
 }
 
-static void bt_uart_isr(struct device *unused)
+static int h5_rx_alloc(const uint8_t *hdr)
 {
-	static int remaining;
-	uint8_t byte;
-	int ret;
-	static uint8_t hdr[4];
+	switch (H5_HDR_PKT_TYPE(hdr)) {
+	case HCI_EVENT_PKT:
+		h5.rx_buf = bt_buf_get_rx(K_NO_WAIT);
+		if (!h5.rx_buf) {
+			BT_WARN("No available event buffers");
+			return -ENOMEM;
+		}
 
-	ARG_UNUSED(unused);
+		bt_buf_set_type(h5.rx_buf, BT_BUF_EVT);
+		break;
+	case HCI_ACLDATA_PKT:
+		h5.rx_buf = bt_buf_get_rx(K_NO_WAIT);
+		if (!h5.rx_buf) {
+			BT_WARN("No available data buffers");
+			return -ENOMEM;
+		}
 
-	while (uart_irq_update(h5_dev) &&
-	       uart_irq_is_pending(h5_dev)) {
+		bt_buf_set_type(h5.rx_buf, BT_BUF_ACL_IN);
+		break;
+	case HCI_3WIRE_LINK_PKT:
+	case HCI_3WIRE_ACK_PKT:
+		h5.rx_buf = net_buf_alloc(&h5_pool, K_NO_WAIT);
+		if (!h5.rx_buf) {
+			BT_WARN("No available signal buffers");
+			return -ENOMEM;
+		}
+		break;
+	default:
+		BT_ERR("Wrong packet type %u", H5_HDR_PKT_TYPE(hdr));
+		return -EINVAL;
+	}
 
-		if (!uart_irq_rx_ready(h5_dev)) {
-			if (uart_irq_tx_ready(h5_dev)) {
-				BT_DBG("transmit ready");
-			} else {
-				BT_DBG("spurious interrupt");
-			}
-			/* Only the UART RX path is interrupt-enabled */
+	if (H5_HDR_LEN(hdr) > net_buf_tailroom(h5.rx_buf)) {
+		BT_ERR("Too long packet: len %u", H5_HDR_LEN(hdr));
+		return -EMSGSIZE;
+	}
+
+	return 0;
+}
+
+static void h5_rx_payload_done(void)
+{
+	if (H5_HDR_CRC(h5.rx_hdr)) {
+		h5.rx_state = CRC;
+		h5.rx_remaining = sizeof(h5.rx_crc_recv);
+	} else {
+		h5.rx_state = END;
+	}
+}
+
+/* Unslipped byte of a packet */
+static void h5_rx_byte(uint8_t byte)
+{
+	uint8_t *hdr = h5.rx_hdr;
+
+	switch (h5.rx_state) {
+	case START:
+		break;
+	case HEADER:
+		hdr[sizeof(h5.rx_hdr) - h5.rx_remaining--] = byte;
+		h5.rx_crc = h5_crc_update(h5.rx_crc, byte);
+		if (h5.rx_remaining) {
 			break;
 		}
 
-		ret = uart_fifo_read(h5_dev, &byte, sizeof(byte));
-		if (!ret) {
-			continue;
+		if (((hdr[0] + hdr[1] + hdr[2] + hdr[3]) & 0xff) != 0xff) {
+			BT_ERR("Invalid header checksum");
+			h5_reset_rx();
+			break;
 		}
 
-		switch (h5.rx_state) {
-		case START:
-			if (byte == SLIP_DELIMITER) {
-				h5.rx_state = HEADER;
-				remaining = sizeof(hdr);
-			}
+		if (h5_rx_alloc(hdr) < 0) {
+			h5_reset_rx();
 			break;
-		case HEADER:
-			/* In a case we confuse ending slip delimeter
-			 * with starting one.
-			 */
-			if (byte == SLIP_DELIMITER) {
-				remaining = sizeof(hdr);
-				continue;
-			}
+		}
 
-			if (h5_unslip_byte(&byte) < 0) {
-				h5_reset_rx();
-				continue;
-			}
+		h5.rx_remaining = H5_HDR_LEN(hdr);
+		if (h5.rx_remaining) {
+			h5.rx_state = PAYLOAD;
+		} else {
+			h5_rx_payload_done();
+		}
+		break;
+	case PAYLOAD:
+		net_buf_add_u8(h5.rx_buf, byte);
+		h5.rx_crc = h5_crc_update(h5.rx_crc, byte);
+		if (!--h5.rx_remaining) {
+			h5_rx_payload_done();
+		}
+		break;
+	case CRC:
+		h5.rx_crc_recv[sizeof(h5.rx_crc_recv) - h5.rx_remaining--] =
+			byte;
+		if (!h5.rx_remaining) {
+			h5.rx_state = END;
+		}
+		break;
+	case END:
+		BT_ERR("Missing ending SLIP_DELIMITER");
+		h5_reset_rx();
+		break;
+	}
+}
 
-			memcpy(&hdr[sizeof(hdr) - remaining], &byte, 1);
-			remaining--;
+static void h5_rx_start(void)
+{
+	h5.rx_state = HEADER;
+	h5.rx_remaining = sizeof(h5.rx_hdr);
+	h5.rx_crc = 0xffff;
+}
 
-			if (remaining) {
-				break;
-			}
+static void h5_rx_delimiter(void)
+{
+	uint8_t *hdr = h5.rx_hdr;
 
-			remaining = H5_HDR_LEN(hdr);
-
-			switch (H5_HDR_PKT_TYPE(hdr)) {
-			case HCI_EVENT_PKT:
-				h5.rx_buf = bt_buf_get_rx(K_NO_WAIT);
-				if (!h5.rx_buf) {
-					BT_WARN("No available event buffers");
-					h5_reset_rx();
-					continue;
-				}
-
-				bt_buf_set_type(h5.rx_buf, BT_BUF_EVT);
-				h5.rx_state = PAYLOAD;
-				break;
-			case HCI_ACLDATA_PKT:
-				h5.rx_buf = bt_buf_get_rx(K_NO_WAIT);
-				if (!h5.rx_buf) {
-					BT_WARN("No available data buffers");
-					h5_reset_rx();
-					continue;
-				}
-
-				bt_buf_set_type(h5.rx_buf, BT_BUF_ACL_IN);
-				h5.rx_state = PAYLOAD;
-				break;
-			case HCI_3WIRE_LINK_PKT:
-			case HCI_3WIRE_ACK_PKT:
-				h5.rx_buf = net_buf_alloc(&h5_pool, K_NO_WAIT);
-				if (!h5.rx_buf) {
-					BT_WARN("No available signal buffers");
-					h5_reset_rx();
-					continue;
-				}
-
-				h5.rx_state = PAYLOAD;
-				break;
-			default:
-				BT_ERR("Wrong packet type %u",
-				       H5_HDR_PKT_TYPE(hdr));
-				h5.rx_state = END;
-				break;
-			}
-			break;
-		case PAYLOAD:
-			if (h5_unslip_byte(&byte) < 0) {
-				h5_reset_rx();
-				continue;
-			}
+	switch (h5.rx_state) {
+	case START:
+		h5_rx_start();
+		return;
+	case HEADER:
+		/* In a case we confuse ending slip delimeter with starting
+		 * one.
+		 */
+		if (h5.rx_remaining == sizeof(h5.rx_hdr)) {
+			return;
+		}
+		/* Fall through */
+	case PAYLOAD:
+	case CRC:
+		BT_ERR("Truncated packet");
+		h5_reset_rx();
+		h5_rx_start();
+		return;
+	case END:
+		break;
+	}
 
-			net_buf_add_mem(h5.rx_buf, &byte, sizeof(byte));
-			remaining--;
-			if (!remaining) {
-				h5.rx_state = END;
-			}
+	BT_DBG("Received full packet: type %u", H5_HDR_PKT_TYPE(hdr));
+
+	if (H5_HDR_CRC(hdr) &&
+	    h5_crc_final(h5.rx_crc) != sys_get_be16(h5.rx_crc_recv)) {
+		BT_ERR("Invalid data integrity check. Drop packet");
+		h5_reset_rx();
+		h5_rx_start();
+		return;
+	}
+
+	/* Check when full packet is received, it can be done when parsing
+	 * packet header but we need to receive full packet anyway to clear
+	 * UART.
+	 */
+	if (H5_HDR_RELIABLE(hdr) && H5_HDR_SEQ(hdr) != h5.tx_ack) {
+		BT_ERR("Seq expected %u got %u. Drop packet", h5.tx_ack,
+		       H5_HDR_SEQ(hdr));
+		h5_reset_rx();
+		h5_rx_start();
+		return;
+	}
+
+	h5_process_complete_packet(hdr);
+
+	/* The delimiter may be shared with the next packet */
+	h5_rx_start();
+}
+
+static void h5_rx_slip(uint8_t byte)
+{
+	if (byte == SLIP_DELIMITER) {
+		h5.rx_flags &= ~H5_RX_ESC;
+		h5_rx_delimiter();
+		return;
+	}
+
+	if (h5.rx_state == START) {
+		return;
+	}
+
+	if (h5.rx_flags & H5_RX_ESC) {
+		h5.rx_flags &= ~H5_RX_ESC;
+
+		switch (byte) {
+		case SLIP_ESC_DELIM:
+			byte = SLIP_DELIMITER;
 			break;
-		case END:
-			if (byte != SLIP_DELIMITER) {
-				BT_ERR("Missing ending SLIP_DELIMITER");
-				h5_reset_rx();
-				break;
-			}
+		case SLIP_ESC_ESC:
+			byte = SLIP_ESC;
+			break;
+		default:
+			BT_ERR("Invalid escape byte %x", byte);
+			h5_reset_rx();
+			return;
+		}
+	} else if (byte == SLIP_ESC) {
+		h5.rx_flags |= H5_RX_ESC;
+		return;
+	}
 
-			BT_DBG("Received full packet: type %u",
-			       H5_HDR_PKT_TYPE(hdr));
+	h5_rx_byte(byte);
+}
 
-			/* Check when full packet is received, it can be done
-			 * when parsing packet header but we need to receive
-			 * full packet anyway to clear UART.
-			 */
-			if (H5_HDR_RELIABLE(hdr) &&
-			    H5_HDR_SEQ(hdr) != h5.tx_ack) {
-				BT_ERR("Seq expected %u got %u. Drop packet",
-				       h5.tx_ack, H5_HDR_SEQ(hdr));
-				h5_reset_rx();
-				break;
-			}
+static void bt_uart_isr(struct device *unused)
+{
+	uint8_t chunk[H5_RX_CHUNK_LEN];
+	int len, i;
+
+	ARG_UNUSED(unused);
+
+	while (uart_irq_update(h5_dev) &&
+	       uart_irq_is_pending(h5_dev)) {
 
-			h5_process_complete_packet(hdr);
-			h5.rx_state = START;
+		if (!uart_irq_rx_ready(h5_dev)) {
+			if (uart_irq_tx_ready(h5_dev)) {
+				BT_DBG("transmit ready");
+			} else {
+				BT_DBG("spurious interrupt");
+			}
+			/* Only the UART RX path is interrupt-enabled */
 			break;
 		}
+
+		/* Read what the FIFO holds at once, and parse it from
+		 * memory.
+		 */
+		len = uart_fifo_read(h5_dev, chunk, sizeof(chunk));
+		for (i = 0; i < len; i++) {
+			h5_rx_slip(chunk[i]);
+		}
 	}
 }
 
@@ -571,13 +700,19 @@ static int h5_queue(struct net_buf *buf)
 	return 0;
 }
 
+static void h5_set_txwin(uint8_t *conf)
+{
+	conf[2] = H5_CONF_WIN(h5.tx_win);
+
+	if (IS_ENABLED(CONFIG_BLUETOOTH_H5_CRC)) {
+		conf[2] |= H5_CONF_CRC;
+	}
+}
+
 static void tx_thread(void)
 {
 	BT_DBG("");
 
-	/* FIXME: make periodic sending */
-	h5_send(sync_req, HCI_3WIRE_LINK_PKT, sizeof(sync_req));
-
 	while (true) {
 		struct net_buf *buf;
 		uint8_t type;
@@ -586,14 +721,21 @@ static void tx_thread(void)
 
 		switch (h5.link_state) {
 		case UNINIT:
-			/* FIXME: send sync */
-			k_sleep(100);
+			/* Repeat until the peer answers */
+			h5_send(sync_req, HCI_3WIRE_LINK_PKT, sizeof(sync_req));
+			k_sleep(H5_LINK_TIMEOUT);
 			break;
 		case INIT:
-			/* FIXME: send conf */
-			k_sleep(100);
+			h5_set_txwin(conf_req);
+			h5_send(conf_req, HCI_3WIRE_LINK_PKT, sizeof(conf_req));
+			k_sleep(H5_LINK_TIMEOUT);
 			break;
 		case ACTIVE:
+			/* Wait for a free slot of the sliding window before
+			 * taking the packet, so that retransmissions queued
+			 * in the meantime go first.
+			 */
+			k_sem_take(&h5.tx_win_sem, K_FOREVER);
 			buf = net_buf_get(&h5.tx_queue, K_FOREVER);
 			type = h5_get_type(buf);
 
@@ -612,11 +754,6 @@ static void tx_thread(void)
 	}
 }
 
-static void h5_set_txwin(uint8_t *conf)
-{
-	conf[2] = h5.tx_win & 0x07;
-}
-
 static void rx_thread(void)
 {
 	BT_DBG("");
@@ -636,7 +773,8 @@ static void rx_thread(void)
 			h5_send(sync_rsp, HCI_3WIRE_LINK_PKT, sizeof(sync_rsp));
 		} else if (!memcmp(buf->data, sync_rsp, sizeof(sync_rsp))) {
 			if (h5.link_state == ACTIVE) {
-				/* TODO Reset H5 */
+				/* Answer to a repeated sync request */
+				goto next;
 			}
 
 			h5.link_state = INIT;
@@ -653,19 +791,28 @@ static void rx_thread(void)
 			h5_set_txwin(conf_req);
 			h5_send(conf_req, HCI_3WIRE_LINK_PKT, sizeof(conf_req));
 		} else if (!memcmp(buf->data, conf_rsp, 2)) {
-			h5.link_state = ACTIVE;
+			if (h5.link_state == ACTIVE) {
+				goto next;
+			}
+
 			if (buf->len > 2) {
 				/* Configuration field present */
-				h5.tx_win = (buf->data[2] & 0x07);
+				h5.tx_win = max(H5_CONF_WIN(buf->data[2]), 1);
+				h5.tx_crc = (buf->data[2] & H5_CONF_CRC) &&
+					IS_ENABLED(CONFIG_BLUETOOTH_H5_CRC);
 			}
 
-			BT_DBG("Finished H5 configuration, tx_win %u",
-			       h5.tx_win);
+			k_sem_init(&h5.tx_win_sem, h5.tx_win, h5.tx_win);
+			h5.link_state = ACTIVE;
+
+			BT_DBG("Finished H5 configuration, tx_win %u crc %u",
+			       h5.tx_win, h5.tx_crc);
 		} else {
 			BT_ERR("Not handled yet %x %x",
 			       buf->data[0], buf->data[1]);
 		}
 
+next:
 		net_buf_unref(buf);
 
 		/* Make sure we don't hog the CPU if the rx_queue never
@@ -682,6 +829,7 @@ static void h5_init(void)
 	h5.link_state = UNINIT;
 	h5.rx_state = START;
 	h5.tx_win = 4;
+	k_sem_init(&h5.tx_win_sem, 0, 8);
 
 	/* TX thread */
 	k_fifo_init(&h5.tx_queue);
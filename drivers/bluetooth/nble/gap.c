@@ -212,6 +212,17 @@ int bt_le_adv_stop(void)
 	return 0;
 }
 
+int bt_le_adv_set_start(uint8_t set, const struct bt_le_adv_param *param,
+			const struct bt_data *ad, size_t ad_len)
+{
+	return -ENOTSUP;
+}
+
+int bt_le_adv_set_stop(uint8_t set)
+{
+	return -ENOTSUP;
+}
+
 void on_nble_gap_stop_advertise_rsp(const struct nble_common_rsp *rsp)
 {
 	if (rsp->status) {
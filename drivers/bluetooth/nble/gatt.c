@@ -627,6 +627,23 @@ int bt_gatt_notify(struct bt_conn *conn, const struct bt_gatt_attr *attr,
 	return 0;
 }
 
+int bt_gatt_notify_multiple(struct bt_conn *conn,
+			    const struct bt_gatt_notify_params *params,
+			    size_t count)
+{
+	int err;
+
+	for (; count; params++, count--) {
+		err = bt_gatt_notify(conn, params->attr, params->data,
+				     params->len);
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
 int bt_gatt_indicate(struct bt_conn *conn,
 		     struct bt_gatt_indicate_params *params)
 {
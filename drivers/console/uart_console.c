@@ -11,6 +11,9 @@
  *
  * Serial console driver.
  * Hooks into the printk and fputc (for printf) modules. Poll driven.
+ *
+ * With the console input handler, the UART interrupt only queues the
+ * received bytes, a thread doing the line editing and the echo.
  */
 
 #include <kernel.h>
@@ -333,13 +336,117 @@ ansi_cmd:
 	atomic_clear_bit(&esc_state, ESC_ANSI);
 }
 
+/*
+ * Received bytes, from the interrupt handler to the input thread. Single
+ * producer and single consumer: each index is only written by one side.
+ */
+static uint8_t rx_ring[CONFIG_CONSOLE_INPUT_RING_SIZE];
+static volatile uint32_t rx_head, rx_tail;
+static K_SEM_DEFINE(rx_sem, 0, 1);
+
+/* The indexes wrap around with the ring when its size is a power of 2 */
+BUILD_ASSERT(!(CONFIG_CONSOLE_INPUT_RING_SIZE &
+	       (CONFIG_CONSOLE_INPUT_RING_SIZE - 1)));
+
+static char __stack input_thread_stack[CONFIG_CONSOLE_INPUT_THREAD_STACK_SIZE];
+
+static void handle_byte(uint8_t byte)
+{
+	static struct uart_console_input *cmd;
+
+	if (!cmd) {
+		cmd = k_fifo_get(avail_queue, K_NO_WAIT);
+		if (!cmd) {
+			return;
+		}
+	}
+
+	/* Handle ANSI escape mode */
+	if (atomic_test_bit(&esc_state, ESC_ANSI)) {
+		handle_ansi(byte, cmd->line);
+		return;
+	}
+
+	/* Handle escape mode */
+	if (atomic_test_and_clear_bit(&esc_state, ESC_ESC)) {
+		switch (byte) {
+		case ANSI_ESC:
+			atomic_set_bit(&esc_state, ESC_ANSI);
+			atomic_set_bit(&esc_state, ESC_ANSI_FIRST);
+			break;
+		default:
+			break;
+		}
+
+		return;
+	}
+
+	/* Handle special control characters */
+	if (!isprint(byte)) {
+		switch (byte) {
+		case DEL:
+			if (cur > 0) {
+				del_char(&cmd->line[--cur], end);
+			}
+			break;
+		case ESC:
+			atomic_set_bit(&esc_state, ESC_ESC);
+			break;
+		case '\r':
+			cmd->line[cur + end] = '\0';
+			uart_poll_out(uart_console_dev, '\r');
+			uart_poll_out(uart_console_dev, '\n');
+			cur = 0;
+			end = 0;
+			k_fifo_put(lines_queue, cmd);
+			cmd = NULL;
+			break;
+		case '\t':
+			if (completion_cb && !end) {
+				cur += completion_cb(cmd->line, cur);
+			}
+			break;
+		default:
+			break;
+		}
+
+		return;
+	}
+
+	/* Ignore characters if there's no more buffer space */
+	if (cur + end < sizeof(cmd->line) - 1) {
+		insert_char(&cmd->line[cur++], byte, end);
+	}
+}
+
+/* Line editing and echo, out of the interrupt handler */
+static void input_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&rx_sem, K_FOREVER);
+
+		while (rx_tail != rx_head) {
+			uint8_t byte;
+
+			byte = rx_ring[rx_tail &
+				       (CONFIG_CONSOLE_INPUT_RING_SIZE - 1)];
+			rx_tail++;
+
+			handle_byte(byte);
+		}
+	}
+}
+
 void uart_console_isr(struct device *unused)
 {
 	ARG_UNUSED(unused);
 
 	while (uart_irq_update(uart_console_dev) &&
 	       uart_irq_is_pending(uart_console_dev)) {
-		static struct uart_console_input *cmd;
 		uint8_t byte;
 		int rx;
 
@@ -364,68 +471,15 @@ void uart_console_isr(struct device *unused)
 		}
 #endif
 
-		if (!cmd) {
-			cmd = k_fifo_get(avail_queue, K_NO_WAIT);
-			if (!cmd)
-				return;
-		}
-
-		/* Handle ANSI escape mode */
-		if (atomic_test_bit(&esc_state, ESC_ANSI)) {
-			handle_ansi(byte, cmd->line);
+		/* Dropped if the input thread falls that much behind */
+		if (rx_head - rx_tail == CONFIG_CONSOLE_INPUT_RING_SIZE) {
 			continue;
 		}
 
-		/* Handle escape mode */
-		if (atomic_test_and_clear_bit(&esc_state, ESC_ESC)) {
-			switch (byte) {
-			case ANSI_ESC:
-				atomic_set_bit(&esc_state, ESC_ANSI);
-				atomic_set_bit(&esc_state, ESC_ANSI_FIRST);
-				break;
-			default:
-				break;
-			}
-
-			continue;
-		}
+		rx_ring[rx_head & (CONFIG_CONSOLE_INPUT_RING_SIZE - 1)] = byte;
+		rx_head++;
 
-		/* Handle special control characters */
-		if (!isprint(byte)) {
-			switch (byte) {
-			case DEL:
-				if (cur > 0) {
-					del_char(&cmd->line[--cur], end);
-				}
-				break;
-			case ESC:
-				atomic_set_bit(&esc_state, ESC_ESC);
-				break;
-			case '\r':
-				cmd->line[cur + end] = '\0';
-				uart_poll_out(uart_console_dev, '\r');
-				uart_poll_out(uart_console_dev, '\n');
-				cur = 0;
-				end = 0;
-				k_fifo_put(lines_queue, cmd);
-				cmd = NULL;
-				break;
-			case '\t':
-				if (completion_cb && !end) {
-					cur += completion_cb(cmd->line, cur);
-				}
-				break;
-			default:
-				break;
-			}
-
-			continue;
-		}
-
-		/* Ignore characters if there's no more buffer space */
-		if (cur + end < sizeof(cmd->line) - 1) {
-			insert_char(&cmd->line[cur++], byte, end);
-		}
+		k_sem_give(&rx_sem);
 	}
 }
 
@@ -453,6 +507,11 @@ void uart_register_input(struct k_fifo *avail, struct k_fifo *lines,
 	lines_queue = lines;
 	completion_cb = completion;
 
+	k_thread_spawn(input_thread_stack, sizeof(input_thread_stack),
+		       input_thread, NULL, NULL, NULL,
+		       K_PRIO_PREEMPT(CONFIG_CONSOLE_INPUT_THREAD_PRIORITY), 0,
+		       K_NO_WAIT);
+
 	console_input_init();
 }
 
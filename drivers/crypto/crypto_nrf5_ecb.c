@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Crypto device for the nRF5 AES ECB peripheral
+ *
+ * The peripheral only encrypts single AES-128 blocks, which gives ECB
+ * encryption and CTR mode in both directions. Packets of asynchronous
+ * sessions are queued and ciphered block per block from the ECB
+ * interrupt, the next packet being started before the completion callback
+ * of the previous one. Synchronous operations poll the peripheral when no
+ * packet is queued.
+ */
+
+#include <kernel.h>
+#include <init.h>
+#include <string.h>
+#include <soc.h>
+#include <misc/slist.h>
+#include <misc/byteorder.h>
+#include <crypto/cipher.h>
+
+#define SYS_LOG_DOMAIN "crypto/nrf5_ecb"
+#define SYS_LOG_LEVEL CONFIG_SYS_LOG_CRYPTO_LEVEL
+#include <logging/sys_log.h>
+
+struct ecb_nrf5_data {
+	/* Data structure pointed to by ECBDATAPTR */
+	struct {
+		uint8_t key[CRYPTO_AES_BLOCK_SIZE];
+		uint8_t clear_text[CRYPTO_AES_BLOCK_SIZE];
+		uint8_t cipher_text[CRYPTO_AES_BLOCK_SIZE];
+	} __packed ecb;
+	/* Packets of asynchronous sessions, the head one being ciphered */
+	sys_slist_t queue;
+	/* Bytes of the head packet already ciphered */
+	int offset;
+	/* Set while a synchronous operation uses the peripheral */
+	int polling;
+};
+
+static struct ecb_nrf5_data ecb_nrf5_dev_data;
+
+static struct cipher_pkt *ecb_nrf5_head(struct ecb_nrf5_data *data)
+{
+	sys_snode_t *node = sys_slist_peek_head(&data->queue);
+
+	return node ? CONTAINER_OF(node, struct cipher_pkt, node) : NULL;
+}
+
+static uint32_t ecb_nrf5_query_hw_caps(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return CRYPTO_CAP_SYNC_OPS | CRYPTO_CAP_ASYNC_OPS |
+	       CRYPTO_CAP_AES_ECB | CRYPTO_CAP_AES_CTR;
+}
+
+static int ecb_nrf5_begin_session(struct device *dev, struct cipher_ctx *ctx)
+{
+	ARG_UNUSED(dev);
+
+	if (ctx->keylen != CRYPTO_AES_BLOCK_SIZE) {
+		return -EINVAL;
+	}
+
+	switch (ctx->mode) {
+	case CRYPTO_CIPHER_MODE_ECB:
+		if (ctx->op != CRYPTO_CIPHER_OP_ENCRYPT) {
+			return -ENOTSUP;
+		}
+		break;
+	case CRYPTO_CIPHER_MODE_CTR:
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	/* The key is loaded for each block, there is no session state */
+	ctx->drv_sessn_state = NULL;
+
+	return 0;
+}
+
+static int ecb_nrf5_free_session(struct device *dev, struct cipher_ctx *ctx)
+{
+	struct ecb_nrf5_data *data = dev->driver_data;
+	sys_snode_t *node;
+	unsigned int key;
+	int ret = 0;
+
+	key = irq_lock();
+	SYS_SLIST_FOR_EACH_NODE(&data->queue, node) {
+		if (CONTAINER_OF(node, struct cipher_pkt, node)->ctx == ctx) {
+			ret = -EBUSY;
+			break;
+		}
+	}
+	irq_unlock(key);
+
+	return ret;
+}
+
+static void ecb_nrf5_block_start(struct ecb_nrf5_data *data,
+				 struct cipher_pkt *pkt)
+{
+	memcpy(data->ecb.key, pkt->ctx->key, CRYPTO_AES_BLOCK_SIZE);
+
+	if (pkt->ctx->mode == CRYPTO_CIPHER_MODE_ECB) {
+		memcpy(data->ecb.clear_text, &pkt->in_buf[data->offset],
+		       CRYPTO_AES_BLOCK_SIZE);
+	} else {
+		memcpy(data->ecb.clear_text, pkt->iv, CRYPTO_AES_BLOCK_SIZE);
+	}
+
+	NRF_ECB->ECBDATAPTR = (uint32_t)&data->ecb;
+	NRF_ECB->EVENTS_ENDECB = 0;
+	NRF_ECB->EVENTS_ERRORECB = 0;
+	NRF_ECB->TASKS_STARTECB = 1;
+}
+
+static void ecb_nrf5_block_end(struct ecb_nrf5_data *data,
+			       struct cipher_pkt *pkt)
+{
+	uint8_t *out = &pkt->out_buf[data->offset];
+	const uint8_t *in = &pkt->in_buf[data->offset];
+	int len = min(pkt->in_len - data->offset, CRYPTO_AES_BLOCK_SIZE);
+	uint32_t counter;
+	int i;
+
+	if (pkt->ctx->mode == CRYPTO_CIPHER_MODE_ECB) {
+		memcpy(out, data->ecb.cipher_text, CRYPTO_AES_BLOCK_SIZE);
+	} else {
+		for (i = 0; i < len; i++) {
+			out[i] = in[i] ^ data->ecb.cipher_text[i];
+		}
+
+		counter = sys_get_be32(&pkt->iv[12]) + 1;
+		sys_put_be32(counter, &pkt->iv[12]);
+	}
+
+	data->offset += len;
+}
+
+static int ecb_nrf5_check(struct cipher_pkt *pkt)
+{
+	if (pkt->out_buf_max < pkt->in_len) {
+		return -EINVAL;
+	}
+
+	if (pkt->ctx->mode == CRYPTO_CIPHER_MODE_ECB &&
+	    pkt->in_len % CRYPTO_AES_BLOCK_SIZE) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int ecb_nrf5_poll(struct ecb_nrf5_data *data, struct cipher_pkt *pkt)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	if (!sys_slist_is_empty(&data->queue)) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+	data->polling = 1;
+	irq_unlock(key);
+
+	NRF_ECB->INTENCLR = ECB_INTENCLR_ENDECB_Msk | ECB_INTENCLR_ERRORECB_Msk;
+
+	data->offset = 0;
+	while (data->offset < pkt->in_len) {
+		ecb_nrf5_block_start(data, pkt);
+
+		while (!NRF_ECB->EVENTS_ENDECB && !NRF_ECB->EVENTS_ERRORECB) {
+		}
+
+		/* Aborted by a higher priority user, done again */
+		if (NRF_ECB->EVENTS_ERRORECB) {
+			continue;
+		}
+
+		ecb_nrf5_block_end(data, pkt);
+	}
+
+	pkt->out_len = pkt->in_len;
+
+	key = irq_lock();
+	data->polling = 0;
+	data->offset = 0;
+	/* Packets queued meanwhile */
+	if (!sys_slist_is_empty(&data->queue)) {
+		NRF_ECB->INTENSET = ECB_INTENSET_ENDECB_Msk |
+				    ECB_INTENSET_ERRORECB_Msk;
+		ecb_nrf5_block_start(data, ecb_nrf5_head(data));
+	}
+	irq_unlock(key);
+
+	return 0;
+}
+
+static int ecb_nrf5_queue(struct ecb_nrf5_data *data, struct cipher_pkt *pkts,
+			  int count)
+{
+	unsigned int key;
+	int idle, i, ret;
+
+	for (i = 0; i < count; i++) {
+		ret = ecb_nrf5_check(&pkts[i]);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	key = irq_lock();
+	idle = !data->polling && sys_slist_is_empty(&data->queue);
+
+	for (i = 0; i < count; i++) {
+		/* Nothing to cipher, completed at once */
+		if (!pkts[i].in_len) {
+			pkts[i].out_len = 0;
+			pkts[i].ctx->cb(&pkts[i], 0);
+			continue;
+		}
+
+		sys_slist_append(&data->queue, &pkts[i].node);
+	}
+
+	if (idle && !sys_slist_is_empty(&data->queue)) {
+		data->offset = 0;
+		NRF_ECB->INTENSET = ECB_INTENSET_ENDECB_Msk |
+				    ECB_INTENSET_ERRORECB_Msk;
+		ecb_nrf5_block_start(data, ecb_nrf5_head(data));
+	}
+	irq_unlock(key);
+
+	return 0;
+}
+
+static int ecb_nrf5_cipher(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	struct ecb_nrf5_data *data = ctx->device->driver_data;
+	int ret;
+
+	if (ctx->cb) {
+		return ecb_nrf5_queue(data, pkt, 1);
+	}
+
+	ret = ecb_nrf5_check(pkt);
+	if (ret) {
+		return ret;
+	}
+
+	return ecb_nrf5_poll(data, pkt);
+}
+
+static int ecb_nrf5_cipher_batch(struct cipher_ctx *ctx,
+				 struct cipher_pkt *pkts, int count)
+{
+	struct ecb_nrf5_data *data = ctx->device->driver_data;
+	int i, ret;
+
+	if (ctx->cb) {
+		return ecb_nrf5_queue(data, pkts, count);
+	}
+
+	for (i = 0; i < count; i++) {
+		ret = ecb_nrf5_cipher(ctx, &pkts[i]);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static void ecb_nrf5_isr(void *arg)
+{
+	struct device *dev = arg;
+	struct ecb_nrf5_data *data = dev->driver_data;
+	struct cipher_pkt *pkt, *next;
+
+	pkt = ecb_nrf5_head(data);
+	if (!pkt) {
+		NRF_ECB->EVENTS_ENDECB = 0;
+		NRF_ECB->EVENTS_ERRORECB = 0;
+		return;
+	}
+
+	/* Aborted by a higher priority user, done again */
+	if (NRF_ECB->EVENTS_ERRORECB) {
+		ecb_nrf5_block_start(data, pkt);
+		return;
+	}
+
+	NRF_ECB->EVENTS_ENDECB = 0;
+	ecb_nrf5_block_end(data, pkt);
+
+	if (data->offset < pkt->in_len) {
+		ecb_nrf5_block_start(data, pkt);
+		return;
+	}
+
+	sys_slist_get(&data->queue);
+	pkt->out_len = pkt->in_len;
+	data->offset = 0;
+
+	/* Keep the peripheral busy while the callback runs */
+	next = ecb_nrf5_head(data);
+	if (next) {
+		ecb_nrf5_block_start(data, next);
+	} else {
+		NRF_ECB->INTENCLR = ECB_INTENCLR_ENDECB_Msk |
+				    ECB_INTENCLR_ERRORECB_Msk;
+	}
+
+	pkt->ctx->cb(pkt, 0);
+}
+
+static const struct crypto_driver_api ecb_nrf5_api = {
+	.query_hw_caps = ecb_nrf5_query_hw_caps,
+	.cipher_begin_session = ecb_nrf5_begin_session,
+	.cipher_free_session = ecb_nrf5_free_session,
+	.cipher = ecb_nrf5_cipher,
+	.cipher_batch = ecb_nrf5_cipher_batch,
+};
+
+static int ecb_nrf5_init(struct device *dev);
+
+DEVICE_AND_API_INIT(crypto_nrf5_ecb, CONFIG_CRYPTO_NRF5_ECB_DRV_NAME,
+		    ecb_nrf5_init, &ecb_nrf5_dev_data, NULL, POST_KERNEL,
+		    CONFIG_CRYPTO_INIT_PRIORITY, &ecb_nrf5_api);
+
+static int ecb_nrf5_init(struct device *dev)
+{
+	struct ecb_nrf5_data *data = dev->driver_data;
+
+	sys_slist_init(&data->queue);
+
+	NRF_ECB->TASKS_STOPECB = 1;
+	NRF_ECB->INTENCLR = ECB_INTENCLR_ENDECB_Msk | ECB_INTENCLR_ERRORECB_Msk;
+
+	IRQ_CONNECT(NRF5_IRQ_ECB_IRQn, CONFIG_CRYPTO_NRF5_ECB_PRI,
+		    ecb_nrf5_isr, DEVICE_GET(crypto_nrf5_ecb), 0);
+	irq_enable(NRF5_IRQ_ECB_IRQn);
+
+	SYS_LOG_DBG("");
+
+	return 0;
+}
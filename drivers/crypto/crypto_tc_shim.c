@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Software crypto device backed by TinyCrypt
+ *
+ * Operations run in the caller context, the completion callback of
+ * asynchronous sessions being called before returning, so any code using
+ * the crypto driver API works without a crypto engine.
+ */
+
+#include <kernel.h>
+#include <init.h>
+#include <string.h>
+#include <drivers/rand32.h>
+#include <crypto/cipher.h>
+#include <crypto/hash.h>
+#include <crypto/ecc.h>
+
+#include <tinycrypt/constants.h>
+#include <tinycrypt/aes.h>
+#include <tinycrypt/ctr_mode.h>
+#include <tinycrypt/ccm_mode.h>
+#include <tinycrypt/sha256.h>
+#include <tinycrypt/ecc.h>
+#include <tinycrypt/ecc_dh.h>
+
+#define SYS_LOG_DOMAIN "crypto/tc"
+#define SYS_LOG_LEVEL CONFIG_SYS_LOG_CRYPTO_LEVEL
+#include <logging/sys_log.h>
+
+struct tc_cipher_sessn {
+	struct tc_aes_key_sched_struct sched;
+	int in_use;
+};
+
+struct tc_hash_sessn {
+	struct tc_sha256_state_struct state;
+	int in_use;
+};
+
+static struct tc_cipher_sessn
+	tc_cipher_sessns[CONFIG_CRYPTO_TINYCRYPT_SHIM_MAX_SESSION];
+static struct tc_hash_sessn
+	tc_hash_sessns[CONFIG_CRYPTO_TINYCRYPT_SHIM_MAX_SESSION];
+
+static uint32_t tc_query_hw_caps(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return CRYPTO_CAP_SYNC_OPS | CRYPTO_CAP_AES_ECB | CRYPTO_CAP_AES_CTR |
+	       CRYPTO_CAP_AES_CCM | CRYPTO_CAP_AES_DECRYPT |
+	       CRYPTO_CAP_SHA256 | CRYPTO_CAP_ECC_P256;
+}
+
+static int tc_cipher_begin_session(struct device *dev, struct cipher_ctx *ctx)
+{
+	struct tc_cipher_sessn *sessn = NULL;
+	unsigned int key;
+	int ret, i;
+
+	ARG_UNUSED(dev);
+
+	if (ctx->keylen != TC_AES_KEY_SIZE) {
+		return -EINVAL;
+	}
+
+	if (ctx->mode == CRYPTO_CIPHER_MODE_CCM &&
+	    (ctx->nonce_len != 13 || ctx->tag_len < 4 || ctx->tag_len > 16 ||
+	     ctx->tag_len & 1)) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+	for (i = 0; i < ARRAY_SIZE(tc_cipher_sessns); i++) {
+		if (!tc_cipher_sessns[i].in_use) {
+			sessn = &tc_cipher_sessns[i];
+			sessn->in_use = 1;
+			break;
+		}
+	}
+	irq_unlock(key);
+
+	if (!sessn) {
+		return -ENOMEM;
+	}
+
+	/* Only ECB decryption uses the inverse cipher */
+	if (ctx->mode == CRYPTO_CIPHER_MODE_ECB &&
+	    ctx->op == CRYPTO_CIPHER_OP_DECRYPT) {
+		ret = tc_aes128_set_decrypt_key(&sessn->sched, ctx->key);
+	} else {
+		ret = tc_aes128_set_encrypt_key(&sessn->sched, ctx->key);
+	}
+
+	if (ret == TC_CRYPTO_FAIL) {
+		sessn->in_use = 0;
+		return -EINVAL;
+	}
+
+	ctx->drv_sessn_state = sessn;
+
+	return 0;
+}
+
+static int tc_cipher_free_session(struct device *dev, struct cipher_ctx *ctx)
+{
+	struct tc_cipher_sessn *sessn = ctx->drv_sessn_state;
+
+	ARG_UNUSED(dev);
+
+	memset(&sessn->sched, 0, sizeof(sessn->sched));
+	sessn->in_use = 0;
+
+	return 0;
+}
+
+static int tc_ecb(struct cipher_ctx *ctx, struct cipher_pkt *pkt,
+		  TCAesKeySched_t sched)
+{
+	int i, ret;
+
+	if (pkt->in_len % TC_AES_BLOCK_SIZE || pkt->out_buf_max < pkt->in_len) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < pkt->in_len; i += TC_AES_BLOCK_SIZE) {
+		if (ctx->op == CRYPTO_CIPHER_OP_ENCRYPT) {
+			ret = tc_aes_encrypt(&pkt->out_buf[i], &pkt->in_buf[i],
+					     sched);
+		} else {
+			ret = tc_aes_decrypt(&pkt->out_buf[i], &pkt->in_buf[i],
+					     sched);
+		}
+
+		if (ret == TC_CRYPTO_FAIL) {
+			return -EIO;
+		}
+	}
+
+	pkt->out_len = pkt->in_len;
+
+	return 0;
+}
+
+static int tc_ctr(struct cipher_pkt *pkt, TCAesKeySched_t sched)
+{
+	if (pkt->out_buf_max < pkt->in_len) {
+		return -EINVAL;
+	}
+
+	if (pkt->in_len &&
+	    tc_ctr_mode(pkt->out_buf, pkt->in_len, pkt->in_buf, pkt->in_len,
+			pkt->iv, sched) == TC_CRYPTO_FAIL) {
+		return -EIO;
+	}
+
+	pkt->out_len = pkt->in_len;
+
+	return 0;
+}
+
+static int tc_ccm(struct cipher_ctx *ctx, struct cipher_pkt *pkt,
+		  TCAesKeySched_t sched)
+{
+	struct tc_ccm_mode_struct ccm;
+	int out_len;
+
+	if (ctx->op == CRYPTO_CIPHER_OP_ENCRYPT) {
+		out_len = pkt->in_len + ctx->tag_len;
+	} else {
+		out_len = pkt->in_len - ctx->tag_len;
+	}
+
+	if (out_len < 0 || pkt->out_buf_max < out_len) {
+		return -EINVAL;
+	}
+
+	if (tc_ccm_config(&ccm, sched, pkt->iv, ctx->nonce_len,
+			  ctx->tag_len) == TC_CRYPTO_FAIL) {
+		return -EINVAL;
+	}
+
+	if (ctx->op == CRYPTO_CIPHER_OP_ENCRYPT) {
+		if (tc_ccm_generation_encryption(pkt->out_buf, pkt->ad,
+						 pkt->ad_len, pkt->in_buf,
+						 pkt->in_len,
+						 &ccm) == TC_CRYPTO_FAIL) {
+			return -EIO;
+		}
+	} else {
+		if (tc_ccm_decryption_verification(pkt->out_buf, pkt->ad,
+						   pkt->ad_len, pkt->in_buf,
+						   pkt->in_len,
+						   &ccm) == TC_CRYPTO_FAIL) {
+			return -EBADMSG;
+		}
+	}
+
+	pkt->out_len = out_len;
+
+	return 0;
+}
+
+static int tc_cipher(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	struct tc_cipher_sessn *sessn = ctx->drv_sessn_state;
+	int ret;
+
+	switch (ctx->mode) {
+	case CRYPTO_CIPHER_MODE_ECB:
+		ret = tc_ecb(ctx, pkt, &sessn->sched);
+		break;
+	case CRYPTO_CIPHER_MODE_CTR:
+		ret = tc_ctr(pkt, &sessn->sched);
+		break;
+	case CRYPTO_CIPHER_MODE_CCM:
+		ret = tc_ccm(ctx, pkt, &sessn->sched);
+		break;
+	default:
+		ret = -ENOTSUP;
+		break;
+	}
+
+	if (ctx->cb) {
+		ctx->cb(pkt, ret);
+		return 0;
+	}
+
+	return ret;
+}
+
+static int tc_hash_begin_session(struct device *dev, struct hash_ctx *ctx)
+{
+	struct tc_hash_sessn *sessn = NULL;
+	unsigned int key;
+	int i;
+
+	ARG_UNUSED(dev);
+
+	if (ctx->algo != CRYPTO_HASH_ALGO_SHA256) {
+		return -ENOTSUP;
+	}
+
+	key = irq_lock();
+	for (i = 0; i < ARRAY_SIZE(tc_hash_sessns); i++) {
+		if (!tc_hash_sessns[i].in_use) {
+			sessn = &tc_hash_sessns[i];
+			sessn->in_use = 1;
+			break;
+		}
+	}
+	irq_unlock(key);
+
+	if (!sessn) {
+		return -ENOMEM;
+	}
+
+	tc_sha256_init(&sessn->state);
+	ctx->drv_sessn_state = sessn;
+
+	return 0;
+}
+
+static int tc_hash_free_session(struct device *dev, struct hash_ctx *ctx)
+{
+	struct tc_hash_sessn *sessn = ctx->drv_sessn_state;
+
+	ARG_UNUSED(dev);
+
+	memset(&sessn->state, 0, sizeof(sessn->state));
+	sessn->in_use = 0;
+
+	return 0;
+}
+
+static int tc_hash(struct hash_ctx *ctx, struct hash_pkt *pkt, int finish)
+{
+	struct tc_hash_sessn *sessn = ctx->drv_sessn_state;
+	int ret = 0;
+
+	if (pkt->in_len &&
+	    tc_sha256_update(&sessn->state, pkt->in_buf,
+			     pkt->in_len) == TC_CRYPTO_FAIL) {
+		ret = -EIO;
+	} else if (finish) {
+		if (tc_sha256_final(pkt->out_buf,
+				    &sessn->state) == TC_CRYPTO_FAIL) {
+			ret = -EIO;
+		}
+
+		tc_sha256_init(&sessn->state);
+	}
+
+	if (ctx->cb) {
+		ctx->cb(pkt, ret);
+		return 0;
+	}
+
+	return ret;
+}
+
+static int tc_ecc_gen_key(struct device *dev, struct ecc_pkt *pkt)
+{
+	uint32_t random[NUM_ECC_DIGITS];
+	uint32_t private_key[NUM_ECC_DIGITS];
+	EccPoint public_key;
+	int ret = 0;
+	int i;
+
+	ARG_UNUSED(dev);
+
+	for (i = 0; i < NUM_ECC_DIGITS; i++) {
+		random[i] = sys_rand32_get();
+	}
+
+	if (ecc_make_key(&public_key, private_key, random) == TC_CRYPTO_FAIL) {
+		ret = -EIO;
+	} else {
+		ecc_native2bytes(pkt->private_key, private_key);
+		ecc_native2bytes(pkt->public_key, public_key.x);
+		ecc_native2bytes(&pkt->public_key[NUM_ECC_BYTES],
+				 public_key.y);
+	}
+
+	memset(private_key, 0, sizeof(private_key));
+	memset(random, 0, sizeof(random));
+
+	if (pkt->cb) {
+		pkt->cb(pkt, ret);
+		return 0;
+	}
+
+	return ret;
+}
+
+static int tc_ecc_dh(struct device *dev, struct ecc_pkt *pkt)
+{
+	uint32_t secret[NUM_ECC_DIGITS];
+	uint32_t private_key[NUM_ECC_DIGITS];
+	EccPoint public_key;
+	int ret = 0;
+
+	ARG_UNUSED(dev);
+
+	ecc_bytes2native(public_key.x, pkt->public_key);
+	ecc_bytes2native(public_key.y, &pkt->public_key[NUM_ECC_BYTES]);
+	ecc_bytes2native(private_key, pkt->private_key);
+
+	if (ecc_valid_public_key(&public_key) < 0) {
+		ret = -EINVAL;
+	} else if (ecdh_shared_secret(secret, &public_key,
+				      private_key) == TC_CRYPTO_FAIL) {
+		ret = -EIO;
+	} else {
+		ecc_native2bytes(pkt->secret, secret);
+	}
+
+	memset(private_key, 0, sizeof(private_key));
+	memset(secret, 0, sizeof(secret));
+
+	if (pkt->cb) {
+		pkt->cb(pkt, ret);
+		return 0;
+	}
+
+	return ret;
+}
+
+static const struct crypto_driver_api tc_crypto_api = {
+	.query_hw_caps = tc_query_hw_caps,
+	.cipher_begin_session = tc_cipher_begin_session,
+	.cipher_free_session = tc_cipher_free_session,
+	.cipher = tc_cipher,
+	.hash_begin_session = tc_hash_begin_session,
+	.hash_free_session = tc_hash_free_session,
+	.hash = tc_hash,
+	.ecc_gen_key = tc_ecc_gen_key,
+	.ecc_dh = tc_ecc_dh,
+};
+
+static int tc_crypto_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	SYS_LOG_DBG("%d sessions", CONFIG_CRYPTO_TINYCRYPT_SHIM_MAX_SESSION);
+
+	return 0;
+}
+
+DEVICE_AND_API_INIT(crypto_tinycrypt, CONFIG_CRYPTO_TINYCRYPT_SHIM_DRV_NAME,
+		    tc_crypto_init, NULL, NULL, POST_KERNEL,
+		    CONFIG_CRYPTO_INIT_PRIORITY, &tc_crypto_api);
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Kinetis eDMA driver
+ *
+ * Chained transfers are made of transfer control descriptors (TCDs) the
+ * controller loads one after the other by itself (scatter/gather). The
+ * peripheral requests are routed to the channels through the DMAMUX,
+ * DMAMUX channel n feeding eDMA channel n.
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <dma.h>
+#include <soc.h>
+#include <fsl_edma.h>
+#include <fsl_dmamux.h>
+
+#define DMA_MCUX_CHANNELS FSL_FEATURE_EDMA_MODULE_CHANNEL
+
+/* CITER is 15 bits with channel linking disabled */
+#define DMA_MCUX_MAX_ITEMS 0x7fff
+
+struct dma_mcux_channel {
+	struct device *dev;
+	uint32_t index;
+	void (*transfer)(struct device *dev, void *data);
+	void (*error)(struct device *dev, void *data);
+	void *callback_data;
+	enum dma_channel_direction direction;
+	enum dma_transfer_type transfer_type;
+	edma_transfer_size_t source_size;
+	edma_transfer_size_t destination_size;
+	uint8_t source_bytes;
+	uint8_t destination_bytes;
+	/* Number of configured blocks */
+	uint8_t blocks;
+};
+
+struct dma_mcux_driver_data {
+	struct dma_mcux_channel channel[DMA_MCUX_CHANNELS];
+};
+
+/* Descriptors of the chained blocks, loaded by the controller */
+static edma_tcd_t dma_mcux_tcd[DMA_MCUX_CHANNELS]
+			      [CONFIG_DMA_MCUX_EDMA_MAX_BLOCKS] __aligned(32);
+
+static int dma_mcux_width(enum dma_transfer_width width,
+			  edma_transfer_size_t *size, uint8_t *bytes)
+{
+	switch (width) {
+	case TRANS_WIDTH_8:
+		*size = kEDMA_TransferSize1Bytes;
+		*bytes = 1;
+		break;
+	case TRANS_WIDTH_16:
+		*size = kEDMA_TransferSize2Bytes;
+		*bytes = 2;
+		break;
+	case TRANS_WIDTH_32:
+		*size = kEDMA_TransferSize4Bytes;
+		*bytes = 4;
+		break;
+	case TRANS_WIDTH_128:
+		*size = kEDMA_TransferSize16Bytes;
+		*bytes = 16;
+		break;
+	case TRANS_WIDTH_256:
+		*size = kEDMA_TransferSize32Bytes;
+		*bytes = 32;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int dma_mcux_channel_config(struct device *dev, uint32_t channel,
+				   struct dma_channel_config *config)
+{
+	struct dma_mcux_driver_data *data = dev->driver_data;
+	struct dma_mcux_channel *chan;
+	int ret;
+
+	if (channel >= DMA_MCUX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &data->channel[channel];
+
+	ret = dma_mcux_width(config->source_transfer_width,
+			     &chan->source_size, &chan->source_bytes);
+	if (ret) {
+		return ret;
+	}
+
+	ret = dma_mcux_width(config->destination_transfer_width,
+			     &chan->destination_size,
+			     &chan->destination_bytes);
+	if (ret) {
+		return ret;
+	}
+
+	chan->direction = config->channel_direction;
+	chan->transfer_type = config->transfer_type;
+	chan->transfer = config->dma_transfer;
+	chan->error = config->dma_error;
+	chan->callback_data = config->callback_data;
+
+	EDMA_DisableChannelRequest(DMA0, channel);
+	DMAMUX_DisableChannel(DMAMUX0, channel);
+
+	/* Memory to memory transfers are started by software */
+	if (chan->direction != MEMORY_TO_MEMORY) {
+		DMAMUX_SetSource(DMAMUX0, channel,
+				 config->handshake_interface & 0xff);
+		DMAMUX_EnableChannel(DMAMUX0, channel);
+	}
+
+	EDMA_EnableChannelInterrupts(DMA0, channel,
+				     kEDMA_ErrorInterruptEnable);
+
+	return 0;
+}
+
+static int dma_mcux_tcd_fill(struct dma_mcux_channel *chan,
+			     struct dma_block_config *block,
+			     edma_transfer_config_t *xfer)
+{
+	uint8_t bytes = max(chan->source_bytes, chan->destination_bytes);
+
+	if (!block->block_size || block->block_size % bytes) {
+		return -EINVAL;
+	}
+
+	xfer->srcAddr = (uint32_t)block->source_address;
+	xfer->destAddr = (uint32_t)block->destination_address;
+	xfer->srcTransferSize = chan->source_size;
+	xfer->destTransferSize = chan->destination_size;
+	xfer->srcOffset = chan->direction == PERIPHERAL_TO_MEMORY ?
+			  0 : chan->source_bytes;
+	xfer->destOffset = chan->direction == MEMORY_TO_PERIPHERAL ?
+			   0 : chan->destination_bytes;
+
+	if (chan->direction == MEMORY_TO_MEMORY) {
+		/* The whole block on a single request */
+		xfer->minorLoopBytes = block->block_size;
+		xfer->majorLoopCounts = 1;
+	} else {
+		/* One data item per peripheral request */
+		if (block->block_size / bytes > DMA_MCUX_MAX_ITEMS) {
+			return -EINVAL;
+		}
+
+		xfer->minorLoopBytes = bytes;
+		xfer->majorLoopCounts = block->block_size / bytes;
+	}
+
+	return 0;
+}
+
+static int dma_mcux_block_config(struct device *dev, uint32_t channel,
+				 struct dma_block_config *first)
+{
+	struct dma_mcux_driver_data *data = dev->driver_data;
+	struct dma_mcux_channel *chan;
+	struct dma_block_config *block;
+	edma_transfer_config_t xfer;
+	edma_tcd_t *tcd, *next;
+	uint32_t n;
+	int ret;
+
+	if (channel >= DMA_MCUX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &data->channel[channel];
+	tcd = dma_mcux_tcd[channel];
+
+	for (n = 0, block = first; block; n++, block = block->next_block) {
+		if (n == CONFIG_DMA_MCUX_EDMA_MAX_BLOCKS) {
+			return -ENOMEM;
+		}
+
+		ret = dma_mcux_tcd_fill(chan, block, &xfer);
+		if (ret) {
+			return ret;
+		}
+
+		if (block->next_block) {
+			next = &tcd[n + 1];
+		} else if (chan->transfer_type == TRANSFER_TYPE_CIRCULAR) {
+			next = &tcd[0];
+		} else {
+			next = NULL;
+		}
+
+		EDMA_TcdReset(&tcd[n]);
+		EDMA_TcdSetTransferConfig(&tcd[n], &xfer, next);
+
+		/*
+		 * Interrupt after the last block, or after every block when
+		 * looping.
+		 */
+		if (!block->next_block ||
+		    chan->transfer_type == TRANSFER_TYPE_CIRCULAR) {
+			EDMA_TcdEnableInterrupts(&tcd[n],
+						 kEDMA_MajorInterruptEnable);
+		}
+
+		/* Software started blocks start the next one when loaded */
+		if (n && chan->direction == MEMORY_TO_MEMORY) {
+			tcd[n].CSR |= DMA_CSR_START_MASK;
+		}
+	}
+
+	chan->blocks = n;
+
+	return 0;
+}
+
+static int dma_mcux_transfer_config(struct device *dev, uint32_t channel,
+				    struct dma_transfer_config *config)
+{
+	struct dma_block_config block = {
+		.block_size = config->block_size,
+		.source_address = config->source_address,
+		.destination_address = config->destination_address,
+		.next_block = NULL,
+	};
+
+	return dma_mcux_block_config(dev, channel, &block);
+}
+
+static int dma_mcux_transfer_start(struct device *dev, uint32_t channel)
+{
+	struct dma_mcux_driver_data *data = dev->driver_data;
+	struct dma_mcux_channel *chan;
+	edma_tcd_t *tcd;
+
+	if (channel >= DMA_MCUX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &data->channel[channel];
+	if (!chan->blocks) {
+		return -EINVAL;
+	}
+
+	/* Scatter/gather can't be enabled while the done flag is set */
+	EDMA_ClearChannelStatusFlags(DMA0, channel, kEDMA_DoneFlag);
+
+	/* Load the first descriptor, the controller fetches the others */
+	tcd = (edma_tcd_t *)&DMA0->TCD[channel];
+	tcd->CSR = 0;
+	tcd->SADDR = dma_mcux_tcd[channel][0].SADDR;
+	tcd->SOFF = dma_mcux_tcd[channel][0].SOFF;
+	tcd->ATTR = dma_mcux_tcd[channel][0].ATTR;
+	tcd->NBYTES = dma_mcux_tcd[channel][0].NBYTES;
+	tcd->SLAST = dma_mcux_tcd[channel][0].SLAST;
+	tcd->DADDR = dma_mcux_tcd[channel][0].DADDR;
+	tcd->DOFF = dma_mcux_tcd[channel][0].DOFF;
+	tcd->CITER = dma_mcux_tcd[channel][0].CITER;
+	tcd->BITER = dma_mcux_tcd[channel][0].BITER;
+	tcd->DLAST_SGA = dma_mcux_tcd[channel][0].DLAST_SGA;
+	tcd->CSR = dma_mcux_tcd[channel][0].CSR;
+
+	if (chan->direction == MEMORY_TO_MEMORY) {
+		EDMA_TriggerChannelStart(DMA0, channel);
+	} else {
+		EDMA_EnableChannelRequest(DMA0, channel);
+	}
+
+	return 0;
+}
+
+static int dma_mcux_transfer_stop(struct device *dev, uint32_t channel)
+{
+	if (channel >= DMA_MCUX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	EDMA_DisableChannelRequest(DMA0, channel);
+	EDMA_ResetChannel(DMA0, channel);
+	EDMA_ClearChannelStatusFlags(DMA0, channel, kEDMA_DoneFlag |
+				     kEDMA_InterruptFlag);
+
+	return 0;
+}
+
+static const struct dma_driver_api dma_mcux_driver_api = {
+	.channel_config = dma_mcux_channel_config,
+	.transfer_config = dma_mcux_transfer_config,
+	.transfer_start = dma_mcux_transfer_start,
+	.transfer_stop = dma_mcux_transfer_stop,
+	.block_config = dma_mcux_block_config,
+};
+
+static void dma_mcux_isr(void *arg)
+{
+	struct dma_mcux_channel *chan = arg;
+
+	EDMA_ClearChannelStatusFlags(DMA0, chan->index, kEDMA_InterruptFlag);
+
+	if (chan->transfer) {
+		chan->transfer(chan->dev, chan->callback_data);
+	}
+}
+
+static void dma_mcux_error_isr(void *arg)
+{
+	struct device *dev = arg;
+	struct dma_mcux_driver_data *data = dev->driver_data;
+	struct dma_mcux_channel *chan;
+	uint32_t errors = DMA0->ERR;
+	uint32_t i;
+
+	for (i = 0; errors; i++, errors >>= 1) {
+		if (!(errors & 1)) {
+			continue;
+		}
+
+		chan = &data->channel[i];
+		EDMA_ClearChannelStatusFlags(DMA0, i, kEDMA_ErrorFlag);
+
+		if (chan->error) {
+			chan->error(dev, chan->callback_data);
+		}
+	}
+}
+
+static struct dma_mcux_driver_data dma_mcux_data;
+
+static void dma_mcux_irq_config(struct device *dev);
+
+static int dma_mcux_init(struct device *dev)
+{
+	struct dma_mcux_driver_data *data = dev->driver_data;
+	edma_config_t config;
+	uint32_t i;
+
+	for (i = 0; i < DMA_MCUX_CHANNELS; i++) {
+		data->channel[i].dev = dev;
+		data->channel[i].index = i;
+	}
+
+	DMAMUX_Init(DMAMUX0);
+
+	EDMA_GetDefaultConfig(&config);
+	/* An error only stops the faulty channel */
+	config.enableHaltOnError = false;
+	EDMA_Init(DMA0, &config);
+
+	dma_mcux_irq_config(dev);
+
+	return 0;
+}
+
+DEVICE_AND_API_INIT(dma_mcux, CONFIG_DMA_0_NAME, &dma_mcux_init,
+		    &dma_mcux_data, NULL, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &dma_mcux_driver_api);
+
+#define DMA_MCUX_IRQ_CONNECT(n)						\
+	do {								\
+		IRQ_CONNECT(IRQ_DMA_CHAN##n, CONFIG_DMA_0_IRQ_PRI,	\
+			    dma_mcux_isr, &dma_mcux_data.channel[n], 0);\
+		irq_enable(IRQ_DMA_CHAN##n);				\
+	} while (0)
+
+static void dma_mcux_irq_config(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	DMA_MCUX_IRQ_CONNECT(0);
+	DMA_MCUX_IRQ_CONNECT(1);
+	DMA_MCUX_IRQ_CONNECT(2);
+	DMA_MCUX_IRQ_CONNECT(3);
+	DMA_MCUX_IRQ_CONNECT(4);
+	DMA_MCUX_IRQ_CONNECT(5);
+	DMA_MCUX_IRQ_CONNECT(6);
+	DMA_MCUX_IRQ_CONNECT(7);
+	DMA_MCUX_IRQ_CONNECT(8);
+	DMA_MCUX_IRQ_CONNECT(9);
+	DMA_MCUX_IRQ_CONNECT(10);
+	DMA_MCUX_IRQ_CONNECT(11);
+	DMA_MCUX_IRQ_CONNECT(12);
+	DMA_MCUX_IRQ_CONNECT(13);
+	DMA_MCUX_IRQ_CONNECT(14);
+	DMA_MCUX_IRQ_CONNECT(15);
+
+	IRQ_CONNECT(IRQ_DMA_ERR, CONFIG_DMA_0_IRQ_PRI, dma_mcux_error_isr,
+		    DEVICE_GET(dma_mcux), 0);
+	irq_enable(IRQ_DMA_ERR);
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Memory to memory copies on top of the DMA API
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <kernel.h>
+#include <init.h>
+#include <dma.h>
+#include <cache.h>
+#include <misc/util.h>
+
+static void memcpy_finish(struct dma_memcpy *ctx)
+{
+	ctx->busy = 0;
+
+	if (ctx->cb) {
+		ctx->cb(ctx->status, ctx->user_data);
+	}
+}
+
+/* Chain as much of what is left as the blocks allow and start it */
+static int memcpy_round(struct dma_memcpy *ctx)
+{
+	size_t max = CONFIG_DMA_MEMCPY_BLOCK_ITEMS * ctx->width;
+	struct dma_block_config *block;
+	uint32_t n;
+	int err;
+
+	for (n = 0; ctx->left && n < ARRAY_SIZE(ctx->blocks); n++) {
+		block = &ctx->blocks[n];
+		block->block_size = min(ctx->left, max);
+		block->source_address = (uint32_t *)ctx->src;
+		block->destination_address = (uint32_t *)ctx->dst;
+		block->next_block = NULL;
+
+		sys_cache_dma_to_device((vaddr_t)ctx->src, block->block_size);
+		sys_cache_dma_from_device_start((vaddr_t)ctx->dst,
+						block->block_size);
+
+		if (n) {
+			ctx->blocks[n - 1].next_block = block;
+		}
+
+		ctx->src += block->block_size;
+		ctx->dst += block->block_size;
+		ctx->left -= block->block_size;
+	}
+
+	err = dma_block_config(ctx->dev, ctx->channel, ctx->blocks);
+	if (err) {
+		return err;
+	}
+
+	return dma_transfer_start(ctx->dev, ctx->channel);
+}
+
+static void memcpy_done(struct device *dev, void *data)
+{
+	struct dma_memcpy *ctx = data;
+	struct dma_block_config *block;
+
+	ARG_UNUSED(dev);
+
+	/* Only the destination of the round just copied, block per block */
+	for (block = ctx->blocks; block; block = block->next_block) {
+		sys_cache_dma_from_device_end(
+			(vaddr_t)block->destination_address,
+			block->block_size);
+	}
+
+	if (ctx->left) {
+		ctx->status = memcpy_round(ctx);
+		if (!ctx->status) {
+			return;
+		}
+	}
+
+	memcpy_finish(ctx);
+}
+
+static void memcpy_error(struct device *dev, void *data)
+{
+	struct dma_memcpy *ctx = data;
+
+	ARG_UNUSED(dev);
+
+	ctx->status = -EIO;
+	memcpy_finish(ctx);
+}
+
+int dma_memcpy_init(struct dma_memcpy *ctx, struct device *dev,
+		    uint32_t channel)
+{
+	ctx->dev = dev;
+	ctx->channel = channel;
+	ctx->busy = 0;
+	k_mutex_init(&ctx->lock);
+	k_sem_init(&ctx->done, 0, 1);
+
+	return 0;
+}
+
+int dma_memcpy_async(struct dma_memcpy *ctx, void *dst, const void *src,
+		     size_t len, dma_memcpy_callback_t cb, void *user_data)
+{
+	struct dma_channel_config cfg = { 0 };
+	enum dma_transfer_width width;
+	unsigned int key;
+	int err;
+
+	key = irq_lock();
+	if (ctx->busy) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+	ctx->busy = 1;
+	irq_unlock(key);
+
+	ctx->cb = cb;
+	ctx->user_data = user_data;
+	ctx->dst = dst;
+	ctx->src = src;
+	ctx->left = len;
+	ctx->status = 0;
+
+	if (!len) {
+		memcpy_finish(ctx);
+		return 0;
+	}
+
+	/* Whole words whenever the copy allows it */
+	if (((uintptr_t)dst | (uintptr_t)src | len) & 3) {
+		width = TRANS_WIDTH_8;
+		ctx->width = 1;
+	} else {
+		width = TRANS_WIDTH_32;
+		ctx->width = 4;
+	}
+
+	cfg.channel_direction = MEMORY_TO_MEMORY;
+	cfg.source_transfer_width = width;
+	cfg.destination_transfer_width = width;
+	cfg.source_burst_length = BURST_TRANS_LENGTH_1;
+	cfg.destination_burst_length = BURST_TRANS_LENGTH_1;
+	cfg.transfer_type = TRANSFER_TYPE_LIST;
+	cfg.dma_transfer = memcpy_done;
+	cfg.dma_error = memcpy_error;
+	cfg.callback_data = ctx;
+
+	err = dma_channel_config(ctx->dev, ctx->channel, &cfg);
+	if (!err) {
+		err = memcpy_round(ctx);
+	}
+
+	if (err) {
+		ctx->busy = 0;
+	}
+
+	return err;
+}
+
+static void memcpy_sync_done(int status, void *user_data)
+{
+	struct dma_memcpy *ctx = user_data;
+
+	ARG_UNUSED(status);
+
+	k_sem_give(&ctx->done);
+}
+
+int dma_memcpy(struct dma_memcpy *ctx, void *dst, const void *src,
+	       size_t len)
+{
+	int err;
+
+	/* Setting up the controller costs more than small copies */
+	if (len < CONFIG_DMA_MEMCPY_THRESHOLD || k_is_in_isr()) {
+		memcpy(dst, src, len);
+		return 0;
+	}
+
+	k_mutex_lock(&ctx->lock, K_FOREVER);
+
+	err = dma_memcpy_async(ctx, dst, src, len, memcpy_sync_done, ctx);
+	if (err) {
+		/* Channel taken by an asynchronous copy or not usable */
+		memcpy(dst, src, len);
+		err = 0;
+	} else {
+		k_sem_take(&ctx->done, K_FOREVER);
+		err = ctx->status;
+	}
+
+	k_mutex_unlock(&ctx->lock);
+
+	return err;
+}
+
+#ifdef CONFIG_DMA_MEMCPY_SYS
+static struct dma_memcpy dma_memcpy_sys_ctx;
+static bool dma_memcpy_sys_ready;
+
+void *dma_memcpy_sys(void *dst, const void *src, size_t len)
+{
+	struct dma_memcpy *ctx = &dma_memcpy_sys_ctx;
+
+	if (len < CONFIG_DMA_MEMCPY_THRESHOLD || !dma_memcpy_sys_ready ||
+	    k_is_in_isr()) {
+		return memcpy(dst, src, len);
+	}
+
+	/* Starting fails with -EBUSY while another copy is ongoing */
+	if (dma_memcpy_async(ctx, dst, src, len, NULL, NULL)) {
+		return memcpy(dst, src, len);
+	}
+
+	while (*(volatile uint8_t *)&ctx->busy) {
+	}
+
+	if (ctx->status) {
+		memcpy(dst, src, len);
+	}
+
+	return dst;
+}
+
+static int dma_memcpy_sys_init(struct device *unused)
+{
+	struct device *dev;
+
+	ARG_UNUSED(unused);
+
+	dev = device_get_binding(CONFIG_DMA_MEMCPY_SYS_DEV_NAME);
+	if (!dev) {
+		return -ENODEV;
+	}
+
+	dma_memcpy_init(&dma_memcpy_sys_ctx, dev,
+			CONFIG_DMA_MEMCPY_SYS_CHANNEL);
+	dma_memcpy_sys_ready = true;
+
+	return 0;
+}
+
+SYS_INIT(dma_memcpy_sys_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE);
+#endif /* CONFIG_DMA_MEMCPY_SYS */
@@ -30,6 +30,11 @@ struct dma_qmsi_driver_data {
 	void (*transfer[QM_DMA_CHANNEL_NUM])(struct device *dev, void *data);
 	void (*error[QM_DMA_CHANNEL_NUM])(struct device *dev, void *data);
 	void *callback_data[QM_DMA_CHANNEL_NUM];
+	enum dma_transfer_type transfer_type[QM_DMA_CHANNEL_NUM];
+	/* Source data item size, log2 in bytes */
+	uint8_t source_width[QM_DMA_CHANNEL_NUM];
+	/* Blocks of a TRANSFER_TYPE_LIST transfer left to be done */
+	uint32_t blocks_left[QM_DMA_CHANNEL_NUM];
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 	uint32_t device_power_state;
 #ifdef CONFIG_SYS_POWER_DEEP_SLEEP
@@ -40,6 +45,10 @@ struct dma_qmsi_driver_data {
 
 
 static struct dma_qmsi_context dma_context[QM_DMA_CHANNEL_NUM];
+
+/* Descriptors the controller walks through in linked list mode */
+static qm_dma_linked_list_item_t
+	dma_lli[QM_DMA_CHANNEL_NUM][CONFIG_DMA_QMSI_MAX_BLOCKS];
 static void dma_qmsi_config(struct device *dev);
 
 static void dma_callback(void *callback_context, uint32_t len,
@@ -57,6 +66,12 @@ static void dma_callback(void *callback_context, uint32_t len,
 		return;
 	}
 
+	/* Called after every block in linked list mode */
+	if (data->transfer_type[channel] == TRANSFER_TYPE_LIST &&
+	    --data->blocks_left[channel]) {
+		return;
+	}
+
 	data->transfer[channel](context->dev, data->callback_data[channel]);
 }
 
@@ -82,8 +97,22 @@ static int dma_qmsi_channel_config(struct device *dev, uint32_t channel,
 	qmsi_cfg.source_burst_length = (qm_dma_burst_length_t)
 					config->source_burst_length;
 
-	/* TODO: add support for using other DMA transfer types. */
-	qmsi_cfg.transfer_type = QM_DMA_TYPE_SINGLE;
+	switch (config->transfer_type) {
+	case TRANSFER_TYPE_SINGLE:
+		qmsi_cfg.transfer_type = QM_DMA_TYPE_SINGLE;
+		break;
+	case TRANSFER_TYPE_LIST:
+		qmsi_cfg.transfer_type = QM_DMA_TYPE_MULTI_LL;
+		break;
+	case TRANSFER_TYPE_CIRCULAR:
+		qmsi_cfg.transfer_type = QM_DMA_TYPE_MULTI_LL_CIRCULAR;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	data->transfer_type[channel] = config->transfer_type;
+	data->source_width[channel] = config->source_transfer_width;
 
 	data->callback_data[channel] = config->callback_data;
 	data->transfer[channel] = config->dma_transfer;
@@ -107,6 +136,51 @@ static int dma_qmsi_transfer_config(struct device *dev, uint32_t channel,
 					 (qm_dma_transfer_t *)config);
 }
 
+static int dma_qmsi_block_config(struct device *dev, uint32_t channel,
+				 struct dma_block_config *first)
+{
+	const struct dma_qmsi_config_info *info = dev->config->config_info;
+	struct dma_qmsi_driver_data *data = dev->driver_data;
+	qm_dma_multi_transfer_t xfer;
+	struct dma_block_config *block;
+	uint32_t n = 0;
+	int ret;
+
+	if (data->transfer_type[channel] == TRANSFER_TYPE_SINGLE) {
+		return -EINVAL;
+	}
+
+	for (block = first; block; block = block->next_block) {
+		if (++n > CONFIG_DMA_QMSI_MAX_BLOCKS) {
+			return -ENOMEM;
+		}
+	}
+
+	/*
+	 * Every block is appended as a buffer of its own, so that blocks
+	 * of different sizes can be chained. The controller counts the
+	 * block size in source data items.
+	 */
+	for (n = 0, block = first; block; n++, block = block->next_block) {
+		xfer.source_address = block->source_address;
+		xfer.destination_address = block->destination_address;
+		xfer.block_size = block->block_size >>
+				  data->source_width[channel];
+		xfer.num_blocks = 1;
+		xfer.linked_list_first = &dma_lli[channel][n];
+
+		ret = qm_dma_multi_transfer_set_config(info->instance, channel,
+						       &xfer);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	data->blocks_left[channel] = n;
+
+	return 0;
+}
+
 static int dma_qmsi_transfer_start(struct device *dev, uint32_t channel)
 {
 	const struct dma_qmsi_config_info *info = dev->config->config_info;
@@ -117,6 +191,10 @@ static int dma_qmsi_transfer_start(struct device *dev, uint32_t channel)
 static int dma_qmsi_transfer_stop(struct device *dev, uint32_t channel)
 {
 	const struct dma_qmsi_config_info *info = dev->config->config_info;
+	struct dma_qmsi_driver_data *data = dev->driver_data;
+
+	/* Termination is reported through the transfer callback */
+	data->blocks_left[channel] = 1;
 
 	return qm_dma_transfer_terminate(info->instance, channel);
 }
@@ -125,7 +203,8 @@ static const struct dma_driver_api dma_funcs = {
 	.channel_config = dma_qmsi_channel_config,
 	.transfer_config = dma_qmsi_transfer_config,
 	.transfer_start = dma_qmsi_transfer_start,
-	.transfer_stop = dma_qmsi_transfer_stop
+	.transfer_stop = dma_qmsi_transfer_stop,
+	.block_config = dma_qmsi_block_config
 };
 
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief STM32F4x DMA driver
+ *
+ * Every controller has 8 streams, the channel number of the API being the
+ * stream number and the handshake interface the request channel (CHSEL)
+ * the stream listens to. The streams have no descriptor lists: chained
+ * blocks are loaded one after the other from the transfer complete
+ * interrupt. A single block looping over itself uses the circular mode
+ * of the stream instead.
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <dma.h>
+#include <soc.h>
+#include <misc/util.h>
+#include <misc/__assert.h>
+#include <clock_control.h>
+#include <clock_control/stm32_clock_control.h>
+
+#define DMA_STM32_STREAMS 8
+
+/* NDTR is 16 bits */
+#define DMA_STM32_MAX_ITEMS 0xffff
+
+/* Flags of a stream, relative to its offset in the status registers */
+#define DMA_STM32_FEIF  BIT(0)
+#define DMA_STM32_DMEIF BIT(2)
+#define DMA_STM32_TEIF  BIT(3)
+#define DMA_STM32_HTIF  BIT(4)
+#define DMA_STM32_TCIF  BIT(5)
+
+#define DMA_STM32_ERRORS (DMA_STM32_DMEIF | DMA_STM32_TEIF)
+#define DMA_STM32_ALL (DMA_STM32_FEIF | DMA_STM32_DMEIF | DMA_STM32_TEIF | \
+		       DMA_STM32_HTIF | DMA_STM32_TCIF)
+
+struct dma_stm32_stream {
+	struct device *dev;
+	uint32_t index;
+	void (*transfer)(struct device *dev, void *data);
+	void (*error)(struct device *dev, void *data);
+	void *callback_data;
+	enum dma_channel_direction direction;
+	enum dma_transfer_type transfer_type;
+	/* Stream control register, without the enable bit */
+	uint32_t cr;
+	/* Peripheral port data item size in bytes, NDTR unit */
+	uint8_t item_bytes;
+	/* Number of configured blocks and block being transferred */
+	uint8_t blocks;
+	uint8_t current;
+	struct dma_block_config block[CONFIG_DMA_STM32F4X_MAX_BLOCKS];
+};
+
+struct dma_stm32_config_info {
+	DMA_TypeDef *base;
+	struct stm32f4x_pclken pclken;
+	/* Memory to memory transfers are only done by DMA2 */
+	bool mem2mem;
+	void (*irq_config)(struct device *dev);
+};
+
+struct dma_stm32_driver_data {
+	struct dma_stm32_stream stream[DMA_STM32_STREAMS];
+};
+
+static inline DMA_Stream_TypeDef *dma_stm32_regs(struct device *dev,
+						 uint32_t stream)
+{
+	const struct dma_stm32_config_info *info = dev->config->config_info;
+
+	return (DMA_Stream_TypeDef *)((uint32_t)info->base + 0x10 +
+				      0x18 * stream);
+}
+
+static inline uint32_t dma_stm32_flag_shift(uint32_t stream)
+{
+	static const uint8_t shift[] = { 0, 6, 16, 22 };
+
+	return shift[stream & 3];
+}
+
+static uint32_t dma_stm32_flags(struct device *dev, uint32_t stream)
+{
+	const struct dma_stm32_config_info *info = dev->config->config_info;
+	uint32_t isr = stream < 4 ? info->base->LISR : info->base->HISR;
+
+	return (isr >> dma_stm32_flag_shift(stream)) & DMA_STM32_ALL;
+}
+
+static void dma_stm32_clear(struct device *dev, uint32_t stream,
+			    uint32_t flags)
+{
+	const struct dma_stm32_config_info *info = dev->config->config_info;
+
+	flags <<= dma_stm32_flag_shift(stream);
+
+	if (stream < 4) {
+		info->base->LIFCR = flags;
+	} else {
+		info->base->HIFCR = flags;
+	}
+}
+
+static int dma_stm32_width(enum dma_transfer_width width, uint32_t *size,
+			   uint8_t *bytes)
+{
+	switch (width) {
+	case TRANS_WIDTH_8:
+		*size = 0;
+		*bytes = 1;
+		break;
+	case TRANS_WIDTH_16:
+		*size = 1;
+		*bytes = 2;
+		break;
+	case TRANS_WIDTH_32:
+		*size = 2;
+		*bytes = 4;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int dma_stm32_burst(enum dma_burst_length burst, uint32_t *inc)
+{
+	switch (burst) {
+	case BURST_TRANS_LENGTH_1:
+		*inc = 0;
+		break;
+	case BURST_TRANS_LENGTH_4:
+		*inc = 1;
+		break;
+	case BURST_TRANS_LENGTH_8:
+		*inc = 2;
+		break;
+	case BURST_TRANS_LENGTH_16:
+		*inc = 3;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int dma_stm32_channel_config(struct device *dev, uint32_t channel,
+				    struct dma_channel_config *config)
+{
+	const struct dma_stm32_config_info *info = dev->config->config_info;
+	struct dma_stm32_driver_data *data = dev->driver_data;
+	enum dma_transfer_width pwidth, mwidth;
+	enum dma_burst_length pburst, mburst;
+	struct dma_stm32_stream *stream;
+	uint32_t psize, msize, pinc, minc;
+	uint8_t mbytes;
+	uint32_t cr;
+
+	if (channel >= DMA_STM32_STREAMS || config->handshake_interface > 7) {
+		return -EINVAL;
+	}
+
+	stream = &data->stream[channel];
+
+	/* The peripheral port is the source, but for memory to peripheral */
+	switch (config->channel_direction) {
+	case MEMORY_TO_MEMORY:
+		if (!info->mem2mem) {
+			return -ENOTSUP;
+		}
+		cr = DMA_SxCR_DIR_1 | DMA_SxCR_PINC | DMA_SxCR_MINC;
+		break;
+	case PERIPHERAL_TO_MEMORY:
+		cr = DMA_SxCR_MINC;
+		break;
+	case MEMORY_TO_PERIPHERAL:
+		cr = DMA_SxCR_DIR_0 | DMA_SxCR_MINC;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if (config->channel_direction == MEMORY_TO_PERIPHERAL) {
+		pwidth = config->destination_transfer_width;
+		mwidth = config->source_transfer_width;
+		pburst = config->destination_burst_length;
+		mburst = config->source_burst_length;
+	} else {
+		pwidth = config->source_transfer_width;
+		mwidth = config->destination_transfer_width;
+		pburst = config->source_burst_length;
+		mburst = config->destination_burst_length;
+	}
+
+	if (dma_stm32_width(pwidth, &psize, &stream->item_bytes) ||
+	    dma_stm32_width(mwidth, &msize, &mbytes) ||
+	    dma_stm32_burst(pburst, &pinc) ||
+	    dma_stm32_burst(mburst, &minc)) {
+		return -EINVAL;
+	}
+
+	cr |= config->handshake_interface * DMA_SxCR_CHSEL_0;
+	cr |= psize * DMA_SxCR_PSIZE_0 | msize * DMA_SxCR_MSIZE_0;
+	cr |= pinc * DMA_SxCR_PBURST_0 | minc * DMA_SxCR_MBURST_0;
+	cr |= DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE;
+
+	stream->cr = cr;
+	stream->direction = config->channel_direction;
+	stream->transfer_type = config->transfer_type;
+	stream->transfer = config->dma_transfer;
+	stream->error = config->dma_error;
+	stream->callback_data = config->callback_data;
+	stream->blocks = 0;
+
+	return 0;
+}
+
+static int dma_stm32_block_config(struct device *dev, uint32_t channel,
+				  struct dma_block_config *first)
+{
+	struct dma_stm32_driver_data *data = dev->driver_data;
+	struct dma_stm32_stream *stream;
+	struct dma_block_config *block;
+	uint32_t n;
+
+	if (channel >= DMA_STM32_STREAMS) {
+		return -EINVAL;
+	}
+
+	stream = &data->stream[channel];
+
+	for (n = 0, block = first; block; n++, block = block->next_block) {
+		if (n == CONFIG_DMA_STM32F4X_MAX_BLOCKS) {
+			return -ENOMEM;
+		}
+
+		if (!block->block_size ||
+		    block->block_size % stream->item_bytes ||
+		    block->block_size / stream->item_bytes >
+		    DMA_STM32_MAX_ITEMS) {
+			return -EINVAL;
+		}
+
+		/* Kept, the caller may reuse its blocks once configured */
+		stream->block[n] = *block;
+	}
+
+	stream->blocks = n;
+
+	return 0;
+}
+
+static int dma_stm32_transfer_config(struct device *dev, uint32_t channel,
+				     struct dma_transfer_config *config)
+{
+	struct dma_block_config block = {
+		.block_size = config->block_size,
+		.source_address = config->source_address,
+		.destination_address = config->destination_address,
+		.next_block = NULL,
+	};
+
+	return dma_stm32_block_config(dev, channel, &block);
+}
+
+/* Program a block on a disabled stream and enable it */
+static void dma_stm32_load(struct device *dev, struct dma_stm32_stream *stream)
+{
+	DMA_Stream_TypeDef *regs = dma_stm32_regs(dev, stream->index);
+	struct dma_block_config *block = &stream->block[stream->current];
+	uint32_t cr = stream->cr;
+
+	if (stream->direction == MEMORY_TO_PERIPHERAL) {
+		regs->PAR = (uint32_t)block->destination_address;
+		regs->M0AR = (uint32_t)block->source_address;
+	} else {
+		regs->PAR = (uint32_t)block->source_address;
+		regs->M0AR = (uint32_t)block->destination_address;
+	}
+
+	regs->NDTR = block->block_size / stream->item_bytes;
+
+	/* Memory to memory needs the FIFO, bursts need it too */
+	if (stream->direction == MEMORY_TO_MEMORY ||
+	    cr & (DMA_SxCR_PBURST | DMA_SxCR_MBURST)) {
+		regs->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH;
+	} else {
+		regs->FCR = 0;
+	}
+
+	if (stream->transfer_type == TRANSFER_TYPE_CIRCULAR &&
+	    stream->blocks == 1 && stream->direction != MEMORY_TO_MEMORY) {
+		cr |= DMA_SxCR_CIRC;
+	}
+
+	dma_stm32_clear(dev, stream->index, DMA_STM32_ALL);
+
+	regs->CR = cr;
+	regs->CR = cr | DMA_SxCR_EN;
+}
+
+static int dma_stm32_transfer_start(struct device *dev, uint32_t channel)
+{
+	struct dma_stm32_driver_data *data = dev->driver_data;
+	struct dma_stm32_stream *stream;
+
+	if (channel >= DMA_STM32_STREAMS) {
+		return -EINVAL;
+	}
+
+	stream = &data->stream[channel];
+	if (!stream->blocks) {
+		return -EINVAL;
+	}
+
+	if (dma_stm32_regs(dev, channel)->CR & DMA_SxCR_EN) {
+		return -EBUSY;
+	}
+
+	stream->current = 0;
+	dma_stm32_load(dev, stream);
+
+	return 0;
+}
+
+static int dma_stm32_transfer_stop(struct device *dev, uint32_t channel)
+{
+	DMA_Stream_TypeDef *regs;
+
+	if (channel >= DMA_STM32_STREAMS) {
+		return -EINVAL;
+	}
+
+	regs = dma_stm32_regs(dev, channel);
+
+	regs->CR &= ~(DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE);
+	regs->CR &= ~DMA_SxCR_EN;
+
+	/* The stream only reads as disabled once the current item is done */
+	while (regs->CR & DMA_SxCR_EN) {
+	}
+
+	dma_stm32_clear(dev, channel, DMA_STM32_ALL);
+
+	return 0;
+}
+
+static const struct dma_driver_api dma_stm32_driver_api = {
+	.channel_config = dma_stm32_channel_config,
+	.transfer_config = dma_stm32_transfer_config,
+	.transfer_start = dma_stm32_transfer_start,
+	.transfer_stop = dma_stm32_transfer_stop,
+	.block_config = dma_stm32_block_config,
+};
+
+static void dma_stm32_isr(void *arg)
+{
+	struct dma_stm32_stream *stream = arg;
+	struct device *dev = stream->dev;
+	uint32_t flags = dma_stm32_flags(dev, stream->index);
+	bool last;
+
+	dma_stm32_clear(dev, stream->index, flags);
+
+	if (flags & DMA_STM32_ERRORS) {
+		dma_stm32_transfer_stop(dev, stream->index);
+
+		if (stream->error) {
+			stream->error(dev, stream->callback_data);
+		}
+
+		return;
+	}
+
+	if (!(flags & DMA_STM32_TCIF)) {
+		return;
+	}
+
+	last = stream->current + 1 == stream->blocks;
+
+	/* The stream reloads itself in circular mode */
+	if (stream->transfer_type == TRANSFER_TYPE_CIRCULAR) {
+		if (stream->blocks > 1 ||
+		    stream->direction == MEMORY_TO_MEMORY) {
+			stream->current = last ? 0 : stream->current + 1;
+			dma_stm32_load(dev, stream);
+		}
+	} else if (!last) {
+		stream->current++;
+		dma_stm32_load(dev, stream);
+		return;
+	}
+
+	if (stream->transfer) {
+		stream->transfer(dev, stream->callback_data);
+	}
+}
+
+static int dma_stm32_init(struct device *dev)
+{
+	const struct dma_stm32_config_info *info = dev->config->config_info;
+	struct dma_stm32_driver_data *data = dev->driver_data;
+	struct device *clk = device_get_binding(STM32_CLOCK_CONTROL_NAME);
+	uint32_t i;
+
+	__ASSERT_NO_MSG(clk);
+
+	clock_control_on(clk, (clock_control_subsys_t *)&info->pclken);
+
+	for (i = 0; i < DMA_STM32_STREAMS; i++) {
+		data->stream[i].dev = dev;
+		data->stream[i].index = i;
+	}
+
+	info->irq_config(dev);
+
+	return 0;
+}
+
+#define DMA_STM32_IRQ_CONNECT(c, n)					\
+	do {								\
+		IRQ_CONNECT(DMA##c##_Stream##n##_IRQn,			\
+			    CONFIG_DMA_0_IRQ_PRI, dma_stm32_isr,	\
+			    &dma_stm32_data_##c.stream[n], 0);		\
+		irq_enable(DMA##c##_Stream##n##_IRQn);			\
+	} while (0)
+
+static void dma_stm32_irq_config_1(struct device *dev);
+
+static const struct dma_stm32_config_info dma_stm32_config_1 = {
+	.base = DMA1,
+	.pclken = { .bus = STM32F4X_CLOCK_BUS_AHB1,
+		    .enr = STM32F4X_CLOCK_ENABLE_DMA1 },
+	.mem2mem = false,
+	.irq_config = dma_stm32_irq_config_1,
+};
+
+static struct dma_stm32_driver_data dma_stm32_data_1;
+
+DEVICE_AND_API_INIT(dma_stm32_1, CONFIG_DMA_STM32F4X_1_NAME, &dma_stm32_init,
+		    &dma_stm32_data_1, &dma_stm32_config_1, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &dma_stm32_driver_api);
+
+static void dma_stm32_irq_config_1(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	DMA_STM32_IRQ_CONNECT(1, 0);
+	DMA_STM32_IRQ_CONNECT(1, 1);
+	DMA_STM32_IRQ_CONNECT(1, 2);
+	DMA_STM32_IRQ_CONNECT(1, 3);
+	DMA_STM32_IRQ_CONNECT(1, 4);
+	DMA_STM32_IRQ_CONNECT(1, 5);
+	DMA_STM32_IRQ_CONNECT(1, 6);
+	DMA_STM32_IRQ_CONNECT(1, 7);
+}
+
+static void dma_stm32_irq_config_2(struct device *dev);
+
+static const struct dma_stm32_config_info dma_stm32_config_2 = {
+	.base = DMA2,
+	.pclken = { .bus = STM32F4X_CLOCK_BUS_AHB1,
+		    .enr = STM32F4X_CLOCK_ENABLE_DMA2 },
+	.mem2mem = true,
+	.irq_config = dma_stm32_irq_config_2,
+};
+
+static struct dma_stm32_driver_data dma_stm32_data_2;
+
+DEVICE_AND_API_INIT(dma_stm32_2, CONFIG_DMA_STM32F4X_2_NAME, &dma_stm32_init,
+		    &dma_stm32_data_2, &dma_stm32_config_2, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &dma_stm32_driver_api);
+
+static void dma_stm32_irq_config_2(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	DMA_STM32_IRQ_CONNECT(2, 0);
+	DMA_STM32_IRQ_CONNECT(2, 1);
+	DMA_STM32_IRQ_CONNECT(2, 2);
+	DMA_STM32_IRQ_CONNECT(2, 3);
+	DMA_STM32_IRQ_CONNECT(2, 4);
+	DMA_STM32_IRQ_CONNECT(2, 5);
+	DMA_STM32_IRQ_CONNECT(2, 6);
+	DMA_STM32_IRQ_CONNECT(2, 7);
+}
@@ -14,6 +14,7 @@
 #include <net/ip/net_driver_ethernet.h>
 #include <misc/__assert.h>
 #include <errno.h>
+#include <cache.h>
 
 #ifdef CONFIG_SHARED_IRQ
 #include <shared_irq.h>
@@ -41,6 +42,9 @@ static void eth_rx(struct device *port)
 	struct net_buf *buf;
 	uint32_t frm_len = 0;
 
+	sys_cache_dma_from_device_end((vaddr_t)&context->rx_desc,
+				      sizeof(context->rx_desc));
+
 	/* Check whether the RX descriptor is still owned by the device.  If not,
 	 * process the received frame or an error that may have occurred.
 	 */
@@ -71,6 +75,7 @@ static void eth_rx(struct device *port)
 		goto release_desc;
 	}
 
+	sys_cache_dma_from_device_end((vaddr_t)context->rx_buf, frm_len);
 	memcpy(net_buf_add(buf, frm_len), (void *)context->rx_buf, frm_len);
 	uip_len(buf) = frm_len;
 
@@ -79,6 +84,8 @@ static void eth_rx(struct device *port)
 release_desc:
 	/* Return ownership of the RX descriptor to the device. */
 	context->rx_desc.own = 1;
+	sys_cache_dma_to_device((vaddr_t)&context->rx_desc,
+				sizeof(context->rx_desc));
 
 	/* Request that the device check for an available RX descriptor, since
 	 * ownership of the descriptor was just transferred to the device.
@@ -101,6 +108,8 @@ static int eth_tx(struct device *port, struct net_buf *buf)
 
 	/* Wait until the TX descriptor is no longer owned by the device. */
 	while (context->tx_desc.own == 1) {
+		sys_cache_dma_from_device_end((vaddr_t)&context->tx_desc,
+					      sizeof(context->tx_desc));
 	}
 
 #ifdef CONFIG_ETHERNET_DEBUG
@@ -119,10 +128,13 @@ static int eth_tx(struct device *port, struct net_buf *buf)
 	}
 
 	memcpy((void *)context->tx_buf, uip_buf(buf), uip_len(buf));
+	sys_cache_dma_to_device((vaddr_t)context->tx_buf, uip_len(buf));
 
 	context->tx_desc.tx_buf1_sz = uip_len(buf);
 
 	context->tx_desc.own = 1;
+	sys_cache_dma_to_device((vaddr_t)&context->tx_desc,
+				sizeof(context->tx_desc));
 
 	/* Request that the device check for an available TX descriptor, since
 	 * ownership of the descriptor was just transferred to the device.
@@ -231,6 +243,11 @@ static int eth_initialize(struct device *port)
 	context->rx_desc.rx_buf1_sz = UIP_BUFSIZE;
 	context->rx_desc.rx_end_of_ring = 1;
 
+	sys_cache_dma_to_device((vaddr_t)&context->tx_desc,
+				sizeof(context->tx_desc));
+	sys_cache_dma_to_device((vaddr_t)&context->rx_desc,
+				sizeof(context->rx_desc));
+
 	/* Install transmit and receive descriptors. */
 	eth_write(base_addr, REG_ADDR_RX_DESC_LIST, (uint32_t)&context->rx_desc);
 	eth_write(base_addr, REG_ADDR_TX_DESC_LIST, (uint32_t)&context->tx_desc);
@@ -36,8 +36,16 @@ static int eth_enc28j60_soft_reset(struct device *dev)
 static void eth_enc28j60_set_bank(struct device *dev, uint16_t reg_addr)
 {
 	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint8_t bank = (reg_addr >> 8) & 0x0F;
 	uint8_t tx_buf[2];
 
+	/* Every bank switch goes through here: the selected bank is
+	 * known, and ECON1 only rewritten when it changes.
+	 */
+	if (bank == context->bank) {
+		return;
+	}
+
 	k_sem_take(&context->spi_sem, K_FOREVER);
 
 	tx_buf[0] = ENC28J60_SPI_RCR | ENC28J60_REG_ECON1;
@@ -46,10 +54,12 @@ static void eth_enc28j60_set_bank(struct device *dev, uint16_t reg_addr)
 	spi_transceive(context->spi, tx_buf, 2, tx_buf, 2);
 
 	tx_buf[0] = ENC28J60_SPI_WCR | ENC28J60_REG_ECON1;
-	tx_buf[1] = (tx_buf[1] & 0xFC) | ((reg_addr >> 8) & 0x0F);
+	tx_buf[1] = (tx_buf[1] & 0xFC) | bank;
 
 	spi_write(context->spi, tx_buf, 2);
 
+	context->bank = bank;
+
 	k_sem_give(&context->spi_sem);
 }
 
@@ -194,6 +204,29 @@ static void eth_enc28j60_read_mem(struct device *dev, uint8_t *data_buffer,
 	k_sem_give(&context->spi_sem);
 }
 
+/*
+ * Reads into the fragment in one transaction, without going through
+ * mem_buf: the RBM opcode is sent from the byte in front of the data,
+ * the fragment being reserved one byte of headroom.
+ */
+static void eth_enc28j60_read_frag(struct device *dev, struct net_buf *frag,
+				   uint16_t len)
+{
+	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint8_t *ptr = net_buf_tail(frag) - 1;
+	uint8_t save = *ptr;
+
+	k_sem_take(&context->spi_sem, K_FOREVER);
+
+	*ptr = ENC28J60_SPI_RBM;
+	spi_transceive(context->spi, ptr, len + 1, ptr, len + 1);
+	*ptr = save;
+
+	k_sem_give(&context->spi_sem);
+
+	net_buf_add(frag, len);
+}
+
 static void eth_enc28j60_write_phy(struct device *dev, uint16_t reg_addr,
 				   int16_t data)
 {
@@ -392,6 +425,9 @@ static int eth_enc28j60_init(struct device *dev)
 		return -EIO;
 	}
 
+	/* ECON1 back to its reset value */
+	context->bank = 0;
+
 	/* Errata B7/2 */
 	k_busy_wait(D10D24S);
 
@@ -424,38 +460,64 @@ static int eth_enc28j60_init(struct device *dev)
 	return 0;
 }
 
+/* Waits for the frame sent from the other TX buffer */
+static void eth_enc28j60_tx_wait(struct device *dev)
+{
+	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint8_t tx_status;
+
+	if (!context->tx_pending) {
+		return;
+	}
+
+	/* TXIF or TXERIF, cleared below for the next frame */
+	eth_enc28j60_read_reg(dev, ENC28J60_REG_EIR, &tx_status);
+
+	while (!(tx_status & (ENC28J60_BIT_EIR_TXIF |
+			      ENC28J60_BIT_EIR_TXERIF))) {
+		/* wait 10.24 useconds */
+		k_busy_wait(D10D24S);
+		eth_enc28j60_read_reg(dev, ENC28J60_REG_EIR, &tx_status);
+	}
+
+	context->tx_pending = false;
+
+	eth_enc28j60_read_reg(dev, ENC28J60_REG_ESTAT, &tx_status);
+	if (tx_status & ENC28J60_BIT_ESTAT_TXABRT) {
+		SYS_LOG_ERR("TX failed!");
+	}
+
+	eth_enc28j60_clear_eth_reg(dev, ENC28J60_REG_EIR,
+				   ENC28J60_BIT_EIR_TXIF |
+				   ENC28J60_BIT_EIR_TXERIF);
+}
+
+/*
+ * The frame is written into the free TX buffer while the previous one
+ * may still be on the wire, and the transmission is started without
+ * waiting for its end: the caller, and the RX path sharing tx_rx_sem,
+ * are only held for the time the SPI transfers take. The status of a
+ * frame is known once the next one is sent, failures are only logged.
+ */
 static int eth_enc28j60_tx(struct device *dev, struct net_buf *buf,
 			   uint16_t len)
 {
 	struct eth_enc28j60_runtime *context = dev->driver_data;
-	uint16_t tx_bufaddr = ENC28J60_TXSTART;
+	uint16_t tx_bufaddr;
 	bool first_frag = true;
 	uint8_t per_packet_control;
 	uint16_t tx_bufaddr_end;
 	struct net_buf *frag;
-	uint8_t tx_end;
 
 	k_sem_take(&context->tx_rx_sem, K_FOREVER);
 
-	/* Latest errata sheet: DS80349C
-	* always reset transmit logic (Errata Issue 12)
-	* the Microchip TCP/IP stack implementation used to first check
-	* whether TXERIF is set and only then reset the transmit logic
-	* but this has been changed in later versions; possibly they
-	* have a reason for this; they don't mention this in the errata
-	* sheet
-	*/
-	eth_enc28j60_set_eth_reg(dev, ENC28J60_REG_ECON1,
-				 ENC28J60_BIT_ECON1_TXRST);
-	eth_enc28j60_clear_eth_reg(dev, ENC28J60_REG_ECON1,
-				   ENC28J60_BIT_ECON1_TXRST);
+	tx_bufaddr = ENC28J60_TXSTART +
+		     context->tx_buf_idx * ENC28J60_TXBUF_SIZE;
 
 	/* Write the buffer content into the transmission buffer */
-	eth_enc28j60_set_bank(dev, ENC28J60_REG_ETXSTL);
+	eth_enc28j60_set_bank(dev, ENC28J60_REG_EWRPTL);
 	eth_enc28j60_write_reg(dev, ENC28J60_REG_EWRPTL, tx_bufaddr & 0xFF);
 	eth_enc28j60_write_reg(dev, ENC28J60_REG_EWRPTH, tx_bufaddr >> 8);
-	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXSTL, tx_bufaddr & 0xFF);
-	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXSTH, tx_bufaddr >> 8);
 
 	/* Write the data into the buffer */
 	per_packet_control = ENC28J60_PPCTL_BYTE;
@@ -477,7 +539,24 @@ static int eth_enc28j60_tx(struct device *dev, struct net_buf *buf,
 		eth_enc28j60_write_mem(dev, data_ptr, data_len);
 	}
 
+	eth_enc28j60_tx_wait(dev);
+
+	/* Latest errata sheet: DS80349C
+	* always reset transmit logic (Errata Issue 12)
+	* the Microchip TCP/IP stack implementation used to first check
+	* whether TXERIF is set and only then reset the transmit logic
+	* but this has been changed in later versions; possibly they
+	* have a reason for this; they don't mention this in the errata
+	* sheet
+	*/
+	eth_enc28j60_set_eth_reg(dev, ENC28J60_REG_ECON1,
+				 ENC28J60_BIT_ECON1_TXRST);
+	eth_enc28j60_clear_eth_reg(dev, ENC28J60_REG_ECON1,
+				   ENC28J60_BIT_ECON1_TXRST);
+
 	tx_bufaddr_end = tx_bufaddr + len;
+	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXSTL, tx_bufaddr & 0xFF);
+	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXSTH, tx_bufaddr >> 8);
 	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXNDL,
 			       tx_bufaddr_end & 0xFF);
 	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXNDH, tx_bufaddr_end >> 8);
@@ -486,142 +565,137 @@ static int eth_enc28j60_tx(struct device *dev, struct net_buf *buf,
 	eth_enc28j60_set_eth_reg(dev, ENC28J60_REG_ECON1,
 				 ENC28J60_BIT_ECON1_TXRTS);
 
-	do {
-		/* wait 10.24 useconds */
-		k_busy_wait(D10D24S);
-		eth_enc28j60_read_reg(dev, ENC28J60_REG_EIR, &tx_end);
-		tx_end &= ENC28J60_BIT_EIR_TXIF;
-	} while (!tx_end);
-
-	eth_enc28j60_read_reg(dev, ENC28J60_REG_ESTAT, &tx_end);
+	context->tx_pending = true;
+	context->tx_buf_idx ^= 1;
 
 	k_sem_give(&context->tx_rx_sem);
 
-	if (tx_end & ENC28J60_BIT_ESTAT_TXABRT) {
-		SYS_LOG_ERR("TX failed!");
-		return -EIO;
-	}
-
 	return 0;
 }
 
-static int eth_enc28j60_rx(struct device *dev)
+/* Reads one frame, ERDPT pointing at its next packet pointer */
+static void eth_enc28j60_rx_frame(struct device *dev)
 {
 	struct eth_enc28j60_runtime *context = dev->driver_data;
+	struct net_buf *last_frag;
+	struct net_buf *pkt_buf;
+	struct net_buf *buf;
+	uint16_t next_packet;
+	uint16_t rxrdpt;
+	uint16_t frm_len;
 	uint16_t lengthfr;
-	uint8_t counter;
 
-	/* Errata 6. The Receive Packet Pending Interrupt Flag (EIR.PKTIF)
-	 * does not reliably/accurately report the status of pending packet.
-	 * Use EPKTCNT register instead.
-	*/
+	/* Next packet pointer and reception status vector together */
+	eth_enc28j60_read_mem(dev, context->rx_rsv, NPP_SIZE + RSV_SIZE);
+	next_packet = context->rx_rsv[0] | (uint16_t)context->rx_rsv[1] << 8;
 
-	SYS_LOG_DBG("");
+	/* Get the frame length from the rx status vector,
+	 * minus CRC size at the end which is always present
+	 */
+	frm_len = ((context->rx_rsv[3] << 8) | context->rx_rsv[2]) - 4;
+	lengthfr = frm_len;
+
+	/* Get the frame from the buffer */
+	buf = net_nbuf_get_reserve_rx(0);
+	if (!buf) {
+		SYS_LOG_ERR("Could not allocate rx buffer");
+		goto skip;
+	}
 
-	k_sem_take(&context->tx_rx_sem, K_FOREVER);
+	last_frag = buf;
 
 	do {
-		struct net_buf *last_frag;
-		struct net_buf *pkt_buf = NULL;
-		uint16_t frm_len = 0;
-		struct net_buf *buf;
-		uint16_t next_packet;
-		uint8_t np[2];
-
-		/* Read address for next packet */
-		eth_enc28j60_read_mem(dev, np, 2);
-		next_packet = np[0] | (uint16_t)np[1] << 8;
-
-		/* Errata 14. Even values in ERXRDPT
-		 * may corrupt receive buffer.
+		size_t spi_frame_len;
+
+		/* Reserve a data frag to receive the frame, its headroom
+		 * byte for the SPI opcode
 		 */
-		if (next_packet == 0) {
-			next_packet = ENC28J60_RXEND;
-		} else if (!(next_packet & 0x01)) {
-			next_packet--;
+		pkt_buf = net_nbuf_get_reserve_data(1);
+		if (!pkt_buf) {
+			SYS_LOG_ERR("Could not allocate data buffer");
+			net_buf_unref(buf);
+
+			goto skip;
 		}
 
-		/* Read reception status vector */
-		eth_enc28j60_read_mem(dev, context->rx_rsv, 4);
+		net_buf_frag_insert(last_frag, pkt_buf);
+		last_frag = pkt_buf;
 
-		/* Get the frame length from the rx status vector,
-		 * minus CRC size at the end which is always present
-		 */
-		frm_len = (context->rx_rsv[1] << 8) | (context->rx_rsv[0] - 4);
-		lengthfr = frm_len;
-
-		/* Get the frame from the buffer */
-		buf = net_nbuf_get_reserve_rx(0);
-		if (!buf) {
-			SYS_LOG_ERR("Could not allocate rx buffer");
-			goto done;
-		}
+		spi_frame_len = min(frm_len, net_buf_tailroom(pkt_buf));
 
-		last_frag = buf;
+		eth_enc28j60_read_frag(dev, pkt_buf, spi_frame_len);
 
-		do {
-			size_t frag_len;
-			uint8_t *data_ptr;
-			size_t spi_frame_len;
+		/* One fragment has been written via SPI */
+		frm_len -= spi_frame_len;
+	} while (frm_len > 0);
 
-			/* Reserve a data frag to receive the frame */
-			pkt_buf = net_nbuf_get_reserve_data(0);
-			if (!pkt_buf) {
-				SYS_LOG_ERR("Could not allocate data buffer");
-				net_buf_unref(buf);
+	/* Let's pop the useless CRC, and the padding byte introduced by
+	 * the device when the frame length is odd, in one go
+	 */
+	eth_enc28j60_read_mem(dev, NULL, 4 + (lengthfr & 0x01));
 
-				goto done;
-			}
+	/* Feed buffer frame to IP stack */
+	SYS_LOG_DBG("Received packet of length %u", lengthfr);
+	if (net_recv_data(context->iface, buf) < 0) {
+		net_nbuf_unref(buf);
+	}
 
-			net_buf_frag_insert(last_frag, pkt_buf);
-			data_ptr = pkt_buf->data;
+	goto done;
 
-			last_frag = pkt_buf;
+skip:
+	/* The frame is left partly read: move to the next one */
+	eth_enc28j60_write_reg(dev, ENC28J60_REG_ERDPTL, next_packet & 0xFF);
+	eth_enc28j60_write_reg(dev, ENC28J60_REG_ERDPTH, next_packet >> 8);
 
-			/* Review the space available for the new frag */
-			frag_len = net_buf_tailroom(pkt_buf);
+done:
+	/* Errata 14. Even values in ERXRDPT
+	 * may corrupt receive buffer.
+	 */
+	if (next_packet == 0) {
+		rxrdpt = ENC28J60_RXEND;
+	} else if (!(next_packet & 0x01)) {
+		rxrdpt = next_packet - 1;
+	} else {
+		rxrdpt = next_packet;
+	}
 
-			if (frm_len > frag_len) {
-				spi_frame_len = frag_len;
-			} else {
-				spi_frame_len = frm_len;
-			}
+	/* Free buffer memory and decrement rx counter */
+	eth_enc28j60_write_reg(dev, ENC28J60_REG_ERXRDPTL, rxrdpt & 0xFF);
+	eth_enc28j60_write_reg(dev, ENC28J60_REG_ERXRDPTH, rxrdpt >> 8);
+	eth_enc28j60_set_eth_reg(dev, ENC28J60_REG_ECON2,
+				 ENC28J60_BIT_ECON2_PKTDEC);
+}
 
-			eth_enc28j60_read_mem(dev, data_ptr, spi_frame_len);
+static int eth_enc28j60_rx(struct device *dev)
+{
+	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint8_t counter;
 
-			net_buf_add(pkt_buf, spi_frame_len);
+	/* Errata 6. The Receive Packet Pending Interrupt Flag (EIR.PKTIF)
+	 * does not reliably/accurately report the status of pending packet.
+	 * Use EPKTCNT register instead.
+	*/
 
-			/* One fragment has been written via SPI */
-			frm_len -= spi_frame_len;
-		} while (frm_len > 0);
+	SYS_LOG_DBG("");
 
-		/* Let's pop the useless CRC */
-		eth_enc28j60_read_mem(dev, NULL, 4);
+	k_sem_take(&context->tx_rx_sem, K_FOREVER);
 
-		/* Pops one padding byte from spi circular buffer
-		 * introduced by the device when the frame length is odd
-		 */
-		if (lengthfr & 0x01) {
-			eth_enc28j60_read_mem(dev, NULL, 1);
+	/* All the frames counted are read within bank 0, before coming
+	 * back to bank 1 for the ones received meanwhile
+	 */
+	while (1) {
+		eth_enc28j60_set_bank(dev, ENC28J60_REG_EPKTCNT);
+		eth_enc28j60_read_reg(dev, ENC28J60_REG_EPKTCNT, &counter);
+		if (!counter) {
+			break;
 		}
 
-		/* Feed buffer frame to IP stack */
-		SYS_LOG_DBG("Received packet of length %u", lengthfr);
-		net_recv_data(context->iface, buf);
-done:
-		/* Free buffer memory and decrement rx counter */
 		eth_enc28j60_set_bank(dev, ENC28J60_REG_ERXRDPTL);
-		eth_enc28j60_write_reg(dev, ENC28J60_REG_ERXRDPTL,
-				       next_packet & 0xFF);
-		eth_enc28j60_write_reg(dev, ENC28J60_REG_ERXRDPTH,
-				       next_packet >> 8);
-		eth_enc28j60_set_eth_reg(dev, ENC28J60_REG_ECON2,
-					 ENC28J60_BIT_ECON2_PKTDEC);
-
-		/* Check if there are frames to clean from the buffer */
-		eth_enc28j60_set_bank(dev, ENC28J60_REG_EPKTCNT);
-		eth_enc28j60_read_reg(dev, ENC28J60_REG_EPKTCNT, &counter);
-	} while (counter);
+
+		while (counter--) {
+			eth_enc28j60_rx_frame(dev);
+		}
+	}
 
 	k_sem_give(&context->tx_rx_sem);
 
@@ -668,6 +742,53 @@ static int eth_net_tx(struct net_if *iface, struct net_buf *buf)
 	return ret;
 }
 
+static int eth_enc28j60_mcast_filter(struct device *dev,
+				     const struct net_eth_addr *addr, bool add)
+{
+	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint32_t crc = 0xFFFFFFFF;
+	uint8_t ptr, value;
+	int i, j;
+
+	/* Bits 28:23 of the Ethernet CRC of the address */
+	for (i = 0; i < sizeof(addr->addr); i++) {
+		for (j = 0; j < 8; j++) {
+			if ((crc >> 31) ^ ((addr->addr[i] >> j) & 1)) {
+				crc = (crc << 1) ^ 0x04C11DB7;
+			} else {
+				crc <<= 1;
+			}
+		}
+	}
+
+	ptr = (crc >> 23) & 0x3F;
+
+	k_sem_take(&context->tx_rx_sem, K_FOREVER);
+
+	if (add) {
+		context->mcast_refs[ptr]++;
+	} else if (context->mcast_refs[ptr]) {
+		context->mcast_refs[ptr]--;
+	}
+
+	/* Register of the bucket */
+	value = 0;
+	ptr &= ~0x07;
+
+	for (i = 0; i < 8; i++) {
+		if (context->mcast_refs[ptr + i]) {
+			value |= BIT(i);
+		}
+	}
+
+	eth_enc28j60_set_bank(dev, ENC28J60_REG_EHT0);
+	eth_enc28j60_write_reg(dev, ENC28J60_REG_EHT0 + (ptr >> 3), value);
+
+	k_sem_give(&context->tx_rx_sem);
+
+	return 0;
+}
+
 #ifdef CONFIG_ETH_ENC28J60_0
 
 static uint8_t mac_address_0[6] = { MICROCHIP_OUI_B0,
@@ -686,11 +807,14 @@ static void eth_enc28j60_iface_init_0(struct net_if *iface)
 
 	net_if_set_link_addr(iface, mac_address_0, sizeof(mac_address_0));
 	context->iface = iface;
+
+	atomic_set_bit(iface->flags, NET_IF_MCAST_FILTER);
 }
 
-static struct net_if_api api_funcs_0 = {
-	.init			= eth_enc28j60_iface_init_0,
-	.send			= eth_net_tx,
+static const struct ethernet_api api_funcs_0 = {
+	.iface_api.init		= eth_enc28j60_iface_init_0,
+	.iface_api.send		= eth_net_tx,
+	.mcast_filter		= eth_enc28j60_mcast_filter,
 };
 
 static struct eth_enc28j60_runtime eth_enc28j60_0_runtime;
@@ -171,9 +171,10 @@
 /*  Receive filters enabled:
  *  - Unicast
  *  - Broadcast
+ *  - Hash table, for the multicast addresses
  *  - CRC Check
  */
-#define ENC28J60_RECEIVE_FILTERS 0xA1
+#define ENC28J60_RECEIVE_FILTERS 0xA5
 
 /*  MAC configuration:
  *  - Automatic Padding
@@ -193,17 +194,22 @@
 
 /* Start of RX buffer, (must be zero, Rev. B4 Errata point 5) */
 #define ENC28J60_RXSTART 0x0000
-/* End of RX buffer, room for 2 packets */
-#define ENC28J60_RXEND 0x0BFF
+/* End of RX buffer, room for 3 packets */
+#define ENC28J60_RXEND 0x13FF
 
-/* Start of TX buffer, room for 1 packet */
-#define ENC28J60_TXSTART 0x0C00
-/* End of TX buffer */
-#define ENC28J60_TXEND 0x11FF
+/* Start of TX buffers, room for 1 packet each: a frame is written into
+ * one while the previous one is sent from the other
+ */
+#define ENC28J60_TXSTART 0x1400
+#define ENC28J60_TXBUF_SIZE 0x0600
+/* End of TX buffers */
+#define ENC28J60_TXEND 0x1FFF
 
 /* Status vectors array size */
 #define TSV_SIZE 7
 #define RSV_SIZE 4
+/* Next packet pointer preceding the RX status vector */
+#define NPP_SIZE 2
 
 /* Microchip's OUI*/
 #define MICROCHIP_OUI_B0 0x00
@@ -229,10 +235,18 @@ struct eth_enc28j60_runtime {
 	struct gpio_callback gpio_cb;
 	uint8_t mem_buf[MAX_BUFFER_LENGTH + 1];
 	uint8_t  tx_tsv[TSV_SIZE];
-	uint8_t  rx_rsv[RSV_SIZE];
+	uint8_t  rx_rsv[NPP_SIZE + RSV_SIZE];
+	/* Register bank selected in ECON1 */
+	uint8_t bank;
+	/* TX buffer the next frame is written into */
+	uint8_t tx_buf_idx;
+	/* The frame of the other TX buffer is being sent */
+	bool tx_pending;
 	struct k_sem tx_rx_sem;
 	struct k_sem int_sem;
 	struct k_sem spi_sem;
+	/* Multicast addresses in each bucket of the hash table */
+	uint8_t mcast_refs[64];
 };
 
 #endif /*_ENC28J60_*/
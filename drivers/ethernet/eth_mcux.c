@@ -25,6 +25,7 @@
 #include <kernel.h>
 #include <net/nbuf.h>
 #include <net/net_if.h>
+#include <net/ethernet.h>
 
 #include "fsl_enet.h"
 #include "fsl_phy.h"
@@ -35,25 +36,38 @@ struct eth_context {
 	enet_handle_t enet_handle;
 	struct k_sem tx_buf_sem;
 	uint8_t mac_addr[6];
-	/* TODO: FIXME. This Ethernet frame sized buffer is used for
-	 * interfacing with MCUX. How it works is that hardware uses
-	 * DMA scatter buffers to receive a frame, and then public
-	 * MCUX call gathers them into this buffer (there's no other
-	 * public interface). All this happens only for this driver
-	 * to scatter this buffer again into Zephyr fragment buffers.
-	 * This is not efficient, but proper resolution of this issue
-	 * depends on introduction of zero-copy networking support
-	 * in Zephyr, and adding needed interface to MCUX (or
-	 * bypassing it and writing a more complex driver working
-	 * directly with hardware).
+	/* This Ethernet frame sized buffer is used for interfacing
+	 * with MCUX. How it works is that hardware uses DMA scatter
+	 * buffers to receive a frame, and then public MCUX call
+	 * gathers them into this buffer (there's no other public
+	 * interface). All this happens only for this driver to
+	 * scatter this buffer again into Zephyr fragment buffers.
+	 * Received frames are therefore passed without copying when
+	 * possible, see eth_rx_zero_copy(), and this buffer is only
+	 * used as a fallback and for TX.
 	 */
 	uint8_t frame_buf[1500];
+#if CONFIG_ETH_MCUX_RX_SPARE_BUFFERS > 0
+	/* DMA buffers available to replace the ones lent to the stack */
+	struct k_lifo rx_spare;
+#endif
+#if defined(CONFIG_ETH_MCUX_TX_SG)
+	/* Packet released when each TX descriptor is done, if any */
+	struct net_buf *tx_bufs[CONFIG_ETH_MCUX_TX_BUFFERS];
+	/* First TX descriptor in use by the hardware */
+	volatile enet_tx_bd_struct_t *tx_dirty;
+	int tx_pending;
+#endif
+	/* Multicast addresses in each bucket of the hash filter */
+	uint8_t mcast_refs[64];
 };
 
 static void eth_0_config_func(void);
 
+static struct eth_context eth_0_context;
+
 static enet_rx_bd_struct_t __aligned(ENET_BUFF_ALIGNMENT)
-rx_buffer_desc[CONFIG_ETH_MCUX_TX_BUFFERS];
+rx_buffer_desc[CONFIG_ETH_MCUX_RX_BUFFERS];
 
 static enet_tx_bd_struct_t __aligned(ENET_BUFF_ALIGNMENT)
 tx_buffer_desc[CONFIG_ETH_MCUX_TX_BUFFERS];
@@ -70,15 +84,153 @@ rx_buffer[CONFIG_ETH_MCUX_RX_BUFFERS][ETH_MCUX_BUFFER_SIZE];
 static uint8_t __aligned(ENET_BUFF_ALIGNMENT)
 tx_buffer[CONFIG_ETH_MCUX_TX_BUFFERS][ETH_MCUX_BUFFER_SIZE];
 
+#if CONFIG_ETH_MCUX_RX_SPARE_BUFFERS > 0
+static uint8_t __aligned(ENET_BUFF_ALIGNMENT)
+rx_spare_buffer[CONFIG_ETH_MCUX_RX_SPARE_BUFFERS][ETH_MCUX_BUFFER_SIZE];
+
+static void rx_buffer_recycle(struct net_buf *buf);
+
+/* Each fragment lends one DMA buffer, replaced in the RX ring by a spare */
+NET_BUF_POOL_EXT_DEFINE(rx_ext_bufs, CONFIG_ETH_MCUX_RX_SPARE_BUFFERS,
+			CONFIG_NET_NBUF_USER_DATA_SIZE, rx_buffer_recycle);
+#endif
+
+#if defined(CONFIG_ETH_MCUX_TX_SG)
+static inline volatile enet_tx_bd_struct_t *
+next_tx_bd(enet_handle_t *handle, volatile enet_tx_bd_struct_t *bd)
+{
+	if (bd->control & ENET_BUFFDESCRIPTOR_TX_WRAP_MASK) {
+		return handle->txBdBase;
+	}
+
+	return bd + 1;
+}
+
+/* Must be called with interrupts locked */
+static inline void ready_tx_bd(volatile enet_tx_bd_struct_t *bd,
+			       uint8_t *data, uint16_t len, bool last)
+{
+	bd->buffer = data;
+	bd->length = len;
+	bd->control = (bd->control & ENET_BUFFDESCRIPTOR_TX_WRAP_MASK) |
+		ENET_BUFFDESCRIPTOR_TX_TRANMITCRC_MASK |
+		ENET_BUFFDESCRIPTOR_TX_READY_MASK |
+		(last ? ENET_BUFFDESCRIPTOR_TX_LAST_MASK : 0);
+}
+
+/* Release the descriptors the hardware is done with, and the packets
+ * whose fragments they pointed to. Called from the TX interrupt.
+ */
+static void eth_tx_reclaim(struct eth_context *context)
+{
+	enet_handle_t *handle = &context->enet_handle;
+	volatile enet_tx_bd_struct_t *bd;
+	int i;
+
+	while (context->tx_pending) {
+		bd = context->tx_dirty;
+		if (bd->control & ENET_BUFFDESCRIPTOR_TX_READY_MASK) {
+			break;
+		}
+
+		i = bd - handle->txBdBase;
+		if (context->tx_bufs[i]) {
+			net_nbuf_unref(context->tx_bufs[i]);
+			context->tx_bufs[i] = NULL;
+		}
+
+		context->tx_dirty = next_tx_bd(handle, bd);
+		context->tx_pending--;
+		k_sem_give(&context->tx_buf_sem);
+	}
+}
+
+/* Map each fragment to a TX descriptor, the first one also covering the
+ * link layer header. A packet with more fragments than descriptors is
+ * copied to the DMA buffer of a single descriptor instead.
+ */
 static int eth_tx(struct net_if *iface, struct net_buf *buf)
 {
 	struct eth_context *context = iface->dev->driver_data;
-	const struct net_buf *frag;
-	uint8_t *dst;
-	status_t status;
+	enet_handle_t *handle = &context->enet_handle;
+	volatile enet_tx_bd_struct_t *first, *bd;
+	struct net_buf *frag;
 	unsigned int imask;
+	int count = 0;
+	int i, len;
+
+	for (frag = buf->frags; frag; frag = frag->frags) {
+		count++;
+	}
+
+	if (count > CONFIG_ETH_MCUX_TX_BUFFERS) {
+		count = 1;
+	}
+
+	for (i = 0; i < count; i++) {
+		k_sem_take(&context->tx_buf_sem, K_FOREVER);
+	}
+
+	imask = irq_lock();
+
+	first = handle->txBdCurrent;
+	i = first - handle->txBdBase;
+
+	if (count == 1 && buf->frags->frags) {
+		len = net_nbuf_linearize(buf, tx_buffer[i],
+					 ETH_MCUX_BUFFER_SIZE);
+		if (len < 0) {
+			irq_unlock(imask);
+			k_sem_give(&context->tx_buf_sem);
+			SYS_LOG_ERR("frame too large (%u)",
+				    net_nbuf_ll_reserve(buf) +
+				    net_buf_frags_len(buf));
+			return len;
+		}
+
+		ready_tx_bd(first, tx_buffer[i], len, true);
+		bd = next_tx_bd(handle, first);
+
+		/* The packet is not needed anymore */
+		net_nbuf_unref(buf);
+	} else {
+		/* Make the first descriptor ready last, so that the
+		 * hardware does not start on a partial frame.
+		 */
+		frag = buf->frags;
+		bd = first;
 
-	uint16_t total_len = net_nbuf_ll_reserve(buf) + net_buf_frags_len(buf);
+		while ((frag = frag->frags)) {
+			bd = next_tx_bd(handle, bd);
+			ready_tx_bd(bd, frag->data, frag->len, !frag->frags);
+		}
+
+		/* The packet is released with its last descriptor */
+		context->tx_bufs[bd - handle->txBdBase] = buf;
+
+		bd = next_tx_bd(handle, bd);
+
+		ready_tx_bd(first, net_nbuf_ll(buf),
+			    net_nbuf_ll_reserve(buf) + buf->frags->len,
+			    count == 1);
+	}
+
+	handle->txBdCurrent = bd;
+	context->tx_pending += count;
+
+	ENET->TDAR = ENET_TDAR_TDAR_MASK;
+
+	irq_unlock(imask);
+
+	return 0;
+}
+#else
+static int eth_tx(struct net_if *iface, struct net_buf *buf)
+{
+	struct eth_context *context = iface->dev->driver_data;
+	status_t status;
+	unsigned int imask;
+	int len;
 
 	k_sem_take(&context->tx_buf_sem, K_FOREVER);
 
@@ -88,25 +240,20 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 	imask = irq_lock();
 
 	/* Gather fragment buffers into flat Ethernet frame buffer
-	 * which can be fed to MCUX Ethernet functions. First
-	 * fragment is special - it contains link layer (Ethernet
-	 * in our case) headers and must be treated specially.
+	 * which can be fed to MCUX Ethernet functions.
 	 */
-	dst = context->frame_buf;
-	memcpy(dst, net_nbuf_ll(buf),
-	       net_nbuf_ll_reserve(buf) + buf->frags->len);
-	dst += net_nbuf_ll_reserve(buf) + buf->frags->len;
-
-	/* Continue with the rest of fragments (which contain only data) */
-	frag = buf->frags->frags;
-	while (frag) {
-		memcpy(dst, frag->data, frag->len);
-		dst += frag->len;
-		frag = frag->frags;
+	len = net_nbuf_linearize(buf, context->frame_buf,
+				 sizeof(context->frame_buf));
+	if (len < 0) {
+		irq_unlock(imask);
+		k_sem_give(&context->tx_buf_sem);
+		SYS_LOG_ERR("frame too large (%u)",
+			    net_nbuf_ll_reserve(buf) + net_buf_frags_len(buf));
+		return len;
 	}
 
 	status = ENET_SendFrame(ENET, &context->enet_handle, context->frame_buf,
-				total_len);
+				len);
 
 	irq_unlock(imask);
 
@@ -118,6 +265,59 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 	net_nbuf_unref(buf);
 	return 0;
 }
+#endif /* CONFIG_ETH_MCUX_TX_SG */
+
+#if CONFIG_ETH_MCUX_RX_SPARE_BUFFERS > 0
+static void rx_buffer_recycle(struct net_buf *buf)
+{
+	struct eth_context *context = &eth_0_context;
+
+	/* The DMA buffer is free again, it becomes a spare */
+	k_lifo_put(&context->rx_spare, net_buf_ext_data(buf));
+
+	net_buf_destroy(buf);
+}
+
+/* Pass the frame to the stack in the DMA buffer it was received in,
+ * giving a spare buffer to the RX descriptor instead. This is only
+ * possible when the frame fits in a single descriptor.
+ */
+static bool eth_rx_zero_copy(struct eth_context *context,
+			     struct net_buf *buf, uint32_t frame_length)
+{
+	enet_handle_t *handle = &context->enet_handle;
+	volatile enet_rx_bd_struct_t *bd = handle->rxBdCurrent;
+	struct net_buf *frag;
+	uint8_t *spare;
+	status_t status;
+
+	if (!(bd->control & ENET_BUFFDESCRIPTOR_RX_LAST_MASK) ||
+	    frame_length != bd->length) {
+		return false;
+	}
+
+	spare = k_lifo_get(&context->rx_spare, K_NO_WAIT);
+	if (!spare) {
+		return false;
+	}
+
+	frag = net_nbuf_get_ext_data(&rx_ext_bufs, bd->buffer, frame_length);
+	if (!frag) {
+		k_lifo_put(&context->rx_spare, spare);
+		return false;
+	}
+
+	bd->buffer = spare;
+
+	/* Give the descriptor back to the hardware */
+	status = ENET_ReadFrame(ENET, handle, NULL, 0);
+	assert(status == kStatus_Success);
+
+	net_buf_frag_add(buf, frag);
+
+	return true;
+}
+#endif /* CONFIG_ETH_MCUX_RX_SPARE_BUFFERS > 0 */
 
 static void eth_rx(struct device *iface)
 {
@@ -160,6 +360,15 @@ static void eth_rx(struct device *iface)
 		return;
 	}
 
+#if CONFIG_ETH_MCUX_RX_SPARE_BUFFERS > 0
+	if (eth_rx_zero_copy(context, buf, frame_length)) {
+		if (net_recv_data(context->iface, buf) < 0) {
+			net_nbuf_unref(buf);
+		}
+		return;
+	}
+#endif
+
 	if (sizeof(context->frame_buf) < frame_length) {
 		SYS_LOG_ERR("frame too large (%d)\n", frame_length);
 		net_buf_unref(buf);
@@ -212,7 +421,9 @@ static void eth_rx(struct device *iface)
 
 	irq_unlock(imask);
 
-	net_recv_data(context->iface, buf);
+	if (net_recv_data(context->iface, buf) < 0) {
+		net_nbuf_unref(buf);
+	}
 }
 
 static void eth_callback(ENET_Type *base, enet_handle_t *handle,
@@ -227,7 +438,11 @@ static void eth_callback(ENET_Type *base, enet_handle_t *handle,
 		break;
 	case kENET_TxEvent:
 		/* Free the TX buffer. */
+#if defined(CONFIG_ETH_MCUX_TX_SG)
+		eth_tx_reclaim(context);
+#else
 		k_sem_give(&context->tx_buf_sem);
+#endif
 		break;
 	case kENET_ErrEvent:
 		/* Error event: BABR/BABT/EBERR/LC/RL/UN/PLR.  */
@@ -282,11 +497,25 @@ static int eth_0_init(struct device *dev)
 	k_sem_init(&context->tx_buf_sem,
 		   CONFIG_ETH_MCUX_TX_BUFFERS, CONFIG_ETH_MCUX_TX_BUFFERS);
 
+#if CONFIG_ETH_MCUX_RX_SPARE_BUFFERS > 0
+	k_lifo_init(&context->rx_spare);
+
+	for (int i = 0; i < CONFIG_ETH_MCUX_RX_SPARE_BUFFERS; i++) {
+		k_lifo_put(&context->rx_spare, rx_spare_buffer[i]);
+	}
+#endif
+
 	sys_clock = CLOCK_GetFreq(kCLOCK_CoreSysClk);
 
 	ENET_GetDefaultConfig(&enet_config);
 	enet_config.interrupt |= kENET_RxFrameInterrupt;
 	enet_config.interrupt |= kENET_TxFrameInterrupt;
+#if defined(CONFIG_ETH_MCUX_HW_CSUM)
+	enet_config.txAccelerConfig |= kENET_TxAccelIpCheckEnabled |
+				       kENET_TxAccelProtoCheckEnabled;
+	enet_config.rxAccelerConfig |= kENET_RxAccelIpCheckEnabled |
+				       kENET_RxAccelProtoCheckEnabled;
+#endif
 
 	status = PHY_Init(ENET, phy_addr, sys_clock);
 	if (status) {
@@ -326,12 +555,63 @@ static int eth_0_init(struct device *dev)
 		    context->mac_addr[2], context->mac_addr[3],
 		    context->mac_addr[4], context->mac_addr[5]);
 
+#if defined(CONFIG_ETH_MCUX_TX_SG)
+	context->tx_dirty = context->enet_handle.txBdBase;
+#endif
+
 	ENET_SetCallback(&context->enet_handle, eth_callback, dev);
 	eth_0_config_func();
 	ENET_ActiveRead(ENET);
 	return 0;
 }
 
+/* The HAL helpers overwrite the hash filter with the bucket of the last
+ * address and clear buckets still shared with other addresses: the
+ * buckets are reference counted here instead.
+ */
+static int eth_mcast_filter(struct device *dev,
+			    const struct net_eth_addr *addr, bool add)
+{
+	struct eth_context *context = dev->driver_data;
+	uint32_t crc = 0xffffffff;
+	unsigned int key;
+	uint8_t hash;
+	int i, j;
+
+	for (i = 0; i < sizeof(addr->addr); i++) {
+		crc ^= addr->addr[i];
+		for (j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+		}
+	}
+
+	/* Six upper bits: GAUR for the upper half, GALR for the lower */
+	hash = crc >> 26;
+
+	key = irq_lock();
+
+	if (add) {
+		if (context->mcast_refs[hash]++ == 0) {
+			if (hash & 0x20) {
+				ENET->GAUR |= BIT(hash & 0x1f);
+			} else {
+				ENET->GALR |= BIT(hash & 0x1f);
+			}
+		}
+	} else if (context->mcast_refs[hash] &&
+		   --context->mcast_refs[hash] == 0) {
+		if (hash & 0x20) {
+			ENET->GAUR &= ~BIT(hash & 0x1f);
+		} else {
+			ENET->GALR &= ~BIT(hash & 0x1f);
+		}
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
 static void eth_0_iface_init(struct net_if *iface)
 {
 	struct device *dev = net_if_get_device(iface);
@@ -340,11 +620,21 @@ static void eth_0_iface_init(struct net_if *iface)
 	net_if_set_link_addr(iface, context->mac_addr,
 			     sizeof(context->mac_addr));
 	context->iface = iface;
+
+#if defined(CONFIG_ETH_MCUX_TX_SG)
+	atomic_set_bit(iface->flags, NET_IF_TX_SG);
+#endif
+#if defined(CONFIG_ETH_MCUX_HW_CSUM)
+	atomic_set_bit(iface->flags, NET_IF_TX_CSUM);
+	atomic_set_bit(iface->flags, NET_IF_RX_CSUM);
+#endif
+	atomic_set_bit(iface->flags, NET_IF_MCAST_FILTER);
 }
 
-static struct net_if_api api_funcs_0 = {
-	.init	= eth_0_iface_init,
-	.send	= eth_tx,
+static const struct ethernet_api api_funcs_0 = {
+	.iface_api.init	= eth_0_iface_init,
+	.iface_api.send	= eth_tx,
+	.mcast_filter	= eth_mcast_filter,
 };
 
 static void eth_mcux_rx_isr(void *p)
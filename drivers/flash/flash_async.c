@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <init.h>
+#include <flash.h>
+
+enum {
+	FLASH_OP_WRITE,
+	FLASH_OP_ERASE,
+};
+
+static struct k_work_q flash_async_work_q;
+static char __stack flash_async_stack[CONFIG_FLASH_ASYNC_STACK_SIZE];
+
+static sys_slist_t pending;
+static struct k_work pending_work;
+
+static void trans_run(struct flash_transaction *trans)
+{
+	int status;
+
+	/* Not all drivers implement write protection, failing is fine */
+	flash_write_protection_set(trans->dev, false);
+
+	if (trans->op == FLASH_OP_WRITE) {
+		status = flash_write(trans->dev, trans->offset, trans->data,
+				     trans->len);
+	} else {
+		status = flash_erase(trans->dev, trans->offset, trans->len);
+	}
+
+	flash_write_protection_set(trans->dev, true);
+
+	if (trans->cb) {
+		trans->cb(trans->dev, status, trans->user_data);
+	}
+}
+
+static void pending_run(struct k_work *work)
+{
+	sys_snode_t *node;
+	unsigned int key;
+
+	while (1) {
+		key = irq_lock();
+		node = sys_slist_get(&pending);
+		irq_unlock(key);
+
+		if (!node) {
+			return;
+		}
+
+		trans_run(CONTAINER_OF(node, struct flash_transaction, node));
+	}
+}
+
+static int trans_submit(struct device *dev, struct flash_transaction *trans,
+			uint8_t op)
+{
+	unsigned int key;
+
+	trans->dev = dev;
+	trans->op = op;
+
+	key = irq_lock();
+	sys_slist_append(&pending, &trans->node);
+	irq_unlock(key);
+
+	k_work_submit_to_queue(&flash_async_work_q, &pending_work);
+
+	return 0;
+}
+
+int flash_write_async(struct device *dev, struct flash_transaction *trans)
+{
+	return trans_submit(dev, trans, FLASH_OP_WRITE);
+}
+
+int flash_erase_async(struct device *dev, struct flash_transaction *trans)
+{
+	return trans_submit(dev, trans, FLASH_OP_ERASE);
+}
+
+static int flash_async_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	sys_slist_init(&pending);
+	k_work_init(&pending_work, pending_run);
+
+	k_work_q_start(&flash_async_work_q, flash_async_stack,
+		       sizeof(flash_async_stack), CONFIG_FLASH_ASYNC_PRIORITY);
+
+	return 0;
+}
+
+SYS_INIT(flash_async_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
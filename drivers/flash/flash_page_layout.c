@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <flash.h>
+
+/* Look the page up by offset if by_offset, by index otherwise */
+static int page_info_get(struct device *dev, off_t offset, uint32_t index,
+			 bool by_offset, struct flash_pages_info *info)
+{
+	const struct flash_pages_layout *layout;
+	size_t layout_size;
+	uint32_t first = 0;
+	size_t i;
+
+	if (flash_page_layout_get(dev, &layout, &layout_size)) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < layout_size; i++, layout++) {
+		off_t end = layout->start +
+			    layout->pages_count * layout->pages_size;
+		uint32_t n;
+
+		if (by_offset) {
+			if (offset < layout->start || offset >= end) {
+				first += layout->pages_count;
+				continue;
+			}
+
+			n = (offset - layout->start) / layout->pages_size;
+		} else {
+			if (index >= first + layout->pages_count) {
+				first += layout->pages_count;
+				continue;
+			}
+
+			n = index - first;
+		}
+
+		info->start_offset = layout->start + n * layout->pages_size;
+		info->size = layout->pages_size;
+		info->index = first + n;
+
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+int flash_get_page_info_by_offs(struct device *dev, off_t offset,
+				struct flash_pages_info *info)
+{
+	return page_info_get(dev, offset, 0, true, info);
+}
+
+int flash_get_page_info_by_idx(struct device *dev, uint32_t index,
+			       struct flash_pages_info *info)
+{
+	return page_info_get(dev, 0, index, false, info);
+}
+
+size_t flash_get_page_count(struct device *dev)
+{
+	const struct flash_pages_layout *layout;
+	size_t layout_size;
+	size_t count = 0;
+	size_t i;
+
+	if (flash_page_layout_get(dev, &layout, &layout_size)) {
+		return 0;
+	}
+
+	for (i = 0; i < layout_size; i++) {
+		count += layout[i].pages_count;
+	}
+
+	return count;
+}
@@ -124,11 +124,31 @@ static int flash_stm32_init(struct device *dev)
 	return 0;
 }
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+static const struct flash_pages_layout flash_stm32_layout = {
+	.pages_count = (CONFIG_FLASH_SIZE * 1024) / CONFIG_FLASH_PAGE_SIZE,
+	.pages_size = CONFIG_FLASH_PAGE_SIZE,
+};
+
+static void flash_stm32_pages_layout(struct device *dev,
+				     const struct flash_pages_layout **layout,
+				     size_t *layout_size)
+{
+	*layout = &flash_stm32_layout;
+	*layout_size = 1;
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 static const struct flash_driver_api flash_stm32_api = {
 	.read = flash_stm32_read,
 	.write = flash_stm32_write,
 	.erase = flash_stm32_erase,
 	.write_protection = flash_stm32_protection_set,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = flash_stm32_pages_layout,
+#endif
+	/* Programming is done by half-words */
+	.write_block_size = sizeof(uint16_t),
 };
 
 static const struct flash_stm32_dev_config flash_device_config = {
@@ -87,11 +87,29 @@ static int flash_mcux_write_protection(struct device *dev, bool enable)
 
 static struct flash_priv flash_data;
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+/* Filled in at init from the configuration reported by the flash driver */
+static struct flash_pages_layout dev_layout;
+
+static void flash_mcux_pages_layout(struct device *dev,
+				    const struct flash_pages_layout **layout,
+				    size_t *layout_size)
+{
+	*layout = &dev_layout;
+	*layout_size = 1;
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 static const struct flash_driver_api flash_mcux_api = {
 	.write_protection = flash_mcux_write_protection,
 	.erase = flash_mcux_erase,
 	.write = flash_mcux_write,
 	.read = flash_mcux_read,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = flash_mcux_pages_layout,
+#endif
+	/* Programming is done by whole, aligned, phrases */
+	.write_block_size = FSL_FEATURE_FLASH_PFLASH_BLOCK_WRITE_UNIT_SIZE,
 };
 
 static int flash_mcux_init(struct device *dev)
@@ -101,6 +119,12 @@ static int flash_mcux_init(struct device *dev)
 
 	rc = FLASH_Init(&priv->config);
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	dev_layout.pages_size = priv->config.PFlashSectorSize;
+	dev_layout.pages_count = priv->config.PFlashTotalSize /
+				 priv->config.PFlashSectorSize;
+#endif
+
 	return (rc == kStatus_Success) ? 0 : -EIO;
 }
 
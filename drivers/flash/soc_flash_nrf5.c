@@ -143,17 +143,39 @@ static int flash_nrf5_write_protection(struct device *dev, bool enable)
 	return 0;
 }
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+/* Filled in at init from the factory information registers */
+static struct flash_pages_layout dev_layout;
+
+static void flash_nrf5_pages_layout(struct device *dev,
+				    const struct flash_pages_layout **layout,
+				    size_t *layout_size)
+{
+	*layout = &dev_layout;
+	*layout_size = 1;
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 static const struct flash_driver_api flash_nrf5_api = {
 	.read = flash_nrf5_read,
 	.write = flash_nrf5_write,
 	.erase = flash_nrf5_erase,
 	.write_protection = flash_nrf5_write_protection,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = flash_nrf5_pages_layout,
+#endif
+	.write_block_size = sizeof(uint32_t),
 };
 
 static int nrf5_flash_init(struct device *dev)
 {
 	dev->driver_api = &flash_nrf5_api;
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	dev_layout.pages_count = NRF_FICR->CODESIZE;
+	dev_layout.pages_size = NRF_FICR->CODEPAGESIZE;
+#endif
+
 	return 0;
 }
 
@@ -262,11 +262,45 @@ static int flash_qmsi_write_protection(struct device *dev, bool enable)
 	return 0;
 }
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+static const struct flash_pages_layout dev_layout[] = {
+	{
+		.start = QM_FLASH_REGION_SYS_0_BASE,
+		.pages_count = CONFIG_SOC_FLASH_QMSI_SYS_SIZE >>
+			       QM_FLASH_PAGE_SIZE_BITS,
+		.pages_size = QM_FLASH_PAGE_SIZE_BYTES,
+	},
+#if defined(CONFIG_SOC_QUARK_D2000)
+	{
+		.start = QM_FLASH_REGION_DATA_0_BASE,
+		.pages_count = QM_FLASH_REGION_DATA_0_SIZE >>
+			       QM_FLASH_PAGE_SIZE_BITS,
+		.pages_size = QM_FLASH_PAGE_SIZE_BYTES,
+	},
+#endif
+};
+
+static void flash_qmsi_pages_layout(struct device *dev,
+				    const struct flash_pages_layout **layout,
+				    size_t *layout_size)
+{
+	ARG_UNUSED(dev);
+
+	*layout = dev_layout;
+	*layout_size = ARRAY_SIZE(dev_layout);
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 static const struct flash_driver_api flash_qmsi_api = {
 	.read = flash_qmsi_read,
 	.write = flash_qmsi_write,
 	.erase = flash_qmsi_erase,
 	.write_protection = flash_qmsi_write_protection,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = flash_qmsi_pages_layout,
+#endif
+	/* Only whole, aligned, words can be written */
+	.write_block_size = sizeof(uint32_t),
 };
 
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
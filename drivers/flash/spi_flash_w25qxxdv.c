@@ -10,6 +10,7 @@
 #include <spi.h>
 #include <init.h>
 #include <string.h>
+#include <misc/util.h>
 #include "spi_flash_w25qxxdv_defs.h"
 #include "spi_flash_w25qxxdv.h"
 
@@ -56,7 +57,7 @@ static int spi_flash_wb_config(struct device *dev)
 		return -EIO;
 	}
 
-	return spi_flash_wb_id(dev);
+	return 0;
 }
 
 static int spi_flash_wb_reg_read(struct device *dev, uint8_t *data)
@@ -73,27 +74,40 @@ static int spi_flash_wb_reg_read(struct device *dev, uint8_t *data)
 	return 0;
 }
 
-static inline void wait_for_flash_idle(struct device *dev)
+/* Poll the status register until the current operation is done, sleeping
+ * interval milliseconds in between or just spinning if interval is 0.
+ */
+static int wait_for_flash_idle_interval(struct device *dev, int32_t interval)
 {
 	uint8_t buf[2];
 
-	buf[0] = W25QXXDV_CMD_RDSR;
-	spi_flash_wb_reg_read(dev, buf);
-
-	while (buf[1] & W25QXXDV_WIP_BIT) {
+	while (1) {
 		buf[0] = W25QXXDV_CMD_RDSR;
-		spi_flash_wb_reg_read(dev, buf);
+		if (spi_flash_wb_reg_read(dev, buf) != 0) {
+			return -EIO;
+		}
+
+		if (!(buf[1] & W25QXXDV_WIP_BIT)) {
+			return 0;
+		}
+
+		if (interval) {
+			k_sleep(interval);
+		}
 	}
 }
 
-static int spi_flash_wb_reg_write(struct device *dev, uint8_t *data)
+static inline int wait_for_flash_idle(struct device *dev)
+{
+	return wait_for_flash_idle_interval(dev, 0);
+}
+
+static int spi_flash_wb_cmd(struct device *dev, uint8_t opcode)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t buf;
 
-	wait_for_flash_idle(dev);
-
-	if (spi_transceive(driver_data->spi, data, 1,
+	if (spi_transceive(driver_data->spi, &opcode, 1,
 			   &buf /*dummy */, 1) != 0) {
 		return -EIO;
 	}
@@ -101,13 +115,106 @@ static int spi_flash_wb_reg_write(struct device *dev, uint8_t *data)
 	return 0;
 }
 
+static int spi_flash_wb_reg_write(struct device *dev, uint8_t *data)
+{
+	if (wait_for_flash_idle(dev) != 0) {
+		return -EIO;
+	}
+
+	return spi_flash_wb_cmd(dev, *data);
+}
+
+#ifdef CONFIG_SPI_FLASH_W25QXXDV_ERASE_SUSPEND
+/* Suspend the erase in progress if any, returns true if it was */
+static bool spi_flash_wb_erase_suspend(struct device *dev)
+{
+	struct spi_flash_data *const driver_data = dev->driver_data;
+	uint8_t buf[2];
+
+	if (!driver_data->erasing) {
+		return false;
+	}
+
+	buf[0] = W25QXXDV_CMD_RDSR;
+	if (spi_flash_wb_reg_read(dev, buf) != 0 ||
+	    !(buf[1] & W25QXXDV_WIP_BIT)) {
+		return false;
+	}
+
+	if (spi_flash_wb_cmd(dev, W25QXXDV_CMD_PGM_ERS_S) != 0) {
+		return false;
+	}
+
+	/* The erase is suspended once the flash reports being idle */
+	wait_for_flash_idle(dev);
+
+	buf[0] = W25QXXDV_CMD_RDSR2;
+	if (spi_flash_wb_reg_read(dev, buf) != 0) {
+		return false;
+	}
+
+	return buf[1] & W25QXXDV_SUS_BIT;
+}
+
+static void spi_flash_wb_erase_resume(struct device *dev)
+{
+	spi_flash_wb_cmd(dev, W25QXXDV_CMD_PGM_ERS_R);
+}
+#endif /* CONFIG_SPI_FLASH_W25QXXDV_ERASE_SUSPEND */
+
+#if defined(CONFIG_SPI_ASYNC)
+/* Read the whole range in one transaction straight into the caller buffer,
+ * so that it is neither split in MAX_DATA_LEN chunks nor copied around.
+ * -ENOTSUP if the controller cannot chain buffers.
+ */
+static int spi_flash_wb_read_direct(struct device *dev, off_t offset,
+				    void *data, size_t len)
+{
+	struct spi_flash_data *const driver_data = dev->driver_data;
+	uint8_t *buf = driver_data->buf;
+	struct spi_buf tx[1];
+	struct spi_buf rx[2];
+	struct spi_transaction trans = { 0 };
+	int ret;
+
+	buf[0] = W25QXXDV_CMD_READ_DATA;
+	buf[1] = (uint8_t) (offset >> 16);
+	buf[2] = (uint8_t) (offset >> 8);
+	buf[3] = (uint8_t) offset;
+	memset(buf + W25QXXDV_LEN_CMD_ADDRESS, 0,
+	       W25QXXDV_LEN_READ - W25QXXDV_LEN_CMD_ADDRESS);
+
+	tx[0].buf = buf;
+	tx[0].len = W25QXXDV_LEN_READ;
+	rx[0].buf = NULL;
+	rx[0].len = W25QXXDV_LEN_READ;
+	rx[1].buf = data;
+	rx[1].len = len;
+
+	trans.tx_bufs = tx;
+	trans.tx_count = ARRAY_SIZE(tx);
+	trans.rx_bufs = rx;
+	trans.rx_count = ARRAY_SIZE(rx);
+
+	ret = spi_transceive_bufs(driver_data->spi, &trans);
+	if (ret && ret != -ENOTSUP) {
+		return -EIO;
+	}
+
+	return ret;
+}
+#endif
+
 static int spi_flash_wb_read(struct device *dev, off_t offset, void *data,
 			     size_t len)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t *buf = driver_data->buf;
+	bool suspended = false;
+	int ret = 0;
 
-	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN || offset < 0) {
+	if (offset < 0 ||
+	    (offset + len) > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE) {
 		return -ENODEV;
 	}
 
@@ -118,26 +225,61 @@ static int spi_flash_wb_read(struct device *dev, off_t offset, void *data,
 		return -EIO;
 	}
 
-	wait_for_flash_idle(dev);
+#ifdef CONFIG_SPI_FLASH_W25QXXDV_ERASE_SUSPEND
+	suspended = spi_flash_wb_erase_suspend(dev);
+#endif
 
-	buf[0] = W25QXXDV_CMD_READ;
-	buf[1] = (uint8_t) (offset >> 16);
-	buf[2] = (uint8_t) (offset >> 8);
-	buf[3] = (uint8_t) offset;
+	if (!suspended) {
+		/* Don't spin for the whole duration of an erase */
+		ret = wait_for_flash_idle_interval(dev, driver_data->erasing ?
+				CONFIG_SPI_FLASH_W25QXXDV_POLL_INTERVAL : 0);
+	}
+
+#if defined(CONFIG_SPI_ASYNC)
+	if (!ret) {
+		ret = spi_flash_wb_read_direct(dev, offset, data, len);
+		if (ret != -ENOTSUP) {
+			len = 0;
+		} else {
+			ret = 0;
+		}
+	}
+#endif
 
-	memset(buf + W25QXXDV_LEN_CMD_ADDRESS, 0, len);
+	while (len && !ret) {
+		size_t chunk = min(len, CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN);
 
-	if (spi_transceive(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS,
-			   buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		buf[0] = W25QXXDV_CMD_READ_DATA;
+		buf[1] = (uint8_t) (offset >> 16);
+		buf[2] = (uint8_t) (offset >> 8);
+		buf[3] = (uint8_t) offset;
+
+		memset(buf + W25QXXDV_LEN_CMD_ADDRESS, 0,
+		       chunk + W25QXXDV_LEN_READ - W25QXXDV_LEN_CMD_ADDRESS);
+
+		if (spi_transceive(driver_data->spi,
+				   buf, chunk + W25QXXDV_LEN_READ,
+				   buf, chunk + W25QXXDV_LEN_READ) != 0) {
+			ret = -EIO;
+			break;
+		}
+
+		memcpy(data, buf + W25QXXDV_LEN_READ, chunk);
+
+		data = (uint8_t *)data + chunk;
+		offset += chunk;
+		len -= chunk;
 	}
 
-	memcpy(data, buf + W25QXXDV_LEN_CMD_ADDRESS, len);
+#ifdef CONFIG_SPI_FLASH_W25QXXDV_ERASE_SUSPEND
+	if (suspended) {
+		spi_flash_wb_erase_resume(dev);
+	}
+#endif
 
 	k_sem_give(&driver_data->sem);
 
-	return 0;
+	return ret;
 }
 
 static int spi_flash_wb_write(struct device *dev, off_t offset,
@@ -145,16 +287,21 @@ static int spi_flash_wb_write(struct device *dev, off_t offset,
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t *buf = driver_data->buf;
+	uint8_t opcode;
+	bool first = true;
+	int ret = 0;
 
-	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN || offset < 0) {
+	if (offset < 0 ||
+	    (offset + len) > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE) {
 		return -ENOTSUP;
 	}
 
+	k_sem_take(&driver_data->lock, K_FOREVER);
 	k_sem_take(&driver_data->sem, K_FOREVER);
 
 	if (spi_flash_wb_config(dev) != 0) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		ret = -EIO;
+		goto out;
 	}
 
 	wait_for_flash_idle(dev);
@@ -163,47 +310,73 @@ static int spi_flash_wb_write(struct device *dev, off_t offset,
 	spi_flash_wb_reg_read(dev, buf);
 
 	if (!(buf[1] & W25QXXDV_WEL_BIT)) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		ret = -EIO;
+		goto out;
 	}
 
-	wait_for_flash_idle(dev);
-
-	buf[0] = W25QXXDV_CMD_PP;
-	buf[1] = (uint8_t) (offset >> 16);
-	buf[2] = (uint8_t) (offset >> 8);
-	buf[3] = (uint8_t) offset;
+	while (len) {
+		/* A page program wraps around at the end of the page */
+		size_t chunk = min(len, W25QXXDV_PAGE_SIZE -
+					(offset & W25QXXDV_PAGE_MASK));
+
+		chunk = min(chunk, CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN);
+
+		/* Filled in while the flash is still busy with the previous
+		 * page, which is only waited for right before the next one.
+		 */
+		buf[0] = W25QXXDV_CMD_PP;
+		buf[1] = (uint8_t) (offset >> 16);
+		buf[2] = (uint8_t) (offset >> 8);
+		buf[3] = (uint8_t) offset;
+
+		memcpy(buf + W25QXXDV_LEN_CMD_ADDRESS, data, chunk);
+
+		/* Assume write protection has been disabled for the first
+		 * page. Note that w25qxxdv flash automatically turns on
+		 * write protection at the completion of each write or erase
+		 * transaction, so it is lifted again for the next pages.
+		 */
+		if (!first) {
+			opcode = W25QXXDV_CMD_WREN;
+			if (spi_flash_wb_reg_write(dev, &opcode) != 0) {
+				ret = -EIO;
+				break;
+			}
+		}
 
-	memcpy(buf + W25QXXDV_LEN_CMD_ADDRESS, data, len);
+		if (spi_write(driver_data->spi, buf,
+			      chunk + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
+			ret = -EIO;
+			break;
+		}
 
-	/* Assume write protection has been disabled. Note that w25qxxdv
-	 * flash automatically turns on write protection at the completion
-	 * of each write or erase transaction.
-	 */
-	if (spi_write(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		data = (const uint8_t *)data + chunk;
+		offset += chunk;
+		len -= chunk;
+		first = false;
 	}
 
+out:
 	k_sem_give(&driver_data->sem);
+	k_sem_give(&driver_data->lock);
 
-	return 0;
+	return ret;
 }
 
 static int spi_flash_wb_write_protection_set(struct device *dev, bool enable)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t buf = 0;
+	int ret = 0;
 
+	k_sem_take(&driver_data->lock, K_FOREVER);
 	k_sem_take(&driver_data->sem, K_FOREVER);
 
 	if (spi_flash_wb_config(dev) != 0) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		ret = -EIO;
+		goto out;
 	}
 
-	wait_for_flash_idle(dev);
-
 	if (enable) {
 		buf = W25QXXDV_CMD_WRDI;
 	} else {
@@ -211,13 +384,14 @@ static int spi_flash_wb_write_protection_set(struct device *dev, bool enable)
 	}
 
 	if (spi_flash_wb_reg_write(dev, &buf) != 0) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		ret = -EIO;
 	}
 
+out:
 	k_sem_give(&driver_data->sem);
+	k_sem_give(&driver_data->lock);
 
-	return 0;
+	return ret;
 }
 
 static inline int spi_flash_wb_erase_internal(struct device *dev,
@@ -232,13 +406,11 @@ static inline int spi_flash_wb_erase_internal(struct device *dev,
 		return -ENOTSUP;
 	}
 
-	wait_for_flash_idle(dev);
-
 	/* write enable */
 	buf[0] = W25QXXDV_CMD_WREN;
-	spi_flash_wb_reg_write(dev, buf);
-
-	wait_for_flash_idle(dev);
+	if (spi_flash_wb_reg_write(dev, buf) != 0) {
+		return -EIO;
+	}
 
 	switch (size) {
 	case W25QXXDV_SECTOR_SIZE:
@@ -274,6 +446,55 @@ static inline int spi_flash_wb_erase_internal(struct device *dev,
 	return spi_write(driver_data->spi, buf, len);
 }
 
+/* Largest erase unit that starts at offset and fits in size */
+static inline uint32_t spi_flash_wb_erase_size(uint32_t offset, uint32_t size)
+{
+	if (!offset && size == CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE) {
+		return CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE;
+	}
+
+	if (!(offset & W25QXXDV_BLOCK_MASK) && size >= W25QXXDV_BLOCK_SIZE) {
+		return W25QXXDV_BLOCK_SIZE;
+	}
+
+	if (!(offset & W25QXXDV_BLOCK32K_MASK) &&
+	    size >= W25QXXDV_BLOCK32K_SIZE) {
+		return W25QXXDV_BLOCK32K_SIZE;
+	}
+
+	return W25QXXDV_SECTOR_SIZE;
+}
+
+/* Wait for an erase to complete, giving the bus away in between polls so
+ * that reads can go on meanwhile.
+ */
+static int spi_flash_wb_erase_wait(struct device *dev)
+{
+	struct spi_flash_data *const driver_data = dev->driver_data;
+	uint8_t buf[2];
+	int ret;
+
+	while (1) {
+		k_sem_give(&driver_data->sem);
+		k_sleep(CONFIG_SPI_FLASH_W25QXXDV_POLL_INTERVAL);
+		k_sem_take(&driver_data->sem, K_FOREVER);
+
+		buf[0] = W25QXXDV_CMD_RDSR;
+		ret = spi_flash_wb_config(dev);
+		if (!ret) {
+			ret = spi_flash_wb_reg_read(dev, buf);
+		}
+
+		if (ret) {
+			return -EIO;
+		}
+
+		if (!(buf[1] & W25QXXDV_WIP_BIT)) {
+			return 0;
+		}
+	}
+}
+
 static int spi_flash_wb_erase(struct device *dev, off_t offset, size_t size)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
@@ -281,6 +502,7 @@ static int spi_flash_wb_erase(struct device *dev, off_t offset, size_t size)
 	int ret = 0;
 	uint32_t new_offset = offset;
 	uint32_t size_remaining = size;
+	uint32_t erase_size;
 
 	if ((offset < 0) || ((offset & W25QXXDV_SECTOR_MASK) != 0) ||
 	    ((size + offset) > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE) ||
@@ -288,62 +510,77 @@ static int spi_flash_wb_erase(struct device *dev, off_t offset, size_t size)
 		return -ENODEV;
 	}
 
+	k_sem_take(&driver_data->lock, K_FOREVER);
 	k_sem_take(&driver_data->sem, K_FOREVER);
 
 	if (spi_flash_wb_config(dev) != 0) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		ret = -EIO;
+		goto out;
 	}
 
+	wait_for_flash_idle(dev);
+
 	buf[0] = W25QXXDV_CMD_RDSR;
 	spi_flash_wb_reg_read(dev, buf);
 
 	if (!(buf[1] & W25QXXDV_WEL_BIT)) {
-		k_sem_give(&driver_data->sem);
-		return -EIO;
+		ret = -EIO;
+		goto out;
 	}
 
 	while ((size_remaining >= W25QXXDV_SECTOR_SIZE) && (ret == 0)) {
-		if (size_remaining == CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE) {
-			ret = spi_flash_wb_erase_internal(dev, offset, size);
+		erase_size = spi_flash_wb_erase_size(new_offset,
+						     size_remaining);
+
+		ret = spi_flash_wb_erase_internal(dev, new_offset, erase_size);
+		if (ret) {
 			break;
 		}
 
-		if (size_remaining >= W25QXXDV_BLOCK_SIZE) {
-			ret = spi_flash_wb_erase_internal(dev, new_offset,
-							  W25QXXDV_BLOCK_SIZE);
-			new_offset += W25QXXDV_BLOCK_SIZE;
-			size_remaining -= W25QXXDV_BLOCK_SIZE;
-			continue;
-		}
+		/* A chip erase can't be suspended */
+		driver_data->erasing =
+			erase_size != CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE;
 
-		if (size_remaining >= W25QXXDV_BLOCK32K_SIZE) {
-			ret = spi_flash_wb_erase_internal(dev, new_offset,
-							  W25QXXDV_BLOCK32K_SIZE);
-			new_offset += W25QXXDV_BLOCK32K_SIZE;
-			size_remaining -= W25QXXDV_BLOCK32K_SIZE;
-			continue;
-		}
+		ret = spi_flash_wb_erase_wait(dev);
 
-		if (size_remaining >= W25QXXDV_SECTOR_SIZE) {
-			ret = spi_flash_wb_erase_internal(dev, new_offset,
-							  W25QXXDV_SECTOR_SIZE);
-			new_offset += W25QXXDV_SECTOR_SIZE;
-			size_remaining -= W25QXXDV_SECTOR_SIZE;
-			continue;
-		}
+		driver_data->erasing = false;
+
+		new_offset += erase_size;
+		size_remaining -= erase_size;
 	}
 
+out:
 	k_sem_give(&driver_data->sem);
+	k_sem_give(&driver_data->lock);
 
 	return ret;
 }
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+static const struct flash_pages_layout spi_flash_layout = {
+	.pages_count = CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE /
+		       W25QXXDV_SECTOR_SIZE,
+	.pages_size = W25QXXDV_SECTOR_SIZE,
+};
+
+static void spi_flash_wb_pages_layout(struct device *dev,
+				      const struct flash_pages_layout **layout,
+				      size_t *layout_size)
+{
+	*layout = &spi_flash_layout;
+	*layout_size = 1;
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 static const struct flash_driver_api spi_flash_api = {
 	.read = spi_flash_wb_read,
 	.write = spi_flash_wb_write,
 	.erase = spi_flash_wb_erase,
 	.write_protection = spi_flash_wb_write_protection_set,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = spi_flash_wb_pages_layout,
+#endif
+	.write_block_size = 1,
 };
 
 static int spi_flash_init(struct device *dev)
@@ -362,7 +599,14 @@ static int spi_flash_init(struct device *dev)
 	k_sem_init(&data->sem, 0, UINT_MAX);
 	k_sem_give(&data->sem);
 
+	k_sem_init(&data->lock, 0, UINT_MAX);
+	k_sem_give(&data->lock);
+
 	ret = spi_flash_wb_config(dev);
+	if (!ret) {
+		ret = spi_flash_wb_id(dev);
+	}
+
 	if (!ret) {
 		dev->driver_api = &spi_flash_api;
 	}
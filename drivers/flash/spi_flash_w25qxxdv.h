@@ -12,13 +12,27 @@
 
 #ifndef __SPI_FLASH_W25QXXDV_H__
 #define __SPI_FLASH_W25QXXDV_H__
-
+#ifdef CONFIG_SPI_FLASH_W25QXXDV_FAST_READ
+#define W25QXXDV_CMD_READ_DATA   W25QXXDV_CMD_FASTREAD
+#define W25QXXDV_LEN_READ        (W25QXXDV_LEN_CMD_ADDRESS + \
+				  W25QXXDV_LEN_DUMMY)
+#else
+#define W25QXXDV_CMD_READ_DATA   W25QXXDV_CMD_READ
+#define W25QXXDV_LEN_READ        W25QXXDV_LEN_CMD_ADDRESS
+#endif
 
 struct spi_flash_data {
 	struct device *spi;
 	uint8_t buf[CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN +
-		    W25QXXDV_LEN_CMD_ADDRESS];
+		    W25QXXDV_LEN_READ];
+	/* serializes the accesses to the SPI bus */
 	struct k_sem sem;
+	/* serializes the program and erase operations, held for the whole
+	 * lifetime of an erase while sem is only taken to poll the status
+	 */
+	struct k_sem lock;
+	/* a sector or block erase is in progress and may be suspended */
+	bool erasing;
 };
 
 
@@ -40,6 +40,7 @@
 #define W25QXXDV_ADDRESS_WIDTH        (3)
 #define W25QXXDV_LEN_CMD_ADDRESS      (4)
 #define W25QXXDV_LEN_CMD_AND_ID       (4)
+#define W25QXXDV_LEN_DUMMY            (1)
 
 /* relevant status register bits */
 #define W25QXXDV_WIP_BIT         (0x1 << 0)
@@ -48,6 +49,9 @@
 #define W25QXXDV_TB_BIT          (0x1 << 3)
 #define W25QXXDV_SR_BP_OFFSET    (2)
 
+/* relevant status register 2 bits */
+#define W25QXXDV_SUS_BIT         (0x1 << 7)
+
 /* relevant security register bits */
 #define W25QXXDV_SECR_WPSEL_BIT  (0x1 << 7)
 #define W25QXXDV_SECR_EFAIL_BIT  (0x1 << 6)
@@ -59,6 +63,12 @@
 #define W25QXXDV_BLOCK_SIZE      (0x10000)
 
 #define W25QXXDV_SECTOR_MASK     (0xFFF)
+#define W25QXXDV_BLOCK32K_MASK   (0x7FFF)
+#define W25QXXDV_BLOCK_MASK      (0xFFFF)
+
+/* program page */
+#define W25QXXDV_PAGE_SIZE       (0x100)
+#define W25QXXDV_PAGE_MASK       (0xFF)
 
 /* ID comands */
 #define W25QXXDV_CMD_RDID        0x9F
@@ -21,7 +21,7 @@ struct gpio_mcux_config {
 
 struct gpio_mcux_data {
 	/* port ISR callback routine address */
-	sys_slist_t callbacks;
+	struct gpio_callback_table callbacks;
 	/* pin callback routine enable flags, by pin number */
 	uint32_t pin_callback_enables;
 };
@@ -163,12 +163,52 @@ static int gpio_mcux_read(struct device *dev,
 	return 0;
 }
 
+static int gpio_mcux_port_set_bits(struct device *dev, uint32_t mask)
+{
+	const struct gpio_mcux_config *config = dev->config->config_info;
+
+	config->gpio_base->PSOR = mask;
+
+	return 0;
+}
+
+static int gpio_mcux_port_clear_bits(struct device *dev, uint32_t mask)
+{
+	const struct gpio_mcux_config *config = dev->config->config_info;
+
+	config->gpio_base->PCOR = mask;
+
+	return 0;
+}
+
+static int gpio_mcux_port_toggle_bits(struct device *dev, uint32_t mask)
+{
+	const struct gpio_mcux_config *config = dev->config->config_info;
+
+	config->gpio_base->PTOR = mask;
+
+	return 0;
+}
+
+static int gpio_mcux_fast_port_get(struct device *dev,
+				   struct gpio_fast_port *fast)
+{
+	const struct gpio_mcux_config *config = dev->config->config_info;
+	GPIO_Type *gpio_base = config->gpio_base;
+
+	fast->set = &gpio_base->PSOR;
+	fast->clear = &gpio_base->PCOR;
+	fast->in = &gpio_base->PDIR;
+
+	return 0;
+}
+
 static int gpio_mcux_manage_callback(struct device *dev,
 				     struct gpio_callback *callback, bool set)
 {
 	struct gpio_mcux_data *data = dev->driver_data;
 
-	_gpio_manage_callback(&data->callbacks, callback, set);
+	_gpio_table_manage_callback(&data->callbacks, callback, set);
 
 	return 0;
 }
@@ -211,7 +251,7 @@ static void gpio_mcux_port_isr(void *arg)
 	int_status = config->port_base->ISFR;
 	enabled_int = int_status & data->pin_callback_enables;
 
-	_gpio_fire_callbacks(&data->callbacks, dev, enabled_int);
+	_gpio_table_fire_callbacks(&data->callbacks, dev, enabled_int);
 
 	/* Clear the port interrupts */
 	config->port_base->ISFR = 0xFFFFFFFF;
@@ -225,6 +265,10 @@ static const struct gpio_driver_api gpio_mcux_driver_api = {
 	.manage_callback = gpio_mcux_manage_callback,
 	.enable_callback = gpio_mcux_enable_callback,
 	.disable_callback = gpio_mcux_disable_callback,
+	.port_set_bits = gpio_mcux_port_set_bits,
+	.port_clear_bits = gpio_mcux_port_clear_bits,
+	.port_toggle_bits = gpio_mcux_port_toggle_bits,
+	.fast_port_get = gpio_mcux_fast_port_get,
 };
 
 #ifdef CONFIG_GPIO_MCUX_PORTA
@@ -75,8 +75,8 @@ struct gpio_nrf5_config {
 };
 
 struct gpio_nrf5_data {
-	/* list of registered callbacks */
-	sys_slist_t callbacks;
+	/* registered callbacks */
+	struct gpio_callback_table callbacks;
 	/* pin callback routine enable flags, by pin number */
 	uint32_t pin_callback_enables;
 
@@ -264,12 +264,56 @@ static int gpio_nrf5_write(struct device *dev,
 	return 0;
 }
 
+static int gpio_nrf5_port_set_bits(struct device *dev, uint32_t mask)
+{
+	volatile struct _gpio *gpio = GPIO_STRUCT(dev);
+
+	gpio->OUTSET = mask;
+
+	return 0;
+}
+
+static int gpio_nrf5_port_clear_bits(struct device *dev, uint32_t mask)
+{
+	volatile struct _gpio *gpio = GPIO_STRUCT(dev);
+
+	gpio->OUTCLR = mask;
+
+	return 0;
+}
+
+static int gpio_nrf5_port_toggle_bits(struct device *dev, uint32_t mask)
+{
+	volatile struct _gpio *gpio = GPIO_STRUCT(dev);
+	uint32_t out = gpio->OUT;
+
+	/* No toggle register: set and clear only the pins in the mask, so
+	 * that the other pins are not written.
+	 */
+	gpio->OUTSET = ~out & mask;
+	gpio->OUTCLR = out & mask;
+
+	return 0;
+}
+
+static int gpio_nrf5_fast_port_get(struct device *dev,
+				   struct gpio_fast_port *fast)
+{
+	volatile struct _gpio *gpio = GPIO_STRUCT(dev);
+
+	fast->set = &gpio->OUTSET;
+	fast->clear = &gpio->OUTCLR;
+	fast->in = &gpio->IN;
+
+	return 0;
+}
+
 static int gpio_nrf5_manage_callback(struct device *dev,
 				    struct gpio_callback *callback, bool set)
 {
 	struct gpio_nrf5_data *data = DEV_GPIO_DATA(dev);
 
-	_gpio_manage_callback(&data->callbacks, callback, set);
+	_gpio_table_manage_callback(&data->callbacks, callback, set);
 
 	return 0;
 }
@@ -353,8 +397,8 @@ static void gpio_nrf5_port_isr(void *arg)
 	irq_disable(NRF5_IRQ_GPIOTE_IRQn);
 
 	/* Call the registered callbacks */
-	_gpio_fire_callbacks(&data->callbacks, (struct device *)dev,
-			     enabled_int);
+	_gpio_table_fire_callbacks(&data->callbacks, (struct device *)dev,
+				   enabled_int);
 
 	irq_enable(NRF5_IRQ_GPIOTE_IRQn);
 }
@@ -366,6 +410,10 @@ static const struct gpio_driver_api gpio_nrf5_drv_api_funcs = {
 	.manage_callback = gpio_nrf5_manage_callback,
 	.enable_callback = gpio_nrf5_enable_callback,
 	.disable_callback = gpio_nrf5_disable_callback,
+	.port_set_bits = gpio_nrf5_port_set_bits,
+	.port_clear_bits = gpio_nrf5_port_clear_bits,
+	.port_toggle_bits = gpio_nrf5_port_toggle_bits,
+	.fast_port_get = gpio_nrf5_fast_port_get,
 };
 
 /* Initialization for GPIO Port 0 */
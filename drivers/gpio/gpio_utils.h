@@ -57,4 +57,117 @@ static inline void _gpio_fire_callbacks(sys_slist_t *list,
 	}
 }
 
+/**
+ * @brief Callbacks of a driver instance, with a table by pin
+ *
+ * With CONFIG_GPIO_CALLBACK_TABLE, a callback whose pins no other callback
+ * is interested in goes in the table, and an interrupt calls it without
+ * looking at the other callbacks. The callbacks sharing pins stay in the
+ * list, only walked when one of their pins triggered. The pin mask of a
+ * callback in the table is the one it had when added.
+ */
+struct gpio_callback_table {
+	sys_slist_t list;
+#ifdef CONFIG_GPIO_CALLBACK_TABLE
+	/* pins of the callbacks in the list */
+	uint32_t list_mask;
+	/* pins served by the table */
+	uint32_t table_mask;
+	struct gpio_callback *table[32];
+#endif
+};
+
+/**
+ * @brief Insert or remove a callback from a callback table
+ *
+ * @param callbacks A pointer to the callback table of the driver instance
+ * @param callback A pointer of the callback to insert or remove
+ * @param set A boolean indicating insertion or removal of the callback
+ */
+static inline void _gpio_table_manage_callback(
+	struct gpio_callback_table *callbacks,
+	struct gpio_callback *callback, bool set)
+{
+#ifdef CONFIG_GPIO_CALLBACK_TABLE
+	uint32_t pins = callback->pin_mask;
+	struct gpio_callback *cb;
+	sys_snode_t *node;
+	unsigned int key;
+	int i;
+
+	__ASSERT(callback, "No callback!");
+	__ASSERT(callback->handler, "No callback handler!");
+
+	key = irq_lock();
+
+	if (set) {
+		if (pins &&
+		    !(pins & (callbacks->table_mask | callbacks->list_mask))) {
+			for (i = 0; i < 32; i++) {
+				if (pins & BIT(i)) {
+					callbacks->table[i] = callback;
+				}
+			}
+			callbacks->table_mask |= pins;
+		} else {
+			sys_slist_prepend(&callbacks->list, &callback->node);
+			callbacks->list_mask |= pins;
+		}
+	} else {
+		for (i = 0; i < 32; i++) {
+			if (callbacks->table[i] == callback) {
+				callbacks->table[i] = NULL;
+				callbacks->table_mask &= ~BIT(i);
+			}
+		}
+
+		sys_slist_find_and_remove(&callbacks->list, &callback->node);
+
+		callbacks->list_mask = 0;
+		SYS_SLIST_FOR_EACH_NODE(&callbacks->list, node) {
+			cb = (struct gpio_callback *)node;
+			callbacks->list_mask |= cb->pin_mask;
+		}
+	}
+
+	irq_unlock(key);
+#else
+	_gpio_manage_callback(&callbacks->list, callback, set);
+#endif
+}
+
+/**
+ * @brief Fire the callbacks of a callback table
+ *
+ * @param callbacks A pointer to the callback table of the driver instance
+ * @param port A pointer on the gpio driver instance
+ * @param pins The actual pin mask that triggered the interrupt
+ */
+static inline void _gpio_table_fire_callbacks(
+	struct gpio_callback_table *callbacks,
+	struct device *port, uint32_t pins)
+{
+#ifdef CONFIG_GPIO_CALLBACK_TABLE
+	uint32_t pending = pins & callbacks->table_mask;
+	struct gpio_callback *cb;
+	int pin;
+
+	/* One lookup per callback to call, whatever the number of
+	 * callbacks registered.
+	 */
+	while (pending) {
+		pin = find_lsb_set(pending) - 1;
+		cb = callbacks->table[pin];
+
+		pending &= ~(cb->pin_mask | BIT(pin));
+		cb->handler(port, cb, pins);
+	}
+
+	if (!(pins & callbacks->list_mask)) {
+		return;
+	}
+#endif
+	_gpio_fire_callbacks(&callbacks->list, port, pins);
+}
+
 #endif /* __GPIO_UTILS_H__ */
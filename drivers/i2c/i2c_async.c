@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <init.h>
+#include <i2c.h>
+
+static struct k_work_q i2c_async_work_q;
+static char __stack i2c_async_stack[CONFIG_I2C_ASYNC_STACK_SIZE];
+
+static sys_slist_t pending;
+static struct k_work pending_work;
+
+static sys_slist_t sweep;
+static struct k_mutex sweep_lock;
+static struct k_delayed_work sweep_work;
+
+static void trans_run(struct i2c_transaction *trans)
+{
+	int status;
+
+	status = i2c_transfer(trans->dev, trans->msgs, trans->num_msgs,
+			      trans->addr);
+
+	if (trans->cb) {
+		trans->cb(trans->dev, status, trans->user_data);
+	}
+}
+
+static void pending_run(struct k_work *work)
+{
+	sys_snode_t *node;
+	unsigned int key;
+
+	while (1) {
+		key = irq_lock();
+		node = sys_slist_get(&pending);
+		irq_unlock(key);
+
+		if (!node) {
+			return;
+		}
+
+		trans_run(CONTAINER_OF(node, struct i2c_transaction, node));
+	}
+}
+
+int i2c_transfer_async(struct device *dev, struct i2c_transaction *trans)
+{
+	unsigned int key;
+
+	trans->dev = dev;
+
+	key = irq_lock();
+	sys_slist_append(&pending, &trans->node);
+	irq_unlock(key);
+
+	k_work_submit_to_queue(&i2c_async_work_q, &pending_work);
+
+	return 0;
+}
+
+static void sweep_run(struct k_work *work)
+{
+	sys_snode_t *node, *next;
+
+	k_mutex_lock(&sweep_lock, K_FOREVER);
+
+	/* Rescheduled first so that the period doesn't drift with the
+	 * time taken by the transfers.
+	 */
+	if (!sys_slist_is_empty(&sweep)) {
+		k_delayed_work_submit_to_queue(&i2c_async_work_q, &sweep_work,
+					       CONFIG_I2C_SWEEP_PERIOD);
+	}
+
+	SYS_SLIST_FOR_EACH_NODE_SAFE(&sweep, node, next) {
+		trans_run(CONTAINER_OF(node, struct i2c_transaction, node));
+	}
+
+	k_mutex_unlock(&sweep_lock);
+}
+
+int i2c_sweep_register(struct device *dev, struct i2c_transaction *trans)
+{
+	sys_snode_t *node;
+	bool first;
+
+	k_mutex_lock(&sweep_lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_NODE(&sweep, node) {
+		if (node == &trans->node) {
+			k_mutex_unlock(&sweep_lock);
+			return -EALREADY;
+		}
+	}
+
+	trans->dev = dev;
+
+	first = sys_slist_is_empty(&sweep);
+	sys_slist_append(&sweep, &trans->node);
+
+	if (first) {
+		k_delayed_work_submit_to_queue(&i2c_async_work_q, &sweep_work,
+					       CONFIG_I2C_SWEEP_PERIOD);
+	}
+
+	k_mutex_unlock(&sweep_lock);
+
+	return 0;
+}
+
+void i2c_sweep_unregister(struct i2c_transaction *trans)
+{
+	/* The lock is recursive, so this is fine from a callback too */
+	k_mutex_lock(&sweep_lock, K_FOREVER);
+
+	sys_slist_find_and_remove(&sweep, &trans->node);
+
+	if (sys_slist_is_empty(&sweep)) {
+		k_delayed_work_cancel(&sweep_work);
+	}
+
+	k_mutex_unlock(&sweep_lock);
+}
+
+static int i2c_async_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	sys_slist_init(&pending);
+	k_work_init(&pending_work, pending_run);
+
+	sys_slist_init(&sweep);
+	k_mutex_init(&sweep_lock);
+	k_delayed_work_init(&sweep_work, sweep_run);
+
+	k_work_q_start(&i2c_async_work_q, i2c_async_stack,
+		       sizeof(i2c_async_stack), CONFIG_I2C_ASYNC_PRIORITY);
+
+	return 0;
+}
+
+SYS_INIT(i2c_async_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
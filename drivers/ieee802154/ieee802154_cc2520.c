@@ -242,6 +242,26 @@ bool _cc2520_write_ram(struct cc2520_spi *spi, uint16_t addr,
 	return (spi_write(spi->dev, spi->cmd_buf, len + 2) == 0);
 }
 
+static bool _cc2520_read_ram(struct cc2520_spi *spi, uint16_t addr,
+			     uint8_t *data_buf, uint8_t len)
+{
+	spi->cmd_buf[0] = CC2520_INS_MEMRD | (addr >> 8);
+	spi->cmd_buf[1] = addr;
+
+	memset(&spi->cmd_buf[2], 0, len);
+
+	spi_slave_select(spi->dev, spi->slave);
+
+	if (spi_transceive(spi->dev, spi->cmd_buf, len + 2,
+			   spi->cmd_buf, len + 2) != 0) {
+		return false;
+	}
+
+	memcpy(data_buf, &spi->cmd_buf[2], len);
+
+	return true;
+}
+
 static uint8_t _cc2520_status(struct cc2520_spi *spi)
 {
 	spi->cmd_buf[0] = CC2520_INS_SNOP;
@@ -498,59 +518,38 @@ static inline uint8_t read_rxfifo_length(struct cc2520_spi *spi)
 	return 0;
 }
 
+/*
+ * Reads the rest of the frame, FCS included, in one burst straight into
+ * the fragment: the instruction byte goes in the headroom, and so the
+ * status byte clocked out with it, the FIFO bytes landing at the data
+ * pointer.
+ */
 static inline bool read_rxfifo_content(struct cc2520_spi *spi,
 				       struct net_buf *buf, uint8_t len)
 {
-	uint8_t data[128+1];
+	uint8_t *data = buf->data - 1;
 
 	data[0] = CC2520_INS_RXBUF;
 	memset(&data[1], 0, len);
 
 	spi_slave_select(spi->dev, spi->slave);
 
-	if (spi_transceive(spi->dev, data, len+1, data, len+1) != 0) {
-		return false;
-	}
-
-	if (read_reg_excflag0(spi) & EXCFLAG0_RX_UNDERFLOW) {
-		SYS_LOG_ERR("RX underflow!");
-		return false;
-	}
-
-	memcpy(buf->data, &data[1], len);
-	net_buf_add(buf, len);
-
-	return true;
+	return (spi_transceive(spi->dev, data, len + 1, data, len + 1) == 0);
 }
 
-static inline bool verify_crc(struct cc2520_context *cc2520)
+/**
+ * CC2520 does not provide an LQI but a correlation factor.
+ * See Section 20.6
+ * Such calculation can be loosely used to transform it to lqi:
+ * corr <= 50 ? lqi = 0
+ * or:
+ * corr >= 110 ? lqi = 255
+ * else:
+ * lqi = (lqi - 50) * 4
+ */
+static inline void set_lqi(struct cc2520_context *cc2520, uint8_t fcs)
 {
-	cc2520->spi.cmd_buf[0] = CC2520_INS_RXBUF;
-	cc2520->spi.cmd_buf[1] = 0;
-	cc2520->spi.cmd_buf[2] = 0;
-
-	spi_slave_select(cc2520->spi.dev, cc2520->spi.slave);
-
-	if (spi_transceive(cc2520->spi.dev, cc2520->spi.cmd_buf, 3,
-			   cc2520->spi.cmd_buf, 3) != 0) {
-		return false;
-	}
-
-	if (!(cc2520->spi.cmd_buf[2] & CC2520_FCS_CRC_OK)) {
-		return false;
-	}
-
-	/**
-	 * CC2520 does not provide an LQI but a correlation factor.
-	 * See Section 20.6
-	 * Such calculation can be loosely used to transform it to lqi:
-	 * corr <= 50 ? lqi = 0
-	 * or:
-	 * corr >= 110 ? lqi = 255
-	 * else:
-	 * lqi = (lqi - 50) * 4
-	 */
-	cc2520->lqi = cc2520->spi.cmd_buf[2] & CC2520_FCS_CORRELATION;
+	cc2520->lqi = fcs & CC2520_FCS_CORRELATION;
 	if (cc2520->lqi <= 50) {
 		cc2520->lqi = 0;
 	} else if (cc2520->lqi >= 110) {
@@ -558,18 +557,6 @@ static inline bool verify_crc(struct cc2520_context *cc2520)
 	} else {
 		cc2520->lqi = (cc2520->lqi - 50) << 2;
 	}
-
-	return true;
-}
-
-static inline bool verify_rxfifo_validity(struct cc2520_spi *spi,
-					  uint8_t pkt_len)
-{
-	if (pkt_len < 2 || read_reg_rxfifocnt(spi) != pkt_len) {
-		return false;
-	}
-
-	return true;
 }
 
 static void cc2520_rx(int arg)
@@ -578,12 +565,21 @@ static void cc2520_rx(int arg)
 	struct cc2520_context *cc2520 = dev->driver_data;
 	struct net_buf *pkt_buf = NULL;
 	struct net_buf *buf;
+	uint8_t fifo_cnt;
 	uint8_t pkt_len;
+	uint8_t fcs;
 
 	while (1) {
 		buf = NULL;
 
-		k_sem_take(&cc2520->rx_lock, K_FOREVER);
+		/* With the threshold above any frame size FIFOP stays up
+		 * while a complete frame is in the FIFO: the frames received
+		 * while the previous one was read are taken without waiting,
+		 * their interrupt only leaving the semaphore up.
+		 */
+		if (!get_fifop(cc2520)) {
+			k_sem_take(&cc2520->rx_lock, K_FOREVER);
+		}
 
 		if (cc2520->overflow) {
 			SYS_LOG_ERR("RX overflow!");
@@ -592,8 +588,16 @@ static void cc2520_rx(int arg)
 			goto flush;
 		}
 
+		if (!get_fifop(cc2520)) {
+			/* Frame already read */
+			continue;
+		}
+
+		/* Length byte included, and maybe frames behind this one */
+		fifo_cnt = read_reg_rxfifocnt(&cc2520->spi);
+
 		pkt_len = read_rxfifo_length(&cc2520->spi) & 0x7f;
-		if (!verify_rxfifo_validity(&cc2520->spi, pkt_len)) {
+		if (pkt_len < 2 || pkt_len >= fifo_cnt) {
 			SYS_LOG_ERR("Invalid content");
 			goto flush;
 		}
@@ -604,14 +608,11 @@ static void cc2520_rx(int arg)
 			goto flush;
 		}
 
-#if defined(CONFIG_TI_CC2520_RAW)
 		/**
-		 * Reserve 1 byte for length
+		 * Reserve 1 byte for the SPI instruction, and for the length
+		 * in raw mode
 		 */
 		pkt_buf = net_nbuf_get_reserve_data(1);
-#else
-		pkt_buf = net_nbuf_get_reserve_data(0);
-#endif
 		if (!pkt_buf) {
 			SYS_LOG_ERR("No pkt_buf available");
 			goto flush;
@@ -619,35 +620,24 @@ static void cc2520_rx(int arg)
 
 		net_buf_frag_insert(buf, pkt_buf);
 
-#if defined(CONFIG_TI_CC2520_RAW)
-		if (!read_rxfifo_content(&cc2520->spi, pkt_buf, pkt_len)) {
+		if (pkt_len > net_buf_tailroom(pkt_buf) ||
+		    !read_rxfifo_content(&cc2520->spi, pkt_buf, pkt_len)) {
 			SYS_LOG_ERR("No content read");
 			goto flush;
 		}
 
-		if (!(pkt_buf->data[pkt_len - 1] & CC2520_FCS_CRC_OK)) {
+		fcs = pkt_buf->data[pkt_len - 1];
+		if (!(fcs & CC2520_FCS_CRC_OK)) {
+			SYS_LOG_ERR("Bad packet CRC");
 			goto out;
 		}
 
-		cc2520->lqi = pkt_buf->data[pkt_len - 1] &
-			CC2520_FCS_CORRELATION;
-		if (cc2520->lqi <= 50) {
-			cc2520->lqi = 0;
-		} else if (cc2520->lqi >= 110) {
-			cc2520->lqi = 255;
-		} else {
-			cc2520->lqi = (cc2520->lqi - 50) << 2;
-		}
-#else
-		if (!read_rxfifo_content(&cc2520->spi, pkt_buf, pkt_len - 2)) {
-			SYS_LOG_ERR("No content read");
-			goto flush;
-		}
+		set_lqi(cc2520, fcs);
 
-		if (!verify_crc(cc2520)) {
-			SYS_LOG_ERR("Bad packet CRC");
-			goto out;
-		}
+#if defined(CONFIG_TI_CC2520_RAW)
+		net_buf_add(pkt_buf, pkt_len);
+#else
+		net_buf_add(pkt_buf, pkt_len - 2);
 #endif
 
 		if (ieee802154_radio_handle_ack(cc2520->iface, buf) == NET_OK) {
@@ -731,6 +721,9 @@ static int cc2520_set_pan_id(struct device *dev, uint16_t pan_id)
 		return -EIO;
 	}
 
+	/* Short entries of the source address table need it */
+	cc2520->pan_id = pan_id;
+
 	return 0;
 }
 
@@ -916,6 +909,162 @@ static uint8_t cc2520_get_lqi(struct device *dev)
 	return cc2520->lqi;
 }
 
+static bool write_src_match_masks(struct cc2520_context *cc2520)
+{
+	uint8_t short_en[3] = { cc2520->src_short_en,
+				cc2520->src_short_en >> 8,
+				cc2520->src_short_en >> 16 };
+	uint8_t ext_en[3] = { cc2520->src_ext_en,
+			      cc2520->src_ext_en >> 8,
+			      cc2520->src_ext_en >> 16 };
+
+	/* Only entries with pending data are enabled */
+	return (write_reg_srcshorten0(&cc2520->spi, short_en[0]) &&
+		write_reg_srcshorten1(&cc2520->spi, short_en[1]) &&
+		write_reg_srcshorten2(&cc2520->spi, short_en[2]) &&
+		write_reg_srcexten0(&cc2520->spi, ext_en[0]) &&
+		write_reg_srcexten1(&cc2520->spi, ext_en[1]) &&
+		write_reg_srcexten2(&cc2520->spi, ext_en[2]) &&
+		write_mem_srcshortpenden(&cc2520->spi, short_en) &&
+		write_mem_srcextpenden(&cc2520->spi, ext_en));
+}
+
+static int cc2520_set_pending(struct device *dev, const uint8_t *addr,
+			      uint8_t addr_len, bool pending)
+{
+	struct cc2520_context *cc2520 = dev->driver_data;
+	uint8_t entry[CC2520_SRC_TABLE_ENTRY_SIZE];
+	uint32_t *mask;
+	int free = -1;
+	int i;
+
+	if (addr_len != 2 && addr_len != 8) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < CC2520_SRC_TABLE_ENTRIES; i++) {
+		if (cc2520->src_addr_len[i] == addr_len &&
+		    !memcmp(cc2520->src_addr[i], addr, addr_len)) {
+			break;
+		}
+
+		if (free < 0 && !cc2520->src_addr_len[i]) {
+			free = i;
+		}
+	}
+
+	if (i < CC2520_SRC_TABLE_ENTRIES) {
+		if (pending) {
+			return 0;
+		}
+
+		cc2520->src_addr_len[i] = 0;
+	} else {
+		if (!pending) {
+			return 0;
+		}
+
+		if (free < 0) {
+			return -ENOMEM;
+		}
+
+		i = free;
+
+		if (addr_len == 2) {
+			memcpy(entry, &cc2520->pan_id, 2);
+			memcpy(entry + 2, addr, 2);
+		} else {
+			memcpy(entry, addr, 8);
+		}
+
+		if (!_cc2520_write_ram(&cc2520->spi, CC2520_MEM_SRC_TABLE +
+				       i * CC2520_SRC_TABLE_ENTRY_SIZE,
+				       entry, addr_len == 2 ? 4 : 8)) {
+			SYS_LOG_ERR("Failed");
+			return -EIO;
+		}
+
+		memcpy(cc2520->src_addr[i], addr, addr_len);
+		cc2520->src_addr_len[i] = addr_len;
+	}
+
+	/* Entry i is a short entry 2i or an extended entry i, both
+	 * enabled by bit 2i
+	 */
+	mask = addr_len == 2 ? &cc2520->src_short_en : &cc2520->src_ext_en;
+
+	if (pending) {
+		*mask |= BIT(2 * i);
+	} else {
+		*mask &= ~BIT(2 * i);
+	}
+
+	if (!write_src_match_masks(cc2520)) {
+		SYS_LOG_ERR("Failed");
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/* AES-128 encryption of a block, in place, through the ECB engine */
+static int cc2520_aes_encrypt(struct device *dev, const uint8_t *key,
+			      uint8_t *block)
+{
+	struct cc2520_context *cc2520 = dev->driver_data;
+	struct cc2520_spi *spi = &cc2520->spi;
+	uint8_t reversed[CC2520_AES_BLOCK_SIZE];
+	uint8_t retries = 100;
+
+	/* The key is only written when it changes, byte reversed */
+	if (!cc2520->aes_key_set ||
+	    memcmp(cc2520->aes_key, key, CC2520_AES_BLOCK_SIZE)) {
+		sys_memcpy_swap(reversed, key, CC2520_AES_BLOCK_SIZE);
+
+		if (!_cc2520_write_ram(spi, CC2520_MEM_AES_KEY, reversed,
+				       CC2520_AES_BLOCK_SIZE)) {
+			cc2520->aes_key_set = false;
+			return -EIO;
+		}
+
+		memcpy(cc2520->aes_key, key, CC2520_AES_BLOCK_SIZE);
+		cc2520->aes_key_set = true;
+	}
+
+	if (!_cc2520_write_ram(spi, CC2520_MEM_AES_BLOCK, block,
+			       CC2520_AES_BLOCK_SIZE)) {
+		return -EIO;
+	}
+
+	/* ECBO: key address / 16, then the 12 bits block address */
+	spi->cmd_buf[0] = CC2520_INS_ECBO;
+	spi->cmd_buf[1] = CC2520_MEM_AES_KEY >> 4;
+	spi->cmd_buf[2] = CC2520_MEM_AES_BLOCK >> 8;
+	spi->cmd_buf[3] = CC2520_MEM_AES_BLOCK & 0xff;
+
+	spi_slave_select(spi->dev, spi->slave);
+
+	if (spi_write(spi->dev, spi->cmd_buf, 4) != 0) {
+		return -EIO;
+	}
+
+	while (_cc2520_status(spi) & CC2520_STATUS_DPU_L_ACTIVE) {
+		if (!retries--) {
+			SYS_LOG_ERR("AES timeout");
+			return -EIO;
+		}
+
+		_usleep(1);
+	}
+
+	if (!_cc2520_read_ram(spi, CC2520_MEM_AES_BLOCK, block,
+			      CC2520_AES_BLOCK_SIZE)) {
+		return -EIO;
+	}
+
+	return 0;
+}
+
 /******************
  * Initialization *
  *****************/
@@ -1078,6 +1227,8 @@ static struct ieee802154_radio_api cc2520_radio_api = {
 	.stop		= cc2520_stop,
 	.tx		= cc2520_tx,
 	.get_lqi	= cc2520_get_lqi,
+	.set_pending	= cc2520_set_pending,
+	.aes_encrypt	= cc2520_aes_encrypt,
 };
 
 #if defined(CONFIG_TI_CC2520_RAW)
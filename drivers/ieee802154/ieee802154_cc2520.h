@@ -15,6 +15,8 @@
 
 #include <ieee802154/cc2520.h>
 
+#include "ieee802154_cc2520_regs.h"
+
 /* Runtime context structure
  ***************************
  */
@@ -22,10 +24,10 @@ struct cc2520_spi {
 	struct device *dev;
 	uint32_t slave;
 	/**
-	 * cmd_buf will use at most 9 bytes:
-	 * dummy bytes + 8 ieee address bytes
+	 * cmd_buf will use at most 18 bytes:
+	 * 2 instruction bytes + 16 AES key or block bytes
 	 */
-	uint8_t cmd_buf[12];
+	uint8_t cmd_buf[18];
 };
 
 struct cc2520_context {
@@ -36,6 +38,15 @@ struct cc2520_context {
 	struct gpio_callback fifop_cb;
 	struct cc2520_spi spi;
 	uint8_t mac_addr[8];
+	uint16_t pan_id;
+	/**********SRC MATCH*******/
+	uint8_t src_addr[CC2520_SRC_TABLE_ENTRIES][8];
+	uint8_t src_addr_len[CC2520_SRC_TABLE_ENTRIES];
+	uint32_t src_short_en;
+	uint32_t src_ext_en;
+	/************AES***********/
+	uint8_t aes_key[CC2520_AES_BLOCK_SIZE];
+	bool aes_key_set;
 	/************TX************/
 	struct k_sem tx_sync;
 	atomic_t tx;
@@ -46,8 +57,6 @@ struct cc2520_context {
 	uint8_t lqi;
 };
 
-#include "ieee802154_cc2520_regs.h"
-
 
 /* Registers useful routines
  ***************************
@@ -104,6 +113,12 @@ DEFINE_FREG_WRITE(excflag2, CC2520_FREG_EXCFLAG2)
 DEFINE_FREG_WRITE(frmfilt0, CC2520_FREG_FRMFILT0)
 DEFINE_FREG_WRITE(frmfilt1, CC2520_FREG_FRMFILT1)
 DEFINE_FREG_WRITE(srcmatch, CC2520_FREG_SRCMATCH)
+DEFINE_FREG_WRITE(srcshorten0, CC2520_FREG_SRCSHORTEN0)
+DEFINE_FREG_WRITE(srcshorten1, CC2520_FREG_SRCSHORTEN1)
+DEFINE_FREG_WRITE(srcshorten2, CC2520_FREG_SRCSHORTEN2)
+DEFINE_FREG_WRITE(srcexten0, CC2520_FREG_SRCEXTEN0)
+DEFINE_FREG_WRITE(srcexten1, CC2520_FREG_SRCEXTEN1)
+DEFINE_FREG_WRITE(srcexten2, CC2520_FREG_SRCEXTEN2)
 DEFINE_FREG_WRITE(fifopctrl, CC2520_FREG_FIFOPCTRL)
 DEFINE_FREG_WRITE(freqctrl, CC2520_FREG_FREQCTRL)
 DEFINE_FREG_WRITE(txpower, CC2520_FREG_TXPOWER)
@@ -137,6 +152,8 @@ bool _cc2520_write_ram(struct cc2520_spi *spi, uint16_t addr,
 DEFINE_MEM_WRITE(short_addr, CC2520_MEM_SHORT_ADDR, 2)
 DEFINE_MEM_WRITE(pan_id, CC2520_MEM_PAN_ID, 2)
 DEFINE_MEM_WRITE(ext_addr, CC2520_MEM_EXT_ADDR, 8)
+DEFINE_MEM_WRITE(srcshortpenden, CC2520_MEM_SRCSHORTPENDEN0, 3)
+DEFINE_MEM_WRITE(srcextpenden, CC2520_MEM_SRCEXTPENDEN0, 3)
 
 
 /* Instructions useful routines
@@ -300,6 +300,7 @@
 #define CC2520_SREG_RAMBIST			(0x7E)
 
 /* Useful RAM addresses (see chapter 15 part 6) */
+#define CC2520_MEM_SRC_TABLE			(0x0380)
 #define CC2520_MEM_SHORT_ADDR			(0x03F4)
 #define CC2520_MEM_PAN_ID			(0x03F2)
 #define CC2520_MEM_EXT_ADDR			(0x03EA)
@@ -314,6 +315,17 @@
 #define CC2520_MEM_SRCRESMASK1			(0x03E1)
 #define CC2520_MEM_SRCRESMASK0			(0x03E0)
 
+/* The source address table holds 24 short or 12 extended entries, an
+ * extended entry n taking the room of the short entries 2n and 2n + 1.
+ */
+#define CC2520_SRC_TABLE_ENTRIES		12
+#define CC2520_SRC_TABLE_ENTRY_SIZE		8
+
+/* AES key and block, in the general purpose RAM */
+#define CC2520_MEM_AES_KEY			(0x0200)
+#define CC2520_MEM_AES_BLOCK			(0x0210)
+#define CC2520_AES_BLOCK_SIZE			16
+
 /* Default settings (see chapter 28 part 1) */
 #define CC2520_TXPOWER_DEFAULT			(0x32)
 #define CC2520_CCACTRL0_DEFAULT			(0xF8)
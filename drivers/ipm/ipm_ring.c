@@ -0,0 +1,266 @@
+/* ipm_ring.c - Shared memory byte ring signalled over IPM */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <kernel.h>
+#include <cache.h>
+#include <ipm.h>
+#include <ipm_ring.h>
+#include <misc/util.h>
+
+/* Orders the accesses to the ring, the cache maintenance being a no-op
+ * without a cache.
+ */
+#define ring_barrier() __asm__ __volatile__("" ::: "memory")
+
+static inline void line_flush(volatile void *addr)
+{
+	ring_barrier();
+	sys_cache_flush((vaddr_t)addr, IPM_RING_LINE_SIZE);
+}
+
+static inline void line_invd(volatile void *addr)
+{
+	sys_cache_invd((vaddr_t)addr, IPM_RING_LINE_SIZE);
+	ring_barrier();
+}
+
+void ipm_ring_shm_init(struct ipm_ring_shm *shm)
+{
+	shm->tail = 0;
+	shm->head = 0;
+	shm->wait_seq = 0;
+
+	line_flush(&shm->tail);
+	line_flush(&shm->head);
+}
+
+int ipm_ring_producer_init(struct ipm_ring *ring, struct ipm_ring_shm *shm,
+			   uint32_t size, struct device *ipm, uint32_t id)
+{
+	if (!is_power_of_two(size)) {
+		return -EINVAL;
+	}
+
+	ring->shm = shm;
+	ring->size = size;
+	ring->ipm = ipm;
+	ring->id = id;
+
+	line_invd(&shm->head);
+	ring->notified_seq = shm->wait_seq;
+
+	return 0;
+}
+
+static void ipm_ring_doorbell(void *context, uint32_t id, volatile void *data)
+{
+	struct ipm_ring *ring = context;
+
+	ARG_UNUSED(id);
+	ARG_UNUSED(data);
+
+	k_sem_give(&ring->sem);
+}
+
+int ipm_ring_consumer_init(struct ipm_ring *ring, struct ipm_ring_shm *shm,
+			   uint32_t size, struct device *ipm)
+{
+	if (!is_power_of_two(size)) {
+		return -EINVAL;
+	}
+
+	ring->shm = shm;
+	ring->size = size;
+	ring->ipm = ipm;
+	k_sem_init(&ring->sem, 0, 1);
+
+	ipm_register_callback(ipm, ipm_ring_doorbell, ring);
+
+	return ipm_set_enabled(ipm, 1);
+}
+
+uint32_t ipm_ring_put_claim(struct ipm_ring *ring, uint8_t **data,
+			    uint32_t size)
+{
+	struct ipm_ring_shm *shm = ring->shm;
+	uint32_t tail = shm->tail;
+	uint32_t space, offset;
+
+	line_invd(&shm->head);
+
+	space = ring->size - (tail - shm->head);
+	offset = tail & (ring->size - 1);
+
+	size = min(size, space);
+	size = min(size, ring->size - offset);
+
+	*data = &shm->data[offset];
+
+	return size;
+}
+
+/* Publishes the bytes written, already flushed */
+static void ring_commit(struct ipm_ring *ring, uint32_t size)
+{
+	struct ipm_ring_shm *shm = ring->shm;
+	uint32_t seq;
+
+	/* The bytes reach memory before the index telling they are there */
+	ring_barrier();
+
+	shm->tail += size;
+	line_flush(&shm->tail);
+
+	/* Only a consumer gone to sleep since the last doorbell needs one:
+	 * a doorbell still pending, or a consumer still reading, will see
+	 * these bytes anyway.
+	 */
+	line_invd(&shm->head);
+	seq = shm->wait_seq;
+
+	if (seq != ring->notified_seq) {
+		ring->notified_seq = seq;
+		ipm_send(ring->ipm, 0, ring->id, NULL, 0);
+	}
+}
+
+void ipm_ring_put_finish(struct ipm_ring *ring, uint32_t size)
+{
+	struct ipm_ring_shm *shm = ring->shm;
+	uint32_t offset = shm->tail & (ring->size - 1);
+
+	if (!size) {
+		return;
+	}
+
+	ring_barrier();
+	sys_cache_flush((vaddr_t)&shm->data[offset], size);
+
+	ring_commit(ring, size);
+}
+
+uint32_t ipm_ring_put(struct ipm_ring *ring, const void *data, uint32_t size)
+{
+	struct ipm_ring_shm *shm = ring->shm;
+	const uint8_t *src = data;
+	uint32_t offset, space, len;
+
+	line_invd(&shm->head);
+
+	space = ring->size - (shm->tail - shm->head);
+	size = min(size, space);
+	if (!size) {
+		return 0;
+	}
+
+	/* Up to the end of the ring, then from its start, committed with a
+	 * single doorbell.
+	 */
+	offset = shm->tail & (ring->size - 1);
+	len = min(size, ring->size - offset);
+
+	memcpy(&shm->data[offset], src, len);
+	memcpy(&shm->data[0], src + len, size - len);
+
+	ring_barrier();
+	sys_cache_flush((vaddr_t)&shm->data[offset], len);
+	sys_cache_flush((vaddr_t)&shm->data[0], size - len);
+
+	ring_commit(ring, size);
+
+	return size;
+}
+
+uint32_t ipm_ring_get_claim(struct ipm_ring *ring, uint8_t **data,
+			    uint32_t size, int32_t timeout)
+{
+	struct ipm_ring_shm *shm = ring->shm;
+	uint32_t head = shm->head;
+	uint32_t used, offset;
+
+	line_invd(&shm->tail);
+	used = shm->tail - head;
+
+	while (!used) {
+		if (timeout == K_NO_WAIT) {
+			return 0;
+		}
+
+		/* Announce the wait before the last look at the ring, so that
+		 * the producer either sees it, or wrote what is looked at.
+		 */
+		shm->wait_seq++;
+		line_flush(&shm->head);
+
+		line_invd(&shm->tail);
+		used = shm->tail - head;
+		if (used) {
+			break;
+		}
+
+		if (k_sem_take(&ring->sem, timeout)) {
+			return 0;
+		}
+
+		line_invd(&shm->tail);
+		used = shm->tail - head;
+	}
+
+	offset = head & (ring->size - 1);
+
+	size = min(size, used);
+	size = min(size, ring->size - offset);
+
+	sys_cache_invd((vaddr_t)&shm->data[offset], size);
+	ring_barrier();
+
+	*data = &shm->data[offset];
+
+	return size;
+}
+
+void ipm_ring_get_finish(struct ipm_ring *ring, uint32_t size)
+{
+	struct ipm_ring_shm *shm = ring->shm;
+
+	if (!size) {
+		return;
+	}
+
+	/* Done reading before the producer may overwrite the bytes */
+	ring_barrier();
+
+	shm->head += size;
+	line_flush(&shm->head);
+}
+
+uint32_t ipm_ring_get(struct ipm_ring *ring, void *data, uint32_t size,
+		      int32_t timeout)
+{
+	uint8_t *dst = data;
+	uint32_t done = 0;
+	uint32_t claimed;
+	uint8_t *src;
+
+	while (done < size) {
+		claimed = ipm_ring_get_claim(ring, &src, size - done,
+					     done ? K_NO_WAIT : timeout);
+		if (!claimed) {
+			break;
+		}
+
+		memcpy(dst + done, src, claimed);
+		ipm_ring_get_finish(ring, claimed);
+		done += claimed;
+	}
+
+	return done;
+}
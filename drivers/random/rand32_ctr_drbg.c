@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief sys_rand32_get() from a CTR-DRBG
+ *
+ * The TinyCrypt CTR-DRBG is seeded from the entropy driver and then
+ * produces random numbers of any length at the cost of AES, instead of
+ * every caller waiting for the hardware generator. It draws fresh
+ * entropy when TinyCrypt requests a reseed.
+ */
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <string.h>
+#include <random.h>
+#include <drivers/rand32.h>
+
+#include <tinycrypt/ctr_prng.h>
+#include <tinycrypt/constants.h>
+
+#define SEED_SIZE (TC_AES_KEY_SIZE + TC_AES_BLOCK_SIZE)
+
+/* Output generated per interrupt lock */
+#define CHUNK_SIZE 32
+
+static const uint8_t personalization[] = "zephyr sys_rand32_get";
+
+static TCCtrPrng_t drbg;
+static struct device *entropy_dev;
+static bool seeded;
+
+static void drbg_seed(void)
+{
+	uint8_t entropy[SEED_SIZE];
+
+	if (!entropy_dev) {
+		entropy_dev = device_get_binding(CONFIG_RANDOM_NAME);
+		__ASSERT(entropy_dev, "no entropy driver");
+	}
+
+	random_get_entropy(entropy_dev, entropy, sizeof(entropy));
+
+	if (seeded) {
+		tc_ctr_prng_reseed(&drbg, entropy, sizeof(entropy), NULL, 0);
+	} else {
+		tc_ctr_prng_init(&drbg, entropy, sizeof(entropy),
+				 personalization, sizeof(personalization));
+		seeded = true;
+	}
+
+	memset(entropy, 0, sizeof(entropy));
+}
+
+void sys_rand_get(void *dst, size_t len)
+{
+	uint8_t *out = dst;
+	unsigned int key;
+	size_t chunk;
+
+	while (len) {
+		chunk = min(len, CHUNK_SIZE);
+
+		key = irq_lock();
+
+		/* Called before the init hook */
+		if (!seeded) {
+			drbg_seed();
+		}
+
+		if (tc_ctr_prng_generate(&drbg, NULL, 0, out, chunk) ==
+		    TC_CTR_PRNG_RESEED_REQ) {
+			drbg_seed();
+			tc_ctr_prng_generate(&drbg, NULL, 0, out, chunk);
+		}
+
+		irq_unlock(key);
+
+		out += chunk;
+		len -= chunk;
+	}
+}
+
+uint32_t sys_rand32_get(void)
+{
+	uint32_t output;
+
+	sys_rand_get(&output, sizeof(output));
+
+	return output;
+}
+
+static int rand32_ctr_drbg_init(struct device *dev)
+{
+	unsigned int key;
+
+	ARG_UNUSED(dev);
+
+	key = irq_lock();
+	if (!seeded) {
+		drbg_seed();
+	}
+	irq_unlock(key);
+
+	return 0;
+}
+
+SYS_INIT(rand32_ctr_drbg_init, PRE_KERNEL_2,
+	 CONFIG_KERNEL_INIT_PRIORITY_DEVICE);
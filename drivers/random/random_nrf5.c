@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Random driver for the nRF5 RNG
+ *
+ * The RNG produces a bias corrected byte every few tens of microseconds.
+ * Its interrupt fills a pool in the background, the generator being
+ * stopped once the pool is full and restarted as soon as it is drawn
+ * from, so that callers normally find their bytes ready.
+ */
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <random.h>
+#include <drivers/rand32.h>
+#include <soc.h>
+
+struct random_nrf5_data {
+	uint8_t first;
+	uint8_t last;
+	uint8_t pool[CONFIG_RANDOM_NRF5_POOL_SIZE + 1];
+};
+
+static struct random_nrf5_data random_nrf5_dev_data;
+
+static int random_nrf5_get_entropy_isr(struct device *dev, uint8_t *buffer,
+				       uint16_t length)
+{
+	struct random_nrf5_data *data = dev->driver_data;
+	unsigned int key;
+	uint16_t count = 0;
+
+	key = irq_lock();
+
+	while (count < length && data->first != data->last) {
+		buffer[count++] = data->pool[data->first];
+		data->first = (data->first + 1) % sizeof(data->pool);
+	}
+
+	if (count) {
+		NRF_RNG->TASKS_START = 1;
+	}
+
+	irq_unlock(key);
+
+	return count;
+}
+
+static int random_nrf5_get_entropy(struct device *dev, uint8_t *buffer,
+				   uint16_t length)
+{
+	int count;
+
+	count = random_nrf5_get_entropy_isr(dev, buffer, length);
+
+	if (count == length) {
+		return 0;
+	}
+
+	/* Pool exhausted, the bytes are taken from the RNG directly */
+	irq_disable(NRF5_IRQ_RNG_IRQn);
+
+	NRF_RNG->TASKS_START = 1;
+
+	while (count < length) {
+		while (!NRF_RNG->EVENTS_VALRDY) {
+		}
+
+		NRF_RNG->EVENTS_VALRDY = 0;
+		buffer[count++] = NRF_RNG->VALUE;
+	}
+
+	irq_enable(NRF5_IRQ_RNG_IRQn);
+
+	return 0;
+}
+
+static void random_nrf5_isr(void *arg)
+{
+	struct random_nrf5_data *data = ((struct device *)arg)->driver_data;
+	uint8_t last;
+
+	if (!NRF_RNG->EVENTS_VALRDY) {
+		return;
+	}
+
+	NRF_RNG->EVENTS_VALRDY = 0;
+
+	last = (data->last + 1) % sizeof(data->pool);
+	if (last != data->first) {
+		data->pool[data->last] = NRF_RNG->VALUE;
+		data->last = last;
+		last = (last + 1) % sizeof(data->pool);
+	}
+
+	if (last == data->first) {
+		NRF_RNG->TASKS_STOP = 1;
+	}
+}
+
+static const struct random_driver_api random_nrf5_api_funcs = {
+	.get_entropy = random_nrf5_get_entropy,
+	.get_entropy_isr = random_nrf5_get_entropy_isr,
+};
+
+static int random_nrf5_init(struct device *);
+
+DEVICE_AND_API_INIT(random_nrf5, CONFIG_RANDOM_NAME,
+		    random_nrf5_init, &random_nrf5_dev_data, NULL,
+		    PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		    &random_nrf5_api_funcs);
+
+static int random_nrf5_init(struct device *dev)
+{
+	NRF_RNG->CONFIG = RNG_CONFIG_DERCEN_Msk;
+	NRF_RNG->EVENTS_VALRDY = 0;
+	NRF_RNG->INTENSET = RNG_INTENSET_VALRDY_Msk;
+
+	IRQ_CONNECT(NRF5_IRQ_RNG_IRQn, CONFIG_RANDOM_NRF5_PRI,
+		    random_nrf5_isr, DEVICE_GET(random_nrf5), 0);
+	irq_enable(NRF5_IRQ_RNG_IRQn);
+
+	NRF_RNG->TASKS_START = 1;
+
+	return 0;
+}
+
+#if !defined(CONFIG_RANDOM_CTR_DRBG)
+uint32_t sys_rand32_get(void)
+{
+	uint32_t output;
+
+	random_nrf5_get_entropy(DEVICE_GET(random_nrf5), (uint8_t *)&output,
+				sizeof(output));
+
+	return output;
+}
+#endif
@@ -14,18 +14,21 @@
 static int bma280_sample_fetch(struct device *dev, enum sensor_channel chan)
 {
 	struct bma280_data *drv_data = dev->driver_data;
-	uint8_t buf[6];
+	uint8_t buf[7];
 	uint8_t lsb;
 
 	__ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL);
 
+	sensor_timestamp_fetch(&drv_data->ts);
+
 	/*
 	 * since all accel data register addresses are consecutive,
-	 * a burst read can be used to read all the samples
+	 * and directly followed by the temperature register, a burst
+	 * read can be used to read all the samples
 	 */
 	if (i2c_burst_read(drv_data->i2c, BMA280_I2C_ADDRESS,
-			   BMA280_REG_ACCEL_X_LSB, buf, 6) < 0) {
-		SYS_LOG_DBG("Could not read accel axis data");
+			   BMA280_REG_ACCEL_X_LSB, buf, 7) < 0) {
+		SYS_LOG_DBG("Could not read sample data");
 		return -EIO;
 	}
 
@@ -38,12 +41,7 @@ static int bma280_sample_fetch(struct device *dev, enum sensor_channel chan)
 	lsb = (buf[4] & BMA280_ACCEL_LSB_MASK) >> BMA280_ACCEL_LSB_SHIFT;
 	drv_data->z_sample = (((int8_t)buf[5]) << BMA280_ACCEL_LSB_BITS) | lsb;
 
-	if (i2c_reg_read_byte(drv_data->i2c, BMA280_I2C_ADDRESS,
-			      BMA280_REG_TEMP,
-			      (uint8_t *)&drv_data->temp_sample) < 0) {
-		SYS_LOG_DBG("Could not read temperature data");
-		return -EIO;
-	}
+	drv_data->temp_sample = (int8_t)buf[6];
 
 	return 0;
 }
@@ -99,6 +97,15 @@ static int bma280_channel_get(struct device *dev,
 	return 0;
 }
 
+static int bma280_timestamp_get(struct device *dev, uint32_t *cycles)
+{
+	struct bma280_data *drv_data = dev->driver_data;
+
+	*cycles = drv_data->ts.sample;
+
+	return 0;
+}
+
 static const struct sensor_driver_api bma280_driver_api = {
 #if CONFIG_BMA280_TRIGGER
 	.attr_set = bma280_attr_set,
@@ -106,6 +113,7 @@ static const struct sensor_driver_api bma280_driver_api = {
 #endif
 	.sample_fetch = bma280_sample_fetch,
 	.channel_get = bma280_channel_get,
+	.timestamp_get = bma280_timestamp_get,
 };
 
 int bma280_init(struct device *dev)
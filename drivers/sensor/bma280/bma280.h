@@ -119,6 +119,7 @@ struct bma280_data {
 	int16_t y_sample;
 	int16_t z_sample;
 	int8_t temp_sample;
+	struct sensor_timestamp ts;
 
 #ifdef CONFIG_BMA280_TRIGGER
 	struct device *gpio;
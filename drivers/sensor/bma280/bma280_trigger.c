@@ -58,12 +58,14 @@ static void bma280_gpio_callback(struct device *dev,
 
 	ARG_UNUSED(pins);
 
+	sensor_timestamp_irq(&drv_data->ts);
+
 	gpio_pin_disable_callback(dev, CONFIG_BMA280_GPIO_PIN_NUM);
 
 #if defined(CONFIG_BMA280_TRIGGER_OWN_THREAD)
 	k_sem_give(&drv_data->gpio_sem);
 #elif defined(CONFIG_BMA280_TRIGGER_GLOBAL_THREAD)
-	k_work_submit(&drv_data->work);
+	sensor_trigger_work_submit(&drv_data->work);
 #endif
 }
 
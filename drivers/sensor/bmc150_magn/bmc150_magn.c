@@ -294,6 +294,8 @@ static int bmc150_magn_sample_fetch(struct device *dev,
 
 	__ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL || chan == SENSOR_CHAN_MAGN_ANY);
 
+	sensor_timestamp_fetch(&data->ts);
+
 	if (i2c_burst_read(data->i2c_master, config->i2c_slave_addr,
 			   BMC150_MAGN_REG_X_L, (uint8_t *)values,
 			   sizeof(values)) < 0) {
@@ -319,6 +321,15 @@ static int bmc150_magn_sample_fetch(struct device *dev,
 	return 0;
 }
 
+static int bmc150_magn_timestamp_get(struct device *dev, uint32_t *cycles)
+{
+	struct bmc150_magn_data *data = dev->driver_data;
+
+	*cycles = data->ts.sample;
+
+	return 0;
+}
+
 static void bmc150_magn_convert(struct sensor_value *val, int raw_val)
 {
 	/* val = raw_val / 1600 */
@@ -471,6 +482,7 @@ static const struct sensor_driver_api bmc150_magn_api_funcs = {
 #endif
 	.sample_fetch = bmc150_magn_sample_fetch,
 	.channel_get = bmc150_magn_channel_get,
+	.timestamp_get = bmc150_magn_timestamp_get,
 #if defined(CONFIG_BMC150_MAGN_TRIGGER_DRDY)
 	.trigger_set = bmc150_magn_trigger_set,
 #endif
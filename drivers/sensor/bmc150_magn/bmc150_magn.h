@@ -131,6 +131,7 @@ struct bmc150_magn_data {
 	struct bmc150_magn_trim_regs tregs;
 	int rep_xy, rep_z, odr, max_odr;
 	int sample_x, sample_y, sample_z;
+	struct sensor_timestamp ts;
 };
 
 enum bmc150_magn_power_modes {
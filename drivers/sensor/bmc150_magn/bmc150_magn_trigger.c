@@ -63,6 +63,8 @@ static void bmc150_magn_gpio_drdy_callback(struct device *dev,
 
 	ARG_UNUSED(pins);
 
+	sensor_timestamp_irq(&data->ts);
+
 	gpio_pin_disable_callback(dev, config->gpio_drdy_int_pin);
 
 	k_sem_give(&data->sem);
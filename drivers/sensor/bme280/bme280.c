@@ -154,9 +154,66 @@ static int bme280_channel_get(struct device *dev,
 	return 0;
 }
 
+/* The compensated values, of the resolutions above */
+static int bme280_channel_get_raw(struct device *dev,
+				  enum sensor_channel chan,
+				  int32_t *raw)
+{
+	struct bme280_data *data = dev->driver_data;
+
+	switch (chan) {
+	case SENSOR_CHAN_TEMP:
+		*raw = data->comp_temp;
+		break;
+	case SENSOR_CHAN_PRESS:
+		*raw = data->comp_press;
+		break;
+	case SENSOR_CHAN_HUMIDITY:
+		*raw = data->comp_humidity;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int bme280_scale_get(struct device *dev,
+			    enum sensor_channel chan,
+			    struct sensor_scale *scale)
+{
+	ARG_UNUSED(dev);
+
+	scale->offset = 0;
+
+	switch (chan) {
+	case SENSOR_CHAN_TEMP:
+		/* 0.01 degC */
+		scale->mult = ((1ULL << 32) + 50) / 100;
+		scale->shift = 32;
+		break;
+	case SENSOR_CHAN_PRESS:
+		/* 1/256 Pa, in kPa */
+		scale->mult = ((1ULL << 40) + 128000) / 256000;
+		scale->shift = 40;
+		break;
+	case SENSOR_CHAN_HUMIDITY:
+		/* 1/1024 %RH, in milli percent */
+		scale->mult = 1000;
+		scale->shift = 10;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static const struct sensor_driver_api bme280_api_funcs = {
 	.sample_fetch = bme280_sample_fetch,
 	.channel_get = bme280_channel_get,
+	.channel_get_raw = bme280_channel_get_raw,
+	.scale_get = bme280_scale_get,
 };
 
 static int bme280_read_compensation(struct bme280_data *data)
@@ -198,6 +198,8 @@ static int bmg160_sample_fetch(struct device *dev, enum sensor_channel chan)
 		};
 	} buf __aligned(2);
 
+	sensor_timestamp_fetch(&bmg160->ts);
+
 	/* do a burst read, to fetch all axis data */
 	if (bmg160_read(dev, BMG160_REG_RATE_X, buf.raw, sizeof(buf)) < 0) {
 		return -EIO;
@@ -259,6 +261,15 @@ static int bmg160_channel_get(struct device *dev, enum sensor_channel chan,
 	}
 }
 
+static int bmg160_timestamp_get(struct device *dev, uint32_t *cycles)
+{
+	struct bmg160_device_data *bmg160 = dev->driver_data;
+
+	*cycles = bmg160->ts.sample;
+
+	return 0;
+}
+
 static const struct sensor_driver_api bmg160_api = {
 	.attr_set = bmg160_attr_set,
 #ifdef CONFIG_BMG160_TRIGGER
@@ -266,6 +277,7 @@ static const struct sensor_driver_api bmg160_api = {
 #endif
 	.sample_fetch = bmg160_sample_fetch,
 	.channel_get = bmg160_channel_get,
+	.timestamp_get = bmg160_timestamp_get,
 };
 
 int bmg160_init(struct device *dev)
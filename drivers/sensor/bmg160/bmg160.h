@@ -212,6 +212,8 @@ struct bmg160_device_data {
 	uint8_t range_idx;
 
 	int8_t raw_temp;
+
+	struct sensor_timestamp ts;
 };
 
 int bmg160_trigger_init(struct device *dev);
@@ -20,8 +20,8 @@
 struct bmi160_device_data bmi160_data;
 
 static int bmi160_transceive(struct device *dev, uint8_t *tx_buf,
-			     uint8_t tx_buf_len, uint8_t *rx_buf,
-			     uint8_t rx_buf_len)
+			     uint16_t tx_buf_len, uint8_t *rx_buf,
+			     uint16_t rx_buf_len)
 {
 	const struct bmi160_device_config *dev_cfg = dev->config->config_info;
 	struct bmi160_device_data *bmi160 = dev->driver_data;
@@ -54,6 +54,16 @@ int bmi160_read(struct device *dev, uint8_t reg_addr,
 	return bmi160_transceive(dev, tx, len, data, len);
 }
 
+int bmi160_fifo_read(struct device *dev, uint8_t *data, uint16_t len)
+{
+	/* The buffer is sent as well, TX being always ahead of RX, but
+	 * only the address byte matters.
+	 */
+	data[0] = BMI160_REG_FIFO_DATA | (1 << 7);
+
+	return bmi160_transceive(dev, data, len, data, len);
+}
+
 int bmi160_byte_read(struct device *dev, uint8_t reg_addr,
 		     uint8_t *byte)
 {
@@ -626,6 +636,14 @@ static int bmi160_attr_set(struct device *dev, enum sensor_channel chan,
 	case SENSOR_CHAN_ACCEL_Z:
 	case SENSOR_CHAN_ACCEL_ANY:
 		return bmi160_acc_config(dev, chan, attr, val);
+#endif
+#ifdef BMI160_STREAM
+	case SENSOR_CHAN_ALL:
+		if (attr == SENSOR_ATTR_FIFO_WATERMARK) {
+			return bmi160_fifo_wtm_set(dev, val);
+		}
+
+		return -ENOTSUP;
 #endif
 	default:
 		SYS_LOG_DBG("attr_set() not supported on this channel.");
@@ -795,6 +813,9 @@ static const struct sensor_driver_api bmi160_api = {
 	.attr_set = bmi160_attr_set,
 #ifdef CONFIG_BMI160_TRIGGER
 	.trigger_set = bmi160_trigger_set,
+#endif
+#ifdef BMI160_STREAM
+	.stream_set = bmi160_stream_set,
 #endif
 	.sample_fetch = bmi160_sample_fetch,
 	.channel_get = bmi160_channel_get,
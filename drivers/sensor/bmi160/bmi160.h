@@ -192,8 +192,18 @@
 #define BMI160_CMD_PMU_ACC		0x10
 #define BMI160_CMD_PMU_GYR		0x14
 #define BMI160_CMD_PMU_MAG		0x18
+#define BMI160_CMD_FIFO_FLUSH		0xB0
 #define BMI160_CMD_SOFT_RESET		0xB6
 
+/* BMI160_REG_FIFO_CONFIG1 */
+#define BMI160_FIFO_GYR_EN		BIT(7)
+#define BMI160_FIFO_ACC_EN		BIT(6)
+#define BMI160_FIFO_MAG_EN		BIT(5)
+#define BMI160_FIFO_HEADER_EN		BIT(4)
+
+/* BMI160_REG_FIFO_LENGTH1 */
+#define BMI160_FIFO_LENGTH1_MASK	0x7
+
 /* BMI160_REG_FOC_CONF */
 #define BMI160_FOC_ACC_Z_POS		0
 #define BMI160_FOC_ACC_Y_POS		2
@@ -244,6 +254,9 @@
 /* other */
 #define BMI160_CHIP_ID			0xD1
 #define BMI160_TEMP_OFFSET		23
+#define BMI160_FIFO_SIZE		1024
+/* the watermark register counts 4 bytes units */
+#define BMI160_FIFO_WTM_UNIT		4
 
 /* allowed ODR values */
 enum bmi160_odr {
@@ -430,6 +443,14 @@ struct bmi160_scale {
 	uint16_t gyr; /* micro radians/s/lsb */
 };
 
+#if defined(CONFIG_SENSOR_STREAM) && defined(CONFIG_BMI160_TRIGGER)
+#define BMI160_STREAM
+
+/* most frames read out of the FIFO in one burst */
+#define BMI160_FIFO_BURST		16
+#define BMI160_FIFO_WTM_DEFAULT		8
+#endif
+
 struct bmi160_device_data {
 	struct device *spi;
 #if defined(CONFIG_BMI160_TRIGGER)
@@ -458,10 +479,22 @@ struct bmi160_device_data {
 	sensor_trigger_handler_t handler_drdy_gyr;
 #endif
 #endif /* CONFIG_BMI160_TRIGGER */
+
+#ifdef BMI160_STREAM
+	struct ring_buf *stream;
+	sensor_trigger_handler_t handler_stream;
+	/* sample period, in cycles */
+	uint32_t stream_period;
+	uint8_t fifo_wtm;
+	/* one dummy byte, needed by SPI, followed by the frames */
+	uint8_t fifo_buf[1 + BMI160_FIFO_BURST * BMI160_SAMPLE_SIZE];
+	uint32_t batch[SENSOR_BATCH_SIZE32(BMI160_FIFO_BURST)];
+#endif
 };
 
 int bmi160_read(struct device *dev, uint8_t reg_addr,
 		uint8_t *data, uint8_t len);
+int bmi160_fifo_read(struct device *dev, uint8_t *data, uint16_t len);
 int bmi160_byte_read(struct device *dev, uint8_t reg_addr, uint8_t *byte);
 int bmi160_byte_write(struct device *dev, uint8_t reg_addr, uint8_t byte);
 int bmi160_word_write(struct device *dev, uint8_t reg_addr, uint16_t word);
@@ -478,6 +511,11 @@ int bmi160_trigger_set(struct device *dev,
 		       sensor_trigger_handler_t handler);
 int bmi160_acc_slope_config(struct device *dev, enum sensor_attribute attr,
 			    const struct sensor_value *val);
+#ifdef BMI160_STREAM
+int bmi160_stream_set(struct device *dev, struct ring_buf *ring,
+		      sensor_trigger_handler_t handler);
+int bmi160_fifo_wtm_set(struct device *dev, const struct sensor_value *val);
+#endif
 int32_t bmi160_acc_reg_val_to_range(uint8_t reg_val);
 int32_t bmi160_gyr_reg_val_to_range(uint8_t reg_val);
 
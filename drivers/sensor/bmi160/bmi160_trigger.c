@@ -8,6 +8,7 @@
 #include <kernel.h>
 #include <sensor.h>
 #include <gpio.h>
+#include <misc/byteorder.h>
 
 #include "bmi160.h"
 
@@ -46,6 +47,82 @@ static void bmi160_handle_drdy(struct device *dev, uint8_t status)
 #endif
 }
 
+#ifdef BMI160_STREAM
+static void bmi160_stream_put(struct device *dev, enum sensor_channel chan,
+			      int count, int ofs, int32_t scale,
+			      uint32_t timestamp)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+	struct sensor_batch *batch = (struct sensor_batch *)bmi160->batch;
+	const uint8_t *frame = &bmi160->fifo_buf[BMI160_DATA_OFS + ofs];
+	int i;
+
+	batch->timestamp = timestamp;
+	batch->period = bmi160->stream_period;
+	batch->scale = scale;
+
+	for (i = 0; i < count * 3; i += 3) {
+		batch->samples[i] = sys_get_le16(&frame[0]);
+		batch->samples[i + 1] = sys_get_le16(&frame[2]);
+		batch->samples[i + 2] = sys_get_le16(&frame[4]);
+		frame += BMI160_SAMPLE_SIZE;
+	}
+
+	if (sys_ring_buf_put(bmi160->stream, chan, count, bmi160->batch,
+			     SENSOR_BATCH_SIZE32(count)) < 0) {
+		SYS_LOG_DBG("Stream buffer full, batch dropped.");
+	}
+}
+
+static void bmi160_handle_fifo(struct device *dev)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+	struct sensor_trigger fwm_trigger = {
+		.type = SENSOR_TRIG_FIFO_WATERMARK,
+		.chan = SENSOR_CHAN_ALL,
+	};
+	uint32_t now = k_cycle_get_32();
+	uint8_t buf[3];
+	int frames, count;
+
+	if (bmi160_read(dev, BMI160_REG_FIFO_LENGTH0, buf, sizeof(buf)) < 0) {
+		return;
+	}
+
+	frames = (buf[1] | (buf[2] & BMI160_FIFO_LENGTH1_MASK) << 8) /
+		 BMI160_SAMPLE_SIZE;
+
+	while (frames) {
+		count = min(frames, BMI160_FIFO_BURST);
+
+		if (bmi160_fifo_read(dev, bmi160->fifo_buf,
+				     BMI160_DATA_OFS +
+				     count * BMI160_SAMPLE_SIZE) < 0) {
+			return;
+		}
+
+		frames -= count;
+
+		/* in headerless mode, gyro data comes first in a frame */
+#if !defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+		bmi160_stream_put(dev, SENSOR_CHAN_GYRO_ANY, count, 0,
+				  bmi160->scale.gyr,
+				  now - frames * bmi160->stream_period);
+#endif
+#if !defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
+		bmi160_stream_put(dev, SENSOR_CHAN_ACCEL_ANY, count,
+				  BMI160_SAMPLE_SIZE - 3 * sizeof(uint16_t),
+				  bmi160->scale.acc,
+				  now - frames * bmi160->stream_period);
+#endif
+	}
+
+	if (bmi160->handler_stream) {
+		bmi160->handler_stream(dev, &fwm_trigger);
+	}
+}
+#endif
+
 static void bmi160_handle_interrupts(void *arg)
 {
 	struct device *dev = (struct device *)arg;
@@ -74,6 +151,12 @@ static void bmi160_handle_interrupts(void *arg)
 		bmi160_handle_drdy(dev, buf.status);
 	}
 
+#ifdef BMI160_STREAM
+	if ((buf.int_status[1] & BMI160_INT_STATUS1_FWM) &&
+	    ((struct bmi160_device_data *)dev->driver_data)->stream) {
+		bmi160_handle_fifo(dev);
+	}
+#endif
 }
 
 #ifdef CONFIG_BMI160_TRIGGER_OWN_THREAD
@@ -117,7 +200,7 @@ static void bmi160_gpio_callback(struct device *port,
 #if defined(CONFIG_BMI160_TRIGGER_OWN_THREAD)
 	k_sem_give(&bmi160->sem);
 #elif defined(CONFIG_BMI160_TRIGGER_GLOBAL_THREAD)
-	k_work_submit(&bmi160->work);
+	sensor_trigger_work_submit(&bmi160->work);
 #endif
 }
 
@@ -249,6 +332,97 @@ static int bmi160_trigger_set_gyr(struct device *dev,
 }
 #endif
 
+#ifdef BMI160_STREAM
+static int bmi160_fifo_wtm_write(struct device *dev, uint8_t frames)
+{
+	return bmi160_byte_write(dev, BMI160_REG_FIFO_CONFIG0,
+				 frames * BMI160_SAMPLE_SIZE /
+				 BMI160_FIFO_WTM_UNIT);
+}
+
+int bmi160_fifo_wtm_set(struct device *dev, const struct sensor_value *val)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+
+	/* the register has 8 bits */
+	if (val->val1 < 1 ||
+	    val->val1 * BMI160_SAMPLE_SIZE > 255 * BMI160_FIFO_WTM_UNIT) {
+		return -EINVAL;
+	}
+
+	bmi160->fifo_wtm = val->val1;
+
+	if (bmi160->stream && bmi160_fifo_wtm_write(dev, val->val1) < 0) {
+		return -EIO;
+	}
+
+	return 0;
+}
+
+int bmi160_stream_set(struct device *dev, struct ring_buf *ring,
+		      sensor_trigger_handler_t handler)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+	uint8_t fifo_en = 0;
+	uint8_t odr;
+
+	if (!ring) {
+		bmi160->stream = NULL;
+
+		if (bmi160_reg_update(dev, BMI160_REG_INT_EN1,
+				      BMI160_INT_FWM_EN, 0) < 0 ||
+		    bmi160_byte_write(dev, BMI160_REG_FIFO_CONFIG1, 0) < 0) {
+			return -EIO;
+		}
+
+		return 0;
+	}
+
+	/*
+	 * In headerless mode, all the enabled sensors must run at the
+	 * same rate, the period is taken from the gyro's when enabled.
+	 */
+#if !defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+	fifo_en |= BMI160_FIFO_GYR_EN;
+	if (bmi160_byte_read(dev, BMI160_REG_GYR_CONF, &odr) < 0) {
+		return -EIO;
+	}
+	odr &= BMI160_GYR_CONF_ODR_MASK;
+#endif
+#if !defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
+	fifo_en |= BMI160_FIFO_ACC_EN;
+#if defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+	if (bmi160_byte_read(dev, BMI160_REG_ACC_CONF, &odr) < 0) {
+		return -EIO;
+	}
+	odr &= BMI160_ACC_CONF_ODR_MASK;
+#endif
+#endif
+
+	/* ODR value n stands for 100 * 2^(n - 8) Hz */
+	bmi160->stream_period = ((uint64_t)sys_clock_hw_cycles_per_sec << 8) /
+				(100 << odr);
+
+	if (bmi160_fifo_wtm_write(dev, bmi160->fifo_wtm) < 0 ||
+	    bmi160_byte_write(dev, BMI160_REG_CMD,
+			      BMI160_CMD_FIFO_FLUSH) < 0 ||
+	    bmi160_byte_write(dev, BMI160_REG_FIFO_CONFIG1, fifo_en) < 0) {
+		return -EIO;
+	}
+
+	bmi160->handler_stream = handler;
+	bmi160->stream = ring;
+
+	if (bmi160_reg_update(dev, BMI160_REG_INT_EN1,
+			      BMI160_INT_FWM_EN, BMI160_INT_FWM_EN) < 0) {
+		bmi160->stream = NULL;
+		return -EIO;
+	}
+
+	return 0;
+}
+#endif
+
 int bmi160_trigger_set(struct device *dev,
 		       const struct sensor_trigger *trig,
 		       sensor_trigger_handler_t handler)
@@ -272,6 +446,10 @@ int bmi160_trigger_mode_init(struct device *dev)
 
 	const struct bmi160_device_config *cfg = dev->config->config_info;
 
+#ifdef BMI160_STREAM
+	bmi160->fifo_wtm = BMI160_FIFO_WTM_DEFAULT;
+#endif
+
 	bmi160->gpio = device_get_binding((char *)cfg->gpio_port);
 	if (!bmi160->gpio) {
 		SYS_LOG_DBG("Gpio controller %s not found.", cfg->gpio_port);
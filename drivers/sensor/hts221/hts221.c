@@ -50,6 +50,66 @@ static int hts221_channel_get(struct device *dev,
 	return 0;
 }
 
+/* The samples of the ADC, calibrated by the linear interpolation of
+ * hts221_channel_get() folded into the scale.
+ */
+static int hts221_channel_get_raw(struct device *dev,
+				  enum sensor_channel chan,
+				  int32_t *raw)
+{
+	struct hts221_data *drv_data = dev->driver_data;
+
+	if (chan == SENSOR_CHAN_TEMP) {
+		*raw = drv_data->t_sample;
+	} else if (chan == SENSOR_CHAN_HUMIDITY) {
+		*raw = drv_data->rh_sample;
+	} else {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+#define HTS221_TEMP_SHIFT	24
+#define HTS221_RH_SHIFT		16
+
+static int hts221_scale_get(struct device *dev,
+			    enum sensor_channel chan,
+			    struct sensor_scale *scale)
+{
+	struct hts221_data *drv_data = dev->driver_data;
+	int64_t num;
+	int32_t den;
+
+	if (chan == SENSOR_CHAN_TEMP) {
+		/* degrees Celsius x8, converted to degrees Celsius */
+		num = (int64_t)(drv_data->t1_degc_x8 - drv_data->t0_degc_x8) <<
+		      (HTS221_TEMP_SHIFT - 3);
+		den = drv_data->t1_out - drv_data->t0_out;
+
+		scale->mult = num / den;
+		scale->offset = ((int64_t)drv_data->t0_degc_x8 <<
+				 (HTS221_TEMP_SHIFT - 3)) -
+				(int64_t)drv_data->t0_out * scale->mult;
+		scale->shift = HTS221_TEMP_SHIFT;
+	} else if (chan == SENSOR_CHAN_HUMIDITY) {
+		/* humidity x2, converted to milli percent */
+		num = ((int64_t)(drv_data->h1_rh_x2 - drv_data->h0_rh_x2) *
+		       500) << HTS221_RH_SHIFT;
+		den = drv_data->h1_t0_out - drv_data->h0_t0_out;
+
+		scale->mult = num / den;
+		scale->offset = ((int64_t)drv_data->h0_rh_x2 * 500 <<
+				 HTS221_RH_SHIFT) -
+				(int64_t)drv_data->h0_t0_out * scale->mult;
+		scale->shift = HTS221_RH_SHIFT;
+	} else {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static int hts221_sample_fetch(struct device *dev, enum sensor_channel chan)
 {
 	struct hts221_data *drv_data = dev->driver_data;
@@ -99,6 +159,8 @@ static const struct sensor_driver_api hts221_driver_api = {
 #endif
 	.sample_fetch = hts221_sample_fetch,
 	.channel_get = hts221_channel_get,
+	.channel_get_raw = hts221_channel_get_raw,
+	.scale_get = hts221_scale_get,
 };
 
 int hts221_init(struct device *dev)
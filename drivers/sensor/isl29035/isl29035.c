@@ -17,21 +17,17 @@
 static int isl29035_sample_fetch(struct device *dev, enum sensor_channel chan)
 {
 	struct isl29035_driver_data *drv_data = dev->driver_data;
-	uint8_t msb, lsb;
+	uint8_t buf[2];
 
 	__ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL);
 
-	if (i2c_reg_read_byte(drv_data->i2c, ISL29035_I2C_ADDRESS,
-				ISL29035_DATA_MSB_REG, &msb) < 0) {
+	/* LSB and MSB are consecutive, read both in one transfer */
+	if (i2c_burst_read(drv_data->i2c, ISL29035_I2C_ADDRESS,
+			   ISL29035_DATA_LSB_REG, buf, 2) < 0) {
 		return -EIO;
 	}
 
-	if (i2c_reg_read_byte(drv_data->i2c, ISL29035_I2C_ADDRESS,
-				ISL29035_DATA_LSB_REG, &lsb) < 0) {
-		return -EIO;
-	}
-
-	drv_data->data_sample = (msb << 8) + lsb;
+	drv_data->data_sample = (buf[1] << 8) + buf[0];
 
 	return 0;
 }
@@ -70,7 +70,7 @@ static void isl29035_gpio_callback(struct device *dev,
 #if defined(CONFIG_ISL29035_TRIGGER_OWN_THREAD)
 	k_sem_give(&drv_data->gpio_sem);
 #elif defined(CONFIG_ISL29035_TRIGGER_GLOBAL_THREAD)
-	k_work_submit(&drv_data->work);
+	sensor_trigger_work_submit(&drv_data->work);
 #endif
 }
 
@@ -118,29 +118,22 @@ static int lsm9ds0_gyro_sample_fetch(struct device *dev,
 {
 	struct lsm9ds0_gyro_data *data = dev->driver_data;
 	const struct lsm9ds0_gyro_config *config = dev->config->config_info;
-	uint8_t x_l, x_h, y_l, y_h, z_l, z_h;
+	uint8_t buf[6];
 
 	__ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL || chan == SENSOR_CHAN_GYRO_ANY);
 
-	if (i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
-			      LSM9DS0_GYRO_REG_OUT_X_L_G, &x_l) < 0 ||
-	    i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
-			      LSM9DS0_GYRO_REG_OUT_X_H_G, &x_h) < 0 ||
-	    i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
-			      LSM9DS0_GYRO_REG_OUT_Y_L_G, &y_l) < 0 ||
-	    i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
-			      LSM9DS0_GYRO_REG_OUT_Y_H_G, &y_h) < 0 ||
-	    i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
-			      LSM9DS0_GYRO_REG_OUT_Z_L_G, &z_l) < 0 ||
-	    i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
-			      LSM9DS0_GYRO_REG_OUT_Z_H_G, &z_h) < 0) {
+	/* The output registers are consecutive, read them in one go */
+	if (i2c_burst_read(data->i2c_master, config->i2c_slave_addr,
+			   LSM9DS0_GYRO_REG_OUT_X_L_G |
+			   LSM9DS0_GYRO_AUTOINCREMENT_ADDR,
+			   buf, sizeof(buf)) < 0) {
 		SYS_LOG_DBG("failed to read sample");
 		return -EIO;
 	}
 
-	data->sample_x = (int16_t)((uint16_t)(x_l) | ((uint16_t)(x_h) << 8));
-	data->sample_y = (int16_t)((uint16_t)(y_l) | ((uint16_t)(y_h) << 8));
-	data->sample_z = (int16_t)((uint16_t)(z_l) | ((uint16_t)(z_h) << 8));
+	data->sample_x = (int16_t)sys_get_le16(&buf[0]);
+	data->sample_y = (int16_t)sys_get_le16(&buf[2]);
+	data->sample_z = (int16_t)sys_get_le16(&buf[4]);
 
 #if defined(CONFIG_LSM9DS0_GYRO_FULLSCALE_RUNTIME)
 	data->sample_fs = data->fs;
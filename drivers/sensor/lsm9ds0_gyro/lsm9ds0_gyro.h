@@ -105,6 +105,9 @@
 #define LSM9DS0_GYRO_REG_OUT_Z_L_G              0x2C
 #define LSM9DS0_GYRO_REG_OUT_Z_H_G              0x2D
 
+/* Set in the register address to read several registers in a row */
+#define LSM9DS0_GYRO_AUTOINCREMENT_ADDR         BIT(7)
+
 #define LSM9DS0_GYRO_REG_FIFO_CTRL_REG_G        0x2E
 #define LSM9DS0_GYRO_MASK_FIFO_CTRL_REG_G_FM    (BIT(7) | BIT(6) | BIT(5))
 #define LSM9DS0_GYRO_SHIFT_FIFO_CTRL_REG_G_FM   5
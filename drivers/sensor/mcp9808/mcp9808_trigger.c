@@ -138,7 +138,7 @@ static void mcp9808_gpio_cb(struct device *dev,
 
 	ARG_UNUSED(pins);
 
-	k_work_submit(&data->work);
+	sensor_trigger_work_submit(&data->work);
 }
 
 static void mcp9808_gpio_thread_cb(struct k_work *work)
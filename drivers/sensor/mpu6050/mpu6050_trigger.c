@@ -49,7 +49,7 @@ static void mpu6050_gpio_callback(struct device *dev,
 #if defined(CONFIG_MPU6050_TRIGGER_OWN_THREAD)
 	k_sem_give(&drv_data->gpio_sem);
 #elif defined(CONFIG_MPU6050_TRIGGER_GLOBAL_THREAD)
-	k_work_submit(&drv_data->work);
+	sensor_trigger_work_submit(&drv_data->work);
 #endif
 }
 
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <sensor.h>
+
+/* Groups started by a trigger, looked up by leader */
+static sys_slist_t triggered = SYS_SLIST_STATIC_INIT(&triggered);
+
+static void group_fetch(struct sensor_group *group)
+{
+	int err = 0;
+	int i;
+
+	if (group->leader) {
+		err = sensor_sample_fetch(group->leader);
+	}
+
+	for (i = 0; i < group->count; i++) {
+		int ret;
+
+		if (group->sensors[i] == group->leader) {
+			continue;
+		}
+
+		ret = sensor_sample_fetch(group->sensors[i]);
+		if (ret && !err) {
+			err = ret;
+		}
+	}
+
+	if (group->handler) {
+		group->handler(group, err);
+	}
+}
+
+static int group_timer_submit(struct sensor_group *group, int32_t delay)
+{
+#ifdef CONFIG_SENSOR_TRIGGER_THREAD
+	return k_delayed_work_submit_to_queue(&sensor_trigger_workq,
+					      &group->work, delay);
+#else
+	return k_delayed_work_submit(&group->work, delay);
+#endif
+}
+
+static void group_timer(struct k_work *work)
+{
+	struct sensor_group *group = CONTAINER_OF(work, struct sensor_group,
+						  work);
+
+	/* Rescheduled first so that the period doesn't drift */
+	if (group->period) {
+		group_timer_submit(group, group->period);
+	}
+
+	group_fetch(group);
+}
+
+static void group_trigger(struct device *dev, struct sensor_trigger *trig)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&triggered, node) {
+		struct sensor_group *group = CONTAINER_OF(node,
+							  struct sensor_group,
+							  node);
+
+		if (group->leader == dev && group->trig.type == trig->type) {
+			group_fetch(group);
+		}
+	}
+}
+
+int sensor_group_timer_start(struct sensor_group *group, int32_t period)
+{
+	if (period <= 0) {
+		return -EINVAL;
+	}
+
+	group->leader = NULL;
+	group->period = period;
+	k_delayed_work_init(&group->work, group_timer);
+
+	return group_timer_submit(group, period);
+}
+
+int sensor_group_trigger_start(struct sensor_group *group,
+			       struct device *leader,
+			       const struct sensor_trigger *trig)
+{
+	unsigned int key;
+	int err;
+
+	group->leader = leader;
+	group->trig = *trig;
+
+	key = irq_lock();
+	sys_slist_append(&triggered, &group->node);
+	irq_unlock(key);
+
+	err = sensor_trigger_set(leader, &group->trig, group_trigger);
+	if (err) {
+		key = irq_lock();
+		sys_slist_find_and_remove(&triggered, &group->node);
+		irq_unlock(key);
+	}
+
+	return err;
+}
+
+void sensor_group_stop(struct sensor_group *group)
+{
+	unsigned int key;
+
+	if (!group->leader) {
+		group->period = 0;
+		k_delayed_work_cancel(&group->work);
+		return;
+	}
+
+	sensor_trigger_set(group->leader, &group->trig, NULL);
+
+	key = irq_lock();
+	sys_slist_find_and_remove(&triggered, &group->node);
+	irq_unlock(key);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Work queue running the triggers of the sensor drivers
+ *
+ * The drivers using the global thread submit the work of their data
+ * ready and threshold interrupts here instead of to the system work
+ * queue. A trigger interrupting again before its work ran is handled
+ * once, the work being still pending, and the triggers of all the
+ * sensors run one after the other, so the bus transfers of one sensor
+ * never wait for the bus lock held by another.
+ */
+
+#include <kernel.h>
+#include <init.h>
+#include <sensor.h>
+
+struct k_work_q sensor_trigger_workq;
+
+static char __noinit __stack
+	sensor_trigger_stack[CONFIG_SENSOR_TRIGGER_THREAD_STACK_SIZE];
+
+static int sensor_trigger_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_work_q_start(&sensor_trigger_workq, sensor_trigger_stack,
+		       sizeof(sensor_trigger_stack),
+		       K_PRIO_COOP(CONFIG_SENSOR_TRIGGER_THREAD_PRIORITY));
+
+	return 0;
+}
+
+/* Before the sensor drivers, which may submit work at init */
+SYS_INIT(sensor_trigger_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -91,7 +91,7 @@ static void sht3xd_gpio_callback(struct device *dev,
 #if defined(CONFIG_SHT3XD_TRIGGER_OWN_THREAD)
 	k_sem_give(&drv_data->gpio_sem);
 #elif defined(CONFIG_SHT3XD_TRIGGER_GLOBAL_THREAD)
-	k_work_submit(&drv_data->work);
+	sensor_trigger_work_submit(&drv_data->work);
 #endif
 }
 
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Asynchronous UART API on top of the interrupt driven one
+ *
+ * Bytes are moved between the hardware FIFO and the user buffers
+ * straight from the UART interrupt, the user only being called back
+ * once a buffer is done or after the line went idle.
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <uart.h>
+
+static sys_slist_t contexts;
+
+static struct uart_async *async_get(struct device *dev)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&contexts, node) {
+		struct uart_async *async = CONTAINER_OF(node,
+							struct uart_async,
+							node);
+
+		if (async->dev == dev) {
+			return async;
+		}
+	}
+
+	return NULL;
+}
+
+static void event_raise(struct uart_async *async, struct uart_event *evt)
+{
+	async->cb(async->dev, evt, async->user_data);
+}
+
+static void rx_report(struct uart_async *async)
+{
+	struct uart_event evt;
+
+	if (async->rx_off == async->rx_reported) {
+		return;
+	}
+
+	evt.type = UART_RX_RDY;
+	evt.data.rx.buf = async->rx_buf;
+	evt.data.rx.offset = async->rx_reported;
+	evt.data.rx.len = async->rx_off - async->rx_reported;
+	async->rx_reported = async->rx_off;
+
+	event_raise(async, &evt);
+}
+
+static void rx_buf_release(struct uart_async *async, uint8_t *buf)
+{
+	struct uart_event evt;
+
+	evt.type = UART_RX_BUF_RELEASED;
+	evt.data.rx_buf.buf = buf;
+
+	event_raise(async, &evt);
+}
+
+static void rx_buf_request(struct uart_async *async)
+{
+	struct uart_event evt;
+
+	evt.type = UART_RX_BUF_REQUEST;
+
+	event_raise(async, &evt);
+}
+
+static void rx_stop(struct uart_async *async)
+{
+	struct uart_event evt;
+
+	uart_irq_rx_disable(async->dev);
+	k_timer_stop(&async->rx_timer);
+
+	rx_report(async);
+	rx_buf_release(async, async->rx_buf);
+	async->rx_buf = NULL;
+
+	if (async->rx_next) {
+		rx_buf_release(async, async->rx_next);
+		async->rx_next = NULL;
+	}
+
+	evt.type = UART_RX_DISABLED;
+	event_raise(async, &evt);
+}
+
+static void rx_isr(struct uart_async *async)
+{
+	size_t start = async->rx_off;
+	int len;
+
+	while (async->rx_buf) {
+		len = uart_fifo_read(async->dev, async->rx_buf + async->rx_off,
+				     async->rx_len - async->rx_off);
+		if (len <= 0) {
+			break;
+		}
+
+		async->rx_off += len;
+		if (async->rx_off < async->rx_len) {
+			continue;
+		}
+
+		rx_report(async);
+
+		if (!async->rx_next) {
+			/* The data would be lost from now on anyway */
+			rx_stop(async);
+			return;
+		}
+
+		rx_buf_release(async, async->rx_buf);
+		async->rx_buf = async->rx_next;
+		async->rx_len = async->rx_next_len;
+		async->rx_next = NULL;
+		async->rx_off = 0;
+		async->rx_reported = 0;
+		start = 0;
+
+		rx_buf_request(async);
+	}
+
+	/* Restarted on every new byte, so it expires once the line is idle */
+	if (async->rx_off != start && async->rx_timeout != K_FOREVER) {
+		k_timer_start(&async->rx_timer, async->rx_timeout, 0);
+	}
+}
+
+static void tx_isr(struct uart_async *async)
+{
+	struct uart_event evt;
+
+	if (!async->tx_buf) {
+		uart_irq_tx_disable(async->dev);
+		return;
+	}
+
+	async->tx_off += uart_fifo_fill(async->dev,
+					async->tx_buf + async->tx_off,
+					async->tx_len - async->tx_off);
+	if (async->tx_off < async->tx_len) {
+		return;
+	}
+
+	uart_irq_tx_disable(async->dev);
+
+	evt.type = UART_TX_DONE;
+	evt.data.tx.buf = async->tx_buf;
+	evt.data.tx.len = async->tx_len;
+	async->tx_buf = NULL;
+
+	event_raise(async, &evt);
+}
+
+static void uart_async_isr(struct device *dev)
+{
+	struct uart_async *async = async_get(dev);
+
+	if (!async) {
+		return;
+	}
+
+	while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+		if (uart_irq_rx_ready(dev)) {
+			rx_isr(async);
+		}
+
+		if (uart_irq_tx_ready(dev)) {
+			tx_isr(async);
+		}
+	}
+}
+
+static void rx_timeout(struct k_timer *timer)
+{
+	struct uart_async *async = CONTAINER_OF(timer, struct uart_async,
+						rx_timer);
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (async->rx_buf) {
+		rx_report(async);
+	}
+
+	irq_unlock(key);
+}
+
+int uart_async_init(struct uart_async *async, struct device *dev,
+		    uart_callback_t cb, void *user_data)
+{
+	unsigned int key;
+
+	if (!cb) {
+		return -EINVAL;
+	}
+
+	async->dev = dev;
+	async->cb = cb;
+	async->user_data = user_data;
+	async->tx_buf = NULL;
+	async->rx_buf = NULL;
+	async->rx_next = NULL;
+	k_timer_init(&async->rx_timer, rx_timeout, NULL);
+
+	uart_irq_rx_disable(dev);
+	uart_irq_tx_disable(dev);
+
+	key = irq_lock();
+	sys_slist_find_and_remove(&contexts, &async->node);
+	sys_slist_append(&contexts, &async->node);
+	irq_unlock(key);
+
+	uart_irq_callback_set(dev, uart_async_isr);
+
+	return 0;
+}
+
+int uart_async_tx(struct uart_async *async, const uint8_t *buf, size_t len)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (async->tx_buf) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	async->tx_buf = buf;
+	async->tx_len = len;
+	async->tx_off = 0;
+
+	irq_unlock(key);
+
+	uart_irq_tx_enable(async->dev);
+
+	return 0;
+}
+
+int uart_async_tx_abort(struct uart_async *async)
+{
+	struct uart_event evt;
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (!async->tx_buf) {
+		irq_unlock(key);
+		return -EFAULT;
+	}
+
+	uart_irq_tx_disable(async->dev);
+
+	evt.type = UART_TX_ABORTED;
+	evt.data.tx.buf = async->tx_buf;
+	evt.data.tx.len = async->tx_off;
+	async->tx_buf = NULL;
+
+	irq_unlock(key);
+
+	event_raise(async, &evt);
+
+	return 0;
+}
+
+int uart_async_rx_enable(struct uart_async *async, uint8_t *buf, size_t len,
+			 int32_t timeout)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (async->rx_buf) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	async->rx_buf = buf;
+	async->rx_len = len;
+	async->rx_off = 0;
+	async->rx_reported = 0;
+	async->rx_next = NULL;
+	async->rx_timeout = timeout;
+
+	irq_unlock(key);
+
+	rx_buf_request(async);
+
+	uart_irq_rx_enable(async->dev);
+
+	return 0;
+}
+
+int uart_async_rx_buf_rsp(struct uart_async *async, uint8_t *buf,
+			  size_t len)
+{
+	unsigned int key;
+	int err = 0;
+
+	key = irq_lock();
+
+	if (!async->rx_buf) {
+		err = -EACCES;
+	} else if (async->rx_next) {
+		err = -EBUSY;
+	} else {
+		async->rx_next = buf;
+		async->rx_next_len = len;
+	}
+
+	irq_unlock(key);
+
+	return err;
+}
+
+int uart_async_rx_disable(struct uart_async *async)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (!async->rx_buf) {
+		irq_unlock(key);
+		return -EFAULT;
+	}
+
+	rx_stop(async);
+
+	irq_unlock(key);
+
+	return 0;
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <init.h>
+#include <misc/util.h>
+#include <spi.h>
+
+#include "spi_async.h"
+
+static struct k_work_q spi_async_work_q;
+static char __stack spi_async_stack[CONFIG_SPI_ASYNC_STACK_SIZE];
+
+/* Start the next chunk of the current transaction, false once none is left
+ * or on error.
+ */
+static bool chunk_start(struct spi_async_queue *queue)
+{
+	uint32_t tx_len, rx_len, len;
+	void *tx_buf = NULL;
+	void *rx_buf = NULL;
+
+	while (queue->tx_count && queue->tx_off == queue->tx->len) {
+		queue->tx++;
+		queue->tx_count--;
+		queue->tx_off = 0;
+	}
+
+	while (queue->rx_count && queue->rx_off == queue->rx->len) {
+		queue->rx++;
+		queue->rx_count--;
+		queue->rx_off = 0;
+	}
+
+	tx_len = queue->tx_count ? queue->tx->len - queue->tx_off : 0;
+	rx_len = queue->rx_count ? queue->rx->len - queue->rx_off : 0;
+
+	if (tx_len && rx_len) {
+		len = min(tx_len, rx_len);
+	} else if (tx_len || rx_len) {
+		len = tx_len ? tx_len : rx_len;
+	} else {
+		return false;
+	}
+
+	if (tx_len && queue->tx->buf) {
+		tx_buf = (uint8_t *)queue->tx->buf + queue->tx_off;
+	}
+
+	if (rx_len && queue->rx->buf) {
+		rx_buf = (uint8_t *)queue->rx->buf + queue->rx_off;
+	}
+
+	queue->len = min(len, queue->chunk_max);
+	queue->status = queue->ops->chunk(queue->dev, tx_buf, rx_buf,
+					  queue->len);
+
+	return !queue->status;
+}
+
+static void chunk_advance(struct spi_async_queue *queue)
+{
+	if (queue->tx_count) {
+		queue->tx_off += queue->len;
+	}
+
+	if (queue->rx_count) {
+		queue->rx_off += queue->len;
+	}
+}
+
+static void trans_finish(struct spi_async_queue *queue)
+{
+	struct spi_transaction *trans = queue->current;
+
+	queue->ops->end(queue->dev, trans);
+	queue->current = NULL;
+
+	if (trans->cb) {
+		trans->cb(queue->dev, queue->status, trans->user_data);
+	}
+}
+
+static void spi_async_work(struct k_work *work)
+{
+	struct spi_async_queue *queue = CONTAINER_OF(work,
+						     struct spi_async_queue,
+						     work);
+	sys_snode_t *node;
+	unsigned int key;
+
+	if (queue->current) {
+		/* Kicked by a submission while a chunk is in flight */
+		if (!atomic_cas(&queue->done, 1, 0)) {
+			return;
+		}
+
+		queue->status = queue->chunk_status;
+		if (!queue->status) {
+			chunk_advance(queue);
+			if (chunk_start(queue)) {
+				return;
+			}
+		}
+
+		trans_finish(queue);
+	}
+
+	while (1) {
+		struct spi_transaction *trans;
+
+		key = irq_lock();
+		node = sys_slist_get(&queue->pending);
+		irq_unlock(key);
+
+		if (!node) {
+			return;
+		}
+
+		trans = CONTAINER_OF(node, struct spi_transaction, node);
+
+		queue->current = trans;
+		queue->tx = trans->tx_bufs;
+		queue->tx_count = trans->tx_count;
+		queue->tx_off = 0;
+		queue->rx = trans->rx_bufs;
+		queue->rx_count = trans->rx_count;
+		queue->rx_off = 0;
+
+		queue->status = queue->ops->begin(queue->dev, trans);
+		if (!queue->status && chunk_start(queue)) {
+			return;
+		}
+
+		trans_finish(queue);
+	}
+}
+
+void spi_async_queue_init(struct spi_async_queue *queue, struct device *dev,
+			  const struct spi_async_ops *ops, uint32_t chunk_max)
+{
+	queue->dev = dev;
+	queue->ops = ops;
+	queue->chunk_max = chunk_max;
+	queue->current = NULL;
+	atomic_set(&queue->done, 0);
+	sys_slist_init(&queue->pending);
+	k_work_init(&queue->work, spi_async_work);
+}
+
+int spi_async_submit(struct spi_async_queue *queue,
+		     struct spi_transaction *trans)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	sys_slist_append(&queue->pending, &trans->node);
+	irq_unlock(key);
+
+	k_work_submit_to_queue(&spi_async_work_q, &queue->work);
+
+	return 0;
+}
+
+void spi_async_chunk_done(struct spi_async_queue *queue, int status)
+{
+	queue->chunk_status = status;
+	atomic_set(&queue->done, 1);
+
+	k_work_submit_to_queue(&spi_async_work_q, &queue->work);
+}
+
+struct spi_sync {
+	struct spi_transaction trans;
+	struct k_sem sem;
+	int status;
+};
+
+static void spi_sync_done(struct device *dev, int status, void *user_data)
+{
+	struct spi_sync *sync = user_data;
+
+	sync->status = status;
+	k_sem_give(&sync->sem);
+}
+
+int spi_transceive_bufs(struct device *dev, struct spi_transaction *trans)
+{
+	const struct spi_driver_api *api = dev->driver_api;
+	struct spi_sync sync;
+	int err;
+
+	/* Without a queue, only one buffer each way can be transferred */
+	if (!api->transceive_async && trans->tx_count <= 1 &&
+	    trans->rx_count <= 1) {
+		if (trans->config) {
+			err = spi_configure(dev, trans->config);
+			if (err) {
+				return err;
+			}
+		}
+
+		if (trans->slave) {
+			err = spi_slave_select(dev, trans->slave);
+			if (err) {
+				return err;
+			}
+		}
+
+		return spi_transceive(dev,
+				trans->tx_count ? trans->tx_bufs->buf : NULL,
+				trans->tx_count ? trans->tx_bufs->len : 0,
+				trans->rx_count ? trans->rx_bufs->buf : NULL,
+				trans->rx_count ? trans->rx_bufs->len : 0);
+	}
+
+	/* Queued as a copy, the callback of the caller is left untouched */
+	sync.trans = *trans;
+	sync.trans.cb = spi_sync_done;
+	sync.trans.user_data = &sync;
+	k_sem_init(&sync.sem, 0, 1);
+
+	err = spi_transceive_async(dev, &sync.trans);
+	if (err) {
+		return err;
+	}
+
+	k_sem_take(&sync.sem, K_FOREVER);
+
+	return sync.status;
+}
+
+static int spi_async_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_work_q_start(&spi_async_work_q, spi_async_stack,
+		       sizeof(spi_async_stack), CONFIG_SPI_ASYNC_PRIORITY);
+
+	return 0;
+}
+
+SYS_INIT(spi_async_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __SPI_ASYNC_H__
+#define __SPI_ASYNC_H__
+
+#include <kernel.h>
+#include <spi.h>
+
+/*
+ * Transaction queue of an SPI bus, shared by the drivers implementing
+ * spi_transceive_async(). The queue splits the scatter-gather buffers of
+ * each transaction into chunks, each of them going to a single TX and a
+ * single RX buffer, and calls the driver to transfer them one by one.
+ */
+struct spi_async_ops {
+	/* Apply the configuration and slave, and assert the chip select */
+	int (*begin)(struct device *dev, struct spi_transaction *trans);
+	/* Start transferring len bytes, tx_buf or rx_buf may be NULL. The
+	 * driver calls spi_async_chunk_done() once it is done.
+	 */
+	int (*chunk)(struct device *dev, const void *tx_buf, void *rx_buf,
+		     uint32_t len);
+	/* Release the chip select */
+	void (*end)(struct device *dev, struct spi_transaction *trans);
+};
+
+struct spi_async_queue {
+	struct device *dev;
+	const struct spi_async_ops *ops;
+	uint32_t chunk_max;
+	sys_slist_t pending;
+	struct spi_transaction *current;
+	struct k_work work;
+	atomic_t done;
+	int chunk_status;
+	int status;
+	const struct spi_buf *tx;
+	const struct spi_buf *rx;
+	uint32_t tx_count;
+	uint32_t rx_count;
+	uint32_t tx_off;
+	uint32_t rx_off;
+	uint32_t len;
+};
+
+void spi_async_queue_init(struct spi_async_queue *queue, struct device *dev,
+			  const struct spi_async_ops *ops, uint32_t chunk_max);
+
+int spi_async_submit(struct spi_async_queue *queue,
+		     struct spi_transaction *trans);
+
+/* Can be called from an ISR */
+void spi_async_chunk_done(struct spi_async_queue *queue, int status);
+
+#endif /* __SPI_ASYNC_H__ */
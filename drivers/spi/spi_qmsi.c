@@ -19,26 +19,34 @@
 #include "qm_isr.h"
 #include "soc.h"
 
-struct pending_transfer {
-	struct device *dev;
-	qm_spi_async_transfer_t xfer;
-};
+#include "spi_async.h"
 
-static struct pending_transfer pending_transfers[QM_SPI_NUM];
+/* Longest chunk, in bytes, a multiple of all the frame sizes fitting in
+ * the 16 bit frame count of a QMSI transfer.
+ */
+#define SPI_QMSI_CHUNK_MAX	0xfffc
 
 struct spi_qmsi_config {
 	qm_spi_t spi;
 	char *cs_port;
 	uint32_t cs_pin;
+#ifdef CONFIG_SPI_QMSI_DMA
+	qm_dma_channel_id_t dma_tx;
+	qm_dma_channel_id_t dma_rx;
+#endif
 };
 
 struct spi_qmsi_runtime {
 	struct device *gpio_cs;
-	struct k_sem device_sync_sem;
+	struct spi_async_queue queue;
+	/* Set by spi_configure() and spi_slave_select() */
 	qm_spi_config_t cfg;
-	int rc;
 	bool loopback;
-	struct k_sem sem;
+	uint32_t slave;
+	/* Of the transaction being run */
+	qm_spi_config_t xfer_cfg;
+	bool xfer_loopback;
+	qm_spi_async_transfer_t xfer;
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 	uint32_t device_power_state;
 #ifdef CONFIG_SYS_POWER_DEEP_SLEEP
@@ -73,52 +81,46 @@ static void spi_control_cs(struct device *dev, bool active)
 	gpio_pin_write(gpio, config->cs_pin, !active);
 }
 
-static int spi_qmsi_configure(struct device *dev,
-				struct spi_config *config)
+static void config_to_cfg(struct spi_config *config, qm_spi_config_t *cfg,
+			  bool *loopback)
 {
-	struct spi_qmsi_runtime *context = dev->driver_data;
-	qm_spi_config_t *cfg = &context->cfg;
-
 	cfg->frame_size = SPI_WORD_SIZE_GET(config->config) - 1;
 	cfg->bus_mode = config_to_bmode(SPI_MODE(config->config));
 	/* As loopback is implemented inside the controller,
 	 * the bus mode doesn't matter.
 	 */
-	context->loopback = SPI_MODE(config->config) & SPI_MODE_LOOP;
+	*loopback = SPI_MODE(config->config) & SPI_MODE_LOOP;
 	cfg->clk_divider = config->max_sys_freq;
+}
+
+static int spi_qmsi_configure(struct device *dev,
+				struct spi_config *config)
+{
+	struct spi_qmsi_runtime *context = dev->driver_data;
 
 	/* Will set the configuration before the transfer starts */
+	config_to_cfg(config, &context->cfg, &context->loopback);
+
 	return 0;
 }
 
 static void transfer_complete(void *data, int error, qm_spi_status_t status,
 			      uint16_t len)
 {
-	const struct spi_qmsi_config *spi_config =
-			       ((struct device *)data)->config->config_info;
-	qm_spi_t spi = spi_config->spi;
-	struct pending_transfer *pending = &pending_transfers[spi];
-	struct device *dev = pending->dev;
-	struct spi_qmsi_runtime *context;
-
-	if (!dev)
-		return;
-
-	context = dev->driver_data;
-
-	spi_control_cs(dev, false);
+	struct device *dev = data;
+	struct spi_qmsi_runtime *context = dev->driver_data;
 
-	pending->dev = NULL;
-	context->rc = error;
-	k_sem_give(&context->device_sync_sem);
+	spi_async_chunk_done(&context->queue, error ? -EIO : 0);
 }
 
 static int spi_qmsi_slave_select(struct device *dev, uint32_t slave)
 {
-	const struct spi_qmsi_config *spi_config = dev->config->config_info;
-	qm_spi_t spi = spi_config->spi;
+	struct spi_qmsi_runtime *context = dev->driver_data;
+
+	/* Will select the slave before the transfer starts */
+	context->slave = slave;
 
-	return qm_spi_slave_select(spi, 1 << (slave - 1)) ? -EIO : 0;
+	return 0;
 }
 
 static inline uint8_t frame_size_to_dfs(qm_spi_frame_size_t frame_size)
@@ -134,79 +136,158 @@ static inline uint8_t frame_size_to_dfs(qm_spi_frame_size_t frame_size)
 	return 0;
 }
 
-static int spi_qmsi_transceive(struct device *dev,
-			       const void *tx_buf, uint32_t tx_buf_len,
-			       void *rx_buf, uint32_t rx_buf_len)
+static int spi_qmsi_begin(struct device *dev, struct spi_transaction *trans)
 {
 	const struct spi_qmsi_config *spi_config = dev->config->config_info;
-	qm_spi_t spi = spi_config->spi;
 	struct spi_qmsi_runtime *context = dev->driver_data;
-	qm_spi_config_t *cfg = &context->cfg;
-	uint8_t dfs = frame_size_to_dfs(cfg->frame_size);
-	qm_spi_async_transfer_t *xfer;
-	int rc;
+	uint32_t slave = trans->slave ? trans->slave : context->slave;
+
+	if (trans->config) {
+		config_to_cfg(trans->config, &context->xfer_cfg,
+			      &context->xfer_loopback);
+	} else {
+		context->xfer_cfg = context->cfg;
+		context->xfer_loopback = context->loopback;
+	}
 
-	k_sem_take(&context->sem, K_FOREVER);
-	if (pending_transfers[spi].dev) {
-		k_sem_give(&context->sem);
-		return -EBUSY;
+	if (slave && qm_spi_slave_select(spi_config->spi, 1 << (slave - 1))) {
+		return -EIO;
 	}
-	pending_transfers[spi].dev = dev;
-	k_sem_give(&context->sem);
 
 	device_busy_set(dev);
+	spi_control_cs(dev, true);
 
-	xfer = &pending_transfers[spi].xfer;
+	return 0;
+}
+
+#ifdef CONFIG_SPI_QMSI_DMA
+static int spi_qmsi_dma_transfer(struct device *dev)
+{
+	const struct spi_qmsi_config *spi_config = dev->config->config_info;
+	struct spi_qmsi_runtime *context = dev->driver_data;
+	qm_spi_async_transfer_t *xfer = &context->xfer;
+	qm_spi_t spi = spi_config->spi;
+
+	/* The channel transfer width follows the frame size just set */
+	if (xfer->tx_len &&
+	    qm_spi_dma_channel_config(spi, QM_DMA_0, spi_config->dma_tx,
+				      QM_DMA_MEMORY_TO_PERIPHERAL)) {
+		return -EIO;
+	}
+
+	if (xfer->rx_len &&
+	    qm_spi_dma_channel_config(spi, QM_DMA_0, spi_config->dma_rx,
+				      QM_DMA_PERIPHERAL_TO_MEMORY)) {
+		return -EIO;
+	}
+
+	return qm_spi_dma_transfer(spi, xfer) ? -EIO : 0;
+}
+#endif
+
+static int spi_qmsi_chunk(struct device *dev, const void *tx_buf,
+			  void *rx_buf, uint32_t len)
+{
+	const struct spi_qmsi_config *spi_config = dev->config->config_info;
+	qm_spi_t spi = spi_config->spi;
+	struct spi_qmsi_runtime *context = dev->driver_data;
+	qm_spi_config_t *cfg = &context->xfer_cfg;
+	uint8_t dfs = frame_size_to_dfs(cfg->frame_size);
+	qm_spi_async_transfer_t *xfer = &context->xfer;
+
+	if (len % dfs) {
+		return -EINVAL;
+	}
+
+	/* Without a TX buffer the controller clocks out dummy frames in RX
+	 * mode, without an RX buffer the frames received are dropped in TX
+	 * mode.
+	 */
+	if (tx_buf && rx_buf) {
+		cfg->transfer_mode = QM_SPI_TMOD_TX_RX;
+	} else if (tx_buf) {
+		cfg->transfer_mode = QM_SPI_TMOD_TX;
+	} else if (rx_buf) {
+		cfg->transfer_mode = QM_SPI_TMOD_RX;
+	} else {
+		return -EINVAL;
+	}
 
 	xfer->rx = rx_buf;
-	xfer->rx_len = rx_buf_len / dfs;
+	xfer->rx_len = rx_buf ? len / dfs : 0;
 	/* This cast is necessary to drop the "const" modifier, since QMSI xfer
 	 * does not take a const pointer.
 	 */
 	xfer->tx = (uint8_t *)tx_buf;
-	xfer->tx_len = tx_buf_len / dfs;
+	xfer->tx_len = tx_buf ? len / dfs : 0;
 	xfer->callback_data = dev;
 	xfer->callback = transfer_complete;
 
-	if (tx_buf_len == 0)
-		cfg->transfer_mode = QM_SPI_TMOD_RX;
-	else if (rx_buf_len == 0)
-		cfg->transfer_mode = QM_SPI_TMOD_TX;
-	else {
-		/* FIXME: QMSI expects rx_buf_len and tx_buf_len to
-		 * have the same size.
-		 */
-		cfg->transfer_mode = QM_SPI_TMOD_TX_RX;
+	if (qm_spi_set_config(spi, cfg)) {
+		return -EINVAL;
 	}
 
-	if (context->loopback)
+	if (context->xfer_loopback) {
 		QM_SPI[spi]->ctrlr0 |= BIT(11);
-
-	rc = qm_spi_set_config(spi, cfg);
-	if (rc != 0) {
-		device_busy_clear(dev);
-		return -EINVAL;
 	}
 
-	spi_control_cs(dev, true);
-
-	rc = qm_spi_irq_transfer(spi, xfer);
-	if (rc != 0) {
-		spi_control_cs(dev, false);
-		device_busy_clear(dev);
-		return -EIO;
+#ifdef CONFIG_SPI_QMSI_DMA
+	if (len >= CONFIG_SPI_QMSI_DMA_THRESHOLD) {
+		return spi_qmsi_dma_transfer(dev);
 	}
-	k_sem_take(&context->device_sync_sem, K_FOREVER);
+#endif
 
+	return qm_spi_irq_transfer(spi, xfer) ? -EIO : 0;
+}
+
+static void spi_qmsi_end(struct device *dev, struct spi_transaction *trans)
+{
+	spi_control_cs(dev, false);
 	device_busy_clear(dev);
+}
+
+static const struct spi_async_ops spi_qmsi_async_ops = {
+	.begin = spi_qmsi_begin,
+	.chunk = spi_qmsi_chunk,
+	.end = spi_qmsi_end,
+};
+
+static int spi_qmsi_transceive_async(struct device *dev,
+				     struct spi_transaction *trans)
+{
+	struct spi_qmsi_runtime *context = dev->driver_data;
+
+	return spi_async_submit(&context->queue, trans);
+}
 
-	return context->rc ? -EIO : 0;
+static int spi_qmsi_transceive(struct device *dev,
+			       const void *tx_buf, uint32_t tx_buf_len,
+			       void *rx_buf, uint32_t rx_buf_len)
+{
+	struct spi_buf tx = {
+		.buf = (void *)tx_buf,
+		.len = tx_buf_len,
+	};
+	struct spi_buf rx = {
+		.buf = rx_buf,
+		.len = rx_buf_len,
+	};
+	struct spi_transaction trans = {
+		.tx_bufs = &tx,
+		.tx_count = tx_buf_len ? 1 : 0,
+		.rx_bufs = &rx,
+		.rx_count = rx_buf_len ? 1 : 0,
+	};
+
+	/* Going through the queue, after the transactions already in it */
+	return spi_transceive_bufs(dev, &trans) ? -EIO : 0;
 }
 
 static const struct spi_driver_api spi_qmsi_api = {
 	.configure = spi_qmsi_configure,
 	.slave_select = spi_qmsi_slave_select,
 	.transceive = spi_qmsi_transceive,
+	.transceive_async = spi_qmsi_transceive_async,
 };
 
 static struct device *gpio_cs_init(const struct spi_qmsi_config *config)
@@ -282,9 +363,8 @@ static int spi_qmsi_init(struct device *dev)
 
 	context->gpio_cs = gpio_cs_init(spi_config);
 
-	k_sem_init(&context->device_sync_sem, 0, UINT_MAX);
-	k_sem_init(&context->sem, 0, UINT_MAX);
-	k_sem_give(&context->sem);
+	spi_async_queue_init(&context->queue, dev, &spi_qmsi_async_ops,
+			     SPI_QMSI_CHUNK_MAX);
 
 	spi_master_set_power_state(dev, DEVICE_PM_ACTIVE_STATE);
 
@@ -353,6 +433,10 @@ static const struct spi_qmsi_config spi_qmsi_mst_0_config = {
 	.cs_port = CONFIG_SPI_0_CS_GPIO_PORT,
 	.cs_pin = CONFIG_SPI_0_CS_GPIO_PIN,
 #endif
+#ifdef CONFIG_SPI_QMSI_DMA
+	.dma_tx = CONFIG_SPI_0_DMA_TX_CHANNEL,
+	.dma_rx = CONFIG_SPI_0_DMA_RX_CHANNEL,
+#endif
 };
 
 static struct spi_qmsi_runtime spi_qmsi_mst_0_runtime;
@@ -370,6 +454,10 @@ static const struct spi_qmsi_config spi_qmsi_mst_1_config = {
 	.cs_port = CONFIG_SPI_1_CS_GPIO_PORT,
 	.cs_pin = CONFIG_SPI_1_CS_GPIO_PIN,
 #endif
+#ifdef CONFIG_SPI_QMSI_DMA
+	.dma_tx = CONFIG_SPI_1_DMA_TX_CHANNEL,
+	.dma_rx = CONFIG_SPI_1_DMA_RX_CHANNEL,
+#endif
 };
 
 static struct spi_qmsi_runtime spi_qmsi_mst_1_runtime;
@@ -66,7 +66,7 @@
 
 /* running total of timer count */
 static uint32_t __noinit cycles_per_tick;
-static uint32_t accumulated_cycle_count;
+static uint64_t accumulated_cycle_count;
 
 #ifdef CONFIG_TICKLESS_IDLE
 static uint32_t __noinit max_system_ticks;
@@ -160,6 +160,104 @@ static ALWAYS_INLINE void update_accumulated_count(void)
 }
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#if defined(CONFIG_TICKLESS_KERNEL)
+/*
+ * In tickless kernel mode, a count of zero corresponds to the last announced
+ * tick, and the limit is always programmed so that the counter wraps around
+ * on a tick boundary: the count then stays relative to the last announced
+ * tick once the ticks elapsed until the wrap-around have been announced.
+ */
+
+/**
+ *
+ * @brief Get the number of cycles elapsed since the last announced tick
+ *
+ * Must be called with interrupts locked.
+ *
+ * @return number of cycles
+ */
+static uint32_t elapsed_cycles_get(void)
+{
+	uint32_t count = timer0_count_register_get();
+
+	if (timer0_control_register_get() & _ARC_V2_TMR_CTRL_IP) {
+		/* the limit has been reached: read the count after wrapping */
+		count = timer0_count_register_get();
+		return timer0_limit_register_get() + 1 + count;
+	}
+
+	return count;
+}
+
+/**
+ *
+ * @brief Program the timer for the next kernel event
+ *
+ * Program the limit so that the counter wraps around 'time' ticks after the
+ * last announced tick, or after the maximum number of ticks that can be
+ * programmed if 'time' is 0 or larger. If that is not in the future anymore,
+ * the counter wraps around on the next tick boundary.
+ *
+ * @return N/A
+ */
+void _set_time(uint32_t time)
+{
+	uint32_t count = timer0_count_register_get();
+
+	if (!time || time > (max_system_ticks - 1)) {
+		time = max_system_ticks - 1;
+	}
+
+	/* allow for the time it takes to program the limit */
+	if (time * cycles_per_tick <= count + 16) {
+		time = ((count + 16) / cycles_per_tick) + 1;
+	}
+
+	programmed_ticks = time;
+	programmed_limit = (time * cycles_per_tick) - 1;
+
+	timer0_limit_register_set(programmed_limit);
+}
+
+uint32_t _get_elapsed_program_time(void)
+{
+	return elapsed_cycles_get() / cycles_per_tick;
+}
+
+/**
+ *
+ * @brief System clock tick handler
+ *
+ * This routine handles the system clock interrupt, announcing all the ticks
+ * elapsed since the last announced tick.
+ *
+ * @return N/A
+ */
+void _timer_int_handler(void *unused)
+{
+	uint32_t cycles, count;
+
+	ARG_UNUSED(unused);
+
+	cycles = elapsed_cycles_get();
+	count = timer0_count_register_get();
+
+	/* clear the interrupt by writing 0 to IP bit of the control register */
+	timer0_control_register_set(_ARC_V2_TMR_CTRL_NH | _ARC_V2_TMR_CTRL_IE);
+
+	_sys_idle_elapsed_ticks = cycles / cycles_per_tick;
+
+	/* keep the count relative to the tick about to be announced */
+	if (count != cycles % cycles_per_tick) {
+		timer0_count_register_set(cycles % cycles_per_tick);
+	}
+
+	update_accumulated_count();
+
+	/* the kernel reprograms the timer for its next event */
+	_sys_clock_tick_announce();
+}
+#else
 /**
  *
  * @brief System clock periodic tick handler
@@ -190,6 +288,7 @@ void _timer_int_handler(void *unused)
 
 	update_accumulated_count();
 }
+#endif /* CONFIG_TICKLESS_KERNEL */
 
 #if defined(CONFIG_TICKLESS_IDLE)
 /*
@@ -350,7 +449,12 @@ int _sys_clock_driver_init(struct device *device)
 
 	tickless_idle_init();
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* nothing is scheduled yet: only keep track of time */
+	_set_time(0);
+#else
 	timer0_limit_register_set(cycles_per_tick - 1);
+#endif
 	timer0_control_register_set(_ARC_V2_TMR_CTRL_NH | _ARC_V2_TMR_CTRL_IE);
 
 	/* everything has been configured: safe to enable the interrupt */
@@ -415,7 +519,19 @@ int sys_clock_device_ctrl(struct device *port, uint32_t ctrl_command,
 
 uint32_t k_cycle_get_32(void)
 {
-	return (accumulated_cycle_count + timer0_count_register_get());
+	return ((uint32_t)accumulated_cycle_count +
+		timer0_count_register_get());
+}
+
+uint64_t k_cycle_get_64(void)
+{
+	/* the accumulated count takes two loads */
+	unsigned int key = irq_lock();
+	uint64_t val = accumulated_cycle_count + timer0_count_register_get();
+
+	irq_unlock(key);
+
+	return val;
 }
 
 #if defined(CONFIG_SYSTEM_CLOCK_DISABLE)
@@ -27,8 +27,8 @@
 #include <drivers/system_timer.h>
 #include <arch/arm/cortex_m/cmsis.h>
 
-/* running total of timer count */
-static uint32_t clock_accumulated_count;
+/* running total of timer count, 64-bit for k_cycle_get_64() */
+static uint64_t clock_accumulated_count;
 
 /*
  * A board support package's board.h header must provide definitions for the
@@ -175,6 +175,74 @@ static ALWAYS_INLINE void sysTickReloadSet(
 	SysTick->VAL = 0; /* also clears the countflag */
 }
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/* cycle count at the last announced tick */
+static uint32_t announced_count;
+
+/**
+ *
+ * @brief Get the current cycle count
+ *
+ * Accounts for a wrap-around of the counter that the interrupt handler has
+ * not processed yet.
+ *
+ * Must be called with interrupts locked.
+ *
+ * @return cycle count
+ */
+static uint64_t current_count_get(void)
+{
+	uint32_t load = SysTick->LOAD;
+	uint64_t count = clock_accumulated_count;
+	uint32_t val = SysTick->VAL;
+
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+		/* the counter has wrapped around: read it again */
+		val = SysTick->VAL;
+		count += load + 1;
+	}
+
+	return count + (load - val);
+}
+
+/**
+ *
+ * @brief Program the timer for the next kernel event
+ *
+ * Restart the counter so that it wraps around 'time' ticks after the last
+ * announced tick, or after the maximum number of ticks that can be
+ * programmed if 'time' is 0 or larger.
+ *
+ * @return N/A
+ */
+void _set_time(uint32_t time)
+{
+	uint64_t now = current_count_get();
+	uint32_t elapsed = (uint32_t)now - announced_count;
+	uint32_t cycles;
+
+	if (!time || time > max_system_ticks) {
+		cycles = max_load_value;
+	} else {
+		cycles = time * sys_clock_hw_cycles_per_tick;
+	}
+
+	/* the counter must count at least down from 1 to raise the interrupt */
+	cycles = (cycles > elapsed + 1) ? cycles - elapsed : 2;
+
+	/* any pending wrap-around has been accounted for in 'now' */
+	sysTickReloadSet(cycles - 1);
+	SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+	clock_accumulated_count = now;
+}
+
+uint32_t _get_elapsed_program_time(void)
+{
+	return ((uint32_t)current_count_get() - announced_count) /
+	       sys_clock_hw_cycles_per_tick;
+}
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 /**
  *
  * @brief System clock tick handler
@@ -211,7 +279,20 @@ void _timer_int_handler(void *unused)
 	 */
 	__asm__(" cpsid i"); /* PRIMASK = 1 */
 
-#ifdef CONFIG_TICKLESS_IDLE
+#if defined(CONFIG_TICKLESS_KERNEL)
+	/* the counter has wrapped around once, at the end of its period */
+	clock_accumulated_count += SysTick->LOAD + 1;
+
+	/* announce all the ticks elapsed since the last announced tick */
+	_sys_idle_elapsed_ticks = ((uint32_t)current_count_get() -
+				   announced_count) /
+				  sys_clock_hw_cycles_per_tick;
+	announced_count += _sys_idle_elapsed_ticks *
+			   sys_clock_hw_cycles_per_tick;
+
+	/* the kernel reprograms the timer for its next event */
+	_sys_clock_tick_announce();
+#elif defined(CONFIG_TICKLESS_IDLE)
 	/*
 	 * If this a wakeup from a completed tickless idle or after
 	 *  _timer_idle_exit has processed a partial idle, return
@@ -537,6 +618,11 @@ int _sys_clock_driver_init(struct device *device)
 
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* nothing is scheduled yet: only keep track of time */
+	sysTickReloadSet(max_load_value - 1);
+#endif
+
 	_ScbExcPrioSet(_EXC_SYSTICK, _EXC_IRQ_DEFAULT_PRIO);
 
 	SysTick->CTRL = ctrl;
@@ -559,7 +645,33 @@ int _sys_clock_driver_init(struct device *device)
  */
 uint32_t k_cycle_get_32(void)
 {
-	return clock_accumulated_count + (SysTick->LOAD - SysTick->VAL);
+	return (uint32_t)clock_accumulated_count +
+	       (SysTick->LOAD - SysTick->VAL);
+}
+
+/**
+ *
+ * @brief Read the platform's timer hardware, 64-bit version
+ *
+ * The accumulated count is read with interrupts locked, since it takes two
+ * loads.
+ *
+ * @return up counter of elapsed clock cycles
+ */
+uint64_t k_cycle_get_64(void)
+{
+	unsigned int key = irq_lock();
+	uint64_t count;
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	count = current_count_get();
+#else
+	count = clock_accumulated_count + (SysTick->LOAD - SysTick->VAL);
+#endif
+
+	irq_unlock(key);
+
+	return count;
 }
 
 #ifdef CONFIG_SYSTEM_CLOCK_DISABLE
@@ -173,21 +173,6 @@ extern uint32_t _hw_irq_to_c_handler_latency;
 #define DBG(...)
 #endif
 
-#ifdef CONFIG_TICKLESS_IDLE
-
-/* additional globals, locals, and forward declarations */
-
-extern int32_t _sys_idle_elapsed_ticks;
-
-/* main counter units per system tick */
-static uint32_t __noinit counter_load_value;
-/* counter value for most recent tick */
-static uint64_t counter_last_value;
-/* # ticks timer is programmed for */
-static int32_t programmed_ticks = 1;
-/* is stale interrupt possible? */
-static int stale_irq_check;
-
 /**
  *
  * @brief Safely read the main HPET up counter
@@ -212,6 +197,21 @@ static uint64_t _hpetMainCounterAtomic(void)
 	return ((uint64_t)highBits << 32) | lowBits;
 }
 
+#ifdef CONFIG_TICKLESS_IDLE
+
+/* additional globals, locals, and forward declarations */
+
+extern int32_t _sys_idle_elapsed_ticks;
+
+/* main counter units per system tick */
+static uint32_t __noinit counter_load_value;
+/* counter value for most recent tick */
+static uint64_t counter_last_value;
+/* # ticks timer is programmed for */
+static int32_t programmed_ticks = 1;
+/* is stale interrupt possible? */
+static int stale_irq_check;
+
 #endif /* CONFIG_TICKLESS_IDLE */
 
 /**
@@ -244,7 +244,27 @@ void _timer_int_handler(void *unused)
 #endif
 
 
-#ifndef CONFIG_TICKLESS_IDLE
+#if defined(CONFIG_TICKLESS_KERNEL)
+
+	uint64_t currTime = _hpetMainCounterAtomic();
+	int32_t elapsedTicks;
+
+	/* ignore interrupt triggered while timer was being reprogrammed */
+
+	if (currTime < *_HPET_TIMER0_COMPARATOR) {
+		return;
+	}
+
+	elapsedTicks =
+		(int32_t)((currTime - counter_last_value) / counter_load_value);
+	counter_last_value += (uint64_t)elapsedTicks * counter_load_value;
+
+	/* the kernel reprograms the timer for its next event */
+
+	_sys_idle_elapsed_ticks = elapsedTicks;
+	_sys_clock_tick_announce();
+
+#elif !defined(CONFIG_TICKLESS_IDLE)
 
 	/*
 	 * one more tick has occurred -- don't need to do anything special since
@@ -421,6 +441,56 @@ void _timer_idle_exit(void)
 
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+
+/**
+ *
+ * @brief Program the timer for the next kernel event
+ *
+ * Program timer0 to expire 'time' ticks after the last announced tick, or
+ * never if 'time' is 0. A deadline too close to the current time, or already
+ * past, is pushed forward so that the HPET does not miss it.
+ *
+ * @return N/A
+ *
+ * \INTERNAL IMPLEMENTATION DETAILS
+ * Called while interrupts are locked.
+ */
+
+void _set_time(uint32_t time)
+{
+	uint64_t counterNextValue;
+	uint64_t currTime;
+
+	counterNextValue = time ?
+		counter_last_value + (uint64_t)time * counter_load_value :
+		~(uint64_t)0;
+
+	currTime = _hpetMainCounterAtomic();
+	if (counterNextValue < currTime + HPET_COMP_DELAY) {
+		counterNextValue = currTime + HPET_COMP_DELAY;
+	}
+
+	*_HPET_TIMER0_CONFIG_CAPS |= HPET_Tn_VAL_SET_CNF;
+	*_HPET_TIMER0_COMPARATOR = counterNextValue;
+	programmed_ticks = time;
+}
+
+/**
+ *
+ * @brief Get the number of ticks elapsed since the last announced tick
+ *
+ * @return number of whole ticks
+ */
+
+uint32_t _get_elapsed_program_time(void)
+{
+	return (uint32_t)((_hpetMainCounterAtomic() - counter_last_value) /
+			  counter_load_value);
+}
+
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 /**
  *
  * @brief Initialize and enable the system clock
@@ -491,6 +561,8 @@ int _sys_clock_driver_init(struct device *device)
 	sys_clock_hw_cycles_per_tick = counter_load_value;
 	sys_clock_hw_cycles_per_sec = sys_clock_hw_cycles_per_tick *
 									sys_clock_ticks_per_sec;
+	_sys_clock_ns_per_cycle_q32 = ((uint64_t)NSEC_PER_SEC << 32) /
+				      sys_clock_hw_cycles_per_sec;
 
 
 #ifdef CONFIG_INT_LATENCY_BENCHMARK
@@ -587,10 +659,6 @@ int _sys_clock_driver_init(struct device *device)
  * cycles.
  *
  * @return up counter of elapsed clock cycles
- *
- * \INTERNAL WARNING
- * If this routine is ever enhanced to return all 64 bits of the counter
- * it will need to call _hpetMainCounterAtomic().
  */
 
 uint32_t k_cycle_get_32(void)
@@ -598,6 +666,19 @@ uint32_t k_cycle_get_32(void)
 	return (uint32_t) *_HPET_MAIN_COUNTER_VALUE;
 }
 
+/**
+ *
+ * @brief Read the platform's timer hardware, 64-bit version
+ *
+ * The main counter is 64-bit wide and never wraps around in practice.
+ *
+ * @return up counter of elapsed clock cycles
+ */
+uint64_t k_cycle_get_64(void)
+{
+	return _hpetMainCounterAtomic();
+}
+
 #ifdef CONFIG_SYSTEM_CLOCK_DISABLE
 
 /**
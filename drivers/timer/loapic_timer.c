@@ -129,7 +129,8 @@ extern int32_t _sys_idle_elapsed_ticks;
 
 /* computed counter 0 initial count value */
 static uint32_t __noinit cycles_per_tick;
-static uint32_t accumulated_cycle_count;
+/* 64-bit for k_cycle_get_64() */
+static uint64_t accumulated_cycle_count;
 
 #if defined(CONFIG_TICKLESS_IDLE)
 static uint32_t programmed_cycles;
@@ -239,6 +240,86 @@ static inline uint32_t initial_count_register_get(void)
 }
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#if defined(CONFIG_TICKLESS_KERNEL)
+/* cycle count at the last announced tick */
+static uint32_t announced_cycle_count;
+
+/**
+ *
+ * @brief Get the current cycle count
+ *
+ * The down counter stops when it reaches zero in one-shot mode, so this is
+ * only accurate until the programmed event occurs: the interrupt latency is
+ * lost when the timer is reprogrammed from the interrupt handler.
+ *
+ * Must be called with interrupts locked.
+ *
+ * @return cycle count
+ */
+static uint64_t current_cycle_count_get(void)
+{
+	uint32_t icr = initial_count_register_get();
+	uint32_t ccr = current_count_register_get();
+
+	/* some targets keep decrementing past zero in one-shot mode */
+	if (ccr > icr) {
+		ccr = 0;
+	}
+
+	return accumulated_cycle_count + icr - ccr;
+}
+
+/**
+ *
+ * @brief Program the timer for the next kernel event
+ *
+ * Program the down counter in one-shot mode to elapse 'time' ticks after the
+ * last announced tick, or after the maximum number of ticks that can be
+ * programmed if 'time' is 0 or larger.
+ *
+ * @return N/A
+ */
+void _set_time(uint32_t time)
+{
+	uint64_t now = current_cycle_count_get();
+	uint32_t elapsed = (uint32_t)now - announced_cycle_count;
+	uint32_t cycles;
+
+	if (!time || time > max_system_ticks) {
+		cycles = cycles_per_max_ticks;
+	} else {
+		cycles = time * cycles_per_tick;
+	}
+
+	/* never program zero, which stops the timer */
+	cycles = (cycles > elapsed) ? cycles - elapsed : 1;
+
+	accumulated_cycle_count = now;
+	initial_count_register_set(cycles);
+}
+
+uint32_t _get_elapsed_program_time(void)
+{
+	return ((uint32_t)current_cycle_count_get() - announced_cycle_count) /
+	       cycles_per_tick;
+}
+
+void _timer_int_handler(void *unused /* parameter is not used */
+				 )
+{
+	uint32_t elapsed_ticks;
+
+	ARG_UNUSED(unused);
+
+	elapsed_ticks = ((uint32_t)current_cycle_count_get() -
+			 announced_cycle_count) / cycles_per_tick;
+	announced_cycle_count += elapsed_ticks * cycles_per_tick;
+
+	/* the kernel reprograms the timer for its next event */
+	_sys_idle_elapsed_ticks = elapsed_ticks;
+	_sys_clock_tick_announce();
+}
+#else
 void _timer_int_handler(void *unused /* parameter is not used */
 				 )
 {
@@ -288,6 +369,7 @@ void _timer_int_handler(void *unused /* parameter is not used */
 #endif /*CONFIG_TICKLESS_IDLE*/
 
 }
+#endif /* CONFIG_TICKLESS_KERNEL */
 
 #if defined(CONFIG_TICKLESS_IDLE)
 /**
@@ -488,8 +570,15 @@ int _sys_clock_driver_init(struct device *device)
 #ifndef CONFIG_MVIC
 	divide_configuration_register_set();
 #endif
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* nothing is scheduled yet: only keep track of time */
+	initial_count_register_set(cycles_per_max_ticks);
+	one_shot_mode_set();
+	timer_mode = TIMER_MODE_ONE_SHOT;
+#else
 	initial_count_register_set(cycles_per_tick - 1);
 	periodic_mode_set();
+#endif
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 	loapic_timer_device_power_state = DEVICE_PM_ACTIVE_STATE;
 #endif
@@ -601,14 +690,41 @@ uint32_t k_cycle_get_32(void)
 
 #if !defined(CONFIG_TICKLESS_IDLE)
 	/* The value in the ICR always matches cycles_per_tick. */
-	val = accumulated_cycle_count - current_count_register_get() +
-			cycles_per_tick;
+	val = (uint32_t)accumulated_cycle_count -
+	      current_count_register_get() + cycles_per_tick;
 #else
 	/* The value in the ICR may vary.  Read from the register. */
+	val = (uint32_t)accumulated_cycle_count -
+	      current_count_register_get() + initial_count_register_get();
+#endif
+
+	return val;
+}
+
+/**
+ *
+ * @brief Read the platform's timer hardware, 64-bit version
+ *
+ * Same as k_cycle_get_32(), with the accumulated count read with interrupts
+ * locked since it takes two loads.
+ *
+ * @return up counter of elapsed clock cycles
+ */
+uint64_t k_cycle_get_64(void)
+{
+	unsigned int key = irq_lock();
+	uint64_t val;
+
+#if !defined(CONFIG_TICKLESS_IDLE)
+	val = accumulated_cycle_count - current_count_register_get() +
+	      cycles_per_tick;
+#else
 	val = accumulated_cycle_count - current_count_register_get() +
 	      initial_count_register_get();
 #endif
 
+	irq_unlock(key);
+
 	return val;
 }
 
@@ -89,6 +89,65 @@ void _timer_idle_exit(void)
 }
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * In tickless kernel mode, rtc_clock_tick_count is the RTC counter value at
+ * the last announced tick, and the compare event is never programmed further
+ * than MAX_PROGRAM_TICKS from it, so that the number of RTC ticks elapsed
+ * since the last announced tick always fits in the 24-bit counter.
+ */
+#define MAX_PROGRAM_TICKS ((0x00FFFFFF / RTC_TICKS) - 1)
+
+static inline uint32_t rtc_elapsed_get(void)
+{
+	return (NRF_RTC1->COUNTER - rtc_clock_tick_count) & 0x00FFFFFF;
+}
+
+void _set_time(uint32_t time)
+{
+	uint32_t rtc_ticks;
+
+	if (!time || time > MAX_PROGRAM_TICKS) {
+		time = MAX_PROGRAM_TICKS;
+	}
+
+	rtc_ticks = time * RTC_TICKS;
+
+	NRF_RTC1->CC[0] = (rtc_clock_tick_count + rtc_ticks) & 0x00FFFFFF;
+
+	/*
+	 * The compare event is not generated if the counter is within two
+	 * RTC ticks of, or past, the compare value: signal the event from
+	 * software. The ISR always reads the elapsed time from the counter.
+	 */
+	if (rtc_elapsed_get() + 3 > rtc_ticks) {
+		NVIC_SetPendingIRQ(NRF5_IRQ_RTC1_IRQn);
+	}
+}
+
+uint32_t _get_elapsed_program_time(void)
+{
+	return rtc_elapsed_get() / RTC_TICKS;
+}
+
+static void rtc1_nrf5_isr(void *arg)
+{
+	uint32_t elapsed_ticks;
+
+	ARG_UNUSED(arg);
+
+	NRF_RTC1->EVENTS_COMPARE[0] = 0;
+
+	elapsed_ticks = rtc_elapsed_get() / RTC_TICKS;
+
+	rtc_clock_tick_count += elapsed_ticks * RTC_TICKS;
+	rtc_clock_tick_count &= 0x00FFFFFF;
+
+	/* the kernel reprograms the compare event for its next event */
+	_sys_idle_elapsed_ticks = elapsed_ticks;
+	_sys_clock_tick_announce();
+}
+#else
 static void rtc1_nrf5_isr(void *arg)
 {
 #ifdef CONFIG_TICKLESS_IDLE
@@ -135,6 +194,7 @@ static void rtc1_nrf5_isr(void *arg)
 		_sys_clock_tick_announce();
 	}
 }
+#endif /* CONFIG_TICKLESS_KERNEL */
 
 int _sys_clock_driver_init(struct device *device)
 {
@@ -151,7 +211,12 @@ int _sys_clock_driver_init(struct device *device)
 
 	/* TODO: replace with counter driver to access RTC */
 	NRF_RTC1->PRESCALER = 0;
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* nothing is scheduled yet: only keep track of time */
+	NRF_RTC1->CC[0] = MAX_PROGRAM_TICKS * RTC_TICKS;
+#else
 	NRF_RTC1->CC[0] = RTC_TICKS;
+#endif
 	NRF_RTC1->EVTENSET = RTC_EVTENSET_COMPARE0_Msk;
 	NRF_RTC1->INTENSET = RTC_INTENSET_COMPARE0_Msk;
 
@@ -174,6 +239,25 @@ uint32_t k_cycle_get_32(void)
 	       elapsed_cycles;
 }
 
+uint64_t k_cycle_get_64(void)
+{
+	unsigned int key;
+	uint32_t elapsed_cycles;
+	uint64_t val;
+
+	/* the RTC is only 24-bit wide: extend it with the tick count */
+	key = irq_lock();
+
+	elapsed_cycles = (NRF_RTC1->COUNTER -
+			  (_sys_clock_tick_count * RTC_TICKS)) & 0x00FFFFFF;
+	val = (_sys_clock_tick_count * sys_clock_hw_cycles_per_tick) +
+	      elapsed_cycles;
+
+	irq_unlock(key);
+
+	return val;
+}
+
 #ifdef CONFIG_SYSTEM_CLOCK_DISABLE
 /**
  *
@@ -23,14 +23,7 @@ static volatile riscv_qemu_timer_t *timer =
 static uint32_t accumulated_cycle_count;
 static uint64_t last_rtc_value;
 
-/*
- * riscv-qemu timer is a one shot timer that needs to be rearm upon
- * every interrupt. Timer clock is a 64-bits ART.
- * To arm timer, we need to read the RTC value and update the
- * timer compare register by the RTC value + time interval we want timer
- * to interrupt.
- */
-static ALWAYS_INLINE void riscv_qemu_rearm_timer(void)
+static ALWAYS_INLINE uint64_t riscv_qemu_read_rtc(void)
 {
 	uint64_t rtc;
 
@@ -43,6 +36,22 @@ static ALWAYS_INLINE void riscv_qemu_rearm_timer(void)
 	 */
 	rtc = timer->val_low;
 	rtc |= ((uint64_t)timer->val_high << 32);
+
+	return rtc;
+}
+
+/*
+ * riscv-qemu timer is a one shot timer that needs to be rearm upon
+ * every interrupt. Timer clock is a 64-bits ART.
+ * To arm timer, we need to read the RTC value and update the
+ * timer compare register by the RTC value + time interval we want timer
+ * to interrupt.
+ */
+static ALWAYS_INLINE void riscv_qemu_rearm_timer(void)
+{
+	uint64_t rtc;
+
+	rtc = riscv_qemu_read_rtc();
 	last_rtc_value = rtc;
 
 	/*
@@ -54,6 +63,61 @@ static ALWAYS_INLINE void riscv_qemu_rearm_timer(void)
 	timer->cmp_high = (uint32_t)((rtc >> 32) & 0xffffffff);
 }
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * In tickless kernel mode, last_rtc_value is the RTC value at the last
+ * announced tick, and the compare register is never programmed further than
+ * max_program_ticks from it, so that the number of cycles elapsed since the
+ * last announced tick always fits in 32 bits.
+ */
+static uint32_t max_program_ticks;
+
+static ALWAYS_INLINE uint32_t riscv_qemu_elapsed_cycles(void)
+{
+	return (uint32_t)(riscv_qemu_read_rtc() - last_rtc_value);
+}
+
+void _set_time(uint32_t time)
+{
+	uint64_t cmp;
+
+	if (!time || time > max_program_ticks) {
+		time = max_program_ticks;
+	}
+
+	cmp = last_rtc_value + (uint64_t)time * sys_clock_hw_cycles_per_tick;
+
+	/*
+	 * Make sure the intermediate compare value is never in the past: an
+	 * interrupt is raised as soon as the RTC reaches the compare value.
+	 */
+	timer->cmp_high = 0xffffffff;
+	timer->cmp_low = (uint32_t)(cmp & 0xffffffff);
+	timer->cmp_high = (uint32_t)((cmp >> 32) & 0xffffffff);
+}
+
+uint32_t _get_elapsed_program_time(void)
+{
+	return riscv_qemu_elapsed_cycles() / sys_clock_hw_cycles_per_tick;
+}
+
+static void riscv_qemu_timer_irq_handler(void *unused)
+{
+	ARG_UNUSED(unused);
+
+	uint32_t cycles;
+
+	cycles = riscv_qemu_elapsed_cycles();
+	cycles -= cycles % sys_clock_hw_cycles_per_tick;
+
+	accumulated_cycle_count += cycles;
+	last_rtc_value += cycles;
+
+	/* the kernel reprograms the timer for its next event */
+	_sys_idle_elapsed_ticks = cycles / sys_clock_hw_cycles_per_tick;
+	_sys_clock_tick_announce();
+}
+#else
 static void riscv_qemu_timer_irq_handler(void *unused)
 {
 	ARG_UNUSED(unused);
@@ -65,8 +129,9 @@ static void riscv_qemu_timer_irq_handler(void *unused)
 	/* Rearm timer */
 	riscv_qemu_rearm_timer();
 }
+#endif /* CONFIG_TICKLESS_KERNEL */
 
-#ifdef CONFIG_TICKLESS_IDLE
+#if defined(CONFIG_TICKLESS_IDLE) && !defined(CONFIG_TICKLESS_KERNEL)
 #error "Tickless idle not yet implemented for riscv32-qemu timer"
 #endif
 
@@ -79,8 +144,16 @@ int _sys_clock_driver_init(struct device *device)
 
 	irq_enable(RISCV_QEMU_TIMER_IRQ);
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	max_program_ticks = 0x7fffffff / sys_clock_hw_cycles_per_tick;
+
+	/* nothing is scheduled yet: only keep track of time */
+	last_rtc_value = riscv_qemu_read_rtc();
+	_set_time(0);
+#else
 	/* Initialize timer, just call riscv_qemu_rearm_timer */
 	riscv_qemu_rearm_timer();
+#endif
 
 	return 0;
 }
@@ -98,9 +171,11 @@ uint32_t k_cycle_get_32(void)
 {
 	uint64_t rtc;
 
-	rtc = timer->val_low;
-	rtc |= ((uint64_t)timer->val_high << 32);
+	rtc = riscv_qemu_read_rtc();
 
-	/* rtc - last_rtc_value is always <= sys_clock_hw_cycles_per_tick */
+	/*
+	 * rtc - last_rtc_value is always <= sys_clock_hw_cycles_per_tick, or
+	 * fits in 32 bits in tickless kernel mode
+	 */
 	return accumulated_cycle_count + (uint32_t)(rtc - last_rtc_value);
 }
@@ -330,8 +330,14 @@ static int usb_dw_tx(uint8_t ep, const uint8_t *const data,
 		return -EAGAIN;
 	}
 
+	/* A short packet ends the transfer on the host side, so only send
+	 * what fits as full packets, the rest goes in a later transfer.
+	 */
 	if (data_len > avail_space) {
 		data_len = avail_space;
+		if (data_len > ep_mps) {
+			data_len -= data_len % ep_mps;
+		}
 	}
 
 	if (data_len != 0) {
@@ -78,7 +78,13 @@ Revision: $Rev: 4351 $
 **********************************************************************
 */
 
+#if defined(CONFIG_RTT_BACKEND) && defined(CONFIG_BLUETOOTH_MONITOR_RTT)
+#define SEGGER_RTT_MAX_NUM_UP_BUFFERS             (5)     // Terminal, the RTT backend channels and the Bluetooth monitor
+#elif defined(CONFIG_RTT_BACKEND)
+#define SEGGER_RTT_MAX_NUM_UP_BUFFERS             (4)     // Terminal, plus the log, trace and data channels of the RTT backend
+#else
 #define SEGGER_RTT_MAX_NUM_UP_BUFFERS             (3)     // Max. number of up-buffers (T->H) available on this target    (Default: 3)
+#endif
 #define SEGGER_RTT_MAX_NUM_DOWN_BUFFERS           (3)     // Max. number of down-buffers (H->T) available on this target  (Default: 3)
 
 #define BUFFER_SIZE_UP                            (1024)  // Size of the buffer for terminal output of target, up to host (Default: 1k)
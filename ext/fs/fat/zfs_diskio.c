@@ -25,10 +25,59 @@
 / by use of this software.
 /----------------------------------------------------------------------------*/
 
+#include <string.h>
 #include <diskio.h>	/* FatFs lower layer API */
 #include <ffconf.h>
 #include <disk_access.h>
 
+#if CONFIG_FS_FAT_READ_AHEAD > 0
+/* FatFs reads whole sectors straight into the caller buffer, only the
+ * partial ones go one by one through its window. Once these follow each
+ * other, the next sectors are read along in one go.
+ */
+static BYTE ra_buf[CONFIG_FS_FAT_READ_AHEAD * _MIN_SS];
+static DWORD ra_start;
+static UINT ra_count;
+static DWORD ra_next;
+static DWORD disk_sectors;
+
+static void ra_invalidate(DWORD sector, UINT count)
+{
+	if (sector < ra_start + ra_count && ra_start < sector + count) {
+		ra_count = 0;
+	}
+}
+
+/* Returns 1 if the sector was served from the read-ahead buffer */
+static int ra_read(BYTE *buff, DWORD sector)
+{
+	UINT count;
+
+	if (sector < ra_start || sector >= ra_start + ra_count) {
+		if (sector != ra_next || sector >= disk_sectors) {
+			return 0;
+		}
+
+		count = CONFIG_FS_FAT_READ_AHEAD;
+		if (count > disk_sectors - sector) {
+			count = disk_sectors - sector;
+		}
+
+		ra_count = 0;
+		if (disk_access_read(ra_buf, sector, count) != 0) {
+			return 0;
+		}
+
+		ra_start = sector;
+		ra_count = count;
+	}
+
+	memcpy(buff, ra_buf + (sector - ra_start) * _MIN_SS, _MIN_SS);
+
+	return 1;
+}
+#endif /* CONFIG_FS_FAT_READ_AHEAD > 0 */
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -50,9 +99,18 @@ DSTATUS disk_initialize(BYTE pdrv)
 {
 	if (disk_access_init() != 0) {
 		return STA_NOINIT;
-	} else {
-		return RES_OK;
 	}
+
+#if CONFIG_FS_FAT_READ_AHEAD > 0
+	ra_count = 0;
+	ra_next = 0;
+	if (disk_access_ioctl(DISK_IOCTL_GET_SECTOR_COUNT,
+			      &disk_sectors) != 0) {
+		disk_sectors = 0;
+	}
+#endif
+
+	return RES_OK;
 }
 
 /*-----------------------------------------------------------------------*/
@@ -61,6 +119,15 @@ DSTATUS disk_initialize(BYTE pdrv)
 
 DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
 {
+#if CONFIG_FS_FAT_READ_AHEAD > 0
+	int hit = count == 1 && ra_read(buff, sector);
+
+	ra_next = sector + count;
+	if (hit) {
+		return RES_OK;
+	}
+#endif
+
 	if (disk_access_read(buff, sector, count) != 0) {
 		return RES_ERROR;
 	} else {
@@ -74,6 +141,10 @@ DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
 /*-----------------------------------------------------------------------*/
 DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 {
+#if CONFIG_FS_FAT_READ_AHEAD > 0
+	ra_invalidate(sector, count);
+#endif
+
 	if(disk_access_write(buff, sector, count) != 0) {
 		return RES_ERROR;
 	} else {
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Per-session memory arenas for mbed TLS
+ *
+ * An arena is a first fit allocator over its buffer, whose free blocks
+ * are kept sorted by address so that freed blocks merge with their
+ * neighbours: the arena is back to a single free block once everything
+ * was freed, whatever the order. Allocated blocks record their arena, so
+ * any thread can free them.
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <misc/util.h>
+#include <mbedtls_arena.h>
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <mbedtls/platform.h>
+
+#if !defined(MBEDTLS_PLATFORM_MEMORY)
+#error "the mbed TLS configuration needs MBEDTLS_PLATFORM_MEMORY"
+#endif
+
+#define ARENA_ALIGN 8
+
+struct arena_free {
+	struct arena_free *next;
+	size_t size;
+};
+
+struct arena_hdr {
+	struct mbedtls_arena *arena;
+	size_t size;
+};
+
+/* Both are 8 bytes on 32-bit targets */
+#define ARENA_HDR_SIZE ROUND_UP(sizeof(struct arena_hdr), ARENA_ALIGN)
+#define ARENA_MIN_FREE ROUND_UP(sizeof(struct arena_free), ARENA_ALIGN)
+
+static struct {
+	k_tid_t thread;
+	struct mbedtls_arena *arena;
+} arena_threads[CONFIG_MBEDTLS_ARENA_MAX_THREADS];
+
+static struct mbedtls_arena *arena_current(void)
+{
+	k_tid_t thread = k_current_get();
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(arena_threads); i++) {
+		if (arena_threads[i].thread == thread) {
+			return arena_threads[i].arena;
+		}
+	}
+
+	return NULL;
+}
+
+static void *arena_alloc(struct mbedtls_arena *arena, size_t size)
+{
+	struct arena_free **prev, *blk, *rest;
+	struct arena_hdr *hdr;
+
+	size = ROUND_UP(size, ARENA_ALIGN) + ARENA_HDR_SIZE;
+
+	for (prev = (struct arena_free **)&arena->free_list; *prev;
+	     prev = &(*prev)->next) {
+		blk = *prev;
+		if (blk->size < size) {
+			continue;
+		}
+
+		if (blk->size - size >= ARENA_MIN_FREE) {
+			rest = (struct arena_free *)((uint8_t *)blk + size);
+			rest->next = blk->next;
+			rest->size = blk->size - size;
+			*prev = rest;
+		} else {
+			size = blk->size;
+			*prev = blk->next;
+		}
+
+		arena->stats.bytes_used += size;
+		if (arena->stats.bytes_used > arena->stats.max_bytes_used) {
+			arena->stats.max_bytes_used = arena->stats.bytes_used;
+		}
+
+		hdr = (struct arena_hdr *)blk;
+		hdr->arena = arena;
+		hdr->size = size;
+
+		return (uint8_t *)hdr + ARENA_HDR_SIZE;
+	}
+
+	arena->stats.failures++;
+
+	return NULL;
+}
+
+static void arena_free(struct mbedtls_arena *arena, struct arena_hdr *hdr)
+{
+	struct arena_free **prev, *blk = (struct arena_free *)hdr;
+	struct arena_free *left = NULL;
+
+	blk->size = hdr->size;
+	arena->stats.bytes_used -= blk->size;
+
+	for (prev = (struct arena_free **)&arena->free_list;
+	     *prev && *prev < blk; prev = &(*prev)->next) {
+		left = *prev;
+	}
+
+	blk->next = *prev;
+	*prev = blk;
+
+	if (blk->next && (uint8_t *)blk + blk->size == (uint8_t *)blk->next) {
+		blk->size += blk->next->size;
+		blk->next = blk->next->next;
+	}
+
+	if (left && (uint8_t *)left + left->size == (uint8_t *)blk) {
+		left->size += blk->size;
+		left->next = blk->next;
+	}
+}
+
+static void *arena_calloc(size_t n, size_t size)
+{
+	struct mbedtls_arena *arena;
+	unsigned int key;
+	void *ptr;
+
+	if (size && n > (SIZE_MAX - ARENA_HDR_SIZE - ARENA_ALIGN) / size) {
+		return NULL;
+	}
+
+	key = irq_lock();
+
+	arena = arena_current();
+	if (!arena) {
+		irq_unlock(key);
+		return NULL;
+	}
+
+	ptr = arena_alloc(arena, n * size);
+
+	irq_unlock(key);
+
+	if (ptr) {
+		memset(ptr, 0, n * size);
+	}
+
+	return ptr;
+}
+
+static void arena_free_hook(void *ptr)
+{
+	struct arena_hdr *hdr;
+	unsigned int key;
+
+	if (!ptr) {
+		return;
+	}
+
+	hdr = (struct arena_hdr *)((uint8_t *)ptr - ARENA_HDR_SIZE);
+
+	key = irq_lock();
+	arena_free(hdr->arena, hdr);
+	irq_unlock(key);
+}
+
+void mbedtls_arena_reset(struct mbedtls_arena *arena)
+{
+	struct arena_free *blk = (struct arena_free *)arena->buf;
+	unsigned int key;
+
+	key = irq_lock();
+
+	blk->next = NULL;
+	blk->size = arena->size;
+	arena->free_list = blk;
+	memset(&arena->stats, 0, sizeof(arena->stats));
+
+	irq_unlock(key);
+}
+
+int mbedtls_arena_init(struct mbedtls_arena *arena, struct k_mem_pool *pool,
+		       size_t size, int32_t timeout)
+{
+	int ret;
+
+	ret = k_mem_pool_alloc(pool, &arena->block, size, timeout);
+	if (ret) {
+		return ret;
+	}
+
+	/* Pool blocks are not necessarily aligned for the arena blocks */
+	arena->buf = (uint8_t *)ROUND_UP(arena->block.data, ARENA_ALIGN);
+	arena->size = ROUND_DOWN(size - (arena->buf -
+					 (uint8_t *)arena->block.data),
+				 ARENA_ALIGN);
+
+	mbedtls_arena_reset(arena);
+
+	mbedtls_platform_set_calloc_free(arena_calloc, arena_free_hook);
+
+	return 0;
+}
+
+void mbedtls_arena_release(struct mbedtls_arena *arena)
+{
+	k_mem_pool_free(&arena->block);
+}
+
+int mbedtls_arena_enter(struct mbedtls_arena *arena)
+{
+	k_tid_t thread = k_current_get();
+	unsigned int key;
+	int i, slot = -1;
+
+	key = irq_lock();
+
+	for (i = 0; i < ARRAY_SIZE(arena_threads); i++) {
+		if (arena_threads[i].thread == thread) {
+			slot = i;
+			break;
+		}
+
+		if (!arena_threads[i].thread && slot < 0) {
+			slot = i;
+		}
+	}
+
+	if (slot < 0) {
+		irq_unlock(key);
+		return arena ? -ENOMEM : 0;
+	}
+
+	arena_threads[slot].thread = arena ? thread : NULL;
+	arena_threads[slot].arena = arena;
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+void mbedtls_arena_stats_get(struct mbedtls_arena *arena,
+			     struct mbedtls_arena_stats *stats, int clear)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	*stats = arena->stats;
+	if (clear) {
+		arena->stats.max_bytes_used = arena->stats.bytes_used;
+	}
+
+	irq_unlock(key);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Per-session memory arenas for mbed TLS
+ *
+ * Each TLS session allocates from its own arena, a fixed size buffer
+ * taken from a k_mem_pool, instead of from one heap shared by all the
+ * sessions. The memory of a session is then bounded, sessions do not
+ * fragment each other's memory, and the peak usage of a handshake can be
+ * measured to size the arenas.
+ *
+ * mbed TLS only has global calloc and free hooks: allocations are served
+ * by the arena the calling thread entered with mbedtls_arena_enter(), and
+ * fail when the thread entered none.
+ */
+
+#ifndef __MBEDTLS_ARENA_H__
+#define __MBEDTLS_ARENA_H__
+
+#include <kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mbedtls_arena_stats {
+	/** Bytes in the blocks currently allocated, headers included */
+	size_t bytes_used;
+	/** Peak value of bytes_used since the last reset */
+	size_t max_bytes_used;
+	/** Allocations which did not fit in the arena */
+	uint32_t failures;
+};
+
+struct mbedtls_arena {
+	struct k_mem_block block;
+	uint8_t *buf;
+	size_t size;
+	/* Free blocks, sorted by address */
+	void *free_list;
+	struct mbedtls_arena_stats stats;
+};
+
+/**
+ * @brief Take the memory of an arena from a pool
+ *
+ * Also installs the arena allocator as the mbed TLS calloc and free
+ * functions.
+ *
+ * @param arena Arena.
+ * @param pool Memory pool.
+ * @param size Size of the arena in bytes.
+ * @param timeout Maximum time to wait for the pool, in milliseconds.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOMEM If the pool is exhausted, without waiting.
+ * @retval -EAGAIN If the waiting period timed out.
+ */
+int mbedtls_arena_init(struct mbedtls_arena *arena, struct k_mem_pool *pool,
+		       size_t size, int32_t timeout);
+
+/**
+ * @brief Give the memory of an arena back to its pool
+ *
+ * All the allocations of the arena must have been freed, that is the mbed
+ * TLS contexts using it released with their mbedtls_*_free() function.
+ *
+ * @param arena Arena.
+ */
+void mbedtls_arena_release(struct mbedtls_arena *arena);
+
+/**
+ * @brief Drop all the allocations of an arena at once
+ *
+ * Reuses an arena for another session without freeing each context,
+ * e.g. once a failed handshake gave up on its mbed TLS contexts. The
+ * statistics are cleared as well.
+ *
+ * @param arena Arena.
+ */
+void mbedtls_arena_reset(struct mbedtls_arena *arena);
+
+/**
+ * @brief Serve the mbed TLS allocations of the calling thread from an arena
+ *
+ * @param arena Arena, NULL to leave the current one.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOMEM If CONFIG_MBEDTLS_ARENA_MAX_THREADS threads already
+ * entered an arena.
+ */
+int mbedtls_arena_enter(struct mbedtls_arena *arena);
+
+/**
+ * @brief Read the usage statistics of an arena
+ *
+ * Calling it with @a clear set once the handshake completed measures the
+ * peak usage of the application data phase on its own.
+ *
+ * @param arena Arena.
+ * @param stats Filled with the statistics.
+ * @param clear Restart the peak usage from the current one.
+ */
+void mbedtls_arena_stats_get(struct mbedtls_arena *arena,
+			     struct mbedtls_arena_stats *stats, int clear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MBEDTLS_ARENA_H__ */
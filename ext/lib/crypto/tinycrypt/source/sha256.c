@@ -72,6 +72,14 @@ int32_t tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
 		return TC_CRYPTO_SUCCESS;
 	}
 
+	/* Whole blocks are compressed in place, without the leftover copy */
+	while (s->leftover_offset == 0 && datalen >= TC_SHA256_BLOCK_SIZE) {
+		compress(s->iv, data);
+		data += TC_SHA256_BLOCK_SIZE;
+		datalen -= TC_SHA256_BLOCK_SIZE;
+		s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+	}
+
 	while (datalen-- > 0) {
 		s->leftover[s->leftover_offset++] = *(data++);
 		if (s->leftover_offset >= TC_SHA256_BLOCK_SIZE) {
@@ -178,6 +186,60 @@ static inline uint32_t BigEndian(const uint8_t **c)
 	return n;
 }
 
+#if defined(CONFIG_TINYCRYPT_SHA256_UNROLLED)
+/*
+ * One round, the rotation of the working variables being done by renaming
+ * them in the next invocation rather than by moving them.
+ */
+#define ROUND(a, b, c, d, e, f, g, h, i, w) \
+	do { \
+		uint32_t t = (h) + Sigma1(e) + Ch(e, f, g) + k256[i] + (w); \
+		(d) += t; \
+		(h) = t + Sigma0(a) + Maj(a, b, c); \
+	} while (0)
+
+#define SCHEDULE(w, i) \
+	((w)[(i) & 0xf] += sigma0((w)[((i) + 1) & 0xf]) + \
+			   sigma1((w)[((i) + 14) & 0xf]) + (w)[((i) + 9) & 0xf])
+
+#define ROUNDS8(w, i, W) \
+	do { \
+		ROUND(a, b, c, d, e, f, g, h, (i) + 0, W(w, (i) + 0)); \
+		ROUND(h, a, b, c, d, e, f, g, (i) + 1, W(w, (i) + 1)); \
+		ROUND(g, h, a, b, c, d, e, f, (i) + 2, W(w, (i) + 2)); \
+		ROUND(f, g, h, a, b, c, d, e, (i) + 3, W(w, (i) + 3)); \
+		ROUND(e, f, g, h, a, b, c, d, (i) + 4, W(w, (i) + 4)); \
+		ROUND(d, e, f, g, h, a, b, c, (i) + 5, W(w, (i) + 5)); \
+		ROUND(c, d, e, f, g, h, a, b, (i) + 6, W(w, (i) + 6)); \
+		ROUND(b, c, d, e, f, g, h, a, (i) + 7, W(w, (i) + 7)); \
+	} while (0)
+
+#define MESSAGE(w, i) ((w)[i])
+
+static void compress(uint32_t *iv, const uint8_t *data)
+{
+	uint32_t a, b, c, d, e, f, g, h;
+	uint32_t work_space[16];
+	uint32_t i;
+
+	for (i = 0; i < 16; ++i) {
+		work_space[i] = BigEndian(&data);
+	}
+
+	a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
+	e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
+
+	ROUNDS8(work_space, 0, MESSAGE);
+	ROUNDS8(work_space, 8, MESSAGE);
+
+	for (i = 16; i < 64; i += 8) {
+		ROUNDS8(work_space, i, SCHEDULE);
+	}
+
+	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
+	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+}
+#else
 static void compress(uint32_t *iv, const uint8_t *data)
 {
 	uint32_t a, b, c, d, e, f, g, h;
@@ -215,3 +277,4 @@ static void compress(uint32_t *iv, const uint8_t *data)
 	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
 	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
 }
+#endif
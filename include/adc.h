@@ -12,6 +12,7 @@
 #ifndef __INCLUDE_ADC_H__
 #define __INCLUDE_ADC_H__
 
+#include <errno.h>
 #include <stdint.h>
 #include <device.h>
 
@@ -63,6 +64,49 @@ struct adc_seq_table {
 	uint8_t stride[3];
 };
 
+/**
+ * @brief Continuous acquisition callback
+ *
+ * Called from interrupt context each time one half of the acquisition
+ * buffer is full. The converter goes on filling the other half, the
+ * samples must be consumed or moved away before it wraps around.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param samples Half of the buffer that was just filled.
+ * @param length Length of @a samples in bytes.
+ * @param user_data Pointer given in the stream configuration.
+ */
+typedef void (*adc_stream_callback_t)(struct device *dev, uint8_t *samples,
+				      uint32_t length, void *user_data);
+
+/**
+ * @brief ADC driver continuous acquisition configuration
+ *
+ * Conversions of a single channel are triggered by a hardware timer and
+ * the samples moved by DMA into a buffer used as two halves (ping-pong).
+ */
+struct adc_stream_config {
+	/** Conversions per second. */
+	uint32_t sample_rate;
+
+	/** Buffer the samples are written to, split in two halves. */
+	uint8_t *buffer;
+
+	/** Length of the buffer, a multiple of twice the sample size. */
+	uint32_t buffer_length;
+
+	/** Called each time a half of the buffer is full. */
+	adc_stream_callback_t callback;
+
+	/** Passed to the callback. */
+	void *user_data;
+
+	/** Channel ID that should be sampled from the ADC */
+	uint8_t channel_id;
+
+	uint8_t stride[3];
+};
+
 /**
  * @brief ADC driver API
  *
@@ -77,6 +121,13 @@ struct adc_driver_api {
 
 	/** Pointer to the read routine. */
 	int (*read)(struct device *dev, struct adc_seq_table *seq_table);
+
+	/** Pointer to the continuous acquisition start routine. */
+	int (*stream_start)(struct device *dev,
+			    const struct adc_stream_config *config);
+
+	/** Pointer to the continuous acquisition stop routine. */
+	int (*stream_stop)(struct device *dev);
 };
 
 /**
@@ -135,6 +186,54 @@ static inline int adc_read(struct device *dev, struct adc_seq_table *seq_table)
 	return api->read(dev, seq_table);
 }
 
+/**
+ * @brief Start a continuous acquisition.
+ *
+ * Conversions go on, without any CPU intervention between two halves of
+ * the buffer, until adc_stream_stop() is called. adc_read() can't be used
+ * meanwhile.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param config Pointer to the acquisition configuration.
+ *
+ * @retval 0 On success
+ * @retval -ENOTSUP If the driver has no continuous acquisition support.
+ * @retval -EBUSY If an acquisition is ongoing.
+ * @retval -EINVAL If the configuration can't be used.
+ */
+static inline int adc_stream_start(struct device *dev,
+				   const struct adc_stream_config *config)
+{
+	const struct adc_driver_api *api = dev->driver_api;
+
+	if (!api->stream_start) {
+		return -ENOTSUP;
+	}
+
+	return api->stream_start(dev, config);
+}
+
+/**
+ * @brief Stop a continuous acquisition.
+ *
+ * The samples of the half being filled are dropped.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ *
+ * @retval 0 On success
+ * @retval -ENOTSUP If the driver has no continuous acquisition support.
+ */
+static inline int adc_stream_stop(struct device *dev)
+{
+	const struct adc_driver_api *api = dev->driver_api;
+
+	if (!api->stream_stop) {
+		return -ENOTSUP;
+	}
+
+	return api->stream_stop(dev);
+}
+
 /**
  * @}
  */
@@ -97,6 +97,70 @@ extern void _irq_priority_set(unsigned int irq, unsigned int prio,
 	irq_p; \
 })
 
+/**
+ * Configure a 'direct' static interrupt.
+ *
+ * All arguments must be computable by the compiler at build time.
+ *
+ * Same as _ARCH_IRQ_CONNECT(), except that the ISR overrides the default
+ * _isr_wrapper() entry of the IRQ line in the vector table, in the
+ * .gnu.linkonce.irq_vector_irq section declared in sw_isr_table.S, and is
+ * invoked directly by the CPU.
+ *
+ * @param irq_p IRQ line number
+ * @param priority_p Interrupt priority
+ * @param isr_p Interrupt service routine, see ISR_DIRECT_DECLARE()
+ * @param flags_p IRQ options
+ *
+ * @return The vector assigned to this interrupt
+ */
+#define _ARCH_IRQ_DIRECT_CONNECT(irq_p, priority_p, isr_p, flags_p) \
+({ \
+	enum { IRQ = irq_p }; \
+	static void (*_CONCAT(_irq_vector_irq, irq_p))(void) \
+		__attribute__ ((used)) \
+		__attribute__ ((section(STRINGIFY(_CONCAT(.gnu.linkonce.irq_vector_irq, irq_p))))) = \
+			isr_p; \
+	_irq_priority_set(irq_p, priority_p, flags_p); \
+	irq_p; \
+})
+
+/* internal routines documented in C file, needed by ISR_DIRECT_* macros */
+#if defined(CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT) || \
+	defined(CONFIG_KERNEL_EVENT_LOGGER_SLEEP)
+extern void _arch_isr_direct_header(void);
+#else
+#define _arch_isr_direct_header() do { } while (0)
+#endif
+
+#if defined(CONFIG_SYS_POWER_MANAGEMENT)
+extern void _arch_isr_direct_pm(void);
+#else
+#define _arch_isr_direct_pm() do { } while (0)
+#endif
+
+#define _ARCH_ISR_DIRECT_HEADER() _arch_isr_direct_header()
+#define _ARCH_ISR_DIRECT_PM() _arch_isr_direct_pm()
+
+/* _IntExit() pends PendSV if a context switch is needed */
+#define _ARCH_ISR_DIRECT_FOOTER(swap) \
+	do { \
+		if (swap) { \
+			_IntExit(); \
+		} \
+	} while (0)
+
+#define _ARCH_ISR_DIRECT_DECLARE(name) \
+	static inline int name##_body(void); \
+	void name(void) \
+	{ \
+		int check_reschedule; \
+		ISR_DIRECT_HEADER(); \
+		check_reschedule = name##_body(); \
+		ISR_DIRECT_FOOTER(check_reschedule); \
+	} \
+	static inline int name##_body(void)
+
 #endif /* _ASMLANGUAGE */
 
 #ifdef __cplusplus
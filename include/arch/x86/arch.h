@@ -194,6 +194,74 @@ typedef struct s_isrList {
 	_IRQ_TO_INTERRUPT_VECTOR(irq_p); \
 })
 
+/**
+ * Configure a 'direct' static interrupt.
+ *
+ * All arguments must be computable by the compiler at build time.
+ *
+ * Same as _ARCH_IRQ_CONNECT(), except that gen_idt installs the ISR itself
+ * in the IDT instead of a stub jumping to _interrupt_enter(): the ISR must
+ * be declared with ISR_DIRECT_DECLARE(). It runs on the stack of the
+ * interrupted thread, with interrupts locked.
+ *
+ * @param irq_p IRQ line number
+ * @param priority_p Interrupt priority
+ * @param isr_p Interrupt service routine
+ * @param flags_p IRQ triggering options, as defined in irq_controller.h
+ *
+ * @return The vector assigned to this interrupt
+ */
+#define _ARCH_IRQ_DIRECT_CONNECT(irq_p, priority_p, isr_p, flags_p) \
+({ \
+	__asm__ __volatile__(							\
+		".pushsection .intList\n\t" \
+		".long %P[isr]\n\t"		/* ISR_LIST.fnc */ \
+		".long %P[irq]\n\t"		/* ISR_LIST.irq */ \
+		".long %P[priority]\n\t"	/* ISR_LIST.priority */ \
+		".long %P[vector]\n\t"		/* ISR_LIST.vec */ \
+		".long 0\n\t"			/* ISR_LIST.dpl */ \
+		".popsection\n\t" \
+		: \
+		: [isr] "i" (isr_p), \
+		  [priority] "i" (priority_p), \
+		  [vector] "i" _VECTOR_ARG(irq_p), \
+		  [irq] "i" (irq_p)); \
+	_irq_controller_irq_config(_IRQ_TO_INTERRUPT_VECTOR(irq_p), (irq_p), \
+				   (flags_p)); \
+	_IRQ_TO_INTERRUPT_VECTOR(irq_p); \
+})
+
+/* internal routines documented in C file, needed by ISR_DIRECT_* macros */
+extern void _arch_isr_direct_header(void);
+extern void _arch_isr_direct_footer(int maybe_swap);
+
+#ifdef CONFIG_SYS_POWER_MANAGEMENT
+extern void _arch_isr_direct_pm(void);
+#else
+#define _arch_isr_direct_pm() do { } while (0)
+#endif
+
+#define _ARCH_ISR_DIRECT_HEADER() _arch_isr_direct_header()
+#define _ARCH_ISR_DIRECT_FOOTER(swap) _arch_isr_direct_footer(swap)
+#define _ARCH_ISR_DIRECT_PM() _arch_isr_direct_pm()
+
+/*
+ * The compiler saves the registers the ISR uses and returns with 'iret'.
+ * The stack frame built by the CPU is not used.
+ */
+#define _ARCH_ISR_DIRECT_DECLARE(name) \
+	static inline int name##_body(void); \
+	__attribute__ ((interrupt, target("general-regs-only"))) \
+	void name(void *stack_frame) \
+	{ \
+		int check_reschedule; \
+		ARG_UNUSED(stack_frame); \
+		ISR_DIRECT_HEADER(); \
+		check_reschedule = name##_body(); \
+		ISR_DIRECT_FOOTER(check_reschedule); \
+	} \
+	static inline int name##_body(void)
+
 #ifdef CONFIG_X86_FIXED_IRQ_MAPPING
 /* Fixed vector-to-irq association mapping.
  * No need for the table at all.
@@ -83,6 +83,17 @@ static inline int _irq_controller_isr_vector_get(void)
 	return __irq_controller_isr_vector_get();
 }
 
+/**
+ * @brief Send EOI to the interrupt controller
+ *
+ * C version of the _irq_controller_eoi assembly macro, for the direct
+ * interrupts which do not go through _IntExitWithEoi.
+ */
+static inline void _irq_controller_eoi(void)
+{
+	__irq_controller_eoi();
+}
+
 
 #else /* _ASMLANGUAGE */
 
@@ -93,7 +104,8 @@ static inline int _irq_controller_isr_vector_get(void)
  * will be locked when this gets called and will not be unlocked until
  * 'iret' has been issued.
  *
- * This macro is used in exactly one spot in intStub.S, in _IntExitWithEoi.
+ * This macro is used in exactly one spot in intStub.S, in _IntExitWithEoi;
+ * direct interrupts use the C version instead.
  * At the time this is called, implementations are free to use the caller-
  * saved registers eax, edx, ecx for their own purposes with impunity but
  * need to preserve all callee-saved registers.
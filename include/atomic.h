@@ -9,6 +9,8 @@
 #ifndef __ATOMIC_H__
 #define __ATOMIC_H__
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,6 +18,9 @@ extern "C" {
 typedef int atomic_t;
 typedef atomic_t atomic_val_t;
 
+typedef int64_t atomic64_t;
+typedef atomic64_t atomic64_val_t;
+
 /**
  * @defgroup atomic_apis Atomic Services APIs
  * @ingroup kernel_apis
@@ -409,6 +414,243 @@ static inline void atomic_set_bit(atomic_t *target, int bit)
 	atomic_or(ATOMIC_ELEM(target, bit), mask);
 }
 
+/**
+ * @brief Atomically find and set a clear bit.
+ *
+ * Atomically set the lowest clear bit of the first @a num_bits bits of
+ * @a target, e.g. to allocate an entry tracked by a bitmap from any
+ * context without locking interrupts. The target may be a single atomic
+ * variable or an array of them.
+ *
+ * @param target Address of atomic variable or array.
+ * @param num_bits Number of bits of @a target.
+ *
+ * @return Number of the bit set, -1 if all the bits were set.
+ */
+static inline int atomic_find_and_set_bit(atomic_t *target, int num_bits)
+{
+	atomic_val_t old, clear;
+	int i, bit;
+
+	for (i = 0; i < num_bits; i += ATOMIC_BITS, target++) {
+		do {
+			old = atomic_get(target);
+			clear = ~old;
+			if (num_bits - i < ATOMIC_BITS) {
+				clear &= ATOMIC_MASK(num_bits - i) - 1;
+			}
+			if (!clear) {
+				break;
+			}
+			bit = __builtin_ctz(clear);
+		} while (!atomic_cas(target, old, old | ATOMIC_MASK(bit)));
+
+		if (clear) {
+			return i + bit;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief 64-bit atomic compare-and-set.
+ *
+ * 64-bit counterpart of atomic_cas().
+ *
+ * @param target Address of 64-bit atomic variable.
+ * @param old_value Original value to compare against.
+ * @param new_value New value to store.
+ * @return 1 if @a new_value is written, 0 otherwise.
+ */
+#ifdef CONFIG_ATOMIC64_OPERATIONS_BUILTIN
+static inline int atomic64_cas(atomic64_t *target, atomic64_val_t old_value,
+			       atomic64_val_t new_value)
+{
+	return __atomic_compare_exchange_n(target, &old_value, new_value,
+					   0, __ATOMIC_SEQ_CST,
+					   __ATOMIC_SEQ_CST);
+}
+#else
+extern int atomic64_cas(atomic64_t *target, atomic64_val_t old_value,
+			atomic64_val_t new_value);
+#endif
+
+/**
+ * @brief 64-bit atomic addition.
+ *
+ * 64-bit counterpart of atomic_add().
+ *
+ * @param target Address of 64-bit atomic variable.
+ * @param value Value to add.
+ *
+ * @return Previous value of @a target.
+ */
+#ifdef CONFIG_ATOMIC64_OPERATIONS_BUILTIN
+static inline atomic64_val_t atomic64_add(atomic64_t *target,
+					  atomic64_val_t value)
+{
+	return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST);
+}
+#else
+extern atomic64_val_t atomic64_add(atomic64_t *target, atomic64_val_t value);
+#endif
+
+/**
+ * @brief 64-bit atomic subtraction.
+ *
+ * 64-bit counterpart of atomic_sub().
+ *
+ * @param target Address of 64-bit atomic variable.
+ * @param value Value to subtract.
+ *
+ * @return Previous value of @a target.
+ */
+#ifdef CONFIG_ATOMIC64_OPERATIONS_BUILTIN
+static inline atomic64_val_t atomic64_sub(atomic64_t *target,
+					  atomic64_val_t value)
+{
+	return __atomic_fetch_sub(target, value, __ATOMIC_SEQ_CST);
+}
+#else
+extern atomic64_val_t atomic64_sub(atomic64_t *target, atomic64_val_t value);
+#endif
+
+/**
+ * @brief 64-bit atomic increment.
+ *
+ * @param target Address of 64-bit atomic variable.
+ *
+ * @return Previous value of @a target.
+ */
+static inline atomic64_val_t atomic64_inc(atomic64_t *target)
+{
+	return atomic64_add(target, 1);
+}
+
+/**
+ * @brief 64-bit atomic decrement.
+ *
+ * @param target Address of 64-bit atomic variable.
+ *
+ * @return Previous value of @a target.
+ */
+static inline atomic64_val_t atomic64_dec(atomic64_t *target)
+{
+	return atomic64_sub(target, 1);
+}
+
+/**
+ * @brief 64-bit atomic get.
+ *
+ * This routine reads all the 64 bits of @a target at once, where a plain
+ * load could see a torn value on 32-bit processors.
+ *
+ * @param target Address of 64-bit atomic variable.
+ *
+ * @return Value of @a target.
+ */
+#ifdef CONFIG_ATOMIC64_OPERATIONS_BUILTIN
+static inline atomic64_val_t atomic64_get(const atomic64_t *target)
+{
+	return __atomic_load_n(target, __ATOMIC_SEQ_CST);
+}
+#else
+extern atomic64_val_t atomic64_get(const atomic64_t *target);
+#endif
+
+/**
+ * @brief 64-bit atomic get-and-set.
+ *
+ * 64-bit counterpart of atomic_set().
+ *
+ * @param target Address of 64-bit atomic variable.
+ * @param value Value to write to @a target.
+ *
+ * @return Previous value of @a target.
+ */
+#ifdef CONFIG_ATOMIC64_OPERATIONS_BUILTIN
+static inline atomic64_val_t atomic64_set(atomic64_t *target,
+					  atomic64_val_t value)
+{
+	return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+#else
+extern atomic64_val_t atomic64_set(atomic64_t *target, atomic64_val_t value);
+#endif
+
+/**
+ * @brief 64-bit atomic clear.
+ *
+ * @param target Address of 64-bit atomic variable.
+ *
+ * @return Previous value of @a target.
+ */
+static inline atomic64_val_t atomic64_clear(atomic64_t *target)
+{
+	return atomic64_set(target, 0);
+}
+
+/**
+ * @brief 64-bit atomic bitwise inclusive OR.
+ *
+ * 64-bit counterpart of atomic_or().
+ *
+ * @param target Address of 64-bit atomic variable.
+ * @param value Value to OR.
+ *
+ * @return Previous value of @a target.
+ */
+#ifdef CONFIG_ATOMIC64_OPERATIONS_BUILTIN
+static inline atomic64_val_t atomic64_or(atomic64_t *target,
+					 atomic64_val_t value)
+{
+	return __atomic_fetch_or(target, value, __ATOMIC_SEQ_CST);
+}
+#else
+extern atomic64_val_t atomic64_or(atomic64_t *target, atomic64_val_t value);
+#endif
+
+/**
+ * @brief 64-bit atomic bitwise AND.
+ *
+ * 64-bit counterpart of atomic_and().
+ *
+ * @param target Address of 64-bit atomic variable.
+ * @param value Value to AND.
+ *
+ * @return Previous value of @a target.
+ */
+#ifdef CONFIG_ATOMIC64_OPERATIONS_BUILTIN
+static inline atomic64_val_t atomic64_and(atomic64_t *target,
+					  atomic64_val_t value)
+{
+	return __atomic_fetch_and(target, value, __ATOMIC_SEQ_CST);
+}
+#else
+extern atomic64_val_t atomic64_and(atomic64_t *target, atomic64_val_t value);
+#endif
+
+/**
+ * @brief 64-bit atomic bitwise exclusive OR (XOR).
+ *
+ * 64-bit counterpart of atomic_xor().
+ *
+ * @param target Address of 64-bit atomic variable.
+ * @param value Value to XOR.
+ *
+ * @return Previous value of @a target.
+ */
+#ifdef CONFIG_ATOMIC64_OPERATIONS_BUILTIN
+static inline atomic64_val_t atomic64_xor(atomic64_t *target,
+					  atomic64_val_t value)
+{
+	return __atomic_fetch_xor(target, value, __ATOMIC_SEQ_CST);
+}
+#else
+extern atomic64_val_t atomic64_xor(atomic64_t *target, atomic64_val_t value);
+#endif
+
 /**
  * @}
  */
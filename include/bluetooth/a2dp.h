@@ -10,6 +10,12 @@
 #ifndef __BT_A2DP_H
 #define __BT_A2DP_H
 
+#include <bluetooth/l2cap.h>
+#include <bluetooth/avdtp.h>
+#if defined(CONFIG_BLUETOOTH_A2DP_SBC)
+#include <bluetooth/sbc.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +36,62 @@ struct bt_a2dp;
  */
 struct bt_a2dp *bt_a2dp_connect(struct bt_conn *conn);
 
+/** @brief Open the media transport of a stream.
+ *
+ *  The stream ops connected callback is called once media can be sent
+ *  with bt_avdtp_media_send() or received with bt_avdtp_media_get().
+ *
+ *  @param a2dp A2DP connection.
+ *  @param stream Stream to open, with its ops set.
+ *
+ *  @return 0 in case of success or negative value in case of error.
+ */
+int bt_a2dp_stream_connect(struct bt_a2dp *a2dp,
+			   struct bt_avdtp_stream *stream);
+
+/** @brief Accept the media transport of a stream opened by the remote.
+ *
+ *  @param a2dp A2DP connection.
+ *  @param stream Stream to use for the next incoming transport channel,
+ *  with its ops set.
+ *
+ *  @return 0 in case of success or negative value in case of error.
+ */
+int bt_a2dp_stream_accept(struct bt_a2dp *a2dp,
+			  struct bt_avdtp_stream *stream);
+
+#if defined(CONFIG_BLUETOOTH_A2DP_SBC)
+/** @brief Number of SBC frames fitting in a media packet of a stream.
+ *
+ *  @param stream Stream with a connected transport channel.
+ *  @param enc Initialized SBC encoder.
+ *
+ *  @return Number of frames, 0 if the stream is not connected.
+ */
+uint8_t bt_a2dp_sbc_frames_max(struct bt_avdtp_stream *stream,
+			       const struct bt_sbc_encoder *enc);
+
+/** @brief Encode and send SBC frames.
+ *
+ *  The frames are encoded directly in the buffer, which should be
+ *  allocated with bt_avdtp_media_create_pdu(). It is consumed in case
+ *  of success, and left empty in case of error.
+ *
+ *  @param stream Stream with a connected transport channel.
+ *  @param enc Initialized SBC encoder.
+ *  @param buf Empty buffer for the media packet.
+ *  @param pcm Samples of the frames, interleaved when there are two
+ *  channels.
+ *  @param frames Number of frames to encode, up to
+ *  bt_a2dp_sbc_frames_max().
+ *
+ *  @return 0 in case of success or negative value in case of error.
+ */
+int bt_a2dp_sbc_send(struct bt_avdtp_stream *stream,
+		     struct bt_sbc_encoder *enc, struct net_buf *buf,
+		     const int16_t *pcm, uint8_t frames);
+#endif /* CONFIG_BLUETOOTH_A2DP_SBC */
+
 #ifdef __cplusplus
 }
 #endif
@@ -10,10 +10,18 @@
 #ifndef __BT_AVDTP_H
 #define __BT_AVDTP_H
 
+#include <net/buf.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if defined(CONFIG_BLUETOOTH_AVDTP_JITTER_LEN)
+#define BT_AVDTP_JITTER_LEN CONFIG_BLUETOOTH_AVDTP_JITTER_LEN
+#else
+#define BT_AVDTP_JITTER_LEN 1
+#endif
+
 /** @brief AVDTP SEID Information */
 struct bt_avdtp_seid_info {
 	/** Stream End Point ID */
@@ -38,6 +46,17 @@ struct bt_avdtp_seid_lsep {
 	struct bt_avdtp_seid_lsep *next;
 };
 
+struct bt_avdtp;
+struct bt_avdtp_stream;
+
+/** @brief AVDTP stream callbacks */
+struct bt_avdtp_stream_ops {
+	/** Transport channel connected, media can be sent */
+	void (*connected)(struct bt_avdtp_stream *stream);
+	/** Transport channel disconnected */
+	void (*disconnected)(struct bt_avdtp_stream *stream);
+};
+
 /** @brief AVDTP Stream */
 struct bt_avdtp_stream {
 	struct bt_l2cap_br_chan chan; /* Transport Channel*/
@@ -45,8 +64,60 @@ struct bt_avdtp_stream {
 	struct bt_avdtp_seid_info rsep; /* Configured Remote SEP*/
 	uint8_t state; /* current state of the stream */
 	struct bt_avdtp_stream *next;
+	struct bt_avdtp_stream_ops *ops;
+	struct bt_avdtp *session;
+	/* RTP sequence number and timestamp of the next media packet */
+	uint16_t seq;
+	uint32_t timestamp;
+	/* Jitter buffer of the received media packets, by sequence number */
+	struct net_buf *jb[BT_AVDTP_JITTER_LEN];
+	uint16_t jb_seq;
+	uint8_t jb_count;
+	bool jb_playing;
 };
 
+/** @brief Allocate a buffer for a media packet.
+ *
+ *  Head room is reserved for the media packet header, L2CAP and ACL
+ *  headers, so that the media payload is never copied.
+ *
+ *  @param pool Which pool to take the buffer from.
+ *
+ *  @return New buffer.
+ */
+struct net_buf *bt_avdtp_media_create_pdu(struct net_buf_pool *pool);
+
+/** @brief Send a media packet.
+ *
+ *  The RTP header is added in the head room of the buffer, which should
+ *  be allocated with bt_avdtp_media_create_pdu(). The buffer is not
+ *  freed in case of error.
+ *
+ *  @param stream Stream with a connected transport channel.
+ *  @param buf Media payload.
+ *  @param samples Number of samples in the payload, by which the
+ *  timestamp of the next packet is advanced.
+ *
+ *  @return 0 in case of success or negative value in case of error.
+ */
+int bt_avdtp_media_send(struct bt_avdtp_stream *stream, struct net_buf *buf,
+			uint32_t samples);
+
+/** @brief Get the next received media packet.
+ *
+ *  The received packets are reordered in a jitter buffer, from which they
+ *  are taken at the pace of the audio output. Playing starts once
+ *  CONFIG_BLUETOOTH_AVDTP_JITTER_PREFILL packets are buffered, and again
+ *  after the buffer ran empty.
+ *
+ *  @param stream Stream with a connected transport channel.
+ *  @param buf Media payload of the next packet, NULL if it was lost.
+ *  The buffer must be unreferenced once its payload is used.
+ *
+ *  @return 0 in case of success, -EAGAIN when buffering.
+ */
+int bt_avdtp_media_get(struct bt_avdtp_stream *stream, struct net_buf **buf);
+
 #ifdef __cplusplus
 }
 #endif
@@ -168,6 +168,33 @@ int bt_le_adv_start(const struct bt_le_adv_param *param,
  */
 int bt_le_adv_stop(void);
 
+/** @brief Start an advertising set
+ *
+ *  Start broadcasting non-connectable advertising set data, alongside
+ *  the advertising started by bt_le_adv_start() and the other sets. The
+ *  built-in controller schedules each set at its own interval, it needs
+ *  CONFIG_BLUETOOTH_CONTROLLER_ADV_SETS to be greater than @a set. The
+ *  identity address is used, the connectable option and own_addr of
+ *  @a param are not supported.
+ *
+ *  @param set Advertising set index.
+ *  @param param Advertising parameters.
+ *  @param ad Data to be used in the advertising packets.
+ *  @param ad_len Number of elements in ad
+ *
+ *  @return Zero on success or (negative) error code otherwise.
+ */
+int bt_le_adv_set_start(uint8_t set, const struct bt_le_adv_param *param,
+			const struct bt_data *ad, size_t ad_len);
+
+/** @brief Stop an advertising set
+ *
+ *  @param set Advertising set index given to bt_le_adv_set_start().
+ *
+ *  @return Zero on success or (negative) error code otherwise.
+ */
+int bt_le_adv_set_stop(uint8_t set);
+
 /** @typedef bt_le_scan_cb_t
  *  @brief Callback type for reporting LE scan results.
  *
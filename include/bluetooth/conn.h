@@ -156,6 +156,36 @@ struct bt_conn_info {
  */
 int bt_conn_get_info(const struct bt_conn *conn, struct bt_conn_info *info);
 
+/** @brief Connection ACL TX statistics
+ *
+ *  @param pkts Number of ACL packets sent to the controller
+ *  @param bytes Number of bytes sent, ACL headers excluded
+ *  @param wait_total Time the packets waited for a controller buffer, in
+ *         microseconds
+ *  @param wait_max Longest wait of a packet for a controller buffer, in
+ *         microseconds
+ */
+struct bt_conn_tx_stats {
+	uint32_t pkts;
+	uint32_t bytes;
+	uint32_t wait_total;
+	uint32_t wait_max;
+};
+
+#if defined(CONFIG_BLUETOOTH_CONN_TX_STATS)
+/** @brief Get the ACL TX statistics of a connection
+ *
+ *  The statistics are reset when the connection is established.
+ *
+ *  @param conn Connection object.
+ *  @param stats Statistics object to fill.
+ *
+ *  @return Zero on success or (negative) error code on failure.
+ */
+int bt_conn_get_tx_stats(const struct bt_conn *conn,
+			 struct bt_conn_tx_stats *stats);
+#endif /* CONFIG_BLUETOOTH_CONN_TX_STATS */
+
 /** @brief Update the connection parameters.
  *
  *  @param conn Connection object.
@@ -0,0 +1,57 @@
+/** @file
+ *  @brief Bluetooth Controller configuration
+ */
+
+/*
+ * Copyright (c) 2017 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __BT_CONTROLLER_H
+#define __BT_CONTROLLER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Bluetooth Controller
+ * @defgroup bt_ctlr Bluetooth Controller
+ * @ingroup bluetooth
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Partition the Controller memory
+ *
+ *  Set the number of connection contexts and of Rx and Tx data buffers
+ *  the Controller lays out in its memory, statically sized for
+ *  CONFIG_BLUETOOTH_MAX_CONN connections and the
+ *  CONFIG_BLUETOOTH_CONTROLLER_RX_BUFFERS and
+ *  CONFIG_BLUETOOTH_CONTROLLER_TX_BUFFERS buffer counts. The memory of
+ *  the connections not used can hold more buffers, e.g. for a
+ *  throughput application on a single connection.
+ *
+ *  To be called before bt_enable(), which fails with -ENOMEM if the
+ *  partition does not fit the Controller memory.
+ *
+ *  @param conn_count Connection contexts, no more than
+ *  CONFIG_BLUETOOTH_MAX_CONN.
+ *  @param rx_count Rx data buffers.
+ *  @param tx_count Tx data buffers, shared by the connections.
+ *
+ *  @return Zero on success, -EINVAL for an invalid count, -EBUSY if the
+ *  Controller is already enabled.
+ */
+int bt_ctlr_mem_config(uint8_t conn_count, uint8_t rx_count,
+		       uint8_t tx_count);
+
+#ifdef __cplusplus
+}
+#endif
+/**
+ * @}
+ */
+
+#endif /* __BT_CONTROLLER_H */
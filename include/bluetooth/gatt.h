@@ -71,6 +71,15 @@ enum {
 	 *  passed to write callback.
 	 */
 	BT_GATT_PERM_PREPARE_WRITE = BIT(6),
+
+	/** Attribute prepare write chain permission.
+	 *
+	 *  If set along with BT_GATT_PERM_PREPARE_WRITE, the contiguous
+	 *  prepared writes of the attribute are given at once to the write
+	 *  callback on execution, with BT_GATT_WRITE_FLAG_CHAIN, rather than
+	 *  one at a time.
+	 */
+	BT_GATT_PERM_PREPARE_WRITE_CHAIN = BIT(7),
 };
 
 /**  @def BT_GATT_ERR
@@ -91,6 +100,15 @@ enum {
 	 * authorized but no data shall be written.
 	 */
 	BT_GATT_WRITE_FLAG_PREPARE = BIT(0),
+
+	/** Attribute write chain flag
+	 *
+	 * If set, the buffer given to the write callback is a struct net_buf
+	 * whose fragment chain holds the data of consecutive prepared writes,
+	 * and the length is the total length of the chain. The fragments are
+	 * only valid during the callback unless it takes a reference on them.
+	 */
+	BT_GATT_WRITE_FLAG_CHAIN = BIT(1),
 };
 
 /** @brief GATT Attribute structure. */
@@ -688,6 +706,33 @@ ssize_t bt_gatt_attr_read_cpf(struct bt_conn *conn,
 int bt_gatt_notify(struct bt_conn *conn, const struct bt_gatt_attr *attr,
 		   const void *data, uint16_t len);
 
+/** @brief GATT Notify Value parameters */
+struct bt_gatt_notify_params {
+	/** Notify Attribute object */
+	const struct bt_gatt_attr *attr;
+	/** Notify Value data */
+	const void *data;
+	/** Notify Value length */
+	uint16_t len;
+};
+
+/** @brief Notify several attribute value changes.
+ *
+ *  Send the notifications of several attributes, in the order given, as
+ *  bt_gatt_notify() does for each of them.
+ *
+ *  @param conn Connection object, or NULL to notify all the subscribed
+ *  peers.
+ *  @param params Array of notification parameters.
+ *  @param count Number of elements in the array.
+ *
+ *  @return 0 in case of success or negative value in case of error, the
+ *  notifications following the failing one are not sent.
+ */
+int bt_gatt_notify_multiple(struct bt_conn *conn,
+			    const struct bt_gatt_notify_params *params,
+			    size_t count);
+
 /** @typedef bt_gatt_indicate_func_t
  *  @brief Indication complete result callback.
  *
@@ -902,6 +947,10 @@ typedef void (*bt_gatt_write_func_t)(struct bt_conn *conn, uint8_t err,
 /** @brief GATT Write parameters */
 struct bt_gatt_write_params {
 	struct bt_att_req _req;
+	/* Request of the next chunk of a long write, queued behind _req */
+	struct bt_att_req _prep_req;
+	uint8_t _prep_pending;
+	uint8_t _prep_err;
 	/** Response callback */
 	bt_gatt_write_func_t func;
 	/** Attribute handle */
@@ -180,6 +180,8 @@ struct bt_hci_cmd_hdr {
 						BT_LE_FEAT_BIT_SLAVE_FEAT_REQ)
 #define BT_FEAT_LE_DLE(feat)                    BT_FEAT_TEST(feat, 0, 0, \
 						BT_LE_FEAT_BIT_DLE)
+#define BT_FEAT_LE_PRIVACY(feat)                BT_FEAT_TEST(feat, 0, 0, \
+						BT_LE_FEAT_BIT_PRIVACY)
 
 /* LE States */
 #define BT_LE_STATES_SLAVE_CONN_ADV(states)     (states & 0x0000004000000000)
@@ -220,6 +222,9 @@ struct bt_hci_cmd_hdr {
 #define BT_GAP_INIT_CONN_INT_MIN                0x0018  /* 30 ms    */
 #define BT_GAP_INIT_CONN_INT_MAX                0x0028  /* 50 ms    */
 
+/* Default LE link layer PDU payload length */
+#define BT_GAP_DATA_LEN_DEFAULT                 0x001b  /* 27 bytes */
+
 /* HCI BR/EDR link types */
 #define BT_HCI_SCO                              0x00
 #define BT_HCI_ACL                              0x01
@@ -874,6 +879,29 @@ struct bt_hci_rp_le_read_max_data_len {
 	uint16_t max_rx_time;
 } __packed;
 
+/* Vendor specific commands of the built-in controller */
+
+#define BT_HCI_OP_VS_SET_ADV_SET_PARAM          BT_OP(BT_OGF_VS, 0x0080)
+struct bt_hci_cp_vs_set_adv_set_param {
+	uint8_t  set;
+	uint16_t interval;
+	uint8_t  own_addr_type;
+	uint8_t  channel_map;
+} __packed;
+
+#define BT_HCI_OP_VS_SET_ADV_SET_DATA           BT_OP(BT_OGF_VS, 0x0081)
+struct bt_hci_cp_vs_set_adv_set_data {
+	uint8_t  set;
+	uint8_t  len;
+	uint8_t  data[31];
+} __packed;
+
+#define BT_HCI_OP_VS_SET_ADV_SET_ENABLE         BT_OP(BT_OGF_VS, 0x0082)
+struct bt_hci_cp_vs_set_adv_set_enable {
+	uint8_t  set;
+	uint8_t  enable;
+} __packed;
+
 /* Event definitions */
 
 #define BT_HCI_EVT_VENDOR                       0xff
@@ -96,6 +96,16 @@ struct bt_l2cap_le_chan {
 	/** Segment SDU packet from upper layer */
 	struct net_buf			*_sdu;
 	uint16_t			_sdu_len;
+#if defined(CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE)
+	/* For internal use only: SDUs waiting to be sent */
+	struct k_fifo			_tx_queue;
+	struct k_sem			_tx_slots;
+	struct k_work			_tx_work;
+	/* SDU being sent and its length left to send */
+	struct net_buf			*_tx_sdu;
+	uint16_t			_tx_left;
+	bool				_tx_hdr_sent;
+#endif /* CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE */
 };
 
 /** @def BT_L2CAP_LE_CHAN(_ch)
@@ -90,10 +90,15 @@ struct bt_rfcomm_dlc {
 	bt_security_t              required_sec_level;
 	bt_rfcomm_role_t           role;
 
+	/** Maximum frame size, 0 for the largest the L2CAP MTU allows */
 	uint16_t                   mtu;
 	uint8_t                    dlci;
 	uint8_t                    state;
 	uint8_t                    rx_credit;
+	/* Credits left when more are given, adapted to the rx rate */
+	uint8_t                    rx_credit_threshold;
+	/* Uptime of the last credit update */
+	uint32_t                   rx_credit_time;
 
 	/* Stack for TX fiber */
 	BT_STACK(stack, 256);
@@ -148,7 +153,9 @@ int bt_rfcomm_dlc_connect(struct bt_conn *conn, struct bt_rfcomm_dlc *dlc,
 /** @brief Send data to RFCOMM
  *
  *  Send data from buffer to the dlc. Length should be less than or equal to
- *  mtu.
+ *  mtu. The RFCOMM header is built in the head room of the buffer, which
+ *  should be allocated with bt_rfcomm_create_pdu(), and one byte of tail
+ *  room is needed for the FCS.
  *
  *  @param dlc Dlc object.
  *  @param buf Data buffer.
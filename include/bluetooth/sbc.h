@@ -0,0 +1,115 @@
+/** @file
+ * @brief Bluetooth SBC audio encoder.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __BT_SBC_H
+#define __BT_SBC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief SBC sampling frequencies */
+enum {
+	BT_SBC_FREQ_16000,
+	BT_SBC_FREQ_32000,
+	BT_SBC_FREQ_44100,
+	BT_SBC_FREQ_48000,
+};
+
+/** @brief SBC channel modes */
+enum {
+	BT_SBC_MODE_MONO,
+	BT_SBC_MODE_DUAL_CHANNEL,
+	BT_SBC_MODE_STEREO,
+	BT_SBC_MODE_JOINT_STEREO,
+};
+
+/** @brief SBC bit allocation methods */
+enum {
+	BT_SBC_ALLOC_LOUDNESS,
+	BT_SBC_ALLOC_SNR,
+};
+
+/** @brief SBC encoding parameters, as configured through AVDTP */
+struct bt_sbc_config {
+	/** BT_SBC_FREQ_* sampling frequency */
+	uint8_t freq;
+	/** BT_SBC_MODE_* channel mode */
+	uint8_t mode;
+	/** Block length: 4, 8, 12 or 16 */
+	uint8_t blocks;
+	/** Number of subbands: 4 or 8 */
+	uint8_t subbands;
+	/** BT_SBC_ALLOC_* bit allocation method */
+	uint8_t alloc;
+	/** Bitpool, setting the bit rate */
+	uint8_t bitpool;
+};
+
+/* Analysis history, with room to shift it only every few blocks */
+#define BT_SBC_X_LEN (10 * 8 + 8 * 8)
+
+/** @brief SBC encoder state */
+struct bt_sbc_encoder {
+	struct bt_sbc_config cfg;
+	uint8_t channels;
+	uint16_t x_pos;
+	int16_t x[2][BT_SBC_X_LEN];
+	int32_t sb[16][2][8];
+};
+
+/** @brief Initialize an SBC encoder.
+ *
+ *  @param enc Encoder to initialize.
+ *  @param cfg Encoding parameters.
+ *
+ *  @return 0 in case of success or negative value in case of error.
+ */
+int bt_sbc_encoder_init(struct bt_sbc_encoder *enc,
+			const struct bt_sbc_config *cfg);
+
+/** @brief Length of the frames produced by an SBC encoder.
+ *
+ *  @param enc Initialized encoder.
+ *
+ *  @return Frame length in bytes.
+ */
+size_t bt_sbc_frame_len(const struct bt_sbc_encoder *enc);
+
+/** @brief Number of PCM samples per channel in an SBC frame.
+ *
+ *  @param enc Initialized encoder.
+ *
+ *  @return Number of samples, blocks times subbands.
+ */
+static inline size_t bt_sbc_frame_samples(const struct bt_sbc_encoder *enc)
+{
+	return enc->cfg.blocks * enc->cfg.subbands;
+}
+
+/** @brief Encode one SBC frame.
+ *
+ *  @param enc Initialized encoder.
+ *  @param pcm bt_sbc_frame_samples() samples per channel, interleaved
+ *  when there are two channels.
+ *  @param frame Output, bt_sbc_frame_len() bytes long.
+ *
+ *  @return Length of the frame written.
+ */
+size_t bt_sbc_encode(struct bt_sbc_encoder *enc, const int16_t *pcm,
+		     uint8_t *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BT_SBC_H */
@@ -62,6 +62,11 @@ enum {
 	  * Type: uint8_t key[16]
 	  */
 	BT_STORAGE_IRK,
+
+	/** GATT client discovery cache of a bonded peer.
+	  * Type: opaque, owned by the GATT client
+	  */
+	BT_STORAGE_GATT_CACHE,
 };
 
 /** LTK key flags */
@@ -17,11 +17,24 @@ extern "C" {
 
 #if defined(CONFIG_CACHE_FLUSHING)
 
+/*
+ * sys_cache_flush() writes the dirty lines of a range back to memory,
+ * sys_cache_invd() discards the lines of a range, dirty or not, so the
+ * next accesses read memory, and sys_cache_flush_invd() does both. The
+ * range need not be aligned, but every line it touches is affected:
+ * invalidating a line only partly covered by the range loses what the CPU
+ * wrote to the rest of it. CPUs that cannot discard lines write them back
+ * on sys_cache_invd() as well.
+ */
 #if defined(CONFIG_ARCH_CACHE_FLUSH_DETECT)
 	typedef _sys_cache_flush_sig(_sys_cache_flush_t);
 	extern _sys_cache_flush_t *sys_cache_flush;
+	extern _sys_cache_flush_t *sys_cache_invd;
+	extern _sys_cache_flush_t *sys_cache_flush_invd;
 #else
 	extern _sys_cache_flush_sig(sys_cache_flush);
+	extern _sys_cache_flush_sig(sys_cache_invd);
+	extern _sys_cache_flush_sig(sys_cache_flush_invd);
 #endif
 
 #else
@@ -43,6 +56,22 @@ static inline _sys_cache_flush_sig(sys_cache_flush)
 	/* do nothing */
 }
 
+static inline _sys_cache_flush_sig(sys_cache_invd)
+{
+	ARG_UNUSED(virt);
+	ARG_UNUSED(size);
+
+	/* do nothing */
+}
+
+static inline _sys_cache_flush_sig(sys_cache_flush_invd)
+{
+	ARG_UNUSED(virt);
+	ARG_UNUSED(size);
+
+	/* do nothing */
+}
+
 #endif /* CACHE_FLUSHING */
 
 #if defined(CONFIG_CACHE_LINE_SIZE_DETECT)
@@ -53,6 +82,86 @@ static inline _sys_cache_flush_sig(sys_cache_flush)
 	#define sys_cache_line_size 0
 #endif
 
+/**
+ * @brief Hint that a range is about to be read
+ *
+ * Issues a prefetch of each cache line of the range, e.g. ahead of parsing
+ * a buffer a DMA transfer just filled. It is only a hint: nothing is done
+ * when the cache line size is 0 or the CPU has no prefetch instruction.
+ *
+ * @param virt Start of the range.
+ * @param size Size of the range in bytes.
+ *
+ * @return N/A
+ */
+static inline _sys_cache_flush_sig(sys_cache_prefetch)
+{
+	vaddr_t end = virt + size;
+
+	if (sys_cache_line_size == 0) {
+		return;
+	}
+
+	for (virt &= ~(vaddr_t)(sys_cache_line_size - 1); virt < end;
+	     virt += sys_cache_line_size) {
+		__builtin_prefetch((const void *)virt);
+	}
+}
+
+/*
+ * Buffers shared with a DMA capable device
+ *
+ * Call sys_cache_dma_to_device() once the CPU wrote a buffer and before a
+ * device reads it, sys_cache_dma_from_device_start() before a device
+ * writes a buffer and sys_cache_dma_from_device_end() once it did, before
+ * the CPU reads it. Only the range given is maintained, so buffers a
+ * device writes should be cache line aligned, and padded to a whole
+ * number of lines, unless the CPU leaves the rest of their lines alone.
+ *
+ * These compile to nothing without CONFIG_CACHE_FLUSHING, or when bus
+ * masters snoop the caches (CONFIG_CACHE_DMA_COHERENT).
+ */
+#if defined(CONFIG_CACHE_FLUSHING) && !defined(CONFIG_CACHE_DMA_COHERENT)
+
+static inline _sys_cache_flush_sig(sys_cache_dma_to_device)
+{
+	sys_cache_flush(virt, size);
+}
+
+static inline _sys_cache_flush_sig(sys_cache_dma_from_device_start)
+{
+	/* No dirty line may be evicted over what the device writes */
+	sys_cache_flush_invd(virt, size);
+}
+
+static inline _sys_cache_flush_sig(sys_cache_dma_from_device_end)
+{
+	/* Drop whatever was read or prefetched during the transfer */
+	sys_cache_invd(virt, size);
+}
+
+#else
+
+static inline _sys_cache_flush_sig(sys_cache_dma_to_device)
+{
+	ARG_UNUSED(virt);
+	ARG_UNUSED(size);
+}
+
+static inline _sys_cache_flush_sig(sys_cache_dma_from_device_start)
+{
+	ARG_UNUSED(virt);
+	ARG_UNUSED(size);
+}
+
+static inline _sys_cache_flush_sig(sys_cache_dma_from_device_end)
+{
+	ARG_UNUSED(virt);
+	ARG_UNUSED(size);
+}
+
+#endif /* CONFIG_CACHE_FLUSHING && !CONFIG_CACHE_DMA_COHERENT */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief AES cipher sessions of the crypto driver API
+ */
+
+#ifndef __CRYPTO_CIPHER_H__
+#define __CRYPTO_CIPHER_H__
+
+#include <crypto/crypto.h>
+#include <misc/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup crypto_interface
+ * @{
+ */
+
+/** AES block size in bytes */
+#define CRYPTO_AES_BLOCK_SIZE	16
+
+enum cipher_mode {
+	/** Blocks ciphered independently, the length must be a multiple of
+	 * the block size
+	 */
+	CRYPTO_CIPHER_MODE_ECB,
+	/** Counter mode, the packet iv being the 16 byte counter block */
+	CRYPTO_CIPHER_MODE_CTR,
+	/** Counter with CBC-MAC, the packet iv being the nonce. Encryption
+	 * appends the tag to the ciphertext, decryption expects it there.
+	 */
+	CRYPTO_CIPHER_MODE_CCM,
+};
+
+enum cipher_op {
+	CRYPTO_CIPHER_OP_ENCRYPT,
+	CRYPTO_CIPHER_OP_DECRYPT,
+};
+
+/**
+ * @typedef cipher_completion_cb
+ * @brief Completion callback of an asynchronous cipher operation
+ *
+ * Called from the interrupt of the engine, or from the caller context
+ * with drivers without CRYPTO_CAP_ASYNC_OPS.
+ *
+ * @param pkt Packet which was processed.
+ * @param status 0 on success, -EBADMSG if a CCM tag did not match, or
+ * another negative errno code.
+ */
+typedef void (*cipher_completion_cb)(struct cipher_pkt *pkt, int status);
+
+/**
+ * @brief Cipher session
+ *
+ * Filled by the caller, except for the driver fields, before
+ * cipher_begin_session().
+ */
+struct cipher_ctx {
+	/** AES-128 key, kept by the caller for the whole session */
+	const uint8_t *key;
+	/** Key length in bytes, 16 */
+	uint16_t keylen;
+	/** CCM tag length in bytes, 4 to 16 and even */
+	uint16_t tag_len;
+	/** CCM nonce length in bytes, 7 to 13, drivers may only support 13 */
+	uint16_t nonce_len;
+	enum cipher_mode mode;
+	enum cipher_op op;
+	/** Makes the operations asynchronous, NULL for synchronous ones */
+	cipher_completion_cb cb;
+
+	/** Device of the session, set by cipher_begin_session() */
+	struct device *device;
+	/** Driver state of the session */
+	void *drv_sessn_state;
+};
+
+/**
+ * @brief Cipher operation
+ *
+ * The packet is owned by the driver until the operation completes, which
+ * for asynchronous sessions is when the completion callback is called.
+ */
+struct cipher_pkt {
+	/** Input data, followed by the tag when decrypting with CCM */
+	const uint8_t *in_buf;
+	int in_len;
+	/** Output buffer, it may be the input buffer */
+	uint8_t *out_buf;
+	int out_buf_max;
+	/** Number of bytes written to out_buf, set by the driver */
+	int out_len;
+	/** CTR counter block, whose last 4 bytes are a big endian counter
+	 * incremented for each block, a last partial one included, so the
+	 * next packet continues the stream. CCM nonce.
+	 */
+	uint8_t *iv;
+	/** CCM associated data, authenticated but not ciphered */
+	const uint8_t *ad;
+	int ad_len;
+	/** Free for the caller, for the completion callback */
+	void *user_data;
+
+	/** Session of the operation, set by cipher_op() */
+	struct cipher_ctx *ctx;
+	/** Queue of the driver */
+	sys_snode_t node;
+};
+
+/**
+ * @brief Set up a cipher session
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param ctx Session, with the key, mode, operation and callback set.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the device does not support the mode or operation.
+ * @retval -EINVAL If the key or CCM parameters are invalid.
+ * @retval -ENOMEM If the device has no free session.
+ */
+static inline int cipher_begin_session(struct device *dev,
+				       struct cipher_ctx *ctx)
+{
+	const struct crypto_driver_api *api = dev->driver_api;
+
+	if (!api->cipher_begin_session) {
+		return -ENOTSUP;
+	}
+
+	ctx->device = dev;
+
+	return api->cipher_begin_session(dev, ctx);
+}
+
+/**
+ * @brief Release a cipher session
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param ctx Session, with no operation pending.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If operations of the session are pending.
+ */
+static inline int cipher_free_session(struct device *dev,
+				      struct cipher_ctx *ctx)
+{
+	const struct crypto_driver_api *api = dev->driver_api;
+
+	return api->cipher_free_session(dev, ctx);
+}
+
+/**
+ * @brief Cipher a packet
+ *
+ * Synchronous sessions return once the packet is ciphered, asynchronous
+ * ones once it is queued, the result being reported to the completion
+ * callback.
+ *
+ * @param ctx Session.
+ * @param pkt Packet.
+ *
+ * @retval 0 If successful, or queued.
+ * @retval -EINVAL If the lengths do not fit the mode or the output buffer.
+ * @retval -EBADMSG If a CCM tag did not match, for synchronous sessions.
+ * @retval -EBUSY If a synchronous operation found the engine busy with
+ * asynchronous ones.
+ */
+static inline int cipher_op(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	const struct crypto_driver_api *api = ctx->device->driver_api;
+
+	pkt->ctx = ctx;
+
+	return api->cipher(ctx, pkt);
+}
+
+/**
+ * @brief Cipher several packets
+ *
+ * Same as cipher_op() for each packet, but lets drivers queue them all at
+ * once: the engine then chains them without returning to the caller. The
+ * completion callback is called for each packet.
+ *
+ * @param ctx Session.
+ * @param pkts Array of packets.
+ * @param count Number of packets.
+ *
+ * @return 0 if successful, or the error of the first packet which failed,
+ * the following ones not being processed.
+ */
+static inline int cipher_batch(struct cipher_ctx *ctx, struct cipher_pkt *pkts,
+			       int count)
+{
+	const struct crypto_driver_api *api = ctx->device->driver_api;
+	int i, ret;
+
+	for (i = 0; i < count; i++) {
+		pkts[i].ctx = ctx;
+	}
+
+	if (api->cipher_batch) {
+		return api->cipher_batch(ctx, pkts, count);
+	}
+
+	for (i = 0; i < count; i++) {
+		ret = api->cipher(ctx, &pkts[i]);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRYPTO_CIPHER_H__ */
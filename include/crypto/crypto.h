@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Public crypto driver APIs
+ *
+ * A crypto device provides AES ciphers (cipher.h), hashes (hash.h) and
+ * elliptic curve operations (ecc.h), in hardware or in software. Each
+ * cipher or hash is used through a session bound to one device. Operations
+ * of a session with a completion callback are asynchronous: drivers
+ * driving an engine queue them and call the callback from its interrupt,
+ * other drivers call it before returning.
+ */
+
+#ifndef __CRYPTO_H__
+#define __CRYPTO_H__
+
+#include <device.h>
+#include <errno.h>
+#include <misc/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Crypto APIs
+ * @defgroup crypto_interface Crypto Interface
+ * @ingroup io_interfaces
+ * @{
+ */
+
+/** Operations may complete without a callback, before returning */
+#define CRYPTO_CAP_SYNC_OPS	BIT(0)
+/** Operations with a completion callback run in the background */
+#define CRYPTO_CAP_ASYNC_OPS	BIT(1)
+/** AES-128 in ECB, CTR and CCM modes, see cipher.h */
+#define CRYPTO_CAP_AES_ECB	BIT(2)
+#define CRYPTO_CAP_AES_CTR	BIT(3)
+#define CRYPTO_CAP_AES_CCM	BIT(4)
+/** AES decryption, besides encryption, in ECB mode */
+#define CRYPTO_CAP_AES_DECRYPT	BIT(5)
+/** SHA-256, see hash.h */
+#define CRYPTO_CAP_SHA256	BIT(6)
+/** P-256 key generation and Diffie-Hellman, see ecc.h */
+#define CRYPTO_CAP_ECC_P256	BIT(7)
+
+struct cipher_ctx;
+struct cipher_pkt;
+struct hash_ctx;
+struct hash_pkt;
+struct ecc_pkt;
+
+/**
+ * @cond INTERNAL_HIDDEN
+ *
+ * These are for internal use only, so skip these in
+ * public documentation.
+ */
+
+struct crypto_driver_api {
+	uint32_t (*query_hw_caps)(struct device *dev);
+
+	int (*cipher_begin_session)(struct device *dev,
+				    struct cipher_ctx *ctx);
+	int (*cipher_free_session)(struct device *dev,
+				   struct cipher_ctx *ctx);
+	int (*cipher)(struct cipher_ctx *ctx, struct cipher_pkt *pkt);
+	/* Optional, cipher_batch() calls cipher for each packet otherwise */
+	int (*cipher_batch)(struct cipher_ctx *ctx, struct cipher_pkt *pkts,
+			    int count);
+
+	int (*hash_begin_session)(struct device *dev, struct hash_ctx *ctx);
+	int (*hash_free_session)(struct device *dev, struct hash_ctx *ctx);
+	int (*hash)(struct hash_ctx *ctx, struct hash_pkt *pkt, int finish);
+
+	int (*ecc_gen_key)(struct device *dev, struct ecc_pkt *pkt);
+	int (*ecc_dh)(struct device *dev, struct ecc_pkt *pkt);
+};
+
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Query the capabilities of a crypto device
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ *
+ * @return Bitmask of the CRYPTO_CAP_* flags supported by the device.
+ */
+static inline uint32_t crypto_query_hwcaps(struct device *dev)
+{
+	const struct crypto_driver_api *api = dev->driver_api;
+
+	return api->query_hw_caps(dev);
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRYPTO_H__ */
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Elliptic curve operations of the crypto driver API
+ *
+ * Keys and secrets are on the NIST P-256 curve, in big endian byte order:
+ * public keys are X followed by Y.
+ */
+
+#ifndef __CRYPTO_ECC_H__
+#define __CRYPTO_ECC_H__
+
+#include <crypto/crypto.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup crypto_interface
+ * @{
+ */
+
+#define CRYPTO_ECC_P256_PRIVATE_KEY_SIZE	32
+#define CRYPTO_ECC_P256_PUBLIC_KEY_SIZE		64
+#define CRYPTO_ECC_P256_SECRET_SIZE		32
+
+/**
+ * @typedef ecc_completion_cb
+ * @brief Completion callback of an asynchronous elliptic curve operation
+ *
+ * @param pkt Packet which was processed.
+ * @param status 0 on success, -EINVAL for an invalid public key, or
+ * another negative errno code.
+ */
+typedef void (*ecc_completion_cb)(struct ecc_pkt *pkt, int status);
+
+struct ecc_pkt {
+	uint8_t *private_key;
+	uint8_t *public_key;
+	/** Diffie-Hellman shared secret */
+	uint8_t *secret;
+	/** Makes the operation asynchronous, NULL for a synchronous one */
+	ecc_completion_cb cb;
+	/** Free for the caller, for the completion callback */
+	void *user_data;
+};
+
+/**
+ * @brief Generate a P-256 key pair
+ *
+ * Writes private_key and public_key. Key generation takes tens to
+ * hundreds of milliseconds in software.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param pkt Packet.
+ *
+ * @retval 0 If successful, or queued.
+ * @retval -ENOTSUP If the device has no elliptic curve support.
+ * @retval -EIO If the random numbers or the computation failed.
+ */
+static inline int ecc_p256_gen_key(struct device *dev, struct ecc_pkt *pkt)
+{
+	const struct crypto_driver_api *api = dev->driver_api;
+
+	if (!api->ecc_gen_key) {
+		return -ENOTSUP;
+	}
+
+	return api->ecc_gen_key(dev, pkt);
+}
+
+/**
+ * @brief Compute a P-256 Diffie-Hellman shared secret
+ *
+ * Writes secret from the local private_key and the remote public_key.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param pkt Packet.
+ *
+ * @retval 0 If successful, or queued.
+ * @retval -ENOTSUP If the device has no elliptic curve support.
+ * @retval -EINVAL If the public key is not on the curve.
+ * @retval -EIO If the computation failed.
+ */
+static inline int ecc_p256_dh(struct device *dev, struct ecc_pkt *pkt)
+{
+	const struct crypto_driver_api *api = dev->driver_api;
+
+	if (!api->ecc_dh) {
+		return -ENOTSUP;
+	}
+
+	return api->ecc_dh(dev, pkt);
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRYPTO_ECC_H__ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Hash sessions of the crypto driver API
+ */
+
+#ifndef __CRYPTO_HASH_H__
+#define __CRYPTO_HASH_H__
+
+#include <crypto/crypto.h>
+#include <misc/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup crypto_interface
+ * @{
+ */
+
+/** SHA-256 digest size in bytes */
+#define CRYPTO_SHA256_DIGEST_SIZE	32
+
+enum hash_algo {
+	CRYPTO_HASH_ALGO_SHA256,
+};
+
+/**
+ * @typedef hash_completion_cb
+ * @brief Completion callback of an asynchronous hash operation
+ *
+ * @param pkt Packet which was processed.
+ * @param status 0 on success, or a negative errno code.
+ */
+typedef void (*hash_completion_cb)(struct hash_pkt *pkt, int status);
+
+/**
+ * @brief Hash session
+ *
+ * A session computes one digest at a time, from any number of packets.
+ */
+struct hash_ctx {
+	enum hash_algo algo;
+	/** Makes the operations asynchronous, NULL for synchronous ones */
+	hash_completion_cb cb;
+
+	/** Device of the session, set by hash_begin_session() */
+	struct device *device;
+	/** Driver state of the session */
+	void *drv_sessn_state;
+};
+
+struct hash_pkt {
+	/** Data hashed */
+	const uint8_t *in_buf;
+	int in_len;
+	/** Digest, written by hash_compute() */
+	uint8_t *out_buf;
+	/** Free for the caller, for the completion callback */
+	void *user_data;
+
+	/** Session of the operation, set by hash_update() and hash_compute() */
+	struct hash_ctx *ctx;
+	/** Queue of the driver */
+	sys_snode_t node;
+};
+
+/**
+ * @brief Set up a hash session
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param ctx Session, with the algorithm and callback set.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the device does not support the algorithm.
+ * @retval -ENOMEM If the device has no free session.
+ */
+static inline int hash_begin_session(struct device *dev, struct hash_ctx *ctx)
+{
+	const struct crypto_driver_api *api = dev->driver_api;
+
+	if (!api->hash_begin_session) {
+		return -ENOTSUP;
+	}
+
+	ctx->device = dev;
+
+	return api->hash_begin_session(dev, ctx);
+}
+
+/**
+ * @brief Release a hash session
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param ctx Session, with no operation pending.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If operations of the session are pending.
+ */
+static inline int hash_free_session(struct device *dev, struct hash_ctx *ctx)
+{
+	const struct crypto_driver_api *api = dev->driver_api;
+
+	return api->hash_free_session(dev, ctx);
+}
+
+/**
+ * @brief Add data to the digest
+ *
+ * @param ctx Session.
+ * @param pkt Packet, out_buf is not used.
+ *
+ * @return 0 if successful, or queued, or a negative errno code.
+ */
+static inline int hash_update(struct hash_ctx *ctx, struct hash_pkt *pkt)
+{
+	const struct crypto_driver_api *api = ctx->device->driver_api;
+
+	pkt->ctx = ctx;
+
+	return api->hash(ctx, pkt, 0);
+}
+
+/**
+ * @brief Add the last data and write the digest
+ *
+ * The session then starts a new digest.
+ *
+ * @param ctx Session.
+ * @param pkt Packet, in_len may be 0.
+ *
+ * @return 0 if successful, or queued, or a negative errno code.
+ */
+static inline int hash_compute(struct hash_ctx *ctx, struct hash_pkt *pkt)
+{
+	const struct crypto_driver_api *api = ctx->device->driver_api;
+
+	pkt->ctx = ctx;
+
+	return api->hash(ctx, pkt, 1);
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRYPTO_HASH_H__ */
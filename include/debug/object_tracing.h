@@ -21,8 +21,7 @@ extern struct k_mem_pool *_trace_list_k_mem_pool;
 extern struct k_sem      *_trace_list_k_sem;
 extern struct k_mutex    *_trace_list_k_mutex;
 extern struct k_alert    *_trace_list_k_alert;
-extern struct k_fifo     *_trace_list_k_fifo;
-extern struct k_lifo     *_trace_list_k_lifo;
+extern struct k_queue    *_trace_list_k_queue;
 extern struct k_stack    *_trace_list_k_stack;
 extern struct k_msgq     *_trace_list_k_msgq;
 extern struct k_mbox     *_trace_list_k_mbox;
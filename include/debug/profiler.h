@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file profiler.h
+ *  @brief Function profiler.
+ *
+ * With CONFIG_PROFILER, the code is built with -finstrument-functions and
+ * the entry and exit hooks account, for each function, the number of calls
+ * and the cycles spent in it, children included (inclusive) or not
+ * (exclusive). Cycles are measured with k_cycle_get_32() and include the
+ * time the thread was preempted.
+ *
+ * Functions are identified by address only; scripts/profiler_report.py
+ * resolves them against the System.map produced by scripts/mksysmap.
+ */
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct profiler_func {
+	/** Entry address of the function */
+	void *fn;
+	uint32_t calls;
+	uint64_t inclusive;
+	uint64_t exclusive;
+};
+
+/**
+ * @brief Get the statistics of a profiled function
+ *
+ * Functions are listed in no particular order.
+ *
+ * @param index Index of the function, from 0.
+ * @param func Filled with the statistics.
+ *
+ * @return 0 on success, -ENOENT if there is no function at that index.
+ */
+int profiler_get(unsigned int index, struct profiler_func *func);
+
+/**
+ * @brief Calls not accounted
+ *
+ * @return Number of calls not accounted because the function table or a
+ * call stack was full.
+ */
+uint32_t profiler_missed_get(void);
+
+/**
+ * @brief Start or stop accounting
+ *
+ * Accounting starts at boot when CONFIG_PROFILER_AUTOSTART is enabled.
+ * Functions running when accounting starts are accounted from their next
+ * call on.
+ *
+ * @param enable 1 to start, 0 to stop.
+ */
+void profiler_enable(int enable);
+
+/**
+ * @brief Clear the statistics
+ */
+void profiler_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROFILER_H */
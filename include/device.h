@@ -43,6 +43,7 @@ static const int _INIT_LEVEL_PRE_KERNEL_1 = 1;
 static const int _INIT_LEVEL_PRE_KERNEL_2 = 1;
 static const int _INIT_LEVEL_POST_KERNEL = 1;
 static const int _INIT_LEVEL_APPLICATION = 1;
+static const int _INIT_LEVEL_ASYNC = 1;
 
 #define _DEPRECATION_CHECK(dev_name, level) \
 	static inline void _CONCAT(_deprecation_check_, dev_name)() \
@@ -90,6 +91,12 @@ static const int _INIT_LEVEL_APPLICATION = 1;
  * \li APPLICATION: Used for application components (i.e. non-kernel components)
  * that need automatic configuration. These devices can use all services
  * provided by the kernel during configuration.
+ * \n
+ * \li ASYNC: Used for devices that can be initialized concurrently, once all
+ * other levels are done, and before main() is invoked. With
+ * CONFIG_DEVICE_INIT_ASYNC, they are initialized by the system workqueue, in
+ * an order only constrained by DEVICE_INIT_DEPENDS_ON(); otherwise, they are
+ * initialized like the APPLICATION level.
  *
  * @param prio The initialization priority of the device, relative to
  * other devices of the same initialization level. Specified as an integer
@@ -411,9 +418,64 @@ struct device {
 	struct device_config *config;
 	const void *driver_api;
 	void *driver_data;
+#ifdef CONFIG_DEVICE_INIT_PROFILING
+	/* hardware clock cycles spent in the init function */
+	uint32_t init_cycles;
+#endif
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+	/* runtime power management state, NULL if not enabled */
+	struct device_pm *pm;
+#endif
 };
 
 void _sys_device_do_config_level(int level);
+void _sys_device_do_async_level(void);
+
+/**
+ * @brief Dependency of a device initialized at the ASYNC level
+ *
+ * Created by DEVICE_INIT_DEPENDS_ON(). For the kernel's use only.
+ */
+struct device_init_dep {
+	struct device *device;
+	const char *depends_on;
+};
+
+/**
+ * @def DEVICE_INIT_DEPENDS_ON
+ *
+ * @brief Declare an initialization dependency of a device
+ *
+ * @details Device @a dev_name, which must be initialized at the ASYNC level,
+ * is not initialized before the device whose driver name is @a drv_name.
+ * Dependencies on devices of the other levels are always met, since these
+ * levels are done before the ASYNC level starts. Dependencies must not be
+ * circular.
+ *
+ * Must be used in the same file as, and after, the definition of the device.
+ *
+ * @param dev_name Device name, as passed to DEVICE_INIT().
+ * @param drv_name Name exposed to the system by the driver @a dev_name
+ * depends on, as passed to DEVICE_INIT() and device_get_binding().
+ */
+#define DEVICE_INIT_DEPENDS_ON(dev_name, drv_name) \
+	static const struct device_init_dep \
+		_CONCAT(_CONCAT(__init_dep_, dev_name), __COUNTER__) __used \
+	__attribute__((__section__(".device_init_deps"))) = { \
+		.device = DEVICE_GET(dev_name), \
+		.depends_on = drv_name, \
+	}
+
+#ifdef CONFIG_DEVICE_INIT_PROFILING
+/**
+ * @brief Print the time spent initializing each device
+ *
+ * @details Prints, for each device and SYS_INIT() function, the number of
+ * hardware clock cycles, and the equivalent in microseconds, spent in its
+ * init function, then the total for all of them.
+ */
+void device_init_profile_print(void);
+#endif
 
 /**
  * @brief Retrieve the device structure for a driver by name
@@ -423,6 +485,12 @@ void _sys_device_do_config_level(int level);
  * it can use this function to retrieve the device structure of the lower level
  * driver by the name the driver exposes to the system.
  *
+ * Passing the string the driver registered, e.g. the same DEVICE_NAME
+ * macro, avoids string comparisons. With CONFIG_DEVICE_LOOKUP_HASH, the
+ * name is looked up in a hash table rather than compared with the name of
+ * every device. Devices of the same name are found in link order, devices
+ * without driver API, e.g. whose initialization failed, are skipped.
+ *
  * @param name device name to search for.
  *
  * @return pointer to device structure; NULL if not found or cannot be used.
@@ -665,6 +733,107 @@ static inline void __deprecated
 	k_sem_give(&sync->f_sem);
 }
 
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+/**
+ * @brief Device Runtime Power Management APIs
+ * @defgroup device_runtime_pm_api Device Runtime Power Management APIs
+ * @ingroup power_management_api
+ * @{
+ */
+
+/** Do not suspend the device on the last device_pm_put() */
+#define DEVICE_PM_NO_AUTOSUSPEND (-1)
+
+/**
+ * @brief Runtime power management state of a device
+ *
+ * Provided by the driver, usually in its driver data, and only touched by
+ * the kernel once device_pm_enable() is called.
+ */
+struct device_pm {
+	struct device *dev;
+	struct device *parent;
+	sys_snode_t node;
+	struct k_mutex lock;
+	struct k_delayed_work work;
+	int32_t autosuspend_delay;
+	uint32_t usage;
+	uint8_t state;
+	/** Duration of the last resume, in microseconds */
+	uint32_t resume_latency_us;
+	/** Longest resume, in microseconds */
+	uint32_t max_resume_latency_us;
+};
+
+/**
+ * @brief Enable the runtime power management of a device
+ *
+ * Called by a driver, typically from its init function, once the device
+ * is powered up and initialized. The device is then suspended, with
+ * device_set_power_state(DEVICE_PM_SUSPEND_STATE), @a autosuspend_ms
+ * milliseconds after the last user put it, and resumed, with
+ * device_set_power_state(DEVICE_PM_ACTIVE_STATE), when a user gets it.
+ *
+ * While the device is active it holds a reference on @a parent, e.g. the
+ * bus or the clock it depends on, which must have its runtime power
+ * management enabled first.
+ *
+ * @param dev Pointer to device structure of the driver instance.
+ * @param pm Runtime power management state, owned by the kernel from now.
+ * @param parent Device this one depends on, NULL if none.
+ * @param autosuspend_ms Delay before suspending the device once unused, in
+ * milliseconds, or DEVICE_PM_NO_AUTOSUSPEND.
+ */
+void device_pm_enable(struct device *dev, struct device_pm *pm,
+		      struct device *parent, int32_t autosuspend_ms);
+
+/**
+ * @brief Get a device, resuming it if needed
+ *
+ * Called by a driver before a transfer, or by an application before
+ * using a device. The device stays active until the matching
+ * device_pm_put(). The call does nothing if the runtime power management
+ * of the device is not enabled, and must not be made from an ISR.
+ *
+ * @param dev Pointer to device structure of the driver instance.
+ *
+ * @retval 0 If the device is active.
+ * @retval Errno Negative errno code if it could not be resumed.
+ */
+int device_pm_get(struct device *dev);
+
+/**
+ * @brief Put a device
+ *
+ * Called once done with a device gotten with device_pm_get(), possibly
+ * from an ISR at the end of a transfer. The device is suspended after its
+ * autosuspend delay, unless it is gotten again meanwhile, so that a burst
+ * of transfers only pays for one resume.
+ *
+ * @param dev Pointer to device structure of the driver instance.
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If the device was not gotten.
+ */
+int device_pm_put(struct device *dev);
+
+/**
+ * @brief Get the longest resume latency of the suspended devices
+ *
+ * A wake event handled by a suspended device is delayed by its resume, on
+ * top of the exit latency of the system low power state: the low power
+ * state policy takes it into account.
+ *
+ * @return Longest measured resume latency of the devices currently
+ * suspended, in microseconds.
+ */
+uint32_t device_pm_resume_latency_get(void);
+
+/**
+ * @}
+ */
+#endif /* CONFIG_DEVICE_RUNTIME_PM */
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,7 +17,9 @@
 #ifndef _DISK_ACCESS_H_
 #define _DISK_ACCESS_H_
 
+#include <kernel.h>
 #include <stdint.h>
+#include <misc/slist.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,6 +44,154 @@ extern "C" {
 #define DISK_STATUS_NOMEDIA		0x02
 #define DISK_STATUS_WR_PROTECT		0x04
 
+struct disk_info;
+
+/**
+ * @brief Disk backend operations, see the disk_access_* routines
+ */
+struct disk_operations {
+	int (*init)(struct disk_info *disk);
+	int (*status)(struct disk_info *disk);
+	int (*read)(struct disk_info *disk, uint8_t *data_buf,
+		    uint32_t start_sector, uint32_t num_sector);
+	int (*write)(struct disk_info *disk, const uint8_t *data_buf,
+		     uint32_t start_sector, uint32_t num_sector);
+	int (*ioctl)(struct disk_info *disk, uint8_t cmd, void *buff);
+};
+
+/**
+ * @brief Disk registered by a backend
+ *
+ * The backend sets @a name and @a ops, the other fields are private.
+ */
+struct disk_info {
+	sys_snode_t node;
+	const char *name;
+	const struct disk_operations *ops;
+	/* serializes the backend calls */
+	struct k_mutex lock;
+#ifdef CONFIG_DISK_ACCESS_ASYNC
+	sys_slist_t queue;
+	struct k_work work;
+	uint32_t sector_size;
+#endif
+};
+
+/* Possible disk request types */
+#define DISK_REQUEST_READ			0
+#define DISK_REQUEST_WRITE			1
+/* Commit any cached writes, once the requests queued before are done */
+#define DISK_REQUEST_SYNC			2
+
+struct disk_request;
+
+/**
+ * @brief Disk request completion callback
+ *
+ * Called from the disk work queue once the request is done.
+ *
+ * @param req The completed request, which can be reused or freed.
+ * @param result 0 on success, negative errno code on fail.
+ */
+typedef void (*disk_request_cb_t)(struct disk_request *req, int result);
+
+/**
+ * @brief Asynchronous disk request
+ *
+ * The request belongs to the disk from its submission until its
+ * callback is called.
+ */
+struct disk_request {
+	sys_snode_t node;
+	/** DISK_REQUEST_* type */
+	uint8_t type;
+	/** Memory buffer to read to or write from */
+	uint8_t *buf;
+	/** Start disk sector */
+	uint32_t start_sector;
+	/** Number of disk sectors */
+	uint32_t num_sector;
+	/** Completion callback */
+	disk_request_cb_t cb;
+};
+
+/**
+ * @brief Register a disk
+ *
+ * @param[in] disk  Disk with its name and operations set
+ *
+ * @return 0 on success, -EEXIST if a disk has the same name
+ */
+int disk_access_register(struct disk_info *disk);
+
+/**
+ * @brief Unregister a disk
+ *
+ * @param[in] disk  Registered disk
+ *
+ * @return 0 on success, -EBUSY if requests are queued to the disk
+ */
+int disk_access_unregister(struct disk_info *disk);
+
+/**
+ * @brief Get a registered disk from its name
+ *
+ * @param[in] name  Name of the disk
+ *
+ * @return The disk, or NULL if no disk has this name
+ */
+struct disk_info *disk_access_get(const char *name);
+
+/*
+ * @brief Initialize a disk, see disk_access_init()
+ */
+int disk_access_dev_init(struct disk_info *disk);
+
+/*
+ * @brief Get the status of a disk, see disk_access_status()
+ */
+int disk_access_dev_status(struct disk_info *disk);
+
+/*
+ * @brief Read data from a disk, see disk_access_read()
+ */
+int disk_access_dev_read(struct disk_info *disk, uint8_t *data_buf,
+			 uint32_t start_sector, uint32_t num_sector);
+
+/*
+ * @brief Write data to a disk, see disk_access_write()
+ */
+int disk_access_dev_write(struct disk_info *disk, const uint8_t *data_buf,
+			  uint32_t start_sector, uint32_t num_sector);
+
+/*
+ * @brief Get/Configure the parameters of a disk, see disk_access_ioctl()
+ */
+int disk_access_dev_ioctl(struct disk_info *disk, uint8_t cmd, void *buff);
+
+#ifdef CONFIG_DISK_ACCESS_ASYNC
+/*
+ * @brief Queue a request to a disk
+ *
+ * The requests of a disk are run in order on the disk work queue. A read
+ * or write request is merged with the ones queued right after it which
+ * continue it both on the disk and in memory, so that the backend
+ * transfers them all in one call. The request callback is called once it
+ * is done, the merged requests sharing the same result.
+ *
+ * @param[in] disk  Initialized disk
+ * @param[in] req   Request, with all its fields set
+ *
+ * @return 0 if queued, negative errno code on fail
+ */
+int disk_access_dev_submit(struct disk_info *disk, struct disk_request *req);
+#endif
+
+/*
+ * The routines below access the default disk, named
+ * CONFIG_DISK_ACCESS_DEFAULT.
+ */
+
 /*
  * @brief perform any intialization
  *
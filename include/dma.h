@@ -13,6 +13,7 @@
 #ifndef _DMA_H_
 #define _DMA_H_
 
+#include <errno.h>
 #include <kernel.h>
 #include <device.h>
 
@@ -59,6 +60,17 @@ enum dma_channel_direction {
 	PERIPHERAL_TO_MEMORY
 };
 
+enum dma_transfer_type {
+	/* One block, set with dma_transfer_config() */
+	TRANSFER_TYPE_SINGLE = 0x0,
+	/* Chain of blocks, set with dma_block_config() */
+	TRANSFER_TYPE_LIST,
+	/* Chain of blocks restarted from the first one after the last one,
+	 * until the transfer is stopped
+	 */
+	TRANSFER_TYPE_CIRCULAR
+};
+
 /**
  * @brief DMA Channel Configuration.
  *
@@ -79,8 +91,14 @@ struct dma_channel_config {
 	enum dma_burst_length source_burst_length;
 	/* Number of data items written */
 	enum dma_burst_length destination_burst_length;
+	/* Single block or chain of blocks */
+	enum dma_transfer_type transfer_type;
 
-	/* Completed transaction callback */
+	/*
+	 * Completed transaction callback. Called once the last block is done
+	 * with TRANSFER_TYPE_LIST, after every block with
+	 * TRANSFER_TYPE_CIRCULAR.
+	 */
 	void (*dma_transfer)(struct device *dev, void *data);
 	/* Error callback */
 	void (*dma_error)(struct device *dev, void *data);
@@ -102,6 +120,24 @@ struct dma_transfer_config {
 	uint32_t *destination_address;
 };
 
+/**
+ * @brief DMA block Configuration.
+ *
+ * One block of a chained transfer, see TRANSFER_TYPE_LIST. The blocks
+ * are only read while configuring the transfer, they may be reused once
+ * dma_block_config() returned.
+ */
+struct dma_block_config {
+	/* Amount of data in bytes to transfer */
+	uint32_t block_size;
+	/* Source address of the block */
+	uint32_t *source_address;
+	/* Destination address of the block */
+	uint32_t *destination_address;
+	/* Next block, NULL for the last one */
+	struct dma_block_config *next_block;
+};
+
 /**
  * @cond INTERNAL_HIDDEN
  *
@@ -109,12 +145,26 @@ struct dma_transfer_config {
  * public documentation.
  */
 
+/*
+ * Whether the DMA controllers reach a memory address, which they do not in
+ * a core coupled memory without CONFIG_CCM_DMA_CAPABLE.
+ */
+#if defined(CONFIG_HAS_CCM) && !defined(CONFIG_CCM_DMA_CAPABLE)
+#define _DMA_REACHES(addr) \
+	((uint32_t)(addr) - CONFIG_CCM_BASE_ADDRESS >= CONFIG_CCM_SIZE * 1024)
+#else
+#define _DMA_REACHES(addr) 1
+#endif
+
 typedef int (*dma_api_channel_config)(struct device *dev, uint32_t channel,
 				      struct dma_channel_config *config);
 
 typedef int (*dma_api_transfer_config)(struct device *dev, uint32_t channel,
 				       struct dma_transfer_config *config);
 
+typedef int (*dma_api_block_config)(struct device *dev, uint32_t channel,
+				    struct dma_block_config *first);
+
 typedef int (*dma_api_transfer_start)(struct device *dev, uint32_t channel);
 
 typedef int (*dma_api_transfer_stop)(struct device *dev, uint32_t channel);
@@ -124,6 +174,7 @@ struct dma_driver_api {
 	dma_api_transfer_config transfer_config;
 	dma_api_transfer_start transfer_start;
 	dma_api_transfer_stop transfer_stop;
+	dma_api_block_config block_config;
 };
 /**
  * @endcond
@@ -158,6 +209,8 @@ static inline int dma_channel_config(struct device *dev, uint32_t channel,
  * selected channel
  *
  * @retval 0 If successful.
+ * @retval -EINVAL If the DMA controller cannot reach the source or the
+ * destination, in a core coupled memory.
  * @retval Negative errno code if failure.
  */
 static inline int dma_transfer_config(struct device *dev, uint32_t channel,
@@ -165,9 +218,52 @@ static inline int dma_transfer_config(struct device *dev, uint32_t channel,
 {
 	const struct dma_driver_api *api = dev->driver_api;
 
+	if (!_DMA_REACHES(config->source_address) ||
+	    !_DMA_REACHES(config->destination_address)) {
+		return -EINVAL;
+	}
+
 	return api->transfer_config(dev, channel, config);
 }
 
+/**
+ * @brief Configure a chained DMA transfer for a specific channel that has
+ * been configured with TRANSFER_TYPE_LIST or TRANSFER_TYPE_CIRCULAR.
+ *
+ * The whole chain is handed to the controller, which moves from one block
+ * to the next one by itself.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param channel Numeric identification of the channel to configure
+ * @param first First block of the chain
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the controller does not support chained transfers.
+ * @retval -ENOMEM If the chain has more blocks than the driver can hold.
+ * @retval -EINVAL If the DMA controller cannot reach the source or the
+ * destination of a block, in a core coupled memory.
+ * @retval Negative errno code if failure.
+ */
+static inline int dma_block_config(struct device *dev, uint32_t channel,
+				   struct dma_block_config *first)
+{
+	const struct dma_driver_api *api = dev->driver_api;
+	struct dma_block_config *block;
+
+	if (!api->block_config) {
+		return -ENOTSUP;
+	}
+
+	for (block = first; block; block = block->next_block) {
+		if (!_DMA_REACHES(block->source_address) ||
+		    !_DMA_REACHES(block->destination_address)) {
+			return -EINVAL;
+		}
+	}
+
+	return api->block_config(dev, channel, first);
+}
+
 /**
  * @brief Enables DMA channel and starts the transfer, the channel must be
  * configured beforehand.
@@ -203,6 +299,103 @@ static inline int dma_transfer_stop(struct device *dev, uint32_t channel)
 	return api->transfer_stop(dev, channel);
 }
 
+#ifdef CONFIG_DMA_MEMCPY
+/**
+ * @brief Memory to memory copy done callback
+ *
+ * @param status 0 on success, negative errno code if the copy failed.
+ * @param user_data Pointer given to dma_memcpy_async().
+ */
+typedef void (*dma_memcpy_callback_t)(int status, void *user_data);
+
+/**
+ * @brief Memory to memory copy service
+ *
+ * Owns one channel of a DMA controller and copies through it. Copies
+ * larger than the controller can do at once are split into chained
+ * blocks, and done in several rounds if needed.
+ */
+struct dma_memcpy {
+	struct device *dev;
+	uint32_t channel;
+	struct k_mutex lock;
+	struct k_sem done;
+	dma_memcpy_callback_t cb;
+	void *user_data;
+	uint8_t *dst;
+	const uint8_t *src;
+	size_t left;
+	int status;
+	uint8_t busy;
+	uint8_t width;
+	struct dma_block_config blocks[CONFIG_DMA_MEMCPY_BLOCKS];
+};
+
+/**
+ * @brief Initialize a memory to memory copy service
+ *
+ * @param ctx Service context.
+ * @param dev DMA controller.
+ * @param channel Channel of the controller, reserved to the service.
+ *
+ * @retval 0 If successful.
+ */
+int dma_memcpy_init(struct dma_memcpy *ctx, struct device *dev,
+		    uint32_t channel);
+
+/**
+ * @brief Start a copy, without waiting for it to be done
+ *
+ * @param ctx Service context.
+ * @param dst Destination.
+ * @param src Source.
+ * @param len Number of bytes to copy.
+ * @param cb Called from the DMA interrupt once the copy is done.
+ * @param user_data Passed to @a cb.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If a copy is ongoing.
+ * @retval Negative errno code if failure.
+ */
+int dma_memcpy_async(struct dma_memcpy *ctx, void *dst, const void *src,
+		     size_t len, dma_memcpy_callback_t cb, void *user_data);
+
+/**
+ * @brief Copy memory, waiting for the copy to be done
+ *
+ * Copies below CONFIG_DMA_MEMCPY_THRESHOLD bytes, or asked for from an
+ * interrupt, are done by the CPU. Concurrent callers are serialized.
+ *
+ * @param ctx Service context.
+ * @param dst Destination.
+ * @param src Source.
+ * @param len Number of bytes to copy.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int dma_memcpy(struct dma_memcpy *ctx, void *dst, const void *src,
+	       size_t len);
+
+#ifdef CONFIG_DMA_MEMCPY_SYS
+/**
+ * @brief Copy memory through the system wide service
+ *
+ * Meant for kernel and subsystem copies, that may be done with the
+ * scheduler locked: the caller busy waits for the controller instead of
+ * pending. Copies below CONFIG_DMA_MEMCPY_THRESHOLD bytes, asked for from
+ * an interrupt or while the service is in use are done by the CPU.
+ *
+ * @param dst Destination.
+ * @param src Source.
+ * @param len Number of bytes to copy.
+ *
+ * @return @a dst
+ */
+void *dma_memcpy_sys(void *dst, const void *src, size_t len);
+#endif /* CONFIG_DMA_MEMCPY_SYS */
+#endif /* CONFIG_DMA_MEMCPY */
+
 /**
  * @}
  */
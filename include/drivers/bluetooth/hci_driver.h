@@ -87,6 +87,20 @@ int bt_recv(struct net_buf *buf);
  */
 int bt_recv_prio(struct net_buf *buf);
 
+/**
+ * @brief Receive ACL data from the built-in controller.
+ *
+ * Used instead of bt_recv() by a controller sharing the image with the
+ * host, to hand over received ACL data without framing it as an HCI ACL
+ * packet. The buffer only holds the payload, and must be given from the
+ * context bt_recv() would have been called from.
+ *
+ * @param buf Network buffer containing the ACL payload.
+ * @param handle ACL connection handle.
+ * @param flags Packet boundary flags (BT_ACL_START or BT_ACL_CONT).
+ */
+void bt_recv_acl(struct net_buf *buf, uint16_t handle, uint8_t flags);
+
 /** Possible values for the 'bus' member of the bt_hci_driver struct */
 enum bt_hci_driver_bus {
 	BT_HCI_DRIVER_BUS_VIRTUAL       = 0,
@@ -153,6 +167,59 @@ struct bt_hci_driver {
  */
 int bt_hci_driver_register(struct bt_hci_driver *drv);
 
+/**
+ * @brief P-256 backend for the HCI ECC emulation.
+ *
+ * With CONFIG_BLUETOOTH_TINYCRYPT_ECC the LE Read Local P-256 Public Key
+ * and LE Generate DHKey commands are handled in the host, with TinyCrypt
+ * unless another backend, e.g. a hardware accelerator, is registered.
+ * Keys are in the HCI format: little endian, the public key being X
+ * followed by Y. The private key is only handed back to the same backend,
+ * which may thus store a key handle in it instead.
+ */
+struct bt_hci_ecc_driver {
+	/** Name of the backend */
+	const char *name;
+
+	/**
+	 * @brief Generate a P-256 key pair.
+	 *
+	 * Called from the ECC thread.
+	 *
+	 * @param public_key Buffer for the public key.
+	 * @param private_key Buffer for the private key.
+	 *
+	 * @return 0 on success or negative error number on failure.
+	 */
+	int (*key_gen)(uint8_t public_key[64], uint8_t private_key[32]);
+
+	/**
+	 * @brief Compute the DH key with a remote public key.
+	 *
+	 * Called from the ECC thread.
+	 *
+	 * @param public_key Remote public key, to be validated.
+	 * @param private_key Local private key, from key_gen().
+	 * @param dhkey Buffer for the DH key.
+	 *
+	 * @return 0 on success, -EINVAL if the remote public key is not a
+	 *         valid P-256 point or another negative error number.
+	 */
+	int (*dh_key)(const uint8_t public_key[64],
+		      const uint8_t private_key[32], uint8_t dhkey[32]);
+};
+
+/**
+ * @brief Register a P-256 backend for the HCI ECC emulation.
+ *
+ * This needs to be called before bt_enable().
+ *
+ * @param drv A bt_hci_ecc_driver struct representing the backend.
+ *
+ * @return 0 on success or negative error number on failure.
+ */
+int bt_hci_ecc_driver_register(const struct bt_hci_ecc_driver *drv);
+
 #ifdef __cplusplus
 }
 #endif
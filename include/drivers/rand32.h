@@ -21,6 +21,7 @@
 #define __INCrand32h
 
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,6 +29,19 @@ extern "C" {
 
 extern uint32_t sys_rand32_get(void);
 
+#ifdef CONFIG_RANDOM_CTR_DRBG
+/**
+ * @brief Fill a buffer with random numbers
+ *
+ * Output of the CTR-DRBG seeded from the entropy driver, without waiting
+ * for the hardware: it can be called from interrupts.
+ *
+ * @param dst Buffer.
+ * @param len Length of the buffer.
+ */
+extern void sys_rand_get(void *dst, size_t len);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
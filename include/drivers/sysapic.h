@@ -27,6 +27,15 @@ void __irq_controller_irq_config(unsigned int vector, unsigned int irq,
 
 int __irq_controller_isr_vector_get(void);
 
+static inline void __irq_controller_eoi(void)
+{
+#if CONFIG_EOI_FORWARDING_BUG
+	_lakemont_eoi();
+#else
+	*(volatile int *)(CONFIG_LOAPIC_BASE_ADDRESS + LOAPIC_EOI) = 0;
+#endif
+}
+
 #else /* _ASMLANGUAGE */
 
 #if CONFIG_EOI_FORWARDING_BUG
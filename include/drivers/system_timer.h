@@ -40,6 +40,28 @@ extern void _timer_idle_enter(int32_t ticks);
 extern void _timer_idle_exit(void);
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * In tickless kernel mode, the timer driver does not interrupt periodically:
+ * it signals only the events the kernel programs with _set_time(),
+ * announcing every tick elapsed since the previous announcement at once.
+ *
+ * _set_time() programs the timer to interrupt 'time' ticks after the last
+ * announced tick, or as soon as possible if that is already in the past. A
+ * value of 0 means there is no event to signal: the driver then interrupts
+ * only as needed to keep track of time, e.g. before its counter wraps around.
+ * It can also interrupt sooner than requested if the hardware cannot
+ * represent the delay, announcing the ticks elapsed so far.
+ *
+ * _get_elapsed_program_time() returns the number of whole ticks elapsed
+ * since the last announced tick.
+ *
+ * Both are called with interrupts locked.
+ */
+extern void _set_time(uint32_t time);
+extern uint32_t _get_elapsed_program_time(void);
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 extern void _nano_sys_clock_tick_announce(int32_t ticks);
 
 extern int sys_clock_device_ctrl(struct device *device,
@@ -19,10 +19,12 @@
  * @{
  */
 
+#include <errno.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <sys/types.h>
 #include <device.h>
+#include <misc/slist.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,11 +37,48 @@ typedef int (*flash_api_write)(struct device *dev, off_t offset,
 typedef int (*flash_api_erase)(struct device *dev, off_t offset, size_t size);
 typedef int (*flash_api_write_protection)(struct device *dev, bool enable);
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+/**
+ * @brief Run of consecutive erase pages of the same size
+ */
+struct flash_pages_layout {
+	/** Offset of the first page, as passed to flash_erase() */
+	off_t start;
+	/** Number of pages */
+	size_t pages_count;
+	/** Size of a page in bytes */
+	size_t pages_size;
+};
+
+/**
+ * @brief Erase page information
+ */
+struct flash_pages_info {
+	/** Offset of the page, as passed to flash_erase() */
+	off_t start_offset;
+	/** Size of the page in bytes */
+	size_t size;
+	/** Index of the page, counted across the whole layout */
+	uint32_t index;
+};
+
+typedef void (*flash_api_pages_layout)(struct device *dev,
+				       const struct flash_pages_layout **layout,
+				       size_t *layout_size);
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 struct flash_driver_api {
 	flash_api_read read;
 	flash_api_write write;
 	flash_api_erase erase;
 	flash_api_write_protection write_protection;
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	flash_api_pages_layout page_layout;
+#endif
+	/* Writes aligned to and multiple of this size are the most
+	 * efficient ones, or the only ones supported, 0 if not known.
+	 */
+	size_t write_block_size;
 };
 
 /**
@@ -127,6 +166,150 @@ static inline int flash_write_protection_set(struct device *dev, bool enable)
 	return api->write_protection(dev, enable);
 }
 
+/**
+ *  @brief  Get the write block size of a flash memory
+ *
+ *  Writes whose offset and length are multiples of the write block size
+ *  are done without any read-modify-write of the surrounding bytes, and
+ *  are the only ones supported by some flash drivers. Higher layers should
+ *  lay their data out, and split their bulk writes, along this size.
+ *
+ *  @param  dev             : flash device
+ *
+ *  @return  write block size in bytes, 1 if the driver has no constraint.
+ */
+static inline size_t flash_get_write_block_size(struct device *dev)
+{
+	const struct flash_driver_api *api = dev->driver_api;
+
+	return api->write_block_size ? api->write_block_size : 1;
+}
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+/**
+ *  @brief  Get the erase page layout of a flash memory
+ *
+ *  The layout is an array of runs of same size pages, sorted by offset.
+ *
+ *  @param  dev             : flash device
+ *  @param  layout          : set to the layout array of the driver
+ *  @param  layout_size     : set to the number of entries of the array
+ *
+ *  @return  0 on success, -ENOTSUP if the driver doesn't report its layout.
+ */
+static inline int flash_page_layout_get(struct device *dev,
+				const struct flash_pages_layout **layout,
+				size_t *layout_size)
+{
+	const struct flash_driver_api *api = dev->driver_api;
+
+	if (!api->page_layout) {
+		return -ENOTSUP;
+	}
+
+	api->page_layout(dev, layout, layout_size);
+
+	return 0;
+}
+
+/**
+ *  @brief  Get the erase page containing an offset
+ *
+ *  @param  dev             : flash device
+ *  @param  offset          : offset within the page
+ *  @param  info            : page information
+ *
+ *  @return  0 on success, -EINVAL if the offset isn't within the flash.
+ */
+int flash_get_page_info_by_offs(struct device *dev, off_t offset,
+				struct flash_pages_info *info);
+
+/**
+ *  @brief  Get an erase page by index
+ *
+ *  @param  dev             : flash device
+ *  @param  index           : index of the page
+ *  @param  info            : page information
+ *
+ *  @return  0 on success, -EINVAL if there is no such page.
+ */
+int flash_get_page_info_by_idx(struct device *dev, uint32_t index,
+			       struct flash_pages_info *info);
+
+/**
+ *  @brief  Get the total number of erase pages of a flash memory
+ *
+ *  @param  dev             : flash device
+ *
+ *  @return  number of pages, 0 if the layout isn't known.
+ */
+size_t flash_get_page_count(struct device *dev);
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
+#if defined(CONFIG_FLASH_ASYNC)
+/**
+ * @typedef flash_callback_t
+ * @brief Asynchronous operation completion callback
+ *
+ * Called from the flash operation thread, it shall not block.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param status 0 if the operation succeeded, negative errno code
+ *		 otherwise.
+ * @param user_data User data of the operation.
+ */
+typedef void (*flash_callback_t)(struct device *dev, int status,
+				 void *user_data);
+
+/**
+ * @brief Flash asynchronous operation
+ *
+ * The operation belongs to the flash subsystem until its callback is
+ * called.
+ */
+struct flash_transaction {
+	sys_snode_t node;
+	/** Set when the operation is submitted */
+	struct device *dev;
+	/** Set when the operation is submitted */
+	uint8_t op;
+	off_t offset;
+	/** Data to write, unused by erases */
+	const void *data;
+	/** Number of bytes to write or erase */
+	size_t len;
+	flash_callback_t cb;
+	void *user_data;
+};
+
+/**
+ *  @brief  Queue an asynchronous write
+ *
+ *  Operations of all the flash devices are run one after the other, in
+ *  the order they were queued, by the flash operation thread. The write
+ *  protection is disabled right before the write and enabled back after
+ *  it, so flash_write_protection_set() needn't be called.
+ *
+ *  @param  dev             : flash device
+ *  @param  trans           : operation, offset, data and len being set
+ *
+ *  @return  0 if the write was queued, negative errno code on fail.
+ */
+int flash_write_async(struct device *dev, struct flash_transaction *trans);
+
+/**
+ *  @brief  Queue an asynchronous erase
+ *
+ *  Same as flash_write_async() for an erase of len bytes at offset.
+ *
+ *  @param  dev             : flash device
+ *  @param  trans           : operation, offset and len being set
+ *
+ *  @return  0 if the erase was queued, negative errno code on fail.
+ */
+int flash_erase_async(struct device *dev, struct flash_transaction *trans);
+#endif /* CONFIG_FLASH_ASYNC */
+
 #ifdef __cplusplus
 }
 #endif
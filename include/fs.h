@@ -97,16 +97,48 @@ struct fs_statvfs {
  * @{
  */
 
+/**
+ * @brief Mount a file system
+ *
+ * Makes the file system described by mp available under its mount
+ * point. Paths are resolved to the mount point with the longest
+ * matching prefix, so file systems can be mounted inside each other.
+ * The structure must stay valid until the file system is unmounted.
+ *
+ * @param mp Pointer to the mount point, with mnt_point, fs and the
+ * backend specific fields set
+ *
+ * @retval 0 Success
+ * @retval -EBUSY The mount point is already in use
+ * @retval -ERRNO errno code if error
+ */
+int fs_mount(struct fs_mount_point *mp);
+
+/**
+ * @brief Unmount a file system
+ *
+ * @param mp Pointer to the mount point given to fs_mount()
+ *
+ * @retval 0 Success
+ * @retval -EBUSY Files or directories are still open on it
+ * @retval -ERRNO errno code if error
+ */
+int fs_unmount(struct fs_mount_point *mp);
+
 /**
  * @brief File open
  *
  * Opens an existing file or create a new one and associates
  * a stream with it.
  *
+ * At most CONFIG_FILE_SYSTEM_MAX_OPEN files and directories can be open
+ * at the same time.
+ *
  * @param zfp Pointer to file object
  * @param file_name The name of file to open
  *
  * @retval 0 Success
+ * @retval -EMFILE Too many open files
  * @retval -ERRNO errno code if error
  */
 int fs_open(fs_file_t *zfp, const char *file_name);
@@ -310,12 +342,13 @@ int fs_stat(const char *path, struct fs_dirent *entry);
  *
  * Returns the total and available space in the file system volume.
  *
+ * @param path Path to any file or directory of the volume
  * @param stat Pointer to zfs_statvfs structure to receive the fs statistics
  *
  * @retval 0 Success
  * @retval -ERRNO errno code if error
  */
-int fs_statvfs(struct fs_statvfs *stat);
+int fs_statvfs(const char *path, struct fs_statvfs *stat);
 
 /**
  * @}
@@ -14,15 +14,10 @@
 extern "C" {
 #endif
 
-FS_FILE_DEFINE(FIL fp);
-FS_DIR_DEFINE(DIR dp);
-
 #define MAX_FILE_NAME 12 /* Uses 8.3 SFN */
 
-static inline off_t fs_tell(struct _fs_file_object *zfp)
-{
-	return f_tell(&zfp->fp);
-}
+/* FAT backend operations, to be used in struct fs_mount_point */
+extern const struct fs_file_system_api fat_fs_api;
 
 #ifdef __cplusplus
 }
@@ -7,43 +7,120 @@
 #ifndef _FS_INTERFACE_H_
 #define _FS_INTERFACE_H_
 
+#include <sys/types.h>
+#include <misc/slist.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef CONFIG_FILE_SYSTEM_FAT
+#include <fs/fat_fs.h>
+#endif
+
+#ifndef MAX_FILE_NAME
+#define MAX_FILE_NAME 12
+#endif
+
+struct fs_dirent;
+struct fs_statvfs;
+struct fs_mount_point;
+
 /*
- * @brief Macro to define _zfile_object structure
+ * @brief Storage of an open file in the file descriptor table
  *
- * This structure contains information about the open files. This
- * structure will be passed to the api functions as an opaque
- * pointer.
- *
- * @param _file_object File structure used by underlying file system
+ * Holds the file object of whichever backend the file belongs to.
+ * Backends keeping their own objects only store a pointer.
  */
+union fs_file_data {
+	void *ptr;
+#ifdef CONFIG_FILE_SYSTEM_FAT
+	FIL fat;
+#endif
+};
 
-#define FS_FILE_DEFINE(_file_object) \
-	struct _fs_file_object { \
-		_file_object; \
-	}
+/*
+ * @brief Storage of an open directory in the file descriptor table
+ */
+union fs_dir_data {
+	void *ptr;
+#ifdef CONFIG_FILE_SYSTEM_FAT
+	DIR fat;
+#endif
+};
 
 /*
- * @brief Macro to define _zdir_object structure
+ * @brief File system backend operations
  *
- * This structure contains information about the open directories. This
- * structure will be passed to the directory api functions as an opaque
- * pointer.
+ * Paths are given relative to the mount point, always starting with
+ * '/'. File and directory operations are given the storage of the
+ * descriptor, see union fs_file_data and union fs_dir_data. Operations
+ * a backend does not support are left NULL, -ENOTSUP is then returned.
+ */
+struct fs_file_system_api {
+	int (*mount)(struct fs_mount_point *mp);
+	int (*unmount)(struct fs_mount_point *mp);
+
+	int (*open)(struct fs_mount_point *mp, union fs_file_data *file,
+		    const char *path);
+	int (*close)(union fs_file_data *file);
+	ssize_t (*read)(union fs_file_data *file, void *ptr, size_t size);
+	ssize_t (*write)(union fs_file_data *file, const void *ptr,
+			 size_t size);
+	int (*seek)(union fs_file_data *file, off_t offset, int whence);
+	off_t (*tell)(union fs_file_data *file);
+	int (*truncate)(union fs_file_data *file, off_t length);
+	int (*sync)(union fs_file_data *file);
+
+	int (*opendir)(struct fs_mount_point *mp, union fs_dir_data *dir,
+		       const char *path);
+	int (*readdir)(union fs_dir_data *dir, struct fs_dirent *entry);
+	int (*closedir)(union fs_dir_data *dir);
+
+	int (*unlink)(struct fs_mount_point *mp, const char *path);
+	int (*mkdir)(struct fs_mount_point *mp, const char *path);
+	int (*stat)(struct fs_mount_point *mp, const char *path,
+		    struct fs_dirent *entry);
+	int (*statvfs)(struct fs_mount_point *mp, const char *path,
+		       struct fs_statvfs *stat);
+};
+
+/*
+ * @brief Mount point
  *
- * @param _dir_object Directory structure used by underlying file system
+ * @param node Entry in the list of mounted file systems, used
+ * internally
+ * @param mnt_point Absolute path the file system appears at, without a
+ * trailing '/' unless it is the root
+ * @param fs Backend operations
+ * @param fs_data Work area of the backend
+ * @param storage Storage the backend sits on, backend specific
  */
+struct fs_mount_point {
+	sys_snode_t node;
+	const char *mnt_point;
+	const struct fs_file_system_api *fs;
+	void *fs_data;
+	void *storage;
+	size_t mnt_point_len;
+};
 
-#define FS_DIR_DEFINE(_dir_object) \
-	struct _fs_dir_object { \
-		_dir_object; \
-	}
+/*
+ * @brief Open file
+ *
+ * An open file is a slot of the file descriptor table, the object
+ * passed to the api functions only refers to it.
+ */
+struct _fs_file_object {
+	int fd;
+};
 
-#ifdef CONFIG_FILE_SYSTEM_FAT
-#include <fs/fat_fs.h>
-#endif
+/*
+ * @brief Open directory, same as struct _fs_file_object
+ */
+struct _fs_dir_object {
+	int fd;
+};
 
 #ifdef __cplusplus
 }
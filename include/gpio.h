@@ -17,6 +17,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <errno.h>
 #include <device.h>
 
 /**
@@ -235,6 +236,22 @@ struct gpio_callback {
 	uint32_t pin_mask;
 };
 
+/**
+ * @brief Registers driving the output of a port directly
+ *
+ * Filled by gpio_fast_port_get(), for the code toggling pins at a rate a
+ * call through the driver does not sustain, e.g. a software SPI or a
+ * WS2812 bit stream: see gpio_fast_set() and gpio_fast_clear().
+ */
+struct gpio_fast_port {
+	/** Writing a mask drives these pins high, the others unchanged */
+	volatile uint32_t *set;
+	/** Writing a mask drives these pins low, the others unchanged */
+	volatile uint32_t *clear;
+	/** Level of the pins */
+	volatile const uint32_t *in;
+};
+
 /**
  * @cond INTERNAL_HIDDEN
  *
@@ -258,6 +275,9 @@ typedef int (*gpio_disable_callback_t)(struct device *port,
 				       int access_op,
 				       uint32_t pin);
 typedef uint32_t (*gpio_api_get_pending_int)(struct device *dev);
+typedef int (*gpio_port_bits_t)(struct device *port, uint32_t mask);
+typedef int (*gpio_fast_port_get_t)(struct device *port,
+				    struct gpio_fast_port *fast);
 
 struct gpio_driver_api {
 	gpio_config_t config;
@@ -267,6 +287,10 @@ struct gpio_driver_api {
 	gpio_enable_callback_t enable_callback;
 	gpio_disable_callback_t disable_callback;
 	gpio_api_get_pending_int get_pending_int;
+	gpio_port_bits_t port_set_bits;
+	gpio_port_bits_t port_clear_bits;
+	gpio_port_bits_t port_toggle_bits;
+	gpio_fast_port_get_t fast_port_get;
 };
 /**
  * @endcond
@@ -442,6 +466,130 @@ static inline int gpio_port_read(struct device *port, uint32_t *value)
 	return api->read(port, GPIO_ACCESS_BY_PORT, 0, value);
 }
 
+/**
+ * @brief Drive pins of the port high.
+ *
+ * The pins not in the mask are left unchanged, even when written at the
+ * same time from another context.
+ *
+ * @param port Pointer to the device structure for the driver instance.
+ * @param mask Mask of the pins to set.
+ * @return 0 if successful, -ENOTSUP if the driver does not support it.
+ */
+static inline int gpio_port_set_bits(struct device *port, uint32_t mask)
+{
+	const struct gpio_driver_api *api = port->driver_api;
+
+	if (!api->port_set_bits) {
+		return -ENOTSUP;
+	}
+
+	return api->port_set_bits(port, mask);
+}
+
+/**
+ * @brief Drive pins of the port low.
+ *
+ * The pins not in the mask are left unchanged, even when written at the
+ * same time from another context.
+ *
+ * @param port Pointer to the device structure for the driver instance.
+ * @param mask Mask of the pins to clear.
+ * @return 0 if successful, -ENOTSUP if the driver does not support it.
+ */
+static inline int gpio_port_clear_bits(struct device *port, uint32_t mask)
+{
+	const struct gpio_driver_api *api = port->driver_api;
+
+	if (!api->port_clear_bits) {
+		return -ENOTSUP;
+	}
+
+	return api->port_clear_bits(port, mask);
+}
+
+/**
+ * @brief Invert the output of pins of the port.
+ *
+ * The pins not in the mask are left unchanged, even when written at the
+ * same time from another context.
+ *
+ * @param port Pointer to the device structure for the driver instance.
+ * @param mask Mask of the pins to toggle.
+ * @return 0 if successful, -ENOTSUP if the driver does not support it.
+ */
+static inline int gpio_port_toggle_bits(struct device *port, uint32_t mask)
+{
+	const struct gpio_driver_api *api = port->driver_api;
+
+	if (!api->port_toggle_bits) {
+		return -ENOTSUP;
+	}
+
+	return api->port_toggle_bits(port, mask);
+}
+
+/**
+ * @brief Get the registers driving the port directly.
+ *
+ * Only for ports whose hardware has set and clear registers; the pins are
+ * configured through the driver beforehand.
+ *
+ * @param port Pointer to the device structure for the driver instance.
+ * @param fast Structure to fill with the register addresses.
+ * @return 0 if successful, -ENOTSUP if the driver does not support it.
+ */
+static inline int gpio_fast_port_get(struct device *port,
+				     struct gpio_fast_port *fast)
+{
+	const struct gpio_driver_api *api = port->driver_api;
+
+	if (!api->fast_port_get) {
+		return -ENOTSUP;
+	}
+
+	return api->fast_port_get(port, fast);
+}
+
+/**
+ * @brief Drive pins high through the port registers.
+ *
+ * A single store, for timing critical bit-banging.
+ *
+ * @param fast Registers of the port, from gpio_fast_port_get().
+ * @param mask Mask of the pins to set.
+ */
+static inline void gpio_fast_set(const struct gpio_fast_port *fast,
+				 uint32_t mask)
+{
+	*fast->set = mask;
+}
+
+/**
+ * @brief Drive pins low through the port registers.
+ *
+ * A single store, for timing critical bit-banging.
+ *
+ * @param fast Registers of the port, from gpio_fast_port_get().
+ * @param mask Mask of the pins to clear.
+ */
+static inline void gpio_fast_clear(const struct gpio_fast_port *fast,
+				   uint32_t mask)
+{
+	*fast->clear = mask;
+}
+
+/**
+ * @brief Read the level of the pins through the port registers.
+ *
+ * @param fast Registers of the port, from gpio_fast_port_get().
+ * @return Level of all the pins of the port.
+ */
+static inline uint32_t gpio_fast_read(const struct gpio_fast_port *fast)
+{
+	return *fast->in;
+}
+
 /**
  * @brief Enable callback(s) for the port.
  * @param port Pointer to the device structure for the driver instance.
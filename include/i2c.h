@@ -25,6 +25,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <device.h>
+#include <misc/slist.h>
 
 /*
  * The following #defines are used to configure the I2C controller.
@@ -381,6 +382,80 @@ struct i2c_client_config {
 #define I2C_GET_MASTER(_conf)		((_conf)->i2c_client.i2c_master)
 #define I2C_GET_ADDR(_conf)		((_conf)->i2c_client.i2c_addr)
 
+#if defined(CONFIG_I2C_ASYNC)
+/**
+ * @typedef i2c_callback_t
+ * @brief Asynchronous transaction completion callback
+ *
+ * Called from the I2C transaction thread, it shall not block.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param status 0 if the transaction succeeded, negative errno code
+ *		 otherwise.
+ * @param user_data User data of the transaction.
+ */
+typedef void (*i2c_callback_t)(struct device *dev, int status,
+			       void *user_data);
+
+/**
+ * @brief I2C asynchronous transaction
+ *
+ * The messages are transferred as by i2c_transfer(). The transaction
+ * belongs to the I2C subsystem until its callback is called or, for a
+ * sweep, until it is unregistered.
+ */
+struct i2c_transaction {
+	sys_snode_t node;
+	/** Set when the transaction is submitted or registered */
+	struct device *dev;
+	struct i2c_msg *msgs;
+	uint8_t num_msgs;
+	uint16_t addr;
+	i2c_callback_t cb;
+	void *user_data;
+};
+
+/**
+ * @brief Queue an asynchronous transaction.
+ *
+ * Transactions of all the buses are run one after the other, in the
+ * order they were queued, by the I2C transaction thread.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans Transaction, its callback is called once it is done.
+ *
+ * @retval 0 If the transaction was queued.
+ * @retval Negative errno code if failure.
+ */
+int i2c_transfer_async(struct device *dev, struct i2c_transaction *trans);
+
+/**
+ * @brief Register a transaction to the periodic sweep.
+ *
+ * Every CONFIG_I2C_SWEEP_PERIOD milliseconds, all the registered
+ * transactions are run back to back, their callbacks being called after
+ * each. Sensors polled at the same rate can so be read in one go rather
+ * than with one thread wakeup each.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans Transaction, run on every sweep until unregistered.
+ *
+ * @retval 0 If successful.
+ * @retval -EALREADY If the transaction is already registered.
+ */
+int i2c_sweep_register(struct device *dev, struct i2c_transaction *trans);
+
+/**
+ * @brief Unregister a transaction from the periodic sweep.
+ *
+ * Once this returns, the transaction is not run anymore. It can be
+ * called from the transaction callback.
+ *
+ * @param trans Transaction registered with i2c_sweep_register().
+ */
+void i2c_sweep_unregister(struct i2c_transaction *trans);
+#endif /* CONFIG_I2C_ASYNC */
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,6 +35,8 @@ extern "C" {
 #define _SYS_INIT_LEVEL_NANOKERNEL	6
 #define _SYS_INIT_LEVEL_MICROKERNEL	7
 
+#define _SYS_INIT_LEVEL_ASYNC		8
+
 
 /* Counter use to avoid issues if two or more system devices are declared
  * in the same C file with the same init function
@@ -0,0 +1,211 @@
+/**
+ * @file
+ * @brief Shared memory byte ring between two processors, signalled over IPM.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __INCipm_ringh
+#define __INCipm_ringh
+
+/**
+ * @brief IPM Ring Interface
+ * @defgroup ipm_ring_interface IPM Ring Interface
+ * @ingroup io_interfaces
+ * @{
+ */
+
+#include <kernel.h>
+#include <device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The ring lives in memory both processors access, e.g. the shared SRAM of
+ * the Quark SE. The producer writes bytes into it and the consumer reads
+ * them in place; the mailbox only serves as a doorbell, rung when the
+ * consumer went to sleep on an empty ring. A stream of bytes thus costs one
+ * mailbox interrupt per wakeup of the consumer, however many bytes it
+ * carries.
+ *
+ * Each index is written by one side only and sits in its own cache line,
+ * written back and invalidated around each access, as are the bytes.
+ */
+#define IPM_RING_LINE_SIZE	64
+
+/**
+ * @brief Ring state in shared memory, followed by the bytes
+ */
+struct ipm_ring_shm {
+	/** Bytes written so far, only written by the producer */
+	volatile uint32_t tail;
+	uint8_t pad0[IPM_RING_LINE_SIZE - sizeof(uint32_t)];
+
+	/** Bytes read so far, only written by the consumer */
+	volatile uint32_t head;
+	/** Incremented by the consumer before waiting for a doorbell */
+	volatile uint32_t wait_seq;
+	uint8_t pad1[IPM_RING_LINE_SIZE - 2 * sizeof(uint32_t)];
+
+	uint8_t data[];
+} __aligned(IPM_RING_LINE_SIZE);
+
+/**
+ * @brief Size of the shared memory holding a ring
+ *
+ * @param size Ring size in bytes, a power of 2.
+ */
+#define IPM_RING_SHM_SIZE(size) (sizeof(struct ipm_ring_shm) + (size))
+
+/**
+ * @brief One side of a ring
+ */
+struct ipm_ring {
+	struct ipm_ring_shm *shm;
+	uint32_t size;
+	/** Mailbox channel, outbound for the producer, inbound otherwise */
+	struct device *ipm;
+	/** Producer: message ID of the doorbell, and last wait answered */
+	uint32_t id;
+	uint32_t notified_seq;
+	/** Consumer: given by the doorbell */
+	struct k_sem sem;
+};
+
+/**
+ * @brief Reset the shared state of a ring
+ *
+ * To be called once, before either side uses the ring, e.g. by the
+ * processor that starts the other one.
+ *
+ * @param shm Shared memory, of IPM_RING_SHM_SIZE() bytes.
+ */
+void ipm_ring_shm_init(struct ipm_ring_shm *shm);
+
+/**
+ * @brief Set up the producer side of a ring
+ *
+ * @param ring Producer side.
+ * @param shm Shared memory, of IPM_RING_SHM_SIZE(size) bytes.
+ * @param size Ring size in bytes, a power of 2.
+ * @param ipm Outbound mailbox channel to the consumer.
+ * @param id Message ID of the doorbell.
+ *
+ * @retval 0 On success.
+ * @retval -EINVAL If the size is not a power of 2.
+ */
+int ipm_ring_producer_init(struct ipm_ring *ring, struct ipm_ring_shm *shm,
+			   uint32_t size, struct device *ipm, uint32_t id);
+
+/**
+ * @brief Set up the consumer side of a ring
+ *
+ * Takes over the callback of the mailbox channel, and enables it.
+ *
+ * @param ring Consumer side.
+ * @param shm Shared memory, of IPM_RING_SHM_SIZE(size) bytes.
+ * @param size Ring size in bytes, a power of 2.
+ * @param ipm Inbound mailbox channel from the producer.
+ *
+ * @retval 0 On success.
+ * @retval -EINVAL If the size is not a power of 2, or the channel is not
+ * inbound.
+ */
+int ipm_ring_consumer_init(struct ipm_ring *ring, struct ipm_ring_shm *shm,
+			   uint32_t size, struct device *ipm);
+
+/**
+ * @brief Claim a contiguous area of the ring to write to
+ *
+ * The area is the largest contiguous free area, up to @a size bytes; it
+ * may be smaller than the free space when this wraps around the end of
+ * the ring. The bytes are only visible to the consumer once committed by
+ * ipm_ring_put_finish().
+ *
+ * @param ring Producer side.
+ * @param data Area to store the address of the claimed area.
+ * @param size Maximum number of bytes to claim.
+ *
+ * @return Number of bytes claimed, 0 if the ring is full.
+ */
+uint32_t ipm_ring_put_claim(struct ipm_ring *ring, uint8_t **data,
+			    uint32_t size);
+
+/**
+ * @brief Commit bytes written to a claimed area
+ *
+ * Rings the doorbell if the consumer waits for data.
+ *
+ * @param ring Producer side.
+ * @param size Number of bytes written, at most the number claimed by the
+ * last call to ipm_ring_put_claim().
+ */
+void ipm_ring_put_finish(struct ipm_ring *ring, uint32_t size);
+
+/**
+ * @brief Write bytes to the ring
+ *
+ * Copies as many of the bytes as there is free space for, and commits
+ * them at once.
+ *
+ * @param ring Producer side.
+ * @param data Bytes to write.
+ * @param size Number of bytes to write.
+ *
+ * @return Number of bytes written.
+ */
+uint32_t ipm_ring_put(struct ipm_ring *ring, const void *data, uint32_t size);
+
+/**
+ * @brief Claim a contiguous area of the ring to read from
+ *
+ * Waits for bytes if the ring is empty.
+ *
+ * @param ring Consumer side.
+ * @param data Area to store the address of the claimed area.
+ * @param size Maximum number of bytes to claim.
+ * @param timeout Maximum time to wait, in milliseconds, or K_NO_WAIT or
+ * K_FOREVER.
+ *
+ * @return Number of bytes claimed, 0 if the timeout expired.
+ */
+uint32_t ipm_ring_get_claim(struct ipm_ring *ring, uint8_t **data,
+			    uint32_t size, int32_t timeout);
+
+/**
+ * @brief Release bytes read from a claimed area
+ *
+ * @param ring Consumer side.
+ * @param size Number of bytes read, at most the number claimed by the last
+ * call to ipm_ring_get_claim().
+ */
+void ipm_ring_get_finish(struct ipm_ring *ring, uint32_t size);
+
+/**
+ * @brief Read bytes from the ring
+ *
+ * @param ring Consumer side.
+ * @param data Area to store the bytes read.
+ * @param size Maximum number of bytes to read.
+ * @param timeout Maximum time to wait for the first byte, in milliseconds,
+ * or K_NO_WAIT or K_FOREVER.
+ *
+ * @return Number of bytes read, 0 if the timeout expired.
+ */
+uint32_t ipm_ring_get(struct ipm_ring *ring, void *data, uint32_t size,
+		      int32_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+#endif /* __INCipm_ringh */
@@ -49,6 +49,99 @@ extern "C" {
 #define IRQ_CONNECT(irq_p, priority_p, isr_p, isr_param_p, flags_p) \
 	_ARCH_IRQ_CONNECT(irq_p, priority_p, isr_p, isr_param_p, flags_p)
 
+/**
+ * @brief Initialize a 'direct' interrupt handler.
+ *
+ * This routine initializes an interrupt handler for an IRQ. The IRQ must be
+ * subsequently enabled via irq_enable() before the interrupt handler begins
+ * servicing interrupts.
+ *
+ * These ISRs are designed for performance-critical interrupt handling and do
+ * not go through common interrupt handling code: the ISR is installed
+ * directly in the interrupt vector table, where IRQ_CONNECT() installs the
+ * wrapper dispatching to the software ISR table. They must be implemented
+ * in a specific way (see ISR_DIRECT_DECLARE()) and take no parameter.
+ * Unless the ISR calls them, power management hooks and event logging are
+ * skipped, and the IRQ statistics do not account for it.
+ *
+ * On ARM, a direct ISR of an interrupt configured with IRQ_ZERO_LATENCY is
+ * not masked by irq_lock() and is unknown to the kernel: it must be a plain
+ * void function, not declared with ISR_DIRECT_DECLARE(), that calls no
+ * kernel API.
+ *
+ * @warning
+ * Although this routine is invoked at run-time, all of its arguments must be
+ * computable by the compiler at build time.
+ *
+ * @param irq_p IRQ line number.
+ * @param priority_p Interrupt priority.
+ * @param isr_p Address of interrupt service routine.
+ * @param flags_p Architecture-specific IRQ configuration flags.
+ *
+ * @return Interrupt vector assigned to this interrupt.
+ */
+#define IRQ_DIRECT_CONNECT(irq_p, priority_p, isr_p, flags_p) \
+	_ARCH_IRQ_DIRECT_CONNECT(irq_p, priority_p, isr_p, flags_p)
+
+/**
+ * @brief Common tasks before executing the body of an ISR
+ *
+ * This macro must be at the beginning of all direct interrupts and performs
+ * minimal architecture-specific tasks before the ISR itself can run. It takes
+ * no arguments and has no return value.
+ */
+#define ISR_DIRECT_HEADER() _ARCH_ISR_DIRECT_HEADER()
+
+/**
+ * @brief Common tasks before exiting the body of an ISR
+ *
+ * This macro must be at the end of all direct interrupts and performs
+ * minimal architecture-specific tasks like EOI. It has no return value.
+ *
+ * @param check_reschedule If nonzero, additionally invoke the scheduler
+ *                         and context switch to another thread if the ISR
+ *                         made one ready to run.
+ */
+#define ISR_DIRECT_FOOTER(check_reschedule) \
+	_ARCH_ISR_DIRECT_FOOTER(check_reschedule)
+
+/**
+ * @brief Perform power management idle exit logic
+ *
+ * This macro may optionally be invoked somewhere in between ISR_DIRECT_HEADER()
+ * and ISR_DIRECT_FOOTER() invocations. It performs tasks necessary to
+ * exit power management idle state. It takes no parameters and returns no
+ * arguments. It may be omitted, but be careful!
+ */
+#define ISR_DIRECT_PM() _ARCH_ISR_DIRECT_PM()
+
+/**
+ * @brief Helper macro to declare a direct interrupt service routine.
+ *
+ * This will declare the function in a proper way and automatically include
+ * the ISR_DIRECT_HEADER() and ISR_DIRECT_FOOTER() macros. The function must
+ * return an integer: nonzero if the scheduler should be invoked on exit,
+ * for instance when the ISR gave a semaphore a thread pends on.
+ *
+ * Example usage:
+ *
+ * @code
+ * ISR_DIRECT_DECLARE(my_isr)
+ * {
+ *	bool done = do_stuff();
+ *	ISR_DIRECT_PM(); // done after do_stuff() due to latency concerns
+ *	if (!done) {
+ *		return 0;  // don't bother checking if we have to _Swap()
+ *	}
+ *	k_sem_give(some_sem);
+ *	return 1;
+ * }
+ * @endcode
+ *
+ * @param name symbol name of the ISR
+ */
+#define ISR_DIRECT_DECLARE(name) _ARCH_ISR_DIRECT_DECLARE(name)
+
 /**
  * @brief Lock interrupts.
  *
@@ -131,6 +224,64 @@ extern "C" {
  */
 #define irq_is_enabled(irq) _arch_irq_is_enabled(irq)
 
+#ifdef CONFIG_IRQ_STATS
+/** Number of buckets of the interrupt statistics histograms */
+#define K_IRQ_STATS_BUCKETS 16
+
+/**
+ * @brief Interrupt statistics.
+ *
+ * Times are in hardware cycles. Bucket 0 of the histograms counts times of
+ * 0 cycles, bucket n > 0 those from 2^(n-1) to 2^n - 1 cycles, the last
+ * bucket also counting longer times.
+ *
+ * The latency is the time the interrupt entry code took before calling
+ * the ISR, including the kernel event logger and the exit of the idle
+ * state. The duration of an ISR includes the time it was preempted by
+ * nested interrupts.
+ */
+struct k_irq_stats {
+	/** IRQ line, or interrupt vector on x86. */
+	unsigned int irq;
+	/** Interrupt service routine. */
+	void *isr;
+	/** Number of interrupts. */
+	uint32_t count;
+	/** Longest latency. */
+	uint32_t max_latency;
+	/** Longest duration. */
+	uint32_t max_duration;
+	/** Cumulated duration. */
+	uint64_t total_duration;
+	/** Latency histogram. */
+	uint32_t latency[K_IRQ_STATS_BUCKETS];
+	/** Duration histogram. */
+	uint32_t duration[K_IRQ_STATS_BUCKETS];
+};
+
+/**
+ * @brief Get the statistics of an interrupt.
+ *
+ * Interrupts are given a statistics slot the first time they occur, until
+ * the CONFIG_IRQ_STATS_SLOTS slots are taken; the interrupts occurring
+ * after that are not accounted.
+ *
+ * @param index Index of the slot, from 0.
+ * @param stats Address of area to hold the statistics.
+ *
+ * @retval 0 on success.
+ * @retval -ENOENT if the slot has not been taken.
+ */
+extern int k_irq_stats_get(unsigned int index, struct k_irq_stats *stats);
+
+/**
+ * @brief Reset the interrupt statistics.
+ *
+ * @return N/A
+ */
+extern void k_irq_stats_reset(void);
+#endif /* CONFIG_IRQ_STATS */
+
 /**
  * @}
  */
@@ -96,6 +96,15 @@ typedef sys_dlist_t _wait_q_t;
 #define _OBJECT_TRACING_NEXT_PTR(type)
 #endif
 
+#ifdef CONFIG_POLL
+#define _POLL_EVENT_OBJ_INIT \
+	.poll_event = NULL,
+#define _POLL_EVENT struct k_poll_event *poll_event
+#else
+#define _POLL_EVENT_OBJ_INIT
+#define _POLL_EVENT
+#endif
+
 #define tcs k_thread
 struct k_thread;
 struct k_mutex;
@@ -104,12 +113,17 @@ struct k_alert;
 struct k_msgq;
 struct k_mbox;
 struct k_pipe;
+struct k_queue;
 struct k_fifo;
 struct k_lifo;
 struct k_stack;
 struct k_mem_slab;
 struct k_mem_pool;
 struct k_timer;
+struct k_poll_event;
+struct k_poll_signal;
+struct k_coro;
+struct k_thread_pool;
 
 typedef struct k_thread *k_tid_t;
 
@@ -189,6 +203,9 @@ typedef void (*k_thread_entry_t)(void *p1, void *p2, void *p3);
 #define K_FP_REGS (1 << 1)
 #endif
 
+/* stack does not need filling, even with CONFIG_INIT_STACKS */
+#define K_NO_STACK_FILL (1 << 2)
+
 #ifdef CONFIG_X86
 /* x86 Bitmask definitions for threads user options */
 
@@ -239,6 +256,9 @@ extern k_tid_t k_thread_spawn(char *stack, size_t stack_size,
  * This routine puts the current thread to sleep for @a duration
  * milliseconds.
  *
+ * A high-resolution timeout, e.g. K_USEC() or K_CYCLES_ABS(), can be passed
+ * instead. A deadline that is already past makes the thread yield.
+ *
  * @param duration Number of milliseconds to sleep.
  *
  * @return N/A
@@ -315,6 +335,105 @@ extern int k_thread_cancel(k_tid_t thread);
  */
 extern void k_thread_abort(k_tid_t thread);
 
+#ifdef CONFIG_THREAD_POOL
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+
+struct k_thread_pool {
+	_wait_q_t wait_q;
+	char *buffer;
+	size_t stack_size;
+	uint32_t num_stacks;
+	/* stacks at the end of the buffer that were never used */
+	uint32_t num_fresh;
+	char *free_list;
+	uint32_t num_used;
+};
+
+#define K_THREAD_POOL_INITIALIZER(obj, pool_buffer, pool_stack_size, \
+				  pool_num_stacks) \
+	{ \
+	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
+	.buffer = pool_buffer, \
+	.stack_size = pool_stack_size, \
+	.num_stacks = pool_num_stacks, \
+	.num_fresh = pool_num_stacks, \
+	.free_list = NULL, \
+	.num_used = 0, \
+	}
+
+/**
+ * INTERNAL_HIDDEN @endcond
+ */
+
+/**
+ * @brief Statically define and initialize a thread pool.
+ *
+ * The pool holds @a pool_num_stacks stacks of @a pool_stack_size bytes,
+ * which must be a multiple of the architecture's stack alignment. Define
+ * a pool for each stack size needed.
+ *
+ * The pool can be accessed outside the module where it is defined using:
+ *
+ * @code extern struct k_thread_pool <name>; @endcode
+ *
+ * @param name Name of the thread pool.
+ * @param pool_stack_size Stack size in bytes.
+ * @param pool_num_stacks Number of stacks.
+ */
+#define K_THREAD_POOL_DEFINE(name, pool_stack_size, pool_num_stacks) \
+	char __noinit __stack \
+		_k_thread_pool_buf_##name[(pool_num_stacks) * \
+					  (pool_stack_size)]; \
+	struct k_thread_pool name = \
+		K_THREAD_POOL_INITIALIZER(name, _k_thread_pool_buf_##name, \
+					  pool_stack_size, pool_num_stacks)
+
+/**
+ * @brief Spawn a thread on a stack of a thread pool.
+ *
+ * This routine takes a free stack of @a pool, waiting for one if needed,
+ * then spawns a thread on it like k_thread_spawn(). The stack goes back to
+ * the pool when the thread returns from its entry function or is aborted,
+ * cancelled included. Its thread object, at the base of the stack, must no
+ * longer be used from then on.
+ *
+ * With CONFIG_THREAD_POOL_NO_REFILL, stacks are only filled by
+ * CONFIG_INIT_STACKS the first time they are used.
+ *
+ * @param pool Thread pool.
+ * @param entry Thread entry function.
+ * @param p1 1st entry point parameter.
+ * @param p2 2nd entry point parameter.
+ * @param p3 3rd entry point parameter.
+ * @param prio Thread priority.
+ * @param options Thread options.
+ * @param delay Scheduling delay (in milliseconds), or K_NO_WAIT (for no delay).
+ * @param timeout Waiting period to take a stack (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return ID of new thread, NULL if no stack was free in time.
+ */
+extern k_tid_t k_thread_pool_spawn(struct k_thread_pool *pool,
+				   k_thread_entry_t entry,
+				   void *p1, void *p2, void *p3,
+				   int prio, uint32_t options, int32_t delay,
+				   int32_t timeout);
+
+/**
+ * @brief Get the number of stacks of a thread pool in use.
+ *
+ * @param pool Thread pool.
+ *
+ * @return Number of stacks whose thread has not exited yet.
+ */
+static inline uint32_t k_thread_pool_num_used_get(struct k_thread_pool *pool)
+{
+	return pool->num_used;
+}
+#endif /* CONFIG_THREAD_POOL */
+
 /**
  * @cond INTERNAL_HIDDEN
  */
@@ -459,6 +578,29 @@ extern int  k_thread_priority_get(k_tid_t thread);
  */
 extern void k_thread_priority_set(k_tid_t thread, int prio);
 
+#ifdef CONFIG_SCHED_DEADLINE
+/**
+ * @brief Set a thread's deadline.
+ *
+ * This routine sets the deadline of @a thread to @a deadline milliseconds
+ * from now. Among threads of the same priority, the one with the earliest
+ * deadline is scheduled first; threads without a deadline come after the
+ * ones that have one, in FIFO order. Deadlines never override priorities.
+ *
+ * The deadline is absolute once set: a periodic thread must set a new one at
+ * the start of each period. Rescheduling occurs immediately if @a thread now
+ * has an earlier deadline than the caller, at the same priority, and the
+ * caller is preemptible.
+ *
+ * @param thread ID of thread whose deadline is to be set.
+ * @param deadline Deadline (in milliseconds from now), or a negative value
+ * to remove the thread's deadline.
+ *
+ * @return N/A
+ */
+extern void k_thread_deadline_set(k_tid_t thread, int32_t deadline);
+#endif
+
 /**
  * @brief Suspend a thread.
  *
@@ -519,6 +661,64 @@ extern void k_thread_resume(k_tid_t thread);
  */
 extern void k_sched_time_slice_set(int32_t slice, int prio);
 
+/**
+ * @brief Set the time slice of a thread.
+ *
+ * This routine gives @a thread its own time slice length, overriding the
+ * one set by k_sched_time_slice_set(). A preemptible thread with its own
+ * time slice is subject to time slicing whatever its priority, and even if
+ * time slicing is otherwise disabled. Cooperative threads are never subject
+ * to time slicing.
+ *
+ * Time slices are measured in hardware cycles, but are enforced when the
+ * system clock signals an event, thus rounded up to whole ticks.
+ *
+ * @param thread ID of thread whose time slice is to be set.
+ * @param slice Maximum time slice length (in milliseconds), or zero to
+ * revert to the time slice set by k_sched_time_slice_set().
+ *
+ * @return N/A
+ */
+extern void k_thread_time_slice_set(k_tid_t thread, int32_t slice);
+
+#ifdef CONFIG_THREAD_STATS
+/**
+ * @brief Thread runtime statistics.
+ *
+ * The preemptions are the switches out that took place while the thread was
+ * still ready to run. The other switches out happened because the thread
+ * blocked, slept, suspended itself or yielded.
+ */
+struct k_thread_stats {
+	/** Hardware cycles the thread has run for. */
+	uint64_t cycles;
+	/** Number of times the thread has been switched out. */
+	uint32_t num_switches;
+	/** Number of those switches that were preemptions. */
+	uint32_t num_preemptions;
+	/** Size of the thread's stack (in bytes). */
+	size_t stack_size;
+	/** Maximum stack usage (in bytes), 0 unless INIT_STACKS is enabled. */
+	size_t stack_used;
+};
+
+/**
+ * @brief Get runtime statistics of a thread.
+ *
+ * This routine reports the runtime statistics that the kernel keeps for
+ * @a thread since it was spawned. The cycles of the current thread include
+ * its ongoing run. The maximum stack usage is found by looking for the
+ * deepest byte of the stack area that no longer holds the pattern the stack
+ * was filled with when the thread was spawned.
+ *
+ * @param thread ID of thread.
+ * @param stats Address of area to hold the statistics.
+ *
+ * @return N/A
+ */
+extern void k_thread_stats_get(k_tid_t thread, struct k_thread_stats *stats);
+#endif
+
 /**
  * @} end defgroup thread_apis
  */
@@ -692,6 +892,55 @@ extern void *k_thread_custom_data_get(void);
  */
 #define K_HOURS(h)     K_MINUTES((h) * 60)
 
+/**
+ * @brief Generate timeout delay from microseconds.
+ *
+ * This macro generates a high-resolution timeout delay that instructs a
+ * kernel API to wait up to @a us microseconds to perform the requested
+ * operation. It can be passed anywhere a millisecond timeout is accepted.
+ *
+ * The delay is still tracked by the system clock, so it is rounded up to a
+ * whole number of ticks: a tickless kernel with a high tick frequency keeps
+ * that rounding small without taking more tick interrupts.
+ *
+ * @param us Duration in microseconds, less than 2^28.
+ *
+ * @return Timeout delay value.
+ */
+#define K_USEC(us) _K_HIRES_TIMEOUT(0, us)
+
+/**
+ * @brief Generate timeout delay from hardware clock cycles.
+ *
+ * This macro generates a high-resolution timeout delay that instructs a
+ * kernel API to wait up to @a cyc hardware clock cycles, as counted by
+ * k_cycle_get_32(), to perform the requested operation.
+ *
+ * @param cyc Duration in hardware clock cycles, less than 2^28.
+ *
+ * @return Timeout delay value.
+ */
+#define K_CYCLES(cyc) _K_HIRES_TIMEOUT(_K_TIMEOUT_CYCLES, cyc)
+
+/**
+ * @brief Generate timeout deadline from the hardware clock.
+ *
+ * This macro generates a high-resolution timeout that instructs a kernel
+ * API to wait until the hardware clock reaches @a cyc, as returned by
+ * k_cycle_get_32(), to perform the requested operation. Periodic work can
+ * thus be paced on absolute deadlines that do not drift.
+ *
+ * The deadline must be less than 2^27 cycles ahead of the current time:
+ * later deadlines are considered to be already past, and expire on the
+ * next tick.
+ *
+ * @param cyc Deadline in hardware clock cycles.
+ *
+ * @return Timeout delay value.
+ */
+#define K_CYCLES_ABS(cyc) \
+	_K_HIRES_TIMEOUT(_K_TIMEOUT_CYCLES | _K_TIMEOUT_ABS, cyc)
+
 /**
  * @brief Generate infinite timeout delay.
  *
@@ -710,6 +959,21 @@ extern void *k_thread_custom_data_get(void);
  * @cond INTERNAL_HIDDEN
  */
 
+/*
+ * High-resolution timeouts live in the negative values below K_FOREVER: bit
+ * 31 flags them, bits 30 and 29 give their unit and whether they are
+ * absolute, and bits 0-27 their value. Bit 28 is always clear, so that they
+ * can never be mistaken for K_FOREVER.
+ */
+#define _K_TIMEOUT_HIRES (1U << 31)
+#define _K_TIMEOUT_CYCLES (1U << 30)
+#define _K_TIMEOUT_ABS (1U << 29)
+#define _K_TIMEOUT_VALUE_MASK ((1U << 28) - 1)
+
+#define _K_HIRES_TIMEOUT(flags, value) \
+	((int32_t)(_K_TIMEOUT_HIRES | (flags) | \
+		   ((uint32_t)(value) & _K_TIMEOUT_VALUE_MASK)))
+
 /* kernel clocks */
 
 #if	(sys_clock_ticks_per_sec == 1000) || \
@@ -738,6 +1002,18 @@ static ALWAYS_INLINE int32_t _ms_to_ticks(int32_t ms)
 }
 #endif
 
+extern int32_t _hires_timeout_to_ticks(int32_t timeout);
+
+/* convert a timeout, other than K_FOREVER, to ticks */
+static inline int32_t _timeout_to_ticks(int32_t timeout)
+{
+	if (timeout >= 0) {
+		return _ms_to_ticks(timeout);
+	}
+
+	return _hires_timeout_to_ticks(timeout);
+}
+
 /* added tick needed to account for tick in progress */
 #define _TICK_ALIGN 1
 
@@ -766,8 +1042,20 @@ struct _timeout {
 	sys_dnode_t node;
 	struct k_thread *thread;
 	sys_dlist_t *wait_q;
+	/*
+	 * With the timing wheel, only holds the duration requested when
+	 * queued, or one of _INACTIVE and _EXPIRED: deltas are not used.
+	 */
 	int32_t delta_ticks_from_prev;
 	_timeout_func_t func;
+#ifdef CONFIG_TIMEOUT_WHEEL
+	/* absolute expiry tick, in timing wheel time */
+	uint32_t expiry;
+#endif
+#ifdef CONFIG_TIMEOUT_SLACK
+	/* ticks the timeout may expire late, to share a timer event */
+	int32_t slack;
+#endif
 };
 
 extern int32_t _timeout_remaining_get(struct _timeout *timeout);
@@ -803,6 +1091,15 @@ struct k_timer {
 	/* timer status */
 	uint32_t status;
 
+	/* next expiry of an aligned timer, as an absolute tick count */
+	uint32_t deadline;
+
+	/* number of periods an aligned timer has missed */
+	uint32_t overruns;
+
+	/* non-zero if the period is aligned on absolute deadlines */
+	uint8_t aligned;
+
 	/* user-specific data, also used to support legacy features */
 	void *user_data;
 
@@ -819,6 +1116,8 @@ struct k_timer {
 	.expiry_fn = expiry, \
 	.stop_fn = stop, \
 	.status = 0, \
+	.overruns = 0, \
+	.aligned = 0, \
 	.user_data = 0, \
 	_OBJECT_TRACING_INIT \
 	}
@@ -903,6 +1202,9 @@ extern void k_timer_init(struct k_timer *timer,
  * The timer's status is reset to zero and the timer begins counting down
  * using the new duration and period values.
  *
+ * High-resolution timeouts, e.g. K_USEC(), can be passed for both values;
+ * the duration can also be an absolute deadline, e.g. K_CYCLES_ABS().
+ *
  * @param timer     Address of timer.
  * @param duration  Initial timer duration (in milliseconds).
  * @param period    Timer period (in milliseconds).
@@ -912,6 +1214,27 @@ extern void k_timer_init(struct k_timer *timer,
 extern void k_timer_start(struct k_timer *timer,
 			  int32_t duration, int32_t period);
 
+/**
+ * @brief Start a timer with a drift-free period.
+ *
+ * This routine starts a timer like k_timer_start(), except that each period
+ * is measured from the deadline of the previous expiry rather than from the
+ * time it was processed. A late timer interrupt thus does not shift the phase
+ * of the following expiries, and the timer does not drift over time.
+ *
+ * If processing the timer is so late that one or more of its deadlines have
+ * already passed, these periods are skipped: they do not increment the timer's
+ * status, but are counted as overruns, see k_timer_overruns_get().
+ *
+ * @param timer     Address of timer.
+ * @param duration  Initial timer duration (in milliseconds).
+ * @param period    Timer period (in milliseconds).
+ *
+ * @return N/A
+ */
+extern void k_timer_start_aligned(struct k_timer *timer,
+				  int32_t duration, int32_t period);
+
 /**
  * @brief Stop a timer.
  *
@@ -941,6 +1264,21 @@ extern void k_timer_stop(struct k_timer *timer);
  */
 extern uint32_t k_timer_status_get(struct k_timer *timer);
 
+/**
+ * @brief Read timer overruns.
+ *
+ * This routine reads the number of periods a timer started with
+ * k_timer_start_aligned() has missed since its overruns were last read.
+ * Timers started with k_timer_start() never record overruns.
+ *
+ * Calling this routine resets the timer's overruns to zero.
+ *
+ * @param timer     Address of timer.
+ *
+ * @return Number of missed periods.
+ */
+extern uint32_t k_timer_overruns_get(struct k_timer *timer);
+
 /**
  * @brief Synchronize thread to timer expiration.
  *
@@ -1007,6 +1345,25 @@ static inline void *k_timer_user_data_get(struct k_timer *timer)
 	return timer->user_data;
 }
 
+#ifdef CONFIG_TIMEOUT_SLACK
+/**
+ * @brief Let a timer expire late.
+ *
+ * This routine lets each expiry of @a timer be delayed by up to @a slack
+ * milliseconds, so that it expires together with other timeouts and the
+ * system wakes up less often. It applies from the next time the timer is
+ * started or restarted by its period. The periods of timers started with
+ * k_timer_start() add up the delays, those of timers started with
+ * k_timer_start_aligned() do not.
+ *
+ * @param timer Address of timer.
+ * @param slack Maximum delay of an expiry (in milliseconds), 0 for none.
+ *
+ * @return N/A
+ */
+extern void k_timer_slack_set(struct k_timer *timer, int32_t slack);
+#endif
+
 /**
  * @} end defgroup timer_apis
  */
@@ -1082,6 +1439,45 @@ extern uint32_t k_uptime_delta_32(int64_t *reftime);
  */
 extern uint32_t k_cycle_get_32(void);
 
+/**
+ * @brief Read the hardware clock (64-bit version).
+ *
+ * This routine returns the same count as k_cycle_get_32(), extended to 64
+ * bits so that it never wraps around, to timestamp events with the full
+ * resolution of the hardware clock over the whole system uptime.
+ *
+ * Timer drivers selecting CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER extend
+ * their counter themselves. Otherwise, the kernel counts the wrap-arounds
+ * of k_cycle_get_32() it observes when this routine is called and when
+ * ticks are announced, which only misses one if no tick is announced for a
+ * whole period of the 32-bit counter.
+ *
+ * @return Current hardware clock up-counter (in cycles).
+ */
+extern uint64_t k_cycle_get_64(void);
+
+/**
+ * @brief Convert hardware clock cycles to nanoseconds (64-bit version).
+ *
+ * Unlike SYS_CLOCK_HW_CYCLES_TO_NS64(), the conversion multiplies by the
+ * fixed-point duration of a cycle and involves no 64-bit division, so it is
+ * cheap enough to convert every k_cycle_get_64() timestamp.
+ *
+ * @param cycles Duration in hardware clock cycles.
+ *
+ * @return Duration in nanoseconds, truncated.
+ */
+static inline uint64_t k_cycle_to_ns_64(uint64_t cycles)
+{
+	uint32_t c_lo = (uint32_t)cycles, c_hi = (uint32_t)(cycles >> 32);
+	uint32_t m_lo = (uint32_t)_SYS_CLOCK_NS_PER_CYCLE_Q32;
+	uint32_t m_hi = (uint32_t)(_SYS_CLOCK_NS_PER_CYCLE_Q32 >> 32);
+
+	/* (cycles * nanoseconds per cycle) >> 32, four 32x32 multiplies */
+	return ((uint64_t)(c_hi * m_hi) << 32) + (uint64_t)c_hi * m_lo +
+	       (uint64_t)c_lo * m_hi + (((uint64_t)c_lo * m_lo) >> 32);
+}
+
 /**
  * @} end addtogroup clock_apis
  */
@@ -1090,17 +1486,22 @@ extern uint32_t k_cycle_get_32(void);
  * @cond INTERNAL_HIDDEN
  */
 
-struct k_fifo {
+struct k_queue {
 	_wait_q_t wait_q;
 	sys_slist_t data_q;
+	/* items appended without locking, last one first */
+	atomic_t lockless;
+	_POLL_EVENT;
 
-	_OBJECT_TRACING_NEXT_PTR(k_fifo);
+	_OBJECT_TRACING_NEXT_PTR(k_queue);
 };
 
-#define K_FIFO_INITIALIZER(obj) \
+#define K_QUEUE_INITIALIZER(obj) \
 	{ \
 	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
 	.data_q = SYS_SLIST_STATIC_INIT(&obj.data_q), \
+	.lockless = ATOMIC_INIT(0), \
+	_POLL_EVENT_OBJ_INIT \
 	_OBJECT_TRACING_INIT \
 	}
 
@@ -1109,124 +1510,193 @@ struct k_fifo {
  */
 
 /**
- * @defgroup fifo_apis Fifo APIs
+ * @defgroup queue_apis Queue APIs
  * @ingroup kernel_apis
  * @{
  */
 
 /**
- * @brief Initialize a fifo.
+ * @brief Initialize a queue.
  *
- * This routine initializes a fifo object, prior to its first use.
+ * This routine initializes a queue object, prior to its first use.
  *
- * @param fifo Address of the fifo.
+ * @param queue Address of the queue.
  *
  * @return N/A
  */
-extern void k_fifo_init(struct k_fifo *fifo);
+extern void k_queue_init(struct k_queue *queue);
 
 /**
- * @brief Add an element to a fifo.
+ * @brief Append an element to the end of a queue.
  *
- * This routine adds a data item to @a fifo. A fifo data item must be
+ * This routine appends a data item to @a queue. A queue data item must be
  * aligned on a 4-byte boundary, and the first 32 bits of the item are
  * reserved for the kernel's use.
  *
  * @note Can be called by ISRs.
  *
- * @param fifo Address of the fifo.
+ * @param queue Address of the queue.
  * @param data Address of the data item.
  *
  * @return N/A
  */
-extern void k_fifo_put(struct k_fifo *fifo, void *data);
+extern void k_queue_append(struct k_queue *queue, void *data);
 
 /**
- * @brief Atomically add a list of elements to a fifo.
+ * @brief Prepend an element to a queue.
  *
- * This routine adds a list of data items to @a fifo in one operation.
+ * This routine prepends a data item to @a queue. A queue data item must be
+ * aligned on a 4-byte boundary, and the first 32 bits of the item are
+ * reserved for the kernel's use.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param queue Address of the queue.
+ * @param data Address of the data item.
+ *
+ * @return N/A
+ */
+extern void k_queue_prepend(struct k_queue *queue, void *data);
+
+/**
+ * @brief Atomically append a list of elements to a queue.
+ *
+ * This routine adds a list of data items to @a queue in one operation.
  * The data items must be in a singly-linked list, with the first 32 bits
  * each data item pointing to the next data item; the list must be
- * NULL-terminated.
+ * NULL-terminated. Waiting threads are handed an item each, the rest is
+ * queued, with a single reschedule.
  *
  * @note Can be called by ISRs.
  *
- * @param fifo Address of the fifo.
+ * @param queue Address of the queue.
  * @param head Pointer to first node in singly-linked list.
  * @param tail Pointer to last node in singly-linked list.
  *
  * @return N/A
  */
-extern void k_fifo_put_list(struct k_fifo *fifo, void *head, void *tail);
+extern void k_queue_append_list(struct k_queue *queue, void *head,
+				void *tail);
 
 /**
- * @brief Atomically add a list of elements to a fifo.
+ * @brief Atomically add a list of elements to a queue.
  *
- * This routine adds a list of data items to @a fifo in one operation.
+ * This routine adds a list of data items to @a queue in one operation.
  * The data items must be in a singly-linked list implemented using a
  * sys_slist_t object. Upon completion, the sys_slist_t object is invalid
  * and must be re-initialized via sys_slist_init().
  *
  * @note Can be called by ISRs.
  *
- * @param fifo Address of the fifo.
+ * @param queue Address of the queue.
  * @param list Pointer to sys_slist_t object.
  *
  * @return N/A
  */
-extern void k_fifo_put_slist(struct k_fifo *fifo, sys_slist_t *list);
+extern void k_queue_merge_slist(struct k_queue *queue, sys_slist_t *list);
 
 /**
- * @brief Get an element from a fifo.
+ * @brief Append an element to a queue without locking interrupts.
  *
- * This routine removes a data item from @a fifo in a "first in, first out"
- * manner. The first 32 bits of the data item are reserved for the kernel's use.
+ * This routine appends a data item to @a queue with an atomic operation,
+ * only locking interrupts to wake up a thread waiting on the queue. It
+ * suits an ISR feeding a thread, which takes the items appended since its
+ * last call at once. These items are ordered among themselves, but not
+ * with the ones added by the other routines in the meantime.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param queue Address of the queue.
+ * @param data Address of the data item.
+ *
+ * @return N/A
+ */
+extern void k_queue_append_lockless(struct k_queue *queue, void *data);
+
+/**
+ * @brief Get an element from a queue.
+ *
+ * This routine removes the first data item from @a queue. The first 32 bits
+ * of the data item are reserved for the kernel's use.
  *
  * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
  *
- * @param fifo Address of the fifo.
+ * @param queue Address of the queue.
  * @param timeout Waiting period to obtain a data item (in milliseconds),
  *                or one of the special values K_NO_WAIT and K_FOREVER.
  *
  * @return Address of the data item if successful; NULL if returned
  * without waiting, or waiting period timed out.
  */
-extern void *k_fifo_get(struct k_fifo *fifo, int32_t timeout);
+extern void *k_queue_get(struct k_queue *queue, int32_t timeout);
 
 /**
- * @brief Statically define and initialize a fifo.
+ * @brief Get all the elements of a queue.
  *
- * The fifo can be accessed outside the module where it is defined using:
+ * This routine removes all the data items from @a queue in one operation,
+ * waiting for one if the queue is empty. They are returned as a
+ * NULL-terminated singly-linked list, the first 32 bits of each data item
+ * pointing to the next one.
  *
- * @code extern struct k_fifo <name>; @endcode
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
  *
- * @param name Name of the fifo.
+ * @param queue Address of the queue.
+ * @param timeout Waiting period to obtain a data item (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Address of the first data item if successful; NULL if returned
+ * without waiting, or waiting period timed out.
  */
-#define K_FIFO_DEFINE(name) \
-	struct k_fifo name \
-		__in_section(_k_fifo, static, name) = \
-		K_FIFO_INITIALIZER(name)
+extern void *k_queue_get_all(struct k_queue *queue, int32_t timeout);
 
 /**
- * @} end defgroup fifo_apis
+ * @brief Query a queue to see if it has data available.
+ *
+ * Note that the data might be already gone by the time this function returns
+ * if other threads are also trying to read from the queue.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param queue Address of the queue.
+ *
+ * @return Non-zero if the queue is empty.
+ * @return 0 if data is available.
  */
+static inline int k_queue_is_empty(struct k_queue *queue)
+{
+	return (int)sys_slist_is_empty(&queue->data_q) &&
+	       !atomic_get(&queue->lockless);
+}
 
 /**
- * @cond INTERNAL_HIDDEN
+ * @brief Statically define and initialize a queue.
+ *
+ * The queue can be accessed outside the module where it is defined using:
+ *
+ * @code extern struct k_queue <name>; @endcode
+ *
+ * @param name Name of the queue.
  */
+#define K_QUEUE_DEFINE(name) \
+	struct k_queue name \
+		__in_section(_k_queue, static, name) = \
+		K_QUEUE_INITIALIZER(name)
 
-struct k_lifo {
-	_wait_q_t wait_q;
-	void *list;
+/**
+ * @} end defgroup queue_apis
+ */
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
 
-	_OBJECT_TRACING_NEXT_PTR(k_lifo);
+struct k_fifo {
+	struct k_queue _queue;
 };
 
-#define K_LIFO_INITIALIZER(obj) \
+#define K_FIFO_INITIALIZER(obj) \
 	{ \
-	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
-	.list = NULL, \
-	_OBJECT_TRACING_INIT \
+	._queue = K_QUEUE_INITIALIZER(obj._queue) \
 	}
 
 /**
@@ -1234,22 +1704,200 @@ struct k_lifo {
  */
 
 /**
- * @defgroup lifo_apis Lifo APIs
+ * @defgroup fifo_apis Fifo APIs
  * @ingroup kernel_apis
  * @{
  */
 
 /**
- * @brief Initialize a lifo.
+ * @brief Initialize a fifo.
  *
- * This routine initializes a lifo object, prior to its first use.
+ * This routine initializes a fifo object, prior to its first use.
  *
- * @param lifo Address of the lifo.
+ * @param fifo Address of the fifo.
  *
  * @return N/A
  */
-extern void k_lifo_init(struct k_lifo *lifo);
-
+static inline void k_fifo_init(struct k_fifo *fifo)
+{
+	k_queue_init(&fifo->_queue);
+}
+
+/**
+ * @brief Add an element to a fifo.
+ *
+ * This routine adds a data item to @a fifo. A fifo data item must be
+ * aligned on a 4-byte boundary, and the first 32 bits of the item are
+ * reserved for the kernel's use.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param fifo Address of the fifo.
+ * @param data Address of the data item.
+ *
+ * @return N/A
+ */
+static inline void k_fifo_put(struct k_fifo *fifo, void *data)
+{
+	k_queue_append(&fifo->_queue, data);
+}
+
+/**
+ * @brief Atomically add a list of elements to a fifo.
+ *
+ * This routine adds a list of data items to @a fifo in one operation.
+ * The data items must be in a singly-linked list, with the first 32 bits
+ * each data item pointing to the next data item; the list must be
+ * NULL-terminated.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param fifo Address of the fifo.
+ * @param head Pointer to first node in singly-linked list.
+ * @param tail Pointer to last node in singly-linked list.
+ *
+ * @return N/A
+ */
+static inline void k_fifo_put_list(struct k_fifo *fifo, void *head,
+				   void *tail)
+{
+	k_queue_append_list(&fifo->_queue, head, tail);
+}
+
+/**
+ * @brief Atomically add a list of elements to a fifo.
+ *
+ * This routine adds a list of data items to @a fifo in one operation.
+ * The data items must be in a singly-linked list implemented using a
+ * sys_slist_t object. Upon completion, the sys_slist_t object is invalid
+ * and must be re-initialized via sys_slist_init().
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param fifo Address of the fifo.
+ * @param list Pointer to sys_slist_t object.
+ *
+ * @return N/A
+ */
+static inline void k_fifo_put_slist(struct k_fifo *fifo, sys_slist_t *list)
+{
+	k_queue_merge_slist(&fifo->_queue, list);
+}
+
+/**
+ * @brief Get an element from a fifo.
+ *
+ * This routine removes a data item from @a fifo in a "first in, first out"
+ * manner. The first 32 bits of the data item are reserved for the kernel's use.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param fifo Address of the fifo.
+ * @param timeout Waiting period to obtain a data item (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Address of the data item if successful; NULL if returned
+ * without waiting, or waiting period timed out.
+ */
+static inline void *k_fifo_get(struct k_fifo *fifo, int32_t timeout)
+{
+	return k_queue_get(&fifo->_queue, timeout);
+}
+
+/**
+ * @brief Get all the elements of a fifo.
+ *
+ * This routine removes all the data items from @a fifo in one operation,
+ * as a NULL-terminated singly-linked list in "first in, first out" order,
+ * see k_queue_get_all().
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param fifo Address of the fifo.
+ * @param timeout Waiting period to obtain a data item (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Address of the first data item if successful; NULL if returned
+ * without waiting, or waiting period timed out.
+ */
+static inline void *k_fifo_get_all(struct k_fifo *fifo, int32_t timeout)
+{
+	return k_queue_get_all(&fifo->_queue, timeout);
+}
+
+/**
+ * @brief Query a fifo to see if it has data available.
+ *
+ * Note that the data might be already gone by the time this function returns
+ * if other threads are also trying to read from the fifo.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param fifo Address of the fifo.
+ *
+ * @return Non-zero if the fifo is empty.
+ * @return 0 if data is available.
+ */
+static inline int k_fifo_is_empty(struct k_fifo *fifo)
+{
+	return k_queue_is_empty(&fifo->_queue);
+}
+
+/**
+ * @brief Statically define and initialize a fifo.
+ *
+ * The fifo can be accessed outside the module where it is defined using:
+ *
+ * @code extern struct k_fifo <name>; @endcode
+ *
+ * @param name Name of the fifo.
+ */
+#define K_FIFO_DEFINE(name) \
+	struct k_fifo name \
+		__in_section(_k_queue, static, name) = \
+		K_FIFO_INITIALIZER(name)
+
+/**
+ * @} end defgroup fifo_apis
+ */
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+
+struct k_lifo {
+	struct k_queue _queue;
+};
+
+#define K_LIFO_INITIALIZER(obj) \
+	{ \
+	._queue = K_QUEUE_INITIALIZER(obj._queue) \
+	}
+
+/**
+ * INTERNAL_HIDDEN @endcond
+ */
+
+/**
+ * @defgroup lifo_apis Lifo APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/**
+ * @brief Initialize a lifo.
+ *
+ * This routine initializes a lifo object, prior to its first use.
+ *
+ * @param lifo Address of the lifo.
+ *
+ * @return N/A
+ */
+static inline void k_lifo_init(struct k_lifo *lifo)
+{
+	k_queue_init(&lifo->_queue);
+}
+
 /**
  * @brief Add an element to a lifo.
  *
@@ -1264,7 +1912,10 @@ extern void k_lifo_init(struct k_lifo *lifo);
  *
  * @return N/A
  */
-extern void k_lifo_put(struct k_lifo *lifo, void *data);
+static inline void k_lifo_put(struct k_lifo *lifo, void *data)
+{
+	k_queue_prepend(&lifo->_queue, data);
+}
 
 /**
  * @brief Get an element from a lifo.
@@ -1281,7 +1932,10 @@ extern void k_lifo_put(struct k_lifo *lifo, void *data);
  * @return Address of the data item if successful; NULL if returned
  * without waiting, or waiting period timed out.
  */
-extern void *k_lifo_get(struct k_lifo *lifo, int32_t timeout);
+static inline void *k_lifo_get(struct k_lifo *lifo, int32_t timeout)
+{
+	return k_queue_get(&lifo->_queue, timeout);
+}
 
 /**
  * @brief Statically define and initialize a lifo.
@@ -1294,7 +1948,7 @@ extern void *k_lifo_get(struct k_lifo *lifo, int32_t timeout);
  */
 #define K_LIFO_DEFINE(name) \
 	struct k_lifo name \
-		__in_section(_k_lifo, static, name) = \
+		__in_section(_k_queue, static, name) = \
 		K_LIFO_INITIALIZER(name)
 
 /**
@@ -1427,6 +2081,10 @@ typedef void (*k_work_handler_t)(struct k_work *work);
 
 struct k_work_q {
 	struct k_fifo fifo;
+	/* holds order_token while no thread of an ordered pool is busy */
+	struct k_fifo order;
+	void *order_token;
+	uint32_t options;
 };
 
 enum {
@@ -1546,6 +2204,43 @@ static inline int k_work_pending(struct k_work *work)
 extern void k_work_q_start(struct k_work_q *work_q, char *stack,
 			   size_t stack_size, int prio);
 
+/* workqueue processes its work items one at a time, in submission order */
+#define K_WORK_Q_ORDERED (1 << 0)
+
+/**
+ * @brief Start a workqueue backed by a pool of threads.
+ *
+ * This routine starts workqueue @a work_q with @a num_threads work
+ * processing threads, which run forever. All the threads take work items
+ * from the workqueue's single queue: whenever a thread is idle, it picks up
+ * the next pending work item, so a work item whose handler blocks or runs
+ * for a long time only stalls the thread processing it.
+ *
+ * Unless @a options contains K_WORK_Q_ORDERED, work items may be processed
+ * concurrently and complete out of submission order, and a work item
+ * resubmitted while its handler runs may be processed again by another
+ * thread before the first invocation of its handler has returned. With
+ * K_WORK_Q_ORDERED, work items are processed one at a time, in submission
+ * order, as with k_work_q_start().
+ *
+ * The threads' stacks are carved out of @a stack, which must contain
+ * @a num_threads consecutive stacks of @a stack_size bytes each, e.g. a
+ * two-dimensional array. @a stack_size must thus be a multiple of the
+ * architecture's stack alignment.
+ *
+ * @param work_q Address of workqueue.
+ * @param stack Pointer to the work queue threads' stack space.
+ * @param stack_size Size of each work queue thread's stack (in bytes).
+ * @param num_threads Number of work queue threads.
+ * @param prio Priority of the work queue's threads.
+ * @param options Workqueue options.
+ *
+ * @return N/A
+ */
+extern void k_work_q_start_pool(struct k_work_q *work_q, char *stack,
+				size_t stack_size, int num_threads, int prio,
+				uint32_t options);
+
 /**
  * @brief Initialize a delayed work item.
  *
@@ -1560,6 +2255,24 @@ extern void k_work_q_start(struct k_work_q *work_q, char *stack,
 extern void k_delayed_work_init(struct k_delayed_work *work,
 				k_work_handler_t handler);
 
+#ifdef CONFIG_TIMEOUT_SLACK
+/**
+ * @brief Let a delayed work item be submitted late.
+ *
+ * This routine lets the countdowns of delayed work item @a work complete
+ * up to @a slack milliseconds late, so that they complete together with
+ * other timeouts and the system wakes up less often. It applies from the
+ * next time the work item is submitted.
+ *
+ * @param work Address of delayed work item.
+ * @param slack Maximum delay of the countdown (in milliseconds), 0 for none.
+ *
+ * @return N/A
+ */
+extern void k_delayed_work_slack_set(struct k_delayed_work *work,
+				     int32_t slack);
+#endif
+
 /**
  * @brief Submit a delayed work item.
  *
@@ -1706,7 +2419,10 @@ struct k_mutex {
 	struct k_thread *owner;
 	uint32_t lock_count;
 	int owner_orig_prio;
-#ifdef CONFIG_OBJECT_MONITOR
+#ifdef CONFIG_MUTEX_PRIO_CEILING
+	int ceiling;
+#endif
+#ifdef CONFIG_MUTEX_STATS
 	int num_lock_state_changes;
 	int num_conflicts;
 #endif
@@ -1714,11 +2430,17 @@ struct k_mutex {
 	_OBJECT_TRACING_NEXT_PTR(k_mutex);
 };
 
-#ifdef CONFIG_OBJECT_MONITOR
-#define _MUTEX_INIT_OBJECT_MONITOR \
+#ifdef CONFIG_MUTEX_PRIO_CEILING
+#define _MUTEX_INIT_PRIO_CEILING .ceiling = K_LOWEST_THREAD_PRIO,
+#else
+#define _MUTEX_INIT_PRIO_CEILING
+#endif
+
+#ifdef CONFIG_MUTEX_STATS
+#define _MUTEX_INIT_STATS \
 	.num_lock_state_changes = 0, .num_conflicts = 0,
 #else
-#define _MUTEX_INIT_OBJECT_MONITOR
+#define _MUTEX_INIT_STATS
 #endif
 
 #define K_MUTEX_INITIALIZER(obj) \
@@ -1727,7 +2449,8 @@ struct k_mutex {
 	.owner = NULL, \
 	.lock_count = 0, \
 	.owner_orig_prio = K_LOWEST_THREAD_PRIO, \
-	_MUTEX_INIT_OBJECT_MONITOR \
+	_MUTEX_INIT_PRIO_CEILING \
+	_MUTEX_INIT_STATS \
 	_OBJECT_TRACING_INIT \
 	}
 
@@ -1804,6 +2527,44 @@ extern int k_mutex_lock(struct k_mutex *mutex, int32_t timeout);
  */
 extern void k_mutex_unlock(struct k_mutex *mutex);
 
+#ifdef CONFIG_MUTEX_PRIO_CEILING
+/**
+ * @brief Set a mutex's priority ceiling.
+ *
+ * This routine sets the priority ceiling of @a mutex. A thread owning the
+ * mutex runs at least at the ceiling priority from the moment it locks the
+ * mutex until it unlocks it (immediate priority ceiling protocol). The ceiling
+ * should be the priority of the highest priority thread that ever locks the
+ * mutex.
+ *
+ * By default, a mutex has no ceiling. The mutex must not be locked.
+ *
+ * @param mutex Address of the mutex.
+ * @param prio Ceiling priority.
+ *
+ * @return N/A
+ */
+extern void k_mutex_ceiling_set(struct k_mutex *mutex, int prio);
+#endif
+
+#ifdef CONFIG_MUTEX_STATS
+/**
+ * @brief Get the number of times a mutex was contended.
+ *
+ * This routine returns the number of times a thread found @a mutex locked by
+ * another thread when trying to lock it, whether it then waited for it or
+ * not. It helps finding the locks that are the most contended.
+ *
+ * @param mutex Address of the mutex.
+ *
+ * @return Number of contended lock attempts.
+ */
+static inline int k_mutex_num_conflicts_get(struct k_mutex *mutex)
+{
+	return mutex->num_conflicts;
+}
+#endif
+
 /**
  * @} end defgroup mutex_apis
  */
@@ -1816,6 +2577,7 @@ struct k_sem {
 	_wait_q_t wait_q;
 	unsigned int count;
 	unsigned int limit;
+	_POLL_EVENT;
 
 	_OBJECT_TRACING_NEXT_PTR(k_sem);
 };
@@ -1825,6 +2587,7 @@ struct k_sem {
 	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
 	.count = initial_count, \
 	.limit = count_limit, \
+	_POLL_EVENT_OBJ_INIT \
 	_OBJECT_TRACING_INIT \
 	}
 
@@ -2084,6 +2847,7 @@ struct k_msgq {
 	char *read_ptr;
 	char *write_ptr;
 	uint32_t used_msgs;
+	_POLL_EVENT;
 
 	_OBJECT_TRACING_NEXT_PTR(k_msgq);
 };
@@ -2098,6 +2862,7 @@ struct k_msgq {
 	.read_ptr = q_buffer, \
 	.write_ptr = q_buffer, \
 	.used_msgs = 0, \
+	_POLL_EVENT_OBJ_INIT \
 	_OBJECT_TRACING_INIT \
 	}
 
@@ -2177,6 +2942,32 @@ extern void k_msgq_init(struct k_msgq *q, char *buffer,
  */
 extern int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout);
 
+/**
+ * @brief Send several messages to a message queue.
+ *
+ * This routine sends up to @a num_msgs consecutive messages from @a data to
+ * message queue @a q, handing them to waiting receivers first, then queuing
+ * as many as fit in the ring buffer. The whole batch is processed with
+ * interrupts locked once, and at most one context switch takes place.
+ *
+ * If no message at all can be sent, the routine waits for space to send the
+ * first one only, as k_msgq_put() would.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param q Address of the message queue.
+ * @param data Pointer to an array of @a num_msgs messages.
+ * @param num_msgs Number of messages to send.
+ * @param timeout Waiting period to send the first message (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Number of messages sent, or one of the negative values below.
+ * @retval -ENOMSG Returned without waiting or queue purged.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+extern int k_msgq_put_batch(struct k_msgq *q, void *data, uint32_t num_msgs,
+			    int32_t timeout);
+
 /**
  * @brief Receive a message from a message queue.
  *
@@ -2196,6 +2987,49 @@ extern int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout);
  */
 extern int k_msgq_get(struct k_msgq *q, void *data, int32_t timeout);
 
+/**
+ * @brief Receive several messages from a message queue.
+ *
+ * This routine receives up to @a max_msgs messages from message queue @a q
+ * in a "first in, first out" manner, storing them consecutively at @a data.
+ * Senders waiting for space have their messages queued as entries are freed.
+ * The whole batch is processed with interrupts locked once, and at most one
+ * context switch takes place.
+ *
+ * If the queue is empty, the routine waits for one message only, as
+ * k_msgq_get() would.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param q Address of the message queue.
+ * @param data Address of area to hold up to @a max_msgs messages.
+ * @param max_msgs Maximum number of messages to receive.
+ * @param timeout Waiting period to receive a message (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Number of messages received, or one of the negative values below.
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+extern int k_msgq_get_batch(struct k_msgq *q, void *data, uint32_t max_msgs,
+			    int32_t timeout);
+
+/**
+ * @brief Peek at the first message of a message queue.
+ *
+ * This routine copies the message at the head of message queue @a q to
+ * @a data without removing it from the queue. It never waits.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the message queue.
+ * @param data Address of area to hold the message.
+ *
+ * @retval 0 Message copied.
+ * @retval -ENOMSG Message queue is empty.
+ */
+extern int k_msgq_peek(struct k_msgq *q, void *data);
+
 /**
  * @brief Purge a message queue.
  *
@@ -2296,15 +3130,48 @@ struct k_mbox_msg {
 
 struct k_mbox {
 	_wait_q_t tx_msg_queue;
+#ifdef CONFIG_MBOX_TARGET_INDEX
+	/* senders to a thread, and receivers, by hash of the thread id */
+	_wait_q_t tx_target_queues[1 << CONFIG_MBOX_TARGET_INDEX_POW2];
+	_wait_q_t rx_queues[1 << CONFIG_MBOX_TARGET_INDEX_POW2];
+#else
 	_wait_q_t rx_msg_queue;
+#endif
 
 	_OBJECT_TRACING_NEXT_PTR(k_mbox);
 };
 
+#ifdef CONFIG_MBOX_TARGET_INDEX
+/* initializers of the queues q[i] to q[i + 2^n - 1] */
+#define _MBOX_QUEUES_INIT_0(q, i) SYS_DLIST_STATIC_INIT(&q[i])
+#define _MBOX_QUEUES_INIT_1(q, i) \
+	_MBOX_QUEUES_INIT_0(q, i), _MBOX_QUEUES_INIT_0(q, (i) + 1)
+#define _MBOX_QUEUES_INIT_2(q, i) \
+	_MBOX_QUEUES_INIT_1(q, i), _MBOX_QUEUES_INIT_1(q, (i) + 2)
+#define _MBOX_QUEUES_INIT_3(q, i) \
+	_MBOX_QUEUES_INIT_2(q, i), _MBOX_QUEUES_INIT_2(q, (i) + 4)
+#define _MBOX_QUEUES_INIT_4(q, i) \
+	_MBOX_QUEUES_INIT_3(q, i), _MBOX_QUEUES_INIT_3(q, (i) + 8)
+#define _MBOX_QUEUES_INIT_5(q, i) \
+	_MBOX_QUEUES_INIT_4(q, i), _MBOX_QUEUES_INIT_4(q, (i) + 16)
+#define _MBOX_QUEUES_INIT_6(q, i) \
+	_MBOX_QUEUES_INIT_5(q, i), _MBOX_QUEUES_INIT_5(q, (i) + 32)
+
+#define _MBOX_QUEUES_INIT(q) \
+	{ _CONCAT(_MBOX_QUEUES_INIT_, CONFIG_MBOX_TARGET_INDEX_POW2)(q, 0) }
+
+#define _MBOX_RX_QUEUE_INIT(obj) \
+	.tx_target_queues = _MBOX_QUEUES_INIT(obj.tx_target_queues), \
+	.rx_queues = _MBOX_QUEUES_INIT(obj.rx_queues),
+#else
+#define _MBOX_RX_QUEUE_INIT(obj) \
+	.rx_msg_queue = SYS_DLIST_STATIC_INIT(&obj.rx_msg_queue),
+#endif
+
 #define K_MBOX_INITIALIZER(obj) \
 	{ \
 	.tx_msg_queue = SYS_DLIST_STATIC_INIT(&obj.tx_msg_queue), \
-	.rx_msg_queue = SYS_DLIST_STATIC_INIT(&obj.rx_msg_queue), \
+	_MBOX_RX_QUEUE_INIT(obj) \
 	_OBJECT_TRACING_INIT \
 	}
 
@@ -2368,6 +3235,11 @@ extern int k_mbox_put(struct k_mbox *mbox, struct k_mbox_msg *tx_msg,
  * will be given when the message has been both received and completely
  * processed by the receiver.
  *
+ * Without @a sem, a message that is not in a memory pool block is handed at
+ * once to a receiver already waiting for it, if any, without using one of
+ * the CONFIG_NUM_MBOX_ASYNC_MSGS descriptors. The message data buffer must
+ * then remain valid until the receiver has retrieved it, as usual.
+ *
  * @param mbox Address of the mailbox.
  * @param tx_msg Address of the transmit message descriptor.
  * @param sem Address of a semaphore, or NULL if none is needed.
@@ -2576,21 +3448,91 @@ extern int k_pipe_get(struct k_pipe *pipe, void *data,
 		      size_t min_xfer, int32_t timeout);
 
 /**
- * @brief Write memory block to a pipe.
- *
- * This routine writes the data contained in a memory block to @a pipe.
- * Once all of the data in the block has been written to the pipe, it will
- * free the memory block @a block and give the semaphore @a sem (if specified).
- *
- * @param pipe Address of the pipe.
- * @param block Memory block containing data to send
- * @param size Number of data bytes in memory block to send
- * @param sem Semaphore to signal upon completion (else NULL)
+ * @brief Pipe buffer segment.
  *
- * @return N/A
+ * Describes one of the buffers a scatter/gather pipe operation transfers
+ * data from or to.
  */
-extern void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
-			     size_t size, struct k_sem *sem);
+struct k_pipe_iov {
+	/** Address of the buffer. */
+	void *data;
+	/** Size of the buffer (in bytes). */
+	size_t len;
+};
+
+/**
+ * @brief Write data from multiple buffers to a pipe.
+ *
+ * This routine writes the data of the @a iov_count buffers described by
+ * @a iov to @a pipe, in order, as if they were a single buffer. Data is
+ * copied once, straight from the buffers into the buffers of waiting readers
+ * first, then into the pipe's ring buffer. If the routine has to wait, the
+ * buffers are lent to the pipe and readers copy the data out of them
+ * directly, so they must not be modified until the routine returns.
+ *
+ * @param pipe Address of the pipe.
+ * @param iov Array of buffers to write the data of.
+ * @param iov_count Number of buffers in @a iov.
+ * @param bytes_written Address of area to hold the number of bytes written.
+ * @param min_xfer Minimum number of bytes to write.
+ * @param timeout Waiting period to wait for the data to be written (in
+ *                milliseconds), or one of the special values K_NO_WAIT
+ *                and K_FOREVER.
+ *
+ * @retval 0 At least @a min_xfer bytes of data were written.
+ * @retval -EIO Returned without waiting; zero data bytes were written.
+ * @retval -EAGAIN Waiting period timed out; between zero and @a min_xfer
+ *                 minus one data bytes were written.
+ */
+extern int k_pipe_put_iov(struct k_pipe *pipe, const struct k_pipe_iov *iov,
+			  int iov_count, size_t *bytes_written,
+			  size_t min_xfer, int32_t timeout);
+
+/**
+ * @brief Read data from a pipe into multiple buffers.
+ *
+ * This routine reads data from @a pipe into the @a iov_count buffers
+ * described by @a iov, in order, as if they were a single buffer. Data is
+ * copied once, from the pipe's ring buffer first, then straight from the
+ * buffers of waiting writers. If the routine has to wait, writers copy their
+ * data directly into the buffers.
+ *
+ * @param pipe Address of the pipe.
+ * @param iov Array of buffers to place the data read from pipe.
+ * @param iov_count Number of buffers in @a iov.
+ * @param bytes_read Address of area to hold the number of bytes read.
+ * @param min_xfer Minimum number of data bytes to read.
+ * @param timeout Waiting period to wait for the data to be read (in
+ *                milliseconds), or one of the special values K_NO_WAIT
+ *                and K_FOREVER.
+ *
+ * @retval 0 At least @a min_xfer bytes of data were read.
+ * @retval -EIO Returned without waiting; zero data bytes were read.
+ * @retval -EAGAIN Waiting period timed out; between zero and @a min_xfer
+ *                 minus one data bytes were read.
+ */
+extern int k_pipe_get_iov(struct k_pipe *pipe, const struct k_pipe_iov *iov,
+			  int iov_count, size_t *bytes_read,
+			  size_t min_xfer, int32_t timeout);
+
+/**
+ * @brief Write memory block to a pipe.
+ *
+ * This routine writes the data contained in a memory block to @a pipe.
+ * The block is lent to the pipe rather than copied: readers copy the data out
+ * of it directly.
+ * Once all of the data in the block has been written to the pipe, it will
+ * free the memory block @a block and give the semaphore @a sem (if specified).
+ *
+ * @param pipe Address of the pipe.
+ * @param block Memory block containing data to send
+ * @param size Number of data bytes in memory block to send
+ * @param sem Semaphore to signal upon completion (else NULL)
+ *
+ * @return N/A
+ */
+extern void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
+			     size_t size, struct k_sem *sem);
 
 /**
  * @} end defgroup pipe_apis
@@ -2605,12 +3547,37 @@ struct k_mem_slab {
 	uint32_t num_blocks;
 	size_t block_size;
 	char *buffer;
+#ifdef CONFIG_MEM_SLAB_LOCKLESS
+	/* generation counter (upper half) and index + 1 of first free block */
+	atomic_t free_list;
+	/* blocks at the start of the buffer ever allocated */
+	atomic_t num_carved;
+	atomic_t num_used;
+#else
 	char *free_list;
+	/* blocks at the start of the buffer ever allocated */
+	uint32_t num_carved;
 	uint32_t num_used;
+#endif
+#ifdef CONFIG_MEM_SLAB_STATS
+#ifdef CONFIG_MEM_SLAB_LOCKLESS
+	atomic_t max_used;
+	atomic_t num_failures;
+#else
+	uint32_t max_used;
+	uint32_t num_failures;
+#endif
+#endif
 
 	_OBJECT_TRACING_NEXT_PTR(k_mem_slab);
 };
 
+#ifdef CONFIG_MEM_SLAB_STATS
+#define _MEM_SLAB_INIT_STATS .max_used = 0, .num_failures = 0,
+#else
+#define _MEM_SLAB_INIT_STATS
+#endif
+
 #define K_MEM_SLAB_INITIALIZER(obj, slab_buffer, slab_block_size, \
 			       slab_num_blocks) \
 	{ \
@@ -2618,8 +3585,10 @@ struct k_mem_slab {
 	.num_blocks = slab_num_blocks, \
 	.block_size = slab_block_size, \
 	.buffer = slab_buffer, \
-	.free_list = NULL, \
+	.free_list = 0, \
+	.num_carved = 0, \
 	.num_used = 0, \
+	_MEM_SLAB_INIT_STATS \
 	_OBJECT_TRACING_INIT \
 	}
 
@@ -2725,7 +3694,7 @@ extern void k_mem_slab_free(struct k_mem_slab *slab, void **mem);
  */
 static inline uint32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
 {
-	return slab->num_used;
+	return (uint32_t)slab->num_used;
 }
 
 /**
@@ -2740,9 +3709,42 @@ static inline uint32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
  */
 static inline uint32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 {
-	return slab->num_blocks - slab->num_used;
+	return slab->num_blocks - (uint32_t)slab->num_used;
 }
 
+#ifdef CONFIG_MEM_SLAB_STATS
+/**
+ * @brief Get the peak number of used blocks in a memory slab.
+ *
+ * This routine gets the largest number of memory blocks that have been
+ * allocated at the same time in @a slab since it was initialized. It helps
+ * sizing the slab to what the application actually needs.
+ *
+ * @param slab Address of the memory slab.
+ *
+ * @return Peak number of allocated memory blocks.
+ */
+static inline uint32_t k_mem_slab_max_used_get(struct k_mem_slab *slab)
+{
+	return (uint32_t)slab->max_used;
+}
+
+/**
+ * @brief Get the number of failed allocations from a memory slab.
+ *
+ * This routine gets the number of calls to k_mem_slab_alloc() on @a slab
+ * that returned without a memory block, whether they waited or not.
+ *
+ * @param slab Address of the memory slab.
+ *
+ * @return Number of failed allocations.
+ */
+static inline uint32_t k_mem_slab_num_failures_get(struct k_mem_slab *slab)
+{
+	return (uint32_t)slab->num_failures;
+}
+#endif
+
 /**
  * @} end defgroup mem_slab_apis
  */
@@ -2751,6 +3753,78 @@ static inline uint32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
  * @cond INTERNAL_HIDDEN
  */
 
+#ifdef CONFIG_MEM_POOL_TLSF
+
+/*
+ * Two-level segregated fit memory pool: free blocks are kept in one list per
+ * size class. The first level splits sizes in powers of two, the second level
+ * splits each power of two in _TLSF_SL_COUNT classes. Bitmaps of non-empty
+ * lists at both levels give the smallest class that fits a request in
+ * constant time.
+ */
+#define _TLSF_ALIGN 8
+#define _TLSF_SL_SHIFT 3
+#define _TLSF_SL_COUNT (1 << _TLSF_SL_SHIFT)
+
+/* block header: previous block in memory (NULL if first) and size/flags */
+#define _TLSF_HDR_SIZE (2 * sizeof(void *))
+
+#define _TLSF_ROUND(size) (((size) + _TLSF_ALIGN - 1) & ~(_TLSF_ALIGN - 1))
+
+/* smallest block payload: must hold the free list links */
+#define _TLSF_PAYLOAD(size) max(_TLSF_ROUND(size), _TLSF_HDR_SIZE)
+
+/*
+ * Number of first level classes needed for blocks up to max_size bytes, once
+ * rounded up to the next second level class.
+ */
+#define _TLSF_MSB(x) (31 - __builtin_clz(x))
+#define _TLSF_FL_COUNT(max_size) \
+	(_TLSF_MSB(max_size) - 3 > 2 ? _TLSF_MSB(max_size) - 3 : 2)
+
+/*
+ * The buffer has room for as many minimum sized blocks, headers included, as
+ * a quad-block pool of the same parameters, and thus for as many maximum sized
+ * blocks as well.
+ */
+#define _TLSF_BUF_SIZE(min_size, max_size, n_max) \
+	((n_max) * ((max_size) / (min_size)) * \
+	 (_TLSF_PAYLOAD(min_size) + _TLSF_HDR_SIZE))
+
+struct _tlsf_block;
+
+/* Memory pool descriptor */
+struct k_mem_pool {
+	size_t max_block_size;
+	size_t min_block_size;
+	char *buf;
+	size_t buf_size;
+	uint32_t fl_count;
+	uint32_t fl_bitmap;
+	uint8_t *sl_bitmap;
+	struct _tlsf_block **free_lists;
+	_wait_q_t wait_q;
+#ifdef CONFIG_MEM_POOL_STATS
+	size_t bytes_used;
+	size_t max_bytes_used;
+	uint32_t num_failures;
+	/* number of allocated blocks per first level class */
+	uint32_t *num_used;
+#endif
+	_OBJECT_TRACING_NEXT_PTR(k_mem_pool);
+};
+
+#ifdef CONFIG_MEM_POOL_STATS
+#define _TLSF_STATS_DEFINE(name, max_size) \
+	static uint32_t _mem_pool_num_used_##name[_TLSF_FL_COUNT(max_size)];
+#define _TLSF_STATS_INIT(name) .num_used = _mem_pool_num_used_##name,
+#else
+#define _TLSF_STATS_DEFINE(name, max_size)
+#define _TLSF_STATS_INIT(name)
+#endif
+
+#else
+
 /*
  * Memory pool requires a buffer and two arrays of structures for the
  * memory block accounting:
@@ -2778,7 +3852,7 @@ struct k_mem_pool_block_set {
 	size_t block_size; /* memory block size */
 	uint32_t nr_of_entries; /* nr of quad block structures in the array */
 	struct k_mem_pool_quad_block *quad_block;
-	int count;
+	int count; /* nr of allocated blocks, if CONFIG_MEM_POOL_STATS */
 };
 
 /* Memory pool descriptor */
@@ -2790,6 +3864,11 @@ struct k_mem_pool {
 	struct k_mem_pool_block_set *block_set;
 	char *bufblock;
 	_wait_q_t wait_q;
+#ifdef CONFIG_MEM_POOL_STATS
+	size_t bytes_used;
+	size_t max_bytes_used;
+	uint32_t num_failures;
+#endif
 	_OBJECT_TRACING_NEXT_PTR(k_mem_pool);
 };
 
@@ -2799,6 +3878,19 @@ struct k_mem_pool {
 #define _SECTION_TYPE_SIGN "@"
 #endif
 
+/* fields of struct k_mem_pool following wait_q, all initialized to zero */
+#ifdef CONFIG_MEM_POOL_STATS
+#define _MEM_POOL_STATS_ASM ".int 0\n\t.int 0\n\t.int 0\n\t"
+#else
+#define _MEM_POOL_STATS_ASM
+#endif
+
+#ifdef CONFIG_OBJECT_TRACING
+#define _MEM_POOL_TRACING_ASM ".int 0\n\t"
+#else
+#define _MEM_POOL_TRACING_ASM
+#endif
+
 /*
  * Static memory pool initialization
  */
@@ -2851,6 +3943,35 @@ __asm__(".macro _build_quad_blocks n_max, name\n\t"
 	"__do_recurse _build_quad_blocks \\name \\n_max\n\t"
 	".endm\n");
 
+/*
+ * Build the quad blocks of the largest block size, initialized so that
+ * they own the whole buffer, then the others, which own no blocks since
+ * their first quad-block has a NULL memory pointer. The pool is thus ready
+ * for use without any boot time initialization.
+ * The followig global symbols need to be initialized:
+ * __memory_pool_max_block_size - maximal size of the memory block
+ * __memory_pool_min_block_size - minimal size of the memory block
+ */
+__asm__(".macro _build_quad_blocks_owning n_max, name, max_size\n\t"
+	".balign 4\n\t"
+	"_mem_pool_quad_blocks_\\name\\()_\\n_max:\n\t"
+	"__memory_pool_quad_block = 0\n\t"
+	".rept \\n_max >> 2\n\t\t"
+	/* mem_blocks */
+	".int _mem_pool_buffer_\\name + "
+	"__memory_pool_quad_block * (\\max_size) * 4\n\t\t"
+	".int 0xf\n\t\t" /* mem_status, all four blocks available */
+	"__memory_pool_quad_block = __memory_pool_quad_block + 1\n\t"
+	".endr\n\t"
+	".if \\n_max % 4\n\t\t"
+	".int _mem_pool_buffer_\\name + "
+	"(\\n_max >> 2) * (\\max_size) * 4\n\t\t"
+	/* non-existent blocks are marked as unavailable */
+	".int 0xf >> (4 - \\n_max % 4)\n\t"
+	".endif\n\t"
+	"__do_recurse _build_quad_blocks \\name \\n_max\n\t"
+	".endm\n");
+
 /*
  * Build block sets and initialize them
  * Macro initializes the k_mem_pool_block_set structure and
@@ -2894,8 +4015,11 @@ __asm__(".macro _build_mem_pool name, min_size, max_size, n_max\n\t"
 	".int __memory_pool_block_set_count\n\t" /* nr_of_block_sets */
 	".int _mem_pool_block_sets_\\name\n\t" /* block_set */
 	".int _mem_pool_buffer_\\name\n\t" /* bufblock */
-	".int 0\n\t" /* wait_q->head */
-	".int 0\n\t" /* wait_q->next */
+	"_mem_pool_wait_q_\\name:\n\t"
+	".int _mem_pool_wait_q_\\name\n\t" /* wait_q->head */
+	".int _mem_pool_wait_q_\\name\n\t" /* wait_q->tail */
+	_MEM_POOL_STATS_ASM
+	_MEM_POOL_TRACING_ASM
 	".popsection\n\t"
 	".endm\n");
 
@@ -2904,8 +4028,8 @@ __asm__(".macro _build_mem_pool name, min_size, max_size, n_max\n\t"
 		_SECTION_TYPE_SIGN "progbits\n\t");			\
 	__asm__("__memory_pool_min_block_size = " STRINGIFY(min_size) "\n\t"); \
 	__asm__("__memory_pool_max_block_size = " STRINGIFY(max_size) "\n\t"); \
-	__asm__("_build_quad_blocks " STRINGIFY(n_max) " "		\
-		STRINGIFY(name) "\n\t");				\
+	__asm__("_build_quad_blocks_owning " STRINGIFY(n_max) " "	\
+		STRINGIFY(name) " " STRINGIFY(max_size) "\n\t");	\
 	__asm__(".popsection\n\t")
 
 #define _MEMORY_POOL_BLOCK_SETS_DEFINE(name, min_size, max_size, n_max) \
@@ -2945,6 +4069,8 @@ static void __attribute__ ((used)) __k_mem_pool_quad_block_size_define(void)
 	    : "n"(sizeof(struct k_mem_pool_quad_block)));
 }
 
+#endif /* CONFIG_MEM_POOL_TLSF */
+
 /**
  * INTERNAL_HIDDEN @endcond
  */
@@ -2974,7 +4100,33 @@ static void __attribute__ ((used)) __k_mem_pool_quad_block_size_define(void)
  * @param max_size Size of the largest blocks in the pool (in bytes).
  * @param n_max Number of maximum sized blocks in the pool.
  * @param align Alignment of the pool's buffer (power of 2).
+ *
+ * @note With CONFIG_MEM_POOL_TLSF, blocks of any size up to @a max_size can
+ * be allocated, and are aligned on 8 bytes. Each block carries a two-pointer
+ * header, which the buffer is sized to accommodate.
  */
+#ifdef CONFIG_MEM_POOL_TLSF
+#define K_MEM_POOL_DEFINE(name, min_size, max_size, n_max, align)     \
+	static char __noinit __aligned(max(align, _TLSF_ALIGN))         \
+		_mem_pool_buffer_##name[_TLSF_BUF_SIZE(min_size, max_size, \
+						       n_max)];          \
+	static uint8_t _mem_pool_sl_bitmap_##name[_TLSF_FL_COUNT(max_size)]; \
+	static struct _tlsf_block *_mem_pool_free_lists_##name            \
+		[_TLSF_FL_COUNT(max_size) * _TLSF_SL_COUNT];             \
+	_TLSF_STATS_DEFINE(name, max_size)                              \
+	struct k_mem_pool name __in_section(_k_mem_pool, static, name) = { \
+		.max_block_size = max_size,                             \
+		.min_block_size = min_size,                             \
+		.buf = _mem_pool_buffer_##name,                         \
+		.buf_size = sizeof(_mem_pool_buffer_##name),            \
+		.fl_count = _TLSF_FL_COUNT(max_size),                   \
+		.sl_bitmap = _mem_pool_sl_bitmap_##name,                \
+		.free_lists = _mem_pool_free_lists_##name,              \
+		.wait_q = SYS_DLIST_STATIC_INIT(&name.wait_q),          \
+		_TLSF_STATS_INIT(name)                                  \
+		_OBJECT_TRACING_INIT                                    \
+	}
+#else
 #define K_MEM_POOL_DEFINE(name, min_size, max_size, n_max, align)     \
 	_MEMORY_POOL_QUAD_BLOCK_DEFINE(name, min_size, max_size, n_max); \
 	_MEMORY_POOL_BLOCK_SETS_DEFINE(name, min_size, max_size, n_max); \
@@ -2982,6 +4134,7 @@ static void __attribute__ ((used)) __k_mem_pool_quad_block_size_define(void)
 	__asm__("_build_mem_pool " STRINGIFY(name) " " STRINGIFY(min_size) " " \
 	       STRINGIFY(max_size) " " STRINGIFY(n_max) "\n\t");	\
 	extern struct k_mem_pool name
+#endif
 
 /**
  * @brief Allocate memory from a memory pool.
@@ -3029,6 +4182,57 @@ extern void k_mem_pool_free(struct k_mem_block *block);
  */
 extern void k_mem_pool_defrag(struct k_mem_pool *pool);
 
+#ifdef CONFIG_MEM_POOL_STATS
+/**
+ * @brief Memory pool usage statistics.
+ */
+struct k_mem_pool_stats {
+	/** Bytes in the blocks currently allocated. */
+	size_t bytes_used;
+	/** Peak value of @a bytes_used since the pool was initialized. */
+	size_t max_bytes_used;
+	/** Size of the largest free block, without defragmenting the pool. */
+	size_t largest_free_block;
+	/** Number of allocations that returned without a memory block. */
+	uint32_t num_failures;
+};
+
+/**
+ * @brief Get usage statistics of a memory pool.
+ *
+ * This routine takes a snapshot of the usage of @a pool, to help sizing it to
+ * what the application actually needs.
+ *
+ * @param pool Address of the memory pool.
+ * @param stats Pointer to the statistics to fill.
+ *
+ * @return N/A
+ */
+extern void k_mem_pool_stats_get(struct k_mem_pool *pool,
+				 struct k_mem_pool_stats *stats);
+
+/**
+ * @brief Get the occupancy of a block size class of a memory pool.
+ *
+ * This routine gets the number of allocated blocks of the size class with
+ * index @a index in @a pool. With the quad-block allocator, there is one
+ * class per block size, from the largest (index 0) to the smallest. With
+ * CONFIG_MEM_POOL_TLSF, there is one class per power of two, from the
+ * smallest (index 0) to the largest, holding the blocks that are larger than
+ * the ones of the previous class.
+ *
+ * @param pool Address of the memory pool.
+ * @param index Index of the block size class.
+ * @param block_size Set to the size of the largest block of the class.
+ * @param num_used Set to the number of allocated blocks of the class.
+ *
+ * @retval 0 Class found.
+ * @retval -EINVAL @a index is past the last class.
+ */
+extern int k_mem_pool_block_stats_get(struct k_mem_pool *pool, int index,
+				      size_t *block_size, uint32_t *num_used);
+#endif
+
 /**
  * @} end addtogroup mem_pool_apis
  */
@@ -3043,7 +4247,8 @@ extern void k_mem_pool_defrag(struct k_mem_pool *pool);
  * @brief Allocate memory from heap.
  *
  * This routine provides traditional malloc() semantics. Memory is
- * allocated from the heap memory pool.
+ * allocated from the heap memory pool, or with CONFIG_HEAP_ARENAS from the
+ * heap arena of the calling thread if it has one.
  *
  * @param size Amount of memory requested (in bytes).
  *
@@ -3051,11 +4256,24 @@ extern void k_mem_pool_defrag(struct k_mem_pool *pool);
  */
 extern void *k_malloc(size_t size);
 
+/**
+ * @brief Allocate memory from a memory pool, with malloc() semantics.
+ *
+ * This routine allocates memory from @a pool like k_malloc() does from the
+ * heap memory pool. The memory is freed with k_free().
+ *
+ * @param pool Address of the memory pool.
+ * @param size Amount of memory requested (in bytes).
+ *
+ * @return Address of the allocated memory if successful; otherwise NULL.
+ */
+extern void *k_mem_pool_malloc(struct k_mem_pool *pool, size_t size);
+
 /**
  * @brief Free memory allocated from heap.
  *
  * This routine provides traditional free() semantics. The memory being
- * returned must have been allocated from the heap memory pool.
+ * returned must have been allocated by k_malloc() or k_mem_pool_malloc().
  *
  * If @a ptr is NULL, no operation is performed.
  *
@@ -3065,10 +4283,522 @@ extern void *k_malloc(size_t size);
  */
 extern void k_free(void *ptr);
 
+#ifdef CONFIG_HEAP_ARENAS
+/**
+ * @brief Assign a heap arena to a thread.
+ *
+ * This routine makes k_malloc() allocate from @a pool when called by
+ * @a thread, instead of from the heap memory pool, so that a subsystem
+ * allocating from its own pool does not contend for the heap memory pool
+ * with the others. The threads later spawned by @a thread inherit its heap
+ * arena. k_free() returns memory to the pool it came from, whatever the
+ * heap arena of the calling thread.
+ *
+ * The usage of the heap arena can be read with k_mem_pool_stats_get().
+ *
+ * @param thread ID of thread.
+ * @param pool Address of the memory pool, or NULL for the heap memory pool.
+ *
+ * @return N/A
+ */
+extern void k_thread_heap_arena_set(k_tid_t thread, struct k_mem_pool *pool);
+
+/**
+ * @brief Get the heap arena of a thread.
+ *
+ * @param thread ID of thread.
+ *
+ * @return Address of the memory pool, or NULL for the heap memory pool.
+ */
+extern struct k_mem_pool *k_thread_heap_arena_get(k_tid_t thread);
+#endif
+
 /**
  * @} end defgroup heap_apis
  */
 
+/* polling API - PRIVATE */
+
+/* private - implementation data created as needed, per-type */
+struct _poller {
+	struct k_thread *thread;
+#ifdef CONFIG_COROUTINES
+	/* set instead of thread when a coroutine is waiting */
+	struct k_coro *coro;
+#endif
+};
+
+/* private - types bit positions */
+enum _poll_types_bits {
+	/* can be used to ignore an event */
+	_POLL_TYPE_IGNORE,
+
+	/* to be signaled by k_poll_signal() */
+	_POLL_TYPE_SIGNAL,
+
+	/* semaphore availability */
+	_POLL_TYPE_SEM_AVAILABLE,
+
+	/* fifo data availability */
+	_POLL_TYPE_FIFO_DATA_AVAILABLE,
+
+	/* message queue data availability */
+	_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+
+	_POLL_NUM_TYPES
+};
+
+#define _POLL_TYPE_BIT(type) (1 << ((type) - 1))
+
+/* private - states bit positions */
+enum _poll_states_bits {
+	/* default state when creating event */
+	_POLL_STATE_NOT_READY,
+
+	/* there was another poller already on the object */
+	_POLL_STATE_EADDRINUSE,
+
+	/* signaled by k_poll_signal() */
+	_POLL_STATE_SIGNALED,
+
+	/* semaphore is available */
+	_POLL_STATE_SEM_AVAILABLE,
+
+	/* data is available to read on fifo */
+	_POLL_STATE_FIFO_DATA_AVAILABLE,
+
+	/* data is available to read on message queue */
+	_POLL_STATE_MSGQ_DATA_AVAILABLE,
+
+	_POLL_NUM_STATES
+};
+
+#define _POLL_STATE_BIT(state) (1 << ((state) - 1))
+
+#define _POLL_EVENT_NUM_UNUSED_BITS \
+	(32 - (8 /* tag */ + _POLL_NUM_TYPES + _POLL_NUM_STATES + \
+	       1 /* modes */))
+
+#if _POLL_EVENT_NUM_UNUSED_BITS < 0
+#error overflow of 32-bit word in struct k_poll_event
+#endif
+
+/* end of polling API - PRIVATE */
+
+
+/**
+ * @defgroup poll_apis Async polling APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/* Public polling API */
+
+/* public - values for k_poll_event.type bitfield */
+#define K_POLL_TYPE_IGNORE 0
+#define K_POLL_TYPE_SIGNAL _POLL_TYPE_BIT(_POLL_TYPE_SIGNAL)
+#define K_POLL_TYPE_SEM_AVAILABLE _POLL_TYPE_BIT(_POLL_TYPE_SEM_AVAILABLE)
+#define K_POLL_TYPE_FIFO_DATA_AVAILABLE \
+	_POLL_TYPE_BIT(_POLL_TYPE_FIFO_DATA_AVAILABLE)
+#define K_POLL_TYPE_DATA_AVAILABLE K_POLL_TYPE_FIFO_DATA_AVAILABLE
+#define K_POLL_TYPE_MSGQ_DATA_AVAILABLE \
+	_POLL_TYPE_BIT(_POLL_TYPE_MSGQ_DATA_AVAILABLE)
+
+/* public - polling modes */
+enum k_poll_modes {
+	/* polling thread does not take ownership of objects when available */
+	K_POLL_MODE_NOTIFY_ONLY = 0,
+
+	K_POLL_NUM_MODES
+};
+
+/* public - values for k_poll_event.state bitfield */
+#define K_POLL_STATE_NOT_READY 0
+#define K_POLL_STATE_EADDRINUSE _POLL_STATE_BIT(_POLL_STATE_EADDRINUSE)
+#define K_POLL_STATE_SIGNALED _POLL_STATE_BIT(_POLL_STATE_SIGNALED)
+#define K_POLL_STATE_SEM_AVAILABLE _POLL_STATE_BIT(_POLL_STATE_SEM_AVAILABLE)
+#define K_POLL_STATE_FIFO_DATA_AVAILABLE \
+	_POLL_STATE_BIT(_POLL_STATE_FIFO_DATA_AVAILABLE)
+#define K_POLL_STATE_DATA_AVAILABLE K_POLL_STATE_FIFO_DATA_AVAILABLE
+#define K_POLL_STATE_MSGQ_DATA_AVAILABLE \
+	_POLL_STATE_BIT(_POLL_STATE_MSGQ_DATA_AVAILABLE)
+
+/* public - poll signal object */
+struct k_poll_signal {
+	/* PRIVATE - DO NOT TOUCH */
+	struct k_poll_event *poll_event;
+
+	/*
+	 * 1 if the event has been signaled, 0 otherwise. Stays set to 1 until
+	 * user resets it to 0.
+	 */
+	unsigned int signaled;
+
+	/* custom result value passed to k_poll_signal() if needed */
+	int result;
+};
+
+#define K_POLL_SIGNAL_INITIALIZER() \
+	{ \
+	.poll_event = NULL, \
+	.signaled = 0, \
+	.result = 0, \
+	}
+
+struct k_poll_event {
+	/* PRIVATE - DO NOT TOUCH */
+	struct _poller *poller;
+
+	/* optional user-specified tag, opaque, untouched by the API */
+	uint32_t tag:8;
+
+	/* bitfield of event types (bitwise-ORed K_POLL_TYPE_xxx values) */
+	uint32_t type:_POLL_NUM_TYPES;
+
+	/* bitfield of event states (bitwise-ORed K_POLL_STATE_xxx values) */
+	uint32_t state:_POLL_NUM_STATES;
+
+	/* mode of operation, from enum k_poll_modes */
+	uint32_t mode:1;
+
+	/* unused bits in 32-bit word */
+	uint32_t unused:_POLL_EVENT_NUM_UNUSED_BITS;
+
+	/* per-type data */
+	union {
+		void *obj;
+		struct k_poll_signal *signal;
+		struct k_sem *sem;
+		struct k_fifo *fifo;
+		struct k_queue *queue;
+		struct k_msgq *msgq;
+	};
+};
+
+#define K_POLL_EVENT_INITIALIZER(event_type, event_mode, event_data) \
+	{ \
+	.poller = NULL, \
+	.type = event_type, \
+	.state = K_POLL_STATE_NOT_READY, \
+	.mode = event_mode, \
+	.unused = 0, \
+	{ .obj = event_data }, \
+	}
+
+/**
+ * @brief Initialize one struct k_poll_event instance
+ *
+ * After this routine is called on a poll event, the event is ready to be
+ * placed in an event array to be passed to k_poll().
+ *
+ * @param event The event to initialize.
+ * @param type A bitfield of the types of event, from the K_POLL_TYPE_xxx
+ *             values. Only values that apply to the same object being polled
+ *             can be used together. Choosing K_POLL_TYPE_IGNORE disables the
+ *             event.
+ * @param mode Future. Use K_POLL_MODE_NOTIFY_ONLY.
+ * @param obj Kernel object or poll signal.
+ *
+ * @return N/A
+ */
+
+extern void k_poll_event_init(struct k_poll_event *event, uint32_t type,
+			      int mode, void *obj);
+
+/**
+ * @brief Wait for one or many of multiple poll events to occur
+ *
+ * This routine allows a thread to wait concurrently for one or many of
+ * multiple poll events to have occurred. Such events can be a kernel object
+ * being available, like a semaphore, or a poll signal event.
+ *
+ * When an event notifies that a kernel object is available, the kernel object
+ * is not "given" to the thread calling k_poll(): it merely signals the fact
+ * that the object was available when the k_poll() call was in effect. Also,
+ * all threads trying to acquire an object the regular way, i.e. by pending on
+ * the object, have precedence over the thread polling on the object. This
+ * means that the polling thread will never get the poll event on an object
+ * until the object becomes available and its pend queue is empty. For this
+ * reason, the k_poll() call is more effective when the objects being polled
+ * only have one thread, the polling thread, trying to acquire them.
+ *
+ * Only one thread can be polling for a particular object at a given time. If
+ * another thread tries to poll on it, the k_poll() call returns -EADDRINUSE
+ * and returns as soon as it has finished handling the other events. This means
+ * that k_poll() can return -EADDRINUSE and have the state value of some events
+ * be non-K_POLL_STATE_NOT_READY. When this condition occurs, the @a timeout
+ * parameter is ignored.
+ *
+ * When k_poll() returns 0 or -EADDRINUSE, the caller should loop on all the
+ * events that were passed to k_poll() and check the state field for the values
+ * that were expected and take the associated actions.
+ *
+ * Before being reused for another call to k_poll(), the user has to reset the
+ * state field to K_POLL_STATE_NOT_READY.
+ *
+ * @param events An array of pointers to events to be polled for.
+ * @param num_events The number of events in the array.
+ * @param timeout Waiting period for an event to be ready (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 One or more events are ready.
+ * @retval -EAGAIN Waiting period timed out.
+ * @retval -EADDRINUSE One or more objects already had a poller.
+ */
+
+extern int k_poll(struct k_poll_event *events, int num_events,
+		  int32_t timeout);
+
+/**
+ * @brief Initialize a poll signal object.
+ *
+ * Ready a poll signal object to be signaled via k_poll_signal().
+ *
+ * @param signal A poll signal.
+ *
+ * @return N/A
+ */
+
+extern void k_poll_signal_init(struct k_poll_signal *signal);
+
+/**
+ * @brief Signal a poll signal object.
+ *
+ * This routine makes ready a poll signal, which is basically a poll event of
+ * type K_POLL_TYPE_SIGNAL. If a thread was polling on that event, it will be
+ * made ready to run. A @a result value can be specified.
+ *
+ * The poll signal contains a 'signaled' field that, when set by
+ * k_poll_signal(), stays set until the user sets it back to 0. It thus has to
+ * be reset by the user before being passed again to k_poll() or k_poll() will
+ * consider it being signaled, and will return immediately.
+ *
+ * @param signal A poll signal.
+ * @param result The value to store in the result field of the signal.
+ *
+ * @retval 0 The signal was delivered successfully.
+ * @retval -EAGAIN The polling thread's timeout is in the process of expiring.
+ */
+
+extern int k_poll_signal(struct k_poll_signal *signal, int result);
+
+/* private internal function */
+extern int _handle_obj_poll_event(struct k_poll_event **obj_poll_event,
+				  uint32_t state);
+
+/**
+ * @} end defgroup poll_apis
+ */
+
+#ifdef CONFIG_COROUTINES
+
+/**
+ * @defgroup coro_apis Coroutine APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/**
+ * @brief Coroutine entry point.
+ *
+ * A coroutine's entry point is called each time the coroutine is resumed. Its
+ * body must be enclosed in K_CORO_BEGIN() and K_CORO_END(), and it must only
+ * use the K_CORO_xxx() macros to wait, since it has no stack of its own.
+ *
+ * @param coro Address of the coroutine.
+ *
+ * @return K_CORO_WAITING or K_CORO_EXITED, as returned by the macros.
+ */
+typedef int (*k_coro_entry_t)(struct k_coro *coro);
+
+/* private - states of a coroutine wait timeout */
+enum _coro_wait_states {
+	_CORO_WAIT_NONE,
+	_CORO_WAIT_FOREVER,
+	_CORO_WAIT_ARMED,
+	_CORO_WAIT_EXPIRED,
+};
+
+struct k_coro {
+	/* PRIVATE - DO NOT TOUCH */
+	struct k_work work;
+	struct k_work_q *work_q;
+	k_coro_entry_t entry;
+	struct _timeout timeout;
+	struct _poller poller;
+	struct k_poll_event event;
+
+	/* line of the K_CORO_xxx() macro to resume at, 0 to restart */
+	uint16_t resume;
+
+	/* non-zero while waiting to be woken up by an event or the timeout */
+	uint8_t waiting;
+
+	/* state of the timeout of the current wait */
+	uint8_t wait_state;
+};
+
+/* return values of a coroutine entry point */
+#define K_CORO_WAITING 0
+#define K_CORO_EXITED 1
+
+/**
+ * @brief Initialize a coroutine.
+ *
+ * This routine initializes a coroutine, prior to its first use. It is
+ * typically embedded in a larger structure holding the state that must be
+ * preserved across waits, since the coroutine has no stack of its own.
+ *
+ * @param coro Address of the coroutine.
+ * @param entry Coroutine entry point.
+ *
+ * @return N/A
+ */
+extern void k_coro_init(struct k_coro *coro, k_coro_entry_t entry);
+
+/**
+ * @brief Start a coroutine.
+ *
+ * This routine makes a coroutine run, from the start of its body, in the
+ * context of the threads of workqueue @a work_q. It must not be called on a
+ * coroutine that has not exited.
+ *
+ * @param coro Address of the coroutine.
+ * @param work_q Address of the workqueue.
+ *
+ * @return N/A
+ */
+extern void k_coro_start(struct k_coro *coro, struct k_work_q *work_q);
+
+/**
+ * @brief Mark the start of the body of a coroutine.
+ *
+ * @param coro Address of the coroutine.
+ */
+#define K_CORO_BEGIN(coro) switch ((coro)->resume) { case 0:
+
+/**
+ * @brief Mark the end of the body of a coroutine.
+ *
+ * Reaching the end of the body makes the coroutine exit.
+ *
+ * @param coro Address of the coroutine.
+ */
+#define K_CORO_END(coro) } (coro)->resume = 0; return K_CORO_EXITED
+
+/**
+ * @brief Make a coroutine exit.
+ *
+ * @param coro Address of the coroutine.
+ */
+#define K_CORO_EXIT(coro) do { (coro)->resume = 0; return K_CORO_EXITED; } \
+	while (0)
+
+/**
+ * @brief Let the other work items of a coroutine's workqueue run.
+ *
+ * The coroutine is requeued at the end of its workqueue's queue.
+ *
+ * @warning Local variables of the entry point are not preserved.
+ *
+ * @param coro Address of the coroutine.
+ */
+#define K_CORO_YIELD(coro) \
+	do { \
+		(coro)->resume = __LINE__; \
+		_k_coro_yield(coro); \
+		return K_CORO_WAITING; \
+		case __LINE__:; \
+	} while (0)
+
+/**
+ * @brief Put a coroutine to sleep.
+ *
+ * @warning Local variables of the entry point are not preserved.
+ *
+ * @param coro Address of the coroutine.
+ * @param duration Number of milliseconds to sleep.
+ */
+#define K_CORO_SLEEP(coro, duration) \
+	do { \
+		_k_coro_wait_start(coro, duration); \
+		(coro)->resume = __LINE__; \
+		case __LINE__: \
+		if (_k_coro_sleep(coro) == -EINPROGRESS) { \
+			return K_CORO_WAITING; \
+		} \
+	} while (0)
+
+/**
+ * @brief Take a semaphore from a coroutine.
+ *
+ * The coroutine waits without blocking its workqueue's threads. As with
+ * k_poll(), only one thread or coroutine can wait this way on a given
+ * semaphore at a time; threads waiting with k_sem_take() have precedence.
+ *
+ * @warning Local variables of the entry point are not preserved.
+ *
+ * @param coro Address of the coroutine.
+ * @param sem Address of the semaphore.
+ * @param timeout Waiting period to take the semaphore (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ * @param rc Set to 0 if the semaphore was taken, -EBUSY if it was not
+ *           available and @a timeout was K_NO_WAIT, -EAGAIN if waiting
+ *           timed out, or -EADDRINUSE if it is already waited on by k_poll()
+ *           or another coroutine.
+ */
+#define K_CORO_SEM_TAKE(coro, sem, timeout, rc) \
+	do { \
+		_k_coro_wait_start(coro, timeout); \
+		(coro)->resume = __LINE__; \
+		case __LINE__: \
+		(rc) = _k_coro_sem_take(coro, sem); \
+		if ((rc) == -EINPROGRESS) { \
+			return K_CORO_WAITING; \
+		} \
+	} while (0)
+
+/**
+ * @brief Get an element from a fifo from a coroutine.
+ *
+ * The coroutine waits without blocking its workqueue's threads. As with
+ * k_poll(), only one thread or coroutine can wait this way on a given fifo
+ * at a time; threads waiting with k_fifo_get() have precedence.
+ *
+ * @warning Local variables of the entry point are not preserved.
+ *
+ * @param coro Address of the coroutine.
+ * @param fifo Address of the fifo.
+ * @param timeout Waiting period to obtain a data item (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ * @param data Set to the address of the data item, or NULL if none was
+ *             obtained.
+ */
+#define K_CORO_FIFO_GET(coro, fifo, timeout, data) \
+	do { \
+		_k_coro_wait_start(coro, timeout); \
+		(coro)->resume = __LINE__; \
+		case __LINE__: \
+		if (_k_coro_fifo_get(coro, fifo, (void **)&(data)) == \
+		    -EINPROGRESS) { \
+			return K_CORO_WAITING; \
+		} \
+	} while (0)
+
+/* private internal functions, used by the macros above */
+extern void _k_coro_yield(struct k_coro *coro);
+extern void _k_coro_wait_start(struct k_coro *coro, int32_t timeout);
+extern int _k_coro_sleep(struct k_coro *coro);
+extern int _k_coro_sem_take(struct k_coro *coro, struct k_sem *sem);
+extern int _k_coro_fifo_get(struct k_coro *coro, struct k_fifo *fifo,
+			    void **data);
+
+/**
+ * @} end defgroup coro_apis
+ */
+
+#endif /* CONFIG_COROUTINES */
+
 /**
  * @brief Make the CPU idle.
  *
@@ -85,6 +85,7 @@
 		DEVICE_INIT_LEVEL(SECONDARY)	\
 		DEVICE_INIT_LEVEL(NANOKERNEL)	\
 		DEVICE_INIT_LEVEL(MICROKERNEL)	\
+		DEVICE_INIT_LEVEL(ASYNC)	\
 		__device_init_end = .;		\
 		DEVICE_BUSY_BITFIELD()		\
 
@@ -146,6 +147,20 @@ extern char __data_ram_start[];
 extern char __data_ram_end[];
 #endif
 
+#ifdef CONFIG_HAS_CCM
+extern char __ccm_bss_start[];
+extern char __ccm_bss_end[];
+extern char __ccm_data_rom_start[];
+extern char __ccm_data_ram_start[];
+extern char __ccm_data_ram_end[];
+#endif
+
+#if defined(CONFIG_XIP) && defined(CONFIG_ARCH_HAS_RAMFUNC)
+extern char _ramfunc_rom_start[];
+extern char _ramfunc_ram_start[];
+extern char _ramfunc_ram_end[];
+#endif
+
 extern char _image_rom_start[];
 extern char _image_rom_end[];
 extern char _image_ram_start[];
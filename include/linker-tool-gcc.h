@@ -68,6 +68,17 @@
 #define GROUP_DATA_LINK_IN(vregion, lregion) > vregion
 #endif
 
+/*
+ * As GROUP_DATA_LINK_IN(), for initialized sections which are not part
+ * of the data image between __data_ram_start and __data_ram_end, and
+ * which keep their load address in ROM when it is compressed.
+ */
+#ifdef CONFIG_XIP
+#define GROUP_RAW_DATA_LINK_IN(vregion, lregion) > vregion AT> lregion
+#else
+#define GROUP_RAW_DATA_LINK_IN(vregion, lregion) > vregion
+#endif
+
 /*
  * The GROUP_FOLLOWS_AT() macro is located at the end of the section
  * and indicates that the section does not specify an address at which
@@ -94,10 +105,32 @@
  * GROUP_LINK_IN_LMA to specify the correct output load address.
  */
 #ifdef CONFIG_XIP
-#define SECTION_DATA_PROLOGUE(name, options, align) \
+#define SECTION_RAW_DATA_PROLOGUE(name, options, align) \
 	name options : ALIGN_WITH_INPUT align
 #else
-#define SECTION_DATA_PROLOGUE(name, options, align) name options : align
+#define SECTION_RAW_DATA_PROLOGUE(name, options, align) \
+	name options : align
+#endif
+
+/*
+ * SECTION_RAW_DATA_PROLOGUE() goes with GROUP_RAW_DATA_LINK_IN(), for the
+ * initialized sections outside of the data image.
+ */
+#define SECTION_DATA_PROLOGUE(name, options, align) \
+	SECTION_RAW_DATA_PROLOGUE(name, options, align)
+
+/*
+ * With CONFIG_XIP_DATA_COMPRESSED, the final link is done with
+ * LINKER_DATA_COMPRESSED defined: the data image is loaded from the
+ * compressed .data_lz4 section instead, so the data sections are no
+ * longer loaded in ROM.
+ */
+#if defined(CONFIG_XIP_DATA_COMPRESSED) && defined(LINKER_DATA_COMPRESSED)
+#undef SECTION_DATA_PROLOGUE
+#undef GROUP_DATA_LINK_IN
+#define SECTION_DATA_PROLOGUE(name, options, align) \
+	name (NOLOAD) : ALIGN_WITH_INPUT align
+#define GROUP_DATA_LINK_IN(vregion, lregion) > vregion
 #endif
 
 #define SORT_BY_NAME(x) SORT(x)
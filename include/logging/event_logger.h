@@ -18,6 +18,15 @@ extern "C" {
 
 #define EVENT_HEADER_SIZE        1
 
+/*
+ * Header word of the events returned by sys_event_logger_get_bulk(),
+ * followed by the data words of the event. Words are in the byte order
+ * of the target.
+ */
+#define EVENT_HEADER_ID(hdr)         ((hdr) & 0xffff)
+#define EVENT_HEADER_LENGTH(hdr)     (((hdr) >> 16) & 0xff)
+#define EVENT_HEADER_DROPPED(hdr)    (((hdr) >> 24) & 0xff)
+
 #ifndef _ASMLANGUAGE
 
 #include <kernel.h>
@@ -66,6 +75,26 @@ void sys_event_logger_init(struct event_logger *logger,
 void sys_event_logger_put(struct event_logger *logger, uint16_t event_id,
 			  uint32_t *event_data, uint8_t data_size);
 
+/**
+ * @brief Send an event message to a single producer logger.
+ *
+ * @details Adds an event message to the ring buffer without locking
+ * interrupts nor signaling the sync semaphore. All the messages of the
+ * logger must come from a single context that cannot preempt itself, for
+ * example the context switch code, and be collected by polling with
+ * sys_event_logger_get_bulk().
+ *
+ * @param logger     Pointer to the event logger used.
+ * @param event_id   The profiler event's ID.
+ * @param event_data Pointer to the data of the message.
+ * @param data_size  Size of the buffer in 32-bit words.
+ *
+ * @return N/A
+ */
+void sys_event_logger_put_unlocked(struct event_logger *logger,
+				   uint16_t event_id, uint32_t *event_data,
+				   uint8_t data_size);
+
 
 /**
  * @brief Retrieve an event message from the logger.
@@ -117,6 +146,24 @@ int sys_event_logger_get_wait(struct event_logger *logger,  uint16_t *event_id,
 			      uint8_t *dropped_event_count, uint32_t *buffer,
 			      uint8_t *buffer_size);
 
+/**
+ * @brief Retrieve as many event messages as fit in a buffer.
+ *
+ * @details Copies whole messages, each one being a header word (see
+ * EVENT_HEADER_ID()) followed by its data, until the logger is empty or
+ * the next message does not fit. It does not wait and does not lock
+ * interrupts, and can only be called from a fiber.
+ *
+ * @param logger      Pointer to the event logger used.
+ * @param buffer      Pointer to the buffer for the copied messages.
+ * @param buffer_size Size of the buffer in 32-bit words.
+ *
+ * @retval -EMSGSIZE If the first message does not fit in the buffer.
+ * @retval Number of 32-bit words copied, 0 if the logger was empty.
+ */
+int sys_event_logger_get_bulk(struct event_logger *logger, uint32_t *buffer,
+			      uint32_t buffer_size);
+
 #ifdef CONFIG_SYS_CLOCK_EXISTS
 /**
  * @brief Retrieve an event message from the logger, wait with a timeout if
@@ -23,6 +23,7 @@ extern "C" {
 #define KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID             0x0001
 #define KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID                  0x0002
 #define KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID                      0x0003
+#define KERNEL_EVENT_LOGGER_NET_LATENCY_EVENT_ID                0x0004
 
 #ifndef _ASMLANGUAGE
 
@@ -260,6 +261,33 @@ static inline int sys_k_event_logger_get_wait(uint16_t *event_id,
 #endif /* CONFIG_KERNEL_EVENT_LOGGER */
 
 
+/**
+ * @brief Retrieves kernel event messages in bulk.
+ *
+ * This routine copies as many recorded events as fit in @a buffer, in the
+ * format described by EVENT_HEADER_ID(): a header word per event followed
+ * by its data, the first data word of kernel events being their timestamp.
+ * Events from the context switch buffer, if any, come first, so events
+ * are only ordered by time per event type.
+ *
+ * If there is no event, the caller pends for up to @a timeout. Context
+ * switch events logged in their own buffer do not wake the caller up,
+ * a finite timeout sets how often they are polled.
+ *
+ * @param buffer       Buffer to store the events.
+ * @param buffer_size  Size of the buffer (number of 32-bit words).
+ * @param timeout      Waiting period, in milliseconds, or one of the special
+ *                     values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval positive_integer Number of 32-bit words retrieved.
+ * @retval 0 No event was recorded within the timeout.
+ * @retval -EMSGSIZE Buffer too small for the next event.
+ */
+#ifdef CONFIG_KERNEL_EVENT_LOGGER
+int sys_k_event_logger_get_bulk(uint32_t *buffer, uint32_t buffer_size,
+				int32_t timeout);
+#endif /* CONFIG_KERNEL_EVENT_LOGGER */
+
 /**
  * @brief Retrieves a kernel event message, or waits for a specified time.
  *
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file rtt_backend.h
+ *  @brief Segger RTT log, trace and data channels.
+ *
+ * Each channel is an RTT up-buffer of its own, next to the terminal one
+ * used by the RTT console, so a debug probe can record them separately:
+ * "Log" gets the lines of the logging core, "Trace" the kernel events in
+ * the binary format of sys_k_event_logger_get_bulk() and "Data" whatever
+ * the application writes there.
+ */
+#ifndef __RTT_BACKEND_H
+#define __RTT_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum rtt_backend_channel {
+	RTT_BACKEND_LOG,
+	RTT_BACKEND_TRACE,
+	RTT_BACKEND_DATA,
+	RTT_BACKEND_CHANNELS
+};
+
+/**
+ * @brief Write to an RTT channel
+ *
+ * Writes are never split: with CONFIG_RTT_BACKEND_MODE_DROP, data that
+ * does not fit in the up-buffer is dropped at once. With
+ * CONFIG_RTT_BACKEND_MODE_BLOCK, threads sleep until the probe made room
+ * for all of it, writes from interrupts still being dropped.
+ *
+ * @param channel Channel to write to.
+ * @param data Data to write.
+ * @param len Number of bytes.
+ *
+ * @return Number of bytes written, 0 if they were dropped or the channel
+ * is not enabled.
+ */
+size_t rtt_backend_write(enum rtt_backend_channel channel, const void *data,
+			 size_t len);
+
+/**
+ * @brief Writes dropped on a channel
+ *
+ * @param channel Channel.
+ *
+ * @return Number of writes dropped because the up-buffer was full.
+ */
+uint32_t rtt_backend_dropped_get(enum rtt_backend_channel channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTT_BACKEND_H */
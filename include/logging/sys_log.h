@@ -45,6 +45,9 @@ void syslog_hook_install(void (*hook)(const char *, ...));
 /* decide print func */
 #if defined(CONFIG_SYS_LOG_EXT_HOOK)
 #define SYS_LOG_BACKEND_FN syslog_hook
+#elif defined(CONFIG_SYS_LOG_DEFERRED)
+#include <misc/printk.h>
+#define SYS_LOG_BACKEND_FN printk_deferred
 #else
 #include <misc/printk.h>
 #define SYS_LOG_BACKEND_FN printk
@@ -94,6 +97,42 @@ void syslog_hook_install(void (*hook)(const char *, ...));
 #define SYS_LOG_NL ""
 #endif
 
+#if defined(CONFIG_SYS_LOG_CORE)
+#include <logging/sys_log_core.h>
+
+static struct sys_log_module _sys_log_module __unused = {
+	.name = SYS_LOG_DOMAIN,
+	.level = SYS_LOG_LEVEL,
+	.build_level = SYS_LOG_LEVEL,
+};
+
+/* function: message, the core adds timestamp, domain and level */
+#define LOG_CORE_CALL(log_lv, log_format, ...)				\
+	do {								\
+		if ((log_lv) <= _sys_log_module.level) {		\
+			sys_log_core_put(&_sys_log_module, log_lv,	\
+				"%s: " log_format SYS_LOG_NL,		\
+				_SYS_LOG_NARGS(__func__, ##__VA_ARGS__),\
+				__func__, ##__VA_ARGS__);		\
+		}							\
+	} while (0)
+
+#define SYS_LOG_ERR(...) LOG_CORE_CALL(SYS_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#if (SYS_LOG_LEVEL >= SYS_LOG_LEVEL_WARNING)
+#define SYS_LOG_WRN(...) LOG_CORE_CALL(SYS_LOG_LEVEL_WARNING, __VA_ARGS__)
+#endif
+
+#if (SYS_LOG_LEVEL >= SYS_LOG_LEVEL_INFO)
+#define SYS_LOG_INF(...) LOG_CORE_CALL(SYS_LOG_LEVEL_INFO, __VA_ARGS__)
+#endif
+
+#if (SYS_LOG_LEVEL == SYS_LOG_LEVEL_DEBUG)
+#define SYS_LOG_DBG(...) LOG_CORE_CALL(SYS_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#endif
+
+#else /* CONFIG_SYS_LOG_CORE */
+
 /* [domain] [level] function: */
 #define LOG_LAYOUT "[%s]%s %s: %s"
 #define LOG_BACKEND_CALL(log_lv, log_color, log_format, color_off, ...)	\
@@ -122,6 +161,8 @@ void syslog_hook_install(void (*hook)(const char *, ...));
 #define SYS_LOG_DBG(...) LOG_NO_COLOR(SYS_LOG_TAG_DBG, ##__VA_ARGS__)
 #endif
 
+#endif /* CONFIG_SYS_LOG_CORE */
+
 #else
 /**
  * @def IS_SYS_LOG_ACTIVE
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file sys_log_core.h
+ *  @brief Deferred logging core.
+ *
+ * With CONFIG_SYS_LOG_CORE, the SYS_LOG macros do not format anything in
+ * the context of the caller: a timestamp, the module, the level, the
+ * format string pointer and the raw arguments are copied into a ring
+ * buffer, and a low priority thread formats and outputs the messages
+ * through the registered backends.
+ *
+ * Since only pointers are stored, format strings and strings given as
+ * arguments must stay valid until the message is output. Arguments must
+ * fit in 32 bits.
+ */
+#ifndef __SYS_LOG_CORE_H
+#define __SYS_LOG_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <toolchain.h>
+#include <misc/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of arguments of a message, function name included */
+#define SYS_LOG_CORE_MAX_ARGS 10
+
+/**
+ * @brief Log module
+ *
+ * One is defined by each compile unit using the logging macros, named
+ * after SYS_LOG_DOMAIN. It is registered when it logs its first message.
+ */
+struct sys_log_module {
+	sys_snode_t node;
+	const char *name;
+	/** Runtime level, messages above it are discarded by the caller */
+	uint8_t level;
+	/** Level the module was built with */
+	uint8_t build_level;
+	uint8_t registered;
+	/** Messages lost because the ring buffer was full */
+	uint32_t dropped;
+};
+
+/**
+ * @brief Log backend
+ *
+ * Receives the formatted lines, from the logging thread.
+ */
+struct sys_log_backend {
+	sys_snode_t node;
+	void (*put)(const char *line, size_t len);
+};
+
+/* Number of arguments, up to SYS_LOG_CORE_MAX_ARGS + 2 */
+#define _SYS_LOG_NARGS(...) _SYS_LOG_NARGS_X(__VA_ARGS__,		\
+	12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define _SYS_LOG_NARGS_X(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10,	\
+	_11, _12, n, ...) n
+
+/**
+ * @brief Store a message in the ring buffer
+ *
+ * Called by the logging macros; usable from any context. The message is
+ * dropped, and counted as such, when the ring buffer is full.
+ *
+ * @param module Module logging the message.
+ * @param level Level of the message.
+ * @param fmt Format string.
+ * @param nargs Number of 32 bit arguments following.
+ */
+void sys_log_core_put(struct sys_log_module *module, uint8_t level,
+		      const char *fmt, uint8_t nargs, ...);
+
+/**
+ * @brief Change the runtime level of modules
+ *
+ * Levels can only be lowered below, or restored up to, the level the
+ * module was built with.
+ *
+ * @param name Name of the module, NULL for all registered modules.
+ * @param level New level.
+ *
+ * @return 0 on success, -ENOENT if no registered module has that name.
+ */
+int sys_log_core_level_set(const char *name, uint8_t level);
+
+/**
+ * @brief Messages dropped since boot
+ *
+ * @return Number of messages lost because the ring buffer was full.
+ */
+uint32_t sys_log_core_dropped_get(void);
+
+/**
+ * @brief Register an output backend
+ *
+ * Lines are given to every registered backend. RTT or flash backends
+ * plug in here; the console one is built in with
+ * CONFIG_SYS_LOG_CORE_BACKEND_CONSOLE.
+ *
+ * @param backend Backend, must stay valid.
+ */
+void sys_log_backend_register(struct sys_log_backend *backend);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SYS_LOG_CORE_H */
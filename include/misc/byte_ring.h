@@ -0,0 +1,361 @@
+/* byte_ring.h: Lock-free byte ring buffer API */
+
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/** @file */
+
+#ifndef __BYTE_RING_H__
+#define __BYTE_RING_H__
+
+#include <kernel.h>
+#include <atomic.h>
+#include <misc/util.h>
+#include <errno.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A structure to represent a single-producer byte ring
+ */
+struct byte_ring {
+	atomic_t head;	/**< Bytes read so far, only written by the consumer */
+	atomic_t tail;	/**< Bytes written so far, only written by producers */
+	uint32_t size;	/**< Size of buf in bytes, a power of 2 */
+	uint8_t *buf;	/**< Memory region for stored bytes */
+};
+
+/**
+ * @brief A structure to represent a multi-producer byte ring
+ */
+struct byte_ring_mp {
+	atomic_t head;	/**< Bytes released so far by the consumer */
+	atomic_t tail;	/**< Bytes reserved so far by producers */
+	uint32_t size;	/**< Size of buf in bytes, a power of 2 */
+	uint32_t *buf;	/**< Memory region for stored records */
+};
+
+/**
+ * @defgroup byte_ring_apis Byte Ring APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/**
+ * @brief Statically define and initialize a single-producer byte ring.
+ *
+ * This macro establishes a byte ring of 2^pow bytes, which one producer and
+ * one consumer can access concurrently without any locking, e.g. an ISR
+ * feeding a thread.
+ *
+ * The byte ring can be accessed outside the module where it is defined
+ * using:
+ *
+ * @code extern struct byte_ring <name>; @endcode
+ *
+ * @param name Name of the byte ring.
+ * @param pow Byte ring size exponent.
+ */
+#define SYS_BYTE_RING_DECLARE_POW2(name, pow) \
+	static uint8_t _byte_ring_data_##name[1 << (pow)]; \
+	struct byte_ring name = { \
+		.size = (1 << (pow)), \
+		.buf = _byte_ring_data_##name \
+	}
+
+/**
+ * @brief Statically define and initialize a multi-producer byte ring.
+ *
+ * This macro establishes a byte ring of 2^pow bytes, which any number of
+ * producers and one consumer can access concurrently without any locking.
+ * Unlike a single-producer byte ring, it stores records: the bytes written
+ * by one producer in one call are read back as a whole, and are never
+ * interleaved with the bytes of another producer. Each record also uses a
+ * 32-bit header and is padded to a multiple of 32 bits.
+ *
+ * The byte ring can be accessed outside the module where it is defined
+ * using:
+ *
+ * @code extern struct byte_ring_mp <name>; @endcode
+ *
+ * @param name Name of the byte ring.
+ * @param pow Byte ring size exponent, at least 3.
+ */
+#define SYS_BYTE_RING_MP_DECLARE_POW2(name, pow) \
+	static uint32_t _byte_ring_data_##name[(1 << (pow)) / 4]; \
+	struct byte_ring_mp name = { \
+		.size = (1 << (pow)), \
+		.buf = _byte_ring_data_##name \
+	}
+
+/**
+ * @brief Initialize a single-producer byte ring.
+ *
+ * This routine initializes a byte ring, prior to its first use. It is only
+ * used for byte rings not defined using SYS_BYTE_RING_DECLARE_POW2.
+ *
+ * @param ring Address of byte ring.
+ * @param size Byte ring size (in bytes), a power of 2.
+ * @param data Byte ring data area.
+ *
+ * @return N/A
+ */
+static inline void sys_byte_ring_init(struct byte_ring *ring, uint32_t size,
+				      uint8_t *data)
+{
+	__ASSERT(is_power_of_two(size), "size must be a power of 2\n");
+
+	ring->head = 0;
+	ring->tail = 0;
+	ring->size = size;
+	ring->buf = data;
+}
+
+/**
+ * @brief Determine the number of bytes stored in a byte ring.
+ *
+ * The result is only exact when called by the consumer.
+ *
+ * @param ring Address of byte ring.
+ *
+ * @return Number of bytes that can be read.
+ */
+static inline uint32_t sys_byte_ring_used_get(struct byte_ring *ring)
+{
+	return (uint32_t)atomic_get(&ring->tail) -
+	       (uint32_t)atomic_get(&ring->head);
+}
+
+/**
+ * @brief Determine free space in a single-producer byte ring.
+ *
+ * The result is only exact when called by the producer.
+ *
+ * @param ring Address of byte ring.
+ *
+ * @return Number of bytes that can be written.
+ */
+static inline uint32_t sys_byte_ring_space_get(struct byte_ring *ring)
+{
+	return ring->size - sys_byte_ring_used_get(ring);
+}
+
+/**
+ * @brief Determine if a byte ring is empty.
+ *
+ * @param ring Address of byte ring.
+ *
+ * @return 1 if the byte ring is empty, or 0 if not.
+ */
+static inline int sys_byte_ring_is_empty(struct byte_ring *ring)
+{
+	return sys_byte_ring_used_get(ring) == 0;
+}
+
+/**
+ * @brief Claim a contiguous area of a byte ring to write to.
+ *
+ * This routine lets the producer write directly into the ring's data area,
+ * without an intermediate copy. The area claimed is the largest contiguous
+ * free area, up to @a size bytes; it may thus be smaller than the free space
+ * in the ring when the free space wraps around the end of the data area.
+ *
+ * The bytes written are only made visible to the consumer by
+ * sys_byte_ring_put_finish().
+ *
+ * @param ring Address of byte ring.
+ * @param data Area to store the address of the claimed area.
+ * @param size Maximum number of bytes to claim.
+ *
+ * @return Number of bytes claimed, possibly 0.
+ */
+extern uint32_t sys_byte_ring_put_claim(struct byte_ring *ring,
+					uint8_t **data, uint32_t size);
+
+/**
+ * @brief Commit bytes written to an area claimed in a byte ring.
+ *
+ * @param ring Address of byte ring.
+ * @param size Number of bytes written, at most the number of bytes claimed
+ *             by the last call to sys_byte_ring_put_claim().
+ *
+ * @return N/A
+ */
+extern void sys_byte_ring_put_finish(struct byte_ring *ring, uint32_t size);
+
+/**
+ * @brief Write bytes to a single-producer byte ring.
+ *
+ * This routine copies as many of the @a size bytes at @a data as there is
+ * free space for into byte ring @a ring.
+ *
+ * @param ring Address of byte ring.
+ * @param data Address of the bytes to write.
+ * @param size Number of bytes to write.
+ *
+ * @return Number of bytes written.
+ */
+extern uint32_t sys_byte_ring_put(struct byte_ring *ring, const uint8_t *data,
+				  uint32_t size);
+
+/**
+ * @brief Claim a contiguous area of a byte ring to read from.
+ *
+ * This routine lets the consumer read directly from the ring's data area,
+ * without an intermediate copy. The area claimed is the largest contiguous
+ * area of stored bytes, up to @a size bytes.
+ *
+ * The bytes read are only released to the producers by
+ * sys_byte_ring_get_finish().
+ *
+ * @param ring Address of byte ring.
+ * @param data Area to store the address of the claimed area.
+ * @param size Maximum number of bytes to claim.
+ *
+ * @return Number of bytes claimed, possibly 0.
+ */
+extern uint32_t sys_byte_ring_get_claim(struct byte_ring *ring,
+					uint8_t **data, uint32_t size);
+
+/**
+ * @brief Release bytes read from an area claimed in a byte ring.
+ *
+ * @param ring Address of byte ring.
+ * @param size Number of bytes read, at most the number of bytes claimed
+ *             by the last call to sys_byte_ring_get_claim().
+ *
+ * @return N/A
+ */
+extern void sys_byte_ring_get_finish(struct byte_ring *ring, uint32_t size);
+
+/**
+ * @brief Read bytes from a byte ring.
+ *
+ * This routine copies up to @a size bytes from byte ring @a ring to @a data.
+ *
+ * @param ring Address of byte ring.
+ * @param data Area to store the bytes read.
+ * @param size Maximum number of bytes to read.
+ *
+ * @return Number of bytes read.
+ */
+extern uint32_t sys_byte_ring_get(struct byte_ring *ring, uint8_t *data,
+				  uint32_t size);
+
+/**
+ * @brief Initialize a multi-producer byte ring.
+ *
+ * This routine initializes a byte ring, prior to its first use. It is only
+ * used for byte rings not defined using SYS_BYTE_RING_MP_DECLARE_POW2.
+ *
+ * @param ring Address of byte ring.
+ * @param size Byte ring size (in bytes), a power of 2 of at least 8.
+ * @param data Byte ring data area.
+ *
+ * @return N/A
+ */
+extern void sys_byte_ring_mp_init(struct byte_ring_mp *ring, uint32_t size,
+				  uint32_t *data);
+
+/**
+ * @brief Claim an area of a multi-producer byte ring to write a record to.
+ *
+ * This routine reserves a contiguous area of @a size bytes for the calling
+ * producer, which must then fill it and commit it by calling
+ * sys_byte_ring_mp_put_finish(). A producer can have several areas claimed
+ * at the same time, and finish them in any order.
+ *
+ * A record only becomes visible to the consumer once it and all the records
+ * claimed before it have been committed, so claims should be short, e.g. not
+ * span a blocking call.
+ *
+ * @param ring Address of byte ring.
+ * @param data Area to store the address of the claimed area.
+ * @param size Size of the record (in bytes).
+ *
+ * @retval 0 Area claimed.
+ * @retval -ENOMEM Byte ring has insufficient free space.
+ * @retval -EMSGSIZE Record, with its header, is larger than half of the
+ *         byte ring.
+ */
+extern int sys_byte_ring_mp_put_claim(struct byte_ring_mp *ring,
+				      uint8_t **data, uint32_t size);
+
+/**
+ * @brief Commit a record written to an area claimed in a byte ring.
+ *
+ * @param ring Address of byte ring.
+ * @param data Address of the area, as returned by
+ *             sys_byte_ring_mp_put_claim().
+ *
+ * @return N/A
+ */
+extern void sys_byte_ring_mp_put_finish(struct byte_ring_mp *ring,
+					uint8_t *data);
+
+/**
+ * @brief Write a record to a multi-producer byte ring.
+ *
+ * @param ring Address of byte ring.
+ * @param data Address of the bytes to write.
+ * @param size Number of bytes to write.
+ *
+ * @retval 0 Record written.
+ * @retval -ENOMEM Byte ring has insufficient free space.
+ * @retval -EMSGSIZE Record, with its header, is larger than half of the
+ *         byte ring.
+ */
+extern int sys_byte_ring_mp_put(struct byte_ring_mp *ring,
+				const uint8_t *data, uint32_t size);
+
+/**
+ * @brief Claim the oldest record of a multi-producer byte ring.
+ *
+ * This routine lets the consumer read the oldest committed record directly
+ * from the ring's data area. The record is only released to the producers by
+ * sys_byte_ring_mp_get_finish().
+ *
+ * @param ring Address of byte ring.
+ * @param data Area to store the address of the record.
+ *
+ * @return Size of the record (in bytes), or -EAGAIN if there is none.
+ */
+extern int sys_byte_ring_mp_get_claim(struct byte_ring_mp *ring,
+				      uint8_t **data);
+
+/**
+ * @brief Release the record claimed in a multi-producer byte ring.
+ *
+ * @param ring Address of byte ring.
+ *
+ * @return N/A
+ */
+extern void sys_byte_ring_mp_get_finish(struct byte_ring_mp *ring);
+
+/**
+ * @brief Read a record from a multi-producer byte ring.
+ *
+ * @param ring Address of byte ring.
+ * @param data Area to store the record.
+ * @param size Size of the storage area (in bytes).
+ *
+ * @return Size of the record (in bytes), -EAGAIN if there is none, or
+ *         -EMSGSIZE if it is larger than @a size, in which case it is left
+ *         in the byte ring.
+ */
+extern int sys_byte_ring_mp_get(struct byte_ring_mp *ring, uint8_t *data,
+				uint32_t size);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BYTE_RING_H__ */
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief Header where the intrusive hash map utility code is found
+ *
+ * The hash map does not allocate anything: the sys_hnode_t is embedded in
+ * the user structure, and CONTAINER_OF() gets the structure back from a
+ * node. The map is an open-addressing table of node pointers with linear
+ * probing, whose storage is given when the map is defined or initialized.
+ * Its size is a power of 2, which should be about twice the number of
+ * nodes stored to keep the probe sequences short.
+ *
+ * The user computes the hash of the keys, e.g. with sys_hash32_bytes(),
+ * and the map caches it in the node.
+ */
+
+#ifndef __HASH_MAP_H__
+#define __HASH_MAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _hnode {
+	uint32_t hash;
+};
+
+typedef struct _hnode sys_hnode_t;
+
+/**
+ * @brief Test if a node of a map holds a key
+ *
+ * Only called on the nodes with the same hash as the key.
+ *
+ * @return true if the node holds the key, false otherwise
+ */
+typedef bool (*sys_hash_match_t)(const void *key, const sys_hnode_t *node);
+
+struct _hash_map {
+	sys_hnode_t **slots;
+	uint32_t mask;
+	uint32_t count;
+};
+
+typedef struct _hash_map sys_hash_map_t;
+
+/**
+ * @brief Statically define and initialize a hash map.
+ *
+ * This macro establishes a hash map of 2^pow slots, which can hold up to
+ * 2^pow - 1 nodes.
+ *
+ * The hash map can be accessed outside the module where it is defined
+ * using:
+ *
+ * @code extern sys_hash_map_t <name>; @endcode
+ *
+ * @param name Name of the hash map.
+ * @param pow Hash map size exponent.
+ */
+#define SYS_HASH_MAP_DEFINE_POW2(name, pow) \
+	static sys_hnode_t *_hash_map_slots_##name[1 << (pow)]; \
+	sys_hash_map_t name = { \
+		.slots = _hash_map_slots_##name, \
+		.mask = (1 << (pow)) - 1, \
+		.count = 0 \
+	}
+
+/**
+ * @brief Provide the primitive to iterate on a map, in no particular order
+ * Note: the loop is unsafe and thus __hn should not be removed
+ *
+ * User _MUST_ add the loop statement curly braces enclosing its own code:
+ *
+ *     SYS_HASH_MAP_FOR_EACH_NODE(m, i, n) {
+ *         <user code>
+ *     }
+ *
+ * @param __hm A pointer on a sys_hash_map_t to iterate on
+ * @param __hi A uint32_t index for the loop
+ * @param __hn A sys_hnode_t pointer to peek each node of the map
+ */
+#define SYS_HASH_MAP_FOR_EACH_NODE(__hm, __hi, __hn)			\
+	for (__hi = 0; __hi <= (__hm)->mask; __hi++)			\
+		if (((__hn) = (__hm)->slots[__hi]) != NULL)
+
+/**
+ * @brief Hash a byte string, with 32-bit FNV-1a
+ *
+ * @param data A pointer on the bytes to hash
+ * @param len The number of bytes to hash
+ *
+ * @return The hash of the bytes
+ */
+static inline uint32_t sys_hash32_bytes(const void *data, size_t len)
+{
+	const uint8_t *bytes = data;
+	uint32_t hash = 2166136261u;
+
+	while (len--) {
+		hash = (hash ^ *bytes++) * 16777619u;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief Hash a 32-bit integer, mixing all its bits in the low ones
+ *
+ * @param value The integer to hash
+ *
+ * @return The hash of the integer
+ */
+static inline uint32_t sys_hash32_u32(uint32_t value)
+{
+	value ^= value >> 16;
+	value *= 0x85ebca6bu;
+	value ^= value >> 13;
+	value *= 0xc2b2ae35u;
+	value ^= value >> 16;
+
+	return value;
+}
+
+/**
+ * @brief Initialize a hash map
+ *
+ * @param map A pointer on the map to initialize
+ * @param slots The slots of the map, 2^pow node pointers
+ * @param pow Hash map size exponent
+ */
+static inline void sys_hash_map_init(sys_hash_map_t *map, sys_hnode_t **slots,
+				     unsigned int pow)
+{
+	uint32_t i;
+
+	map->slots = slots;
+	map->mask = (1 << pow) - 1;
+	map->count = 0;
+
+	for (i = 0; i <= map->mask; i++) {
+		slots[i] = NULL;
+	}
+}
+
+/**
+ * @brief Get the number of nodes of a hash map
+ *
+ * @param map A pointer on the map
+ *
+ * @return The number of nodes in the map
+ */
+static inline uint32_t sys_hash_map_count(sys_hash_map_t *map)
+{
+	return map->count;
+}
+
+/**
+ * @brief Look up a node of a hash map from its key
+ *
+ * @param map A pointer on the map to look into
+ * @param hash The hash of the key
+ * @param key A pointer on the key to look for, given back to match
+ * @param match The function testing if a node holds the key
+ *
+ * @return A pointer on a node holding the key (or NULL if none)
+ */
+static inline sys_hnode_t *sys_hash_map_find(sys_hash_map_t *map,
+					     uint32_t hash, const void *key,
+					     sys_hash_match_t match)
+{
+	uint32_t i = hash & map->mask;
+	sys_hnode_t *node;
+
+	/* There is always an empty slot ending the probe sequence */
+	while ((node = map->slots[i])) {
+		if (node->hash == hash && match(key, node)) {
+			return node;
+		}
+
+		i = (i + 1) & map->mask;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Insert a node in a hash map
+ *
+ * The map does not check whether it already holds the key: look it up
+ * first if keys may be inserted twice.
+ *
+ * @param map A pointer on the map to insert into
+ * @param node A pointer on the node to insert
+ * @param hash The hash of the key of the node
+ *
+ * @return 0 once inserted, -ENOSPC if the map is full
+ */
+static inline int sys_hash_map_insert(sys_hash_map_t *map, sys_hnode_t *node,
+				      uint32_t hash)
+{
+	uint32_t i = hash & map->mask;
+
+	if (map->count == map->mask) {
+		return -ENOSPC;
+	}
+
+	while (map->slots[i]) {
+		i = (i + 1) & map->mask;
+	}
+
+	node->hash = hash;
+	map->slots[i] = node;
+	map->count++;
+
+	return 0;
+}
+
+/**
+ * @brief Remove a node from a hash map
+ *
+ * @param map A pointer on the map holding the node
+ * @param node A pointer on the node to remove
+ *
+ * @return true if the node was removed, false if it was not in the map
+ */
+static inline bool sys_hash_map_remove(sys_hash_map_t *map, sys_hnode_t *node)
+{
+	uint32_t i = node->hash & map->mask;
+	uint32_t j, home;
+
+	while (map->slots[i] != node) {
+		if (!map->slots[i]) {
+			return false;
+		}
+
+		i = (i + 1) & map->mask;
+	}
+
+	/* Shift back the nodes following the removed one which would not be
+	 * found anymore past the hole, so that no tombstone is needed.
+	 */
+	for (j = (i + 1) & map->mask; map->slots[j]; j = (j + 1) & map->mask) {
+		home = map->slots[j]->hash & map->mask;
+
+		if (((j - home) & map->mask) >= ((j - i) & map->mask)) {
+			map->slots[i] = map->slots[j];
+			i = j;
+		}
+	}
+
+	map->slots[i] = NULL;
+	map->count--;
+
+	return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HASH_MAP_H__ */
@@ -21,7 +21,9 @@ extern "C" {
  * @brief Print kernel debugging message.
  *
  * This routine prints a kernel debugging message to the system console.
- * Output is send immediately, without any mutual exclusion or buffering.
+ * Output is send immediately, without any mutual exclusion. With
+ * CONFIG_PRINTK_BUFFER_SIZE, it is formatted into a buffer on the stack
+ * and pushed to the console as whole strings.
  *
  * A basic set of conversion specifier characters are supported:
  *   - signed decimal: \%d, \%i
@@ -47,6 +49,24 @@ extern __printf_like(3, 4) int snprintk(char *str, size_t size,
 extern int vsnprintk(char *str, size_t size, const char *fmt, va_list ap);
 
 void _vprintk(int (*out)(int, void *), void *ctx, const char *fmt, va_list ap);
+
+#ifdef CONFIG_PRINTK_DEFERRED
+/**
+ * @brief Queue a kernel debugging message.
+ *
+ * Same as printk(), but only the format string and the arguments are
+ * queued, to be formatted and output later by a low priority thread. It
+ * can be called from interrupts. String arguments must stay valid until
+ * the message is output, and at most 10 arguments are stored: messages
+ * with more are output immediately.
+ *
+ * @param fmt Format string.
+ * @param ... Optional list of format arguments.
+ */
+extern __printf_like(1, 2) void printk_deferred(const char *fmt, ...);
+#else
+#define printk_deferred(...) printk(__VA_ARGS__)
+#endif
 #else
 static inline __printf_like(1, 2) int printk(const char *fmt, ...)
 {
@@ -54,6 +74,8 @@ static inline __printf_like(1, 2) int printk(const char *fmt, ...)
 	return 0;
 }
 
+#define printk_deferred(...) printk(__VA_ARGS__)
+
 static inline __printf_like(3, 4) int snprintk(char *str, size_t size,
 					       const char *fmt, ...)
 {
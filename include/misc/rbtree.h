@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief Header where the intrusive red-black tree utility code is found
+ *
+ * The tree does not allocate anything: the sys_rbnode_t is embedded in the
+ * user structure, and CONTAINER_OF() gets the structure back from a node.
+ * Insertion, removal and lookup are O(log n), and the nodes are ordered by
+ * a comparison function given when the tree is initialized.
+ */
+
+#ifndef __RBTREE_H__
+#define __RBTREE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _rbnode {
+	struct _rbnode *child[2];
+	/* Parent node pointer, with the node color in bit 0 (set if red) */
+	uintptr_t parent_color;
+};
+
+typedef struct _rbnode sys_rbnode_t;
+
+/**
+ * @brief Compare two nodes of a tree
+ *
+ * @return A negative value if a is ordered before b, 0 if a and b have the
+ * same key, a positive value otherwise.
+ */
+typedef int (*sys_rb_cmp_t)(const sys_rbnode_t *a, const sys_rbnode_t *b);
+
+/**
+ * @brief Compare a key with the key of a node of a tree
+ *
+ * @return A negative value if key is ordered before the key of node, 0 if
+ * they are equal, a positive value otherwise.
+ */
+typedef int (*sys_rb_key_cmp_t)(const void *key, const sys_rbnode_t *node);
+
+struct _rbtree {
+	sys_rbnode_t *root;
+	sys_rb_cmp_t cmp;
+};
+
+typedef struct _rbtree sys_rbtree_t;
+
+/**
+ * @brief Provide the primitive to iterate on a tree, in ascending order
+ * Note: the loop is unsafe and thus __rn should not be removed
+ *
+ * User _MUST_ add the loop statement curly braces enclosing its own code:
+ *
+ *     SYS_RB_FOR_EACH_NODE(t, n) {
+ *         <user code>
+ *     }
+ *
+ * @param __rt A pointer on a sys_rbtree_t to iterate on
+ * @param __rn A sys_rbnode_t pointer to peek each node of the tree
+ */
+#define SYS_RB_FOR_EACH_NODE(__rt, __rn)				\
+	for (__rn = sys_rb_min(__rt); __rn; __rn = sys_rb_next(__rn))
+
+/**
+ * @brief Provide the primitive to safely iterate on a tree
+ * Note: __rn can be removed, it will not break the loop.
+ *
+ * User _MUST_ add the loop statement curly braces enclosing its own code:
+ *
+ *     SYS_RB_FOR_EACH_NODE_SAFE(t, n, s) {
+ *         <user code>
+ *     }
+ *
+ * @param __rt A pointer on a sys_rbtree_t to iterate on
+ * @param __rn A sys_rbnode_t pointer to peek each node of the tree
+ * @param __rns A sys_rbnode_t pointer for the loop to run safely
+ */
+#define SYS_RB_FOR_EACH_NODE_SAFE(__rt, __rn, __rns)			\
+	for (__rn = sys_rb_min(__rt),					\
+		     __rns = __rn ? sys_rb_next(__rn) : NULL;		\
+	     __rn; __rn = __rns,					\
+		     __rns = __rn ? sys_rb_next(__rn) : NULL)
+
+/**
+ * @brief Statically initialize a tree
+ *
+ * @param _cmp Node comparison function, of type sys_rb_cmp_t
+ */
+#define SYS_RB_TREE_INITIALIZER(_cmp) { .root = NULL, .cmp = _cmp }
+
+/**
+ * @brief Initialize a tree
+ *
+ * @param tree A pointer on the tree to initialize
+ * @param cmp The node comparison function, ordering the tree
+ */
+static inline void sys_rb_init(sys_rbtree_t *tree, sys_rb_cmp_t cmp)
+{
+	tree->root = NULL;
+	tree->cmp = cmp;
+}
+
+/**
+ * @brief Test if the given tree is empty
+ *
+ * @param tree A pointer on the tree to test
+ *
+ * @return a boolean, true if it's empty, false otherwise
+ */
+static inline bool sys_rb_is_empty(sys_rbtree_t *tree)
+{
+	return (!tree->root);
+}
+
+/* Internal helpers, color and parent pointer handling, and rebalancing */
+
+static inline sys_rbnode_t *_rb_parent(const sys_rbnode_t *node)
+{
+	return (sys_rbnode_t *)(node->parent_color & ~(uintptr_t)1);
+}
+
+static inline bool _rb_is_red(const sys_rbnode_t *node)
+{
+	/* NULL leaves are black */
+	return node && (node->parent_color & 1);
+}
+
+static inline void _rb_set_parent(sys_rbnode_t *node, sys_rbnode_t *parent)
+{
+	node->parent_color = (uintptr_t)parent | (node->parent_color & 1);
+}
+
+static inline void _rb_set_red(sys_rbnode_t *node)
+{
+	node->parent_color |= 1;
+}
+
+static inline void _rb_set_black(sys_rbnode_t *node)
+{
+	node->parent_color &= ~(uintptr_t)1;
+}
+
+static inline void _rb_replace_child(sys_rbtree_t *tree, sys_rbnode_t *parent,
+				     sys_rbnode_t *old, sys_rbnode_t *new)
+{
+	if (!parent) {
+		tree->root = new;
+	} else {
+		parent->child[parent->child[1] == old] = new;
+	}
+}
+
+/* Rotate around node, child[!dir] of node taking its place */
+static inline void _rb_rotate(sys_rbtree_t *tree, sys_rbnode_t *node, int dir)
+{
+	sys_rbnode_t *up = node->child[!dir];
+	sys_rbnode_t *parent = _rb_parent(node);
+
+	node->child[!dir] = up->child[dir];
+	if (up->child[dir]) {
+		_rb_set_parent(up->child[dir], node);
+	}
+
+	_rb_set_parent(up, parent);
+	_rb_replace_child(tree, parent, node, up);
+
+	up->child[dir] = node;
+	_rb_set_parent(node, up);
+}
+
+static inline sys_rbnode_t *_rb_step(const sys_rbnode_t *node, int dir)
+{
+	sys_rbnode_t *parent;
+
+	if (node->child[dir]) {
+		node = node->child[dir];
+		while (node->child[!dir]) {
+			node = node->child[!dir];
+		}
+
+		return (sys_rbnode_t *)node;
+	}
+
+	parent = _rb_parent(node);
+	while (parent && node == parent->child[dir]) {
+		node = parent;
+		parent = _rb_parent(node);
+	}
+
+	return parent;
+}
+
+static inline sys_rbnode_t *_rb_end(sys_rbtree_t *tree, int dir)
+{
+	sys_rbnode_t *node = tree->root;
+
+	if (node) {
+		while (node->child[dir]) {
+			node = node->child[dir];
+		}
+	}
+
+	return node;
+}
+
+static inline void _rb_insert_fixup(sys_rbtree_t *tree, sys_rbnode_t *node)
+{
+	sys_rbnode_t *parent, *grandparent, *uncle;
+	int dir;
+
+	while ((parent = _rb_parent(node)) && _rb_is_red(parent)) {
+		/* A red node is never the root, so there is a grandparent */
+		grandparent = _rb_parent(parent);
+		dir = (grandparent->child[1] == parent);
+		uncle = grandparent->child[!dir];
+
+		if (_rb_is_red(uncle)) {
+			_rb_set_black(parent);
+			_rb_set_black(uncle);
+			_rb_set_red(grandparent);
+			node = grandparent;
+			continue;
+		}
+
+		if (parent->child[!dir] == node) {
+			_rb_rotate(tree, parent, dir);
+			node = parent;
+			parent = _rb_parent(node);
+		}
+
+		_rb_set_black(parent);
+		_rb_set_red(grandparent);
+		_rb_rotate(tree, grandparent, !dir);
+		break;
+	}
+
+	_rb_set_black(tree->root);
+}
+
+static inline void _rb_remove_fixup(sys_rbtree_t *tree, sys_rbnode_t *node,
+				    sys_rbnode_t *parent)
+{
+	sys_rbnode_t *sibling;
+	int dir;
+
+	/* node, possibly a NULL leaf, lacks one black node on its paths */
+	while (node != tree->root && !_rb_is_red(node)) {
+		/* The sibling holds at least one black node, so it is not
+		 * NULL, and tells on which side a NULL node is.
+		 */
+		dir = (parent->child[1] == node);
+		sibling = parent->child[!dir];
+
+		if (_rb_is_red(sibling)) {
+			_rb_set_black(sibling);
+			_rb_set_red(parent);
+			_rb_rotate(tree, parent, dir);
+			sibling = parent->child[!dir];
+		}
+
+		if (!_rb_is_red(sibling->child[0]) &&
+		    !_rb_is_red(sibling->child[1])) {
+			_rb_set_red(sibling);
+			node = parent;
+			parent = _rb_parent(node);
+			continue;
+		}
+
+		if (!_rb_is_red(sibling->child[!dir])) {
+			_rb_set_black(sibling->child[dir]);
+			_rb_set_red(sibling);
+			_rb_rotate(tree, sibling, !dir);
+			sibling = parent->child[!dir];
+		}
+
+		if (_rb_is_red(parent)) {
+			_rb_set_red(sibling);
+		} else {
+			_rb_set_black(sibling);
+		}
+		_rb_set_black(parent);
+		_rb_set_black(sibling->child[!dir]);
+		_rb_rotate(tree, parent, dir);
+		node = tree->root;
+		break;
+	}
+
+	if (node) {
+		_rb_set_black(node);
+	}
+}
+
+/**
+ * @brief Get the first node of a tree, with the smallest key
+ *
+ * @param tree A pointer on the tree
+ *
+ * @return A pointer on the first node of the tree (or NULL if none)
+ */
+static inline sys_rbnode_t *sys_rb_min(sys_rbtree_t *tree)
+{
+	return _rb_end(tree, 0);
+}
+
+/**
+ * @brief Get the last node of a tree, with the largest key
+ *
+ * @param tree A pointer on the tree
+ *
+ * @return A pointer on the last node of the tree (or NULL if none)
+ */
+static inline sys_rbnode_t *sys_rb_max(sys_rbtree_t *tree)
+{
+	return _rb_end(tree, 1);
+}
+
+/**
+ * @brief Get the node following a node, in ascending order
+ *
+ * @param node A pointer on a node of a tree
+ *
+ * @return A pointer on the next node (or NULL if node is the last one)
+ */
+static inline sys_rbnode_t *sys_rb_next(const sys_rbnode_t *node)
+{
+	return _rb_step(node, 1);
+}
+
+/**
+ * @brief Get the node preceding a node, in ascending order
+ *
+ * @param node A pointer on a node of a tree
+ *
+ * @return A pointer on the previous node (or NULL if node is the first one)
+ */
+static inline sys_rbnode_t *sys_rb_prev(const sys_rbnode_t *node)
+{
+	return _rb_step(node, 0);
+}
+
+/**
+ * @brief Look up a node of a tree from its key
+ *
+ * @param tree A pointer on the tree to look into
+ * @param key A pointer on the key to look for, given back to cmp
+ * @param cmp The key comparison function, ordering keys as tree->cmp does
+ *
+ * @return A pointer on the node with the key (or NULL if none)
+ */
+static inline sys_rbnode_t *sys_rb_find(sys_rbtree_t *tree, const void *key,
+					sys_rb_key_cmp_t cmp)
+{
+	sys_rbnode_t *node = tree->root;
+	int ret;
+
+	while (node) {
+		ret = cmp(key, node);
+		if (!ret) {
+			break;
+		}
+
+		node = node->child[ret > 0];
+	}
+
+	return node;
+}
+
+/**
+ * @brief Insert a node in a tree
+ *
+ * The node is not inserted if the tree already holds a node with the same
+ * key, the node being compared with tree->cmp.
+ *
+ * @param tree A pointer on the tree to insert into
+ * @param node A pointer on the node to insert
+ *
+ * @return NULL once inserted, or a pointer on the node holding the same key
+ */
+static inline sys_rbnode_t *sys_rb_insert(sys_rbtree_t *tree,
+					  sys_rbnode_t *node)
+{
+	sys_rbnode_t **link = &tree->root;
+	sys_rbnode_t *parent = NULL;
+	int ret;
+
+	while (*link) {
+		parent = *link;
+
+		ret = tree->cmp(node, parent);
+		if (!ret) {
+			return parent;
+		}
+
+		link = &parent->child[ret > 0];
+	}
+
+	node->child[0] = NULL;
+	node->child[1] = NULL;
+	node->parent_color = (uintptr_t)parent | 1;
+	*link = node;
+
+	_rb_insert_fixup(tree, node);
+
+	return NULL;
+}
+
+/**
+ * @brief Remove a node from a tree
+ *
+ * @param tree A pointer on the tree holding the node
+ * @param node A pointer on the node to remove
+ */
+static inline void sys_rb_remove(sys_rbtree_t *tree, sys_rbnode_t *node)
+{
+	sys_rbnode_t *child, *parent, *next;
+	bool black;
+
+	if (!node->child[0] || !node->child[1]) {
+		child = node->child[0] ? node->child[0] : node->child[1];
+		parent = _rb_parent(node);
+		black = !_rb_is_red(node);
+
+		if (child) {
+			_rb_set_parent(child, parent);
+		}
+		_rb_replace_child(tree, parent, node, child);
+	} else {
+		/* Move the next node, lacking a left child, in place */
+		next = node->child[1];
+		while (next->child[0]) {
+			next = next->child[0];
+		}
+
+		child = next->child[1];
+		parent = _rb_parent(next);
+		black = !_rb_is_red(next);
+
+		if (parent == node) {
+			parent = next;
+		} else {
+			parent->child[0] = child;
+			if (child) {
+				_rb_set_parent(child, parent);
+			}
+
+			next->child[1] = node->child[1];
+			_rb_set_parent(next->child[1], next);
+		}
+
+		next->child[0] = node->child[0];
+		_rb_set_parent(next->child[0], next);
+
+		_rb_replace_child(tree, _rb_parent(node), node, next);
+		next->parent_color = node->parent_color;
+	}
+
+	if (black) {
+		_rb_remove_fixup(tree, child, parent);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RBTREE_H__ */
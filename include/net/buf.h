@@ -386,6 +386,13 @@ static inline void net_buf_simple_restore(struct net_buf_simple *buf,
   */
 #define NET_BUF_FRAGS        BIT(0)
 
+/** Flag indicating that the buffer data is not stored in the buffer
+  * itself but in memory owned by the user of the pool, typically a
+  * network driver handing its DMA buffers to the stack. Set by
+  * net_buf_alloc_ext().
+  */
+#define NET_BUF_EXTERNAL_DATA BIT(1)
+
 /** @brief Network buffer representation.
   *
   * This struct is used to represent network buffers. Such buffers are
@@ -415,6 +422,11 @@ struct net_buf {
 	/** Where the buffer should go when freed up. */
 	struct net_buf_pool *pool;
 
+#if defined(CONFIG_NET_BUF_POOL_OWNER)
+	/** Address of the code which allocated the buffer. */
+	void *owner;
+#endif
+
 	/* Union for convenience access to the net_buf_simple members, also
 	 * preserving the old API.
 	 */
@@ -440,6 +452,32 @@ struct net_buf {
 	uint8_t __buf[0] __net_buf_align;
 };
 
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+/** Usage statistics of a buffer pool */
+struct net_buf_pool_stats {
+	/** Number of buffers allocated */
+	uint32_t alloc;
+
+	/** Number of allocations which failed, after their timeout if any */
+	uint32_t fail;
+
+	/** Number of allocations which had to wait for a buffer */
+	uint32_t wait;
+
+	/** Total time spent waiting for buffers, in milliseconds */
+	uint32_t wait_ms;
+
+	/** Number of times the last free buffer was allocated */
+	uint32_t empty;
+
+	/** Number of buffers in use */
+	uint16_t used;
+
+	/** Highest number of buffers in use */
+	uint16_t peak;
+};
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+
 struct net_buf_pool {
 	/** LIFO to place the buffer into when free */
 	struct k_lifo free;
@@ -461,8 +499,22 @@ struct net_buf_pool {
 
 	/** Helper to access the start of storage (for net_buf_pool_init) */
 	struct net_buf * const __bufs;
+
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+	/** Name of the pool variable */
+	const char *name;
+
+	/** Usage statistics */
+	struct net_buf_pool_stats stats;
+#endif
 };
 
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+#define _NET_BUF_POOL_USAGE_INIT(_pool) .name = #_pool,
+#else
+#define _NET_BUF_POOL_USAGE_INIT(_pool)
+#endif
+
 #define NET_BUF_POOL_INITIALIZER(_pool, _bufs, _count, _size, _ud_size,      \
 				 _destroy)                                   \
 	{                                                                    \
@@ -473,6 +525,7 @@ struct net_buf_pool {
 		.buf_size = _size,                                           \
 		.user_data_size = _ud_size,                                  \
 		.destroy = _destroy,                                         \
+		_NET_BUF_POOL_USAGE_INIT(_pool)                              \
 	}
 
 /** @def NET_BUF_POOL_DEFINE
@@ -505,6 +558,28 @@ struct net_buf_pool {
 		NET_BUF_POOL_INITIALIZER(_name, _net_buf_pool_##_name,       \
 					 _count, _size, _ud_size, _destroy)
 
+/** @def NET_BUF_POOL_EXT_DEFINE
+ *  @brief Define a new pool for buffers with external data
+ *
+ *  Defines a pool whose buffers do not store any data, but describe data
+ *  stored elsewhere, as passed to net_buf_alloc_ext(). This allows e.g. a
+ *  network driver to pass the buffers its DMA engine received into to the
+ *  stack without copying them.
+ *
+ *  The recycle callback is called when the last reference to a buffer is
+ *  released. It gets the external data back with net_buf_ext_data(), e.g.
+ *  to return it to the RX descriptor ring of the driver, and must then call
+ *  net_buf_destroy() to return the buffer to the pool.
+ *
+ *  @param _name     Name of the pool variable.
+ *  @param _count    Number of buffers in the pool.
+ *  @param _ud_size  Amount of user data space to reserve.
+ *  @param _recycle  Callback when a buffer is freed.
+ */
+#define NET_BUF_POOL_EXT_DEFINE(_name, _count, _ud_size, _recycle)          \
+	NET_BUF_POOL_DEFINE(_name, _count, sizeof(uint8_t *), _ud_size,      \
+			    _recycle)
+
 /**
  *  @brief Allocate a new buffer from a pool.
  *
@@ -527,6 +602,52 @@ struct net_buf *net_buf_alloc_debug(struct net_buf_pool *pool, int32_t timeout,
 struct net_buf *net_buf_alloc(struct net_buf_pool *pool, int32_t timeout);
 #endif
 
+/**
+ *  @brief Allocate a new buffer with external data from a pool.
+ *
+ *  Allocate a buffer from a pool defined with NET_BUF_POOL_EXT_DEFINE(),
+ *  describing the given data. The data is owned by the caller until the
+ *  pool recycle callback is called for the buffer. The buffer contains
+ *  'len' bytes of data and has no headroom nor tailroom.
+ *
+ *  @param pool Which pool to allocate the buffer from.
+ *  @param data External data.
+ *  @param len Length of the external data.
+ *  @param timeout Affects the action taken should the pool be empty.
+ *         If K_NO_WAIT, then return immediately. If K_FOREVER, then
+ *         wait as long as necessary. Otherwise, wait up to the specified
+ *         number of ticks before timing out.
+ *
+ *  @return New buffer or NULL if out of buffers.
+ */
+#if defined(CONFIG_NET_BUF_LOG)
+struct net_buf *net_buf_alloc_ext_debug(struct net_buf_pool *pool,
+					uint8_t *data, uint16_t len,
+					int32_t timeout, const char *func,
+					int line);
+#define	net_buf_alloc_ext(_pool, _data, _len, _timeout) \
+	net_buf_alloc_ext_debug(_pool, _data, _len, _timeout, \
+				__func__, __LINE__)
+#else
+struct net_buf *net_buf_alloc_ext(struct net_buf_pool *pool, uint8_t *data,
+				  uint16_t len, int32_t timeout);
+#endif
+
+/**
+ *  @brief Get the external data of a buffer.
+ *
+ *  Get the start of the data passed to net_buf_alloc_ext(), e.g. from the
+ *  recycle callback of the pool.
+ *
+ *  @param buf Buffer with external data.
+ *
+ *  @return Start of the external data.
+ */
+static inline uint8_t *net_buf_ext_data(struct net_buf *buf)
+{
+	return *(uint8_t **)buf->__buf;
+}
+
 /**
  *  @brief Get a buffer from a FIFO.
  *
@@ -560,9 +681,61 @@ struct net_buf *net_buf_get(struct k_fifo *fifo, int32_t timeout);
  */
 static inline void net_buf_destroy(struct net_buf *buf)
 {
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+	unsigned int key = irq_lock();
+
+	buf->pool->stats.used--;
+	irq_unlock(key);
+#endif
+
 	k_lifo_put(&buf->pool->free, buf);
 }
 
+/**
+ *  @brief Set the owner of a buffer
+ *
+ *  The owner is the code address net_buf_alloc() was called from. A layer
+ *  allocating buffers for others sets it to the address of its own caller
+ *  instead, with CONFIG_NET_BUF_POOL_OWNER.
+ *
+ *  @param buf Buffer.
+ *  @param owner Code address, e.g. __builtin_return_address(0).
+ */
+static inline void net_buf_set_owner(struct net_buf *buf, void *owner)
+{
+#if defined(CONFIG_NET_BUF_POOL_OWNER)
+	if (buf) {
+		buf->owner = owner;
+	}
+#endif
+}
+
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+/**
+ *  @brief Get the usage statistics of a pool
+ *
+ *  @param pool Buffer pool.
+ *  @param stats The statistics are copied here.
+ */
+void net_buf_pool_stats_get(struct net_buf_pool *pool,
+			    struct net_buf_pool_stats *stats);
+
+/**
+ *  @brief Call a function for each buffer of a pool which is in use
+ *
+ *  This lists the buffers held e.g. when a pool is exhausted. The buffers
+ *  can be released meanwhile: the callback must only look at them.
+ *
+ *  @param pool Buffer pool.
+ *  @param cb Function to call.
+ *  @param user_data User data passed to the function.
+ */
+void net_buf_pool_foreach_used(struct net_buf_pool *pool,
+			       void (*cb)(struct net_buf *buf,
+					  void *user_data),
+			       void *user_data);
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+
 /**
  *  @brief Initialize buffer with the given headroom.
  *
@@ -586,6 +759,19 @@ void net_buf_reserve(struct net_buf *buf, size_t reserve);
  */
 void net_buf_put(struct k_fifo *fifo, struct net_buf *buf);
 
+/**
+ *  @brief Put several buffers into a FIFO
+ *
+ *  Put buffers to the end of a FIFO, in order and with their follow-up
+ *  fragments, in one go: the FIFO is only locked once, and a thread
+ *  waiting on it only woken up once.
+ *
+ *  @param fifo Which FIFO to put the buffers to.
+ *  @param bufs Array of buffers.
+ *  @param count Number of buffers in the array.
+ */
+void net_buf_put_list(struct k_fifo *fifo, struct net_buf **bufs, int count);
+
 /**
  *  @brief Decrements the reference count of a buffer.
  *
@@ -635,7 +821,8 @@ struct net_buf *net_buf_clone(struct net_buf *buf, int32_t timeout);
  */
 static inline void *net_buf_user_data(struct net_buf *buf)
 {
-	return (void *)ROUND_UP((buf->__buf + buf->size), sizeof(int));
+	return (void *)ROUND_UP((buf->__buf + buf->pool->buf_size),
+				sizeof(int));
 }
 
 /**
@@ -863,7 +1050,6 @@ static inline void *net_buf_user_data(struct net_buf *buf)
 #define net_buf_pull_be32(buf) net_buf_simple_pull_be32(&(buf)->b)
 
 /**
- *  @def net_buf_tailroom
  *  @brief Check buffer tailroom.
  *
  *  Check how much free space there is at the end of the buffer.
@@ -872,10 +1058,9 @@ static inline void *net_buf_user_data(struct net_buf *buf)
  *
  *  @return Number of bytes available at the end of the buffer.
  */
-#define net_buf_tailroom(buf) net_buf_simple_tailroom(&(buf)->b)
+size_t net_buf_tailroom(struct net_buf *buf);
 
 /**
- *  @def net_buf_headroom
  *  @brief Check buffer headroom.
  *
  *  Check how much free space there is in the beginning of the buffer.
@@ -884,7 +1069,7 @@ static inline void *net_buf_user_data(struct net_buf *buf)
  *
  *  @return Number of bytes available in the beginning of the buffer.
  */
-#define net_buf_headroom(buf) net_buf_simple_headroom(&(buf)->b)
+size_t net_buf_headroom(struct net_buf *buf);
 
 /**
  *  @def net_buf_tail
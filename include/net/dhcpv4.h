@@ -13,6 +13,7 @@
 
 #include <misc/slist.h>
 #include <stdint.h>
+#include <net/net_ip.h>
 
 /** Current state of DHCPv4 client address negotiation */
 enum net_dhcpv4_state {
@@ -22,14 +23,52 @@ enum net_dhcpv4_state {
 	NET_DHCPV4_REQUEST,
 	NET_DHCPV4_RENEWAL,
 	NET_DHCPV4_ACK,
+	NET_DHCPV4_INIT_REBOOT,
 };
 
+#if defined(CONFIG_NET_DHCPV4_LEASE_STORAGE)
+/** DHCPv4 lease kept across reboots */
+struct net_dhcpv4_lease {
+	struct in_addr addr;
+	struct in_addr server_id;
+	struct in_addr netmask;
+	struct in_addr gw;
+	/** Lease time in seconds */
+	uint32_t lease_time;
+};
+
+/**
+ *  @brief Storage of the DHCPv4 lease
+ *
+ *  @details The callbacks return 0 if ok, or a negative error code.
+ *  load() returns -ENOENT when no lease is stored.
+ */
+struct net_dhcpv4_storage {
+	int (*load)(struct net_if *iface, struct net_dhcpv4_lease *lease);
+	int (*save)(struct net_if *iface,
+		    const struct net_dhcpv4_lease *lease);
+	int (*clear)(struct net_if *iface);
+};
+
+/**
+ *  @brief Set the storage of the DHCPv4 lease
+ *
+ *  @details To be called before net_dhcpv4_start(). The lease is saved
+ *  each time the server acknowledges it, and cleared when it is refused.
+ *
+ *  @param storage Storage callbacks, NULL for none
+ */
+void net_dhcpv4_set_storage(const struct net_dhcpv4_storage *storage);
+#endif /* CONFIG_NET_DHCPV4_LEASE_STORAGE */
+
 /**
  *  @brief Start DHCPv4 client
  *
  *  @details Start DHCPv4 client on a given interface. DHCPv4 client
  *  will start negotiation for IPv4 address. Once the negotiation is
  *  success IPv4 address details will be added to interface.
+ *  With CONFIG_NET_DHCPV4_LEASE_STORAGE, a stored lease is first
+ *  requested again in the INIT-REBOOT state.
  *
  *  @param iface A valid pointer on an interface
  */
@@ -16,10 +16,6 @@ enum dns_query_type {
 };
 
 struct dns_context {
-	/* rx_sem and rx buffer, for internal use only */
-	struct k_sem rx_sem;
-	struct net_buf *rx_buf;
-
 	/** Previously initialized network context */
 	struct net_context *net_ctx;
 
@@ -95,4 +91,34 @@ int dns_init(struct dns_context *ctx);
  */
 int dns_resolve(struct dns_context *ctx);
 
+/**
+ * @brief dns_resolve_parallel	Retrieves the IP addresses of several
+ *				DNS contexts at once
+ * @details		The queries of all the contexts are outstanding at
+ *			the same time, each one waits for its response
+ *			during its own 'timeout'. For example, the A and
+ *			AAAA records of a name are retrieved in parallel
+ *			with one context for each query type.
+ *			The contexts may share their network context.
+ *
+ * @param ctx		Array of 'count' DNS Client structures
+ * @param count		Number of contexts, up to
+ *			CONFIG_DNS_RESOLVER_MAX_PARALLEL
+ * @return		0 if at least one context was resolved, the
+ *			'items' of the others are set to 0.
+ * @return		Otherwise, the dns_resolve error of the first
+ *			context.
+ */
+int dns_resolve_parallel(struct dns_context *ctx[], uint8_t count);
+
+/**
+ * @brief dns_cache_flush	Drops the answers kept by the resolver
+ * @details		Answers are cached during their TTL when
+ *			CONFIG_DNS_RESOLVER_CACHE is set, names without
+ *			records during CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL.
+ *			For example, the cache should be flushed when the
+ *			network or the DNS server changes.
+ */
+void dns_cache_flush(void);
+
 #endif
@@ -18,6 +18,7 @@
 
 #include <net/net_ip.h>
 #include <net/nbuf.h>
+#include <net/net_if.h>
 #include <misc/util.h>
 
 #define NET_ETH_BUF(buf) ((struct net_eth_hdr *)net_nbuf_ll(buf))
@@ -64,4 +65,39 @@ static inline bool net_eth_is_addr_multicast(struct net_eth_addr *addr)
 
 const struct net_eth_addr *net_eth_broadcast_addr(void);
 
+/**
+ * @brief Ethernet driver API
+ *
+ * A driver whose interface has the NET_IF_MCAST_FILTER flag provides this
+ * API, the network interface API being its first member: the multicast
+ * frames are then dropped by the device unless their destination address
+ * has been added to its filter.
+ */
+struct ethernet_api {
+	struct net_if_api iface_api;
+
+	/**
+	 * Add the multicast MAC address to the filter of the device, or
+	 * remove it. Every addition is matched by one removal, the same
+	 * address possibly being added several times.
+	 */
+	int (*mcast_filter)(struct device *dev,
+			    const struct net_eth_addr *addr, bool add);
+};
+
+#if defined(CONFIG_NET_IPV6)
+/**
+ * @brief Update the multicast filter of the device for an IPv6 address
+ *
+ * Called by the network interface when it joins or leaves a multicast
+ * group, the solicited-node group of a unicast address included.
+ *
+ * @param iface Network interface.
+ * @param addr IPv6 multicast address.
+ * @param add True when joining the group, false when leaving it.
+ */
+void net_eth_ipv6_mcast_filter(struct net_if *iface,
+			       const struct in6_addr *addr, bool add);
+#endif
+
 #endif /* __ETHERNET_H */
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief HTTP/1.1 server engine built on the http_parser library.
+ */
+
+#ifndef __HTTP_SERVER_H__
+#define __HTTP_SERVER_H__
+
+#include <sys/types.h>
+#include <net/net_context.h>
+#include <net/http_parser.h>
+
+struct http_server_conn;
+
+/**
+ * @brief Route handler.
+ *
+ * @details Called once the request is received whole. The handler writes
+ * the response with http_server_response() and http_server_write(), the
+ * response is completed when the handler returns.
+ *
+ * @param conn Connection the request was received on.
+ *
+ * @return 0 if ok, a negative error code closes the connection.
+ */
+typedef int (*http_server_handler_t)(struct http_server_conn *conn);
+
+/**
+ * @brief Request body callback, called for each piece of the body.
+ */
+typedef int (*http_server_body_t)(struct http_server_conn *conn,
+				  const uint8_t *data, size_t len);
+
+/**
+ * @brief Entry of a route table.
+ *
+ * @details A route either serves a static body, whose status line and
+ * headers are built once by http_server_init(), or calls a handler.
+ */
+struct http_server_route {
+	/** Path of the route, a trailing '*' matches any suffix */
+	const char *path;
+	/** enum http_method of the route */
+	uint8_t method;
+
+	/** Static body, or NULL when the route has a handler */
+	const uint8_t *body;
+	size_t body_len;
+	/** Content-Type of the static body */
+	const char *content_type;
+
+	http_server_handler_t handler;
+	/** Optional, receives the request body before the handler runs */
+	http_server_body_t body_cb;
+	void *user_data;
+
+	/* Internal use only: precomputed headers of the static body */
+	char headers[CONFIG_HTTP_SERVER_HEADERS_SIZE];
+	uint8_t headers_len;
+};
+
+/**
+ * @brief Route serving a static body, given as a string literal.
+ */
+#define HTTP_SERVER_STATIC_ROUTE(_path, _content_type, _body)	\
+	{ .path = (_path), .method = HTTP_GET,			\
+	  .body = (const uint8_t *)(_body),			\
+	  .body_len = sizeof(_body) - 1,			\
+	  .content_type = (_content_type),			\
+	}
+
+/**
+ * @brief A client connection, handles the requests one after the other.
+ */
+struct http_server_conn {
+	struct http_server *server;
+	struct net_context *net_ctx;
+	struct http_parser parser;
+	/** Route of the request being received, NULL if unknown */
+	struct http_server_route *route;
+	/** Response being written, sent when it is big enough or once the
+	 * requests received are handled
+	 */
+	struct net_buf *tx;
+	/** Closes the connection when there is no request for a while */
+	struct k_delayed_work idle_timer;
+	/** Path of the request being received, NUL terminated */
+	char url[CONFIG_HTTP_SERVER_URL_SIZE];
+	uint16_t url_len;
+	uint8_t in_use:1;
+	uint8_t chunked:1;
+	uint8_t responded:1;
+	uint8_t closing:1;
+};
+
+/**
+ * @brief HTTP server.
+ */
+struct http_server {
+	struct http_server_route *routes;
+	uint16_t routes_count;
+	/** Timeout for the tx buffers and sending */
+	int32_t timeout;
+	struct http_server_conn conns[CONFIG_HTTP_SERVER_CONNECTIONS];
+};
+
+/**
+ * @brief Initialize a server with its route table.
+ *
+ * @details The headers of the static routes are built here.
+ *
+ * @param server Server to initialize.
+ * @param routes Route table, the first matching route is used.
+ * @param count Number of routes.
+ *
+ * @return 0 if ok, -EINVAL if the headers of a static route do not fit in
+ * CONFIG_HTTP_SERVER_HEADERS_SIZE.
+ */
+int http_server_init(struct http_server *server,
+		     struct http_server_route *routes, uint16_t count);
+
+/**
+ * @brief Start accepting connections.
+ *
+ * @param server Initialized server.
+ * @param net_ctx TCP context, bound to the local address of the server.
+ *
+ * @return 0 if ok, a net_context_listen() or net_context_accept() error
+ * otherwise.
+ */
+int http_server_start(struct http_server *server,
+		      struct net_context *net_ctx);
+
+/**
+ * @brief Write the status line and the headers of a response.
+ *
+ * @param conn Connection.
+ * @param status HTTP status code, e.g. 200.
+ * @param content_type Content-Type of the body, NULL for none.
+ * @param len Length of the body, or -1 to stream it with the chunked
+ * transfer encoding.
+ *
+ * @return 0 if ok, -EALREADY if a response was already written, -ENOMEM
+ * if no buffer is available.
+ */
+int http_server_response(struct http_server_conn *conn, int status,
+			 const char *content_type, ssize_t len);
+
+/**
+ * @brief Write a piece of the body of a response.
+ *
+ * @details The data is appended to the net_buf chain of the response,
+ * which is sent each time it reaches CONFIG_HTTP_SERVER_TX_THRESHOLD
+ * bytes. With the chunked transfer encoding, each call writes a chunk.
+ *
+ * @return 0 if ok, -ENOMEM if no buffer is available, -EIO on network
+ * error.
+ */
+int http_server_write(struct http_server_conn *conn, const void *data,
+		      uint16_t len);
+
+/**
+ * @brief Get the method of the request being handled.
+ */
+static inline enum http_method
+http_server_method(const struct http_server_conn *conn)
+{
+	return (enum http_method)conn->parser.method;
+}
+
+#endif /* __HTTP_SERVER_H__ */
@@ -61,6 +61,7 @@ enum net_request_ieee802154_cmd {
 	NET_REQUEST_IEEE802154_CMD_SET_CHAN,
 	NET_REQUEST_IEEE802154_CMD_SET_PAN_ID,
 	NET_REQUEST_IEEE802154_CMD_SET_SHORT_ADDR,
+	NET_REQUEST_IEEE802154_CMD_SET_SECURITY_SETTINGS,
 };
 
 
@@ -114,6 +115,12 @@ NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_IEEE802154_SET_PAN_ID);
 
 NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_IEEE802154_SET_SHORT_ADDR);
 
+#define NET_REQUEST_IEEE802154_SET_SECURITY_SETTINGS			\
+	(_NET_IEEE802154_BASE |						\
+	 NET_REQUEST_IEEE802154_CMD_SET_SECURITY_SETTINGS)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_IEEE802154_SET_SECURITY_SETTINGS);
+
 enum net_event_ieee802154_cmd {
 	NET_EVENT_IEEE802154_CMD_SCAN_RESULT = 1,
 };
@@ -162,4 +169,45 @@ struct ieee802154_req_params {
 	uint8_t lqi;
 } __packed;
 
+/* Security levels, see Section 7.6.2.2.1 */
+enum ieee802154_security_level {
+	IEEE802154_SECURITY_LEVEL_NONE		= 0x0,
+	IEEE802154_SECURITY_LEVEL_MIC_32	= 0x1,
+	IEEE802154_SECURITY_LEVEL_MIC_64	= 0x2,
+	IEEE802154_SECURITY_LEVEL_MIC_128	= 0x3,
+	IEEE802154_SECURITY_LEVEL_ENC		= 0x4,
+	IEEE802154_SECURITY_LEVEL_ENC_MIC_32	= 0x5,
+	IEEE802154_SECURITY_LEVEL_ENC_MIC_64	= 0x6,
+	IEEE802154_SECURITY_LEVEL_ENC_MIC_128	= 0x7,
+};
+
+/* Key identifier modes, see Section 7.6.2.2.2 */
+enum ieee802154_key_id_mode {
+	/** The key is the default one, known from the addresses */
+	IEEE802154_KEY_ID_MODE_IMPLICIT		= 0x0,
+	/** The key is given by its index */
+	IEEE802154_KEY_ID_MODE_INDEX		= 0x1,
+};
+
+#define IEEE802154_SECURITY_KEY_LENGTH	16
+
+/**
+ * @brief Security settings
+ *
+ * Adds a key to the key table, or replaces the one with the same index,
+ * and sets how the outgoing data frames are secured.
+ */
+struct ieee802154_security_params {
+	/** AES-128 key, ignored when key_len is 0 */
+	uint8_t key[IEEE802154_SECURITY_KEY_LENGTH];
+	/** IEEE802154_SECURITY_KEY_LENGTH, or 0 to keep the key table */
+	uint8_t key_len;
+	/** enum ieee802154_key_id_mode of the outgoing frames */
+	uint8_t key_mode;
+	/** Index of the key, the implicit key has index 0 */
+	uint8_t key_index;
+	/** enum ieee802154_security_level of the outgoing frames */
+	uint8_t level;
+} __packed;
+
 #endif /* __IEEE802154_H__ */
@@ -53,6 +53,19 @@ struct ieee802154_radio_api {
 
 	/** Get latest Link Quality Information */
 	uint8_t (*get_lqi)(struct device *dev);
+
+	/** Set or clear the frame pending bit of the ACKs sent to a device,
+	 *  the address being given as found in frames. Optional: NULL if
+	 *  the radio cannot match the source address of received frames.
+	 */
+	int (*set_pending)(struct device *dev, const uint8_t *addr,
+			   uint8_t addr_len, bool pending);
+
+	/** Encrypt a 16 bytes block in place with AES-128. Optional: NULL
+	 *  if the radio has no AES engine.
+	 */
+	int (*aes_encrypt)(struct device *dev, const uint8_t *key,
+			   uint8_t *block);
 } __packed;
 
 /**
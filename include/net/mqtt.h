@@ -48,7 +48,12 @@ enum mqtt_app {
  * structs).
  *
  * <b>NOTE: The application (and not the API) is in charge of keeping track of
- * the state of the received and sent messages.</b>
+ * the state of the received messages.</b>
+ *
+ * Sent PUBLISH messages are stored by the context until they are
+ * acknowledged: up to CONFIG_MQTT_INFLIGHT_MAX QoS 1 and QoS 2 messages are
+ * in flight, the following ones wait in the outbound queue. The stored
+ * messages are kept across reconnections, see mqtt_attach.
  */
 struct mqtt_ctx {
 	/** IP stack context structure */
@@ -113,7 +118,12 @@ struct mqtt_ctx {
 	 * @param [in] data	User provided data, represented by
 	 *			#publish_rx_data
 	 * @param [in] msg	Publish message, this parameter is only used
-	 *			when the type is MQTT_PUBLISH
+	 *			when the type is MQTT_PUBLISH. The payload is
+	 *			received in chunks: the callback is executed
+	 *			for each chunk, msg->msg being the msg->msg_len
+	 *			bytes at msg->msg_offset in the
+	 *			msg->msg_total_len bytes of the payload. The
+	 *			message is acknowledged after its last chunk.
 	 * @param [in] pkt_id	Packet Identifier for the input msg
 	 * @param [in] type	Packet type
 	 * @return		If this callback returns 0, the caller will
@@ -174,7 +184,7 @@ struct mqtt_ctx {
 	void *unsubscribe_data;
 
 	/* Internal use only */
-	int (*rcv)(struct mqtt_ctx *, struct net_buf *);
+	int (*rcv)(struct mqtt_ctx *, uint8_t *, uint16_t);
 
 	/** Application type, see: enum mqtt_app */
 	uint8_t app_type;
@@ -187,6 +197,21 @@ struct mqtt_ctx {
 
 	/** 1 if the MQTT application is connected and 0 otherwise */
 	uint8_t connected:1;
+
+	/* Internal use only */
+	/** PUBLISH messages waiting to be sent */
+	sys_slist_t tx_queue;
+	/** QoS 1 and QoS 2 PUBLISH messages waiting for their ack */
+	sys_slist_t inflight;
+	/** Number of messages in #tx_queue */
+	uint8_t tx_queue_cnt;
+	/** Number of messages in #inflight */
+	uint8_t inflight_cnt;
+
+	/** Parser of the received stream */
+	struct mqtt_parser parser;
+	/** Received messages and PUBLISH headers, see #parser */
+	uint8_t rx_buf[CONFIG_MQTT_MSG_MAX_SIZE];
 };
 
 /**
@@ -197,6 +222,18 @@ struct mqtt_ctx {
  */
 int mqtt_init(struct mqtt_ctx *ctx, enum mqtt_app app_type);
 
+/**
+ * @brief mqtt_attach		Attaches the MQTT context structure to the
+ *				network context in #net_ctx
+ * @details			This routine is used after a reconnection, once
+ *				#net_ctx is replaced by the new connection. The
+ *				stored PUBLISH messages are kept, they are sent
+ *				again after the next MQTT CONNACK msg.
+ * @param ctx			MQTT context structure
+ * @return			0, always.
+ */
+int mqtt_attach(struct mqtt_ctx *ctx);
+
 /**
  * @brief mqtt_tx_connect	Sends the MQTT CONNECT message
  * @param [in] ctx		MQTT context structure
@@ -274,15 +311,51 @@ int mqtt_tx_pubrel(struct mqtt_ctx *ctx, uint16_t id);
 
 /**
  * @brief mqtt_tx_publish	Sends the MQTT PUBLISH message
+ * @details			The message is queued behind the messages not
+ *				sent yet, then the queue is flushed, see
+ *				mqtt_tx_flush. So, the message may still be
+ *				queued when this routine returns.
  * @param [in] ctx		MQTT context structure
  * @param [in] msg		MQTT PUBLISH msg
  * @return			0 on success
  * @return			-EINVAL if an invalid parameter was passed to
  *				this routine
+ * @return			-ENOMEM if the outbound queue is full or a tx
+ *				buffer is not available
+ * @return			-EIO on network error, the message is kept in
+ *				the outbound queue
+ */
+int mqtt_tx_publish(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg);
+
+/**
+ * @brief mqtt_tx_publish_queue	Queues the MQTT PUBLISH message, without
+ *				sending it
+ * @details			This allows several messages to be sent at once
+ *				by mqtt_tx_flush.
+ * @param [in] ctx		MQTT context structure
+ * @param [in] msg		MQTT PUBLISH msg
+ * @return			0 on success
+ * @return			-EINVAL if an invalid parameter was passed to
+ *				this routine
+ * @return			-ENOMEM if the outbound queue is full
+ */
+int mqtt_tx_publish_queue(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg);
+
+/**
+ * @brief mqtt_tx_flush		Sends the queued MQTT PUBLISH messages
+ * @details			Consecutive messages are coalesced into one
+ *				network buffer of up to
+ *				CONFIG_MQTT_TX_BATCH_SIZE bytes. It stops at
+ *				the first QoS 1 or QoS 2 message not fitting in
+ *				the in-flight window, the queue is flushed again
+ *				when an acknowledgement is received. Nothing is
+ *				sent while the context is not connected.
+ * @param [in] ctx		MQTT context structure
+ * @return			0 on success
  * @return			-ENOMEM if a tx buffer is not available
  * @return			-EIO on network error
  */
-int mqtt_tx_publish(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg);
+int mqtt_tx_flush(struct mqtt_ctx *ctx);
 
 /**
  * @brief mqtt_tx_pingreq	Sends the MQTT PINGREQ message
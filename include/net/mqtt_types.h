@@ -74,6 +74,46 @@ struct mqtt_publish_msg {
 	uint16_t topic_len;
 	uint8_t *msg;
 	uint16_t msg_len;
+	/* only used for unpacking: a received payload is delivered in
+	 * chunks, msg is the chunk at msg_offset in the msg_total_len bytes
+	 * of the payload
+	 */
+	uint32_t msg_offset;
+	uint32_t msg_total_len;
+};
+
+/**
+ * @brief mqtt_parser	Incremental parser of a stream of MQTT messages
+ * @details		The stream is consumed in pieces of any size, see
+ *			mqtt_parser_input. The messages, but PUBLISH, are kept
+ *			in the parser buffer until they are received whole.
+ *			For PUBLISH, only the fixed and variable headers are
+ *			kept, the payload is delivered in chunks as it is
+ *			received, so its size is not limited.
+ */
+struct mqtt_parser {
+	/** Called when a message, but PUBLISH, is received whole */
+	int (*message)(struct mqtt_parser *parser, uint8_t *buf,
+		       uint16_t len);
+	/** Called for each chunk of a PUBLISH payload, with an empty chunk
+	 * when the payload is empty. The fields of msg are valid until
+	 * the last chunk.
+	 */
+	int (*publish)(struct mqtt_parser *parser,
+		       struct mqtt_publish_msg *msg);
+	/** User data, not used by the parser */
+	void *user_data;
+
+	/* Internal use only */
+	struct mqtt_publish_msg msg;
+	uint8_t *buf;
+	uint16_t size;
+	uint16_t len;
+	uint16_t hdr_len;
+	uint32_t rlen;
+	uint32_t pos;
+	uint8_t shift;
+	uint8_t state;
 };
 
 #endif
@@ -60,6 +60,7 @@ struct net_nbuf {
 	uint8_t ip_hdr_len;	/* pre-filled in order to avoid func call */
 	uint8_t ext_len;	/* length of extension headers */
 	uint8_t ext_bitmap;
+	uint8_t priority;	/* see enum net_priority */
 
 #if defined(CONFIG_NET_IPV6)
 	uint8_t ext_opt_len; /* IPv6 ND option length */
@@ -68,6 +69,18 @@ struct net_nbuf {
 #if defined(CONFIG_NET_TCP)
 	bool buf_sent; /* Is this net_buf sent or not */
 #endif
+
+#if defined(CONFIG_NET_TCP_GSO)
+	uint16_t gso_size; /* segment size to split the TCP payload in */
+#endif
+
+#if defined(CONFIG_NET_LOOPBACK_FAST_PATH)
+	bool loopback; /* Sent to a local address, never leaves the device */
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_LATENCY)
+	uint32_t stamp; /* cycles when the last pipeline stage was passed */
+#endif
 	/* @endcond */
 };
 
@@ -157,6 +170,17 @@ static inline void net_nbuf_add_ext_bitmap(struct net_buf *buf, uint8_t bm)
 	((struct net_nbuf *)net_buf_user_data(buf))->ext_bitmap |= bm;
 }
 
+static inline enum net_priority net_nbuf_priority(struct net_buf *buf)
+{
+	return ((struct net_nbuf *)net_buf_user_data(buf))->priority;
+}
+
+static inline void net_nbuf_set_priority(struct net_buf *buf,
+					 enum net_priority priority)
+{
+	((struct net_nbuf *)net_buf_user_data(buf))->priority = priority;
+}
+
 static inline uint8_t *net_nbuf_next_hdr(struct net_buf *buf)
 {
 	return ((struct net_nbuf *)net_buf_user_data(buf))->next_hdr;
@@ -191,6 +215,56 @@ static inline void net_nbuf_set_buf_sent(struct net_buf *buf, bool sent)
 }
 #endif
 
+#if defined(CONFIG_NET_TCP_GSO)
+static inline uint16_t net_nbuf_gso_size(struct net_buf *buf)
+{
+	return ((struct net_nbuf *)net_buf_user_data(buf))->gso_size;
+}
+
+static inline void net_nbuf_set_gso_size(struct net_buf *buf, uint16_t size)
+{
+	((struct net_nbuf *)net_buf_user_data(buf))->gso_size = size;
+}
+#else
+static inline uint16_t net_nbuf_gso_size(struct net_buf *buf)
+{
+	ARG_UNUSED(buf);
+
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_NET_LOOPBACK_FAST_PATH)
+static inline bool net_nbuf_loopback(struct net_buf *buf)
+{
+	return ((struct net_nbuf *)net_buf_user_data(buf))->loopback;
+}
+
+static inline void net_nbuf_set_loopback(struct net_buf *buf, bool loopback)
+{
+	((struct net_nbuf *)net_buf_user_data(buf))->loopback = loopback;
+}
+#else
+static inline bool net_nbuf_loopback(struct net_buf *buf)
+{
+	ARG_UNUSED(buf);
+
+	return false;
+}
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_LATENCY)
+static inline uint32_t net_nbuf_stamp(struct net_buf *buf)
+{
+	return ((struct net_nbuf *)net_buf_user_data(buf))->stamp;
+}
+
+static inline void net_nbuf_set_stamp(struct net_buf *buf, uint32_t stamp)
+{
+	((struct net_nbuf *)net_buf_user_data(buf))->stamp = stamp;
+}
+#endif
+
 static inline uint16_t net_nbuf_get_len(struct net_buf *buf)
 {
 	return buf->len;
@@ -304,6 +378,29 @@ static inline void net_nbuf_set_src_ipv6_addr(struct net_buf *buf)
 
 /* @endcond */
 
+/**
+ * @brief Define a pool of TX buffers for network contexts.
+ *
+ * @details See net_context_setup_pools().
+ *
+ * @param name Name of the pool variable.
+ * @param count Number of buffers in the pool.
+ */
+#define NET_NBUF_TX_POOL_DEFINE(name, count)				\
+	NET_BUF_POOL_DEFINE(name, count, 0, sizeof(struct net_nbuf), NULL)
+
+/**
+ * @brief Define a pool of data fragments for network contexts.
+ *
+ * @details See net_context_setup_pools().
+ *
+ * @param name Name of the pool variable.
+ * @param count Number of fragments in the pool.
+ */
+#define NET_NBUF_DATA_POOL_DEFINE(name, count)				\
+	NET_BUF_POOL_DEFINE(name, count, CONFIG_NET_NBUF_DATA_SIZE,	\
+			    CONFIG_NET_NBUF_USER_DATA_SIZE, NULL)
+
 #if defined(CONFIG_NET_DEBUG_NET_BUF)
 
 /* Debug versions of the nbuf functions that are used when tracking
@@ -340,6 +437,12 @@ struct net_buf *net_nbuf_get_reserve_data_debug(uint16_t reserve_head,
 #define net_nbuf_get_reserve_data(res) \
 	net_nbuf_get_reserve_data_debug(res, __func__, __LINE__)
 
+struct net_buf *net_nbuf_get_ext_data_debug(struct net_buf_pool *pool,
+					    uint8_t *data, uint16_t len,
+					    const char *caller, int line);
+#define net_nbuf_get_ext_data(pool, data, len) \
+	net_nbuf_get_ext_data_debug(pool, data, len, __func__, __LINE__)
+
 void net_nbuf_unref_debug(struct net_buf *buf, const char *caller, int line);
 #define net_nbuf_unref(buf) net_nbuf_unref_debug(buf, __func__, __LINE__)
 
@@ -439,6 +542,26 @@ struct net_buf *net_nbuf_get_reserve_tx(uint16_t reserve_head);
  */
 struct net_buf *net_nbuf_get_reserve_data(uint16_t reserve_head);
 
+/**
+ * @brief Get a DATA fragment describing data owned by a driver.
+ *
+ * @details Lets a network driver pass the buffer it received a frame
+ * into, typically a DMA buffer, to the stack without copying it. The
+ * fragment is allocated from a pool defined with
+ * NET_BUF_POOL_EXT_DEFINE() with CONFIG_NET_NBUF_USER_DATA_SIZE bytes of
+ * user data, whose recycle callback gets the data back when the stack
+ * releases the fragment. This does not block, so it can be called from
+ * an ISR.
+ *
+ * @param pool Pool of fragments with external data.
+ * @param data Received data.
+ * @param len Length of the received data.
+ *
+ * @return Network buffer if successful, NULL otherwise.
+ */
+struct net_buf *net_nbuf_get_ext_data(struct net_buf_pool *pool,
+				      uint8_t *data, uint16_t len);
+
 /**
  * @brief Place buffer back into the available buffers pool.
  *
@@ -528,6 +651,23 @@ int net_nbuf_linear_copy(struct net_buf *dst, struct net_buf *src,
  */
 struct net_buf *net_nbuf_compact(struct net_buf *buf);
 
+/**
+ * @brief Copy a packet to a contiguous buffer.
+ *
+ * @details For drivers which cannot transmit fragment chains directly,
+ * see NET_IF_TX_SG. The link layer header and all the data fragments are
+ * copied, in a single pass, to a buffer the device can transmit from,
+ * typically the DMA buffer of its TX descriptor.
+ *
+ * @param buf Network buffer, with the link layer header reserved in its
+ * first fragment.
+ * @param dst Destination buffer.
+ * @param len Length of the destination buffer.
+ *
+ * @return Length of the packet copied, -ENOBUFS if it does not fit.
+ */
+int net_nbuf_linearize(struct net_buf *buf, uint8_t *dst, size_t len);
+
 /**
  * @brief Check if the buffer chain is compact or not.
  *
@@ -749,6 +889,164 @@ struct net_buf *net_nbuf_read_be16(struct net_buf *buf, uint16_t offset,
 struct net_buf *net_nbuf_read_be32(struct net_buf *buf, uint16_t offset,
 				   uint16_t *pos, uint32_t *value);
 
+/**
+ * @brief View over the data of a fragment chain.
+ *
+ * @details A view is a cursor walking a range of data in a fragment list,
+ * for parsers to consume the data in place instead of copying it to a
+ * contiguous buffer first. Reading from a view does not modify the
+ * fragments, net_nbuf_view_release() frees what has been consumed.
+ */
+struct net_nbuf_view {
+	/** Fragment the cursor is in, NULL at the end of the data */
+	struct net_buf *frag;
+
+	/** Position of the cursor in the fragment */
+	uint16_t pos;
+
+	/** Length of the data left in the view */
+	uint16_t len;
+};
+
+/**
+ * @brief Initialize a view over a fragment list.
+ *
+ * @param view View to initialize.
+ * @param frag Network buffer fragment.
+ * @param offset Offset of the data from the start of the fragment, the
+ * offset can be beyond the fragment.
+ * @param len Length of the data in the view.
+ *
+ * @return 0 if ok, -ENODATA if the fragments do not have that much data.
+ */
+int net_nbuf_view_init(struct net_nbuf_view *view, struct net_buf *frag,
+		       uint16_t offset, uint16_t len);
+
+/**
+ * @brief Initialize a view over the application data of a buffer.
+ *
+ * @param view View to initialize.
+ * @param buf Network buffer, as given to the net_context receive callback.
+ *
+ * @return 0 if ok, -ENODATA if the buffer has no such data.
+ */
+int net_nbuf_view_appdata(struct net_nbuf_view *view, struct net_buf *buf);
+
+/**
+ * @brief Get the length of the data left in a view.
+ *
+ * @param view View.
+ *
+ * @return Number of bytes left.
+ */
+static inline uint16_t net_nbuf_view_len(const struct net_nbuf_view *view)
+{
+	return view->len;
+}
+
+/**
+ * @brief Get the contiguous data at the cursor of a view.
+ *
+ * @details The data is not consumed.
+ *
+ * @param view View.
+ * @param len Length of the contiguous data is returned here, which is the
+ * rest of the current fragment or less.
+ *
+ * @return Pointer to the data, NULL if the view is empty.
+ */
+static inline uint8_t *net_nbuf_view_span(const struct net_nbuf_view *view,
+					  uint16_t *len)
+{
+	if (!view->len) {
+		*len = 0;
+		return NULL;
+	}
+
+	*len = min(view->frag->len - view->pos, view->len);
+
+	return view->frag->data + view->pos;
+}
+
+/**
+ * @brief Consume data from a view.
+ *
+ * @param view View.
+ * @param len Number of bytes to consume.
+ *
+ * @return 0 if ok, -ENODATA if the view has less data (nothing is
+ * consumed then).
+ */
+int net_nbuf_view_advance(struct net_nbuf_view *view, uint16_t len);
+
+/**
+ * @brief Copy data from a view without consuming it.
+ *
+ * @param view View.
+ * @param offset Offset of the data from the cursor.
+ * @param data Data will be copied here.
+ * @param len Number of bytes to copy.
+ *
+ * @return 0 if ok, -ENODATA if the view has less data.
+ */
+int net_nbuf_view_peek(const struct net_nbuf_view *view, uint16_t offset,
+		       void *data, uint16_t len);
+
+/**
+ * @brief Copy and consume data from a view.
+ *
+ * @param view View.
+ * @param data Data will be copied here, NULL to only consume.
+ * @param len Number of bytes to read.
+ *
+ * @return 0 if ok, -ENODATA if the view has less data (nothing is
+ * consumed then).
+ */
+int net_nbuf_view_read(struct net_nbuf_view *view, void *data, uint16_t len);
+
+/**
+ * @brief Read a byte from a view.
+ *
+ * @param view View.
+ * @param value Value is returned.
+ *
+ * @return 0 if ok, -ENODATA if the view is empty.
+ */
+int net_nbuf_view_read_u8(struct net_nbuf_view *view, uint8_t *value);
+
+/**
+ * @brief Read a 16 bit big endian value from a view.
+ *
+ * @param view View.
+ * @param value Value is returned in host byte order.
+ *
+ * @return 0 if ok, -ENODATA if the view has less data.
+ */
+int net_nbuf_view_read_be16(struct net_nbuf_view *view, uint16_t *value);
+
+/**
+ * @brief Read a 32 bit big endian value from a view.
+ *
+ * @param view View.
+ * @param value Value is returned in host byte order.
+ *
+ * @return 0 if ok, -ENODATA if the view has less data.
+ */
+int net_nbuf_view_read_be32(struct net_nbuf_view *view, uint32_t *value);
+
+/**
+ * @brief Free the data a view has consumed.
+ *
+ * @details The fragments before the cursor are removed from the buffer and
+ * the consumed part of the current fragment is pulled, so the fragments
+ * are released while the rest of the data is still being parsed. The view
+ * and the buffer then both start at the cursor.
+ *
+ * @param buf Network buffer whose fragment list the view is over.
+ * @param view View.
+ */
+void net_nbuf_view_release(struct net_buf *buf, struct net_nbuf_view *view);
+
 /**
  * @brief Write data to an arbitrary offset in a series of fragments.
  *
@@ -905,7 +1203,8 @@ static inline bool net_nbuf_insert_be32(struct net_buf *buf,
 /**
  * @brief Get information about available free buffer count in
  * various network buffer pools. The amount of free buffers is
- * only returned if network buffer debugging is enabled.
+ * only returned if network buffer debugging or the pool usage
+ * statistics are enabled.
  *
  * @param tx_size Size of TX pool. Value is returned.
  * @param rx_size Size of RX pool. Value is returned.
@@ -917,6 +1216,23 @@ static inline bool net_nbuf_insert_be32(struct net_buf *buf,
 void net_nbuf_get_info(size_t *tx_size, size_t *rx_size, size_t *data_size,
 		       int *tx, int *rx, int *data);
 
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+typedef void (*net_nbuf_pool_cb_t)(struct net_buf_pool *pool,
+				   const char *name, void *user_data);
+
+/**
+ * @brief Go through the RX, TX and DATA buffer pools.
+ *
+ * @details The usage statistics of each pool can then be read with
+ * net_buf_pool_stats_get(). The pools given to the contexts, see
+ * net_context_setup_pools(), are not part of these.
+ *
+ * @param cb Function called for each pool.
+ * @param user_data User data passed to the function.
+ */
+void net_nbuf_foreach_pool(net_nbuf_pool_cb_t cb, void *user_data);
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+
 #if defined(CONFIG_NET_DEBUG_NET_BUF)
 /**
  * @brief Debug helper to print out the buffer allocations
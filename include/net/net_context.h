@@ -123,6 +123,16 @@ struct net_conn_handle;
  * anyway. This saves 12 bytes / context in IPv6.
  */
 struct net_context {
+#if defined(CONFIG_NET_SOCKETS)
+	/** First member of the structure to allow putting contexts into a
+	 * FIFO, e.g. the queue of accepted sockets.
+	 */
+	void *fifo_reserved;
+#endif /* CONFIG_NET_SOCKETS */
+
+	/** Node in the list of unused contexts */
+	sys_snode_t node;
+
 	/** Local IP address. Note that the values are in network byte order.
 	 */
 	struct sockaddr_ptr local;
@@ -161,10 +171,61 @@ struct net_context {
 	/** Flags for the context */
 	uint8_t flags;
 
+	/** Priority of the packets sent, see enum net_priority */
+	uint8_t priority;
+
+#if defined(CONFIG_NET_CONTEXT_NBUF_POOL)
+	/** Pool to allocate TX buffers from instead of the global one */
+	struct net_buf_pool *tx_pool;
+
+	/** Pool to allocate data fragments from instead of the global one */
+	struct net_buf_pool *data_pool;
+#endif /* CONFIG_NET_CONTEXT_NBUF_POOL */
+
 #if defined(CONFIG_NET_TCP)
 	/** TCP connection information */
 	struct net_tcp *tcp;
 #endif /* CONFIG_NET_TCP */
+
+#if defined(CONFIG_NET_CONTEXT_UDP_CACHE)
+	/** Headers of the datagrams sent to the connected peer */
+	struct {
+		/** IP and UDP headers of the previous datagram */
+		uint8_t hdr[sizeof(struct net_ipv6_hdr) +
+			    sizeof(struct net_udp_hdr)];
+
+		/** Interface the headers were built for */
+		struct net_if *iface;
+
+		/** Neighbor to send to, NULL if left to the L2 */
+		struct net_nbr *nbr;
+
+		/** Flush count when the headers were built */
+		uint32_t gen;
+
+		/** Length of the headers, 0 if none are cached */
+		uint8_t hdr_len;
+
+		/** The peer is a local address */
+		bool loopback;
+	} udp_cache;
+#endif /* CONFIG_NET_CONTEXT_UDP_CACHE */
+
+#if defined(CONFIG_NET_SOCKETS)
+	union {
+		/** Received buffers, for the BSD socket API */
+		struct k_fifo recv_q;
+
+		/** Accepted connections, for a listening BSD socket */
+		struct k_fifo accept_q;
+	};
+
+	/** Buffer whose data has been partly read by recv() */
+	struct net_buf *recv_cur;
+
+	/** BSD socket flags, e.g. non-blocking mode or end of stream */
+	uint8_t sock_flags;
+#endif /* CONFIG_NET_SOCKETS */
 };
 
 static inline bool net_context_is_used(struct net_context *context)
@@ -432,7 +493,9 @@ int net_context_bind(struct net_context *context,
  * @details This is similar as BSD listen() function.
  *
  * @param context The context to use.
- * @param backlog The size of the pending connections backlog.
+ * @param backlog The size of the pending connections backlog: the number
+ * of connections whose handshake may be in progress at the same time,
+ * up to CONFIG_NET_TCP_SYN_CACHE_SIZE.
  *
  * @return 0 if ok, < 0 if error
  */
@@ -622,6 +685,78 @@ int net_context_recv(struct net_context *context,
 		     int32_t timeout,
 		     void *user_data);
 
+/** Network context options */
+enum net_context_option {
+	/** Priority of the packets sent, an enum net_priority value */
+	NET_OPT_PRIORITY = 1,
+	/** Send small writes at once instead of coalescing them while data
+	 * is unacknowledged (Nagle algorithm), an int used as a boolean.
+	 * TCP only, inherited by the accepted connections.
+	 */
+	NET_OPT_TCP_NODELAY,
+	/** Acknowledge received data at once instead of delaying the ACK,
+	 * an int used as a boolean. TCP only, inherited by the accepted
+	 * connections.
+	 */
+	NET_OPT_TCP_QUICKACK,
+};
+
+/**
+ * @brief Set an option of a network context.
+ *
+ * @details The option applies to the packets allocated for the context
+ * after this call. This is similar as BSD setsockopt() function.
+ *
+ * @param context The network context to use.
+ * @param option Option to set.
+ * @param value Option value.
+ * @param len Length of the option value.
+ *
+ * @return 0 if ok, -EINVAL if the option or its value is invalid.
+ */
+int net_context_set_option(struct net_context *context,
+			   enum net_context_option option,
+			   const void *value, size_t len);
+
+/**
+ * @brief Get an option of a network context.
+ *
+ * @details This is similar as BSD getsockopt() function.
+ *
+ * @param context The network context to use.
+ * @param option Option to get.
+ * @param value Where to store the option value.
+ * @param len Size of the value buffer, set to the length of the value
+ * stored on return.
+ *
+ * @return 0 if ok, -EINVAL if the option is invalid or the buffer too small.
+ */
+int net_context_get_option(struct net_context *context,
+			   enum net_context_option option,
+			   void *value, size_t *len);
+
+#if defined(CONFIG_NET_CONTEXT_NBUF_POOL)
+/**
+ * @brief Set the buffer pools of a network context.
+ *
+ * @details The TX buffers and data fragments allocated for the context,
+ * including the ones the stack allocates itself for e.g. TCP segments, are
+ * then taken from these pools only. Running out of them thus only blocks
+ * this context. The pools are defined with NET_NBUF_TX_POOL_DEFINE() and
+ * NET_NBUF_DATA_POOL_DEFINE(), and can be shared by several contexts.
+ *
+ * @param context The network context to use.
+ * @param tx_pool Pool of TX buffers, NULL to use the global pool.
+ * @param data_pool Pool of data fragments, NULL to use the global pool.
+ *
+ * @return 0 if ok, -EINVAL if a pool does not have the right buffer
+ * sizes.
+ */
+int net_context_setup_pools(struct net_context *context,
+			    struct net_buf_pool *tx_pool,
+			    struct net_buf_pool *data_pool);
+#endif /* CONFIG_NET_CONTEXT_NBUF_POOL */
+
 typedef void (*net_context_cb_t)(struct net_context *context, void *user_data);
 
 /**
@@ -73,6 +73,14 @@ enum net_verdict {
 /* Called by lower network stack when a network packet has been received */
 int net_recv_data(struct net_if *iface, struct net_buf *buf);
 
+/* Called by lower network stack when several network packets have been
+ * received at once, e.g. in one interrupt: they are queued in one go, and
+ * the RX thread is only woken up once. Returns the number of packets queued,
+ * from the start of the array, the caller keeps the other ones; or -ENOBUFS
+ * if none could be queued.
+ */
+int net_recv_data_list(struct net_if *iface, struct net_buf **bufs, int count);
+
 /**
  * @brief Send data to network.
  *
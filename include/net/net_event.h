@@ -89,4 +89,26 @@ enum net_event_ipv4_cmd {
 #define NET_EVENT_IPV4_ROUTER_ADD				\
 	(_NET_EVENT_IPV4_BASE |	NET_EVENT_IPV4_CMD_ROUTER_ADD)
 
+/* Network buffer events, see CONFIG_NET_BUF_POOL_USAGE */
+#define _NET_NBUF_LAYER		NET_MGMT_LAYER_L3
+#define _NET_NBUF_CORE_CODE	0x100
+#define _NET_EVENT_NBUF_BASE	(NET_MGMT_EVENT_BIT |			\
+				 NET_MGMT_LAYER(_NET_NBUF_LAYER) |	\
+				 NET_MGMT_LAYER_CODE(_NET_NBUF_CORE_CODE))
+
+enum net_event_nbuf_cmd {
+	NET_EVENT_NBUF_CMD_RX_EMPTY	= 0,
+	NET_EVENT_NBUF_CMD_TX_EMPTY,
+	NET_EVENT_NBUF_CMD_DATA_EMPTY,
+};
+
+#define NET_EVENT_NBUF_RX_EMPTY					\
+	(_NET_EVENT_NBUF_BASE | NET_EVENT_NBUF_CMD_RX_EMPTY)
+
+#define NET_EVENT_NBUF_TX_EMPTY					\
+	(_NET_EVENT_NBUF_BASE |	NET_EVENT_NBUF_CMD_TX_EMPTY)
+
+#define NET_EVENT_NBUF_DATA_EMPTY				\
+	(_NET_EVENT_NBUF_BASE |	NET_EVENT_NBUF_CMD_DATA_EMPTY)
+
 #endif /* __NET_EVENT_H__ */
@@ -20,6 +20,7 @@
 #include <net/net_linkaddr.h>
 #include <net/net_ip.h>
 #include <net/net_l2.h>
+#include <net/net_stats.h>
 
 #if defined(CONFIG_NET_DHCPV4)
 #include <net/dhcpv4.h>
@@ -140,10 +141,42 @@ struct net_if_router {
  */
 #define __net_if_align __aligned(32)
 
+#if defined(CONFIG_NET_TC_TX_COUNT)
+#define NET_TC_TX_COUNT CONFIG_NET_TC_TX_COUNT
+#else
+#define NET_TC_TX_COUNT 1
+#endif
+
 enum {
 	/* interface is up/ready to receive and transmit */
 	NET_IF_UP,
 
+	/* driver maps the fragments of a packet directly to its TX
+	 * descriptors instead of copying them to a contiguous buffer, so the
+	 * fragments are owned by the device until their transmission is done
+	 */
+	NET_IF_TX_SG,
+
+	/* device computes the IPv4 header, UDP, TCP and ICMP checksums of
+	 * the packets it sends, the stack leaves them to zero
+	 */
+	NET_IF_TX_CSUM,
+
+	/* device verifies the IPv4 header, UDP and TCP checksums of the
+	 * packets it receives and drops the ones that are invalid
+	 */
+	NET_IF_RX_CSUM,
+
+	/* device splits the TCP packets queued for segmentation offload,
+	 * see CONFIG_NET_TCP_GSO, into segments of their gso_size itself
+	 */
+	NET_IF_TX_TSO,
+
+	/* device drops the multicast frames whose destination address is
+	 * not in its filter, programmed through its struct ethernet_api
+	 */
+	NET_IF_MCAST_FILTER,
+
 	/* Total number of flags - must be at the end of the enum */
 	NET_IF_NUM_FLAGS
 };
@@ -186,8 +219,18 @@ struct net_if {
 	 */
 	bool offload_ip;
 
-	/** Queue for outgoing packets from apps */
-	struct k_fifo tx_queue;
+	/** Queues for outgoing packets from apps, one per traffic class,
+	 * the last one having the highest priority
+	 */
+	struct k_fifo tx_queue[NET_TC_TX_COUNT];
+
+	/** Number of packets in the TX queues */
+	struct k_sem tx_pending;
+
+#if defined(CONFIG_NET_TC_SCHED_WRR)
+	/** Packets each traffic class may still send in this round */
+	uint8_t tx_credit[NET_TC_TX_COUNT];
+#endif
 
 	/** Stack for the TX thread tied to this interface */
 #ifndef CONFIG_NET_TX_STACK_SIZE
@@ -195,6 +238,17 @@ struct net_if {
 #endif
 	NET_STACK_DEFINE_EMBEDDED(tx_stack, CONFIG_NET_TX_STACK_SIZE);
 
+	/** Queue for incoming packets from the device */
+	struct k_fifo rx_queue;
+
+	/** Number of packets in the RX queue */
+	atomic_t rx_queue_len;
+
+#if defined(CONFIG_NET_STATISTICS)
+	/** Interface statistics */
+	struct net_stats_iface stats;
+#endif
+
 #if defined(CONFIG_NET_IPV6)
 #define NET_IF_MAX_IPV6_ADDR CONFIG_NET_IF_UNICAST_IPV6_ADDR_COUNT
 #define NET_IF_MAX_IPV6_MADDR CONFIG_NET_IF_MCAST_IPV6_ADDR_COUNT
@@ -232,6 +286,11 @@ struct net_if {
 
 	/** Retransmit timer (RFC 4861, page 52) */
 	uint32_t retrans_timer;
+
+#if defined(CONFIG_NET_IPV6_ND)
+	/** Neighbor the last packet sent was resolved to */
+	struct net_nbr *nbr_last;
+#endif /* CONFIG_NET_IPV6_ND */
 #endif /* CONFIG_NET_IPV6 */
 
 #if defined(CONFIG_NET_IPV4)
@@ -253,6 +312,11 @@ struct net_if {
 
 	/** IPv4 time-to-live */
 	uint8_t ttl;
+
+#if defined(CONFIG_NET_ARP)
+	/** ARP entry the last packet sent was resolved to */
+	struct arp_entry *arp_last;
+#endif /* CONFIG_NET_ARP */
 #endif /* CONFIG_NET_IPV4 */
 
 #if defined(CONFIG_NET_DHCPV4)
@@ -351,16 +415,45 @@ static inline struct device *net_if_get_device(struct net_if *iface)
 	return iface->dev;
 }
 
+/**
+ * @brief Get the TX traffic class of a packet priority
+ *
+ * @details The priorities are spread evenly over the traffic classes,
+ * in the IEEE 802.1Q order, i.e. with background below best effort.
+ *
+ * @param priority Packet priority
+ *
+ * @return Traffic class, from 0 (lowest) to NET_TC_TX_COUNT - 1
+ */
+static inline uint8_t net_tx_priority2tc(enum net_priority priority)
+{
+	uint8_t rank;
+
+	if (priority >= NET_MAX_PRIORITIES) {
+		priority = NET_PRIORITY_NC;
+	}
+
+	if (priority == NET_PRIORITY_BK) {
+		rank = 0;
+	} else if (priority == NET_PRIORITY_BE) {
+		rank = 1;
+	} else {
+		rank = priority;
+	}
+
+	return (rank * NET_TC_TX_COUNT) / NET_MAX_PRIORITIES;
+}
+
 /**
  * @brief Queue a packet into net if's TX queue
  *
+ * @details The packet is queued to the TX queue of the traffic class
+ * matching its priority.
+ *
  * @param iface Pointer to a network interface structure
  * @param buf Pointer on a net buffer to queue
  */
-static inline void net_if_queue_tx(struct net_if *iface, struct net_buf *buf)
-{
-	net_buf_put(&iface->tx_queue, buf);
-}
+void net_if_queue_tx(struct net_if *iface, struct net_buf *buf);
 
 /**
  * @brief Return the IP offload status.
@@ -49,6 +49,22 @@ enum net_sock_type {
 	SOCK_STREAM,
 };
 
+/** Packet priorities, as defined by IEEE 802.1Q. Note that best effort
+ * is above background even if its value is lower.
+ */
+enum net_priority {
+	NET_PRIORITY_BK = 1, /* Background (lowest) */
+	NET_PRIORITY_BE = 0, /* Best effort (default) */
+	NET_PRIORITY_EE = 2, /* Excellent effort */
+	NET_PRIORITY_CA = 3, /* Critical applications */
+	NET_PRIORITY_VI = 4, /* Video, < 100 ms latency and jitter */
+	NET_PRIORITY_VO = 5, /* Voice, < 10 ms latency and jitter */
+	NET_PRIORITY_IC = 6, /* Internetwork control */
+	NET_PRIORITY_NC = 7, /* Network control (highest) */
+};
+
+#define NET_MAX_PRIORITIES 8
+
 #define ntohs(x) sys_be16_to_cpu(x)
 #define ntohl(x) sys_be32_to_cpu(x)
 #define htons(x) sys_cpu_to_be16(x)
@@ -580,6 +596,21 @@ static inline bool net_is_ipv6_addr_mcast_global(const struct in6_addr *addr)
 		(addr->s6_addr[1] & 0x0e) == 0x0e;
 }
 
+/**
+ * @brief Check if the IPv6 address is a realm-local multicast address
+ * (FFx3::/16).
+ *
+ * @param addr IPv6 address.
+ *
+ * @return True if the address is realm-local multicast address, false
+ * otherwise.
+ */
+static inline bool net_is_ipv6_addr_mcast_realm(const struct in6_addr *addr)
+{
+	return addr->s6_addr[0] == 0xff &&
+		(addr->s6_addr[1] & 0x0f) == 0x03;
+}
+
 /**
  *  @brief Create solicited node IPv6 multicast address
  *  FF02:0:0:0:0:1:FFXX:XXXX defined in RFC 3513
@@ -145,6 +145,17 @@ void net_mgmt_init_event_callback(struct net_mgmt_event_callback *cb,
  */
 void net_mgmt_add_event_callback(struct net_mgmt_event_callback *cb);
 
+#if defined(CONFIG_NET_MGMT_EVENT_SYNC)
+/**
+ * @brief Add a user callback run synchronously
+ * @details The callback is run by net_mgmt_event_notify() itself, in the
+ *          context notifying the event, which may be an ISR: it must not
+ *          block.
+ * @param cb A valid pointer on user's callback to add.
+ */
+void net_mgmt_add_sync_event_callback(struct net_mgmt_event_callback *cb);
+#endif
+
 /**
  * @brief Delete a user callback
  * @param cb A valid pointer on user's callback to delete.
@@ -167,6 +178,7 @@ void net_mgmt_event_init(void);
 #else
 #define net_mgmt_init_event_callback(...)
 #define net_mgmt_add_event_callback(...)
+#define net_mgmt_del_event_callback(...)
 #define net_mgmt_event_notify(...)
 #define net_mgmt_event_init(...)
 #endif /* CONFIG_NET_MGMT_EVENT */
@@ -36,6 +36,43 @@ struct net_stats_ip {
 	net_stats_t drop;
 };
 
+struct net_stats_ip_frag {
+	/** Number of received fragments. */
+	net_stats_t recv;
+
+	/** Number of sent fragments. */
+	net_stats_t sent;
+
+	/** Number of reassembled datagrams. */
+	net_stats_t reassembled;
+
+	/** Number of dropped fragments, e.g. malformed or overlapping. */
+	net_stats_t drop;
+
+	/** Number of datagrams dropped as their reassembly timed out. */
+	net_stats_t timeout;
+
+	/** Number of datagrams dropped to make room for newer ones. */
+	net_stats_t evicted;
+};
+
+struct net_stats_ipv6_mpl {
+	/** Number of received MPL packets. */
+	net_stats_t recv;
+
+	/** Number of MPL packets originated by this node. */
+	net_stats_t sent;
+
+	/** Number of MPL packets retransmitted. */
+	net_stats_t forwarded;
+
+	/** Number of duplicate MPL packets dropped. */
+	net_stats_t duplicate;
+
+	/** Number of malformed MPL packets dropped. */
+	net_stats_t drop;
+};
+
 struct net_stats_ip_errors {
 	/** Number of packets dropped due to wrong IP version
 	 * or header length.
@@ -106,6 +143,17 @@ struct net_stats_tcp {
 
 	/** Number of SYNs for closed ports, triggering a RST. */
 	net_stats_t synrst;
+
+	/** Number of received TCP segments carrying SACK blocks. */
+	net_stats_t sackrecv;
+
+	/** Number of sent TCP segments carrying SACK blocks. */
+	net_stats_t sacksent;
+
+	/** Number of TCP segments retransmitted because SACK blocks
+	 * showed them missing.
+	 */
+	net_stats_t sackrexmit;
 };
 
 struct net_stats_udp {
@@ -122,10 +170,127 @@ struct net_stats_udp {
 	net_stats_t chkerr;
 };
 
+struct net_stats_rx_queue {
+	/** Number of packets queued for the RX threads. */
+	net_stats_t recv;
+
+	/** Number of packets dropped because the RX queue was full. */
+	net_stats_t drop;
+};
+
+struct net_stats_iface_rate {
+	/** Number of packets received per second. */
+	net_stats_t rx_pkts;
+
+	/** Number of bytes received per second. */
+	net_stats_t rx_bytes;
+
+	/** Number of packets sent per second. */
+	net_stats_t tx_pkts;
+
+	/** Number of bytes sent per second. */
+	net_stats_t tx_bytes;
+};
+
+struct net_stats_iface {
+	/** Packets queued to, or dropped by, the RX queue of the
+	 * interface, i.e. received packets.
+	 */
+	struct net_stats_rx_queue rx_queue;
+
+	/** Number of bytes received. */
+	net_stats_t rx_bytes;
+
+	/** Number of received packets dropped by the stack, e.g.
+	 * malformed ones or ones for no local address or connection.
+	 */
+	net_stats_t rx_drop;
+
+	/** Highest number of packets waiting in the RX queue. */
+	net_stats_t rx_queue_max;
+
+	/** Number of packets passed to the driver. */
+	net_stats_t tx_pkts;
+
+	/** Number of bytes passed to the driver. */
+	net_stats_t tx_bytes;
+
+	/** Number of packets dropped because the interface was down. */
+	net_stats_t tx_drop_down;
+
+	/** Number of packets dropped by the L2, e.g. unresolved ones. */
+	net_stats_t tx_drop_l2;
+
+	/** Number of packets the driver failed to send. */
+	net_stats_t tx_drop_driver;
+
+	/** Highest number of packets waiting in the TX queues. */
+	net_stats_t tx_queue_max;
+
+#if defined(CONFIG_NET_STATISTICS_RATE)
+	/** Rates over the last CONFIG_NET_STATISTICS_RATE_INTERVAL ms. */
+	struct net_stats_iface_rate rate;
+
+	/** For internal use, counters at the last rate computation. */
+	struct net_stats_iface_rate rate_last;
+#endif
+};
+
+/** Stages of the packet pipelines timed by CONFIG_NET_STATISTICS_LATENCY */
+enum net_stats_latency_stage {
+	/** From net_recv_data() to an RX thread picking the packet. */
+	NET_STATS_LATENCY_RX_QUEUE,
+
+	/** From the RX thread to net_conn_input(), i.e. L2 and IP. */
+	NET_STATS_LATENCY_RX_PROCESS,
+
+	/** From net_conn_input() to the application callback. */
+	NET_STATS_LATENCY_RX_DELIVER,
+
+	/** From net_send_data() to the TX queue, i.e. IP and L2. */
+	NET_STATS_LATENCY_TX_PROCESS,
+
+	/** From the TX queue to the TX thread picking the packet. */
+	NET_STATS_LATENCY_TX_QUEUE,
+
+	/** Time spent in the send() function of the driver. */
+	NET_STATS_LATENCY_TX_DRIVER,
+
+	NET_STATS_LATENCY_STAGES,
+};
+
+/** Number of buckets of the latency histograms. Bucket 0 counts the
+ * latencies of less than 1 us, bucket N those of 2^(N-1) to 2^N - 1 us
+ * and the last bucket all the longer ones.
+ */
+#define NET_STATS_LATENCY_BUCKETS 16
+
+struct net_stats_latency {
+	/** Number of packets that passed the stage. */
+	net_stats_t count;
+
+	/** Sum of the latencies in us, for the average. */
+	net_stats_t total;
+
+	/** Longest latency in us. */
+	net_stats_t max;
+
+	/** Histogram of the latencies. */
+	net_stats_t hist[NET_STATS_LATENCY_BUCKETS];
+};
+
 struct net_stats_ipv6_nd {
 	net_stats_t drop;
 	net_stats_t recv;
 	net_stats_t sent;
+
+	/** Number of packets dropped, the neighbor queue being full. */
+	net_stats_t pending_drop;
+};
+
+struct net_stats_arp {
+	/** Number of packets dropped, the ARP entry queue being full. */
+	net_stats_t pending_drop;
 };
 
 struct net_stats_rpl_dis {
@@ -165,6 +330,9 @@ struct net_stats_rpl_dao {
 
 	/** Number of forwarded DAO packets. */
 	net_stats_t forwarded;
+
+	/** Number of targets of the sub-DODAG advertised in our DAOs. */
+	net_stats_t aggregated;
 };
 
 struct net_stats_rpl_dao_ack {
@@ -201,12 +369,27 @@ struct net_stats {
 
 	struct net_stats_ip_errors ip_errors;
 
+	/** Totals of the RX queues of all the interfaces */
+	struct net_stats_rx_queue rx_queue;
+
 #if defined(CONFIG_NET_STATISTICS_IPV6)
 	struct net_stats_ip ipv6;
+
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+	struct net_stats_ip_frag ipv6_frag;
+#endif
+
+#if defined(CONFIG_NET_IPV6_MPL)
+	struct net_stats_ipv6_mpl ipv6_mpl;
+#endif
 #endif
 
 #if defined(CONFIG_NET_STATISTICS_IPV4)
 	struct net_stats_ip ipv4;
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	struct net_stats_ip_frag ipv4_frag;
+#endif
 #endif
 
 #if defined(CONFIG_NET_STATISTICS_ICMP)
@@ -225,9 +408,17 @@ struct net_stats {
 	struct net_stats_ipv6_nd ipv6_nd;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+	struct net_stats_arp arp;
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_RPL)
 	struct net_stats_rpl rpl;
 #endif
+
+#if defined(CONFIG_NET_STATISTICS_LATENCY)
+	struct net_stats_latency latency[NET_STATS_LATENCY_STAGES];
+#endif
 };
 
 #if defined(CONFIG_NET_STATISTICS_USER_API)
@@ -251,6 +442,8 @@ enum net_request_stats_cmd {
 	NET_REQUEST_STATS_CMD_GET_UDP,
 	NET_REQUEST_STATS_CMD_GET_TCP,
 	NET_REQUEST_STATS_CMD_GET_RPL,
+	NET_REQUEST_STATS_CMD_GET_RX_QUEUE,
+	NET_REQUEST_STATS_CMD_GET_IFACE,
 };
 
 #define NET_REQUEST_STATS_GET_ALL				\
@@ -317,6 +510,20 @@ NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_TCP);
 NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_RPL);
 #endif /* CONFIG_NET_STATISTICS_RPL */
 
+/* Statistics of the RX queue of the given interface, or if there is none,
+ * totals of the RX queues of all the interfaces.
+ */
+#define NET_REQUEST_STATS_GET_RX_QUEUE				\
+	(_NET_STATS_BASE | NET_REQUEST_STATS_CMD_GET_RX_QUEUE)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_RX_QUEUE);
+
+/* Statistics of the given interface, struct net_stats_iface */
+#define NET_REQUEST_STATS_GET_IFACE				\
+	(_NET_STATS_BASE | NET_REQUEST_STATS_CMD_GET_IFACE)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IFACE);
+
 #endif /* CONFIG_NET_STATISTICS_USER_API */
 
 #ifdef __cplusplus
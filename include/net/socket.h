@@ -0,0 +1,216 @@
+/**
+ * @file
+ * @brief BSD Sockets compatible API definitions
+ *
+ * An API for applications to use BSD Sockets like API.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __NET_SOCKET_H
+#define __NET_SOCKET_H
+
+#include <sys/types.h>
+#include <net/net_ip.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief BSD Sockets compatible API
+ * @defgroup bsd_sockets BSD Sockets compatible API
+ * @{
+ */
+
+struct zsock_pollfd {
+	int fd;
+	short events;
+	short revents;
+};
+
+/* Values are compatible with Linux */
+#define ZSOCK_POLLIN 1
+#define ZSOCK_POLLOUT 4
+#define ZSOCK_POLLERR 8
+#define ZSOCK_POLLHUP 0x10
+#define ZSOCK_POLLNVAL 0x20
+
+#define ZSOCK_MSG_DONTWAIT 0x40
+
+#define ZSOCK_F_GETFL 3
+#define ZSOCK_F_SETFL 4
+#define ZSOCK_O_NONBLOCK 0x800
+
+/*
+ * The functions return -1 on error and set errno, like their POSIX
+ * counterparts. A socket is only to be used by one thread at a time.
+ */
+
+/**
+ * @brief Create a socket.
+ *
+ * @param family AF_INET or AF_INET6.
+ * @param type SOCK_STREAM or SOCK_DGRAM.
+ * @param proto IPPROTO_TCP or IPPROTO_UDP.
+ *
+ * @return Socket descriptor, or -1 if error.
+ */
+int zsock_socket(int family, int type, int proto);
+
+/**
+ * @brief Close a socket, the data not read yet is dropped.
+ *
+ * @param sock Socket descriptor.
+ *
+ * @return 0 if ok, -1 if error.
+ */
+int zsock_close(int sock);
+
+int zsock_bind(int sock, const struct sockaddr *addr, socklen_t addrlen);
+
+/**
+ * @brief Connect a socket to a peer.
+ *
+ * @details A TCP connection is always waited for, see
+ * CONFIG_NET_SOCKETS_CONNECT_TIMEOUT.
+ */
+int zsock_connect(int sock, const struct sockaddr *addr, socklen_t addrlen);
+
+int zsock_listen(int sock, int backlog);
+
+int zsock_accept(int sock, struct sockaddr *addr, socklen_t *addrlen);
+
+ssize_t zsock_send(int sock, const void *buf, size_t len, int flags);
+
+ssize_t zsock_recv(int sock, void *buf, size_t max_len, int flags);
+
+ssize_t zsock_sendto(int sock, const void *buf, size_t len, int flags,
+		     const struct sockaddr *dest_addr, socklen_t addrlen);
+
+/**
+ * @brief Receive data from a socket.
+ *
+ * @details The part of a datagram not fitting in the buffer is dropped.
+ * For a stream socket, 0 is returned once the peer closed the connection.
+ */
+ssize_t zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
+		       struct sockaddr *src_addr, socklen_t *addrlen);
+
+/**
+ * @brief Get or set the flags of a socket, only ZSOCK_O_NONBLOCK is
+ * supported.
+ */
+int zsock_fcntl(int sock, int cmd, int flags);
+
+/**
+ * @brief Wait for events on sockets.
+ *
+ * @details A socket is readable when it has data or connections waiting,
+ * or at the end of the stream. Sends block until buffers are available,
+ * so a socket is always writable.
+ *
+ * @param fds Sockets and the events to wait for. Sockets with a negative
+ * descriptor are ignored.
+ * @param nfds Number of sockets.
+ * @param timeout Timeout in ms, or -1 to wait forever.
+ *
+ * @return Number of sockets with events, 0 on timeout, -1 if error.
+ */
+int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout);
+
+#if defined(CONFIG_NET_SOCKETS_POSIX_NAMES)
+static inline int socket(int family, int type, int proto)
+{
+	return zsock_socket(family, type, proto);
+}
+
+static inline int close(int sock)
+{
+	return zsock_close(sock);
+}
+
+static inline int bind(int sock, const struct sockaddr *addr,
+		       socklen_t addrlen)
+{
+	return zsock_bind(sock, addr, addrlen);
+}
+
+static inline int connect(int sock, const struct sockaddr *addr,
+			  socklen_t addrlen)
+{
+	return zsock_connect(sock, addr, addrlen);
+}
+
+static inline int listen(int sock, int backlog)
+{
+	return zsock_listen(sock, backlog);
+}
+
+static inline int accept(int sock, struct sockaddr *addr, socklen_t *addrlen)
+{
+	return zsock_accept(sock, addr, addrlen);
+}
+
+static inline ssize_t send(int sock, const void *buf, size_t len, int flags)
+{
+	return zsock_send(sock, buf, len, flags);
+}
+
+static inline ssize_t recv(int sock, void *buf, size_t max_len, int flags)
+{
+	return zsock_recv(sock, buf, max_len, flags);
+}
+
+static inline ssize_t sendto(int sock, const void *buf, size_t len,
+			     int flags, const struct sockaddr *dest_addr,
+			     socklen_t addrlen)
+{
+	return zsock_sendto(sock, buf, len, flags, dest_addr, addrlen);
+}
+
+static inline ssize_t recvfrom(int sock, void *buf, size_t max_len,
+			       int flags, struct sockaddr *src_addr,
+			       socklen_t *addrlen)
+{
+	return zsock_recvfrom(sock, buf, max_len, flags, src_addr, addrlen);
+}
+
+static inline int fcntl(int sock, int cmd, int flags)
+{
+	return zsock_fcntl(sock, cmd, flags);
+}
+
+#define pollfd zsock_pollfd
+
+static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
+{
+	return zsock_poll(fds, nfds, timeout);
+}
+
+#define POLLIN ZSOCK_POLLIN
+#define POLLOUT ZSOCK_POLLOUT
+#define POLLERR ZSOCK_POLLERR
+#define POLLHUP ZSOCK_POLLHUP
+#define POLLNVAL ZSOCK_POLLNVAL
+
+#define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
+
+#define F_GETFL ZSOCK_F_GETFL
+#define F_SETFL ZSOCK_F_SETFL
+#define O_NONBLOCK ZSOCK_O_NONBLOCK
+#endif /* CONFIG_NET_SOCKETS_POSIX_NAMES */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_SOCKET_H */
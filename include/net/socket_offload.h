@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Socket offload API
+ *
+ * Wi-Fi and cellular modules attached over e.g. SPI or UART often run
+ * their own TCP/IP stack. Their driver then implements the BSD Sockets
+ * compatible API itself: each socket call maps to the commands of the
+ * module, and the data is copied between the receive and transmit
+ * buffers of the driver and the buffer of the application, with no
+ * network buffer in between.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __NET_SOCKET_OFFLOAD_H
+#define __NET_SOCKET_OFFLOAD_H
+
+#include <net/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Socket operations of an offloading driver
+ *
+ * The operations have the arguments of the zsock_*() functions, see
+ * net/socket.h, but return a negative errno code on error: the caller
+ * sets errno. The socket descriptors are chosen by the driver. The
+ * operations a module does not support can be left NULL, they then fail
+ * with EOPNOTSUPP.
+ */
+struct net_socket_offload {
+	int (*socket)(int family, int type, int proto);
+	int (*close)(int sock);
+	int (*bind)(int sock, const struct sockaddr *addr, socklen_t addrlen);
+	int (*connect)(int sock, const struct sockaddr *addr,
+		       socklen_t addrlen);
+	int (*listen)(int sock, int backlog);
+	int (*accept)(int sock, struct sockaddr *addr, socklen_t *addrlen);
+
+	/** Both are handed the buffer of the application, which the data
+	 * is to be copied from or to directly.
+	 */
+	ssize_t (*sendto)(int sock, const void *buf, size_t len, int flags,
+			  const struct sockaddr *dest_addr, socklen_t addrlen);
+	ssize_t (*recvfrom)(int sock, void *buf, size_t max_len, int flags,
+			    struct sockaddr *src_addr, socklen_t *addrlen);
+
+	int (*fcntl)(int sock, int cmd, int flags);
+	int (*poll)(struct zsock_pollfd *fds, int nfds, int timeout);
+};
+
+/**
+ * @brief Register the driver the sockets are offloaded to
+ *
+ * @details To be called by the driver at its initialization, before any
+ * socket is created. Only one driver can be registered.
+ *
+ * @param ops Socket operations of the driver.
+ */
+void net_socket_offload_register(const struct net_socket_offload *ops);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_SOCKET_OFFLOAD_H */
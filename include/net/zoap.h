@@ -17,7 +17,9 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include <kernel.h>
 #include <misc/slist.h>
+#include <net/net_ip.h>
 
 /**
  * @brief Set of CoAP packet options we are aware of.
@@ -137,6 +139,7 @@ enum zoap_response_code {
 struct zoap_observer;
 struct zoap_packet;
 struct zoap_pending;
+struct zoap_pending_table;
 struct zoap_reply;
 struct zoap_resource;
 
@@ -175,6 +178,7 @@ struct zoap_resource {
  */
 struct zoap_observer {
 	sys_snode_t list;
+	sys_snode_t index; /* used by zoap_observer_table */
 	struct sockaddr addr;
 	uint8_t token[8];
 	uint8_t tkl;
@@ -202,6 +206,14 @@ typedef int (*zoap_reply_t)(const struct zoap_packet *response,
 struct zoap_pending {
 	struct zoap_packet request;
 	int32_t timeout;
+
+	/* Used by zoap_pending_table */
+	sys_snode_t node;
+	struct k_delayed_work work;
+	struct sockaddr addr;
+	struct zoap_pending_table *table;
+	uint8_t retries;
+	uint8_t state;
 };
 
 /**
@@ -209,6 +221,7 @@ struct zoap_pending {
  * observing resources.
  */
 struct zoap_reply {
+	sys_snode_t node; /* used by zoap_reply_table */
 	zoap_reply_t reply;
 	void *user_data;
 	int age;
@@ -343,6 +356,158 @@ void zoap_pending_clear(struct zoap_pending *pending);
  */
 void zoap_reply_clear(struct zoap_reply *reply);
 
+/**
+ * Type of the callback transmitting a confirmable message tracked by a
+ * zoap_pending_table, called for the first transmission and for each
+ * retransmission. It must not consume the reference to the buffer of
+ * @a pending, e.g. by sending a copy of it or a new reference to it.
+ */
+typedef int (*zoap_pending_send_t)(struct zoap_pending *pending);
+
+/**
+ * Type of the callback called when a confirmable message tracked by a
+ * zoap_pending_table was retransmitted without being acknowledged.
+ */
+typedef void (*zoap_pending_expired_t)(struct zoap_pending *pending);
+
+/**
+ * Pending confirmable messages indexed by message id, retransmitted
+ * with an exponential backoff by the system workqueue [RFC 7252, 4.2].
+ * At most CONFIG_ZOAP_NSTART messages are outstanding at a time, the
+ * others waiting in order for their turn.
+ */
+struct zoap_pending_table {
+	struct zoap_pending *pendings;
+	size_t len;
+	zoap_pending_send_t send;
+	zoap_pending_expired_t expired;
+	sys_slist_t free;
+	sys_slist_t queue;
+	sys_slist_t buckets[CONFIG_ZOAP_TABLE_BUCKETS];
+	uint16_t in_flight;
+};
+
+/**
+ * Initializes a pending table holding the @a len entries of @a pendings.
+ */
+void zoap_pending_table_init(struct zoap_pending_table *table,
+			     struct zoap_pending *pendings, size_t len,
+			     zoap_pending_send_t send,
+			     zoap_pending_expired_t expired);
+
+/**
+ * Returns a free pending of @a table, or NULL if there is none.
+ */
+struct zoap_pending *zoap_pending_alloc(struct zoap_pending_table *table);
+
+/**
+ * Sends @a request to @a addr, and retransmits it until it is
+ * acknowledged. The table takes over the reference to the buffer of the
+ * request, released once it's done with it.
+ */
+int zoap_pending_submit(struct zoap_pending_table *table,
+			struct zoap_pending *pending,
+			const struct zoap_packet *request,
+			const struct sockaddr *addr);
+
+/**
+ * Stops tracking the pending message acknowledged or reset by @a response,
+ * received from @a from, if any. Returns 0 if a message was acknowledged,
+ * -ENOENT otherwise.
+ */
+int zoap_pending_table_received(struct zoap_pending_table *table,
+				const struct zoap_packet *response,
+				const struct sockaddr *from);
+
+/**
+ * Stops retransmitting @a pending and releases it.
+ */
+void zoap_pending_cancel(struct zoap_pending_table *table,
+			 struct zoap_pending *pending);
+
+/**
+ * Replies awaited indexed by token.
+ */
+struct zoap_reply_table {
+	struct zoap_reply *replies;
+	size_t len;
+	sys_slist_t free;
+	sys_slist_t buckets[CONFIG_ZOAP_TABLE_BUCKETS];
+};
+
+/**
+ * Initializes a reply table holding the @a len entries of @a replies.
+ */
+void zoap_reply_table_init(struct zoap_reply_table *table,
+			   struct zoap_reply *replies, size_t len);
+
+/**
+ * Returns a free reply of @a table, or NULL if there is none.
+ */
+struct zoap_reply *zoap_reply_alloc(struct zoap_reply_table *table);
+
+/**
+ * Starts waiting for the replies matching @a reply, after it was set
+ * with zoap_reply_init().
+ */
+void zoap_reply_table_add(struct zoap_reply_table *table,
+			  struct zoap_reply *reply);
+
+/**
+ * Same as zoap_response_received() using @a table.
+ */
+struct zoap_reply *zoap_reply_table_received(
+	struct zoap_reply_table *table,
+	const struct zoap_packet *response,
+	const struct sockaddr *from);
+
+/**
+ * Stops waiting for the replies matching @a reply and releases it.
+ */
+void zoap_reply_table_remove(struct zoap_reply_table *table,
+			     struct zoap_reply *reply);
+
+/**
+ * Observers indexed by address.
+ */
+struct zoap_observer_table {
+	struct zoap_observer *observers;
+	size_t len;
+	sys_slist_t free;
+	sys_slist_t buckets[CONFIG_ZOAP_TABLE_BUCKETS];
+};
+
+/**
+ * Initializes an observer table holding the @a len entries of
+ * @a observers.
+ */
+void zoap_observer_table_init(struct zoap_observer_table *table,
+			      struct zoap_observer *observers, size_t len);
+
+/**
+ * Returns a free observer of @a table, or NULL if there is none.
+ */
+struct zoap_observer *zoap_observer_alloc(struct zoap_observer_table *table);
+
+/**
+ * Indexes @a observer, after it was set with zoap_observer_init().
+ */
+void zoap_observer_table_add(struct zoap_observer_table *table,
+			     struct zoap_observer *observer);
+
+/**
+ * Returns the observer of @a table that matches address @a addr.
+ */
+struct zoap_observer *zoap_observer_table_find(
+	struct zoap_observer_table *table, const struct sockaddr *addr);
+
+/**
+ * Removes @a observer from the index and releases it, it must have been
+ * removed from its resource with zoap_remove_observer() first.
+ */
+void zoap_observer_table_remove(struct zoap_observer_table *table,
+				struct zoap_observer *observer);
+
 /**
  * When a request is received, call the appropriate methods of the
  * matching resources.
@@ -489,6 +654,84 @@ int zoap_update_from_block(struct zoap_packet *pkt,
  */
 size_t zoap_next_block(struct zoap_block_context *ctx);
 
+/**
+ * Returns the largest block size for which a block, along with the IPv6
+ * and UDP headers and @a overhead bytes of CoAP header and options, fits
+ * in a link MTU of @a mtu bytes, so that block-wise transfers don't need
+ * IP fragmentation.
+ */
+enum zoap_block_size zoap_block_size_from_mtu(uint16_t mtu, uint16_t overhead);
+
+struct zoap_block_stream;
+
+/**
+ * Type of the callback producing the body of a block-wise transfer. It must
+ * copy the @a len bytes of the body at @a offset to @a data, and return 0 or
+ * a negative error.
+ */
+typedef int (*zoap_block_read_t)(struct zoap_block_stream *stream,
+				 size_t offset, uint8_t *data, uint16_t len);
+
+/**
+ * Type of the callback consuming the body of a block-wise transfer, @a len
+ * bytes at @a offset, @a last telling if this is the end of the body. It must
+ * return 0 or a negative error.
+ */
+typedef int (*zoap_block_write_t)(struct zoap_block_stream *stream,
+				  size_t offset, const uint8_t *data,
+				  uint16_t len, bool last);
+
+/**
+ * Represents a block-wise transfer whose body is produced or consumed one
+ * block at a time, so that its size is not limited by the packet buffers.
+ */
+struct zoap_block_stream {
+	struct zoap_block_context ctx;
+	zoap_block_read_t read;
+	zoap_block_write_t write;
+	void *user_data;
+	size_t received;
+};
+
+/**
+ * Initializes a block-wise transfer sending a body of @a total_size bytes,
+ * produced by @a read.
+ */
+void zoap_block_stream_source_init(struct zoap_block_stream *stream,
+				   enum zoap_block_size block_size,
+				   size_t total_size, zoap_block_read_t read,
+				   void *user_data);
+
+/**
+ * Initializes a block-wise transfer receiving a body consumed by @a write,
+ * using blocks of at most @a block_size.
+ */
+void zoap_block_stream_sink_init(struct zoap_block_stream *stream,
+				 enum zoap_block_size block_size,
+				 zoap_block_write_t write, void *user_data);
+
+/**
+ * Adds the current block of the body of @a stream to @a pkt: the BLOCK1
+ * option to a request or the BLOCK2 option to a response, the SIZE1 or
+ * SIZE2 option with the first block, and the payload. The block size is
+ * reduced if the block doesn't fit in the buffer of @a pkt. Options with
+ * a higher number must not have been added to @a pkt.
+ *
+ * The stream moves to the next block when the peer asks for it, with
+ * zoap_update_from_block() and zoap_next_block().
+ */
+int zoap_block_stream_send(struct zoap_packet *pkt,
+			   struct zoap_block_stream *stream);
+
+/**
+ * Passes the block carried by @a pkt to the stream, a packet without any
+ * block option being the whole body. Returns 0 if more blocks are expected,
+ * 1 once the body is complete, -EALREADY for a block already received or
+ * another negative error, e.g. -EINVAL for a block out of sequence.
+ */
+int zoap_block_stream_recv(struct zoap_packet *pkt,
+			   struct zoap_block_stream *stream);
+
 /**
  * Returns the version present in a CoAP packet.
  */
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief DTLS transport for CoAP packets, over mbed TLS.
+ *
+ * The CoAP packets are ciphered straight from and deciphered straight
+ * into the data fragment of their zoap_packet, and the DTLS records are
+ * copied between the mbed TLS buffers and the network buffer fragments:
+ * no intermediate linear buffer is used.
+ *
+ * The session of a completed handshake is saved in a zoap_dtls_cache,
+ * which outlives the DTLS context: a device can release the context
+ * before sleeping and, once awake, resume the session with an abbreviated
+ * handshake (by session ID, or by session ticket when the mbed TLS
+ * configuration has MBEDTLS_SSL_SESSION_TICKETS), which saves the key
+ * exchange and the certificate or PSK messages.
+ */
+
+#ifndef __ZOAP_DTLS_H__
+#define __ZOAP_DTLS_H__
+
+#include <net/zoap.h>
+#include <net/net_context.h>
+
+#if !defined(CONFIG_MBEDTLS_CFG_FILE)
+#include "mbedtls/config.h"
+#else
+#include CONFIG_MBEDTLS_CFG_FILE
+#endif
+
+#include "mbedtls/ssl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Saved DTLS session
+ */
+struct zoap_dtls_cache {
+	mbedtls_ssl_session session;
+	bool valid;
+};
+
+/**
+ * @brief DTLS association with a peer
+ */
+struct zoap_dtls {
+	struct net_context *net_ctx;
+	struct sockaddr peer;
+	socklen_t peer_len;
+	struct zoap_dtls_cache *cache;
+
+	mbedtls_ssl_context ssl;
+	/* Datagrams received from the peer, waiting for mbed TLS */
+	struct k_fifo rx_queue;
+	int32_t rx_timeout;
+
+	/* Retransmission timer of the handshake */
+	uint32_t timer_start;
+	uint32_t int_ms;
+	uint32_t fin_ms;
+};
+
+/**
+ * @brief Set up a DTLS association
+ *
+ * Takes over the receive callback of the network context.
+ *
+ * @param dtls DTLS association.
+ * @param net_ctx Bound UDP network context.
+ * @param peer Address of the peer.
+ * @param conf mbed TLS configuration, with the datagram transport, the
+ * random number generator and the credentials set.
+ * @param cache Session saved across releases of the association, NULL
+ * for none.
+ *
+ * @return 0 on success, negative errno code otherwise.
+ */
+int zoap_dtls_init(struct zoap_dtls *dtls, struct net_context *net_ctx,
+		   const struct sockaddr *peer,
+		   const mbedtls_ssl_config *conf,
+		   struct zoap_dtls_cache *cache);
+
+/**
+ * @brief Perform the handshake
+ *
+ * Resumes the session of the cache, if valid, and falls back to a full
+ * handshake if the peer refuses it. The session is saved in the cache on
+ * success.
+ *
+ * @param dtls DTLS association.
+ *
+ * @return 0 on success, -ECONNREFUSED if the handshake failed, -ETIMEDOUT
+ * if the peer did not answer.
+ */
+int zoap_dtls_handshake(struct zoap_dtls *dtls);
+
+/**
+ * @brief Send a CoAP packet
+ *
+ * @param dtls DTLS association.
+ * @param pkt Packet, whose network buffer is released on success.
+ *
+ * @return 0 on success, negative errno code otherwise.
+ */
+int zoap_dtls_send(struct zoap_dtls *dtls, struct zoap_packet *pkt);
+
+/**
+ * @brief Receive a CoAP packet
+ *
+ * @param dtls DTLS association.
+ * @param pkt Packet to parse the received data into. Its network buffer
+ * is to be released with net_nbuf_unref().
+ * @param timeout Maximum time to wait, in milliseconds.
+ *
+ * @return 0 on success, -EAGAIN if the timeout expired, -ENOTCONN if the
+ * peer closed the association, negative errno code otherwise.
+ */
+int zoap_dtls_recv(struct zoap_dtls *dtls, struct zoap_packet *pkt,
+		   int32_t timeout);
+
+/**
+ * @brief Release a DTLS association
+ *
+ * The session stays in the cache, to be resumed by the next association.
+ *
+ * @param dtls DTLS association.
+ * @param notify Send a close notification alert to the peer, instead of
+ * releasing the association silently, which saves a transmission.
+ */
+void zoap_dtls_release(struct zoap_dtls *dtls, bool notify);
+
+/**
+ * @brief Forget a saved session
+ *
+ * @param cache Session cache.
+ */
+void zoap_dtls_cache_clear(struct zoap_dtls_cache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ZOAP_DTLS_H__ */
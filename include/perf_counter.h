@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Public API for the hardware performance counters
+ */
+
+#ifndef __PERF_COUNTER_H__
+#define __PERF_COUNTER_H__
+
+#include <stdint.h>
+#include <kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Hardware performance counters
+ * @defgroup perf_counter_apis Performance Counter APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/**
+ * @brief Hardware events.
+ *
+ * The events a CPU can count are given by perf_counter_events(). The
+ * Cortex-M3/M4/M7 DWT counts the cycles and the stall, load/store, exception
+ * and sleep cycles and the folded instructions; the Atom PMU the cycles, the
+ * instructions, the last level cache misses and the branch mispredictions.
+ */
+enum perf_event {
+	/** Processor cycles. */
+	PERF_EVENT_CYCLES,
+	/** Instructions retired. */
+	PERF_EVENT_INSTRUCTIONS,
+	/** Extra cycles taken by multi-cycle instructions, i.e. stalls
+	 * other than the load/store ones.
+	 */
+	PERF_EVENT_STALL_CYCLES,
+	/** Extra cycles taken by load and store instructions. */
+	PERF_EVENT_LSU_CYCLES,
+	/** Cycles spent entering and leaving exceptions. */
+	PERF_EVENT_EXC_CYCLES,
+	/** Cycles spent sleeping. */
+	PERF_EVENT_SLEEP_CYCLES,
+	/** Instructions folded, i.e. taking no cycle. */
+	PERF_EVENT_FOLDED,
+	/** Last level cache misses. */
+	PERF_EVENT_CACHE_MISSES,
+	/** Mispredicted branches. */
+	PERF_EVENT_BRANCH_MISSES,
+
+	PERF_EVENT_COUNT
+};
+
+/** Bit of an event in an event mask */
+#define PERF_EVENT_BIT(event) (1 << (event))
+
+/**
+ * @brief Event counts.
+ *
+ * The counts of the events not counted stay as they were when they last
+ * were.
+ */
+struct perf_counter_values {
+	/** Count of each event, indexed by enum perf_event. */
+	uint64_t count[PERF_EVENT_COUNT];
+};
+
+/**
+ * @brief Get the events the CPU can count.
+ *
+ * @return Mask of PERF_EVENT_BIT() of the events.
+ */
+extern uint32_t perf_counter_events(void);
+
+/**
+ * @brief Start counting events.
+ *
+ * This routine programs the hardware counters to count @a events, from
+ * zero, replacing the events counted so far. Some counters of the DWT are
+ * 8-bit wide: their counts are only exact if they are read, or a context
+ * switch happens, before they wrap.
+ *
+ * @param events Mask of PERF_EVENT_BIT() of the events.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if the CPU cannot count one of the events.
+ * @retval -EINVAL if the CPU cannot count that many events together.
+ */
+extern int perf_counter_start(uint32_t events);
+
+/**
+ * @brief Stop counting events.
+ *
+ * The counts stay available to perf_counter_read().
+ *
+ * @return N/A
+ */
+extern void perf_counter_stop(void);
+
+/**
+ * @brief Read the event counts.
+ *
+ * This routine gets the counts of all the threads since the events were
+ * started. To measure a code region, read the counts before and after it
+ * and subtract them.
+ *
+ * @param values Address of area to hold the counts.
+ *
+ * @return N/A
+ */
+extern void perf_counter_read(struct perf_counter_values *values);
+
+#ifdef CONFIG_PERF_COUNTER_THREAD
+/**
+ * @brief Read the event counts of a thread.
+ *
+ * This routine gets the counts of the events which occurred while
+ * @a thread was running, since it was spawned: the counts are saved on each
+ * context switch. Unlike perf_counter_read(), the counts of a code region
+ * measured with this routine are not disturbed by the other threads.
+ *
+ * @param thread ID of thread.
+ * @param values Address of area to hold the counts.
+ *
+ * @return N/A
+ */
+extern void perf_counter_thread_read(k_tid_t thread,
+				     struct perf_counter_values *values);
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERF_COUNTER_H__ */
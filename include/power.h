@@ -7,6 +7,9 @@
 #ifndef __INCpower
 #define __INCpower
 
+#include <stdint.h>
+#include <misc/dlist.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -115,6 +118,117 @@ extern int _sys_soc_suspend(int32_t ticks);
  * @}
  */
 
+#ifdef CONFIG_SYS_POWER_STATE_POLICY
+/**
+ * @brief Low Power State Policy
+ *
+ * @defgroup power_state_policy Low Power State Policy
+ * @ingroup power_management_api
+ * @{
+ */
+
+/* Latency of no QoS request, any state is allowed */
+#define SYS_PM_NO_CONSTRAINT		UINT32_MAX
+
+/** Low power state of the SOC */
+struct sys_pm_state {
+	/** SOC specific identifier, passed back to _sys_soc_suspend() */
+	int id;
+	/** Time from the wake event to code running again, in microseconds */
+	uint32_t exit_latency_us;
+	/**
+	 * Minimum time to stay in the state for it to save power, entry and
+	 * exit included, in microseconds
+	 */
+	uint32_t min_residency_us;
+};
+
+/** Wakeup latency constraint, must not be touched by the requester */
+struct sys_pm_qos_request {
+	sys_dnode_t node;
+	uint32_t latency_us;
+};
+
+/**
+ * @brief Register the low power states of the SOC
+ *
+ * Typically called by the SOC initialization code. The table is used as is
+ * and must remain valid.
+ *
+ * @param states States, from the shallowest to the deepest.
+ * @param num_states Number of states.
+ */
+void sys_pm_states_set(const struct sys_pm_state *states, int num_states);
+
+/**
+ * @brief Add a wakeup latency constraint
+ *
+ * Until the request is removed, the state policy only selects states that
+ * exit within @a latency_us microseconds. Drivers add requests while a
+ * transfer is in progress, threads while they have deadlines to meet.
+ *
+ * @param req Request, owned by the caller until it is removed.
+ * @param latency_us Maximum wakeup latency, in microseconds.
+ */
+void sys_pm_qos_request_add(struct sys_pm_qos_request *req,
+			    uint32_t latency_us);
+
+/**
+ * @brief Change the latency of a wakeup latency constraint
+ *
+ * @param req Request previously added.
+ * @param latency_us Maximum wakeup latency, in microseconds.
+ */
+void sys_pm_qos_request_update(struct sys_pm_qos_request *req,
+			       uint32_t latency_us);
+
+/**
+ * @brief Remove a wakeup latency constraint
+ *
+ * @param req Request previously added.
+ */
+void sys_pm_qos_request_remove(struct sys_pm_qos_request *req);
+
+/**
+ * @brief Get the wakeup latency constraint
+ *
+ * @return Lowest latency of all the requests in microseconds, or
+ * SYS_PM_NO_CONSTRAINT if there is none.
+ */
+uint32_t sys_pm_qos_latency_get(void);
+
+/**
+ * @brief Predict the idle time
+ *
+ * @param ticks Ticks until the next timeout, as passed to
+ * _sys_soc_suspend(), or K_FOREVER.
+ *
+ * @return Predicted idle time in microseconds, UINT32_MAX for no limit.
+ */
+uint32_t sys_pm_idle_predict(int32_t ticks);
+
+/**
+ * @brief Select a low power state
+ *
+ * Meant to be called by _sys_soc_suspend().
+ *
+ * @param ticks Ticks until the next timeout, as passed to
+ * _sys_soc_suspend(), or K_FOREVER.
+ *
+ * With CONFIG_DEVICE_RUNTIME_PM, the exit latency of the state plus the
+ * resume latency of the suspended devices must meet the constraints.
+ *
+ * @return The deepest registered state whose exit latency meets the
+ * constraints and whose minimum residency is within the predicted idle
+ * time, NULL if there is none.
+ */
+const struct sys_pm_state *sys_pm_state_select(int32_t ticks);
+
+/**
+ * @}
+ */
+#endif /* CONFIG_SYS_POWER_STATE_POLICY */
+
 #endif /* CONFIG_SYS_POWER_MANAGEMENT */
 
 #ifdef __cplusplus
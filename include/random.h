@@ -24,6 +24,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <errno.h>
 #include <device.h>
 
 /**
@@ -36,8 +37,19 @@ typedef int (*random_get_entropy_t)(struct device *dev,
 				    uint8_t *buffer,
 				    uint16_t length);
 
+/**
+ * @typedef random_get_entropy_isr_t
+ * @brief Callback API to get entropy without waiting.
+ *
+ * See random_get_entropy_isr() for argument description
+ */
+typedef int (*random_get_entropy_isr_t)(struct device *dev,
+					uint8_t *buffer,
+					uint16_t length);
+
 struct random_driver_api {
 	random_get_entropy_t get_entropy;
+	random_get_entropy_isr_t get_entropy_isr;
 };
 
 /**
@@ -61,6 +73,31 @@ static inline int random_get_entropy(struct device *dev,
 	return api->get_entropy(dev, buffer, length);
 }
 
+/**
+ * @brief Get the entropy the random driver has ready.
+ *
+ * Takes entropy from the pool a driver fills in the background, without
+ * waiting for the hardware: it can be called from interrupts.
+ *
+ * @param dev Pointer to the random device.
+ * @param buffer Buffer to fill with entropy.
+ * @param length Buffer length.
+ * @retval Number of bytes written, up to @a length.
+ * @retval -ENOTSUP if the driver has no pool.
+ */
+static inline int random_get_entropy_isr(struct device *dev,
+					 uint8_t *buffer,
+					 uint16_t length)
+{
+	const struct random_driver_api *api = dev->driver_api;
+
+	if (!api->get_entropy_isr) {
+		return -ENOTSUP;
+	}
+
+	return api->get_entropy_isr(dev, buffer, length);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,6 +18,40 @@
 
 #define __noinit     __in_section(NOINIT,    _FILE_PATH_HASH, __COUNTER__)
 
+/*
+ * Functions run from RAM in XIP images, away from the flash wait states
+ * and still running while the flash is erased or written. They are copied
+ * from ROM first thing in _PrepC(), so the BSS clearing and the data copy
+ * may already use them. Calls to them are long calls, RAM and flash being
+ * usually too far apart for a direct branch. The attribute has no effect
+ * when the whole image runs from RAM.
+ */
+#if defined(CONFIG_XIP) && defined(CONFIG_ARCH_HAS_RAMFUNC)
+#define __ramfunc \
+	__attribute__((section("." _STRINGIFY(RAMFUNC)), noinline, long_call))
+#else
+#define __ramfunc
+#endif
+
+/*
+ * Objects in the core coupled memory: initialized, zeroed at boot or left
+ * as they are. The DMA controllers may not reach that memory, see
+ * CONFIG_CCM_DMA_CAPABLE, so DMA buffers do not belong there. Without a
+ * CCM, the objects stay in the main SRAM.
+ */
+#if defined(CONFIG_HAS_CCM)
+#define __ccm_data_section   __in_section(CCM_DATA, _FILE_PATH_HASH, \
+					  __COUNTER__)
+#define __ccm_bss_section    __in_section(CCM_BSS, _FILE_PATH_HASH, \
+					  __COUNTER__)
+#define __ccm_noinit_section __in_section(CCM_NOINIT, _FILE_PATH_HASH, \
+					  __COUNTER__)
+#else
+#define __ccm_data_section
+#define __ccm_bss_section
+#define __ccm_noinit_section __noinit
+#endif
+
 #if defined(CONFIG_ARM)
 #define __scs_section  __in_section(SCS_SECTION, _FILE_PATH_HASH, __COUNTER__)
 #define __scp_section  __in_section(SCP_SECTION, _FILE_PATH_HASH, __COUNTER__)
@@ -22,6 +22,10 @@
 #define _DATA_SECTION_NAME datas
 #define _BSS_SECTION_NAME bss
 #define _NOINIT_SECTION_NAME noinit
+#define _RAMFUNC_SECTION_NAME ramfunc
+#define _CCM_DATA_SECTION_NAME ccm_data
+#define _CCM_BSS_SECTION_NAME ccm_bss
+#define _CCM_NOINIT_SECTION_NAME ccm_noinit
 
 #define _UNDEFINED_SECTION_NAME undefined
 
@@ -39,6 +43,21 @@
 #define DATA data
 #define NOINIT noinit
 
+/* Code linked in RAM and copied there from ROM at boot, see __ramfunc */
+#define RAMFUNC ramfunc
+
+/* Data in the core coupled memory, see CONFIG_HAS_CCM */
+#define CCM_DATA ccm_data
+#define CCM_BSS ccm_bss
+#define CCM_NOINIT ccm_noinit
+
+/* Kernel hot paths, moved to RAM with CONFIG_RAMFUNC_KERNEL */
+#if defined(CONFIG_RAMFUNC_KERNEL)
+#define TEXT_HOT RAMFUNC
+#else
+#define TEXT_HOT TEXT
+#endif
+
 #if defined(CONFIG_ARM)
 #define SCS_SECTION scs
 #define SCP_SECTION scp
@@ -24,8 +24,14 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <device.h>
 #include <errno.h>
+#include <kernel.h>
+
+#ifdef CONFIG_SENSOR_STREAM
+#include <misc/ring_buffer.h>
+#endif
 
 /**
  * @brief Representation of a sensor readout value.
@@ -124,6 +130,13 @@ enum sensor_trigger_type {
 
 	/** Trigger fires when a double tap is detected. */
 	SENSOR_TRIG_DOUBLE_TAP,
+
+	/**
+	 * Trigger fires when the hardware FIFO reached its watermark and
+	 * its content was moved to the stream ring buffer, see
+	 * sensor_stream_start().
+	 */
+	SENSOR_TRIG_FIFO_WATERMARK,
 };
 
 /**
@@ -170,6 +183,11 @@ enum sensor_attribute {
 	 * algorithms to calibrate itself on a certain axis, or all of them.
 	 */
 	SENSOR_ATTR_CALIB_TARGET,
+	/**
+	 * Number of samples in the hardware FIFO at which it is read out
+	 * when streaming.
+	 */
+	SENSOR_ATTR_FIFO_WATERMARK,
 };
 
 /**
@@ -219,11 +237,73 @@ typedef int (*sensor_channel_get_t)(struct device *dev,
 				    enum sensor_channel chan,
 				    struct sensor_value *val);
 
+/**
+ * @typedef sensor_timestamp_get_t
+ * @brief Callback API for getting the time of the fetched sample
+ *
+ * See sensor_sample_timestamp_get() for argument description
+ */
+typedef int (*sensor_timestamp_get_t)(struct device *dev, uint32_t *cycles);
+
+/**
+ * @brief Scale of the raw values of a channel
+ *
+ * The value of the channel, in the unit of sensor_channel_get(), is
+ * (raw * mult + offset) / 2^shift.
+ */
+struct sensor_scale {
+	/** Added to the product, with shift fractional bits */
+	int64_t offset;
+	/** Multiplier, with shift fractional bits */
+	int32_t mult;
+	/** Number of fractional bits, at most 40 */
+	uint8_t shift;
+};
+
+/**
+ * @typedef sensor_channel_get_raw_t
+ * @brief Callback API for getting a raw reading from a sensor
+ *
+ * See sensor_channel_get_raw() for argument description
+ */
+typedef int (*sensor_channel_get_raw_t)(struct device *dev,
+					enum sensor_channel chan,
+					int32_t *raw);
+
+/**
+ * @typedef sensor_scale_get_t
+ * @brief Callback API for getting the scale of the raw readings
+ *
+ * See sensor_scale_get() for argument description
+ */
+typedef int (*sensor_scale_get_t)(struct device *dev,
+				  enum sensor_channel chan,
+				  struct sensor_scale *scale);
+
+#ifdef CONFIG_SENSOR_STREAM
+/**
+ * @typedef sensor_stream_set_t
+ * @brief Callback API for starting or stopping streaming
+ *
+ * See sensor_stream_start() for argument description, a NULL ring
+ * stops streaming.
+ */
+typedef int (*sensor_stream_set_t)(struct device *dev,
+				   struct ring_buf *ring,
+				   sensor_trigger_handler_t handler);
+#endif
+
 struct sensor_driver_api {
 	sensor_attr_set_t attr_set;
 	sensor_trigger_set_t trigger_set;
 	sensor_sample_fetch_t sample_fetch;
 	sensor_channel_get_t channel_get;
+	sensor_timestamp_get_t timestamp_get;
+	sensor_channel_get_raw_t channel_get_raw;
+	sensor_scale_get_t scale_get;
+#ifdef CONFIG_SENSOR_STREAM
+	sensor_stream_set_t stream_set;
+#endif
 };
 
 /**
@@ -360,6 +440,353 @@ static inline int sensor_channel_get(struct device *dev,
 	return api->channel_get(dev, chan, val);
 }
 
+/**
+ * @brief Get a raw reading from a sensor device
+ *
+ * Same as @ref sensor_channel_get, the value being returned as an
+ * integer to be scaled as told by @ref sensor_scale_get, instead of being
+ * converted to a sensor_value. Consumers of many samples can work on the
+ * raw integers, e.g. compare them with thresholds scaled once, and skip
+ * the per sample conversion.
+ *
+ * For the channels with _ANY suffix, the values of the X, Y and Z axes
+ * are returned at raw[0], raw[1] and raw[2].
+ *
+ * @param dev Pointer to the sensor device
+ * @param chan The channel to read
+ * @param raw Where to store the raw value
+ *
+ * @return 0 if successful, -ENOTSUP if the driver has no raw readings,
+ * negative errno code if failure.
+ */
+static inline int sensor_channel_get_raw(struct device *dev,
+					 enum sensor_channel chan,
+					 int32_t *raw)
+{
+	const struct sensor_driver_api *api = dev->driver_api;
+
+	if (!api->channel_get_raw) {
+		return -ENOTSUP;
+	}
+
+	return api->channel_get_raw(dev, chan, raw);
+}
+
+/**
+ * @brief Get the scale of the raw readings of a channel
+ *
+ * The scale only changes when the range or resolution of the channel is
+ * changed through @ref sensor_attr_set, or, for sensors whose calibration
+ * is read out at start, never.
+ *
+ * @param dev Pointer to the sensor device
+ * @param chan The channel
+ * @param scale Where to store the scale
+ *
+ * @return 0 if successful, -ENOTSUP if the driver has no raw readings,
+ * negative errno code if failure.
+ */
+static inline int sensor_scale_get(struct device *dev,
+				   enum sensor_channel chan,
+				   struct sensor_scale *scale)
+{
+	const struct sensor_driver_api *api = dev->driver_api;
+
+	if (!api->scale_get) {
+		return -ENOTSUP;
+	}
+
+	return api->scale_get(dev, chan, scale);
+}
+
+/**
+ * @brief Convert a raw reading to a sensor_value
+ *
+ * @param scale Scale of the channel.
+ * @param raw Raw reading.
+ * @param val Where to store the value
+ */
+static inline void sensor_raw_to_value(const struct sensor_scale *scale,
+				       int32_t raw, struct sensor_value *val)
+{
+	int64_t q = (int64_t)raw * scale->mult + scale->offset;
+	uint64_t mag = q < 0 ? -q : q;
+	uint64_t frac = mag & (((uint64_t)1 << scale->shift) - 1);
+
+	/* Both parts truncated towards zero, with the sign of the value */
+	val->val1 = mag >> scale->shift;
+	val->val2 = (frac * 1000000) >> scale->shift;
+
+	if (q < 0) {
+		val->val1 = -val->val1;
+		val->val2 = -val->val2;
+	}
+}
+
+/**
+ * @brief Get the time at which the fetched sample was taken
+ *
+ * When the sample was fetched after a data ready interrupt, this is the
+ * time of the interrupt, captured in the interrupt handler, so that the
+ * latency of the trigger fiber doesn't matter. Otherwise this is the
+ * time of the fetch.
+ *
+ * @param dev Pointer to the sensor device
+ * @param cycles k_cycle_get_32() time of the sample
+ *
+ * @return 0 if successful, negative errno code if failure.
+ */
+static inline int sensor_sample_timestamp_get(struct device *dev,
+					      uint32_t *cycles)
+{
+	const struct sensor_driver_api *api = dev->driver_api;
+
+	if (!api->timestamp_get) {
+		return -ENOTSUP;
+	}
+
+	return api->timestamp_get(dev, cycles);
+}
+
+/**
+ * @brief Sample timestamp, for the drivers
+ */
+struct sensor_timestamp {
+	/** Time of the last data ready interrupt */
+	uint32_t irq;
+	/** Time of the fetched sample */
+	uint32_t sample;
+	/** Whether an interrupt came since the last fetch */
+	bool irq_valid;
+};
+
+/**
+ * @brief Record the time of a data ready interrupt
+ *
+ * To be called from the interrupt handler.
+ *
+ * @param ts Sample timestamp of the driver.
+ */
+static inline void sensor_timestamp_irq(struct sensor_timestamp *ts)
+{
+	ts->irq = k_cycle_get_32();
+	ts->irq_valid = true;
+}
+
+/**
+ * @brief Record the time of the sample being fetched
+ *
+ * To be called when the sample is read out, that is the time of its
+ * interrupt if there is one.
+ *
+ * @param ts Sample timestamp of the driver.
+ */
+static inline void sensor_timestamp_fetch(struct sensor_timestamp *ts)
+{
+	ts->sample = ts->irq_valid ? ts->irq : k_cycle_get_32();
+	ts->irq_valid = false;
+}
+
+#ifdef CONFIG_SENSOR_TRIGGER_THREAD
+extern struct k_work_q sensor_trigger_workq;
+#endif
+
+/**
+ * @brief Submit the trigger work of a driver
+ *
+ * For the drivers using the global thread: the work runs on the sensor
+ * trigger thread if CONFIG_SENSOR_TRIGGER_THREAD is enabled, on the
+ * system work queue otherwise.
+ *
+ * @param work Trigger work of the driver.
+ */
+static inline void sensor_trigger_work_submit(struct k_work *work)
+{
+#ifdef CONFIG_SENSOR_TRIGGER_THREAD
+	k_work_submit_to_queue(&sensor_trigger_workq, work);
+#else
+	k_work_submit(work);
+#endif
+}
+
+#ifdef CONFIG_SENSOR_GROUP
+struct sensor_group;
+
+/**
+ * @typedef sensor_group_handler_t
+ * @brief Called once all the sensors of a group were fetched
+ *
+ * @param group The sensor group.
+ * @param err 0 if all the fetches succeeded, the error of the first one
+ * which failed otherwise.
+ */
+typedef void (*sensor_group_handler_t)(struct sensor_group *group, int err);
+
+/**
+ * @brief Sensors fetched together
+ *
+ * On each pass, started by a timer or by a trigger of one of the
+ * sensors, all the sensors are fetched back to back from the same fiber
+ * and the handler is called, the samples and their timestamps can then
+ * be read.
+ */
+struct sensor_group {
+	/** Sensors of the group */
+	struct device **sensors;
+	/** Number of sensors */
+	uint8_t count;
+	/** Called after each pass */
+	sensor_group_handler_t handler;
+
+	/* private */
+	sys_snode_t node;
+	struct device *leader;
+	struct sensor_trigger trig;
+	int32_t period;
+	struct k_delayed_work work;
+};
+
+/**
+ * @brief Fetch the sensors of a group periodically
+ *
+ * The passes run from the system work queue.
+ *
+ * @param group The sensor group.
+ * @param period Time between passes, in milliseconds.
+ *
+ * @return 0 if successful, negative errno code if failure.
+ */
+int sensor_group_timer_start(struct sensor_group *group, int32_t period);
+
+/**
+ * @brief Fetch the sensors of a group on a trigger of one of them
+ *
+ * Typically the data ready trigger of the sensor with the highest data
+ * rate. The passes run from the trigger fiber of that sensor.
+ *
+ * @param group The sensor group.
+ * @param leader The sensor whose trigger starts the passes, it is
+ * fetched first whether or not it is in the group.
+ * @param trig The trigger to set on the leader.
+ *
+ * @return 0 if successful, negative errno code if failure.
+ */
+int sensor_group_trigger_start(struct sensor_group *group,
+			       struct device *leader,
+			       const struct sensor_trigger *trig);
+
+/**
+ * @brief Stop the passes of a group
+ *
+ * @param group The sensor group.
+ */
+void sensor_group_stop(struct sensor_group *group);
+#endif /* CONFIG_SENSOR_GROUP */
+
+#ifdef CONFIG_SENSOR_STREAM
+/**
+ * @brief Batch of streamed samples
+ *
+ * Each item of a stream ring buffer is a batch of samples of one
+ * channel, with the channel as item type and the sample count as item
+ * value. The samples are the raw readings of the X, Y and Z axes, one
+ * after the other.
+ */
+struct sensor_batch {
+	/** k_cycle_get_32() time of the last sample */
+	uint32_t timestamp;
+	/** Sample period, in k_cycle_get_32() cycles */
+	uint32_t period;
+	/** Value of one LSB of the raw readings, in millionths of unit */
+	int32_t scale;
+	/** count * 3 raw readings */
+	int16_t samples[];
+};
+
+/**
+ * @brief Size of a batch of @a count samples, in 32-bit words
+ */
+#define SENSOR_BATCH_SIZE32(count) \
+	((sizeof(struct sensor_batch) + (count) * 3 * sizeof(int16_t) + 3) / 4)
+
+/**
+ * @brief Stream samples from the hardware FIFO to a ring buffer
+ *
+ * Whenever the FIFO of the sensor reaches its watermark, see
+ * @ref SENSOR_ATTR_FIFO_WATERMARK, the driver reads it out in a burst,
+ * puts the samples in the ring buffer as struct sensor_batch items and
+ * calls the handler with a @ref SENSOR_TRIG_FIFO_WATERMARK trigger. The
+ * handler is called from the same fiber as the other triggers. Batches
+ * not fitting in the ring buffer are dropped.
+ *
+ * @param dev Pointer to the sensor device
+ * @param ring Ring buffer, with a single reader.
+ * @param handler The function that should be called when batches were
+ * added, or NULL.
+ *
+ * @return 0 if successful, negative errno code if failure.
+ */
+static inline int sensor_stream_start(struct device *dev,
+				      struct ring_buf *ring,
+				      sensor_trigger_handler_t handler)
+{
+	const struct sensor_driver_api *api = dev->driver_api;
+
+	if (!api->stream_set) {
+		return -ENOTSUP;
+	}
+
+	return api->stream_set(dev, ring, handler);
+}
+
+/**
+ * @brief Stop streaming samples
+ *
+ * @param dev Pointer to the sensor device
+ *
+ * @return 0 if successful, negative errno code if failure.
+ */
+static inline int sensor_stream_stop(struct device *dev)
+{
+	const struct sensor_driver_api *api = dev->driver_api;
+
+	if (!api->stream_set) {
+		return -ENOTSUP;
+	}
+
+	return api->stream_set(dev, NULL, NULL);
+}
+
+/**
+ * @brief Get the next batch of samples from a stream ring buffer
+ *
+ * @param ring Ring buffer given to sensor_stream_start().
+ * @param chan Channel of the samples.
+ * @param count Number of samples.
+ * @param batch Word aligned storage for the batch.
+ * @param size32 Size of the storage, in 32-bit words, updated with the
+ * size of the batch.
+ *
+ * @retval 0 If successful.
+ * @retval -EAGAIN If the ring buffer is empty.
+ * @retval -EMSGSIZE If the storage is too small, see @a size32.
+ */
+static inline int sensor_stream_get(struct ring_buf *ring,
+				    enum sensor_channel *chan,
+				    uint8_t *count,
+				    struct sensor_batch *batch,
+				    uint8_t *size32)
+{
+	uint16_t type;
+	int err;
+
+	err = sys_ring_buf_get(ring, &type, count, (uint32_t *)batch, size32);
+	*chan = type;
+
+	return err;
+}
+#endif /* CONFIG_SENSOR_STREAM */
+
 /**
  * @brief The value of gravitational constant in micro m/s^2.
  */
@@ -19,9 +19,11 @@
  * @{
  */
 
+#include <errno.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <device.h>
+#include <misc/slist.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -88,10 +90,69 @@ typedef int (*spi_api_io)(struct device *dev,
 			  const void *tx_buf, uint32_t tx_buf_len,
 			  void *rx_buf, uint32_t rx_buf_len);
 
+/**
+ * @brief SPI buffer, one piece of a scatter-gather transfer
+ *
+ * A NULL buf in a TX buffer clocks out len bytes of dummy data, a NULL
+ * buf in an RX buffer discards len bytes.
+ */
+struct spi_buf {
+	void *buf;
+	uint32_t len;
+};
+
+/**
+ * @typedef spi_callback_t
+ * @brief Asynchronous transaction completion callback
+ *
+ * Called from the SPI transaction thread, it shall not block.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param status 0 if the transaction succeeded, negative errno code
+ *		 otherwise.
+ * @param user_data User data of the transaction.
+ */
+typedef void (*spi_callback_t)(struct device *dev, int status,
+			       void *user_data);
+
+/**
+ * @brief SPI asynchronous transaction
+ *
+ * The TX buffers are sent one after the other while the RX buffers are
+ * filled one after the other, all of it with the slave selected. The
+ * transaction belongs to the driver until its callback is called.
+ */
+struct spi_transaction {
+	sys_snode_t node;
+	/** Bus configuration for this transaction, NULL to use the one set
+	 *  with spi_configure().
+	 */
+	struct spi_config *config;
+	/** Slave to select, as for spi_slave_select(), 0 to use the one set
+	 *  with spi_slave_select().
+	 */
+	uint32_t slave;
+	const struct spi_buf *tx_bufs;
+	uint32_t tx_count;
+	const struct spi_buf *rx_bufs;
+	uint32_t rx_count;
+	spi_callback_t cb;
+	void *user_data;
+};
+
+/**
+ * @typedef spi_api_io_async
+ * @brief Callback API for asynchronous I/O
+ * See spi_transceive_async() for argument descriptions
+ */
+typedef int (*spi_api_io_async)(struct device *dev,
+				struct spi_transaction *trans);
+
 struct spi_driver_api {
 	spi_api_configure configure;
 	spi_api_slave_select slave_select;
 	spi_api_io transceive;
+	spi_api_io_async transceive_async;
 };
 
 /**
@@ -192,6 +253,48 @@ static inline int spi_transceive(struct device *dev,
 	return api->transceive(dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
 }
 
+/**
+ * @brief Queue an asynchronous transaction.
+ *
+ * Transactions, including the ones of spi_transceive(), are run one at a
+ * time in the order they were queued. Each applies its own configuration
+ * and slave select, so that several slave drivers can share the bus.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans Transaction, its callback is called once it is done.
+ *
+ * @retval 0 If the transaction was queued.
+ * @retval -ENOTSUP If the driver has no asynchronous support.
+ * @retval Negative errno code if failure.
+ */
+static inline int spi_transceive_async(struct device *dev,
+				       struct spi_transaction *trans)
+{
+	const struct spi_driver_api *api = dev->driver_api;
+
+	if (!api->transceive_async) {
+		return -ENOTSUP;
+	}
+
+	return api->transceive_async(dev, trans);
+}
+
+#if defined(CONFIG_SPI_ASYNC)
+/**
+ * @brief Run a scatter-gather transaction and wait for it to be done.
+ *
+ * The callback and user data of the transaction are not used. It shall
+ * not be called from an SPI completion callback.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param trans Transaction to run.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int spi_transceive_bufs(struct device *dev, struct spi_transaction *trans);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Spinlock APIs
+ */
+
+#ifndef _SPINLOCK_H_
+#define _SPINLOCK_H_
+
+#include <kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup spinlock_apis Spinlock APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/**
+ * @brief Kernel spinlock.
+ *
+ * A spinlock protects data that is shared between threads and ISRs. The
+ * kernel only runs on one CPU, so taking a spinlock is just locking
+ * interrupts, and the lock has no state. Code protecting its data with
+ * spinlocks rather than irq_lock() says which data each lock covers.
+ */
+struct k_spinlock {
+};
+
+/**
+ * @brief Statically define and initialize a spinlock.
+ *
+ * @param name Name of the spinlock.
+ */
+#define K_SPINLOCK_DEFINE(name) struct k_spinlock name = { }
+
+/**
+ * @brief Take a spinlock.
+ *
+ * This routine locks interrupts. It can be called from ISRs. A spinlock
+ * must not be taken again by its holder.
+ *
+ * @param lock Spinlock.
+ *
+ * @return Interrupt lock-out key, to be passed to k_spin_unlock().
+ */
+static ALWAYS_INLINE unsigned int k_spin_lock(struct k_spinlock *lock)
+{
+	ARG_UNUSED(lock);
+
+	return irq_lock();
+}
+
+/**
+ * @brief Give a spinlock.
+ *
+ * This routine restores the interrupt lock-out state saved by
+ * k_spin_lock().
+ *
+ * @param lock Spinlock.
+ * @param key Interrupt lock-out key returned by k_spin_lock().
+ *
+ * @return N/A
+ */
+static ALWAYS_INLINE void k_spin_unlock(struct k_spinlock *lock,
+					unsigned int key)
+{
+	ARG_UNUSED(lock);
+
+	irq_unlock(key);
+}
+
+/**
+ * @} end defgroup spinlock_apis
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SPINLOCK_H_ */
@@ -66,6 +66,20 @@ extern int sys_clock_hw_cycles_per_tick;
 #define NSEC_PER_SEC ((NSEC_PER_USEC) * (USEC_PER_MSEC) * (MSEC_PER_SEC))
 
 
+/*
+ * _SYS_CLOCK_NS_PER_CYCLE_Q32 is the duration of a hardware clock cycle in
+ * nanoseconds, as a 32.32 fixed-point value, used by k_cycle_to_ns_64()
+ */
+#if defined(CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME)
+extern uint64_t _sys_clock_ns_per_cycle_q32;
+#define _SYS_CLOCK_NS_PER_CYCLE_Q32 _sys_clock_ns_per_cycle_q32
+#elif defined(CONFIG_SYS_CLOCK_EXISTS)
+#define _SYS_CLOCK_NS_PER_CYCLE_Q32 \
+	(((uint64_t)NSEC_PER_SEC << 32) / sys_clock_hw_cycles_per_sec)
+#else
+#define _SYS_CLOCK_NS_PER_CYCLE_Q32 ((uint64_t)0)
+#endif
+
 /* SYS_CLOCK_HW_CYCLES_TO_NS64 converts CPU clock cycles to nanoseconds */
 #define SYS_CLOCK_HW_CYCLES_TO_NS64(X) \
 	(((uint64_t)(X) * sys_clock_us_per_tick * NSEC_PER_USEC) / \
@@ -101,6 +115,7 @@ extern int sys_clock_hw_cycles_per_tick;
  */
 
 extern int64_t _sys_clock_tick_count;
+extern uint32_t _tick_get_32(void);
 
 /*
  * Number of ticks for x seconds. NOTE: With MSEC() or USEC(),
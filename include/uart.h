@@ -569,6 +569,175 @@ static inline int uart_drv_cmd(struct device *dev, uint32_t cmd, uint32_t p)
 
 #endif /* CONFIG_UART_DRV_CMD */
 
+#ifdef CONFIG_UART_ASYNC_API
+
+#include <kernel.h>
+#include <misc/slist.h>
+
+/** @brief Types of the asynchronous UART events */
+enum uart_event_type {
+	/** The whole TX buffer was handed to the hardware */
+	UART_TX_DONE,
+	/** uart_async_tx_abort() was called, see the length sent */
+	UART_TX_ABORTED,
+	/** Data was received, after the idle timeout or a full buffer */
+	UART_RX_RDY,
+	/** The next RX buffer is needed, see uart_async_rx_buf_rsp() */
+	UART_RX_BUF_REQUEST,
+	/** The RX buffer is not used anymore and can be reused */
+	UART_RX_BUF_RELEASED,
+	/** Reception stopped, by request or for lack of a buffer */
+	UART_RX_DISABLED,
+};
+
+/** @brief Asynchronous UART event */
+struct uart_event {
+	enum uart_event_type type;
+	union {
+		/** UART_TX_DONE and UART_TX_ABORTED */
+		struct {
+			const uint8_t *buf;
+			size_t len;
+		} tx;
+		/** UART_RX_RDY: len new bytes at buf + offset */
+		struct {
+			uint8_t *buf;
+			size_t offset;
+			size_t len;
+		} rx;
+		/** UART_RX_BUF_RELEASED */
+		struct {
+			uint8_t *buf;
+		} rx_buf;
+	} data;
+};
+
+/**
+ * @typedef uart_callback_t
+ * @brief Asynchronous UART event callback
+ *
+ * Called from the UART interrupt, or from the timer interrupt for the
+ * idle timeout, it shall not block.
+ */
+typedef void (*uart_callback_t)(struct device *dev, struct uart_event *evt,
+				void *user_data);
+
+/**
+ * @brief Asynchronous UART context
+ *
+ * Built on the interrupt driven API, which it takes over for the device.
+ * The fields are private.
+ */
+struct uart_async {
+	sys_snode_t node;
+	struct device *dev;
+	uart_callback_t cb;
+	void *user_data;
+
+	const uint8_t *tx_buf;
+	size_t tx_len;
+	size_t tx_off;
+
+	uint8_t *rx_buf;
+	size_t rx_len;
+	size_t rx_off;
+	size_t rx_reported;
+	uint8_t *rx_next;
+	size_t rx_next_len;
+	int32_t rx_timeout;
+	struct k_timer rx_timer;
+};
+
+/**
+ * @brief Set up the asynchronous API for a UART.
+ *
+ * @param async Context, to be kept as long as the UART is used.
+ * @param dev UART device structure.
+ * @param cb Event callback.
+ * @param user_data User data passed to the callback.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int uart_async_init(struct uart_async *async, struct device *dev,
+		    uart_callback_t cb, void *user_data);
+
+/**
+ * @brief Send a buffer.
+ *
+ * UART_TX_DONE is raised once all of it is handed to the hardware.
+ *
+ * @param async Asynchronous UART context.
+ * @param buf Data to send, to be kept until the TX event.
+ * @param len Length of the data.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If a transmission is already in progress.
+ */
+int uart_async_tx(struct uart_async *async, const uint8_t *buf, size_t len);
+
+/**
+ * @brief Abort the transmission in progress.
+ *
+ * @param async Asynchronous UART context.
+ *
+ * @retval 0 If successful, UART_TX_ABORTED being raised.
+ * @retval -EFAULT If there was no transmission in progress.
+ */
+int uart_async_tx_abort(struct uart_async *async);
+
+/**
+ * @brief Start receiving.
+ *
+ * Data is written to the buffer as it arrives. UART_RX_RDY is raised
+ * once the line has been idle for @a timeout milliseconds after some
+ * data, or when the buffer is full. UART_RX_BUF_REQUEST is raised
+ * right away for the buffer to switch to when this one is full, so that
+ * reception goes on without a gap.
+ *
+ * @param async Asynchronous UART context.
+ * @param buf First receive buffer.
+ * @param len Length of the buffer.
+ * @param timeout Idle timeout in milliseconds, K_FOREVER for none.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If reception is already enabled.
+ */
+int uart_async_rx_enable(struct uart_async *async, uint8_t *buf, size_t len,
+			 int32_t timeout);
+
+/**
+ * @brief Provide the next receive buffer.
+ *
+ * To be called in response to UART_RX_BUF_REQUEST, possibly from the
+ * callback itself.
+ *
+ * @param async Asynchronous UART context.
+ * @param buf Next receive buffer.
+ * @param len Length of the buffer.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If a next buffer is already set.
+ * @retval -EACCES If reception is not enabled.
+ */
+int uart_async_rx_buf_rsp(struct uart_async *async, uint8_t *buf,
+			  size_t len);
+
+/**
+ * @brief Stop receiving.
+ *
+ * The data received is reported, the buffers are released and
+ * UART_RX_DISABLED is raised.
+ *
+ * @param async Asynchronous UART context.
+ *
+ * @retval 0 If successful.
+ * @retval -EFAULT If reception was not enabled.
+ */
+int uart_async_rx_disable(struct uart_async *async);
+
+#endif /* CONFIG_UART_ASYNC_API */
+
 #ifdef __cplusplus
 }
 #endif
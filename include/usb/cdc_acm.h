@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief CDC ACM extensions to the UART API
+ *
+ * Available with CONFIG_CDC_ACM_RING_BUFFERS, to read the received data
+ * in place instead of copying it out with uart_fifo_read().
+ */
+
+#ifndef __USB_CDC_ACM_H__
+#define __USB_CDC_ACM_H__
+
+#include <stdint.h>
+#include <device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the received data without copying it
+ *
+ * Only the data up to the end of the RX ring is returned, call again
+ * after cdc_acm_rx_finish() for the rest. Not to be mixed with
+ * uart_fifo_read() from another context.
+ *
+ * @param dev  CDC ACM device struct.
+ * @param data Set to the first received byte.
+ *
+ * @return Number of bytes available at @a data.
+ */
+uint32_t cdc_acm_rx_claim(struct device *dev, uint8_t **data);
+
+/**
+ * @brief Release data got with cdc_acm_rx_claim()
+ *
+ * @param dev  CDC ACM device struct.
+ * @param size Number of bytes done with, at most what was claimed.
+ *
+ * @return N/A.
+ */
+void cdc_acm_rx_finish(struct device *dev, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USB_CDC_ACM_H__ */
@@ -36,6 +36,7 @@
 #ifndef USB_DEVICE_H_
 #define USB_DEVICE_H_
 
+#include <stddef.h>
 #include <drivers/usb/usb_dc.h>
 #include <usb/usbstruct.h>
 
@@ -297,4 +298,83 @@ int usb_ep_read_wait(uint8_t ep, uint8_t *data, uint32_t max_data_len,
  */
 int usb_ep_read_continue(uint8_t ep);
 
+/*
+ * Transfer flags
+ */
+#define USB_TRANS_READ       (1 << 0)  /**< Read transfer, on an OUT EP */
+#define USB_TRANS_WRITE      (1 << 1)  /**< Write transfer, on an IN EP */
+/** Do not end a write of whole packets with a zero length packet */
+#define USB_TRANS_NO_ZLP     (1 << 2)
+
+/**
+ * @brief Transfer completion callback
+ *
+ * Called from the system work queue once the transfer is done.
+ *
+ * @param[in] ep    Endpoint of the transfer
+ * @param[in] tsize Number of bytes transferred, or negative errno code
+ *                  on fail (-ECANCELED if cancelled)
+ * @param[in] priv  Argument given to usb_transfer()
+ */
+typedef void (*usb_transfer_callback)(uint8_t ep, int tsize, void *priv);
+
+/**
+ * @brief Transfer a buffer on an endpoint
+ *
+ * Queue a transfer of a whole buffer on an endpoint, which the stack splits
+ * in as many packets as needed, the controller sending or receiving them
+ * without the class having to handle each one. A write ends with a zero
+ * length packet if the buffer is made of whole packets, unless
+ * USB_TRANS_NO_ZLP is set, so that the host sees the end of the transfer;
+ * a read ends once the buffer is full or on a short packet.
+ *
+ * The endpoint must have usb_transfer_ep_callback() as callback in the
+ * device configuration. One transfer can run at a time on an endpoint.
+ *
+ * @param[in] ep    Endpoint address corresponding to the one listed in
+ *                  the device configuration table
+ * @param[in] data  Buffer to write from or read to, which must stay valid
+ *                  until the transfer is done
+ * @param[in] dlen  Length of the buffer
+ * @param[in] flags USB_TRANS_* flags, USB_TRANS_READ or USB_TRANS_WRITE
+ *                  matching the endpoint direction
+ * @param[in] cb    Completion callback, may be NULL
+ * @param[in] priv  Argument of the callback
+ *
+ * @return 0 if queued, -EBUSY if a transfer runs on the endpoint, -ENOMEM
+ *         if CONFIG_USB_MAX_NUM_TRANSFERS transfers run, other negative
+ *         errno code on fail
+ */
+int usb_transfer(uint8_t ep, uint8_t *data, size_t dlen, unsigned int flags,
+		 usb_transfer_callback cb, void *priv);
+
+/**
+ * @brief Transfer a buffer on an endpoint, waiting for its end
+ *
+ * Like usb_transfer(), but blocks the calling thread until the transfer
+ * is done. Cannot be called from the system work queue.
+ *
+ * @return Number of bytes transferred, or negative errno code on fail
+ */
+int usb_transfer_sync(uint8_t ep, uint8_t *data, size_t dlen,
+		      unsigned int flags);
+
+/**
+ * @brief Cancel the transfer running on an endpoint
+ *
+ * Its callback is called with -ECANCELED. The transfers are also
+ * cancelled on bus reset and disconnection.
+ *
+ * @param[in] ep Endpoint address
+ */
+void usb_cancel_transfer(uint8_t ep);
+
+/**
+ * @brief Endpoint callback running the transfers
+ *
+ * To be set as the callback of the endpoints used with usb_transfer().
+ */
+void usb_transfer_ep_callback(uint8_t ep,
+			      enum usb_dc_ep_cb_status_code status);
+
 #endif /* USB_DEVICE_H_ */
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file 64-bit atomic ops in pure C
+ *
+ * This module provides the 64-bit atomic operators for processors which
+ * have no 64-bit atomic instruction: none of the ARMv7-M, ARC, Nios II or
+ * RV32 processors can update 64 bits at once, so these lock interrupts
+ * around a plain read-modify-write. The 32-bit atomic operators are not
+ * affected.
+ */
+
+#include <atomic.h>
+#include <toolchain.h>
+#include <arch/cpu.h>
+
+int atomic64_cas(atomic64_t *target, atomic64_val_t old_value,
+		 atomic64_val_t new_value)
+{
+	unsigned int key;
+	int ret = 0;
+
+	key = irq_lock();
+
+	if (*target == old_value) {
+		*target = new_value;
+		ret = 1;
+	}
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+atomic64_val_t atomic64_add(atomic64_t *target, atomic64_val_t value)
+{
+	unsigned int key;
+	atomic64_val_t ret;
+
+	key = irq_lock();
+
+	ret = *target;
+	*target += value;
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+atomic64_val_t atomic64_sub(atomic64_t *target, atomic64_val_t value)
+{
+	unsigned int key;
+	atomic64_val_t ret;
+
+	key = irq_lock();
+
+	ret = *target;
+	*target -= value;
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+atomic64_val_t atomic64_get(const atomic64_t *target)
+{
+	unsigned int key;
+	atomic64_val_t ret;
+
+	key = irq_lock();
+
+	ret = *target;
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+atomic64_val_t atomic64_set(atomic64_t *target, atomic64_val_t value)
+{
+	unsigned int key;
+	atomic64_val_t ret;
+
+	key = irq_lock();
+
+	ret = *target;
+	*target = value;
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+atomic64_val_t atomic64_or(atomic64_t *target, atomic64_val_t value)
+{
+	unsigned int key;
+	atomic64_val_t ret;
+
+	key = irq_lock();
+
+	ret = *target;
+	*target |= value;
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+atomic64_val_t atomic64_and(atomic64_t *target, atomic64_val_t value)
+{
+	unsigned int key;
+	atomic64_val_t ret;
+
+	key = irq_lock();
+
+	ret = *target;
+	*target &= value;
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+atomic64_val_t atomic64_xor(atomic64_t *target, atomic64_val_t value)
+{
+	unsigned int key;
+	atomic64_val_t ret;
+
+	key = irq_lock();
+
+	ret = *target;
+	*target ^= value;
+
+	irq_unlock(key);
+
+	return ret;
+}
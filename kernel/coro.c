@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief Stackless coroutines running on workqueues.
+ *
+ * A coroutine is a work item whose handler resumes the coroutine's body at
+ * the point where it last waited. Waiting on an object registers a poller on
+ * it, like k_poll() does, but pointing to the coroutine instead of a thread:
+ * signaling the object resubmits the coroutine to its workqueue instead of
+ * readying a thread.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <wait_q.h>
+#include <ksched.h>
+#include <misc/__assert.h>
+
+static void coro_run(struct k_work *work)
+{
+	struct k_coro *coro = CONTAINER_OF(work, struct k_coro, work);
+
+	(void)coro->entry(coro);
+}
+
+static void coro_timeout(struct _timeout *t)
+{
+	struct k_coro *coro = CONTAINER_OF(t, struct k_coro, timeout);
+	unsigned int key = irq_lock();
+	int was_waiting = coro->waiting;
+
+	if (coro->wait_state != _CORO_WAIT_ARMED) {
+		irq_unlock(key);
+		return;
+	}
+
+	coro->wait_state = _CORO_WAIT_EXPIRED;
+
+	if (was_waiting) {
+		coro->waiting = 0;
+		_coro_poll_unregister(&coro->event);
+	}
+
+	irq_unlock(key);
+
+	if (was_waiting) {
+		k_work_submit_to_queue(coro->work_q, &coro->work);
+	}
+}
+
+void k_coro_init(struct k_coro *coro, k_coro_entry_t entry)
+{
+	k_work_init(&coro->work, coro_run);
+	_init_timeout(&coro->timeout, coro_timeout);
+	coro->work_q = NULL;
+	coro->entry = entry;
+	coro->poller.thread = NULL;
+	coro->poller.coro = coro;
+	coro->event.poller = NULL;
+	coro->resume = 0;
+	coro->waiting = 0;
+	coro->wait_state = _CORO_WAIT_NONE;
+}
+
+void k_coro_start(struct k_coro *coro, struct k_work_q *work_q)
+{
+	__ASSERT(!coro->resume, "coroutine has not exited\n");
+
+	coro->work_q = work_q;
+	k_work_submit_to_queue(work_q, &coro->work);
+}
+
+void _k_coro_yield(struct k_coro *coro)
+{
+	k_work_submit_to_queue(coro->work_q, &coro->work);
+}
+
+void _k_coro_wait_start(struct k_coro *coro, int32_t timeout)
+{
+	unsigned int key = irq_lock();
+
+	_abort_timeout(&coro->timeout);
+
+	if (timeout == K_NO_WAIT) {
+		coro->wait_state = _CORO_WAIT_NONE;
+	} else if (timeout == K_FOREVER) {
+		coro->wait_state = _CORO_WAIT_FOREVER;
+	} else {
+		coro->wait_state = _CORO_WAIT_ARMED;
+		_add_timeout(NULL, &coro->timeout, NULL,
+			     _TICK_ALIGN + _timeout_to_ticks(timeout));
+	}
+
+	irq_unlock(key);
+}
+
+/* must be called with interrupts locked */
+static inline void end_wait(struct k_coro *coro)
+{
+	_abort_timeout(&coro->timeout);
+	coro->wait_state = _CORO_WAIT_NONE;
+}
+
+/*
+ * Wait for an object to become available, after failing to obtain it.
+ * Returns 1 if it has become available meanwhile and the caller must try
+ * again, -EINPROGRESS if the coroutine must return to its workqueue, or the
+ * error code ending the wait.
+ *
+ * Must be called with interrupts locked.
+ */
+static int wait_event(struct k_coro *coro, uint32_t type, void *obj,
+		      int no_wait_rc)
+{
+	int rc;
+
+	switch (coro->wait_state) {
+	case _CORO_WAIT_NONE:
+		return no_wait_rc;
+	case _CORO_WAIT_EXPIRED:
+		coro->wait_state = _CORO_WAIT_NONE;
+		return -EAGAIN;
+	default:
+		break;
+	}
+
+	k_poll_event_init(&coro->event, type, K_POLL_MODE_NOTIFY_ONLY, obj);
+
+	rc = _coro_poll_register(&coro->event, &coro->poller);
+	if (rc == 1) {
+		return 1;
+	}
+
+	if (rc == -EADDRINUSE) {
+		end_wait(coro);
+		return rc;
+	}
+
+	coro->waiting = 1;
+
+	return -EINPROGRESS;
+}
+
+int _k_coro_sleep(struct k_coro *coro)
+{
+	unsigned int key = irq_lock();
+
+	if (coro->wait_state == _CORO_WAIT_ARMED ||
+	    coro->wait_state == _CORO_WAIT_FOREVER) {
+		coro->waiting = 1;
+		irq_unlock(key);
+		return -EINPROGRESS;
+	}
+
+	coro->wait_state = _CORO_WAIT_NONE;
+	irq_unlock(key);
+
+	return 0;
+}
+
+int _k_coro_sem_take(struct k_coro *coro, struct k_sem *sem)
+{
+	unsigned int key;
+	int rc;
+
+	do {
+		key = irq_lock();
+
+		if (k_sem_take(sem, K_NO_WAIT) == 0) {
+			end_wait(coro);
+			irq_unlock(key);
+			return 0;
+		}
+
+		rc = wait_event(coro, K_POLL_TYPE_SEM_AVAILABLE, sem, -EBUSY);
+
+		irq_unlock(key);
+	} while (rc == 1);
+
+	return rc;
+}
+
+int _k_coro_fifo_get(struct k_coro *coro, struct k_fifo *fifo, void **data)
+{
+	unsigned int key;
+	int rc;
+
+	do {
+		key = irq_lock();
+
+		*data = k_fifo_get(fifo, K_NO_WAIT);
+		if (*data) {
+			end_wait(coro);
+			irq_unlock(key);
+			return 0;
+		}
+
+		rc = wait_event(coro, K_POLL_TYPE_FIFO_DATA_AVAILABLE, fifo,
+				-EBUSY);
+
+		irq_unlock(key);
+	} while (rc == 1);
+
+	return rc;
+}
+
+/*
+ * Called when an object a coroutine waits on is signaled. Returns 1 if a
+ * reschedule must take place, 0 otherwise.
+ *
+ * Must be called with interrupts locked.
+ */
+int _coro_wake(struct k_coro *coro)
+{
+	if (!coro->waiting) {
+		return 0;
+	}
+
+	coro->waiting = 0;
+
+	if (atomic_test_and_set_bit(coro->work.flags, K_WORK_STATE_PENDING)) {
+		return 0;
+	}
+
+	return _k_queue_append_locked(&coro->work_q->fifo._queue, &coro->work);
+}
@@ -7,8 +7,16 @@
 #include <errno.h>
 #include <string.h>
 #include <device.h>
+#include <init.h>
 #include <misc/util.h>
 #include <atomic.h>
+#if defined(CONFIG_DEVICE_INIT_ASYNC) || \
+	defined(CONFIG_DEVICE_INIT_PROFILING) || \
+	defined(CONFIG_DEVICE_LOOKUP_HASH)
+#include <kernel.h>
+#include <misc/__assert.h>
+#include <misc/printk.h>
+#endif
 
 extern struct device __device_init_start[];
 extern struct device __device_PRE_KERNEL_1_start[];
@@ -22,6 +30,8 @@ extern struct device __device_SECONDARY_start[];
 extern struct device __device_NANOKERNEL_start[];
 extern struct device __device_MICROKERNEL_start[];
 
+extern struct device __device_ASYNC_start[];
+
 extern struct device __device_init_end[];
 
 static struct device *config_levels[] = {
@@ -36,6 +46,8 @@ static struct device *config_levels[] = {
 	__device_NANOKERNEL_start,
 	__device_MICROKERNEL_start,
 
+	__device_ASYNC_start,
+
 	/* End marker */
 	__device_init_end,
 };
@@ -58,21 +70,279 @@ extern uint32_t __device_busy_end[];
  *
  * @param level init level to run.
  */
+static inline void device_init(struct device *info)
+{
+#ifdef CONFIG_DEVICE_INIT_PROFILING
+	uint32_t start = k_cycle_get_32();
+
+	info->config->init(info);
+	info->init_cycles = k_cycle_get_32() - start;
+#else
+	info->config->init(info);
+#endif
+}
+
 void _sys_device_do_config_level(int level)
 {
 	struct device *info;
 
 	for (info = config_levels[level]; info < config_levels[level+1]; info++) {
-		struct device_config *device = info->config;
+		device_init(info);
+	}
+}
+
+#ifdef CONFIG_DEVICE_INIT_ASYNC
+extern const struct device_init_dep __device_init_deps_start[];
+extern const struct device_init_dep __device_init_deps_end[];
+
+#define ASYNC_COUNT (__device_init_end - __device_ASYNC_start)
+
+struct async_init {
+	struct k_work work;
+	atomic_t unmet_deps;
+};
 
-		device->init(info);
+static struct async_init async_inits[CONFIG_DEVICE_INIT_ASYNC_MAX];
+static struct k_sem async_done;
+
+/* dependencies on devices that are not in the ASYNC level are always met */
+static struct device *find_async_device(const char *name)
+{
+	struct device *info;
+
+	if (!name[0]) {
+		return NULL;
+	}
+
+	for (info = __device_ASYNC_start; info < __device_init_end; info++) {
+		if (!strcmp(name, info->config->name)) {
+			return info;
+		}
 	}
+
+	return NULL;
 }
 
+static void async_init_handler(struct k_work *work)
+{
+	struct async_init *async = CONTAINER_OF(work, struct async_init, work);
+	struct device *info = __device_ASYNC_start + (async - async_inits);
+	const struct device_init_dep *dep;
+
+	device_init(info);
+
+	/* release the devices that were only waiting for this one */
+	for (dep = __device_init_deps_start; dep < __device_init_deps_end;
+	     dep++) {
+		if (find_async_device(dep->depends_on) != info) {
+			continue;
+		}
+
+		async = &async_inits[dep->device - __device_ASYNC_start];
+		if (atomic_dec(&async->unmet_deps) == 1) {
+			k_work_submit(&async->work);
+		}
+	}
+
+	k_sem_give(&async_done);
+}
+
+/**
+ * @brief Execute the device initialization functions of the ASYNC level
+ *
+ * @details Submits the initialization of each device of the ASYNC level to
+ * the system workqueue, once all the devices it depends on are initialized,
+ * then waits for all of them to be done.
+ */
+void _sys_device_do_async_level(void)
+{
+	const struct device_init_dep *dep;
+	int count = ASYNC_COUNT;
+	int i;
+
+	if (count > CONFIG_DEVICE_INIT_ASYNC_MAX) {
+		__ASSERT(0, "too many ASYNC devices, initializing serially\n");
+		_sys_device_do_config_level(_SYS_INIT_LEVEL_ASYNC);
+		return;
+	}
+
+	k_sem_init(&async_done, 0, count);
+
+	for (i = 0; i < count; i++) {
+		k_work_init(&async_inits[i].work, async_init_handler);
+		atomic_clear(&async_inits[i].unmet_deps);
+	}
+
+	for (dep = __device_init_deps_start; dep < __device_init_deps_end;
+	     dep++) {
+		__ASSERT(dep->device >= __device_ASYNC_start &&
+			 dep->device < __device_init_end,
+			 "dependent device is not in the ASYNC level\n");
+
+		if (find_async_device(dep->depends_on)) {
+			i = dep->device - __device_ASYNC_start;
+			atomic_inc(&async_inits[i].unmet_deps);
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		if (!atomic_get(&async_inits[i].unmet_deps)) {
+			k_work_submit(&async_inits[i].work);
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		k_sem_take(&async_done, K_FOREVER);
+	}
+}
+#else
+void _sys_device_do_async_level(void)
+{
+	_sys_device_do_config_level(_SYS_INIT_LEVEL_ASYNC);
+}
+#endif /* CONFIG_DEVICE_INIT_ASYNC */
+
+#ifdef CONFIG_DEVICE_INIT_PROFILING
+static const char * const level_names[] = {
+	"PRE_KERNEL_1", "PRE_KERNEL_2", "POST_KERNEL", "APPLICATION",
+	"PRIMARY", "SECONDARY", "NANOKERNEL", "MICROKERNEL", "ASYNC",
+};
+
+void device_init_profile_print(void)
+{
+	struct device *info;
+	uint32_t total = 0;
+	int level = 0;
+
+	printk("Device init profile: %d cycles per second\n",
+	       sys_clock_hw_cycles_per_sec);
+
+	for (info = __device_init_start; info < __device_init_end; info++) {
+		while (info >= config_levels[level + 1]) {
+			level++;
+		}
+
+		printk("%s %s (%p): %u cycles, %u us\n", level_names[level],
+		       info->config->name[0] ? info->config->name : "-",
+		       info->config->init, info->init_cycles,
+		       (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(info->init_cycles)
+				  / 1000));
+
+		total += info->init_cycles;
+	}
+
+	printk("total: %u cycles, %u us\n", total,
+	       (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(total) / 1000));
+}
+#endif /* CONFIG_DEVICE_INIT_PROFILING */
+
+#ifdef CONFIG_DEVICE_LOOKUP_HASH
+#define LOOKUP_SLOTS (1 << CONFIG_DEVICE_LOOKUP_HASH_POW2)
+
+/*
+ * Open addressing table of device indexes plus one, 0 marking an empty
+ * slot, built on the first lookup. Devices are inserted in link order, so
+ * among devices of the same name, the first one is met first when probing,
+ * as with the linear scan.
+ */
+static uint16_t lookup_slots[LOOKUP_SLOTS];
+static int lookup_state;
+
+#define LOOKUP_EMPTY 0
+#define LOOKUP_READY 1
+#define LOOKUP_FULL 2
+
+/* FNV-1a, folded to the table size */
+static unsigned int lookup_hash(const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name) {
+		hash = (hash ^ (uint8_t)*name++) * 16777619u;
+	}
+
+	return (hash ^ (hash >> 16)) & (LOOKUP_SLOTS - 1);
+}
+
+static void lookup_build(void)
+{
+	int count = __device_init_end - __device_init_start;
+	unsigned int key;
+	unsigned int i;
+	int dev;
+
+	key = irq_lock();
+
+	if (lookup_state != LOOKUP_EMPTY) {
+		irq_unlock(key);
+		return;
+	}
+
+	/* Keep a free slot so that probing for a missing name terminates */
+	if (count >= LOOKUP_SLOTS) {
+		lookup_state = LOOKUP_FULL;
+		irq_unlock(key);
+		return;
+	}
+
+	for (dev = 0; dev < count; dev++) {
+		i = lookup_hash(__device_init_start[dev].config->name);
+		while (lookup_slots[i]) {
+			i = (i + 1) & (LOOKUP_SLOTS - 1);
+		}
+		lookup_slots[i] = dev + 1;
+	}
+
+	lookup_state = LOOKUP_READY;
+	irq_unlock(key);
+}
+
+static struct device *lookup_find(const char *name)
+{
+	unsigned int i = lookup_hash(name);
+	struct device *info;
+
+	for (; lookup_slots[i]; i = (i + 1) & (LOOKUP_SLOTS - 1)) {
+		info = &__device_init_start[lookup_slots[i] - 1];
+
+		if (!info->driver_api) {
+			continue;
+		}
+
+		if (info->config->name == name ||
+		    !strcmp(name, info->config->name)) {
+			return info;
+		}
+	}
+
+	return NULL;
+}
+#endif /* CONFIG_DEVICE_LOOKUP_HASH */
+
 struct device *device_get_binding(const char *name)
 {
 	struct device *info;
 
+#ifdef CONFIG_DEVICE_LOOKUP_HASH
+	if (lookup_state == LOOKUP_EMPTY) {
+		lookup_build();
+	}
+
+	if (lookup_state == LOOKUP_READY) {
+		return lookup_find(name);
+	}
+#endif
+
+	/*
+	 * Callers mostly pass the same string literal the driver registered,
+	 * so look for the pointer itself before comparing strings.
+	 */
+	for (info = __device_init_start; info != __device_init_end; info++) {
+		if (info->driver_api && info->config->name == name) {
+			return info;
+		}
+	}
+
 	for (info = __device_init_start; info != __device_init_end; info++) {
 		if (info->driver_api && !strcmp(name, info->config->name)) {
 			return info;
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Device runtime power management
+ *
+ * A device is kept active while its usage count is not zero. Getting an
+ * active device only increments the count with interrupts locked; the
+ * device mutex is only taken to resume a suspended device, or while the
+ * delayed work suspending it once unused runs on the system workqueue.
+ * An active device holds a reference on its parent, put when it suspends.
+ *
+ * The resume latency of each device is measured with the hardware cycle
+ * counter, and the worst of those of the suspended devices is kept up to
+ * date for the low power state policy.
+ */
+
+#include <kernel.h>
+#include <device.h>
+#include <misc/slist.h>
+#include <errno.h>
+
+enum {
+	DEVICE_PM_RT_ACTIVE,
+	DEVICE_PM_RT_SUSPENDING,
+	DEVICE_PM_RT_SUSPENDED,
+};
+
+static sys_slist_t pm_devices;
+static uint32_t pm_resume_latency;
+
+/* must be called with interrupts locked */
+static void resume_latency_update(void)
+{
+	struct device_pm *pm;
+	uint32_t latency = 0;
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&pm_devices, node) {
+		pm = CONTAINER_OF(node, struct device_pm, node);
+		if (pm->state == DEVICE_PM_RT_SUSPENDED &&
+		    pm->max_resume_latency_us > latency) {
+			latency = pm->max_resume_latency_us;
+		}
+	}
+
+	pm_resume_latency = latency;
+}
+
+/* must be called with the device mutex held */
+static int device_pm_resume(struct device_pm *pm)
+{
+	unsigned int key;
+	uint32_t start, us;
+	int ret;
+
+	if (pm->parent) {
+		ret = device_pm_get(pm->parent);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	start = k_cycle_get_32();
+	ret = device_set_power_state(pm->dev, DEVICE_PM_ACTIVE_STATE);
+	if (ret) {
+		if (pm->parent) {
+			device_pm_put(pm->parent);
+		}
+		return ret;
+	}
+
+	us = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start) /
+		NSEC_PER_USEC;
+
+	key = irq_lock();
+
+	pm->resume_latency_us = us;
+	if (us > pm->max_resume_latency_us) {
+		pm->max_resume_latency_us = us;
+	}
+
+	pm->state = DEVICE_PM_RT_ACTIVE;
+	resume_latency_update();
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+static void device_pm_suspend(struct k_work *work)
+{
+	struct device_pm *pm = CONTAINER_OF(work, struct device_pm, work);
+	unsigned int key;
+	int ret;
+
+	k_mutex_lock(&pm->lock, K_FOREVER);
+
+	key = irq_lock();
+	if (pm->usage || pm->state != DEVICE_PM_RT_ACTIVE) {
+		irq_unlock(key);
+		k_mutex_unlock(&pm->lock);
+		return;
+	}
+
+	/* from now on, device_pm_get() waits for the mutex */
+	pm->state = DEVICE_PM_RT_SUSPENDING;
+	irq_unlock(key);
+
+	ret = device_set_power_state(pm->dev, DEVICE_PM_SUSPEND_STATE);
+
+	key = irq_lock();
+	if (ret) {
+		pm->state = DEVICE_PM_RT_ACTIVE;
+	} else {
+		pm->state = DEVICE_PM_RT_SUSPENDED;
+		resume_latency_update();
+	}
+	irq_unlock(key);
+
+	k_mutex_unlock(&pm->lock);
+
+	if (!ret && pm->parent) {
+		device_pm_put(pm->parent);
+	}
+}
+
+void device_pm_enable(struct device *dev, struct device_pm *pm,
+		      struct device *parent, int32_t autosuspend_ms)
+{
+	unsigned int key;
+
+	pm->dev = dev;
+	pm->parent = parent;
+	pm->autosuspend_delay = autosuspend_ms;
+	pm->usage = 0;
+	pm->state = DEVICE_PM_RT_ACTIVE;
+	pm->resume_latency_us = 0;
+	pm->max_resume_latency_us = 0;
+	k_mutex_init(&pm->lock);
+	k_delayed_work_init(&pm->work, device_pm_suspend);
+
+	if (parent) {
+		device_pm_get(parent);
+	}
+
+	key = irq_lock();
+	sys_slist_append(&pm_devices, &pm->node);
+	dev->pm = pm;
+	irq_unlock(key);
+
+	if (autosuspend_ms >= 0) {
+		k_delayed_work_submit(&pm->work, autosuspend_ms);
+	}
+}
+
+int device_pm_get(struct device *dev)
+{
+	struct device_pm *pm = dev->pm;
+	unsigned int key;
+	int ret = 0;
+
+	if (!pm) {
+		return 0;
+	}
+
+	key = irq_lock();
+	pm->usage++;
+	if (pm->state == DEVICE_PM_RT_ACTIVE) {
+		irq_unlock(key);
+		return 0;
+	}
+	irq_unlock(key);
+
+	k_mutex_lock(&pm->lock, K_FOREVER);
+	if (pm->state == DEVICE_PM_RT_SUSPENDED) {
+		ret = device_pm_resume(pm);
+	}
+	k_mutex_unlock(&pm->lock);
+
+	if (ret) {
+		key = irq_lock();
+		pm->usage--;
+		irq_unlock(key);
+	}
+
+	return ret;
+}
+
+int device_pm_put(struct device *dev)
+{
+	struct device_pm *pm = dev->pm;
+	unsigned int key;
+
+	if (!pm) {
+		return 0;
+	}
+
+	key = irq_lock();
+
+	if (!pm->usage) {
+		irq_unlock(key);
+		return -EINVAL;
+	}
+
+	if (--pm->usage == 0 && pm->autosuspend_delay >= 0) {
+		/*
+		 * Resubmitting restarts the delay, unless the suspend work is
+		 * already queued: it then finds the device unused anyway.
+		 */
+		k_delayed_work_submit(&pm->work, pm->autosuspend_delay);
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+uint32_t device_pm_resume_latency_get(void)
+{
+	return pm_resume_latency;
+}
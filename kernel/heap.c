@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief Heap memory pool, used by k_malloc() and k_free().
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <string.h>
+
+/*
+ * Heap memory pool support
+ */
+
+#if (CONFIG_HEAP_MEM_POOL_SIZE > 0)
+
+/*
+ * Case 1: Heap is defined using HEAP_MEM_POOL_SIZE configuration option.
+ *
+ * This module defines the heap memory pool and the _HEAP_MEM_POOL symbol
+ * that has the address of the associated memory pool struct.
+ */
+
+K_MEM_POOL_DEFINE(_heap_mem_pool, 64, CONFIG_HEAP_MEM_POOL_SIZE, 1, 4);
+#define _HEAP_MEM_POOL (&_heap_mem_pool)
+
+#else
+
+/*
+ * Case 2: Heap is defined using HEAP_SIZE item type in MDEF.
+ *
+ * Sysgen defines the heap memory pool and the _heap_mem_pool_ptr variable
+ * that has the address of the associated memory pool struct. This module
+ * defines the _HEAP_MEM_POOL symbol as an alias for _heap_mem_pool_ptr.
+ *
+ * Note: If the MDEF does not define the heap memory pool k_malloc() will
+ * compile successfully, but will trigger a link error if it is used.
+ */
+
+extern struct k_mem_pool * const _heap_mem_pool_ptr;
+#define _HEAP_MEM_POOL _heap_mem_pool_ptr
+
+#endif /* CONFIG_HEAP_MEM_POOL_SIZE */
+
+
+void *k_mem_pool_malloc(struct k_mem_pool *pool, size_t size)
+{
+	struct k_mem_block block;
+
+	/*
+	 * get a block large enough to hold an initial (hidden) block
+	 * descriptor, as well as the space the caller requested
+	 */
+	size += sizeof(struct k_mem_block);
+	if (k_mem_pool_alloc(pool, &block, size, K_NO_WAIT) != 0) {
+		return NULL;
+	}
+
+	/* save the block descriptor info at the start of the actual block */
+	memcpy(block.data, &block, sizeof(struct k_mem_block));
+
+	/* return address of the user area part of the block to the caller */
+	return (char *)block.data + sizeof(struct k_mem_block);
+}
+
+
+void *k_malloc(size_t size)
+{
+#ifdef CONFIG_HEAP_ARENAS
+	/* ISRs have no arena, they share the heap memory pool */
+	if (!_is_in_isr() && _current->heap_arena) {
+		return k_mem_pool_malloc(_current->heap_arena, size);
+	}
+#endif
+
+	return k_mem_pool_malloc(_HEAP_MEM_POOL, size);
+}
+
+
+void k_free(void *ptr)
+{
+	if (ptr != NULL) {
+		/* point to hidden block descriptor at start of block */
+		ptr = (char *)ptr - sizeof(struct k_mem_block);
+
+		/* return block to the heap memory pool */
+		k_mem_pool_free(ptr);
+	}
+}
+
+#ifdef CONFIG_HEAP_ARENAS
+void k_thread_heap_arena_set(k_tid_t thread, struct k_mem_pool *pool)
+{
+	thread->heap_arena = pool;
+}
+
+struct k_mem_pool *k_thread_heap_arena_get(k_tid_t thread)
+{
+	return thread->heap_arena;
+}
+#endif /* CONFIG_HEAP_ARENAS */
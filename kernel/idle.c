@@ -11,6 +11,7 @@
 #include <drivers/system_timer.h>
 #include <wait_q.h>
 #include <power.h>
+#include <nano_internal.h>
 
 #if defined(CONFIG_TICKLESS_IDLE)
 /*
@@ -56,7 +57,7 @@ static void set_kernel_idle_time_in_ticks(int32_t ticks)
 
 static void _sys_power_save_idle(int32_t ticks __unused)
 {
-#if defined(CONFIG_TICKLESS_IDLE)
+#if defined(CONFIG_TICKLESS_IDLE) && !defined(CONFIG_TICKLESS_KERNEL)
 	if ((ticks == K_FOREVER) || ticks >= _sys_idle_threshold_ticks) {
 		/*
 		 * Stop generating system timer interrupts until it's time for
@@ -68,6 +69,7 @@ static void _sys_power_save_idle(int32_t ticks __unused)
 #endif /* CONFIG_TICKLESS_IDLE */
 
 	set_kernel_idle_time_in_ticks(ticks);
+	_sys_pm_idle_enter();
 #if (defined(CONFIG_SYS_POWER_LOW_POWER_STATE) || \
 	defined(CONFIG_SYS_POWER_DEEP_SLEEP))
 
@@ -97,6 +99,8 @@ static void _sys_power_save_idle(int32_t ticks __unused)
 
 void _sys_power_save_idle_exit(int32_t ticks)
 {
+	_sys_pm_idle_exit();
+
 #if defined(CONFIG_SYS_POWER_LOW_POWER_STATE)
 	/* Some CPU low power states require notification at the ISR
 	 * to allow any operations that needs to be done before kernel
@@ -108,7 +112,7 @@ void _sys_power_save_idle_exit(int32_t ticks)
 		_sys_soc_resume();
 	}
 #endif
-#ifdef CONFIG_TICKLESS_IDLE
+#if defined(CONFIG_TICKLESS_IDLE) && !defined(CONFIG_TICKLESS_KERNEL)
 	if ((ticks == K_FOREVER) || ticks >= _sys_idle_threshold_ticks) {
 		/* Resume normal periodic system timer interrupts */
 
@@ -12,6 +12,10 @@
 #if !defined(_ASMLANGUAGE)
 #include <atomic.h>
 #include <misc/dlist.h>
+
+#ifdef CONFIG_PERF_COUNTER_THREAD
+#include <perf_counter.h>
+#endif
 #endif
 
 /*
@@ -39,6 +43,9 @@
 /* Thread is suspended */
 #define _THREAD_SUSPENDED (1 << 4)
 
+/* Thread is actively looking at events to see if they are ready */
+#define _THREAD_POLLING (1 << 5)
+
 /* end - states */
 
 
@@ -103,15 +110,62 @@ struct _thread_base {
 	/* data returned by APIs */
 	void *swap_data;
 
+	/* mutex this thread is waiting on, to follow priority inheritance */
+	struct k_mutex *pended_on_mutex;
+
+#ifdef CONFIG_WAIT_Q_PRIO_RUNS
+	/*
+	 * Run of equal priority threads this one is part of in its wait
+	 * queue: the first thread of a run points to the last one and back,
+	 * other threads leave it stale. The priority is the one the thread
+	 * was queued with, since it can change while waiting.
+	 */
+	struct _thread_base *wait_q_run;
+	int8_t wait_q_prio;
+	uint8_t wait_q_flags;
+#endif
+
+#ifdef CONFIG_SCHED_DEADLINE
+	/* absolute deadline, in hw cycles, only valid if has_deadline is set */
+	uint32_t prio_deadline;
+	uint8_t has_deadline;
+#endif
+
 #ifdef CONFIG_SYS_CLOCK_EXISTS
 	/* this thread's entry in a timeout queue */
 	struct _timeout timeout;
 #endif
 
+#ifdef CONFIG_TIMESLICING
+	/* time slice size (in ms), 0 to use the global one */
+	int32_t time_slice;
+#endif
+
 };
 
 typedef struct _thread_base _thread_base_t;
 
+#ifdef CONFIG_THREAD_STATS
+struct _thread_stats {
+
+	/* hardware cycles spent running, up to the last switch out */
+	uint64_t cycles;
+
+	/* hardware cycle count when the thread was last switched in */
+	uint32_t switched_in;
+
+	/* number of times switched out, and how many were preemptions */
+	uint32_t num_switches;
+	uint32_t num_preemptions;
+
+	/* size of the stack area, including the thread structure */
+	uint32_t stack_size;
+
+	/* set by k_yield(): the next switch out is voluntary */
+	uint8_t yielding;
+};
+#endif
+
 struct k_thread {
 
 	struct _thread_base base;
@@ -144,6 +198,26 @@ struct k_thread {
 	int errno_var;
 #endif
 
+#ifdef CONFIG_THREAD_POOL
+	/* pool the stack goes back to on exit, if any */
+	struct k_thread_pool *pool;
+#endif
+
+#ifdef CONFIG_HEAP_ARENAS
+	/* memory pool k_malloc() draws from, if not the heap memory pool */
+	struct k_mem_pool *heap_arena;
+#endif
+
+#ifdef CONFIG_THREAD_STATS
+	/* runtime statistics */
+	struct _thread_stats stats;
+#endif
+
+#ifdef CONFIG_PERF_COUNTER_THREAD
+	/* hardware event counts while running, indexed by enum perf_event */
+	uint64_t perf_counts[PERF_EVENT_COUNT];
+#endif
+
 	/* arch-specifics: must always be at the end */
 	struct _thread_arch arch;
 };
@@ -155,6 +229,11 @@ struct _ready_q {
 	/* always contains next thread to run: cannot be NULL */
 	struct k_thread *cache;
 
+#if (K_NUM_PRIO_BITMAPS > 1)
+	/* bitmap of prio_bmap entries that contain at least one bit set */
+	uint32_t prio_bmap_summary;
+#endif
+
 	/* bitmap of priorities that contain at least one ready thread */
 	uint32_t prio_bmap[K_NUM_PRIO_BITMAPS];
 
@@ -164,6 +243,35 @@ struct _ready_q {
 
 typedef struct _ready_q _ready_q_t;
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+
+#define _TIMEOUT_WHEEL_BITS 5
+#define _TIMEOUT_WHEEL_SLOTS (1 << _TIMEOUT_WHEEL_BITS)
+#define _TIMEOUT_WHEEL_MASK (_TIMEOUT_WHEEL_SLOTS - 1)
+
+struct _timeout_wheel {
+
+	/* current time, in ticks, as seen by the wheel */
+	uint32_t now;
+
+	/* number of timeouts queued on the wheel */
+	uint32_t num_active;
+
+	/*
+	 * bitmaps of slots that may contain timeouts, one per level; a bit is
+	 * not cleared when the last timeout of a slot is aborted, only when
+	 * an empty slot is found when looking up the next expiry
+	 */
+	uint32_t bmap[CONFIG_TIMEOUT_WHEEL_LEVELS];
+
+	/* the wheel levels, each level covering 32 times the one below */
+	sys_dlist_t slots[CONFIG_TIMEOUT_WHEEL_LEVELS][_TIMEOUT_WHEEL_SLOTS];
+};
+
+extern struct _timeout_wheel _timeout_wheel;
+
+#endif /* CONFIG_TIMEOUT_WHEEL */
+
 struct _kernel {
 
 	/* nested interrupt count */
@@ -175,7 +283,7 @@ struct _kernel {
 	/* currently scheduled thread */
 	struct k_thread *current;
 
-#ifdef CONFIG_SYS_CLOCK_EXISTS
+#if defined(CONFIG_SYS_CLOCK_EXISTS) && !defined(CONFIG_TIMEOUT_WHEEL)
 	/* queue of timeouts */
 	sys_dlist_t timeout_q;
 #endif
@@ -236,6 +344,12 @@ extern void _init_thread_base(struct _thread_base *thread_base,
 			      int priority, uint32_t initial_state,
 			      unsigned int options);
 
+#ifdef CONFIG_POLL
+#define _INIT_OBJ_POLL_EVENT(obj) do { (obj)->poll_event = NULL; } while ((0))
+#else
+#define _INIT_OBJ_POLL_EVENT(obj) do { } while ((0))
+#endif
+
 #endif /* _ASMLANGUAGE */
 
 #endif /* _kernel_structs__h_ */
@@ -19,12 +19,20 @@ extern void k_sched_unlock(void);
 extern void _pend_thread(struct k_thread *thread,
 			 _wait_q_t *wait_q, int32_t timeout);
 extern void _pend_current_thread(_wait_q_t *wait_q, int32_t timeout);
+extern void _wait_q_insert(_wait_q_t *wait_q, struct k_thread *thread);
 extern void _move_thread_to_end_of_prio_q(struct k_thread *thread);
 extern int __must_switch_threads(void);
 #ifdef _NON_OPTIMIZED_TICKS_PER_SEC
 extern int32_t _ms_to_ticks(int32_t ms);
 #endif
 extern void idle(void *, void *, void *);
+extern int _k_queue_append_locked(struct k_queue *queue, void *data);
+#ifdef CONFIG_COROUTINES
+extern int _coro_wake(struct k_coro *coro);
+extern int _coro_poll_register(struct k_poll_event *event,
+			       struct _poller *poller);
+extern void _coro_poll_unregister(struct k_poll_event *event);
+#endif
 
 /* find which one is the next thread to run */
 /* must be called with interrupts locked */
@@ -107,9 +115,32 @@ static inline int _is_prio_lower(int prio1, int prio2)
 	return _is_prio1_lower_than_prio2(prio1, prio2);
 }
 
+#ifdef CONFIG_SCHED_DEADLINE
+/* threads without a deadline are considered to have the latest one */
+static inline int _is_t1_deadline_earlier_than_t2(struct k_thread *t1,
+						  struct k_thread *t2)
+{
+	if (!t1->base.has_deadline) {
+		return 0;
+	}
+
+	if (!t2->base.has_deadline) {
+		return 1;
+	}
+
+	return (int32_t)(t1->base.prio_deadline - t2->base.prio_deadline) < 0;
+}
+#endif
+
 static inline int _is_t1_higher_prio_than_t2(struct k_thread *t1,
 					     struct k_thread *t2)
 {
+#ifdef CONFIG_SCHED_DEADLINE
+	if (t1->base.prio == t2->base.prio) {
+		return _is_t1_deadline_earlier_than_t2(t1, t2);
+	}
+#endif
+
 	return _is_prio1_higher_than_prio2(t1->base.prio, t2->base.prio);
 }
 
@@ -186,26 +217,25 @@ static inline int _get_ready_q_q_index(int prio)
 	return prio + _NUM_COOP_PRIO;
 }
 
-/* find out the currently highest priority where a thread is ready to run */
-/* interrupts must be locked */
+/*
+ * Find out the currently highest priority where a thread is ready to run.
+ *
+ * This is O(1): find_lsb_set() maps to the architecture's bit-scan
+ * instruction, and when there are more than 32 priorities, a summary word
+ * tracking the non-empty bitmaps is scanned first instead of looping on them.
+ *
+ * Interrupts must be locked.
+ */
 static inline int _get_highest_ready_prio(void)
 {
-	int bitmap = 0;
-	uint32_t ready_range;
+#if (K_NUM_PRIO_BITMAPS > 1)
+	__ASSERT(_ready_q.prio_bmap_summary, "no ready thread\n");
 
-#if (K_NUM_PRIORITIES <= 32)
-	ready_range = _ready_q.prio_bmap[0];
+	int bitmap = find_lsb_set(_ready_q.prio_bmap_summary) - 1;
 #else
-	for (;; bitmap++) {
-
-		__ASSERT(bitmap < K_NUM_PRIO_BITMAPS, "prio out-of-range\n");
-
-		if (_ready_q.prio_bmap[bitmap]) {
-			ready_range = _ready_q.prio_bmap[bitmap];
-			break;
-		}
-	}
+	int bitmap = 0;
 #endif
+	uint32_t ready_range = _ready_q.prio_bmap[bitmap];
 
 	int abs_prio = (find_lsb_set(ready_range) - 1) + (bitmap << 5);
 
@@ -405,6 +435,44 @@ static inline void _thread_priority_set(struct k_thread *thread, int prio)
 	}
 }
 
+#ifdef CONFIG_WAIT_Q_PRIO_RUNS
+#define _WAIT_Q_RUN_FIRST (1 << 0)
+#define _WAIT_Q_RUN_LAST (1 << 1)
+#endif
+
+/* remove a thread from the wait queue it is on */
+/* must be called with interrupts locked */
+static inline void _wait_q_remove(struct k_thread *thread)
+{
+#ifdef CONFIG_WAIT_Q_PRIO_RUNS
+	struct _thread_base *base = &thread->base;
+	struct _thread_base *other = base->wait_q_run;
+	struct _thread_base *neighbor;
+
+	/* hand the end of the run over to the thread next to it */
+	switch (base->wait_q_flags) {
+	case _WAIT_Q_RUN_FIRST:
+		neighbor = (struct _thread_base *)base->k_q_node.next;
+		neighbor->wait_q_flags |= _WAIT_Q_RUN_FIRST;
+		break;
+	case _WAIT_Q_RUN_LAST:
+		neighbor = (struct _thread_base *)base->k_q_node.prev;
+		neighbor->wait_q_flags |= _WAIT_Q_RUN_LAST;
+		break;
+	default:
+		neighbor = NULL;
+		break;
+	}
+
+	if (neighbor) {
+		neighbor->wait_q_run = other;
+		other->wait_q_run = neighbor;
+	}
+#endif
+
+	sys_dlist_remove(&thread->base.k_q_node);
+}
+
 /* check if thread is a thread pending on a particular wait queue */
 static inline struct k_thread *_peek_first_pending_thread(_wait_q_t *wait_q)
 {
@@ -428,14 +496,20 @@ static inline struct k_thread *_get_thread_to_unpend(_wait_q_t *wait_q)
 				continue;
 			}
 
-			sys_dlist_remove(cur);
+			_wait_q_remove(thread);
 			return thread;
 		}
 		return NULL;
 	}
 #endif
 
-	return (struct k_thread *)sys_dlist_get(wait_q);
+	struct k_thread *thread = _peek_first_pending_thread(wait_q);
+
+	if (thread) {
+		_wait_q_remove(thread);
+	}
+
+	return thread;
 }
 
 /* unpend the first thread from a wait queue */
@@ -457,7 +531,7 @@ static inline void _unpend_thread(struct k_thread *thread)
 {
 	__ASSERT(thread->base.thread_state & _THREAD_PENDING, "");
 
-	sys_dlist_remove(&thread->base.k_q_node);
+	_wait_q_remove(thread);
 	_mark_thread_as_not_pending(thread);
 }
 
@@ -36,6 +36,14 @@ static inline void _data_copy(void)
 	/* Do nothing */
 }
 #endif
+#if defined(CONFIG_XIP) && defined(CONFIG_ARCH_HAS_RAMFUNC)
+void _ramfunc_copy(void);
+#else
+static inline void _ramfunc_copy(void)
+{
+	/* Do nothing */
+}
+#endif
 FUNC_NORETURN void _Cstart(void);
 
 /* helper type alias for thread control structure */
@@ -69,6 +77,58 @@ extern void _thread_monitor_exit(struct k_thread *thread);
 	} while (0)
 #endif /* CONFIG_THREAD_MONITOR */
 
+/* reset runtime statistics of a new thread */
+
+#if defined(CONFIG_THREAD_STATS)
+extern void _thread_stats_init(struct k_thread *thread, size_t stack_size);
+#else
+#define _thread_stats_init(thread, stack_size) \
+	do {/* nothing */    \
+	} while (0)
+#endif /* CONFIG_THREAD_STATS */
+
+/* account an interrupt, called by the interrupt entry code */
+
+#if defined(CONFIG_IRQ_STATS)
+extern uint32_t _irq_stats_timestamp(void);
+extern void _irq_stats_record(unsigned int irq, void *isr, uint32_t entered,
+			      uint32_t start, uint32_t end);
+#endif /* CONFIG_IRQ_STATS */
+
+/* hardware performance counters, implemented by the architecture */
+
+#if defined(CONFIG_PERF_COUNTER)
+#include <perf_counter.h>
+
+extern uint32_t _arch_perf_counter_events(void);
+extern int _arch_perf_counter_start(uint32_t events);
+extern void _arch_perf_counter_stop(void);
+
+/* raw count of a started event, and mask of the counter width */
+extern uint32_t _arch_perf_counter_read(enum perf_event event);
+extern uint32_t _arch_perf_counter_mask(enum perf_event event);
+#endif /* CONFIG_PERF_COUNTER */
+
+/* save the event counts of the outgoing thread, called on context switch */
+
+#if defined(CONFIG_PERF_COUNTER_THREAD)
+extern void _perf_counter_switch(void);
+#endif /* CONFIG_PERF_COUNTER_THREAD */
+
+/* measure idle periods for the low power state policy */
+
+#if defined(CONFIG_SYS_POWER_STATE_PREDICT)
+extern void _sys_pm_idle_enter(void);
+extern void _sys_pm_idle_exit(void);
+#else
+#define _sys_pm_idle_enter() \
+	do {/* nothing */    \
+	} while (0)
+#define _sys_pm_idle_exit() \
+	do {/* nothing */    \
+	} while (0)
+#endif /* CONFIG_SYS_POWER_STATE_PREDICT */
+
 #ifdef __cplusplus
 }
 #endif
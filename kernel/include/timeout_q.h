@@ -15,11 +15,28 @@
  */
 
 #include <misc/dlist.h>
+#ifdef CONFIG_TICKLESS_KERNEL
+#include <drivers/system_timer.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+extern void _timeout_wheel_init(void);
+extern void _timeout_wheel_add(struct _timeout *timeout,
+			       int32_t timeout_in_ticks);
+extern int _timeout_wheel_abort(struct _timeout *timeout);
+extern int32_t _timeout_wheel_remaining(struct _timeout *timeout);
+extern int32_t _timeout_wheel_next_expiry(void);
+extern void _timeout_wheel_announce(int32_t ticks, sys_dlist_t *expired);
+#endif
+
+#ifdef CONFIG_TICKLESS_KERNEL
+extern void _sys_clock_set_next_event(int32_t ticks);
+#endif
+
 /* initialize the timeouts part of k_thread when enabled in the kernel */
 
 static inline void _init_timeout(struct _timeout *t, _timeout_func_t func)
@@ -48,6 +65,10 @@ static inline void _init_timeout(struct _timeout *t, _timeout_func_t func)
 	 */
 	t->func = func;
 
+#ifdef CONFIG_TIMEOUT_SLACK
+	t->slack = 0;
+#endif
+
 	/*
 	 * These are initialized when enqueing on the timeout queue:
 	 *
@@ -118,6 +139,9 @@ static inline void _handle_expired_timeouts(sys_dlist_t *expired)
 /* returns _INACTIVE if the timer is not active */
 static inline int _abort_timeout(struct _timeout *timeout)
 {
+#ifdef CONFIG_TIMEOUT_WHEEL
+	return _timeout_wheel_abort(timeout);
+#else
 	if (timeout->delta_ticks_from_prev == _INACTIVE) {
 		return _INACTIVE;
 	}
@@ -133,6 +157,7 @@ static inline int _abort_timeout(struct _timeout *timeout)
 	timeout->delta_ticks_from_prev = _INACTIVE;
 
 	return 0;
+#endif
 }
 
 /* returns _INACTIVE if the timer has already expired */
@@ -159,7 +184,7 @@ static inline void _dump_timeout(struct _timeout *timeout, int extra_tab)
 
 static inline void _dump_timeout_q(void)
 {
-#ifdef CONFIG_KERNEL_DEBUG
+#if defined(CONFIG_KERNEL_DEBUG) && !defined(CONFIG_TIMEOUT_WHEEL)
 	sys_dnode_t *node;
 
 	K_DEBUG("_timeout_q: %p, head: %p, tail: %p\n",
@@ -171,6 +196,58 @@ static inline void _dump_timeout_q(void)
 #endif
 }
 
+#ifdef CONFIG_TIMEOUT_SLACK
+static inline void _timeout_slack_set(struct _timeout *t, int32_t slack_ms)
+{
+	/* rounded down, the slack being a tolerance */
+	t->slack = (int32_t)((int64_t)slack_ms * sys_clock_ticks_per_sec /
+			     MSEC_PER_SEC);
+}
+
+/*
+ * Expiry, in ticks from the last announced tick, of a timeout due in
+ * 'ticks' that may expire up to 'slack' ticks late: the first expiry
+ * already queued in that window if any, so that both are handled by the
+ * same timer event, else the tick of the window that is a multiple of the
+ * largest power of two, where other timeouts with slack gather.
+ */
+static inline int32_t _timeout_slack_apply(int32_t ticks, int32_t slack)
+{
+	uint32_t first, last, aligned;
+
+#ifndef CONFIG_TIMEOUT_WHEEL
+	int32_t expiry = 0;
+	sys_dnode_t *node;
+
+	SYS_DLIST_FOR_EACH_NODE(&_timeout_q, node) {
+		expiry += ((struct _timeout *)node)->delta_ticks_from_prev;
+
+		if (expiry >= ticks) {
+			if (expiry - ticks <= slack) {
+				return expiry;
+			}
+			break;
+		}
+	}
+#endif
+
+	first = (uint32_t)_sys_clock_tick_count + ticks;
+	last = first + slack;
+
+	/* clear the lowest set bits of 'last' while staying in the window */
+	for (aligned = last; aligned & (aligned - 1); ) {
+		uint32_t next = aligned & (aligned - 1);
+
+		if ((int32_t)(next - first) < 0) {
+			break;
+		}
+		aligned = next;
+	}
+
+	return ticks + (int32_t)(aligned - first);
+}
+#endif /* CONFIG_TIMEOUT_SLACK */
+
 /*
  * Add timeout to timeout queue. Record waiting thread and wait queue if any.
  *
@@ -186,10 +263,28 @@ static inline void _add_timeout(struct k_thread *thread,
 {
 	__ASSERT(timeout_in_ticks > 0, "");
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	/*
+	 * The queue is relative to the last announced tick, which may be
+	 * a number of ticks in the past since there is no periodic tick.
+	 */
+	timeout_in_ticks += _get_elapsed_program_time();
+#endif
+
+#ifdef CONFIG_TIMEOUT_SLACK
+	if (timeout->slack > 0) {
+		timeout_in_ticks = _timeout_slack_apply(timeout_in_ticks,
+							timeout->slack);
+	}
+#endif
+
 	timeout->delta_ticks_from_prev = timeout_in_ticks;
 	timeout->thread = thread;
 	timeout->wait_q = (sys_dlist_t *)wait_q;
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+	_timeout_wheel_add(timeout, timeout_in_ticks);
+#else
 	K_DEBUG("before adding timeout %p\n", timeout);
 	_dump_timeout(timeout, 0);
 	_dump_timeout_q();
@@ -216,6 +311,11 @@ inserted:
 	K_DEBUG("after adding timeout %p\n", timeout);
 	_dump_timeout(timeout, 0);
 	_dump_timeout_q();
+#endif
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	_sys_clock_set_next_event(timeout_in_ticks);
+#endif
 }
 
 /*
@@ -237,10 +337,14 @@ static inline void _add_thread_timeout(struct k_thread *thread,
 
 static inline int32_t _get_next_timeout_expiry(void)
 {
+#ifdef CONFIG_TIMEOUT_WHEEL
+	return _timeout_wheel_next_expiry();
+#else
 	struct _timeout *t = (struct _timeout *)
 			     sys_dlist_peek_head(&_timeout_q);
 
 	return t ? t->delta_ticks_from_prev : K_FOREVER;
+#endif
 }
 
 #ifdef __cplusplus
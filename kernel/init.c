@@ -96,9 +96,18 @@ k_tid_t const _idle_thread = (k_tid_t)_idle_stack;
 #if CONFIG_ISR_STACK_SIZE & (STACK_ALIGN - 1)
     #error "ISR_STACK_SIZE must be a multiple of the stack alignment"
 #endif
+#if defined(CONFIG_CCM_ISR_STACK)
+char __ccm_noinit_section __stack _interrupt_stack[CONFIG_ISR_STACK_SIZE];
+#else
 char __noinit __stack _interrupt_stack[CONFIG_ISR_STACK_SIZE];
+#endif
 
-#ifdef CONFIG_SYS_CLOCK_EXISTS
+#if defined(CONFIG_TIMEOUT_WHEEL)
+	#include <wait_q.h>
+	#define initialize_timeouts() do { \
+		_timeout_wheel_init(); \
+	} while ((0))
+#elif defined(CONFIG_SYS_CLOCK_EXISTS)
 	#include <misc/dlist.h>
 	#define initialize_timeouts() do { \
 		sys_dlist_init(&_timeout_q); \
@@ -112,7 +121,8 @@ extern void idle(void *unused1, void *unused2, void *unused3);
 void k_call_stacks_analyze(void)
 {
 #if defined(CONFIG_INIT_STACKS) && defined(CONFIG_PRINTK)
-	extern char sys_work_q_stack[CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE];
+	extern char sys_work_q_stack[CONFIG_SYSTEM_WORKQUEUE_THREADS]
+				    [CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE];
 #if defined(CONFIG_ARC)
 	extern char _firq_stack[CONFIG_FIRQ_STACK_SIZE];
 #endif /* CONFIG_ARC */
@@ -125,8 +135,10 @@ void k_call_stacks_analyze(void)
 #endif /* CONFIG_ARC */
 	stack_analyze("interrupt", _interrupt_stack,
 		      sizeof(_interrupt_stack));
-	stack_analyze("workqueue", sys_work_q_stack,
-		      sizeof(sys_work_q_stack));
+	for (int i = 0; i < CONFIG_SYSTEM_WORKQUEUE_THREADS; i++) {
+		stack_analyze("workqueue", sys_work_q_stack[i],
+			      sizeof(sys_work_q_stack[i]));
+	}
 
 #endif /* CONFIG_INIT_STACKS && CONFIG_PRINTK */
 }
@@ -135,7 +147,8 @@ void k_call_stacks_analyze(void)
  *
  * @brief Clear BSS
  *
- * This routine clears the BSS region, so all bytes are 0.
+ * This routine clears the BSS region, and the one of the core coupled
+ * memory if any, so all bytes are 0.
  *
  * @return N/A
  */
@@ -143,22 +156,122 @@ void _bss_zero(void)
 {
 	memset(&__bss_start, 0,
 		 ((uint32_t) &__bss_end - (uint32_t) &__bss_start));
+#ifdef CONFIG_HAS_CCM
+	memset(&__ccm_bss_start, 0,
+		 ((uint32_t) &__ccm_bss_end - (uint32_t) &__ccm_bss_start));
+#endif
 }
 
 
 #ifdef CONFIG_XIP
+#ifdef CONFIG_XIP_DATA_COMPRESSED
+/**
+ *
+ * @brief Decompress the data image from ROM to RAM
+ *
+ * The image is compressed in the LZ4 block format by
+ * scripts/gen_data_lz4.py: each sequence has literals, copied as they are,
+ * then a match copied from the data already decompressed, except the last
+ * one which has literals only.
+ *
+ * @return N/A
+ */
+static void _data_lz4_decompress(uint8_t *dst, uint8_t *end,
+				 const uint8_t *src)
+{
+	const uint8_t *match;
+	uint8_t token;
+	size_t len;
+
+	while (dst < end) {
+		token = *src++;
+
+		len = token >> 4;
+		if (len == 15) {
+			do {
+				len += *src;
+			} while (*src++ == 255);
+		}
+
+		memcpy(dst, src, len);
+		dst += len;
+		src += len;
+
+		if (dst >= end) {
+			break;
+		}
+
+		match = dst - (src[0] | (src[1] << 8));
+		src += 2;
+
+		len = (token & 0xf) + 4;
+		if (len == 19) {
+			do {
+				len += *src;
+			} while (*src++ == 255);
+		}
+
+		/* A match closer than its length repeats bytes it copies */
+		if ((size_t)(dst - match) >= len) {
+			memcpy(dst, match, len);
+			dst += len;
+		} else {
+			while (len--) {
+				*dst++ = *match++;
+			}
+		}
+	}
+}
+#endif
+
 /**
  *
  * @brief Copy the data section from ROM to RAM
  *
- * This routine copies the data section from ROM to RAM.
+ * This routine copies the data section from ROM to RAM, decompressing it
+ * with CONFIG_XIP_DATA_COMPRESSED, and the one of the core coupled memory
+ * if any.
  *
  * @return N/A
  */
 void _data_copy(void)
 {
+#ifdef CONFIG_XIP_DATA_COMPRESSED
+	_data_lz4_decompress((uint8_t *)__data_ram_start,
+			     (uint8_t *)__data_ram_end,
+			     (const uint8_t *)__data_rom_start);
+#else
 	memcpy(&__data_ram_start, &__data_rom_start,
 		 ((uint32_t) &__data_ram_end - (uint32_t) &__data_ram_start));
+#endif
+#ifdef CONFIG_HAS_CCM
+	memcpy(&__ccm_data_ram_start, &__ccm_data_rom_start,
+		 ((uint32_t) &__ccm_data_ram_end -
+		  (uint32_t) &__ccm_data_ram_start));
+#endif
+}
+#endif
+
+#if defined(CONFIG_XIP) && defined(CONFIG_ARCH_HAS_RAMFUNC)
+/**
+ *
+ * @brief Copy the RAM functions from ROM to RAM
+ *
+ * This routine copies the __ramfunc code from ROM to RAM. It runs before
+ * _bss_zero() and _data_copy(), and with CONFIG_RAMFUNC_MEMCPY memcpy()
+ * and memset() are among the functions copied, so it copies word per word
+ * itself.
+ *
+ * @return N/A
+ */
+void _ramfunc_copy(void)
+{
+	volatile uint32_t *dst = (uint32_t *)_ramfunc_ram_start;
+	const uint32_t *src = (const uint32_t *)_ramfunc_rom_start;
+
+	while (dst < (uint32_t *)_ramfunc_ram_end) {
+		*dst++ = *src++;
+	}
 }
 #endif
 
@@ -187,6 +300,9 @@ static void _main(void *unused1, void *unused2, void *unused3)
 	/* Final init level before app starts */
 	_sys_device_do_config_level(_SYS_INIT_LEVEL_APPLICATION);
 
+	/* Devices that can be initialized concurrently */
+	_sys_device_do_async_level();
+
 #ifdef CONFIG_CPLUSPLUS
 	/* Process the .ctors and .init_array sections */
 	extern void __do_global_ctors_aux(void);
@@ -287,6 +403,7 @@ static void prepare_multithreading(struct k_thread *dummy_thread)
 	_new_thread(_main_stack, MAIN_STACK_SIZE,
 		    _main, NULL, NULL, NULL,
 		    CONFIG_MAIN_THREAD_PRIORITY, K_ESSENTIAL);
+	_thread_stats_init(_main_thread, MAIN_STACK_SIZE);
 	_mark_thread_as_started(_main_thread);
 	_add_thread_to_ready_q(_main_thread);
 
@@ -294,6 +411,7 @@ static void prepare_multithreading(struct k_thread *dummy_thread)
 	_new_thread(_idle_stack, IDLE_STACK_SIZE,
 		    idle, NULL, NULL, NULL,
 		    K_LOWEST_THREAD_PRIO, K_ESSENTIAL);
+	_thread_stats_init(_idle_thread, IDLE_STACK_SIZE);
 	_mark_thread_as_started(_idle_thread);
 	_add_thread_to_ready_q(_idle_thread);
 #endif
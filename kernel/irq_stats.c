@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief interrupt latency and duration statistics
+ *
+ * The interrupt entry code of the architecture takes a timestamp as early
+ * as it can, then has the ISR called through _irq_stats_isr() or an
+ * architecture specific equivalent, which accounts the latency and the
+ * duration of the ISR with _irq_stats_record().
+ */
+
+#include <kernel.h>
+#include <irq.h>
+#include <nano_internal.h>
+#include <string.h>
+#include <errno.h>
+
+static struct k_irq_stats irq_stats[CONFIG_IRQ_STATS_SLOTS];
+
+uint32_t _irq_stats_timestamp(void)
+{
+	return k_cycle_get_32();
+}
+
+static inline unsigned int irq_stats_bucket(uint32_t cycles)
+{
+	unsigned int bucket;
+
+	if (!cycles) {
+		return 0;
+	}
+
+	bucket = 32 - __builtin_clz(cycles);
+
+	return min(bucket, K_IRQ_STATS_BUCKETS - 1);
+}
+
+void _irq_stats_record(unsigned int irq, void *isr, uint32_t entered,
+		       uint32_t start, uint32_t end)
+{
+	struct k_irq_stats *stats = NULL;
+	uint32_t latency = start - entered;
+	uint32_t duration = end - start;
+	unsigned int key;
+	int i;
+
+	/* nested interrupts account too */
+	key = irq_lock();
+
+	for (i = 0; i < CONFIG_IRQ_STATS_SLOTS; i++) {
+		if (!irq_stats[i].isr) {
+			irq_stats[i].irq = irq;
+			irq_stats[i].isr = isr;
+		}
+
+		if (irq_stats[i].irq == irq && irq_stats[i].isr == isr) {
+			stats = &irq_stats[i];
+			break;
+		}
+	}
+
+	if (stats) {
+		stats->count++;
+		stats->max_latency = max(stats->max_latency, latency);
+		stats->max_duration = max(stats->max_duration, duration);
+		stats->total_duration += duration;
+		stats->latency[irq_stats_bucket(latency)]++;
+		stats->duration[irq_stats_bucket(duration)]++;
+	}
+
+	irq_unlock(key);
+}
+
+#if defined(CONFIG_ARM) || defined(CONFIG_ARC)
+#include <sw_isr_table.h>
+
+/* Called by the ARM and ARC interrupt entry code instead of the ISR */
+void _irq_stats_isr(const struct _IsrTableEntry *entry, unsigned int irq,
+		    uint32_t entered)
+{
+	uint32_t start = k_cycle_get_32();
+
+	entry->isr(entry->arg);
+
+	_irq_stats_record(irq, entry->isr, entered, start, k_cycle_get_32());
+}
+#endif /* CONFIG_ARM || CONFIG_ARC */
+
+int k_irq_stats_get(unsigned int index, struct k_irq_stats *stats)
+{
+	unsigned int key;
+
+	if (index >= CONFIG_IRQ_STATS_SLOTS) {
+		return -ENOENT;
+	}
+
+	key = irq_lock();
+	*stats = irq_stats[index];
+	irq_unlock(key);
+
+	return stats->isr ? 0 : -ENOENT;
+}
+
+void k_irq_stats_reset(void)
+{
+	unsigned int key = irq_lock();
+
+	memset(irq_stats, 0, sizeof(irq_stats));
+
+	irq_unlock(key);
+}
@@ -30,12 +30,30 @@ struct k_mbox_async {
 /* array of asynchronous message descriptors */
 static struct k_mbox_async __noinit async_msg[CONFIG_NUM_MBOX_ASYNC_MSGS];
 
-/* stack of unused asynchronous message descriptors */
+/* stack of freed asynchronous message descriptors */
 K_STACK_DEFINE(async_msg_free, CONFIG_NUM_MBOX_ASYNC_MSGS);
 
+/* number of descriptors at the start of the array ever allocated */
+static int async_msg_carved;
+
 /* allocate an asynchronous message descriptor */
 static inline void _mbox_async_alloc(struct k_mbox_async **async)
 {
+	unsigned int key = irq_lock();
+
+	/*
+	 * Descriptors never allocated are carved in order, as described for
+	 * block_carve() in mem_slab.c.
+	 */
+	if (async_msg_carved < CONFIG_NUM_MBOX_ASYNC_MSGS) {
+		*async = &async_msg[async_msg_carved++];
+		irq_unlock(key);
+		_init_thread_base(&(*async)->thread, 0, _THREAD_DUMMY, 0);
+		return;
+	}
+
+	irq_unlock(key);
+
 	k_stack_pop(&async_msg_free, (uint32_t *)async, K_FOREVER);
 }
 
@@ -52,58 +70,56 @@ extern struct k_mbox _k_mbox_list_end[];
 
 struct k_mbox *_trace_list_k_mbox;
 
-#if (CONFIG_NUM_MBOX_ASYNC_MSGS > 0) || \
-	defined(CONFIG_OBJECT_TRACING)
+#ifdef CONFIG_MBOX_TARGET_INDEX
+#define MBOX_INDEX_SIZE (1 << CONFIG_MBOX_TARGET_INDEX_POW2)
 
-/*
- * Do run-time initialization of mailbox object subsystem.
- */
-static int init_mbox_module(struct device *dev)
+static inline unsigned int _mbox_index(k_tid_t thread)
 {
-	ARG_UNUSED(dev);
-
-#if (CONFIG_NUM_MBOX_ASYNC_MSGS > 0)
-	/*
-	 * Create pool of asynchronous message descriptors.
-	 *
-	 * A dummy thread requires minimal initialization, since it never gets
-	 * to execute. The _THREAD_DUMMY flag is sufficient to distinguish a
-	 * dummy thread from a real one. The threads are *not* added to the
-	 * kernel's list of known threads.
-	 *
-	 * Once initialized, the address of each descriptor is added to a stack
-	 * that governs access to them.
-	 */
+	return ((uint32_t)thread * 2654435761u) >>
+		(32 - CONFIG_MBOX_TARGET_INDEX_POW2);
+}
 
+static void _mbox_index_init(struct k_mbox *mbox)
+{
 	int i;
 
-	for (i = 0; i < CONFIG_NUM_MBOX_ASYNC_MSGS; i++) {
-		_init_thread_base(&async_msg[i].thread, 0, _THREAD_DUMMY, 0);
-		k_stack_push(&async_msg_free, (uint32_t)&async_msg[i]);
+	for (i = 0; i < MBOX_INDEX_SIZE; i++) {
+		sys_dlist_init(&mbox->tx_target_queues[i]);
+		sys_dlist_init(&mbox->rx_queues[i]);
 	}
-#endif /* CONFIG_NUM_MBOX_ASYNC_MSGS > 0 */
-
-	/* Complete initialization of statically defined mailboxes. */
+}
+#endif
 
 #ifdef CONFIG_OBJECT_TRACING
+
+/*
+ * Complete initialization of statically defined mailboxes.
+ */
+static int init_mbox_module(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
 	struct k_mbox *mbox;
 
 	for (mbox = _k_mbox_list_start; mbox < _k_mbox_list_end; mbox++) {
 		SYS_TRACING_OBJ_INIT(k_mbox, mbox);
 	}
-#endif /* CONFIG_OBJECT_TRACING */
 
 	return 0;
 }
 
 SYS_INIT(init_mbox_module, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
-#endif /* CONFIG_NUM_MBOX_ASYNC_MSGS or CONFIG_OBJECT_TRACING */
+#endif /* CONFIG_OBJECT_TRACING */
 
 void k_mbox_init(struct k_mbox *mbox_ptr)
 {
 	sys_dlist_init(&mbox_ptr->tx_msg_queue);
+#ifdef CONFIG_MBOX_TARGET_INDEX
+	_mbox_index_init(mbox_ptr);
+#else
 	sys_dlist_init(&mbox_ptr->rx_msg_queue);
+#endif
 	SYS_TRACING_OBJ_INIT(k_mbox, mbox_ptr);
 }
 
@@ -119,15 +135,21 @@ void k_mbox_init(struct k_mbox *mbox_ptr)
  *
  * @return 0 if successfully matched, otherwise -1.
  */
+static inline int _mbox_message_compatible(struct k_mbox_msg *tx_msg,
+					   struct k_mbox_msg *rx_msg)
+{
+	return ((tx_msg->tx_target_thread == (k_tid_t)K_ANY) ||
+		(tx_msg->tx_target_thread == rx_msg->tx_target_thread)) &&
+	       ((rx_msg->rx_source_thread == (k_tid_t)K_ANY) ||
+		(rx_msg->rx_source_thread == tx_msg->rx_source_thread));
+}
+
 static int _mbox_message_match(struct k_mbox_msg *tx_msg,
 			       struct k_mbox_msg *rx_msg)
 {
 	uint32_t temp_info;
 
-	if (((tx_msg->tx_target_thread == (k_tid_t)K_ANY) ||
-	     (tx_msg->tx_target_thread == rx_msg->tx_target_thread)) &&
-	    ((rx_msg->rx_source_thread == (k_tid_t)K_ANY) ||
-	     (rx_msg->rx_source_thread == tx_msg->rx_source_thread))) {
+	if (_mbox_message_compatible(tx_msg, rx_msg)) {
 
 		/* update thread identifier fields for both descriptors */
 		rx_msg->rx_source_thread = tx_msg->rx_source_thread;
@@ -161,6 +183,143 @@ static int _mbox_message_match(struct k_mbox_msg *tx_msg,
 	return -1;
 }
 
+#ifdef CONFIG_MBOX_TARGET_INDEX
+/* highest priority of two waiting threads, the first one on a tie */
+static struct k_thread *_mbox_thread_first(struct k_thread *thread,
+					   struct k_thread *other)
+{
+	if (!thread || (other && _is_prio1_higher_than_prio2(other->base.prio,
+							     thread->base.prio))) {
+		return other;
+	}
+
+	return thread;
+}
+#endif
+
+/* first sender of a wait queue whose message a receiver accepts */
+static struct k_thread *_mbox_sender_find_in(_wait_q_t *wait_q,
+					     struct k_mbox_msg *rx_msg)
+{
+	struct k_thread *sending_thread;
+	sys_dnode_t *wait_q_item;
+
+	SYS_DLIST_FOR_EACH_NODE(wait_q, wait_q_item) {
+		sending_thread = (struct k_thread *)wait_q_item;
+		if (_mbox_message_compatible(sending_thread->base.swap_data,
+					     rx_msg)) {
+			return sending_thread;
+		}
+	}
+
+	return NULL;
+}
+
+/* first receiver of a wait queue accepting a message */
+static struct k_thread *_mbox_receiver_find_in(_wait_q_t *wait_q,
+					       struct k_mbox_msg *tx_msg)
+{
+	struct k_thread *receiving_thread;
+	sys_dnode_t *wait_q_item;
+
+	SYS_DLIST_FOR_EACH_NODE(wait_q, wait_q_item) {
+		receiving_thread = (struct k_thread *)wait_q_item;
+		if (_mbox_message_compatible(tx_msg,
+					     receiving_thread->base.swap_data)) {
+			return receiving_thread;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * With CONFIG_MBOX_TARGET_INDEX, senders to any thread wait on tx_msg_queue,
+ * senders to a given thread on the tx_target_queues entry of that thread,
+ * and receivers on their own rx_queues entry. Directed messages are then
+ * matched by looking at the threads of a single entry, plus tx_msg_queue for
+ * receivers. Waiting threads of equal priority are found in the order they
+ * started waiting only within the same queue.
+ */
+static inline _wait_q_t *_mbox_tx_queue(struct k_mbox *mbox,
+					struct k_mbox_msg *tx_msg)
+{
+#ifdef CONFIG_MBOX_TARGET_INDEX
+	if (tx_msg->tx_target_thread != (k_tid_t)K_ANY) {
+		return &mbox->tx_target_queues[
+			_mbox_index(tx_msg->tx_target_thread)];
+	}
+#endif
+	return &mbox->tx_msg_queue;
+}
+
+static inline _wait_q_t *_mbox_rx_queue(struct k_mbox *mbox,
+					struct k_thread *receiving_thread)
+{
+#ifdef CONFIG_MBOX_TARGET_INDEX
+	return &mbox->rx_queues[_mbox_index(receiving_thread)];
+#else
+	ARG_UNUSED(receiving_thread);
+
+	return &mbox->rx_msg_queue;
+#endif
+}
+
+/* must be called with interrupts locked */
+static struct k_thread *_mbox_sender_find(struct k_mbox *mbox,
+					  struct k_mbox_msg *rx_msg)
+{
+	struct k_thread *sending_thread;
+
+	sending_thread = _mbox_sender_find_in(&mbox->tx_msg_queue, rx_msg);
+
+#ifdef CONFIG_MBOX_TARGET_INDEX
+	sending_thread = _mbox_thread_first(
+		_mbox_sender_find_in(&mbox->tx_target_queues[
+			_mbox_index(rx_msg->tx_target_thread)], rx_msg),
+		sending_thread);
+#endif
+
+	return sending_thread;
+}
+
+/* must be called with interrupts locked */
+static struct k_thread *_mbox_receiver_find(struct k_mbox *mbox,
+					    struct k_mbox_msg *tx_msg)
+{
+#ifdef CONFIG_MBOX_TARGET_INDEX
+	struct k_thread *receiving_thread = NULL;
+	int i;
+
+	if (tx_msg->tx_target_thread != (k_tid_t)K_ANY) {
+		return _mbox_receiver_find_in(_mbox_rx_queue(mbox,
+				tx_msg->tx_target_thread), tx_msg);
+	}
+
+	for (i = 0; i < MBOX_INDEX_SIZE; i++) {
+		receiving_thread = _mbox_thread_first(receiving_thread,
+			_mbox_receiver_find_in(&mbox->rx_queues[i], tx_msg));
+	}
+
+	return receiving_thread;
+#else
+	return _mbox_receiver_find_in(&mbox->rx_msg_queue, tx_msg);
+#endif
+}
+
+/*
+ * Must be called with interrupts locked: takes a receiver found by
+ * _mbox_receiver_find() out of its queue and readies it.
+ */
+static void _mbox_receiver_wake(struct k_thread *receiving_thread)
+{
+	_unpend_thread(receiving_thread);
+	_abort_thread_timeout(receiving_thread);
+
+	_set_thread_return_value(receiving_thread, 0);
+	_ready_thread(receiving_thread);
+}
+
 /**
  * @brief Dispose of received message.
  *
@@ -239,8 +398,6 @@ static int _mbox_message_put(struct k_mbox *mbox, struct k_mbox_msg *tx_msg,
 {
 	struct k_thread *sending_thread;
 	struct k_thread *receiving_thread;
-	struct k_mbox_msg *rx_msg;
-	sys_dnode_t *wait_q_item, *next_wait_q_item;
 	unsigned int key;
 
 	/* save sender id so it can be used during message matching */
@@ -253,43 +410,34 @@ static int _mbox_message_put(struct k_mbox *mbox, struct k_mbox_msg *tx_msg,
 	/* search mailbox's rx queue for a compatible receiver */
 	key = irq_lock();
 
-	SYS_DLIST_FOR_EACH_NODE_SAFE(&mbox->rx_msg_queue, wait_q_item,
-				     next_wait_q_item) {
-
-		receiving_thread = (struct k_thread *)wait_q_item;
-		rx_msg = (struct k_mbox_msg *)receiving_thread->base.swap_data;
+	receiving_thread = _mbox_receiver_find(mbox, tx_msg);
+	if (receiving_thread) {
+		_mbox_message_match(tx_msg, receiving_thread->base.swap_data);
 
-		if (_mbox_message_match(tx_msg, rx_msg) == 0) {
-			/* take receiver out of rx queue */
-			_unpend_thread(receiving_thread);
-			_abort_thread_timeout(receiving_thread);
-
-			/* ready receiver for execution */
-			_set_thread_return_value(receiving_thread, 0);
-			_ready_thread(receiving_thread);
+		/* take receiver out of rx queue, ready it for execution */
+		_mbox_receiver_wake(receiving_thread);
 
 #if (CONFIG_NUM_MBOX_ASYNC_MSGS > 0)
-			/*
-			 * asynchronous send: swap out current thread
-			 * if receiver has priority, otherwise let it continue
-			 *
-			 * note: dummy sending thread sits (unqueued)
-			 * until the receiver consumes the message
-			 */
-			if (sending_thread->base.thread_state & _THREAD_DUMMY) {
-				_reschedule_threads(key);
-				return 0;
-			}
+		/*
+		 * asynchronous send: swap out current thread
+		 * if receiver has priority, otherwise let it continue
+		 *
+		 * note: dummy sending thread sits (unqueued)
+		 * until the receiver consumes the message
+		 */
+		if (sending_thread->base.thread_state & _THREAD_DUMMY) {
+			_reschedule_threads(key);
+			return 0;
+		}
 #endif
 
-			/*
-			 * synchronous send: pend current thread (unqueued)
-			 * until the receiver consumes the message
-			 */
-			_remove_thread_from_ready_q(_current);
-			_mark_thread_as_pending(_current);
-			return _Swap(key);
-		}
+		/*
+		 * synchronous send: pend current thread (unqueued)
+		 * until the receiver consumes the message
+		 */
+		_remove_thread_from_ready_q(_current);
+		_mark_thread_as_pending(_current);
+		return _Swap(key);
 	}
 
 	/* didn't find a matching receiver: don't wait for one */
@@ -301,14 +449,15 @@ static int _mbox_message_put(struct k_mbox *mbox, struct k_mbox_msg *tx_msg,
 #if (CONFIG_NUM_MBOX_ASYNC_MSGS > 0)
 	/* asynchronous send: dummy thread waits on tx queue for receiver */
 	if (sending_thread->base.thread_state & _THREAD_DUMMY) {
-		_pend_thread(sending_thread, &mbox->tx_msg_queue, K_FOREVER);
+		_pend_thread(sending_thread, _mbox_tx_queue(mbox, tx_msg),
+			     K_FOREVER);
 		irq_unlock(key);
 		return 0;
 	}
 #endif
 
 	/* synchronous send: sender waits on tx queue for receiver or timeout */
-	_pend_current_thread(&mbox->tx_msg_queue, timeout);
+	_pend_current_thread(_mbox_tx_queue(mbox, tx_msg), timeout);
 	return _Swap(key);
 }
 
@@ -325,6 +474,34 @@ void k_mbox_async_put(struct k_mbox *mbox, struct k_mbox_msg *tx_msg,
 		      struct k_sem *sem)
 {
 	struct k_mbox_async *async;
+	struct k_thread *receiving_thread;
+	struct k_mbox_msg direct_msg;
+	unsigned int key;
+
+	/*
+	 * a message the sender needs no notification for, and with no memory
+	 * pool block to release, is handed to a receiver already waiting
+	 * without using a descriptor: the receiver has nothing to dispose of
+	 */
+	if (sem == NULL &&
+	    (tx_msg->tx_data != NULL || tx_msg->tx_block.pool_id == NULL)) {
+		direct_msg = *tx_msg;
+		direct_msg.rx_source_thread = _current;
+		direct_msg._syncing_thread = NULL;
+
+		key = irq_lock();
+
+		receiving_thread = _mbox_receiver_find(mbox, &direct_msg);
+		if (receiving_thread) {
+			_mbox_message_match(&direct_msg,
+					    receiving_thread->base.swap_data);
+			_mbox_receiver_wake(receiving_thread);
+			_reschedule_threads(key);
+			return;
+		}
+
+		irq_unlock(key);
+	}
 
 	/*
 	 * allocate an asynchronous message descriptor, configure both parts,
@@ -427,8 +604,6 @@ int k_mbox_get(struct k_mbox *mbox, struct k_mbox_msg *rx_msg, void *buffer,
 	       int32_t timeout)
 {
 	struct k_thread *sending_thread;
-	struct k_mbox_msg *tx_msg;
-	sys_dnode_t *wait_q_item, *next_wait_q_item;
 	unsigned int key;
 	int result;
 
@@ -438,22 +613,18 @@ int k_mbox_get(struct k_mbox *mbox, struct k_mbox_msg *rx_msg, void *buffer,
 	/* search mailbox's tx queue for a compatible sender */
 	key = irq_lock();
 
-	SYS_DLIST_FOR_EACH_NODE_SAFE(&mbox->tx_msg_queue, wait_q_item,
-				     next_wait_q_item) {
+	sending_thread = _mbox_sender_find(mbox, rx_msg);
+	if (sending_thread) {
+		_mbox_message_match(sending_thread->base.swap_data, rx_msg);
 
-		sending_thread = (struct k_thread *)wait_q_item;
-		tx_msg = (struct k_mbox_msg *)sending_thread->base.swap_data;
+		/* take sender out of mailbox's tx queue */
+		_unpend_thread(sending_thread);
+		_abort_thread_timeout(sending_thread);
 
-		if (_mbox_message_match(tx_msg, rx_msg) == 0) {
-			/* take sender out of mailbox's tx queue */
-			_unpend_thread(sending_thread);
-			_abort_thread_timeout(sending_thread);
-
-			irq_unlock(key);
+		irq_unlock(key);
 
-			/* consume message data immediately, if needed */
-			return _mbox_message_data_check(rx_msg, buffer);
-		}
+		/* consume message data immediately, if needed */
+		return _mbox_message_data_check(rx_msg, buffer);
 	}
 
 	/* didn't find a matching sender */
@@ -465,7 +636,7 @@ int k_mbox_get(struct k_mbox *mbox, struct k_mbox_msg *rx_msg, void *buffer,
 	}
 
 	/* wait until a matching sender appears or a timeout occurs */
-	_pend_current_thread(&mbox->rx_msg_queue, timeout);
+	_pend_current_thread(_mbox_rx_queue(mbox, _current), timeout);
 	_current->base.swap_data = rx_msg;
 	result = _Swap(key);
 
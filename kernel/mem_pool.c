@@ -25,79 +25,74 @@ extern struct k_mem_pool _k_mem_pool_list_end[];
 
 struct k_mem_pool *_trace_list_k_mem_pool;
 
-static void init_one_memory_pool(struct k_mem_pool *pool);
+#ifdef CONFIG_MEM_POOL_STATS
+static void stats_block_alloc(struct k_mem_pool *pool, int index)
+{
+	unsigned int key = irq_lock();
 
-/**
- *
- * @brief Initialize kernel memory pool subsystem
- *
- * Perform any initialization of memory pool that wasn't done at build time.
- *
- * @return N/A
+	pool->block_set[index].count++;
+	pool->bytes_used += pool->block_set[index].block_size;
+	if (pool->bytes_used > pool->max_bytes_used) {
+		pool->max_bytes_used = pool->bytes_used;
+	}
+	irq_unlock(key);
+}
+
+static void stats_block_free(struct k_mem_pool *pool, int index)
+{
+	unsigned int key = irq_lock();
+
+	pool->block_set[index].count--;
+	pool->bytes_used -= pool->block_set[index].block_size;
+	irq_unlock(key);
+}
+
+static void stats_alloc_failed(struct k_mem_pool *pool)
+{
+	unsigned int key = irq_lock();
+
+	pool->num_failures++;
+	irq_unlock(key);
+}
+#else
+static inline void stats_block_alloc(struct k_mem_pool *pool, int index)
+{
+	ARG_UNUSED(pool);
+	ARG_UNUSED(index);
+}
+
+static inline void stats_block_free(struct k_mem_pool *pool, int index)
+{
+	ARG_UNUSED(pool);
+	ARG_UNUSED(index);
+}
+
+static inline void stats_alloc_failed(struct k_mem_pool *pool)
+{
+	ARG_UNUSED(pool);
+}
+#endif
+
+#ifdef CONFIG_OBJECT_TRACING
+/*
+ * Complete initialization of statically defined memory pools: their
+ * quad-blocks and wait queue are initialized at build time.
  */
 static int init_static_pools(struct device *unused)
 {
 	ARG_UNUSED(unused);
 	struct k_mem_pool *pool;
 
-	/* perform initialization for each memory pool */
-
 	for (pool = _k_mem_pool_list_start;
 	     pool < _k_mem_pool_list_end;
 	     pool++) {
-		init_one_memory_pool(pool);
+		SYS_TRACING_OBJ_INIT(k_mem_pool, pool);
 	}
 	return 0;
 }
 
 SYS_INIT(init_static_pools, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
-
-/**
- *
- * @brief Initialize the memory pool
- *
- * Initialize the internal memory accounting structures of the memory pool
- *
- * @param pool memory pool descriptor
- *
- * @return N/A
- */
-static void init_one_memory_pool(struct k_mem_pool *pool)
-{
-	/*
-	 * mark block set for largest block size
-	 * as owning all of the memory pool buffer space
-	 */
-
-	int remaining_blocks = pool->nr_of_maxblocks;
-	int j = 0;
-	char *memptr = pool->bufblock;
-
-	while (remaining_blocks >= 4) {
-		pool->block_set[0].quad_block[j].mem_blocks = memptr;
-		pool->block_set[0].quad_block[j].mem_status =
-			_QUAD_BLOCK_AVAILABLE;
-		j++;
-		remaining_blocks -= 4;
-		memptr +=
-			OCTET_TO_SIZEOFUNIT(pool->block_set[0].block_size)
-			* 4;
-	}
-
-	if (remaining_blocks != 0) {
-		pool->block_set[0].quad_block[j].mem_blocks = memptr;
-		pool->block_set[0].quad_block[j].mem_status =
-			_QUAD_BLOCK_AVAILABLE >> (4 - remaining_blocks);
-		/* non-existent blocks are marked as unavailable */
-	}
-
-	/*
-	 * note: all other block sets own no blocks, since their
-	 * first quad-block has a NULL memory pointer
-	 */
-	sys_dlist_init(&pool->wait_q);
-	SYS_TRACING_OBJ_INIT(k_mem_pool, pool);
-}
+#endif /* CONFIG_OBJECT_TRACING */
 
 /**
  *
@@ -286,9 +281,6 @@ static char *get_existing_block(struct k_mem_pool_block_set *block_set,
 			/* mark block as unavailable (using XOR to invert) */
 			block_set->quad_block[i].mem_status ^=
 				1 << free_bit;
-#ifdef CONFIG_OBJECT_MONITOR
-			block_set->count++;
-#endif
 			break;
 		}
 
@@ -371,9 +363,6 @@ static char *get_block_recursive(struct k_mem_pool *pool,
 		fr_table[index].quad_block[i].mem_blocks = larger_block;
 		fr_table[index].quad_block[i].mem_status =
 			_QUAD_BLOCK_AVAILABLE & (~0x1);
-#ifdef CONFIG_OBJECT_MONITOR
-		fr_table[index].count++;
-#endif
 		return larger_block;
 	}
 
@@ -439,6 +428,8 @@ static void block_waiters_check(struct k_mem_pool *pool)
 
 		/* if success : remove task from list and reschedule */
 		if (found_block != NULL) {
+			stats_block_alloc(pool, offset);
+
 			/* return found block */
 			_set_thread_return_value_with_data(waiter, 0,
 							   found_block);
@@ -484,6 +475,7 @@ int k_mem_pool_alloc(struct k_mem_pool *pool, struct k_mem_block *block,
 
 
 	if (found_block != NULL) {
+		stats_block_alloc(pool, offset);
 		k_sched_unlock();
 		block->pool_id = pool;
 		block->addr_in_pool = found_block;
@@ -509,9 +501,12 @@ int k_mem_pool_alloc(struct k_mem_pool *pool, struct k_mem_block *block,
 			block->addr_in_pool = _current->base.swap_data;
 			block->data = _current->base.swap_data;
 			block->req_size = size;
+		} else {
+			stats_alloc_failed(pool);
 		}
 		return result;
 	}
+	stats_alloc_failed(pool);
 	k_sched_unlock();
 	return -ENOMEM;
 }
@@ -527,76 +522,60 @@ void k_mem_pool_free(struct k_mem_block *block)
 
 	/* mark the block as unused */
 	free_existing_block(block->addr_in_pool, pool, offset);
+	stats_block_free(pool, offset);
 
 	/* reschedule anybody waiting for a block */
 	block_waiters_check(pool);
 	k_sched_unlock();
 }
 
+#ifdef CONFIG_MEM_POOL_STATS
+void k_mem_pool_stats_get(struct k_mem_pool *pool,
+			  struct k_mem_pool_stats *stats)
+{
+	struct k_mem_pool_block_set *block_set;
+	uint32_t i;
+	int j;
 
-/*
- * Heap memory pool support
- */
-
-#if (CONFIG_HEAP_MEM_POOL_SIZE > 0)
-
-/*
- * Case 1: Heap is defined using HEAP_MEM_POOL_SIZE configuration option.
- *
- * This module defines the heap memory pool and the _HEAP_MEM_POOL symbol
- * that has the address of the associated memory pool struct.
- */
-
-K_MEM_POOL_DEFINE(_heap_mem_pool, 64, CONFIG_HEAP_MEM_POOL_SIZE, 1, 4);
-#define _HEAP_MEM_POOL (&_heap_mem_pool)
-
-#else
-
-/*
- * Case 2: Heap is defined using HEAP_SIZE item type in MDEF.
- *
- * Sysgen defines the heap memory pool and the _heap_mem_pool_ptr variable
- * that has the address of the associated memory pool struct. This module
- * defines the _HEAP_MEM_POOL symbol as an alias for _heap_mem_pool_ptr.
- *
- * Note: If the MDEF does not define the heap memory pool k_malloc() will
- * compile successfully, but will trigger a link error if it is used.
- */
-
-extern struct k_mem_pool * const _heap_mem_pool_ptr;
-#define _HEAP_MEM_POOL _heap_mem_pool_ptr
+	_sched_lock();
 
-#endif /* CONFIG_HEAP_MEM_POOL_SIZE */
+	stats->bytes_used = pool->bytes_used;
+	stats->max_bytes_used = pool->max_bytes_used;
+	stats->num_failures = pool->num_failures;
+	stats->largest_free_block = 0;
 
+	/* find the largest block set that has a free block */
+	for (j = 0; j < pool->nr_of_block_sets; j++) {
+		block_set = &pool->block_set[j];
 
-void *k_malloc(size_t size)
-{
-	struct k_mem_block block;
+		for (i = 0; i < block_set->nr_of_entries; i++) {
+			if (block_set->quad_block[i].mem_blocks == NULL) {
+				break;
+			}
 
-	/*
-	 * get a block large enough to hold an initial (hidden) block
-	 * descriptor, as well as the space the caller requested
-	 */
-	size += sizeof(struct k_mem_block);
-	if (k_mem_pool_alloc(_HEAP_MEM_POOL, &block, size, K_NO_WAIT) != 0) {
-		return NULL;
+			if (block_set->quad_block[i].mem_status !=
+			    _QUAD_BLOCK_ALLOCATED) {
+				stats->largest_free_block =
+					block_set->block_size;
+				goto done;
+			}
+		}
 	}
 
-	/* save the block descriptor info at the start of the actual block */
-	memcpy(block.data, &block, sizeof(struct k_mem_block));
-
-	/* return address of the user area part of the block to the caller */
-	return (char *)block.data + sizeof(struct k_mem_block);
+done:
+	k_sched_unlock();
 }
 
-
-void k_free(void *ptr)
+int k_mem_pool_block_stats_get(struct k_mem_pool *pool, int index,
+			       size_t *block_size, uint32_t *num_used)
 {
-	if (ptr != NULL) {
-		/* point to hidden block descriptor at start of block */
-		ptr = (char *)ptr - sizeof(struct k_mem_block);
-
-		/* return block to the heap memory pool */
-		k_mem_pool_free(ptr);
+	if (index < 0 || index >= pool->nr_of_block_sets) {
+		return -EINVAL;
 	}
+
+	*block_size = pool->block_set[index].block_size;
+	*num_used = pool->block_set[index].count;
+
+	return 0;
 }
+#endif /* CONFIG_MEM_POOL_STATS */
@@ -0,0 +1,545 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Memory pools, two-level segregated fit (TLSF) implementation.
+ *
+ * Blocks of any size are carved out of the pool's buffer. Each block starts
+ * with a header giving its size and the block preceding it in memory, so that
+ * a freed block is merged with its free neighbours right away. Free blocks are
+ * kept in segregated lists, one per size class, and a two-level bitmap of the
+ * non-empty lists finds a free block large enough for a request with two
+ * find-first-set operations. Allocating and freeing are thus O(1).
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <debug/object_tracing_common.h>
+#include <ksched.h>
+#include <wait_q.h>
+#include <init.h>
+
+struct _tlsf_block {
+	/* block preceding this one in memory, NULL for the first block */
+	struct _tlsf_block *prev_phys;
+	/* size of the payload; the lowest bit flags a free block */
+	size_t size;
+	/* free blocks only: links in the free list, overlapping the payload */
+	struct _tlsf_block *next_free;
+	struct _tlsf_block *prev_free;
+};
+
+#define FREE_BIT 1
+
+#define ALIGN_SHIFT 3
+#define SL_SHIFT _TLSF_SL_SHIFT
+#define SL_COUNT _TLSF_SL_COUNT
+#define HDR_SIZE _TLSF_HDR_SIZE
+
+/* sizes below this are all in the first first-level class */
+#define SMALL_SIZE (1 << (SL_SHIFT + ALIGN_SHIFT))
+
+extern struct k_mem_pool _k_mem_pool_list_start[];
+extern struct k_mem_pool _k_mem_pool_list_end[];
+
+struct k_mem_pool *_trace_list_k_mem_pool;
+
+static inline size_t block_size(struct _tlsf_block *block)
+{
+	return block->size & ~FREE_BIT;
+}
+
+static inline int block_is_free(struct _tlsf_block *block)
+{
+	return block->size & FREE_BIT;
+}
+
+static inline char *block_payload(struct _tlsf_block *block)
+{
+	return (char *)block + HDR_SIZE;
+}
+
+static inline struct _tlsf_block *payload_block(void *payload)
+{
+	return (struct _tlsf_block *)((char *)payload - HDR_SIZE);
+}
+
+/* block following this one in memory, NULL for the last block */
+static inline struct _tlsf_block *block_next(struct k_mem_pool *pool,
+					     struct _tlsf_block *block)
+{
+	char *next = block_payload(block) + block_size(block);
+
+	return next < pool->buf + pool->buf_size ?
+		(struct _tlsf_block *)next : NULL;
+}
+
+/* find the free list a block of 'size' bytes belongs to */
+static void mapping_insert(struct k_mem_pool *pool, size_t size,
+			   int *fl, int *sl)
+{
+	if (size < SMALL_SIZE) {
+		*fl = 0;
+		*sl = size >> ALIGN_SHIFT;
+		return;
+	}
+
+	int msb = find_msb_set(size) - 1;
+
+	*fl = msb - (SL_SHIFT + ALIGN_SHIFT) + 1;
+	*sl = (size >> (msb - SL_SHIFT)) & (SL_COUNT - 1);
+
+	/* blocks larger than any request go in the last list */
+	if (*fl >= pool->fl_count) {
+		*fl = pool->fl_count - 1;
+		*sl = SL_COUNT - 1;
+	}
+}
+
+/*
+ * Find the first free list whose blocks are all at least 'size' bytes long:
+ * round the size up to the next class, so that any block of the class fits.
+ */
+static void mapping_search(struct k_mem_pool *pool, size_t size,
+			   int *fl, int *sl)
+{
+	if (size >= SMALL_SIZE) {
+		size += (1 << ((find_msb_set(size) - 1) - SL_SHIFT)) - 1;
+	}
+
+	mapping_insert(pool, size, fl, sl);
+}
+
+static void insert_free_block(struct k_mem_pool *pool,
+			      struct _tlsf_block *block)
+{
+	struct _tlsf_block **head;
+	int fl, sl;
+
+	mapping_insert(pool, block_size(block), &fl, &sl);
+	head = &pool->free_lists[fl * SL_COUNT + sl];
+
+	block->size |= FREE_BIT;
+	block->prev_free = NULL;
+	block->next_free = *head;
+	if (*head) {
+		(*head)->prev_free = block;
+	}
+	*head = block;
+
+	pool->fl_bitmap |= (1 << fl);
+	pool->sl_bitmap[fl] |= (1 << sl);
+}
+
+static void remove_free_block(struct k_mem_pool *pool,
+			      struct _tlsf_block *block)
+{
+	int fl, sl;
+
+	mapping_insert(pool, block_size(block), &fl, &sl);
+
+	if (block->next_free) {
+		block->next_free->prev_free = block->prev_free;
+	}
+
+	if (block->prev_free) {
+		block->prev_free->next_free = block->next_free;
+	} else {
+		pool->free_lists[fl * SL_COUNT + sl] = block->next_free;
+		if (!block->next_free) {
+			pool->sl_bitmap[fl] &= ~(1 << sl);
+			if (!pool->sl_bitmap[fl]) {
+				pool->fl_bitmap &= ~(1 << fl);
+			}
+		}
+	}
+
+	block->size &= ~FREE_BIT;
+}
+
+static struct _tlsf_block *find_free_block(struct k_mem_pool *pool,
+					   size_t size)
+{
+	uint32_t sl_map, fl_map;
+	int fl, sl;
+
+	mapping_search(pool, size, &fl, &sl);
+
+	sl_map = pool->sl_bitmap[fl] & (~0U << sl);
+	if (!sl_map) {
+		/* no block in this first-level class: go to a larger one */
+		fl_map = pool->fl_bitmap & (~0U << (fl + 1));
+		if (!fl_map) {
+			return NULL;
+		}
+
+		fl = find_lsb_set(fl_map) - 1;
+		sl_map = pool->sl_bitmap[fl];
+	}
+
+	sl = find_lsb_set(sl_map) - 1;
+
+	return pool->free_lists[fl * SL_COUNT + sl];
+}
+
+#ifdef CONFIG_MEM_POOL_STATS
+/* first level class of the blocks allocated for 'size' bytes */
+static int stats_index(struct k_mem_pool *pool, size_t size)
+{
+	int fl, sl;
+
+	mapping_insert(pool, _TLSF_PAYLOAD(size), &fl, &sl);
+
+	return fl;
+}
+
+static void stats_block_alloc(struct k_mem_pool *pool, char *ptr,
+			      size_t size)
+{
+	unsigned int key = irq_lock();
+
+	pool->num_used[stats_index(pool, size)]++;
+	pool->bytes_used += block_size(payload_block(ptr));
+	if (pool->bytes_used > pool->max_bytes_used) {
+		pool->max_bytes_used = pool->bytes_used;
+	}
+	irq_unlock(key);
+}
+
+/* must be called before the block is merged with its neighbours */
+static void stats_block_free(struct k_mem_pool *pool, char *ptr, size_t size)
+{
+	unsigned int key = irq_lock();
+
+	pool->num_used[stats_index(pool, size)]--;
+	pool->bytes_used -= block_size(payload_block(ptr));
+	irq_unlock(key);
+}
+
+static void stats_alloc_failed(struct k_mem_pool *pool)
+{
+	unsigned int key = irq_lock();
+
+	pool->num_failures++;
+	irq_unlock(key);
+}
+
+static void stats_init(struct k_mem_pool *pool)
+{
+	pool->bytes_used = 0;
+	pool->max_bytes_used = 0;
+	pool->num_failures = 0;
+	for (int fl = 0; fl < pool->fl_count; fl++) {
+		pool->num_used[fl] = 0;
+	}
+}
+#else
+static inline void stats_block_alloc(struct k_mem_pool *pool, char *ptr,
+				     size_t size)
+{
+	ARG_UNUSED(pool);
+	ARG_UNUSED(ptr);
+	ARG_UNUSED(size);
+}
+
+static inline void stats_block_free(struct k_mem_pool *pool, char *ptr,
+				    size_t size)
+{
+	ARG_UNUSED(pool);
+	ARG_UNUSED(ptr);
+	ARG_UNUSED(size);
+}
+
+static inline void stats_alloc_failed(struct k_mem_pool *pool)
+{
+	ARG_UNUSED(pool);
+}
+
+static inline void stats_init(struct k_mem_pool *pool)
+{
+	ARG_UNUSED(pool);
+}
+#endif /* CONFIG_MEM_POOL_STATS */
+
+/* must be called with the scheduler locked */
+static char *tlsf_alloc(struct k_mem_pool *pool, size_t size)
+{
+	struct _tlsf_block *block, *rest, *next;
+
+	if (size > pool->max_block_size) {
+		return NULL;
+	}
+
+	size = _TLSF_PAYLOAD(size);
+
+	block = find_free_block(pool, size);
+	if (!block) {
+		return NULL;
+	}
+
+	remove_free_block(pool, block);
+
+	/* give back the tail of the block if it can hold a block of its own */
+	if (block_size(block) >= size + HDR_SIZE + _TLSF_PAYLOAD(0)) {
+		rest = (struct _tlsf_block *)(block_payload(block) + size);
+		rest->prev_phys = block;
+		rest->size = block_size(block) - size - HDR_SIZE;
+
+		next = block_next(pool, rest);
+		if (next) {
+			next->prev_phys = rest;
+		}
+
+		block->size = size;
+		insert_free_block(pool, rest);
+	}
+
+	return block_payload(block);
+}
+
+/* must be called with the scheduler locked */
+static void tlsf_free(struct k_mem_pool *pool, char *ptr)
+{
+	struct _tlsf_block *block = payload_block(ptr);
+	struct _tlsf_block *prev = block->prev_phys;
+	struct _tlsf_block *next;
+
+	__ASSERT(!block_is_free(block), "block already free\n");
+
+	if (prev && block_is_free(prev)) {
+		remove_free_block(pool, prev);
+		prev->size += HDR_SIZE + block_size(block);
+		block = prev;
+	}
+
+	next = block_next(pool, block);
+	if (next && block_is_free(next)) {
+		remove_free_block(pool, next);
+		block->size += HDR_SIZE + block_size(next);
+	}
+
+	next = block_next(pool, block);
+	if (next) {
+		next->prev_phys = block;
+	}
+
+	insert_free_block(pool, block);
+}
+
+/**
+ *
+ * @brief Initialize the memory pool
+ *
+ * Make the whole buffer of the memory pool one free block.
+ *
+ * @param pool memory pool descriptor
+ *
+ * @return N/A
+ */
+static void init_one_memory_pool(struct k_mem_pool *pool)
+{
+	struct _tlsf_block *block = (struct _tlsf_block *)pool->buf;
+
+	pool->fl_bitmap = 0;
+	for (int fl = 0; fl < pool->fl_count; fl++) {
+		pool->sl_bitmap[fl] = 0;
+		for (int sl = 0; sl < SL_COUNT; sl++) {
+			pool->free_lists[fl * SL_COUNT + sl] = NULL;
+		}
+	}
+
+	block->prev_phys = NULL;
+	block->size = pool->buf_size - HDR_SIZE;
+	insert_free_block(pool, block);
+
+	stats_init(pool);
+	SYS_TRACING_OBJ_INIT(k_mem_pool, pool);
+}
+
+/**
+ *
+ * @brief Initialize kernel memory pool subsystem
+ *
+ * Perform any initialization of memory pool that wasn't done at build time.
+ *
+ * @return N/A
+ */
+static int init_static_pools(struct device *unused)
+{
+	ARG_UNUSED(unused);
+	struct k_mem_pool *pool;
+
+	for (pool = _k_mem_pool_list_start;
+	     pool < _k_mem_pool_list_end;
+	     pool++) {
+		init_one_memory_pool(pool);
+	}
+	return 0;
+}
+
+SYS_INIT(init_static_pools, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
+
+/**
+ *
+ * @brief Examine threads that are waiting for memory pool blocks.
+ *
+ * This routine attempts to satisfy any incomplete block allocation requests for
+ * the specified memory pool, after a block has been freed.
+ *
+ * @return N/A
+ */
+static void block_waiters_check(struct k_mem_pool *pool)
+{
+	char *found_block;
+	struct k_thread *waiter;
+	struct k_thread *next_waiter;
+
+	unsigned int key = irq_lock();
+
+	waiter = (struct k_thread *)sys_dlist_peek_head(&pool->wait_q);
+
+	/* loop all waiters */
+	while (waiter != NULL) {
+		size_t req_size = (size_t)(waiter->base.swap_data);
+
+		found_block = tlsf_alloc(pool, req_size);
+
+		next_waiter = (struct k_thread *)sys_dlist_peek_next(
+			&pool->wait_q, &waiter->base.k_q_node);
+
+		/* if success : remove task from list and reschedule */
+		if (found_block != NULL) {
+			stats_block_alloc(pool, found_block, req_size);
+
+			/* return found block */
+			_set_thread_return_value_with_data(waiter, 0,
+							   found_block);
+
+			/*
+			 * Schedule the thread. Threads will be rescheduled
+			 * outside the function by k_sched_unlock()
+			 */
+			_unpend_thread(waiter);
+			_abort_thread_timeout(waiter);
+			_ready_thread(waiter);
+		}
+		waiter = next_waiter;
+	}
+	irq_unlock(key);
+}
+
+void k_mem_pool_defrag(struct k_mem_pool *pool)
+{
+	/* free blocks are merged as soon as they are freed */
+	ARG_UNUSED(pool);
+}
+
+int k_mem_pool_alloc(struct k_mem_pool *pool, struct k_mem_block *block,
+		     size_t size, int32_t timeout)
+{
+	char *found_block;
+
+	_sched_lock();
+
+	found_block = tlsf_alloc(pool, size);
+
+	if (found_block != NULL) {
+		stats_block_alloc(pool, found_block, size);
+		k_sched_unlock();
+		block->pool_id = pool;
+		block->addr_in_pool = found_block;
+		block->data = found_block;
+		block->req_size = size;
+		return 0;
+	}
+
+	/*
+	 * no suitable block is currently available,
+	 * so either wait for one to appear or indicate failure
+	 */
+	if (likely(timeout != K_NO_WAIT)) {
+		int result;
+		unsigned int key = irq_lock();
+
+		_sched_unlock_no_reschedule();
+
+		_current->base.swap_data = (void *)size;
+		_pend_current_thread(&pool->wait_q, timeout);
+		result = _Swap(key);
+		if (result == 0) {
+			block->pool_id = pool;
+			block->addr_in_pool = _current->base.swap_data;
+			block->data = _current->base.swap_data;
+			block->req_size = size;
+		} else {
+			stats_alloc_failed(pool);
+		}
+		return result;
+	}
+	stats_alloc_failed(pool);
+	k_sched_unlock();
+	return -ENOMEM;
+}
+
+void k_mem_pool_free(struct k_mem_block *block)
+{
+	struct k_mem_pool *pool = block->pool_id;
+
+	_sched_lock();
+
+	stats_block_free(pool, block->addr_in_pool, block->req_size);
+	tlsf_free(pool, block->addr_in_pool);
+
+	/* reschedule anybody waiting for a block */
+	block_waiters_check(pool);
+	k_sched_unlock();
+}
+
+#ifdef CONFIG_MEM_POOL_STATS
+void k_mem_pool_stats_get(struct k_mem_pool *pool,
+			  struct k_mem_pool_stats *stats)
+{
+	struct _tlsf_block *block;
+	int fl, sl;
+
+	_sched_lock();
+
+	stats->bytes_used = pool->bytes_used;
+	stats->max_bytes_used = pool->max_bytes_used;
+	stats->num_failures = pool->num_failures;
+	stats->largest_free_block = 0;
+
+	/* the largest free block is in the last non-empty list */
+	if (pool->fl_bitmap) {
+		fl = find_msb_set(pool->fl_bitmap) - 1;
+		sl = find_msb_set(pool->sl_bitmap[fl]) - 1;
+
+		for (block = pool->free_lists[fl * SL_COUNT + sl]; block;
+		     block = block->next_free) {
+			if (block_size(block) > stats->largest_free_block) {
+				stats->largest_free_block = block_size(block);
+			}
+		}
+	}
+
+	k_sched_unlock();
+}
+
+int k_mem_pool_block_stats_get(struct k_mem_pool *pool, int index,
+			       size_t *class_size, uint32_t *num_used)
+{
+	if (index < 0 || index >= pool->fl_count) {
+		return -EINVAL;
+	}
+
+	/* class 'index' holds sizes up to the next power of two, excluded */
+	*class_size = (1 << (index + SL_SHIFT + ALIGN_SHIFT)) - _TLSF_ALIGN;
+	*num_used = pool->num_used[index];
+
+	return 0;
+}
+#endif /* CONFIG_MEM_POOL_STATS */
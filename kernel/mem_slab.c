@@ -19,35 +19,186 @@ extern struct k_mem_slab _k_mem_slab_list_end[];
 
 struct k_mem_slab *_trace_list_k_mem_slab;
 
-/**
- * @brief Initialize kernel memory slab subsystem.
- *
- * Perform any initialization of memory slabs that wasn't done at build time.
- * Currently this just involves creating the list of free blocks for each slab.
+#ifdef CONFIG_MEM_SLAB_STATS
+#ifdef CONFIG_MEM_SLAB_LOCKLESS
+/* must be called once 'num_used' blocks are allocated */
+static inline void stats_block_alloc(struct k_mem_slab *slab,
+				     uint32_t num_used)
+{
+	atomic_val_t max_used;
+
+	do {
+		max_used = atomic_get(&slab->max_used);
+		if ((uint32_t)max_used >= num_used) {
+			return;
+		}
+	} while (!atomic_cas(&slab->max_used, max_used,
+			     (atomic_val_t)num_used));
+}
+
+static inline void stats_alloc_failed(struct k_mem_slab *slab)
+{
+	atomic_inc(&slab->num_failures);
+}
+#else
+/* must be called with interrupts locked */
+static inline void stats_block_alloc(struct k_mem_slab *slab,
+				     uint32_t num_used)
+{
+	if (num_used > slab->max_used) {
+		slab->max_used = num_used;
+	}
+}
+
+static inline void stats_alloc_failed(struct k_mem_slab *slab)
+{
+	unsigned int key = irq_lock();
+
+	slab->num_failures++;
+	irq_unlock(key);
+}
+#endif
+
+static inline void stats_init(struct k_mem_slab *slab)
+{
+	slab->max_used = 0;
+	slab->num_failures = 0;
+}
+#else
+static inline void stats_block_alloc(struct k_mem_slab *slab,
+				     uint32_t num_used)
+{
+	ARG_UNUSED(slab);
+	ARG_UNUSED(num_used);
+}
+
+static inline void stats_alloc_failed(struct k_mem_slab *slab)
+{
+	ARG_UNUSED(slab);
+}
+
+static inline void stats_init(struct k_mem_slab *slab)
+{
+	ARG_UNUSED(slab);
+}
+#endif
+
+#ifdef CONFIG_MEM_SLAB_LOCKLESS
+/*
+ * The free list is a lock-free stack of blocks. Its head packs the index + 1
+ * of the first free block (0 if there is none) in its lower half, and a
+ * generation counter in its upper half. The counter is incremented on every
+ * push and pop, so that a compare-and-swap on a head that has been popped and
+ * pushed back in the meantime fails instead of corrupting the list (ABA
+ * problem). Each free block starts with the index + 1 of the next one.
+ */
+#define INDEX_MASK 0xffff
+#define GEN_INC (INDEX_MASK + 1)
+
+static inline char *block_get(struct k_mem_slab *slab, uint32_t index)
+{
+	return slab->buffer + (index - 1) * slab->block_size;
+}
+
+static inline uint32_t block_index(struct k_mem_slab *slab, char *block)
+{
+	return (block - slab->buffer) / slab->block_size + 1;
+}
+
+static inline atomic_val_t next_head(atomic_val_t head, uint32_t index)
+{
+	return (atomic_val_t)((((uint32_t)head + GEN_INC) & ~INDEX_MASK) |
+			      index);
+}
+
+static char *free_list_pop(struct k_mem_slab *slab)
+{
+	atomic_val_t head, next;
+	char *block;
+
+	do {
+		head = atomic_get(&slab->free_list);
+		if (!((uint32_t)head & INDEX_MASK)) {
+			return NULL;
+		}
+
+		block = block_get(slab, (uint32_t)head & INDEX_MASK);
+
+		/* garbage if the block was popped meanwhile: the CAS fails */
+		next = next_head(head, *(uint32_t *)block);
+	} while (!atomic_cas(&slab->free_list, head, next));
+
+	return block;
+}
+
+static void free_list_push(struct k_mem_slab *slab, char *block)
+{
+	atomic_val_t head;
+
+	do {
+		head = atomic_get(&slab->free_list);
+		*(uint32_t *)block = (uint32_t)head & INDEX_MASK;
+	} while (!atomic_cas(&slab->free_list, head,
+			     next_head(head, block_index(slab, block))));
+}
+
+/*
+ * Blocks never allocated are not on the free list: they are carved from the
+ * buffer in order, so that a slab needs no initialization at boot.
  *
- * @return N/A
+ * The mailbox and pipe asynchronous message descriptors are carved the same
+ * way, and initialized when carved. Their dummy thread requires minimal
+ * initialization, since it never gets to execute: the _THREAD_DUMMY flag is
+ * sufficient to distinguish it from a real one, and it is *not* added to
+ * the kernel's list of known threads.
  */
-static void create_free_list(struct k_mem_slab *slab)
+static char *block_carve(struct k_mem_slab *slab)
 {
-	uint32_t j;
-	char *p;
+	atomic_val_t carved;
 
-	slab->free_list = NULL;
-	p = slab->buffer;
+	__ASSERT(slab->num_blocks <= INDEX_MASK, "too many blocks\n");
+
+	do {
+		carved = atomic_get(&slab->num_carved);
+		if ((uint32_t)carved >= slab->num_blocks) {
+			return NULL;
+		}
+	} while (!atomic_cas(&slab->num_carved, carved, carved + 1));
 
-	for (j = 0; j < slab->num_blocks; j++) {
-		*(char **)p = slab->free_list;
-		slab->free_list = p;
-		p += slab->block_size;
+	return slab->buffer + (uint32_t)carved * slab->block_size;
+}
+
+static char *block_take(struct k_mem_slab *slab)
+{
+	char *block = free_list_pop(slab);
+
+	return block ? block : block_carve(slab);
+}
+#else
+/*
+ * Take a freed block, or else carve the next never allocated one from the
+ * buffer. Must be called with interrupts locked.
+ */
+static char *block_take(struct k_mem_slab *slab)
+{
+	char *block = slab->free_list;
+
+	if (block) {
+		slab->free_list = *(char **)block;
+		return block;
+	}
+
+	if (slab->num_carved < slab->num_blocks) {
+		return slab->buffer + slab->num_carved++ * slab->block_size;
 	}
+
+	return NULL;
 }
+#endif
 
-/**
- * @brief Complete initialization of statically defined memory slabs.
- *
- * Perform any initialization that wasn't done at build time.
- *
- * @return N/A
+#ifdef CONFIG_OBJECT_TRACING
+/*
+ * Complete initialization of statically defined memory slabs.
  */
 static int init_mem_slab_module(struct device *dev)
 {
@@ -58,7 +209,6 @@ static int init_mem_slab_module(struct device *dev)
 	for (slab = _k_mem_slab_list_start;
 	     slab < _k_mem_slab_list_end;
 	     slab++) {
-		create_free_list(slab);
 		SYS_TRACING_OBJ_INIT(k_mem_slab, slab);
 	}
 	return 0;
@@ -66,6 +216,7 @@ static int init_mem_slab_module(struct device *dev)
 
 SYS_INIT(init_mem_slab_module, PRE_KERNEL_1,
 	 CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
+#endif /* CONFIG_OBJECT_TRACING */
 
 void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 		    size_t block_size, uint32_t num_blocks)
@@ -73,25 +224,142 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 	slab->num_blocks = num_blocks;
 	slab->block_size = block_size;
 	slab->buffer = buffer;
+	slab->free_list = 0;
+	slab->num_carved = 0;
 	slab->num_used = 0;
-	create_free_list(slab);
+	stats_init(slab);
 	sys_dlist_init(&slab->wait_q);
 	SYS_TRACING_OBJ_INIT(k_mem_slab, slab);
 }
 
+#ifdef CONFIG_MEM_SLAB_LOCKLESS
+/* must be called with interrupts locked */
+static void give_to_waiter(struct k_thread *thread, void *block,
+			   unsigned int key)
+{
+	_set_thread_return_value_with_data(thread, 0, block);
+	_abort_thread_timeout(thread);
+	_ready_thread(thread);
+	if (_must_switch_threads()) {
+		_Swap(key);
+		return;
+	}
+
+	irq_unlock(key);
+}
+
+int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, int32_t timeout)
+{
+	char *block = block_take(slab);
+	unsigned int key;
+	int result;
+
+	if (block) {
+		stats_block_alloc(slab, atomic_inc(&slab->num_used) + 1);
+		*mem = block;
+		return 0;
+	}
+
+	if (timeout == K_NO_WAIT) {
+		/* don't wait for a free block to become available */
+		stats_alloc_failed(slab);
+		*mem = NULL;
+		return -ENOMEM;
+	}
+
+	key = irq_lock();
+
+	/* a block may have been freed since the list was found empty */
+	block = block_take(slab);
+	if (block) {
+		irq_unlock(key);
+		stats_block_alloc(slab, atomic_inc(&slab->num_used) + 1);
+		*mem = block;
+		return 0;
+	}
+
+	/*
+	 * Wait for a free block or timeout. A block freed from now on sees
+	 * this thread waiting and is handed to it.
+	 */
+	_pend_current_thread(&slab->wait_q, timeout);
+	result = _Swap(key);
+	if (result == 0) {
+		*mem = _current->base.swap_data;
+	} else {
+		stats_alloc_failed(slab);
+	}
+	return result;
+}
+
+void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
+{
+	struct k_thread *pending_thread;
+	unsigned int key;
+	char *block;
+
+	if (sys_dlist_is_empty(&slab->wait_q)) {
+		free_list_push(slab, *mem);
+		atomic_dec(&slab->num_used);
+
+		/*
+		 * A thread may have started waiting before the block was
+		 * back on the list, in which case it must be handed a block.
+		 */
+		if (sys_dlist_is_empty(&slab->wait_q)) {
+			return;
+		}
+
+		key = irq_lock();
+
+		block = free_list_pop(slab);
+		if (!block) {
+			/* someone else took it: it will see the waiter */
+			irq_unlock(key);
+			return;
+		}
+
+		pending_thread = _unpend_first_thread(&slab->wait_q);
+		if (!pending_thread) {
+			/* the waiter timed out meanwhile */
+			free_list_push(slab, block);
+			irq_unlock(key);
+			return;
+		}
+
+		stats_block_alloc(slab, atomic_inc(&slab->num_used) + 1);
+		give_to_waiter(pending_thread, block, key);
+		return;
+	}
+
+	key = irq_lock();
+
+	pending_thread = _unpend_first_thread(&slab->wait_q);
+	if (pending_thread) {
+		give_to_waiter(pending_thread, *mem, key);
+		return;
+	}
+
+	free_list_push(slab, *mem);
+	atomic_dec(&slab->num_used);
+
+	irq_unlock(key);
+}
+#else
 int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, int32_t timeout)
 {
 	unsigned int key = irq_lock();
+	char *block = block_take(slab);
 	int result;
 
-	if (slab->free_list != NULL) {
-		/* take a free block */
-		*mem = slab->free_list;
-		slab->free_list = *(char **)(slab->free_list);
+	if (block) {
+		*mem = block;
 		slab->num_used++;
+		stats_block_alloc(slab, slab->num_used);
 		result = 0;
 	} else if (timeout == K_NO_WAIT) {
 		/* don't wait for a free block to become available */
+		stats_alloc_failed(slab);
 		*mem = NULL;
 		result = -ENOMEM;
 	} else {
@@ -100,6 +368,8 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, int32_t timeout)
 		result = _Swap(key);
 		if (result == 0) {
 			*mem = _current->base.swap_data;
+		} else {
+			stats_alloc_failed(slab);
 		}
 		return result;
 	}
@@ -130,3 +400,4 @@ void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 
 	irq_unlock(key);
 }
+#endif /* CONFIG_MEM_SLAB_LOCKLESS */
@@ -57,9 +57,65 @@ void k_msgq_init(struct k_msgq *q, char *buffer,
 	q->write_ptr = buffer;
 	q->used_msgs = 0;
 	sys_dlist_init(&q->wait_q);
+
+	_INIT_OBJ_POLL_EVENT(q);
+
 	SYS_TRACING_OBJ_INIT(k_msgq, q);
 }
 
+/* returns 1 if a reschedule must take place, 0 otherwise */
+static inline int handle_poll_event(struct k_msgq *q)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_MSGQ_DATA_AVAILABLE;
+
+	return q->poll_event ?
+	       _handle_obj_poll_event(&q->poll_event, state) : 0;
+#else
+	return 0;
+#endif
+}
+
+/* must be called with interrupts locked and a free entry in the queue */
+static inline void ring_put(struct k_msgq *q, void *data)
+{
+	memcpy(q->write_ptr, data, q->msg_size);
+	q->write_ptr += q->msg_size;
+	if (q->write_ptr == q->buffer_end) {
+		q->write_ptr = q->buffer_start;
+	}
+	q->used_msgs++;
+}
+
+/* must be called with interrupts locked and a message in the queue */
+static inline void ring_get(struct k_msgq *q, void *data)
+{
+	memcpy(data, q->read_ptr, q->msg_size);
+	q->read_ptr += q->msg_size;
+	if (q->read_ptr == q->buffer_end) {
+		q->read_ptr = q->buffer_start;
+	}
+	q->used_msgs--;
+}
+
+/* must be called with interrupts locked */
+static inline void wake_pending_thread(struct k_thread *thread)
+{
+	_set_thread_return_value(thread, 0);
+	_abort_thread_timeout(thread);
+	_ready_thread(thread);
+}
+
+/* releases the interrupt lock, context switching if needed */
+static inline void reschedule(unsigned int key, int must_switch)
+{
+	if (must_switch || (!_is_in_isr() && _must_switch_threads())) {
+		_Swap(key);
+	} else {
+		irq_unlock(key);
+	}
+}
+
 int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout)
 {
 	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
@@ -76,21 +132,18 @@ int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout)
 			memcpy(pending_thread->base.swap_data, data,
 			       q->msg_size);
 			/* wake up waiting thread */
-			_set_thread_return_value(pending_thread, 0);
-			_abort_thread_timeout(pending_thread);
-			_ready_thread(pending_thread);
+			wake_pending_thread(pending_thread);
 			if (!_is_in_isr() && _must_switch_threads()) {
 				_Swap(key);
 				return 0;
 			}
 		} else {
 			/* put message in queue */
-			memcpy(q->write_ptr, data, q->msg_size);
-			q->write_ptr += q->msg_size;
-			if (q->write_ptr == q->buffer_end) {
-				q->write_ptr = q->buffer_start;
+			ring_put(q, data);
+			if (handle_poll_event(q)) {
+				_Swap(key);
+				return 0;
 			}
-			q->used_msgs++;
 		}
 		result = 0;
 	} else if (timeout == K_NO_WAIT) {
@@ -108,6 +161,52 @@ int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout)
 	return result;
 }
 
+int k_msgq_put_batch(struct k_msgq *q, void *data, uint32_t num_msgs,
+		     int32_t timeout)
+{
+	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
+
+	unsigned int key = irq_lock();
+	struct k_thread *pending_thread;
+	char *msg = data;
+	uint32_t num_put = 0;
+	int queued = 0;
+	int rc;
+
+	while (num_put < num_msgs && q->used_msgs < q->max_msgs) {
+		/* readers only wait on an empty queue: serve them first */
+		pending_thread = _unpend_first_thread(&q->wait_q);
+		if (pending_thread) {
+			memcpy(pending_thread->base.swap_data, msg,
+			       q->msg_size);
+			wake_pending_thread(pending_thread);
+		} else {
+			ring_put(q, msg);
+			queued = 1;
+		}
+		msg += q->msg_size;
+		num_put++;
+	}
+
+	if (num_put == 0 && num_msgs > 0) {
+		if (timeout == K_NO_WAIT) {
+			irq_unlock(key);
+			return -ENOMSG;
+		}
+
+		/* wait for space for the first message only */
+		_pend_current_thread(&q->wait_q, timeout);
+		_current->base.swap_data = data;
+		rc = _Swap(key);
+
+		return rc ? rc : 1;
+	}
+
+	reschedule(key, queued && handle_poll_event(q));
+
+	return num_put;
+}
+
 int k_msgq_get(struct k_msgq *q, void *data, int32_t timeout)
 {
 	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
@@ -118,29 +217,16 @@ int k_msgq_get(struct k_msgq *q, void *data, int32_t timeout)
 
 	if (q->used_msgs > 0) {
 		/* take first available message from queue */
-		memcpy(data, q->read_ptr, q->msg_size);
-		q->read_ptr += q->msg_size;
-		if (q->read_ptr == q->buffer_end) {
-			q->read_ptr = q->buffer_start;
-		}
-		q->used_msgs--;
+		ring_get(q, data);
 
 		/* handle first thread waiting to write (if any) */
 		pending_thread = _unpend_first_thread(&q->wait_q);
 		if (pending_thread) {
 			/* add thread's message to queue */
-			memcpy(q->write_ptr, pending_thread->base.swap_data,
-			       q->msg_size);
-			q->write_ptr += q->msg_size;
-			if (q->write_ptr == q->buffer_end) {
-				q->write_ptr = q->buffer_start;
-			}
-			q->used_msgs++;
+			ring_put(q, pending_thread->base.swap_data);
 
 			/* wake up waiting thread */
-			_set_thread_return_value(pending_thread, 0);
-			_abort_thread_timeout(pending_thread);
-			_ready_thread(pending_thread);
+			wake_pending_thread(pending_thread);
 			if (!_is_in_isr() && _must_switch_threads()) {
 				_Swap(key);
 				return 0;
@@ -162,6 +248,66 @@ int k_msgq_get(struct k_msgq *q, void *data, int32_t timeout)
 	return result;
 }
 
+int k_msgq_get_batch(struct k_msgq *q, void *data, uint32_t max_msgs,
+		     int32_t timeout)
+{
+	__ASSERT(!_is_in_isr() || timeout == K_NO_WAIT, "");
+
+	unsigned int key = irq_lock();
+	struct k_thread *pending_thread;
+	char *msg = data;
+	uint32_t num_got = 0;
+	int rc;
+
+	while (num_got < max_msgs && q->used_msgs > 0) {
+		ring_get(q, msg);
+		msg += q->msg_size;
+		num_got++;
+
+		/* writers only wait on a full queue: refill the free entry */
+		pending_thread = _unpend_first_thread(&q->wait_q);
+		if (pending_thread) {
+			ring_put(q, pending_thread->base.swap_data);
+			wake_pending_thread(pending_thread);
+		}
+	}
+
+	if (num_got == 0 && max_msgs > 0) {
+		if (timeout == K_NO_WAIT) {
+			irq_unlock(key);
+			return -ENOMSG;
+		}
+
+		/* wait for the first message only */
+		_pend_current_thread(&q->wait_q, timeout);
+		_current->base.swap_data = data;
+		rc = _Swap(key);
+
+		return rc ? rc : 1;
+	}
+
+	reschedule(key, 0);
+
+	return num_got;
+}
+
+int k_msgq_peek(struct k_msgq *q, void *data)
+{
+	unsigned int key = irq_lock();
+	int result;
+
+	if (q->used_msgs > 0) {
+		memcpy(data, q->read_ptr, q->msg_size);
+		result = 0;
+	} else {
+		result = -ENOMSG;
+	}
+
+	irq_unlock(key);
+
+	return result;
+}
+
 void k_msgq_purge(struct k_msgq *q)
 {
 	unsigned int key = irq_lock();
@@ -11,7 +11,13 @@
  *
  * Mutexes implement a priority inheritance algorithm that boosts the priority
  * level of the owning thread to match the priority level of the highest
- * priority thread waiting on the mutex.
+ * priority thread waiting on the mutex. Inheritance is transitive: if the
+ * owner is itself waiting on another mutex, the owner of that mutex is boosted
+ * as well, and so on down the chain.
+ *
+ * Optionally, a mutex can have a priority ceiling, in which case its owner
+ * runs at least at the ceiling priority for as long as it holds the mutex
+ * (immediate priority ceiling protocol).
  *
  * Each mutex that contributes to priority inheritance must be released in the
  * reverse order in which is was acquired.  Furthermore each subsequent mutex
@@ -36,7 +42,7 @@
 #include <errno.h>
 #include <init.h>
 
-#ifdef CONFIG_OBJECT_MONITOR
+#ifdef CONFIG_MUTEX_STATS
 #define RECORD_STATE_CHANGE(mutex) \
 	do { (mutex)->num_lock_state_changes++; } while ((0))
 #define RECORD_CONFLICT(mutex) \
@@ -46,13 +52,20 @@
 #define RECORD_CONFLICT(mutex) do { } while ((0))
 #endif
 
-#ifdef CONFIG_OBJECT_MONITOR
-#define INIT_OBJECT_MONITOR(mutex) do { \
+#ifdef CONFIG_MUTEX_STATS
+#define INIT_MUTEX_STATS(mutex) do { \
 	mutex->num_lock_state_changes = 0; \
 	mutex->num_conflicts = 0; \
 	} while ((0))
 #else
-#define INIT_OBJECT_MONITOR(mutex) do { } while ((0))
+#define INIT_MUTEX_STATS(mutex) do { } while ((0))
+#endif
+
+#ifdef CONFIG_MUTEX_PRIO_CEILING
+#define INIT_PRIO_CEILING(mutex) \
+	do { mutex->ceiling = K_LOWEST_THREAD_PRIO; } while ((0))
+#else
+#define INIT_PRIO_CEILING(mutex) do { } while ((0))
 #endif
 
 extern struct k_mutex _k_mutex_list_start[];
@@ -92,8 +105,18 @@ void k_mutex_init(struct k_mutex *mutex)
 	sys_dlist_init(&mutex->wait_q);
 
 	SYS_TRACING_OBJ_INIT(k_mutex, mutex);
-	INIT_OBJECT_MONITOR(mutex);
+	INIT_MUTEX_STATS(mutex);
+	INIT_PRIO_CEILING(mutex);
+}
+
+#ifdef CONFIG_MUTEX_PRIO_CEILING
+void k_mutex_ceiling_set(struct k_mutex *mutex, int prio)
+{
+	__ASSERT(mutex->lock_count == 0, "mutex is locked\n");
+
+	mutex->ceiling = prio;
 }
+#endif
 
 static int new_prio_for_inheritance(int target, int limit)
 {
@@ -104,6 +127,18 @@ static int new_prio_for_inheritance(int target, int limit)
 	return new_prio;
 }
 
+/* priority of the owner of a mutex without any waiter */
+static int owner_base_prio(struct k_mutex *mutex)
+{
+#ifdef CONFIG_MUTEX_PRIO_CEILING
+	if (_is_prio_higher(mutex->ceiling, mutex->owner_orig_prio)) {
+		return mutex->ceiling;
+	}
+#endif
+
+	return mutex->owner_orig_prio;
+}
+
 static void adjust_owner_prio(struct k_mutex *mutex, int new_prio)
 {
 	if (mutex->owner->base.prio != new_prio) {
@@ -117,15 +152,104 @@ static void adjust_owner_prio(struct k_mutex *mutex, int new_prio)
 	}
 }
 
+/*
+ * Re-sort a thread whose priority has changed in the prioritized wait queue of
+ * the mutex it is waiting on.
+ *
+ * Must be called with interrupts locked.
+ */
+static void requeue_waiter(struct k_mutex *mutex, struct k_thread *thread)
+{
+	_wait_q_remove(thread);
+	_wait_q_insert(&mutex->wait_q, thread);
+}
+
+/*
+ * Find the mutex the owner of 'mutex' is waiting on, if any, after having
+ * re-sorted the owner in its wait queue to account for a priority change.
+ *
+ * Must be called with interrupts locked.
+ */
+static struct k_mutex *next_in_chain(struct k_mutex *mutex)
+{
+	struct k_thread *owner = mutex->owner;
+	struct k_mutex *next = owner->base.pended_on_mutex;
+
+	/* a thread that timed out is not pending anymore */
+	if (!next || !_is_thread_pending(owner)) {
+		return NULL;
+	}
+
+	requeue_waiter(next, owner);
+
+	return next;
+}
+
+/*
+ * Boost the owner of 'mutex' to priority 'prio', then the owner of the mutex
+ * that owner is waiting on, if any, and so on. Stops as soon as an owner
+ * already runs at 'prio' or higher, which also ends the walk if the chain
+ * loops back on itself, i.e. if there is a deadlock.
+ *
+ * Must be called with interrupts locked.
+ */
+static void inherit_prio(struct k_mutex *mutex, int prio)
+{
+	while (mutex) {
+		int new_prio = new_prio_for_inheritance(prio,
+						mutex->owner->base.prio);
+
+		if (!_is_prio_higher(new_prio, mutex->owner->base.prio)) {
+			return;
+		}
+
+		K_DEBUG("adjusting prio up on mutex %p\n", mutex);
+
+		adjust_owner_prio(mutex, new_prio);
+		mutex = next_in_chain(mutex);
+	}
+}
+
+/*
+ * Recompute the priority of the owner of 'mutex' from its remaining waiters
+ * after one of them stopped waiting, and do the same down the chain of
+ * mutexes the owners are waiting on, for as long as priorities change.
+ *
+ * Must be called with interrupts locked.
+ */
+static void disinherit_prio(struct k_mutex *mutex)
+{
+	/* the mutex may have been released since the waiter timed out */
+	while (mutex && mutex->owner) {
+		struct k_thread *waiter =
+			(struct k_thread *)sys_dlist_peek_head(&mutex->wait_q);
+		int new_prio = owner_base_prio(mutex);
+
+		if (waiter) {
+			new_prio = new_prio_for_inheritance(waiter->base.prio,
+							    new_prio);
+		}
+
+		if (new_prio == mutex->owner->base.prio) {
+			return;
+		}
+
+		K_DEBUG("adjusting prio down on mutex %p\n", mutex);
+
+		adjust_owner_prio(mutex, new_prio);
+		mutex = next_in_chain(mutex);
+	}
+}
+
 int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 {
-	int new_prio, key;
+	int key;
 
 	_sched_lock();
 
 	if (likely(mutex->lock_count == 0 || mutex->owner == _current)) {
 
-		RECORD_STATE_CHANGE();
+		RECORD_STATE_CHANGE(mutex);
 
 		mutex->owner_orig_prio = mutex->lock_count == 0 ?
 					_current->base.prio :
@@ -134,6 +258,14 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 		mutex->lock_count++;
 		mutex->owner = _current;
 
+#ifdef CONFIG_MUTEX_PRIO_CEILING
+		if (mutex->lock_count == 1) {
+			key = irq_lock();
+			adjust_owner_prio(mutex, owner_base_prio(mutex));
+			irq_unlock(key);
+		}
+#endif
+
 		K_DEBUG("%p took mutex %p, count: %d, orig prio: %d\n",
 			_current, mutex, mutex->lock_count,
 			mutex->owner_orig_prio);
@@ -143,34 +275,24 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 		return 0;
 	}
 
-	RECORD_CONFLICT();
+	RECORD_CONFLICT(mutex);
 
 	if (unlikely(timeout == K_NO_WAIT)) {
 		k_sched_unlock();
 		return -EBUSY;
 	}
 
-#if 0
-	if (_is_prio_higher(_current->prio, mutex->owner->prio)) {
-		new_prio = _current->prio;
-	}
-	new_prio = _get_new_prio_with_ceiling(new_prio);
-#endif
-	new_prio = new_prio_for_inheritance(_current->base.prio,
-					    mutex->owner->base.prio);
-
 	key = irq_lock();
 
-	K_DEBUG("adjusting prio up on mutex %p\n", mutex);
-
-	if (_is_prio_higher(new_prio, mutex->owner->base.prio)) {
-		adjust_owner_prio(mutex, new_prio);
-	}
+	inherit_prio(mutex, _current->base.prio);
 
 	_pend_current_thread(&mutex->wait_q, timeout);
+	_current->base.pended_on_mutex = mutex;
 
 	int got_mutex = _Swap(key);
 
+	_current->base.pended_on_mutex = NULL;
+
 	K_DEBUG("on mutex %p got_mutex value: %d\n", mutex, got_mutex);
 
 	K_DEBUG("%p got mutex %p (y/n): %c\n", _current, mutex,
@@ -185,17 +307,8 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 
 	K_DEBUG("%p timeout on mutex %p\n", _current, mutex);
 
-	struct k_thread *waiter =
-		(struct k_thread *)sys_dlist_peek_head(&mutex->wait_q);
-
-	new_prio = mutex->owner_orig_prio;
-	new_prio = waiter ? new_prio_for_inheritance(waiter->base.prio,
-						     new_prio) : new_prio;
-
-	K_DEBUG("adjusting prio down on mutex %p\n", mutex);
-
 	key = irq_lock();
-	adjust_owner_prio(mutex, new_prio);
+	disinherit_prio(mutex);
 	irq_unlock(key);
 
 	k_sched_unlock();
@@ -212,7 +325,7 @@ void k_mutex_unlock(struct k_mutex *mutex)
 
 	_sched_lock();
 
-	RECORD_STATE_CHANGE();
+	RECORD_STATE_CHANGE(mutex);
 
 	mutex->lock_count--;
 
@@ -234,20 +347,23 @@ void k_mutex_unlock(struct k_mutex *mutex)
 
 	if (new_owner) {
 		_abort_thread_timeout(new_owner);
-		_ready_thread(new_owner);
-
-		irq_unlock(key);
-
-		_set_thread_return_value(new_owner, 0);
+		new_owner->base.pended_on_mutex = NULL;
 
 		/*
 		 * new owner is already of higher or equal prio than first
 		 * waiter since the wait queue is priority-based: no need to
-		 * ajust its priority
+		 * ajust its priority, except to apply the mutex's ceiling
 		 */
 		mutex->owner = new_owner;
 		mutex->lock_count++;
 		mutex->owner_orig_prio = new_owner->base.prio;
+		adjust_owner_prio(mutex, owner_base_prio(mutex));
+
+		_ready_thread(new_owner);
+
+		irq_unlock(key);
+
+		_set_thread_return_value(new_owner, 0);
 	} else {
 		irq_unlock(key);
 		mutex->owner = NULL;
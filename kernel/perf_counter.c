@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief hardware performance counters
+ *
+ * The architecture programs the hardware counters and reads their raw
+ * values, which wrap at the counter width. The counts are accumulated from
+ * the raw values into 64-bit counts, sampling the counters on each read and,
+ * with PERF_COUNTER_THREAD, on each context switch to charge the outgoing
+ * thread for the events which occurred while it ran.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <nano_internal.h>
+#include <perf_counter.h>
+#include <string.h>
+#include <errno.h>
+
+/* events counted, raw counts at the last sample and totals */
+static uint32_t perf_events;
+static uint32_t perf_last[PERF_EVENT_COUNT];
+static struct perf_counter_values perf_total;
+
+/* Must be called with interrupts locked */
+static void perf_counter_sample(uint64_t *charge)
+{
+	uint32_t events = perf_events;
+	uint32_t raw, delta;
+	int event;
+
+	while (events) {
+		event = find_lsb_set(events) - 1;
+		events &= ~PERF_EVENT_BIT(event);
+
+		raw = _arch_perf_counter_read(event);
+		delta = (raw - perf_last[event]) &
+			_arch_perf_counter_mask(event);
+		perf_last[event] = raw;
+
+		perf_total.count[event] += delta;
+		if (charge) {
+			charge[event] += delta;
+		}
+	}
+}
+
+#ifdef CONFIG_PERF_COUNTER_THREAD
+#define perf_counter_current() (_current->perf_counts)
+
+/*
+ * Called by the architecture's context switch code, with interrupts locked,
+ * while _current is still the outgoing thread.
+ */
+void _perf_counter_switch(void)
+{
+	if (perf_events) {
+		perf_counter_sample(_current->perf_counts);
+	}
+}
+
+void perf_counter_thread_read(k_tid_t thread,
+			      struct perf_counter_values *values)
+{
+	unsigned int key = irq_lock();
+
+	/* the current thread has not been charged for its ongoing run */
+	if (thread == _current) {
+		perf_counter_sample(thread->perf_counts);
+	}
+
+	memcpy(values->count, thread->perf_counts, sizeof(values->count));
+
+	irq_unlock(key);
+}
+#else
+#define perf_counter_current() NULL
+#endif /* CONFIG_PERF_COUNTER_THREAD */
+
+uint32_t perf_counter_events(void)
+{
+	return _arch_perf_counter_events();
+}
+
+int perf_counter_start(uint32_t events)
+{
+	unsigned int key;
+	int event, ret;
+
+	if (events & ~_arch_perf_counter_events()) {
+		return -ENOTSUP;
+	}
+
+	key = irq_lock();
+
+	/* charge the events counted so far before replacing them */
+	perf_counter_sample(perf_counter_current());
+
+	ret = _arch_perf_counter_start(events);
+	if (ret) {
+		perf_events = 0;
+		irq_unlock(key);
+		return ret;
+	}
+
+	perf_events = events;
+
+	for (event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (events & PERF_EVENT_BIT(event)) {
+			perf_total.count[event] = 0;
+			perf_last[event] = _arch_perf_counter_read(event);
+		}
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+void perf_counter_stop(void)
+{
+	unsigned int key = irq_lock();
+
+	perf_counter_sample(perf_counter_current());
+
+	_arch_perf_counter_stop();
+	perf_events = 0;
+
+	irq_unlock(key);
+}
+
+void perf_counter_read(struct perf_counter_values *values)
+{
+	unsigned int key = irq_lock();
+
+	perf_counter_sample(perf_counter_current());
+
+	*values = perf_total;
+
+	irq_unlock(key);
+}
@@ -18,9 +18,16 @@
 #include <wait_q.h>
 #include <misc/dlist.h>
 #include <init.h>
+#include <string.h>
+#ifdef CONFIG_DMA_MEMCPY_PIPES
+#include <dma.h>
+#endif
 
 struct k_pipe_desc {
-	unsigned char *buffer;           /* Position in src/dest buffer */
+	unsigned char *buffer;           /* Position in current segment */
+	size_t seg_bytes;                /* # bytes left in current segment */
+	const struct k_pipe_iov *iov;    /* Segments following this one */
+	int iov_count;                   /* # segments following this one */
 	size_t bytes_to_xfer;            /* # bytes left to transfer */
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
 	struct k_mem_block *block;       /* Pointer to memory block */
@@ -44,12 +51,28 @@ struct k_pipe *_trace_list_k_pipe;
 /* Array of asynchronous message descriptors */
 static struct k_pipe_async __noinit async_msg[CONFIG_NUM_PIPE_ASYNC_MSGS];
 
-/* stack of unused asynchronous message descriptors */
+/* stack of freed asynchronous message descriptors */
 K_STACK_DEFINE(pipe_async_msgs, CONFIG_NUM_PIPE_ASYNC_MSGS);
 
+/* number of descriptors at the start of the array ever allocated */
+static int async_msg_carved;
+
 /* Allocate an asynchronous message descriptor */
 static void _pipe_async_alloc(struct k_pipe_async **async)
 {
+	unsigned int key = irq_lock();
+
+	/* carved in order, see block_carve() in mem_slab.c */
+	if (async_msg_carved < CONFIG_NUM_PIPE_ASYNC_MSGS) {
+		*async = &async_msg[async_msg_carved++];
+		irq_unlock(key);
+		(*async)->thread.thread_state = _THREAD_DUMMY;
+		(*async)->thread.swap_data = &(*async)->desc;
+		return;
+	}
+
+	irq_unlock(key);
+
 	k_stack_pop(&pipe_async_msgs, (uint32_t *)async, K_FOREVER);
 }
 
@@ -77,52 +100,27 @@ static void _pipe_async_finish(struct k_pipe_async *async_desc)
 }
 #endif /* CONFIG_NUM_PIPE_ASYNC_MSGS > 0 */
 
-#if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0) || \
-	defined(CONFIG_OBJECT_TRACING)
+#ifdef CONFIG_OBJECT_TRACING
 
 /*
- * Do run-time initialization of pipe object subsystem.
+ * Complete initialization of statically defined pipes.
  */
 static int init_pipes_module(struct device *dev)
 {
 	ARG_UNUSED(dev);
 
-#if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
-	/*
-	 * Create pool of asynchronous pipe message descriptors.
-	 *
-	 * A dummy thread requires minimal initialization, since it never gets
-	 * to execute. The _THREAD_DUMMY flag is sufficient to distinguish a
-	 * dummy thread from a real one. The threads are *not* added to the
-	 * kernel's list of known threads.
-	 *
-	 * Once initialized, the address of each descriptor is added to a stack
-	 * that governs access to them.
-	 */
-
-	for (int i = 0; i < CONFIG_NUM_PIPE_ASYNC_MSGS; i++) {
-		async_msg[i].thread.thread_state = _THREAD_DUMMY;
-		async_msg[i].thread.swap_data = &async_msg[i].desc;
-		k_stack_push(&pipe_async_msgs, (uint32_t)&async_msg[i]);
-	}
-#endif /* CONFIG_NUM_PIPE_ASYNC_MSGS > 0 */
-
-	/* Complete initialization of statically defined mailboxes. */
-
-#ifdef CONFIG_OBJECT_TRACING
 	struct k_pipe *pipe;
 
 	for (pipe = _k_pipe_list_start; pipe < _k_pipe_list_end; pipe++) {
 		SYS_TRACING_OBJ_INIT(k_pipe, pipe);
 	}
-#endif /* CONFIG_OBJECT_TRACING */
 
 	return 0;
 }
 
 SYS_INIT(init_pipes_module, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
-#endif /* CONFIG_NUM_PIPE_ASYNC_MSGS or CONFIG_OBJECT_TRACING */
+#endif /* CONFIG_OBJECT_TRACING */
 
 void k_pipe_init(struct k_pipe *pipe, unsigned char *buffer, size_t size)
 {
@@ -137,50 +135,110 @@ void k_pipe_init(struct k_pipe *pipe, unsigned char *buffer, size_t size)
 }
 
 /**
- * @brief Copy bytes from @a src to @a dest
+ * @brief Consume @a num_bytes bytes of the data described by @a desc
+ *
+ * Moves to the next non-empty segment once the current one is exhausted.
+ *
+ * @return N/A
+ */
+static void _pipe_desc_advance(struct k_pipe_desc *desc, size_t num_bytes)
+{
+	desc->buffer        += num_bytes;
+	desc->seg_bytes     -= num_bytes;
+	desc->bytes_to_xfer -= num_bytes;
+
+	while ((desc->seg_bytes == 0) && (desc->iov_count > 0)) {
+		desc->buffer    = desc->iov->data;
+		desc->seg_bytes = desc->iov->len;
+		desc->iov++;
+		desc->iov_count--;
+	}
+}
+
+/**
+ * @brief Describe a single contiguous buffer
+ *
+ * @return N/A
+ */
+static void _pipe_desc_init(struct k_pipe_desc *desc, void *data, size_t size)
+{
+	desc->buffer        = data;
+	desc->seg_bytes     = size;
+	desc->iov           = NULL;
+	desc->iov_count     = 0;
+	desc->bytes_to_xfer = size;
+}
+
+/**
+ * @brief Describe a list of buffer segments
+ *
+ * @return N/A
+ */
+static void _pipe_desc_init_iov(struct k_pipe_desc *desc,
+				const struct k_pipe_iov *iov, int iov_count)
+{
+	_pipe_desc_init(desc, NULL, 0);
+
+	desc->iov       = iov;
+	desc->iov_count = iov_count;
+	for (int i = 0; i < iov_count; i++) {
+		desc->bytes_to_xfer += iov[i].len;
+	}
+
+	_pipe_desc_advance(desc, 0);
+}
+
+/**
+ * @brief Copy bytes from the data described by @a src to the buffers
+ * described by @a dest
+ *
+ * Both descriptors are advanced past the bytes copied.
  *
  * @return Number of bytes copied
  */
-static size_t _pipe_xfer(unsigned char *dest, size_t dest_size,
-			 const unsigned char *src, size_t src_size)
+static size_t _pipe_xfer(struct k_pipe_desc *dest, struct k_pipe_desc *src)
 {
-	size_t num_bytes = min(dest_size, src_size);
-	const unsigned char *end = src + num_bytes;
+	size_t num_bytes = 0;
+	size_t run_length;
+
+	while ((dest->bytes_to_xfer != 0) && (src->bytes_to_xfer != 0)) {
+		run_length = min(dest->seg_bytes, src->seg_bytes);
+
+#ifdef CONFIG_DMA_MEMCPY_PIPES
+		dma_memcpy_sys(dest->buffer, src->buffer, run_length);
+#else
+		memcpy(dest->buffer, src->buffer, run_length);
+#endif
 
-	while (src != end) {
-		*dest = *src;
-		dest++;
-		src++;
+		_pipe_desc_advance(dest, run_length);
+		_pipe_desc_advance(src, run_length);
+		num_bytes += run_length;
 	}
 
 	return num_bytes;
 }
 
 /**
- * @brief Put data from @a src into the pipe's circular buffer
+ * @brief Put data described by @a src into the pipe's circular buffer
  *
  * Modifies the following fields in @a pipe:
  *        buffer, bytes_used, write_index
  *
  * @return Number of bytes written to the pipe's circular buffer
  */
-static size_t _pipe_buffer_put(struct k_pipe *pipe,
-			       const unsigned char *src, size_t src_size)
+static size_t _pipe_buffer_put(struct k_pipe *pipe, struct k_pipe_desc *src)
 {
+	struct k_pipe_desc dest;
 	size_t  bytes_copied;
-	size_t  run_length;
 	size_t  num_bytes_written = 0;
 	int     i;
 
-
 	for (i = 0; i < 2; i++) {
-		run_length = min(pipe->size - pipe->bytes_used,
-				 pipe->size - pipe->write_index);
+		_pipe_desc_init(&dest, pipe->buffer + pipe->write_index,
+				min(pipe->size - pipe->bytes_used,
+				    pipe->size - pipe->write_index));
 
-		bytes_copied = _pipe_xfer(pipe->buffer + pipe->write_index,
-					  run_length,
-					  src + num_bytes_written,
-					  src_size - num_bytes_written);
+		bytes_copied = _pipe_xfer(&dest, src);
 
 		num_bytes_written += bytes_copied;
 		pipe->bytes_used += bytes_copied;
@@ -194,29 +252,27 @@ static size_t _pipe_buffer_put(struct k_pipe *pipe,
 }
 
 /**
- * @brief Get data from the pipe's circular buffer
+ * @brief Get data from the pipe's circular buffer into the buffers
+ * described by @a dest
  *
  * Modifies the following fields in @a pipe:
  *        bytes_used, read_index
  *
  * @return Number of bytes read from the pipe's circular buffer
  */
-static size_t _pipe_buffer_get(struct k_pipe *pipe,
-			       unsigned char *dest, size_t dest_size)
+static size_t _pipe_buffer_get(struct k_pipe *pipe, struct k_pipe_desc *dest)
 {
+	struct k_pipe_desc src;
 	size_t  bytes_copied;
-	size_t  run_length;
 	size_t  num_bytes_read = 0;
 	int     i;
 
 	for (i = 0; i < 2; i++) {
-		run_length = min(pipe->bytes_used,
-				 pipe->size - pipe->read_index);
+		_pipe_desc_init(&src, pipe->buffer + pipe->read_index,
+				min(pipe->bytes_used,
+				    pipe->size - pipe->read_index));
 
-		bytes_copied = _pipe_xfer(dest + num_bytes_read,
-					  dest_size - num_bytes_read,
-					  pipe->buffer + pipe->read_index,
-					  run_length);
+		bytes_copied = _pipe_xfer(dest, &src);
 
 		num_bytes_read += bytes_copied;
 		pipe->bytes_used -= bytes_copied;
@@ -380,18 +436,20 @@ static void _pipe_thread_ready(struct k_thread *thread)
 
 /**
  * @brief Internal API used to send data to a pipe
+ *
+ * The data to send is described by @a desc, which is advanced as the data is
+ * consumed. If the writer has to wait, the waiting readers copy the data
+ * directly from @a desc.
  */
 int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
-			 unsigned char *data, size_t bytes_to_write,
-			 size_t *bytes_written, size_t min_xfer,
-			 int32_t timeout)
+			 struct k_pipe_desc *desc, size_t *bytes_written,
+			 size_t min_xfer, int32_t timeout)
 {
 	struct k_thread    *reader;
-	struct k_pipe_desc *desc;
+	struct k_pipe_desc *reader_desc;
 	sys_dlist_t    xfer_list;
 	unsigned int   key;
-	size_t         num_bytes_written = 0;
-	size_t         bytes_copied;
+	size_t         bytes_to_write = desc->bytes_to_xfer;
 
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS == 0)
 	ARG_UNUSED(async_desc);
@@ -430,14 +488,8 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 	struct k_thread *thread = (struct k_thread *)
 				  sys_dlist_get(&xfer_list);
 	while (thread) {
-		desc = (struct k_pipe_desc *)thread->base.swap_data;
-		bytes_copied = _pipe_xfer(desc->buffer, desc->bytes_to_xfer,
-					  data + num_bytes_written,
-					  bytes_to_write - num_bytes_written);
-
-		num_bytes_written   += bytes_copied;
-		desc->buffer        += bytes_copied;
-		desc->bytes_to_xfer -= bytes_copied;
+		reader_desc = (struct k_pipe_desc *)thread->base.swap_data;
+		(void)_pipe_xfer(reader_desc, desc);
 
 		/* The thread's read request has been satisfied. Ready it. */
 		key = irq_lock();
@@ -452,14 +504,8 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 	 * It is possible no data will be copied.
 	 */
 	if (reader) {
-		desc = (struct k_pipe_desc *)reader->base.swap_data;
-		bytes_copied = _pipe_xfer(desc->buffer, desc->bytes_to_xfer,
-					  data + num_bytes_written,
-					  bytes_to_write - num_bytes_written);
-
-		num_bytes_written   += bytes_copied;
-		desc->buffer        += bytes_copied;
-		desc->bytes_to_xfer -= bytes_copied;
+		reader_desc = (struct k_pipe_desc *)reader->base.swap_data;
+		(void)_pipe_xfer(reader_desc, desc);
 	}
 
 	/*
@@ -467,12 +513,10 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 	 * readers. Add as much as possible to the pipe's circular buffer.
 	 */
 
-	num_bytes_written +=
-		_pipe_buffer_put(pipe, data + num_bytes_written,
-				 bytes_to_write - num_bytes_written);
+	(void)_pipe_buffer_put(pipe, desc);
 
-	if (num_bytes_written == bytes_to_write) {
-		*bytes_written = num_bytes_written;
+	if (desc->bytes_to_xfer == 0) {
+		*bytes_written = bytes_to_write;
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
 		if (async_desc != NULL) {
 			_pipe_async_finish(async_desc);
@@ -499,13 +543,8 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 	}
 #endif
 
-	struct k_pipe_desc  pipe_desc;
-
-	pipe_desc.buffer         = data + num_bytes_written;
-	pipe_desc.bytes_to_xfer  = bytes_to_write - num_bytes_written;
-
 	if (timeout != K_NO_WAIT) {
-		_current->base.swap_data = &pipe_desc;
+		_current->base.swap_data = desc;
 		/*
 		 * Lock interrupts and unlock the scheduler before
 		 * manipulating the writers wait_q.
@@ -518,24 +557,28 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 		k_sched_unlock();
 	}
 
-	*bytes_written = bytes_to_write - pipe_desc.bytes_to_xfer;
+	*bytes_written = bytes_to_write - desc->bytes_to_xfer;
 
-	return _pipe_return_code(min_xfer, pipe_desc.bytes_to_xfer,
+	return _pipe_return_code(min_xfer, desc->bytes_to_xfer,
 				 bytes_to_write);
 }
 
-int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
-	       size_t *bytes_read, size_t min_xfer, int32_t timeout)
+/**
+ * @brief Internal API used to receive data from a pipe
+ *
+ * The buffers to fill are described by @a desc, which is advanced as they are
+ * filled. If the reader has to wait, the writers copy their data directly into
+ * the buffers described by @a desc.
+ */
+static int _k_pipe_get_internal(struct k_pipe *pipe, struct k_pipe_desc *desc,
+				size_t *bytes_read, size_t min_xfer,
+				int32_t timeout)
 {
 	struct k_thread    *writer;
-	struct k_pipe_desc *desc;
+	struct k_pipe_desc *writer_desc;
 	sys_dlist_t    xfer_list;
 	unsigned int   key;
-	size_t         num_bytes_read = 0;
-	size_t         bytes_copied;
-
-	__ASSERT(min_xfer <= bytes_to_read, "");
-	__ASSERT(bytes_read != NULL, "");
+	size_t         bytes_to_read = desc->bytes_to_xfer;
 
 	key = irq_lock();
 
@@ -555,7 +598,7 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 	_sched_lock();
 	irq_unlock(key);
 
-	num_bytes_read = _pipe_buffer_get(pipe, data, bytes_to_read);
+	(void)_pipe_buffer_get(pipe, desc);
 
 	/*
 	 * 1. 'xfer_list' currently contains a list of writer threads that can
@@ -573,15 +616,9 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 
 	struct k_thread *thread = (struct k_thread *)
 				  sys_dlist_get(&xfer_list);
-	while (thread && (num_bytes_read < bytes_to_read)) {
-		desc = (struct k_pipe_desc *)thread->base.swap_data;
-		bytes_copied = _pipe_xfer(data + num_bytes_read,
-					  bytes_to_read - num_bytes_read,
-					  desc->buffer, desc->bytes_to_xfer);
-
-		num_bytes_read       += bytes_copied;
-		desc->buffer         += bytes_copied;
-		desc->bytes_to_xfer  -= bytes_copied;
+	while (thread && (desc->bytes_to_xfer != 0)) {
+		writer_desc = (struct k_pipe_desc *)thread->base.swap_data;
+		(void)_pipe_xfer(desc, writer_desc);
 
 		/*
 		 * It is expected that the write request will be satisfied.
@@ -589,7 +626,7 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 		 * write request was satisfied, then the write request must
 		 * finish later when writing to the pipe's circular buffer.
 		 */
-		if (num_bytes_read == bytes_to_read) {
+		if (desc->bytes_to_xfer == 0) {
 			break;
 		}
 		_pipe_thread_ready(thread);
@@ -597,15 +634,9 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 		thread = (struct k_thread *)sys_dlist_get(&xfer_list);
 	}
 
-	if (writer && (num_bytes_read < bytes_to_read)) {
-		desc = (struct k_pipe_desc *)writer->base.swap_data;
-		bytes_copied = _pipe_xfer(data + num_bytes_read,
-					  bytes_to_read - num_bytes_read,
-					  desc->buffer, desc->bytes_to_xfer);
-
-		num_bytes_read       += bytes_copied;
-		desc->buffer         += bytes_copied;
-		desc->bytes_to_xfer  -= bytes_copied;
+	if (writer && (desc->bytes_to_xfer != 0)) {
+		writer_desc = (struct k_pipe_desc *)writer->base.swap_data;
+		(void)_pipe_xfer(desc, writer_desc);
 	}
 
 	/*
@@ -614,12 +645,8 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 	 */
 
 	while (thread) {
-		desc = (struct k_pipe_desc *)thread->base.swap_data;
-		bytes_copied = _pipe_buffer_put(pipe, desc->buffer,
-						desc->bytes_to_xfer);
-
-		desc->buffer         += bytes_copied;
-		desc->bytes_to_xfer  -= bytes_copied;
+		writer_desc = (struct k_pipe_desc *)thread->base.swap_data;
+		(void)_pipe_buffer_put(pipe, writer_desc);
 
 		/* Write request has been satsified */
 		_pipe_thread_ready(thread);
@@ -628,31 +655,22 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 	}
 
 	if (writer) {
-		desc = (struct k_pipe_desc *)writer->base.swap_data;
-		bytes_copied = _pipe_buffer_put(pipe, desc->buffer,
-						desc->bytes_to_xfer);
-
-		desc->buffer         += bytes_copied;
-		desc->bytes_to_xfer  -= bytes_copied;
+		writer_desc = (struct k_pipe_desc *)writer->base.swap_data;
+		(void)_pipe_buffer_put(pipe, writer_desc);
 	}
 
-	if (num_bytes_read == bytes_to_read) {
+	if (desc->bytes_to_xfer == 0) {
 		k_sched_unlock();
 
-		*bytes_read = num_bytes_read;
+		*bytes_read = bytes_to_read;
 
 		return 0;
 	}
 
 	/* Not all data was read. */
 
-	struct k_pipe_desc  pipe_desc;
-
-	pipe_desc.buffer        = data + num_bytes_read;
-	pipe_desc.bytes_to_xfer = bytes_to_read - num_bytes_read;
-
 	if (timeout != K_NO_WAIT) {
-		_current->base.swap_data = &pipe_desc;
+		_current->base.swap_data = desc;
 		key = irq_lock();
 		_sched_unlock_no_reschedule();
 		_pend_current_thread(&pipe->wait_q.readers, timeout);
@@ -661,20 +679,69 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 		k_sched_unlock();
 	}
 
-	*bytes_read = bytes_to_read - pipe_desc.bytes_to_xfer;
+	*bytes_read = bytes_to_read - desc->bytes_to_xfer;
 
-	return _pipe_return_code(min_xfer, pipe_desc.bytes_to_xfer,
+	return _pipe_return_code(min_xfer, desc->bytes_to_xfer,
 				 bytes_to_read);
 }
 
+int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
+	       size_t *bytes_read, size_t min_xfer, int32_t timeout)
+{
+	struct k_pipe_desc desc;
+
+	__ASSERT(min_xfer <= bytes_to_read, "");
+	__ASSERT(bytes_read != NULL, "");
+
+	_pipe_desc_init(&desc, data, bytes_to_read);
+
+	return _k_pipe_get_internal(pipe, &desc, bytes_read, min_xfer,
+				    timeout);
+}
+
+int k_pipe_get_iov(struct k_pipe *pipe, const struct k_pipe_iov *iov,
+		   int iov_count, size_t *bytes_read, size_t min_xfer,
+		   int32_t timeout)
+{
+	struct k_pipe_desc desc;
+
+	__ASSERT(bytes_read != NULL, "");
+
+	_pipe_desc_init_iov(&desc, iov, iov_count);
+
+	__ASSERT(min_xfer <= desc.bytes_to_xfer, "");
+
+	return _k_pipe_get_internal(pipe, &desc, bytes_read, min_xfer,
+				    timeout);
+}
+
 int k_pipe_put(struct k_pipe *pipe, void *data, size_t bytes_to_write,
 	       size_t *bytes_written, size_t min_xfer, int32_t timeout)
 {
+	struct k_pipe_desc desc;
+
 	__ASSERT(min_xfer <= bytes_to_write, "");
 	__ASSERT(bytes_written != NULL, "");
 
-	return _k_pipe_put_internal(pipe, NULL, data,
-				    bytes_to_write, bytes_written,
+	_pipe_desc_init(&desc, data, bytes_to_write);
+
+	return _k_pipe_put_internal(pipe, NULL, &desc, bytes_written,
+				    min_xfer, timeout);
+}
+
+int k_pipe_put_iov(struct k_pipe *pipe, const struct k_pipe_iov *iov,
+		   int iov_count, size_t *bytes_written, size_t min_xfer,
+		   int32_t timeout)
+{
+	struct k_pipe_desc desc;
+
+	__ASSERT(bytes_written != NULL, "");
+
+	_pipe_desc_init_iov(&desc, iov, iov_count);
+
+	__ASSERT(min_xfer <= desc.bytes_to_xfer, "");
+
+	return _k_pipe_put_internal(pipe, NULL, &desc, bytes_written,
 				    min_xfer, timeout);
 }
 
@@ -690,13 +757,18 @@ void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
 	/* For simplicity, always allocate an asynchronous descriptor */
 	_pipe_async_alloc(&async_desc);
 
+	/*
+	 * The block's data is lent to the pipe: readers copy it out of the
+	 * block directly, and the block is freed once it has all been read.
+	 */
+	_pipe_desc_init(&async_desc->desc, block->data, block->req_size);
 	async_desc->desc.block = &async_desc->desc.copy_block;
 	async_desc->desc.copy_block = *block;
 	async_desc->desc.sem = sem;
 	async_desc->thread.prio = k_thread_priority_get(_current);
 
-	(void) _k_pipe_put_internal(pipe, async_desc, block->data,
-				    block->req_size, &dummy_bytes_written,
-				    block->req_size, K_FOREVER);
+	(void) _k_pipe_put_internal(pipe, async_desc, &async_desc->desc,
+				    &dummy_bytes_written, block->req_size,
+				    K_FOREVER);
 }
 #endif
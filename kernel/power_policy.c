@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Low power state selection policy
+ *
+ * The wakeup latency constraint is the lowest of the latencies of all the
+ * QoS requests, recomputed when a request changes so that the idle path
+ * only reads it. The idle time is predicted as the smaller of the time to
+ * the next timeout and a moving average of the previous idle periods, which
+ * are measured from the kernel's idle entry to the interrupt ending it.
+ * With device runtime power management, the resume latency of the
+ * suspended devices is taken out of the latency constraint.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <misc/dlist.h>
+#include <power.h>
+#include <device.h>
+#include <nano_internal.h>
+
+static const struct sys_pm_state *pm_states;
+static int pm_num_states;
+
+static sys_dlist_t qos_requests = SYS_DLIST_STATIC_INIT(&qos_requests);
+static uint32_t qos_latency = SYS_PM_NO_CONSTRAINT;
+
+#ifdef CONFIG_SYS_POWER_STATE_PREDICT
+/* weight of the last idle period in the average is 1/2^IDLE_AVG_SHIFT */
+#define IDLE_AVG_SHIFT 3
+#define IDLE_SAMPLE_MAX (UINT32_MAX >> IDLE_AVG_SHIFT)
+
+/* average idle period in microseconds, scaled by 2^IDLE_AVG_SHIFT */
+static uint32_t idle_avg_scaled;
+static int idle_avg_valid;
+static uint32_t idle_start;
+static int idle_measuring;
+
+void _sys_pm_idle_enter(void)
+{
+	idle_start = k_cycle_get_32();
+	idle_measuring = 1;
+}
+
+void _sys_pm_idle_exit(void)
+{
+	uint64_t us;
+
+	if (!idle_measuring) {
+		return;
+	}
+
+	idle_measuring = 0;
+	us = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - idle_start) /
+		NSEC_PER_USEC;
+	if (us > IDLE_SAMPLE_MAX) {
+		us = IDLE_SAMPLE_MAX;
+	}
+
+	if (!idle_avg_valid) {
+		idle_avg_scaled = (uint32_t)us << IDLE_AVG_SHIFT;
+		idle_avg_valid = 1;
+	} else {
+		idle_avg_scaled += (uint32_t)us -
+			(idle_avg_scaled >> IDLE_AVG_SHIFT);
+	}
+}
+#endif /* CONFIG_SYS_POWER_STATE_PREDICT */
+
+void sys_pm_states_set(const struct sys_pm_state *states, int num_states)
+{
+	unsigned int key = irq_lock();
+
+	pm_states = states;
+	pm_num_states = num_states;
+
+	irq_unlock(key);
+}
+
+/* must be called with interrupts locked */
+static void qos_latency_update(void)
+{
+	struct sys_pm_qos_request *req;
+	uint32_t latency = SYS_PM_NO_CONSTRAINT;
+	sys_dnode_t *node;
+
+	SYS_DLIST_FOR_EACH_NODE(&qos_requests, node) {
+		req = (struct sys_pm_qos_request *)node;
+		if (req->latency_us < latency) {
+			latency = req->latency_us;
+		}
+	}
+
+	qos_latency = latency;
+}
+
+void sys_pm_qos_request_add(struct sys_pm_qos_request *req,
+			    uint32_t latency_us)
+{
+	unsigned int key = irq_lock();
+
+	req->latency_us = latency_us;
+	sys_dlist_append(&qos_requests, &req->node);
+	if (latency_us < qos_latency) {
+		qos_latency = latency_us;
+	}
+
+	irq_unlock(key);
+}
+
+void sys_pm_qos_request_update(struct sys_pm_qos_request *req,
+			       uint32_t latency_us)
+{
+	unsigned int key = irq_lock();
+
+	req->latency_us = latency_us;
+	qos_latency_update();
+
+	irq_unlock(key);
+}
+
+void sys_pm_qos_request_remove(struct sys_pm_qos_request *req)
+{
+	unsigned int key = irq_lock();
+
+	sys_dlist_remove(&req->node);
+	qos_latency_update();
+
+	irq_unlock(key);
+}
+
+uint32_t sys_pm_qos_latency_get(void)
+{
+	return qos_latency;
+}
+
+uint32_t sys_pm_idle_predict(int32_t ticks)
+{
+	uint32_t us;
+
+	if (ticks == K_FOREVER ||
+	    (uint32_t)ticks > UINT32_MAX / sys_clock_us_per_tick) {
+		us = UINT32_MAX;
+	} else {
+		us = (uint32_t)ticks * sys_clock_us_per_tick;
+	}
+
+#ifdef CONFIG_SYS_POWER_STATE_PREDICT
+	if (idle_avg_valid && (idle_avg_scaled >> IDLE_AVG_SHIFT) < us) {
+		us = idle_avg_scaled >> IDLE_AVG_SHIFT;
+	}
+#endif
+
+	return us;
+}
+
+const struct sys_pm_state *sys_pm_state_select(int32_t ticks)
+{
+	uint32_t latency = qos_latency;
+	uint32_t idle_us = sys_pm_idle_predict(ticks);
+	int i;
+
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+	/* a wake event may have to resume a suspended device too */
+	if (latency != SYS_PM_NO_CONSTRAINT) {
+		uint32_t resume_us = device_pm_resume_latency_get();
+
+		latency = latency > resume_us ? latency - resume_us : 0;
+	}
+#endif
+
+	for (i = pm_num_states - 1; i >= 0; i--) {
+		if (pm_states[i].exit_latency_us <= latency &&
+		    pm_states[i].min_residency_us <= idle_us) {
+			return &pm_states[i];
+		}
+	}
+
+	return NULL;
+}
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2010-2016 Wind River Systems, Inc.
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief dynamic-size queue object, underlying fifos and lifos.
+ */
+
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <debug/object_tracing_common.h>
+#include <toolchain.h>
+#include <sections.h>
+#include <wait_q.h>
+#include <ksched.h>
+#include <misc/slist.h>
+#include <init.h>
+
+extern struct k_queue _k_queue_list_start[];
+extern struct k_queue _k_queue_list_end[];
+
+struct k_queue *_trace_list_k_queue;
+
+#ifdef CONFIG_OBJECT_TRACING
+
+/*
+ * Complete initialization of statically defined queues.
+ */
+static int init_queue_module(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	struct k_queue *queue;
+
+	for (queue = _k_queue_list_start; queue < _k_queue_list_end; queue++) {
+		SYS_TRACING_OBJ_INIT(k_queue, queue);
+	}
+	return 0;
+}
+
+SYS_INIT(init_queue_module, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
+
+#endif /* CONFIG_OBJECT_TRACING */
+
+void k_queue_init(struct k_queue *queue)
+{
+	sys_slist_init(&queue->data_q);
+	sys_dlist_init(&queue->wait_q);
+	atomic_clear(&queue->lockless);
+
+	_INIT_OBJ_POLL_EVENT(queue);
+
+	SYS_TRACING_OBJ_INIT(k_queue, queue);
+}
+
+static void prepare_thread_to_run(struct k_thread *thread, void *data)
+{
+	_abort_thread_timeout(thread);
+	_ready_thread(thread);
+	_set_thread_return_value_with_data(thread, 0, data);
+}
+
+/* returns 1 if a reschedule must take place, 0 otherwise */
+static inline int handle_poll_event(struct k_queue *queue)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_FIFO_DATA_AVAILABLE;
+
+	return queue->poll_event ?
+	       _handle_obj_poll_event(&queue->poll_event, state) : 0;
+#else
+	return 0;
+#endif
+}
+
+static inline int has_poll_event(struct k_queue *queue)
+{
+#ifdef CONFIG_POLL
+	return queue->poll_event != NULL;
+#else
+	return 0;
+#endif
+}
+
+/* returns 1 if a reschedule must take place, 0 otherwise */
+/* must be called with interrupts locked */
+static int insert_locked(struct k_queue *queue, void *data, bool append)
+{
+	struct k_thread *first_pending_thread;
+
+	first_pending_thread = _unpend_first_thread(&queue->wait_q);
+
+	if (first_pending_thread) {
+		prepare_thread_to_run(first_pending_thread, data);
+		return !_is_in_isr() && _must_switch_threads();
+	}
+
+	if (append) {
+		sys_slist_append(&queue->data_q, data);
+	} else {
+		sys_slist_prepend(&queue->data_q, data);
+	}
+
+	return handle_poll_event(queue);
+}
+
+/* returns 1 if a reschedule must take place, 0 otherwise */
+/* must be called with interrupts locked */
+static int append_list_locked(struct k_queue *queue, void *head, void *tail)
+{
+	struct k_thread *first_thread, *thread;
+
+	first_thread = _peek_first_pending_thread(&queue->wait_q);
+	while (head && ((thread = _unpend_first_thread(&queue->wait_q)))) {
+		prepare_thread_to_run(thread, head);
+		head = *(void **)head;
+	}
+
+	if (head) {
+		sys_slist_append_list(&queue->data_q, head, tail);
+	}
+
+	if (first_thread) {
+		return !_is_in_isr() && _must_switch_threads();
+	}
+
+	return handle_poll_event(queue);
+}
+
+/*
+ * Moves the items appended without locking to the queue proper. They are
+ * pushed last one first, and thus reversed back into their order.
+ *
+ * Returns 1 if a reschedule must take place, 0 otherwise. Must be called
+ * with interrupts locked.
+ */
+static int flush_lockless(struct k_queue *queue)
+{
+	void *node, *next, *head = NULL, *tail;
+
+	node = (void *)atomic_set(&queue->lockless, 0);
+	if (!node) {
+		return 0;
+	}
+
+	tail = node;
+	while (node) {
+		next = *(void **)node;
+		*(void **)node = head;
+		head = node;
+		node = next;
+	}
+
+	return append_list_locked(queue, head, tail);
+}
+
+int _k_queue_append_locked(struct k_queue *queue, void *data)
+{
+	return insert_locked(queue, data, true);
+}
+
+static void queue_insert(struct k_queue *queue, void *data, bool append)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (insert_locked(queue, data, append)) {
+		(void)_Swap(key);
+		return;
+	}
+
+	irq_unlock(key);
+}
+
+void k_queue_append(struct k_queue *queue, void *data)
+{
+	queue_insert(queue, data, true);
+}
+
+void k_queue_prepend(struct k_queue *queue, void *data)
+{
+	queue_insert(queue, data, false);
+}
+
+void k_queue_append_list(struct k_queue *queue, void *head, void *tail)
+{
+	__ASSERT(head && tail, "invalid head or tail");
+
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (append_list_locked(queue, head, tail)) {
+		(void)_Swap(key);
+		return;
+	}
+
+	irq_unlock(key);
+}
+
+void k_queue_merge_slist(struct k_queue *queue, sys_slist_t *list)
+{
+	__ASSERT(!sys_slist_is_empty(list), "list must not be empty");
+
+	/*
+	 * note: this works as long as:
+	 * - the slist implementation keeps the next pointer as the first
+	 *   field of the node object type
+	 * - list->tail->next = NULL.
+	 */
+	k_queue_append_list(queue, list->head, list->tail);
+}
+
+void k_queue_append_lockless(struct k_queue *queue, void *data)
+{
+	atomic_val_t head;
+	unsigned int key;
+
+	do {
+		head = atomic_get(&queue->lockless);
+		*(void **)data = (void *)head;
+	} while (!atomic_cas(&queue->lockless, head, (atomic_val_t)data));
+
+	/*
+	 * A thread only waits, or polls, after finding the queue empty with
+	 * interrupts locked: seen from here, either it is not waiting yet
+	 * and will find the item, or it already is and must be handed it.
+	 */
+	if (sys_dlist_is_empty(&queue->wait_q) && !has_poll_event(queue)) {
+		return;
+	}
+
+	key = irq_lock();
+
+	if (flush_lockless(queue)) {
+		(void)_Swap(key);
+		return;
+	}
+
+	irq_unlock(key);
+}
+
+void *k_queue_get(struct k_queue *queue, int32_t timeout)
+{
+	unsigned int key;
+	void *data;
+
+	key = irq_lock();
+
+	/* no thread waits while items are queued: no reschedule */
+	(void)flush_lockless(queue);
+
+	if (likely(!sys_slist_is_empty(&queue->data_q))) {
+		data = sys_slist_get_not_empty(&queue->data_q);
+		irq_unlock(key);
+		return data;
+	}
+
+	if (timeout == K_NO_WAIT) {
+		irq_unlock(key);
+		return NULL;
+	}
+
+	_pend_current_thread(&queue->wait_q, timeout);
+
+	return _Swap(key) ? NULL : _current->base.swap_data;
+}
+
+void *k_queue_get_all(struct k_queue *queue, int32_t timeout)
+{
+	unsigned int key;
+	void *data;
+
+	key = irq_lock();
+
+	(void)flush_lockless(queue);
+
+	if (sys_slist_is_empty(&queue->data_q)) {
+		if (timeout == K_NO_WAIT) {
+			irq_unlock(key);
+			return NULL;
+		}
+
+		_pend_current_thread(&queue->wait_q, timeout);
+
+		if (_Swap(key)) {
+			return NULL;
+		}
+
+		/*
+		 * Handed one item, possibly the head of a list whose rest
+		 * was queued at the same time: take it along.
+		 */
+		data = _current->base.swap_data;
+
+		key = irq_lock();
+		(void)flush_lockless(queue);
+		*(void **)data = queue->data_q.head;
+		sys_slist_init(&queue->data_q);
+		irq_unlock(key);
+
+		return data;
+	}
+
+	data = queue->data_q.head;
+	sys_slist_init(&queue->data_q);
+
+	irq_unlock(key);
+
+	return data;
+}
@@ -12,7 +12,12 @@
 #include <misc/util.h>
 
 /* the only struct _kernel instance */
+#if defined(CONFIG_CCM_KERNEL)
+/* Zeroed with the rest of the CCM BSS */
+struct _kernel __ccm_bss_section _kernel;
+#else
 struct _kernel _kernel = {0};
+#endif
 
 /* set the bit corresponding to prio in ready q bitmap */
 #ifdef CONFIG_MULTITHREADING
@@ -22,6 +27,10 @@ static void _set_ready_q_prio_bit(int prio)
 	uint32_t *bmap = &_ready_q.prio_bmap[bmap_index];
 
 	*bmap |= _get_ready_q_prio_bit(prio);
+
+#if (K_NUM_PRIO_BITMAPS > 1)
+	_ready_q.prio_bmap_summary |= (1 << bmap_index);
+#endif
 }
 #endif
 
@@ -33,10 +42,40 @@ static void _clear_ready_q_prio_bit(int prio)
 	uint32_t *bmap = &_ready_q.prio_bmap[bmap_index];
 
 	*bmap &= ~_get_ready_q_prio_bit(prio);
+
+#if (K_NUM_PRIO_BITMAPS > 1)
+	if (!*bmap) {
+		_ready_q.prio_bmap_summary &= ~(1 << bmap_index);
+	}
+#endif
 }
 #endif
 
 #ifdef CONFIG_MULTITHREADING
+/*
+ * Queue a thread at the end of its priority's ready queue or, when scheduling
+ * by deadline, after the threads of that priority whose deadline is not later
+ * than its own.
+ */
+static void _ready_q_insert(sys_dlist_t *q, struct k_thread *thread)
+{
+#ifdef CONFIG_SCHED_DEADLINE
+	sys_dnode_t *node;
+
+	SYS_DLIST_FOR_EACH_NODE(q, node) {
+		struct k_thread *queued = (struct k_thread *)node;
+
+		if (_is_t1_deadline_earlier_than_t2(thread, queued)) {
+			sys_dlist_insert_before(q, node,
+						&thread->base.k_q_node);
+			return;
+		}
+	}
+#endif
+
+	sys_dlist_append(q, &thread->base.k_q_node);
+}
+
 /*
  * Find the next thread to run when there is no thread in the cache and update
  * the cache.
@@ -75,7 +114,7 @@ void _add_thread_to_ready_q(struct k_thread *thread)
 	sys_dlist_t *q = &_ready_q.q[q_index];
 
 	_set_ready_q_prio_bit(thread->base.prio);
-	sys_dlist_append(q, &thread->base.k_q_node);
+	_ready_q_insert(q, thread);
 
 	struct k_thread **cache = &_ready_q.cache;
 
@@ -175,11 +214,81 @@ int32_t _ms_to_ticks(int32_t ms)
 }
 #endif
 
-/* pend the specified thread: it must *not* be in the ready queue */
-/* must be called with interrupts locked */
-void _pend_thread(struct k_thread *thread, _wait_q_t *wait_q, int32_t timeout)
+/* convert a high-resolution timeout to ticks, rounding up */
+int32_t _hires_timeout_to_ticks(int32_t timeout)
+{
+#ifdef CONFIG_SYS_CLOCK_EXISTS
+	uint32_t value = (uint32_t)timeout & _K_TIMEOUT_VALUE_MASK;
+
+	if (!((uint32_t)timeout & _K_TIMEOUT_CYCLES)) {
+		int64_t us_ticks = (int64_t)value * sys_clock_ticks_per_sec;
+
+		return (int32_t)ceiling_fraction(us_ticks, USEC_PER_SEC);
+	}
+
+	if ((uint32_t)timeout & _K_TIMEOUT_ABS) {
+		/* deadline in the 28-bit wrapping hardware clock domain */
+		value = (value - k_cycle_get_32()) & _K_TIMEOUT_VALUE_MASK;
+		if (value > (_K_TIMEOUT_VALUE_MASK >> 1)) {
+			return 0;
+		}
+	}
+
+	return (int32_t)ceiling_fraction(value, sys_clock_hw_cycles_per_tick);
+#else
+	ARG_UNUSED(timeout);
+	return 0;
+#endif
+}
+
+#ifdef CONFIG_WAIT_Q_PRIO_RUNS
+/*
+ * Walk the runs of equal priority threads: the thread goes at the end of
+ * the run of its priority, or in a run of its own before the first run of
+ * lower priority.
+ */
+void _wait_q_insert(_wait_q_t *wait_q, struct k_thread *thread)
+{
+	sys_dlist_t *wait_q_list = (sys_dlist_t *)wait_q;
+	struct _thread_base *base = &thread->base;
+	struct _thread_base *first, *last;
+
+	base->wait_q_prio = base->prio;
+
+	first = (struct _thread_base *)sys_dlist_peek_head(wait_q_list);
+
+	while (first) {
+		last = first->wait_q_run;
+
+		if (base->wait_q_prio == first->wait_q_prio) {
+			sys_dlist_insert_after(wait_q_list, &last->k_q_node,
+					       &base->k_q_node);
+			last->wait_q_flags &= ~_WAIT_Q_RUN_LAST;
+			base->wait_q_flags = _WAIT_Q_RUN_LAST;
+			base->wait_q_run = first;
+			first->wait_q_run = base;
+			return;
+		}
+
+		if (_is_prio_higher(base->wait_q_prio, first->wait_q_prio)) {
+			sys_dlist_insert_before(wait_q_list, &first->k_q_node,
+						&base->k_q_node);
+			goto new_run;
+		}
+
+		first = (struct _thread_base *)
+			sys_dlist_peek_next(wait_q_list, &last->k_q_node);
+	}
+
+	sys_dlist_append(wait_q_list, &base->k_q_node);
+
+new_run:
+	base->wait_q_flags = _WAIT_Q_RUN_FIRST | _WAIT_Q_RUN_LAST;
+	base->wait_q_run = base;
+}
+#else
+void _wait_q_insert(_wait_q_t *wait_q, struct k_thread *thread)
 {
-#ifdef CONFIG_MULTITHREADING
 	sys_dlist_t *wait_q_list = (sys_dlist_t *)wait_q;
 	sys_dnode_t *node;
 
@@ -189,17 +298,24 @@ void _pend_thread(struct k_thread *thread, _wait_q_t *wait_q, int32_t timeout)
 		if (_is_t1_higher_prio_than_t2(thread, pending)) {
 			sys_dlist_insert_before(wait_q_list, node,
 						&thread->base.k_q_node);
-			goto inserted;
+			return;
 		}
 	}
 
 	sys_dlist_append(wait_q_list, &thread->base.k_q_node);
+}
+#endif /* CONFIG_WAIT_Q_PRIO_RUNS */
 
-inserted:
+/* pend the specified thread: it must *not* be in the ready queue */
+/* must be called with interrupts locked */
+void _pend_thread(struct k_thread *thread, _wait_q_t *wait_q, int32_t timeout)
+{
+#ifdef CONFIG_MULTITHREADING
+	_wait_q_insert(wait_q, thread);
 	_mark_thread_as_pending(thread);
 
 	if (timeout != K_FOREVER) {
-		int32_t ticks = _TICK_ALIGN + _ms_to_ticks(timeout);
+		int32_t ticks = _TICK_ALIGN + _timeout_to_ticks(timeout);
 
 		_add_thread_timeout(thread, wait_q, ticks);
 	}
@@ -227,7 +343,11 @@ int __must_switch_threads(void)
 	extern void _dump_ready_q(void);
 	_dump_ready_q();
 
+#ifdef CONFIG_SCHED_DEADLINE
+	return _is_t1_higher_prio_than_t2(_get_next_ready_thread(), _current);
+#else
 	return _is_prio_higher(_get_highest_ready_prio(), _current->base.prio);
+#endif
 #else
 	return 0;
 #endif
@@ -254,6 +374,39 @@ void k_thread_priority_set(k_tid_t tid, int prio)
 	_reschedule_threads(key);
 }
 
+#ifdef CONFIG_SCHED_DEADLINE
+void k_thread_deadline_set(k_tid_t tid, int32_t deadline)
+{
+	__ASSERT(!_is_in_isr(), "");
+
+	struct k_thread *thread = (struct k_thread *)tid;
+	uint32_t cycles = 0;
+
+	if (deadline >= 0) {
+		cycles = (uint32_t)(((uint64_t)deadline *
+				     sys_clock_hw_cycles_per_sec) /
+				    MSEC_PER_SEC);
+		__ASSERT(cycles <= INT32_MAX, "deadline too far away\n");
+	}
+
+	int key = irq_lock();
+	int ready = _is_thread_ready(thread);
+
+	if (ready) {
+		_remove_thread_from_ready_q(thread);
+	}
+
+	thread->base.has_deadline = deadline >= 0;
+	thread->base.prio_deadline = k_cycle_get_32() + cycles;
+
+	if (ready) {
+		_add_thread_to_ready_q(thread);
+	}
+
+	_reschedule_threads(key);
+}
+#endif
+
 /*
  * Interrupts must be locked when calling this function.
  *
@@ -272,7 +425,7 @@ void _move_thread_to_end_of_prio_q(struct k_thread *thread)
 	}
 
 	sys_dlist_remove(&thread->base.k_q_node);
-	sys_dlist_append(q, &thread->base.k_q_node);
+	_ready_q_insert(q, thread);
 
 	struct k_thread **cache = &_ready_q.cache;
 
@@ -291,6 +444,9 @@ void k_yield(void)
 	if (_current == _get_next_ready_thread()) {
 		irq_unlock(key);
 	} else {
+#ifdef CONFIG_THREAD_STATS
+		_current->stats.yielding = 1;
+#endif
 		_Swap(key);
 	}
 }
@@ -309,13 +465,15 @@ void k_sleep(int32_t duration)
 
 	K_DEBUG("thread %p for %d ns\n", _current, duration);
 
-	/* wait of 0 ms is treated as a 'yield' */
-	if (duration == 0) {
+	ticks = _timeout_to_ticks(duration);
+
+	/* wait of 0 ticks, e.g. a deadline already past, is a 'yield' */
+	if (ticks == 0) {
 		k_yield();
 		return;
 	}
 
-	ticks = _TICK_ALIGN + _ms_to_ticks(duration);
+	ticks += _TICK_ALIGN;
 	key = irq_lock();
 
 	_remove_thread_from_ready_q(_current);
@@ -371,7 +529,7 @@ void _dump_ready_q(void)
 
 #ifdef CONFIG_TIMESLICING
 extern int32_t _time_slice_duration;    /* Measured in ms */
-extern int32_t _time_slice_elapsed;     /* Measured in ms */
+extern uint64_t _time_slice_elapsed;    /* Measured in hw cycles */
 extern int _time_slice_prio_ceiling;
 
 void k_sched_time_slice_set(int32_t duration_in_ms, int prio)
@@ -382,6 +540,33 @@ void k_sched_time_slice_set(int32_t duration_in_ms, int prio)
 	_time_slice_duration = duration_in_ms;
 	_time_slice_elapsed = 0;
 	_time_slice_prio_ceiling = prio;
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	if (duration_in_ms) {
+		unsigned int key = irq_lock();
+
+		_sys_clock_set_next_event(_get_elapsed_program_time() +
+					  _ms_to_ticks(duration_in_ms));
+		irq_unlock(key);
+	}
+#endif
+}
+
+void k_thread_time_slice_set(k_tid_t thread, int32_t slice)
+{
+	__ASSERT(slice >= 0, "");
+
+	thread->base.time_slice = slice;
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	if (slice && thread == _current) {
+		unsigned int key = irq_lock();
+
+		_sys_clock_set_next_event(_get_elapsed_program_time() +
+					  _ms_to_ticks(slice));
+		irq_unlock(key);
+	}
+#endif
 }
 #endif /* CONFIG_TIMESLICING */
 
@@ -73,6 +73,9 @@ void k_sem_init(struct k_sem *sem, unsigned int initial_count,
 	sem->count = initial_count;
 	sem->limit = limit;
 	sys_dlist_init(&sem->wait_q);
+
+	_INIT_OBJ_POLL_EVENT(sem);
+
 	SYS_TRACING_OBJ_INIT(k_sem, sem);
 }
 
@@ -231,6 +234,24 @@ static int handle_sem_group(struct k_sem *sem, struct k_thread *thread)
 #define handle_sem_group(sem, thread) 0
 #endif
 
+static inline void increment_count_up_to_limit(struct k_sem *sem)
+{
+	sem->count += (sem->count != sem->limit);
+}
+
+/* returns 1 if a reschedule must take place, 0 otherwise */
+static inline int handle_poll_event(struct k_sem *sem)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_SEM_AVAILABLE;
+
+	return sem->poll_event ?
+	       _handle_obj_poll_event(&sem->poll_event, state) : 0;
+#else
+	return 0;
+#endif
+}
+
 /**
  * @brief Common semaphore give code
  *
@@ -247,8 +268,8 @@ static bool sem_give_common(struct k_sem *sem)
 		 * Increment the semaphore's count unless
 		 * its limit has already been reached.
 		 */
-		sem->count += (sem->count != sem->limit);
-		return false;
+		increment_count_up_to_limit(sem);
+		return handle_poll_event(sem);
 	}
 
 	_abort_thread_timeout(thread);
@@ -278,8 +299,8 @@ void _sem_give_non_preemptible(struct k_sem *sem)
 
 	thread = _unpend_first_thread(&sem->wait_q);
 	if (!thread) {
-		/* increment semaphore's count unless limit is reached */
-		sem->count += (sem->count != sem->limit);
+		increment_count_up_to_limit(sem);
+		(void)handle_poll_event(sem);
 		return;
 	}
 
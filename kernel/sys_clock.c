@@ -25,6 +25,8 @@ int sys_clock_hw_cycles_per_tick =
 	CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC / sys_clock_ticks_per_sec;
 #if defined(CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME)
 int sys_clock_hw_cycles_per_sec = CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
+uint64_t _sys_clock_ns_per_cycle_q32 =
+	((uint64_t)NSEC_PER_SEC << 32) / CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
 #endif
 #else
 /* don't initialize to avoid division-by-zero error */
@@ -32,6 +34,7 @@ int sys_clock_us_per_tick;
 int sys_clock_hw_cycles_per_tick;
 #if defined(CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME)
 int sys_clock_hw_cycles_per_sec;
+uint64_t _sys_clock_ns_per_cycle_q32;
 #endif
 #endif
 
@@ -49,7 +52,16 @@ int64_t _sys_clock_tick_count;
  */
 uint32_t _tick_get_32(void)
 {
+#ifdef CONFIG_TICKLESS_KERNEL
+	unsigned int imask = irq_lock();
+	uint32_t ticks = (uint32_t)_sys_clock_tick_count +
+			 _get_elapsed_program_time();
+
+	irq_unlock(imask);
+	return ticks;
+#else
 	return (uint32_t)_sys_clock_tick_count;
+#endif
 }
 FUNC_ALIAS(_tick_get_32, sys_tick_get_32, uint32_t);
 
@@ -77,6 +89,10 @@ int64_t _tick_get(void)
 	unsigned int imask = irq_lock();
 
 	tmp_sys_clock_tick_count = _sys_clock_tick_count;
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* ticks are only announced when a timer event occurs */
+	tmp_sys_clock_tick_count += _get_elapsed_program_time();
+#endif
 	irq_unlock(imask);
 	return tmp_sys_clock_tick_count;
 }
@@ -120,16 +136,7 @@ static ALWAYS_INLINE int64_t _nano_tick_delta(int64_t *reftime)
 	int64_t  delta;
 	int64_t  saved;
 
-	/*
-	 * Lock the interrupts when reading _sys_clock_tick_count 64-bit
-	 * variable.  Some architectures (x86) do not handle 64-bit atomically,
-	 * so we have to lock the timer interrupt that causes change of
-	 * _sys_clock_tick_count
-	 */
-	unsigned int imask = irq_lock();
-
-	saved = _sys_clock_tick_count;
-	irq_unlock(imask);
+	saved = _tick_get();
 	delta = saved - (*reftime);
 	*reftime = saved;
 
@@ -169,6 +176,35 @@ uint32_t k_uptime_delta_32(int64_t *reftime)
 	return (uint32_t)k_uptime_delta(reftime);
 }
 
+#if defined(CONFIG_SYS_CLOCK_EXISTS) && \
+	!defined(CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER)
+/* last k_cycle_get_32() value seen, and number of times it wrapped around */
+static uint32_t cycle_64_last;
+static uint32_t cycle_64_wraps;
+
+uint64_t k_cycle_get_64(void)
+{
+	unsigned int key = irq_lock();
+	uint32_t now = k_cycle_get_32();
+	uint64_t cycles;
+
+	if (now < cycle_64_last) {
+		cycle_64_wraps++;
+	}
+	cycle_64_last = now;
+	cycles = ((uint64_t)cycle_64_wraps << 32) | now;
+
+	irq_unlock(key);
+
+	return cycles;
+}
+
+/* observe the counter at least once per tick announced */
+#define cycle_64_update() ((void)k_cycle_get_64())
+#else
+#define cycle_64_update() do { } while (0)
+#endif
+
 /* handle the expired timeouts in the nano timeout queue */
 
 #ifdef CONFIG_SYS_CLOCK_EXISTS
@@ -188,6 +224,23 @@ uint32_t k_uptime_delta_32(int64_t *reftime)
 
 volatile int _handling_timeouts;
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+static inline void handle_timeouts(int32_t ticks)
+{
+	sys_dlist_t expired;
+
+	/* init before locking interrupts */
+	sys_dlist_init(&expired);
+
+	_handling_timeouts = 1;
+
+	_timeout_wheel_announce(ticks, &expired);
+
+	_handle_expired_timeouts(&expired);
+
+	_handling_timeouts = 0;
+}
+#else
 static inline void handle_timeouts(int32_t ticks)
 {
 	sys_dlist_t expired;
@@ -242,50 +295,183 @@ static inline void handle_timeouts(int32_t ticks)
 
 	_handling_timeouts = 0;
 }
+#endif /* CONFIG_TIMEOUT_WHEEL */
 #else
 	#define handle_timeouts(ticks) do { } while ((0))
 #endif
 
 #ifdef CONFIG_TIMESLICING
-int32_t _time_slice_elapsed;
 int32_t _time_slice_duration = CONFIG_TIMESLICE_SIZE;
 int  _time_slice_prio_ceiling = CONFIG_TIMESLICE_PRIORITY;
 
+/*
+ * Thread whose time slice is being measured, and the hardware cycles it has
+ * used of it, up to _time_slice_cycle_stamp. Measuring in hardware cycles
+ * rather than in ticks keeps the accounting exact when ticks are announced
+ * in batches, e.g. after tickless idle.
+ */
+struct k_thread *_time_slice_thread;
+uint64_t _time_slice_elapsed;
+static uint32_t _time_slice_cycle_stamp;
+
+/*
+ * Time slice of a thread, in hardware cycles, or 0 if it is not subject to
+ * time slicing: its own budget if it has one, else the global slice size,
+ * as long as its priority is not above the time slicing ceiling.
+ */
+static uint64_t time_slice_budget(struct k_thread *thread)
+{
+	int32_t slice = thread->base.time_slice;
+
+	if (thread == _idle_thread || _is_coop(thread)) {
+		return 0;
+	}
+
+	if (slice == 0) {
+		if (_is_prio_higher(thread->base.prio,
+				    _time_slice_prio_ceiling)) {
+			return 0;
+		}
+		slice = _time_slice_duration;
+	}
+
+	return (uint64_t)slice * sys_clock_hw_cycles_per_sec / MSEC_PER_SEC;
+}
+
 /*
  * Always called from interrupt level, and always only from the system clock
  * interrupt, thus:
  * - _current does not have to be protected, since it only changes at thread
  *   level or when exiting a non-nested interrupt
- * - _time_slice_elapsed does not have to be protected, since it can only change
- *   in this function and at thread level
- * - _time_slice_duration does not have to be protected, since it can only
- *   change at thread level
+ * - _time_slice_thread, _time_slice_elapsed and _time_slice_cycle_stamp do
+ *   not have to be protected, since they can only change in this function
+ *   and at thread level
+ * - the slice sizes do not have to be protected, since they can only change
+ *   at thread level
  */
 static void handle_time_slicing(int32_t ticks)
 {
-	if (_time_slice_duration == 0) {
-		return;
+	uint32_t now = k_cycle_get_32();
+	uint64_t budget;
+
+	ARG_UNUSED(ticks);
+
+	/* a slice only runs down while its thread runs */
+	if (_current == _time_slice_thread) {
+		_time_slice_elapsed += now - _time_slice_cycle_stamp;
 	}
+	_time_slice_cycle_stamp = now;
 
-	if (_is_prio_higher(_current->base.prio, _time_slice_prio_ceiling)) {
+	budget = time_slice_budget(_current);
+	if (budget == 0) {
 		return;
 	}
 
-	_time_slice_elapsed += __ticks_to_ms(ticks);
-	if (_time_slice_elapsed >= _time_slice_duration) {
+	if (_current != _time_slice_thread) {
+		/* another thread of the same priority starts a new slice */
+		_time_slice_thread = _current;
+		_time_slice_elapsed = 0;
+	}
 
-		unsigned int key;
+	if (_time_slice_elapsed >= budget) {
 
-		_time_slice_elapsed = 0;
+		unsigned int key;
 
 		key = irq_lock();
 		_move_thread_to_end_of_prio_q(_current);
+
+		/* runs when the interrupt exits, with a whole slice */
+		_time_slice_thread = _get_next_ready_thread();
+		_time_slice_elapsed = 0;
 		irq_unlock(key);
 	}
 }
 #else
 #define handle_time_slicing(ticks) do { } while (0)
 #endif
+
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * Number of ticks, counted from the last announcement, after which the timer
+ * driver has been asked to signal the next event; 0 if none.
+ */
+static int32_t _programmed_ticks;
+
+/*
+ * Ticks left in the time slice of the thread that runs when the system clock
+ * interrupt exits, or 0 if that thread is not subject to time slicing.
+ *
+ * A thread made ready by another interrupt source starts its time slice with
+ * the next system clock event.
+ */
+static int32_t time_slice_ticks_left(void)
+{
+#ifdef CONFIG_TIMESLICING
+	struct k_thread *thread = _get_next_ready_thread();
+	uint64_t budget = time_slice_budget(thread);
+	uint64_t ticks;
+
+	if (budget == 0) {
+		return 0;
+	}
+
+	if (thread == _time_slice_thread) {
+		budget = budget > _time_slice_elapsed ?
+			 budget - _time_slice_elapsed : 0;
+	}
+
+	ticks = ceiling_fraction(budget, sys_clock_hw_cycles_per_tick);
+
+	return (int32_t)min(max(ticks, 1), INT32_MAX);
+#else
+	return 0;
+#endif
+}
+
+/**
+ *
+ * @brief Program the system clock for an event
+ *
+ * Asks the timer driver to signal an event 'ticks' ticks after the last
+ * announcement, unless it is already programmed to signal one sooner.
+ *
+ * Must be called with interrupts locked.
+ *
+ * @param ticks the number of ticks since the last announcement
+ *
+ * @return N/A
+ */
+void _sys_clock_set_next_event(int32_t ticks)
+{
+	if (_programmed_ticks && ticks >= _programmed_ticks) {
+		return;
+	}
+
+	_programmed_ticks = ticks;
+	_set_time(ticks);
+}
+
+/* program the timer for the earliest of the next timeout and time slice end */
+static void program_next_event(void)
+{
+	unsigned int key = irq_lock();
+	int32_t timeout = _get_next_timeout_expiry();
+	int32_t slice = time_slice_ticks_left();
+
+	if (timeout == K_FOREVER) {
+		timeout = 0;
+	}
+
+	_programmed_ticks = (!timeout || (slice && slice < timeout)) ?
+			    slice : timeout;
+	_set_time(_programmed_ticks);
+
+	irq_unlock(key);
+}
+#else
+#define program_next_event() do { } while (0)
+#endif
+
 /**
  *
  * @brief Announce a tick to the kernel
@@ -305,10 +491,19 @@ void _nano_sys_clock_tick_announce(int32_t ticks)
 	/* 64-bit value, ensure atomic access with irq lock */
 	key = irq_lock();
 	_sys_clock_tick_count += ticks;
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* the event the timer was programmed for, if any, has occurred */
+	_programmed_ticks = 0;
+#endif
 	irq_unlock(key);
 
+	cycle_64_update();
+
 	handle_timeouts(ticks);
 
 	/* time slicing is basically handled like just yet another timeout */
 	handle_time_slicing(ticks);
+
+	/* there is no periodic tick: ask for the next one explicitly */
+	program_next_event();
 }
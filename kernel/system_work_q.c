@@ -14,7 +14,8 @@
 #include <kernel.h>
 #include <init.h>
 
-char __noinit __stack sys_work_q_stack[CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE];
+char __noinit __stack sys_work_q_stack[CONFIG_SYSTEM_WORKQUEUE_THREADS]
+				       [CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE];
 
 struct k_work_q k_sys_work_q;
 
@@ -22,10 +23,18 @@ static int k_sys_work_q_init(struct device *dev)
 {
 	ARG_UNUSED(dev);
 
-	k_work_q_start(&k_sys_work_q,
-		       sys_work_q_stack,
-		       sizeof(sys_work_q_stack),
-		       CONFIG_SYSTEM_WORKQUEUE_PRIORITY);
+#ifdef CONFIG_SYSTEM_WORKQUEUE_ORDERED
+	uint32_t options = K_WORK_Q_ORDERED;
+#else
+	uint32_t options = 0;
+#endif
+
+	k_work_q_start_pool(&k_sys_work_q,
+			    sys_work_q_stack[0],
+			    sizeof(sys_work_q_stack[0]),
+			    CONFIG_SYSTEM_WORKQUEUE_THREADS,
+			    CONFIG_SYSTEM_WORKQUEUE_PRIORITY,
+			    options);
 
 	return 0;
 }
@@ -220,7 +220,7 @@ static void schedule_new_thread(struct k_thread *thread, int32_t delay)
 	if (delay == 0) {
 		start_thread(thread);
 	} else {
-		int32_t ticks = _TICK_ALIGN + _ms_to_ticks(delay);
+		int32_t ticks = _TICK_ALIGN + _timeout_to_ticks(delay);
 		int key = irq_lock();
 
 		_add_thread_timeout(thread, NULL, ticks);
@@ -233,6 +233,15 @@ static void schedule_new_thread(struct k_thread *thread, int32_t delay)
 }
 #endif
 
+#ifdef CONFIG_HEAP_ARENAS
+#define thread_heap_arena_inherit(thread) \
+	((thread)->heap_arena = _current->heap_arena)
+#else
+#define thread_heap_arena_inherit(thread) \
+	do {/* nothing */    \
+	} while (0)
+#endif
+
 #ifdef CONFIG_MULTITHREADING
 k_tid_t k_thread_spawn(char *stack, size_t stack_size,
 			void (*entry)(void *, void *, void*),
@@ -244,6 +253,8 @@ k_tid_t k_thread_spawn(char *stack, size_t stack_size,
 	struct k_thread *new_thread = (struct k_thread *)stack;
 
 	_new_thread(stack, stack_size, entry, p1, p2, p3, prio, options);
+	_thread_stats_init(new_thread, stack_size);
+	thread_heap_arena_inherit(new_thread);
 
 	schedule_new_thread(new_thread, delay);
 
@@ -251,6 +262,94 @@ k_tid_t k_thread_spawn(char *stack, size_t stack_size,
 }
 #endif
 
+#ifdef CONFIG_THREAD_POOL
+/*
+ * Must be called with interrupts locked, once the thread is off all kernel
+ * queues. A thread waiting for a stack is made ready, not switched to, so
+ * the caller can still switch out of a thread giving its own stack back.
+ */
+static void thread_pool_release(struct k_thread *thread)
+{
+	struct k_thread_pool *pool = thread->pool;
+	struct k_thread *pending_thread;
+
+	if (!pool) {
+		return;
+	}
+
+	thread->pool = NULL;
+
+	pending_thread = _unpend_first_thread(&pool->wait_q);
+	if (pending_thread) {
+		_set_thread_return_value_with_data(pending_thread, 0, thread);
+		_abort_thread_timeout(pending_thread);
+		_ready_thread(pending_thread);
+		return;
+	}
+
+	*(char **)thread = pool->free_list;
+	pool->free_list = (char *)thread;
+	pool->num_used--;
+}
+
+k_tid_t k_thread_pool_spawn(struct k_thread_pool *pool,
+			    void (*entry)(void *, void *, void*),
+			    void *p1, void *p2, void *p3,
+			    int prio, uint32_t options, int32_t delay,
+			    int32_t timeout)
+{
+	__ASSERT(!_is_in_isr(), "");
+
+	struct k_thread *new_thread;
+	unsigned int key = irq_lock();
+	int recycled = 1;
+	char *stack;
+
+	if (pool->free_list) {
+		stack = pool->free_list;
+		pool->free_list = *(char **)stack;
+		pool->num_used++;
+		irq_unlock(key);
+	} else if (pool->num_fresh) {
+		stack = pool->buffer +
+			(pool->num_stacks - pool->num_fresh) * pool->stack_size;
+		pool->num_fresh--;
+		pool->num_used++;
+		irq_unlock(key);
+		recycled = 0;
+	} else if (timeout == K_NO_WAIT) {
+		irq_unlock(key);
+		return NULL;
+	} else {
+		/* a stack given back from now on is handed to this thread */
+		_pend_current_thread(&pool->wait_q, timeout);
+		if (_Swap(key)) {
+			return NULL;
+		}
+		stack = _current->base.swap_data;
+	}
+
+	if (recycled && IS_ENABLED(CONFIG_THREAD_POOL_NO_REFILL)) {
+		options |= K_NO_STACK_FILL;
+	}
+
+	new_thread = (struct k_thread *)stack;
+
+	_new_thread(stack, pool->stack_size, entry, p1, p2, p3, prio, options);
+	_thread_stats_init(new_thread, pool->stack_size);
+	new_thread->pool = pool;
+	thread_heap_arena_inherit(new_thread);
+
+	schedule_new_thread(new_thread, delay);
+
+	return new_thread;
+}
+#else
+#define thread_pool_release(thread) \
+	do {/* nothing */    \
+	} while (0)
+#endif /* CONFIG_THREAD_POOL */
+
 int k_thread_cancel(k_tid_t tid)
 {
 	struct k_thread *thread = tid;
@@ -265,6 +364,7 @@ int k_thread_cancel(k_tid_t tid)
 
 	_abort_thread_timeout(thread);
 	_thread_monitor_exit(thread);
+	thread_pool_release(thread);
 
 	irq_unlock(key);
 
@@ -376,6 +476,7 @@ void _k_thread_single_abort(struct k_thread *thread)
 		}
 	}
 	_mark_thread_as_dead(thread);
+	thread_pool_release(thread);
 }
 
 #ifdef CONFIG_MULTITHREADING
@@ -394,6 +495,8 @@ void _init_static_threads(void)
 			thread_data->init_p3,
 			thread_data->init_prio,
 			thread_data->init_options);
+		_thread_stats_init(thread_data->thread,
+				   thread_data->init_stack_size);
 
 		thread_data->thread->init_data = thread_data;
 	}
@@ -437,8 +540,18 @@ void _init_thread_base(struct _thread_base *thread_base, int priority,
 
 	thread_base->sched_locked = 0;
 
+#ifdef CONFIG_SCHED_DEADLINE
+	thread_base->has_deadline = 0;
+#endif
+
+#ifdef CONFIG_TIMESLICING
+	thread_base->time_slice = 0;
+#endif
+
 	/* swap_data does not need to be initialized */
 
+	thread_base->pended_on_mutex = NULL;
+
 	_init_thread_timeout(thread_base);
 }
 
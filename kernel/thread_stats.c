@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief thread runtime statistics
+ *
+ * Each context switch charges the outgoing thread for the hardware cycles it
+ * ran since it was switched in, and counts whether it was preempted, i.e.
+ * still ready to run, or gave up the CPU on its own by blocking or yielding.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <ksched.h>
+#include <nano_internal.h>
+#include <string.h>
+
+/* value used by the architectures to fill stacks when INIT_STACKS is set */
+#define STACK_FILL 0xaa
+
+void _thread_stats_init(struct k_thread *thread, size_t stack_size)
+{
+	memset(&thread->stats, 0, sizeof(thread->stats));
+	thread->stats.stack_size = stack_size;
+}
+
+/*
+ * Called by the architecture's context switch code, with interrupts locked,
+ * while _current is still the outgoing thread and the ready queue cache
+ * holds the incoming one.
+ */
+void _thread_stats_switch(void)
+{
+	struct k_thread *from = _current;
+	struct k_thread *to = _ready_q.cache;
+	uint32_t now = k_cycle_get_32();
+
+	if (from == to) {
+		return;
+	}
+
+	from->stats.cycles += now - from->stats.switched_in;
+	++from->stats.num_switches;
+
+	if (_is_thread_ready(from) && !from->stats.yielding) {
+		++from->stats.num_preemptions;
+	}
+	from->stats.yielding = 0;
+
+	to->stats.switched_in = now;
+}
+
+#ifdef CONFIG_INIT_STACKS
+static size_t stack_unused(struct k_thread *thread)
+{
+	const unsigned char *stack = (const unsigned char *)thread;
+	size_t unused = 0;
+
+#if defined(CONFIG_STACK_GROWS_UP)
+	for (size_t i = thread->stats.stack_size; i > sizeof(*thread); i--) {
+		if (stack[i - 1] != STACK_FILL) {
+			break;
+		}
+		unused++;
+	}
+#else
+	for (size_t i = sizeof(*thread); i < thread->stats.stack_size; i++) {
+		if (stack[i] != STACK_FILL) {
+			break;
+		}
+		unused++;
+	}
+#endif
+
+	return unused;
+}
+#endif
+
+void k_thread_stats_get(k_tid_t thread, struct k_thread_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	stats->cycles = thread->stats.cycles;
+	stats->num_switches = thread->stats.num_switches;
+	stats->num_preemptions = thread->stats.num_preemptions;
+
+	/* the current thread has not been charged for its ongoing run */
+	if (thread == _current) {
+		stats->cycles += k_cycle_get_32() - thread->stats.switched_in;
+	}
+
+	irq_unlock(key);
+
+	stats->stack_size = thread->stats.stack_size - sizeof(*thread);
+#ifdef CONFIG_INIT_STACKS
+	stats->stack_used = stats->stack_size - stack_unused(thread);
+#else
+	stats->stack_used = 0;
+#endif
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief hierarchical timing wheel backend for the timeout queue
+ *
+ * Timeouts are hashed on their absolute expiry tick into one of 32 slots of
+ * the first level of the wheel if they expire within 32 ticks, into one of 32
+ * slots of the second level, each covering 32 ticks, if they expire within
+ * 1024 ticks, and so on. Each time the lower bits of the current time wrap
+ * around, the matching slot of the level above is re-hashed into the lower
+ * levels ("cascaded"). Adding and aborting a timeout are thus O(1), and each
+ * tick only touches the timeouts that expire or cascade on that tick.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <wait_q.h>
+#include <misc/dlist.h>
+
+#define LEVELS CONFIG_TIMEOUT_WHEEL_LEVELS
+#define BITS _TIMEOUT_WHEEL_BITS
+#define MASK _TIMEOUT_WHEEL_MASK
+
+/* longest delta the wheel can represent without re-queuing */
+#define MAX_DELTA ((1U << (BITS * LEVELS)) - 1)
+
+struct _timeout_wheel _timeout_wheel;
+
+#define _wheel _timeout_wheel
+
+static inline uint32_t level_shift(int level)
+{
+	return BITS * level;
+}
+
+void _timeout_wheel_init(void)
+{
+	for (int level = 0; level < LEVELS; level++) {
+		for (int slot = 0; slot < _TIMEOUT_WHEEL_SLOTS; slot++) {
+			sys_dlist_init(&_wheel.slots[level][slot]);
+		}
+	}
+}
+
+/* must be called with interrupts locked */
+static void insert(struct _timeout *timeout)
+{
+	uint32_t expiry = timeout->expiry;
+	uint32_t delta = expiry - _wheel.now;
+	int level;
+
+	if (delta > MAX_DELTA) {
+		/* park on the last level, re-queued when it cascades */
+		expiry = _wheel.now + MAX_DELTA;
+		delta = MAX_DELTA;
+	}
+
+	for (level = 0; level < LEVELS - 1; level++) {
+		if (delta < (1U << level_shift(level + 1))) {
+			break;
+		}
+	}
+
+	int slot = (expiry >> level_shift(level)) & MASK;
+
+	sys_dlist_append(&_wheel.slots[level][slot], &timeout->node);
+	_wheel.bmap[level] |= (1U << slot);
+}
+
+/* must be called with interrupts locked */
+void _timeout_wheel_add(struct _timeout *timeout, int32_t timeout_in_ticks)
+{
+	timeout->expiry = _wheel.now + (uint32_t)timeout_in_ticks;
+	++_wheel.num_active;
+	insert(timeout);
+}
+
+/* must be called with interrupts locked */
+int _timeout_wheel_abort(struct _timeout *timeout)
+{
+	if (timeout->delta_ticks_from_prev == _INACTIVE) {
+		return _INACTIVE;
+	}
+
+	/* expired timeouts are already accounted for */
+	if (timeout->delta_ticks_from_prev != _EXPIRED) {
+		--_wheel.num_active;
+	}
+
+	sys_dlist_remove(&timeout->node);
+	timeout->delta_ticks_from_prev = _INACTIVE;
+
+	return 0;
+}
+
+/* must be called with interrupts locked */
+int32_t _timeout_wheel_remaining(struct _timeout *timeout)
+{
+	if (timeout->delta_ticks_from_prev == _INACTIVE ||
+	    timeout->delta_ticks_from_prev == _EXPIRED) {
+		return 0;
+	}
+
+	return (int32_t)(timeout->expiry - _wheel.now);
+}
+
+/*
+ * Distance, in slots, from slot 'cur' to the next slot flagged in 'bmap',
+ * 'cur' itself being considered last, i.e. at a distance of 32 slots.
+ * Returns 0 if there is no flagged slot.
+ */
+static inline int next_slot_distance(uint32_t bmap, uint32_t cur)
+{
+	uint32_t start = (cur + 1) & MASK;
+	uint32_t rotated;
+
+	rotated = start ? (bmap >> start) | (bmap << (32 - start)) : bmap;
+
+	return rotated ? find_lsb_set(rotated) : 0;
+}
+
+/*
+ * Find the number of ticks until the next time the wheel must be looked at:
+ * either when a timeout expires or when a slot containing timeouts cascades.
+ * The latter is never later than the expiry of the timeouts it contains, so it
+ * is a safe value to program a tickless timer with.
+ *
+ * Must be called with interrupts locked.
+ */
+int32_t _timeout_wheel_next_expiry(void)
+{
+	uint32_t min = 0;
+
+	if (!_wheel.num_active) {
+		return K_FOREVER;
+	}
+
+	for (int level = 0; level < LEVELS; level++) {
+		uint32_t shift = level_shift(level);
+		uint32_t cur = (_wheel.now >> shift) & MASK;
+		uint32_t distance, slot;
+
+		for (;;) {
+			distance = next_slot_distance(_wheel.bmap[level], cur);
+			if (!distance) {
+				break;
+			}
+
+			slot = (cur + distance) & MASK;
+			if (!sys_dlist_is_empty(&_wheel.slots[level][slot])) {
+				break;
+			}
+
+			/* emptied by an abort: drop the stale bit */
+			_wheel.bmap[level] &= ~(1U << slot);
+		}
+
+		if (!distance) {
+			continue;
+		}
+
+		uint32_t ticks = ((((_wheel.now >> shift) + distance) << shift)
+				 - _wheel.now);
+
+		if (!min || ticks < min) {
+			min = ticks;
+		}
+	}
+
+	return min ? (int32_t)min : K_FOREVER;
+}
+
+/*
+ * Move all timeouts in a slot to the local 'list', so that they can be
+ * handled with interrupts unlocked between each of them.
+ *
+ * Must be called with interrupts locked.
+ */
+static void detach_slot(int level, int slot, sys_dlist_t *list)
+{
+	sys_dlist_t *slot_list = &_wheel.slots[level][slot];
+	sys_dnode_t *node;
+
+	while ((node = sys_dlist_get(slot_list)) != NULL) {
+		sys_dlist_append(list, node);
+	}
+
+	_wheel.bmap[level] &= ~(1U << slot);
+}
+
+/*
+ * Advance the wheel by one tick: cascade the slots of the upper levels that
+ * are due, then move the timeouts expiring on this tick to the 'expired'
+ * queue, marking them as _EXPIRED. Relieves interrupt lock pressure between
+ * each timeout being handled, like the delta list implementation does.
+ */
+static unsigned int advance_one_tick(sys_dlist_t *expired, unsigned int key)
+{
+	sys_dlist_t cascade;
+	sys_dnode_t *node;
+
+	sys_dlist_init(&cascade);
+
+	++_wheel.now;
+
+	for (int level = 1; level < LEVELS; level++) {
+		uint32_t shift = level_shift(level);
+
+		if (_wheel.now & ((1U << shift) - 1)) {
+			break;
+		}
+
+		detach_slot(level, (_wheel.now >> shift) & MASK, &cascade);
+
+		while ((node = sys_dlist_get(&cascade)) != NULL) {
+			insert((struct _timeout *)node);
+
+			irq_unlock(key);
+			key = irq_lock();
+		}
+	}
+
+	sys_dlist_t *slot_list = &_wheel.slots[0][_wheel.now & MASK];
+
+	while ((node = sys_dlist_get(slot_list)) != NULL) {
+		struct _timeout *timeout = (struct _timeout *)node;
+
+		sys_dlist_append(expired, node);
+		timeout->delta_ticks_from_prev = _EXPIRED;
+		--_wheel.num_active;
+
+		irq_unlock(key);
+		key = irq_lock();
+	}
+
+	_wheel.bmap[0] &= ~(1U << (_wheel.now & MASK));
+
+	return key;
+}
+
+/*
+ * Announce 'ticks' elapsed ticks to the wheel; the timeouts that expired are
+ * queued on 'expired' and marked as _EXPIRED.
+ *
+ * Must be called with interrupts unlocked.
+ */
+void _timeout_wheel_announce(int32_t ticks, sys_dlist_t *expired)
+{
+	unsigned int key = irq_lock();
+
+	while (ticks-- > 0) {
+		if (!_wheel.num_active) {
+			/* nothing to expire or cascade: just catch up */
+			_wheel.now += ticks + 1;
+			break;
+		}
+
+		key = advance_one_tick(expired, key);
+	}
+
+	irq_unlock(key);
+}
@@ -35,6 +35,32 @@ SYS_INIT(init_timer_module, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
 #endif /* CONFIG_OBJECT_TRACING */
 
+/*
+ * Re-arm an aligned periodic timer against its next absolute deadline rather
+ * than relative to the tick being processed, which may be late. Deadlines
+ * that have already passed are skipped and counted as overruns.
+ *
+ * Must be called with interrupts locked.
+ */
+static void rearm_aligned(struct k_timer *timer)
+{
+	uint32_t now = _tick_get_32();
+	int32_t ticks;
+
+	timer->deadline += timer->period;
+	ticks = (int32_t)(timer->deadline - now);
+
+	if (ticks <= 0) {
+		uint32_t missed = (uint32_t)(-ticks) / timer->period + 1;
+
+		timer->overruns += missed;
+		timer->deadline += missed * timer->period;
+		ticks += missed * timer->period;
+	}
+
+	_add_timeout(NULL, &timer->timeout, &timer->wait_q, ticks);
+}
+
 /**
  * @brief Handle expiration of a kernel timer object.
  *
@@ -54,8 +80,12 @@ void _timer_expiration_handler(struct _timeout *t)
 	 */
 	if (timer->period > 0) {
 		key = irq_lock();
-		_add_timeout(NULL, &timer->timeout, &timer->wait_q,
-				timer->period);
+		if (timer->aligned) {
+			rearm_aligned(timer);
+		} else {
+			_add_timeout(NULL, &timer->timeout, &timer->wait_q,
+					timer->period);
+		}
 		irq_unlock(key);
 	}
 
@@ -97,6 +127,8 @@ void k_timer_init(struct k_timer *timer,
 	timer->expiry_fn = expiry_fn;
 	timer->stop_fn = stop_fn;
 	timer->status = 0;
+	timer->aligned = 0;
+	timer->overruns = 0;
 
 	sys_dlist_init(&timer->wait_q);
 	_init_timeout(&timer->timeout, _timer_expiration_handler);
@@ -105,16 +137,26 @@ void k_timer_init(struct k_timer *timer,
 	timer->user_data = 0;
 }
 
+#ifdef CONFIG_TIMEOUT_SLACK
+void k_timer_slack_set(struct k_timer *timer, int32_t slack)
+{
+	_timeout_slack_set(&timer->timeout, slack);
+}
+#endif
 
-void k_timer_start(struct k_timer *timer, int32_t duration, int32_t period)
+
+static void start_timer(struct k_timer *timer, int32_t duration,
+			int32_t period, int aligned)
 {
-	__ASSERT(duration >= 0 && period >= 0 &&
+	__ASSERT(duration != K_FOREVER && period != K_FOREVER &&
 		 (duration != 0 || period != 0), "invalid parameters\n");
+	__ASSERT(period >= 0 || !((uint32_t)period & _K_TIMEOUT_ABS),
+		 "period cannot be absolute\n");
 
 	volatile int32_t period_in_ticks, duration_in_ticks;
 
-	period_in_ticks = _ms_to_ticks(period);
-	duration_in_ticks = _TICK_ALIGN + _ms_to_ticks(duration);
+	period_in_ticks = _timeout_to_ticks(period);
+	duration_in_ticks = _TICK_ALIGN + _timeout_to_ticks(duration);
 
 	unsigned int key = irq_lock();
 
@@ -123,12 +165,28 @@ void k_timer_start(struct k_timer *timer, int32_t duration, int32_t period)
 	}
 
 	timer->period = period_in_ticks;
+	timer->aligned = aligned;
+	timer->deadline = _tick_get_32() + duration_in_ticks;
+	timer->overruns = 0;
 	_add_timeout(NULL, &timer->timeout, &timer->wait_q, duration_in_ticks);
 	timer->status = 0;
 	irq_unlock(key);
 }
 
 
+void k_timer_start(struct k_timer *timer, int32_t duration, int32_t period)
+{
+	start_timer(timer, duration, period, 0);
+}
+
+
+void k_timer_start_aligned(struct k_timer *timer, int32_t duration,
+			   int32_t period)
+{
+	start_timer(timer, duration, period, 1);
+}
+
+
 void k_timer_stop(struct k_timer *timer)
 {
 	__ASSERT(!_is_in_isr(), "");
@@ -173,6 +231,18 @@ uint32_t k_timer_status_get(struct k_timer *timer)
 }
 
 
+uint32_t k_timer_overruns_get(struct k_timer *timer)
+{
+	unsigned int key = irq_lock();
+	uint32_t result = timer->overruns;
+
+	timer->overruns = 0;
+	irq_unlock(key);
+
+	return result;
+}
+
+
 uint32_t k_timer_status_sync(struct k_timer *timer)
 {
 	__ASSERT(!_is_in_isr(), "");
@@ -207,6 +277,9 @@ int32_t _timeout_remaining_get(struct _timeout *timeout)
 	unsigned int key = irq_lock();
 	int32_t remaining_ticks;
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+	remaining_ticks = _timeout_wheel_remaining(timeout);
+#else
 	if (timeout->delta_ticks_from_prev == _INACTIVE) {
 		remaining_ticks = 0;
 	} else {
@@ -224,6 +297,15 @@ int32_t _timeout_remaining_get(struct _timeout *timeout)
 			remaining_ticks += t->delta_ticks_from_prev;
 		}
 	}
+#endif
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* the queue is relative to the last announced tick */
+	if (remaining_ticks > 0) {
+		remaining_ticks = max(remaining_ticks -
+				      (int32_t)_get_elapsed_program_time(), 0);
+	}
+#endif
 
 	irq_unlock(key);
 	return __ticks_to_ms(remaining_ticks);
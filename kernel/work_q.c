@@ -14,10 +14,12 @@
 #include <kernel_structs.h>
 #include <wait_q.h>
 #include <errno.h>
+#include <misc/__assert.h>
 
 static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 {
 	struct k_work_q *work_q = work_q_ptr;
+	int ordered = work_q->options & K_WORK_Q_ORDERED;
 
 	ARG_UNUSED(p2);
 	ARG_UNUSED(p3);
@@ -25,6 +27,12 @@ static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 	while (1) {
 		struct k_work *work;
 		k_work_handler_t handler;
+		void *token = NULL;
+
+		/* Only the thread of an ordered pool holding the token runs */
+		if (ordered) {
+			token = k_fifo_get(&work_q->order, K_FOREVER);
+		}
 
 		work = k_fifo_get(&work_q->fifo, K_FOREVER);
 
@@ -36,6 +44,10 @@ static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 			handler(work);
 		}
 
+		if (ordered) {
+			k_fifo_put(&work_q->order, token);
+		}
+
 		/* Make sure we don't hog up the CPU if the FIFO never (or
 		 * very rarely) gets empty.
 		 */
@@ -43,14 +55,28 @@ static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 	}
 }
 
-void k_work_q_start(struct k_work_q *work_q, char *stack,
-		    size_t stack_size, int prio)
+void k_work_q_start_pool(struct k_work_q *work_q, char *stack,
+			 size_t stack_size, int num_threads, int prio,
+			 uint32_t options)
 {
+	__ASSERT(num_threads > 0, "workqueue needs at least one thread\n");
+
 	k_fifo_init(&work_q->fifo);
+	k_fifo_init(&work_q->order);
+	k_fifo_put(&work_q->order, &work_q->order_token);
+	work_q->options = options;
+
+	for (int i = 0; i < num_threads; i++) {
+		k_thread_spawn(stack + i * stack_size, stack_size,
+			       work_q_main, work_q, 0, 0,
+			       prio, 0, 0);
+	}
+}
 
-	k_thread_spawn(stack, stack_size,
-		       work_q_main, work_q, 0, 0,
-		       prio, 0, 0);
+void k_work_q_start(struct k_work_q *work_q, char *stack,
+		    size_t stack_size, int prio)
+{
+	k_work_q_start_pool(work_q, stack, stack_size, 1, prio, 0);
 }
 
 #ifdef CONFIG_SYS_CLOCK_EXISTS
@@ -72,6 +98,13 @@ void k_delayed_work_init(struct k_delayed_work *work, k_work_handler_t handler)
 	work->work_q = NULL;
 }
 
+#ifdef CONFIG_TIMEOUT_SLACK
+void k_delayed_work_slack_set(struct k_delayed_work *work, int32_t slack)
+{
+	_timeout_slack_set(&work->timeout, slack);
+}
+#endif
+
 int k_delayed_work_submit_to_queue(struct k_work_q *work_q,
 				   struct k_delayed_work *work,
 				   int32_t delay)
@@ -102,7 +135,7 @@ int k_delayed_work_submit_to_queue(struct k_work_q *work_q,
 	} else {
 		/* Add timeout */
 		_add_timeout(NULL, &work->timeout, NULL,
-				_TICK_ALIGN + _ms_to_ticks(delay));
+				_TICK_ALIGN + _timeout_to_ticks(delay));
 	}
 
 	err = 0;
@@ -0,0 +1,337 @@
+/* mem_opt.c - optimized memory copy and initialization routines */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Used instead of the generic routines of string.c when
+ * CONFIG_MINIMAL_LIBC_OPTIMIZED_MEM is enabled.
+ *
+ * x86 moves data with string instructions, which handle misaligned
+ * buffers themselves. Other architectures align the destination, then
+ * copy with unrolled word loops (LDM/STM on ARM) when the source has the
+ * same alignment, or by combining shifted aligned source words when it
+ * does not.
+ *
+ * SSE is not used on x86: the FPU/SSE context of a thread is only saved
+ * when it asked for it, using those registers here would corrupt the
+ * state of other threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(CONFIG_RAMFUNC_MEMCPY)
+#include <toolchain.h>
+#include <sections.h>
+#define MEM_RAMFUNC __ramfunc
+#else
+#define MEM_RAMFUNC
+#endif
+
+/* Copies below this size are done byte per byte */
+#define MEM_SMALL 16
+
+typedef uint32_t mem_word_t;
+
+#define WORD_SIZE sizeof(mem_word_t)
+#define WORD_MASK (WORD_SIZE - 1)
+
+#if defined(CONFIG_X86)
+
+static inline void mem_forward(unsigned char *d, const unsigned char *s,
+			       size_t n)
+{
+	int d0, d1, d2;
+
+	/* The direction flag is clear, as required by the ABI */
+	__asm__ volatile("rep movsl\n\t"
+			 "movl %4, %%ecx\n\t"
+			 "rep movsb"
+			 : "=&c" (d0), "=&D" (d1), "=&S" (d2)
+			 : "0" (n / 4), "g" (n & 3), "1" (d), "2" (s)
+			 : "memory");
+}
+
+MEM_RAMFUNC void *memset(void *buf, int c, size_t n)
+{
+	mem_word_t c_word = (unsigned char)c * 0x01010101U;
+	int d0, d1;
+
+	__asm__ volatile("rep stosl\n\t"
+			 "movl %3, %%ecx\n\t"
+			 "rep stosb"
+			 : "=&c" (d0), "=&D" (d1)
+			 : "a" (c_word), "g" (n & 3), "0" (n / 4), "1" (buf)
+			 : "memory");
+
+	return buf;
+}
+
+#else /* CONFIG_X86 */
+
+/* Copy 8 words per iteration between word aligned buffers */
+static inline void mem_copy_blocks(mem_word_t **d, const mem_word_t **s,
+				   size_t blocks)
+{
+	mem_word_t *d_word = *d;
+	const mem_word_t *s_word = *s;
+
+	while (blocks--) {
+#if defined(CONFIG_ARM)
+		/* Low registers only, for ARMv6-M */
+		__asm__ volatile("ldmia %1!, {r3-r6}\n\t"
+				 "stmia %0!, {r3-r6}\n\t"
+				 "ldmia %1!, {r3-r6}\n\t"
+				 "stmia %0!, {r3-r6}"
+				 : "+l" (d_word), "+l" (s_word)
+				 :
+				 : "r3", "r4", "r5", "r6", "memory");
+#else
+		mem_word_t w0 = s_word[0], w1 = s_word[1];
+		mem_word_t w2 = s_word[2], w3 = s_word[3];
+
+		d_word[0] = w0;
+		d_word[1] = w1;
+		d_word[2] = w2;
+		d_word[3] = w3;
+
+		w0 = s_word[4];
+		w1 = s_word[5];
+		w2 = s_word[6];
+		w3 = s_word[7];
+
+		d_word[4] = w0;
+		d_word[5] = w1;
+		d_word[6] = w2;
+		d_word[7] = w3;
+
+		d_word += 8;
+		s_word += 8;
+#endif
+	}
+
+	*d = d_word;
+	*s = s_word;
+}
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define MERGE(prev, next, shift) \
+	(((prev) >> (shift)) | ((next) << (32 - (shift))))
+#else
+#define MERGE(prev, next, shift) \
+	(((prev) << (shift)) | ((next) >> (32 - (shift))))
+#endif
+
+/*
+ * Copy words to an aligned destination from a misaligned source, reading
+ * the source with aligned loads only. The last word read may hold bytes
+ * past the end of the source, but never crosses a word boundary.
+ */
+static inline void mem_copy_shifted(mem_word_t **d, const unsigned char **s,
+				    size_t words)
+{
+	unsigned int offset = (uintptr_t)*s & WORD_MASK;
+	unsigned int shift = offset * 8;
+	const mem_word_t *s_word = (const mem_word_t *)(*s - offset);
+	mem_word_t *d_word = *d;
+	mem_word_t prev, next;
+
+	prev = *s_word++;
+
+	while (words >= 4) {
+		next = s_word[0];
+		d_word[0] = MERGE(prev, next, shift);
+		prev = s_word[1];
+		d_word[1] = MERGE(next, prev, shift);
+		next = s_word[2];
+		d_word[2] = MERGE(prev, next, shift);
+		prev = s_word[3];
+		d_word[3] = MERGE(next, prev, shift);
+
+		s_word += 4;
+		d_word += 4;
+		words -= 4;
+	}
+
+	while (words--) {
+		next = *s_word++;
+		*d_word++ = MERGE(prev, next, shift);
+		prev = next;
+	}
+
+	*d = d_word;
+	*s = (const unsigned char *)(s_word - 1) + offset;
+}
+
+/* Copy forwards, also used by memmove() when the destination comes first */
+MEM_RAMFUNC static inline void mem_forward(unsigned char *d_byte,
+					   const unsigned char *s_byte,
+					   size_t n)
+{
+	mem_word_t *d_word;
+	const mem_word_t *s_word;
+
+	if (n >= MEM_SMALL) {
+		/* do byte-sized copying until the destination is aligned */
+		while ((uintptr_t)d_byte & WORD_MASK) {
+			*(d_byte++) = *(s_byte++);
+			n--;
+		}
+
+		d_word = (mem_word_t *)d_byte;
+
+		if ((uintptr_t)s_byte & WORD_MASK) {
+			mem_copy_shifted(&d_word, &s_byte, n / WORD_SIZE);
+		} else {
+			s_word = (const mem_word_t *)s_byte;
+
+			mem_copy_blocks(&d_word, &s_word, n / (8 * WORD_SIZE));
+
+			n &= 8 * WORD_SIZE - 1;
+			while (n >= WORD_SIZE) {
+				*(d_word++) = *(s_word++);
+				n -= WORD_SIZE;
+			}
+
+			s_byte = (const unsigned char *)s_word;
+		}
+
+		d_byte = (unsigned char *)d_word;
+		n &= WORD_MASK;
+	}
+
+	/* do byte-sized copying until finished */
+	while (n > 0) {
+		*(d_byte++) = *(s_byte++);
+		n--;
+	}
+}
+
+MEM_RAMFUNC void *memset(void *buf, int c, size_t n)
+{
+	unsigned char *d_byte = buf;
+	unsigned char c_byte = (unsigned char)c;
+	mem_word_t c_word = c_byte * 0x01010101U;
+	mem_word_t *d_word;
+	size_t blocks;
+
+	if (n >= MEM_SMALL) {
+		/* do byte-sized initialization until word-aligned */
+		while ((uintptr_t)d_byte & WORD_MASK) {
+			*(d_byte++) = c_byte;
+			n--;
+		}
+
+		d_word = (mem_word_t *)d_byte;
+
+		for (blocks = n / (8 * WORD_SIZE); blocks; blocks--) {
+#if defined(CONFIG_ARM)
+			register mem_word_t r3 __asm__("r3") = c_word;
+			register mem_word_t r4 __asm__("r4") = c_word;
+			register mem_word_t r5 __asm__("r5") = c_word;
+			register mem_word_t r6 __asm__("r6") = c_word;
+
+			__asm__ volatile("stmia %0!, {r3-r6}\n\t"
+					 "stmia %0!, {r3-r6}"
+					 : "+l" (d_word)
+					 : "r" (r3), "r" (r4), "r" (r5), "r" (r6)
+					 : "memory");
+#else
+			d_word[0] = c_word;
+			d_word[1] = c_word;
+			d_word[2] = c_word;
+			d_word[3] = c_word;
+			d_word[4] = c_word;
+			d_word[5] = c_word;
+			d_word[6] = c_word;
+			d_word[7] = c_word;
+			d_word += 8;
+#endif
+		}
+
+		n &= 8 * WORD_SIZE - 1;
+		while (n >= WORD_SIZE) {
+			*(d_word++) = c_word;
+			n -= WORD_SIZE;
+		}
+
+		d_byte = (unsigned char *)d_word;
+	}
+
+	/* do byte-sized initialization until finished */
+	while (n > 0) {
+		*(d_byte++) = c_byte;
+		n--;
+	}
+
+	return buf;
+}
+
+#endif /* CONFIG_X86 */
+
+/**
+ *
+ * @brief Copy bytes in memory
+ *
+ * @return pointer to start of destination buffer
+ */
+
+MEM_RAMFUNC void *memcpy(void *_Restrict d, const void *_Restrict s, size_t n)
+{
+	mem_forward(d, s, n);
+
+	return d;
+}
+
+/**
+ *
+ * @brief Copy bytes in memory with overlapping areas
+ *
+ * @return pointer to destination buffer <d>
+ */
+
+void *memmove(void *d, const void *s, size_t n)
+{
+	unsigned char *dest = d;
+	const unsigned char *src = s;
+	mem_word_t *d_word;
+	const mem_word_t *s_word;
+
+	if ((size_t)(dest - src) >= n) {
+		/* It is safe to perform a forward-copy */
+		mem_forward(dest, src, n);
+		return d;
+	}
+
+	/*
+	 * The <src> buffer overlaps with the start of the <dest> buffer.
+	 * Copy backwards to prevent the premature corruption of <src>,
+	 * word per word when the buffers have the same alignment.
+	 */
+	if ((((uintptr_t)dest ^ (uintptr_t)src) & WORD_MASK) == 0) {
+		while (n > 0 && ((uintptr_t)(dest + n) & WORD_MASK)) {
+			n--;
+			dest[n] = src[n];
+		}
+
+		d_word = (mem_word_t *)(dest + n);
+		s_word = (const mem_word_t *)(src + n);
+
+		while (n >= WORD_SIZE) {
+			*(--d_word) = *(--s_word);
+			n -= WORD_SIZE;
+		}
+	}
+
+	while (n > 0) {
+		n--;
+		dest[n] = src[n];
+	}
+
+	return d;
+}
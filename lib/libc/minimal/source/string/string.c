@@ -8,6 +8,14 @@
 
 #include <string.h>
 
+#if defined(CONFIG_RAMFUNC_MEMCPY)
+#include <toolchain.h>
+#include <sections.h>
+#define MEM_RAMFUNC __ramfunc
+#else
+#define MEM_RAMFUNC
+#endif
+
 /**
  *
  * @brief Copy a string
@@ -190,6 +198,7 @@ int memcmp(const void *m1, const void *m2, size_t n)
 	return *c1 - *c2;
 }
 
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZED_MEM
 /**
  *
  * @brief Copy bytes in memory with overlapping areas
@@ -232,7 +241,7 @@ void *memmove(void *d, const void *s, size_t n)
  * @return pointer to start of destination buffer
  */
 
-void *memcpy(void *_Restrict d, const void *_Restrict s, size_t n)
+MEM_RAMFUNC void *memcpy(void *_Restrict d, const void *_Restrict s, size_t n)
 {
 	/* attempt word-sized copying only if buffers have identical alignment */
 
@@ -282,7 +291,7 @@ void *memcpy(void *_Restrict d, const void *_Restrict s, size_t n)
  * @return pointer to start of buffer
  */
 
-void *memset(void *buf, int c, size_t n)
+MEM_RAMFUNC void *memset(void *buf, int c, size_t n)
 {
 	/* do byte-sized initialization until word-aligned or finished */
 
@@ -322,6 +331,8 @@ void *memset(void *buf, int c, size_t n)
 	return buf;
 }
 
+#endif /* !CONFIG_MINIMAL_LIBC_OPTIMIZED_MEM */
+
 /**
  *
  * @brief Scan byte in memory
@@ -0,0 +1,267 @@
+/* byte_ring.c: Lock-free byte ring buffer API */
+
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Indices are free-running byte counts, masked when accessing the data area:
+ * the ring is empty when they are equal and full when they are 'size' apart,
+ * so that all of the data area can be used. The consumer only writes 'head'
+ * and the producers only write 'tail', after the bytes they cover have been
+ * copied, so neither side needs to lock out the other.
+ */
+
+#include <misc/byte_ring.h>
+#include <string.h>
+
+static inline uint32_t offset_of(struct byte_ring *ring, uint32_t index)
+{
+	return index & (ring->size - 1);
+}
+
+uint32_t sys_byte_ring_put_claim(struct byte_ring *ring, uint8_t **data,
+				 uint32_t size)
+{
+	uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+	uint32_t head = (uint32_t)atomic_get(&ring->head);
+	uint32_t offset = offset_of(ring, tail);
+
+	size = min(size, ring->size - (tail - head));
+	size = min(size, ring->size - offset);
+
+	*data = &ring->buf[offset];
+
+	return size;
+}
+
+void sys_byte_ring_put_finish(struct byte_ring *ring, uint32_t size)
+{
+	__ASSERT(size <= sys_byte_ring_space_get(ring), "overflow\n");
+
+	atomic_add(&ring->tail, size);
+}
+
+uint32_t sys_byte_ring_put(struct byte_ring *ring, const uint8_t *data,
+			   uint32_t size)
+{
+	uint32_t written = 0, claimed;
+	uint8_t *dst;
+
+	/* at most two contiguous areas: up to the end, then from the start */
+	while (written < size) {
+		claimed = sys_byte_ring_put_claim(ring, &dst, size - written);
+		if (!claimed) {
+			break;
+		}
+
+		memcpy(dst, data + written, claimed);
+		sys_byte_ring_put_finish(ring, claimed);
+		written += claimed;
+	}
+
+	return written;
+}
+
+uint32_t sys_byte_ring_get_claim(struct byte_ring *ring, uint8_t **data,
+				 uint32_t size)
+{
+	uint32_t head = (uint32_t)atomic_get(&ring->head);
+	uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+	uint32_t offset = offset_of(ring, head);
+
+	size = min(size, tail - head);
+	size = min(size, ring->size - offset);
+
+	*data = &ring->buf[offset];
+
+	return size;
+}
+
+void sys_byte_ring_get_finish(struct byte_ring *ring, uint32_t size)
+{
+	__ASSERT(size <= sys_byte_ring_used_get(ring), "underflow\n");
+
+	atomic_add(&ring->head, size);
+}
+
+uint32_t sys_byte_ring_get(struct byte_ring *ring, uint8_t *data,
+			   uint32_t size)
+{
+	uint32_t read = 0, claimed;
+	uint8_t *src;
+
+	while (read < size) {
+		claimed = sys_byte_ring_get_claim(ring, &src, size - read);
+		if (!claimed) {
+			break;
+		}
+
+		memcpy(data + read, src, claimed);
+		sys_byte_ring_get_finish(ring, claimed);
+		read += claimed;
+	}
+
+	return read;
+}
+
+/*
+ * A multi-producer ring stores records, each made of a header word followed
+ * by its bytes, padded to a whole number of words so that headers are always
+ * aligned. Producers reserve a record by advancing 'tail', then write it,
+ * then commit it by writing its header; the consumer stops at the first
+ * record whose header is still zero. Records never wrap around: when one does
+ * not fit before the end of the data area, a padding record fills the end.
+ * The consumer zeroes the records it releases, so that the data area beyond
+ * the committed records never contains anything that looks like a header.
+ */
+
+#define MP_COMMITTED (1U << 31)
+#define MP_PADDING (1U << 30)
+#define MP_LEN_MASK (MP_PADDING - 1)
+
+#define HDR_SIZE sizeof(uint32_t)
+
+static inline uint32_t mp_total(uint32_t len)
+{
+	return HDR_SIZE + ROUND_UP(len, HDR_SIZE);
+}
+
+static inline atomic_t *mp_hdr(struct byte_ring_mp *ring, uint32_t index)
+{
+	return (atomic_t *)&ring->buf[(index & (ring->size - 1)) / HDR_SIZE];
+}
+
+void sys_byte_ring_mp_init(struct byte_ring_mp *ring, uint32_t size,
+			   uint32_t *data)
+{
+	__ASSERT(is_power_of_two(size) && size >= 2 * HDR_SIZE,
+		 "size must be a power of 2\n");
+
+	ring->head = 0;
+	ring->tail = 0;
+	ring->size = size;
+	ring->buf = data;
+	memset(data, 0, size);
+}
+
+int sys_byte_ring_mp_put_claim(struct byte_ring_mp *ring, uint8_t **data,
+			       uint32_t size)
+{
+	uint32_t total = mp_total(size);
+	uint32_t tail, offset, pad;
+
+	/* larger records might never find room around a padding record */
+	if (total > ring->size / 2) {
+		return -EMSGSIZE;
+	}
+
+	do {
+		tail = (uint32_t)atomic_get(&ring->tail);
+		offset = tail & (ring->size - 1);
+		pad = (total > ring->size - offset) ? ring->size - offset : 0;
+
+		if (pad + total >
+		    ring->size - (tail - (uint32_t)atomic_get(&ring->head))) {
+			return -ENOMEM;
+		}
+	} while (!atomic_cas(&ring->tail, tail, tail + pad + total));
+
+	if (pad) {
+		atomic_set(mp_hdr(ring, tail),
+			   MP_COMMITTED | MP_PADDING | (pad - HDR_SIZE));
+		tail += pad;
+	}
+
+	/* not committed yet: the consumer waits for this record */
+	atomic_set(mp_hdr(ring, tail), size);
+	*data = (uint8_t *)mp_hdr(ring, tail) + HDR_SIZE;
+
+	return 0;
+}
+
+void sys_byte_ring_mp_put_finish(struct byte_ring_mp *ring, uint8_t *data)
+{
+	atomic_t *hdr = (atomic_t *)(data - HDR_SIZE);
+
+	__ASSERT(!(atomic_get(hdr) & MP_COMMITTED), "not claimed\n");
+
+	atomic_or(hdr, MP_COMMITTED);
+}
+
+int sys_byte_ring_mp_put(struct byte_ring_mp *ring, const uint8_t *data,
+			 uint32_t size)
+{
+	uint8_t *dst;
+	int rc;
+
+	rc = sys_byte_ring_mp_put_claim(ring, &dst, size);
+	if (rc == 0) {
+		memcpy(dst, data, size);
+		sys_byte_ring_mp_put_finish(ring, dst);
+	}
+
+	return rc;
+}
+
+int sys_byte_ring_mp_get_claim(struct byte_ring_mp *ring, uint8_t **data)
+{
+	uint32_t head = (uint32_t)atomic_get(&ring->head);
+	uint32_t hdr;
+
+	for (;;) {
+		hdr = (uint32_t)atomic_get(mp_hdr(ring, head));
+
+		if (!(hdr & MP_COMMITTED)) {
+			return -EAGAIN;
+		}
+
+		if (!(hdr & MP_PADDING)) {
+			break;
+		}
+
+		/* skip to the start of the data area */
+		sys_byte_ring_mp_get_finish(ring);
+		head = (uint32_t)atomic_get(&ring->head);
+	}
+
+	*data = (uint8_t *)mp_hdr(ring, head) + HDR_SIZE;
+
+	return hdr & MP_LEN_MASK;
+}
+
+void sys_byte_ring_mp_get_finish(struct byte_ring_mp *ring)
+{
+	uint32_t head = (uint32_t)atomic_get(&ring->head);
+	atomic_t *hdr = mp_hdr(ring, head);
+	uint32_t total = mp_total((uint32_t)atomic_get(hdr) & MP_LEN_MASK);
+
+	__ASSERT(atomic_get(hdr) & MP_COMMITTED, "no record claimed\n");
+
+	/* zeroed before being handed back to the producers */
+	memset(hdr, 0, total);
+	atomic_add(&ring->head, total);
+}
+
+int sys_byte_ring_mp_get(struct byte_ring_mp *ring, uint8_t *data,
+			 uint32_t size)
+{
+	uint8_t *src;
+	int len;
+
+	len = sys_byte_ring_mp_get_claim(ring, &src);
+	if (len < 0) {
+		return len;
+	}
+
+	if ((uint32_t)len > size) {
+		return -EMSGSIZE;
+	}
+
+	memcpy(data, src, len);
+	sys_byte_ring_mp_get_finish(ring);
+
+	return len;
+}
@@ -16,6 +16,10 @@
 #include <stdarg.h>
 #include <toolchain.h>
 #include <sections.h>
+#ifdef CONFIG_PRINTK_DEFERRED
+#include <kernel.h>
+#include <atomic.h>
+#endif
 
 typedef int (*out_func_t)(int c, void *ctx);
 
@@ -166,6 +170,36 @@ still_might_format:
 	}
 }
 
+#if CONFIG_PRINTK_BUFFER_SIZE > 0
+struct out_context {
+	int count;
+	unsigned int len;
+	char buf[CONFIG_PRINTK_BUFFER_SIZE];
+};
+
+static void buf_flush(struct out_context *ctx)
+{
+	unsigned int i;
+
+	for (i = 0; i < ctx->len; i++) {
+		_char_out(ctx->buf[i]);
+	}
+
+	ctx->len = 0;
+}
+
+static int char_out(int c, struct out_context *ctx)
+{
+	ctx->count++;
+	ctx->buf[ctx->len++] = c;
+
+	if (ctx->len == sizeof(ctx->buf)) {
+		buf_flush(ctx);
+	}
+
+	return c;
+}
+#else
 struct out_context {
 	int count;
 };
@@ -175,6 +209,7 @@ static int char_out(int c, struct out_context *ctx)
 	ctx->count++;
 	return _char_out(c);
 }
+#endif /* CONFIG_PRINTK_BUFFER_SIZE > 0 */
 
 /**
  * @brief Output a string
@@ -196,16 +231,40 @@ static int char_out(int c, struct out_context *ctx)
  */
 int printk(const char *fmt, ...)
 {
-	struct out_context ctx = { 0 };
+	struct out_context ctx;
 	va_list ap;
 
+	ctx.count = 0;
+#if CONFIG_PRINTK_BUFFER_SIZE > 0
+	ctx.len = 0;
+#endif
+
 	va_start(ap, fmt);
 	_vprintk((out_func_t)char_out, &ctx, fmt, ap);
 	va_end(ap);
 
+#if CONFIG_PRINTK_BUFFER_SIZE > 0
+	if (ctx.len) {
+		buf_flush(&ctx);
+	}
+#endif
+
 	return ctx.count;
 }
 
+/* Output the digits of a number, stored backwards, after their padding */
+static void _printk_digits(out_func_t out, void *ctx, const char *digits,
+			   int len, int pad_zero, int min_width)
+{
+	for (; min_width > len; min_width--) {
+		out((int)(pad_zero ? '0' : ' '), ctx);
+	}
+
+	while (len) {
+		out((int)digits[--len], ctx);
+	}
+}
+
 /**
  * @brief Output an unsigned long in hex format
  *
@@ -219,31 +278,25 @@ static void _printk_hex_ulong(out_func_t out, void *ctx,
 			      const unsigned long num, int pad_zero,
 			      int min_width)
 {
-	int size = sizeof(num) * 2;
-	int found_largest_digit = 0;
-	int remaining = 8; /* 8 digits max */
+	char digits[sizeof(num) * 2];
+	unsigned long remainder = num;
+	int len = 0;
 
-	for (; size; size--) {
-		char nibble = (num >> ((size - 1) << 2) & 0xf);
+	do {
+		digits[len++] = "0123456789abcdef"[remainder & 0xf];
+		remainder >>= 4;
+	} while (remainder);
 
-		if (nibble || found_largest_digit || size == 1) {
-			found_largest_digit = 1;
-			nibble += nibble > 9 ? 87 : 48;
-			out((int)nibble, ctx);
-			continue;
-		}
-
-		if (remaining-- <= min_width) {
-			out((int)(pad_zero ? '0' : ' '), ctx);
-		}
-	}
+	/* 8 digits max */
+	_printk_digits(out, ctx, digits, len, pad_zero,
+		       min_width > 8 ? 8 : min_width);
 }
 
 /**
- * @brief Output an unsigned long (32-bit) in decimal format
+ * @brief Output an unsigned long in decimal format
  *
- * Output an unsigned long on output installed by platform at init time. Only
- * works with 32-bit values.
+ * Output an unsigned long on output installed by platform at init time.
+ * Digits are found from the lowest one, one division per digit.
  * @param num Number to output
  *
  * @return N/A
@@ -252,28 +305,20 @@ static void _printk_dec_ulong(out_func_t out, void *ctx,
 			      const unsigned long num, int pad_zero,
 			      int min_width)
 {
-	unsigned long pos = 999999999;
+	char digits[sizeof(num) * 3];
 	unsigned long remainder = num;
-	int found_largest_digit = 0;
-	int remaining = 10; /* 10 digits max */
-
-	/* make sure we don't skip if value is zero */
-	if (min_width <= 0) {
-		min_width = 1;
-	}
-
-	while (pos >= 9) {
-		if (found_largest_digit || remainder > pos) {
-			found_largest_digit = 1;
-			out((int)((remainder / (pos + 1)) + 48), ctx);
-		} else if (remaining <= min_width) {
-			out((int)(pad_zero ? '0' : ' '), ctx);
-		}
-		remaining--;
-		remainder %= (pos + 1);
-		pos /= 10;
-	}
-	out((int)(remainder + 48), ctx);
+	unsigned long quotient;
+	int len = 0;
+
+	do {
+		quotient = remainder / 10;
+		digits[len++] = '0' + (remainder - quotient * 10);
+		remainder = quotient;
+	} while (remainder);
+
+	/* 10 digits max */
+	_printk_digits(out, ctx, digits, len, pad_zero,
+		       min_width > 10 ? 10 : min_width);
 }
 
 struct str_context {
@@ -326,3 +371,114 @@ int vsnprintk(char *str, size_t size, const char *fmt, va_list ap)
 
 	return ctx.count;
 }
+
+#ifdef CONFIG_PRINTK_DEFERRED
+#define PRINTK_DEFERRED_MAX_ARGS 10
+
+struct printk_deferred_msg {
+	const char *fmt;
+	unsigned long args[PRINTK_DEFERRED_MAX_ARGS];
+};
+
+K_MSGQ_DEFINE(printk_deferred_q, sizeof(struct printk_deferred_msg),
+	      CONFIG_PRINTK_DEFERRED_QUEUE_SIZE, 4);
+
+static atomic_t printk_deferred_dropped;
+
+/* Number of arguments a format string consumes, as _vprintk() does */
+static int printk_deferred_nargs(const char *fmt)
+{
+	int n = 0;
+
+	while (*fmt) {
+		if (*fmt++ != '%') {
+			continue;
+		}
+
+		while ((*fmt >= '0' && *fmt <= '9') || *fmt == 'z' ||
+		       *fmt == 'l' || *fmt == 'h') {
+			fmt++;
+		}
+
+		switch (*fmt) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'p':
+		case 'x':
+		case 'X':
+		case 's':
+		case 'c':
+			n++;
+			break;
+		case '\0':
+			return n;
+		}
+
+		fmt++;
+	}
+
+	return n;
+}
+
+void printk_deferred(const char *fmt, ...)
+{
+	struct printk_deferred_msg msg;
+	va_list ap;
+	int n, i;
+
+	n = printk_deferred_nargs(fmt);
+
+	va_start(ap, fmt);
+
+	if (n > PRINTK_DEFERRED_MAX_ARGS) {
+		struct out_context ctx = { 0 };
+
+		_vprintk((out_func_t)char_out, &ctx, fmt, ap);
+#if CONFIG_PRINTK_BUFFER_SIZE > 0
+		if (ctx.len) {
+			buf_flush(&ctx);
+		}
+#endif
+		va_end(ap);
+		return;
+	}
+
+	/* printk() arguments are all word sized */
+	msg.fmt = fmt;
+	for (i = 0; i < n; i++) {
+		msg.args[i] = va_arg(ap, unsigned long);
+	}
+
+	va_end(ap);
+
+	if (k_msgq_put(&printk_deferred_q, &msg, K_NO_WAIT)) {
+		atomic_inc(&printk_deferred_dropped);
+	}
+}
+
+static void printk_deferred_thread(void)
+{
+	struct printk_deferred_msg msg;
+	unsigned long *a = msg.args;
+	atomic_val_t dropped;
+
+	while (1) {
+		k_msgq_get(&printk_deferred_q, &msg, K_FOREVER);
+
+		/* Unused trailing arguments are ignored */
+		printk(msg.fmt, a[0], a[1], a[2], a[3], a[4], a[5], a[6],
+		       a[7], a[8], a[9]);
+
+		dropped = atomic_set(&printk_deferred_dropped, 0);
+		if (dropped) {
+			printk("printk: %u messages dropped\n",
+			       (unsigned int)dropped);
+		}
+	}
+}
+
+K_THREAD_DEFINE(printk_deferred_id, CONFIG_PRINTK_DEFERRED_STACK_SIZE,
+		printk_deferred_thread, NULL, NULL, NULL,
+		CONFIG_PRINTK_DEFERRED_THREAD_PRIORITY, 0, K_NO_WAIT);
+#endif /* CONFIG_PRINTK_DEFERRED */
@@ -0,0 +1,710 @@
+/* main.c - Bluetooth LE throughput and latency benchmark */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <misc/byteorder.h>
+#include <misc/util.h>
+#include <shell/shell.h>
+
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/hci.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/uuid.h>
+#include <bluetooth/gatt.h>
+#include <bluetooth/l2cap.h>
+
+#define MY_SHELL_MODULE "tp"
+
+/* LE dynamic PSM of the benchmark L2CAP server */
+#define TP_PSM			0x0080
+#define TP_DATA_MAX		(CONFIG_BLUETOOTH_L2CAP_TX_MTU - 3)
+#define TP_L2CAP_MTU		(CONFIG_BLUETOOTH_L2CAP_TX_MTU - 2)
+
+/* First byte of every GATT payload */
+#define TP_OP_DATA		0x00
+#define TP_OP_PING		0x01
+
+#define TP_PING_TIMEOUT		K_SECONDS(2)
+
+static struct bt_conn *default_conn;
+static uint16_t conn_interval;
+
+static struct {
+	uint32_t bytes;
+	uint32_t pdus;
+	int64_t first;
+	int64_t last;
+} rx_stats;
+
+/* 32b6cd1c-3e1c-4f3a-9a53-2a4c1b0e0001 */
+static struct bt_uuid_128 tp_uuid = BT_UUID_INIT_128(
+	0x01, 0x00, 0x0e, 0x1b, 0x4c, 0x2a, 0x53, 0x9a,
+	0x3a, 0x4f, 0x1c, 0x3e, 0x1c, 0xcd, 0xb6, 0x32);
+
+/* 32b6cd1c-3e1c-4f3a-9a53-2a4c1b0e0002 */
+static struct bt_uuid_128 tp_data_uuid = BT_UUID_INIT_128(
+	0x02, 0x00, 0x0e, 0x1b, 0x4c, 0x2a, 0x53, 0x9a,
+	0x3a, 0x4f, 0x1c, 0x3e, 0x1c, 0xcd, 0xb6, 0x32);
+
+static uint8_t tx_data[TP_DATA_MAX];
+
+static void rx_count(uint16_t len)
+{
+	int64_t now = k_uptime_get();
+
+	if (!rx_stats.pdus) {
+		rx_stats.first = now;
+	}
+
+	rx_stats.last = now;
+	rx_stats.bytes += len;
+	rx_stats.pdus++;
+}
+
+static void print_rate(const char *what, uint32_t bytes, uint32_t pdus,
+		       uint32_t ms)
+{
+	uint32_t events;
+
+	if (!ms) {
+		ms = 1;
+	}
+
+	printk("%s: %u bytes, %u PDUs in %u ms, %u bytes/s\n", what, bytes,
+	       pdus, ms, (uint32_t)((uint64_t)bytes * 1000 / ms));
+
+	if (!conn_interval) {
+		return;
+	}
+
+	/* The interval is in 1.25 ms units */
+	events = ((uint64_t)ms * 4 + conn_interval * 5 - 1) /
+		 (conn_interval * 5);
+	printk("%s: interval %u.%02u ms, %u.%02u PDUs per event\n", what,
+	       conn_interval * 5 / 4, (conn_interval * 125) % 100,
+	       pdus / events, (pdus % events) * 100 / events);
+}
+
+/* GATT server side */
+
+static struct bt_gatt_ccc_cfg tp_ccc_cfg[CONFIG_BLUETOOTH_MAX_PAIRED] = {};
+static uint8_t tp_notify;
+
+static void tp_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	tp_notify = (value == BT_GATT_CCC_NOTIFY) ? 1 : 0;
+}
+
+static ssize_t write_tp(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			const void *buf, uint16_t len, uint16_t offset,
+			uint8_t flags);
+
+static struct bt_gatt_attr tp_attrs[] = {
+	BT_GATT_PRIMARY_SERVICE(&tp_uuid),
+	BT_GATT_CHARACTERISTIC(&tp_data_uuid.uuid,
+			       BT_GATT_CHRC_WRITE_WITHOUT_RESP |
+			       BT_GATT_CHRC_NOTIFY),
+	BT_GATT_DESCRIPTOR(&tp_data_uuid.uuid, BT_GATT_PERM_WRITE, NULL,
+			   write_tp, NULL),
+	BT_GATT_CCC(tp_ccc_cfg, tp_ccc_cfg_changed),
+};
+
+static ssize_t write_tp(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			const void *buf, uint16_t len, uint16_t offset,
+			uint8_t flags)
+{
+	const uint8_t *data = buf;
+
+	if (offset || !len) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+	}
+
+	if (data[0] == TP_OP_PING) {
+		/* Echo pings back so the client can time the round trip */
+		bt_gatt_notify(conn, &tp_attrs[2], buf, len);
+		return len;
+	}
+
+	rx_count(len);
+
+	return len;
+}
+
+/* GATT client side */
+
+static struct bt_gatt_discover_params discover_params;
+static struct bt_gatt_subscribe_params subscribe_params;
+static struct bt_gatt_exchange_params exchange_params;
+static uint16_t tp_handle;
+
+static K_SEM_DEFINE(ping_sem, 0, 1);
+static uint32_t ping_stamp;
+static uint32_t ping_cycles;
+
+static uint8_t notify_func(struct bt_conn *conn,
+			   struct bt_gatt_subscribe_params *params,
+			   const void *data, uint16_t length)
+{
+	const uint8_t *op = data;
+
+	if (!data) {
+		params->value_handle = 0;
+		return BT_GATT_ITER_STOP;
+	}
+
+	if (length && op[0] == TP_OP_PING) {
+		ping_cycles = k_cycle_get_32() - ping_stamp;
+		k_sem_give(&ping_sem);
+		return BT_GATT_ITER_CONTINUE;
+	}
+
+	rx_count(length);
+
+	return BT_GATT_ITER_CONTINUE;
+}
+
+static uint8_t discover_func(struct bt_conn *conn,
+			     const struct bt_gatt_attr *attr,
+			     struct bt_gatt_discover_params *params)
+{
+	int err;
+
+	if (!attr) {
+		printk("Throughput service not found\n");
+		memset(params, 0, sizeof(*params));
+		return BT_GATT_ITER_STOP;
+	}
+
+	switch (params->type) {
+	case BT_GATT_DISCOVER_PRIMARY:
+		params->uuid = &tp_data_uuid.uuid;
+		params->start_handle = attr->handle + 1;
+		params->type = BT_GATT_DISCOVER_CHARACTERISTIC;
+		break;
+	case BT_GATT_DISCOVER_CHARACTERISTIC:
+		tp_handle = attr->handle + 1;
+		params->uuid = BT_UUID_GATT_CCC;
+		params->start_handle = attr->handle + 2;
+		params->type = BT_GATT_DISCOVER_DESCRIPTOR;
+		break;
+	default:
+		subscribe_params.notify = notify_func;
+		subscribe_params.value = BT_GATT_CCC_NOTIFY;
+		subscribe_params.value_handle = tp_handle;
+		subscribe_params.ccc_handle = attr->handle;
+
+		err = bt_gatt_subscribe(conn, &subscribe_params);
+		if (err && err != -EALREADY) {
+			printk("Subscribe failed (err %d)\n", err);
+		} else {
+			printk("Throughput service ready, handle %u\n",
+			       tp_handle);
+		}
+
+		return BT_GATT_ITER_STOP;
+	}
+
+	err = bt_gatt_discover(conn, params);
+	if (err) {
+		printk("Discover failed (err %d)\n", err);
+	}
+
+	return BT_GATT_ITER_STOP;
+}
+
+static void exchange_func(struct bt_conn *conn, uint8_t err,
+			  struct bt_gatt_exchange_params *params)
+{
+	int ret;
+
+	printk("MTU exchange %s\n", err ? "failed" : "done");
+
+	discover_params.uuid = &tp_uuid.uuid;
+	discover_params.func = discover_func;
+	discover_params.start_handle = 0x0001;
+	discover_params.end_handle = 0xffff;
+	discover_params.type = BT_GATT_DISCOVER_PRIMARY;
+
+	ret = bt_gatt_discover(conn, &discover_params);
+	if (ret) {
+		printk("Discover failed (err %d)\n", ret);
+	}
+}
+
+/* L2CAP connection oriented channel */
+
+NET_BUF_POOL_DEFINE(tp_pool, CONFIG_BLUETOOTH_L2CAP_TX_BUF_COUNT,
+		    CONFIG_BLUETOOTH_L2CAP_TX_MTU + BT_L2CAP_CHAN_SEND_RESERVE,
+		    BT_BUF_USER_DATA_MIN, NULL);
+
+static void l2cap_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	rx_count(net_buf_frags_len(buf));
+}
+
+static void l2cap_connected(struct bt_l2cap_chan *chan)
+{
+	printk("L2CAP channel connected\n");
+}
+
+static void l2cap_disconnected(struct bt_l2cap_chan *chan)
+{
+	printk("L2CAP channel disconnected\n");
+}
+
+static struct bt_l2cap_chan_ops l2cap_ops = {
+	.recv		= l2cap_recv,
+	.connected	= l2cap_connected,
+	.disconnected	= l2cap_disconnected,
+};
+
+static struct bt_l2cap_le_chan l2cap_chan = {
+	.chan.ops	= &l2cap_ops,
+	.rx.mtu		= TP_L2CAP_MTU,
+};
+
+static int l2cap_accept(struct bt_conn *conn, struct bt_l2cap_chan **chan)
+{
+	if (l2cap_chan.chan.conn) {
+		return -ENOMEM;
+	}
+
+	*chan = &l2cap_chan.chan;
+
+	return 0;
+}
+
+static struct bt_l2cap_server l2cap_server = {
+	.psm		= TP_PSM,
+	.accept		= l2cap_accept,
+};
+
+/* Connection handling */
+
+static const struct bt_data ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA(BT_DATA_UUID128_ALL, tp_uuid.val, sizeof(tp_uuid.val)),
+};
+
+static bool ad_has_tp_uuid(struct net_buf_simple *ad)
+{
+	while (ad->len > 1) {
+		uint8_t len = net_buf_simple_pull_u8(ad);
+		uint8_t type;
+
+		if (len == 0 || len > ad->len) {
+			return false;
+		}
+
+		type = net_buf_simple_pull_u8(ad);
+
+		if ((type == BT_DATA_UUID128_ALL ||
+		     type == BT_DATA_UUID128_SOME) &&
+		    len - 1 == sizeof(tp_uuid.val) &&
+		    !memcmp(ad->data, tp_uuid.val, sizeof(tp_uuid.val))) {
+			return true;
+		}
+
+		net_buf_simple_pull(ad, len - 1);
+	}
+
+	return false;
+}
+
+static void device_found(const bt_addr_le_t *addr, int8_t rssi, uint8_t type,
+			 struct net_buf_simple *ad)
+{
+	char addr_str[BT_ADDR_LE_STR_LEN];
+
+	if (default_conn || type != BT_LE_ADV_IND || !ad_has_tp_uuid(ad)) {
+		return;
+	}
+
+	if (bt_le_scan_stop()) {
+		return;
+	}
+
+	bt_addr_le_to_str(addr, addr_str, sizeof(addr_str));
+	printk("Connecting to %s (RSSI %d)\n", addr_str, rssi);
+
+	default_conn = bt_conn_create_le(addr, BT_LE_CONN_PARAM_DEFAULT);
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+	struct bt_conn_info info;
+
+	if (err) {
+		printk("Connection failed (err %u)\n", err);
+		if (default_conn) {
+			bt_conn_unref(default_conn);
+			default_conn = NULL;
+		}
+		return;
+	}
+
+	if (!default_conn) {
+		default_conn = bt_conn_ref(conn);
+	}
+
+	bt_conn_get_info(conn, &info);
+	conn_interval = info.le.interval;
+
+	printk("Connected, interval %u\n", conn_interval);
+
+	if (info.role != BT_CONN_ROLE_MASTER) {
+		return;
+	}
+
+	/* The central is the GATT client and opens the L2CAP channel */
+	exchange_params.func = exchange_func;
+	if (bt_gatt_exchange_mtu(conn, &exchange_params)) {
+		exchange_func(conn, BT_ATT_ERR_UNLIKELY, &exchange_params);
+	}
+
+	err = bt_l2cap_chan_connect(conn, &l2cap_chan.chan, TP_PSM);
+	if (err) {
+		printk("L2CAP connect failed (err %d)\n", err);
+	}
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	printk("Disconnected (reason %u)\n", reason);
+
+	if (default_conn != conn) {
+		return;
+	}
+
+	bt_conn_unref(default_conn);
+	default_conn = NULL;
+	conn_interval = 0;
+	tp_handle = 0;
+}
+
+static void le_param_updated(struct bt_conn *conn, uint16_t interval,
+			     uint16_t latency, uint16_t timeout)
+{
+	conn_interval = interval;
+
+	printk("Connection parameters updated, interval %u\n", interval);
+}
+
+static struct bt_conn_cb conn_callbacks = {
+	.connected = connected,
+	.disconnected = disconnected,
+	.le_param_updated = le_param_updated,
+};
+
+/* Shell commands */
+
+static int cmd_adv(int argc, char *argv[])
+{
+	int err;
+
+	err = bt_le_adv_start(BT_LE_ADV_CONN, ad, ARRAY_SIZE(ad), NULL, 0);
+	if (err) {
+		printk("Advertising failed to start (err %d)\n", err);
+	} else {
+		printk("Advertising\n");
+	}
+
+	return 0;
+}
+
+static int cmd_scan(int argc, char *argv[])
+{
+	int err;
+
+	err = bt_le_scan_start(BT_LE_SCAN_PASSIVE, device_found);
+	if (err) {
+		printk("Scanning failed to start (err %d)\n", err);
+	} else {
+		printk("Scanning\n");
+	}
+
+	return 0;
+}
+
+static int cmd_interval(int argc, char *argv[])
+{
+	struct bt_le_conn_param param;
+	int err;
+
+	if (argc < 2) {
+		return -EINVAL;
+	}
+
+	if (!default_conn) {
+		printk("Not connected\n");
+		return 0;
+	}
+
+	param.interval_min = strtoul(argv[1], NULL, 0);
+	param.interval_max = argc > 2 ? strtoul(argv[2], NULL, 0) :
+			     param.interval_min;
+	param.latency = 0;
+	param.timeout = 400;
+
+	err = bt_conn_le_param_update(default_conn, &param);
+	if (err) {
+		printk("Parameter update failed (err %d)\n", err);
+	}
+
+	return 0;
+}
+
+static int get_count_len(int argc, char *argv[], uint32_t *count,
+			 uint16_t *len, uint16_t max)
+{
+	*count = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000;
+	*len = argc > 2 ? strtoul(argv[2], NULL, 0) : 20;
+
+	if (!*len || *len > max) {
+		printk("Length must be 1-%u\n", max);
+		return -EINVAL;
+	}
+
+	if (!default_conn) {
+		printk("Not connected\n");
+		return -ENOTCONN;
+	}
+
+	return 0;
+}
+
+static void print_tx(uint32_t bytes, uint32_t pdus, int64_t start)
+{
+	print_rate("TX", bytes, pdus, k_uptime_get() - start);
+
+#if defined(CONFIG_BLUETOOTH_CONN_TX_STATS)
+	{
+		struct bt_conn_tx_stats stats;
+
+		if (!bt_conn_get_tx_stats(default_conn, &stats) &&
+		    stats.pkts) {
+			printk("TX: controller buffer wait avg %u us max %u"
+			       " us\n", stats.wait_total / stats.pkts,
+			       stats.wait_max);
+		}
+	}
+#endif
+}
+
+static int cmd_gatt(int argc, char *argv[])
+{
+	uint32_t count, i;
+	int64_t start;
+	uint16_t len;
+	int err = 0;
+
+	if (get_count_len(argc, argv, &count, &len, TP_DATA_MAX)) {
+		return 0;
+	}
+
+	if (!tp_handle) {
+		printk("Throughput service not discovered\n");
+		return 0;
+	}
+
+	tx_data[0] = TP_OP_DATA;
+	start = k_uptime_get();
+
+	for (i = 0; i < count; i++) {
+		err = bt_gatt_write_without_response(default_conn, tp_handle,
+						     tx_data, len, false);
+		if (err) {
+			printk("Write failed (err %d)\n", err);
+			break;
+		}
+	}
+
+	print_tx(i * len, i, start);
+
+	return 0;
+}
+
+static int cmd_notify(int argc, char *argv[])
+{
+	uint32_t count, i;
+	int64_t start;
+	uint16_t len;
+	int err = 0;
+
+	if (get_count_len(argc, argv, &count, &len, TP_DATA_MAX)) {
+		return 0;
+	}
+
+	if (!tp_notify) {
+		printk("Peer has not subscribed\n");
+		return 0;
+	}
+
+	tx_data[0] = TP_OP_DATA;
+	start = k_uptime_get();
+
+	for (i = 0; i < count; i++) {
+		err = bt_gatt_notify(default_conn, &tp_attrs[2], tx_data, len);
+		if (err) {
+			printk("Notify failed (err %d)\n", err);
+			break;
+		}
+	}
+
+	print_tx(i * len, i, start);
+
+	return 0;
+}
+
+static int cmd_l2cap(int argc, char *argv[])
+{
+	struct net_buf *buf;
+	uint32_t count, i;
+	int64_t start;
+	uint16_t len;
+	int err;
+
+	if (get_count_len(argc, argv, &count, &len, TP_L2CAP_MTU)) {
+		return 0;
+	}
+
+	if (!l2cap_chan.chan.conn) {
+		printk("L2CAP channel not connected\n");
+		return 0;
+	}
+
+	len = min(len, l2cap_chan.tx.mtu);
+	start = k_uptime_get();
+
+	for (i = 0; i < count; i++) {
+		buf = net_buf_alloc(&tp_pool, K_FOREVER);
+		net_buf_reserve(buf, BT_L2CAP_CHAN_SEND_RESERVE);
+		net_buf_add_mem(buf, tx_data, len);
+
+		err = bt_l2cap_chan_send(&l2cap_chan.chan, buf);
+		if (err < 0) {
+			printk("Send failed (err %d)\n", err);
+			net_buf_unref(buf);
+			break;
+		}
+	}
+
+	print_tx(i * len, i, start);
+
+	return 0;
+}
+
+static int cmd_latency(int argc, char *argv[])
+{
+	uint32_t count, i, ns, total = 0, min_ns = UINT32_MAX, max_ns = 0;
+	uint16_t len;
+	int err;
+
+	if (get_count_len(argc, argv, &count, &len, TP_DATA_MAX)) {
+		return 0;
+	}
+
+	if (!tp_handle || !subscribe_params.value_handle) {
+		printk("Throughput service not discovered\n");
+		return 0;
+	}
+
+	tx_data[0] = TP_OP_PING;
+	k_sem_reset(&ping_sem);
+
+	for (i = 0; i < count; i++) {
+		ping_stamp = k_cycle_get_32();
+
+		err = bt_gatt_write_without_response(default_conn, tp_handle,
+						     tx_data, len, false);
+		if (err) {
+			printk("Write failed (err %d)\n", err);
+			break;
+		}
+
+		if (k_sem_take(&ping_sem, TP_PING_TIMEOUT)) {
+			printk("Ping %u timed out\n", i);
+			break;
+		}
+
+		/* One way latency is half the round trip */
+		ns = SYS_CLOCK_HW_CYCLES_TO_NS(ping_cycles) / 2;
+		total += ns / 1000;
+		min_ns = min(min_ns, ns);
+		max_ns = max(max_ns, ns);
+	}
+
+	tx_data[0] = TP_OP_DATA;
+
+	if (!i) {
+		return 0;
+	}
+
+	printk("Latency: %u pings, avg %u us min %u us max %u us\n", i,
+	       total / i, min_ns / 1000, max_ns / 1000);
+
+	return 0;
+}
+
+static int cmd_stats(int argc, char *argv[])
+{
+	print_rate("RX", rx_stats.bytes, rx_stats.pdus,
+		   rx_stats.last - rx_stats.first);
+
+	return 0;
+}
+
+static int cmd_reset(int argc, char *argv[])
+{
+	memset(&rx_stats, 0, sizeof(rx_stats));
+
+	return 0;
+}
+
+static struct shell_cmd commands[] = {
+	{ "adv", cmd_adv, "start advertising" },
+	{ "scan", cmd_scan, "connect to an advertising peer" },
+	{ "interval", cmd_interval, "<min> [max], 1.25 ms units" },
+	{ "gatt", cmd_gatt, "[count] [len], write without response" },
+	{ "notify", cmd_notify, "[count] [len], notifications" },
+	{ "l2cap", cmd_l2cap, "[count] [len], L2CAP channel" },
+	{ "latency", cmd_latency, "[count] [len], GATT round trips" },
+	{ "stats", cmd_stats, "print received data rate" },
+	{ "reset", cmd_reset, "reset received data counters" },
+	{ NULL, NULL, NULL }
+};
+
+void main(void)
+{
+	int err;
+
+	err = bt_enable(NULL);
+	if (err) {
+		printk("Bluetooth init failed (err %d)\n", err);
+		return;
+	}
+
+	printk("Bluetooth initialized\n");
+
+	bt_gatt_register(tp_attrs, ARRAY_SIZE(tp_attrs));
+	bt_conn_cb_register(&conn_callbacks);
+
+	err = bt_l2cap_server_register(&l2cap_server);
+	if (err) {
+		printk("L2CAP server registration failed (err %d)\n", err);
+	}
+
+	SHELL_REGISTER(MY_SHELL_MODULE, commands);
+	shell_register_default_module(MY_SHELL_MODULE);
+}
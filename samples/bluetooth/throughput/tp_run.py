@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2017 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Run the Bluetooth throughput benchmark between two boards flashed with
+# the throughput sample, by driving their shell consoles over serial.
+
+import argparse
+import re
+import sys
+import time
+
+import serial
+
+TESTS = ("gatt", "notify", "l2cap", "latency")
+
+
+class Board:
+    def __init__(self, name, port, baud):
+        self.name = name
+        self.tty = serial.Serial(port, baud, timeout=0.1)
+
+    def cmd(self, line):
+        self.tty.write((line + "\r\n").encode())
+
+    def wait(self, pattern, timeout):
+        regex = re.compile(pattern)
+        end = time.time() + timeout
+        while time.time() < end:
+            line = self.tty.readline().decode(errors="replace").strip()
+            if not line:
+                continue
+            print("%s: %s" % (self.name, line))
+            match = regex.search(line)
+            if match:
+                return match
+        sys.exit("%s: timed out waiting for '%s'" % (self.name, pattern))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Bluetooth throughput benchmark")
+    parser.add_argument("central", help="serial port of the central board")
+    parser.add_argument("peripheral", help="serial port of the peripheral")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--test", choices=TESTS, action="append")
+    parser.add_argument("--count", type=int, default=1000)
+    parser.add_argument("--len", type=int, default=20)
+    parser.add_argument("--interval", type=int,
+                        help="connection interval, in 1.25 ms units")
+    args = parser.parse_args()
+
+    central = Board("central", args.central, args.baud)
+    peripheral = Board("peripheral", args.peripheral, args.baud)
+
+    peripheral.cmd("adv")
+    peripheral.wait("Advertising", 5)
+    central.cmd("scan")
+    central.wait("Throughput service ready", 30)
+
+    if args.interval:
+        central.cmd("interval %d" % args.interval)
+        central.wait("parameters updated", 10)
+
+    # Each test is run from the board that sends the data
+    for test in args.test or TESTS:
+        if test == "notify":
+            sender, receiver = peripheral, central
+        else:
+            sender, receiver = central, peripheral
+
+        receiver.cmd("reset")
+        sender.cmd("%s %d %d" % (test, args.count, args.len))
+
+        if test == "latency":
+            sender.wait("Latency:|timed out|failed", args.count * 2 + 10)
+            continue
+
+        sender.wait("TX: .* bytes/s|failed", args.count + 10)
+        time.sleep(1)
+        receiver.cmd("stats")
+        receiver.wait("RX: .* bytes/s", 5)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+
+#include <misc/printk.h>
+
+#include <device.h>
+#include <adc.h>
+
+/**
+ * @file Sample app streaming ADC samples to a pipe.
+ */
+
+#define ADC_CHANNEL	12
+#define SAMPLE_RATE	10000
+
+/* Samples per half of the ping-pong buffer */
+#define HALF_SAMPLES	256
+
+#define STACKSIZE	1024
+#define PRIORITY	7
+
+static uint16_t samples[2 * HALF_SAMPLES];
+
+/* Room for a whole half, so the producer never blocks */
+K_PIPE_DEFINE(sample_pipe, 4 * HALF_SAMPLES * sizeof(uint16_t), 4);
+
+static K_SEM_DEFINE(half_ready, 0, 2);
+static uint16_t *volatile half_filled;
+
+static void stream_callback(struct device *dev, uint8_t *buf, uint32_t len,
+			    void *user_data)
+{
+	/* Pipes can't be written from interrupts, hand the half over */
+	half_filled = (uint16_t *)buf;
+	k_sem_give(&half_ready);
+}
+
+static void consumer(void)
+{
+	uint16_t chunk[HALF_SAMPLES];
+	uint32_t sum = 0, count = 0;
+	size_t read;
+	int i;
+
+	while (1) {
+		k_pipe_get(&sample_pipe, chunk, sizeof(chunk), &read,
+			   sizeof(chunk), K_FOREVER);
+
+		for (i = 0; i < read / sizeof(chunk[0]); i++) {
+			sum += chunk[i];
+		}
+
+		count += read / sizeof(chunk[0]);
+		if (count >= SAMPLE_RATE) {
+			printk("mean: %u over %u samples\n", sum / count,
+			       count);
+			sum = 0;
+			count = 0;
+		}
+	}
+}
+
+K_THREAD_DEFINE(consumer_id, STACKSIZE, consumer, NULL, NULL, NULL,
+		PRIORITY, 0, K_NO_WAIT);
+
+void main(void)
+{
+	struct adc_stream_config cfg = {
+		.sample_rate = SAMPLE_RATE,
+		.buffer = (uint8_t *)samples,
+		.buffer_length = sizeof(samples),
+		.callback = stream_callback,
+		.channel_id = ADC_CHANNEL,
+	};
+	struct device *adc;
+	size_t written;
+	int ret;
+
+	adc = device_get_binding(CONFIG_ADC_0_NAME);
+	if (!adc) {
+		printk("Cannot get ADC device\n");
+		return;
+	}
+
+	adc_enable(adc);
+
+	ret = adc_stream_start(adc, &cfg);
+	if (ret) {
+		printk("Cannot start acquisition: %d\n", ret);
+		return;
+	}
+
+	while (1) {
+		k_sem_take(&half_ready, K_FOREVER);
+
+		if (k_pipe_put(&sample_pipe, half_filled,
+			       HALF_SAMPLES * sizeof(uint16_t), &written,
+			       HALF_SAMPLES * sizeof(uint16_t), K_NO_WAIT)) {
+			printk("Consumer too slow, samples dropped\n");
+		}
+	}
+}
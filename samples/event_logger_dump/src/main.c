@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <logging/kernel_event_logger.h>
+
+#define STACKSIZE 512
+#define PRIORITY 5
+
+/* How often the collector polls, in milliseconds */
+#define COLLECT_PERIOD 100
+
+/* Words per output line */
+#define LINE_WORDS 8
+
+static uint32_t events[256];
+
+K_SEM_DEFINE(ping_sem, 0, 1);
+K_SEM_DEFINE(pong_sem, 0, 1);
+
+static void ping(void *p1, void *p2, void *p3)
+{
+	while (1) {
+		k_sem_give(&ping_sem);
+		k_sem_take(&pong_sem, K_FOREVER);
+		k_sleep(10);
+	}
+}
+
+static void pong(void *p1, void *p2, void *p3)
+{
+	while (1) {
+		k_sem_take(&ping_sem, K_FOREVER);
+		k_sem_give(&pong_sem);
+	}
+}
+
+K_THREAD_DEFINE(ping_id, STACKSIZE, ping, NULL, NULL, NULL,
+		PRIORITY, 0, K_NO_WAIT);
+K_THREAD_DEFINE(pong_id, STACKSIZE, pong, NULL, NULL, NULL,
+		PRIORITY, 0, K_NO_WAIT);
+
+void main(void)
+{
+	int count, i;
+
+	while (1) {
+		count = sys_k_event_logger_get_bulk(events, ARRAY_SIZE(events),
+						    COLLECT_PERIOD);
+
+		for (i = 0; i < count; i++) {
+			if (!(i % LINE_WORDS)) {
+				printk("%sEVT:", i ? "\n" : "");
+			}
+			printk(" %08x", events[i]);
+		}
+
+		if (count > 0) {
+			printk("\n");
+		}
+	}
+}
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2017 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Tabulate ztest benchmark results per board.
+
+Reads the CSV files written by sanitycheck --benchmark-report and prints
+one row per benchmark and one column per platform, giving a statistic of
+the benchmark in cycles or in nanoseconds. A second set of files, from a
+baseline run, adds the relative change of each result.
+"""
+
+import argparse
+import csv
+import sys
+
+STATS = ["min", "max", "mean", "median", "p90", "p99"]
+
+
+def load(filenames):
+    results = {}
+    for filename in filenames:
+        with open(filename) as fp:
+            for row in csv.DictReader(fp):
+                key = (row["benchmark"], row["platform"])
+                results[key] = dict((k, int(row[k])) for k in STATS + ["hz"])
+    return results
+
+
+def value(result, stat, ns):
+    if ns:
+        return result[stat] * 1000000000.0 / result["hz"]
+    return float(result[stat])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("reports", nargs="+",
+                        help="CSV files of sanitycheck --benchmark-report")
+    parser.add_argument("-s", "--stat", choices=STATS, default="median",
+                        help="statistic to show, default median")
+    parser.add_argument("-n", "--ns", action="store_true",
+                        help="show nanoseconds instead of cycles")
+    parser.add_argument("-b", "--baseline", action="append", default=[],
+                        help="CSV file of a baseline run to compare with")
+    args = parser.parse_args()
+
+    results = load(args.reports)
+    baseline = load(args.baseline)
+
+    benchmarks = sorted(set(b for b, _ in results))
+    platforms = sorted(set(p for _, p in results))
+    if not benchmarks:
+        sys.exit("no benchmark results")
+
+    unit = "ns" if args.ns else "cycles"
+    label = "%s (%s)" % (args.stat, unit)
+    width = max([len(label)] + [len(b) for b in benchmarks])
+    cells = []
+    for b in benchmarks:
+        row = []
+        for p in platforms:
+            r = results.get((b, p))
+            if not r:
+                row.append("-")
+                continue
+            cell = "%.0f" % value(r, args.stat, args.ns)
+            base = baseline.get((b, p))
+            if base and value(base, args.stat, args.ns):
+                delta = (value(r, args.stat, args.ns) /
+                         value(base, args.stat, args.ns) - 1) * 100
+                cell += " (%+.1f%%)" % delta
+            row.append(cell)
+        cells.append(row)
+
+    widths = [max([len(p)] + [len(row[i]) for row in cells])
+              for i, p in enumerate(platforms)]
+
+    print("%-*s  %s" % (width, label,
+                        "  ".join("%*s" % (w, p)
+                                  for w, p in zip(widths, platforms))))
+    for b, row in zip(benchmarks, cells):
+        print("%-*s  %s" % (width, b,
+                            "  ".join("%*s" % (w, c)
+                                      for w, c in zip(widths, row))))
+
+
+if __name__ == "__main__":
+    main()
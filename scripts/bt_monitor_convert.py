@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2017 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Convert the Bluetooth monitor stream to btsnoop or pcap.
+
+Reads the records written by CONFIG_BLUETOOTH_DEBUG_MONITOR, from the RTT
+"btmonitor" up-buffer or from the monitor UART, and writes them out as:
+
+- a btsnoop file (datalink 2001, "monitor"), read by "btmon -r" and by
+  Wireshark,
+- a pcap stream (LINKTYPE_BLUETOOTH_LINUX_MONITOR), which Wireshark can
+  capture live from a pipe: "... -f pcap | wireshark -k -i -".
+
+The input is a file or a FIFO, e.g. the output of
+"JLinkRTTLogger -RTTChannel <n>", standard input, or a TCP server given as
+host:port, e.g. the RTT server of OpenOCD ("rtt server start <port> <n>").
+Records are written out as they are read, so a live capture keeps up.
+
+The target timestamps (1/10 ms since boot) are placed on the host clock
+of the first record. Records the target dropped for lack of room in the
+RTT buffer are reported on the next record, as the btsnoop drop count.
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+TS32 = 8
+DROPS_MIN = 1
+DROPS_MAX = 7
+
+# Microseconds between year 0 and 1970, the btsnoop time origin
+BTSNOOP_EPOCH = 0x00dcddb30f2f8000
+BTSNOOP_MONITOR = 2001
+PCAP_LINKTYPE_MONITOR = 254
+
+
+class Monitor:
+    """Split the monitor stream into (opcode, drops, ts, payload)."""
+
+    def __init__(self, read):
+        self.read = read
+
+    def read_exact(self, size):
+        data = b""
+        while len(data) < size:
+            chunk = self.read(size - len(data))
+            if not chunk:
+                return None
+            data += chunk
+        return data
+
+    def records(self):
+        while True:
+            hdr = self.read_exact(4)
+            if hdr is None:
+                return
+            data_len, opcode = struct.unpack("<HH", hdr)
+            body = self.read_exact(data_len)
+            if body is None or data_len < 2:
+                return
+
+            hdr_len = body[1]
+            ext = body[2:2 + hdr_len]
+            payload = body[2 + hdr_len:]
+
+            drops = 0
+            ts = None
+            i = 0
+            while i < len(ext):
+                kind = ext[i]
+                if DROPS_MIN <= kind <= DROPS_MAX and i + 1 < len(ext):
+                    drops += ext[i + 1]
+                    i += 2
+                elif kind == TS32 and i + 4 < len(ext):
+                    ts = struct.unpack("<I", ext[i + 1:i + 5])[0]
+                    i += 5
+                else:
+                    break
+
+            yield opcode, drops, ts, payload
+
+
+class Clock:
+    """Place the 32 bit target timestamps on the host clock."""
+
+    def __init__(self):
+        self.origin = None
+        self.last = 0
+        self.wraps = 0
+
+    def us(self, ts):
+        if ts is None:
+            ts = self.last
+        if ts < self.last:
+            self.wraps += 1
+        self.last = ts
+
+        target_us = ((self.wraps << 32) + ts) * 100
+        if self.origin is None:
+            self.origin = int(time.time() * 1000000) - target_us
+        return self.origin + target_us
+
+
+def write_btsnoop_header(out):
+    out.write(b"btsnoop\0" + struct.pack(">II", 1, BTSNOOP_MONITOR))
+
+
+def write_btsnoop(out, opcode, drops, us, payload):
+    out.write(struct.pack(">IIIIQ", len(payload), len(payload), opcode,
+                          drops, us + BTSNOOP_EPOCH))
+    out.write(payload)
+
+
+def write_pcap_header(out):
+    out.write(struct.pack("<IHHiIII", 0xa1b2c3d4, 2, 4, 0, 0, 65535,
+                          PCAP_LINKTYPE_MONITOR))
+
+
+def write_pcap(out, opcode, drops, us, payload):
+    # The pseudo-header is the adapter index and the opcode, big endian
+    data = struct.pack(">HH", 0, opcode) + payload
+    out.write(struct.pack("<IIII", us // 1000000, us % 1000000, len(data),
+                          len(data)))
+    out.write(data)
+
+
+def open_input(name):
+    if name == "-":
+        return sys.stdin.buffer.read1 if hasattr(sys.stdin.buffer, "read1") \
+            else sys.stdin.buffer.read
+
+    if ":" in name:
+        host, port = name.rsplit(":", 1)
+        if port.isdigit():
+            sock = socket.create_connection((host or "localhost", int(port)))
+            return sock.recv
+
+    f = open(name, "rb", buffering=0)
+    return f.read
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input",
+                        help="monitor stream: file, - for standard input, "
+                        "or host:port of a TCP server")
+    parser.add_argument("-o", "--output", default="-",
+                        help="output file, standard output by default")
+    parser.add_argument("-f", "--format", choices=["btsnoop", "pcap"],
+                        default="btsnoop", help="output format")
+    args = parser.parse_args()
+
+    if args.format == "btsnoop":
+        write_header, write_record = write_btsnoop_header, write_btsnoop
+    else:
+        write_header, write_record = write_pcap_header, write_pcap
+
+    if args.output == "-":
+        out = sys.stdout.buffer
+    else:
+        out = open(args.output, "wb")
+
+    clock = Clock()
+    write_header(out)
+    out.flush()
+
+    try:
+        for opcode, drops, ts, payload in Monitor(open_input(args.input)).records():
+            write_record(out, opcode, drops, clock.us(ts), payload)
+            out.flush()
+    except (KeyboardInterrupt, BrokenPipeError):
+        pass
+    finally:
+        if out is not sys.stdout.buffer:
+            out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2017 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Convert kernel event logger dumps to a Chrome trace.
+
+Reads the words returned by sys_k_event_logger_get_bulk(), either as a raw
+binary file or as console output where the lines starting with the dump
+prefix ("EVT:" by default) hold hexadecimal words, and writes a JSON trace
+that chrome://tracing or Perfetto can display as a timeline:
+
+- context switch events become one slice per thread run,
+- interrupt events become instant events on an "interrupts" track,
+- sleep events become "sleep" slices on an "idle" track,
+- other events become instant events carrying their data words,
+- dropped event counts become global instant events.
+
+Timestamps are 32 bit cycle counts, wrap arounds are handled per event
+type since events of one type are in time order.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+CONTEXT_SWITCH = 0x0001
+INTERRUPT = 0x0002
+SLEEP = 0x0003
+
+# Pseudo thread ids of the tracks that are not threads
+TID_INTERRUPTS = 1
+TID_IDLE = 2
+
+
+def parse_binary(data, byteorder):
+    fmt = "<" if byteorder == "little" else ">"
+    count = len(data) // 4
+    return list(struct.unpack(fmt + "%dI" % count, data[:count * 4]))
+
+
+def parse_text(lines, prefix):
+    words = []
+    for line in lines:
+        pos = line.find(prefix)
+        if pos < 0:
+            continue
+        for field in line[pos + len(prefix):].split():
+            words.append(int(field, 16))
+    return words
+
+
+def split_events(words):
+    """Yield (event id, dropped count, data words) from the dump."""
+    i = 0
+    while i < len(words):
+        header = words[i]
+        length = (header >> 16) & 0xff
+        if i + 1 + length > len(words):
+            sys.stderr.write("truncated event at word %d\n" % i)
+            return
+        yield header & 0xffff, (header >> 24) & 0xff, words[i + 1:i + 1 + length]
+        i += 1 + length
+
+
+class Timeline:
+    def __init__(self, freq, ticks_per_sec):
+        self.freq = float(freq)
+        self.ticks_per_sec = float(ticks_per_sec)
+        self.last = {}
+        self.wraps = {}
+        self.switches = []
+        self.events = []
+
+    def timestamp(self, event_id, cycles):
+        """Microseconds, wrap arounds of the 32 bit counter removed."""
+        last = self.last.get(event_id)
+        if last is not None and cycles < last:
+            self.wraps[event_id] = self.wraps.get(event_id, 0) + 1
+        self.last[event_id] = cycles
+        cycles += self.wraps.get(event_id, 0) << 32
+        return cycles * 1e6 / self.freq
+
+    def add(self, event_id, dropped, data):
+        ts = self.timestamp(event_id, data[0]) if data else 0
+
+        if dropped:
+            self.events.append({"name": "%d dropped" % dropped, "ph": "i",
+                                "s": "g", "ts": ts, "pid": 0, "tid": 0})
+
+        if event_id == CONTEXT_SWITCH and len(data) >= 2:
+            self.switches.append((ts, data[1]))
+        elif event_id == INTERRUPT and len(data) >= 2:
+            self.events.append({"name": "irq %d" % data[1], "ph": "i",
+                                "s": "t", "ts": ts, "pid": 0,
+                                "tid": TID_INTERRUPTS})
+        elif event_id == SLEEP and len(data) >= 3:
+            duration = data[1] * 1e6 / self.ticks_per_sec
+            self.events.append({"name": "sleep", "ph": "X",
+                                "ts": ts - duration, "dur": duration,
+                                "pid": 0, "tid": TID_IDLE,
+                                "args": {"wake irq": data[2]}})
+        else:
+            self.events.append({"name": "event 0x%04x" % event_id,
+                                "ph": "i", "s": "t", "ts": ts, "pid": 0,
+                                "tid": 0,
+                                "args": {"data": ["0x%08x" % w
+                                                  for w in data]}})
+
+    def trace(self):
+        events = list(self.events)
+        names = {0: "events", TID_INTERRUPTS: "interrupts", TID_IDLE: "idle"}
+
+        # A thread runs from the switch to it until the next switch
+        switches = sorted(self.switches)
+        for (ts, thread), (end, _) in zip(switches, switches[1:]):
+            events.append({"name": "run", "ph": "X", "ts": ts,
+                           "dur": end - ts, "pid": 0, "tid": thread})
+            names[thread] = "thread 0x%08x" % thread
+
+        for tid, name in names.items():
+            events.append({"name": "thread_name", "ph": "M", "pid": 0,
+                           "tid": tid, "args": {"name": name}})
+
+        return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="dump file, - for standard input")
+    parser.add_argument("-o", "--output", default="-",
+                        help="trace file, standard output by default")
+    parser.add_argument("-b", "--binary", action="store_true",
+                        help="input is raw binary words")
+    parser.add_argument("--big-endian", action="store_true",
+                        help="binary words are big endian")
+    parser.add_argument("-p", "--prefix", default="EVT:",
+                        help="prefix of the dump lines in text input")
+    parser.add_argument("-f", "--freq", type=float, required=True,
+                        help="timestamp frequency in Hz, usually "
+                        "CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC")
+    parser.add_argument("-t", "--ticks-per-sec", type=float, default=100,
+                        help="CONFIG_SYS_CLOCK_TICKS_PER_SEC, for sleep "
+                        "durations")
+    args = parser.parse_args()
+
+    if args.binary:
+        if args.input == "-":
+            data = sys.stdin.buffer.read()
+        else:
+            with open(args.input, "rb") as f:
+                data = f.read()
+        words = parse_binary(data, "big" if args.big_endian else "little")
+    else:
+        if args.input == "-":
+            words = parse_text(sys.stdin, args.prefix)
+        else:
+            with open(args.input) as f:
+                words = parse_text(f, args.prefix)
+
+    timeline = Timeline(args.freq, args.ticks_per_sec)
+    for event_id, dropped, data in split_events(words):
+        timeline.add(event_id, dropped, data)
+
+    if args.output == "-":
+        json.dump(timeline.trace(), sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(timeline.trace(), f)
+
+
+if __name__ == "__main__":
+    main()
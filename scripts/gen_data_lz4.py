@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2017 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Compress the initialized data image of an XIP kernel.
+
+Reads the sections between __data_ram_start and __data_ram_end of the
+prebuilt ELF, the image _data_copy() copies to RAM at boot, compresses it
+in the LZ4 block format and writes it as an assembly file defining the
+.data_lz4 section, linked at __data_rom_start by the second link of
+CONFIG_XIP_DATA_COMPRESSED.
+"""
+
+import argparse
+import struct
+import sys
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHF_ALLOC = 0x2
+
+# LZ4 block format limits
+MIN_MATCH = 4
+LAST_LITERALS = 5
+MF_LIMIT = 12
+MAX_OFFSET = 65535
+
+
+class Elf32:
+    def __init__(self, data):
+        if data[:4] != b"\x7fELF" or data[4] != 1:
+            raise ValueError("not an ELF32 file")
+        self.data = data
+        self.endian = "<" if data[5] == 1 else ">"
+        (shoff, shentsize, shnum, shstrndx) = self.unpack("32xI10xHHH", 0)
+        self.sections = []
+        for i in range(shnum):
+            self.sections.append(self.unpack("IIIIIIIIII",
+                                             shoff + i * shentsize))
+        self.shstrtab = self.sections[shstrndx]
+
+    def unpack(self, fmt, offset):
+        fmt = self.endian + fmt
+        return struct.unpack_from(fmt, self.data, offset)
+
+    def string(self, section, offset):
+        start = section[4] + offset
+        return self.data[start:self.data.index(b"\0", start)].decode()
+
+    def section_name(self, section):
+        return self.string(self.shstrtab, section[0])
+
+    def symbols(self):
+        syms = {}
+        for section in self.sections:
+            if section[1] != SHT_SYMTAB:
+                continue
+            strtab = self.sections[section[6]]
+            for offset in range(section[4], section[4] + section[5],
+                                section[9]):
+                name, value = self.unpack("II", offset)
+                syms[self.string(strtab, name)] = value
+        return syms
+
+
+def data_image(elf):
+    syms = elf.symbols()
+    start = syms["__data_ram_start"]
+    end = syms["__data_ram_end"]
+    image = bytearray(end - start)
+
+    for section in elf.sections:
+        (_, sh_type, flags, addr, offset, size) = section[:6]
+        if sh_type != SHT_PROGBITS or not flags & SHF_ALLOC or not size:
+            continue
+        if addr < start or addr >= end:
+            continue
+        if addr + size > end:
+            raise ValueError("section %s crosses __data_ram_end" %
+                             elf.section_name(section))
+        image[addr - start:addr - start + size] = \
+            elf.data[offset:offset + size]
+
+    return bytes(image)
+
+
+def lz4_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def lz4_sequence(out, literals, offset, match):
+    token = min(len(literals), 15) << 4
+    if offset:
+        token |= min(match - MIN_MATCH, 15)
+    out.append(token)
+    if len(literals) >= 15:
+        lz4_length(out, len(literals) - 15)
+    out += literals
+    if offset:
+        out += struct.pack("<H", offset)
+        if match - MIN_MATCH >= 15:
+            lz4_length(out, match - MIN_MATCH - 15)
+
+
+def lz4_compress(src):
+    """Greedy LZ4 block compression, with a single entry hash table."""
+    out = bytearray()
+    table = {}
+    anchor = 0
+    pos = 0
+    match_limit = len(src) - MF_LIMIT
+    end_limit = len(src) - LAST_LITERALS
+
+    while pos < match_limit:
+        key = src[pos:pos + MIN_MATCH]
+        ref = table.get(key)
+        table[key] = pos
+        if ref is None or pos - ref > MAX_OFFSET:
+            pos += 1
+            continue
+
+        match = MIN_MATCH
+        while pos + match < end_limit and src[ref + match] == src[pos + match]:
+            match += 1
+
+        lz4_sequence(out, src[anchor:pos], pos - ref, match)
+        pos += match
+        anchor = pos
+
+    # The block always ends with literals
+    lz4_sequence(out, src[anchor:], 0, 0)
+    return bytes(out)
+
+
+def write_asm(path, blob):
+    with open(path, "w") as f:
+        f.write("/* Generated by scripts/gen_data_lz4.py, do not edit */\n\n")
+        f.write("\t.section .data_lz4,\"a\"\n")
+        for i in range(0, len(blob), 16):
+            f.write("\t.byte %s\n" %
+                    ",".join("0x%02x" % b for b in blob[i:i + 16]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-i", "--input", required=True,
+                        help="prebuilt kernel ELF")
+    parser.add_argument("-o", "--output", required=True,
+                        help="assembly file to write")
+    parser.add_argument("-v", "--verbose", action="store_true",
+                        help="report the compression ratio")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        elf = Elf32(f.read())
+
+    image = data_image(elf)
+    blob = lz4_compress(image)
+    write_asm(args.output, blob)
+
+    if args.verbose:
+        sys.stdout.write("data image: %d bytes, compressed: %d bytes\n" %
+                         (len(image), len(blob)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2017 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Report the function profiler statistics with symbol names.
+
+Reads the output of the "prof dump" shell command, from the console or
+the RTT data channel, where lines starting with "PROF:" hold a function
+address, the number of calls and the inclusive and exclusive cycles in
+hexadecimal, and resolves the addresses against a System.map created with:
+
+    NM=<cross>-nm scripts/mksysmap outdir/<board>/zephyr.elf System.map
+
+Functions are listed by decreasing exclusive cycles.
+"""
+
+import argparse
+import bisect
+import sys
+
+
+def parse_sysmap(path):
+    """Sorted (address, name) list of the text symbols."""
+    symbols = []
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) < 3 or fields[1] not in "TtWw":
+                continue
+            symbols.append((int(fields[0], 16), fields[2]))
+    symbols.sort()
+    return symbols
+
+
+def resolve(symbols, addresses, address):
+    # Thumb function addresses have bit 0 set
+    i = bisect.bisect_right(addresses, address & ~1) - 1
+    if i < 0:
+        return "0x%08x" % address
+    base, name = symbols[i]
+    if base == address & ~1:
+        return name
+    return "%s+0x%x" % (name, (address & ~1) - base)
+
+
+def parse_dump(lines, prefix):
+    funcs = []
+    missed = 0
+    for line in lines:
+        pos = line.find(prefix)
+        if pos < 0:
+            continue
+        fields = line[pos + len(prefix):].split()
+        if len(fields) == 2 and fields[0] == "missed":
+            missed = int(fields[1])
+        elif len(fields) == 4:
+            funcs.append((int(fields[0], 16), int(fields[1]),
+                          int(fields[2], 16), int(fields[3], 16)))
+    return funcs, missed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="dump file, - for standard input")
+    parser.add_argument("-m", "--sysmap", help="System.map of the image")
+    parser.add_argument("-p", "--prefix", default="PROF:",
+                        help="prefix of the dump lines")
+    parser.add_argument("-f", "--freq", type=float,
+                        help="cycle frequency in Hz, usually "
+                        "CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC, to report "
+                        "microseconds instead of cycles")
+    parser.add_argument("-n", "--count", type=int, default=0,
+                        help="number of functions listed, all by default")
+    args = parser.parse_args()
+
+    if args.input == "-":
+        funcs, missed = parse_dump(sys.stdin, args.prefix)
+    else:
+        with open(args.input) as f:
+            funcs, missed = parse_dump(f, args.prefix)
+
+    symbols = parse_sysmap(args.sysmap) if args.sysmap else []
+    addresses = [address for address, _ in symbols]
+
+    total = sum(excl for _, _, _, excl in funcs) or 1
+    scale = 1e6 / args.freq if args.freq else 1
+    unit = "us" if args.freq else "cycles"
+
+    funcs.sort(key=lambda func: func[3], reverse=True)
+    if args.count:
+        funcs = funcs[:args.count]
+
+    print("%6s %10s %14s %14s %12s  %s" % ("excl%", "calls", "incl " + unit,
+                                          "excl " + unit, "excl/call",
+                                          "function"))
+    for address, calls, incl, excl in funcs:
+        name = resolve(symbols, addresses, address) if symbols \
+            else "0x%08x" % address
+        print("%6.2f %10d %14.0f %14.0f %12.1f  %s" %
+              (100.0 * excl / total, calls, incl * scale, excl * scale,
+               excl * scale / calls if calls else 0, name))
+
+    if missed:
+        print("%d calls not accounted" % missed)
+
+
+if __name__ == "__main__":
+    main()
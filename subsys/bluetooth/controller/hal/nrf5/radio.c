@@ -22,6 +22,7 @@
 #endif
 
 static radio_isr_fp sfp_radio_isr;
+static uint32_t _start_margin;
 
 void isr_radio(void *param)
 {
@@ -348,6 +349,9 @@ uint32_t radio_tmr_start(uint8_t trx, uint32_t ticks_start, uint32_t remainder)
 	NRF_RTC0->EVTENSET = RTC_EVTENSET_COMPARE2_Msk;
 	NRF_RTC0->EVENTS_COMPARE[2] = 0;
 
+	/* RTC ticks left before the compare starts the timer */
+	_start_margin = (ticks_start - NRF_RTC0->COUNTER) & 0x00FFFFFF;
+
 	NRF_PPI->CH[1].EEP = (uint32_t)&(NRF_RTC0->EVENTS_COMPARE[2]);
 	NRF_PPI->CH[1].TEP = (uint32_t)&(NRF_TIMER0->TASKS_START);
 	NRF_PPI->CHENSET = PPI_CHEN_CH1_Msk;
@@ -423,6 +427,11 @@ uint32_t radio_tmr_sample_get(void)
 	return NRF_TIMER0->CC[3];
 }
 
+uint32_t radio_tmr_start_margin_get(void)
+{
+	return _start_margin;
+}
+
 static uint8_t MALIGN(4) _ccm_scratch[(RADIO_PDU_LEN_MAX - 4) + 16];
 
 void *radio_ccm_rx_pkt_set(struct ccm *ccm, void *pkt)
@@ -527,7 +536,7 @@ void radio_ar_configure(uint32_t nirk, void *irk)
 	NRF_AAR->NIRK = nirk;
 	NRF_AAR->IRKPTR = (uint32_t)irk;
 	NRF_AAR->ADDRPTR = (uint32_t)NRF_RADIO->PACKETPTR;
-	NRF_AAR->SCRATCHPTR = (uint32_t)_aar_scratch[0];
+	NRF_AAR->SCRATCHPTR = (uint32_t)&_aar_scratch[0];
 
 	radio_bc_configure(64);
 
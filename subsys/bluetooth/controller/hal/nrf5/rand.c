@@ -12,6 +12,39 @@
 #include <bluetooth/log.h>
 #include "debug.h"
 
+#if defined(CONFIG_RANDOM_NRF5)
+#include <device.h>
+#include <random.h>
+
+/* The RNG and its interrupt are owned by the random driver */
+static struct device *rand_dev;
+
+void rand_init(uint8_t *context, uint8_t context_len)
+{
+	ARG_UNUSED(context);
+	ARG_UNUSED(context_len);
+
+	rand_dev = device_get_binding(CONFIG_RANDOM_NAME);
+	LL_ASSERT(rand_dev);
+}
+
+size_t rand_get(size_t octets, uint8_t *rand)
+{
+	while (octets &&
+	       random_get_entropy_isr(rand_dev, &rand[octets - 1], 1) == 1) {
+		octets--;
+	}
+
+	return octets;
+}
+
+void isr_rand(void *param)
+{
+	ARG_UNUSED(param);
+}
+
+#else /* !CONFIG_RANDOM_NRF5 */
+
 #define RAND_RESERVED (4)
 
 struct rand {
@@ -114,3 +147,5 @@ void isr_rand(void *param)
 		}
 	}
 }
+
+#endif /* !CONFIG_RANDOM_NRF5 */
@@ -86,6 +86,7 @@ void radio_tmr_end_capture(void);
 uint32_t radio_tmr_end_get(void);
 void radio_tmr_sample(void);
 uint32_t radio_tmr_sample_get(void);
+uint32_t radio_tmr_start_margin_get(void);
 
 void *radio_ccm_rx_pkt_set(struct ccm *ccm, void *pkt);
 void *radio_ccm_tx_pkt_set(struct ccm *ccm, void *pkt);
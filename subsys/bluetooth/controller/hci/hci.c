@@ -222,9 +222,18 @@ static void read_supported_commands(struct net_buf *buf, struct net_buf *evt)
 	rp->commands[34] |= (1 << 1) | (1 << 2);
 #endif
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_PRIVACY)
+	/* LE Add Device to, Remove Device from, Clear and Read Size of the
+	 * Resolving List.
+	 */
+	rp->commands[34] |= (1 << 3) | (1 << 4) | (1 << 5) | (1 << 6);
+	/* LE Set Address Resolution Enable. */
+	rp->commands[35] |= (1 << 1);
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_PRIVACY */
+
 #if defined(CONFIG_BLUETOOTH_CONTROLLER_DATA_LENGTH)
 	/* LE Read Maximum Data Length. */
-	rp->commands[35] = (1 << 3);
+	rp->commands[35] |= (1 << 3);
 #endif /* CONFIG_BLUETOOTH_CONTROLLER_DATA_LENGTH */
 }
 
@@ -296,7 +305,7 @@ static void le_read_buffer_size(struct net_buf *buf, struct net_buf *evt)
 	rp->status = 0x00;
 
 	rp->le_max_len = sys_cpu_to_le16(RADIO_PACKET_TX_DATA_SIZE);
-	rp->le_max_num = RADIO_PACKET_COUNT_TX_MAX;
+	rp->le_max_num = radio_tx_count_get();
 }
 
 static void le_read_local_features(struct net_buf *buf, struct net_buf *evt)
@@ -410,7 +419,7 @@ static void le_set_scan_enable(struct net_buf *buf, struct net_buf *evt)
 	struct bt_hci_evt_cc_status *ccst;
 	uint32_t status;
 
-	status = ll_scan_enable(cmd->enable);
+	status = ll_scan_enable(cmd->enable, cmd->filter_dup);
 
 	ccst = cmd_complete(evt, sizeof(*ccst));
 	ccst->status = (!status) ? 0x00 : BT_HCI_ERR_CMD_DISALLOWED;
@@ -497,6 +506,81 @@ static void le_rem_dev_from_wl(struct net_buf *buf, struct net_buf *evt)
 	ccst->status = (!status) ? 0x00 : BT_HCI_ERR_CMD_DISALLOWED;
 }
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_PRIVACY)
+static uint8_t rl_status(uint32_t status)
+{
+	switch (status) {
+	case 0:
+		return 0x00;
+	case 1:
+		/* address resolution enabled */
+		return BT_HCI_ERR_CMD_DISALLOWED;
+	default:
+		return BT_HCI_ERR_MEM_CAPACITY_EXCEEDED;
+	}
+}
+
+static void le_add_dev_to_rl(struct net_buf *buf, struct net_buf *evt)
+{
+	struct bt_hci_cp_le_add_dev_to_rl *cmd = (void *)buf->data;
+	struct bt_hci_evt_cc_status *ccst;
+	uint32_t status;
+
+	/* The local IRK is not used, the Host generates our own RPAs */
+	status = radio_rl_add(cmd->peer_id_addr.type,
+			      &cmd->peer_id_addr.a.val[0], &cmd->peer_irk[0]);
+
+	ccst = cmd_complete(evt, sizeof(*ccst));
+	ccst->status = rl_status(status);
+}
+
+static void le_rem_dev_from_rl(struct net_buf *buf, struct net_buf *evt)
+{
+	struct bt_hci_cp_le_rem_dev_from_rl *cmd = (void *)buf->data;
+	struct bt_hci_evt_cc_status *ccst;
+	uint32_t status;
+
+	status = radio_rl_remove(cmd->peer_id_addr.type,
+				 &cmd->peer_id_addr.a.val[0]);
+
+	ccst = cmd_complete(evt, sizeof(*ccst));
+	ccst->status = (status == 2) ? BT_HCI_ERR_UNKNOWN_CONN_ID :
+				       rl_status(status);
+}
+
+static void le_clear_rl(struct net_buf *buf, struct net_buf *evt)
+{
+	struct bt_hci_evt_cc_status *ccst;
+	uint32_t status;
+
+	status = radio_rl_clear();
+
+	ccst = cmd_complete(evt, sizeof(*ccst));
+	ccst->status = rl_status(status);
+}
+
+static void le_read_rl_size(struct net_buf *buf, struct net_buf *evt)
+{
+	struct bt_hci_rp_le_read_rl_size *rp;
+
+	rp = cmd_complete(evt, sizeof(*rp));
+
+	rp->status = 0x00;
+	rp->rl_size = radio_rl_size_get();
+}
+
+static void le_set_addr_res_enable(struct net_buf *buf, struct net_buf *evt)
+{
+	struct bt_hci_cp_le_set_addr_res_enable *cmd = (void *)buf->data;
+	struct bt_hci_evt_cc_status *ccst;
+
+	radio_rl_enable(cmd->enable == BT_HCI_ADDR_RES_ENABLE);
+
+	ccst = cmd_complete(evt, sizeof(*ccst));
+	ccst->status = 0x00;
+}
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_PRIVACY */
+
 static void le_conn_update(struct net_buf *buf, struct net_buf *evt)
 {
 	struct hci_cp_le_conn_update *cmd = (void *)buf->data;
@@ -849,6 +933,100 @@ static int controller_cmd_handle(uint8_t ocf, struct net_buf *cmd,
 		break;
 #endif /* CONFIG_BLUETOOTH_CONTROLLER_DATA_LENGTH */
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_PRIVACY)
+	case BT_OCF(BT_HCI_OP_LE_ADD_DEV_TO_RL):
+		le_add_dev_to_rl(cmd, evt);
+		break;
+
+	case BT_OCF(BT_HCI_OP_LE_REM_DEV_FROM_RL):
+		le_rem_dev_from_rl(cmd, evt);
+		break;
+
+	case BT_OCF(BT_HCI_OP_LE_CLEAR_RL):
+		le_clear_rl(cmd, evt);
+		break;
+
+	case BT_OCF(BT_HCI_OP_LE_READ_RL_SIZE):
+		le_read_rl_size(cmd, evt);
+		break;
+
+	case BT_OCF(BT_HCI_OP_LE_SET_ADDR_RES_ENABLE):
+		le_set_addr_res_enable(cmd, evt);
+		break;
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_PRIVACY */
+
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+#if (RADIO_ADV_SET_COUNT > 0)
+static void vs_set_adv_set_param(struct net_buf *buf, struct net_buf *evt)
+{
+	struct bt_hci_cp_vs_set_adv_set_param *cmd = (void *)buf->data;
+	struct bt_hci_evt_cc_status *ccst;
+	uint16_t interval;
+	uint32_t status;
+
+	interval = sys_le16_to_cpu(cmd->interval);
+
+	status = ll_adv_set_params_set(cmd->set, interval, cmd->own_addr_type,
+				       cmd->channel_map);
+
+	ccst = cmd_complete(evt, sizeof(*ccst));
+	ccst->status = (!status) ? 0x00 : BT_HCI_ERR_INVALID_PARAMS;
+}
+
+static void vs_set_adv_set_data(struct net_buf *buf, struct net_buf *evt)
+{
+	struct bt_hci_cp_vs_set_adv_set_data *cmd = (void *)buf->data;
+	struct bt_hci_evt_cc_status *ccst;
+	uint32_t status;
+
+	if (cmd->len > sizeof(cmd->data)) {
+		status = 1;
+	} else {
+		status = ll_adv_set_data_set(cmd->set, cmd->len,
+					     &cmd->data[0]);
+	}
+
+	ccst = cmd_complete(evt, sizeof(*ccst));
+	ccst->status = (!status) ? 0x00 : BT_HCI_ERR_INVALID_PARAMS;
+}
+
+static void vs_set_adv_set_enable(struct net_buf *buf, struct net_buf *evt)
+{
+	struct bt_hci_cp_vs_set_adv_set_enable *cmd = (void *)buf->data;
+	struct bt_hci_evt_cc_status *ccst;
+	uint32_t status;
+
+	status = ll_adv_set_enable(cmd->set, cmd->enable);
+
+	ccst = cmd_complete(evt, sizeof(*ccst));
+	ccst->status = (!status) ? 0x00 : BT_HCI_ERR_CMD_DISALLOWED;
+}
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
+static int vendor_cmd_handle(uint8_t ocf, struct net_buf *cmd,
+			     struct net_buf *evt)
+{
+	switch (ocf) {
+#if (RADIO_ADV_SET_COUNT > 0)
+	case BT_OCF(BT_HCI_OP_VS_SET_ADV_SET_PARAM):
+		vs_set_adv_set_param(cmd, evt);
+		break;
+
+	case BT_OCF(BT_HCI_OP_VS_SET_ADV_SET_DATA):
+		vs_set_adv_set_data(cmd, evt);
+		break;
+
+	case BT_OCF(BT_HCI_OP_VS_SET_ADV_SET_ENABLE):
+		vs_set_adv_set_enable(cmd, evt);
+		break;
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 	default:
 		return -EINVAL;
 	}
@@ -895,7 +1073,7 @@ int hci_cmd_handle(struct net_buf *cmd, struct net_buf *evt)
 		err = controller_cmd_handle(ocf, cmd, evt);
 		break;
 	case BT_OGF_VS:
-		err = -EINVAL;
+		err = vendor_cmd_handle(ocf, cmd, evt);
 		break;
 	default:
 		err = -EINVAL;
@@ -957,44 +1135,66 @@ int hci_acl_handle(struct net_buf *buf)
 	return 0;
 }
 
-static void le_advertising_report(struct pdu_data *pdu_data, uint8_t *b,
-				  struct net_buf *buf)
+static uint8_t adv_info_len(struct pdu_adv *adv, uint8_t *data_len)
 {
-	const uint8_t c_adv_type[] = { 0x00, 0x01, 0x03, 0xff, 0x04,
-				       0xff, 0x02 };
-	struct bt_hci_ev_le_advertising_report *sep;
-	struct pdu_adv *adv = (struct pdu_adv *)pdu_data;
-	struct bt_hci_ev_le_advertising_info *adv_info;
-	uint8_t data_len;
-	uint8_t *rssi;
-	uint8_t info_len;
-
 	if (adv->type != PDU_ADV_TYPE_DIRECT_IND) {
-		data_len = (adv->len - BDADDR_SIZE);
+		*data_len = (adv->len - BDADDR_SIZE);
 	} else {
-		data_len = 0;
+		*data_len = 0;
 	}
 
-	info_len = sizeof(struct bt_hci_ev_le_advertising_info) + data_len +
-		   sizeof(*rssi);
-	sep = meta_evt(buf, BT_HCI_EVT_LE_ADVERTISING_REPORT,
-		       sizeof(*sep) + info_len);
+	return sizeof(struct bt_hci_ev_le_advertising_info) + *data_len +
+	       sizeof(uint8_t);
+}
 
-	sep->num_reports = 1;
-	adv_info = (void *)(((uint8_t *)sep) + sizeof(*sep));
+static void adv_info_fill(struct pdu_adv *adv, uint8_t *b, uint8_t data_len,
+			  struct bt_hci_ev_le_advertising_info *adv_info)
+{
+	const uint8_t c_adv_type[] = { 0x00, 0x01, 0x03, 0xff, 0x04,
+				       0xff, 0x02 };
+	uint8_t *rssi;
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_PRIVACY)
+	uint8_t rl_idx;
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_PRIVACY */
 
 	adv_info->evt_type = c_adv_type[adv->type];
 	adv_info->addr.type = adv->tx_addr;
 	memcpy(&adv_info->addr.a.val[0], &adv->payload.adv_ind.addr[0],
 	       sizeof(bt_addr_t));
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_PRIVACY)
+	/* Resolved RPA, report the identity address instead */
+	rl_idx = b[offsetof(struct radio_pdu_node_rx, pdu_data) +
+		   offsetof(struct pdu_adv, payload) + adv->len + 1];
+	if (!radio_rl_id_get(rl_idx, &adv_info->addr.type,
+			     &adv_info->addr.a.val[0])) {
+		adv_info->addr.type += BT_ADDR_LE_PUBLIC_ID;
+	}
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_PRIVACY */
+
 	adv_info->length = data_len;
 	memcpy(&adv_info->data[0], &adv->payload.adv_ind.data[0], data_len);
 	/* RSSI */
 	rssi = &adv_info->data[0] + data_len;
 	*rssi = b[offsetof(struct radio_pdu_node_rx, pdu_data) +
 		  offsetof(struct pdu_adv, payload) + adv->len];
+}
 
+static void le_advertising_report(struct pdu_data *pdu_data, uint8_t *b,
+				  struct net_buf *buf)
+{
+	struct bt_hci_ev_le_advertising_report *sep;
+	struct pdu_adv *adv = (struct pdu_adv *)pdu_data;
+	uint8_t data_len;
+	uint8_t info_len;
+
+	info_len = adv_info_len(adv, &data_len);
+	sep = meta_evt(buf, BT_HCI_EVT_LE_ADVERTISING_REPORT,
+		       sizeof(*sep) + info_len);
+
+	sep->num_reports = 1;
+	adv_info_fill(adv, b, data_len,
+		      (void *)(((uint8_t *)sep) + sizeof(*sep)));
 }
 
 static void le_conn_complete(struct pdu_data *pdu_data, uint16_t handle,
@@ -1005,6 +1205,35 @@ static void le_conn_complete(struct pdu_data *pdu_data, uint16_t handle,
 
 	radio_cc = (struct radio_le_conn_cmplt *) (pdu_data->payload.lldata);
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_PRIVACY)
+	/* The peer used an RPA that was resolved, give both it and the
+	 * identity address in an Enhanced Connection Complete.
+	 */
+	if (!radio_cc->status && (radio_cc->peer_irk_index != 0xff)) {
+		struct bt_hci_evt_le_enh_conn_complete *enh;
+		uint8_t id_addr_type;
+
+		enh = meta_evt(buf, BT_HCI_EVT_LE_ENH_CONN_COMPLETE,
+			       sizeof(*enh));
+
+		enh->status = 0x00;
+		enh->handle = sys_cpu_to_le16(handle);
+		enh->role = radio_cc->role;
+		radio_rl_id_get(radio_cc->peer_irk_index, &id_addr_type,
+				&enh->peer_addr.a.val[0]);
+		enh->peer_addr.type = id_addr_type + BT_ADDR_LE_PUBLIC_ID;
+		memset(&enh->local_rpa.val[0], 0x00, sizeof(bt_addr_t));
+		memcpy(&enh->peer_rpa.val[0], &radio_cc->peer_addr[0],
+		       BDADDR_SIZE);
+		enh->interval = sys_cpu_to_le16(radio_cc->interval);
+		enh->latency = sys_cpu_to_le16(radio_cc->latency);
+		enh->supv_timeout = sys_cpu_to_le16(radio_cc->timeout);
+		enh->clock_accuracy = radio_cc->mca;
+
+		return;
+	}
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_PRIVACY */
+
 	sep = meta_evt(buf, BT_HCI_EVT_LE_CONN_COMPLETE, sizeof(*sep));
 
 	sep->status = radio_cc->status;
@@ -1328,6 +1557,25 @@ void hci_acl_encode(struct radio_pdu_node_rx *node_rx, struct net_buf *buf)
 
 }
 
+uint8_t hci_acl_data_encode(struct radio_pdu_node_rx *node_rx,
+			    struct net_buf *buf)
+{
+	struct pdu_data *pdu_data;
+
+	pdu_data = (struct pdu_data *)node_rx->pdu_data;
+
+	LL_ASSERT(pdu_data->ll_id == PDU_DATA_LLID_DATA_START ||
+		  pdu_data->ll_id == PDU_DATA_LLID_DATA_CONTINUE);
+
+	net_buf_add_mem(buf, &pdu_data->payload.lldata[0], pdu_data->len);
+
+	if (pdu_data->ll_id == PDU_DATA_LLID_DATA_START) {
+		return BT_ACL_START;
+	}
+
+	return BT_ACL_CONT;
+}
+
 void hci_evt_encode(struct radio_pdu_node_rx *node_rx, struct net_buf *buf)
 {
 	struct pdu_data *pdu_data;
@@ -1360,6 +1608,44 @@ void hci_num_cmplt_encode(struct net_buf *buf, uint16_t handle, uint8_t num)
 	hc->count = sys_cpu_to_le16(num);
 }
 
+bool hci_evt_report_append(struct radio_pdu_node_rx *node_rx,
+			   struct net_buf *buf)
+{
+	struct pdu_adv *adv = (struct pdu_adv *)node_rx->pdu_data;
+	struct bt_hci_ev_le_advertising_report *sep;
+	struct bt_hci_evt_le_meta_event *me;
+	struct bt_hci_evt_hdr *hdr;
+	uint8_t data_len;
+	uint8_t info_len;
+
+	if (node_rx->hdr.type != NODE_RX_TYPE_REPORT ||
+	    buf->len < sizeof(*hdr) + sizeof(*me) + sizeof(*sep)) {
+		return false;
+	}
+
+	hdr = (void *)buf->data;
+	me = (void *)(buf->data + sizeof(*hdr));
+	sep = (void *)(buf->data + sizeof(*hdr) + sizeof(*me));
+	if (hdr->evt != BT_HCI_EVT_LE_META_EVENT ||
+	    me->subevent != BT_HCI_EVT_LE_ADVERTISING_REPORT) {
+		return false;
+	}
+
+	/* the parameters of an HCI event are at most 255 bytes */
+	info_len = adv_info_len(adv, &data_len);
+	if (net_buf_tailroom(buf) < info_len ||
+	    hdr->len + info_len > UINT8_MAX) {
+		return false;
+	}
+
+	adv_info_fill(adv, (uint8_t *)node_rx, data_len,
+		      net_buf_add(buf, info_len));
+	hdr->len += info_len;
+	sep->num_reports++;
+
+	return true;
+}
+
 bool hci_evt_is_discardable(struct radio_pdu_node_rx *node_rx)
 {
 	switch (node_rx->hdr.type) {
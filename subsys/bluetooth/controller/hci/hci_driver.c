@@ -23,7 +23,9 @@
 #include <bluetooth/log.h>
 #include <bluetooth/bluetooth.h>
 #include <bluetooth/hci.h>
+#include <bluetooth/controller.h>
 #include <drivers/bluetooth/hci_driver.h>
+#include <drivers/rand32.h>
 
 #ifdef CONFIG_CLOCK_CONTROL_NRF5
 #include <drivers/clock_control/nrf5_clock_control.h>
@@ -61,6 +63,12 @@ static uint8_t MALIGN(4) _ticker_user_ops[RADIO_TICKER_USER_OPS]
 						[TICKER_USER_OP_T_SIZE];
 static uint8_t MALIGN(4) _radio[LL_MEM_TOTAL];
 
+/* Partition of _radio, sized for the compile time maximums by default */
+static uint8_t mem_conn_count = RADIO_CONNECTION_CONTEXT_MAX;
+static uint8_t mem_rx_count = RADIO_PACKET_COUNT_RX_MAX;
+static uint8_t mem_tx_count = RADIO_PACKET_COUNT_TX_MAX;
+static bool opened;
+
 static K_SEM_DEFINE(sem_prio_recv, 0, UINT_MAX);
 static K_FIFO_DEFINE(recv_fifo);
 
@@ -72,6 +80,11 @@ K_MUTEX_DEFINE(mutex_rand);
 
 int bt_rand(void *buf, size_t len)
 {
+#if defined(CONFIG_RANDOM_CTR_DRBG)
+	sys_rand_get(buf, len);
+
+	return 0;
+#else
 	while (len) {
 		k_mutex_lock(&mutex_rand, K_FOREVER);
 		len = rand_get(len, buf);
@@ -82,6 +95,7 @@ int bt_rand(void *buf, size_t len)
 	}
 
 	return 0;
+#endif
 }
 
 void mayfly_enable(uint8_t caller_id, uint8_t callee_id, uint8_t enable)
@@ -141,6 +155,13 @@ void mayfly_pend(uint8_t caller_id, uint8_t callee_id)
 	}
 }
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MAYFLY_STATS)
+uint32_t mayfly_ticks_get(void)
+{
+	return cntr_cnt_get();
+}
+#endif
+
 void radio_active_callback(uint8_t active)
 {
 }
@@ -180,10 +201,12 @@ static void rtc0_nrf5_isr(void *arg)
 	mayfly_run(MAYFLY_CALL_ID_0);
 }
 
+#if !defined(CONFIG_RANDOM_NRF5)
 static void rng_nrf5_isr(void *arg)
 {
 	isr_rand(arg);
 }
+#endif
 
 static void swi4_nrf5_isr(void *arg)
 {
@@ -228,16 +251,35 @@ static void prio_recv_thread(void *p1, void *p2, void *p3)
 	}
 }
 
+static void node_rx_release(struct radio_pdu_node_rx *node_rx)
+{
+	radio_rx_fc_set(node_rx->hdr.handle, 0);
+	node_rx->hdr.onion.next = 0;
+	radio_rx_mem_release(&node_rx);
+}
+
 static void recv_thread(void *p1, void *p2, void *p3)
 {
+	/* node dequeued while batching reports, processed next */
+	struct radio_pdu_node_rx *node_next = NULL;
+
 	while (1) {
 		struct radio_pdu_node_rx *node_rx;
 		struct pdu_data *pdu_data;
 		struct net_buf *buf;
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RX_DIRECT)
+		uint16_t handle = 0;
+		int8_t flags = -1;
+#endif
 
-		BT_DBG("RX node get");
-		node_rx = k_fifo_get(&recv_fifo, K_FOREVER);
-		BT_DBG("RX node dequeued");
+		if (node_next) {
+			node_rx = node_next;
+			node_next = NULL;
+		} else {
+			BT_DBG("RX node get");
+			node_rx = k_fifo_get(&recv_fifo, K_FOREVER);
+			BT_DBG("RX node dequeued");
+		}
 
 		pdu_data = (void *)node_rx->pdu_data;
 		/* Check if we need to generate an HCI event or ACL
@@ -260,12 +302,38 @@ static void recv_thread(void *p1, void *p2, void *p3)
 			/* generate ACL data */
 			buf = bt_buf_get_rx(K_FOREVER);
 			bt_buf_set_type(buf, BT_BUF_ACL_IN);
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RX_DIRECT)
+			handle = node_rx->hdr.handle;
+			flags = hci_acl_data_encode(node_rx, buf);
+#else
 			hci_acl_encode(node_rx, buf);
+#endif
 		}
 
-		radio_rx_fc_set(node_rx->hdr.handle, 0);
-		node_rx->hdr.onion.next = 0;
-		radio_rx_mem_release(&node_rx);
+		/* Pack the advertising reports already queued in the same
+		 * event, as long as it has room for them.
+		 */
+		if (buf && buf->len && hci_evt_is_discardable(node_rx)) {
+			while ((node_next = k_fifo_get(&recv_fifo,
+						       K_NO_WAIT))) {
+				if (!hci_evt_report_append(node_next, buf)) {
+					break;
+				}
+
+				node_rx_release(node_next);
+			}
+		}
+
+		node_rx_release(node_rx);
+
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RX_DIRECT)
+		if (flags >= 0) {
+			BT_DBG("ACL in: handle:%u flags:%d len:%u", handle,
+			       flags, buf->len);
+			bt_recv_acl(buf, handle, flags);
+			buf = NULL;
+		}
+#endif
 
 		if (buf) {
 			if (buf->len) {
@@ -342,6 +410,26 @@ static int hci_driver_send(struct net_buf *buf)
 	return err;
 }
 
+int bt_ctlr_mem_config(uint8_t conn_count, uint8_t rx_count,
+		       uint8_t tx_count)
+{
+	if (opened) {
+		return -EBUSY;
+	}
+
+	/* the ticker nodes are reserved for the maximum connection count */
+	if (conn_count > RADIO_CONNECTION_CONTEXT_MAX || !rx_count ||
+	    !tx_count) {
+		return -EINVAL;
+	}
+
+	mem_conn_count = conn_count;
+	mem_rx_count = rx_count;
+	mem_tx_count = tx_count;
+
+	return 0;
+}
+
 static int hci_driver_open(void)
 {
 	struct device *clk_k32;
@@ -350,7 +438,6 @@ static int hci_driver_open(void)
 
 	DEBUG_INIT();
 
-	/* TODO: bind and use RNG driver */
 	rand_init(_rand_context, sizeof(_rand_context));
 
 	clk_k32 = device_get_binding(CONFIG_CLOCK_CONTROL_NRF5_K32SRC_DRV_NAME);
@@ -380,9 +467,7 @@ static int hci_driver_open(void)
 	}
 
 	err = radio_init(clk_m16, CLOCK_CONTROL_NRF5_K32SRC_ACCURACY,
-			 RADIO_CONNECTION_CONTEXT_MAX,
-			 RADIO_PACKET_COUNT_RX_MAX,
-			 RADIO_PACKET_COUNT_TX_MAX,
+			 mem_conn_count, mem_rx_count, mem_tx_count,
 			 RADIO_LL_LENGTH_OCTETS_RX_MAX,
 			 RADIO_PACKET_TX_DATA_SIZE, &_radio[0], sizeof(_radio));
 	if (err) {
@@ -391,13 +476,19 @@ static int hci_driver_open(void)
 		return -ENOMEM;
 	}
 
+	opened = true;
+
 	IRQ_CONNECT(NRF5_IRQ_RADIO_IRQn, 0, radio_nrf5_isr, 0, 0);
 	IRQ_CONNECT(NRF5_IRQ_RTC0_IRQn, 0, rtc0_nrf5_isr, 0, 0);
+#if !defined(CONFIG_RANDOM_NRF5)
 	IRQ_CONNECT(NRF5_IRQ_RNG_IRQn, 1, rng_nrf5_isr, 0, 0);
+#endif
 	IRQ_CONNECT(NRF5_IRQ_SWI4_IRQn, 0, swi4_nrf5_isr, 0, 0);
 	irq_enable(NRF5_IRQ_RADIO_IRQn);
 	irq_enable(NRF5_IRQ_RTC0_IRQn);
+#if !defined(CONFIG_RANDOM_NRF5)
 	irq_enable(NRF5_IRQ_RNG_IRQn);
+#endif
 	irq_enable(NRF5_IRQ_SWI4_IRQn);
 
 	k_thread_spawn(prio_recv_thread_stack, sizeof(prio_recv_thread_stack),
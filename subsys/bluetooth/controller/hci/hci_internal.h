@@ -12,6 +12,10 @@ int hci_cmd_handle(struct net_buf *cmd, struct net_buf *evt);
 int hci_acl_handle(struct net_buf *acl);
 void hci_evt_encode(struct radio_pdu_node_rx *node_rx, struct net_buf *buf);
 void hci_acl_encode(struct radio_pdu_node_rx *node_rx, struct net_buf *buf);
+uint8_t hci_acl_data_encode(struct radio_pdu_node_rx *node_rx,
+			    struct net_buf *buf);
 void hci_num_cmplt_encode(struct net_buf *buf, uint16_t handle, uint8_t num);
 bool hci_evt_is_discardable(struct radio_pdu_node_rx *node_rx);
+bool hci_evt_report_append(struct radio_pdu_node_rx *node_rx,
+			   struct net_buf *buf);
 #endif /* _HCI_CONTROLLER_H_ */
@@ -37,6 +37,13 @@
 #include <bluetooth/log.h>
 #include "debug.h"
 
+#if defined(CONFIG_RAMFUNC_BLUETOOTH_CONTROLLER_ISR)
+#include <sections.h>
+#define ISR_RAMFUNC __ramfunc
+#else
+#define ISR_RAMFUNC
+#endif
+
 #define RADIO_PREAMBLE_TO_ADDRESS_US	40
 #define RADIO_HCTO_US			(150 + 2 + 2 + \
 					 RADIO_PREAMBLE_TO_ADDRESS_US)
@@ -67,6 +74,7 @@ enum role {
 	ROLE_NONE,
 	ROLE_ADV,
 	ROLE_OBS,
+	ROLE_ADV_SET,
 	ROLE_SLAVE,
 	ROLE_MASTER,
 };
@@ -97,6 +105,15 @@ struct advertiser {
 	struct connection *conn;
 };
 
+#if (RADIO_DUP_FILTER_LEN > 0)
+struct dup_entry {
+	uint8_t addr_type:1;
+	uint8_t type:4;
+	uint8_t addr[BDADDR_SIZE];
+	uint16_t data_hash;
+};
+#endif /* RADIO_DUP_FILTER_LEN > 0 */
+
 struct observer {
 	struct shdr hdr;
 
@@ -106,11 +123,20 @@ struct observer {
 	uint8_t filter_policy:2;
 	uint8_t adv_addr_type:1;
 	uint8_t init_addr_type:1;
+	/* adv_addr is an identity address, resolved from the peer's RPA */
+	uint8_t adv_addr_id:1;
 
 	uint8_t adv_addr[BDADDR_SIZE];
 	uint8_t init_addr[BDADDR_SIZE];
 	uint32_t ticks_window;
 
+#if (RADIO_DUP_FILTER_LEN > 0)
+	uint8_t filter_dup:1;
+	uint8_t dup_count;
+	uint8_t dup_curr;
+	struct dup_entry dup[RADIO_DUP_FILTER_LEN];
+#endif /* RADIO_DUP_FILTER_LEN > 0 */
+
 	uint8_t filter_enable_bitmask;
 	uint8_t filter_addr_type_bitmask;
 	uint8_t filter_bdaddr[8][BDADDR_SIZE];
@@ -124,6 +150,17 @@ struct observer {
 	uint32_t win_offset_us;
 };
 
+#if (RADIO_ADV_SET_COUNT > 0)
+struct adv_set {
+	struct shdr hdr;
+
+	uint8_t chl_map:3;
+	uint8_t chl_map_current:3;
+
+	struct radio_adv_data adv_data;
+};
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 static struct {
 	struct device *hf_clock;
 
@@ -142,9 +179,19 @@ static struct {
 	uint8_t nirk;
 	uint8_t irk[RADIO_IRK_COUNT_MAX][16];
 
+	/* resolving list, peer identities of the irk entries */
+	uint8_t rl_enable;
+	uint8_t rl_id_addr_type_bitmask;
+	uint8_t rl_id_addr[RADIO_IRK_COUNT_MAX][BDADDR_SIZE];
+
 	struct advertiser advertiser;
 	struct observer observer;
 
+#if (RADIO_ADV_SET_COUNT > 0)
+	struct adv_set adv_set[RADIO_ADV_SET_COUNT];
+	struct adv_set *adv_set_curr;
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 	void *conn_pool;
 	void *conn_free;
 	uint8_t connection_count;
@@ -222,6 +269,9 @@ static void event_inactive(uint32_t ticks_at_expire, uint32_t remainder,
 static void adv_setup(void);
 static void event_adv(uint32_t ticks_at_expire, uint32_t remainder,
 		      uint16_t lazy, void *context);
+#if (RADIO_ADV_SET_COUNT > 0)
+static void adv_set_setup(void);
+#endif /* RADIO_ADV_SET_COUNT > 0 */
 static void event_obs(uint32_t ticks_at_expire, uint32_t remainder,
 		      uint16_t lazy, void *context);
 static void event_slave_prepare(uint32_t ticks_at_expire,
@@ -290,6 +340,14 @@ static uint32_t role_disable(uint8_t ticker_id_primary,
 			     uint8_t ticker_id_stop);
 static void rx_fc_lock(uint16_t handle);
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
+static void radio_stats_init(void);
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS */
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS)
+static void radio_mem_stats_init(void);
+static void radio_mem_stats_update(void *mem_head, uint16_t *free_min);
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
+
 /*****************************************************************************
  *RADIO
  ****************************************************************************/
@@ -385,10 +443,10 @@ uint32_t radio_init(void *hf_clock, uint8_t sca, uint8_t connection_count_max,
 	/* check for sufficient memory allocation for stack
 	 * configuration.
 	 */
-	retcode = (mem_radio - mem_radio_end);
-	if (retcode) {
-		return (retcode + mem_size);
+	if (mem_radio > mem_radio_end) {
+		return (mem_radio - mem_radio_end) + mem_size;
 	}
+	retcode = 0;
 
 	/* enable connection handle based on-off flow control feature.
 	 * This is a simple flow control to rx data only on one selected
@@ -401,6 +459,14 @@ uint32_t radio_init(void *hf_clock, uint8_t sca, uint8_t connection_count_max,
 	/* memory allocations */
 	common_init();
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
+	radio_stats_init();
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS */
+
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS)
+	radio_mem_stats_init();
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
+
 	return retcode;
 }
 
@@ -414,6 +480,15 @@ void ctrl_reset(void)
 	/* disable oberver events */
 	role_disable(RADIO_TICKER_ID_OBS, RADIO_TICKER_ID_OBS_STOP);
 
+#if (RADIO_ADV_SET_COUNT > 0)
+	/* disable advertising set events */
+	for (conn_handle = 0; conn_handle < RADIO_ADV_SET_COUNT;
+	     conn_handle++) {
+		role_disable(RADIO_TICKER_ID_ADV_SET + conn_handle,
+			     TICKER_NULL);
+	}
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 	/* disable connection events */
 	for (conn_handle = 0; conn_handle < _radio.connection_count;
 	     conn_handle++) {
@@ -424,6 +499,8 @@ void ctrl_reset(void)
 	/* reset controller context members */
 	_radio.filter_enable_bitmask = 0;
 	_radio.nirk = 0;
+	_radio.rl_enable = 0;
+	_radio.rl_id_addr_type_bitmask = 0;
 	_radio.advertiser.conn = NULL;
 	_radio.observer.conn = NULL;
 	_radio.packet_rx_data_size = PACKET_RX_DATA_SIZE_MIN;
@@ -516,7 +593,8 @@ static inline void isr_radio_state_tx(void)
 		/* assert if radio packet ptr is not set and radio started rx */
 		LL_ASSERT(!radio_is_ready());
 
-		if (_radio.advertiser.filter_policy && _radio.nirk) {
+		if ((_radio.advertiser.filter_policy || _radio.rl_enable) &&
+		    _radio.nirk) {
 			radio_ar_configure(_radio.nirk, _radio.irk);
 		}
 
@@ -568,6 +646,29 @@ static inline void isr_radio_state_tx(void)
 	}
 }
 
+/* Index of the resolving list entry the AdvA, InitA or ScanA of the
+ * received PDU was resolved with, 0xff if none.
+ */
+static inline uint8_t rl_idx_get(uint8_t irkmatch_ok, uint8_t irkmatch_id)
+{
+	if (!_radio.rl_enable || !irkmatch_ok ||
+	    (irkmatch_id >= _radio.nirk)) {
+		return 0xff;
+	}
+
+	return irkmatch_id;
+}
+
+static inline uint8_t rl_id_match(uint8_t rl_idx, uint8_t id_addr_type,
+				  uint8_t *id_addr)
+{
+	return ((rl_idx != 0xff) &&
+		(((_radio.rl_id_addr_type_bitmask >> rl_idx) & 0x01) ==
+		 id_addr_type) &&
+		(memcmp(&_radio.rl_id_addr[rl_idx][0], id_addr,
+			BDADDR_SIZE) == 0));
+}
+
 static inline uint32_t isr_rx_adv(uint8_t devmatch_ok, uint8_t irkmatch_ok,
 				uint8_t irkmatch_id, uint8_t rssi_ready)
 {
@@ -687,7 +788,8 @@ static inline uint32_t isr_rx_adv(uint8_t devmatch_ok, uint8_t irkmatch_ok,
 		radio_le_conn_cmplt->own_addr_type = pdu_adv->rx_addr;
 		memcpy(&radio_le_conn_cmplt->own_addr[0],
 		       &pdu_adv->payload.connect_req.adv_addr[0], BDADDR_SIZE);
-		radio_le_conn_cmplt->peer_irk_index = irkmatch_id;
+		radio_le_conn_cmplt->peer_irk_index =
+			rl_idx_get(irkmatch_ok, irkmatch_id);
 		radio_le_conn_cmplt->interval =
 			pdu_adv->payload.connect_req.lldata.interval;
 		radio_le_conn_cmplt->latency =
@@ -777,10 +879,99 @@ static inline uint32_t isr_rx_adv(uint8_t devmatch_ok, uint8_t irkmatch_ok,
 	return 1;
 }
 
-static inline uint32_t isr_rx_obs(uint8_t irkmatch_id, uint8_t rssi_ready)
+#if (RADIO_DUP_FILTER_LEN > 0)
+static uint16_t dup_data_hash(uint8_t *data, uint8_t len)
+{
+	uint16_t hash = 0;
+
+	while (len--) {
+		hash = ((hash << 5) + hash) ^ *data++;
+	}
+
+	return hash;
+}
+
+static uint8_t dup_found(struct pdu_adv *pdu_adv_rx)
+{
+	struct dup_entry *dup;
+	uint16_t data_hash;
+	uint8_t index;
+
+	/* direct_ind has no data, and its init_addr is not hashed */
+	if (pdu_adv_rx->type == PDU_ADV_TYPE_DIRECT_IND) {
+		data_hash = 0;
+	} else {
+		data_hash = dup_data_hash(&pdu_adv_rx->payload.adv_ind.data[0],
+					  pdu_adv_rx->len - BDADDR_SIZE);
+	}
+
+	for (index = 0; index < _radio.observer.dup_count; index++) {
+		dup = &_radio.observer.dup[index];
+
+		if ((dup->addr_type == pdu_adv_rx->tx_addr) &&
+		    (dup->type == pdu_adv_rx->type) &&
+		    (memcmp(&dup->addr[0],
+			    &pdu_adv_rx->payload.adv_ind.addr[0],
+			    BDADDR_SIZE) == 0)) {
+			if (dup->data_hash == data_hash) {
+				return 1;
+			}
+
+			/* data changed, report it again */
+			dup->data_hash = data_hash;
+
+			return 0;
+		}
+	}
+
+	/* new advertiser, replace the oldest entry if table is full */
+	if (_radio.observer.dup_count < RADIO_DUP_FILTER_LEN) {
+		dup = &_radio.observer.dup[_radio.observer.dup_count++];
+	} else {
+		dup = &_radio.observer.dup[_radio.observer.dup_curr++];
+		if (_radio.observer.dup_curr == RADIO_DUP_FILTER_LEN) {
+			_radio.observer.dup_curr = 0;
+		}
+	}
+
+	dup->addr_type = pdu_adv_rx->tx_addr;
+	dup->type = pdu_adv_rx->type;
+	memcpy(&dup->addr[0], &pdu_adv_rx->payload.adv_ind.addr[0],
+	       BDADDR_SIZE);
+	dup->data_hash = data_hash;
+
+	return 0;
+}
+#endif /* RADIO_DUP_FILTER_LEN > 0 */
+
+/* Returns 1 if no report is to be generated for the received PDU, its RSSI
+ * saved after the payload being absolute, with 0x7f for not available.
+ */
+static inline uint8_t isr_rx_obs_report_drop(struct pdu_adv *pdu_adv_rx)
+{
+	uint8_t rssi;
+
+	rssi = ((uint8_t *)pdu_adv_rx)[offsetof(struct pdu_adv, payload) +
+				       pdu_adv_rx->len];
+	if ((rssi != 0x7f) && (-((int16_t)rssi) < RADIO_SCAN_RSSI_MIN)) {
+		return 1;
+	}
+
+#if (RADIO_DUP_FILTER_LEN > 0)
+	if (_radio.observer.filter_dup && dup_found(pdu_adv_rx)) {
+		return 1;
+	}
+#endif /* RADIO_DUP_FILTER_LEN > 0 */
+
+	return 0;
+}
+
+static inline uint32_t isr_rx_obs(uint8_t irkmatch_ok, uint8_t irkmatch_id,
+				  uint8_t rssi_ready)
 {
 	struct pdu_adv *pdu_adv_rx;
 	struct radio_pdu_node_rx *radio_pdu_node_rx;
+	uint8_t rl_idx;
 
 	radio_pdu_node_rx = packet_rx_reserve_get(3);
 
@@ -791,15 +982,21 @@ static inline uint32_t isr_rx_obs(uint8_t irkmatch_id, uint8_t rssi_ready)
 	pdu_adv_rx = (struct pdu_adv *)
 		_radio.packet_rx[_radio.packet_rx_last]->pdu_data;
 
+	rl_idx = rl_idx_get(irkmatch_ok, irkmatch_id);
+
 	/* Initiator */
 	if ((_radio.observer.conn) && ((_radio.fc_ena == 0) ||
 				       (_radio.fc_req == _radio.fc_ack)) &&
 	    (((pdu_adv_rx->type == PDU_ADV_TYPE_ADV_IND) &&
 	      (((_radio.observer.filter_policy & 0x01) != 0) ||
-	       ((_radio.observer.adv_addr_type == pdu_adv_rx->tx_addr) &&
+	       ((!_radio.observer.adv_addr_id) &&
+		(_radio.observer.adv_addr_type == pdu_adv_rx->tx_addr) &&
 		(memcmp(&_radio.observer.adv_addr[0],
 			&pdu_adv_rx->payload.adv_ind.addr[0],
-			BDADDR_SIZE) == 0)))) ||
+			BDADDR_SIZE) == 0)) ||
+	       ((_radio.observer.adv_addr_id) &&
+		(rl_id_match(rl_idx, _radio.observer.adv_addr_type,
+			     &_radio.observer.adv_addr[0]))))) ||
 	     ((pdu_adv_rx->type == PDU_ADV_TYPE_DIRECT_IND) &&
 	      (/* allow directed adv packets addressed to this device */
 	       ((_radio.observer.init_addr_type == pdu_adv_rx->rx_addr) &&
@@ -919,7 +1116,7 @@ static inline uint32_t isr_rx_obs(uint8_t irkmatch_id, uint8_t rssi_ready)
 		memcpy(&radio_le_conn_cmplt->own_addr[0],
 		       &pdu_adv_tx->payload. connect_req.init_addr[0],
 		       BDADDR_SIZE);
-		radio_le_conn_cmplt->peer_irk_index = irkmatch_id;
+		radio_le_conn_cmplt->peer_irk_index = rl_idx;
 		radio_le_conn_cmplt->interval = _radio.observer.conn_interval;
 		radio_le_conn_cmplt->latency = _radio.observer. conn_latency;
 		radio_le_conn_cmplt->timeout = _radio.observer.conn_timeout;
@@ -988,11 +1185,18 @@ static inline uint32_t isr_rx_obs(uint8_t irkmatch_id, uint8_t rssi_ready)
 		((uint8_t *)pdu_adv_rx)[offsetof(struct pdu_adv, payload) +
 			pdu_adv_rx->len] =
 			(rssi_ready) ? (radio_rssi_get() & 0x7F) : 0x7F;
+		/* and the resolving list index */
+		((uint8_t *)pdu_adv_rx)[offsetof(struct pdu_adv, payload) +
+			pdu_adv_rx->len + 1] = rl_idx;
 
-		/* save the adv packet */
-		radio_pdu_node_rx->hdr.handle = 0xffff;
-		radio_pdu_node_rx->hdr.type = NODE_RX_TYPE_REPORT;
-		packet_rx_enqueue();
+		/* save the adv packet, the scan request is sent even if it
+		 * is filtered as the scan response may not be.
+		 */
+		if (!isr_rx_obs_report_drop(pdu_adv_rx)) {
+			radio_pdu_node_rx->hdr.handle = 0xffff;
+			radio_pdu_node_rx->hdr.type = NODE_RX_TYPE_REPORT;
+			packet_rx_enqueue();
+		}
 
 		/* prepare the scan request packet */
 		pdu_adv_tx = (struct pdu_adv *)radio_pkt_scratch_get();
@@ -1038,11 +1242,16 @@ static inline uint32_t isr_rx_obs(uint8_t irkmatch_id, uint8_t rssi_ready)
 		((uint8_t *)pdu_adv_rx)[offsetof(struct pdu_adv, payload) +
 			pdu_adv_rx->len] =
 			(rssi_ready) ? (radio_rssi_get() & 0x7f) : 0x7f;
+		/* and the resolving list index */
+		((uint8_t *)pdu_adv_rx)[offsetof(struct pdu_adv, payload) +
+			pdu_adv_rx->len + 1] = rl_idx;
 
 		/* save the scan response packet */
-		radio_pdu_node_rx->hdr.handle = 0xffff;
-		radio_pdu_node_rx->hdr.type = NODE_RX_TYPE_REPORT;
-		packet_rx_enqueue();
+		if (!isr_rx_obs_report_drop(pdu_adv_rx)) {
+			radio_pdu_node_rx->hdr.handle = 0xffff;
+			radio_pdu_node_rx->hdr.type = NODE_RX_TYPE_REPORT;
+			packet_rx_enqueue();
+		}
 	}
 	/* invalid PDU */
 	else {
@@ -2247,7 +2456,8 @@ static inline void isr_radio_state_rx(uint8_t trx_done, uint8_t crc_ok,
 		if ((crc_ok) &&
 		    (((_radio.observer.filter_policy & 0x01) == 0) ||
 		     (devmatch_ok) || (irkmatch_ok))) {
-			err = isr_rx_obs(irkmatch_id, rssi_ready);
+			err = isr_rx_obs(irkmatch_ok, irkmatch_id,
+					 rssi_ready);
 		} else {
 			err = 1;
 		}
@@ -2318,6 +2528,45 @@ static inline uint32_t isr_close_adv(void)
 	return dont_close;
 }
 
+#if (RADIO_ADV_SET_COUNT > 0)
+static inline uint32_t isr_close_adv_set(void)
+{
+	struct adv_set *adv_set = _radio.adv_set_curr;
+	uint32_t ticker_status;
+	uint8_t random_delay;
+
+	/* Transmit on the next channel, without listening in between */
+	if ((_radio.state == STATE_CLOSE) && (adv_set->chl_map_current != 0)) {
+		adv_set_setup();
+
+		radio_tx_enable();
+
+		radio_tmr_end_capture();
+
+		return 1;
+	}
+
+	if (_radio.state == STATE_CLOSE) {
+		/** @todo use random 0-10 */
+		random_delay = 10;
+
+		ticker_status =
+			ticker_update(RADIO_TICKER_INSTANCE_ID_RADIO,
+				      RADIO_TICKER_USER_ID_WORKER,
+				      RADIO_TICKER_ID_ADV_SET +
+				      (adv_set - &_radio.adv_set[0]),
+				      TICKER_US_TO_TICKS(random_delay * 1000),
+				      0, 0, 0, 0, 0,
+				      ticker_success_assert,
+				      (void *)__LINE__);
+		LL_ASSERT((ticker_status == TICKER_STATUS_SUCCESS) ||
+			  (ticker_status == TICKER_STATUS_BUSY));
+	}
+
+	return 0;
+}
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 static inline uint32_t isr_close_obs(void)
 {
 	uint32_t dont_close = 0;
@@ -2329,7 +2578,8 @@ static inline uint32_t isr_close_obs(void)
 		radio_switch_complete_and_tx();
 		radio_rssi_measure();
 
-		if (_radio.observer.filter_policy && _radio.nirk) {
+		if ((_radio.observer.filter_policy || _radio.rl_enable) &&
+		    _radio.nirk) {
 			radio_ar_configure(_radio.nirk, _radio.irk);
 		}
 
@@ -2496,10 +2746,12 @@ static inline void isr_close_conn(void)
 			_radio.conn_curr->latency_event = 0;
 
 			/* Force both master and slave when close to
-			 * supervision timeout.
+			 * supervision timeout, above the tickers forced
+			 * by a start or by the slave randomness below so
+			 * that they lose the slot collision instead.
 			 */
 			if (_radio.conn_curr->supervision_expire <= 6) {
-				force = 1;
+				force = 2;
 			}
 			/* use randomness to force slave role when anchor
 			 * points are being missed.
@@ -2642,6 +2894,127 @@ static inline void isr_close_conn(void)
 	}
 }
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
+static struct radio_stats _radio_stats;
+
+static void radio_stats_init(void)
+{
+	memset(&_radio_stats, 0, sizeof(_radio_stats));
+	_radio_stats.tifs_margin_min = INT16_MAX;
+	_radio_stats.start_margin_min = UINT32_MAX;
+}
+
+/* entry is the timer sampled at ISR entry, end the packet end captured
+ * by PPI.
+ */
+static void radio_stats_isr(uint32_t entry, uint32_t end)
+{
+	uint32_t latency, elapsed, exit;
+	int32_t margin;
+
+	radio_tmr_sample();
+	exit = radio_tmr_sample_get();
+
+	latency = (entry - end) & 0x00FFFFFF;
+	elapsed = (exit - entry) & 0x00FFFFFF;
+
+	_radio_stats.isr_count++;
+
+	if (latency > _radio_stats.isr_latency_max) {
+		_radio_stats.isr_latency_max = min(latency, UINT16_MAX);
+	}
+
+	if (elapsed > _radio_stats.isr_elapsed_max) {
+		_radio_stats.isr_elapsed_max = min(elapsed, UINT16_MAX);
+	}
+
+	/* Only when the event goes on with another packet, the turnaround
+	 * having to be set up before the radio starts it.
+	 */
+	if (_radio.state != STATE_TX && _radio.state != STATE_RX) {
+		return;
+	}
+
+	margin = 150 - (int32_t)(latency + elapsed);
+	if (margin < _radio_stats.tifs_margin_min) {
+		_radio_stats.tifs_margin_min = max(margin, INT16_MIN);
+	}
+
+	if (margin < 0) {
+		_radio_stats.tifs_late++;
+	}
+}
+
+static void radio_stats_start(void)
+{
+	uint32_t margin = radio_tmr_start_margin_get();
+
+	/* Set after the compare value went by */
+	if (margin & 0x00800000) {
+		_radio_stats.start_late++;
+		return;
+	}
+
+	if (margin < _radio_stats.start_margin_min) {
+		_radio_stats.start_margin_min = margin;
+	}
+}
+
+void radio_stats_get(struct radio_stats *stats, uint8_t clear)
+{
+	uint32_t key = irq_lock();
+
+	*stats = _radio_stats;
+
+	if (clear) {
+		radio_stats_init();
+	}
+
+	irq_unlock(key);
+}
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS */
+
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS)
+static struct radio_mem_stats _radio_mem_stats;
+
+static void radio_mem_stats_init(void)
+{
+	memset(&_radio_mem_stats, 0, sizeof(_radio_mem_stats));
+	_radio_mem_stats.conn_free_min = UINT16_MAX;
+	_radio_mem_stats.rx_free_min = UINT16_MAX;
+	_radio_mem_stats.tx_free_min = UINT16_MAX;
+}
+
+/* called after a successful acquire, with the pool's free list head */
+static void radio_mem_stats_update(void *mem_head, uint16_t *free_min)
+{
+	uint16_t free_count = mem_free_count_get(mem_head);
+
+	if (free_count < *free_min) {
+		*free_min = free_count;
+	}
+}
+
+void radio_mem_stats_get(struct radio_mem_stats *stats, uint8_t clear)
+{
+	uint32_t key = irq_lock();
+
+	*stats = _radio_mem_stats;
+	stats->conn_count = _radio.connection_count;
+	stats->conn_free = mem_free_count_get(_radio.conn_free);
+	stats->rx_count = _radio.packet_rx_data_count;
+	stats->rx_free = mem_free_count_get(_radio.pkt_rx_data_free);
+	stats->tx_count = _radio.packet_tx_count - 1;
+	stats->tx_free = mem_free_count_get(_radio.pkt_tx_data_free);
+
+	if (clear) {
+		radio_mem_stats_init();
+	}
+
+	irq_unlock(key);
+}
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
+
 static inline void isr_radio_state_close(void)
 {
 	uint32_t dont_close = 0;
@@ -2655,6 +3028,12 @@ static inline void isr_radio_state_close(void)
 		dont_close = isr_close_obs();
 		break;
 
+#if (RADIO_ADV_SET_COUNT > 0)
+	case ROLE_ADV_SET:
+		dont_close = isr_close_adv_set();
+		break;
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 	case ROLE_SLAVE:
 	case ROLE_MASTER:
 		isr_close_conn();
@@ -2674,6 +3053,10 @@ static inline void isr_radio_state_close(void)
 	_radio.state = STATE_NONE;
 	_radio.ticker_id_event = 0;
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
+	radio_stats_start();
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS */
+
 	radio_tmr_stop();
 
 	event_inactive(0, 0, 0, 0);
@@ -2685,7 +3068,7 @@ static inline void isr_radio_state_close(void)
 	DEBUG_RADIO_CLOSE(0);
 }
 
-static void isr(void)
+ISR_RAMFUNC static void isr(void)
 {
 	uint8_t trx_done;
 	uint8_t crc_ok;
@@ -2693,6 +3076,9 @@ static void isr(void)
 	uint8_t irkmatch_ok;
 	uint8_t irkmatch_id;
 	uint8_t rssi_ready;
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
+	uint32_t entry = 0, end = 0;
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS */
 
 	DEBUG_RADIO_ISR(1);
 
@@ -2700,12 +3086,21 @@ static void isr(void)
 	trx_done = radio_is_done();
 	if (trx_done) {
 
-#if defined(CONFIG_BLUETOOTH_CONTROLLER_PROFILE_ISR)
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_PROFILE_ISR) || \
+	defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
 		/* sample the packet timer here, use it to calculate ISR latency
 		 * and generate the profiling event at the end of the ISR.
 		 */
 		radio_tmr_sample();
-#endif /* CONFIG_BLUETOOTH_CONTROLLER_PROFILE_ISR */
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_PROFILE_ISR || RADIO_STATS */
+
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
+		/* The end capture is reused by the header complete timeout
+		 * set up for the next packet, read it first.
+		 */
+		entry = radio_tmr_sample_get();
+		end = radio_tmr_end_get();
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS */
 
 		crc_ok = radio_crc_is_valid();
 		devmatch_ok = radio_filter_has_match();
@@ -2751,6 +3146,12 @@ static void isr(void)
 		break;
 	}
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
+	if (trx_done) {
+		radio_stats_isr(entry, end);
+	}
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS */
+
 	DEBUG_RADIO_ISR(0);
 }
 
@@ -3054,6 +3455,11 @@ static void mayfly_xtal_stop_calc(void *params)
 				hdr = &_radio.advertiser.hdr;
 			} else if (ticker_id == RADIO_TICKER_ID_OBS) {
 				hdr = &_radio.observer.hdr;
+#if (RADIO_ADV_SET_COUNT > 0)
+			} else if (ticker_id >= RADIO_TICKER_ID_ADV_SET) {
+				hdr = &_radio.adv_set[ticker_id -
+					RADIO_TICKER_ID_ADV_SET].hdr;
+#endif /* RADIO_ADV_SET_COUNT > 0 */
 			} else {
 				LL_ASSERT(0);
 			}
@@ -3188,6 +3594,11 @@ static void mayfly_xtal_stop_calc(void *params)
 				hdr = &_radio.advertiser.hdr;
 			} else if (ticker_id == RADIO_TICKER_ID_OBS) {
 				hdr = &_radio.observer.hdr;
+#if (RADIO_ADV_SET_COUNT > 0)
+			} else if (ticker_id >= RADIO_TICKER_ID_ADV_SET) {
+				hdr = &_radio.adv_set[ticker_id -
+					RADIO_TICKER_ID_ADV_SET].hdr;
+#endif /* RADIO_ADV_SET_COUNT > 0 */
 			} else {
 				LL_ASSERT(0);
 			}
@@ -4102,6 +4513,126 @@ static void event_adv(uint32_t ticks_at_expire, uint32_t remainder,
 	DEBUG_RADIO_START_A(0);
 }
 
+#if (RADIO_ADV_SET_COUNT > 0)
+static void adv_set_setup(void)
+{
+	struct adv_set *adv_set = _radio.adv_set_curr;
+	uint8_t bitmap;
+	uint8_t channel;
+
+	/* Use latest adv packet */
+	if (adv_set->adv_data.first != adv_set->adv_data.last) {
+		uint8_t first;
+
+		first = adv_set->adv_data.first + 1;
+		if (first == DOUBLE_BUFFER_SIZE) {
+			first = 0;
+		}
+		adv_set->adv_data.first = first;
+	}
+
+	radio_pkt_tx_set(&adv_set->adv_data.data[adv_set->adv_data.first][0]);
+	radio_switch_complete_and_disable();
+
+	bitmap = adv_set->chl_map_current;
+	channel = 0;
+	while ((bitmap & 0x01) == 0) {
+		channel++;
+		bitmap >>= 1;
+	}
+	adv_set->chl_map_current &= (adv_set->chl_map_current - 1);
+
+	channel_set(37 + channel);
+}
+
+static void event_adv_set(uint32_t ticks_at_expire, uint32_t remainder,
+			  uint16_t lazy, void *context)
+{
+	struct adv_set *adv_set = context;
+	uint8_t ticker_id;
+
+	ARG_UNUSED(remainder);
+	ARG_UNUSED(lazy);
+
+	DEBUG_RADIO_START_A(1);
+
+	ticker_id = RADIO_TICKER_ID_ADV_SET + (adv_set - &_radio.adv_set[0]);
+
+	LL_ASSERT(_radio.role == ROLE_NONE);
+	LL_ASSERT(_radio.ticker_id_prepare == ticker_id);
+
+	/* The set is not connectable nor scannable, the radio is disabled
+	 * after each transmission and the next channel used on close.
+	 */
+	_radio.role = ROLE_ADV_SET;
+	_radio.state = STATE_CLOSE;
+	_radio.ticker_id_prepare = 0;
+	_radio.ticker_id_event = ticker_id;
+	_radio.ticks_anchor = ticks_at_expire;
+	_radio.adv_set_curr = adv_set;
+
+	adv_obs_configure(RADIO_PHY_ADV);
+
+	adv_set->chl_map_current = adv_set->chl_map;
+	adv_set_setup();
+
+	radio_tmr_start(1,
+			ticks_at_expire +
+			TICKER_US_TO_TICKS(RADIO_TICKER_START_PART_US),
+			_radio.remainder_anchor);
+	radio_tmr_end_capture();
+
+#if (XTAL_ADVANCED && (RADIO_TICKER_PREEMPT_PART_US \
+			<= RADIO_TICKER_PREEMPT_PART_MIN_US))
+	/* check if preempt to start has changed */
+	if (preempt_calc(&adv_set->hdr, ticker_id, ticks_at_expire) != 0) {
+		_radio.state = STATE_STOP;
+		radio_disable();
+	} else
+#endif
+
+	/* Ticker Job Silence */
+#if (RADIO_TICKER_USER_ID_WORKER_PRIO == RADIO_TICKER_USER_ID_JOB_PRIO)
+	{
+		uint32_t ticker_status;
+
+		ticker_status =
+		    ticker_job_idle_get(RADIO_TICKER_INSTANCE_ID_RADIO,
+					RADIO_TICKER_USER_ID_WORKER,
+					ticker_job_disable, 0);
+		LL_ASSERT((ticker_status == TICKER_STATUS_SUCCESS) ||
+			  (ticker_status == TICKER_STATUS_BUSY));
+	}
+#endif
+
+	DEBUG_RADIO_START_A(0);
+}
+
+static void event_adv_set_prepare(uint32_t ticks_at_expire,
+				  uint32_t remainder, uint16_t lazy,
+				  void *context)
+{
+	struct adv_set *adv_set = context;
+	uint8_t ticker_id;
+
+	ARG_UNUSED(lazy);
+
+	DEBUG_RADIO_PREPARE_A(1);
+
+	ticker_id = RADIO_TICKER_ID_ADV_SET + (adv_set - &_radio.adv_set[0]);
+
+	_radio.ticker_id_prepare = ticker_id;
+
+	event_common_prepare(ticks_at_expire, remainder,
+			     &adv_set->hdr.ticks_xtal_to_start,
+			     &adv_set->hdr.ticks_active_to_start,
+			     adv_set->hdr.ticks_preempt_to_start,
+			     ticker_id, event_adv_set, adv_set);
+
+	DEBUG_RADIO_PREPARE_A(0);
+}
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 void event_adv_stop(uint32_t ticks_at_expire, uint32_t remainder,
 		    uint16_t lazy, void *context)
 {
@@ -4252,10 +4783,11 @@ static void event_obs(uint32_t ticks_at_expire, uint32_t remainder,
 		radio_filter_configure(_radio.observer.filter_enable_bitmask,
 				       _radio.observer.filter_addr_type_bitmask,
 				       (uint8_t *)_radio.observer.filter_bdaddr);
+	}
 
-		if (_radio.nirk) {
-			radio_ar_configure(_radio.nirk, _radio.irk);
-		}
+	if ((_radio.observer.filter_policy || _radio.rl_enable) &&
+	    _radio.nirk) {
+		radio_ar_configure(_radio.nirk, _radio.irk);
 	}
 
 	radio_tmr_start(0,
@@ -5901,6 +6433,11 @@ static void packet_rx_allocate(uint8_t max)
 			break;
 		}
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS)
+		radio_mem_stats_update(_radio.pkt_rx_data_free,
+				       &_radio_mem_stats.rx_free_min);
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
+
 		radio_pdu_node_rx->hdr.onion.link = link;
 
 		_radio.packet_rx[_radio.packet_rx_acquire] = radio_pdu_node_rx;
@@ -6695,23 +7232,112 @@ uint32_t radio_filter_remove(uint8_t addr_type, uint8_t *addr)
 	return 1;
 }
 
-void radio_irk_clear(void)
+/* The resolving list is not modified while address resolution is
+ * enabled, as the AAR may be using it at any time.
+ */
+uint32_t radio_rl_clear(void)
 {
+	if (_radio.rl_enable) {
+		return 1;
+	}
+
 	_radio.nirk = 0;
+	_radio.rl_id_addr_type_bitmask = 0;
+
+	return 0;
+}
+
+static uint8_t rl_find(uint8_t id_addr_type, uint8_t *id_addr)
+{
+	uint8_t index;
+
+	for (index = 0; index < _radio.nirk; index++) {
+		if (rl_id_match(index, id_addr_type & 0x01, id_addr)) {
+			return index;
+		}
+	}
+
+	return 0xff;
 }
 
-uint32_t radio_irk_add(uint8_t *irk)
+uint32_t radio_rl_add(uint8_t id_addr_type, uint8_t *id_addr, uint8_t *irk)
 {
-	if (_radio.nirk >= RADIO_IRK_COUNT_MAX) {
+	uint8_t index;
+
+	if (_radio.rl_enable) {
 		return 1;
 	}
 
-	memcpy(&_radio.irk[_radio.nirk][0], irk, 16);
-	_radio.nirk++;
+	index = rl_find(id_addr_type, id_addr);
+	if (index == 0xff) {
+		if (_radio.nirk >= RADIO_IRK_COUNT_MAX) {
+			return 2;
+		}
+
+		index = _radio.nirk++;
+	}
+
+	/* the AAR takes the IRKs most significant byte first */
+	mem_rcopy(&_radio.irk[index][0], irk, 16);
+	_radio.rl_id_addr_type_bitmask &= ~BIT(index);
+	_radio.rl_id_addr_type_bitmask |= ((id_addr_type & 0x01) << index);
+	memcpy(&_radio.rl_id_addr[index][0], id_addr, BDADDR_SIZE);
 
 	return 0;
 }
 
+uint32_t radio_rl_remove(uint8_t id_addr_type, uint8_t *id_addr)
+{
+	uint8_t index;
+
+	if (_radio.rl_enable) {
+		return 1;
+	}
+
+	index = rl_find(id_addr_type, id_addr);
+	if (index == 0xff) {
+		return 2;
+	}
+
+	/* keep the list contiguous for the AAR, move the last entry in */
+	_radio.nirk--;
+	if (index != _radio.nirk) {
+		memcpy(&_radio.irk[index][0], &_radio.irk[_radio.nirk][0], 16);
+		memcpy(&_radio.rl_id_addr[index][0],
+		       &_radio.rl_id_addr[_radio.nirk][0], BDADDR_SIZE);
+		_radio.rl_id_addr_type_bitmask &= ~BIT(index);
+		_radio.rl_id_addr_type_bitmask |=
+			(((_radio.rl_id_addr_type_bitmask >> _radio.nirk) &
+			  0x01) << index);
+	}
+	_radio.rl_id_addr_type_bitmask &= ~BIT(_radio.nirk);
+
+	return 0;
+}
+
+uint32_t radio_rl_id_get(uint8_t rl_idx, uint8_t *id_addr_type,
+			 uint8_t *id_addr)
+{
+	if (rl_idx >= _radio.nirk) {
+		return 1;
+	}
+
+	*id_addr_type = (_radio.rl_id_addr_type_bitmask >> rl_idx) & 0x01;
+	memcpy(id_addr, &_radio.rl_id_addr[rl_idx][0], BDADDR_SIZE);
+
+	return 0;
+}
+
+uint8_t radio_rl_size_get(void)
+{
+	return RADIO_IRK_COUNT_MAX;
+}
+
+void radio_rl_enable(uint8_t enable)
+{
+	_radio.rl_enable = enable;
+}
+
 static struct connection *connection_get(uint16_t handle)
 {
 	struct connection *conn;
@@ -6888,6 +7514,20 @@ static uint32_t role_disable(uint8_t ticker_id_primary,
 			_radio.observer.hdr.ticks_active_to_start;
 		break;
 	default:
+#if (RADIO_ADV_SET_COUNT > 0)
+		if ((ticker_id_primary >= RADIO_TICKER_ID_ADV_SET) &&
+		    (ticker_id_primary < RADIO_TICKER_ID_FIRST_CONNECTION)) {
+			struct adv_set *adv_set;
+
+			adv_set = &_radio.adv_set[ticker_id_primary -
+						  RADIO_TICKER_ID_ADV_SET];
+
+			ticks_xtal_to_start =
+				adv_set->hdr.ticks_xtal_to_start;
+			ticks_active_to_start =
+				adv_set->hdr.ticks_active_to_start;
+		} else
+#endif /* RADIO_ADV_SET_COUNT > 0 */
 		if (ticker_id_primary >= RADIO_TICKER_ID_FIRST_CONNECTION) {
 			struct connection *conn;
 			uint16_t conn_handle;
@@ -6975,6 +7615,11 @@ uint32_t radio_adv_enable(uint16_t interval, uint8_t chl_map,
 			return 1;
 		}
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS)
+		radio_mem_stats_update(_radio.conn_free,
+				       &_radio_mem_stats.conn_free_min);
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
+
 		conn->handle = 0xFFFF;
 		conn->llcp_features = RADIO_BLE_FEATURES;
 		conn->data_channel_use = 0;
@@ -7160,9 +7805,78 @@ uint32_t radio_adv_disable(void)
 	return status;
 }
 
+#if (RADIO_ADV_SET_COUNT > 0)
+struct radio_adv_data *radio_adv_set_data_get(uint8_t set)
+{
+	if (set >= RADIO_ADV_SET_COUNT) {
+		return NULL;
+	}
+
+	return &_radio.adv_set[set].adv_data;
+}
+
+uint32_t radio_adv_set_enable(uint8_t set, uint16_t interval, uint8_t chl_map)
+{
+	uint32_t volatile ticker_status;
+	uint32_t ticks_slot_offset;
+	struct adv_set *adv_set;
+
+	if ((set >= RADIO_ADV_SET_COUNT) || !chl_map) {
+		return 1;
+	}
+
+	adv_set = &_radio.adv_set[set];
+	adv_set->chl_map = chl_map;
+
+	adv_set->hdr.ticks_active_to_start = _radio.ticks_active_to_start;
+	adv_set->hdr.ticks_xtal_to_start =
+		TICKER_US_TO_TICKS(RADIO_TICKER_XTAL_OFFSET_US);
+	adv_set->hdr.ticks_preempt_to_start =
+		TICKER_US_TO_TICKS(RADIO_TICKER_PREEMPT_PART_MIN_US);
+	adv_set->hdr.ticks_slot =
+		TICKER_US_TO_TICKS(RADIO_TICKER_START_PART_US +
+		/* Max. ADV_NONCONN_IND and radio ramp up on each channel */
+		((376 + 150) * 3));
+
+	ticks_slot_offset =
+		(adv_set->hdr.ticks_active_to_start <
+		 adv_set->hdr.ticks_xtal_to_start) ?
+		adv_set->hdr.ticks_xtal_to_start :
+		adv_set->hdr.ticks_active_to_start;
+
+	ticker_status =
+		ticker_start(RADIO_TICKER_INSTANCE_ID_RADIO,
+			     RADIO_TICKER_USER_ID_APP,
+			     RADIO_TICKER_ID_ADV_SET + set,
+			     ticker_ticks_now_get(), 0,
+			     TICKER_US_TO_TICKS((uint64_t) interval * 625),
+			     TICKER_NULL_REMAINDER, TICKER_NULL_LAZY,
+			     (ticks_slot_offset + adv_set->hdr.ticks_slot),
+			     event_adv_set_prepare, adv_set, ticker_if_done,
+			     (void *)&ticker_status);
+
+	/** @todo design to avoid this wait */
+	while (ticker_status == TICKER_STATUS_BUSY) {
+		cpu_sleep();
+	}
+
+	return (ticker_status == TICKER_STATUS_SUCCESS) ? 0 : 1;
+}
+
+uint32_t radio_adv_set_disable(uint8_t set)
+{
+	if (set >= RADIO_ADV_SET_COUNT) {
+		return 1;
+	}
+
+	return role_disable(RADIO_TICKER_ID_ADV_SET + set, TICKER_NULL);
+}
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 uint32_t radio_scan_enable(uint8_t scan_type, uint8_t init_addr_type,
 			   uint8_t *init_addr, uint16_t interval,
-			   uint16_t window, uint8_t filter_policy)
+			   uint16_t window, uint8_t filter_policy,
+			   uint8_t filter_dup)
 {
 	uint32_t volatile ticker_status;
 	uint32_t ticks_anchor;
@@ -7186,6 +7900,14 @@ uint32_t radio_scan_enable(uint8_t scan_type, uint8_t init_addr_type,
 			_radio.filter_enable_bitmask;
 	}
 
+#if (RADIO_DUP_FILTER_LEN > 0)
+	_radio.observer.filter_dup = filter_dup;
+	_radio.observer.dup_count = 0;
+	_radio.observer.dup_curr = 0;
+#else
+	(void)filter_dup;
+#endif /* RADIO_DUP_FILTER_LEN > 0 */
+
 	_radio.observer.hdr.ticks_active_to_start =
 		_radio.ticks_active_to_start;
 	_radio.observer.hdr.ticks_xtal_to_start =
@@ -7291,9 +8013,16 @@ uint32_t radio_connect_enable(uint8_t adv_addr_type, uint8_t *adv_addr,
 		return 1;
 	}
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS)
+	radio_mem_stats_update(_radio.conn_free,
+			       &_radio_mem_stats.conn_free_min);
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
+
 	radio_scan_disable();
 
-	_radio.observer.adv_addr_type = adv_addr_type;
+	/* 0x02 and 0x03 are the identity of a peer in the resolving list */
+	_radio.observer.adv_addr_type = adv_addr_type & 0x01;
+	_radio.observer.adv_addr_id = (adv_addr_type >> 1) & 0x01;
 	memcpy(&_radio.observer.adv_addr[0], adv_addr, BDADDR_SIZE);
 	_radio.observer.conn_interval = interval;
 	_radio.observer.conn_latency = latency;
@@ -7982,9 +8711,29 @@ uint8_t radio_rx_fc_get(uint16_t *handle)
 	return 0;
 }
 
+uint8_t radio_tx_count_get(void)
+{
+	/* less the additional pdu for enc_req and the queue's free entry */
+	return _radio.packet_tx_count - 2;
+}
+
 struct radio_pdu_node_tx *radio_tx_mem_acquire(void)
 {
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS)
+	struct radio_pdu_node_tx *node_tx;
+
+	node_tx = mem_acquire(&_radio.pkt_tx_data_free);
+	if (!node_tx) {
+		_radio_mem_stats.tx_fail++;
+	} else {
+		radio_mem_stats_update(_radio.pkt_tx_data_free,
+				       &_radio_mem_stats.tx_free_min);
+	}
+
+	return node_tx;
+#else /* !CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
 	return mem_acquire(&_radio.pkt_tx_data_free);
+#endif /* !CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
 }
 
 void radio_tx_mem_release(struct radio_pdu_node_tx *node_tx)
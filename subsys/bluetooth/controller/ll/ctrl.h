@@ -17,6 +17,24 @@
 #define RADIO_CONNECTION_CONTEXT_MAX 0
 #endif
 
+#ifdef CONFIG_BLUETOOTH_CONTROLLER_ADV_SETS
+#define RADIO_ADV_SET_COUNT CONFIG_BLUETOOTH_CONTROLLER_ADV_SETS
+#else
+#define RADIO_ADV_SET_COUNT 0
+#endif
+
+#ifdef CONFIG_BLUETOOTH_CONTROLLER_DUP_FILTER_LEN
+#define RADIO_DUP_FILTER_LEN CONFIG_BLUETOOTH_CONTROLLER_DUP_FILTER_LEN
+#else
+#define RADIO_DUP_FILTER_LEN 0
+#endif
+
+#ifdef CONFIG_BLUETOOTH_CONTROLLER_SCAN_RSSI_MIN
+#define RADIO_SCAN_RSSI_MIN CONFIG_BLUETOOTH_CONTROLLER_SCAN_RSSI_MIN
+#else
+#define RADIO_SCAN_RSSI_MIN -127
+#endif
+
 #ifdef CONFIG_BLUETOOTH_CONTROLLER_RX_BUFFERS
 #define RADIO_PACKET_COUNT_RX_MAX \
 		CONFIG_BLUETOOTH_CONTROLLER_RX_BUFFERS
@@ -38,6 +56,12 @@
 #define RADIO_BLE_FEATURES_BIT_PING 0
 #endif /* !CONFIG_BLUETOOTH_CONTROLLER_LE_PING */
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_PRIVACY)
+#define RADIO_BLE_FEATURES_BIT_PRIVACY BIT(BT_LE_FEAT_BIT_PRIVACY)
+#else /* !CONFIG_BLUETOOTH_CONTROLLER_PRIVACY */
+#define RADIO_BLE_FEATURES_BIT_PRIVACY 0
+#endif /* !CONFIG_BLUETOOTH_CONTROLLER_PRIVACY */
+
 #if defined(CONFIG_BLUETOOTH_CONTROLLER_DATA_LENGTH_MAX)
 #define RADIO_BLE_FEATURES_BIT_DLE BIT(BT_LE_FEAT_BIT_DLE)
 #define RADIO_LL_LENGTH_OCTETS_RX_MAX \
@@ -57,7 +81,9 @@
 #define RADIO_TICKER_ID_OBS_STOP	 4
 #define RADIO_TICKER_ID_ADV		 5
 #define RADIO_TICKER_ID_OBS		 6
-#define RADIO_TICKER_ID_FIRST_CONNECTION 7
+#define RADIO_TICKER_ID_ADV_SET		 7
+#define RADIO_TICKER_ID_FIRST_CONNECTION (RADIO_TICKER_ID_ADV_SET \
+					 + RADIO_ADV_SET_COUNT)
 
 #define RADIO_TICKER_INSTANCE_ID_RADIO	 0
 #define RADIO_TICKER_INSTANCE_ID_APP	 1
@@ -95,6 +121,7 @@
 					 BIT(BT_LE_FEAT_BIT_EXT_REJ_IND) | \
 					 BIT(BT_LE_FEAT_BIT_SLAVE_FEAT_REQ) | \
 					 RADIO_BLE_FEATURES_BIT_PING | \
+					 RADIO_BLE_FEATURES_BIT_PRIVACY | \
 					 RADIO_BLE_FEATURES_BIT_DLE)
 
 /*****************************************************************************
@@ -242,14 +269,25 @@ struct radio_adv_data *radio_scan_data_get(void);
 void radio_filter_clear(void);
 uint32_t radio_filter_add(uint8_t addr_type, uint8_t *addr);
 uint32_t radio_filter_remove(uint8_t addr_type, uint8_t *addr);
-void radio_irk_clear(void);
-uint32_t radio_irk_add(uint8_t *irk);
+uint32_t radio_rl_clear(void);
+uint32_t radio_rl_add(uint8_t id_addr_type, uint8_t *id_addr, uint8_t *irk);
+uint32_t radio_rl_remove(uint8_t id_addr_type, uint8_t *id_addr);
+uint32_t radio_rl_id_get(uint8_t rl_idx, uint8_t *id_addr_type,
+			 uint8_t *id_addr);
+uint8_t radio_rl_size_get(void);
+void radio_rl_enable(uint8_t enable);
 uint32_t radio_adv_enable(uint16_t interval, uint8_t chl_map,
 		uint8_t filter_policy);
 uint32_t radio_adv_disable(void);
+#if (RADIO_ADV_SET_COUNT > 0)
+struct radio_adv_data *radio_adv_set_data_get(uint8_t set);
+uint32_t radio_adv_set_enable(uint8_t set, uint16_t interval, uint8_t chl_map);
+uint32_t radio_adv_set_disable(uint8_t set);
+#endif /* RADIO_ADV_SET_COUNT > 0 */
 uint32_t radio_scan_enable(uint8_t scan_type, uint8_t init_addr_type,
 		uint8_t *init_addr, uint16_t interval,
-		uint16_t window, uint8_t filter_policy);
+		uint16_t window, uint8_t filter_policy,
+		uint8_t filter_dup);
 uint32_t radio_scan_disable(void);
 uint32_t radio_connect_enable(uint8_t adv_addr_type, uint8_t *adv_addr,
 		uint16_t interval, uint16_t latency,
@@ -282,11 +320,57 @@ void radio_rx_dequeue(void);
 void radio_rx_mem_release(struct radio_pdu_node_rx **radio_pdu_node_rx);
 uint8_t radio_rx_fc_set(uint16_t handle, uint8_t fc);
 uint8_t radio_rx_fc_get(uint16_t *handle);
+uint8_t radio_tx_count_get(void);
 struct radio_pdu_node_tx *radio_tx_mem_acquire(void);
 void radio_tx_mem_release(struct radio_pdu_node_tx *pdu_data_node_tx);
 uint32_t radio_tx_mem_enqueue(uint16_t handle,
 		struct radio_pdu_node_tx *pdu_data_node_tx);
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS)
+struct radio_stats {
+	/* Radio ISRs that handled a packet end */
+	uint32_t isr_count;
+	/* Worst packet end to ISR entry, and ISR execution, in us */
+	uint16_t isr_latency_max;
+	uint16_t isr_elapsed_max;
+	/* Smallest time left, in us, between the ISR exit and the radio
+	 * start of the next packet, tIFS after the packet end; and the
+	 * number of ISRs that exited after it.
+	 */
+	int16_t tifs_margin_min;
+	uint32_t tifs_late;
+	/* Smallest time left, in RTC ticks, between the setup of an event
+	 * start and the start itself; and the number of starts set up late.
+	 */
+	uint32_t start_margin_min;
+	uint32_t start_late;
+};
+
+void radio_stats_get(struct radio_stats *stats, uint8_t clear);
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RADIO_STATS */
+
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS)
+struct radio_mem_stats {
+	/* Blocks of each pool, free now and fewest free since the last
+	 * clear. The Rx pool is counted in blocks of its current size,
+	 * which follows the data length in use.
+	 */
+	uint16_t conn_count;
+	uint16_t conn_free;
+	uint16_t conn_free_min;
+	uint16_t rx_count;
+	uint16_t rx_free;
+	uint16_t rx_free_min;
+	uint16_t tx_count;
+	uint16_t tx_free;
+	uint16_t tx_free_min;
+	/* Tx buffers requested from the Host with none free */
+	uint32_t tx_fail;
+};
+
+void radio_mem_stats_get(struct radio_mem_stats *stats, uint8_t clear);
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_MEM_STATS */
+
 extern void radio_active_callback(uint8_t active);
 extern void radio_event_callback(void);
 
@@ -196,10 +196,12 @@ struct pdu_data_q_tx {
 	struct radio_pdu_node_tx *node_tx;
 };
 
-/* Minimum Rx Data allocation size */
+/* Minimum Rx Data allocation size, advertising channel PDUs are followed by
+ * their RSSI and resolving list index.
+ */
 #define PACKET_RX_DATA_SIZE_MIN \
 			MROUND(offsetof(struct radio_pdu_node_rx, pdu_data) + \
-			(RADIO_ACPDU_SIZE_MAX + 1))
+			(RADIO_ACPDU_SIZE_MAX + 2))
 
 /* Minimum Tx Ctrl allocation size */
 #define PACKET_TX_CTRL_SIZE_MIN \
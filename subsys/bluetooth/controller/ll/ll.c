@@ -39,6 +39,14 @@ static struct {
 	uint8_t direct_addr[BDADDR_SIZE];
 } _ll_adv_params;
 
+#if (RADIO_ADV_SET_COUNT > 0)
+static struct {
+	uint16_t interval;
+	uint8_t tx_addr:1;
+	uint8_t chl_map:3;
+} _ll_adv_set_params[RADIO_ADV_SET_COUNT];
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 static struct {
 	uint16_t interval;
 	uint16_t window;
@@ -237,6 +245,105 @@ uint32_t ll_adv_enable(uint8_t enable)
 	return status;
 }
 
+#if (RADIO_ADV_SET_COUNT > 0)
+static uint8_t const *adv_set_addr(uint8_t set)
+{
+	if (_ll_adv_set_params[set].tx_addr) {
+		return &_ll_context.rnd_addr[0];
+	}
+
+	return &_ll_context.pub_addr[0];
+}
+
+uint32_t ll_adv_set_params_set(uint8_t set, uint16_t interval,
+			       uint8_t own_addr_type, uint8_t chl_map)
+{
+	struct radio_adv_data *radio_adv_data;
+	struct pdu_adv *pdu;
+
+	radio_adv_data = radio_adv_set_data_get(set);
+	if (!radio_adv_data) {
+		return 1;
+	}
+
+	_ll_adv_set_params[set].interval = interval;
+	_ll_adv_set_params[set].tx_addr = own_addr_type;
+	_ll_adv_set_params[set].chl_map = chl_map;
+
+	/* update the current adv data */
+	pdu = (struct pdu_adv *)&radio_adv_data->data[radio_adv_data->last][0];
+	pdu->type = PDU_ADV_TYPE_NONCONN_IND;
+	pdu->tx_addr = own_addr_type;
+	pdu->rx_addr = 0;
+	if (pdu->len == 0) {
+		pdu->len = BDADDR_SIZE;
+	}
+
+	return 0;
+}
+
+uint32_t ll_adv_set_data_set(uint8_t set, uint8_t len,
+			     uint8_t const *const data)
+{
+	struct radio_adv_data *radio_adv_data;
+	struct pdu_adv *pdu;
+	uint8_t last;
+
+	radio_adv_data = radio_adv_set_data_get(set);
+	if (!radio_adv_data) {
+		return 1;
+	}
+
+	/* use the last index in double buffer, */
+	if (radio_adv_data->first == radio_adv_data->last) {
+		last = radio_adv_data->last + 1;
+		if (last == DOUBLE_BUFFER_SIZE) {
+			last = 0;
+		}
+	} else {
+		last = radio_adv_data->last;
+	}
+
+	/* update adv pdu fields. */
+	pdu = (struct pdu_adv *)&radio_adv_data->data[last][0];
+	pdu->type = PDU_ADV_TYPE_NONCONN_IND;
+	pdu->tx_addr = _ll_adv_set_params[set].tx_addr;
+	pdu->rx_addr = 0;
+	memcpy(&pdu->payload.adv_ind.addr[0], adv_set_addr(set),
+	       BDADDR_SIZE);
+	memcpy(&pdu->payload.adv_ind.data[0], data, len);
+	pdu->len = BDADDR_SIZE + len;
+
+	/* commit the update so controller picks it. */
+	radio_adv_data->last = last;
+
+	return 0;
+}
+
+uint32_t ll_adv_set_enable(uint8_t set, uint8_t enable)
+{
+	struct radio_adv_data *radio_adv_data;
+	struct pdu_adv *pdu;
+
+	radio_adv_data = radio_adv_set_data_get(set);
+	if (!radio_adv_data) {
+		return 1;
+	}
+
+	if (!enable) {
+		return radio_adv_set_disable(set);
+	}
+
+	/* use the address current at enable, as the legacy advertiser */
+	pdu = (struct pdu_adv *)&radio_adv_data->data[radio_adv_data->last][0];
+	memcpy(&pdu->payload.adv_ind.addr[0], adv_set_addr(set),
+	       BDADDR_SIZE);
+
+	return radio_adv_set_enable(set, _ll_adv_set_params[set].interval,
+				    _ll_adv_set_params[set].chl_map);
+}
+#endif /* RADIO_ADV_SET_COUNT > 0 */
+
 void ll_scan_params_set(uint8_t scan_type, uint16_t interval, uint16_t window,
 			uint8_t own_addr_type, uint8_t filter_policy)
 {
@@ -247,7 +354,7 @@ void ll_scan_params_set(uint8_t scan_type, uint16_t interval, uint16_t window,
 	_ll_scan_params.filter_policy = filter_policy;
 }
 
-uint32_t ll_scan_enable(uint8_t enable)
+uint32_t ll_scan_enable(uint8_t enable, uint8_t filter_dup)
 {
 	uint32_t status;
 
@@ -259,7 +366,8 @@ uint32_t ll_scan_enable(uint8_t enable)
 					&_ll_context.pub_addr[0],
 				_ll_scan_params.interval,
 				_ll_scan_params.window,
-				_ll_scan_params.filter_policy);
+				_ll_scan_params.filter_policy,
+				filter_dup);
 	} else {
 		status = radio_scan_disable();
 	}
@@ -285,5 +393,5 @@ uint32_t ll_create_connection(uint16_t scan_interval, uint16_t scan_window,
 	return radio_scan_enable(0, own_addr_type, (own_addr_type) ?
 			&_ll_context.rnd_addr[0] :
 			&_ll_context.pub_addr[0],
-		scan_interval, scan_window, filter_policy);
+		scan_interval, scan_window, filter_policy, 0);
 }
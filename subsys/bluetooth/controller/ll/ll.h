@@ -17,9 +17,14 @@ void ll_adv_params_set(uint16_t interval, uint8_t adv_type,
 void ll_adv_data_set(uint8_t len, uint8_t const *const p_data);
 void ll_scan_data_set(uint8_t len, uint8_t const *const p_data);
 uint32_t ll_adv_enable(uint8_t enable);
+uint32_t ll_adv_set_params_set(uint8_t set, uint16_t interval,
+			       uint8_t own_addr_type, uint8_t chl_map);
+uint32_t ll_adv_set_data_set(uint8_t set, uint8_t len,
+			     uint8_t const *const p_data);
+uint32_t ll_adv_set_enable(uint8_t set, uint8_t enable);
 void ll_scan_params_set(uint8_t scan_type, uint16_t interval, uint16_t window,
 			uint8_t own_addr_type, uint8_t filter_policy);
-uint32_t ll_scan_enable(uint8_t enable);
+uint32_t ll_scan_enable(uint8_t enable, uint8_t filter_dup);
 uint32_t ll_create_connection(uint16_t scan_interval, uint16_t scan_window,
 			      uint8_t filter_policy, uint8_t peer_addr_type,
 			      uint8_t *p_peer_addr, uint8_t own_addr_type,
@@ -47,6 +47,9 @@ struct ticker_node {
 	uint16_t lazy_current;
 	uint32_t remainder_periodic;
 	uint32_t remainder_current;
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_TICKER_STATS)
+	struct ticker_stats stats;
+#endif
 };
 
 enum ticker_user_op_type {
@@ -132,6 +135,22 @@ static struct ticker_instance _instance[2];
 /*****************************************************************************
  * Static Functions
  ****************************************************************************/
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_TICKER_STATS)
+#define STATS_ADD(ticker, name, value) ((ticker)->stats.name += (value))
+
+static void ticker_stats_reset(struct ticker_node *ticker)
+{
+	ticker->stats.expire = 0;
+	ticker->stats.skip = 0;
+	ticker->stats.lazy = 0;
+	ticker->stats.drift_plus = 0;
+	ticker->stats.drift_minus = 0;
+}
+#else
+#define STATS_ADD(ticker, name, value)
+#define ticker_stats_reset(ticker)
+#endif
+
 static uint8_t ticker_by_slot_get(struct ticker_node *node,
 					uint8_t ticker_id_head,
 					uint32_t ticks_slot)
@@ -388,6 +407,9 @@ static inline void ticker_worker(struct ticker_instance *instance)
 		/* scheduled timeout is acknowledged to be complete */
 		ticker->ack--;
 
+		STATS_ADD(ticker, expire, 1);
+		STATS_ADD(ticker, lazy, ticker->lazy_current);
+
 		if (ticker->timeout_func) {
 			DEBUG_TICKER_TASK(1);
 			ticker->timeout_func(((instance->ticks_current +
@@ -525,6 +547,10 @@ static inline void ticker_job_node_update(struct ticker_node *ticker,
 		ticker->lazy_periodic = user_op->params.update.lazy;
 	}
 
+	STATS_ADD(ticker, drift_plus, user_op->params.update.ticks_drift_plus);
+	STATS_ADD(ticker, drift_minus,
+		  user_op->params.update.ticks_drift_minus);
+
 	ticker->ticks_to_expire =
 	    ticks_to_expire + user_op->params.update.ticks_drift_plus;
 	ticker->ticks_to_expire_minus +=
@@ -873,6 +899,7 @@ static inline void ticker_job_list_insert(
 				ticker->remainder_current = 0;
 				ticker->lazy_current = 0;
 				ticker->force = 1;
+				ticker_stats_reset(ticker);
 			}
 
 			/* Prepare to insert */
@@ -900,6 +927,7 @@ static inline void ticker_job_list_insert(
 					/* unschedule node */
 					ticker_preempt->req =
 					    ticker_preempt->ack;
+					STATS_ADD(ticker_preempt, skip, 1);
 
 					/* enqueue for re-insertion */
 					ticker_preempt->next = insert_head;
@@ -910,7 +938,9 @@ static inline void ticker_job_list_insert(
 					    ticker_remainder_increment
 					    (ticker);
 					ticker->lazy_current++;
+					STATS_ADD(ticker, skip, 1);
 				} else {
+					STATS_ADD(ticker, skip, 1);
 					break;
 				}
 			}
@@ -1741,6 +1771,22 @@ uint32_t ticker_next_slot_get(uint8_t instance_index, uint8_t user_id,
 	return user_op->status;
 }
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_TICKER_STATS)
+uint32_t ticker_stats_get(uint8_t instance_index, uint8_t ticker_id,
+			 struct ticker_stats *stats)
+{
+	struct ticker_instance *instance = &_instance[instance_index];
+
+	if (ticker_id >= instance->count_node) {
+		return TICKER_STATUS_FAILURE;
+	}
+
+	*stats = instance->node[ticker_id].stats;
+
+	return TICKER_STATUS_SUCCESS;
+}
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_TICKER_STATS */
+
 uint32_t ticker_job_idle_get(uint8_t instance_index, uint8_t user_id,
 			    ticker_op_func fp_op_func, void *op_context)
 {
@@ -64,7 +64,11 @@
 
 /** \brief Timer node type size.
 */
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_TICKER_STATS)
+#define TICKER_NODE_T_SIZE	56
+#else
 #define TICKER_NODE_T_SIZE	36
+#endif
 
 /** \brief Timer user type size.
 */
@@ -74,6 +78,16 @@
 */
 #define TICKER_USER_OP_T_SIZE	44
 
+/** \brief Timer statistics, counted since the timer was started.
+*/
+struct ticker_stats {
+	uint32_t expire;	/**< Timeouts called. */
+	uint32_t skip;		/**< Intervals lost to a slot collision. */
+	uint32_t lazy;		/**< Intervals elapsed without a timeout. */
+	uint32_t drift_plus;	/**< Ticks of drift added by updates. */
+	uint32_t drift_minus;	/**< Ticks of drift removed by updates. */
+};
+
 /** \brief Timer timeout function type.
 */
 typedef void (*ticker_timeout_func) (uint32_t ticks_at_expire,
@@ -119,6 +133,18 @@ uint32_t ticker_next_slot_get(uint8_t instance_index, uint8_t user_id,
 			     uint32_t *ticks_current,
 			     uint32_t *ticks_to_expire,
 			     ticker_op_func fp_op_func, void *op_context);
+/** \brief Get the statistics of a timer.
+*
+* Available with CONFIG_BLUETOOTH_CONTROLLER_TICKER_STATS. The counters are
+* updated by the worker and the job, a copy may hence be taken in between
+* the updates of two of them.
+*
+* \param[in]  instance_index  Timer mode instance.
+* \param[in]  ticker_id       Timer node.
+* \param[out] stats           Copy of the counters.
+*/
+uint32_t ticker_stats_get(uint8_t instance_index, uint8_t ticker_id,
+			 struct ticker_stats *stats);
 uint32_t ticker_job_idle_get(uint8_t instance_index, uint8_t user_id,
 			    ticker_op_func fp_op_func, void *op_context);
 void ticker_job_sched(uint8_t instance_index, uint8_t user_id);
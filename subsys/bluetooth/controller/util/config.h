@@ -15,6 +15,9 @@
 #define MAYFLY_CALLER_COUNT    4
 #define MAYFLY_CALLEE_COUNT    4
 
+/* mayfly_ticks_get() counts with the 24-bit RTC0 counter */
+#define MAYFLY_TICKS_MASK      0x00FFFFFF
+
 #define TICKER_MAYFLY_CALL_ID_TRIGGER MAYFLY_CALL_ID_0
 #define TICKER_MAYFLY_CALL_ID_WORKER0 MAYFLY_CALL_ID_0
 #define TICKER_MAYFLY_CALL_ID_WORKER1 MAYFLY_CALL_ID_2
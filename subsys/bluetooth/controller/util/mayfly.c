@@ -11,6 +11,12 @@
 
 #include "config.h"
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MAYFLY_BATCH)
+#define MAYFLY_BATCH CONFIG_BLUETOOTH_CONTROLLER_MAYFLY_BATCH
+#else
+#define MAYFLY_BATCH 1
+#endif
+
 static struct {
 	void *head;
 	void *tail;
@@ -18,6 +24,51 @@ static struct {
 
 static void *mfl[MAYFLY_CALLEE_COUNT][MAYFLY_CALLER_COUNT][2];
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MAYFLY_STATS)
+static struct mayfly_stats mfs[MAYFLY_CALLEE_COUNT];
+
+static void mayfly_stats_ready(struct mayfly *m)
+{
+	m->_ticks = mayfly_ticks_get();
+}
+
+static void mayfly_stats_run(uint8_t callee_id, struct mayfly *m)
+{
+	struct mayfly_stats *stats = &mfs[callee_id];
+	uint32_t latency;
+
+	latency = (mayfly_ticks_get() - m->_ticks) & MAYFLY_TICKS_MASK;
+
+	stats->run++;
+	stats->latency_total += latency;
+	if (latency > stats->latency_max) {
+		stats->latency_max = latency;
+	}
+}
+
+static void mayfly_stats_batch(uint8_t callee_id, uint8_t count)
+{
+	if (count > mfs[callee_id].batch_max) {
+		mfs[callee_id].batch_max = count;
+	}
+}
+
+uint32_t mayfly_stats_get(uint8_t callee_id, struct mayfly_stats *stats)
+{
+	if (callee_id >= MAYFLY_CALLEE_COUNT) {
+		return 1;
+	}
+
+	*stats = mfs[callee_id];
+
+	return 0;
+}
+#else
+#define mayfly_stats_ready(m)
+#define mayfly_stats_run(callee_id, m)
+#define mayfly_stats_batch(callee_id, count)
+#endif
+
 void mayfly_init(void)
 {
 	uint8_t callee_id;
@@ -54,6 +105,7 @@ uint32_t mayfly_enqueue(uint8_t caller_id, uint8_t callee_id, uint8_t chain,
 			if (state != 1) {
 				/* mark as ready in queue */
 				m->_req = ack + 1;
+				mayfly_stats_ready(m);
 
 				/* pend the callee for execution */
 				mayfly_pend(caller_id, callee_id);
@@ -79,6 +131,7 @@ uint32_t mayfly_enqueue(uint8_t caller_id, uint8_t callee_id, uint8_t chain,
 
 	/* new, add as ready in the queue */
 	m->_req = ack + 1;
+	mayfly_stats_ready(m);
 	memq_enqueue(m, m->_link, &mft[callee_id][caller_id].tail);
 
 	/* pend the callee for execution */
@@ -87,11 +140,33 @@ uint32_t mayfly_enqueue(uint8_t caller_id, uint8_t callee_id, uint8_t chain,
 	return 0;
 }
 
+static uint32_t mayfly_pending(uint8_t callee_id)
+{
+	uint8_t caller_id;
+
+	caller_id = MAYFLY_CALLER_COUNT;
+	while (caller_id--) {
+		struct mayfly *m = 0;
+
+		if (memq_peek(mft[callee_id][caller_id].tail,
+			      mft[callee_id][caller_id].head,
+			      (void **)&m)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
 void mayfly_run(uint8_t callee_id)
 {
+	uint8_t count = 0;
 	uint8_t caller_id;
 
-	/* iterate through each caller queue to this callee_id */
+	/* iterate through each caller queue to this callee_id, highest
+	 * caller_id being the highest priority.
+	 */
+restart:
 	caller_id = MAYFLY_CALLER_COUNT;
 	while (caller_id--) {
 		void *link;
@@ -109,6 +184,8 @@ void mayfly_run(uint8_t callee_id)
 			req = m->_req;
 			state = (req - m->_ack) & 0x03;
 			if (state == 1) {
+				mayfly_stats_run(callee_id, m);
+
 				/* mark mayfly as ran */
 				m->_ack--;
 
@@ -135,19 +212,30 @@ void mayfly_run(uint8_t callee_id)
 					 mft[callee_id][caller_id].head,
 					 (void **)&m);
 
-			/* yield out of mayfly_run if a mayfly function was
-			 * called.
+			if (state != 1) {
+				continue;
+			}
+
+			/* run up to MAYFLY_BATCH mayfly functions in this
+			 * call, restarting from the highest priority caller
+			 * queue after each of them, then yield.
 			 */
-			if (state == 1) {
-				/* pend callee (tailchain) if mayfly queue is
-				 * not empty.
-				 */
-				if (link) {
-					mayfly_pend(callee_id, callee_id);
-				}
-
-				return;
+			if (++count < MAYFLY_BATCH) {
+				goto restart;
 			}
+
+			mayfly_stats_batch(callee_id, count);
+
+			/* pend callee (tailchain) if a mayfly queue is not
+			 * empty.
+			 */
+			if (link || mayfly_pending(callee_id)) {
+				mayfly_pend(callee_id, callee_id);
+			}
+
+			return;
 		}
 	}
+
+	mayfly_stats_batch(callee_id, count);
 }
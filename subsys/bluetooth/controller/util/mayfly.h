@@ -14,16 +14,31 @@ struct mayfly {
 	void *_link;
 	void *param;
 	void (*fp)(void *);
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_MAYFLY_STATS)
+	uint32_t _ticks;
+#endif
+};
+
+/* Per callee statistics, latencies being in mayfly_ticks_get() ticks from
+ * the mayfly being marked ready to its function being called.
+ */
+struct mayfly_stats {
+	uint32_t run;
+	uint32_t batch_max;
+	uint32_t latency_max;
+	uint32_t latency_total;
 };
 
 void mayfly_init(void);
 uint32_t mayfly_enqueue(uint8_t caller_id, uint8_t callee_id, uint8_t chain,
 			struct mayfly *m);
 void mayfly_run(uint8_t callee_id);
+uint32_t mayfly_stats_get(uint8_t callee_id, struct mayfly_stats *stats);
 
 extern void mayfly_enable(uint8_t caller_id, uint8_t callee_id, uint8_t enable);
 extern uint32_t mayfly_is_enabled(uint8_t caller_id, uint8_t callee_id);
 extern uint32_t mayfly_prio_is_equal(uint8_t caller_id, uint8_t callee_id);
 extern void mayfly_pend(uint8_t caller_id, uint8_t callee_id);
+extern uint32_t mayfly_ticks_get(void);
 
 #endif /* _MAYFLY_H_ */
@@ -102,3 +102,75 @@ struct bt_a2dp *bt_a2dp_connect(struct bt_conn *conn)
 	BT_DBG("Connect request sent");
 	return &connection[free];
 }
+
+int bt_a2dp_stream_connect(struct bt_a2dp *a2dp,
+			   struct bt_avdtp_stream *stream)
+{
+	if (!a2dp) {
+		return -EINVAL;
+	}
+
+	return bt_avdtp_media_connect(&a2dp->session, stream);
+}
+
+int bt_a2dp_stream_accept(struct bt_a2dp *a2dp,
+			  struct bt_avdtp_stream *stream)
+{
+	if (!a2dp) {
+		return -EINVAL;
+	}
+
+	return bt_avdtp_media_listen(&a2dp->session, stream);
+}
+
+#if defined(CONFIG_BLUETOOTH_A2DP_SBC)
+uint8_t bt_a2dp_sbc_frames_max(struct bt_avdtp_stream *stream,
+			       const struct bt_sbc_encoder *enc)
+{
+	const size_t hdr_len = BT_AVDTP_MEDIA_HDR_LEN + BT_A2DP_SBC_HDR_LEN;
+	size_t room;
+
+	if (!stream->chan.chan.conn || stream->chan.tx.mtu < hdr_len) {
+		return 0;
+	}
+
+	room = stream->chan.tx.mtu - hdr_len;
+
+	return min(room / bt_sbc_frame_len(enc), BT_A2DP_SBC_MAX_FRAMES);
+}
+
+int bt_a2dp_sbc_send(struct bt_avdtp_stream *stream,
+		     struct bt_sbc_encoder *enc, struct net_buf *buf,
+		     const int16_t *pcm, uint8_t frames)
+{
+	size_t frame_len = bt_sbc_frame_len(enc);
+	size_t samples = bt_sbc_frame_samples(enc);
+	uint8_t i;
+	int err;
+
+	if (!frames || frames > BT_A2DP_SBC_MAX_FRAMES) {
+		return -EINVAL;
+	}
+
+	if (net_buf_tailroom(buf) < BT_A2DP_SBC_HDR_LEN + frames * frame_len) {
+		return -ENOMEM;
+	}
+
+	/* Number of frames, without fragmentation */
+	net_buf_add_u8(buf, frames);
+
+	for (i = 0; i < frames; i++) {
+		bt_sbc_encode(enc, pcm, net_buf_add(buf, frame_len));
+		pcm += samples * enc->channels;
+	}
+
+	err = bt_avdtp_media_send(stream, buf, frames * samples);
+	if (err < 0) {
+		/* Leave the buffer empty again for the caller */
+		buf->len = 0;
+		return err;
+	}
+
+	return 0;
+}
+#endif /* CONFIG_BLUETOOTH_A2DP_SBC */
@@ -14,5 +14,9 @@ enum bt_a2dp_stream_state {
 	A2DP_STREAM_SUSPENDED
 };
 
+/* SBC media payload header */
+#define BT_A2DP_SBC_HDR_LEN    1
+#define BT_A2DP_SBC_MAX_FRAMES 15
+
 /* To be called when first SEP is being registered */
 int bt_a2dp_init(void);
@@ -46,16 +46,18 @@
 
 #define ATT_TIMEOUT				K_SECONDS(30)
 
-#if CONFIG_BLUETOOTH_ATT_PREPARE_COUNT > 0
-struct bt_attr_data {
-	uint16_t handle;
-	uint16_t offset;
-};
-
-/* Pool for incoming ATT packets */
+#if defined(CONFIG_BLUETOOTH_ATT_PREPARE_ZERO_COPY)
+#if !(defined(CONFIG_BLUETOOTH_RX_QUOTA) && \
+	CONFIG_BLUETOOTH_RX_QUOTA_ATT > 0) && \
+	CONFIG_BLUETOOTH_ATT_PREPARE_COUNT * CONFIG_BLUETOOTH_MAX_CONN >= \
+	CONFIG_BLUETOOTH_RX_BUF_COUNT
+#error "Queued prepare writes may hold all the HCI RX buffers"
+#endif
+#elif CONFIG_BLUETOOTH_ATT_PREPARE_COUNT > 0
+/* Pool for queued prepare write requests */
 NET_BUF_POOL_DEFINE(prep_pool, CONFIG_BLUETOOTH_ATT_PREPARE_COUNT, BT_ATT_MTU,
-		    sizeof(struct bt_attr_data), NULL);
-#endif /* CONFIG_BLUETOOTH_ATT_PREPARE_COUNT */
+		    0, NULL);
+#endif /* CONFIG_BLUETOOTH_ATT_PREPARE_ZERO_COPY */
 
 /* ATT channel specific context */
 struct bt_att {
@@ -65,7 +67,9 @@ struct bt_att {
 	sys_slist_t		reqs;
 	struct k_delayed_work	timeout_work;
 #if CONFIG_BLUETOOTH_ATT_PREPARE_COUNT > 0
-	struct k_fifo		prep_queue;
+	/* Prepare write requests, in reception order, as a fragment chain */
+	struct net_buf		*prep_queue;
+	uint8_t			prep_count;
 #endif
 };
 
@@ -190,38 +194,43 @@ static void att_process(struct bt_att *att)
 static uint8_t att_handle_rsp(struct bt_att *att, void *pdu, uint16_t len,
 			      uint8_t err)
 {
+	struct bt_att_req *req = att->req;
 	bt_att_func_t func;
 
-	if (!att->req) {
-		goto process;
+	if (!req) {
+		/* Process pending requests */
+		att_process(att);
+		return 0;
 	}
 
 	/* Cancel timeout if ongoing */
 	k_delayed_work_cancel(&att->timeout_work);
 
 	/* Release original buffer */
-	if (att->req->buf) {
-		net_buf_unref(att->req->buf);
-		att->req->buf = NULL;
+	if (req->buf) {
+		net_buf_unref(req->buf);
+		req->buf = NULL;
 	}
 
 	/* Reset func so it can be reused by the callback */
-	func = att->req->func;
-	att->req->func = NULL;
+	func = req->func;
+	req->func = NULL;
 
-	func(att->chan.chan.conn, err, pdu, len, att->req);
+	/* Send the next pending request before running the callback, so
+	 * that it can still go out in the connection event the response
+	 * was received in. Requests sent by the callback are queued after
+	 * it.
+	 */
+	att->req = NULL;
+	att_process(att);
+
+	func(att->chan.chan.conn, err, pdu, len, req);
 
 	/* Don't destroy if callback had reused the request */
-	if (!att->req->func) {
-		att_req_destroy(att->req);
+	if (!req->func) {
+		att_req_destroy(req);
 	}
 
-	att->req = NULL;
-
-process:
-	/* Process pending requests */
-	att_process(att);
-
 	return 0;
 }
 
@@ -1136,7 +1145,7 @@ static uint8_t att_write_rsp(struct bt_conn *conn, uint8_t op, uint8_t rsp,
 			/* Respond here since handle is set */
 			send_err_rsp(conn, op, handle, data.err);
 		}
-		return op == BT_ATT_OP_EXEC_WRITE_REQ ? data.err : 0;
+		return 0;
 	}
 
 	if (data.buf) {
@@ -1162,7 +1171,6 @@ static uint8_t att_write_req(struct bt_att *att, struct net_buf *buf)
 #if CONFIG_BLUETOOTH_ATT_PREPARE_COUNT > 0
 struct prep_data {
 	struct bt_conn *conn;
-	struct net_buf *buf;
 	const void *value;
 	uint8_t len;
 	uint16_t offset;
@@ -1172,7 +1180,6 @@ struct prep_data {
 static uint8_t prep_write_cb(const struct bt_gatt_attr *attr, void *user_data)
 {
 	struct prep_data *data = user_data;
-	struct bt_attr_data *attr_data;
 	int write;
 
 	BT_DBG("handle 0x%04x offset %u", attr->handle, data->offset);
@@ -1196,32 +1203,39 @@ static uint8_t prep_write_cb(const struct bt_gatt_attr *attr, void *user_data)
 		return BT_GATT_ITER_STOP;
 	}
 
-	/* Copy data into the outstanding queue */
-	data->buf = net_buf_alloc(&prep_pool, K_NO_WAIT);
-	if (!data->buf) {
-		data->err = BT_ATT_ERR_PREPARE_QUEUE_FULL;
-		return BT_GATT_ITER_STOP;
-	}
+	data->err = 0;
 
-	attr_data = net_buf_user_data(data->buf);
-	attr_data->handle = attr->handle;
-	attr_data->offset = data->offset;
+	return BT_GATT_ITER_CONTINUE;
+}
 
-	net_buf_add_mem(data->buf, data->value, data->len);
+/* Get a buffer holding the prepare write request in buf to queue */
+static struct net_buf *prep_buf_get(struct net_buf *buf)
+{
+#if defined(CONFIG_BLUETOOTH_ATT_PREPARE_ZERO_COPY)
+	/* Keep the received buffer, accounted to ATT by the RX quota */
+	return net_buf_ref(buf);
+#else
+	struct net_buf *prep;
 
-	data->err = 0;
+	prep = net_buf_alloc(&prep_pool, K_NO_WAIT);
+	if (prep) {
+		net_buf_add_mem(prep, buf->data, buf->len);
+	}
 
-	return BT_GATT_ITER_CONTINUE;
+	return prep;
+#endif /* CONFIG_BLUETOOTH_ATT_PREPARE_ZERO_COPY */
 }
 
-static uint8_t att_prep_write_rsp(struct bt_att *att, uint16_t handle,
-				  uint16_t offset, const void *value,
-				  uint8_t len)
+static uint8_t att_prep_write_rsp(struct bt_att *att, struct net_buf *buf)
 {
 	struct bt_conn *conn = att->chan.chan.conn;
-	struct prep_data data;
+	struct bt_att_prepare_write_req *req = (void *)buf->data;
 	struct bt_att_prepare_write_rsp *rsp;
+	struct prep_data data;
+	struct net_buf *prep = NULL;
+	uint16_t handle;
 
+	handle = sys_le16_to_cpu(req->handle);
 	if (!handle) {
 		return BT_ATT_ERR_INVALID_HANDLE;
 	}
@@ -1229,13 +1243,23 @@ static uint8_t att_prep_write_rsp(struct bt_att *att, uint16_t handle,
 	memset(&data, 0, sizeof(data));
 
 	data.conn = conn;
-	data.offset = offset;
-	data.value = value;
-	data.len = len;
+	data.offset = sys_le16_to_cpu(req->offset);
+	data.value = req->value;
+	data.len = buf->len - sizeof(*req);
 	data.err = BT_ATT_ERR_INVALID_HANDLE;
 
 	bt_gatt_foreach_attr(handle, handle, prep_write_cb, &data);
 
+	if (!data.err) {
+		if (att->prep_count < CONFIG_BLUETOOTH_ATT_PREPARE_COUNT) {
+			prep = prep_buf_get(buf);
+		}
+
+		if (!prep) {
+			data.err = BT_ATT_ERR_PREPARE_QUEUE_FULL;
+		}
+	}
+
 	if (data.err) {
 		/* Respond here since handle is set */
 		send_err_rsp(conn, BT_ATT_OP_PREPARE_WRITE_REQ, handle,
@@ -1243,24 +1267,29 @@ static uint8_t att_prep_write_rsp(struct bt_att *att, uint16_t handle,
 		return 0;
 	}
 
-	BT_DBG("buf %p handle 0x%04x offset %u", data.buf, handle, offset);
+	BT_DBG("buf %p handle 0x%04x offset %u", prep, handle, data.offset);
 
-	/* Store buffer in the outstanding queue */
-	net_buf_put(&att->prep_queue, data.buf);
+	/* Store the request at the end of the outstanding queue */
+	if (att->prep_queue) {
+		net_buf_frag_add(att->prep_queue, prep);
+	} else {
+		att->prep_queue = prep;
+	}
+
+	att->prep_count++;
 
 	/* Generate response */
-	data.buf = bt_att_create_pdu(conn, BT_ATT_OP_PREPARE_WRITE_RSP, 0);
-	if (!data.buf) {
+	prep = bt_att_create_pdu(conn, BT_ATT_OP_PREPARE_WRITE_RSP, 0);
+	if (!prep) {
 		return BT_ATT_ERR_UNLIKELY;
 	}
 
-	rsp = net_buf_add(data.buf, sizeof(*rsp));
-	rsp->handle = sys_cpu_to_le16(handle);
-	rsp->offset = sys_cpu_to_le16(offset);
-	net_buf_add(data.buf, len);
-	memcpy(rsp->value, value, len);
+	rsp = net_buf_add(prep, sizeof(*rsp));
+	rsp->handle = req->handle;
+	rsp->offset = req->offset;
+	net_buf_add_mem(prep, data.value, data.len);
 
-	bt_l2cap_send(conn, BT_L2CAP_CID_ATT, data.buf);
+	bt_l2cap_send(conn, BT_L2CAP_CID_ATT, prep);
 
 	return 0;
 }
@@ -1271,43 +1300,137 @@ static uint8_t att_prepare_write_req(struct bt_att *att, struct net_buf *buf)
 #if CONFIG_BLUETOOTH_ATT_PREPARE_COUNT == 0
 	return BT_ATT_ERR_NOT_SUPPORTED;
 #else
+	return att_prep_write_rsp(att, buf);
+#endif /* CONFIG_BLUETOOTH_ATT_PREPARE_COUNT */
+}
+
+#if CONFIG_BLUETOOTH_ATT_PREPARE_COUNT > 0
+/*
+ * Detach the first writes of the prepare queue which are contiguous parts of
+ * the same attribute value, as a fragment chain holding their values.
+ */
+static struct net_buf *prep_queue_get(struct bt_att *att, uint16_t *handle,
+				      uint16_t *offset)
+{
 	struct bt_att_prepare_write_req *req;
-	uint16_t handle, offset;
+	struct net_buf *buf, *last;
+	uint16_t next;
 
+	buf = att->prep_queue;
 	req = (void *)buf->data;
+	*handle = sys_le16_to_cpu(req->handle);
+	*offset = sys_le16_to_cpu(req->offset);
+	next = *offset;
 
-	handle = sys_le16_to_cpu(req->handle);
-	offset = sys_le16_to_cpu(req->offset);
-	net_buf_pull(buf, sizeof(*req));
+	for (last = buf; ; last = last->frags) {
+		net_buf_pull(last, sizeof(*req));
+		next += last->len;
+		att->prep_count--;
 
-	BT_DBG("handle 0x%04x offset %u", handle, offset);
+		if (!last->frags) {
+			break;
+		}
 
-	return att_prep_write_rsp(att, handle, offset, buf->data, buf->len);
-#endif /* CONFIG_BLUETOOTH_ATT_PREPARE_COUNT */
+		req = (void *)last->frags->data;
+		if (sys_le16_to_cpu(req->handle) != *handle ||
+		    sys_le16_to_cpu(req->offset) != next) {
+			break;
+		}
+	}
+
+	att->prep_queue = last->frags;
+	last->frags = NULL;
+
+	return buf;
+}
+
+struct exec_data {
+	struct bt_conn *conn;
+	struct net_buf *buf;
+	uint16_t offset;
+	uint8_t err;
+};
+
+static uint8_t exec_write_cb(const struct bt_gatt_attr *attr, void *user_data)
+{
+	struct exec_data *data = user_data;
+	uint16_t offset = data->offset;
+	struct net_buf *frag;
+	int write;
+
+	BT_DBG("handle 0x%04x offset %u", attr->handle, data->offset);
+
+	/* Check attribute permissions */
+	data->err = check_perm(data->conn, attr, BT_GATT_PERM_WRITE_MASK);
+	if (data->err) {
+		return BT_GATT_ITER_STOP;
+	}
+
+	/* Hand the whole chain over if the attribute takes it */
+	if (attr->perm & BT_GATT_PERM_PREPARE_WRITE_CHAIN) {
+		size_t len = net_buf_frags_len(data->buf);
+
+		if (len > UINT16_MAX) {
+			data->err = BT_ATT_ERR_INVALID_ATTRIBUTE_LEN;
+			return BT_GATT_ITER_STOP;
+		}
+
+		write = attr->write(data->conn, attr, data->buf, len, offset,
+				    BT_GATT_WRITE_FLAG_CHAIN);
+		if (write < 0 || write != len) {
+			data->err = err_to_att(write);
+			return BT_GATT_ITER_STOP;
+		}
+
+		data->err = 0;
+
+		return BT_GATT_ITER_CONTINUE;
+	}
+
+	for (frag = data->buf; frag; frag = frag->frags) {
+		write = attr->write(data->conn, attr, frag->data, frag->len,
+				    offset, 0);
+		if (write < 0 || write != frag->len) {
+			data->err = err_to_att(write);
+			return BT_GATT_ITER_STOP;
+		}
+
+		offset += frag->len;
+	}
+
+	data->err = 0;
+
+	return BT_GATT_ITER_CONTINUE;
 }
 
-#if CONFIG_BLUETOOTH_ATT_PREPARE_COUNT > 0
 static uint8_t att_exec_write_rsp(struct bt_att *att, uint8_t flags)
 {
 	struct bt_conn *conn = att->chan.chan.conn;
+	struct exec_data data;
 	struct net_buf *buf;
+	uint16_t handle;
 	uint8_t err = 0;
 
-	while ((buf = net_buf_get(&att->prep_queue, K_NO_WAIT))) {
-		struct bt_attr_data *data = net_buf_user_data(buf);
+	while (att->prep_queue) {
+		buf = prep_queue_get(att, &handle, &data.offset);
 
-		BT_DBG("buf %p handle 0x%04x offset %u", buf, data->handle,
-		       data->offset);
+		BT_DBG("buf %p handle 0x%04x offset %u len %u", buf, handle,
+		       data.offset, net_buf_frags_len(buf));
 
 		/* Just discard the data if an error was set */
 		if (!err && flags == BT_ATT_FLAG_EXEC) {
-			err = att_write_rsp(conn, BT_ATT_OP_EXEC_WRITE_REQ, 0,
-					    data->handle, data->offset,
-					    buf->data, buf->len);
+			data.conn = conn;
+			data.buf = buf;
+			data.err = BT_ATT_ERR_INVALID_HANDLE;
+
+			bt_gatt_foreach_attr(handle, handle, exec_write_cb,
+					     &data);
+
+			err = data.err;
 			if (err) {
 				/* Respond here since handle is set */
 				send_err_rsp(conn, BT_ATT_OP_EXEC_WRITE_REQ,
-					     data->handle, err);
+					     handle, err);
 			}
 		}
 
@@ -1744,11 +1867,11 @@ static void att_reset(struct bt_att *att)
 {
 	sys_snode_t *node, *tmp;
 #if CONFIG_BLUETOOTH_ATT_PREPARE_COUNT > 0
-	struct net_buf *buf;
-
 	/* Discard queued buffers */
-	while ((buf = k_fifo_get(&att->prep_queue, K_NO_WAIT))) {
-		net_buf_unref(buf);
+	if (att->prep_queue) {
+		net_buf_unref(att->prep_queue);
+		att->prep_queue = NULL;
+		att->prep_count = 0;
 	}
 #endif
 
@@ -1804,10 +1927,6 @@ static void bt_att_connected(struct bt_l2cap_chan *chan)
 
 	BT_DBG("chan %p cid 0x%04x", ch, ch->tx.cid);
 
-#if CONFIG_BLUETOOTH_ATT_PREPARE_COUNT > 0
-	k_fifo_init(&att->prep_queue);
-#endif
-
 	ch->tx.mtu = BT_ATT_DEFAULT_LE_MTU;
 	ch->rx.mtu = BT_ATT_DEFAULT_LE_MTU;
 
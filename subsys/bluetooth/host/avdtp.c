@@ -26,6 +26,12 @@
 /* TODO add config file*/
 #define CONFIG_BLUETOOTH_AVDTP_CONN CONFIG_BLUETOOTH_MAX_CONN
 
+#if defined(CONFIG_BLUETOOTH_AVDTP_JITTER_PREFILL)
+#define AVDTP_JITTER_PREFILL CONFIG_BLUETOOTH_AVDTP_JITTER_PREFILL
+#else
+#define AVDTP_JITTER_PREFILL 1
+#endif
+
 /* Pool for outgoing BR/EDR signaling packets, min MTU is 48 */
 /*
 NET_BUF_POOL_DEFINE(avdtp_sig_pool, CONFIG_BLUETOOTH_AVDTP_CONN,
@@ -40,6 +46,9 @@ static struct bt_avdtp_event_cb *event_cb;
 
 static struct bt_avdtp_seid_lsep *lseps;
 
+/* Streams waiting for their incoming transport channel */
+static struct bt_avdtp_stream *media_listen;
+
 struct bt_avdtp_req {
 	uint8_t signal_id;
 	uint8_t transaction_id;
@@ -54,6 +63,8 @@ struct bt_avdtp_req {
 
 #define AVDTP_TIMEOUT K_SECONDS(6)
 
+#define AVDTP_STREAM(_ch) CONTAINER_OF(_ch, struct bt_avdtp_stream, chan.chan)
+
 /* Timeout handler */
 static void avdtp_timeout(struct k_work *work)
 {
@@ -99,6 +110,294 @@ void bt_avdtp_l2cap_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
 	BT_DBG("");
 }
 
+/* Media transport, with the received packets reordered by sequence number
+ * in the jitter buffer of the stream. The buffers are the L2CAP receive
+ * buffers themselves, so that the payload is not copied.
+ */
+static void jitter_flush(struct bt_avdtp_stream *stream)
+{
+	unsigned int key;
+	int i;
+
+	key = irq_lock();
+
+	for (i = 0; i < BT_AVDTP_JITTER_LEN; i++) {
+		if (stream->jb[i]) {
+			net_buf_unref(stream->jb[i]);
+			stream->jb[i] = NULL;
+		}
+	}
+
+	stream->jb_count = 0;
+	stream->jb_playing = false;
+
+	irq_unlock(key);
+}
+
+static void jitter_put(struct bt_avdtp_stream *stream, uint16_t seq,
+		       struct net_buf *buf)
+{
+	struct net_buf **slot;
+	int16_t diff;
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (!stream->jb_count && !stream->jb_playing) {
+		stream->jb_seq = seq;
+	}
+
+	diff = seq - stream->jb_seq;
+	if (diff < 0) {
+		BT_DBG("Late packet seq %u", seq);
+		goto done;
+	}
+
+	if (diff >= BT_AVDTP_JITTER_LEN) {
+		uint16_t shift = diff - BT_AVDTP_JITTER_LEN + 1;
+		uint16_t i;
+
+		/* Make room by dropping the oldest packets */
+		for (i = 0; i < min(shift, BT_AVDTP_JITTER_LEN); i++) {
+			slot = &stream->jb[(stream->jb_seq + i) %
+					   BT_AVDTP_JITTER_LEN];
+			if (*slot) {
+				net_buf_unref(*slot);
+				*slot = NULL;
+				stream->jb_count--;
+			}
+		}
+
+		stream->jb_seq += shift;
+	}
+
+	slot = &stream->jb[seq % BT_AVDTP_JITTER_LEN];
+	if (*slot) {
+		BT_DBG("Duplicate packet seq %u", seq);
+		goto done;
+	}
+
+	*slot = net_buf_ref(buf);
+	stream->jb_count++;
+
+done:
+	irq_unlock(key);
+}
+
+int bt_avdtp_media_get(struct bt_avdtp_stream *stream, struct net_buf **buf)
+{
+	struct net_buf **slot;
+	unsigned int key;
+	int err = 0;
+
+	key = irq_lock();
+
+	if (!stream->jb_count) {
+		stream->jb_playing = false;
+		err = -EAGAIN;
+		goto done;
+	}
+
+	if (!stream->jb_playing) {
+		if (stream->jb_count < AVDTP_JITTER_PREFILL) {
+			err = -EAGAIN;
+			goto done;
+		}
+
+		/* Start playing with the first packet received */
+		while (!stream->jb[stream->jb_seq % BT_AVDTP_JITTER_LEN]) {
+			stream->jb_seq++;
+		}
+
+		stream->jb_playing = true;
+	}
+
+	slot = &stream->jb[stream->jb_seq++ % BT_AVDTP_JITTER_LEN];
+	*buf = *slot;
+	if (*slot) {
+		*slot = NULL;
+		stream->jb_count--;
+	}
+
+done:
+	irq_unlock(key);
+
+	return err;
+}
+
+static void avdtp_media_connected(struct bt_l2cap_chan *chan)
+{
+	struct bt_avdtp_stream *stream = AVDTP_STREAM(chan);
+
+	BT_DBG("chan %p stream %p", chan, stream);
+
+	stream->seq = 0;
+	stream->timestamp = 0;
+
+	if (stream->ops && stream->ops->connected) {
+		stream->ops->connected(stream);
+	}
+}
+
+static void avdtp_media_disconnected(struct bt_l2cap_chan *chan)
+{
+	struct bt_avdtp_stream *stream = AVDTP_STREAM(chan);
+
+	BT_DBG("chan %p stream %p", chan, stream);
+
+	jitter_flush(stream);
+
+	if (stream->ops && stream->ops->disconnected) {
+		stream->ops->disconnected(stream);
+	}
+}
+
+static void avdtp_media_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	struct bt_avdtp_stream *stream = AVDTP_STREAM(chan);
+	struct bt_avdtp_media_hdr *hdr = (void *)buf->data;
+	size_t hdr_len;
+	uint16_t seq;
+
+	if (buf->len < sizeof(*hdr) ||
+	    BT_AVDTP_RTP_VER(hdr->flags) != BT_AVDTP_RTP_VERSION) {
+		BT_ERR("Invalid media packet");
+		return;
+	}
+
+	hdr_len = sizeof(*hdr) + BT_AVDTP_RTP_CC(hdr->flags) * 4;
+	if (buf->len < hdr_len) {
+		BT_ERR("Too small media packet");
+		return;
+	}
+
+	seq = sys_be16_to_cpu(hdr->seq);
+	net_buf_pull(buf, hdr_len);
+
+	BT_DBG("stream %p seq %u len %u", stream, seq, buf->len);
+
+	jitter_put(stream, seq, buf);
+}
+
+static struct bt_l2cap_chan_ops media_ops = {
+	.connected = avdtp_media_connected,
+	.disconnected = avdtp_media_disconnected,
+	.recv = avdtp_media_recv,
+};
+
+struct net_buf *bt_avdtp_media_create_pdu(struct net_buf_pool *pool)
+{
+	return bt_l2cap_create_pdu(pool, BT_AVDTP_MEDIA_HDR_LEN);
+}
+
+int bt_avdtp_media_send(struct bt_avdtp_stream *stream, struct net_buf *buf,
+			uint32_t samples)
+{
+	struct bt_avdtp_media_hdr *hdr;
+	int err;
+
+	if (!stream->chan.chan.conn) {
+		return -ENOTCONN;
+	}
+
+	if (buf->len + sizeof(*hdr) > stream->chan.tx.mtu) {
+		return -EMSGSIZE;
+	}
+
+	hdr = net_buf_push(buf, sizeof(*hdr));
+	hdr->flags = BT_AVDTP_RTP_FLAGS(BT_AVDTP_RTP_VERSION);
+	hdr->pt = BT_AVDTP_RTP_PAYLOAD_TYPE;
+	hdr->seq = sys_cpu_to_be16(stream->seq);
+	hdr->timestamp = sys_cpu_to_be32(stream->timestamp);
+	hdr->ssrc = sys_cpu_to_be32(BT_AVDTP_RTP_SSRC);
+
+	err = bt_l2cap_chan_send(&stream->chan.chan, buf);
+	if (err < 0) {
+		net_buf_pull(buf, sizeof(*hdr));
+		return err;
+	}
+
+	stream->seq++;
+	stream->timestamp += samples;
+
+	return 0;
+}
+
+static void media_init(struct bt_avdtp *session,
+		       struct bt_avdtp_stream *stream)
+{
+	jitter_flush(stream);
+
+	stream->session = session;
+	stream->chan.chan.ops = &media_ops;
+	stream->chan.chan.required_sec_level = BT_SECURITY_MEDIUM;
+	stream->chan.rx.mtu = BT_AVDTP_MAX_MTU;
+}
+
+int bt_avdtp_media_connect(struct bt_avdtp *session,
+			   struct bt_avdtp_stream *stream)
+{
+	if (!session || !stream || !session->br_chan.chan.conn) {
+		return -EINVAL;
+	}
+
+	media_init(session, stream);
+
+	return bt_l2cap_chan_connect(session->br_chan.chan.conn,
+				     &stream->chan.chan, BT_L2CAP_PSM_AVDTP);
+}
+
+int bt_avdtp_media_listen(struct bt_avdtp *session,
+			  struct bt_avdtp_stream *stream)
+{
+	struct bt_avdtp_stream *tmp;
+
+	if (!session || !stream) {
+		return -EINVAL;
+	}
+
+	for (tmp = media_listen; tmp; tmp = tmp->next) {
+		if (tmp == stream) {
+			return -EALREADY;
+		}
+	}
+
+	media_init(session, stream);
+
+	stream->next = media_listen;
+	media_listen = stream;
+
+	return 0;
+}
+
+static struct bt_avdtp_stream *media_listen_take(struct bt_conn *conn)
+{
+	struct bt_avdtp_stream *stream, **prev;
+
+	for (prev = &media_listen; *prev; prev = &(*prev)->next) {
+		stream = *prev;
+
+		if (stream->session->br_chan.chan.conn == conn) {
+			*prev = stream->next;
+			stream->next = NULL;
+			return stream;
+		}
+	}
+
+	return NULL;
+}
+
+int bt_avdtp_media_disconnect(struct bt_avdtp_stream *stream)
+{
+	if (!stream) {
+		return -EINVAL;
+	}
+
+	BT_DBG("stream %p", stream);
+
+	return bt_l2cap_chan_disconnect(&stream->chan.chan);
+}
+
 /*A2DP Layer interface */
 int bt_avdtp_connect(struct bt_conn *conn, struct bt_avdtp *session)
 {
@@ -134,6 +433,7 @@ int bt_avdtp_disconnect(struct bt_avdtp *session)
 int bt_avdtp_l2cap_accept(struct bt_conn *conn, struct bt_l2cap_chan **chan)
 {
 	struct bt_avdtp *session = NULL;
+	struct bt_avdtp_stream *stream;
 	int result;
 	static struct bt_l2cap_chan_ops ops = {
 		.connected = bt_avdtp_l2cap_connected,
@@ -142,6 +442,18 @@ int bt_avdtp_l2cap_accept(struct bt_conn *conn, struct bt_l2cap_chan **chan)
 	};
 
 	BT_DBG("conn %p", conn);
+
+	/* Further channels of a session are transport channels */
+	stream = media_listen_take(conn);
+	if (stream) {
+		*chan = &stream->chan.chan;
+		return 0;
+	}
+
+	if (!event_cb || !event_cb->accept) {
+		return -ENOTSUP;
+	}
+
 	/* Get the AVDTP session from upper layer */
 	result = event_cb->accept(conn, &session);
 	if (result < 0) {
@@ -101,6 +101,25 @@ struct bt_avdtp_single_sig_hdr {
 
 #define BT_AVDTP_SIG_HDR_LEN sizeof(struct bt_avdtp_single_sig_hdr)
 
+/* Media packet header (RTP, RFC 3550) */
+#define BT_AVDTP_RTP_VERSION      2
+#define BT_AVDTP_RTP_PAYLOAD_TYPE 96 /* Dynamic */
+#define BT_AVDTP_RTP_SSRC         1
+
+struct bt_avdtp_media_hdr {
+	uint8_t flags; /* Version, padding, extension, CSRC count */
+	uint8_t pt; /* Marker, payload type */
+	uint16_t seq;
+	uint32_t timestamp;
+	uint32_t ssrc;
+} __packed;
+
+#define BT_AVDTP_MEDIA_HDR_LEN sizeof(struct bt_avdtp_media_hdr)
+
+#define BT_AVDTP_RTP_FLAGS(_ver) ((_ver) << 6)
+#define BT_AVDTP_RTP_VER(_flags) ((_flags) >> 6)
+#define BT_AVDTP_RTP_CC(_flags) ((_flags) & 0x0f)
+
 struct bt_avdtp_ind_cb {
 	/*
 	 * discovery_ind;
@@ -140,3 +159,14 @@ int bt_avdtp_disconnect(struct bt_avdtp *session);
 /* AVDTP SEP register function */
 int bt_avdtp_register_sep(uint8_t media_type, uint8_t role,
 				struct bt_avdtp_seid_lsep *sep);
+
+/* Open the transport channel of a stream */
+int bt_avdtp_media_connect(struct bt_avdtp *session,
+			   struct bt_avdtp_stream *stream);
+
+/* Accept the next incoming transport channel for a stream */
+int bt_avdtp_media_listen(struct bt_avdtp *session,
+			  struct bt_avdtp_stream *stream);
+
+/* Close the transport channel of a stream */
+int bt_avdtp_media_disconnect(struct bt_avdtp_stream *stream);
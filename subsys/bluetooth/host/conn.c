@@ -158,6 +158,88 @@ static void le_conn_update(struct k_work *work)
 	bt_conn_le_param_update(conn, param);
 }
 
+#if defined(CONFIG_BLUETOOTH_CONN_PARAM_AUTO)
+#define PARAM_AUTO_PERIOD	K_MSEC(500)
+
+enum {
+	PARAM_AUTO_NONE,
+	PARAM_AUTO_BUSY,
+	PARAM_AUTO_IDLE,
+};
+
+/* 7.5 to 15 ms without latency while busy, 200 to 400 ms with 4 events of
+ * latency while idle: the supervision timeout of 6 s covers both.
+ */
+static const struct bt_le_conn_param param_auto[] = {
+	[PARAM_AUTO_BUSY] = {
+		.interval_min = 0x0006,
+		.interval_max = 0x000c,
+		.latency = 0,
+		.timeout = 600,
+	},
+	[PARAM_AUTO_IDLE] = {
+		.interval_min = 0x00a0,
+		.interval_max = 0x0140,
+		.latency = 4,
+		.timeout = 600,
+	},
+};
+
+static void le_conn_param_auto(struct k_work *work)
+{
+	struct bt_conn_le *le = CONTAINER_OF(work, struct bt_conn_le,
+					     param_work);
+	struct bt_conn *conn = CONTAINER_OF(le, struct bt_conn, le);
+	uint32_t now = k_uptime_get_32();
+	uint32_t bytes;
+	uint8_t mode;
+	int err;
+
+	if (conn->state != BT_CONN_CONNECTED) {
+		return;
+	}
+
+	bytes = atomic_set(&le->tx_bytes, 0);
+
+	if (bytes * (MSEC_PER_SEC / PARAM_AUTO_PERIOD) >=
+	    CONFIG_BLUETOOTH_CONN_PARAM_AUTO_RATE ||
+	    !k_fifo_is_empty(&conn->tx_queue)) {
+		le->busy_time = now;
+		mode = PARAM_AUTO_BUSY;
+	} else if (now - le->busy_time >= CONFIG_BLUETOOTH_CONN_PARAM_AUTO_IDLE) {
+		mode = PARAM_AUTO_IDLE;
+	} else {
+		mode = le->param_mode;
+	}
+
+	if (mode != le->param_mode && mode != PARAM_AUTO_NONE &&
+	    now - le->param_time >= CONFIG_BLUETOOTH_CONN_PARAM_AUTO_HOLDOFF) {
+		BT_DBG("conn %p %s, %u bytes", conn,
+		       mode == PARAM_AUTO_BUSY ? "busy" : "idle", bytes);
+
+		err = bt_conn_le_param_update(conn, &param_auto[mode]);
+		if (!err || err == -EALREADY) {
+			le->param_mode = mode;
+		}
+
+		/* Failures are not retried before the holdoff either */
+		le->param_time = now;
+	}
+
+	k_delayed_work_submit(&le->param_work, PARAM_AUTO_PERIOD);
+}
+
+static void le_conn_param_auto_start(struct bt_conn *conn)
+{
+	atomic_set(&conn->le.tx_bytes, 0);
+	conn->le.busy_time = k_uptime_get_32();
+	conn->le.param_time = conn->le.busy_time;
+	conn->le.param_mode = PARAM_AUTO_NONE;
+
+	k_delayed_work_submit(&conn->le.param_work, PARAM_AUTO_PERIOD);
+}
+#endif /* CONFIG_BLUETOOTH_CONN_PARAM_AUTO */
+
 static struct bt_conn *conn_new(void)
 {
 	struct bt_conn *conn = NULL;
@@ -789,11 +871,32 @@ static void bt_conn_reset_rx_state(struct bt_conn *conn)
 		return;
 	}
 
-	net_buf_unref(conn->rx);
-	conn->rx = NULL;
+	if (conn->rx) {
+		net_buf_unref(conn->rx);
+		conn->rx = NULL;
+	}
+
 	conn->rx_len = 0;
 }
 
+static uint8_t rx_class(uint16_t cid)
+{
+	switch (cid) {
+	case BT_L2CAP_CID_ATT:
+		return BT_RX_CLASS_ATT;
+	case BT_L2CAP_CID_SMP:
+	case BT_L2CAP_CID_BR_SMP:
+		return BT_RX_CLASS_SMP;
+	default:
+		/* Dynamic channels, the signaling channels are not limited */
+		if (cid >= 0x0040) {
+			return BT_RX_CLASS_L2CAP;
+		}
+
+		return BT_RX_CLASS_NONE;
+	}
+}
+
 void bt_conn_recv(struct bt_conn *conn, struct net_buf *buf, uint8_t flags)
 {
 	struct bt_l2cap_hdr *hdr;
@@ -804,18 +907,40 @@ void bt_conn_recv(struct bt_conn *conn, struct net_buf *buf, uint8_t flags)
 	/* Check packet boundary flags */
 	switch (flags) {
 	case BT_ACL_START:
+		if (conn->rx_len) {
+			BT_ERR("Unexpected first L2CAP frame");
+			bt_conn_reset_rx_state(conn);
+		}
+
+		if (buf->len < sizeof(*hdr)) {
+			BT_ERR("Too small first L2CAP frame");
+			net_buf_unref(buf);
+			return;
+		}
+
 		hdr = (void *)buf->data;
 		len = sys_le16_to_cpu(hdr->len);
 
 		BT_DBG("First, len %u final %u", buf->len, len);
 
-		if (conn->rx_len) {
-			BT_ERR("Unexpected first L2CAP frame");
-			bt_conn_reset_rx_state(conn);
+		if (sizeof(*hdr) + len < buf->len) {
+			BT_ERR("L2CAP data overflow");
+			net_buf_unref(buf);
+			return;
 		}
 
 		conn->rx_len = (sizeof(*hdr) + len) - buf->len;
+		conn->rx_class = rx_class(sys_le16_to_cpu(hdr->cid));
 		BT_DBG("rx_len %u", conn->rx_len);
+
+		if (bt_buf_rx_claim(buf, conn->rx_class)) {
+			BT_WARN("RX quota reached, dropping PDU for CID 0x%04x",
+				sys_le16_to_cpu(hdr->cid));
+			/* Drop the continuation fragments as well */
+			net_buf_unref(buf);
+			return;
+		}
+
 		if (conn->rx_len) {
 			conn->rx = buf;
 			return;
@@ -839,16 +964,25 @@ void bt_conn_recv(struct bt_conn *conn, struct net_buf *buf, uint8_t flags)
 
 		BT_DBG("Cont, len %u rx_len %u", buf->len, conn->rx_len);
 
-		if (buf->len > net_buf_tailroom(conn->rx)) {
-			BT_ERR("Not enough buffer space for L2CAP data");
-			bt_conn_reset_rx_state(conn);
+		conn->rx_len -= buf->len;
+
+		if (conn->rx && bt_buf_rx_claim(buf, conn->rx_class)) {
+			BT_WARN("RX quota reached, dropping PDU");
+			net_buf_unref(conn->rx);
+			conn->rx = NULL;
+		}
+
+		/* PDU being dropped */
+		if (!conn->rx) {
 			net_buf_unref(buf);
 			return;
 		}
 
-		net_buf_add_mem(conn->rx, buf->data, buf->len);
-		conn->rx_len -= buf->len;
-		net_buf_unref(buf);
+		/* Chain the fragments rather than copying them, the
+		 * receiving channel pulls them up if it needs contiguous
+		 * data.
+		 */
+		net_buf_frag_add(conn->rx, buf);
 
 		if (conn->rx_len) {
 			return;
@@ -856,7 +990,6 @@ void bt_conn_recv(struct bt_conn *conn, struct net_buf *buf, uint8_t flags)
 
 		buf = conn->rx;
 		conn->rx = NULL;
-		conn->rx_len = 0;
 
 		break;
 	default:
@@ -866,16 +999,8 @@ void bt_conn_recv(struct bt_conn *conn, struct net_buf *buf, uint8_t flags)
 		return;
 	}
 
-	hdr = (void *)buf->data;
-	len = sys_le16_to_cpu(hdr->len);
-
-	if (sizeof(*hdr) + len != buf->len) {
-		BT_ERR("ACL len mismatch (%u != %u)", len, buf->len);
-		net_buf_unref(buf);
-		return;
-	}
-
-	BT_DBG("Successfully parsed %u byte L2CAP packet", buf->len);
+	BT_DBG("Successfully parsed %u byte L2CAP packet",
+	       net_buf_frags_len(buf));
 
 	bt_l2cap_recv(conn, buf);
 }
@@ -896,19 +1021,97 @@ int bt_conn_send(struct bt_conn *conn, struct net_buf *buf)
 		return -ENOTCONN;
 	}
 
+#if defined(CONFIG_BLUETOOTH_CONN_PARAM_AUTO)
+	if (conn->type == BT_CONN_TYPE_LE) {
+		atomic_add(&conn->le.tx_bytes, net_buf_frags_len(buf));
+	}
+#endif /* CONFIG_BLUETOOTH_CONN_PARAM_AUTO */
+
 	net_buf_put(&conn->tx_queue, buf);
 	return 0;
 }
 
+#if defined(CONFIG_BLUETOOTH_CONN_TX_FAIR)
+/* Number of packets a connection may have pending in the controller: its
+ * buffers are split evenly between the connections having packets pending
+ * or queued, rounding up so that none of them is left unused.
+ */
+static unsigned int conn_tx_quota(struct bt_conn *conn)
+{
+	struct k_sem *pkts = bt_conn_get_pkts(conn);
+	unsigned int busy = 1;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(conns); i++) {
+		struct bt_conn *other = &conns[i];
+
+		if (other == conn || other->state != BT_CONN_CONNECTED ||
+		    bt_conn_get_pkts(other) != pkts) {
+			continue;
+		}
+
+		if (other->pending_pkts ||
+		    !k_fifo_is_empty(&other->tx_queue)) {
+			busy++;
+		}
+	}
+
+	return (pkts->limit + busy - 1) / busy;
+}
+
+static void conn_tx_wait_quota(struct bt_conn *conn)
+{
+	while (conn->state == BT_CONN_CONNECTED &&
+	       conn->pending_pkts >= conn_tx_quota(conn)) {
+		k_sem_take(&conn->tx_notify, K_FOREVER);
+	}
+}
+#endif /* CONFIG_BLUETOOTH_CONN_TX_FAIR */
+
+#if defined(CONFIG_BLUETOOTH_CONN_TX_STATS)
+static void conn_tx_stats_update(struct bt_conn *conn, uint16_t len,
+				 uint32_t start)
+{
+	struct bt_conn_tx_stats *stats = &conn->tx_stats;
+	uint32_t wait;
+
+	wait = SYS_CLOCK_HW_CYCLES_TO_NS(k_cycle_get_32() - start) / 1000;
+
+	stats->pkts++;
+	stats->bytes += len;
+	stats->wait_total += wait;
+
+	if (wait > stats->wait_max) {
+		stats->wait_max = wait;
+	}
+}
+
+int bt_conn_get_tx_stats(const struct bt_conn *conn,
+			 struct bt_conn_tx_stats *stats)
+{
+	*stats = conn->tx_stats;
+
+	return 0;
+}
+#endif /* CONFIG_BLUETOOTH_CONN_TX_STATS */
+
 static bool send_frag(struct bt_conn *conn, struct net_buf *buf, uint8_t flags,
 		      bool always_consume)
 {
 	struct bt_hci_acl_hdr *hdr;
+#if defined(CONFIG_BLUETOOTH_CONN_TX_STATS)
+	uint32_t start = k_cycle_get_32();
+#endif /* CONFIG_BLUETOOTH_CONN_TX_STATS */
 	int err;
 
 	BT_DBG("conn %p buf %p len %u flags 0x%02x", conn, buf, buf->len,
 	       flags);
 
+#if defined(CONFIG_BLUETOOTH_CONN_TX_FAIR)
+	/* Wait until the connection is within its share of the buffers */
+	conn_tx_wait_quota(conn);
+#endif /* CONFIG_BLUETOOTH_CONN_TX_FAIR */
+
 	/* Wait until the controller can accept ACL packets */
 	k_sem_take(bt_conn_get_pkts(conn), K_FOREVER);
 
@@ -930,6 +1133,11 @@ static bool send_frag(struct bt_conn *conn, struct net_buf *buf, uint8_t flags,
 	}
 
 	conn->pending_pkts++;
+
+#if defined(CONFIG_BLUETOOTH_CONN_TX_STATS)
+	conn_tx_stats_update(conn, buf->len - sizeof(*hdr), start);
+#endif /* CONFIG_BLUETOOTH_CONN_TX_STATS */
+
 	return true;
 
 fail:
@@ -1062,6 +1270,9 @@ struct bt_conn *bt_conn_add_le(const bt_addr_le_t *peer)
 	conn->le.interval_min = BT_GAP_INIT_CONN_INT_MIN;
 	conn->le.interval_max = BT_GAP_INIT_CONN_INT_MAX;
 	k_delayed_work_init(&conn->le.update_work, le_conn_update);
+#if defined(CONFIG_BLUETOOTH_CONN_PARAM_AUTO)
+	k_delayed_work_init(&conn->le.param_work, le_conn_param_auto);
+#endif /* CONFIG_BLUETOOTH_CONN_PARAM_AUTO */
 
 	return conn;
 }
@@ -1119,12 +1330,24 @@ void bt_conn_set_state(struct bt_conn *conn, bt_conn_state_t state)
 	switch (conn->state) {
 	case BT_CONN_CONNECTED:
 		k_fifo_init(&conn->tx_queue);
+#if defined(CONFIG_BLUETOOTH_CONN_TX_FAIR)
+		k_sem_init(&conn->tx_notify, 0, 1);
+#endif /* CONFIG_BLUETOOTH_CONN_TX_FAIR */
+#if defined(CONFIG_BLUETOOTH_CONN_TX_STATS)
+		memset(&conn->tx_stats, 0, sizeof(conn->tx_stats));
+#endif /* CONFIG_BLUETOOTH_CONN_TX_STATS */
 		k_thread_spawn(conn->stack, sizeof(conn->stack), conn_tx_thread,
 			    bt_conn_ref(conn), NULL, NULL, K_PRIO_COOP(7),
 			    0, K_NO_WAIT);
 
 		bt_l2cap_connected(conn);
 		notify_connected(conn);
+
+#if defined(CONFIG_BLUETOOTH_CONN_PARAM_AUTO)
+		if (conn->type == BT_CONN_TYPE_LE) {
+			le_conn_param_auto_start(conn);
+		}
+#endif /* CONFIG_BLUETOOTH_CONN_PARAM_AUTO */
 		break;
 	case BT_CONN_DISCONNECTED:
 		/* Notify disconnection and queue a dummy buffer to wake
@@ -1151,9 +1374,15 @@ void bt_conn_set_state(struct bt_conn *conn, bt_conn_state_t state)
 			conn->pending_pkts--;
 		}
 
+		bt_conn_tx_notify(conn);
+
 		/* Cancel Connection Update if it is pending */
-		if (conn->type == BT_CONN_TYPE_LE)
+		if (conn->type == BT_CONN_TYPE_LE) {
 			k_delayed_work_cancel(&conn->le.update_work);
+#if defined(CONFIG_BLUETOOTH_CONN_PARAM_AUTO)
+			k_delayed_work_cancel(&conn->le.param_work);
+#endif /* CONFIG_BLUETOOTH_CONN_PARAM_AUTO */
+		}
 
 		/* Release the reference we took for the very first
 		 * state transition.
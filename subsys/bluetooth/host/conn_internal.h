@@ -47,6 +47,16 @@ struct bt_conn_le {
 
 	/* Delayed work for connection update handling */
 	struct k_delayed_work	update_work;
+
+#if defined(CONFIG_BLUETOOTH_CONN_PARAM_AUTO)
+	/* Bytes sent since the last traffic check */
+	atomic_t		tx_bytes;
+	/* Uptime (in ms) of the last busy check and parameter update */
+	uint32_t		busy_time;
+	uint32_t		param_time;
+	uint8_t			param_mode;
+	struct k_delayed_work	param_work;
+#endif /* CONFIG_BLUETOOTH_CONN_PARAM_AUTO */
 };
 
 #if defined(CONFIG_BLUETOOTH_BREDR)
@@ -80,8 +90,18 @@ struct bt_conn {
 
 	uint8_t			pending_pkts;
 
+#if defined(CONFIG_BLUETOOTH_CONN_TX_FAIR)
+	/* Given when the controller completes packets of the connection */
+	struct k_sem		tx_notify;
+#endif /* CONFIG_BLUETOOTH_CONN_TX_FAIR */
+
+#if defined(CONFIG_BLUETOOTH_CONN_TX_STATS)
+	struct bt_conn_tx_stats	tx_stats;
+#endif /* CONFIG_BLUETOOTH_CONN_TX_STATS */
+
 	uint16_t		rx_len;
 	struct net_buf		*rx;
+	uint8_t			rx_class;
 
 	/* Queue for outgoing ACL data */
 	struct k_fifo		tx_queue;
@@ -188,3 +208,13 @@ static inline struct k_sem *bt_conn_get_pkts(struct bt_conn *conn)
 
 	return &bt_dev.le.pkts;
 }
+
+/* Wake up the TX thread of a connection waiting for its packets to be
+ * completed.
+ */
+static inline void bt_conn_tx_notify(struct bt_conn *conn)
+{
+#if defined(CONFIG_BLUETOOTH_CONN_TX_FAIR)
+	k_sem_give(&conn->tx_notify);
+#endif /* CONFIG_BLUETOOTH_CONN_TX_FAIR */
+}
@@ -38,11 +38,20 @@ static struct bt_gatt_subscribe_params *subscriptions;
 
 #if !defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
 static size_t attr_count;
+#else
+/* Attribute arrays registered, in handle order */
+static struct {
+	struct bt_gatt_attr *attrs;
+	size_t count;
+} db_index[CONFIG_BLUETOOTH_GATT_DYNAMIC_DB_INDEX];
+static size_t db_index_count;
 #endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
 
 int bt_gatt_register(struct bt_gatt_attr *attrs, size_t count)
 {
 #if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
+	struct bt_gatt_attr *first = attrs;
+	size_t total = count;
 	struct bt_gatt_attr *last;
 #endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
 	uint16_t handle;
@@ -102,6 +111,14 @@ populate:
 		       bt_uuid_str(attrs->uuid), attrs->perm);
 	}
 
+#if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
+	if (db_index_count < ARRAY_SIZE(db_index)) {
+		db_index[db_index_count].attrs = first;
+		db_index[db_index_count].count = total;
+		db_index_count++;
+	}
+#endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
+
 	return 0;
 }
 
@@ -240,15 +257,84 @@ ssize_t bt_gatt_attr_read_chrc(struct bt_conn *conn,
 	return bt_gatt_attr_read(conn, attr, buf, len, offset, &pdu, value_len);
 }
 
+/* Binary search of the first attribute of an array, sorted by handle,
+ * having the given handle or a greater one.
+ */
+static struct bt_gatt_attr *attr_lower_bound(struct bt_gatt_attr *attrs,
+					     size_t count, uint16_t handle)
+{
+	size_t lo = 0, hi = count;
+
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+
+		if (attrs[mid].handle < handle) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo < count ? &attrs[lo] : NULL;
+}
+
+/* Registration keeps the handles increasing along the database, so the
+ * first attribute of a range is looked up instead of walking the database
+ * from its start.
+ */
+static struct bt_gatt_attr *gatt_find_first(uint16_t handle)
+{
+#if defined(CONFIG_BLUETOOTH_GATT_DYNAMIC_DB)
+	struct bt_gatt_attr *attr;
+	size_t lo = 0, hi = db_index_count;
+
+	/* Find the last indexed array starting at or before the handle */
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+
+		if (db_index[mid].attrs->handle <= handle) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (!lo) {
+		return db;
+	}
+
+	attr = attr_lower_bound(db_index[lo - 1].attrs,
+				db_index[lo - 1].count, handle);
+	if (attr) {
+		return attr;
+	}
+
+	/* Continue with the arrays registered after it */
+	attr = db_index[lo - 1].attrs[db_index[lo - 1].count - 1]._next;
+	while (attr && attr->handle < handle) {
+		attr = attr->_next;
+	}
+
+	return attr;
+#else
+	if (!db) {
+		return NULL;
+	}
+
+	return attr_lower_bound(db, attr_count, handle);
+#endif /* CONFIG_BLUETOOTH_GATT_DYNAMIC_DB */
+}
+
 void bt_gatt_foreach_attr(uint16_t start_handle, uint16_t end_handle,
 			  bt_gatt_attr_func_t func, void *user_data)
 {
 	const struct bt_gatt_attr *attr;
 
-	for (attr = db; attr; attr = bt_gatt_attr_next(attr)) {
-		/* Check if attribute handle is within range */
-		if (attr->handle < start_handle || attr->handle > end_handle) {
-			continue;
+	for (attr = gatt_find_first(start_handle); attr;
+	     attr = bt_gatt_attr_next(attr)) {
+		/* Stop once past the end of the range */
+		if (attr->handle > end_handle) {
+			break;
 		}
 
 		if (func(attr, user_data) == BT_GATT_ITER_STOP) {
@@ -518,12 +604,20 @@ static uint8_t notify_cb(const struct bt_gatt_attr *attr, void *user_data)
 
 	ccc = attr->user_data;
 
+	/* No peer subscribed at all */
+	if (!ccc->value) {
+		return BT_GATT_ITER_STOP;
+	}
+
 	/* Notify all peers configured */
 	for (i = 0; i < ccc->cfg_len; i++) {
 		struct bt_conn *conn;
 		int err;
 
-		if (ccc->value != data->type) {
+		/* Skip the peers which did not subscribe, before looking up
+		 * their connection.
+		 */
+		if (!ccc->cfg[i].valid || !(ccc->cfg[i].value & data->type)) {
 			continue;
 		}
 
@@ -577,6 +671,23 @@ int bt_gatt_notify(struct bt_conn *conn, const struct bt_gatt_attr *attr,
 	return 0;
 }
 
+int bt_gatt_notify_multiple(struct bt_conn *conn,
+			    const struct bt_gatt_notify_params *params,
+			    size_t count)
+{
+	int err;
+
+	for (; count; params++, count--) {
+		err = bt_gatt_notify(conn, params->attr, params->data,
+				     params->len);
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
 int bt_gatt_indicate(struct bt_conn *conn,
 		     struct bt_gatt_indicate_params *params)
 {
@@ -701,6 +812,8 @@ void bt_gatt_notification(struct bt_conn *conn, uint16_t handle,
 
 	BT_DBG("handle 0x%04x length %u", handle, length);
 
+	bt_gatt_cache_notification(conn, handle);
+
 	for (params = subscriptions; params; params = params->_next) {
 		if (bt_conn_addr_le_cmp(conn, &params->_peer)) {
 			continue;
@@ -821,10 +934,15 @@ static void gatt_find_type_rsp(struct bt_conn *conn, uint8_t err,
 	struct bt_gatt_discover_params *params = user_data;
 	uint8_t i;
 	uint16_t end_handle = 0, start_handle;
+	bool cached = true;
 
 	BT_DBG("err 0x%02x", err);
 
 	if (err) {
+		if (err == BT_ATT_ERR_ATTRIBUTE_NOT_FOUND) {
+			bt_gatt_cache_cover(conn, params);
+		}
+
 		goto done;
 	}
 
@@ -840,6 +958,10 @@ static void gatt_find_type_rsp(struct bt_conn *conn, uint8_t err,
 		BT_DBG("start_handle 0x%04x end_handle 0x%04x", start_handle,
 		       end_handle);
 
+		cached = cached && bt_gatt_cache_add(conn, params, start_handle,
+						     end_handle, params->uuid,
+						     0);
+
 		if (params->type == BT_GATT_DISCOVER_PRIMARY) {
 			attr.uuid = BT_UUID_GATT_PRIMARY;
 		} else {
@@ -1074,6 +1196,7 @@ static uint16_t parse_characteristic(struct bt_conn *conn, const void *pdu,
 {
 	const struct bt_att_read_type_rsp *rsp = pdu;
 	uint16_t handle = 0;
+	bool cached = true;
 	union {
 		struct bt_uuid uuid;
 		struct bt_uuid_16 u16;
@@ -1118,6 +1241,10 @@ static uint16_t parse_characteristic(struct bt_conn *conn, const void *pdu,
 		BT_DBG("handle 0x%04x uuid %s properties 0x%02x", handle,
 		       bt_uuid_str(&u.uuid), chrc->properties);
 
+		cached = cached && bt_gatt_cache_add(conn, params, handle, 0,
+						     &u.uuid,
+						     chrc->properties);
+
 		/* Skip if UUID is set but doesn't match */
 		if (params->uuid && bt_uuid_cmp(&u.uuid, params->uuid)) {
 			continue;
@@ -1152,6 +1279,10 @@ static void gatt_read_type_rsp(struct bt_conn *conn, uint8_t err,
 	BT_DBG("err 0x%02x", err);
 
 	if (err) {
+		if (err == BT_ATT_ERR_ATTRIBUTE_NOT_FOUND) {
+			bt_gatt_cache_cover(conn, params);
+		}
+
 		params->func(conn, NULL, params);
 		return;
 	}
@@ -1203,6 +1334,7 @@ static void gatt_find_info_rsp(struct bt_conn *conn, uint8_t err,
 	const struct bt_att_find_info_rsp *rsp = pdu;
 	struct bt_gatt_discover_params *params = user_data;
 	uint16_t handle = 0;
+	bool cached = true;
 	uint8_t len;
 	union {
 		const struct bt_att_info_16 *i16;
@@ -1217,6 +1349,10 @@ static void gatt_find_info_rsp(struct bt_conn *conn, uint8_t err,
 	BT_DBG("err 0x%02x", err);
 
 	if (err) {
+		if (err == BT_ATT_ERR_ATTRIBUTE_NOT_FOUND) {
+			bt_gatt_cache_cover(conn, params);
+		}
+
 		goto done;
 	}
 
@@ -1254,6 +1390,9 @@ static void gatt_find_info_rsp(struct bt_conn *conn, uint8_t err,
 
 		BT_DBG("handle 0x%04x uuid %s", handle, bt_uuid_str(&u.uuid));
 
+		cached = cached && bt_gatt_cache_add(conn, params, handle, 0,
+						     &u.uuid, 0);
+
 		/* Skip if UUID is set but doesn't match */
 		if (params->uuid && bt_uuid_cmp(&u.uuid, params->uuid)) {
 			continue;
@@ -1314,6 +1453,11 @@ int bt_gatt_discover(struct bt_conn *conn,
 		return -ENOTCONN;
 	}
 
+	/* The callbacks are run right away for what the cache knows */
+	if (bt_gatt_cache_discover(conn, params)) {
+		return 0;
+	}
+
 	switch (params->type) {
 	case BT_GATT_DISCOVER_PRIMARY:
 	case BT_GATT_DISCOVER_SECONDARY:
@@ -1531,37 +1675,77 @@ static int gatt_exec_write(struct bt_conn *conn,
 	return gatt_send(conn, buf, gatt_write_rsp, params, NULL);
 }
 
-static void gatt_prepare_write_rsp(struct bt_conn *conn, uint8_t err,
-				   const void *pdu, uint16_t length,
-				   void *user_data)
+static int gatt_prepare_write(struct bt_conn *conn,
+			      struct bt_gatt_write_params *params,
+			      struct bt_att_req *att_req, bt_att_func_t func);
+
+static void gatt_prepare_write_done(struct bt_conn *conn, uint8_t err,
+				    struct bt_gatt_write_params *params,
+				    struct bt_att_req *att_req,
+				    bt_att_func_t func)
 {
-	struct bt_gatt_write_params *params = user_data;
+	BT_DBG("err 0x%02x pending %u", err, params->_prep_pending);
 
-	BT_DBG("err 0x%02x", err);
+	params->_prep_pending--;
 
+	/* Keep the first error */
+	if (err && !params->_prep_err) {
+		params->_prep_err = err;
+	}
 
-	/* Don't continue in case of error */
-	if (err) {
-		params->func(conn, err, params);
+	/* Queue the next chunk behind the one still outstanding */
+	if (!params->_prep_err && params->length &&
+	    gatt_prepare_write(conn, params, att_req, func)) {
+		params->_prep_err = BT_ATT_ERR_UNLIKELY;
+	}
+
+	if (params->_prep_pending) {
 		return;
 	}
 
-	/* If there is no more data execute */
-	if (!params->length) {
-		gatt_exec_write(conn, params);
+	/* Don't continue in case of error */
+	if (params->_prep_err) {
+		params->func(conn, params->_prep_err, params);
 		return;
 	}
 
-	/* Write next chunk */
-	bt_gatt_write(conn, params);
+	/* There is no more data, execute */
+	if (gatt_exec_write(conn, params)) {
+		params->func(conn, BT_ATT_ERR_UNLIKELY, params);
+	}
+}
+
+static void gatt_prepare_write_rsp(struct bt_conn *conn, uint8_t err,
+				   const void *pdu, uint16_t length,
+				   void *user_data)
+{
+	struct bt_gatt_write_params *params = user_data;
+
+	gatt_prepare_write_done(conn, err, params, &params->_req,
+				gatt_prepare_write_rsp);
+}
+
+static void gatt_prepare_write_next_rsp(struct bt_conn *conn, uint8_t err,
+					const void *pdu, uint16_t length,
+					void *user_data)
+{
+	struct bt_gatt_write_params *params;
+
+	params = CONTAINER_OF(user_data, struct bt_gatt_write_params,
+			      _prep_req);
+
+	gatt_prepare_write_done(conn, err, params, &params->_prep_req,
+				gatt_prepare_write_next_rsp);
 }
 
 static int gatt_prepare_write(struct bt_conn *conn,
-			      struct bt_gatt_write_params *params)
+			      struct bt_gatt_write_params *params,
+			      struct bt_att_req *att_req, bt_att_func_t func)
 {
 	struct net_buf *buf;
 	struct bt_att_prepare_write_req *req;
 	uint16_t len;
+	int err;
 
 	len = min(params->length, bt_att_get_mtu(conn) - sizeof(*req) - 1);
 
@@ -1577,15 +1761,47 @@ static int gatt_prepare_write(struct bt_conn *conn,
 	memcpy(req->value, params->data, len);
 	net_buf_add(buf, len);
 
+	BT_DBG("handle 0x%04x offset %u len %u", params->handle, params->offset,
+	       len);
+
+	err = gatt_send(conn, buf, func, att_req, NULL);
+	if (err) {
+		return err;
+	}
+
 	/* Update params */
 	params->offset += len;
 	params->data += len;
 	params->length -= len;
+	params->_prep_pending++;
 
-	BT_DBG("handle 0x%04x offset %u len %u", params->handle, params->offset,
-	       params->length);
+	return 0;
+}
 
-	return gatt_send(conn, buf, gatt_prepare_write_rsp, params, NULL);
+static int gatt_long_write(struct bt_conn *conn,
+			   struct bt_gatt_write_params *params)
+{
+	int err;
+
+	params->_prep_pending = 0;
+	params->_prep_err = 0;
+
+	err = gatt_prepare_write(conn, params, &params->_req,
+				 gatt_prepare_write_rsp);
+	if (err) {
+		return err;
+	}
+
+	/* Only one request can be outstanding: queue the second chunk
+	 * already so that it is sent as soon as the first one is
+	 * answered, it is otherwise sent from the response callback.
+	 */
+	if (params->length) {
+		gatt_prepare_write(conn, params, &params->_prep_req,
+				   gatt_prepare_write_next_rsp);
+	}
+
+	return 0;
 }
 
 int bt_gatt_write(struct bt_conn *conn, struct bt_gatt_write_params *params)
@@ -1604,7 +1820,7 @@ int bt_gatt_write(struct bt_conn *conn, struct bt_gatt_write_params *params)
 	/* Use Prepare Write if offset is set or Long Write is required */
 	if (params->offset ||
 	    params->length > (bt_att_get_mtu(conn) - sizeof(*req) - 1)) {
-		return gatt_prepare_write(conn, params);
+		return gatt_long_write(conn, params);
 	}
 
 	buf = bt_att_create_pdu(conn, BT_ATT_OP_WRITE_REQ,
@@ -1820,6 +2036,44 @@ static void update_subscriptions(struct bt_conn *conn)
 
 #endif /* CONFIG_BLUETOOTH_GATT_CLIENT */
 
+#if defined(CONFIG_BLUETOOTH_GATT_AUTO_EXCHANGE_MTU)
+static struct bt_gatt_exchange_params mtu_params[CONFIG_BLUETOOTH_MAX_CONN];
+
+static void auto_mtu_rsp(struct bt_conn *conn, uint8_t err,
+			 struct bt_gatt_exchange_params *params)
+{
+	BT_DBG("conn %p err 0x%02x mtu %u", conn, err, bt_att_get_mtu(conn));
+
+	/* Release the parameters */
+	params->func = NULL;
+}
+
+static void auto_exchange_mtu(struct bt_conn *conn)
+{
+	int i;
+
+	if (BT_ATT_MTU <= BT_ATT_DEFAULT_LE_MTU) {
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(mtu_params); i++) {
+		if (!mtu_params[i].func) {
+			break;
+		}
+	}
+
+	if (i == ARRAY_SIZE(mtu_params)) {
+		return;
+	}
+
+	mtu_params[i].func = auto_mtu_rsp;
+
+	if (bt_gatt_exchange_mtu(conn, &mtu_params[i])) {
+		mtu_params[i].func = NULL;
+	}
+}
+#endif /* CONFIG_BLUETOOTH_GATT_AUTO_EXCHANGE_MTU */
+
 void bt_gatt_connected(struct bt_conn *conn)
 {
 	BT_DBG("conn %p", conn);
@@ -1827,6 +2081,9 @@ void bt_gatt_connected(struct bt_conn *conn)
 #if defined(CONFIG_BLUETOOTH_GATT_CLIENT)
 	add_subscriptions(conn);
 #endif /* CONFIG_BLUETOOTH_GATT_CLIENT */
+#if defined(CONFIG_BLUETOOTH_GATT_AUTO_EXCHANGE_MTU)
+	auto_exchange_mtu(conn);
+#endif /* CONFIG_BLUETOOTH_GATT_AUTO_EXCHANGE_MTU */
 }
 
 void bt_gatt_disconnected(struct bt_conn *conn)
@@ -1834,6 +2091,8 @@ void bt_gatt_disconnected(struct bt_conn *conn)
 	BT_DBG("conn %p", conn);
 	bt_gatt_foreach_attr(0x0001, 0xffff, disconnected_cb, conn);
 
+	bt_gatt_cache_disconnected(conn);
+
 #if defined(CONFIG_BLUETOOTH_GATT_CLIENT)
 	/* If bonded don't remove subscriptions */
 	if (bt_addr_le_is_bonded(&conn->le.dst)) {
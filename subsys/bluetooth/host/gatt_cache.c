@@ -0,0 +1,539 @@
+/* gatt_cache.c - GATT client discovery cache */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <misc/byteorder.h>
+#include <misc/util.h>
+
+#define BT_DBG_ENABLED IS_ENABLED(CONFIG_BLUETOOTH_DEBUG_GATT)
+#include <bluetooth/log.h>
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/uuid.h>
+#include <bluetooth/gatt.h>
+#include <bluetooth/storage.h>
+
+#include "hci_core.h"
+#include "conn_internal.h"
+#include "keys.h"
+#include "gatt_internal.h"
+
+#define CACHE_ATTRS	CONFIG_BLUETOOTH_GATT_CACHE_ATTRS
+#define CACHE_RANGES	CONFIG_BLUETOOTH_GATT_CACHE_RANGES
+
+union cache_uuid {
+	struct bt_uuid uuid;
+	struct bt_uuid_16 u16;
+	struct bt_uuid_32 u32;
+	struct bt_uuid_128 u128;
+};
+
+/* Attribute found by a discovery */
+struct cache_attr {
+	uint16_t handle;
+	/* End handle of a service */
+	uint16_t end_handle;
+	uint8_t type;
+	/* Properties of a characteristic */
+	uint8_t properties;
+	union cache_uuid uuid;
+};
+
+/* Handle range over which all the attributes a discovery type reports
+ * are cached. Services are discovered by UUID, so their ranges only hold
+ * for that UUID.
+ */
+struct cache_range {
+	uint16_t start_handle;
+	uint16_t end_handle;
+	uint8_t type;
+	union cache_uuid uuid;
+};
+
+/* Cache of a bonded peer, also the layout of its storage entry */
+struct gatt_cache {
+	bt_addr_le_t addr;
+	/* LTK of the bond the cache was built with */
+	uint8_t ltk[16];
+	uint8_t attr_count;
+	uint8_t range_count;
+	/* Attributes ordered by handle */
+	struct cache_attr attrs[CACHE_ATTRS];
+	struct cache_range ranges[CACHE_RANGES];
+};
+
+static struct gatt_cache caches[CONFIG_BLUETOOTH_MAX_PAIRED];
+static bool dirty[CONFIG_BLUETOOTH_MAX_PAIRED];
+static uint8_t cache_evict;
+
+static void uuid_copy(union cache_uuid *dst, const struct bt_uuid *src)
+{
+	switch (src->type) {
+	case BT_UUID_TYPE_16:
+		dst->u16 = *BT_UUID_16(src);
+		break;
+	case BT_UUID_TYPE_32:
+		dst->u32 = *BT_UUID_32(src);
+		break;
+	case BT_UUID_TYPE_128:
+		dst->u128 = *BT_UUID_128(src);
+		break;
+	}
+}
+
+static bool is_service(uint8_t type)
+{
+	return type == BT_GATT_DISCOVER_PRIMARY ||
+	       type == BT_GATT_DISCOVER_SECONDARY;
+}
+
+static bool is_cached(uint8_t type)
+{
+	/* Included services are not cached: one with a 128-bit UUID needs
+	 * an extra read which does not fit the handle ranges.
+	 */
+	return is_service(type) || type == BT_GATT_DISCOVER_CHARACTERISTIC ||
+	       type == BT_GATT_DISCOVER_DESCRIPTOR;
+}
+
+static struct bt_keys *conn_bond(struct bt_conn *conn)
+{
+	struct bt_keys *keys;
+
+	if (conn->type != BT_CONN_TYPE_LE) {
+		return NULL;
+	}
+
+	keys = bt_keys_find_addr(&conn->le.dst);
+	if (!keys || !(keys->keys & (BT_KEYS_LTK | BT_KEYS_LTK_P256))) {
+		return NULL;
+	}
+
+	return keys;
+}
+
+static int cache_index(struct gatt_cache *cache)
+{
+	return cache - caches;
+}
+
+static void cache_reset(struct gatt_cache *cache, const bt_addr_le_t *addr,
+			const struct bt_keys *keys)
+{
+	memset(cache, 0, sizeof(*cache));
+	bt_addr_le_copy(&cache->addr, addr);
+	memcpy(cache->ltk, keys->ltk.val, sizeof(cache->ltk));
+}
+
+static void cache_store(struct gatt_cache *cache)
+{
+	if (!dirty[cache_index(cache)]) {
+		return;
+	}
+
+	dirty[cache_index(cache)] = false;
+
+	if (bt_storage) {
+		bt_storage->write(&cache->addr, BT_STORAGE_GATT_CACHE, cache,
+				  sizeof(*cache));
+	}
+}
+
+static void cache_load(struct gatt_cache *cache, const bt_addr_le_t *addr,
+		       const struct bt_keys *keys)
+{
+	ssize_t ret;
+
+	if (!bt_storage) {
+		goto reset;
+	}
+
+	ret = bt_storage->read(addr, BT_STORAGE_GATT_CACHE, cache,
+			       sizeof(*cache));
+	if (ret != sizeof(*cache) || bt_addr_le_cmp(&cache->addr, addr) ||
+	    memcmp(cache->ltk, keys->ltk.val, sizeof(cache->ltk)) ||
+	    cache->attr_count > CACHE_ATTRS ||
+	    cache->range_count > CACHE_RANGES) {
+		goto reset;
+	}
+
+	BT_DBG("Loaded %u attributes for %s", cache->attr_count,
+	       bt_addr_le_str(addr));
+
+	return;
+
+reset:
+	cache_reset(cache, addr, keys);
+}
+
+/* Get the cache of the peer of a connection, only kept for bonded peers.
+ * A cache built for an older bond of the peer is dropped.
+ */
+static struct gatt_cache *cache_get(struct bt_conn *conn)
+{
+	struct gatt_cache *cache = NULL;
+	struct bt_keys *keys;
+	int i;
+
+	keys = conn_bond(conn);
+	if (!keys) {
+		return NULL;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(caches); i++) {
+		if (!bt_addr_le_cmp(&caches[i].addr, &conn->le.dst)) {
+			cache = &caches[i];
+			break;
+		}
+
+		if (!cache &&
+		    !bt_addr_le_cmp(&caches[i].addr, BT_ADDR_LE_ANY)) {
+			cache = &caches[i];
+		}
+	}
+
+	if (cache && !bt_addr_le_cmp(&cache->addr, &conn->le.dst)) {
+		if (memcmp(cache->ltk, keys->ltk.val, sizeof(cache->ltk))) {
+			cache_reset(cache, &conn->le.dst, keys);
+			dirty[cache_index(cache)] = true;
+		}
+
+		return cache;
+	}
+
+	if (!cache) {
+		cache = &caches[cache_evict];
+		cache_evict = (cache_evict + 1) % ARRAY_SIZE(caches);
+		cache_store(cache);
+	}
+
+	cache_load(cache, &conn->le.dst, keys);
+	dirty[cache_index(cache)] = false;
+
+	return cache;
+}
+
+static bool range_match(const struct cache_range *range, uint8_t type,
+			const struct bt_uuid *uuid)
+{
+	if (range->type != type) {
+		return false;
+	}
+
+	return !is_service(type) || !bt_uuid_cmp(&range->uuid.uuid, uuid);
+}
+
+static void cache_cover(struct gatt_cache *cache,
+			const struct bt_gatt_discover_params *params,
+			uint16_t end_handle)
+{
+	uint16_t start_handle = params->start_handle;
+	struct cache_range *range;
+	int i;
+
+	end_handle = min(end_handle, params->end_handle);
+
+	/* Merge the ranges overlapping or adjacent to the new one */
+	for (i = 0; i < cache->range_count;) {
+		range = &cache->ranges[i];
+
+		if (!range_match(range, params->type, params->uuid) ||
+		    range->start_handle > end_handle + 1 ||
+		    range->end_handle + 1 < start_handle) {
+			i++;
+			continue;
+		}
+
+		start_handle = min(start_handle, range->start_handle);
+		end_handle = max(end_handle, range->end_handle);
+
+		*range = cache->ranges[--cache->range_count];
+	}
+
+	if (cache->range_count == CACHE_RANGES) {
+		return;
+	}
+
+	range = &cache->ranges[cache->range_count++];
+	range->start_handle = start_handle;
+	range->end_handle = end_handle;
+	range->type = params->type;
+
+	if (is_service(params->type)) {
+		uuid_copy(&range->uuid, params->uuid);
+	}
+
+	dirty[cache_index(cache)] = true;
+}
+
+bool bt_gatt_cache_add(struct bt_conn *conn,
+		       const struct bt_gatt_discover_params *params,
+		       uint16_t handle, uint16_t end_handle,
+		       const struct bt_uuid *uuid, uint8_t properties)
+{
+	struct gatt_cache *cache;
+	struct cache_attr *attr;
+	int i;
+
+	if (!is_cached(params->type)) {
+		return false;
+	}
+
+	cache = cache_get(conn);
+	if (!cache) {
+		return false;
+	}
+
+	for (i = 0; i < cache->attr_count; i++) {
+		attr = &cache->attrs[i];
+
+		if (attr->handle > handle) {
+			break;
+		}
+
+		if (attr->handle == handle && attr->type == params->type) {
+			goto found;
+		}
+	}
+
+	if (cache->attr_count == CACHE_ATTRS) {
+		BT_DBG("No room to cache handle 0x%04x", handle);
+		return false;
+	}
+
+	attr = &cache->attrs[i];
+	memmove(attr + 1, attr, (cache->attr_count - i) * sizeof(*attr));
+	cache->attr_count++;
+
+found:
+	attr->handle = handle;
+	attr->end_handle = end_handle;
+	attr->type = params->type;
+	attr->properties = properties;
+	uuid_copy(&attr->uuid, uuid);
+
+	/* Everything from the start of the request up to this attribute
+	 * has been reported by the server.
+	 */
+	cache_cover(cache, params, is_service(params->type) ?
+		    end_handle : handle);
+
+	return true;
+}
+
+void bt_gatt_cache_cover(struct bt_conn *conn,
+			 const struct bt_gatt_discover_params *params)
+{
+	struct gatt_cache *cache;
+
+	if (!is_cached(params->type)) {
+		return;
+	}
+
+	cache = cache_get(conn);
+	if (cache) {
+		cache_cover(cache, params, params->end_handle);
+	}
+}
+
+static bool attr_match(const struct cache_attr *attr,
+		       const struct bt_gatt_discover_params *params)
+{
+	if (attr->type != params->type) {
+		return false;
+	}
+
+	if (is_service(params->type)) {
+		/* Services are cached together with the UUID searched */
+		return !bt_uuid_cmp(&attr->uuid.uuid, params->uuid);
+	}
+
+	return !params->uuid || !bt_uuid_cmp(&attr->uuid.uuid, params->uuid);
+}
+
+/* Look the next attribute to report up by handle, the cache may change
+ * while the callback of the previous one runs.
+ */
+static bool cache_next(struct gatt_cache *cache,
+		       const struct bt_gatt_discover_params *params,
+		       uint16_t handle, uint16_t end_handle,
+		       struct cache_attr *found)
+{
+	int i;
+
+	for (i = 0; i < cache->attr_count; i++) {
+		struct cache_attr *attr = &cache->attrs[i];
+
+		if (attr->handle < handle) {
+			continue;
+		}
+
+		if (attr->handle > end_handle) {
+			break;
+		}
+
+		if (attr_match(attr, params)) {
+			*found = *attr;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static uint8_t cache_report(struct bt_conn *conn, struct cache_attr *found,
+			    struct bt_gatt_discover_params *params)
+{
+	struct bt_gatt_attr attr = {};
+	struct bt_gatt_service value;
+	struct bt_gatt_chrc chrc;
+
+	switch (params->type) {
+	case BT_GATT_DISCOVER_PRIMARY:
+	case BT_GATT_DISCOVER_SECONDARY:
+		if (params->type == BT_GATT_DISCOVER_PRIMARY) {
+			attr.uuid = BT_UUID_GATT_PRIMARY;
+		} else {
+			attr.uuid = BT_UUID_GATT_SECONDARY;
+		}
+
+		value.end_handle = found->end_handle;
+		value.uuid = params->uuid;
+		attr.user_data = &value;
+		break;
+	case BT_GATT_DISCOVER_CHARACTERISTIC:
+		chrc.uuid = &found->uuid.uuid;
+		chrc.properties = found->properties;
+
+		attr.uuid = BT_UUID_GATT_CHRC;
+		attr.perm = BT_GATT_PERM_READ;
+		attr.read = bt_gatt_attr_read_chrc;
+		attr.user_data = &chrc;
+		break;
+	default:
+		attr.uuid = &found->uuid.uuid;
+		break;
+	}
+
+	attr.handle = found->handle;
+
+	return params->func(conn, &attr, params);
+}
+
+bool bt_gatt_cache_discover(struct bt_conn *conn,
+			    struct bt_gatt_discover_params *params)
+{
+	struct gatt_cache *cache;
+	struct cache_attr found;
+	uint16_t handle, end_handle;
+	int i;
+
+	if (!is_cached(params->type)) {
+		return false;
+	}
+
+	cache = cache_get(conn);
+	if (!cache) {
+		return false;
+	}
+
+	for (i = 0; i < cache->range_count; i++) {
+		struct cache_range *range = &cache->ranges[i];
+
+		if (range_match(range, params->type, params->uuid) &&
+		    range->start_handle <= params->start_handle &&
+		    range->end_handle >= params->start_handle) {
+			break;
+		}
+	}
+
+	if (i == cache->range_count) {
+		return false;
+	}
+
+	end_handle = min(cache->ranges[i].end_handle, params->end_handle);
+
+	BT_DBG("type %u start_handle 0x%04x end_handle 0x%04x from cache",
+	       params->type, params->start_handle, end_handle);
+
+	for (handle = params->start_handle;
+	     cache_next(cache, params, handle, end_handle, &found);
+	     handle = found.handle + 1) {
+		if (cache_report(conn, &found, params) == BT_GATT_ITER_STOP) {
+			return true;
+		}
+
+		if (found.handle == UINT16_MAX) {
+			break;
+		}
+	}
+
+	if (end_handle < params->end_handle) {
+		/* Discover the rest of the range from the server */
+		params->start_handle = end_handle + 1;
+		return false;
+	}
+
+	params->func(conn, NULL, params);
+
+	return true;
+}
+
+void bt_gatt_cache_notification(struct bt_conn *conn, uint16_t handle)
+{
+	struct gatt_cache *cache;
+	int i;
+
+	cache = cache_get(conn);
+	if (!cache) {
+		return;
+	}
+
+	/* The value of the Service Changed characteristic follows its
+	 * declaration.
+	 */
+	for (i = 0; i < cache->attr_count; i++) {
+		struct cache_attr *attr = &cache->attrs[i];
+
+		if (attr->type == BT_GATT_DISCOVER_CHARACTERISTIC &&
+		    attr->handle + 1 == handle &&
+		    !bt_uuid_cmp(&attr->uuid.uuid, BT_UUID_GATT_SC)) {
+			break;
+		}
+	}
+
+	if (i == cache->attr_count) {
+		return;
+	}
+
+	BT_DBG("Service Changed, dropping cache of %s",
+	       bt_addr_le_str(&conn->le.dst));
+
+	cache->attr_count = 0;
+	cache->range_count = 0;
+	dirty[cache_index(cache)] = true;
+}
+
+void bt_gatt_cache_disconnected(struct bt_conn *conn)
+{
+	int i;
+
+	if (conn->type != BT_CONN_TYPE_LE) {
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(caches); i++) {
+		if (!bt_addr_le_cmp(&caches[i].addr, &conn->le.dst)) {
+			cache_store(&caches[i]);
+			break;
+		}
+	}
+}
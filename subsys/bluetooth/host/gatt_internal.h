@@ -20,3 +20,51 @@ static inline void bt_gatt_notification(struct bt_conn *conn, uint16_t handle,
 {
 }
 #endif /* CONFIG_BLUETOOTH_GATT_CLIENT */
+
+#if defined(CONFIG_BLUETOOTH_GATT_CACHE)
+/* Record an attribute found by a discovery, returns false if it could not
+ * be cached.
+ */
+bool bt_gatt_cache_add(struct bt_conn *conn,
+		       const struct bt_gatt_discover_params *params,
+		       uint16_t handle, uint16_t end_handle,
+		       const struct bt_uuid *uuid, uint8_t properties);
+/* Record that the server found nothing in the range of a discovery */
+void bt_gatt_cache_cover(struct bt_conn *conn,
+			 const struct bt_gatt_discover_params *params);
+/* Run a discovery from the cache, returns false if the server needs to
+ * be asked, from the updated start handle of the discovery.
+ */
+bool bt_gatt_cache_discover(struct bt_conn *conn,
+			    struct bt_gatt_discover_params *params);
+void bt_gatt_cache_notification(struct bt_conn *conn, uint16_t handle);
+void bt_gatt_cache_disconnected(struct bt_conn *conn);
+#else
+static inline bool bt_gatt_cache_add(struct bt_conn *conn,
+				const struct bt_gatt_discover_params *params,
+				uint16_t handle, uint16_t end_handle,
+				const struct bt_uuid *uuid, uint8_t properties)
+{
+	return false;
+}
+
+static inline void bt_gatt_cache_cover(struct bt_conn *conn,
+				const struct bt_gatt_discover_params *params)
+{
+}
+
+static inline bool bt_gatt_cache_discover(struct bt_conn *conn,
+				struct bt_gatt_discover_params *params)
+{
+	return false;
+}
+
+static inline void bt_gatt_cache_notification(struct bt_conn *conn,
+					      uint16_t handle)
+{
+}
+
+static inline void bt_gatt_cache_disconnected(struct bt_conn *conn)
+{
+}
+#endif /* CONFIG_BLUETOOTH_GATT_CACHE */
@@ -47,15 +47,14 @@ static void init_work(struct k_work *work);
 
 struct bt_dev bt_dev = {
 	.init          = K_WORK_INITIALIZER(init_work),
-	/* Give cmd_sem allowing to send first HCI_Reset cmd, the only
-	 * exception is if the controller requests to wait for an
-	 * initial Command Complete for NOP.
+	/* Allow sending the first HCI_Reset cmd, the only exception is if
+	 * the controller requests to wait for an initial Command Complete
+	 * for NOP.
 	 */
 #if !defined(CONFIG_BLUETOOTH_WAIT_NOP)
-	.ncmd_sem      = K_SEM_INITIALIZER(bt_dev.ncmd_sem, 1, 1),
-#else
-	.ncmd_sem      = K_SEM_INITIALIZER(bt_dev.ncmd_sem, 0, 1),
+	.ncmd          = 1,
 #endif
+	.ncmd_sem      = K_SEM_INITIALIZER(bt_dev.ncmd_sem, 0, 1),
 	.cmd_tx_queue  = K_FIFO_INITIALIZER(bt_dev.cmd_tx_queue),
 #if !defined(CONFIG_BLUETOOTH_RECV_IS_RX_THREAD)
 	.rx_queue      = K_FIFO_INITIALIZER(bt_dev.rx_queue),
@@ -91,12 +90,19 @@ struct cmd_data {
 	 *  for the return parameters.
 	 */
 	void *sync;
+
+	/** Used by bt_hci_cmd_send_cb, called on completion */
+	bt_hci_cmd_cb_t func;
+	void *user_data;
 };
 
 struct acl_data {
 	/** BT_BUF_ACL_IN */
 	uint8_t  type;
 
+	/** BT_RX_CLASS_* the buffer is accounted to */
+	uint8_t  rx_class;
+
 	/** ACL connection handle */
 	uint16_t handle;
 };
@@ -111,8 +117,50 @@ struct acl_data {
 NET_BUF_POOL_DEFINE(hci_cmd_pool, CONFIG_BLUETOOTH_HCI_CMD_COUNT,
 		    CMD_BUF_SIZE, sizeof(struct cmd_data), NULL);
 
+#if defined(CONFIG_BLUETOOTH_RX_QUOTA)
+static void rx_buf_destroy(struct net_buf *buf);
+
+NET_BUF_POOL_DEFINE(hci_rx_pool, CONFIG_BLUETOOTH_RX_BUF_COUNT,
+		    BT_BUF_RX_SIZE, BT_BUF_USER_DATA_MIN, rx_buf_destroy);
+
+/* RX buffers held by each class, and their limits (0 for none) */
+static atomic_t rx_held[BT_RX_CLASS_COUNT];
+
+static const uint8_t rx_quota[BT_RX_CLASS_COUNT] = {
+	[BT_RX_CLASS_ATT] = CONFIG_BLUETOOTH_RX_QUOTA_ATT,
+	[BT_RX_CLASS_SMP] = CONFIG_BLUETOOTH_RX_QUOTA_SMP,
+	[BT_RX_CLASS_L2CAP] = CONFIG_BLUETOOTH_RX_QUOTA_L2CAP,
+};
+
+static void rx_buf_destroy(struct net_buf *buf)
+{
+	if (acl(buf)->rx_class != BT_RX_CLASS_NONE) {
+		atomic_dec(&rx_held[acl(buf)->rx_class]);
+	}
+
+	net_buf_destroy(buf);
+}
+
+int bt_buf_rx_claim(struct net_buf *buf, uint8_t rx_class)
+{
+	if (acl(buf)->rx_class == rx_class) {
+		return 0;
+	}
+
+	if (rx_quota[rx_class] &&
+	    atomic_inc(&rx_held[rx_class]) >= rx_quota[rx_class]) {
+		atomic_dec(&rx_held[rx_class]);
+		return -ENOBUFS;
+	}
+
+	acl(buf)->rx_class = rx_class;
+
+	return 0;
+}
+#else
 NET_BUF_POOL_DEFINE(hci_rx_pool, CONFIG_BLUETOOTH_RX_BUF_COUNT,
 		    BT_BUF_RX_SIZE, BT_BUF_USER_DATA_MIN, NULL);
+#endif /* CONFIG_BLUETOOTH_RX_QUOTA */
 
 #if defined(CONFIG_BLUETOOTH_DEBUG)
 const char *bt_addr_str(const bt_addr_t *addr)
@@ -158,6 +206,7 @@ struct net_buf *bt_hci_cmd_create(uint16_t opcode, uint8_t param_len)
 	cmd(buf)->type = BT_BUF_CMD;
 	cmd(buf)->opcode = opcode;
 	cmd(buf)->sync = NULL;
+	cmd(buf)->func = NULL;
 
 	hdr = net_buf_add(buf, sizeof(*hdr));
 	hdr->opcode = sys_cpu_to_le16(opcode);
@@ -237,6 +286,26 @@ int bt_hci_cmd_send_sync(uint16_t opcode, struct net_buf *buf,
 	return err;
 }
 
+int bt_hci_cmd_send_cb(uint16_t opcode, struct net_buf *buf,
+		       bt_hci_cmd_cb_t func, void *user_data)
+{
+	if (!buf) {
+		buf = bt_hci_cmd_create(opcode, 0);
+		if (!buf) {
+			return -ENOBUFS;
+		}
+	}
+
+	BT_DBG("opcode 0x%04x len %u", opcode, buf->len);
+
+	cmd(buf)->func = func;
+	cmd(buf)->user_data = user_data;
+
+	net_buf_put(&bt_dev.cmd_tx_queue, buf);
+
+	return 0;
+}
+
 static int bt_hci_stop_scanning(void)
 {
 	struct net_buf *buf, *rsp;
@@ -292,6 +361,107 @@ static const bt_addr_le_t *find_id_addr(const bt_addr_le_t *addr)
 	return addr;
 }
 
+#if defined(CONFIG_BLUETOOTH_SMP)
+static int addr_res_enable(uint8_t enable)
+{
+	struct net_buf *buf;
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_LE_SET_ADDR_RES_ENABLE, 1);
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	net_buf_add_u8(buf, enable);
+
+	return bt_hci_cmd_send_sync(BT_HCI_OP_LE_SET_ADDR_RES_ENABLE,
+				    buf, NULL);
+}
+
+void bt_id_add(struct bt_keys *keys)
+{
+	struct bt_hci_cp_le_add_dev_to_rl *cp;
+	struct net_buf *buf;
+	int err;
+
+	BT_DBG("%s", bt_addr_le_str(&keys->addr));
+
+	/* Peers not fitting are still resolved by bt_keys_find_irk() */
+	if (bt_dev.le.rl_entries >= bt_dev.le.rl_size ||
+	    atomic_test_bit(keys->flags, BT_KEYS_ID_ADDED)) {
+		return;
+	}
+
+	/* The resolving list can only be changed with resolution off */
+	if (bt_dev.le.rl_entries && addr_res_enable(BT_HCI_ADDR_RES_DISABLE)) {
+		BT_WARN("Failed to disable address resolution");
+		return;
+	}
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_LE_ADD_DEV_TO_RL, sizeof(*cp));
+	if (!buf) {
+		goto done;
+	}
+
+	cp = net_buf_add(buf, sizeof(*cp));
+	bt_addr_le_copy(&cp->peer_id_addr, &keys->addr);
+	memcpy(cp->peer_irk, keys->irk.val, 16);
+	/* Our own RPAs are generated by the host */
+	memset(cp->local_irk, 0, 16);
+
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_ADD_DEV_TO_RL, buf, NULL);
+	if (err) {
+		BT_ERR("Failed to add IRK to controller");
+		goto done;
+	}
+
+	atomic_set_bit(keys->flags, BT_KEYS_ID_ADDED);
+	bt_dev.le.rl_entries++;
+
+done:
+	if (bt_dev.le.rl_entries) {
+		addr_res_enable(BT_HCI_ADDR_RES_ENABLE);
+	}
+}
+
+void bt_id_del(struct bt_keys *keys)
+{
+	struct bt_hci_cp_le_rem_dev_from_rl *cp;
+	struct net_buf *buf;
+	int err;
+
+	BT_DBG("%s", bt_addr_le_str(&keys->addr));
+
+	if (!atomic_test_and_clear_bit(keys->flags, BT_KEYS_ID_ADDED)) {
+		return;
+	}
+
+	bt_dev.le.rl_entries--;
+
+	if (addr_res_enable(BT_HCI_ADDR_RES_DISABLE)) {
+		BT_WARN("Failed to disable address resolution");
+		return;
+	}
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_LE_REM_DEV_FROM_RL, sizeof(*cp));
+	if (!buf) {
+		goto done;
+	}
+
+	cp = net_buf_add(buf, sizeof(*cp));
+	bt_addr_le_copy(&cp->peer_id_addr, &keys->addr);
+
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_REM_DEV_FROM_RL, buf, NULL);
+	if (err) {
+		BT_ERR("Failed to remove IRK from controller");
+	}
+
+done:
+	if (bt_dev.le.rl_entries) {
+		addr_res_enable(BT_HCI_ADDR_RES_ENABLE);
+	}
+}
+#endif /* CONFIG_BLUETOOTH_SMP */
+
 static int set_advertise_enable(bool enable)
 {
 	struct net_buf *buf;
@@ -418,23 +588,38 @@ static int le_set_private_addr(void)
 #endif
 
 #if defined(CONFIG_BLUETOOTH_CONN)
+static void acl_recv(struct net_buf *buf, uint16_t handle, uint8_t flags)
+{
+	struct bt_conn *conn;
+
+	acl(buf)->handle = handle;
+
+	conn = bt_conn_lookup_handle(handle);
+	if (!conn) {
+		BT_ERR("Unable to find conn for handle %u", handle);
+		net_buf_unref(buf);
+		return;
+	}
+
+	bt_conn_recv(conn, buf, flags);
+	bt_conn_unref(conn);
+}
+
 static void hci_acl(struct net_buf *buf)
 {
 	struct bt_hci_acl_hdr *hdr = (void *)buf->data;
 	uint16_t handle, len = sys_le16_to_cpu(hdr->len);
-	struct bt_conn *conn;
 	uint8_t flags;
 
 	BT_DBG("buf %p", buf);
 
 	handle = sys_le16_to_cpu(hdr->handle);
 	flags = bt_acl_flags(handle);
-
-	acl(buf)->handle = bt_acl_handle(handle);
+	handle = bt_acl_handle(handle);
 
 	net_buf_pull(buf, sizeof(*hdr));
 
-	BT_DBG("handle %u len %u flags %u", acl(buf)->handle, len, flags);
+	BT_DBG("handle %u len %u flags %u", handle, len, flags);
 
 	if (buf->len != len) {
 		BT_ERR("ACL data length mismatch (%u != %u)", buf->len, len);
@@ -442,15 +627,7 @@ static void hci_acl(struct net_buf *buf)
 		return;
 	}
 
-	conn = bt_conn_lookup_handle(acl(buf)->handle);
-	if (!conn) {
-		BT_ERR("Unable to find conn for handle %u", acl(buf)->handle);
-		net_buf_unref(buf);
-		return;
-	}
-
-	bt_conn_recv(conn, buf, flags);
-	bt_conn_unref(conn);
+	acl_recv(buf, handle, flags);
 }
 
 static void hci_num_completed_packets(struct net_buf *buf)
@@ -493,6 +670,7 @@ static void hci_num_completed_packets(struct net_buf *buf)
 			k_sem_give(bt_conn_get_pkts(conn));
 		}
 
+		bt_conn_tx_notify(conn);
 		bt_conn_unref(conn);
 	}
 }
@@ -607,6 +785,42 @@ static int hci_le_read_remote_features(struct bt_conn *conn)
 	return 0;
 }
 
+#if defined(CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE)
+static int hci_le_set_data_len(struct bt_conn *conn)
+{
+	struct bt_hci_cp_le_set_data_len *cp;
+	struct net_buf *buf;
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_LE_SET_DATA_LEN, sizeof(*cp));
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	cp = net_buf_add(buf, sizeof(*cp));
+	cp->handle = sys_cpu_to_le16(conn->handle);
+	cp->tx_octets = sys_cpu_to_le16(bt_dev.le.data_len_tx_octets);
+	cp->tx_time = sys_cpu_to_le16(bt_dev.le.data_len_tx_time);
+
+	return bt_hci_cmd_send(BT_HCI_OP_LE_SET_DATA_LEN, buf);
+}
+
+static void le_data_len_update(struct bt_conn *conn)
+{
+	int err;
+
+	/* Both sides need the Data Length Extension */
+	if (bt_dev.le.data_len_tx_octets <= BT_GAP_DATA_LEN_DEFAULT ||
+	    !BT_FEAT_LE_DLE(conn->le.features)) {
+		return;
+	}
+
+	err = hci_le_set_data_len(conn);
+	if (err) {
+		BT_WARN("Unable to update data length (err %d)", err);
+	}
+}
+#endif /* CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE */
+
 static void update_conn_param(struct bt_conn *conn)
 {
 	/*
@@ -619,11 +833,12 @@ static void update_conn_param(struct bt_conn *conn)
 				 CONN_UPDATE_TIMEOUT);
 }
 
-static void le_conn_complete(struct net_buf *buf)
+static void enh_conn_complete(struct bt_hci_evt_le_enh_conn_complete *evt)
 {
-	struct bt_hci_evt_le_conn_complete *evt = (void *)buf->data;
 	uint16_t handle = sys_le16_to_cpu(evt->handle);
 	const bt_addr_le_t *id_addr;
+	bt_addr_le_t peer_addr;
+	bt_addr_le_t id;
 	struct bt_conn *conn;
 	int err;
 
@@ -656,7 +871,19 @@ static void le_conn_complete(struct net_buf *buf)
 		return;
 	}
 
-	id_addr = find_id_addr(&evt->peer_addr);
+	if (evt->peer_addr.type == BT_ADDR_LE_PUBLIC_ID ||
+	    evt->peer_addr.type == BT_ADDR_LE_RANDOM_ID) {
+		/* Resolved by the controller, peer_rpa is the address used */
+		bt_addr_le_copy(&id, &evt->peer_addr);
+		id.type -= BT_ADDR_LE_PUBLIC_ID;
+		id_addr = &id;
+
+		peer_addr.type = BT_ADDR_LE_RANDOM;
+		bt_addr_copy(&peer_addr.a, &evt->peer_rpa);
+	} else {
+		id_addr = find_id_addr(&evt->peer_addr);
+		bt_addr_le_copy(&peer_addr, &evt->peer_addr);
+	}
 
 	/*
 	 * Make lookup to check if there's a connection object in
@@ -695,7 +922,7 @@ static void le_conn_complete(struct net_buf *buf)
 	 * was set during outgoing connection creation.
 	 */
 	if (conn->role == BT_HCI_ROLE_SLAVE) {
-		bt_addr_le_copy(&conn->le.init_addr, &evt->peer_addr);
+		bt_addr_le_copy(&conn->le.init_addr, &peer_addr);
 
 		/* TODO Handle the probability that random address could have
 		 * been updated by rpa_timeout or numerous other places it is
@@ -723,6 +950,11 @@ static void le_conn_complete(struct net_buf *buf)
 			set_advertise_enable(true);
 		}
 
+	} else {
+		/* The identity given to the controller is not what SMP needs
+		 * when the peer's RPA was resolved by the controller.
+		 */
+		bt_addr_le_copy(&conn->le.resp_addr, &peer_addr);
 	}
 
 	bt_conn_set_state(conn, BT_CONN_CONNECTED);
@@ -751,6 +983,30 @@ done:
 	bt_le_scan_update(false);
 }
 
+static void le_enh_conn_complete(struct net_buf *buf)
+{
+	enh_conn_complete((void *)buf->data);
+}
+
+static void le_conn_complete(struct net_buf *buf)
+{
+	struct bt_hci_evt_le_conn_complete *evt = (void *)buf->data;
+	struct bt_hci_evt_le_enh_conn_complete enh;
+
+	enh.status = evt->status;
+	enh.handle = evt->handle;
+	enh.role = evt->role;
+	bt_addr_le_copy(&enh.peer_addr, &evt->peer_addr);
+	memset(&enh.local_rpa, 0, sizeof(enh.local_rpa));
+	memset(&enh.peer_rpa, 0, sizeof(enh.peer_rpa));
+	enh.interval = evt->interval;
+	enh.latency = evt->latency;
+	enh.supv_timeout = evt->supv_timeout;
+	enh.clock_accuracy = evt->clock_accuracy;
+
+	enh_conn_complete(&enh);
+}
+
 static void le_remote_feat_complete(struct net_buf *buf)
 {
 	struct bt_hci_ev_le_remote_feat_complete *evt = (void *)buf->data;
@@ -766,6 +1022,9 @@ static void le_remote_feat_complete(struct net_buf *buf)
 	if (!evt->status) {
 		memcpy(conn->le.features, evt->features,
 		       sizeof(conn->le.features));
+#if defined(CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE)
+		le_data_len_update(conn);
+#endif /* CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE */
 	}
 
 	update_conn_param(conn);
@@ -2219,41 +2478,97 @@ static void hci_reset_complete(struct net_buf *buf)
 	atomic_set(bt_dev.flags, BIT(BT_DEV_ENABLE));
 }
 
+/* Called with interrupts locked */
+static struct net_buf *sent_cmd_remove(uint8_t i)
+{
+	struct net_buf *sent = bt_dev.sent_cmd[i];
+
+	bt_dev.sent_cmd_count--;
+	memmove(&bt_dev.sent_cmd[i], &bt_dev.sent_cmd[i + 1],
+		(bt_dev.sent_cmd_count - i) * sizeof(bt_dev.sent_cmd[0]));
+	bt_dev.sent_cmd[bt_dev.sent_cmd_count] = NULL;
+
+	return sent;
+}
+
+static void sent_cmd_done(struct net_buf *sent, uint8_t status,
+			  struct net_buf *buf)
+{
+	/* If the command was synchronous wake up bt_hci_cmd_send_sync() */
+	if (cmd(sent)->sync) {
+		struct k_sem *sem = cmd(sent)->sync;
+
+		if (status) {
+			cmd(sent)->sync = NULL;
+		} else {
+			cmd(sent)->sync = net_buf_ref(buf);
+		}
+
+		k_sem_give(sem);
+		return;
+	}
+
+	if (cmd(sent)->func) {
+		cmd(sent)->func(cmd(sent)->opcode, status, status ? NULL : buf,
+				cmd(sent)->user_data);
+	}
+
+	net_buf_unref(sent);
+}
+
 static void hci_cmd_done(uint16_t opcode, uint8_t status, struct net_buf *buf)
 {
 	struct net_buf *sent;
 	int key = irq_lock();
+	uint8_t i;
 
-	sent = bt_dev.sent_cmd;
-	if (!sent) {
+	if (!bt_dev.sent_cmd_count) {
 		irq_unlock(key);
 		return;
 	}
 
-	if (cmd(sent)->opcode != opcode) {
+	/* The oldest command with this opcode is the one completed */
+	for (i = 0; i < bt_dev.sent_cmd_count; i++) {
+		if (cmd(bt_dev.sent_cmd[i])->opcode == opcode) {
+			break;
+		}
+	}
+
+	if (i == bt_dev.sent_cmd_count) {
 		BT_ERR("Unexpected completion of opcode 0x%04x expected 0x%04x",
-		       opcode, cmd(sent)->opcode);
+		       opcode, cmd(bt_dev.sent_cmd[0])->opcode);
 		irq_unlock(key);
 		return;
 	}
 
-	bt_dev.sent_cmd = NULL;
+	sent = sent_cmd_remove(i);
 
 	irq_unlock(key);
 
-	/* If the command was synchronous wake up bt_hci_cmd_send_sync() */
-	if (cmd(sent)->sync) {
-		struct k_sem *sem = cmd(sent)->sync;
+	sent_cmd_done(sent, status, buf);
+}
 
-		if (status) {
-			cmd(sent)->sync = NULL;
-		} else {
-			cmd(sent)->sync = net_buf_ref(buf);
-		}
+/* Num_HCI_Command_Packets counts what the controller can accept at the
+ * time of the event, which may or may not include the commands still in
+ * flight: these are deducted so that the controller is never overrun.
+ */
+static void hci_cmd_credits_update(uint8_t ncmd)
+{
+	int key = irq_lock();
 
-		k_sem_give(sem);
+	ncmd = min(ncmd, CONFIG_BLUETOOTH_HCI_CMD_PENDING);
+
+	if (ncmd > bt_dev.sent_cmd_count) {
+		bt_dev.ncmd = ncmd - bt_dev.sent_cmd_count;
 	} else {
-		net_buf_unref(sent);
+		bt_dev.ncmd = 0;
+	}
+
+	irq_unlock(key);
+
+	/* Allow next command to be sent */
+	if (bt_dev.ncmd) {
+		k_sem_give(&bt_dev.ncmd_sem);
 	}
 }
 
@@ -2274,10 +2589,7 @@ static void hci_cmd_complete(struct net_buf *buf)
 
 	hci_cmd_done(opcode, status, buf);
 
-	/* Allow next command to be sent */
-	if (evt->ncmd) {
-		k_sem_give(&bt_dev.ncmd_sem);
-	}
+	hci_cmd_credits_update(evt->ncmd);
 }
 
 static void hci_cmd_status(struct net_buf *buf)
@@ -2291,10 +2603,7 @@ static void hci_cmd_status(struct net_buf *buf)
 
 	hci_cmd_done(opcode, evt->status, buf);
 
-	/* Allow next command to be sent */
-	if (evt->ncmd) {
-		k_sem_give(&bt_dev.ncmd_sem);
-	}
+	hci_cmd_credits_update(evt->ncmd);
 }
 
 #if !defined(CONFIG_BLUETOOTH_CONTROLLER)
@@ -2515,6 +2824,7 @@ static void le_adv_report(struct net_buf *buf)
 
 	while (num_reports--) {
 		const bt_addr_le_t *addr;
+		bt_addr_le_t id_addr;
 		int8_t rssi;
 
 		info = (void *)buf->data;
@@ -2526,7 +2836,15 @@ static void le_adv_report(struct net_buf *buf)
 		       bt_addr_le_str(&info->addr),
 		       info->evt_type, info->length, rssi);
 
-		addr = find_id_addr(&info->addr);
+		if (info->addr.type == BT_ADDR_LE_PUBLIC_ID ||
+		    info->addr.type == BT_ADDR_LE_RANDOM_ID) {
+			/* Resolved by the controller */
+			bt_addr_le_copy(&id_addr, &info->addr);
+			id_addr.type -= BT_ADDR_LE_PUBLIC_ID;
+			addr = &id_addr;
+		} else {
+			addr = find_id_addr(&info->addr);
+		}
 
 		if (scan_dev_found_cb) {
 			struct net_buf_simple_state state;
@@ -2561,6 +2879,9 @@ static void hci_le_meta_event(struct net_buf *buf)
 	case BT_HCI_EVT_LE_CONN_COMPLETE:
 		le_conn_complete(buf);
 		break;
+	case BT_HCI_EVT_LE_ENH_CONN_COMPLETE:
+		le_enh_conn_complete(buf);
+		break;
 	case BT_HCI_EVT_LE_CONN_UPDATE_COMPLETE:
 		le_conn_update_complete(buf);
 		break;
@@ -2693,25 +3014,31 @@ static void hci_cmd_tx_thread(void)
 	BT_DBG("started");
 
 	while (1) {
-		struct net_buf *buf;
-		int err;
-
-		/* Wait until ncmd > 0 */
-		BT_DBG("calling sem_take_wait");
-		k_sem_take(&bt_dev.ncmd_sem, K_FOREVER);
+		struct net_buf *buf, *sent;
+		int err, key;
 
 		/* Get next command - wait if necessary */
 		BT_DBG("calling net_buf_get");
 		buf = net_buf_get(&bt_dev.cmd_tx_queue, K_FOREVER);
 
-		/* Clear out any existing sent command */
-		if (bt_dev.sent_cmd) {
-			BT_ERR("Uncleared pending sent_cmd");
-			net_buf_unref(bt_dev.sent_cmd);
-			bt_dev.sent_cmd = NULL;
+		/* Wait until ncmd > 0 */
+		while (1) {
+			key = irq_lock();
+
+			if (bt_dev.ncmd) {
+				break;
+			}
+
+			irq_unlock(key);
+
+			BT_DBG("calling sem_take_wait");
+			k_sem_take(&bt_dev.ncmd_sem, K_FOREVER);
 		}
 
-		bt_dev.sent_cmd = net_buf_ref(buf);
+		bt_dev.ncmd--;
+		bt_dev.sent_cmd[bt_dev.sent_cmd_count++] = net_buf_ref(buf);
+
+		irq_unlock(key);
 
 		BT_DBG("Sending command 0x%04x (buf %p) to driver",
 		       cmd(buf)->opcode, buf);
@@ -2719,9 +3046,17 @@ static void hci_cmd_tx_thread(void)
 		err = bt_send(buf);
 		if (err) {
 			BT_ERR("Unable to send to driver (err %d)", err);
+
+			/* Completions only remove entries, so the command
+			 * is still the last one sent.
+			 */
+			key = irq_lock();
+			sent = sent_cmd_remove(bt_dev.sent_cmd_count - 1);
+			bt_dev.ncmd++;
+			irq_unlock(key);
+
 			k_sem_give(&bt_dev.ncmd_sem);
-			hci_cmd_done(cmd(buf)->opcode, BT_HCI_ERR_UNSPECIFIED,
-				     NULL);
+			sent_cmd_done(sent, BT_HCI_ERR_UNSPECIFIED, NULL);
 			net_buf_unref(buf);
 		}
 	}
@@ -2811,6 +3146,28 @@ static void le_read_buffer_size_complete(struct net_buf *buf)
 	}
 }
 
+#if defined(CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE)
+static void le_read_max_data_len_complete(struct net_buf *buf)
+{
+	struct bt_hci_rp_le_read_max_data_len *rp = (void *)buf->data;
+	uint16_t octets, time;
+
+	BT_DBG("status %u", rp->status);
+
+	/* PDUs longer than an ACL buffer would never be filled */
+	octets = min(sys_le16_to_cpu(rp->max_tx_octets), bt_dev.le.mtu);
+	octets = max(octets, BT_GAP_DATA_LEN_DEFAULT);
+
+	/* 14 octets of overhead at 8 us each on the 1M PHY */
+	time = min(sys_le16_to_cpu(rp->max_tx_time), (octets + 14) * 8);
+
+	bt_dev.le.data_len_tx_octets = octets;
+	bt_dev.le.data_len_tx_time = time;
+
+	BT_DBG("data length tx octets %u time %u", octets, time);
+}
+#endif /* CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE */
+
 static void read_supported_commands_complete(struct net_buf *buf)
 {
 	struct bt_hci_rp_read_supported_commands *rp = (void *)buf->data;
@@ -2848,8 +3205,83 @@ static void le_read_supp_states_complete(struct net_buf *buf)
 	bt_dev.le.states = sys_get_le64(rp->le_states);
 }
 
+struct hci_init_cmd {
+	uint16_t opcode;
+	void (*complete)(struct net_buf *rsp);
+};
+
+struct hci_init_batch {
+	const struct hci_init_cmd *cmds;
+	uint8_t count;
+	struct k_sem done;
+	int err;
+};
+
+static void hci_init_cmd_done(uint16_t opcode, uint8_t status,
+			      struct net_buf *rsp, void *user_data)
+{
+	struct hci_init_batch *batch = user_data;
+	uint8_t i;
+
+	if (status) {
+		batch->err = -EIO;
+	} else {
+		for (i = 0; i < batch->count; i++) {
+			if (batch->cmds[i].opcode == opcode) {
+				batch->cmds[i].complete(rsp);
+				break;
+			}
+		}
+	}
+
+	k_sem_give(&batch->done);
+}
+
+/* Issue independent commands back to back, sparing a round trip to the
+ * controller per command, and wait for all of them.
+ */
+static int hci_init_cmds(const struct hci_init_cmd *cmds, uint8_t count)
+{
+	struct hci_init_batch batch;
+	uint8_t i;
+	int err;
+
+	batch.cmds = cmds;
+	batch.count = count;
+	batch.err = 0;
+	k_sem_init(&batch.done, 0, count);
+
+	for (i = 0; i < count; i++) {
+		err = bt_hci_cmd_send_cb(cmds[i].opcode, NULL,
+					 hci_init_cmd_done, &batch);
+		if (err) {
+			batch.err = err;
+			break;
+		}
+	}
+
+	/* Only the commands sent complete */
+	count = i;
+
+	for (i = 0; i < count; i++) {
+		k_sem_take(&batch.done, K_FOREVER);
+	}
+
+	return batch.err;
+}
+
 static int common_init(void)
 {
+	static const struct hci_init_cmd cmds[] = {
+		{ BT_HCI_OP_READ_LOCAL_FEATURES,
+		  read_local_features_complete },
+		{ BT_HCI_OP_READ_LOCAL_VERSION_INFO,
+		  read_local_ver_complete },
+		{ BT_HCI_OP_READ_BD_ADDR,
+		  read_bdaddr_complete },
+		{ BT_HCI_OP_READ_SUPPORTED_COMMANDS,
+		  read_supported_commands_complete },
+	};
 	struct net_buf *rsp;
 	int err;
 
@@ -2872,49 +3304,26 @@ static int common_init(void)
 	}
 #endif
 
-	/* Read Local Supported Features */
-	err = bt_hci_cmd_send_sync(BT_HCI_OP_READ_LOCAL_FEATURES, NULL, &rsp);
-	if (err) {
-		return err;
-	}
-	read_local_features_complete(rsp);
-	net_buf_unref(rsp);
-
-	/* Read Local Version Information */
-	err = bt_hci_cmd_send_sync(BT_HCI_OP_READ_LOCAL_VERSION_INFO, NULL,
-				   &rsp);
-	if (err) {
-		return err;
-	}
-	read_local_ver_complete(rsp);
-	net_buf_unref(rsp);
-
-	/* Read Bluetooth Address */
-	err = bt_hci_cmd_send_sync(BT_HCI_OP_READ_BD_ADDR, NULL, &rsp);
-	if (err) {
-		return err;
-	}
-	read_bdaddr_complete(rsp);
-	net_buf_unref(rsp);
-
-	/* Read Local Supported Commands */
-	err = bt_hci_cmd_send_sync(BT_HCI_OP_READ_SUPPORTED_COMMANDS, NULL,
-				   &rsp);
-	if (err) {
-		return err;
-	}
-	read_supported_commands_complete(rsp);
-	net_buf_unref(rsp);
-
-	return 0;
+	/* Read Local Supported Features, Local Version Information,
+	 * Bluetooth Address and Local Supported Commands
+	 */
+	return hci_init_cmds(cmds, ARRAY_SIZE(cmds));
 }
 
 static int le_init(void)
 {
+	static const struct hci_init_cmd cmds[] = {
+		{ BT_HCI_OP_LE_READ_LOCAL_FEATURES,
+		  read_le_features_complete },
+		{ BT_HCI_OP_LE_READ_BUFFER_SIZE,
+		  le_read_buffer_size_complete },
+		/* Last, being only sent if supported */
+		{ BT_HCI_OP_LE_READ_SUPP_STATES,
+		  le_read_supp_states_complete },
+	};
 	struct bt_hci_cp_write_le_host_supp *cp_le;
 	struct bt_hci_cp_le_set_event_mask *cp_mask;
 	struct net_buf *buf;
-	struct net_buf *rsp;
 	int err;
 
 	/* For now we only support LE capable controllers */
@@ -2923,22 +3332,48 @@ static int le_init(void)
 		return -ENODEV;
 	}
 
-	/* Read Low Energy Supported Features */
-	err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_READ_LOCAL_FEATURES, NULL,
-				   &rsp);
+	/* Read Low Energy Supported Features, LE Buffer Size and LE
+	 * Supported States
+	 */
+	err = hci_init_cmds(cmds, BT_CMD_LE_STATES(bt_dev.supported_commands) ?
+			    ARRAY_SIZE(cmds) : ARRAY_SIZE(cmds) - 1);
 	if (err) {
 		return err;
 	}
-	read_le_features_complete(rsp);
-	net_buf_unref(rsp);
 
-	/* Read LE Buffer Size */
-	err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_READ_BUFFER_SIZE, NULL, &rsp);
-	if (err) {
-		return err;
+#if defined(CONFIG_BLUETOOTH_SMP)
+	/* IRKs of bonded peers are then handed to the controller */
+	if (BT_FEAT_LE_PRIVACY(bt_dev.le.features)) {
+		struct bt_hci_rp_le_read_rl_size *rp;
+		struct net_buf *rsp;
+
+		err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_READ_RL_SIZE, NULL,
+					   &rsp);
+		if (err) {
+			return err;
+		}
+
+		rp = (void *)rsp->data;
+		bt_dev.le.rl_size = rp->rl_size;
+		net_buf_unref(rsp);
+
+		BT_DBG("Resolving list size %u", bt_dev.le.rl_size);
 	}
-	le_read_buffer_size_complete(rsp);
-	net_buf_unref(rsp);
+#endif /* CONFIG_BLUETOOTH_SMP */
+
+#if defined(CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE)
+	if (BT_FEAT_LE_DLE(bt_dev.le.features) && bt_dev.le.mtu) {
+		struct net_buf *rsp;
+
+		err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_READ_MAX_DATA_LEN, NULL,
+					   &rsp);
+		if (err) {
+			return err;
+		}
+		le_read_max_data_len_complete(rsp);
+		net_buf_unref(rsp);
+	}
+#endif /* CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE */
 
 	if (BT_FEAT_BREDR(bt_dev.features)) {
 		buf = bt_hci_cmd_create(BT_HCI_OP_LE_WRITE_LE_HOST_SUPP,
@@ -2959,17 +3394,6 @@ static int le_init(void)
 		}
 	}
 
-	/* Read LE Supported States */
-	if (BT_CMD_LE_STATES(bt_dev.supported_commands)) {
-		err = bt_hci_cmd_send_sync(BT_HCI_OP_LE_READ_SUPP_STATES, NULL,
-					   &rsp);
-		if (err) {
-			return err;
-		}
-		le_read_supp_states_complete(rsp);
-		net_buf_unref(rsp);
-	}
-
 	/* Set LE event mask */
 	buf = bt_hci_cmd_create(BT_HCI_OP_LE_SET_EVENT_MASK, sizeof(*cp_mask));
 	if (!buf) {
@@ -2988,6 +3412,11 @@ static int le_init(void)
 		cp_mask->events[0] |= 0x04;
 		/* LE Read Remote Used Features Compl Evt */
 		cp_mask->events[0] |= 0x08;
+
+		if (BT_FEAT_LE_PRIVACY(bt_dev.le.features)) {
+			/* LE Enhanced Connection Complete Event */
+			cp_mask->events[1] |= 0x02;
+		}
 	}
 
 	if (IS_ENABLED(CONFIG_BLUETOOTH_SMP)) {
@@ -3443,6 +3872,16 @@ int bt_recv(struct net_buf *buf)
 	}
 }
 
+#if defined(CONFIG_BLUETOOTH_CONTROLLER_RX_DIRECT)
+void bt_recv_acl(struct net_buf *buf, uint16_t handle, uint8_t flags)
+{
+	BT_DBG("buf %p handle %u flags %u len %u", buf, handle, flags,
+	       buf->len);
+
+	acl_recv(buf, handle, flags);
+}
+#endif /* CONFIG_BLUETOOTH_CONTROLLER_RX_DIRECT */
+
 int bt_recv_prio(struct net_buf *buf)
 {
 	struct bt_hci_evt_hdr *hdr = (void *)buf->data;
@@ -3836,6 +4275,104 @@ int bt_le_adv_start(const struct bt_le_adv_param *param,
 	return 0;
 }
 
+static int adv_set_enable(uint8_t set, bool enable)
+{
+	struct bt_hci_cp_vs_set_adv_set_enable *cp;
+	struct net_buf *buf;
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_VS_SET_ADV_SET_ENABLE, sizeof(*cp));
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	cp = net_buf_add(buf, sizeof(*cp));
+	cp->set = set;
+	cp->enable = enable ? BT_HCI_LE_ADV_ENABLE : BT_HCI_LE_ADV_DISABLE;
+
+	return bt_hci_cmd_send_sync(BT_HCI_OP_VS_SET_ADV_SET_ENABLE, buf, NULL);
+}
+
+int bt_le_adv_set_start(uint8_t set, const struct bt_le_adv_param *param,
+			const struct bt_data *ad, size_t ad_len)
+{
+	struct bt_hci_cp_vs_set_adv_set_param *set_param;
+	struct bt_hci_cp_vs_set_adv_set_data *set_data;
+	struct net_buf *buf;
+	int err, i;
+
+	if (!valid_adv_param(param) ||
+	    (param->options & BT_LE_ADV_OPT_CONNECTABLE) || param->own_addr) {
+		return -EINVAL;
+	}
+
+	/* The controller has a single random address, the identity one is
+	 * restored as for connectable advertising.
+	 */
+	if (atomic_test_bit(bt_dev.flags, BT_DEV_ID_STATIC_RANDOM)) {
+		err = set_random_address(&bt_dev.id_addr.a);
+		if (err) {
+			return err;
+		}
+	}
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_VS_SET_ADV_SET_PARAM,
+				sizeof(*set_param));
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	set_param = net_buf_add(buf, sizeof(*set_param));
+	set_param->set = set;
+	set_param->interval = sys_cpu_to_le16(param->interval_min);
+	set_param->own_addr_type = bt_dev.id_addr.type;
+	set_param->channel_map = 0x07;
+
+	/* The parameters give the address the data is then set with */
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_VS_SET_ADV_SET_PARAM, buf, NULL);
+	if (err) {
+		return err;
+	}
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_VS_SET_ADV_SET_DATA,
+				sizeof(*set_data));
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	set_data = net_buf_add(buf, sizeof(*set_data));
+
+	memset(set_data, 0, sizeof(*set_data));
+	set_data->set = set;
+
+	for (i = 0; i < ad_len; i++) {
+		/* Check if ad fit in the remaining buffer */
+		if (set_data->len + ad[i].data_len + 2 >
+		    sizeof(set_data->data)) {
+			net_buf_unref(buf);
+			return -EINVAL;
+		}
+
+		set_data->data[set_data->len++] = ad[i].data_len + 1;
+		set_data->data[set_data->len++] = ad[i].type;
+
+		memcpy(&set_data->data[set_data->len], ad[i].data,
+		       ad[i].data_len);
+		set_data->len += ad[i].data_len;
+	}
+
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_VS_SET_ADV_SET_DATA, buf, NULL);
+	if (err) {
+		return err;
+	}
+
+	return adv_set_enable(set, true);
+}
+
+int bt_le_adv_set_stop(uint8_t set)
+{
+	return adv_set_enable(set, false);
+}
+
 int bt_le_adv_stop(void)
 {
 	int err;
@@ -3949,6 +4486,7 @@ struct net_buf *bt_buf_get_rx(int32_t timeout)
 	buf = net_buf_alloc(&hci_rx_pool, timeout);
 	if (buf) {
 		net_buf_reserve(buf, CONFIG_BLUETOOTH_HCI_RECV_RESERVE);
+		acl(buf)->rx_class = BT_RX_CLASS_NONE;
 	}
 
 	return buf;
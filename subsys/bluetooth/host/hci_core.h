@@ -51,6 +51,18 @@ struct bt_dev_le {
 	/* Controller buffer information */
 	uint16_t		mtu;
 	struct k_sem		pkts;
+
+#if defined(CONFIG_BLUETOOTH_SMP)
+	/* Controller resolving list size and IRKs added to it */
+	uint8_t			rl_size;
+	uint8_t			rl_entries;
+#endif /* CONFIG_BLUETOOTH_SMP */
+
+#if defined(CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE)
+	/* Link layer PDU payload length and time to ask connections for */
+	uint16_t		data_len_tx_octets;
+	uint16_t		data_len_tx_time;
+#endif /* CONFIG_BLUETOOTH_AUTO_DATA_LEN_UPDATE */
 };
 
 #if defined(CONFIG_BLUETOOTH_BREDR)
@@ -94,11 +106,15 @@ struct bt_dev {
 	struct bt_dev_br	br;
 #endif
 
-	/* Number of commands controller can accept */
+	/* Given when the controller can accept commands again */
 	struct k_sem		ncmd_sem;
 
-	/* Last sent HCI command */
-	struct net_buf		*sent_cmd;
+	/* Number of commands controller can accept */
+	uint8_t			ncmd;
+
+	/* Sent HCI commands waiting for their completion, oldest first */
+	struct net_buf		*sent_cmd[CONFIG_BLUETOOTH_HCI_CMD_PENDING];
+	uint8_t			sent_cmd_count;
 
 #if !defined(CONFIG_BLUETOOTH_RECV_IS_RX_THREAD)
 	/* Queue for incoming HCI events & ACL data */
@@ -139,6 +155,19 @@ int bt_hci_cmd_send(uint16_t opcode, struct net_buf *buf);
 int bt_hci_cmd_send_sync(uint16_t opcode, struct net_buf *buf,
 			 struct net_buf **rsp);
 
+/* Called from the RX thread once the command completed, with the return
+ * parameters on success, so it must not block. rsp is only valid during
+ * the call.
+ */
+typedef void (*bt_hci_cmd_cb_t)(uint16_t opcode, uint8_t status,
+				struct net_buf *rsp, void *user_data);
+
+/* Queue a command without waiting for its completion, several commands
+ * being in flight as long as the controller has room for them.
+ */
+int bt_hci_cmd_send_cb(uint16_t opcode, struct net_buf *buf,
+		       bt_hci_cmd_cb_t func, void *user_data);
+
 /* The helper is only safe to be called from internal threads as it's
  * not multi-threading safe
  */
@@ -149,6 +178,38 @@ int bt_le_scan_update(bool fast_scan);
 
 bool bt_addr_le_is_bonded(const bt_addr_le_t *addr);
 
+#if defined(CONFIG_BLUETOOTH_SMP)
+struct bt_keys;
+
+/* Add or remove the IRK of a bonded peer from the controller resolving
+ * list, if it has one.
+ */
+void bt_id_add(struct bt_keys *keys);
+void bt_id_del(struct bt_keys *keys);
+#endif /* CONFIG_BLUETOOTH_SMP */
+
 int bt_send(struct net_buf *buf);
 
+/* Channels whose PDUs may be limited in the number of RX buffers held */
+enum {
+	BT_RX_CLASS_NONE,
+	BT_RX_CLASS_ATT,
+	BT_RX_CLASS_SMP,
+	BT_RX_CLASS_L2CAP,
+
+	BT_RX_CLASS_COUNT,
+};
+
+#if defined(CONFIG_BLUETOOTH_RX_QUOTA)
+/* Account an RX buffer to a class, failing if its quota is reached. The
+ * buffer is released from the class once freed.
+ */
+int bt_buf_rx_claim(struct net_buf *buf, uint8_t rx_class);
+#else
+static inline int bt_buf_rx_claim(struct net_buf *buf, uint8_t rx_class)
+{
+	return 0;
+}
+#endif /* CONFIG_BLUETOOTH_RX_QUOTA */
+
 uint16_t bt_hci_get_cmd_opcode(struct net_buf *buf);
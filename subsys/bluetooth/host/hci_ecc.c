@@ -10,6 +10,7 @@
  */
 
 #include <zephyr.h>
+#include <errno.h>
 #include <atomic.h>
 #include <misc/stack.h>
 #include <misc/byteorder.h>
@@ -56,6 +57,93 @@ static K_FIFO_DEFINE(ecc_queue);
 static int (*drv_send)(struct net_buf *buf);
 static uint32_t private_key[8];
 
+#if defined(CONFIG_BLUETOOTH_ECC_KEY_CACHE)
+/* Key pair generated while idle, for the next public key command */
+static struct {
+	uint8_t public_key[64];
+	uint32_t private_key[8];
+	bool valid;
+	/* cleared on failure, not to retry until the cache is used */
+	bool fill;
+} key_cache = {
+	.fill = true,
+};
+#endif /* CONFIG_BLUETOOTH_ECC_KEY_CACHE */
+
+static int tc_key_gen(uint8_t public_key[64], uint8_t private_key[32])
+{
+	uint32_t random[8];
+	uint32_t key[8];
+	EccPoint pkey;
+
+	if (bt_rand((uint8_t *)random, sizeof(random))) {
+		BT_ERR("Failed to get random bytes for ECC keys");
+		return -EIO;
+	}
+
+	if (ecc_make_key(&pkey, key, random) == TC_CRYPTO_FAIL) {
+		BT_ERR("Failed to create ECC public/private pair");
+		return -EIO;
+	}
+
+	memcpy(public_key, pkey.x, 32);
+	memcpy(&public_key[32], pkey.y, 32);
+	memcpy(private_key, key, 32);
+
+	return 0;
+}
+
+static int tc_dh_key(const uint8_t public_key[64],
+		     const uint8_t private_key[32], uint8_t dhkey[32])
+{
+	/* The following large stack variables are never needed at the same
+	 * time, so we save some stack space by putting them in a union.
+	 */
+	union {
+		EccPoint pk;
+		uint32_t dhkey[8];
+	} ecc;
+	uint32_t key[8];
+
+	memcpy(ecc.pk.x, public_key, 32);
+	memcpy(ecc.pk.y, &public_key[32], 32);
+
+	if (ecc_valid_public_key(&ecc.pk) < 0) {
+		return -EINVAL;
+	}
+
+	memcpy(key, private_key, 32);
+
+	if (ecdh_shared_secret(ecc.dhkey, &ecc.pk, key) == TC_CRYPTO_FAIL) {
+		return -EIO;
+	}
+
+	memcpy(dhkey, ecc.dhkey, 32);
+
+	return 0;
+}
+
+static const struct bt_hci_ecc_driver tc_ecc = {
+	.name		= "tinycrypt",
+	.key_gen	= tc_key_gen,
+	.dh_key		= tc_dh_key,
+};
+
+static const struct bt_hci_ecc_driver *ecc_drv = &tc_ecc;
+
+int bt_hci_ecc_driver_register(const struct bt_hci_ecc_driver *drv)
+{
+	if (!drv->key_gen || !drv->dh_key) {
+		return -EINVAL;
+	}
+
+	BT_DBG("Using %s for ECC", drv->name);
+
+	ecc_drv = drv;
+
+	return 0;
+}
+
 static void send_cmd_status(uint16_t opcode, uint8_t status)
 {
 	struct bt_hci_evt_cmd_status *evt;
@@ -79,40 +167,62 @@ static void send_cmd_status(uint16_t opcode, uint8_t status)
 	bt_recv_prio(buf);
 }
 
-static uint8_t generate_keys(EccPoint *pkey, uint32_t private_key[8])
+static uint8_t generate_keys(uint8_t public_key[64], uint32_t private_key[8])
 {
 #if !defined(CONFIG_BLUETOOTH_USE_DEBUG_KEYS)
 	do {
-		uint32_t random[8];
-		int rc;
-
-		if (bt_rand((uint8_t *)random, sizeof(random))) {
-			BT_ERR("Failed to get random bytes for ECC keys");
-			return BT_HCI_ERR_UNSPECIFIED;
-		}
-
-		rc = ecc_make_key(pkey, private_key, random);
-		if (rc == TC_CRYPTO_FAIL) {
-			BT_ERR("Failed to create ECC public/private pair");
+		if (ecc_drv->key_gen(public_key, (uint8_t *)private_key)) {
 			return BT_HCI_ERR_UNSPECIFIED;
 		}
 
 	/* make sure generated key isn't debug key */
 	} while (memcmp(private_key, debug_private_key, 32) == 0);
 #else
-	memcpy(pkey, debug_public_key, 64);
+	memcpy(public_key, debug_public_key, 64);
 	memcpy(private_key, debug_private_key, 32);
 #endif
 	return 0;
 }
 
+#if defined(CONFIG_BLUETOOTH_ECC_KEY_CACHE)
+static void key_cache_fill(void)
+{
+	BT_DBG("");
+
+	key_cache.valid = !generate_keys(key_cache.public_key,
+					 key_cache.private_key);
+	key_cache.fill = false;
+}
+
+static uint8_t key_cache_get(uint8_t public_key[64], uint32_t private_key[8])
+{
+	key_cache.fill = true;
+
+	if (!key_cache.valid) {
+		return generate_keys(public_key, private_key);
+	}
+
+	memcpy(public_key, key_cache.public_key, 64);
+	memcpy(private_key, key_cache.private_key, 32);
+
+	/* a key pair is handed out only once */
+	memset(key_cache.private_key, 0, sizeof(key_cache.private_key));
+	key_cache.valid = false;
+
+	return 0;
+}
+#else
+#define key_cache_get(public_key, private_key) \
+	generate_keys(public_key, private_key)
+#endif /* CONFIG_BLUETOOTH_ECC_KEY_CACHE */
+
 static void emulate_le_p256_public_key_cmd(struct net_buf *buf)
 {
 	struct bt_hci_evt_le_p256_public_key_complete *evt;
 	struct bt_hci_evt_le_meta_event *meta;
 	struct bt_hci_evt_hdr *hdr;
+	uint8_t public_key[64];
 	uint8_t status;
-	EccPoint pkey;
 
 	BT_DBG("");
 
@@ -120,7 +230,7 @@ static void emulate_le_p256_public_key_cmd(struct net_buf *buf)
 
 	send_cmd_status(BT_HCI_OP_LE_P256_PUBLIC_KEY, 0);
 
-	status = generate_keys(&pkey, private_key);
+	status = key_cache_get(public_key, private_key);
 
 	buf = bt_buf_get_rx(K_FOREVER);
 	bt_buf_set_type(buf, BT_BUF_EVT);
@@ -138,8 +248,7 @@ static void emulate_le_p256_public_key_cmd(struct net_buf *buf)
 	if (status) {
 		memset(evt->key, 0, sizeof(evt->key));
 	} else {
-		memcpy(evt->key, pkey.x, 32);
-		memcpy(&evt->key[32], pkey.y, 32);
+		memcpy(evt->key, public_key, 64);
 	}
 
 	bt_recv(buf);
@@ -151,14 +260,9 @@ static void emulate_le_generate_dhkey(struct net_buf *buf)
 	struct bt_hci_cp_le_generate_dhkey *cmd;
 	struct bt_hci_evt_le_meta_event *meta;
 	struct bt_hci_evt_hdr *hdr;
-	int32_t ret;
-	/* The following large stack variables are never needed at the same
-	 * time, so we save some stack space by putting them in a union.
-	 */
-	union {
-		EccPoint pk;
-		uint32_t dhkey[8];
-	} ecc;
+	uint8_t public_key[64];
+	uint8_t dhkey[32];
+	int err;
 
 	if (buf->len < sizeof(*cmd)) {
 		send_cmd_status(BT_HCI_OP_LE_GENERATE_DHKEY,
@@ -170,16 +274,11 @@ static void emulate_le_generate_dhkey(struct net_buf *buf)
 
 	cmd = (void *)buf->data  + sizeof(struct bt_hci_cmd_hdr);
 
-	memcpy(ecc.pk.x, cmd->key, 32);
-	memcpy(ecc.pk.y, &cmd->key[32], 32);
+	memcpy(public_key, cmd->key, 64);
 
 	net_buf_unref(buf);
 
-	if (ecc_valid_public_key(&ecc.pk) < 0) {
-		ret = TC_CRYPTO_FAIL;
-	} else {
-		ret = ecdh_shared_secret(ecc.dhkey, &ecc.pk, private_key);
-	}
+	err = ecc_drv->dh_key(public_key, (uint8_t *)private_key, dhkey);
 
 	buf = bt_buf_get_rx(K_FOREVER);
 	bt_buf_set_type(buf, BT_BUF_EVT);
@@ -193,12 +292,12 @@ static void emulate_le_generate_dhkey(struct net_buf *buf)
 
 	evt = net_buf_add(buf, sizeof(*evt));
 
-	if (ret == TC_CRYPTO_FAIL) {
+	if (err) {
 		evt->status = BT_HCI_ERR_UNSPECIFIED;
 		memset(evt->dhkey, 0, sizeof(evt->dhkey));
 	} else {
 		evt->status = 0;
-		memcpy(evt->dhkey, ecc.dhkey, sizeof(ecc.dhkey));
+		memcpy(evt->dhkey, dhkey, sizeof(dhkey));
 	}
 
 	bt_recv(buf);
@@ -207,11 +306,28 @@ static void emulate_le_generate_dhkey(struct net_buf *buf)
 static void ecc_thread(void *p1, void *p2, void *p3)
 {
 	while (true) {
+		int32_t timeout = K_FOREVER;
 		struct net_buf *buf;
 		struct bt_hci_cmd_hdr *chdr;
 		uint16_t opcode;
 
-		buf = k_fifo_get(&ecc_queue, K_FOREVER);
+#if defined(CONFIG_BLUETOOTH_ECC_KEY_CACHE)
+		/* Generate the next key pair when there is nothing else to do,
+		 * commands still being served first.
+		 */
+		if (key_cache.fill) {
+			timeout = K_NO_WAIT;
+		}
+#endif /* CONFIG_BLUETOOTH_ECC_KEY_CACHE */
+
+		buf = k_fifo_get(&ecc_queue, timeout);
+#if defined(CONFIG_BLUETOOTH_ECC_KEY_CACHE)
+		if (!buf) {
+			key_cache_fill();
+			continue;
+		}
+#endif /* CONFIG_BLUETOOTH_ECC_KEY_CACHE */
+
 		chdr = (void *)buf->data;
 		opcode = sys_le16_to_cpu(chdr->opcode);
 		switch (opcode) {
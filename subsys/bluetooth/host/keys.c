@@ -153,10 +153,18 @@ void bt_keys_clear(struct bt_keys *keys)
 {
 	BT_DBG("keys for %s", bt_addr_le_str(&keys->addr));
 
+	bt_id_del(keys);
+
 	memset(keys, 0, sizeof(*keys));
 }
 
 void bt_keys_clear_all(void)
 {
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(key_pool); i++) {
+		bt_id_del(&key_pool[i]);
+	}
+
 	memset(key_pool, 0, sizeof(key_pool));
 }
@@ -22,6 +22,8 @@ enum {
 enum {
 	BT_KEYS_AUTHENTICATED,
 	BT_KEYS_DEBUG,
+	/* IRK is in the controller resolving list */
+	BT_KEYS_ID_ADDED,
 
 	/* Total number of flags - must be at the end of the enum */
 	BT_KEYS_NUM_FLAGS,
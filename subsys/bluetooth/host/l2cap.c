@@ -27,7 +27,13 @@
 #define LE_CHAN_RTX(_w) CONTAINER_OF(_w, struct bt_l2cap_le_chan, chan.rtx_work)
 
 #define L2CAP_LE_MIN_MTU		23
+#if defined(CONFIG_BLUETOOTH_RX_QUOTA) && CONFIG_BLUETOOTH_RX_QUOTA_L2CAP
+/* Don't let the peer send more than the channels may hold */
+#define L2CAP_LE_MAX_CREDITS		min(CONFIG_BLUETOOTH_RX_QUOTA_L2CAP, \
+					    CONFIG_BLUETOOTH_RX_BUF_COUNT - 1)
+#else
 #define L2CAP_LE_MAX_CREDITS		(CONFIG_BLUETOOTH_RX_BUF_COUNT - 1)
+#endif
 #define L2CAP_LE_CREDITS_THRESHOLD(_creds) (_creds / 2)
 
 #define L2CAP_LE_CID_DYN_START	0x0040
@@ -66,7 +72,7 @@ static struct bt_l2cap_server *servers;
 
 #if defined(CONFIG_BLUETOOTH_L2CAP_DYNAMIC_CHANNEL)
 /* Pool for outgoing LE data packets, MTU is 23 */
-NET_BUF_POOL_DEFINE(le_data_pool, CONFIG_BLUETOOTH_MAX_CONN,
+NET_BUF_POOL_DEFINE(le_data_pool, CONFIG_BLUETOOTH_L2CAP_LE_SEG_COUNT,
 		    BT_L2CAP_BUF_SIZE(BT_L2CAP_MAX_LE_MPS),
 		    BT_BUF_USER_DATA_MIN, NULL);
 #endif /* CONFIG_BLUETOOTH_L2CAP_DYNAMIC_CHANNEL */
@@ -643,8 +649,12 @@ static void l2cap_chan_rx_init(struct bt_l2cap_le_chan *chan)
 	/* Use existing credits if defined */
 	if (!chan->rx.init_credits) {
 		if (chan->chan.ops->alloc_buf) {
-			/* Auto tune credits to receive a full packet */
-			chan->rx.init_credits = chan->rx.mtu /
+			/* Auto tune credits to receive a full packet,
+			 * including its SDU header.
+			 */
+			chan->rx.init_credits = (chan->rx.mtu +
+						 BT_L2CAP_SDU_HDR_LEN +
+						 BT_L2CAP_MAX_LE_MPS - 1) /
 						BT_L2CAP_MAX_LE_MPS;
 		} else {
 			chan->rx.init_credits = L2CAP_LE_MAX_CREDITS;
@@ -655,12 +665,24 @@ static void l2cap_chan_rx_init(struct bt_l2cap_le_chan *chan)
 	k_sem_init(&chan->rx.credits, 0, UINT_MAX);
 }
 
+#if defined(CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE)
+static void l2cap_chan_le_tx_work(struct k_work *work);
+#endif
+
 static void l2cap_chan_tx_init(struct bt_l2cap_le_chan *chan)
 {
 	BT_DBG("chan %p", chan);
 
 	memset(&chan->tx, 0, sizeof(chan->tx));
 	k_sem_init(&chan->tx.credits, 0, UINT_MAX);
+
+#if defined(CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE)
+	k_fifo_init(&chan->_tx_queue);
+	k_sem_init(&chan->_tx_slots, CONFIG_BLUETOOTH_L2CAP_LE_TX_QUEUE_LEN,
+		   CONFIG_BLUETOOTH_L2CAP_LE_TX_QUEUE_LEN);
+	k_work_init(&chan->_tx_work, l2cap_chan_le_tx_work);
+	chan->_tx_sdu = NULL;
+#endif
 }
 
 static void l2cap_chan_tx_give_credits(struct bt_l2cap_le_chan *chan,
@@ -697,6 +719,11 @@ static void l2cap_chan_destroy(struct bt_l2cap_chan *chan)
 	 */
 	l2cap_chan_tx_give_credits(ch, 1);
 
+#if defined(CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE)
+	/* The work drops the SDUs queued, it may be using one of them */
+	k_work_submit(&ch->_tx_work);
+#endif
+
 	/* Destroy segmented SDU if it exists */
 	if (ch->_sdu) {
 		net_buf_unref(ch->_sdu);
@@ -1054,6 +1081,10 @@ static void le_credits(struct bt_l2cap *l2cap, uint8_t ident,
 
 	BT_DBG("chan %p total credits %u", ch,
 	       k_sem_count_get(&ch->tx.credits));
+
+#if defined(CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE)
+	k_work_submit(&ch->_tx_work);
+#endif
 }
 
 static void reject_cmd(struct bt_l2cap *l2cap, uint8_t ident,
@@ -1196,10 +1227,11 @@ static void l2cap_chan_le_recv_sdu(struct bt_l2cap_le_chan *chan,
 	struct net_buf *frag;
 	uint16_t len;
 
-	BT_DBG("chan %p len %u sdu %zu", chan, buf->len,
+	BT_DBG("chan %p len %zu sdu %zu", chan, net_buf_frags_len(buf),
 	       net_buf_frags_len(chan->_sdu));
 
-	if (net_buf_frags_len(chan->_sdu) + buf->len > chan->_sdu_len) {
+	if (net_buf_frags_len(chan->_sdu) + net_buf_frags_len(buf) >
+	    chan->_sdu_len) {
 		BT_ERR("SDU length mismatch");
 		bt_l2cap_chan_disconnect(&chan->chan);
 		return;
@@ -1208,22 +1240,29 @@ static void l2cap_chan_le_recv_sdu(struct bt_l2cap_le_chan *chan,
 	/* Jump to last fragment */
 	frag = net_buf_frag_last(chan->_sdu);
 
-	while (buf->len) {
-		/* Check if there is any space left in the current fragment */
-		if (!net_buf_tailroom(frag)) {
-			frag = l2cap_alloc_frag(chan);
-			if (!frag) {
-				BT_ERR("Unable to store SDU");
-				bt_l2cap_chan_disconnect(&chan->chan);
-				return;
+	/* The K-frame may itself be made of the ACL fragments it was
+	 * received in.
+	 */
+	for (; buf; buf = buf->frags) {
+		while (buf->len) {
+			/* Check if there is any space left in the current
+			 * fragment
+			 */
+			if (!net_buf_tailroom(frag)) {
+				frag = l2cap_alloc_frag(chan);
+				if (!frag) {
+					BT_ERR("Unable to store SDU");
+					bt_l2cap_chan_disconnect(&chan->chan);
+					return;
+				}
 			}
-		}
 
-		len = min(net_buf_tailroom(frag), buf->len);
-		net_buf_add_mem(frag, buf->data, len);
-		net_buf_pull(buf, len);
+			len = min(net_buf_tailroom(frag), buf->len);
+			net_buf_add_mem(frag, buf->data, len);
+			net_buf_pull(buf, len);
 
-		BT_DBG("frag %p len %u", frag, frag->len);
+			BT_DBG("frag %p len %u", frag, frag->len);
+		}
 	}
 
 	if (net_buf_frags_len(chan->_sdu) == chan->_sdu_len) {
@@ -1299,6 +1338,41 @@ static void l2cap_chan_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
 	chan->ops->recv(chan, buf);
 }
 
+/* Copy the chained ACL fragments of a PDU into its first buffer */
+static int l2cap_pullup(struct net_buf *buf)
+{
+	struct net_buf *frag;
+
+	if (net_buf_frags_len(buf->frags) > net_buf_tailroom(buf)) {
+		return -ENOMEM;
+	}
+
+	while (buf->frags) {
+		frag = buf->frags;
+		net_buf_add_mem(buf, frag->data, frag->len);
+		net_buf_frag_del(buf, frag);
+	}
+
+	return 0;
+}
+
+/* Whether PDUs of a channel may be received as fragment chains */
+static bool l2cap_chan_recv_frags(struct bt_l2cap_chan *chan,
+				  struct net_buf *buf)
+{
+#if defined(CONFIG_BLUETOOTH_L2CAP_DYNAMIC_CHANNEL)
+	struct bt_l2cap_le_chan *ch = BT_L2CAP_LE_CHAN(chan);
+
+	/* SDUs are reassembled in buffers of the channel, the SDU length
+	 * must be in the first buffer.
+	 */
+	return L2CAP_LE_CID_IS_DYN(ch->rx.cid) && chan->ops->alloc_buf &&
+	       (ch->_sdu || buf->len >= sizeof(uint16_t));
+#else
+	return false;
+#endif /* CONFIG_BLUETOOTH_L2CAP_DYNAMIC_CHANNEL */
+}
+
 void bt_l2cap_recv(struct bt_conn *conn, struct net_buf *buf)
 {
 	struct bt_l2cap_hdr *hdr = (void *)buf->data;
@@ -1307,6 +1381,12 @@ void bt_l2cap_recv(struct bt_conn *conn, struct net_buf *buf)
 
 	if (IS_ENABLED(CONFIG_BLUETOOTH_BREDR) &&
 	    conn->type == BT_CONN_TYPE_BR) {
+		if (buf->frags && l2cap_pullup(buf) < 0) {
+			BT_ERR("Too large L2CAP PDU received");
+			net_buf_unref(buf);
+			return;
+		}
+
 		bt_l2cap_br_recv(conn, buf);
 		return;
 	}
@@ -1329,6 +1409,13 @@ void bt_l2cap_recv(struct bt_conn *conn, struct net_buf *buf)
 		return;
 	}
 
+	if (buf->frags && !l2cap_chan_recv_frags(chan, buf) &&
+	    l2cap_pullup(buf) < 0) {
+		BT_ERR("Too large PDU for CID 0x%04x", cid);
+		net_buf_unref(buf);
+		return;
+	}
+
 	l2cap_chan_recv(chan, buf);
 	net_buf_unref(buf);
 }
@@ -1586,14 +1673,14 @@ segment:
 	return seg;
 }
 
-static int l2cap_chan_le_send(struct bt_l2cap_le_chan *ch, struct net_buf *buf,
-			      uint16_t sdu_hdr_len)
+/* Send a segment, a credit being taken. Returns the length of the segment,
+ * including the SDU header.
+ */
+static int l2cap_chan_le_send_seg(struct bt_l2cap_le_chan *ch,
+				  struct net_buf *buf, uint16_t sdu_hdr_len)
 {
 	int len;
 
-	/* Wait for credits */
-	k_sem_take(&ch->tx.credits, K_FOREVER);
-
 	buf = l2cap_chan_create_seg(ch, buf, sdu_hdr_len);
 	if (!buf) {
 		return -ENOMEM;
@@ -1615,6 +1702,123 @@ static int l2cap_chan_le_send(struct bt_l2cap_le_chan *ch, struct net_buf *buf,
 	return len;
 }
 
+#if defined(CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE)
+static void l2cap_chan_le_tx_flush(struct bt_l2cap_le_chan *ch)
+{
+	struct net_buf *buf;
+
+	if (ch->_tx_sdu) {
+		net_buf_unref(ch->_tx_sdu);
+		ch->_tx_sdu = NULL;
+		k_sem_give(&ch->_tx_slots);
+	}
+
+	while ((buf = net_buf_get(&ch->_tx_queue, K_NO_WAIT))) {
+		net_buf_unref(buf);
+		k_sem_give(&ch->_tx_slots);
+	}
+}
+
+/* The first fragment of the SDU being sent which has data left */
+static struct net_buf *l2cap_chan_le_tx_frag(struct bt_l2cap_le_chan *ch)
+{
+	struct net_buf *frag = ch->_tx_sdu;
+
+	while (!frag->len && frag->frags) {
+		frag = frag->frags;
+	}
+
+	return frag;
+}
+
+/* Send segments as long as there are credits, each new batch of credits
+ * resubmits the work. The segments of the SDUs queued follow each other
+ * without waiting for the upper layer.
+ */
+static void l2cap_chan_le_tx_work(struct k_work *work)
+{
+	struct bt_l2cap_le_chan *ch = CONTAINER_OF(work,
+						   struct bt_l2cap_le_chan,
+						   _tx_work);
+	uint16_t sdu_hdr_len;
+	int ret;
+
+	while (ch->chan.conn) {
+		if (!ch->_tx_sdu) {
+			ch->_tx_sdu = net_buf_get(&ch->_tx_queue, K_NO_WAIT);
+			if (!ch->_tx_sdu) {
+				return;
+			}
+
+			ch->_tx_left = net_buf_frags_len(ch->_tx_sdu);
+			ch->_tx_hdr_sent = false;
+		}
+
+		if (k_sem_take(&ch->tx.credits, K_NO_WAIT)) {
+			return;
+		}
+
+		sdu_hdr_len = ch->_tx_hdr_sent ? 0 : BT_L2CAP_SDU_HDR_LEN;
+
+		ret = l2cap_chan_le_send_seg(ch, l2cap_chan_le_tx_frag(ch),
+					     sdu_hdr_len);
+		if (ret < 0) {
+			BT_ERR("Unable to send segment (err %d)", ret);
+			break;
+		}
+
+		ch->_tx_hdr_sent = true;
+		ch->_tx_left -= ret - sdu_hdr_len;
+
+		if (!ch->_tx_left) {
+			BT_DBG("ch %p cid 0x%04x SDU %p sent", ch, ch->tx.cid,
+			       ch->_tx_sdu);
+
+			net_buf_unref(ch->_tx_sdu);
+			ch->_tx_sdu = NULL;
+			k_sem_give(&ch->_tx_slots);
+		}
+	}
+
+	/* Disconnected */
+	l2cap_chan_le_tx_flush(ch);
+}
+
+static int l2cap_chan_le_queue_sdu(struct bt_l2cap_le_chan *ch,
+				   struct net_buf *buf)
+{
+	int total_len = net_buf_frags_len(buf);
+
+	if (total_len > ch->tx.mtu) {
+		return -EMSGSIZE;
+	}
+
+	/* Wait for the queue to make room */
+	k_sem_take(&ch->_tx_slots, K_FOREVER);
+
+	/* Channel may have been disconnected while waiting */
+	if (!ch->chan.conn) {
+		k_sem_give(&ch->_tx_slots);
+		return -ECONNRESET;
+	}
+
+	net_buf_put(&ch->_tx_queue, buf);
+	k_work_submit(&ch->_tx_work);
+
+	BT_DBG("ch %p cid 0x%04x queued %u", ch, ch->tx.cid, total_len);
+
+	return total_len;
+}
+#else
+static int l2cap_chan_le_send(struct bt_l2cap_le_chan *ch, struct net_buf *buf,
+			      uint16_t sdu_hdr_len)
+{
+	/* Wait for credits */
+	k_sem_take(&ch->tx.credits, K_FOREVER);
+
+	return l2cap_chan_le_send_seg(ch, buf, sdu_hdr_len);
+}
+
 static int l2cap_chan_le_send_sdu(struct bt_l2cap_le_chan *ch,
 				  struct net_buf *buf)
 {
@@ -1638,8 +1842,9 @@ static int l2cap_chan_le_send_sdu(struct bt_l2cap_le_chan *ch,
 		return ret;
 	}
 
-	/* Send remaining segments */
-	for (sent = ret; sent < total_len; sent += ret) {
+	/* Send remaining segments, the SDU length is not part of the data */
+	for (sent = ret - BT_L2CAP_SDU_HDR_LEN; sent < total_len;
+	     sent += ret) {
 		/* Proceed to next fragment */
 		if (!frag->len) {
 			frag = net_buf_frag_del(buf, frag);
@@ -1657,6 +1862,7 @@ static int l2cap_chan_le_send_sdu(struct bt_l2cap_le_chan *ch,
 
 	return sent;
 }
+#endif /* CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE */
 
 int bt_l2cap_chan_send(struct bt_l2cap_chan *chan, struct net_buf *buf)
 {
@@ -1677,7 +1883,11 @@ int bt_l2cap_chan_send(struct bt_l2cap_chan *chan, struct net_buf *buf)
 		return bt_l2cap_br_chan_send(chan, buf);
 	}
 
+#if defined(CONFIG_BLUETOOTH_L2CAP_LE_PIPELINE)
+	err = l2cap_chan_le_queue_sdu(BT_L2CAP_LE_CHAN(chan), buf);
+#else
 	err = l2cap_chan_le_send_sdu(BT_L2CAP_LE_CHAN(chan), buf);
+#endif
 	if (err < 0) {
 		BT_ERR("failed to send message %d", err);
 	}
@@ -1,5 +1,5 @@
 /** @file
- *  @brief Custom logging over UART
+ *  @brief Custom logging over UART or Segger RTT
  */
 
 /*
@@ -19,6 +19,10 @@
 #include <misc/printk.h>
 #include <uart.h>
 
+#if defined(CONFIG_BLUETOOTH_MONITOR_RTT)
+#include <rtt/SEGGER_RTT.h>
+#endif
+
 #include <bluetooth/buf.h>
 
 #include "monitor.h"
@@ -29,10 +33,52 @@
  */
 #define MONITOR_INIT_PRIORITY 60
 
-static struct device *monitor_dev;
+/* Fixed part of the header, before the extended header */
+#define HDR_FIXED_LEN offsetof(struct bt_monitor_hdr, type)
 
-extern int _prf(int (*func)(), void *dest,
-		const char *format, va_list vargs);
+#if defined(CONFIG_BLUETOOTH_MONITOR_RTT)
+/* Records are written whole or dropped, the count of records dropped being
+ * reported in the extended header of the next one written.
+ */
+static uint8_t monitor_rtt_buf[CONFIG_BLUETOOTH_MONITOR_RTT_BUFFER_SIZE];
+static int monitor_rtt = -1;
+static uint32_t drops;
+
+static void monitor_send(const void *data, size_t len)
+{
+	SEGGER_RTT_WriteNoLock(monitor_rtt, data, len);
+}
+
+/* Called with interrupts locked */
+static bool monitor_reserve(size_t len)
+{
+	SEGGER_RTT_BUFFER_UP *up;
+	unsigned int rd, wr, space;
+
+	if (monitor_rtt < 0) {
+		return false;
+	}
+
+	up = &_SEGGER_RTT.aUp[monitor_rtt];
+	rd = up->RdOff;
+	wr = up->WrOff;
+
+	/* One byte always stays free */
+	if (rd <= wr) {
+		space = up->SizeOfBuffer - 1 - wr + rd;
+	} else {
+		space = rd - wr - 1;
+	}
+
+	if (space < len) {
+		drops++;
+		return false;
+	}
+
+	return true;
+}
+#else
+static struct device *monitor_dev;
 
 static void monitor_send(const void *data, size_t len)
 {
@@ -43,25 +89,71 @@ static void monitor_send(const void *data, size_t len)
 	}
 }
 
+static inline bool monitor_reserve(size_t len)
+{
+	ARG_UNUSED(len);
+
+	return true;
+}
+#endif /* CONFIG_BLUETOOTH_MONITOR_RTT */
+
+extern int _prf(int (*func)(), void *dest,
+		const char *format, va_list vargs);
+
+static inline size_t hdr_len_get(void)
+{
+	size_t len = sizeof(struct bt_monitor_hdr);
+
+#if defined(CONFIG_BLUETOOTH_MONITOR_RTT)
+	if (drops) {
+		len += 2;
+	}
+#endif
+
+	return len;
+}
+
 static inline void encode_hdr(struct bt_monitor_hdr *hdr, uint16_t opcode,
 			      uint16_t len)
 {
 	uint32_t ts32;
 
-	hdr->hdr_len  = sizeof(hdr->type) + sizeof(hdr->ts32);
+	hdr->hdr_len  = hdr_len_get() - HDR_FIXED_LEN;
 	hdr->data_len = sys_cpu_to_le16(4 + hdr->hdr_len + len);
 	hdr->opcode   = sys_cpu_to_le16(opcode);
 	hdr->flags    = 0;
 
-	/* Extended header */
+	/* Extended header, timestamped in 1/10 ms from the hardware clock
+	 * rather than from the system tick.
+	 */
 	hdr->type = BT_MONITOR_TS32;
-	ts32 = k_uptime_get() * 10;
+	ts32 = k_cycle_to_ns_64(k_cycle_get_64()) / 100000;
 	hdr->ts32 = sys_cpu_to_le32(ts32);
 }
 
+/* Called with interrupts locked, once the record is reserved */
+static void send_hdr(struct bt_monitor_hdr *hdr)
+{
+#if defined(CONFIG_BLUETOOTH_MONITOR_RTT)
+	if (drops) {
+		uint8_t ext[2] = { BT_MONITOR_OTHER_DROPS, min(drops, 255) };
+
+		monitor_send(hdr, HDR_FIXED_LEN);
+		monitor_send(ext, sizeof(ext));
+		monitor_send(&hdr->type, sizeof(*hdr) - HDR_FIXED_LEN);
+		drops = 0;
+		return;
+	}
+#endif
+
+	monitor_send(hdr, sizeof(*hdr));
+}
+
 static int log_out(int c, void *unused)
 {
-	uart_poll_out(monitor_dev, c);
+	char ch = c;
+
+	monitor_send(&ch, 1);
 	return 0;
 }
 
@@ -84,12 +176,18 @@ void bt_log(int prio, const char *fmt, ...)
 	log.priority = prio;
 	log.ident_len = sizeof(id);
 
+	key = irq_lock();
+
+	if (!monitor_reserve(hdr_len_get() + sizeof(log) + sizeof(id) +
+			     len + 1)) {
+		irq_unlock(key);
+		return;
+	}
+
 	encode_hdr(&hdr, BT_MONITOR_USER_LOGGING,
 		   sizeof(log) + sizeof(id) + len + 1);
 
-	key = irq_lock();
-
-	monitor_send(&hdr, sizeof(hdr));
+	send_hdr(&hdr);
 	monitor_send(&log, sizeof(log));
 	monitor_send(id, sizeof(id));
 
@@ -98,7 +196,7 @@ void bt_log(int prio, const char *fmt, ...)
 	va_end(ap);
 
 	/* Terminate the string with null */
-	uart_poll_out(monitor_dev, '\0');
+	log_out('\0', NULL);
 
 	irq_unlock(key);
 }
@@ -108,11 +206,16 @@ void bt_monitor_send(uint16_t opcode, const void *data, size_t len)
 	struct bt_monitor_hdr hdr;
 	int key;
 
-	encode_hdr(&hdr, opcode, len);
-
 	key = irq_lock();
 
-	monitor_send(&hdr, sizeof(hdr));
+	if (!monitor_reserve(hdr_len_get() + len)) {
+		irq_unlock(key);
+		return;
+	}
+
+	encode_hdr(&hdr, opcode, len);
+
+	send_hdr(&hdr);
 	monitor_send(data, len);
 
 	irq_unlock(key);
@@ -165,12 +268,20 @@ static int bt_monitor_init(struct device *d)
 {
 	ARG_UNUSED(d);
 
+#if defined(CONFIG_BLUETOOTH_MONITOR_RTT)
+	/* The name btmon looks for */
+	SEGGER_RTT_Init();
+	monitor_rtt = SEGGER_RTT_AllocUpBuffer("btmonitor", monitor_rtt_buf,
+					       sizeof(monitor_rtt_buf),
+					       SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+#else
 	monitor_dev = device_get_binding(CONFIG_BLUETOOTH_MONITOR_ON_DEV_NAME);
 
 #if defined(CONFIG_UART_INTERRUPT_DRIVEN)
 	uart_irq_rx_disable(monitor_dev);
 	uart_irq_tx_disable(monitor_dev);
 #endif
+#endif /* CONFIG_BLUETOOTH_MONITOR_RTT */
 
 #if !defined(CONFIG_UART_CONSOLE)
 	__printk_hook_install(monitor_console_out);
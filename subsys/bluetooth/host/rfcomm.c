@@ -38,6 +38,16 @@
 #define RFCOMM_CREDITS_THRESHOLD	(RFCOMM_MAX_CREDITS / 2)
 #define RFCOMM_DEFAULT_CREDIT		RFCOMM_MAX_CREDITS
 
+/* The credits threshold moves between these bounds: up when the peer uses
+ * its credits faster than RFCOMM_CREDITS_FAST so that new ones are given
+ * before it runs out, down when slower than RFCOMM_CREDITS_SLOW so that
+ * fewer credit frames are sent.
+ */
+#define RFCOMM_CREDITS_THRESHOLD_MIN	(RFCOMM_MAX_CREDITS / 4)
+#define RFCOMM_CREDITS_THRESHOLD_MAX	(RFCOMM_MAX_CREDITS * 3 / 4)
+#define RFCOMM_CREDITS_FAST		K_MSEC(100)
+#define RFCOMM_CREDITS_SLOW		K_SECONDS(1)
+
 #define RFCOMM_CONN_TIMEOUT     K_SECONDS(60)
 #define RFCOMM_DISC_TIMEOUT     K_SECONDS(20)
 #define RFCOMM_IDLE_TIMEOUT     K_SECONDS(2)
@@ -317,11 +327,11 @@ static void rfcomm_session_disconnected(struct bt_rfcomm_session *session)
 struct net_buf *bt_rfcomm_create_pdu(struct net_buf_pool *pool)
 {
 	/* Length in RFCOMM header can be 2 bytes depending on length of user
-	 * data
+	 * data, and credits may be given along with it.
 	 */
 	return bt_conn_create_pdu(pool,
 				  sizeof(struct bt_l2cap_hdr) +
-				  sizeof(struct bt_rfcomm_hdr) + 1);
+				  BT_RFCOMM_HDR_SIZE + BT_RFCOMM_CREDITS_SIZE);
 }
 
 static int rfcomm_send_sabm(struct bt_rfcomm_session *session, uint8_t dlci)
@@ -406,10 +416,11 @@ static void rfcomm_connected(struct bt_l2cap_chan *chan)
 
 	BT_DBG("Session %p", session);
 
-	/* Need to include UIH header and FCS*/
+	/* Need to include UIH header, credits and FCS */
 	session->mtu = min(session->br_chan.rx.mtu,
 			   session->br_chan.tx.mtu) -
-			   BT_RFCOMM_HDR_SIZE + BT_RFCOMM_FCS_SIZE;
+			   BT_RFCOMM_HDR_SIZE - BT_RFCOMM_CREDITS_SIZE -
+			   BT_RFCOMM_FCS_SIZE;
 
 	if (session->state == BT_RFCOMM_STATE_CONNECTING) {
 		rfcomm_send_sabm(session, 0);
@@ -449,6 +460,8 @@ static void rfcomm_dlc_init(struct bt_rfcomm_dlc *dlc,
 	dlc->dlci = dlci;
 	dlc->session = session;
 	dlc->rx_credit = RFCOMM_DEFAULT_CREDIT;
+	dlc->rx_credit_threshold = RFCOMM_CREDITS_THRESHOLD;
+	dlc->rx_credit_time = k_uptime_get_32();
 	dlc->state = BT_RFCOMM_STATE_INIT;
 	dlc->role = role;
 	k_sem_init(&dlc->tx_credits, 0, UINT32_MAX);
@@ -480,6 +493,11 @@ static struct bt_rfcomm_dlc *rfcomm_dlc_accept(struct bt_rfcomm_session *session
 		return NULL;
 	}
 
+	/* Reduced to the session MTU below */
+	if (!dlc->mtu) {
+		dlc->mtu = BT_RFCOMM_SIG_MAX_MTU;
+	}
+
 	if (!BT_RFCOMM_CHECK_MTU(dlc->mtu)) {
 		rfcomm_dlc_destroy(dlc);
 		return NULL;
@@ -533,6 +551,54 @@ static void rfcomm_check_fc(struct bt_rfcomm_dlc *dlc)
 	k_sem_give(&dlc->session->fc);
 }
 
+/* Give back all the credits used so far */
+static uint8_t rfcomm_dlc_rx_credits_restore(struct bt_rfcomm_dlc *dlc)
+{
+	uint8_t credits = RFCOMM_MAX_CREDITS - dlc->rx_credit;
+
+	dlc->rx_credit += credits;
+	dlc->rx_credit_time = k_uptime_get_32();
+
+	return credits;
+}
+
+/* The header is built in the head room of the buffer just before sending,
+ * so that the credits used since the last frame can be given along with
+ * the data instead of in a frame of their own.
+ */
+static void rfcomm_dlc_push_hdr(struct bt_rfcomm_dlc *dlc, struct net_buf *buf)
+{
+	struct bt_rfcomm_hdr *hdr;
+	uint16_t len = buf->len;
+	uint8_t credits = 0;
+	uint8_t fcs, cr, pf;
+
+	if (dlc->session->cfc == BT_RFCOMM_CFC_SUPPORTED &&
+	    dlc->rx_credit < RFCOMM_MAX_CREDITS) {
+		credits = rfcomm_dlc_rx_credits_restore(dlc);
+		net_buf_push_u8(buf, credits);
+	}
+
+	if (len > BT_RFCOMM_MAX_LEN_8) {
+		/* Length is 2 byte */
+		net_buf_push_le16(buf, BT_RFCOMM_SET_LEN_16(len));
+	} else {
+		net_buf_push_u8(buf, BT_RFCOMM_SET_LEN_8(len));
+	}
+
+	hdr = net_buf_push(buf, sizeof(*hdr) - sizeof(hdr->length));
+
+	pf = credits ? BT_RFCOMM_PF_UIH_CREDIT : BT_RFCOMM_PF_UIH_NO_CREDIT;
+	cr = BT_RFCOMM_UIH_CR(dlc->session->role);
+	hdr->address = BT_RFCOMM_SET_ADDR(dlc->dlci, cr);
+	hdr->control = BT_RFCOMM_SET_CTRL(BT_RFCOMM_UIH, pf);
+
+	fcs = rfcomm_calc_fcs(BT_RFCOMM_FCS_LEN_UIH, buf->data);
+	net_buf_add_u8(buf, fcs);
+
+	BT_DBG("dlc %p len %u credits %u", dlc, len, credits);
+}
+
 static void rfcomm_dlc_tx_thread(void *p1, void *p2, void *p3)
 {
 	struct bt_rfcomm_dlc *dlc = p1;
@@ -563,6 +629,8 @@ static void rfcomm_dlc_tx_thread(void *p1, void *p2, void *p3)
 			break;
 		}
 
+		rfcomm_dlc_push_hdr(dlc, buf);
+
 		if (bt_l2cap_chan_send(&dlc->session->br_chan.chan, buf) < 0) {
 			/* This fails only if channel is disconnected */
 			dlc->state = BT_RFCOMM_STATE_DISCONNECTED;
@@ -1305,6 +1373,7 @@ static void rfcomm_handle_msg(struct bt_rfcomm_session *session,
 
 static void rfcomm_dlc_update_credits(struct bt_rfcomm_dlc *dlc)
 {
+	uint32_t elapsed;
 	uint8_t credits;
 
 	if (dlc->session->cfc == BT_RFCOMM_CFC_NOT_SUPPORTED) {
@@ -1313,14 +1382,22 @@ static void rfcomm_dlc_update_credits(struct bt_rfcomm_dlc *dlc)
 
 	BT_DBG("dlc %p credits %u", dlc, dlc->rx_credit);
 
-	/* Only give more credits if it went below the defined threshold */
-	if (dlc->rx_credit > RFCOMM_CREDITS_THRESHOLD) {
+	/* Only give more credits if it went below the threshold */
+	if (dlc->rx_credit > dlc->rx_credit_threshold) {
 		return;
 	}
 
+	elapsed = k_uptime_get_32() - dlc->rx_credit_time;
+	if (elapsed < RFCOMM_CREDITS_FAST &&
+	    dlc->rx_credit_threshold < RFCOMM_CREDITS_THRESHOLD_MAX) {
+		dlc->rx_credit_threshold++;
+	} else if (elapsed > RFCOMM_CREDITS_SLOW &&
+		   dlc->rx_credit_threshold > RFCOMM_CREDITS_THRESHOLD_MIN) {
+		dlc->rx_credit_threshold--;
+	}
+
 	/* Restore credits */
-	credits = RFCOMM_MAX_CREDITS - dlc->rx_credit;
-	dlc->rx_credit += credits;
+	credits = rfcomm_dlc_rx_credits_restore(dlc);
 
 	rfcomm_send_credit(dlc, credits);
 }
@@ -1371,8 +1448,7 @@ static void rfcomm_handle_data(struct bt_rfcomm_session *session,
 
 int bt_rfcomm_dlc_send(struct bt_rfcomm_dlc *dlc, struct net_buf *buf)
 {
-	struct bt_rfcomm_hdr *hdr;
-	uint8_t fcs, cr;
+	uint16_t len;
 
 	if (!buf) {
 		return -EINVAL;
@@ -1388,30 +1464,18 @@ int bt_rfcomm_dlc_send(struct bt_rfcomm_dlc *dlc, struct net_buf *buf)
 		return -EMSGSIZE;
 	}
 
-	if (buf->len > BT_RFCOMM_MAX_LEN_8) {
-		uint16_t *len;
-
-		/* Length is 2 byte */
-		hdr = net_buf_push(buf, sizeof(*hdr) + 1);
-		len = (uint16_t *)&hdr->length;
-		*len = BT_RFCOMM_SET_LEN_16(sys_cpu_to_le16(buf->len -
-							    sizeof(*hdr) + 1));
-	} else {
-		hdr = net_buf_push(buf, sizeof(*hdr));
-		hdr->length = BT_RFCOMM_SET_LEN_8(buf->len - sizeof(*hdr));
+	/* The header and FCS are added by the tx thread */
+	if (net_buf_headroom(buf) < BT_RFCOMM_HDR_SIZE +
+	    BT_RFCOMM_CREDITS_SIZE ||
+	    net_buf_tailroom(buf) < BT_RFCOMM_FCS_SIZE) {
+		return -EINVAL;
 	}
 
-	cr = BT_RFCOMM_UIH_CR(dlc->session->role);
-	hdr->address = BT_RFCOMM_SET_ADDR(dlc->dlci, cr);
-	hdr->control = BT_RFCOMM_SET_CTRL(BT_RFCOMM_UIH,
-					  BT_RFCOMM_PF_UIH_NO_CREDIT);
-
-	fcs = rfcomm_calc_fcs(BT_RFCOMM_FCS_LEN_UIH, buf->data);
-	net_buf_add_u8(buf, fcs);
+	len = buf->len;
 
 	net_buf_put(&dlc->tx_queue, buf);
 
-	return buf->len;
+	return len;
 }
 
 static void rfcomm_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
@@ -1582,6 +1646,11 @@ int bt_rfcomm_dlc_connect(struct bt_conn *conn, struct bt_rfcomm_dlc *dlc,
 		return -EINVAL;
 	}
 
+	/* Reduced to the session MTU once it is connected */
+	if (!dlc->mtu) {
+		dlc->mtu = BT_RFCOMM_SIG_MAX_MTU;
+	}
+
 	if (!BT_RFCOMM_CHECK_MTU(dlc->mtu)) {
 		return -EINVAL;
 	}
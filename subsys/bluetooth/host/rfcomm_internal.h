@@ -127,14 +127,15 @@ struct bt_rfcomm_rpn {
 				     (mtu) <= BT_RFCOMM_SIG_MAX_MTU))
 
 /* Helper to calculate needed outgoing buffer size.
- * Length in rfcomm header can be two bytes depending on user data length.
- * One byte in the tail should be reserved for FCS.
+ * Length in rfcomm header can be two bytes depending on user data length,
+ * and it can be followed by a credits byte. One byte in the tail should be
+ * reserved for FCS.
  */
 #define BT_RFCOMM_BUF_SIZE(mtu) (CONFIG_BLUETOOTH_HCI_SEND_RESERVE + \
 				 sizeof(struct bt_hci_acl_hdr) + \
 				 sizeof(struct bt_l2cap_hdr) + \
-				 sizeof(struct bt_rfcomm_hdr) + 1 + (mtu) + \
-				 BT_RFCOMM_FCS_SIZE)
+				 BT_RFCOMM_HDR_SIZE + BT_RFCOMM_CREDITS_SIZE + \
+				 (mtu) + BT_RFCOMM_FCS_SIZE)
 
 #define BT_RFCOMM_GET_DLCI(addr)           (((addr) & 0xfc) >> 2)
 #define BT_RFCOMM_GET_FRAME_TYPE(ctrl)     ((ctrl) & 0xef)
@@ -186,6 +187,8 @@ struct bt_rfcomm_rpn {
 /* Length can be 2 bytes depending on data size */
 #define BT_RFCOMM_HDR_SIZE  (sizeof(struct bt_rfcomm_hdr) + 1)
 #define BT_RFCOMM_FCS_SIZE  1
+/* Credits given along with data, when credit based flow control is used */
+#define BT_RFCOMM_CREDITS_SIZE 1
 
 #define BT_RFCOMM_FCS_LEN_UIH      2
 #define BT_RFCOMM_FCS_LEN_NON_UIH  3
@@ -0,0 +1,600 @@
+/* sbc.c - Bluetooth SBC audio encoder */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Fixed-point implementation of the SBC encoder of the A2DP specification.
+ * The analysis filter bank windows the history with the prototype filter,
+ * in Q16 for four subbands and Q17 for eight, and the matrixing is done
+ * with 16-bit operands so that Cortex-M DSP instructions can compute two
+ * products at once.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/util.h>
+
+#include <bluetooth/sbc.h>
+
+#if defined(CONFIG_HAS_CMSIS) && defined(__ARM_FEATURE_DSP)
+#include <arch/arm/cortex_m/cmsis.h>
+#define SBC_DSP 1
+#endif
+
+#define SBC_SYNCWORD	0x9c
+
+/* Shift of the windowed samples, keeping one fractional bit */
+#define SBC_PROTO_SHIFT_4	15
+#define SBC_PROTO_SHIFT_8	16
+
+/* Shift of the matrixed samples back to the PCM scale */
+#define SBC_COS_SHIFT		16
+
+/* Largest subband sample magnitude, with scale factor 15 */
+#define SBC_SB_MAX		((1 << 16) - 1)
+
+/* Prototype filter, with the sign of every other 2M block inverted */
+static const int16_t proto_4[40] = {
+	0, 35, 98, 179, 251, 255, 122, -201,
+	715, 1339, 1892, 2110, 1696, 402, -1889, -5089,
+	8886, 12779, 16164, 18470, 19288, 18470, 16164, 12779,
+	-8886, -5089, -1889, 402, 1696, 2110, 1892, 1339,
+	-715, -201, 122, 255, 251, 179, 98, 35,
+};
+
+static const int16_t proto_8[80] = {
+	0, 21, 45, 73, 108, 149, 194, 234,
+	264, 276, 261, 212, 118, -23, -216, -458,
+	742, 1052, 1371, 1671, 1921, 2085, 2126, 2008,
+	1696, 1161, 383, -644, -1919, -3422, -5122, -6971,
+	8913, 10877, 12789, 14575, 16157, 17467, 18449, 19057,
+	19262, 19057, 18449, 17467, 16157, 14575, 12789, 10877,
+	-8913, -6971, -5122, -3422, -1919, -644, 383, 1161,
+	1696, 2008, 2126, 2085, 1921, 1671, 1371, 1052,
+	-742, -458, -216, -23, 118, 212, 261, 276,
+	264, 234, 194, 149, 108, 73, 45, 21,
+};
+
+/* Matrixing coefficients cos((k + 0.5) * (i - M / 2) * pi / M), Q15 */
+static const int16_t cos_4[4][8] __aligned(4) = {
+	{
+		23170, 30274, 32767, 30274, 23170, 12540, 0, -12540,
+	},
+	{
+		-23170, 12540, 32767, 12540, -23170, -30274, 0, 30274,
+	},
+	{
+		-23170, -12540, 32767, -12540, -23170, 30274, 0, -30274,
+	},
+	{
+		23170, -30274, 32767, -30274, 23170, -12540, 0, 12540,
+	},
+};
+
+static const int16_t cos_8[8][16] __aligned(4) = {
+	{
+		23170, 27246, 30274, 32138, 32767, 32138, 30274, 27246,
+		23170, 18205, 12540, 6393, 0, -6393, -12540, -18205,
+	},
+	{
+		-23170, -6393, 12540, 27246, 32767, 27246, 12540, -6393,
+		-23170, -32138, -30274, -18205, 0, 18205, 30274, 32138,
+	},
+	{
+		-23170, -32138, -12540, 18205, 32767, 18205, -12540, -32138,
+		-23170, 6393, 30274, 27246, 0, -27246, -30274, -6393,
+	},
+	{
+		23170, -18205, -30274, 6393, 32767, 6393, -30274, -18205,
+		23170, 27246, -12540, -32138, 0, 32138, 12540, -27246,
+	},
+	{
+		23170, 18205, -30274, -6393, 32767, -6393, -30274, 18205,
+		23170, -27246, -12540, 32138, 0, -32138, 12540, 27246,
+	},
+	{
+		-23170, 32138, -12540, -18205, 32767, -18205, -12540, 32138,
+		-23170, -6393, 30274, -27246, 0, 27246, -30274, 6393,
+	},
+	{
+		-23170, 6393, 12540, -27246, 32767, -27246, 12540, 6393,
+		-23170, 32138, -30274, 18205, 0, -18205, 30274, -32138,
+	},
+	{
+		23170, -27246, 30274, -32138, 32767, -32138, 30274, -27246,
+		23170, -18205, 12540, -6393, 0, 6393, -12540, 18205,
+	},
+};
+
+/* Loudness offsets, per sampling frequency and subband */
+static const int8_t offset_4[4][4] = {
+	{ -1, 0, 0, 0 },
+	{ -2, 0, 0, 1 },
+	{ -2, 0, 0, 1 },
+	{ -2, 0, 0, 1 },
+};
+
+static const int8_t offset_8[4][8] = {
+	{ -2, 0, 0, 0, 0, 0, 0, 1 },
+	{ -3, 0, 0, 0, 0, 0, 1, 2 },
+	{ -4, 0, 0, 0, 0, 0, 1, 2 },
+	{ -4, 0, 0, 0, 0, 0, 1, 2 },
+};
+
+struct sbc_bits {
+	uint8_t *data;
+	uint32_t acc;
+	uint8_t count;
+};
+
+static void bits_put(struct sbc_bits *bits, uint32_t value, uint8_t len)
+{
+	bits->acc = (bits->acc << len) | (value & ((1 << len) - 1));
+	bits->count += len;
+
+	while (bits->count >= 8) {
+		bits->count -= 8;
+		*bits->data++ = bits->acc >> bits->count;
+	}
+}
+
+static void bits_flush(struct sbc_bits *bits)
+{
+	if (bits->count) {
+		*bits->data++ = bits->acc << (8 - bits->count);
+		bits->count = 0;
+	}
+}
+
+static uint8_t crc_bits(uint8_t crc, uint8_t data, uint8_t len)
+{
+	while (len--) {
+		uint8_t bit = (data >> 7) ^ (crc >> 7);
+
+		crc <<= 1;
+		if (bit) {
+			crc ^= 0x1d;
+		}
+
+		data <<= 1;
+	}
+
+	return crc;
+}
+
+/* CRC of the header bytes following the syncword, then of the first
+ * crc_len bits following the CRC byte.
+ */
+static uint8_t sbc_crc(const uint8_t *frame, size_t crc_len)
+{
+	uint8_t crc = 0x0f;
+	size_t i;
+
+	crc = crc_bits(crc, frame[1], 8);
+	crc = crc_bits(crc, frame[2], 8);
+
+	for (i = 0; i < crc_len / 8; i++) {
+		crc = crc_bits(crc, frame[4 + i], 8);
+	}
+
+	return crc_bits(crc, frame[4 + i], crc_len % 8);
+}
+
+static inline int32_t sbc_matrix(const int16_t *cos, const int16_t *y,
+				 uint8_t len)
+{
+	int64_t acc = 0;
+	uint8_t i;
+
+#if defined(SBC_DSP)
+	for (i = 0; i < len; i += 2) {
+		uint32_t c, v;
+
+		memcpy(&c, &cos[i], sizeof(c));
+		memcpy(&v, &y[i], sizeof(v));
+		acc = (int64_t)__SMLALD(c, v, (uint64_t)acc);
+	}
+#else
+	for (i = 0; i < len; i++) {
+		acc += (int32_t)cos[i] * y[i];
+	}
+#endif
+
+	return acc >> SBC_COS_SHIFT;
+}
+
+/* Shift in the samples of one block and compute its subband samples */
+static void sbc_analyze(struct bt_sbc_encoder *enc, uint8_t ch,
+			const int16_t *pcm, int32_t *sb)
+{
+	uint8_t m = enc->cfg.subbands;
+	const int16_t *proto = (m == 4) ? proto_4 : proto_8;
+	const int16_t *cos = (m == 4) ? &cos_4[0][0] : &cos_8[0][0];
+	uint8_t shift = (m == 4) ? SBC_PROTO_SHIFT_4 : SBC_PROTO_SHIFT_8;
+	int16_t y[16] __aligned(4);
+	int16_t *x;
+	uint8_t i, j, k;
+
+	x = &enc->x[ch][enc->x_pos];
+
+	/* The newest sample comes first */
+	for (i = 0; i < m; i++) {
+		x[m - 1 - i] = pcm[i * enc->channels];
+	}
+
+	for (i = 0; i < 2 * m; i++) {
+		int32_t acc = 0;
+
+		for (j = 0; j < 10 * m; j += 2 * m) {
+			acc += (int32_t)x[i + j] * proto[i + j];
+		}
+
+		y[i] = acc >> shift;
+	}
+
+	for (k = 0; k < m; k++) {
+		sb[k] = sbc_matrix(&cos[k * 2 * m], y, 2 * m);
+	}
+}
+
+static uint8_t sbc_scale_factor(uint32_t max)
+{
+	uint8_t sf = 0;
+
+	while (sf < 15 && max >= (2U << sf)) {
+		sf++;
+	}
+
+	return sf;
+}
+
+static uint32_t sbc_max(struct bt_sbc_encoder *enc, uint8_t ch, uint8_t sb)
+{
+	uint32_t peak = 0;
+	uint8_t blk;
+
+	for (blk = 0; blk < enc->cfg.blocks; blk++) {
+		int32_t s = enc->sb[blk][ch][sb];
+
+		if (s < -SBC_SB_MAX) {
+			s = -SBC_SB_MAX;
+		} else if (s > SBC_SB_MAX) {
+			s = SBC_SB_MAX;
+		}
+
+		enc->sb[blk][ch][sb] = s;
+
+		if (s < 0) {
+			s = -s;
+		}
+
+		peak = max(peak, (uint32_t)s);
+	}
+
+	return peak;
+}
+
+/* Code the subbands, but the last one, as mid and side when it needs
+ * fewer bits for their scale factors.
+ */
+static uint8_t sbc_joint(struct bt_sbc_encoder *enc, uint8_t sf[2][8])
+{
+	uint8_t join = 0;
+	uint8_t sb, blk;
+
+	for (sb = 0; sb < enc->cfg.subbands - 1; sb++) {
+		uint32_t mid = 0, side = 0;
+		uint8_t sf_mid, sf_side;
+
+		for (blk = 0; blk < enc->cfg.blocks; blk++) {
+			int32_t l = enc->sb[blk][0][sb];
+			int32_t r = enc->sb[blk][1][sb];
+			int32_t m = (l + r) >> 1;
+			int32_t s = (l - r) >> 1;
+
+			mid = max(mid, (uint32_t)(m < 0 ? -m : m));
+			side = max(side, (uint32_t)(s < 0 ? -s : s));
+		}
+
+		sf_mid = sbc_scale_factor(mid);
+		sf_side = sbc_scale_factor(side);
+
+		if (sf_mid + sf_side >= sf[0][sb] + sf[1][sb]) {
+			continue;
+		}
+
+		join |= BIT(enc->cfg.subbands - 1 - sb);
+		sf[0][sb] = sf_mid;
+		sf[1][sb] = sf_side;
+
+		for (blk = 0; blk < enc->cfg.blocks; blk++) {
+			int32_t l = enc->sb[blk][0][sb];
+			int32_t r = enc->sb[blk][1][sb];
+
+			enc->sb[blk][0][sb] = (l + r) >> 1;
+			enc->sb[blk][1][sb] = (l - r) >> 1;
+		}
+	}
+
+	return join;
+}
+
+static void sbc_bitneed(struct bt_sbc_encoder *enc, const uint8_t *sf,
+			int8_t *bitneed)
+{
+	uint8_t m = enc->cfg.subbands;
+	const int8_t *offset = (m == 4) ? offset_4[enc->cfg.freq] :
+					  offset_8[enc->cfg.freq];
+	uint8_t sb;
+
+	for (sb = 0; sb < m; sb++) {
+		int8_t loudness;
+
+		if (enc->cfg.alloc == BT_SBC_ALLOC_SNR) {
+			bitneed[sb] = sf[sb];
+		} else if (!sf[sb]) {
+			bitneed[sb] = -5;
+		} else {
+			loudness = sf[sb] - offset[sb];
+			bitneed[sb] = (loudness > 0) ? loudness / 2 : loudness;
+		}
+	}
+}
+
+/* Bit allocation of the specification, over one channel or over both
+ * channels of a stereo frame.
+ */
+static void sbc_bit_alloc(struct bt_sbc_encoder *enc, uint8_t sf[2][8],
+			  uint8_t bits[2][8], uint8_t nch)
+{
+	uint8_t m = enc->cfg.subbands;
+	int8_t bitneed[2][8];
+	int8_t max_bitneed = 0;
+	int bitcount = 0, slicecount = 0;
+	int bitslice;
+	uint8_t ch, sb;
+
+	for (ch = 0; ch < nch; ch++) {
+		sbc_bitneed(enc, sf[ch], bitneed[ch]);
+
+		for (sb = 0; sb < m; sb++) {
+			max_bitneed = max(max_bitneed, bitneed[ch][sb]);
+		}
+	}
+
+	bitslice = max_bitneed + 1;
+
+	do {
+		bitslice--;
+		bitcount += slicecount;
+		slicecount = 0;
+
+		for (ch = 0; ch < nch; ch++) {
+			for (sb = 0; sb < m; sb++) {
+				int8_t need = bitneed[ch][sb];
+
+				if (need > bitslice + 1 &&
+				    need < bitslice + 16) {
+					slicecount++;
+				} else if (need == bitslice + 1) {
+					slicecount += 2;
+				}
+			}
+		}
+	} while (bitcount + slicecount < enc->cfg.bitpool);
+
+	if (bitcount + slicecount == enc->cfg.bitpool) {
+		bitcount += slicecount;
+		bitslice--;
+	}
+
+	for (ch = 0; ch < nch; ch++) {
+		for (sb = 0; sb < m; sb++) {
+			if (bitneed[ch][sb] < bitslice + 2) {
+				bits[ch][sb] = 0;
+			} else {
+				bits[ch][sb] = min(bitneed[ch][sb] - bitslice,
+						   16);
+			}
+		}
+	}
+
+	/* Distribute the remaining bits, alternating the channels */
+	for (ch = 0, sb = 0; bitcount < enc->cfg.bitpool && sb < m; ) {
+		if (bits[ch][sb] >= 2 && bits[ch][sb] < 16) {
+			bits[ch][sb]++;
+			bitcount++;
+		} else if (bitneed[ch][sb] == bitslice + 1 &&
+			   enc->cfg.bitpool > bitcount + 1) {
+			bits[ch][sb] = 2;
+			bitcount += 2;
+		}
+
+		if (++ch == nch) {
+			ch = 0;
+			sb++;
+		}
+	}
+
+	for (ch = 0, sb = 0; bitcount < enc->cfg.bitpool && sb < m; ) {
+		if (bits[ch][sb] < 16) {
+			bits[ch][sb]++;
+			bitcount++;
+		}
+
+		if (++ch == nch) {
+			ch = 0;
+			sb++;
+		}
+	}
+}
+
+int bt_sbc_encoder_init(struct bt_sbc_encoder *enc,
+			const struct bt_sbc_config *cfg)
+{
+	uint8_t channels = (cfg->mode == BT_SBC_MODE_MONO) ? 1 : 2;
+	uint16_t max_bitpool;
+
+	if (cfg->freq > BT_SBC_FREQ_48000 ||
+	    cfg->mode > BT_SBC_MODE_JOINT_STEREO ||
+	    cfg->alloc > BT_SBC_ALLOC_SNR) {
+		return -EINVAL;
+	}
+
+	if (cfg->blocks != 4 && cfg->blocks != 8 && cfg->blocks != 12 &&
+	    cfg->blocks != 16) {
+		return -EINVAL;
+	}
+
+	if (cfg->subbands != 4 && cfg->subbands != 8) {
+		return -EINVAL;
+	}
+
+	if (cfg->mode == BT_SBC_MODE_STEREO ||
+	    cfg->mode == BT_SBC_MODE_JOINT_STEREO) {
+		max_bitpool = 32 * cfg->subbands;
+	} else {
+		max_bitpool = 16 * cfg->subbands;
+	}
+
+	if (cfg->bitpool < 2 || cfg->bitpool > max_bitpool) {
+		return -EINVAL;
+	}
+
+	memset(enc, 0, sizeof(*enc));
+	enc->cfg = *cfg;
+	enc->channels = channels;
+	enc->x_pos = BT_SBC_X_LEN - 10 * cfg->subbands;
+
+	return 0;
+}
+
+size_t bt_sbc_frame_len(const struct bt_sbc_encoder *enc)
+{
+	const struct bt_sbc_config *cfg = &enc->cfg;
+	size_t len, bits;
+
+	len = 4 + (4 * cfg->subbands * enc->channels) / 8;
+
+	switch (cfg->mode) {
+	case BT_SBC_MODE_MONO:
+	case BT_SBC_MODE_DUAL_CHANNEL:
+		bits = cfg->blocks * enc->channels * cfg->bitpool;
+		break;
+	case BT_SBC_MODE_JOINT_STEREO:
+		bits = cfg->subbands + cfg->blocks * cfg->bitpool;
+		break;
+	default:
+		bits = cfg->blocks * cfg->bitpool;
+		break;
+	}
+
+	return len + (bits + 7) / 8;
+}
+
+size_t bt_sbc_encode(struct bt_sbc_encoder *enc, const int16_t *pcm,
+		     uint8_t *frame)
+{
+	const struct bt_sbc_config *cfg = &enc->cfg;
+	uint8_t m = cfg->subbands;
+	uint8_t sf[2][8], bits[2][8];
+	struct sbc_bits out;
+	uint8_t join = 0;
+	uint8_t blk, ch, sb;
+	size_t crc_len;
+
+	for (blk = 0; blk < cfg->blocks; blk++) {
+		/* Make room for the block, moving the history when the
+		 * start of the buffer is reached.
+		 */
+		if (enc->x_pos < m) {
+			for (ch = 0; ch < enc->channels; ch++) {
+				memmove(&enc->x[ch][BT_SBC_X_LEN - 9 * m],
+					&enc->x[ch][enc->x_pos],
+					9 * m * sizeof(enc->x[ch][0]));
+			}
+
+			enc->x_pos = BT_SBC_X_LEN - 9 * m;
+		}
+
+		enc->x_pos -= m;
+
+		for (ch = 0; ch < enc->channels; ch++) {
+			sbc_analyze(enc, ch, &pcm[blk * m * enc->channels + ch],
+				    enc->sb[blk][ch]);
+		}
+	}
+
+	for (ch = 0; ch < enc->channels; ch++) {
+		for (sb = 0; sb < m; sb++) {
+			sf[ch][sb] = sbc_scale_factor(sbc_max(enc, ch, sb));
+		}
+	}
+
+	if (cfg->mode == BT_SBC_MODE_JOINT_STEREO) {
+		join = sbc_joint(enc, sf);
+	}
+
+	if (cfg->mode == BT_SBC_MODE_STEREO ||
+	    cfg->mode == BT_SBC_MODE_JOINT_STEREO) {
+		sbc_bit_alloc(enc, sf, bits, 2);
+	} else {
+		for (ch = 0; ch < enc->channels; ch++) {
+			sbc_bit_alloc(enc, &sf[ch], &bits[ch], 1);
+		}
+	}
+
+	frame[0] = SBC_SYNCWORD;
+	frame[1] = (cfg->freq << 6) | ((cfg->blocks / 4 - 1) << 4) |
+		   (cfg->mode << 2) | (cfg->alloc << 1) | (m == 8);
+	frame[2] = cfg->bitpool;
+
+	out.data = &frame[4];
+	out.acc = 0;
+	out.count = 0;
+
+	crc_len = 0;
+
+	if (cfg->mode == BT_SBC_MODE_JOINT_STEREO) {
+		bits_put(&out, join, m);
+		crc_len += m;
+	}
+
+	for (ch = 0; ch < enc->channels; ch++) {
+		for (sb = 0; sb < m; sb++) {
+			bits_put(&out, sf[ch][sb], 4);
+		}
+	}
+
+	crc_len += 4 * m * enc->channels;
+
+	for (blk = 0; blk < cfg->blocks; blk++) {
+		for (ch = 0; ch < enc->channels; ch++) {
+			for (sb = 0; sb < m; sb++) {
+				uint32_t levels, q;
+				int32_t s;
+
+				if (!bits[ch][sb]) {
+					continue;
+				}
+
+				levels = (1 << bits[ch][sb]) - 1;
+				s = enc->sb[blk][ch][sb] + (2 << sf[ch][sb]);
+				q = ((uint64_t)s * levels) >> (sf[ch][sb] + 2);
+
+				bits_put(&out, min(q, levels), bits[ch][sb]);
+			}
+		}
+	}
+
+	bits_flush(&out);
+
+	/* The CRC needs the scale factors in place */
+	frame[3] = sbc_crc(frame, crc_len);
+
+	return out.data - frame;
+}
@@ -3031,6 +3031,8 @@ static uint8_t smp_ident_addr_info(struct bt_smp *smp, struct net_buf *buf)
 				bt_conn_identity_resolved(conn);
 			}
 		}
+
+		bt_id_add(keys);
 	}
 
 	smp->remote_dist &= ~BT_SMP_DIST_ID_KEY;
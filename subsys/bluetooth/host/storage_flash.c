@@ -0,0 +1,817 @@
+/* storage_flash.c - Bluetooth storage on a raw flash partition */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* The keys are kept as a log of records on one of two flash sectors. A
+ * new value is appended after the last record, a cleared peer gets a
+ * tombstone record, and a RAM index keeps the offset of the live record
+ * of each key. When the sector is full the live records are copied to
+ * the other sector, which then becomes the active one: each compaction
+ * erases one sector only, the two in turn, and a value is only written
+ * again when it changes.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr.h>
+#include <init.h>
+#include <flash.h>
+#include <misc/util.h>
+
+#define BT_DBG_ENABLED IS_ENABLED(CONFIG_BLUETOOTH_DEBUG_HCI_CORE)
+#include <bluetooth/log.h>
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/storage.h>
+
+#define SECTOR_SIZE     CONFIG_BLUETOOTH_STORAGE_FLASH_SECTOR_SIZE
+#define SECTOR_OFFSET(i) (CONFIG_BLUETOOTH_STORAGE_FLASH_OFFSET + \
+			  (i) * SECTOR_SIZE)
+#define INDEX_SIZE      CONFIG_BLUETOOTH_STORAGE_FLASH_ENTRIES
+#define CACHE_SIZE      CONFIG_BLUETOOTH_STORAGE_FLASH_CACHE
+
+/* Largest value kept in the write-back cache */
+#define CACHE_DATA_MAX  16
+
+/* Time without writes after which the cache is written to flash */
+#define CACHE_TIMEOUT   K_SECONDS(5)
+
+#define SECTOR_MAGIC    0x42545354 /* "BTST" */
+
+/* Key of the erased flash, ending the log */
+#define KEY_NONE        0xffff
+/* Key of the tombstone record clearing all the keys of an address */
+#define KEY_CLEAR       0xfffe
+
+/* State of a record, written last so that a partial record is ignored */
+#define RECORD_VALID    0x00000000
+
+/* Address type of the local keys */
+#define ADDR_LOCAL      0xff
+
+struct sector_hdr {
+	uint32_t magic;
+	/* Incremented at each compaction, the highest one is active */
+	uint32_t seq;
+} __packed;
+
+struct record_hdr {
+	uint16_t key;
+	uint16_t len;
+	bt_addr_le_t addr;
+	uint8_t reserved;
+	uint32_t state;
+} __packed;
+
+#define RECORD_SIZE(len) (sizeof(struct record_hdr) + ROUND_UP(len, 4))
+
+struct index_entry {
+	bt_addr_le_t addr;
+	uint16_t key;
+	uint16_t len;
+	/* Offset of the record in the active sector */
+	uint16_t offset;
+} __packed;
+
+static struct device *flash_dev;
+static struct index_entry index[INDEX_SIZE];
+static uint8_t active;
+static uint32_t active_seq;
+/* Offset of the erased space following the last record */
+static uint32_t write_offset;
+
+static K_SEM_DEFINE(storage_lock, 1, 1);
+
+static const bt_addr_le_t addr_local = { .type = ADDR_LOCAL };
+
+static inline const bt_addr_le_t *addr_or_local(const bt_addr_le_t *addr)
+{
+	return addr ? addr : &addr_local;
+}
+
+static int flash_program(uint32_t offset, const void *data, size_t len)
+{
+	int err;
+
+	flash_write_protection_set(flash_dev, false);
+	err = flash_write(flash_dev, offset, data, len);
+	flash_write_protection_set(flash_dev, true);
+
+	return err;
+}
+
+static int sector_erase(uint8_t sector, uint32_t seq)
+{
+	struct sector_hdr hdr;
+	int err;
+
+	flash_write_protection_set(flash_dev, false);
+	err = flash_erase(flash_dev, SECTOR_OFFSET(sector), SECTOR_SIZE);
+	flash_write_protection_set(flash_dev, true);
+	if (err) {
+		return err;
+	}
+
+	hdr.magic = SECTOR_MAGIC;
+	hdr.seq = seq;
+
+	return flash_program(SECTOR_OFFSET(sector), &hdr, sizeof(hdr));
+}
+
+static struct index_entry *index_find(const bt_addr_le_t *addr, uint16_t key)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(index); i++) {
+		if (index[i].key == key &&
+		    !bt_addr_le_cmp(&index[i].addr, addr)) {
+			return &index[i];
+		}
+	}
+
+	return NULL;
+}
+
+static struct index_entry *index_alloc(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(index); i++) {
+		if (index[i].key == KEY_NONE) {
+			return &index[i];
+		}
+	}
+
+	return NULL;
+}
+
+static bool index_remove_addr(const bt_addr_le_t *addr)
+{
+	bool found = false;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(index); i++) {
+		if (index[i].key != KEY_NONE &&
+		    !bt_addr_le_cmp(&index[i].addr, addr)) {
+			index[i].key = KEY_NONE;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+static void index_reset(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(index); i++) {
+		index[i].key = KEY_NONE;
+	}
+}
+
+/* Write a record at the end of the log of the given sector */
+static int record_append(uint8_t sector, uint32_t *offset,
+			 const bt_addr_le_t *addr, uint16_t key,
+			 const void *data, size_t len)
+{
+	uint32_t base = SECTOR_OFFSET(sector) + *offset;
+	struct record_hdr hdr;
+	size_t aligned = ROUND_DOWN(len, 4);
+	int err;
+
+	hdr.key = key;
+	hdr.len = len;
+	bt_addr_le_copy(&hdr.addr, addr);
+	hdr.reserved = 0xff;
+	hdr.state = 0xffffffff;
+
+	err = flash_program(base, &hdr, sizeof(hdr));
+	if (err) {
+		return err;
+	}
+
+	base += sizeof(hdr);
+
+	if (aligned) {
+		err = flash_program(base, data, aligned);
+		if (err) {
+			return err;
+		}
+	}
+
+	if (len > aligned) {
+		uint8_t tail[4];
+
+		memset(tail, 0xff, sizeof(tail));
+		memcpy(tail, (const uint8_t *)data + aligned, len - aligned);
+
+		err = flash_program(base + aligned, tail, sizeof(tail));
+		if (err) {
+			return err;
+		}
+	}
+
+	hdr.state = RECORD_VALID;
+	err = flash_program(SECTOR_OFFSET(sector) + *offset +
+			    offsetof(struct record_hdr, state),
+			    &hdr.state, sizeof(hdr.state));
+	if (err) {
+		return err;
+	}
+
+	*offset += RECORD_SIZE(len);
+
+	return 0;
+}
+
+static int record_read(uint8_t sector, const struct index_entry *entry,
+		       uint16_t from, void *data, size_t len)
+{
+	return flash_read(flash_dev, SECTOR_OFFSET(sector) + entry->offset +
+			  sizeof(struct record_hdr) + from, data, len);
+}
+
+static bool record_equal(const struct index_entry *entry, const void *data,
+			 size_t len)
+{
+	uint8_t buf[16];
+	uint16_t i;
+
+	if (entry->len != len) {
+		return false;
+	}
+
+	for (i = 0; i < len; i += sizeof(buf)) {
+		size_t chunk = min(sizeof(buf), len - i);
+
+		if (record_read(active, entry, i, buf, chunk) ||
+		    memcmp(buf, (const uint8_t *)data + i, chunk)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Copy the live records to the other sector and make it the active one */
+static int compact(void)
+{
+	uint8_t sector = !active;
+	uint32_t seq = active_seq + 1;
+	uint32_t offset = sizeof(struct sector_hdr);
+	int err, i;
+
+	BT_DBG("Compacting to sector %u", sector);
+
+	/* The header is only written once all the records are copied so
+	 * that the old sector stays the active one if this is interrupted.
+	 */
+	flash_write_protection_set(flash_dev, false);
+	err = flash_erase(flash_dev, SECTOR_OFFSET(sector), SECTOR_SIZE);
+	flash_write_protection_set(flash_dev, true);
+	if (err) {
+		return err;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(index); i++) {
+		struct index_entry *entry = &index[i];
+		uint32_t base = SECTOR_OFFSET(sector) + offset;
+		struct record_hdr hdr;
+		uint8_t buf[16];
+		uint16_t j;
+
+		if (entry->key == KEY_NONE) {
+			continue;
+		}
+
+		hdr.key = entry->key;
+		hdr.len = entry->len;
+		bt_addr_le_copy(&hdr.addr, &entry->addr);
+		hdr.reserved = 0xff;
+		hdr.state = RECORD_VALID;
+
+		err = flash_program(base, &hdr, sizeof(hdr));
+		if (err) {
+			return err;
+		}
+
+		/* The padding is copied too, keeping the writes aligned */
+		for (j = 0; j < ROUND_UP(entry->len, 4); j += sizeof(buf)) {
+			size_t chunk = min(sizeof(buf),
+					   ROUND_UP(entry->len, 4) - j);
+
+			err = record_read(active, entry, j, buf, chunk);
+			if (err) {
+				return err;
+			}
+
+			err = flash_program(base + sizeof(hdr) + j, buf, chunk);
+			if (err) {
+				return err;
+			}
+		}
+
+		offset += RECORD_SIZE(entry->len);
+	}
+
+	err = flash_program(SECTOR_OFFSET(sector),
+			    &(struct sector_hdr){ SECTOR_MAGIC, seq },
+			    sizeof(struct sector_hdr));
+	if (err) {
+		return err;
+	}
+
+	active = sector;
+	active_seq = seq;
+	write_offset = sizeof(struct sector_hdr);
+
+	/* The index only moves to the new sector once it is complete */
+	for (i = 0; i < ARRAY_SIZE(index); i++) {
+		if (index[i].key != KEY_NONE) {
+			index[i].offset = write_offset;
+			write_offset += RECORD_SIZE(index[i].len);
+		}
+	}
+
+	return 0;
+}
+
+static int record_write(const bt_addr_le_t *addr, uint16_t key,
+			const void *data, size_t len)
+{
+	struct index_entry *entry;
+	uint32_t offset;
+	int err;
+
+	if (RECORD_SIZE(len) > SECTOR_SIZE - sizeof(struct sector_hdr)) {
+		return -ENOSPC;
+	}
+
+	entry = index_find(addr, key);
+	if (entry && record_equal(entry, data, len)) {
+		BT_DBG("Key 0x%04x unchanged", key);
+		return 0;
+	}
+
+	if (!entry && key != KEY_CLEAR) {
+		entry = index_alloc();
+		if (!entry) {
+			return -ENOMEM;
+		}
+	}
+
+	if (write_offset + RECORD_SIZE(len) > SECTOR_SIZE) {
+		/* The value being replaced doesn't need to be copied */
+		uint16_t old_key = KEY_NONE;
+
+		if (entry) {
+			old_key = entry->key;
+			entry->key = KEY_NONE;
+		}
+
+		err = compact();
+		if (err) {
+			/* The old sector is still the active one */
+			if (entry) {
+				entry->key = old_key;
+			}
+
+			return err;
+		}
+
+		if (write_offset + RECORD_SIZE(len) > SECTOR_SIZE) {
+			return -ENOSPC;
+		}
+	}
+
+	offset = write_offset;
+
+	err = record_append(active, &write_offset, addr, key, data, len);
+	if (err) {
+		return err;
+	}
+
+	if (entry) {
+		bt_addr_le_copy(&entry->addr, addr);
+		entry->key = key;
+		entry->len = len;
+		entry->offset = offset;
+	}
+
+	return 0;
+}
+
+#if CACHE_SIZE > 0
+/* Write-back cache of small values of peer devices, which may be updated
+ * many times during a connection.
+ */
+struct cache_entry {
+	bt_addr_le_t addr;
+	uint16_t key;
+	uint8_t len;
+	uint8_t data[CACHE_DATA_MAX];
+};
+
+static struct cache_entry cache[CACHE_SIZE];
+static struct k_delayed_work cache_work;
+
+static struct cache_entry *cache_find(const bt_addr_le_t *addr, uint16_t key)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].key == key &&
+		    !bt_addr_le_cmp(&cache[i].addr, addr)) {
+			return &cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void cache_flush(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		int err;
+
+		if (cache[i].key == KEY_NONE) {
+			continue;
+		}
+
+		err = record_write(&cache[i].addr, cache[i].key,
+				   cache[i].data, cache[i].len);
+		if (err) {
+			BT_ERR("Unable to write key 0x%04x (err %d)",
+			       cache[i].key, err);
+		}
+
+		cache[i].key = KEY_NONE;
+	}
+}
+
+static void cache_drop(const bt_addr_le_t *addr)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (!addr || !bt_addr_le_cmp(&cache[i].addr, addr)) {
+			cache[i].key = KEY_NONE;
+		}
+	}
+}
+
+static bool cache_put(const bt_addr_le_t *addr, uint16_t key,
+		      const void *data, size_t len)
+{
+	struct cache_entry *entry;
+
+	if (addr == &addr_local || len > CACHE_DATA_MAX) {
+		return false;
+	}
+
+	entry = cache_find(addr, key);
+	if (!entry) {
+		int i;
+
+		for (i = 0; i < ARRAY_SIZE(cache); i++) {
+			if (cache[i].key == KEY_NONE) {
+				entry = &cache[i];
+				break;
+			}
+		}
+	}
+
+	if (!entry) {
+		cache_flush();
+		entry = &cache[0];
+	}
+
+	bt_addr_le_copy(&entry->addr, addr);
+	entry->key = key;
+	entry->len = len;
+	memcpy(entry->data, data, len);
+
+	/* Resubmitting postpones the flush until the writes stop */
+	k_delayed_work_submit(&cache_work, CACHE_TIMEOUT);
+
+	return true;
+}
+
+static void cache_timeout(struct k_work *work)
+{
+	k_sem_take(&storage_lock, K_FOREVER);
+	cache_flush();
+	k_sem_give(&storage_lock);
+}
+
+#if defined(CONFIG_BLUETOOTH_CONN)
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	k_sem_take(&storage_lock, K_FOREVER);
+	cache_flush();
+	k_sem_give(&storage_lock);
+}
+
+static struct bt_conn_cb conn_callbacks = {
+	.disconnected = disconnected,
+};
+#endif /* CONFIG_BLUETOOTH_CONN */
+
+static void cache_init(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		cache[i].key = KEY_NONE;
+	}
+
+	k_delayed_work_init(&cache_work, cache_timeout);
+
+#if defined(CONFIG_BLUETOOTH_CONN)
+	bt_conn_cb_register(&conn_callbacks);
+#endif
+}
+#else
+#define cache_flush()
+#define cache_drop(addr)
+#define cache_put(addr, key, data, len) false
+#define cache_init()
+#endif /* CACHE_SIZE > 0 */
+
+static bool addr_listed(const bt_addr_le_t *list, size_t count,
+			const bt_addr_le_t *addr)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (!bt_addr_le_cmp(&list[i], addr)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static ssize_t storage_addresses(bt_addr_le_t *list, size_t length)
+{
+	size_t count = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(index); i++) {
+		if (index[i].key == KEY_NONE ||
+		    index[i].addr.type == ADDR_LOCAL) {
+			continue;
+		}
+
+		if (addr_listed(list, count, &index[i].addr)) {
+			continue;
+		}
+
+		if ((count + 1) * sizeof(*list) > length) {
+			break;
+		}
+
+		bt_addr_le_copy(&list[count++], &index[i].addr);
+	}
+
+#if CACHE_SIZE > 0
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].key == KEY_NONE ||
+		    addr_listed(list, count, &cache[i].addr)) {
+			continue;
+		}
+
+		if ((count + 1) * sizeof(*list) > length) {
+			break;
+		}
+
+		bt_addr_le_copy(&list[count++], &cache[i].addr);
+	}
+#endif
+
+	return count * sizeof(*list);
+}
+
+static ssize_t storage_read(const bt_addr_le_t *addr, uint16_t key, void *data,
+			    size_t length)
+{
+	struct index_entry *entry;
+	ssize_t ret;
+
+	k_sem_take(&storage_lock, K_FOREVER);
+
+	if (!addr && key == BT_STORAGE_ADDRESSES) {
+		ret = storage_addresses(data, length);
+		goto done;
+	}
+
+	addr = addr_or_local(addr);
+
+#if CACHE_SIZE > 0
+	{
+		struct cache_entry *cached = cache_find(addr, key);
+
+		if (cached) {
+			ret = min(length, cached->len);
+			memcpy(data, cached->data, ret);
+			goto done;
+		}
+	}
+#endif
+
+	entry = index_find(addr, key);
+	if (!entry) {
+		ret = -ENOENT;
+		goto done;
+	}
+
+	ret = min(length, entry->len);
+	if (record_read(active, entry, 0, data, ret)) {
+		ret = -EIO;
+	}
+
+done:
+	k_sem_give(&storage_lock);
+
+	return ret;
+}
+
+static ssize_t storage_write(const bt_addr_le_t *addr, uint16_t key,
+			     const void *data, size_t length)
+{
+	ssize_t ret = length;
+	int err;
+
+	if (key == KEY_NONE || key == KEY_CLEAR) {
+		return -EINVAL;
+	}
+
+	k_sem_take(&storage_lock, K_FOREVER);
+
+	addr = addr_or_local(addr);
+
+	if (!cache_put(addr, key, data, length)) {
+		err = record_write(addr, key, data, length);
+		if (err) {
+			ret = err;
+		}
+	}
+
+	k_sem_give(&storage_lock);
+
+	return ret;
+}
+
+static int storage_clear(const bt_addr_le_t *addr)
+{
+	int err = 0;
+
+	k_sem_take(&storage_lock, K_FOREVER);
+
+	cache_drop(addr);
+
+	if (!addr) {
+		index_reset();
+
+		flash_write_protection_set(flash_dev, false);
+		flash_erase(flash_dev, SECTOR_OFFSET(!active), SECTOR_SIZE);
+		flash_write_protection_set(flash_dev, true);
+
+		err = sector_erase(active, ++active_seq);
+		write_offset = sizeof(struct sector_hdr);
+	} else if (index_remove_addr(addr)) {
+		err = record_write(addr, KEY_CLEAR, NULL, 0);
+	}
+
+	k_sem_give(&storage_lock);
+
+	return err;
+}
+
+static int sector_hdr_read(uint8_t sector, struct sector_hdr *hdr)
+{
+	int err;
+
+	err = flash_read(flash_dev, SECTOR_OFFSET(sector), hdr, sizeof(*hdr));
+	if (err) {
+		return err;
+	}
+
+	return hdr->magic == SECTOR_MAGIC ? 0 : -ENOENT;
+}
+
+/* Rebuild the index by replaying the log of the active sector */
+static void log_replay(void)
+{
+	uint32_t offset = sizeof(struct sector_hdr);
+
+	while (offset + sizeof(struct record_hdr) <= SECTOR_SIZE) {
+		struct index_entry *entry;
+		struct record_hdr hdr;
+
+		if (flash_read(flash_dev, SECTOR_OFFSET(active) + offset,
+			       &hdr, sizeof(hdr)) || hdr.key == KEY_NONE) {
+			break;
+		}
+
+		if (offset + RECORD_SIZE(hdr.len) > SECTOR_SIZE) {
+			BT_WARN("Corrupted record at offset 0x%x", offset);
+			break;
+		}
+
+		if (hdr.state != RECORD_VALID) {
+			/* Interrupted write, skip it */
+			offset += RECORD_SIZE(hdr.len);
+			continue;
+		}
+
+		if (hdr.key == KEY_CLEAR) {
+			index_remove_addr(&hdr.addr);
+			offset += RECORD_SIZE(hdr.len);
+			continue;
+		}
+
+		entry = index_find(&hdr.addr, hdr.key);
+		if (!entry) {
+			entry = index_alloc();
+		}
+
+		if (entry) {
+			bt_addr_le_copy(&entry->addr, &hdr.addr);
+			entry->key = hdr.key;
+			entry->len = hdr.len;
+			entry->offset = offset;
+		} else {
+			BT_WARN("No index entry for key 0x%04x", hdr.key);
+		}
+
+		offset += RECORD_SIZE(hdr.len);
+	}
+
+	write_offset = offset;
+}
+
+static int storage_init(struct device *unused)
+{
+	static const struct bt_storage storage = {
+		.read  = storage_read,
+		.write = storage_write,
+		.clear = storage_clear
+	};
+	struct sector_hdr hdr[2];
+	bool valid[2];
+	int err;
+
+	flash_dev = device_get_binding(CONFIG_BLUETOOTH_STORAGE_FLASH_DEV_NAME);
+	if (!flash_dev) {
+		BT_ERR("No flash device %s",
+		       CONFIG_BLUETOOTH_STORAGE_FLASH_DEV_NAME);
+		return -ENODEV;
+	}
+
+	index_reset();
+
+	valid[0] = !sector_hdr_read(0, &hdr[0]);
+	valid[1] = !sector_hdr_read(1, &hdr[1]);
+
+	if (valid[0] && valid[1]) {
+		/* The one written by the last compaction is active */
+		active = (int32_t)(hdr[1].seq - hdr[0].seq) > 0;
+	} else if (valid[0] || valid[1]) {
+		active = valid[1];
+	} else {
+		BT_WARN("No storage sector found, formatting");
+
+		active = 0;
+		err = sector_erase(0, 0);
+		if (err) {
+			BT_ERR("Unable to format storage (err %d)", err);
+			return err;
+		}
+
+		hdr[0].seq = 0;
+	}
+
+	active_seq = hdr[active].seq;
+
+	log_replay();
+
+	BT_DBG("Sector %u seq %u, %u bytes used", active, active_seq,
+	       write_offset);
+
+	cache_init();
+
+	bt_storage_register(&storage);
+
+	return 0;
+}
+
+SYS_INIT(storage_init, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
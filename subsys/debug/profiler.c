@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Function profiler
+ *
+ * The -finstrument-functions hooks keep a shadow call stack per thread,
+ * and one for interrupts since those nest, holding the entry timestamp of
+ * each function and the cycles spent in its children. On exit, the call is
+ * accounted in an open addressing hash table keyed by function address.
+ * Hooks run with interrupts locked and must not call instrumented code:
+ * this file, the kernel and the timer drivers are excluded from the
+ * instrumentation by CONFIG_PROFILER_EXCLUDE.
+ */
+
+#include <kernel.h>
+#include <errno.h>
+#include <string.h>
+#include <debug/profiler.h>
+
+#define __no_instrument __attribute__((no_instrument_function))
+
+#define PROF_FUNCTIONS (1 << CONFIG_PROFILER_FUNCTIONS_POW2)
+
+/* Owner of the call stack used by interrupts */
+#define PROF_ISR ((void *)1)
+
+struct prof_frame {
+	void *fn;
+	uint32_t start;
+	uint32_t children;
+};
+
+struct prof_stack {
+	void *owner;
+	/* Calls not pushed because the stack was full */
+	uint32_t overflow;
+	uint8_t depth;
+	struct prof_frame frames[CONFIG_PROFILER_STACK_DEPTH];
+};
+
+static struct profiler_func prof_funcs[PROF_FUNCTIONS];
+static struct prof_stack prof_stacks[CONFIG_PROFILER_STACKS];
+static uint32_t prof_missed;
+static int prof_enabled = IS_ENABLED(CONFIG_PROFILER_AUTOSTART);
+
+void __cyg_profile_func_enter(void *fn, void *call_site) __no_instrument;
+void __cyg_profile_func_exit(void *fn, void *call_site) __no_instrument;
+
+static __no_instrument struct prof_stack *prof_stack_get(int create)
+{
+	void *owner = k_is_in_isr() ? PROF_ISR : k_current_get();
+	struct prof_stack *unused = NULL;
+	int i;
+
+	for (i = 0; i < CONFIG_PROFILER_STACKS; i++) {
+		if (prof_stacks[i].owner == owner) {
+			return &prof_stacks[i];
+		}
+
+		/* Empty stacks are free to take, even from another owner */
+		if (!unused && !prof_stacks[i].depth &&
+		    !prof_stacks[i].overflow) {
+			unused = &prof_stacks[i];
+		}
+	}
+
+	if (create && unused) {
+		unused->owner = owner;
+	}
+
+	return create ? unused : NULL;
+}
+
+static __no_instrument void prof_account(void *fn, uint32_t inclusive,
+					 uint32_t exclusive)
+{
+	unsigned int i, n;
+
+	i = ((uint32_t)(uintptr_t)fn * 2654435761u) >>
+		(32 - CONFIG_PROFILER_FUNCTIONS_POW2);
+
+	for (n = 0; n < PROF_FUNCTIONS; n++) {
+		struct profiler_func *func = &prof_funcs[i];
+
+		if (!func->fn) {
+			func->fn = fn;
+		}
+
+		if (func->fn == fn) {
+			func->calls++;
+			func->inclusive += inclusive;
+			func->exclusive += exclusive;
+			return;
+		}
+
+		i = (i + 1) & (PROF_FUNCTIONS - 1);
+	}
+
+	prof_missed++;
+}
+
+void __cyg_profile_func_enter(void *fn, void *call_site)
+{
+	struct prof_stack *stack;
+	struct prof_frame *frame;
+	unsigned int key;
+
+	ARG_UNUSED(call_site);
+
+	if (!prof_enabled) {
+		return;
+	}
+
+	key = irq_lock();
+
+	stack = prof_stack_get(1);
+	if (!stack) {
+		prof_missed++;
+	} else if (stack->depth == CONFIG_PROFILER_STACK_DEPTH) {
+		stack->overflow++;
+		prof_missed++;
+	} else {
+		frame = &stack->frames[stack->depth++];
+		frame->fn = fn;
+		frame->children = 0;
+		frame->start = k_cycle_get_32();
+	}
+
+	irq_unlock(key);
+}
+
+void __cyg_profile_func_exit(void *fn, void *call_site)
+{
+	uint32_t now = k_cycle_get_32();
+	struct prof_stack *stack;
+	struct prof_frame *frame;
+	uint32_t inclusive;
+	unsigned int key;
+
+	ARG_UNUSED(call_site);
+
+	key = irq_lock();
+
+	stack = prof_stack_get(0);
+	if (!stack) {
+		goto out;
+	}
+
+	if (stack->overflow) {
+		stack->overflow--;
+		goto out;
+	}
+
+	/* Calls entered before accounting started are not on the stack */
+	if (!stack->depth || stack->frames[stack->depth - 1].fn != fn) {
+		goto out;
+	}
+
+	frame = &stack->frames[--stack->depth];
+	inclusive = now - frame->start;
+
+	if (stack->depth) {
+		stack->frames[stack->depth - 1].children += inclusive;
+	}
+
+	if (prof_enabled) {
+		prof_account(fn, inclusive, inclusive - frame->children);
+	}
+
+out:
+	irq_unlock(key);
+}
+
+int profiler_get(unsigned int index, struct profiler_func *func)
+{
+	unsigned int key;
+	int i;
+
+	for (i = 0; i < PROF_FUNCTIONS; i++) {
+		if (!prof_funcs[i].fn) {
+			continue;
+		}
+
+		if (!index--) {
+			key = irq_lock();
+			*func = prof_funcs[i];
+			irq_unlock(key);
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
+uint32_t profiler_missed_get(void)
+{
+	return prof_missed;
+}
+
+void profiler_enable(int enable)
+{
+	prof_enabled = enable;
+}
+
+void profiler_reset(void)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	memset(prof_funcs, 0, sizeof(prof_funcs));
+	memset(prof_stacks, 0, sizeof(prof_stacks));
+	prof_missed = 0;
+	irq_unlock(key);
+}
+
+#if defined(CONFIG_PROFILER_SHELL)
+#include <stdlib.h>
+#include <misc/printk.h>
+#include <shell/shell.h>
+
+#if defined(CONFIG_RTT_BACKEND) && CONFIG_RTT_BACKEND_DATA_BUFFER_SIZE > 0
+#include <logging/rtt_backend.h>
+#define PROF_RTT 1
+#endif
+
+/* printk() has no 64 bit conversions */
+static uint32_t cycles_to_us(uint64_t cycles)
+{
+	return (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) / NSEC_PER_USEC);
+}
+
+static int shell_cmd_start(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	profiler_enable(1);
+
+	return 0;
+}
+
+static int shell_cmd_stop(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	profiler_enable(0);
+
+	return 0;
+}
+
+static int shell_cmd_reset(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	profiler_reset();
+
+	return 0;
+}
+
+static int shell_cmd_show(int argc, char *argv[])
+{
+	struct profiler_func *func, *top, *last = NULL;
+	int count = 10;
+	int i;
+
+	if (argc > 1) {
+		count = atoi(argv[1]);
+	}
+
+	printk("Function\tCalls\tInclusive\tExclusive (us)\n");
+
+	/* Highest exclusive cycles first, without sorting in place */
+	while (count--) {
+		top = NULL;
+
+		for (i = 0; i < PROF_FUNCTIONS; i++) {
+			func = &prof_funcs[i];
+			if (!func->fn) {
+				continue;
+			}
+
+			/* Table order breaks ties */
+			if (last && (func->exclusive > last->exclusive ||
+				     (func->exclusive == last->exclusive &&
+				      func <= last))) {
+				continue;
+			}
+
+			if (!top || func->exclusive > top->exclusive) {
+				top = func;
+			}
+		}
+
+		if (!top) {
+			break;
+		}
+
+		printk("%p\t%u\t%u\t%u\n", top->fn, top->calls,
+		       cycles_to_us(top->inclusive),
+		       cycles_to_us(top->exclusive));
+		last = top;
+	}
+
+	printk("Missed calls: %u\n", profiler_missed_get());
+
+	return 0;
+}
+
+static void prof_dump_line(const char *line, int len, int rtt)
+{
+#if defined(PROF_RTT)
+	if (rtt) {
+		rtt_backend_write(RTT_BACKEND_DATA, line, len);
+		return;
+	}
+#endif
+	printk("%s", line);
+}
+
+static int shell_cmd_dump(int argc, char *argv[])
+{
+	struct profiler_func func;
+	int rtt = argc > 1 && !strcmp(argv[1], "rtt");
+	char line[64];
+	unsigned int i;
+	int len;
+
+	/* Lines parsed by scripts/profiler_report.py */
+	for (i = 0; !profiler_get(i, &func); i++) {
+		len = snprintk(line, sizeof(line),
+			       "PROF: %p %u %08x%08x %08x%08x\n", func.fn,
+			       func.calls, (uint32_t)(func.inclusive >> 32),
+			       (uint32_t)func.inclusive,
+			       (uint32_t)(func.exclusive >> 32),
+			       (uint32_t)func.exclusive);
+		prof_dump_line(line, len, rtt);
+	}
+
+	len = snprintk(line, sizeof(line), "PROF: missed %u\n",
+		       profiler_missed_get());
+	prof_dump_line(line, len, rtt);
+
+	return 0;
+}
+
+static struct shell_cmd prof_commands[] = {
+	{ "start", shell_cmd_start, "Start accounting" },
+	{ "stop", shell_cmd_stop, "Stop accounting" },
+	{ "reset", shell_cmd_reset, "Clear the statistics" },
+	{ "show", shell_cmd_show,
+	  "List the functions taking the most exclusive cycles: [<count>]" },
+#if defined(PROF_RTT)
+	{ "dump", shell_cmd_dump,
+	  "Dump all functions for profiler_report.py, to RTT: [rtt]" },
+#else
+	{ "dump", shell_cmd_dump,
+	  "Dump all functions for profiler_report.py" },
+#endif
+	{ NULL, NULL, NULL }
+};
+
+SHELL_REGISTER("prof", prof_commands);
+#endif /* CONFIG_PROFILER_SHELL */
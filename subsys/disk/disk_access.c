@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <kernel.h>
+#include <init.h>
+#include <misc/util.h>
+#include <disk_access.h>
+#include <errno.h>
+
+static sys_slist_t disks;
+static struct disk_info *default_disk;
+
+#ifdef CONFIG_DISK_ACCESS_ASYNC
+static char __stack disk_work_q_stack[CONFIG_DISK_ACCESS_THREAD_STACK_SIZE];
+static struct k_work_q disk_work_q;
+#endif
+
+struct disk_info *disk_access_get(const char *name)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&disks, node) {
+		struct disk_info *disk = CONTAINER_OF(node, struct disk_info,
+						      node);
+
+		if (!strcmp(disk->name, name)) {
+			return disk;
+		}
+	}
+
+	return NULL;
+}
+
+int disk_access_dev_init(struct disk_info *disk)
+{
+	int ret;
+
+	k_mutex_lock(&disk->lock, K_FOREVER);
+	ret = disk->ops->init(disk);
+	k_mutex_unlock(&disk->lock);
+
+	return ret;
+}
+
+int disk_access_dev_status(struct disk_info *disk)
+{
+	int ret;
+
+	k_mutex_lock(&disk->lock, K_FOREVER);
+	ret = disk->ops->status(disk);
+	k_mutex_unlock(&disk->lock);
+
+	return ret;
+}
+
+int disk_access_dev_read(struct disk_info *disk, uint8_t *data_buf,
+			 uint32_t start_sector, uint32_t num_sector)
+{
+	int ret;
+
+	k_mutex_lock(&disk->lock, K_FOREVER);
+	ret = disk->ops->read(disk, data_buf, start_sector, num_sector);
+	k_mutex_unlock(&disk->lock);
+
+	return ret;
+}
+
+int disk_access_dev_write(struct disk_info *disk, const uint8_t *data_buf,
+			  uint32_t start_sector, uint32_t num_sector)
+{
+	int ret;
+
+	k_mutex_lock(&disk->lock, K_FOREVER);
+	ret = disk->ops->write(disk, data_buf, start_sector, num_sector);
+	k_mutex_unlock(&disk->lock);
+
+	return ret;
+}
+
+int disk_access_dev_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
+{
+	int ret;
+
+	k_mutex_lock(&disk->lock, K_FOREVER);
+	ret = disk->ops->ioctl(disk, cmd, buff);
+	k_mutex_unlock(&disk->lock);
+
+	return ret;
+}
+
+#ifdef CONFIG_DISK_ACCESS_ASYNC
+/* Does next continue req, both on the disk and in memory? */
+static bool request_merges(struct disk_info *disk, struct disk_request *req,
+			   struct disk_request *next)
+{
+	return next->type == req->type && req->type != DISK_REQUEST_SYNC &&
+	       next->start_sector == req->start_sector + req->num_sector &&
+	       next->buf == req->buf + req->num_sector * disk->sector_size;
+}
+
+static int request_run(struct disk_info *disk, struct disk_request *req,
+		       uint32_t num_sector)
+{
+	switch (req->type) {
+	case DISK_REQUEST_READ:
+		return disk_access_dev_read(disk, req->buf, req->start_sector,
+					    num_sector);
+	case DISK_REQUEST_WRITE:
+		return disk_access_dev_write(disk, req->buf,
+					     req->start_sector, num_sector);
+	case DISK_REQUEST_SYNC:
+		return disk_access_dev_ioctl(disk, DISK_IOCTL_CTRL_SYNC, NULL);
+	default:
+		return -EINVAL;
+	}
+}
+
+static void disk_work_handler(struct k_work *work)
+{
+	struct disk_info *disk = CONTAINER_OF(work, struct disk_info, work);
+	struct disk_request *req, *last, *next;
+	sys_slist_t batch;
+	sys_snode_t *node;
+	uint32_t num_sector;
+	unsigned int key;
+	int ret;
+
+	for (;;) {
+		key = irq_lock();
+
+		node = sys_slist_get(&disk->queue);
+		if (!node) {
+			irq_unlock(key);
+			return;
+		}
+
+		/* Take the requests continuing this one along */
+		sys_slist_init(&batch);
+		sys_slist_append(&batch, node);
+		req = CONTAINER_OF(node, struct disk_request, node);
+		last = req;
+		num_sector = req->num_sector;
+
+		while ((node = sys_slist_peek_head(&disk->queue))) {
+			next = CONTAINER_OF(node, struct disk_request, node);
+			if (!request_merges(disk, last, next)) {
+				break;
+			}
+
+			sys_slist_get(&disk->queue);
+			sys_slist_append(&batch, node);
+			num_sector += next->num_sector;
+			last = next;
+		}
+
+		irq_unlock(key);
+
+		ret = request_run(disk, req, num_sector);
+
+		while ((node = sys_slist_get(&batch))) {
+			req = CONTAINER_OF(node, struct disk_request, node);
+			req->cb(req, ret);
+		}
+	}
+}
+
+int disk_access_dev_submit(struct disk_info *disk, struct disk_request *req)
+{
+	unsigned int key;
+
+	if (req->type > DISK_REQUEST_SYNC || !req->cb) {
+		return -EINVAL;
+	}
+
+	if (!disk->sector_size &&
+	    disk_access_dev_ioctl(disk, DISK_IOCTL_GET_SECTOR_SIZE,
+				  &disk->sector_size) != 0) {
+		return -EIO;
+	}
+
+	key = irq_lock();
+	sys_slist_append(&disk->queue, &req->node);
+	irq_unlock(key);
+
+	k_work_submit_to_queue(&disk_work_q, &disk->work);
+
+	return 0;
+}
+#endif /* CONFIG_DISK_ACCESS_ASYNC */
+
+int disk_access_register(struct disk_info *disk)
+{
+	unsigned int key;
+
+	if (disk_access_get(disk->name)) {
+		return -EEXIST;
+	}
+
+	k_mutex_init(&disk->lock);
+#ifdef CONFIG_DISK_ACCESS_ASYNC
+	sys_slist_init(&disk->queue);
+	k_work_init(&disk->work, disk_work_handler);
+	disk->sector_size = 0;
+#endif
+
+	key = irq_lock();
+	sys_slist_append(&disks, &disk->node);
+	irq_unlock(key);
+
+	return 0;
+}
+
+int disk_access_unregister(struct disk_info *disk)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+#ifdef CONFIG_DISK_ACCESS_ASYNC
+	if (!sys_slist_is_empty(&disk->queue)) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+#endif
+
+	sys_slist_find_and_remove(&disks, &disk->node);
+	if (default_disk == disk) {
+		default_disk = NULL;
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+static struct disk_info *default_disk_get(void)
+{
+	if (!default_disk) {
+		default_disk = disk_access_get(CONFIG_DISK_ACCESS_DEFAULT);
+	}
+
+	return default_disk;
+}
+
+int disk_access_init(void)
+{
+	struct disk_info *disk = default_disk_get();
+
+	if (!disk) {
+		return -ENODEV;
+	}
+
+	return disk_access_dev_init(disk);
+}
+
+int disk_access_status(void)
+{
+	struct disk_info *disk = default_disk_get();
+
+	if (!disk) {
+		return DISK_STATUS_NOMEDIA;
+	}
+
+	return disk_access_dev_status(disk);
+}
+
+int disk_access_read(uint8_t *data_buf, uint32_t start_sector,
+		     uint32_t num_sector)
+{
+	struct disk_info *disk = default_disk_get();
+
+	if (!disk) {
+		return -ENODEV;
+	}
+
+	return disk_access_dev_read(disk, data_buf, start_sector, num_sector);
+}
+
+int disk_access_write(const uint8_t *data_buf, uint32_t start_sector,
+		      uint32_t num_sector)
+{
+	struct disk_info *disk = default_disk_get();
+
+	if (!disk) {
+		return -ENODEV;
+	}
+
+	return disk_access_dev_write(disk, data_buf, start_sector, num_sector);
+}
+
+int disk_access_ioctl(uint8_t cmd, void *buff)
+{
+	struct disk_info *disk = default_disk_get();
+
+	if (!disk) {
+		return -ENODEV;
+	}
+
+	return disk_access_dev_ioctl(disk, cmd, buff);
+}
+
+#ifdef CONFIG_DISK_ACCESS_ASYNC
+static int disk_access_thread_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_work_q_start(&disk_work_q, disk_work_q_stack,
+		       sizeof(disk_work_q_stack),
+		       K_PRIO_PREEMPT(CONFIG_DISK_ACCESS_THREAD_PRIORITY));
+
+	return 0;
+}
+
+SYS_INIT(disk_access_thread_init, POST_KERNEL,
+	 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+#endif
@@ -9,6 +9,7 @@
 #include <misc/__assert.h>
 #include <misc/util.h>
 #include <disk_access.h>
+#include <init.h>
 #include <errno.h>
 #include <device.h>
 #include <flash.h>
@@ -40,7 +41,7 @@ static off_t lba_to_address(uint32_t sector_num)
 	return flash_addr;
 }
 
-int disk_access_status(void)
+static int disk_flash_status(struct disk_info *disk)
 {
 	if (!flash_dev) {
 		return DISK_STATUS_NOMEDIA;
@@ -49,22 +50,59 @@ int disk_access_status(void)
 	return DISK_STATUS_OK;
 }
 
-int disk_access_init(void)
+/* Check the flash geometry against the disk configuration */
+static int flash_geometry_check(struct device *dev)
 {
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	struct flash_pages_info info;
+	off_t offset = CONFIG_DISK_FLASH_START;
+
+	/* Erase blocks must be made of whole erase pages */
+	while (offset < CONFIG_DISK_FLASH_START + CONFIG_DISK_VOLUME_SIZE) {
+		if (flash_get_page_info_by_offs(dev, offset, &info) != 0) {
+			/* layout unknown or volume beyond the flash end */
+			break;
+		}
+
+		if (CONFIG_DISK_ERASE_BLOCK_SIZE % info.size) {
+			return -EINVAL;
+		}
+
+		offset = info.start_offset + info.size;
+	}
+#endif
+
+	if (CONFIG_DISK_FLASH_MAX_RW_SIZE % flash_get_write_block_size(dev)) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int disk_flash_init(struct disk_info *disk)
+{
+	struct device *dev;
+
 	if (flash_dev) {
 		return 0;
 	}
 
-	flash_dev = device_get_binding(CONFIG_DISK_FLASH_DEV_NAME);
-	if (!flash_dev) {
+	dev = device_get_binding(CONFIG_DISK_FLASH_DEV_NAME);
+	if (!dev) {
 		return -ENODEV;
 	}
 
+	if (flash_geometry_check(dev) != 0) {
+		return -EINVAL;
+	}
+
+	flash_dev = dev;
+
 	return 0;
 }
 
-int disk_access_read(uint8_t *buff, uint32_t start_sector,
-		     uint32_t sector_count)
+static int disk_flash_read(struct disk_info *disk, uint8_t *buff,
+			   uint32_t start_sector, uint32_t sector_count)
 {
 	off_t fl_addr;
 	uint32_t remaining;
@@ -185,8 +223,8 @@ static int update_flash_block(off_t start_addr, uint32_t size, const void *buff)
 	return 0;
 }
 
-int disk_access_write(const uint8_t *buff, uint32_t start_sector,
-		      uint32_t sector_count)
+static int disk_flash_write(struct disk_info *disk, const uint8_t *buff,
+			    uint32_t start_sector, uint32_t sector_count)
 {
 	off_t fl_addr;
 	uint32_t remaining;
@@ -254,7 +292,7 @@ int disk_access_write(const uint8_t *buff, uint32_t start_sector,
 	return 0;
 }
 
-int disk_access_ioctl(uint8_t cmd, void *buff)
+static int disk_flash_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
 {
 	switch (cmd) {
 	case DISK_IOCTL_CTRL_SYNC:
@@ -277,3 +315,25 @@ int disk_access_ioctl(uint8_t cmd, void *buff)
 
 	return -EINVAL;
 }
+
+static const struct disk_operations disk_flash_ops = {
+	.init = disk_flash_init,
+	.status = disk_flash_status,
+	.read = disk_flash_read,
+	.write = disk_flash_write,
+	.ioctl = disk_flash_ioctl,
+};
+
+static struct disk_info disk_flash_disk = {
+	.name = "FLASH",
+	.ops = &disk_flash_ops,
+};
+
+static int disk_flash_register(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return disk_access_register(&disk_flash_disk);
+}
+
+SYS_INIT(disk_flash_register, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,806 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Flash disk backend going through a flash translation layer
+ *
+ * Sectors are never rewritten in place: every write goes to the next free
+ * slot of the active erase block and the sector map is updated, the
+ * previous copy becoming garbage. Blocks are reclaimed by moving their
+ * live sectors away and erasing them, so an erase is only needed every
+ * few sector writes rather than for each of them.
+ *
+ * The first sector sized slot of each erase block holds the block header
+ * followed by one entry per data slot, programmed once the slot is
+ * written. The entries carry a sequence number, the newest copy of a
+ * sector being the one with the highest, which lets the map be rebuilt
+ * at init.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <misc/util.h>
+#include <disk_access.h>
+#include <init.h>
+#include <errno.h>
+#include <device.h>
+#include <flash.h>
+
+#define SECTOR_SIZE 512
+
+#define BLOCK_SIZE CONFIG_DISK_ERASE_BLOCK_SIZE
+#define BLOCK_COUNT (CONFIG_DISK_VOLUME_SIZE / BLOCK_SIZE)
+/* data slots per block, the first one holding the block metadata */
+#define BLOCK_SLOTS (BLOCK_SIZE / SECTOR_SIZE - 1)
+
+#define LOGICAL_SECTORS \
+	((BLOCK_COUNT - CONFIG_DISK_FLASH_FTL_SPARE_BLOCKS) * BLOCK_SLOTS)
+
+#define FTL_MAGIC 0x314c5446
+#define ERASED 0xffffffff
+#define NO_SLOT 0xffff
+#define NO_BLOCK 0xffff
+
+/* The last field is programmed last, a write torn by a power loss
+ * leaves it incomplete.
+ */
+struct ftl_header {
+	uint32_t erase_count;
+	uint32_t magic;
+};
+
+struct ftl_entry {
+	uint32_t seq;
+	uint16_t lsn;
+	uint16_t check;
+};
+
+BUILD_ASSERT(BLOCK_SLOTS >= 1);
+BUILD_ASSERT(sizeof(struct ftl_header) +
+	     BLOCK_SLOTS * sizeof(struct ftl_entry) <= SECTOR_SIZE);
+BUILD_ASSERT(BLOCK_COUNT * BLOCK_SLOTS < NO_SLOT);
+BUILD_ASSERT(LOGICAL_SECTORS < NO_SLOT);
+BUILD_ASSERT(BLOCK_COUNT > CONFIG_DISK_FLASH_FTL_SPARE_BLOCKS);
+
+static struct device *flash_dev;
+
+/* physical slot of each logical sector */
+static uint16_t map[LOGICAL_SECTORS];
+
+static uint32_t erase_count[BLOCK_COUNT];
+/* next data slot to be written */
+static uint8_t wp[BLOCK_COUNT];
+/* number of data slots holding the current copy of a sector */
+static uint8_t valid[BLOCK_COUNT];
+
+static uint16_t active = NO_BLOCK;
+static uint16_t free_blocks;
+static uint32_t seq;
+
+static uint8_t gc_buf[SECTOR_SIZE];
+
+struct cache_entry {
+	uint32_t lsn;
+	uint32_t age;
+	bool dirty;
+	uint8_t data[SECTOR_SIZE];
+};
+
+static struct cache_entry cache[CONFIG_DISK_FLASH_FTL_CACHE_SECTORS];
+static uint32_t cache_age;
+
+static off_t block_addr(uint16_t block)
+{
+	return CONFIG_DISK_FLASH_START + (off_t)block * BLOCK_SIZE;
+}
+
+static off_t slot_addr(uint16_t phys)
+{
+	return block_addr(phys / BLOCK_SLOTS) +
+	       (phys % BLOCK_SLOTS + 1) * SECTOR_SIZE;
+}
+
+static off_t entry_addr(uint16_t phys)
+{
+	return block_addr(phys / BLOCK_SLOTS) + sizeof(struct ftl_header) +
+	       (phys % BLOCK_SLOTS) * sizeof(struct ftl_entry);
+}
+
+static int ftl_read(off_t addr, void *buf, size_t len)
+{
+	uint8_t *dst = buf;
+
+	while (len) {
+		size_t chunk = min(len, CONFIG_DISK_FLASH_MAX_RW_SIZE);
+
+		if (flash_read(flash_dev, addr, dst, chunk) != 0) {
+			return -EIO;
+		}
+
+		addr += chunk;
+		dst += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+static int ftl_write(off_t addr, const void *buf, size_t len)
+{
+	const uint8_t *src = buf;
+
+	while (len) {
+		size_t chunk = min(len, CONFIG_DISK_FLASH_MAX_RW_SIZE);
+
+		/* flash_write may reenable write-protection */
+		flash_write_protection_set(flash_dev, false);
+
+		if (flash_write(flash_dev, addr, src, chunk) != 0) {
+			return -EIO;
+		}
+
+		addr += chunk;
+		src += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+static int header_write(uint16_t block)
+{
+	struct ftl_header hdr = {
+		.magic = FTL_MAGIC,
+		.erase_count = erase_count[block],
+	};
+
+	return ftl_write(block_addr(block), &hdr, sizeof(hdr));
+}
+
+static int block_erase(uint16_t block)
+{
+	flash_write_protection_set(flash_dev, false);
+	if (flash_erase(flash_dev, block_addr(block), BLOCK_SIZE) != 0) {
+		return -EIO;
+	}
+
+	erase_count[block]++;
+	wp[block] = 0;
+	valid[block] = 0;
+	free_blocks++;
+
+	return header_write(block);
+}
+
+static uint16_t entry_check(const struct ftl_entry *entry)
+{
+	return ~(entry->lsn ^ (entry->seq & 0xffff) ^ (entry->seq >> 16));
+}
+
+static void map_set(uint32_t lsn, uint16_t phys)
+{
+	uint16_t old = map[lsn];
+
+	if (old != NO_SLOT) {
+		valid[old / BLOCK_SLOTS]--;
+	}
+
+	map[lsn] = phys;
+	valid[phys / BLOCK_SLOTS]++;
+}
+
+/* Free block erased the least, for the erases to spread evenly */
+static uint16_t free_block_take(void)
+{
+	uint16_t best = NO_BLOCK;
+	uint16_t b;
+
+	for (b = 0; b < BLOCK_COUNT; b++) {
+		if (wp[b] || b == active) {
+			continue;
+		}
+
+		if (best == NO_BLOCK || erase_count[b] < erase_count[best]) {
+			best = b;
+		}
+	}
+
+	if (best != NO_BLOCK) {
+		free_blocks--;
+	}
+
+	return best;
+}
+
+static int sector_store(uint32_t lsn, const uint8_t *data)
+{
+	struct ftl_entry entry;
+	uint16_t phys;
+
+	if (active == NO_BLOCK || wp[active] == BLOCK_SLOTS) {
+		active = free_block_take();
+		if (active == NO_BLOCK) {
+			return -ENOSPC;
+		}
+	}
+
+	phys = active * BLOCK_SLOTS + wp[active]++;
+
+	/* the entry last, so that it never points to partial data */
+	if (ftl_write(slot_addr(phys), data, SECTOR_SIZE) != 0) {
+		return -EIO;
+	}
+
+	entry.lsn = lsn;
+	entry.seq = seq++;
+	entry.check = entry_check(&entry);
+	if (ftl_write(entry_addr(phys), &entry, sizeof(entry)) != 0) {
+		return -EIO;
+	}
+
+	map_set(lsn, phys);
+
+	return 0;
+}
+
+/* Move the live sectors of a block away and erase it */
+static int block_collect(uint16_t block)
+{
+	struct ftl_entry entry;
+	uint16_t phys;
+	uint8_t i;
+
+	for (i = 0; i < wp[block]; i++) {
+		phys = block * BLOCK_SLOTS + i;
+
+		if (ftl_read(entry_addr(phys), &entry, sizeof(entry)) != 0) {
+			return -EIO;
+		}
+
+		if (entry.lsn >= LOGICAL_SECTORS || map[entry.lsn] != phys) {
+			continue;
+		}
+
+		if (ftl_read(slot_addr(phys), gc_buf, SECTOR_SIZE) != 0 ||
+		    sector_store(entry.lsn, gc_buf) != 0) {
+			return -EIO;
+		}
+	}
+
+	return block_erase(block);
+}
+
+/* Used block with the fewest live sectors, or erased the least if cold */
+static uint16_t victim_find(bool cold)
+{
+	uint16_t best = NO_BLOCK;
+	uint16_t b;
+
+	for (b = 0; b < BLOCK_COUNT; b++) {
+		if (!wp[b] || b == active) {
+			continue;
+		}
+
+		if (best == NO_BLOCK) {
+			best = b;
+		} else if (cold) {
+			if (erase_count[b] < erase_count[best]) {
+				best = b;
+			}
+		} else if (valid[b] < valid[best] ||
+			   (valid[b] == valid[best] &&
+			    erase_count[b] < erase_count[best])) {
+			best = b;
+		}
+	}
+
+	if (!cold && best != NO_BLOCK && valid[best] == BLOCK_SLOTS) {
+		/* nothing would be reclaimed */
+		return NO_BLOCK;
+	}
+
+	return best;
+}
+
+/* Move the data of the block erased the least, if it lags too far behind
+ * the most erased one: it holds data that is never rewritten, so it
+ * wouldn't be collected otherwise.
+ */
+static int wear_level(void)
+{
+	uint32_t most = 0;
+	uint16_t cold;
+	uint16_t b;
+
+	/* only when there is room to spare */
+	if (free_blocks < 2) {
+		return 0;
+	}
+
+	cold = victim_find(true);
+	if (cold == NO_BLOCK) {
+		return 0;
+	}
+
+	for (b = 0; b < BLOCK_COUNT; b++) {
+		most = max(most, erase_count[b]);
+	}
+
+	if (most - erase_count[cold] <= CONFIG_DISK_FLASH_FTL_WEAR_THRESHOLD) {
+		return 0;
+	}
+
+	return block_collect(cold);
+}
+
+static int sector_write(uint32_t lsn, const uint8_t *data)
+{
+	bool collected = false;
+	uint16_t victim;
+	int rc;
+
+	/* One free block is always kept for the collection to move the
+	 * live sectors of its victim to.
+	 */
+	while ((active == NO_BLOCK || wp[active] == BLOCK_SLOTS) &&
+	       free_blocks < 2) {
+		victim = victim_find(false);
+		if (victim == NO_BLOCK) {
+			return -ENOSPC;
+		}
+
+		rc = block_collect(victim);
+		if (rc) {
+			return rc;
+		}
+
+		collected = true;
+	}
+
+	rc = sector_store(lsn, data);
+	if (!rc && collected) {
+		rc = wear_level();
+	}
+
+	return rc;
+}
+
+static int sector_read(uint32_t lsn, uint8_t *data)
+{
+	if (map[lsn] == NO_SLOT) {
+		/* never written, reads as erased flash */
+		memset(data, 0xff, SECTOR_SIZE);
+		return 0;
+	}
+
+	return ftl_read(slot_addr(map[lsn]), data, SECTOR_SIZE);
+}
+
+static int cache_flush(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (!cache[i].dirty) {
+			continue;
+		}
+
+		if (sector_write(cache[i].lsn, cache[i].data) != 0) {
+			return -EIO;
+		}
+
+		cache[i].dirty = false;
+	}
+
+	return 0;
+}
+
+static struct cache_entry *cache_find(uint32_t lsn)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].lsn == lsn) {
+			return &cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Least recently used entry, written back first if dirty */
+static struct cache_entry *cache_evict(void)
+{
+	struct cache_entry *entry = &cache[0];
+	int i;
+
+	for (i = 1; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].age < entry->age) {
+			entry = &cache[i];
+		}
+	}
+
+	if (entry->dirty) {
+		if (sector_write(entry->lsn, entry->data) != 0) {
+			return NULL;
+		}
+
+		entry->dirty = false;
+	}
+
+	return entry;
+}
+
+static int entry_seq_get(uint16_t phys, uint32_t *entry_seq)
+{
+	struct ftl_entry entry;
+
+	if (ftl_read(entry_addr(phys), &entry, sizeof(entry)) != 0) {
+		return -EIO;
+	}
+
+	*entry_seq = entry.seq;
+
+	return 0;
+}
+
+static bool slot_is_erased(uint16_t phys)
+{
+	int i;
+
+	if (ftl_read(slot_addr(phys), gc_buf, SECTOR_SIZE) != 0) {
+		return false;
+	}
+
+	for (i = 0; i < SECTOR_SIZE; i++) {
+		if (gc_buf[i] != 0xff) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int block_scan(uint16_t block, uint32_t *max_seq, uint16_t *newest)
+{
+	struct ftl_entry entry;
+	uint32_t old_seq;
+	uint16_t phys;
+	uint8_t i;
+
+	wp[block] = 0;
+
+	for (i = 0; i < BLOCK_SLOTS; i++) {
+		phys = block * BLOCK_SLOTS + i;
+
+		if (ftl_read(entry_addr(phys), &entry, sizeof(entry)) != 0) {
+			return -EIO;
+		}
+
+		if (entry.seq == ERASED && entry.lsn == NO_SLOT &&
+		    entry.check == 0xffff) {
+			continue;
+		}
+
+		/* slots skipped after a power loss leave holes */
+		wp[block] = i + 1;
+
+		if (entry.check != entry_check(&entry)) {
+			/* torn write, the slot is garbage */
+			continue;
+		}
+
+		if (*newest == NO_BLOCK || entry.seq >= *max_seq) {
+			*max_seq = entry.seq;
+			*newest = block;
+		}
+
+		if (entry.lsn >= LOGICAL_SECTORS) {
+			continue;
+		}
+
+		if (map[entry.lsn] != NO_SLOT) {
+			if (entry_seq_get(map[entry.lsn], &old_seq) != 0) {
+				return -EIO;
+			}
+
+			if (old_seq > entry.seq) {
+				continue;
+			}
+		}
+
+		map_set(entry.lsn, phys);
+	}
+
+	/* A slot whose entry is missing may still have been partially
+	 * written when power was lost, it can't be used anymore.
+	 */
+	while (wp[block] < BLOCK_SLOTS &&
+	       !slot_is_erased(block * BLOCK_SLOTS + wp[block])) {
+		wp[block]++;
+	}
+
+	return 0;
+}
+
+static int ftl_format(void)
+{
+	uint16_t b;
+
+	flash_write_protection_set(flash_dev, false);
+	if (flash_erase(flash_dev, CONFIG_DISK_FLASH_START,
+			BLOCK_COUNT * BLOCK_SIZE) != 0) {
+		return -EIO;
+	}
+
+	for (b = 0; b < BLOCK_COUNT; b++) {
+		erase_count[b] = 1;
+		wp[b] = 0;
+		valid[b] = 0;
+
+		if (header_write(b) != 0) {
+			return -EIO;
+		}
+	}
+
+	free_blocks = BLOCK_COUNT;
+
+	return 0;
+}
+
+static int ftl_mount(void)
+{
+	struct ftl_header hdr;
+	uint32_t max_seq = 0;
+	uint32_t max_erase = 0;
+	uint16_t newest = NO_BLOCK;
+	bool formatted = false;
+	uint16_t b;
+
+	memset(map, 0xff, sizeof(map));
+	memset(valid, 0, sizeof(valid));
+	active = NO_BLOCK;
+	free_blocks = 0;
+	seq = 0;
+
+	for (b = 0; b < BLOCK_COUNT; b++) {
+		if (ftl_read(block_addr(b), &hdr, sizeof(hdr)) != 0) {
+			return -EIO;
+		}
+
+		if (hdr.magic != FTL_MAGIC) {
+			/* erased once the others are known */
+			erase_count[b] = ERASED;
+			continue;
+		}
+
+		formatted = true;
+		erase_count[b] = hdr.erase_count;
+		max_erase = max(max_erase, hdr.erase_count);
+
+		if (block_scan(b, &max_seq, &newest) != 0) {
+			return -EIO;
+		}
+	}
+
+	if (!formatted) {
+		return ftl_format();
+	}
+
+	for (b = 0; b < BLOCK_COUNT; b++) {
+		if (erase_count[b] != ERASED) {
+			continue;
+		}
+
+		/* interrupted erase, or not written by the FTL */
+		erase_count[b] = max_erase;
+		if (block_erase(b) != 0) {
+			return -EIO;
+		}
+	}
+
+	if (newest != NO_BLOCK) {
+		seq = max_seq + 1;
+
+		if (wp[newest] < BLOCK_SLOTS) {
+			active = newest;
+		}
+	}
+
+	free_blocks = 0;
+	for (b = 0; b < BLOCK_COUNT; b++) {
+		if (!wp[b] && b != active) {
+			free_blocks++;
+		}
+	}
+
+	return 0;
+}
+
+static int disk_flash_status(struct disk_info *disk)
+{
+	if (!flash_dev) {
+		return DISK_STATUS_NOMEDIA;
+	}
+
+	return DISK_STATUS_OK;
+}
+
+static int disk_flash_init(struct disk_info *disk)
+{
+	int i;
+
+	if (flash_dev) {
+		return 0;
+	}
+
+	flash_dev = device_get_binding(CONFIG_DISK_FLASH_DEV_NAME);
+	if (!flash_dev) {
+		return -ENODEV;
+	}
+
+	/* entries and headers are written on their own */
+	if (sizeof(struct ftl_entry) % flash_get_write_block_size(flash_dev) ||
+	    CONFIG_DISK_FLASH_MAX_RW_SIZE %
+	    flash_get_write_block_size(flash_dev)) {
+		flash_dev = NULL;
+		return -EINVAL;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(cache); i++) {
+		cache[i].lsn = ERASED;
+		cache[i].age = 0;
+		cache[i].dirty = false;
+	}
+
+	if (ftl_mount() != 0) {
+		flash_dev = NULL;
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/* Number of uncached sectors from lsn on held by consecutive slots of
+ * the same block, at least 1.
+ */
+static uint32_t sector_run(uint32_t lsn, uint32_t count)
+{
+	uint16_t phys = map[lsn];
+	uint32_t run = 1;
+
+	if (phys == NO_SLOT) {
+		return 1;
+	}
+
+	while (run < count && map[lsn + run] == phys + run &&
+	       (phys + run) % BLOCK_SLOTS != 0 && !cache_find(lsn + run)) {
+		run++;
+	}
+
+	return run;
+}
+
+static int disk_flash_read(struct disk_info *disk, uint8_t *buff,
+			   uint32_t start_sector, uint32_t sector_count)
+{
+	struct cache_entry *entry;
+	uint32_t lsn, run;
+
+	if (start_sector + sector_count > LOGICAL_SECTORS) {
+		return -EIO;
+	}
+
+	lsn = start_sector;
+	while (lsn < start_sector + sector_count) {
+		entry = cache_find(lsn);
+		if (entry) {
+			memcpy(buff, entry->data, SECTOR_SIZE);
+			lsn++;
+			buff += SECTOR_SIZE;
+			continue;
+		}
+
+		run = sector_run(lsn, start_sector + sector_count - lsn);
+		if (run > 1) {
+			/* sectors written one after the other lie in a row */
+			if (ftl_read(slot_addr(map[lsn]), buff,
+				     run * SECTOR_SIZE) != 0) {
+				return -EIO;
+			}
+		} else if (sector_read(lsn, buff) != 0) {
+			return -EIO;
+		}
+
+		lsn += run;
+		buff += run * SECTOR_SIZE;
+	}
+
+	return 0;
+}
+
+static int disk_flash_write(struct disk_info *disk, const uint8_t *buff,
+			    uint32_t start_sector, uint32_t sector_count)
+{
+	struct cache_entry *entry;
+	uint32_t lsn;
+
+	if (start_sector + sector_count > LOGICAL_SECTORS) {
+		return -EIO;
+	}
+
+	/* Written back on eviction or sync only, so that the sectors
+	 * updated over and over, like the FAT ones, only hit the flash
+	 * once in a while.
+	 */
+	for (lsn = start_sector; lsn < start_sector + sector_count; lsn++) {
+		entry = cache_find(lsn);
+		if (!entry) {
+			entry = cache_evict();
+			if (!entry) {
+				return -EIO;
+			}
+
+			entry->lsn = lsn;
+		}
+
+		memcpy(entry->data, buff, SECTOR_SIZE);
+		entry->dirty = true;
+		entry->age = ++cache_age;
+
+		buff += SECTOR_SIZE;
+	}
+
+	return 0;
+}
+
+static int disk_flash_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
+{
+	switch (cmd) {
+	case DISK_IOCTL_CTRL_SYNC:
+		return cache_flush();
+	case DISK_IOCTL_GET_SECTOR_COUNT:
+		*(uint32_t *)buff = LOGICAL_SECTORS;
+		return 0;
+	case DISK_IOCTL_GET_SECTOR_SIZE:
+		*(uint32_t *) buff = SECTOR_SIZE;
+		return 0;
+	case DISK_IOCTL_GET_ERASE_BLOCK_SZ: /* in sectors */
+		/* sectors are remapped, erases are not a concern of the FS */
+		*(uint32_t *)buff = 1;
+		return 0;
+	case DISK_IOCTL_GET_DISK_SIZE:
+		*(uint32_t *)buff = LOGICAL_SECTORS * SECTOR_SIZE;
+		return 0;
+	default:
+		break;
+	}
+
+	return -EINVAL;
+}
+
+static const struct disk_operations disk_flash_ops = {
+	.init = disk_flash_init,
+	.status = disk_flash_status,
+	.read = disk_flash_read,
+	.write = disk_flash_write,
+	.ioctl = disk_flash_ioctl,
+};
+
+static struct disk_info disk_flash_disk = {
+	.name = "FLASH",
+	.ops = &disk_flash_ops,
+};
+
+static int disk_flash_register(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return disk_access_register(&disk_flash_disk);
+}
+
+SYS_INIT(disk_flash_register, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <misc/__assert.h>
 #include <disk_access.h>
+#include <init.h>
 #include <errno.h>
 
 #define RAMDISK_SECTOR_SIZE 512
@@ -33,31 +34,33 @@ static void *lba_to_address(uint32_t lba)
 	return &ramdisk_buf[(lba * RAMDISK_SECTOR_SIZE)];
 }
 
-int disk_access_status(void)
+static int disk_ram_status(struct disk_info *disk)
 {
 	return DISK_STATUS_OK;
 }
 
-int disk_access_init(void)
+static int disk_ram_init(struct disk_info *disk)
 {
 	return 0;
 }
 
-int disk_access_read(uint8_t *buff, uint32_t sector, uint32_t count)
+static int disk_ram_read(struct disk_info *disk, uint8_t *buff,
+			 uint32_t sector, uint32_t count)
 {
 	memcpy(buff, lba_to_address(sector), count * RAMDISK_SECTOR_SIZE);
 
 	return 0;
 }
 
-int disk_access_write(const uint8_t *buff, uint32_t sector, uint32_t count)
+static int disk_ram_write(struct disk_info *disk, const uint8_t *buff,
+			  uint32_t sector, uint32_t count)
 {
 	memcpy(lba_to_address(sector), buff, count * RAMDISK_SECTOR_SIZE);
 
 	return 0;
 }
 
-int disk_access_ioctl(uint8_t cmd, void *buff)
+static int disk_ram_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
 {
 	switch (cmd) {
 	case DISK_IOCTL_CTRL_SYNC:
@@ -80,3 +83,25 @@ int disk_access_ioctl(uint8_t cmd, void *buff)
 
 	return 0;
 }
+
+static const struct disk_operations disk_ram_ops = {
+	.init = disk_ram_init,
+	.status = disk_ram_status,
+	.read = disk_ram_read,
+	.write = disk_ram_write,
+	.ioctl = disk_ram_ioctl,
+};
+
+static struct disk_info disk_ram_disk = {
+	.name = "RAM",
+	.ops = &disk_ram_ops,
+};
+
+static int disk_ram_register(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return disk_access_register(&disk_ram_disk);
+}
+
+SYS_INIT(disk_ram_register, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
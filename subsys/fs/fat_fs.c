@@ -15,6 +15,8 @@
 
 static FATFS fat_fs;	/* FatFs work area */
 
+static struct fs_mount_point fat_fs_mnt;
+
 static int translate_error(int error)
 {
 	switch (error) {
@@ -54,28 +56,29 @@ static int translate_error(int error)
 	return -EIO;
 }
 
-int fs_open(fs_file_t *zfp, const char *file_name)
+static int fat_fs_open(struct fs_mount_point *mp, union fs_file_data *zfp,
+		       const char *file_name)
 {
 	FRESULT res;
 	uint8_t fs_mode;
 
 	fs_mode = FA_READ | FA_WRITE | FA_OPEN_ALWAYS;
 
-	res = f_open(&zfp->fp, file_name, fs_mode);
+	res = f_open(&zfp->fat, file_name, fs_mode);
 
 	return translate_error(res);
 }
 
-int fs_close(fs_file_t *zfp)
+static int fat_fs_close(union fs_file_data *zfp)
 {
 	FRESULT res;
 
-	res = f_close(&zfp->fp);
+	res = f_close(&zfp->fat);
 
 	return translate_error(res);
 }
 
-int fs_unlink(const char *path)
+static int fat_fs_unlink(struct fs_mount_point *mp, const char *path)
 {
 	FRESULT res;
 
@@ -84,12 +87,12 @@ int fs_unlink(const char *path)
 	return translate_error(res);
 }
 
-ssize_t fs_read(fs_file_t *zfp, void *ptr, size_t size)
+static ssize_t fat_fs_read(union fs_file_data *zfp, void *ptr, size_t size)
 {
 	FRESULT res;
 	unsigned int br;
 
-	res = f_read(&zfp->fp, ptr, size, &br);
+	res = f_read(&zfp->fat, ptr, size, &br);
 	if (res != FR_OK) {
 		return translate_error(res);
 	}
@@ -97,12 +100,13 @@ ssize_t fs_read(fs_file_t *zfp, void *ptr, size_t size)
 	return br;
 }
 
-ssize_t fs_write(fs_file_t *zfp, const void *ptr, size_t size)
+static ssize_t fat_fs_write(union fs_file_data *zfp, const void *ptr,
+			    size_t size)
 {
 	FRESULT res;
 	unsigned int bw;
 
-	res = f_write(&zfp->fp, ptr, size, &bw);
+	res = f_write(&zfp->fat, ptr, size, &bw);
 	if (res != FR_OK) {
 		return translate_error(res);
 	}
@@ -110,7 +114,7 @@ ssize_t fs_write(fs_file_t *zfp, const void *ptr, size_t size)
 	return bw;
 }
 
-int fs_seek(fs_file_t *zfp, off_t offset, int whence)
+static int fat_fs_seek(union fs_file_data *zfp, off_t offset, int whence)
 {
 	FRESULT res = FR_OK;
 	off_t pos;
@@ -120,46 +124,46 @@ int fs_seek(fs_file_t *zfp, off_t offset, int whence)
 		pos = offset;
 		break;
 	case FS_SEEK_CUR:
-		pos = f_tell(&zfp->fp) + offset;
+		pos = f_tell(&zfp->fat) + offset;
 		break;
 	case FS_SEEK_END:
-		pos = f_size(&zfp->fp) + offset;
+		pos = f_size(&zfp->fat) + offset;
 		break;
 	default:
 		return -EINVAL;
 	}
 
-	if ((pos < 0) || (pos > f_size(&zfp->fp))) {
+	if ((pos < 0) || (pos > f_size(&zfp->fat))) {
 		return -EINVAL;
 	}
 
-	res = f_lseek(&zfp->fp, pos);
+	res = f_lseek(&zfp->fat, pos);
 
 	return translate_error(res);
 }
 
-int fs_truncate(fs_file_t *zfp, off_t length)
+static int fat_fs_truncate(union fs_file_data *zfp, off_t length)
 {
 	FRESULT res = FR_OK;
-	off_t cur_length = f_size(&zfp->fp);
+	off_t cur_length = f_size(&zfp->fat);
 
 	/* f_lseek expands file if new position is larger than file size */
-	res = f_lseek(&zfp->fp, length);
+	res = f_lseek(&zfp->fat, length);
 	if (res != FR_OK) {
 		return translate_error(res);
 	}
 
 	if (length < cur_length) {
-		res = f_truncate(&zfp->fp);
+		res = f_truncate(&zfp->fat);
 	} else {
 		/*
 		 * Get actual length after expansion. This could be
 		 * less if there was not enough space in the volume
 		 * to expand to the requested length
 		 */
-		length = f_tell(&zfp->fp);
+		length = f_tell(&zfp->fat);
 
-		res = f_lseek(&zfp->fp, cur_length);
+		res = f_lseek(&zfp->fat, cur_length);
 		if (res != FR_OK) {
 			return translate_error(res);
 		}
@@ -174,7 +178,7 @@ int fs_truncate(fs_file_t *zfp, off_t length)
 		uint8_t c = 0;
 
 		for (int i = cur_length; i < length; i++) {
-			res = f_write(&zfp->fp, &c, 1, &bw);
+			res = f_write(&zfp->fat, &c, 1, &bw);
 			if (res != FR_OK) {
 				break;
 			}
@@ -184,16 +188,16 @@ int fs_truncate(fs_file_t *zfp, off_t length)
 	return translate_error(res);
 }
 
-int fs_sync(fs_file_t *zfp)
+static int fat_fs_sync(union fs_file_data *zfp)
 {
 	FRESULT res = FR_OK;
 
-	res = f_sync(&zfp->fp);
+	res = f_sync(&zfp->fat);
 
 	return translate_error(res);
 }
 
-int fs_mkdir(const char *path)
+static int fat_fs_mkdir(struct fs_mount_point *mp, const char *path)
 {
 	FRESULT res;
 
@@ -202,21 +206,22 @@ int fs_mkdir(const char *path)
 	return translate_error(res);
 }
 
-int fs_opendir(fs_dir_t *zdp, const char *path)
+static int fat_fs_opendir(struct fs_mount_point *mp, union fs_dir_data *zdp,
+			  const char *path)
 {
 	FRESULT res;
 
-	res = f_opendir(&zdp->dp, path);
+	res = f_opendir(&zdp->fat, path);
 
 	return translate_error(res);
 }
 
-int fs_readdir(fs_dir_t *zdp, struct fs_dirent *entry)
+static int fat_fs_readdir(union fs_dir_data *zdp, struct fs_dirent *entry)
 {
 	FRESULT res;
 	FILINFO fno;
 
-	res = f_readdir(&zdp->dp, &fno);
+	res = f_readdir(&zdp->fat, &fno);
 	if (res == FR_OK) {
 		entry->type = ((fno.fattrib & AM_DIR) ?
 			       FS_DIR_ENTRY_DIR : FS_DIR_ENTRY_FILE);
@@ -227,16 +232,17 @@ int fs_readdir(fs_dir_t *zdp, struct fs_dirent *entry)
 	return translate_error(res);
 }
 
-int fs_closedir(fs_dir_t *zdp)
+static int fat_fs_closedir(union fs_dir_data *zdp)
 {
 	FRESULT res;
 
-	res = f_closedir(&zdp->dp);
+	res = f_closedir(&zdp->fat);
 
 	return translate_error(res);
 }
 
-int fs_stat(const char *path, struct fs_dirent *entry)
+static int fat_fs_stat(struct fs_mount_point *mp, const char *path,
+		       struct fs_dirent *entry)
 {
 	FRESULT res;
 	FILINFO fno;
@@ -252,7 +258,8 @@ int fs_stat(const char *path, struct fs_dirent *entry)
 	return translate_error(res);
 }
 
-int fs_statvfs(struct fs_statvfs *stat)
+static int fat_fs_statvfs(struct fs_mount_point *mp, const char *path,
+			  struct fs_statvfs *stat)
 {
 	FATFS *fs;
 	FRESULT res;
@@ -273,13 +280,17 @@ int fs_statvfs(struct fs_statvfs *stat)
 	return translate_error(res);
 }
 
-static int fs_init(struct device *dev)
+static off_t fat_fs_tell(union fs_file_data *zfp)
 {
-	FRESULT res;
+	return f_tell(&zfp->fat);
+}
 
-	ARG_UNUSED(dev);
+static int fat_fs_mount(struct fs_mount_point *mp)
+{
+	FRESULT res;
 
-	res = f_mount(&fat_fs, "", 1);
+	/* FatFs is configured for a single volume, the disk access one */
+	res = f_mount(mp->fs_data, "", 1);
 
 	/* If no file system found then create one */
 	if (res == FR_NO_FILESYSTEM) {
@@ -287,13 +298,57 @@ static int fs_init(struct device *dev)
 
 		res = f_mkfs("", (FM_FAT | FM_SFD), 0, work, sizeof(work));
 		if (res == FR_OK) {
-			res = f_mount(&fat_fs, "", 1);
+			res = f_mount(mp->fs_data, "", 1);
 		}
 	}
 
-	__ASSERT((res == FR_OK), "FS init failed (%d)", translate_error(res));
+	return translate_error(res);
+}
+
+static int fat_fs_unmount(struct fs_mount_point *mp)
+{
+	FRESULT res;
+
+	res = f_mount(NULL, "", 0);
 
 	return translate_error(res);
 }
 
+const struct fs_file_system_api fat_fs_api = {
+	.mount = fat_fs_mount,
+	.unmount = fat_fs_unmount,
+	.open = fat_fs_open,
+	.close = fat_fs_close,
+	.read = fat_fs_read,
+	.write = fat_fs_write,
+	.seek = fat_fs_seek,
+	.tell = fat_fs_tell,
+	.truncate = fat_fs_truncate,
+	.sync = fat_fs_sync,
+	.opendir = fat_fs_opendir,
+	.readdir = fat_fs_readdir,
+	.closedir = fat_fs_closedir,
+	.unlink = fat_fs_unlink,
+	.mkdir = fat_fs_mkdir,
+	.stat = fat_fs_stat,
+	.statvfs = fat_fs_statvfs,
+};
+
+static int fs_init(struct device *dev)
+{
+	int err;
+
+	ARG_UNUSED(dev);
+
+	fat_fs_mnt.mnt_point = CONFIG_FS_FAT_MOUNT_POINT;
+	fat_fs_mnt.fs = &fat_fs_api;
+	fat_fs_mnt.fs_data = &fat_fs;
+
+	err = fs_mount(&fat_fs_mnt);
+
+	__ASSERT(!err, "FS init failed (%d)", err);
+
+	return err;
+}
+
 SYS_INIT(fs_init, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,659 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Virtual file system
+ *
+ * Dispatches the file system API to the backend mounted at the longest
+ * prefix of each path, and keeps the open files and directories of all
+ * backends in a single descriptor table.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <kernel.h>
+#include <fs.h>
+
+struct fs_desc {
+	/* NULL while the slot is free */
+	struct fs_mount_point *mp;
+	bool is_dir;
+#if CONFIG_FILE_SYSTEM_LOOKUP_CACHE > 0
+	uint32_t hash;
+#endif
+	union {
+		union fs_file_data file;
+		union fs_dir_data dir;
+	} data;
+};
+
+static struct fs_desc descs[CONFIG_FILE_SYSTEM_MAX_OPEN];
+static sys_slist_t mounts;
+
+/* Protects the mount list, the descriptor table and the lookup cache */
+static K_MUTEX_DEFINE(fs_lock);
+
+#if CONFIG_FILE_SYSTEM_LOOKUP_CACHE > 0
+/* Longer paths are looked up by the backend every time */
+#define LOOKUP_PATH_MAX 32
+
+/* Result of a previous fs_stat(), including -ENOENT, so that existence
+ * checks do not walk the directories of the backend again.
+ */
+struct lookup_entry {
+	uint32_t hash;
+	int res;
+	struct fs_dirent entry;
+	/* empty if unused */
+	char path[LOOKUP_PATH_MAX];
+};
+
+static struct lookup_entry lookup_cache[CONFIG_FILE_SYSTEM_LOOKUP_CACHE];
+static unsigned int lookup_next;
+/* Bumped on every invalidation, a lookup racing with one is not stored */
+static uint32_t lookup_gen;
+
+/* FNV-1a */
+static uint32_t path_hash(const char *path)
+{
+	uint32_t hash = 2166136261U;
+
+	while (*path) {
+		hash = (hash ^ (uint8_t)*path++) * 16777619U;
+	}
+
+	return hash;
+}
+
+static struct lookup_entry *lookup_find(const char *path, uint32_t hash)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(lookup_cache); i++) {
+		if (lookup_cache[i].path[0] && lookup_cache[i].hash == hash &&
+		    !strcmp(lookup_cache[i].path, path)) {
+			return &lookup_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void lookup_store(const char *path, uint32_t hash, int res,
+			 const struct fs_dirent *entry)
+{
+	struct lookup_entry *cached;
+
+	if (strlen(path) >= LOOKUP_PATH_MAX) {
+		return;
+	}
+
+	cached = lookup_find(path, hash);
+	if (!cached) {
+		cached = &lookup_cache[lookup_next];
+		lookup_next = (lookup_next + 1) % ARRAY_SIZE(lookup_cache);
+	}
+
+	cached->hash = hash;
+	cached->res = res;
+	if (!res) {
+		cached->entry = *entry;
+	}
+	strcpy(cached->path, path);
+}
+
+static void lookup_drop(uint32_t hash)
+{
+	int i;
+
+	lookup_gen++;
+
+	for (i = 0; i < ARRAY_SIZE(lookup_cache); i++) {
+		if (lookup_cache[i].hash == hash) {
+			lookup_cache[i].path[0] = '\0';
+		}
+	}
+}
+
+static void lookup_flush(void)
+{
+	int i;
+
+	lookup_gen++;
+
+	for (i = 0; i < ARRAY_SIZE(lookup_cache); i++) {
+		lookup_cache[i].path[0] = '\0';
+	}
+}
+
+/* Cache key of a path, the same with or without the leading '/' */
+static const char *lookup_key(const char *path)
+{
+	return path[0] == '/' ? path + 1 : path;
+}
+
+static void lookup_invalidate(const char *path)
+{
+	k_mutex_lock(&fs_lock, K_FOREVER);
+	lookup_drop(path_hash(lookup_key(path)));
+	k_mutex_unlock(&fs_lock);
+}
+#else
+#define lookup_invalidate(path) do { } while (0)
+#define lookup_flush() do { } while (0)
+#endif /* CONFIG_FILE_SYSTEM_LOOKUP_CACHE > 0 */
+
+/* Paths without a leading '/' are relative to the root */
+static struct fs_mount_point *mount_find(const char *path, const char **rel)
+{
+	struct fs_mount_point *best = NULL;
+	const char *name = path[0] == '/' ? path + 1 : path;
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&mounts, node) {
+		struct fs_mount_point *mp = CONTAINER_OF(node,
+							 struct fs_mount_point,
+							 node);
+		size_t len = mp->mnt_point_len - 1;
+
+		if (best && len < best->mnt_point_len - 1) {
+			continue;
+		}
+
+		if (len && (strncmp(name, mp->mnt_point + 1, len) ||
+			    (name[len] != '/' && name[len] != '\0'))) {
+			continue;
+		}
+
+		best = mp;
+	}
+
+	if (best) {
+		if (best->mnt_point_len == 1) {
+			*rel = path;
+		} else {
+			*rel = name + best->mnt_point_len - 1;
+			if (**rel == '\0') {
+				*rel = "/";
+			}
+		}
+	}
+
+	return best;
+}
+
+static bool mount_is_active(struct fs_mount_point *mp)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&mounts, node) {
+		if (node == &mp->node) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static struct fs_mount_point *mount_get(const char *path, const char **rel)
+{
+	struct fs_mount_point *mp;
+
+	k_mutex_lock(&fs_lock, K_FOREVER);
+	mp = mount_find(path, rel);
+	k_mutex_unlock(&fs_lock);
+
+	return mp;
+}
+
+static int desc_alloc(struct fs_mount_point *mp, bool is_dir,
+		      const char *path)
+{
+	int fd;
+
+	k_mutex_lock(&fs_lock, K_FOREVER);
+
+	for (fd = 0; fd < ARRAY_SIZE(descs); fd++) {
+		if (!descs[fd].mp) {
+			descs[fd].mp = mp;
+			descs[fd].is_dir = is_dir;
+#if CONFIG_FILE_SYSTEM_LOOKUP_CACHE > 0
+			descs[fd].hash = path_hash(lookup_key(path));
+#endif
+			break;
+		}
+	}
+
+	k_mutex_unlock(&fs_lock);
+
+	return fd < ARRAY_SIZE(descs) ? fd : -EMFILE;
+}
+
+static void desc_free(int fd)
+{
+	k_mutex_lock(&fs_lock, K_FOREVER);
+	descs[fd].mp = NULL;
+	k_mutex_unlock(&fs_lock);
+}
+
+static struct fs_desc *desc_get(int fd, bool is_dir)
+{
+	if (fd < 0 || fd >= ARRAY_SIZE(descs) || !descs[fd].mp ||
+	    descs[fd].is_dir != is_dir) {
+		return NULL;
+	}
+
+	return &descs[fd];
+}
+
+#if CONFIG_FILE_SYSTEM_LOOKUP_CACHE > 0
+/* The size of a file being written is not known anymore */
+static void desc_modified(struct fs_desc *desc)
+{
+	k_mutex_lock(&fs_lock, K_FOREVER);
+	lookup_drop(desc->hash);
+	k_mutex_unlock(&fs_lock);
+}
+#else
+#define desc_modified(desc) do { } while (0)
+#endif
+
+int fs_mount(struct fs_mount_point *mp)
+{
+	struct fs_mount_point *other;
+	const char *rel;
+	size_t len;
+	int err = 0;
+
+	if (!mp->mnt_point || mp->mnt_point[0] != '/' || !mp->fs) {
+		return -EINVAL;
+	}
+
+	len = strlen(mp->mnt_point);
+	if (len > 1 && mp->mnt_point[len - 1] == '/') {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&fs_lock, K_FOREVER);
+
+	/* The longest match is the same path only if it has the same length */
+	other = mount_find(mp->mnt_point, &rel);
+	if (other && other->mnt_point_len == len) {
+		err = -EBUSY;
+		goto out;
+	}
+
+	mp->mnt_point_len = len;
+
+	if (mp->fs->mount) {
+		err = mp->fs->mount(mp);
+		if (err) {
+			goto out;
+		}
+	}
+
+	sys_slist_append(&mounts, &mp->node);
+
+	/* Paths below it may have belonged to another file system */
+	lookup_flush();
+
+out:
+	k_mutex_unlock(&fs_lock);
+
+	return err;
+}
+
+int fs_unmount(struct fs_mount_point *mp)
+{
+	int err = 0;
+	int fd;
+
+	k_mutex_lock(&fs_lock, K_FOREVER);
+
+	for (fd = 0; fd < ARRAY_SIZE(descs); fd++) {
+		if (descs[fd].mp == mp) {
+			err = -EBUSY;
+			goto out;
+		}
+	}
+
+	if (!mount_is_active(mp)) {
+		err = -EINVAL;
+		goto out;
+	}
+
+	sys_slist_find_and_remove(&mounts, &mp->node);
+
+	if (mp->fs->unmount) {
+		err = mp->fs->unmount(mp);
+		if (err) {
+			sys_slist_append(&mounts, &mp->node);
+			goto out;
+		}
+	}
+
+	lookup_flush();
+
+out:
+	k_mutex_unlock(&fs_lock);
+
+	return err;
+}
+
+int fs_open(fs_file_t *zfp, const char *file_name)
+{
+	struct fs_mount_point *mp;
+	const char *rel;
+	int fd, err;
+
+	mp = mount_get(file_name, &rel);
+	if (!mp) {
+		return -ENOENT;
+	}
+
+	if (!mp->fs->open) {
+		return -ENOTSUP;
+	}
+
+	fd = desc_alloc(mp, false, file_name);
+	if (fd < 0) {
+		return fd;
+	}
+
+	/* The file is created if it does not exist */
+	lookup_invalidate(file_name);
+
+	err = mp->fs->open(mp, &descs[fd].data.file, rel);
+	if (err) {
+		desc_free(fd);
+		return err;
+	}
+
+	zfp->fd = fd;
+
+	return 0;
+}
+
+int fs_close(fs_file_t *zfp)
+{
+	struct fs_desc *desc = desc_get(zfp->fd, false);
+	int err;
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	err = desc->mp->fs->close ? desc->mp->fs->close(&desc->data.file) : 0;
+
+	/* The slot would leak otherwise, the file is not usable anymore */
+	desc_free(zfp->fd);
+	zfp->fd = -1;
+
+	return err;
+}
+
+int fs_unlink(const char *path)
+{
+	struct fs_mount_point *mp;
+	const char *rel;
+
+	mp = mount_get(path, &rel);
+	if (!mp) {
+		return -ENOENT;
+	}
+
+	if (!mp->fs->unlink) {
+		return -ENOTSUP;
+	}
+
+	lookup_invalidate(path);
+
+	return mp->fs->unlink(mp, rel);
+}
+
+ssize_t fs_read(fs_file_t *zfp, void *ptr, size_t size)
+{
+	struct fs_desc *desc = desc_get(zfp->fd, false);
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	if (!desc->mp->fs->read) {
+		return -ENOTSUP;
+	}
+
+	return desc->mp->fs->read(&desc->data.file, ptr, size);
+}
+
+ssize_t fs_write(fs_file_t *zfp, const void *ptr, size_t size)
+{
+	struct fs_desc *desc = desc_get(zfp->fd, false);
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	if (!desc->mp->fs->write) {
+		return -ENOTSUP;
+	}
+
+	desc_modified(desc);
+
+	return desc->mp->fs->write(&desc->data.file, ptr, size);
+}
+
+int fs_seek(fs_file_t *zfp, off_t offset, int whence)
+{
+	struct fs_desc *desc = desc_get(zfp->fd, false);
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	if (!desc->mp->fs->seek) {
+		return -ENOTSUP;
+	}
+
+	return desc->mp->fs->seek(&desc->data.file, offset, whence);
+}
+
+off_t fs_tell(fs_file_t *zfp)
+{
+	struct fs_desc *desc = desc_get(zfp->fd, false);
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	if (!desc->mp->fs->tell) {
+		return -ENOTSUP;
+	}
+
+	return desc->mp->fs->tell(&desc->data.file);
+}
+
+int fs_truncate(fs_file_t *zfp, off_t length)
+{
+	struct fs_desc *desc = desc_get(zfp->fd, false);
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	if (!desc->mp->fs->truncate) {
+		return -ENOTSUP;
+	}
+
+	desc_modified(desc);
+
+	return desc->mp->fs->truncate(&desc->data.file, length);
+}
+
+int fs_sync(fs_file_t *zfp)
+{
+	struct fs_desc *desc = desc_get(zfp->fd, false);
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	if (!desc->mp->fs->sync) {
+		return 0;
+	}
+
+	return desc->mp->fs->sync(&desc->data.file);
+}
+
+int fs_mkdir(const char *path)
+{
+	struct fs_mount_point *mp;
+	const char *rel;
+
+	mp = mount_get(path, &rel);
+	if (!mp) {
+		return -ENOENT;
+	}
+
+	if (!mp->fs->mkdir) {
+		return -ENOTSUP;
+	}
+
+	lookup_invalidate(path);
+
+	return mp->fs->mkdir(mp, rel);
+}
+
+int fs_opendir(fs_dir_t *zdp, const char *path)
+{
+	struct fs_mount_point *mp;
+	const char *rel;
+	int fd, err;
+
+	mp = mount_get(path, &rel);
+	if (!mp) {
+		return -ENOENT;
+	}
+
+	if (!mp->fs->opendir) {
+		return -ENOTSUP;
+	}
+
+	fd = desc_alloc(mp, true, path);
+	if (fd < 0) {
+		return fd;
+	}
+
+	err = mp->fs->opendir(mp, &descs[fd].data.dir, rel);
+	if (err) {
+		desc_free(fd);
+		return err;
+	}
+
+	zdp->fd = fd;
+
+	return 0;
+}
+
+int fs_readdir(fs_dir_t *zdp, struct fs_dirent *entry)
+{
+	struct fs_desc *desc = desc_get(zdp->fd, true);
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	if (!desc->mp->fs->readdir) {
+		return -ENOTSUP;
+	}
+
+	return desc->mp->fs->readdir(&desc->data.dir, entry);
+}
+
+int fs_closedir(fs_dir_t *zdp)
+{
+	struct fs_desc *desc = desc_get(zdp->fd, true);
+	int err;
+
+	if (!desc) {
+		return -EBADF;
+	}
+
+	err = desc->mp->fs->closedir ?
+	      desc->mp->fs->closedir(&desc->data.dir) : 0;
+
+	desc_free(zdp->fd);
+	zdp->fd = -1;
+
+	return err;
+}
+
+int fs_stat(const char *path, struct fs_dirent *entry)
+{
+	struct fs_mount_point *mp;
+	const char *rel;
+	int res;
+#if CONFIG_FILE_SYSTEM_LOOKUP_CACHE > 0
+	const char *key = lookup_key(path);
+	uint32_t hash = path_hash(key);
+	struct lookup_entry *cached;
+	uint32_t gen;
+
+	k_mutex_lock(&fs_lock, K_FOREVER);
+	gen = lookup_gen;
+	cached = lookup_find(key, hash);
+	if (cached) {
+		res = cached->res;
+		if (!res) {
+			*entry = cached->entry;
+		}
+		k_mutex_unlock(&fs_lock);
+		return res;
+	}
+	k_mutex_unlock(&fs_lock);
+#endif
+
+	mp = mount_get(path, &rel);
+	if (!mp) {
+		return -ENOENT;
+	}
+
+	if (!mp->fs->stat) {
+		return -ENOTSUP;
+	}
+
+	res = mp->fs->stat(mp, rel, entry);
+
+#if CONFIG_FILE_SYSTEM_LOOKUP_CACHE > 0
+	if (!res || res == -ENOENT) {
+		k_mutex_lock(&fs_lock, K_FOREVER);
+		if (gen == lookup_gen) {
+			lookup_store(key, hash, res, entry);
+		}
+		k_mutex_unlock(&fs_lock);
+	}
+#endif
+
+	return res;
+}
+
+int fs_statvfs(const char *path, struct fs_statvfs *stat)
+{
+	struct fs_mount_point *mp;
+	const char *rel;
+
+	mp = mount_get(path, &rel);
+	if (!mp) {
+		return -ENOENT;
+	}
+
+	if (!mp->fs->statvfs) {
+		return -ENOTSUP;
+	}
+
+	return mp->fs->statvfs(mp, rel, stat);
+}
@@ -48,6 +48,21 @@ void sys_event_logger_put(struct event_logger *logger, uint16_t event_id,
 }
 
 
+void sys_event_logger_put_unlocked(struct event_logger *logger,
+				   uint16_t event_id, uint32_t *event_data,
+				   uint8_t data_size)
+{
+	int ret;
+
+	ret = sys_ring_buf_put(&logger->ring_buf, event_id,
+			       logger->ring_buf.dropped_put_count, event_data,
+			       data_size);
+	if (ret == 0) {
+		logger->ring_buf.dropped_put_count = 0;
+	}
+}
+
+
 /**
  * @brief Send an event message to the logger with a non preemptible
  * behaviour.
@@ -125,6 +140,53 @@ int sys_event_logger_get_wait(struct event_logger *logger,  uint16_t *event_id,
 }
 
 
+int sys_event_logger_get_bulk(struct event_logger *logger, uint32_t *buffer,
+			      uint32_t buffer_size)
+{
+	struct ring_buf *ring = &logger->ring_buf;
+	uint32_t head = ring->head;
+	uint32_t tail, length, i;
+	uint32_t count = 0, events = 0;
+
+	/*
+	 * Producers write the message before moving the tail, read the tail
+	 * once and only then the messages it covers.
+	 */
+	tail = *(volatile uint32_t *)&ring->tail;
+	__asm__ volatile("" ::: "memory");
+
+	while (head != tail) {
+		length = EVENT_HEADER_LENGTH(ring->buf[head]) + EVENT_HEADER_SIZE;
+		if (count + length > buffer_size) {
+			break;
+		}
+
+		for (i = 0; i < length; i++) {
+			buffer[count++] = ring->buf[head];
+			if (likely(ring->mask)) {
+				head = (head + 1) & ring->mask;
+			} else {
+				head = (head + 1) % ring->size;
+			}
+		}
+
+		events++;
+	}
+
+	ring->head = head;
+
+	/* Consume the signals given for the messages taken, if any */
+	while (events-- && !k_sem_take(&(logger->sync_sema), K_NO_WAIT)) {
+	}
+
+	if (!count && head != tail) {
+		return -EMSGSIZE;
+	}
+
+	return count;
+}
+
+
 #ifdef CONFIG_SYS_CLOCK_EXISTS
 int sys_event_logger_get_wait_timeout(struct event_logger *logger,
 				      uint16_t *event_id,
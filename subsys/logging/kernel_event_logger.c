@@ -25,6 +25,13 @@ uint32_t _sys_k_event_logger_buffer[CONFIG_KERNEL_EVENT_LOGGER_BUFFER_SIZE];
 void *_collector_coop_thread;
 #endif
 
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SWITCH_BUFFER
+static struct event_logger sys_k_event_logger_switch;
+
+static uint32_t
+_sys_k_event_logger_switch_buffer[CONFIG_KERNEL_EVENT_LOGGER_SWITCH_BUFFER_SIZE];
+#endif
+
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_SLEEP
 uint32_t _sys_k_event_logger_sleep_start_time;
 #endif
@@ -47,6 +54,12 @@ static int _sys_k_event_logger_init(struct device *arg)
 	sys_event_logger_init(&sys_k_event_logger, _sys_k_event_logger_buffer,
 		CONFIG_KERNEL_EVENT_LOGGER_BUFFER_SIZE);
 
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SWITCH_BUFFER
+	sys_event_logger_init(&sys_k_event_logger_switch,
+		_sys_k_event_logger_switch_buffer,
+		CONFIG_KERNEL_EVENT_LOGGER_SWITCH_BUFFER_SIZE);
+#endif
+
 	return 0;
 }
 SYS_INIT(_sys_k_event_logger_init,
@@ -104,6 +117,14 @@ void _sys_k_event_logger_context_switch(void)
 	data[0] = _sys_k_get_time();
 	data[1] = (uint32_t)_kernel.current;
 
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SWITCH_BUFFER
+	/* Only produced here, with no semaphore to signal */
+	sys_event_logger_put_unlocked(&sys_k_event_logger_switch,
+		KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, data,
+		ARRAY_SIZE(data));
+	return;
+#endif
+
 	/*
 	 * The mechanism we use to log the kernel events uses a sync semaphore
 	 * to inform that there are available events to be collected. The
@@ -138,6 +159,43 @@ void sys_k_event_logger_register_as_collector(void)
 #endif /* CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH */
 
 
+int sys_k_event_logger_get_bulk(uint32_t *buffer, uint32_t buffer_size,
+				int32_t timeout)
+{
+	int count = 0;
+	int ret;
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SWITCH_BUFFER
+	count = sys_event_logger_get_bulk(&sys_k_event_logger_switch, buffer,
+					  buffer_size);
+	if (count < 0) {
+		return count;
+	}
+#endif
+
+	ret = sys_event_logger_get_bulk(&sys_k_event_logger, buffer + count,
+					buffer_size - count);
+	if (ret < 0) {
+		return count ? count : ret;
+	}
+
+	count += ret;
+	if (count || timeout == K_NO_WAIT) {
+		return count;
+	}
+
+	/*
+	 * Only the main buffer signals, waiting for it also bounds how long
+	 * context switch events stay in theirs.
+	 */
+	if (!k_sem_take(&(sys_k_event_logger.sync_sema), timeout)) {
+		k_sem_give(&(sys_k_event_logger.sync_sema));
+	}
+
+	return sys_k_event_logger_get_bulk(buffer, buffer_size, K_NO_WAIT);
+}
+
+
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT
 void _sys_k_event_logger_interrupt(void)
 {
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Segger RTT log, trace and data channels
+ *
+ * Up-buffers are written with interrupts locked, skipping writes that do
+ * not fit; the probe reading them in the background, nothing else is
+ * done on the target. In block mode, threads retry until the probe made
+ * enough room.
+ */
+
+#include <kernel.h>
+#include <init.h>
+#include <atomic.h>
+#include <rtt/SEGGER_RTT.h>
+#include <logging/rtt_backend.h>
+
+#if defined(CONFIG_SYS_LOG_CORE)
+#include <logging/sys_log_core.h>
+#endif
+
+#if defined(CONFIG_RTT_BACKEND_TRACE)
+#include <logging/kernel_event_logger.h>
+#endif
+
+/* How long a blocked thread waits for the probe, in milliseconds */
+#define RTT_BLOCK_WAIT 1
+
+static int rtt_index[RTT_BACKEND_CHANNELS] = { -1, -1, -1 };
+static size_t rtt_size[RTT_BACKEND_CHANNELS];
+static atomic_t rtt_dropped[RTT_BACKEND_CHANNELS];
+
+#if defined(CONFIG_RTT_BACKEND_LOG)
+static uint8_t rtt_log_buf[CONFIG_RTT_BACKEND_LOG_BUFFER_SIZE];
+#endif
+
+#if defined(CONFIG_RTT_BACKEND_TRACE)
+static uint8_t rtt_trace_buf[CONFIG_RTT_BACKEND_TRACE_BUFFER_SIZE];
+#endif
+
+#if CONFIG_RTT_BACKEND_DATA_BUFFER_SIZE > 0
+static uint8_t rtt_data_buf[CONFIG_RTT_BACKEND_DATA_BUFFER_SIZE];
+#endif
+
+size_t rtt_backend_write(enum rtt_backend_channel channel, const void *data,
+			 size_t len)
+{
+	int index = rtt_index[channel];
+	unsigned int key;
+	unsigned int written;
+
+	if (index < 0) {
+		return 0;
+	}
+
+	while (1) {
+		key = irq_lock();
+		written = SEGGER_RTT_WriteSkipNoLock(index, data, len);
+		irq_unlock(key);
+
+#if defined(CONFIG_RTT_BACKEND_MODE_BLOCK)
+		/* One byte of an up-buffer always stays free */
+		if (!written && len < rtt_size[channel] && !k_is_in_isr()) {
+			k_sleep(RTT_BLOCK_WAIT);
+			continue;
+		}
+#endif
+		break;
+	}
+
+	if (!written) {
+		atomic_inc(&rtt_dropped[channel]);
+	}
+
+	return written;
+}
+
+uint32_t rtt_backend_dropped_get(enum rtt_backend_channel channel)
+{
+	return atomic_get(&rtt_dropped[channel]);
+}
+
+#if defined(CONFIG_RTT_BACKEND_LOG)
+static void rtt_log_put(const char *line, size_t len)
+{
+	rtt_backend_write(RTT_BACKEND_LOG, line, len);
+}
+
+static struct sys_log_backend rtt_log_backend = {
+	.put = rtt_log_put,
+};
+#endif
+
+#if defined(CONFIG_RTT_BACKEND_TRACE)
+static void rtt_trace_thread(void *p1, void *p2, void *p3)
+{
+	static uint32_t events[CONFIG_RTT_BACKEND_TRACE_BULK_SIZE];
+	int count;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		count = sys_k_event_logger_get_bulk(events, ARRAY_SIZE(events),
+						    CONFIG_RTT_BACKEND_TRACE_PERIOD);
+		if (count > 0) {
+			rtt_backend_write(RTT_BACKEND_TRACE, events,
+					  count * sizeof(events[0]));
+		}
+	}
+}
+
+K_THREAD_DEFINE(rtt_trace_thread_id, CONFIG_RTT_BACKEND_TRACE_STACK_SIZE,
+		rtt_trace_thread, NULL, NULL, NULL,
+		CONFIG_RTT_BACKEND_TRACE_THREAD_PRIORITY, 0, K_NO_WAIT);
+#endif /* CONFIG_RTT_BACKEND_TRACE */
+
+static int rtt_backend_init(struct device *unused)
+{
+	ARG_UNUSED(unused);
+
+	/* The probe finds the control block once it is initialized */
+	SEGGER_RTT_Init();
+
+#if defined(CONFIG_RTT_BACKEND_LOG)
+	rtt_index[RTT_BACKEND_LOG] =
+		SEGGER_RTT_AllocUpBuffer("Log", rtt_log_buf,
+					 sizeof(rtt_log_buf),
+					 SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+	rtt_size[RTT_BACKEND_LOG] = sizeof(rtt_log_buf);
+	sys_log_backend_register(&rtt_log_backend);
+#endif
+
+#if defined(CONFIG_RTT_BACKEND_TRACE)
+	rtt_index[RTT_BACKEND_TRACE] =
+		SEGGER_RTT_AllocUpBuffer("Trace", rtt_trace_buf,
+					 sizeof(rtt_trace_buf),
+					 SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+	rtt_size[RTT_BACKEND_TRACE] = sizeof(rtt_trace_buf);
+#endif
+
+#if CONFIG_RTT_BACKEND_DATA_BUFFER_SIZE > 0
+	rtt_index[RTT_BACKEND_DATA] =
+		SEGGER_RTT_AllocUpBuffer("Data", rtt_data_buf,
+					 sizeof(rtt_data_buf),
+					 SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+	rtt_size[RTT_BACKEND_DATA] = sizeof(rtt_data_buf);
+#endif
+
+	return 0;
+}
+
+SYS_INIT(rtt_backend_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Deferred logging core
+ *
+ * Messages are stored in a ring buffer of 32 bit words as:
+ * timestamp, module, format string, arguments; the level and number of
+ * arguments going in the item header. Producers serialize themselves by
+ * locking interrupts for the copy only, the logging thread being the only
+ * consumer it reads without locking.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include <kernel.h>
+#include <init.h>
+#include <atomic.h>
+#include <misc/printk.h>
+#include <misc/ring_buffer.h>
+#include <logging/sys_log.h>
+#include <logging/sys_log_core.h>
+
+/* Timestamp, module and format before the arguments */
+#define LOG_HDR_WORDS 3
+
+SYS_RING_BUF_DECLARE_POW2(sys_log_ring, CONFIG_SYS_LOG_CORE_BUFFER_POW2);
+
+static K_SEM_DEFINE(sys_log_sem, 0, 1);
+
+static sys_slist_t sys_log_modules;
+static sys_slist_t sys_log_backends;
+static atomic_t sys_log_dropped;
+
+#if defined(CONFIG_SYS_LOG_SHOW_TAGS)
+static const char * const sys_log_tags[] = {
+	"", " [ERR]", " [WRN]", " [INF]", " [DBG]"
+};
+#else
+static const char * const sys_log_tags[] = {
+	"", "", "", "", ""
+};
+#endif
+
+static void sys_log_module_register(struct sys_log_module *module)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	if (!module->registered) {
+		module->registered = 1;
+		sys_slist_append(&sys_log_modules, &module->node);
+	}
+	irq_unlock(key);
+}
+
+void sys_log_core_put(struct sys_log_module *module, uint8_t level,
+		      const char *fmt, uint8_t nargs, ...)
+{
+	uint32_t data[LOG_HDR_WORDS + SYS_LOG_CORE_MAX_ARGS];
+	unsigned int key;
+	va_list ap;
+	int i, err;
+
+	if (!module->registered) {
+		sys_log_module_register(module);
+	}
+
+	if (nargs > SYS_LOG_CORE_MAX_ARGS) {
+		nargs = SYS_LOG_CORE_MAX_ARGS;
+	}
+
+	data[0] = k_uptime_get_32();
+	data[1] = (uint32_t)(uintptr_t)module;
+	data[2] = (uint32_t)(uintptr_t)fmt;
+
+	va_start(ap, nargs);
+	for (i = 0; i < nargs; i++) {
+		data[LOG_HDR_WORDS + i] = va_arg(ap, uint32_t);
+	}
+	va_end(ap);
+
+	key = irq_lock();
+	err = sys_ring_buf_put(&sys_log_ring, level, nargs, data,
+			       LOG_HDR_WORDS + nargs);
+	if (err) {
+		module->dropped++;
+	}
+	irq_unlock(key);
+
+	if (err) {
+		atomic_inc(&sys_log_dropped);
+		return;
+	}
+
+	k_sem_give(&sys_log_sem);
+}
+
+int sys_log_core_level_set(const char *name, uint8_t level)
+{
+	struct sys_log_module *module;
+	sys_snode_t *node;
+	int ret = -ENOENT;
+
+	SYS_SLIST_FOR_EACH_NODE(&sys_log_modules, node) {
+		module = CONTAINER_OF(node, struct sys_log_module, node);
+		if (name && strcmp(name, module->name)) {
+			continue;
+		}
+
+		module->level = min(level, module->build_level);
+		ret = 0;
+	}
+
+	return ret;
+}
+
+uint32_t sys_log_core_dropped_get(void)
+{
+	return atomic_get(&sys_log_dropped);
+}
+
+void sys_log_backend_register(struct sys_log_backend *backend)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	sys_slist_append(&sys_log_backends, &backend->node);
+	irq_unlock(key);
+}
+
+static void sys_log_output(const char *line, int len)
+{
+	struct sys_log_backend *backend;
+	sys_snode_t *node;
+
+	/* snprintk() returns the length the line would have had */
+	if (len >= CONFIG_SYS_LOG_CORE_LINE_SIZE) {
+		len = CONFIG_SYS_LOG_CORE_LINE_SIZE - 1;
+	}
+
+	SYS_SLIST_FOR_EACH_NODE(&sys_log_backends, node) {
+		backend = CONTAINER_OF(node, struct sys_log_backend, node);
+		backend->put(line, len);
+	}
+}
+
+static void sys_log_process(uint16_t level, uint8_t nargs, uint32_t *data)
+{
+	static char line[CONFIG_SYS_LOG_CORE_LINE_SIZE];
+	struct sys_log_module *module = (void *)(uintptr_t)data[1];
+	const char *fmt = (const char *)(uintptr_t)data[2];
+	uint32_t *a = &data[LOG_HDR_WORDS];
+	int len;
+
+	/* Unused arguments are not read by the format */
+	memset(&a[nargs], 0, (SYS_LOG_CORE_MAX_ARGS - nargs) * sizeof(*a));
+
+	if (level >= ARRAY_SIZE(sys_log_tags)) {
+		level = 0;
+	}
+
+	len = snprintk(line, sizeof(line), "[%08u] [%s]%s ", data[0],
+		       module->name, sys_log_tags[level]);
+	if (len >= sizeof(line)) {
+		len = sizeof(line) - 1;
+	}
+
+	len += snprintk(line + len, sizeof(line) - len, fmt, a[0], a[1], a[2],
+			a[3], a[4], a[5], a[6], a[7], a[8], a[9]);
+
+	sys_log_output(line, len);
+}
+
+static void sys_log_thread(void *p1, void *p2, void *p3)
+{
+	uint32_t data[LOG_HDR_WORDS + SYS_LOG_CORE_MAX_ARGS];
+	uint32_t dropped, reported = 0;
+	uint16_t level;
+	uint8_t nargs, size;
+	char line[48];
+	int len;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&sys_log_sem, K_FOREVER);
+
+		while (1) {
+			size = ARRAY_SIZE(data);
+			if (sys_ring_buf_get(&sys_log_ring, &level, &nargs,
+					     data, &size)) {
+				break;
+			}
+
+			sys_log_process(level, nargs, data);
+		}
+
+		dropped = atomic_get(&sys_log_dropped);
+		if (dropped != reported) {
+			len = snprintk(line, sizeof(line),
+				       "--- %u messages dropped ---\n",
+				       dropped - reported);
+			sys_log_output(line, len);
+			reported = dropped;
+		}
+	}
+}
+
+K_THREAD_DEFINE(sys_log_thread_id, CONFIG_SYS_LOG_CORE_STACK_SIZE,
+		sys_log_thread, NULL, NULL, NULL,
+		CONFIG_SYS_LOG_CORE_THREAD_PRIORITY, 0, K_NO_WAIT);
+
+#if defined(CONFIG_SYS_LOG_CORE_BACKEND_CONSOLE)
+static void sys_log_console_put(const char *line, size_t len)
+{
+	ARG_UNUSED(len);
+
+	printk("%s", line);
+}
+
+static struct sys_log_backend sys_log_console = {
+	.put = sys_log_console_put,
+};
+
+static int sys_log_console_init(struct device *unused)
+{
+	ARG_UNUSED(unused);
+
+	sys_log_backend_register(&sys_log_console);
+
+	return 0;
+}
+
+SYS_INIT(sys_log_console_init, PRE_KERNEL_1,
+	 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+#endif /* CONFIG_SYS_LOG_CORE_BACKEND_CONSOLE */
+
+#if defined(CONFIG_SYS_LOG_CORE_SHELL)
+#include <stdlib.h>
+#include <shell/shell.h>
+
+static int shell_cmd_level(int argc, char *argv[])
+{
+	const char *name = NULL;
+	int level;
+
+	if (argc < 2) {
+		printk("usage: level [<module>] <0-4>\n");
+		return 0;
+	}
+
+	if (argc > 2) {
+		name = argv[1];
+	}
+
+	level = atoi(argv[argc - 1]);
+	if (level < SYS_LOG_LEVEL_OFF || level > SYS_LOG_LEVEL_DEBUG) {
+		printk("Invalid level %d\n", level);
+		return 0;
+	}
+
+	if (sys_log_core_level_set(name, level)) {
+		printk("No module %s\n", name);
+	}
+
+	return 0;
+}
+
+static int shell_cmd_modules(int argc, char *argv[])
+{
+	struct sys_log_module *module;
+	sys_snode_t *node;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	printk("Module\tLevel\tMax\tDropped\n");
+
+	SYS_SLIST_FOR_EACH_NODE(&sys_log_modules, node) {
+		module = CONTAINER_OF(node, struct sys_log_module, node);
+		printk("%s\t%u\t%u\t%u\n", module->name, module->level,
+		       module->build_level, module->dropped);
+	}
+
+	return 0;
+}
+
+static int shell_cmd_stats(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	printk("Dropped messages: %u\n", sys_log_core_dropped_get());
+	printk("Buffer space: %d/%u words\n",
+	       sys_ring_buf_space_get(&sys_log_ring), sys_log_ring.size);
+
+	return 0;
+}
+
+static struct shell_cmd sys_log_commands[] = {
+	{ "level", shell_cmd_level,
+	  "Set the level of a module, or of all: [<module>] <0-4>" },
+	{ "modules", shell_cmd_modules, "List the registered modules" },
+	{ "stats", shell_cmd_stats, "Show drop counters" },
+	{ NULL, NULL, NULL }
+};
+
+SHELL_REGISTER("log", sys_log_commands);
+#endif /* CONFIG_SYS_LOG_CORE_SHELL */
@@ -14,6 +14,13 @@
 
 #include <net/buf.h>
 
+#ifdef CONFIG_DMA_MEMCPY_NET_BUF
+#include <dma.h>
+#define buf_memcpy dma_memcpy_sys
+#else
+#define buf_memcpy memcpy
+#endif
+
 #if defined(CONFIG_NET_BUF_LOG)
 #define SYS_LOG_DOMAIN "net/buf"
 #define SYS_LOG_LEVEL CONFIG_SYS_LOG_NET_BUF_LEVEL
@@ -58,6 +65,81 @@ static inline struct net_buf *pool_get_uninit(struct net_buf_pool *pool,
 	return buf;
 }
 
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+static inline void pool_stats_alloc(struct net_buf_pool *pool)
+{
+	unsigned int key = irq_lock();
+
+	pool->stats.alloc++;
+
+	if (++pool->stats.used > pool->stats.peak) {
+		pool->stats.peak = pool->stats.used;
+	}
+
+	if (pool->stats.used == pool->buf_count) {
+		pool->stats.empty++;
+	}
+
+	irq_unlock(key);
+}
+
+static inline void pool_stats_fail(struct net_buf_pool *pool)
+{
+	unsigned int key = irq_lock();
+
+	pool->stats.fail++;
+	irq_unlock(key);
+}
+
+static struct net_buf *pool_wait(struct net_buf_pool *pool, int32_t timeout)
+{
+	uint32_t start = k_uptime_get_32();
+	struct net_buf *buf;
+	unsigned int key;
+
+	buf = k_lifo_get(&pool->free, timeout);
+
+	key = irq_lock();
+	pool->stats.wait++;
+	pool->stats.wait_ms += k_uptime_get_32() - start;
+	irq_unlock(key);
+
+	return buf;
+}
+
+void net_buf_pool_stats_get(struct net_buf_pool *pool,
+			    struct net_buf_pool_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	*stats = pool->stats;
+	irq_unlock(key);
+}
+
+void net_buf_pool_foreach_used(struct net_buf_pool *pool,
+			       void (*cb)(struct net_buf *buf,
+					  void *user_data),
+			       void *user_data)
+{
+	int i;
+
+	/* Only the buffers below uninit_count have ever been allocated, the
+	 * free ones have no reference.
+	 */
+	for (i = 0; i < pool->buf_count - pool->uninit_count; i++) {
+		struct net_buf *buf = UNINIT_BUF(pool, i);
+
+		if (buf->ref) {
+			cb(buf, user_data);
+		}
+	}
+}
+#else
+#define pool_stats_alloc(...)
+#define pool_stats_fail(...)
+#define pool_wait(_pool, _timeout) k_lifo_get(&(_pool)->free, _timeout)
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+
 #if defined(CONFIG_NET_BUF_LOG)
 struct net_buf *net_buf_alloc_debug(struct net_buf_pool *pool, int32_t timeout,
 				    const char *func, int line)
@@ -104,28 +186,29 @@ struct net_buf *net_buf_alloc(struct net_buf_pool *pool, int32_t timeout)
 
 	irq_unlock(key);
 
+	buf = k_lifo_get(&pool->free, K_NO_WAIT);
+	if (!buf && timeout != K_NO_WAIT) {
 #if defined(CONFIG_NET_BUF_LOG) && SYS_LOG_LEVEL >= SYS_LOG_LEVEL_WARNING
-	if (timeout == K_FOREVER) {
-		buf = k_lifo_get(&pool->free, K_NO_WAIT);
-		if (!buf) {
+		if (timeout == K_FOREVER) {
 			NET_BUF_WARN("%s():%d: Pool %p low on buffers.",
 				     func, line, pool);
-			buf = k_lifo_get(&pool->free, timeout);
 		}
-	} else {
-		buf = k_lifo_get(&pool->free, timeout);
-	}
-#else
-	buf = k_lifo_get(&pool->free, timeout);
 #endif
+		buf = pool_wait(pool, timeout);
+	}
+
 	if (!buf) {
 		NET_BUF_ERR("%s():%d: Failed to get free buffer", func, line);
+		pool_stats_fail(pool);
 		return NULL;
 	}
 
 success:
 	NET_BUF_DBG("allocated buf %p", buf);
 
+	pool_stats_alloc(pool);
+	net_buf_set_owner(buf, __builtin_return_address(0));
+
 	buf->ref   = 1;
 	buf->len   = 0;
 	buf->data  = buf->__buf;
@@ -135,6 +218,42 @@ success:
 	return buf;
 }
 
+#if defined(CONFIG_NET_BUF_LOG)
+struct net_buf *net_buf_alloc_ext_debug(struct net_buf_pool *pool,
+					uint8_t *data, uint16_t len,
+					int32_t timeout, const char *func,
+					int line)
+#else
+struct net_buf *net_buf_alloc_ext(struct net_buf_pool *pool, uint8_t *data,
+				  uint16_t len, int32_t timeout)
+#endif
+{
+	struct net_buf *buf;
+
+	NET_BUF_ASSERT(pool->buf_size >= sizeof(uint8_t *));
+
+#if defined(CONFIG_NET_BUF_LOG)
+	buf = net_buf_alloc_debug(pool, timeout, func, line);
+#else
+	buf = net_buf_alloc(pool, timeout);
+#endif
+	if (!buf) {
+		return NULL;
+	}
+
+	net_buf_set_owner(buf, __builtin_return_address(0));
+
+	/* The buffer storage only records where the data starts */
+	*(uint8_t **)buf->__buf = data;
+
+	buf->data  = data;
+	buf->len   = len;
+	buf->size  = len;
+	buf->flags = NET_BUF_EXTERNAL_DATA;
+
+	return buf;
+}
+
 #if defined(CONFIG_NET_BUF_LOG)
 struct net_buf *net_buf_get_debug(struct k_fifo *fifo, int32_t timeout,
 				  const char *func, int line)
@@ -175,7 +294,11 @@ void net_buf_reserve(struct net_buf *buf, size_t reserve)
 	NET_BUF_ASSERT(buf->len == 0);
 	NET_BUF_DBG("buf %p reserve %zu", buf, reserve);
 
-	buf->data = buf->__buf + reserve;
+	if (buf->flags & NET_BUF_EXTERNAL_DATA) {
+		buf->data = net_buf_ext_data(buf) + reserve;
+	} else {
+		buf->data = buf->__buf + reserve;
+	}
 }
 
 void net_buf_put(struct k_fifo *fifo, struct net_buf *buf)
@@ -192,6 +315,36 @@ void net_buf_put(struct k_fifo *fifo, struct net_buf *buf)
 	k_fifo_put_list(fifo, buf, tail);
 }
 
+void net_buf_put_list(struct k_fifo *fifo, struct net_buf **bufs, int count)
+{
+	struct net_buf *head = NULL, *tail = NULL;
+	int i;
+
+	NET_BUF_ASSERT(fifo);
+	NET_BUF_ASSERT(bufs || !count);
+
+	for (i = 0; i < count; i++) {
+		NET_BUF_ASSERT(bufs[i]);
+
+		/* Only the fragments of a buffer are flagged, so that
+		 * net_buf_get() stops at the next buffer.
+		 */
+		if (tail) {
+			tail->frags = bufs[i];
+		} else {
+			head = bufs[i];
+		}
+
+		for (tail = bufs[i]; tail->frags; tail = tail->frags) {
+			tail->flags |= NET_BUF_FRAGS;
+		}
+	}
+
+	if (head) {
+		k_fifo_put_list(fifo, head, tail);
+	}
+}
+
 #if defined(CONFIG_NET_BUF_LOG)
 void net_buf_unref_debug(struct net_buf *buf, const char *func, int line)
 #else
@@ -245,6 +398,12 @@ struct net_buf *net_buf_clone(struct net_buf *buf, int32_t timeout)
 
 	NET_BUF_ASSERT(buf);
 
+	/* External data belongs to the pool user, it cannot be duplicated */
+	if (buf->flags & NET_BUF_EXTERNAL_DATA) {
+		NET_BUF_ERR("Cannot clone buf %p with external data", buf);
+		return NULL;
+	}
+
 	clone = net_buf_alloc(buf->pool, timeout);
 	if (!clone) {
 		return NULL;
@@ -253,7 +412,7 @@ struct net_buf *net_buf_clone(struct net_buf *buf, int32_t timeout)
 	net_buf_reserve(clone, net_buf_headroom(buf));
 
 	/* TODO: Add reference to the original buffer instead of copying it. */
-	memcpy(net_buf_add(clone, buf->len), buf->data, buf->len);
+	buf_memcpy(net_buf_add(clone, buf->len), buf->data, buf->len);
 
 	return clone;
 }
@@ -345,7 +504,7 @@ void *net_buf_simple_add_mem(struct net_buf_simple *buf, const void *mem,
 {
 	NET_BUF_SIMPLE_DBG("buf %p len %zu", buf, len);
 
-	return memcpy(net_buf_simple_add(buf, len), mem, len);
+	return buf_memcpy(net_buf_simple_add(buf, len), mem, len);
 }
 
 uint8_t *net_buf_simple_add_u8(struct net_buf_simple *buf, uint8_t val)
@@ -495,3 +654,17 @@ size_t net_buf_simple_tailroom(struct net_buf_simple *buf)
 {
 	return buf->size - net_buf_simple_headroom(buf) - buf->len;
 }
+
+size_t net_buf_headroom(struct net_buf *buf)
+{
+	if (buf->flags & NET_BUF_EXTERNAL_DATA) {
+		return buf->data - net_buf_ext_data(buf);
+	}
+
+	return net_buf_simple_headroom(&buf->b);
+}
+
+size_t net_buf_tailroom(struct net_buf *buf)
+{
+	return buf->size - net_buf_headroom(buf) - buf->len;
+}
@@ -24,6 +24,7 @@
 #include "icmpv4.h"
 #include "connection.h"
 #include "net_stats.h"
+#include "tcp.h"
 
 /** Is this connection used or not */
 #define NET_CONN_IN_USE BIT(0)
@@ -42,8 +43,25 @@
 #define NET_RANK_LOCAL_SPEC_ADDR    BIT(4)
 #define NET_RANK_REMOTE_SPEC_ADDR   BIT(5)
 
+/** Rank of a connection bound to a remote address and both ports */
+#define NET_RANK_CONNECTED (NET_RANK_REMOTE_SPEC_ADDR | \
+			    NET_RANK_REMOTE_PORT | NET_RANK_LOCAL_PORT)
+
 static struct net_conn conns[CONFIG_NET_MAX_CONN];
 
+/* Lookup hash tables. Connections bound to a remote address and port
+ * and to a local port are hashed on the protocol, both ports and the
+ * remote address. The other ones (listeners) are hashed on the protocol
+ * and the local port, except those without a local port, which are
+ * kept in the wildcard list. As a connected match has a remote port, it
+ * is never overridden by a listener (see conn_find()), so listeners are
+ * only looked at if there is no connected match. Ports are hashed in
+ * network byte order.
+ */
+static sys_slist_t conn_connected[CONFIG_NET_CONN_HASH_BUCKETS];
+static sys_slist_t conn_listeners[CONFIG_NET_CONN_HASH_BUCKETS];
+static sys_slist_t conn_wildcard;
+
 /* This is only used for getting source and destination ports. Because
  * both TCP and UDP header have these in the same location, we can check
  * them both using the UDP struct.
@@ -70,6 +88,112 @@ static inline const char *proto2str(enum net_ip_protocol proto)
 }
 #endif /* CONFIG_NET_DEBUG_CONN */
 
+static inline uint32_t addr_to_hash(sa_family_t family, const void *addr)
+{
+#if defined(CONFIG_NET_IPV6)
+	if (family == AF_INET6) {
+		const struct in6_addr *addr6 = addr;
+
+		return addr6->s6_addr32[0] ^ addr6->s6_addr32[1] ^
+			addr6->s6_addr32[2] ^ addr6->s6_addr32[3];
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4)
+	if (family == AF_INET) {
+		return ((const struct in_addr *)addr)->s_addr[0];
+	}
+#endif
+
+	return 0;
+}
+
+static inline uint32_t hash_to_bucket(uint32_t hash)
+{
+	/* Fold the upper bits in, as the lower bits of addresses and
+	 * ports are often the same across connections.
+	 */
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+
+	return hash % CONFIG_NET_CONN_HASH_BUCKETS;
+}
+
+static inline sys_slist_t *connected_bucket(uint8_t proto,
+					    sa_family_t family,
+					    const void *remote_addr,
+					    uint16_t remote_port,
+					    uint16_t local_port)
+{
+	uint32_t hash = addr_to_hash(family, remote_addr);
+
+	hash ^= ((uint32_t)remote_port << 16) | local_port;
+	hash ^= proto;
+
+	return &conn_connected[hash_to_bucket(hash)];
+}
+
+static inline sys_slist_t *listener_bucket(uint8_t proto,
+					   uint16_t local_port)
+{
+	return &conn_listeners[hash_to_bucket(((uint32_t)proto << 16) |
+					      local_port)];
+}
+
+/* Return the bucket a registered connection belongs to */
+static sys_slist_t *conn_to_bucket(struct net_conn *conn)
+{
+	uint16_t local_port = net_sin(&conn->local_addr)->sin_port;
+	const void *addr = NULL;
+
+	if ((conn->rank & NET_RANK_CONNECTED) != NET_RANK_CONNECTED) {
+		if (local_port) {
+			return listener_bucket(conn->proto, local_port);
+		}
+
+		return &conn_wildcard;
+	}
+
+#if defined(CONFIG_NET_IPV6)
+	if (conn->remote_addr.family == AF_INET6) {
+		addr = &net_sin6(&conn->remote_addr)->sin6_addr;
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4)
+	if (conn->remote_addr.family == AF_INET) {
+		addr = &net_sin(&conn->remote_addr)->sin_addr;
+	}
+#endif
+
+	return connected_bucket(conn->proto, conn->remote_addr.family, addr,
+				net_sin(&conn->remote_addr)->sin_port,
+				local_port);
+}
+
+/* Return the connected bucket a received packet hashes to */
+static sys_slist_t *buf_to_bucket(enum net_ip_protocol proto,
+				  struct net_buf *buf)
+{
+	const void *addr = NULL;
+
+#if defined(CONFIG_NET_IPV6)
+	if (net_nbuf_family(buf) == AF_INET6) {
+		addr = &NET_IPV6_BUF(buf)->src;
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4)
+	if (net_nbuf_family(buf) == AF_INET) {
+		addr = &NET_IPV4_BUF(buf)->src;
+	}
+#endif
+
+	return connected_bucket(proto, net_nbuf_family(buf), addr,
+				NET_CONN_BUF(buf)->src_port,
+				NET_CONN_BUF(buf)->dst_port);
+}
+
 #if defined(CONFIG_NET_CONN_CACHE)
 
 /* Cache the connection so that we do not have to go
@@ -352,8 +476,13 @@ int net_conn_unregister(struct net_conn_handle *handle)
 	NET_DBG("[%zu] connection handler %p removed",
 		(conn - conns) / sizeof(*conn), conn);
 
+	sys_slist_find_and_remove(conn_to_bucket(conn), &conn->node);
+
 	conn->flags = 0;
 
+	/* The cache might still point to the removed entry */
+	cache_clear();
+
 	return 0;
 }
 
@@ -449,6 +578,9 @@ int net_conn_register(enum net_ip_protocol proto,
 			continue;
 		}
 
+		/* Clear the leftovers of a previous registration */
+		memset(&conns[i], 0, sizeof(conns[i]));
+
 		if (remote_addr) {
 			if (remote_addr->family != AF_INET &&
 			    remote_addr->family != AF_INET6) {
@@ -545,6 +677,8 @@ int net_conn_register(enum net_ip_protocol proto,
 		conns[i].rank = rank;
 		conns[i].proto = proto;
 
+		sys_slist_append(conn_to_bucket(&conns[i]), &conns[i].node);
+
 		/* Cache needs to be cleared if new entries are added. */
 		cache_clear();
 
@@ -646,59 +780,72 @@ static inline void send_icmp_error(struct net_buf *buf)
 	}
 }
 
-enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_buf *buf)
+#if defined(CONFIG_NET_RX_CHKSUM)
+static bool is_chksum_valid(enum net_ip_protocol proto, struct net_buf *buf)
 {
-	int i, best_match = -1;
-	int16_t best_rank = -1;
+	if (net_nbuf_rx_chksum_offloaded(buf)) {
+		return true;
+	}
 
-#if defined(CONFIG_NET_CONN_CACHE)
-	enum net_verdict verdict;
-	uint32_t cache_value = 0;
-	int32_t pos;
+	/* A zero UDP checksum over IPv4 means that there is none */
+	if (proto == IPPROTO_UDP && net_nbuf_family(buf) == AF_INET &&
+	    !NET_UDP_BUF(buf)->chksum) {
+		return true;
+	}
 
-	verdict = cache_check(proto, buf, &cache_value, &pos);
-	if (verdict != NET_CONTINUE) {
-		return verdict;
+	if (net_calc_chksum(buf, proto) == 0xffff) {
+		return true;
 	}
-#endif
 
-	NET_DBG("Check %s listener for buf %p src port %u dst port %u "
-		"family %d", proto2str(proto), buf,
-		ntohs(NET_CONN_BUF(buf)->src_port),
-		ntohs(NET_CONN_BUF(buf)->dst_port),
-		net_nbuf_family(buf));
+	if (proto == IPPROTO_UDP) {
+		net_stats_update_udp_chkerr();
+	} else {
+		net_stats_update_tcp_chkerr();
+	}
 
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (!(conns[i].flags & NET_CONN_IN_USE)) {
-			continue;
-		}
+	return false;
+}
+#endif /* CONFIG_NET_RX_CHKSUM */
+
+/* Return the index of the best matching connection of a bucket, or
+ * best_match if none of its connections is a better match.
+ */
+static int conn_find(sys_slist_t *list, enum net_ip_protocol proto,
+		     struct net_buf *buf, int best_match)
+{
+	int16_t best_rank = best_match < 0 ? -1 : conns[best_match].rank;
+	sys_snode_t *node;
 
-		if (conns[i].proto != proto) {
+	SYS_SLIST_FOR_EACH_NODE(list, node) {
+		struct net_conn *conn = CONTAINER_OF(node, struct net_conn,
+						     node);
+
+		if (conn->proto != proto) {
 			continue;
 		}
 
-		if (net_sin(&conns[i].remote_addr)->sin_port) {
-			if (net_sin(&conns[i].remote_addr)->sin_port !=
+		if (net_sin(&conn->remote_addr)->sin_port) {
+			if (net_sin(&conn->remote_addr)->sin_port !=
 			    NET_CONN_BUF(buf)->src_port) {
 				continue;
 			}
 		}
 
-		if (net_sin(&conns[i].local_addr)->sin_port) {
-			if (net_sin(&conns[i].local_addr)->sin_port !=
+		if (net_sin(&conn->local_addr)->sin_port) {
+			if (net_sin(&conn->local_addr)->sin_port !=
 			    NET_CONN_BUF(buf)->dst_port) {
 				continue;
 			}
 		}
 
-		if (conns[i].flags & NET_CONN_REMOTE_ADDR_SET) {
-			if (!check_addr(buf, &conns[i].remote_addr, true)) {
+		if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
+			if (!check_addr(buf, &conn->remote_addr, true)) {
 				continue;
 			}
 		}
 
-		if (conns[i].flags & NET_CONN_LOCAL_ADDR_SET) {
-			if (!check_addr(buf, &conns[i].local_addr, false)) {
+		if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
+			if (!check_addr(buf, &conn->local_addr, false)) {
 				continue;
 			}
 		}
@@ -712,10 +859,65 @@ enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_buf *buf)
 			continue;
 		}
 
-		if (best_rank < conns[i].rank) {
-			best_rank = conns[i].rank;
-			best_match = i;
+		if (best_rank < conn->rank) {
+			best_rank = conn->rank;
+			best_match = conn - conns;
+		}
+	}
+
+	return best_match;
+}
+
+enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_buf *buf)
+{
+	int best_match;
+
+#if defined(CONFIG_NET_CONN_CACHE)
+	enum net_verdict verdict;
+	uint32_t cache_value = 0;
+	int32_t pos;
+#endif
+
+	net_stats_update_latency(buf, NET_STATS_LATENCY_RX_PROCESS);
+
+#if defined(CONFIG_NET_RX_CHKSUM)
+	if (!is_chksum_valid(proto, buf)) {
+		NET_DBG("Drop %s buf %p with bad checksum", proto2str(proto),
+			buf);
+		return NET_DROP;
+	}
+#endif
+
+#if defined(CONFIG_NET_CONN_CACHE)
+	verdict = cache_check(proto, buf, &cache_value, &pos);
+	if (verdict != NET_CONTINUE) {
+		return verdict;
+	}
+#endif
+
+	NET_DBG("Check %s listener for buf %p src port %u dst port %u "
+		"family %d", proto2str(proto), buf,
+		ntohs(NET_CONN_BUF(buf)->src_port),
+		ntohs(NET_CONN_BUF(buf)->dst_port),
+		net_nbuf_family(buf));
+
+	best_match = conn_find(buf_to_bucket(proto, buf), proto, buf, -1);
+	if (best_match < 0) {
+		sys_slist_t *bucket;
+
+#if defined(CONFIG_NET_TCP)
+		/* A connection in TIME_WAIT has no handler any more, its
+		 * segments must not reach a listener of the port.
+		 */
+		if (proto == IPPROTO_TCP && net_tcp_time_wait_input(buf)) {
+			return NET_DROP;
 		}
+#endif
+
+		bucket = listener_bucket(proto, NET_CONN_BUF(buf)->dst_port);
+
+		best_match = conn_find(bucket, proto, buf, -1);
+		best_match = conn_find(&conn_wildcard, proto, buf, best_match);
 	}
 
 	if (best_match >= 0) {
@@ -783,13 +985,18 @@ drop:
 
 void net_conn_init(void)
 {
-#if defined(CONFIG_NET_CONN_CACHE)
-	do {
-		int i;
+	int i;
 
-		for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-			conn_cache[i].idx = -1;
-		}
-	} while (0);
+	for (i = 0; i < CONFIG_NET_CONN_HASH_BUCKETS; i++) {
+		sys_slist_init(&conn_connected[i]);
+		sys_slist_init(&conn_listeners[i]);
+	}
+
+	sys_slist_init(&conn_wildcard);
+
+#if defined(CONFIG_NET_CONN_CACHE)
+	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
+		conn_cache[i].idx = -1;
+	}
 #endif /* CONFIG_NET_CONN_CACHE */
 }
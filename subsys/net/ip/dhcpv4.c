@@ -98,6 +98,10 @@ static uint8_t magic_cookie[4] = { 0x63, 0x82, 0x53, 0x63 }; /* RFC 1497 [17] */
 
 static void dhcpv4_timeout(struct k_work *work);
 
+#if defined(CONFIG_NET_DHCPV4_LEASE_STORAGE)
+static const struct net_dhcpv4_storage *lease_storage;
+#endif
+
 /*
  * Timeout for Initialization and allocation of network address.
  * Timeout value is from random number between 1-10 seconds.
@@ -263,7 +267,9 @@ static void setup_header(struct net_buf *buf)
 	ipv4->proto = IPPROTO_UDP;
 	ipv4->len[0] = len >> 8;
 	ipv4->len[1] = (uint8_t)len;
-	ipv4->chksum = ~net_calc_chksum_ipv4(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		ipv4->chksum = ~net_calc_chksum_ipv4(buf);
+	}
 
 	net_ipaddr_copy(&ipv4->dst, net_ipv4_broadcast_address());
 
@@ -272,7 +278,10 @@ static void setup_header(struct net_buf *buf)
 	udp->src_port = htons(DHCPV4_CLIENT_PORT);
 	udp->dst_port = htons(DHCPV4_SERVER_PORT);
 	udp->len = htons(len);
-	udp->chksum = ~net_calc_chksum_udp(buf);
+	udp->chksum = 0;
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		udp->chksum = ~net_calc_chksum_udp(buf);
+	}
 }
 
 /* Prepare initial DHCPv4 message and add options as per message type */
@@ -346,8 +355,11 @@ fail:
 	return NULL;
 }
 
-/* Prepare DHCPv4 Message request and send it to peer */
-static void send_request(struct net_if *iface, bool renewal)
+/*
+ * Prepare DHCPv4 Message request and send it to peer. The state is
+ * NET_DHCPV4_REQUEST, NET_DHCPV4_RENEWAL or NET_DHCPV4_INIT_REBOOT.
+ */
+static void send_request(struct net_if *iface, enum net_dhcpv4_state state)
 {
 	struct net_buf *buf;
 
@@ -356,7 +368,10 @@ static void send_request(struct net_if *iface, bool renewal)
 		goto fail;
 	}
 
-	if (!add_server_id(buf) ||
+	/* No server identifier when verifying a previous lease,
+	 * RFC 2131, Chapter 4.3.2.
+	 */
+	if ((state != NET_DHCPV4_INIT_REBOOT && !add_server_id(buf)) ||
 	    !add_req_ipaddr(buf) ||
 	    !add_end(buf)) {
 		goto fail;
@@ -368,11 +383,7 @@ static void send_request(struct net_if *iface, bool renewal)
 		goto fail;
 	}
 
-	if (renewal) {
-		iface->dhcpv4.state = NET_DHCPV4_RENEWAL;
-	} else {
-		iface->dhcpv4.state = NET_DHCPV4_REQUEST;
-	}
+	iface->dhcpv4.state = state;
 
 	iface->dhcpv4.attempts++;
 
@@ -395,6 +406,7 @@ static void send_discover(struct net_if *iface)
 	struct net_buf *buf;
 
 	iface->dhcpv4.xid++;
+	iface->dhcpv4.attempts = 0;
 
 	buf = prepare_message(iface, DHCPV4_MSG_TYPE_DISCOVER);
 	if (!buf) {
@@ -452,7 +464,23 @@ static void dhcpv4_timeout(struct k_work *work)
 			send_discover(iface);
 		} else {
 			/* Repeat requests until max number of attempts */
-			send_request(iface, false);
+			send_request(iface, NET_DHCPV4_REQUEST);
+		}
+		break;
+	case NET_DHCPV4_INIT_REBOOT:
+		if (iface->dhcpv4.attempts >= DHCPV4_MAX_NUMBER_OF_ATTEMPTS) {
+			/*
+			 * No server confirms the stored lease, get a new
+			 * one. The lease is kept for the next reboot.
+			 */
+			if (IS_ENABLED(CONFIG_NET_DHCPV4_OPTIMISTIC)) {
+				net_if_ipv4_addr_rm(
+					iface, &iface->dhcpv4.requested_ip);
+			}
+
+			send_discover(iface);
+		} else {
+			send_request(iface, NET_DHCPV4_INIT_REBOOT);
 		}
 		break;
 	case NET_DHCPV4_RENEWAL:
@@ -469,7 +497,7 @@ static void dhcpv4_timeout(struct k_work *work)
 			send_discover(iface);
 		} else {
 			/* Repeat renewal request for max number of attempts */
-			send_request(iface, true);
+			send_request(iface, NET_DHCPV4_RENEWAL);
 		}
 		break;
 	default:
@@ -488,9 +516,75 @@ static void dhcpv4_t1_timeout(struct k_work *work)
 		return;
 	}
 
-	send_request(iface, true);
+	send_request(iface, NET_DHCPV4_RENEWAL);
+}
+
+#if defined(CONFIG_NET_DHCPV4_LEASE_STORAGE)
+static void lease_save(struct net_if *iface)
+{
+	struct net_dhcpv4_lease lease;
+
+	if (!lease_storage) {
+		return;
+	}
+
+	net_ipaddr_copy(&lease.addr, &iface->dhcpv4.requested_ip);
+	net_ipaddr_copy(&lease.server_id, &iface->dhcpv4.server_id);
+	net_ipaddr_copy(&lease.netmask, &iface->ipv4.netmask);
+	net_ipaddr_copy(&lease.gw, &iface->ipv4.gw);
+	lease.lease_time = iface->dhcpv4.lease_time;
+
+	if (lease_storage->save(iface, &lease) < 0) {
+		NET_DBG("Cannot save the lease");
+	}
+}
+
+static void lease_clear(struct net_if *iface)
+{
+	if (lease_storage && lease_storage->clear(iface) < 0) {
+		NET_DBG("Cannot clear the lease");
+	}
+}
+
+/* Start from a stored lease, true if there is one */
+static bool lease_restore(struct net_if *iface)
+{
+	struct net_dhcpv4_lease lease;
+
+	if (!lease_storage || lease_storage->load(iface, &lease) < 0 ||
+	    !lease.addr.s4_addr32[0] || !lease.lease_time) {
+		return false;
+	}
+
+	net_ipaddr_copy(&iface->dhcpv4.requested_ip, &lease.addr);
+	net_ipaddr_copy(&iface->dhcpv4.server_id, &lease.server_id);
+	iface->dhcpv4.lease_time = lease.lease_time;
+
+	NET_DBG("Stored lease %s", net_sprint_ipv4_addr(&lease.addr));
+
+	if (IS_ENABLED(CONFIG_NET_DHCPV4_OPTIMISTIC)) {
+		net_if_ipv4_set_netmask(iface, &lease.netmask);
+		net_if_ipv4_set_gw(iface, &lease.gw);
+
+		if (!net_if_ipv4_addr_add(iface, &lease.addr, NET_ADDR_DHCP,
+					  lease.lease_time)) {
+			NET_DBG("Failed to add IPv4 addr to iface %p", iface);
+		}
+	}
+
+	return true;
 }
 
+void net_dhcpv4_set_storage(const struct net_dhcpv4_storage *storage)
+{
+	lease_storage = storage;
+}
+#else
+#define lease_save(...)
+#define lease_clear(...)
+#define lease_restore(...) false
+#endif /* CONFIG_NET_DHCPV4_LEASE_STORAGE */
+
 /*
  * Parse DHCPv4 options and retrieve relavant information
  * as per RFC 2132.
@@ -646,19 +740,37 @@ static inline void handle_dhcpv4_reply(struct net_if *iface, uint8_t msg_type)
 	 * Rest of the replies are discarded.
 	 */
 	if (iface->dhcpv4.state == NET_DHCPV4_DISCOVER) {
-		if (msg_type != NET_DHCPV4_OFFER) {
+		if (msg_type != DHCPV4_MSG_TYPE_OFFER) {
 			NET_DBG("Reply not handled %d", msg_type);
 			return;
 		}
 
 		/* Send DHCPv4 Request Message */
 		k_delayed_work_cancel(&iface->dhcpv4_timeout);
-		send_request(iface, false);
+		send_request(iface, NET_DHCPV4_REQUEST);
 
 	} else if (iface->dhcpv4.state == NET_DHCPV4_REQUEST ||
-		   iface->dhcpv4.state == NET_DHCPV4_RENEWAL) {
+		   iface->dhcpv4.state == NET_DHCPV4_RENEWAL ||
+		   iface->dhcpv4.state == NET_DHCPV4_INIT_REBOOT) {
+
+		if (msg_type == DHCPV4_MSG_TYPE_NAK) {
+			NET_DBG("Address %s refused",
+				net_sprint_ipv4_addr(
+					&iface->dhcpv4.requested_ip));
 
-		if (msg_type != NET_DHCPV4_ACK) {
+			k_delayed_work_cancel(&iface->dhcpv4_timeout);
+
+			/* The address is in use if renewing, or with an
+			 * optimistic INIT-REBOOT.
+			 */
+			net_if_ipv4_addr_rm(iface, &iface->dhcpv4.requested_ip);
+
+			lease_clear(iface);
+			send_discover(iface);
+			return;
+		}
+
+		if (msg_type != DHCPV4_MSG_TYPE_ACK) {
 			NET_DBG("Reply not handled %d", msg_type);
 			return;
 		}
@@ -666,6 +778,14 @@ static inline void handle_dhcpv4_reply(struct net_if *iface, uint8_t msg_type)
 		k_delayed_work_cancel(&iface->dhcpv4_timeout);
 
 		switch (iface->dhcpv4.state) {
+		case NET_DHCPV4_INIT_REBOOT:
+			if (net_if_ipv4_addr_lookup(&iface->dhcpv4.requested_ip,
+						    NULL)) {
+				/* Optimistically added already */
+				break;
+			}
+
+			/* Fall through */
 		case NET_DHCPV4_REQUEST:
 			NET_INFO("Received: %s",
 				 net_sprint_ipv4_addr(
@@ -692,6 +812,8 @@ static inline void handle_dhcpv4_reply(struct net_if *iface, uint8_t msg_type)
 		iface->dhcpv4.attempts = 0;
 		iface->dhcpv4.state = NET_DHCPV4_ACK;
 
+		lease_save(iface);
+
 		/* Start renewal time */
 		k_delayed_work_init(&iface->dhcpv4_t1_timer,
 				    dhcpv4_t1_timeout);
@@ -708,7 +830,7 @@ static enum net_verdict net_dhcpv4_input(struct net_conn *conn,
 	struct dhcp_msg *msg;
 	struct net_buf *frag;
 	struct net_if *iface;
-	uint8_t	msg_type;
+	uint8_t	msg_type = 0;
 	uint8_t min;
 	uint16_t pos;
 
@@ -763,9 +885,6 @@ static enum net_verdict net_dhcpv4_input(struct net_conn *conn,
 		goto drop;
 	}
 
-	memcpy(iface->dhcpv4.requested_ip.s4_addr, msg->yiaddr,
-	       sizeof(msg->yiaddr));
-
 	/* sname, file are not used at the moment, skip it */
 	frag = net_nbuf_skip(frag, min, &pos, SIZE_OF_SNAME + SIZE_OF_FILE);
 	if (!frag && pos) {
@@ -777,6 +896,12 @@ static enum net_verdict net_dhcpv4_input(struct net_conn *conn,
 		goto drop;
 	}
 
+	/* A NAK has no address, the refused one is still needed */
+	if (msg_type != DHCPV4_MSG_TYPE_NAK) {
+		memcpy(iface->dhcpv4.requested_ip.s4_addr, msg->yiaddr,
+		       sizeof(msg->yiaddr));
+	}
+
 	net_nbuf_unref(buf);
 
 	handle_dhcpv4_reply(iface, msg_type);
@@ -816,5 +941,11 @@ void net_dhcpv4_start(struct net_if *iface)
 		return;
 	}
 
+	/* Confirm the lease of the last boot with a single request */
+	if (lease_restore(iface)) {
+		send_request(iface, NET_DHCPV4_INIT_REBOOT);
+		return;
+	}
+
 	send_discover(iface);
 }
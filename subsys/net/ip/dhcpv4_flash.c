@@ -0,0 +1,129 @@
+/** @file
+ * @brief DHCPv4 lease storage in flash
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_DHCPV4)
+#define SYS_LOG_DOMAIN "net/dhcpv4"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <init.h>
+#include <flash.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/dhcpv4.h>
+
+#define LEASE_OFFSET	CONFIG_NET_DHCPV4_LEASE_FLASH_OFFSET
+#define LEASE_MAGIC	0x44484350 /* "DHCP" */
+
+struct lease_record {
+	uint32_t magic;
+	struct net_dhcpv4_lease lease;
+};
+
+static struct device *flash_dev;
+
+static int lease_flash_load(struct net_if *iface,
+			    struct net_dhcpv4_lease *lease)
+{
+	struct lease_record record;
+
+	if (flash_read(flash_dev, LEASE_OFFSET, &record, sizeof(record))) {
+		return -EIO;
+	}
+
+	/* Erased flash reads as all ones */
+	if (record.magic != LEASE_MAGIC) {
+		return -ENOENT;
+	}
+
+	memcpy(lease, &record.lease, sizeof(*lease));
+
+	return 0;
+}
+
+static int lease_flash_write(const struct lease_record *record)
+{
+	int ret;
+
+	flash_write_protection_set(flash_dev, false);
+
+	ret = flash_erase(flash_dev, LEASE_OFFSET,
+			  CONFIG_NET_DHCPV4_LEASE_FLASH_PAGE_SIZE);
+	if (!ret && record) {
+		flash_write_protection_set(flash_dev, false);
+
+		ret = flash_write(flash_dev, LEASE_OFFSET, record,
+				  sizeof(*record));
+	}
+
+	flash_write_protection_set(flash_dev, true);
+
+	return ret ? -EIO : 0;
+}
+
+static int lease_flash_save(struct net_if *iface,
+			    const struct net_dhcpv4_lease *lease)
+{
+	struct lease_record record;
+
+	/* Renewals mostly get the same lease, spare the flash then */
+	if (!flash_read(flash_dev, LEASE_OFFSET, &record, sizeof(record)) &&
+	    record.magic == LEASE_MAGIC &&
+	    !memcmp(&record.lease, lease, sizeof(*lease))) {
+		return 0;
+	}
+
+	memset(&record, 0, sizeof(record));
+	record.magic = LEASE_MAGIC;
+	memcpy(&record.lease, lease, sizeof(*lease));
+
+	NET_DBG("Saving lease %s", net_sprint_ipv4_addr(&lease->addr));
+
+	return lease_flash_write(&record);
+}
+
+static int lease_flash_clear(struct net_if *iface)
+{
+	struct lease_record record;
+	int ret;
+
+	ret = lease_flash_load(iface, &record.lease);
+	if (ret == -ENOENT) {
+		return 0;
+	}
+
+	return lease_flash_write(NULL);
+}
+
+static const struct net_dhcpv4_storage lease_flash_storage = {
+	.load = lease_flash_load,
+	.save = lease_flash_save,
+	.clear = lease_flash_clear,
+};
+
+static int lease_flash_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	flash_dev = device_get_binding(CONFIG_NET_DHCPV4_LEASE_FLASH_DEV_NAME);
+	if (!flash_dev) {
+		NET_ERR("No flash device %s to store the lease",
+			CONFIG_NET_DHCPV4_LEASE_FLASH_DEV_NAME);
+		return -ENODEV;
+	}
+
+	net_dhcpv4_set_storage(&lease_flash_storage);
+
+	return 0;
+}
+
+SYS_INIT(lease_flash_init, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -46,7 +46,9 @@ static inline enum net_verdict handle_echo_request(struct net_buf *buf)
 	NET_ICMP_BUF(buf)->type = NET_ICMPV4_ECHO_REPLY;
 	NET_ICMP_BUF(buf)->code = 0;
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv4(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv4(buf);
+	}
 
 #if defined(CONFIG_NET_DEBUG_ICMPV4)
 	snprintf(out, sizeof(out),
@@ -85,7 +87,9 @@ static inline void setup_ipv4_header(struct net_buf *buf, uint8_t extra_len,
 	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv4_hdr));
 
 	NET_IPV4_BUF(buf)->chksum = 0;
-	NET_IPV4_BUF(buf)->chksum = ~net_calc_chksum_ipv4(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_IPV4_BUF(buf)->chksum = ~net_calc_chksum_ipv4(buf);
+	}
 
 	NET_ICMP_BUF(buf)->type = icmp_type;
 	NET_ICMP_BUF(buf)->code = icmp_code;
@@ -132,7 +136,9 @@ int net_icmpv4_send_echo_request(struct net_if *iface,
 	NET_ICMPV4_ECHO_REQ_BUF(buf)->sequence = htons(sequence);
 
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv4(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv4(buf);
+	}
 
 #if defined(CONFIG_NET_DEBUG_ICMPV4)
 	do {
@@ -246,7 +252,9 @@ int net_icmpv4_send_error(struct net_buf *orig, uint8_t type, uint8_t code)
 	net_nbuf_ll_dst(buf)->len = net_nbuf_ll_src(orig)->len;
 
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv4(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv4(buf);
+	}
 
 #if defined(CONFIG_NET_DEBUG_ICMPV4)
 	do {
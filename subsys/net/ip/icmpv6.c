@@ -136,7 +136,9 @@ static enum net_verdict handle_echo_request(struct net_buf *orig)
 	sys_put_be32(seq, ptr + sizeof(uint32_t));
 
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	}
 
 #if defined(CONFIG_NET_DEBUG_ICMPV6)
 	do {
@@ -255,7 +257,9 @@ int net_icmpv6_send_error(struct net_buf *orig, uint8_t type, uint8_t code,
 	net_nbuf_ll_dst(buf)->len = net_nbuf_ll_src(orig)->len;
 
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	}
 
 #if defined(CONFIG_NET_DEBUG_ICMPV6)
 	do {
@@ -315,7 +319,9 @@ int net_icmpv6_send_echo_request(struct net_if *iface,
 	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, dst);
 
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	}
 
 	buf = net_ipv6_finalize_raw(buf, IPPROTO_ICMPV6);
 
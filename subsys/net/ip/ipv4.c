@@ -20,6 +20,7 @@
 #include <net/net_context.h>
 #include "net_private.h"
 #include "ipv4.h"
+#include "net_stats.h"
 
 struct net_buf *net_ipv4_create_raw(struct net_buf *buf,
 				    uint16_t reserve,
@@ -35,7 +36,8 @@ struct net_buf *net_ipv4_create_raw(struct net_buf *buf,
 	net_buf_frag_insert(buf, header);
 
 	NET_IPV4_BUF(buf)->vhl = 0x45;
-	NET_IPV4_BUF(buf)->tos = 0x00;
+	/* The priority goes to the precedence bits of the TOS */
+	NET_IPV4_BUF(buf)->tos = net_nbuf_priority(buf) << 5;
 	NET_IPV4_BUF(buf)->proto = 0;
 
 	NET_IPV4_BUF(buf)->ttl = net_if_ipv4_get_ttl(iface);
@@ -93,6 +95,20 @@ struct net_buf *net_ipv4_finalize_raw(struct net_buf *buf,
 	NET_IPV4_BUF(buf)->len[1] = total_len - NET_IPV4_BUF(buf)->len[0] * 256;
 
 	NET_IPV4_BUF(buf)->chksum = 0;
+
+	net_nbuf_check_loopback(buf);
+
+	if (net_nbuf_tx_chksum_offloaded(buf)) {
+		/* The device fills in the header and payload checksums */
+		if (next_header == IPPROTO_UDP) {
+			NET_UDP_BUF(buf)->chksum = 0;
+		} else if (next_header == IPPROTO_TCP) {
+			NET_TCP_BUF(buf)->chksum = 0;
+		}
+
+		return buf;
+	}
+
 	NET_IPV4_BUF(buf)->chksum = ~net_calc_chksum_ipv4(buf);
 
 #if defined(CONFIG_NET_UDP)
@@ -131,3 +147,531 @@ const struct in_addr *net_ipv4_broadcast_address(void)
 
 	return &addr;
 }
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+
+#define REASS_COUNT CONFIG_NET_IPV4_FRAGMENT_REASS_COUNT
+#define MAX_FRAGS CONFIG_NET_IPV4_FRAGMENT_MAX_FRAGS
+#define REASS_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+
+/* Largest payload an IPv4 datagram can carry */
+#define MAX_PAYLOAD (0xffff - sizeof(struct net_ipv4_hdr))
+
+struct ipv4_frag {
+	struct ipv4_frag *next;
+
+	/* Data fragments, the IPv4 header is kept only at offset 0 */
+	struct net_buf *data;
+
+	/* Place of the payload in the datagram, in bytes */
+	uint16_t offset;
+	uint16_t len;
+};
+
+struct ipv4_reass {
+	/* Fragments received so far, sorted by offset */
+	struct ipv4_frag *frags;
+
+	struct in_addr src;
+	struct in_addr dst;
+
+	uint32_t last_used;
+	uint32_t expiry;
+
+	uint16_t id;
+
+	/* Payload length, known once the last fragment is received */
+	uint16_t len;
+
+	uint8_t proto;
+	bool used;
+};
+
+static struct ipv4_reass reass_cache[REASS_COUNT];
+static struct ipv4_frag frags[MAX_FRAGS];
+static struct ipv4_frag *free_frags;
+
+static struct k_sem reass_lock;
+static struct k_delayed_work reass_timer;
+static bool reass_timer_armed;
+
+static atomic_t ipv4_id;
+
+static void frag_free(struct ipv4_frag *frag)
+{
+	if (frag->data) {
+		net_nbuf_unref(frag->data);
+		frag->data = NULL;
+	}
+
+	frag->next = free_frags;
+	free_frags = frag;
+}
+
+/* Must be called with reass_lock held */
+static void reass_free(struct ipv4_reass *reass)
+{
+	while (reass->frags) {
+		struct ipv4_frag *frag = reass->frags;
+
+		reass->frags = frag->next;
+		frag_free(frag);
+	}
+
+	reass->used = false;
+}
+
+/* Must be called with reass_lock held */
+static void reass_timer_arm(void)
+{
+	uint32_t now = k_uptime_get_32();
+	int32_t delay = -1;
+	int i;
+
+	for (i = 0; i < REASS_COUNT; i++) {
+		int32_t left = reass_cache[i].expiry - now;
+
+		if (!reass_cache[i].used) {
+			continue;
+		}
+
+		if (delay < 0 || left < delay) {
+			delay = max(left, 0);
+		}
+	}
+
+	if (delay < 0) {
+		return;
+	}
+
+	k_delayed_work_submit(&reass_timer, delay);
+	reass_timer_armed = true;
+}
+
+static void reass_timeout(struct k_work *work)
+{
+	uint32_t now = k_uptime_get_32();
+	int i;
+
+	ARG_UNUSED(work);
+
+	k_sem_take(&reass_lock, K_FOREVER);
+
+	reass_timer_armed = false;
+
+	for (i = 0; i < REASS_COUNT; i++) {
+		struct ipv4_reass *reass = &reass_cache[i];
+
+		if (reass->used && (int32_t)(now - reass->expiry) >= 0) {
+			NET_DBG("Reassembly of datagram %u timed out",
+				reass->id);
+			reass_free(reass);
+			net_stats_update_ipv4_frag_timeout();
+		}
+	}
+
+	reass_timer_arm();
+
+	k_sem_give(&reass_lock);
+}
+
+/* Least recently updated datagram, other than the one being updated,
+ * and holding fragments if 'with_frags' is set.
+ *
+ * Must be called with reass_lock held.
+ */
+static struct ipv4_reass *reass_lru(struct ipv4_reass *current,
+				    bool with_frags)
+{
+	struct ipv4_reass *lru = NULL;
+	int i;
+
+	for (i = 0; i < REASS_COUNT; i++) {
+		struct ipv4_reass *reass = &reass_cache[i];
+
+		if (!reass->used || reass == current ||
+		    (with_frags && !reass->frags)) {
+			continue;
+		}
+
+		if (!lru || (int32_t)(reass->last_used - lru->last_used) < 0) {
+			lru = reass;
+		}
+	}
+
+	return lru;
+}
+
+/* Must be called with reass_lock held */
+static struct ipv4_reass *reass_get(struct net_ipv4_hdr *hdr, uint16_t id)
+{
+	struct ipv4_reass *reass = NULL;
+	int i;
+
+	for (i = 0; i < REASS_COUNT; i++) {
+		if (!reass_cache[i].used) {
+			reass = reass ? reass : &reass_cache[i];
+			continue;
+		}
+
+		if (reass_cache[i].id == id &&
+		    reass_cache[i].proto == hdr->proto &&
+		    net_ipv4_addr_cmp(&reass_cache[i].src, &hdr->src) &&
+		    net_ipv4_addr_cmp(&reass_cache[i].dst, &hdr->dst)) {
+			return &reass_cache[i];
+		}
+	}
+
+	if (!reass) {
+		reass = reass_lru(NULL, false);
+
+		NET_DBG("Evicting datagram %u", reass->id);
+		reass_free(reass);
+		net_stats_update_ipv4_frag_evicted();
+	}
+
+	reass->frags = NULL;
+	net_ipaddr_copy(&reass->src, &hdr->src);
+	net_ipaddr_copy(&reass->dst, &hdr->dst);
+	reass->id = id;
+	reass->len = 0;
+	reass->proto = hdr->proto;
+	reass->expiry = k_uptime_get_32() + REASS_TIMEOUT;
+	reass->used = true;
+
+	if (!reass_timer_armed) {
+		reass_timer_arm();
+	}
+
+	return reass;
+}
+
+/* Take a fragment slot, evicting other datagrams if the budget is
+ * exhausted.
+ *
+ * Must be called with reass_lock held.
+ */
+static struct ipv4_frag *frag_alloc(struct ipv4_reass *current)
+{
+	struct ipv4_frag *frag;
+
+	while (!free_frags) {
+		struct ipv4_reass *lru = reass_lru(current, true);
+
+		if (!lru) {
+			return NULL;
+		}
+
+		NET_DBG("Evicting datagram %u", lru->id);
+		reass_free(lru);
+		net_stats_update_ipv4_frag_evicted();
+	}
+
+	frag = free_frags;
+	free_frags = frag->next;
+
+	return frag;
+}
+
+/* Must be called with reass_lock held */
+static bool reass_is_complete(struct ipv4_reass *reass)
+{
+	struct ipv4_frag *frag;
+	uint16_t expected = 0;
+
+	if (!reass->len) {
+		return false;
+	}
+
+	for (frag = reass->frags; frag; frag = frag->next) {
+		if (frag->offset != expected) {
+			return false;
+		}
+
+		expected += frag->len;
+	}
+
+	return expected == reass->len;
+}
+
+/* Move the fragments of a complete datagram to the buffer and release
+ * the datagram.
+ *
+ * Must be called with reass_lock held.
+ */
+static void reass_deliver(struct ipv4_reass *reass, struct net_buf *buf)
+{
+	struct ipv4_frag *frag = reass->frags;
+
+	buf->frags = frag->data;
+	frag->data = NULL;
+
+	for (frag = frag->next; frag; frag = frag->next) {
+		net_buf_frag_add(buf->frags, frag->data);
+		frag->data = NULL;
+	}
+
+	reass_free(reass);
+}
+
+enum net_verdict net_ipv4_reassemble(struct net_buf *buf)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_BUF(buf);
+	uint16_t field = (hdr->offset[0] << 8) | hdr->offset[1];
+	uint16_t offset = (field & NET_IPV4_FRAGH_OFFSET_MASK) * 8;
+	uint16_t hdr_len = (hdr->vhl & 0x0f) * 4;
+	uint16_t len = ((hdr->len[0] << 8) | hdr->len[1]) - hdr_len;
+	uint16_t id = (hdr->id[0] << 8) | hdr->id[1];
+	bool more = field & NET_IPV4_MF;
+	struct ipv4_frag **pos, *frag;
+	struct ipv4_reass *reass;
+
+	net_stats_update_ipv4_frag_recv();
+
+	if (hdr_len < sizeof(struct net_ipv4_hdr) ||
+	    hdr_len + len > net_buf_frags_len(buf->frags) ||
+	    !len || (more && (len % 8)) || offset + len > MAX_PAYLOAD) {
+		NET_DBG("Invalid fragment of datagram %u", id);
+		goto drop;
+	}
+
+	k_sem_take(&reass_lock, K_FOREVER);
+
+	reass = reass_get(hdr, id);
+	reass->last_used = k_uptime_get_32();
+
+	if (reass->len && offset + len > reass->len) {
+		goto drop_datagram;
+	}
+
+	for (pos = &reass->frags; *pos && (*pos)->offset < offset;
+	     pos = &(*pos)->next) {
+		if ((*pos)->offset + (*pos)->len > offset) {
+			goto drop_datagram;
+		}
+	}
+
+	if (*pos && (*pos)->offset == offset && (*pos)->len == len) {
+		NET_DBG("Duplicate fragment of datagram %u", id);
+		k_sem_give(&reass_lock);
+		goto drop;
+	}
+
+	if (*pos && offset + len > (*pos)->offset) {
+		goto drop_datagram;
+	}
+
+	if (!more) {
+		if (*pos || (reass->len && reass->len != offset + len)) {
+			goto drop_datagram;
+		}
+
+		reass->len = offset + len;
+	}
+
+	frag = frag_alloc(reass);
+	if (!frag) {
+		NET_DBG("Datagram %u exceeds the fragment budget", id);
+		goto drop_datagram;
+	}
+
+	frag->offset = offset;
+	frag->len = len;
+	frag->data = buf->frags;
+	buf->frags = NULL;
+
+	if (offset) {
+		frag->data = net_nbuf_pull(frag->data, hdr_len);
+	}
+
+	frag->next = *pos;
+	*pos = frag;
+
+	if (!reass_is_complete(reass)) {
+		k_sem_give(&reass_lock);
+		net_nbuf_unref(buf);
+		return NET_OK;
+	}
+
+	reass_deliver(reass, buf);
+
+	k_sem_give(&reass_lock);
+
+	/* The header of the first fragment becomes the datagram header */
+	hdr = NET_IPV4_BUF(buf);
+	hdr_len = (hdr->vhl & 0x0f) * 4;
+	len = net_buf_frags_len(buf->frags);
+
+	hdr->len[0] = len >> 8;
+	hdr->len[1] = len;
+	hdr->offset[0] = hdr->offset[1] = 0;
+	hdr->chksum = 0;
+	hdr->chksum = ~net_calc_chksum_ipv4(buf);
+
+	net_nbuf_set_ip_hdr_len(buf, hdr_len);
+
+	NET_DBG("Reassembled datagram %u, %u bytes", id, len);
+
+	net_stats_update_ipv4_frag_reassembled();
+
+	return NET_CONTINUE;
+
+drop_datagram:
+	NET_DBG("Inconsistent fragment, dropping datagram %u", id);
+	reass_free(reass);
+	k_sem_give(&reass_lock);
+
+drop:
+	net_stats_update_ipv4_frag_drop();
+
+	return NET_DROP;
+}
+
+/* Compute the upper layer checksum the interface would have filled in:
+ * it spans the whole datagram, so it cannot be left to each fragment.
+ */
+static void fill_upper_chksum(struct net_buf *buf)
+{
+	switch (NET_IPV4_BUF(buf)->proto) {
+#if defined(CONFIG_NET_UDP)
+	case IPPROTO_UDP:
+		NET_UDP_BUF(buf)->chksum = 0;
+		NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+		break;
+#endif
+#if defined(CONFIG_NET_TCP)
+	case IPPROTO_TCP:
+		NET_TCP_BUF(buf)->chksum = 0;
+		NET_TCP_BUF(buf)->chksum = ~net_calc_chksum_tcp(buf);
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+int net_ipv4_send_fragments(struct net_buf *buf, uint16_t mtu)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_BUF(buf);
+	uint16_t hdr_len = net_nbuf_ip_hdr_len(buf);
+	uint16_t field = (hdr->offset[0] << 8) | hdr->offset[1];
+	uint16_t total = net_buf_frags_len(buf->frags) - hdr_len;
+	uint16_t max_len = (mtu - hdr_len) & ~7;
+	uint16_t id, offset;
+	struct net_buf *src = buf->frags;
+	uint16_t src_pos = hdr_len;
+
+	if ((field & NET_IPV4_DF) || mtu <= hdr_len + 8) {
+		NET_DBG("Cannot fragment buf %p to fit in MTU %u", buf, mtu);
+		return -EMSGSIZE;
+	}
+
+	if (net_nbuf_tx_chksum_offloaded(buf)) {
+		fill_upper_chksum(buf);
+	}
+
+	id = atomic_inc(&ipv4_id);
+
+	for (offset = 0; offset < total; ) {
+		uint16_t len = min(max_len, total - offset);
+		bool last = (offset + len == total);
+		struct net_buf *frag_buf, *frag;
+		struct net_ipv4_hdr *frag_hdr;
+		uint16_t left;
+
+		frag_buf = net_nbuf_get_reserve_tx(0);
+		if (!frag_buf) {
+			goto fail;
+		}
+
+		frag = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
+		if (!frag) {
+			net_nbuf_unref(frag_buf);
+			goto fail;
+		}
+
+		net_buf_frag_add(frag_buf, frag);
+
+		net_nbuf_set_iface(frag_buf, net_nbuf_iface(buf));
+		net_nbuf_set_family(frag_buf, AF_INET);
+		net_nbuf_set_ll_reserve(frag_buf, net_nbuf_ll_reserve(buf));
+		net_nbuf_set_ip_hdr_len(frag_buf, hdr_len);
+		net_nbuf_set_priority(frag_buf, net_nbuf_priority(buf));
+
+		/* Only the last fragment notifies the sender */
+		if (last) {
+			net_nbuf_set_context(frag_buf, net_nbuf_context(buf));
+			net_nbuf_set_token(frag_buf, net_nbuf_token(buf));
+		}
+
+		memcpy(net_buf_add(frag, hdr_len), hdr, hdr_len);
+
+		for (left = len; left; ) {
+			uint16_t count;
+
+			while (src_pos >= src->len) {
+				src_pos -= src->len;
+				src = src->frags;
+			}
+
+			count = min(left, src->len - src_pos);
+			if (!net_nbuf_append(frag_buf, count,
+					     src->data + src_pos)) {
+				net_nbuf_unref(frag_buf);
+				goto fail;
+			}
+
+			src_pos += count;
+			left -= count;
+		}
+
+		frag_hdr = NET_IPV4_BUF(frag_buf);
+		frag_hdr->len[0] = (hdr_len + len) >> 8;
+		frag_hdr->len[1] = hdr_len + len;
+		frag_hdr->id[0] = id >> 8;
+		frag_hdr->id[1] = id;
+		field = (offset / 8) | (last ? 0 : NET_IPV4_MF);
+		frag_hdr->offset[0] = field >> 8;
+		frag_hdr->offset[1] = field;
+		frag_hdr->chksum = 0;
+
+		if (!net_nbuf_tx_chksum_offloaded(frag_buf)) {
+			frag_hdr->chksum = ~net_calc_chksum_ipv4(frag_buf);
+		}
+
+		if (net_if_send_data(net_nbuf_iface(frag_buf),
+				     frag_buf) == NET_DROP) {
+			net_nbuf_unref(frag_buf);
+			goto fail;
+		}
+
+		net_stats_update_ipv4_frag_sent();
+
+		offset += len;
+	}
+
+	net_nbuf_unref(buf);
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment of buf %p", buf);
+
+	return -EIO;
+}
+
+void net_ipv4_init(void)
+{
+	int i;
+
+	k_sem_init(&reass_lock, 0, UINT_MAX);
+	k_delayed_work_init(&reass_timer, reass_timeout);
+
+	for (i = 0; i < MAX_FRAGS; i++) {
+		frags[i].next = free_frags;
+		free_frags = &frags[i];
+	}
+
+	k_sem_give(&reass_lock);
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
@@ -84,4 +84,62 @@ struct net_buf *net_ipv4_finalize_raw(struct net_buf *buf,
 struct net_buf *net_ipv4_finalize(struct net_context *context,
 				  struct net_buf *buf);
 
+/* Flags and fragment offset of the IPv4 header, host byte order */
+#define NET_IPV4_DF BIT(14)
+#define NET_IPV4_MF BIT(13)
+#define NET_IPV4_FRAGH_OFFSET_MASK 0x1fff
+
+/**
+ * @brief Check whether an IPv4 packet is a fragment of a datagram.
+ *
+ * @param hdr IPv4 header
+ *
+ * @return True if more fragments follow or the fragment offset is set.
+ */
+static inline bool net_ipv4_is_fragment(struct net_ipv4_hdr *hdr)
+{
+	uint16_t field = (hdr->offset[0] << 8) | hdr->offset[1];
+
+	return field & (NET_IPV4_MF | NET_IPV4_FRAGH_OFFSET_MASK);
+}
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+/**
+ * @brief Initialize the IPv4 reassembly cache.
+ */
+void net_ipv4_init(void);
+
+/**
+ * @brief Add a received fragment to its datagram.
+ *
+ * @details The data fragments of the buffer are kept until the
+ * datagram is complete, its reassembly times out, or it is evicted
+ * to make room for a newer one. Once the last missing fragment is
+ * received, the whole datagram is placed in the buffer.
+ *
+ * @param buf Network buffer containing an IPv4 fragment
+ *
+ * @return NET_OK if the fragment has been kept (the buffer is
+ * consumed), NET_CONTINUE if the buffer now contains the reassembled
+ * datagram, NET_DROP if the fragment must be dropped.
+ */
+enum net_verdict net_ipv4_reassemble(struct net_buf *buf);
+
+/**
+ * @brief Send an IPv4 packet as fragments fitting in the MTU.
+ *
+ * @details The buffer is unreferenced once all the fragments have
+ * been sent.
+ *
+ * @param buf Network buffer containing a finalized IPv4 packet
+ * @param mtu MTU of the network interface
+ *
+ * @return 0 on success, -EMSGSIZE if the packet cannot be
+ * fragmented, -EIO if a fragment could not be sent.
+ */
+int net_ipv4_send_fragments(struct net_buf *buf, uint16_t mtu);
+#else
+#define net_ipv4_init(...)
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #endif /* __IPV4_H */
@@ -30,6 +30,7 @@
 #include "6lo.h"
 #include "route.h"
 #include "rpl.h"
+#include "mpl.h"
 #include "net_stats.h"
 
 #if defined(CONFIG_NET_IPV6_ND)
@@ -71,6 +72,38 @@ static inline struct net_nbr *get_nbr(int idx)
 	return &net_neighbor_pool[idx].nbr;
 }
 
+/* Neighbors in use are hashed on their IPv6 address only: the interface a
+ * neighbor is tied to is cleared when it is unlinked.
+ */
+static sys_slist_t nbr_hash[CONFIG_NET_IPV6_NBR_HASH_BUCKETS];
+
+static inline sys_slist_t *nbr_bucket(const struct in6_addr *addr)
+{
+	uint32_t hash = addr->s6_addr32[0] ^ addr->s6_addr32[1] ^
+			addr->s6_addr32[2] ^ addr->s6_addr32[3];
+
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+
+	return &nbr_hash[hash % CONFIG_NET_IPV6_NBR_HASH_BUCKETS];
+}
+
+static inline void nbr_hash_add(struct net_nbr *nbr)
+{
+	struct net_ipv6_nbr_data *data = net_ipv6_nbr_data(nbr);
+
+	sys_slist_prepend(nbr_bucket(&data->addr), &data->node);
+}
+
+static inline struct net_nbr *nbr_from_node(sys_snode_t *node)
+{
+	struct net_ipv6_nbr_data *data;
+
+	data = CONTAINER_OF(node, struct net_ipv6_nbr_data, node);
+
+	return CONTAINER_OF((uint8_t *)data, struct net_nbr, __nbr);
+}
+
 static inline struct net_nbr *get_nbr_from_data(struct net_ipv6_nbr_data *data)
 {
 	int i;
@@ -98,13 +131,13 @@ void nbr_print(void)
 			continue;
 		}
 
-		NET_DBG("[%d] %p %d/%d/%d/%d/%d pending %p iface %p idx %d "
+		NET_DBG("[%d] %p %d/%d/%d/%d/%d pending %d iface %p idx %d "
 			"ll %s addr %s",
 			i, nbr, nbr->ref, net_ipv6_nbr_data(nbr)->ns_count,
 			net_ipv6_nbr_data(nbr)->is_router,
 			net_ipv6_nbr_data(nbr)->state,
 			net_ipv6_nbr_data(nbr)->link_metric,
-			net_ipv6_nbr_data(nbr)->pending,
+			net_ipv6_nbr_data(nbr)->pending_count,
 			nbr->iface, nbr->idx,
 			nbr->idx == NET_NBR_LLADDR_UNKNOWN ? "?" :
 			net_sprint_ll_addr(
@@ -121,14 +154,12 @@ static struct net_nbr *nbr_lookup(struct net_nbr_table *table,
 				  struct net_if *iface,
 				  struct in6_addr *addr)
 {
-	int i;
+	sys_snode_t *node;
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	ARG_UNUSED(table);
 
-		if (!nbr->ref) {
-			continue;
-		}
+	SYS_SLIST_FOR_EACH_NODE(nbr_bucket(addr), node) {
+		struct net_nbr *nbr = nbr_from_node(node);
 
 		if (nbr->iface == iface &&
 		    net_ipv6_addr_cmp(&net_ipv6_nbr_data(nbr)->addr, addr)) {
@@ -148,6 +179,22 @@ struct net_ipv6_nbr_data *net_ipv6_get_nbr_by_index(uint8_t idx)
 	return net_ipv6_nbr_data(nbr);
 }
 
+/* Each pending buffer holds the reference of its sender and the one taken
+ * when it was queued.
+ */
+static void nbr_drop_pending(struct net_ipv6_nbr_data *data)
+{
+	uint8_t i;
+
+	for (i = 0; i < data->pending_count; i++) {
+		net_nbuf_unref(data->pending[i]);
+		net_nbuf_unref(data->pending[i]);
+		data->pending[i] = NULL;
+	}
+
+	data->pending_count = 0;
+}
+
 static inline void nbr_clear_ns_pending(struct net_ipv6_nbr_data *data)
 {
 	int ret;
@@ -157,9 +204,61 @@ static inline void nbr_clear_ns_pending(struct net_ipv6_nbr_data *data)
 		NET_DBG("Cannot cancel NS work (%d)", ret);
 	}
 
-	net_nbuf_unref(data->pending);
+	nbr_drop_pending(data);
+}
+
+/* Queue a buffer until the neighbor is resolved. Returns false if it is
+ * already queued or if the queue is full.
+ */
+static bool nbr_queue_pending(struct net_ipv6_nbr_data *data,
+			      struct net_buf *buf)
+{
+	uint8_t i;
+
+	for (i = 0; i < data->pending_count; i++) {
+		if (data->pending[i] == buf) {
+			return false;
+		}
+	}
+
+	if (data->pending_count == CONFIG_NET_IPV6_ND_PENDING_COUNT) {
+		NET_DBG("Pending queue of %s full, dropping buf %p",
+			net_sprint_ipv6_addr(&data->addr), buf);
+		net_stats_update_ipv6_nd_pending_drop();
+		return false;
+	}
+
+	data->pending[data->pending_count++] = net_nbuf_ref(buf);
+
+	return true;
+}
+
+/* Send the queued buffers in order, once the neighbor is resolved. */
+static void nbr_send_pending(struct net_ipv6_nbr_data *data)
+{
+	uint8_t i;
+	int ret;
+
+	ret = k_delayed_work_cancel(&data->send_ns);
+	if (ret < 0) {
+		NET_DBG("Cannot cancel NS work (%d)", ret);
+	}
+
+	for (i = 0; i < data->pending_count; i++) {
+		struct net_buf *pending = data->pending[i];
+
+		NET_DBG("Sending pending %p to %s", pending,
+			net_sprint_ipv6_addr(&NET_IPV6_BUF(pending)->dst));
+
+		if (net_send_data(pending) < 0) {
+			net_nbuf_unref(pending);
+		}
+
+		net_nbuf_unref(pending);
+		data->pending[i] = NULL;
+	}
 
-	data->pending = NULL;
+	data->pending_count = 0;
 }
 
 static inline void nbr_free(struct net_nbr *nbr)
@@ -173,13 +272,69 @@ static inline void nbr_free(struct net_nbr *nbr)
 	net_nbr_unref(nbr);
 }
 
+/* Free the least recently used neighbor that nothing else refers to, is not
+ * a router and has no packet waiting for address resolution, preferring the
+ * ones that are not known to be reachable, and allocate a new one instead.
+ */
+static struct net_nbr *nbr_evict(void)
+{
+	struct net_ipv6_nbr_data *lru = NULL;
+	bool lru_stale = false;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
+		struct net_nbr *nbr = get_nbr(i);
+		struct net_ipv6_nbr_data *data = net_ipv6_nbr_data(nbr);
+		bool stale;
+
+		if (nbr->ref != 1 || data->pending_count || data->is_router) {
+			continue;
+		}
+
+		stale = data->state != NET_NBR_REACHABLE;
+
+		if (!lru || (stale && !lru_stale) ||
+		    (stale == lru_stale &&
+		     (int32_t)(data->last_used - lru->last_used) < 0)) {
+			lru = data;
+			lru_stale = stale;
+		}
+	}
+
+	if (!lru) {
+		return NULL;
+	}
+
+	NET_DBG("Evicting nbr %p IPv6 %s", get_nbr_from_data(lru),
+		net_sprint_ipv6_addr(&lru->addr));
+
+	nbr_free(get_nbr_from_data(lru));
+
+	return net_nbr_get(&net_neighbor.table);
+}
+
+static struct net_nbr *nbr_get(void)
+{
+	struct net_nbr *nbr = net_nbr_get(&net_neighbor.table);
+
+	if (!nbr) {
+		nbr = nbr_evict();
+	}
+
+	if (nbr) {
+		net_ipv6_nbr_data(nbr)->last_used = k_uptime_get_32();
+	}
+
+	return nbr;
+}
+
 struct net_nbr *net_ipv6_nbr_add(struct net_if *iface,
 				 struct in6_addr *addr,
 				 struct net_linkaddr *lladdr,
 				 bool is_router,
 				 enum net_nbr_state state)
 {
-	struct net_nbr *nbr = net_nbr_get(&net_neighbor.table);
+	struct net_nbr *nbr = nbr_get();
 
 	if (!nbr) {
 		return NULL;
@@ -194,6 +349,8 @@ struct net_nbr *net_ipv6_nbr_add(struct net_if *iface,
 	net_ipv6_nbr_data(nbr)->state = state;
 	net_ipv6_nbr_data(nbr)->is_router = is_router;
 
+	nbr_hash_add(nbr);
+
 	NET_DBG("[%d] nbr %p state %d router %d IPv6 %s ll %s",
 		nbr->idx, nbr, state, is_router,
 		net_sprint_ipv6_addr(addr),
@@ -216,7 +373,7 @@ static struct net_nbr *nbr_new(struct net_if *iface,
 			       struct in6_addr *addr,
 			       enum net_nbr_state state)
 {
-	struct net_nbr *nbr = net_nbr_get(&net_neighbor.table);
+	struct net_nbr *nbr = nbr_get();
 
 	if (!nbr) {
 		return NULL;
@@ -227,7 +384,9 @@ static struct net_nbr *nbr_new(struct net_if *iface,
 
 	net_ipaddr_copy(&net_ipv6_nbr_data(nbr)->addr, addr);
 	net_ipv6_nbr_data(nbr)->state = state;
-	net_ipv6_nbr_data(nbr)->pending = NULL;
+	net_ipv6_nbr_data(nbr)->pending_count = 0;
+
+	nbr_hash_add(nbr);
 
 	NET_DBG("nbr %p iface %p state %d IPv6 %s",
 		nbr, iface, state, net_sprint_ipv6_addr(addr));
@@ -237,9 +396,14 @@ static struct net_nbr *nbr_new(struct net_if *iface,
 
 void net_neighbor_data_remove(struct net_nbr *nbr)
 {
+	struct net_ipv6_nbr_data *data = net_ipv6_nbr_data(nbr);
+
 	NET_DBG("Neighbor %p removed", nbr);
 
-	return;
+	sys_slist_find_and_remove(nbr_bucket(&data->addr), &data->node);
+
+	/* Release the link address, so that it can be reused */
+	net_nbr_unlink(nbr, NULL);
 }
 
 void net_neighbor_table_clear(struct net_nbr_table *table)
@@ -296,7 +460,8 @@ struct net_buf *net_ipv6_create_raw(struct net_buf *buf,
 
 	net_buf_frag_insert(buf, header);
 
-	NET_IPV6_BUF(buf)->vtc = 0x60;
+	/* The priority goes to the precedence bits of the traffic class */
+	NET_IPV6_BUF(buf)->vtc = 0x60 | (net_nbuf_priority(buf) << 1);
 	NET_IPV6_BUF(buf)->tcflow = 0;
 	NET_IPV6_BUF(buf)->flow = 0;
 
@@ -346,6 +511,7 @@ struct net_buf *net_ipv6_finalize_raw(struct net_buf *buf,
 {
 	/* Set the length of the IPv6 header */
 	size_t total_len;
+	int mpl;
 
 #if defined(CONFIG_NET_UDP) && defined(CONFIG_NET_RPL_INSERT_HBH_OPTION)
 	if (next_header != IPPROTO_TCP && next_header != IPPROTO_ICMPV6) {
@@ -356,6 +522,15 @@ struct net_buf *net_ipv6_finalize_raw(struct net_buf *buf,
 	}
 #endif
 
+	/* TCP does not work over multicast */
+	mpl = 0;
+	if (next_header != IPPROTO_TCP) {
+		mpl = net_mpl_insert_header(buf);
+		if (mpl < 0) {
+			NET_DBG("MPL HBHO insert failed");
+		}
+	}
+
 	net_nbuf_compact(buf);
 
 	total_len = net_buf_frags_len(buf->frags);
@@ -365,24 +540,36 @@ struct net_buf *net_ipv6_finalize_raw(struct net_buf *buf,
 	NET_IPV6_BUF(buf)->len[0] = total_len / 256;
 	NET_IPV6_BUF(buf)->len[1] = total_len - NET_IPV6_BUF(buf)->len[0] * 256;
 
+	net_nbuf_check_loopback(buf);
+
 #if defined(CONFIG_NET_UDP)
 	if (next_header == IPPROTO_UDP) {
 		NET_UDP_BUF(buf)->chksum = 0;
-		NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+		if (!net_nbuf_tx_chksum_offloaded(buf)) {
+			NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+		}
 	} else
 #endif
 
 #if defined(CONFIG_NET_TCP)
 	if (next_header == IPPROTO_TCP) {
 		NET_TCP_BUF(buf)->chksum = 0;
-		NET_TCP_BUF(buf)->chksum = ~net_calc_chksum_tcp(buf);
+		if (!net_nbuf_tx_chksum_offloaded(buf)) {
+			NET_TCP_BUF(buf)->chksum = ~net_calc_chksum_tcp(buf);
+		}
 	} else
 #endif
 
 	if (next_header == IPPROTO_ICMPV6) {
 		NET_ICMP_BUF(buf)->chksum = 0;
-		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum(buf,
-							     IPPROTO_ICMPV6);
+		if (!net_nbuf_tx_chksum_offloaded(buf)) {
+			NET_ICMP_BUF(buf)->chksum =
+				~net_calc_chksum_icmpv6(buf);
+		}
+	}
+
+	if (mpl > 0) {
+		net_mpl_sent(buf);
 	}
 
 	return buf;
@@ -464,23 +651,17 @@ static void ns_reply_timeout(struct k_work *work)
 		return;
 	}
 
-	if (!data->pending) {
+	if (!data->pending_count) {
 		/* Silently return, this is not an error as the work
 		 * cannot be cancelled in certain cases.
 		 */
 		return;
 	}
 
-	NET_DBG("NS nbr %p pending %p timeout to %s", nbr, data->pending,
-		net_sprint_ipv6_addr(&NET_IPV6_BUF(data->pending)->dst));
-
-	/* To unref when pending variable was set */
-	net_nbuf_unref(data->pending);
+	NET_DBG("NS nbr %p pending %d timeout to %s", nbr,
+		data->pending_count, net_sprint_ipv6_addr(&data->addr));
 
-	/* To unref the original buf allocation */
-	net_nbuf_unref(data->pending);
-
-	data->pending = NULL;
+	nbr_drop_pending(data);
 
 	net_nbr_unref(nbr);
 }
@@ -490,9 +671,17 @@ struct net_buf *net_ipv6_prepare_for_send(struct net_buf *buf)
 	struct in6_addr *nexthop = NULL;
 	struct net_if *iface = NULL;
 	struct net_nbr *nbr;
+	int ret;
 
-	if (net_if_ipv6_addr_onlink(&iface,
-				    &NET_IPV6_BUF(buf)->dst)) {
+	/* The root of a non-storing DODAG routes the packets going down */
+	ret = net_rpl_insert_srh(buf);
+	if (ret < 0) {
+		net_nbuf_unref(buf);
+		return NULL;
+	} else if (ret > 0) {
+		nexthop = &NET_IPV6_BUF(buf)->dst;
+	} else if (net_if_ipv6_addr_onlink(&iface,
+					   &NET_IPV6_BUF(buf)->dst)) {
 		nexthop = &NET_IPV6_BUF(buf)->dst;
 		net_nbuf_set_iface(buf, iface);
 	} else {
@@ -542,8 +731,16 @@ struct net_buf *net_ipv6_prepare_for_send(struct net_buf *buf)
 	}
 
 try_send:
-	nbr = nbr_lookup(&net_neighbor.table, net_nbuf_iface(buf),
-			 &NET_IPV6_BUF(buf)->dst);
+	iface = net_nbuf_iface(buf);
+
+	/* Consecutive packets usually go to the same neighbor */
+	nbr = iface->nbr_last;
+	if (!nbr || !nbr->ref || nbr->iface != iface ||
+	    !net_ipv6_addr_cmp(&net_ipv6_nbr_data(nbr)->addr,
+			       &NET_IPV6_BUF(buf)->dst)) {
+		nbr = nbr_lookup(&net_neighbor.table, iface,
+				 &NET_IPV6_BUF(buf)->dst);
+	}
 
 	NET_DBG("Neighbor lookup %p (%d) iface %p addr %s", nbr,
 		nbr ? nbr->idx : NET_NBR_LLADDR_UNKNOWN,
@@ -558,6 +755,9 @@ try_send:
 		net_nbuf_ll_dst(buf)->addr = lladdr->addr;
 		net_nbuf_ll_dst(buf)->len = lladdr->len;
 
+		iface->nbr_last = nbr;
+		net_ipv6_nbr_data(nbr)->last_used = k_uptime_get_32();
+
 		NET_DBG("Neighbor %p addr %s", nbr,
 			net_sprint_ll_addr(lladdr->addr, lladdr->len));
 
@@ -815,7 +1015,9 @@ int net_ipv6_send_na(struct net_if *iface, struct in6_addr *src,
 			 llao_len);
 
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	}
 
 	dbg_addr_sent_tgt("Neighbor Advertisement",
 			  &NET_IPV6_BUF(buf)->src,
@@ -1015,7 +1217,7 @@ static void nd_reachable_timeout(struct k_work *work)
 {
 	struct net_ipv6_nbr_data *data = CONTAINER_OF(work,
 						      struct net_ipv6_nbr_data,
-						      send_ns);
+						      reachable);
 
 	struct net_nbr *nbr = get_nbr_from_data(data);
 
@@ -1098,6 +1300,7 @@ void net_ipv6_nbr_set_reachable_timer(struct net_if *iface, struct net_nbr *nbr)
 
 	k_delayed_work_init(&net_ipv6_nbr_data(nbr)->reachable,
 			    nd_reachable_timeout);
+	net_timer_slack_init(&net_ipv6_nbr_data(nbr)->reachable);
 
 	k_delayed_work_submit(&net_ipv6_nbr_data(nbr)->reachable, time);
 }
@@ -1109,7 +1312,6 @@ static inline bool handle_na_neighbor(struct net_buf *buf,
 	bool lladdr_changed = false;
 	struct net_nbr *nbr;
 	struct net_linkaddr_storage *cached_lladdr;
-	struct net_buf *pending;
 
 	ARG_UNUSED(hdr);
 
@@ -1241,20 +1443,13 @@ static inline bool handle_na_neighbor(struct net_buf *buf,
 
 send_pending:
 	/* Next send any pending messages to the peer. */
-	pending = net_ipv6_nbr_data(nbr)->pending;
-
-	if (pending) {
-		NET_DBG("Sending pending %p to %s lladdr %s", pending,
-			net_sprint_ipv6_addr(&NET_IPV6_BUF(pending)->dst),
+	if (net_ipv6_nbr_data(nbr)->pending_count) {
+		NET_DBG("Sending %d pending to lladdr %s",
+			net_ipv6_nbr_data(nbr)->pending_count,
 			net_sprint_ll_addr(cached_lladdr->addr,
 					   cached_lladdr->len));
 
-		if (net_send_data(pending) < 0) {
-			net_nbuf_unref(pending);
-			nbr_clear_ns_pending(net_ipv6_nbr_data(nbr));
-		} else {
-			net_ipv6_nbr_data(nbr)->pending = NULL;
-		}
+		nbr_send_pending(net_ipv6_nbr_data(nbr));
 	}
 
 	return true;
@@ -1446,7 +1641,9 @@ int net_ipv6_send_ns(struct net_if *iface,
 	}
 
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	}
 
 	nbr = nbr_lookup(&net_neighbor.table, net_nbuf_iface(buf),
 			 &NET_ICMPV6_NS_BUF(buf)->tgt);
@@ -1465,16 +1662,24 @@ int net_ipv6_send_ns(struct net_if *iface,
 	}
 
 	if (pending) {
-		if (!net_ipv6_nbr_data(nbr)->pending) {
-			net_ipv6_nbr_data(nbr)->pending = net_nbuf_ref(pending);
-		} else {
-			NET_DBG("Buffer %p already pending for "
-				"operation. Discarding pending %p and buf %p",
-				net_ipv6_nbr_data(nbr)->pending, pending, buf);
+		bool first = !net_ipv6_nbr_data(nbr)->pending_count;
+
+		if (!nbr_queue_pending(net_ipv6_nbr_data(nbr), pending)) {
+			NET_DBG("Cannot queue buf %p, discarding it and buf %p",
+				pending, buf);
 			net_nbuf_unref(pending);
 			goto drop;
 		}
 
+		/* The NS sent for the first buffer resolves the others */
+		if (!first) {
+			NET_DBG("Buf %p queued behind %d pending",
+				pending,
+				net_ipv6_nbr_data(nbr)->pending_count - 1);
+			net_nbuf_unref(buf);
+			return 0;
+		}
+
 		NET_DBG("Setting timeout %d for NS", NS_REPLY_TIMEOUT);
 
 		k_delayed_work_init(&net_ipv6_nbr_data(nbr)->send_ns,
@@ -1555,7 +1760,9 @@ int net_ipv6_send_rs(struct net_if *iface)
 	}
 
 	NET_ICMP_BUF(buf)->chksum = 0;
-	NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+	}
 
 	dbg_addr_sent("Router Solicitation",
 		      &NET_IPV6_BUF(buf)->src,
@@ -1741,8 +1948,7 @@ static inline uint32_t remaining(struct k_delayed_work *work)
 		return NET_IPV6_ND_INFINITE_LIFETIME;
 	}
 
-	return (uint32_t)work->timeout.delta_ticks_from_prev /
-		sys_clock_ticks_per_sec;
+	return (uint32_t)k_delayed_work_remaining_get(work) / MSEC_PER_SEC;
 }
 
 static inline void handle_prefix_autonomous(struct net_buf *buf,
@@ -2057,17 +2263,8 @@ static enum net_verdict handle_ra_input(struct net_buf *buf)
 				       router_lifetime);
 	}
 
-	if (nbr && net_ipv6_nbr_data(nbr)->pending) {
-		NET_DBG("Sending pending buf %p to %s",
-			net_ipv6_nbr_data(nbr)->pending,
-			net_sprint_ipv6_addr(&NET_IPV6_BUF(
-					net_ipv6_nbr_data(nbr)->pending)->dst));
-
-		if (net_send_data(net_ipv6_nbr_data(nbr)->pending) < 0) {
-			net_nbuf_unref(net_ipv6_nbr_data(nbr)->pending);
-		}
-
-		nbr_clear_ns_pending(net_ipv6_nbr_data(nbr));
+	if (nbr && net_ipv6_nbr_data(nbr)->pending_count) {
+		nbr_send_pending(net_ipv6_nbr_data(nbr));
 	}
 
 	/* Cancel the RS timer on iface */
@@ -2084,6 +2281,779 @@ drop:
 }
 #endif /* CONFIG_NET_IPV6_ND */
 
+#if defined(CONFIG_NET_IPV6_PMTU)
+#define PMTU_TIMEOUT K_MINUTES(CONFIG_NET_IPV6_PMTU_TIMEOUT)
+
+/* RFC 2460, ch 5 */
+#define IPV6_MIN_MTU 1280
+
+struct ipv6_pmtu {
+	struct in6_addr dst;
+	struct net_if *iface;
+	uint32_t updated;
+	uint16_t mtu;
+	bool used;
+};
+
+static struct ipv6_pmtu pmtu_cache[CONFIG_NET_IPV6_PMTU_CACHE_SIZE];
+
+/* Must be called with interrupts locked */
+static struct ipv6_pmtu *pmtu_find(struct net_if *iface,
+				   const struct in6_addr *dst)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pmtu_cache); i++) {
+		struct ipv6_pmtu *entry = &pmtu_cache[i];
+
+		if (!entry->used) {
+			continue;
+		}
+
+		if ((int32_t)(k_uptime_get_32() - entry->updated) >=
+		    PMTU_TIMEOUT) {
+			entry->used = false;
+			continue;
+		}
+
+		if (entry->iface == iface &&
+		    net_ipv6_addr_cmp(&entry->dst, dst)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+uint16_t net_ipv6_pmtu_get(struct net_if *iface, const struct in6_addr *dst)
+{
+	uint16_t mtu = net_if_get_mtu(iface);
+	struct ipv6_pmtu *entry;
+	unsigned int key;
+
+	key = irq_lock();
+
+	entry = pmtu_find(iface, dst);
+	if (entry && (!mtu || entry->mtu < mtu)) {
+		mtu = entry->mtu;
+	}
+
+	irq_unlock(key);
+
+	return mtu;
+}
+
+void net_ipv6_pmtu_update(struct net_if *iface, const struct in6_addr *dst,
+			  uint32_t mtu)
+{
+	struct ipv6_pmtu *entry;
+	unsigned int key;
+	int i;
+
+	if (mtu < IPV6_MIN_MTU) {
+		mtu = IPV6_MIN_MTU;
+	}
+
+	key = irq_lock();
+
+	entry = pmtu_find(iface, dst);
+	if (entry) {
+		if (mtu >= entry->mtu) {
+			irq_unlock(key);
+			return;
+		}
+	} else {
+		if (net_if_get_mtu(iface) && mtu >= net_if_get_mtu(iface)) {
+			irq_unlock(key);
+			return;
+		}
+
+		/* Take a free entry, or replace the least recently
+		 * updated one.
+		 */
+		entry = &pmtu_cache[0];
+
+		for (i = 0; i < ARRAY_SIZE(pmtu_cache); i++) {
+			if (!pmtu_cache[i].used) {
+				entry = &pmtu_cache[i];
+				break;
+			}
+
+			if ((int32_t)(pmtu_cache[i].updated -
+				      entry->updated) < 0) {
+				entry = &pmtu_cache[i];
+			}
+		}
+
+		net_ipaddr_copy(&entry->dst, dst);
+		entry->iface = iface;
+		entry->used = true;
+	}
+
+	entry->mtu = mtu;
+	entry->updated = k_uptime_get_32();
+
+	irq_unlock(key);
+
+	NET_DBG("Path MTU to %s is %u", net_sprint_ipv6_addr(dst), mtu);
+}
+
+static enum net_verdict handle_ptb_input(struct net_buf *buf)
+{
+	uint16_t offset = net_nbuf_ip_hdr_len(buf) + net_nbuf_ext_len(buf) +
+		sizeof(struct net_icmp_hdr);
+	struct net_ipv6_hdr orig;
+	struct net_buf *frag;
+	uint32_t mtu;
+	uint16_t pos;
+
+	/* The MTU is followed by as much of the packet that was too big
+	 * as fits in the message.
+	 */
+	frag = net_nbuf_read_be32(buf->frags, offset, &pos, &mtu);
+	frag = net_nbuf_read(frag, pos, &pos, sizeof(orig), (uint8_t *)&orig);
+	if (!frag && pos == 0xffff) {
+		NET_DBG("Packet Too Big message too short");
+		return NET_DROP;
+	}
+
+	/* Only the packets we have sent can be too big for our path */
+	if (!net_is_my_ipv6_addr(&orig.src)) {
+		NET_DBG("Packet Too Big message not about our packet");
+		return NET_DROP;
+	}
+
+	net_ipv6_pmtu_update(net_nbuf_iface(buf), &orig.dst, mtu);
+
+	net_nbuf_unref(buf);
+
+	return NET_OK;
+}
+
+static struct net_icmpv6_handler ptb_input_handler = {
+	.type = NET_ICMPV6_PACKET_TOO_BIG,
+	.code = 0,
+	.handler = handle_ptb_input,
+};
+#endif /* CONFIG_NET_IPV6_PMTU */
+
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+
+#define REASS_COUNT CONFIG_NET_IPV6_FRAGMENT_REASS_COUNT
+#define MAX_FRAGS CONFIG_NET_IPV6_FRAGMENT_MAX_FRAGS
+#define REASS_TIMEOUT K_SECONDS(CONFIG_NET_IPV6_FRAGMENT_TIMEOUT)
+
+#define FRAG_HDR_LEN 8
+#define FRAG_OFFSET_MASK 0xfff8
+#define FRAG_MORE BIT(0)
+
+struct ipv6_frag {
+	struct ipv6_frag *next;
+
+	/* Data fragments, holding the payload only */
+	struct net_buf *data;
+
+	/* Place of the payload in the packet, in bytes */
+	uint16_t offset;
+	uint16_t len;
+};
+
+struct ipv6_reass {
+	/* Fragments received so far, sorted by offset */
+	struct ipv6_frag *frags;
+
+	/* Unfragmentable part of the first fragment, NULL until the
+	 * first fragment is received.
+	 */
+	struct net_buf *hdr;
+
+	struct in6_addr src;
+	struct in6_addr dst;
+
+	uint32_t last_used;
+	uint32_t expiry;
+
+	uint32_t id;
+
+	/* Payload length, known once the last fragment is received */
+	uint16_t len;
+
+	bool used;
+};
+
+static struct ipv6_reass reass_cache[REASS_COUNT];
+static struct ipv6_frag frags[MAX_FRAGS];
+static struct ipv6_frag *free_frags;
+
+static struct k_sem reass_lock;
+static struct k_delayed_work reass_timer;
+static bool reass_timer_armed;
+
+static void frag_free(struct ipv6_frag *frag)
+{
+	if (frag->data) {
+		net_nbuf_unref(frag->data);
+		frag->data = NULL;
+	}
+
+	frag->next = free_frags;
+	free_frags = frag;
+}
+
+/* Must be called with reass_lock held */
+static void reass_free(struct ipv6_reass *reass)
+{
+	while (reass->frags) {
+		struct ipv6_frag *frag = reass->frags;
+
+		reass->frags = frag->next;
+		frag_free(frag);
+	}
+
+	if (reass->hdr) {
+		net_nbuf_unref(reass->hdr);
+		reass->hdr = NULL;
+	}
+
+	reass->used = false;
+}
+
+/* Must be called with reass_lock held */
+static void reass_timer_arm(void)
+{
+	uint32_t now = k_uptime_get_32();
+	int32_t delay = -1;
+	int i;
+
+	for (i = 0; i < REASS_COUNT; i++) {
+		int32_t left = reass_cache[i].expiry - now;
+
+		if (!reass_cache[i].used) {
+			continue;
+		}
+
+		if (delay < 0 || left < delay) {
+			delay = max(left, 0);
+		}
+	}
+
+	if (delay < 0) {
+		return;
+	}
+
+	k_delayed_work_submit(&reass_timer, delay);
+	reass_timer_armed = true;
+}
+
+static void reass_timeout(struct k_work *work)
+{
+	uint32_t now = k_uptime_get_32();
+	int i;
+
+	ARG_UNUSED(work);
+
+	k_sem_take(&reass_lock, K_FOREVER);
+
+	reass_timer_armed = false;
+
+	for (i = 0; i < REASS_COUNT; i++) {
+		struct ipv6_reass *reass = &reass_cache[i];
+
+		if (reass->used && (int32_t)(now - reass->expiry) >= 0) {
+			NET_DBG("Reassembly of packet 0x%x timed out",
+				reass->id);
+			reass_free(reass);
+			net_stats_update_ipv6_frag_timeout();
+		}
+	}
+
+	reass_timer_arm();
+
+	k_sem_give(&reass_lock);
+}
+
+/* Least recently updated packet, other than the one being updated,
+ * and holding fragments if 'with_frags' is set.
+ *
+ * Must be called with reass_lock held.
+ */
+static struct ipv6_reass *reass_lru(struct ipv6_reass *current,
+				    bool with_frags)
+{
+	struct ipv6_reass *lru = NULL;
+	int i;
+
+	for (i = 0; i < REASS_COUNT; i++) {
+		struct ipv6_reass *reass = &reass_cache[i];
+
+		if (!reass->used || reass == current ||
+		    (with_frags && !reass->frags)) {
+			continue;
+		}
+
+		if (!lru || (int32_t)(reass->last_used - lru->last_used) < 0) {
+			lru = reass;
+		}
+	}
+
+	return lru;
+}
+
+/* Must be called with reass_lock held */
+static struct ipv6_reass *reass_get(struct net_ipv6_hdr *hdr, uint32_t id)
+{
+	struct ipv6_reass *reass = NULL;
+	int i;
+
+	for (i = 0; i < REASS_COUNT; i++) {
+		if (!reass_cache[i].used) {
+			reass = reass ? reass : &reass_cache[i];
+			continue;
+		}
+
+		if (reass_cache[i].id == id &&
+		    net_ipv6_addr_cmp(&reass_cache[i].src, &hdr->src) &&
+		    net_ipv6_addr_cmp(&reass_cache[i].dst, &hdr->dst)) {
+			return &reass_cache[i];
+		}
+	}
+
+	if (!reass) {
+		reass = reass_lru(NULL, false);
+
+		NET_DBG("Evicting packet 0x%x", reass->id);
+		reass_free(reass);
+		net_stats_update_ipv6_frag_evicted();
+	}
+
+	reass->frags = NULL;
+	reass->hdr = NULL;
+	net_ipaddr_copy(&reass->src, &hdr->src);
+	net_ipaddr_copy(&reass->dst, &hdr->dst);
+	reass->id = id;
+	reass->len = 0;
+	reass->expiry = k_uptime_get_32() + REASS_TIMEOUT;
+	reass->used = true;
+
+	if (!reass_timer_armed) {
+		reass_timer_arm();
+	}
+
+	return reass;
+}
+
+/* Take a fragment slot, evicting other packets if the budget is
+ * exhausted.
+ *
+ * Must be called with reass_lock held.
+ */
+static struct ipv6_frag *frag_alloc(struct ipv6_reass *current)
+{
+	struct ipv6_frag *frag;
+
+	while (!free_frags) {
+		struct ipv6_reass *lru = reass_lru(current, true);
+
+		if (!lru) {
+			return NULL;
+		}
+
+		NET_DBG("Evicting packet 0x%x", lru->id);
+		reass_free(lru);
+		net_stats_update_ipv6_frag_evicted();
+	}
+
+	frag = free_frags;
+	free_frags = frag->next;
+
+	return frag;
+}
+
+/* Must be called with reass_lock held */
+static bool reass_is_complete(struct ipv6_reass *reass)
+{
+	struct ipv6_frag *frag;
+	uint16_t expected = 0;
+
+	if (!reass->len || !reass->hdr) {
+		return false;
+	}
+
+	for (frag = reass->frags; frag; frag = frag->next) {
+		if (frag->offset != expected) {
+			return false;
+		}
+
+		expected += frag->len;
+	}
+
+	return expected == reass->len;
+}
+
+/* Move the unfragmentable part and the fragments of a complete packet
+ * to the buffer and release the packet.
+ *
+ * Must be called with reass_lock held.
+ */
+static void reass_deliver(struct ipv6_reass *reass, struct net_buf *buf)
+{
+	struct ipv6_frag *frag;
+
+	buf->frags = reass->hdr;
+	reass->hdr = NULL;
+
+	for (frag = reass->frags; frag; frag = frag->next) {
+		net_buf_frag_add(buf->frags, frag->data);
+		frag->data = NULL;
+	}
+
+	reass_free(reass);
+}
+
+/* Copy the unfragmentable part of the first fragment, to become the
+ * headers of the reassembled packet.
+ */
+static struct net_buf *copy_unfragmentable(struct net_buf *buf,
+					   uint16_t len, uint16_t nexthdr_off,
+					   uint8_t nexthdr)
+{
+	struct net_buf *hdr;
+	uint16_t pos;
+
+	hdr = net_nbuf_get_reserve_data(net_buf_headroom(buf->frags));
+	if (!hdr) {
+		return NULL;
+	}
+
+	if (len > net_buf_tailroom(hdr)) {
+		NET_DBG("Unfragmentable part of %u bytes too long", len);
+		net_nbuf_unref(hdr);
+		return NULL;
+	}
+
+	net_nbuf_read(buf->frags, 0, &pos, len, net_buf_add(hdr, len));
+
+	hdr->data[nexthdr_off] = nexthdr;
+
+	return hdr;
+}
+
+enum net_verdict net_ipv6_reassemble(struct net_buf *buf,
+				     uint16_t frag_hdr_off,
+				     uint16_t nexthdr_off)
+{
+	struct net_ipv6_hdr *hdr = NET_IPV6_BUF(buf);
+	uint8_t frag_hdr[FRAG_HDR_LEN];
+	struct ipv6_frag **pos, *frag;
+	struct ipv6_reass *reass;
+	struct net_buf *unfrag = NULL;
+	uint16_t offset, len, read_pos;
+	uint32_t id;
+	bool more;
+
+	net_stats_update_ipv6_frag_recv();
+
+	if (!net_nbuf_read(buf->frags, frag_hdr_off, &read_pos,
+			   sizeof(frag_hdr), frag_hdr) && read_pos == 0xffff) {
+		NET_DBG("Fragment header truncated");
+		goto drop;
+	}
+
+	offset = sys_get_be16(&frag_hdr[2]) & FRAG_OFFSET_MASK;
+	more = sys_get_be16(&frag_hdr[2]) & FRAG_MORE;
+	id = sys_get_be32(&frag_hdr[4]);
+	len = net_buf_frags_len(buf->frags) - frag_hdr_off - FRAG_HDR_LEN;
+
+	if (net_buf_frags_len(buf->frags) <= frag_hdr_off + FRAG_HDR_LEN ||
+	    (more && (len % 8)) || offset + len > 0xffff) {
+		NET_DBG("Invalid fragment of packet 0x%x", id);
+		goto drop;
+	}
+
+	if (!offset) {
+		unfrag = copy_unfragmentable(buf, frag_hdr_off, nexthdr_off,
+					     frag_hdr[0]);
+		if (!unfrag) {
+			goto drop;
+		}
+	}
+
+	k_sem_take(&reass_lock, K_FOREVER);
+
+	reass = reass_get(hdr, id);
+	reass->last_used = k_uptime_get_32();
+
+	if (reass->len && offset + len > reass->len) {
+		goto drop_packet;
+	}
+
+	for (pos = &reass->frags; *pos && (*pos)->offset < offset;
+	     pos = &(*pos)->next) {
+		if ((*pos)->offset + (*pos)->len > offset) {
+			goto drop_packet;
+		}
+	}
+
+	if (*pos && (*pos)->offset == offset && (*pos)->len == len) {
+		NET_DBG("Duplicate fragment of packet 0x%x", id);
+		k_sem_give(&reass_lock);
+		goto drop;
+	}
+
+	/* Overlapping fragments are not allowed, see RFC 5722 */
+	if (*pos && offset + len > (*pos)->offset) {
+		goto drop_packet;
+	}
+
+	if (!more) {
+		if (*pos || (reass->len && reass->len != offset + len)) {
+			goto drop_packet;
+		}
+
+		reass->len = offset + len;
+	}
+
+	frag = frag_alloc(reass);
+	if (!frag) {
+		NET_DBG("Packet 0x%x exceeds the fragment budget", id);
+		goto drop_packet;
+	}
+
+	if (unfrag) {
+		reass->hdr = unfrag;
+		unfrag = NULL;
+	}
+
+	frag->offset = offset;
+	frag->len = len;
+	frag->data = net_nbuf_pull(buf->frags, frag_hdr_off + FRAG_HDR_LEN);
+	buf->frags = NULL;
+
+	frag->next = *pos;
+	*pos = frag;
+
+	if (!reass_is_complete(reass)) {
+		k_sem_give(&reass_lock);
+		net_nbuf_unref(buf);
+		return NET_OK;
+	}
+
+	reass_deliver(reass, buf);
+
+	k_sem_give(&reass_lock);
+
+	len = net_buf_frags_len(buf->frags) - sizeof(struct net_ipv6_hdr);
+	NET_IPV6_BUF(buf)->len[0] = len >> 8;
+	NET_IPV6_BUF(buf)->len[1] = len;
+
+	NET_DBG("Reassembled packet 0x%x, %u bytes", id, len);
+
+	net_stats_update_ipv6_frag_reassembled();
+
+	return NET_CONTINUE;
+
+drop_packet:
+	NET_DBG("Inconsistent fragment, dropping packet 0x%x", id);
+	reass_free(reass);
+	k_sem_give(&reass_lock);
+
+drop:
+	if (unfrag) {
+		net_nbuf_unref(unfrag);
+	}
+
+	net_stats_update_ipv6_frag_drop();
+
+	return NET_DROP;
+}
+
+/* Compute the upper layer checksum the interface would have filled in:
+ * it spans the whole packet, so it cannot be left to each fragment.
+ */
+static void fill_upper_chksum(struct net_buf *buf, uint8_t proto)
+{
+	switch (proto) {
+	case IPPROTO_ICMPV6:
+		NET_ICMP_BUF(buf)->chksum = 0;
+		NET_ICMP_BUF(buf)->chksum = ~net_calc_chksum_icmpv6(buf);
+		break;
+#if defined(CONFIG_NET_UDP)
+	case IPPROTO_UDP:
+		NET_UDP_BUF(buf)->chksum = 0;
+		NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+		break;
+#endif
+#if defined(CONFIG_NET_TCP)
+	case IPPROTO_TCP:
+		NET_TCP_BUF(buf)->chksum = 0;
+		NET_TCP_BUF(buf)->chksum = ~net_calc_chksum_tcp(buf);
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+int net_ipv6_send_fragments(struct net_buf *buf, uint16_t mtu)
+{
+	uint16_t nexthdr_off = offsetof(struct net_ipv6_hdr, nexthdr);
+	uint16_t unfrag_len = sizeof(struct net_ipv6_hdr);
+	uint8_t nexthdr = NET_IPV6_BUF(buf)->nexthdr;
+	struct net_buf *src;
+	uint16_t total, max_len, offset, src_pos;
+	uint32_t id;
+
+	/* The hop-by-hop options and the routing header are processed
+	 * by each node on the path, they must be in each fragment.
+	 */
+	while (nexthdr == NET_IPV6_NEXTHDR_HBHO ||
+	       nexthdr == NET_IPV6_NEXTHDR_ROUTING) {
+		uint8_t next, length;
+		uint16_t pos;
+
+		src = net_nbuf_read_u8(buf->frags, unfrag_len, &pos, &next);
+		src = net_nbuf_read_u8(src, pos, &pos, &length);
+		if (!src && pos == 0xffff) {
+			return -EMSGSIZE;
+		}
+
+		nexthdr_off = unfrag_len;
+		unfrag_len += length * 8 + 8;
+		nexthdr = next;
+	}
+
+	/* Each fragment starts with a copy of the unfragmentable part and
+	 * the Fragment header, in its first data fragment.
+	 */
+	total = net_buf_frags_len(buf->frags);
+	if (unfrag_len >= total ||
+	    mtu < unfrag_len + FRAG_HDR_LEN + 8 ||
+	    net_nbuf_ll_reserve(buf) + unfrag_len + FRAG_HDR_LEN >
+	    CONFIG_NET_NBUF_DATA_SIZE) {
+		NET_DBG("Cannot fragment buf %p to fit in MTU %u", buf, mtu);
+		return -EMSGSIZE;
+	}
+
+	total -= unfrag_len;
+	max_len = (mtu - unfrag_len - FRAG_HDR_LEN) & ~7;
+
+	if (net_nbuf_tx_chksum_offloaded(buf)) {
+		fill_upper_chksum(buf, nexthdr);
+	}
+
+	id = sys_rand32_get();
+
+	src = buf->frags;
+	src_pos = unfrag_len;
+
+	for (offset = 0; offset < total; ) {
+		uint16_t len = min(max_len, total - offset);
+		bool last = (offset + len == total);
+		struct net_buf *frag_buf, *frag;
+		uint16_t left, pos;
+		uint8_t *frag_hdr;
+
+		frag_buf = net_nbuf_get_reserve_tx(0);
+		if (!frag_buf) {
+			goto fail;
+		}
+
+		frag = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
+		if (!frag) {
+			net_nbuf_unref(frag_buf);
+			goto fail;
+		}
+
+		net_buf_frag_add(frag_buf, frag);
+
+		net_nbuf_set_iface(frag_buf, net_nbuf_iface(buf));
+		net_nbuf_set_family(frag_buf, AF_INET6);
+		net_nbuf_set_ll_reserve(frag_buf, net_nbuf_ll_reserve(buf));
+		net_nbuf_set_ip_hdr_len(frag_buf, sizeof(struct net_ipv6_hdr));
+		net_nbuf_set_ext_len(frag_buf, unfrag_len + FRAG_HDR_LEN -
+				     sizeof(struct net_ipv6_hdr));
+		net_nbuf_set_priority(frag_buf, net_nbuf_priority(buf));
+		*net_nbuf_ll_src(frag_buf) = *net_nbuf_ll_src(buf);
+		*net_nbuf_ll_dst(frag_buf) = *net_nbuf_ll_dst(buf);
+
+		/* Only the last fragment notifies the sender */
+		if (last) {
+			net_nbuf_set_context(frag_buf, net_nbuf_context(buf));
+			net_nbuf_set_token(frag_buf, net_nbuf_token(buf));
+		}
+
+		net_nbuf_read(buf->frags, 0, &pos, unfrag_len,
+			      net_buf_add(frag, unfrag_len));
+		frag->data[nexthdr_off] = NET_IPV6_NEXTHDR_FRAG;
+
+		frag_hdr = net_buf_add(frag, FRAG_HDR_LEN);
+		frag_hdr[0] = nexthdr;
+		frag_hdr[1] = 0;
+		sys_put_be16(offset | (last ? 0 : FRAG_MORE), &frag_hdr[2]);
+		sys_put_be32(id, &frag_hdr[4]);
+
+		for (left = len; left; ) {
+			uint16_t count;
+
+			while (src_pos >= src->len) {
+				src_pos -= src->len;
+				src = src->frags;
+			}
+
+			count = min(left, src->len - src_pos);
+			if (!net_nbuf_append(frag_buf, count,
+					     src->data + src_pos)) {
+				net_nbuf_unref(frag_buf);
+				goto fail;
+			}
+
+			src_pos += count;
+			left -= count;
+		}
+
+		sys_put_be16(unfrag_len + FRAG_HDR_LEN + len -
+			     sizeof(struct net_ipv6_hdr),
+			     NET_IPV6_BUF(frag_buf)->len);
+
+		if (net_if_send_data(net_nbuf_iface(frag_buf),
+				     frag_buf) == NET_DROP) {
+			net_nbuf_unref(frag_buf);
+			goto fail;
+		}
+
+		net_stats_update_ipv6_frag_sent();
+
+		offset += len;
+	}
+
+	net_nbuf_unref(buf);
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment of buf %p", buf);
+
+	return -EIO;
+}
+
+static void reass_init(void)
+{
+	int i;
+
+	k_sem_init(&reass_lock, 0, UINT_MAX);
+	k_delayed_work_init(&reass_timer, reass_timeout);
+
+	for (i = 0; i < MAX_FRAGS; i++) {
+		frags[i].next = free_frags;
+		free_frags = &frags[i];
+	}
+
+	k_sem_give(&reass_lock);
+}
+#else
+#define reass_init(...)
+#endif /* CONFIG_NET_IPV6_FRAGMENT */
+
 #if defined(CONFIG_NET_IPV6_ND)
 static struct net_icmpv6_handler ns_input_handler = {
 	.type = NET_ICMPV6_NS,
@@ -2111,4 +3081,9 @@ void net_ipv6_init(void)
 	net_icmpv6_register_handler(&na_input_handler);
 	net_icmpv6_register_handler(&ra_input_handler);
 #endif
+#if defined(CONFIG_NET_IPV6_PMTU)
+	net_icmpv6_register_handler(&ptb_input_handler);
+#endif
+
+	reass_init();
 }
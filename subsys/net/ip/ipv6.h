@@ -52,6 +52,7 @@
 #define NET_IPV6_EXT_HDR_OPT_PAD1  0
 #define NET_IPV6_EXT_HDR_OPT_PADN  1
 #define NET_IPV6_EXT_HDR_OPT_RPL   0x63
+#define NET_IPV6_EXT_HDR_OPT_MPL   0x6d
 
 /* State of the neighbor */
 enum net_nbr_state {
@@ -66,8 +67,16 @@ enum net_nbr_state {
  * @brief IPv6 neighbor information.
  */
 struct net_ipv6_nbr_data {
-	/** Any pending buffer waiting ND to finish. */
-	struct net_buf *pending;
+	/** Node in the neighbor lookup hash table. */
+	sys_snode_t node;
+
+#if defined(CONFIG_NET_IPV6_ND)
+	/** Buffers waiting ND to finish, in the order they were sent. */
+	struct net_buf *pending[CONFIG_NET_IPV6_ND_PENDING_COUNT];
+
+	/** Number of buffers in the pending queue. */
+	uint8_t pending_count;
+#endif
 
 	/** IPv6 address. */
 	struct in6_addr addr;
@@ -81,6 +90,9 @@ struct net_ipv6_nbr_data {
 	/** State of the neighbor discovery */
 	enum net_nbr_state state;
 
+	/** Uptime (in ms) when a packet was last sent to the neighbor */
+	uint32_t last_used;
+
 	/** Link metric for the neighbor */
 	uint16_t link_metric;
 
@@ -292,6 +304,80 @@ static inline void net_ipv6_nbr_set_reachable_timer(struct net_if *iface,
 }
 #endif
 
+#if defined(CONFIG_NET_IPV6_PMTU)
+/**
+ * @brief Get the path MTU towards a destination.
+ *
+ * @param iface Network interface the packets are sent through
+ * @param dst Destination address
+ *
+ * @return The path MTU learnt from ICMPv6 Packet Too Big messages if it
+ * is known and still valid, the MTU of the interface otherwise.
+ */
+uint16_t net_ipv6_pmtu_get(struct net_if *iface, const struct in6_addr *dst);
+
+/**
+ * @brief Record a path MTU reported for a destination.
+ *
+ * @details The path MTU can only decrease, and never below the IPv6
+ * minimum link MTU, until its entry expires.
+ *
+ * @param iface Network interface the packets are sent through
+ * @param dst Destination address
+ * @param mtu Reported MTU
+ */
+void net_ipv6_pmtu_update(struct net_if *iface, const struct in6_addr *dst,
+			  uint32_t mtu);
+#else
+static inline uint16_t net_ipv6_pmtu_get(struct net_if *iface,
+					 const struct in6_addr *dst)
+{
+	ARG_UNUSED(dst);
+
+	return net_if_get_mtu(iface);
+}
+#endif /* CONFIG_NET_IPV6_PMTU */
+
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+/**
+ * @brief Add a received fragment to its packet.
+ *
+ * @details The data fragments of the buffer are kept until the
+ * packet is complete, its reassembly times out, or it is evicted
+ * to make room for a newer one. Once the last missing fragment is
+ * received, the whole packet, without the Fragment header, is placed
+ * in the buffer.
+ *
+ * @param buf Network buffer containing an IPv6 fragment
+ * @param frag_hdr_off Offset of the Fragment header in the packet,
+ * i.e. length of the unfragmentable part.
+ * @param nexthdr_off Offset of the Next Header field that contains
+ * the Fragment header type.
+ *
+ * @return NET_OK if the fragment has been kept (the buffer is
+ * consumed), NET_CONTINUE if the buffer now contains the reassembled
+ * packet which must be processed again, NET_DROP if the fragment must
+ * be dropped.
+ */
+enum net_verdict net_ipv6_reassemble(struct net_buf *buf,
+				     uint16_t frag_hdr_off,
+				     uint16_t nexthdr_off);
+
+/**
+ * @brief Send an IPv6 packet as fragments fitting in the MTU.
+ *
+ * @details The buffer is unreferenced once all the fragments have
+ * been sent.
+ *
+ * @param buf Network buffer containing a finalized IPv6 packet
+ * @param mtu Path MTU towards the destination
+ *
+ * @return 0 on success, -EMSGSIZE if the packet cannot be
+ * fragmented, -EIO if a fragment could not be sent.
+ */
+int net_ipv6_send_fragments(struct net_buf *buf, uint16_t mtu);
+#endif /* CONFIG_NET_IPV6_FRAGMENT */
+
 #if defined(CONFIG_NET_IPV6)
 void net_ipv6_init(void);
 #else
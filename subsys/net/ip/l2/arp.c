@@ -20,62 +20,178 @@
 #include <net/net_stats.h>
 #include <net/arp.h>
 #include "net_private.h"
+#include "net_stats.h"
 
 struct arp_entry {
-	uint32_t time;	/* FIXME - implement timeout functionality */
+	/* Node in a hash bucket, or in the free list */
+	sys_snode_t node;
+	/* Node in the LRU list of the entries in use */
+	sys_dnode_t lru;
+	/* Uptime (in ms) when the entry was requested or resolved */
+	uint32_t time;
 	struct net_if *iface;
-	struct net_buf *pending;
+	/* Packets waiting for the resolution, in sending order */
+	struct net_buf *pending[CONFIG_NET_ARP_PENDING_COUNT];
+	uint8_t pending_count;
 	struct in_addr ip;
 	struct net_eth_addr eth;
 };
 
 static struct arp_entry arp_table[CONFIG_NET_ARP_TABLE_SIZE];
 
-static inline struct arp_entry *find_entry(struct net_if *iface,
-					   struct in_addr *dst,
-					   struct arp_entry **free_entry,
-					   struct arp_entry **non_pending)
+/* Entries in use are hashed on their IP address and kept in least recently
+ * used first order, the other ones are in the free list.
+ */
+static sys_slist_t arp_hash[CONFIG_NET_ARP_HASH_BUCKETS];
+static sys_dlist_t arp_lru;
+static sys_slist_t arp_free_entries;
+
+static inline sys_slist_t *arp_bucket(const struct in_addr *addr)
+{
+	uint32_t hash = addr->s_addr[0];
+
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+
+	return &arp_hash[hash % CONFIG_NET_ARP_HASH_BUCKETS];
+}
+
+static inline bool arp_entry_expired(struct arp_entry *entry)
+{
+#if CONFIG_NET_ARP_ENTRY_TIMEOUT > 0
+	return k_uptime_get_32() - entry->time >=
+		K_SECONDS(CONFIG_NET_ARP_ENTRY_TIMEOUT);
+#else
+	return false;
+#endif
+}
+
+static inline void arp_entry_touch(struct arp_entry *entry)
+{
+	sys_dlist_remove(&entry->lru);
+	sys_dlist_append(&arp_lru, &entry->lru);
+}
+
+static void arp_entry_drop_pending(struct arp_entry *entry)
 {
 	int i;
 
-	NET_DBG("dst %s", net_sprint_ipv4_addr(dst));
+	for (i = 0; i < entry->pending_count; i++) {
+		/* To unref when pending variable was set */
+		net_nbuf_unref(entry->pending[i]);
 
-	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
+		/* To unref the original buf allocation */
+		net_nbuf_unref(entry->pending[i]);
 
-		NET_DBG("[%d] iface %p dst %s ll %s pending %p", i, iface,
-			net_sprint_ipv4_addr(&arp_table[i].ip),
-			net_sprint_ll_addr((uint8_t *)&arp_table[i].eth.addr,
-					   sizeof(struct net_eth_addr)),
-			arp_table[i].pending);
-
-		if (arp_table[i].iface == iface &&
-		    net_ipv4_addr_cmp(&arp_table[i].ip, dst)) {
-			/* Is there already pending operation for this
-			 * IP address.
-			 */
-			if (arp_table[i].pending) {
-				NET_DBG("ARP already pending to %s ll %s",
-					net_sprint_ipv4_addr(dst),
-					net_sprint_ll_addr((uint8_t *)
-						&arp_table[i].eth.addr,
-						sizeof(struct net_eth_addr)));
-				*free_entry = NULL;
-				*non_pending = NULL;
-				return NULL;
-			}
-
-			return &arp_table[i];
+		entry->pending[i] = NULL;
+	}
+
+	entry->pending_count = 0;
+}
+
+/* Queue one more packet behind an unresolved address. A retransmission of
+ * a packet already waiting is not queued twice.
+ */
+static bool arp_entry_queue(struct arp_entry *entry, struct net_buf *buf)
+{
+	int i;
+
+	for (i = 0; i < entry->pending_count; i++) {
+		if (entry->pending[i] == buf) {
+			return false;
 		}
+	}
+
+	if (entry->pending_count == CONFIG_NET_ARP_PENDING_COUNT) {
+		NET_DBG("ARP queue to %s full, dropping %p",
+			net_sprint_ipv4_addr(&entry->ip), buf);
+		net_stats_update_arp_pending_drop();
+		return false;
+	}
+
+	entry->pending[entry->pending_count++] = net_buf_ref(buf);
 
-		/* We return also the first free entry */
-		if (!*free_entry && !arp_table[i].pending &&
-		    !arp_table[i].iface) {
-			*free_entry = &arp_table[i];
+	return true;
+}
+
+static void arp_entry_free(struct arp_entry *entry)
+{
+	sys_slist_find_and_remove(arp_bucket(&entry->ip), &entry->node);
+	sys_dlist_remove(&entry->lru);
+
+	entry->iface = NULL;
+
+	sys_slist_append(&arp_free_entries, &entry->node);
+}
+
+/* Get a free entry, or else evict the least recently used entry that has no
+ * packet waiting for its resolution, or whose resolution timed out.
+ */
+static struct arp_entry *arp_entry_get(struct net_if *iface,
+				       struct in_addr *dst)
+{
+	struct arp_entry *entry = NULL;
+	sys_snode_t *node;
+	sys_dnode_t *lru;
+
+	node = sys_slist_get(&arp_free_entries);
+	if (node) {
+		entry = CONTAINER_OF(node, struct arp_entry, node);
+		goto found;
+	}
+
+	SYS_DLIST_FOR_EACH_NODE(&arp_lru, lru) {
+		struct arp_entry *tmp = CONTAINER_OF(lru, struct arp_entry,
+						     lru);
+
+		if (!tmp->pending_count || arp_entry_expired(tmp)) {
+			entry = tmp;
+			break;
 		}
+	}
+
+	if (!entry) {
+		return NULL;
+	}
+
+	NET_DBG("Evicting ARP entry %s pending %d",
+		net_sprint_ipv4_addr(&entry->ip), entry->pending_count);
+
+	arp_entry_drop_pending(entry);
+
+	sys_slist_find_and_remove(arp_bucket(&entry->ip), &entry->node);
+	sys_dlist_remove(&entry->lru);
+
+found:
+	entry->iface = iface;
+	net_ipaddr_copy(&entry->ip, dst);
 
-		/* And also first non pending entry */
-		if (!*non_pending && !arp_table[i].pending) {
-			*non_pending = &arp_table[i];
+	sys_slist_prepend(arp_bucket(dst), &entry->node);
+	sys_dlist_append(&arp_lru, &entry->lru);
+
+	return entry;
+}
+
+static struct arp_entry *find_entry(struct net_if *iface,
+				    struct in_addr *dst)
+{
+	sys_snode_t *node;
+
+	NET_DBG("dst %s", net_sprint_ipv4_addr(dst));
+
+	SYS_SLIST_FOR_EACH_NODE(arp_bucket(dst), node) {
+		struct arp_entry *entry = CONTAINER_OF(node, struct arp_entry,
+						       node);
+
+		NET_DBG("iface %p dst %s ll %s pending %d", iface,
+			net_sprint_ipv4_addr(&entry->ip),
+			net_sprint_ll_addr((uint8_t *)&entry->eth.addr,
+					   sizeof(struct net_eth_addr)),
+			entry->pending_count);
+
+		if (entry->iface == iface &&
+		    net_ipv4_addr_cmp(&entry->ip, dst)) {
+			return entry;
 		}
 	}
 
@@ -131,8 +247,10 @@ static inline struct net_buf *prepare_arp(struct net_if *iface,
 	 * request and we want to send it again.
 	 */
 	if (entry) {
-		entry->pending = net_buf_ref(pending);
+		entry->pending[0] = net_buf_ref(pending);
+		entry->pending_count = 1;
 		entry->iface = net_nbuf_iface(buf);
+		entry->time = k_uptime_get_32();
 
 		net_ipaddr_copy(&entry->ip, next_addr);
 
@@ -179,14 +297,13 @@ static inline struct net_buf *prepare_arp(struct net_if *iface,
 
 fail:
 	net_nbuf_unref(buf);
-	net_nbuf_unref(pending);
 	return NULL;
 }
 
 struct net_buf *net_arp_prepare(struct net_buf *buf)
 {
-	struct net_buf *frag;
-	struct arp_entry *entry, *free_entry = NULL, *non_pending = NULL;
+	struct net_buf *frag, *req;
+	struct arp_entry *entry;
 	struct net_linkaddr *ll;
 	struct net_eth_hdr *hdr;
 	struct in_addr *addr;
@@ -236,39 +353,77 @@ struct net_buf *net_arp_prepare(struct net_buf *buf)
 		addr = &NET_IPV4_BUF(buf)->dst;
 	}
 
+	/* Consecutive packets usually go to the same destination */
+	entry = net_nbuf_iface(buf)->arp_last;
+	if (entry && entry->iface == net_nbuf_iface(buf) &&
+	    !entry->pending_count &&
+	    net_ipv4_addr_cmp(&entry->ip, addr) && !arp_entry_expired(entry)) {
+		goto resolved;
+	}
+
 	/* If the destination address is already known, we do not need
 	 * to send any ARP packet.
 	 */
-	entry = find_entry(net_nbuf_iface(buf),
-			   addr, &free_entry, &non_pending);
+	entry = find_entry(net_nbuf_iface(buf), addr);
+	if (entry && entry->pending_count) {
+		NET_DBG("ARP already pending to %s",
+			net_sprint_ipv4_addr(addr));
+
+		/* The packet waits with the others, the request being
+		 * sent again.
+		 */
+		req = prepare_arp(net_nbuf_iface(buf), addr, NULL, buf);
+		if (!req) {
+			return NULL;
+		}
+
+		if (arp_entry_queue(entry, buf)) {
+			NET_DBG("Resending ARP %p, %p queued", req, buf);
+			return req;
+		}
+
+		goto drop;
+	}
+
+	if (entry && !arp_entry_expired(entry)) {
+		goto resolved;
+	}
+
 	if (!entry) {
-		if (!free_entry) {
-			/* So all the slots are occupied, use the first
-			 * that can be taken.
-			 */
-			if (!non_pending) {
-				/* We cannot send the packet, the ARP
-				 * cache is full or there is already a
-				 * pending query to this IP address,
-				 * so this packet must be discarded.
-				 */
-				struct net_buf *req;
-
-				req = prepare_arp(net_nbuf_iface(buf),
-						  addr, NULL, buf);
-				NET_DBG("Resending ARP %p", req);
-
-				net_nbuf_unref(buf);
-
-				return req;
-			}
-
-			free_entry = non_pending;
+		entry = arp_entry_get(net_nbuf_iface(buf), addr);
+		if (!entry) {
+			goto resend;
 		}
+	}
 
-		return prepare_arp(net_nbuf_iface(buf), addr, free_entry, buf);
+	req = prepare_arp(net_nbuf_iface(buf), addr, entry, buf);
+	if (!req) {
+		arp_entry_free(entry);
 	}
 
+	return req;
+
+resend:
+	req = prepare_arp(net_nbuf_iface(buf), addr, NULL, buf);
+	if (!req) {
+		return NULL;
+	}
+
+drop:
+	/* We cannot send the packet, the ARP cache is full of pending
+	 * queries or the packet cannot wait behind the pending query to
+	 * this IP address, so this packet must be discarded.
+	 */
+	NET_DBG("Resending ARP %p", req);
+
+	net_nbuf_unref(buf);
+
+	return req;
+
+resolved:
+	net_nbuf_iface(buf)->arp_last = entry;
+	arp_entry_touch(entry);
+
 	ll = net_if_get_link_addr(entry->iface);
 
 	NET_DBG("ARP using ll %s for IP %s",
@@ -300,16 +455,13 @@ struct net_buf *net_arp_prepare(struct net_buf *buf)
 	return buf;
 }
 
-static inline void send_pending(struct net_if *iface, struct net_buf **buf)
+static inline void send_pending(struct net_if *iface,
+				struct net_buf *pending)
 {
-	struct net_buf *pending = *buf;
-
 	NET_DBG("dst %s pending %p frag %p",
 		net_sprint_ipv4_addr(&NET_IPV4_BUF(pending)->dst), pending,
 		pending->frags);
 
-	*buf = NULL;
-
 	if (net_if_send_data(iface, pending) == NET_DROP) {
 		/* This is to unref the original ref */
 		net_nbuf_unref(pending);
@@ -327,41 +479,37 @@ static inline void arp_update(struct net_if *iface,
 			      struct in_addr *src,
 			      struct net_eth_addr *hwaddr)
 {
+	struct arp_entry *entry;
 	int i;
 
 	NET_DBG("src %s", net_sprint_ipv4_addr(src));
 
-	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
-
-		NET_DBG("[%d] iface %p dst %s ll %s pending %p", i, iface,
-			net_sprint_ipv4_addr(&arp_table[i].ip),
-			net_sprint_ll_addr((uint8_t *)&arp_table[i].eth.addr,
-					   sizeof(struct net_eth_addr)),
-			arp_table[i].pending);
+	entry = find_entry(iface, src);
+	if (!entry || !entry->pending_count) {
+		/* We only update the ARP cache if we were
+		 * initiating a request.
+		 */
+		return;
+	}
 
-		if (arp_table[i].iface == iface &&
-		    net_ipv4_addr_cmp(&arp_table[i].ip, src)) {
+	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
+	entry->time = k_uptime_get_32();
+	arp_entry_touch(entry);
 
-			if (arp_table[i].pending) {
-				/* We only update the ARP cache if we were
-				 * initiating a request.
-				 */
-				memcpy(&arp_table[i].eth, hwaddr,
-				       sizeof(struct net_eth_addr));
+	for (i = 0; i < entry->pending_count; i++) {
+		struct net_buf *pending = entry->pending[i];
 
-				/* Set the dst in the pending packet */
-				net_nbuf_ll_dst(arp_table[i].pending)->len =
-					sizeof(struct net_eth_addr);
-				net_nbuf_ll_dst(arp_table[i].pending)->addr =
-					(uint8_t *)
-					&NET_ETH_BUF(arp_table[i].pending)->dst.addr;
+		entry->pending[i] = NULL;
 
-				send_pending(iface, &arp_table[i].pending);
-			}
+		/* Set the dst in the pending packet */
+		net_nbuf_ll_dst(pending)->len = sizeof(struct net_eth_addr);
+		net_nbuf_ll_dst(pending)->addr =
+			(uint8_t *)&NET_ETH_BUF(pending)->dst.addr;
 
-			return;
-		}
+		send_pending(iface, pending);
 	}
+
+	entry->pending_count = 0;
 }
 
 static inline struct net_buf *prepare_arp_reply(struct net_if *iface,
@@ -480,5 +628,15 @@ enum net_verdict net_arp_input(struct net_buf *buf)
 
 void net_arp_init(void)
 {
+	int i;
+
 	memset(&arp_table, 0, sizeof(arp_table));
+	memset(&arp_hash, 0, sizeof(arp_hash));
+
+	sys_dlist_init(&arp_lru);
+	sys_slist_init(&arp_free_entries);
+
+	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
+		sys_slist_append(&arp_free_entries, &arp_table[i].node);
+	}
 }
@@ -333,4 +333,68 @@ static inline uint16_t ethernet_reserve(struct net_if *iface, void *unused)
 	return sizeof(struct net_eth_hdr);
 }
 
-NET_L2_INIT(ETHERNET_L2, ethernet_recv, ethernet_send, ethernet_reserve, NULL);
+#if defined(CONFIG_NET_IPV6)
+void net_eth_ipv6_mcast_filter(struct net_if *iface,
+			       const struct in6_addr *addr, bool add)
+{
+	const struct ethernet_api *api = iface->dev->driver_api;
+	struct net_eth_addr mac;
+
+	if (!atomic_test_bit(iface->flags, NET_IF_MCAST_FILTER)) {
+		return;
+	}
+
+	memcpy(mac.addr, multicast_eth_addr.addr, 2);
+	memcpy(mac.addr + 2, &addr->s6_addr[12], 4);
+
+	NET_DBG("iface %p %s %s", iface, add ? "add" : "rm",
+		net_sprint_ll_addr(mac.addr, sizeof(mac)));
+
+	api->mcast_filter(iface->dev, &mac, add);
+}
+
+/* The filter of the device follows the groups of the interface while it
+ * is up: all-nodes, the solicited-node group of every unicast address,
+ * and the groups joined explicitly.
+ */
+static void ethernet_ipv6_mcast_filter_all(struct net_if *iface, bool add)
+{
+	struct in6_addr addr;
+	int i;
+
+	net_ipv6_addr_create_ll_allnodes_mcast(&addr);
+	net_eth_ipv6_mcast_filter(iface, &addr, add);
+
+	for (i = 0; i < NET_IF_MAX_IPV6_ADDR; i++) {
+		if (!iface->ipv6.unicast[i].is_used) {
+			continue;
+		}
+
+		net_ipv6_addr_create_solicited_node(
+			&iface->ipv6.unicast[i].address.in6_addr, &addr);
+		net_eth_ipv6_mcast_filter(iface, &addr, add);
+	}
+
+	for (i = 0; i < NET_IF_MAX_IPV6_MADDR; i++) {
+		if (!iface->ipv6.mcast[i].is_used) {
+			continue;
+		}
+
+		net_eth_ipv6_mcast_filter(iface,
+					  &iface->ipv6.mcast[i].address.in6_addr,
+					  add);
+	}
+}
+#endif /* CONFIG_NET_IPV6 */
+
+static int ethernet_enable(struct net_if *iface, bool state)
+{
+#if defined(CONFIG_NET_IPV6)
+	ethernet_ipv6_mcast_filter_all(iface, state);
+#endif
+
+	return 0;
+}
+
+NET_L2_INIT(ETHERNET_L2, ethernet_recv, ethernet_send, ethernet_reserve,
+	    ethernet_enable);
@@ -21,6 +21,7 @@
 #ifdef CONFIG_NET_L2_IEEE802154_FRAGMENT
 #include "ieee802154_fragment.h"
 #endif
+#include "ieee802154_mesh.h"
 #include <6lo.h>
 #endif /* CONFIG_NET_6LO */
 
@@ -28,6 +29,9 @@
 
 #include "ieee802154_frame.h"
 #include "ieee802154_mgmt.h"
+#include "ieee802154_radio_lpl.h"
+#include "ieee802154_indirect.h"
+#include "ieee802154_security.h"
 
 #if 0
 
@@ -105,6 +109,11 @@ static inline void ieee802154_acknowledge(struct net_if *iface,
 	if (ieee802154_create_ack_frame(iface, buf, mpdu->mhr.fs->sequence)) {
 		const struct ieee802154_radio_api *radio =
 			iface->dev->driver_api;
+		struct ieee802154_fcf_seq *fs =
+			(struct ieee802154_fcf_seq *)net_nbuf_ll(buf);
+
+		fs->fc.frame_pending = ieee802154_indirect_pending(iface,
+								   mpdu);
 
 		net_buf_add(frag, IEEE802154_ACK_PKT_LENGTH);
 
@@ -223,6 +232,7 @@ static enum net_verdict ieee802154_recv(struct net_if *iface,
 					struct net_buf *buf)
 {
 	struct ieee802154_mpdu mpdu;
+	enum net_verdict verdict;
 
 	if (!ieee802154_validate_frame(net_nbuf_ll(buf),
 				       net_buf_frags_len(buf), &mpdu)) {
@@ -237,13 +247,28 @@ static enum net_verdict ieee802154_recv(struct net_if *iface,
 		return NET_DROP;
 	}
 
+	ieee802154_acknowledge(iface, &mpdu);
+
+	/* Data requests only tell a sleepy child is listening */
+	if (ieee802154_indirect_recv(iface, &mpdu) == NET_OK) {
+		net_nbuf_unref(buf);
+		return NET_OK;
+	}
+
 	if (mpdu.mhr.fs->fc.frame_type == IEEE802154_FRAME_TYPE_MAC_COMMAND) {
 		return ieee802154_handle_mac_command(iface, &mpdu);
 	}
 
 	/* At this point the frame has to be a DATA one */
 
-	ieee802154_acknowledge(iface, &mpdu);
+	if (!ieee802154_decrypt_frame(iface, buf, &mpdu)) {
+		return NET_DROP;
+	}
+
+	verdict = ieee802154_lpl_recv(iface, &mpdu);
+	if (verdict != NET_CONTINUE) {
+		return verdict;
+	}
 
 	net_nbuf_set_ll_reserve(buf, mpdu.payload - (void *)net_nbuf_ll(buf));
 	net_buf_pull(buf->frags, net_nbuf_ll_reserve(buf));
@@ -254,6 +279,11 @@ static enum net_verdict ieee802154_recv(struct net_if *iface,
 	set_buf_ll_addr(net_nbuf_ll_dst(buf), false,
 			mpdu.mhr.fs->fc.dst_addr_mode, mpdu.mhr.dst_addr);
 
+	verdict = ieee802154_mesh_recv(iface, buf);
+	if (verdict != NET_CONTINUE) {
+		return verdict;
+	}
+
 	pkt_hexdump(buf, true);
 
 	return ieee802154_manage_recv_buffer(iface, buf);
@@ -306,6 +336,10 @@ static enum net_verdict ieee802154_send(struct net_if *iface,
 
 	pkt_hexdump(buf, true);
 
+	if (ieee802154_indirect_send(iface, buf)) {
+		return NET_OK;
+	}
+
 	net_if_queue_tx(iface, buf);
 
 	return NET_OK;
@@ -348,4 +382,6 @@ void ieee802154_init(struct net_if *iface)
 	radio->set_channel(iface->dev, ctx->channel);
 #endif
 	radio->start(iface->dev);
+
+	ieee802154_lpl_init(iface);
 }
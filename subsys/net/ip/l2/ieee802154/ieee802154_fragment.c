@@ -20,6 +20,7 @@
 #include <net/net_stats.h>
 
 #include "ieee802154_fragment.h"
+#include "ieee802154_security.h"
 
 #include "net_private.h"
 #include "6lo.h"
@@ -29,17 +30,29 @@
 				 CONFIG_NET_L2_IEEE802154_REASSEMBLY_TIMEOUT)
 #define REASS_CACHE_SIZE CONFIG_NET_L2_IEEE802154_FRAGMENT_REASS_CACHE_SIZE
 
+#define REASS_MAX_FRAGS CONFIG_NET_L2_IEEE802154_FRAGMENT_REASS_MAX_FRAGS
+
 static uint16_t datagram_tag;
 
+/* Data of a received fragment, as linked by the RX path */
+struct frag_slot {
+	struct net_buf *frag;		/* Fragment data chain */
+	uint16_t offset;		/* Offset in the datagram */
+	uint16_t len;			/* Length of the data */
+};
+
 /**
  *  Reasseble cache : Depends on cache size it used for reassemble
- *  IPv6 packets simultaneously.
+ *  IPv6 packets simultaneously. Received fragments are kept sorted by
+ *  offset and linked together once the datagram is complete.
  */
 struct frag_cache {
 	struct k_delayed_work timer;	/* Reassemble timer */
-	struct net_buf *buf;		/* Reassemble buffer */
+	struct frag_slot slots[REASS_MAX_FRAGS];
 	uint16_t size;			/* Datagram size */
 	uint16_t tag;			/* Datagram tag */
+	uint16_t received;		/* Amount of data received */
+	uint8_t count;			/* Number of slots in use */
 	bool used;
 };
 
@@ -118,50 +131,35 @@ static inline uint8_t calc_max_payload(struct net_buf *buf,
 {
 	uint8_t max;
 
-	max = frag->size - net_nbuf_ll_reserve(buf);
+	max = frag->size - net_nbuf_ll_reserve(buf) -
+		ieee802154_security_mic_len(net_nbuf_iface(buf));
 	max -= offset ? NET_6LO_FRAGN_HDR_LEN : NET_6LO_FRAG1_HDR_LEN;
 
 	return (max & 0xF8);
 }
 
-static inline uint8_t move_frag_data(struct net_buf *frag,
-				     struct net_buf *next,
-				     uint8_t max, uint8_t moved,
-				     uint8_t offset,
-				     int hdr_diff)
+/* Move up to 'len' bytes from the head of the 'src' chain at the end of
+ * 'frag', releasing the source fragments once they are consumed. Returns
+ * the new head of the source chain.
+ */
+static inline struct net_buf *fill_frag(struct net_buf *frag,
+					struct net_buf *src, int len)
 {
-	uint8_t remaining = max - moved;
-	uint8_t move;
-
-	if (!offset) {
-		remaining -= hdr_diff;
-	}
-
-	/* Calculate remaining space for data to move */
-	move = next->len > remaining ? remaining : next->len;
+	uint16_t copy;
 
-	memmove(frag->data + frag->len, next->data, move);
+	while (src && len > 0) {
+		copy = min(src->len, len);
 
-	net_buf_add(frag, move);
+		memcpy(net_buf_add(frag, copy), src->data, copy);
+		net_buf_pull(src, copy);
+		len -= copy;
 
-	return move;
-}
-
-static inline uint8_t compact_frag(struct net_buf *frag, uint8_t moved)
-{
-	uint8_t remaining = frag->len - moved;
-
-	/* Move remaining data next to fragmentation header,
-	 * (leave space for header).
-	 */
-	if (remaining) {
-		memmove(frag->data + NET_6LO_FRAGN_HDR_LEN,
-			frag->data + moved, remaining);
+		if (!src->len) {
+			src = net_buf_frag_del(NULL, src);
+		}
 	}
 
-	frag->len = NET_6LO_FRAGN_HDR_LEN + remaining;
-
-	return remaining;
+	return src;
 }
 
 /**
@@ -182,20 +180,19 @@ static inline uint8_t compact_frag(struct net_buf *frag, uint8_t moved)
  *  of 8 octets (we have predefined buffers at compile time, data buffer mtu
  *  is set already).
  *
- *  Create the first fragment, add fragmentation header and insert
- *  fragment at beginning of buf, move data from next fragments to
- *  previous one, from here on insert fragmentation header and adjust
- *  data on subsequent buffers.
+ *  Every frame is built in a new fragment: the fragmentation header is
+ *  written first, then the payload is copied once from the input chain,
+ *  whose fragments are released as soon as they are consumed. Radio
+ *  drivers send one fragment per frame, so the frame has to be contiguous.
  */
 bool ieee802154_fragment(struct net_buf *buf, int hdr_diff)
 {
+	struct net_buf *last = NULL;
 	struct net_buf *frag;
-	struct net_buf *next;
+	struct net_buf *src;
 	uint16_t processed;
 	uint16_t offset;
 	uint16_t size;
-	uint8_t moved;
-	uint8_t move;
 	uint8_t max;
 
 	if (!buf || !buf->frags) {
@@ -212,60 +209,45 @@ bool ieee802154_fragment(struct net_buf *buf, int hdr_diff)
 	/* Datagram_size: total length before compression */
 	size = net_buf_frags_len(buf) + hdr_diff;
 
-	frag = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
-	if (!frag) {
-		return false;
-	}
-
-	/* Reserve space for fragmentation header */
-	net_buf_add(frag, NET_6LO_FRAG1_HDR_LEN);
-	net_buf_frag_insert(buf, frag);
+	src = buf->frags;
+	buf->frags = NULL;
 
 	offset = 0;
-	moved = 0;
 	processed = 0;
-	next = frag->frags;
 
 	/* First fragment has compressed header, but SIZE and OFFSET
 	 * values in fragmentation header are based on uncompressed
 	 * IP packet.
 	 */
-	while (1) {
+	while (src) {
+		frag = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
+		if (!frag) {
+			net_nbuf_unref(src);
+			return false;
+		}
+
+		if (last) {
+			last->frags = frag;
+		} else {
+			buf->frags = frag;
+		}
+
+		last = frag;
+
 		/* Set fragmentation header in the beginning */
+		net_buf_add(frag, offset ? NET_6LO_FRAGN_HDR_LEN :
+			    NET_6LO_FRAG1_HDR_LEN);
 		set_up_frag_hdr(frag, size, offset);
 
 		/* Calculate max payload in multiples of 8 bytes */
 		max = calc_max_payload(buf, frag, offset);
 
-		/* Move data from next fragment to current fragment */
-		move = move_frag_data(frag, next, max, moved, offset,
-				      hdr_diff);
-
-		/* Compact the next fragment, returns how much data moved */
-		moved = compact_frag(next, move);
+		src = fill_frag(frag, src, offset ? max : max - hdr_diff);
 
 		/* Calculate how much data is processed */
 		processed += max;
 
 		offset = processed >> 3;
-
-		/** If next fragment is last and data already moved to previous
-		 *  fragment, then delete this fragment, if data is left insert
-		 *  header.
-		 */
-		if (!next->frags) {
-			if (next->len == NET_6LO_FRAGN_HDR_LEN) {
-				net_buf_frag_del(frag, next);
-			} else {
-				set_up_frag_hdr(next, size, offset);
-			}
-
-			break;
-		}
-
-		/* Repeat the steps */
-		frag = next;
-		next = next->frags;
 	}
 
 	return true;
@@ -281,12 +263,6 @@ static inline uint16_t get_datagram_tag(uint8_t *ptr)
 	return (ptr[0] << 8) | ptr[1];
 }
 
-static inline void remove_frag_header(struct net_buf *frag, uint8_t hdr_len)
-{
-	memmove(frag->data, frag->data + hdr_len, frag->len - hdr_len);
-	frag->len -= hdr_len;
-}
-
 static void update_protocol_header_lengths(struct net_buf *buf, uint16_t size)
 {
 	net_nbuf_set_ip_hdr_len(buf, NET_IPV6H_LEN);
@@ -299,23 +275,26 @@ static void update_protocol_header_lengths(struct net_buf *buf, uint16_t size)
 	}
 }
 
-static inline void clear_reass_cache(uint16_t size, uint16_t tag)
+static void free_reass_cache(struct frag_cache *cache)
 {
 	uint8_t i;
 
-	for (i = 0; i < REASS_CACHE_SIZE; i++) {
-		if (!(cache[i].size == size && cache[i].tag == tag)) {
-			continue;
-		}
+	for (i = 0; i < cache->count; i++) {
+		net_nbuf_unref(cache->slots[i].frag);
+		cache->slots[i].frag = NULL;
+	}
 
-		net_nbuf_unref(cache[i].buf);
+	cache->count = 0;
+	cache->received = 0;
+	cache->size = 0;
+	cache->tag = 0;
+	cache->used = false;
+}
 
-		cache[i].buf = NULL;
-		cache[i].size = 0;
-		cache[i].tag = 0;
-		cache[i].used = false;
-		k_delayed_work_cancel(&cache[i].timer);
-	}
+static inline void clear_reass_cache(struct frag_cache *cache)
+{
+	k_delayed_work_cancel(&cache->timer);
+	free_reass_cache(cache);
 }
 
 /**
@@ -326,14 +305,7 @@ static void reass_timeout(struct k_work *work)
 {
 	struct frag_cache *cache = CONTAINER_OF(work, struct frag_cache, timer);
 
-	if (cache->buf) {
-		net_nbuf_unref(cache->buf);
-	}
-
-	cache->buf = NULL;
-	cache->size = 0;
-	cache->tag = 0;
-	cache->used = false;
+	free_reass_cache(cache);
 }
 
 /**
@@ -341,8 +313,7 @@ static void reass_timeout(struct k_work *work)
  *  create a new cache. If number of unused cache are out then
  *  discard the fragments.
  */
-static inline struct frag_cache *set_reass_cache(struct net_buf *buf,
-						 uint16_t size, uint16_t tag)
+static inline struct frag_cache *set_reass_cache(uint16_t size, uint16_t tag)
 {
 	int i;
 
@@ -351,9 +322,10 @@ static inline struct frag_cache *set_reass_cache(struct net_buf *buf,
 			continue;
 		}
 
-		cache[i].buf = buf;
 		cache[i].size = size;
 		cache[i].tag = tag;
+		cache[i].received = 0;
+		cache[i].count = 0;
 		cache[i].used = true;
 
 		k_delayed_work_init(&cache[i].timer, reass_timeout);
@@ -384,39 +356,83 @@ static inline struct frag_cache *get_reass_cache(uint16_t size, uint16_t tag)
 	return NULL;
 }
 
-/* Helper function to write fragment data to Rx buffer based on offset. */
-static inline bool copy_frag(struct net_buf *buf,
-			     struct net_buf *frag,
-			     uint16_t offset)
+/**
+ *  Insert the fragment data in the cache, sorted by offset. The data is
+ *  not copied: the cache takes over the fragment chain. Returns 1 if it
+ *  was inserted, 0 if it duplicates a fragment already received (the
+ *  caller still owns it then) or a negative value if it cannot be kept.
+ */
+static int add_frag(struct frag_cache *cache, struct net_buf *frag,
+		    uint16_t offset)
 {
-	struct net_buf *input = frag;
-	struct net_buf *write;
-	uint16_t pos = offset;
+	uint16_t len = net_buf_frags_len(frag);
+	uint8_t i;
 
-	write = buf->frags;
+	for (i = 0; i < cache->count; i++) {
+		if (cache->slots[i].offset == offset) {
+			return 0;
+		}
 
-	while (input) {
-		write = net_nbuf_write(buf, write, pos, &pos, input->len,
-				       input->data);
-		if (!write && pos == 0xffff) {
-			return false;
+		if (cache->slots[i].offset > offset) {
+			break;
 		}
+	}
 
-		input = input->frags;
+	if (cache->count == REASS_MAX_FRAGS ||
+	    cache->received + len > cache->size) {
+		return -ENOMEM;
 	}
 
-	net_nbuf_unref(frag);
+	memmove(&cache->slots[i + 1], &cache->slots[i],
+		(cache->count - i) * sizeof(struct frag_slot));
 
-	return true;
+	cache->slots[i].frag = frag;
+	cache->slots[i].offset = offset;
+	cache->slots[i].len = len;
+
+	cache->count++;
+	cache->received += len;
+
+	return 1;
+}
+
+/**
+ *  Link the fragments of a complete datagram together. Returns NULL if
+ *  they overlap, which leaves holes since the whole size was received.
+ */
+static struct net_buf *link_frags(struct frag_cache *cache)
+{
+	struct net_buf *frags = cache->slots[0].frag;
+	uint16_t offset = 0;
+	uint8_t i;
+
+	for (i = 0; i < cache->count; i++) {
+		if (cache->slots[i].offset != offset) {
+			return NULL;
+		}
+
+		offset += cache->slots[i].len;
+	}
+
+	for (i = 0; i + 1 < cache->count; i++) {
+		net_buf_frag_last(cache->slots[i].frag)->frags =
+			cache->slots[i + 1].frag;
+		cache->slots[i].frag = NULL;
+	}
+
+	cache->slots[i].frag = NULL;
+	cache->count = 0;
+
+	return frags;
 }
 
 /**
  *  Parse size and tag from the fragment, check if we have any cache
  *  related to it. If not create a new cache.
  *  Remove the fragmentation header and uncompress IPv6 and related headers.
- *  Cache Rx part of fragment along with data buf for the first fragment
- *  in the cache, remaining fragments just cache data fragment, unref
- *  RX buf. So in both the cases caller can assume buffer is consumed.
+ *  The data fragments are handed to the cache, the RX part of the buffer
+ *  is released, unless the datagram is complete: it is then given the
+ *  whole chain. So in both the cases caller can assume buffer is consumed.
  */
 static inline enum net_verdict add_frag_to_cache(struct net_buf *buf,
 						 bool first)
@@ -427,6 +443,7 @@ static inline enum net_verdict add_frag_to_cache(struct net_buf *buf,
 	uint16_t tag;
 	uint16_t offset = 0;
 	uint8_t pos = 0;
+	int ret;
 
 	/* Parse total size of packet */
 	size = get_datagram_size(buf->frags->data);
@@ -441,83 +458,79 @@ static inline enum net_verdict add_frag_to_cache(struct net_buf *buf,
 		pos++;
 	}
 
-	/* Remove frag header and update data */
-	remove_frag_header(buf->frags, pos);
+	/* Remove frag header, the data is left in place */
+	net_buf_pull(buf->frags, pos);
+
+	cache = get_reass_cache(size, tag);
 
 	/* Uncompress the IP headers */
 	if (first && !net_6lo_uncompress(buf)) {
 		NET_ERR("Could not uncompress first frag's 6lo hdr");
-		clear_reass_cache(size, tag);
+
+		if (cache) {
+			clear_reass_cache(cache);
+		}
 
 		return NET_DROP;
 	}
 
-	/* If there are no fragments in the cache means this frag
-	 * is the first one. So cache Rx buf otherwise not.
-	 * Write data fragment data to cached Rx based on offset parameter.
-	 * (Detach data fragment from incoming Rx and copy that data).
-	 */
-
-	frag = buf->frags;
-	buf->frags = NULL;
-
-	cache = get_reass_cache(size, tag);
 	if (!cache) {
-		cache = set_reass_cache(buf, size, tag);
+		cache = set_reass_cache(size, tag);
 		if (!cache) {
 			NET_ERR("Could not get a cache entry");
 			return NET_DROP;
 		}
+	}
+
+	/* Detach data fragment from incoming Rx and give it to the cache */
+	frag = buf->frags;
+	buf->frags = NULL;
 
-		/* If write failed, then attach frag back to incoming buffer
-		 * and return NET_DROP, caller will take care of freeing it.
+	ret = add_frag(cache, frag, offset);
+	if (ret < 0) {
+		/* Attach frag back to incoming buffer and return NET_DROP,
+		 * caller will take care of freeing it.
 		 */
-		if (!copy_frag(cache->buf, frag, offset)) {
-			buf->frags = frag;
+		buf->frags = frag;
 
-			/* Initialize to NULL to prevent duble free. It's only
-			 * needed here because this is the first fragment.
-			 */
-			cache->buf = NULL;
+		clear_reass_cache(cache);
 
-			clear_reass_cache(size, tag);
+		NET_ERR("Fragment at %u does not fit", offset);
 
-			NET_ERR("Copying frag failed");
+		return NET_DROP;
+	}
 
-			return NET_DROP;
-		}
+	if (!ret) {
+		NET_DBG("Duplicate fragment at %u", offset);
 
-		NET_DBG("buffer inserted into cache");
+		buf->frags = frag;
+		net_nbuf_unref(buf);
 
 		return NET_OK;
 	}
 
-	/* Add data buffer to reassembly buffer */
-	if (!copy_frag(cache->buf, frag, offset)) {
-		buf->frags = frag;
-
-		clear_reass_cache(size, tag);
+	/* Check if all the fragments are received or not */
+	if (cache->received == cache->size) {
+		buf->frags = link_frags(cache);
 
-		return NET_DROP;
-	}
+		/* Once reassemble is done, cache is no longer needed. */
+		clear_reass_cache(cache);
 
-	/* Check if all the fragments are received or not */
-	if (net_buf_frags_len(cache->buf->frags) == size) {
-		/* Assign frags back to input buffer. */
-		buf->frags = cache->buf->frags;
-		cache->buf->frags = NULL;
+		if (!buf->frags) {
+			NET_ERR("Overlapping fragments");
+			return NET_DROP;
+		}
 
 		/* Lengths are elided in compression, so calculate it. */
-		update_protocol_header_lengths(buf, cache->size);
-
-		/* Once reassemble is done, cache is no longer needed. */
-		clear_reass_cache(size, tag);
+		update_protocol_header_lengths(buf, size);
 
 		NET_DBG("All fragments received and reassembled");
 
 		return NET_CONTINUE;
 	}
 
+	NET_DBG("buffer inserted into cache");
+
 	/* Unref Rx part of original buffer */
 	net_nbuf_unref(buf);
 
@@ -27,6 +27,7 @@
 #include <nbr.h>
 
 #include "ieee802154_frame.h"
+#include "ieee802154_security.h"
 
 static inline struct ieee802154_fcf_seq *
 validate_fc_seq(uint8_t *buf, uint8_t **p_buf)
@@ -301,6 +302,22 @@ validate_payload_and_mfr(struct ieee802154_mpdu *mpdu,
 	return true;
 }
 
+static inline struct ieee802154_aux_security_hdr *
+validate_aux_security_hdr(uint8_t *buf, uint8_t **p_buf)
+{
+	struct ieee802154_aux_security_hdr *ash =
+		(struct ieee802154_aux_security_hdr *)buf;
+
+	if (ash->control.key_id_mode > IEEE802154_KEY_ID_MODE_INDEX ||
+	    ash->control.security_level == IEEE802154_SECURITY_LEVEL_NONE) {
+		return NULL;
+	}
+
+	*p_buf = buf + IEEE802154_AUX_SEC_HDR_LENGTH(ash->control.key_id_mode);
+
+	return ash;
+}
+
 bool ieee802154_validate_frame(uint8_t *buf, uint8_t length,
 			       struct ieee802154_mpdu *mpdu)
 {
@@ -329,6 +346,21 @@ bool ieee802154_validate_frame(uint8_t *buf, uint8_t length,
 					   mpdu->mhr.fs->fc.src_addr_mode,
 					   (mpdu->mhr.fs->fc.pan_id_comp));
 
+	mpdu->mhr.aux_sec = NULL;
+
+	if (mpdu->mhr.fs->fc.security_enabled) {
+		/* ToDo: secured MAC commands */
+		if (mpdu->mhr.fs->fc.frame_type !=
+		    IEEE802154_FRAME_TYPE_DATA) {
+			return false;
+		}
+
+		mpdu->mhr.aux_sec = validate_aux_security_hdr(p_buf, &p_buf);
+		if (!mpdu->mhr.aux_sec) {
+			return false;
+		}
+	}
+
 	return validate_payload_and_mfr(mpdu, buf, p_buf, length);
 }
 
@@ -361,7 +393,7 @@ uint16_t ieee802154_compute_header_size(struct net_if *iface,
 		}
 	}
 
-	/* Todo: handle security aux header */
+	hdr_len += ieee802154_security_hdr_len(iface);
 
 	NET_DBG("Computed size of %u", hdr_len);
 
@@ -524,6 +556,8 @@ bool ieee802154_create_data_frame(struct net_if *iface,
 
 	p_buf = generate_addressing_fields(iface, fs, &params, p_buf);
 
+	p_buf = ieee802154_security_write_hdr(iface, fs, p_buf);
+
 	if ((p_buf - frag_start) != len) {
 		/* ll reserve was too small? We probably overwrote
 		 * payload bytes
@@ -531,8 +565,6 @@ bool ieee802154_create_data_frame(struct net_if *iface,
 		return false;
 	}
 
-	/* Todo: handle security aux header */
-
 	dbg_print_fs(fs);
 
 	return true;
@@ -14,6 +14,7 @@
 
 #include <kernel.h>
 #include <net/nbuf.h>
+#include <string.h>
 
 #define IEEE802154_MTU				127
 #define IEEE802154_MIN_LENGTH			5
@@ -130,11 +131,37 @@ struct ieee802154_address_field {
 	};
 } __packed;
 
+/* Auxiliary security header, see Section 7.6.2 */
+struct ieee802154_security_control_field {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	uint8_t security_level	:3;
+	uint8_t key_id_mode	:2;
+	uint8_t reserved	:3;
+#elif __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	uint8_t reserved	:3;
+	uint8_t key_id_mode	:2;
+	uint8_t security_level	:3;
+#endif
+} __packed;
+
+/* Only the implicit and key index modes are supported */
+#define IEEE802154_AUX_SEC_HDR_LENGTH(__key_id_mode)	\
+	((__key_id_mode) ? 6 : 5)
+
+struct ieee802154_aux_security_hdr {
+	struct ieee802154_security_control_field control;
+	uint32_t frame_counter;
+	/* Only there in key index mode */
+	uint8_t key_index;
+} __packed;
+
 /** MAC header */
 struct ieee802154_mhr {
 	struct ieee802154_fcf_seq *fs;
 	struct ieee802154_address_field *dst_addr;
 	struct ieee802154_address_field *src_addr;
+	/* NULL if the frame is not secured */
+	struct ieee802154_aux_security_hdr *aux_sec;
 };
 
 struct ieee802154_mfr {
@@ -402,4 +429,54 @@ static inline bool ieee802154_ack_required(struct net_buf *buf)
 	return fs->fc.ar;
 }
 
+/**
+ * @brief Copy an address field of a frame, as is
+ *
+ * @param field Address field, NULL if the frame has none
+ * @param mode Addressing mode of the field
+ * @param comp Whether the PAN id of the field is compressed
+ * @param addr Where to copy the address, IEEE802154_EXT_ADDR_LENGTH long
+ *
+ * @return Length of the address, 0 if there is none
+ */
+static inline uint8_t ieee802154_frame_addr(
+	struct ieee802154_address_field *field,
+	uint8_t mode, bool comp, uint8_t *addr)
+{
+	struct ieee802154_address *src;
+	uint8_t len;
+
+	if (!field) {
+		return 0;
+	}
+
+	if (mode == IEEE802154_ADDR_MODE_SHORT) {
+		len = IEEE802154_SHORT_ADDR_LENGTH;
+	} else if (mode == IEEE802154_ADDR_MODE_EXTENDED) {
+		len = IEEE802154_EXT_ADDR_LENGTH;
+	} else {
+		return 0;
+	}
+
+	src = comp ? &field->comp.addr : &field->plain.addr;
+	memcpy(addr, src, len);
+
+	return len;
+}
+
+/**
+ * @brief Copy the destination address of a frame being sent
+ *
+ * @details The destination PAN id is always there in the frames built by
+ * ieee802154_create_data_frame().
+ */
+static inline uint8_t ieee802154_frame_dst_addr(struct ieee802154_fcf_seq *fs,
+						uint8_t *addr)
+{
+	struct ieee802154_address_field *dst =
+		(struct ieee802154_address_field *)(fs + 1);
+
+	return ieee802154_frame_addr(dst, fs->fc.dst_addr_mode, false, addr);
+}
+
 #endif /* __IEEE802154_FRAME_H__ */
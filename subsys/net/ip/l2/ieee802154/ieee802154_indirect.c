@@ -0,0 +1,334 @@
+/** @file
+ * @brief IEEE 802.15.4 indirect transmission to sleepy children
+ *
+ * A child keeping its radio off polls its coordinator with data requests.
+ * The buffers sent to it meanwhile are queued, and the ACK of its next
+ * data request tells it to keep listening: the radio sets the frame
+ * pending bit of the ACKs to the children having data queued, through
+ * source address matching, or the software ACK does. The first queued
+ * buffer is then sent right away, its last frame telling whether more
+ * are pending so that the child polls again at once.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_L2_IEEE802154)
+#define SYS_LOG_DOMAIN "net/ieee802154"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/nbuf.h>
+
+#include <misc/util.h>
+
+#include <string.h>
+#include <errno.h>
+
+#include <net/ieee802154_radio.h>
+
+#include "ieee802154_frame.h"
+#include "ieee802154_indirect.h"
+
+#define INDIRECT_CHILDREN	CONFIG_NET_L2_IEEE802154_INDIRECT_CHILDREN
+#define INDIRECT_QUEUE_MAX	CONFIG_NET_L2_IEEE802154_INDIRECT_QUEUE_MAX
+#define INDIRECT_TIMEOUT	CONFIG_NET_L2_IEEE802154_INDIRECT_TIMEOUT
+
+struct indirect_child {
+	struct net_if *iface;
+	struct k_fifo queue;
+	uint8_t addr[IEEE802154_EXT_ADDR_LENGTH];
+	uint8_t addr_len;
+	uint8_t count;
+	/* When the queued buffers are dropped if the child does not poll */
+	uint32_t deadline;
+};
+
+static struct indirect_child children[INDIRECT_CHILDREN];
+
+static K_SEM_DEFINE(indirect_lock, 1, 1);
+
+static struct k_delayed_work indirect_timer;
+static bool indirect_timer_init;
+
+static inline bool time_after(uint32_t a, uint32_t b)
+{
+	return (int32_t)(a - b) > 0;
+}
+
+static void child_set_pending(struct indirect_child *child, bool pending)
+{
+	const struct ieee802154_radio_api *radio =
+		child->iface->dev->driver_api;
+
+	if (radio->set_pending) {
+		radio->set_pending(child->iface->dev, child->addr,
+				   child->addr_len, pending);
+	}
+}
+
+static void child_flush(struct indirect_child *child)
+{
+	struct net_buf *buf;
+
+	while ((buf = net_buf_get(&child->queue, K_NO_WAIT))) {
+		net_nbuf_unref(buf);
+	}
+
+	if (child->count) {
+		child_set_pending(child, false);
+	}
+
+	child->count = 0;
+}
+
+static struct indirect_child *child_find(struct net_if *iface,
+					 uint8_t *addr, uint8_t len)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(children); i++) {
+		struct indirect_child *child = &children[i];
+
+		if (child->addr_len == len && child->iface == iface &&
+		    !memcmp(child->addr, addr, len)) {
+			return child;
+		}
+	}
+
+	return NULL;
+}
+
+/* A child is known from its first data request. The slot of a child with
+ * nothing queued is reused when all are taken.
+ */
+static struct indirect_child *child_add(struct net_if *iface,
+					uint8_t *addr, uint8_t len)
+{
+	struct indirect_child *child = NULL;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(children); i++) {
+		if (!children[i].addr_len) {
+			child = &children[i];
+			break;
+		}
+
+		if (!child && !children[i].count) {
+			child = &children[i];
+		}
+	}
+
+	if (!child) {
+		return NULL;
+	}
+
+	if (!child->addr_len) {
+		k_fifo_init(&child->queue);
+	}
+
+	child->iface = iface;
+	memcpy(child->addr, addr, len);
+	child->addr_len = len;
+	child->count = 0;
+
+	return child;
+}
+
+static void indirect_timeout(struct k_work *work)
+{
+	uint32_t now = k_uptime_get_32();
+	int32_t next = 0;
+	int i;
+
+	k_sem_take(&indirect_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(children); i++) {
+		struct indirect_child *child = &children[i];
+		int32_t left;
+
+		if (!child->count) {
+			continue;
+		}
+
+		left = child->deadline - now;
+		if (left <= 0) {
+			/* The child is gone, or sleeps for too long */
+			NET_DBG("Dropping %u buffers for child %p",
+				child->count, child);
+
+			child_flush(child);
+			child->addr_len = 0;
+			continue;
+		}
+
+		if (!next || left < next) {
+			next = left;
+		}
+	}
+
+	if (next) {
+		k_delayed_work_submit(&indirect_timer, next);
+	}
+
+	k_sem_give(&indirect_lock);
+}
+
+/* Set the frame pending bit of all the frames but the last one, and of
+ * the last one too if more buffers are queued.
+ */
+static void buf_set_pending(struct net_buf *buf, bool more)
+{
+	struct net_buf *frag;
+
+	for (frag = buf->frags; frag; frag = frag->frags) {
+		struct ieee802154_fcf_seq *fs = (struct ieee802154_fcf_seq *)
+			(frag->data - net_nbuf_ll_reserve(buf));
+
+		fs->fc.frame_pending = more || frag->frags;
+	}
+}
+
+bool ieee802154_indirect_send(struct net_if *iface, struct net_buf *buf)
+{
+	struct ieee802154_fcf_seq *fs =
+		(struct ieee802154_fcf_seq *)net_nbuf_ll(buf);
+	uint8_t addr[IEEE802154_EXT_ADDR_LENGTH];
+	struct indirect_child *child;
+	bool queued = false;
+	uint8_t len;
+
+	len = ieee802154_frame_dst_addr(fs, addr);
+	if (!len) {
+		return false;
+	}
+
+	k_sem_take(&indirect_lock, K_FOREVER);
+
+	child = child_find(iface, addr, len);
+	if (!child) {
+		goto out;
+	}
+
+	queued = true;
+
+	if (child->count >= INDIRECT_QUEUE_MAX) {
+		NET_DBG("Queue of child %p full, dropping buf %p",
+			child, buf);
+
+		net_nbuf_unref(buf);
+		goto out;
+	}
+
+	if (!child->count) {
+		child->deadline = k_uptime_get_32() + INDIRECT_TIMEOUT;
+		child_set_pending(child, true);
+
+		if (!indirect_timer_init) {
+			k_delayed_work_init(&indirect_timer, indirect_timeout);
+			indirect_timer_init = true;
+		}
+
+		if (!k_delayed_work_remaining_get(&indirect_timer)) {
+			k_delayed_work_submit(&indirect_timer,
+					      INDIRECT_TIMEOUT);
+		}
+	}
+
+	net_buf_put(&child->queue, buf);
+	child->count++;
+
+	NET_DBG("Queued buf %p for child %p (%u)", buf, child, child->count);
+out:
+	k_sem_give(&indirect_lock);
+
+	return queued;
+}
+
+enum net_verdict ieee802154_indirect_recv(struct net_if *iface,
+					  struct ieee802154_mpdu *mpdu)
+{
+	struct ieee802154_fcf_seq *fs = mpdu->mhr.fs;
+	uint8_t addr[IEEE802154_EXT_ADDR_LENGTH];
+	struct indirect_child *child;
+	struct net_buf *buf = NULL;
+	uint8_t len;
+
+	if (fs->fc.frame_type != IEEE802154_FRAME_TYPE_MAC_COMMAND ||
+	    mpdu->command->cfi != IEEE802154_CFI_DATA_REQUEST) {
+		return NET_CONTINUE;
+	}
+
+	len = ieee802154_frame_addr(mpdu->mhr.src_addr, fs->fc.src_addr_mode,
+				    fs->fc.pan_id_comp, addr);
+	if (!len) {
+		return NET_DROP;
+	}
+
+	k_sem_take(&indirect_lock, K_FOREVER);
+
+	child = child_find(iface, addr, len);
+	if (!child) {
+		child = child_add(iface, addr, len);
+		if (!child) {
+			NET_DBG("No room for a new child");
+		}
+
+		goto out;
+	}
+
+	buf = net_buf_get(&child->queue, K_NO_WAIT);
+	if (!buf) {
+		goto out;
+	}
+
+	child->count--;
+	child->deadline = k_uptime_get_32() + INDIRECT_TIMEOUT;
+
+	if (!child->count) {
+		child_set_pending(child, false);
+	}
+
+	buf_set_pending(buf, child->count);
+out:
+	k_sem_give(&indirect_lock);
+
+	/* The child only listens for a short while after its ACK */
+	if (buf) {
+		net_if_queue_tx(iface, buf);
+	}
+
+	return NET_OK;
+}
+
+bool ieee802154_indirect_pending(struct net_if *iface,
+				 struct ieee802154_mpdu *mpdu)
+{
+	struct ieee802154_fcf_seq *fs = mpdu->mhr.fs;
+	uint8_t addr[IEEE802154_EXT_ADDR_LENGTH];
+	struct indirect_child *child;
+	bool pending = false;
+	uint8_t len;
+
+	len = ieee802154_frame_addr(mpdu->mhr.src_addr, fs->fc.src_addr_mode,
+				    fs->fc.pan_id_comp, addr);
+	if (!len) {
+		return false;
+	}
+
+	k_sem_take(&indirect_lock, K_FOREVER);
+
+	child = child_find(iface, addr, len);
+	if (child) {
+		pending = child->count != 0;
+	}
+
+	k_sem_give(&indirect_lock);
+
+	return pending;
+}
@@ -0,0 +1,60 @@
+/** @file
+ @brief IEEE 802.15.4 indirect transmission to sleepy children
+
+ This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __IEEE802154_INDIRECT_H__
+#define __IEEE802154_INDIRECT_H__
+
+#include <net/net_if.h>
+#include <net/nbuf.h>
+
+#include "ieee802154_frame.h"
+
+#if defined(CONFIG_NET_L2_IEEE802154_INDIRECT)
+/**
+ *  @brief Queue a buffer for a sleepy child
+ *
+ *  @details A device polling this node with data requests is a sleepy
+ *  child: the buffers sent to it are kept until it polls again, and the
+ *  ACKs sent to it tell it that data is pending.
+ *
+ *  @param iface Network interface to send from
+ *  @param buf Buffer whose frames are built already
+ *
+ *  @return True if the buffer was queued, false if it has to be sent now.
+ */
+bool ieee802154_indirect_send(struct net_if *iface, struct net_buf *buf);
+
+/**
+ *  @brief Handle a data request, the next buffer queued for the child
+ *  is then sent
+ *
+ *  @param iface Network interface the frame was received on
+ *  @param mpdu Validated frame
+ *
+ *  @return NET_OK if the frame was a data request, NET_CONTINUE otherwise.
+ */
+enum net_verdict ieee802154_indirect_recv(struct net_if *iface,
+					  struct ieee802154_mpdu *mpdu);
+
+/**
+ *  @brief Tell whether buffers are queued for the sender of a frame,
+ *  to set the frame pending bit of the ACK replied to it
+ */
+bool ieee802154_indirect_pending(struct net_if *iface,
+				 struct ieee802154_mpdu *mpdu);
+#else
+#define ieee802154_indirect_send(...) false
+#define ieee802154_indirect_recv(...) NET_CONTINUE
+#define ieee802154_indirect_pending(...) false
+#endif
+
+#endif /* __IEEE802154_INDIRECT_H__ */
@@ -0,0 +1,207 @@
+/** @file
+ * @brief 802.15.4 mesh-under forwarding
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_L2_IEEE802154)
+#define SYS_LOG_DOMAIN "net/ieee802154"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/nbuf.h>
+#include <net/net_if.h>
+
+#include "ieee802154_frame.h"
+#include "ieee802154_mesh.h"
+
+#include "net_private.h"
+#include "ipv6.h"
+#include "route.h"
+#include "6lo_private.h"
+
+/**
+ *                     1                   2                   3
+ *   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *  |1 0|V|F|HopsLft| originator address, final address
+ *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *
+ *  V and F tell whether the originator and final addresses are short
+ *  (16 bits) or extended (64 bits) ones. Addresses are in network order.
+ */
+#define MESH_DISPATCH_MASK	0xC0
+#define MESH_ORIG_SHORT		BIT(5)
+#define MESH_FINAL_SHORT	BIT(4)
+#define MESH_HOPS_LEFT_MASK	0x0F
+
+static inline uint8_t mesh_addr_len(uint8_t dispatch, uint8_t short_flag)
+{
+	return (dispatch & short_flag) ? IEEE802154_SHORT_ADDR_LENGTH :
+		IEEE802154_EXT_ADDR_LENGTH;
+}
+
+/* The L2 swaps the extended addresses of the buffer to network order
+ * once the frame is handled, as it does for the ones of the MAC header,
+ * so they are stored the other way around here.
+ */
+static inline void set_buf_ll_addr(struct net_linkaddr *addr,
+				   uint8_t *mesh_addr, uint8_t len)
+{
+	if (len == IEEE802154_EXT_ADDR_LENGTH) {
+		sys_mem_swap(mesh_addr, len);
+
+		addr->addr = mesh_addr;
+		addr->len = len;
+	} else {
+		/* ToDo: Handle short address */
+		addr->addr = NULL;
+		addr->len = 0;
+	}
+}
+
+static inline bool mesh_addr_is_mine(struct net_if *iface,
+				     uint8_t *mesh_addr, uint8_t len)
+{
+	/* ToDo: Handle short address, once the L2 gets one */
+	return len == IEEE802154_EXT_ADDR_LENGTH &&
+		iface->link_addr.len == IEEE802154_EXT_ADDR_LENGTH &&
+		!memcmp(mesh_addr, iface->link_addr.addr, len);
+}
+
+static struct in6_addr *get_nexthop(struct net_if *iface,
+				    struct in6_addr *dst)
+{
+#if defined(CONFIG_NET_ROUTE)
+	struct net_route_entry *route;
+#endif
+
+	if (net_ipv6_nbr_lookup(iface, dst)) {
+		return dst;
+	}
+
+#if defined(CONFIG_NET_ROUTE)
+	route = net_route_lookup(iface, dst);
+	if (route) {
+		return net_route_get_nexthop(route);
+	}
+#endif
+
+	return NULL;
+}
+
+static enum net_verdict mesh_forward(struct net_if *iface,
+				     struct net_buf *buf,
+				     uint8_t *final, uint8_t final_len)
+{
+	struct net_linkaddr lladdr = { .addr = final, .len = final_len };
+	struct net_buf *frag = buf->frags;
+	uint8_t hops_left = frag->data[0] & MESH_HOPS_LEFT_MASK;
+	struct in6_addr *nexthop;
+	struct in6_addr dst;
+	uint16_t headroom;
+	uint16_t reserve;
+
+	if (hops_left <= 1) {
+		NET_DBG("No hops left");
+		return NET_DROP;
+	}
+
+	/* Single frame only: it is sent again as it came */
+	if (frag->frags) {
+		return NET_DROP;
+	}
+
+	/* The final destination is known by the address it derives from
+	 * its link layer address.
+	 */
+	net_ipv6_addr_create_iid(&dst, &lladdr);
+
+	nexthop = get_nexthop(iface, &dst);
+	if (!nexthop || !net_ipv6_nbr_lookup(iface, nexthop)) {
+		NET_DBG("No route to %s", net_sprint_ipv6_addr(&dst));
+		return NET_DROP;
+	}
+
+	reserve = ieee802154_compute_header_size(iface, nexthop);
+	if (reserve + frag->len + IEEE802154_MFR_LENGTH > IEEE802154_MTU) {
+		return NET_DROP;
+	}
+
+	/* The new MAC header goes where the received one was, make room
+	 * if it happens to be larger.
+	 */
+	headroom = net_buf_headroom(frag);
+	if (headroom < reserve) {
+		uint16_t delta = reserve - headroom;
+		uint16_t len = frag->len;
+
+		if (net_buf_tailroom(frag) < delta) {
+			return NET_DROP;
+		}
+
+		net_buf_add(frag, delta);
+		memmove(frag->data + delta, frag->data, len);
+		net_buf_pull(frag, delta);
+	}
+
+	frag->data[0] = (frag->data[0] & ~MESH_HOPS_LEFT_MASK) |
+		(hops_left - 1);
+
+	net_nbuf_set_ll_reserve(buf, reserve);
+
+	if (!ieee802154_create_data_frame(iface, nexthop,
+					  frag->data - reserve, reserve)) {
+		return NET_DROP;
+	}
+
+	NET_DBG("Forwarding buf %p to %s", buf,
+		net_sprint_ipv6_addr(nexthop));
+
+	net_if_queue_tx(iface, buf);
+
+	return NET_OK;
+}
+
+enum net_verdict ieee802154_mesh_recv(struct net_if *iface,
+				      struct net_buf *buf)
+{
+	struct net_buf *frag = buf->frags;
+	uint8_t orig_len, final_len, hdr_len;
+	uint8_t *orig, *final;
+
+	if (!frag->len ||
+	    (frag->data[0] & MESH_DISPATCH_MASK) != NET_6LO_DISPATCH_MESH) {
+		return NET_CONTINUE;
+	}
+
+	orig_len = mesh_addr_len(frag->data[0], MESH_ORIG_SHORT);
+	final_len = mesh_addr_len(frag->data[0], MESH_FINAL_SHORT);
+	hdr_len = 1 + orig_len + final_len;
+
+	if (frag->len <= hdr_len) {
+		return NET_DROP;
+	}
+
+	orig = frag->data + 1;
+	final = orig + orig_len;
+
+	if (!mesh_addr_is_mine(iface, final, final_len)) {
+		return mesh_forward(iface, buf, final, final_len);
+	}
+
+	set_buf_ll_addr(net_nbuf_ll_src(buf), orig, orig_len);
+	set_buf_ll_addr(net_nbuf_ll_dst(buf), final, final_len);
+
+	/* The mesh header stays in the link layer part of the buffer */
+	net_buf_pull(frag, hdr_len);
+	net_nbuf_set_ll_reserve(buf, net_nbuf_ll_reserve(buf) + hdr_len);
+
+	return NET_CONTINUE;
+}
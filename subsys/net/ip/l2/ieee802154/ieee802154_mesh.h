@@ -0,0 +1,42 @@
+/** @file
+ @brief 802.15.4 mesh-under forwarding
+
+ This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __NET_IEEE802154_MESH_H__
+#define __NET_IEEE802154_MESH_H__
+
+#include <net/net_if.h>
+#include <net/nbuf.h>
+
+/**
+ *  @brief Handle a frame carrying a 6LoWPAN mesh header (RFC 4944)
+ *
+ *  @details If the frame is addressed to this node the mesh header is
+ *  removed and the link layer addresses of the buffer are set to the
+ *  originator and final addresses, as header compression refers to them.
+ *  Otherwise the frame is sent as is to the next hop towards its final
+ *  destination, found in the neighbor cache or the route table: neither
+ *  the IPv6 header is uncompressed nor fragments are reassembled.
+ *
+ *  @param iface Network interface the frame was received on
+ *  @param buf Received frame, its MAC header already pulled off
+ *
+ *  @return NET_CONTINUE if the frame must be handled by this node,
+ *          NET_OK if it was forwarded, NET_DROP if it cannot be.
+ */
+#if defined(CONFIG_NET_L2_IEEE802154_MESH)
+enum net_verdict ieee802154_mesh_recv(struct net_if *iface,
+				      struct net_buf *buf);
+#else
+#define ieee802154_mesh_recv(...) NET_CONTINUE
+#endif
+
+#endif /* __NET_IEEE802154_MESH_H__ */
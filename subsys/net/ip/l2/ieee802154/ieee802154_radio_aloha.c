@@ -18,6 +18,7 @@
 
 #include "ieee802154_frame.h"
 #include "ieee802154_radio_utils.h"
+#include "ieee802154_security.h"
 
 static inline int aloha_tx_fragment(struct net_if *iface,
 				    struct net_buf *buf)
@@ -30,6 +31,13 @@ static inline int aloha_tx_fragment(struct net_if *iface,
 
 	NET_DBG("frag %p", buf->frags);
 
+	ret = ieee802154_encrypt_frame(iface, buf);
+	if (ret) {
+		return ret;
+	}
+
+	ret = -EIO;
+
 	while (retries) {
 		retries--;
 
@@ -0,0 +1,457 @@
+/** @file
+ * @brief IEEE 802.15.4 low-power listening radio protocol
+ *
+ * The radio is only switched on once every wake-up interval, during a
+ * short receive window. A sender repeats its frame (a strobe train) long
+ * enough to hit the window of the receiver: a unicast frame until it is
+ * acknowledged, at most during a whole wake-up interval, and a broadcast
+ * frame during a whole interval. The time a neighbor acknowledged a frame
+ * tells the phase of its wake-ups, so the next frames sent to it only
+ * need a short strobe train, started just before it wakes up.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_L2_IEEE802154)
+#define SYS_LOG_DOMAIN "net/ieee802154"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+
+#include <misc/util.h>
+
+#include <string.h>
+#include <errno.h>
+
+#include <net/ieee802154_radio.h>
+
+#include "ieee802154_frame.h"
+#include "ieee802154_mgmt.h"
+#include "ieee802154_radio_utils.h"
+#include "ieee802154_radio_lpl.h"
+#include "ieee802154_security.h"
+
+#define LPL_INTERVAL	CONFIG_NET_L2_IEEE802154_RADIO_LPL_INTERVAL
+#define LPL_RX_WINDOW	CONFIG_NET_L2_IEEE802154_RADIO_LPL_RX_WINDOW
+#define LPL_GUARD_TIME	CONFIG_NET_L2_IEEE802154_RADIO_LPL_GUARD_TIME
+#define LPL_LISTEN_TIME	CONFIG_NET_L2_IEEE802154_RADIO_LPL_LISTEN_TIME
+#define LPL_NEIGHBORS	CONFIG_NET_L2_IEEE802154_RADIO_LPL_NEIGHBORS
+#define LPL_DUP_CACHE	CONFIG_NET_L2_IEEE802154_RADIO_LPL_DUP_CACHE
+
+struct lpl_neighbor {
+	uint8_t addr[IEEE802154_EXT_ADDR_LENGTH];
+	uint8_t addr_len;
+	uint8_t phase_known	: 1;
+	uint8_t _unused		: 7;
+	/* Wake-up time of the neighbor, modulo the wake-up interval */
+	uint16_t phase;
+	/* The neighbor listens until then, expecting pending frames */
+	uint32_t awake_until;
+	uint32_t last_use;
+};
+
+struct lpl_dup {
+	uint8_t addr[IEEE802154_EXT_ADDR_LENGTH];
+	uint8_t addr_len;
+	uint8_t sequence;
+};
+
+static struct {
+	struct net_if *iface;
+	/* Serializes the radio switching of the TX thread and works */
+	struct k_sem lock;
+	struct k_delayed_work wakeup;
+	struct k_delayed_work sleep;
+	uint32_t next_wakeup;
+	uint32_t awake_until;
+	struct lpl_neighbor neighbors[LPL_NEIGHBORS];
+	struct lpl_dup dups[LPL_DUP_CACHE];
+	uint8_t dup_next;
+	uint8_t radio_on	: 1;
+	uint8_t tx_active	: 1;
+} lpl;
+
+static inline bool time_after(uint32_t a, uint32_t b)
+{
+	return (int32_t)(a - b) > 0;
+}
+
+static void lpl_radio_on(void)
+{
+	const struct ieee802154_radio_api *radio =
+		lpl.iface->dev->driver_api;
+
+	if (!lpl.radio_on && !radio->start(lpl.iface->dev)) {
+		lpl.radio_on = 1;
+	}
+}
+
+static void lpl_radio_off(void)
+{
+	const struct ieee802154_radio_api *radio =
+		lpl.iface->dev->driver_api;
+
+	if (lpl.radio_on && !radio->stop(lpl.iface->dev)) {
+		lpl.radio_on = 0;
+	}
+}
+
+/* Called with the lock held */
+static void lpl_stay_awake(uint32_t now, uint32_t duration)
+{
+	if (!time_after(now + duration, lpl.awake_until)) {
+		return;
+	}
+
+	lpl.awake_until = now + duration;
+	k_delayed_work_submit(&lpl.sleep, duration);
+}
+
+static void lpl_wakeup(struct k_work *work)
+{
+	uint32_t now = k_uptime_get_32();
+
+	k_sem_take(&lpl.lock, K_FOREVER);
+
+	/* The radio is already on while sending */
+	if (!lpl.tx_active) {
+		lpl_radio_on();
+	}
+
+	lpl_stay_awake(now, LPL_RX_WINDOW);
+
+	k_sem_give(&lpl.lock);
+
+	/* Wake-ups are scheduled from the first one, not from the previous
+	 * one, so that neighbors can predict them.
+	 */
+	lpl.next_wakeup += LPL_INTERVAL;
+	if (!time_after(lpl.next_wakeup, now)) {
+		lpl.next_wakeup = now + LPL_INTERVAL;
+	}
+
+	k_delayed_work_submit(&lpl.wakeup, lpl.next_wakeup - now);
+}
+
+static void lpl_sleep(struct k_work *work)
+{
+	uint32_t now = k_uptime_get_32();
+
+	k_sem_take(&lpl.lock, K_FOREVER);
+
+	/* Sending ends switching the radio off when it is time */
+	if (lpl.tx_active) {
+		goto out;
+	}
+
+	if (ieee802154_is_scanning(lpl.iface)) {
+		lpl_stay_awake(now, LPL_RX_WINDOW);
+		goto out;
+	}
+
+	if (time_after(lpl.awake_until, now)) {
+		k_delayed_work_submit(&lpl.sleep, lpl.awake_until - now);
+		goto out;
+	}
+
+	lpl_radio_off();
+out:
+	k_sem_give(&lpl.lock);
+}
+
+/* Neighbor a unicast frame is sent to, the least recently used one is
+ * replaced when the neighbor is not known yet.
+ */
+static struct lpl_neighbor *lpl_neighbor_get(struct net_buf *buf)
+{
+	struct ieee802154_fcf_seq *fs =
+		(struct ieee802154_fcf_seq *)net_nbuf_ll(buf);
+	struct lpl_neighbor *nbr = &lpl.neighbors[0];
+	uint32_t now = k_uptime_get_32();
+	uint8_t addr[IEEE802154_EXT_ADDR_LENGTH];
+	uint8_t len;
+	int i;
+
+	len = ieee802154_frame_dst_addr(fs, addr);
+	if (!len) {
+		return NULL;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(lpl.neighbors); i++) {
+		struct lpl_neighbor *n = &lpl.neighbors[i];
+
+		if (n->addr_len == len && !memcmp(n->addr, addr, len)) {
+			nbr = n;
+			goto out;
+		}
+
+		if (!n->addr_len ||
+		    (nbr->addr_len &&
+		     time_after(nbr->last_use, n->last_use))) {
+			nbr = n;
+		}
+	}
+
+	memcpy(nbr->addr, addr, len);
+	nbr->addr_len = len;
+	nbr->phase_known = 0;
+	nbr->awake_until = now;
+out:
+	nbr->last_use = now;
+
+	return nbr;
+}
+
+/* Time to wait before sending to a neighbor whose phase is known */
+static uint32_t lpl_phase_wait(struct lpl_neighbor *nbr, uint32_t now)
+{
+	uint32_t start = (nbr->phase + LPL_INTERVAL - LPL_GUARD_TIME) %
+		LPL_INTERVAL;
+
+	return (start + LPL_INTERVAL - now % LPL_INTERVAL) % LPL_INTERVAL;
+}
+
+static void lpl_tx_begin(void)
+{
+	k_sem_take(&lpl.lock, K_FOREVER);
+
+	lpl.tx_active = 1;
+	lpl_radio_on();
+
+	k_sem_give(&lpl.lock);
+}
+
+static void lpl_tx_end(void)
+{
+	uint32_t now = k_uptime_get_32();
+
+	k_sem_take(&lpl.lock, K_FOREVER);
+
+	lpl.tx_active = 0;
+
+	if (time_after(lpl.awake_until, now)) {
+		k_delayed_work_submit(&lpl.sleep, lpl.awake_until - now);
+	} else {
+		lpl_radio_off();
+	}
+
+	k_sem_give(&lpl.lock);
+}
+
+/* Repeat the frame during the given duration, or until it is acked */
+static int lpl_tx_train(struct net_if *iface, struct net_buf *buf,
+			bool ack_required, uint32_t duration,
+			uint32_t *acked_at)
+{
+	struct ieee802154_context *ctx = net_if_l2_data(iface);
+	const struct ieee802154_radio_api *radio = iface->dev->driver_api;
+	uint32_t start = k_uptime_get_32();
+	uint32_t strobe;
+	bool sent = false;
+
+	do {
+		strobe = k_uptime_get_32();
+
+		if (radio->tx(iface->dev, buf)) {
+			continue;
+		}
+
+		if (!ack_required) {
+			sent = true;
+		} else if (!wait_for_ack(ctx, true)) {
+			*acked_at = strobe;
+			return 0;
+		}
+	} while (k_uptime_get_32() - start < duration);
+
+	return sent ? 0 : -EIO;
+}
+
+static inline int lpl_tx_fragment(struct net_if *iface,
+				  struct net_buf *buf)
+{
+	uint8_t retries = CONFIG_NET_L2_IEEE802154_RADIO_TX_RETRIES;
+	struct ieee802154_context *ctx = net_if_l2_data(iface);
+	struct ieee802154_fcf_seq *fs =
+		(struct ieee802154_fcf_seq *)net_nbuf_ll(buf);
+	bool ack_required = prepare_for_ack(ctx, buf);
+	struct lpl_neighbor *nbr = NULL;
+	uint32_t duration, acked_at, now;
+	bool awake = false;
+	int ret = -EIO;
+
+	NET_DBG("frag %p", buf->frags);
+
+	/* Keeps the receiver listening for the next fragments */
+	if (buf->frags->frags) {
+		fs->fc.frame_pending = 1;
+	}
+
+	/* Only once the header is final, as it is authenticated */
+	ret = ieee802154_encrypt_frame(iface, buf);
+	if (ret) {
+		return ret;
+	}
+
+	ret = -EIO;
+
+	if (ack_required) {
+		nbr = lpl_neighbor_get(buf);
+	}
+
+	while (retries) {
+		retries--;
+
+		duration = LPL_INTERVAL + LPL_RX_WINDOW;
+		now = k_uptime_get_32();
+
+		if (nbr && time_after(nbr->awake_until, now)) {
+			awake = true;
+			duration = LPL_RX_WINDOW;
+		} else if (nbr && nbr->phase_known) {
+			k_sleep(lpl_phase_wait(nbr, now));
+			duration = 2 * LPL_GUARD_TIME;
+		}
+
+		lpl_tx_begin();
+		ret = lpl_tx_train(iface, buf, ack_required, duration,
+				   &acked_at);
+		lpl_tx_end();
+
+		if (!ret || !nbr) {
+			break;
+		}
+
+		/* The neighbor drifted away or went to sleep: next time,
+		 * send to it during a whole wake-up interval.
+		 */
+		nbr->phase_known = 0;
+		nbr->awake_until = now;
+		awake = false;
+	}
+
+	if (ret || !nbr) {
+		return ret;
+	}
+
+	/* Only the first frame of a burst is received in a wake-up window.
+	 * Half the listen time is assumed, so it is not missed by far.
+	 */
+	if (!awake) {
+		nbr->phase = acked_at % LPL_INTERVAL;
+		nbr->phase_known = 1;
+	}
+
+	nbr->awake_until = fs->fc.frame_pending ?
+		acked_at + LPL_LISTEN_TIME / 2 : acked_at;
+
+	return 0;
+}
+
+static bool lpl_is_duplicate(struct ieee802154_mpdu *mpdu)
+{
+	struct ieee802154_fcf_seq *fs = mpdu->mhr.fs;
+	struct lpl_dup *dup;
+	uint8_t addr[IEEE802154_EXT_ADDR_LENGTH];
+	uint8_t len;
+	int i;
+
+	len = ieee802154_frame_addr(mpdu->mhr.src_addr, fs->fc.src_addr_mode,
+				    fs->fc.pan_id_comp, addr);
+	if (!len) {
+		return false;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(lpl.dups); i++) {
+		dup = &lpl.dups[i];
+
+		if (dup->addr_len == len && !memcmp(dup->addr, addr, len)) {
+			if (dup->sequence == fs->sequence) {
+				return true;
+			}
+
+			goto update;
+		}
+	}
+
+	dup = &lpl.dups[lpl.dup_next];
+	lpl.dup_next = (lpl.dup_next + 1) % ARRAY_SIZE(lpl.dups);
+
+	memcpy(dup->addr, addr, len);
+	dup->addr_len = len;
+update:
+	dup->sequence = fs->sequence;
+
+	return false;
+}
+
+enum net_verdict ieee802154_lpl_recv(struct net_if *iface,
+				     struct ieee802154_mpdu *mpdu)
+{
+	uint32_t now = k_uptime_get_32();
+
+	if (lpl_is_duplicate(mpdu)) {
+		NET_DBG("Dropping repeated frame %u", mpdu->mhr.fs->sequence);
+		return NET_DROP;
+	}
+
+	k_sem_take(&lpl.lock, K_FOREVER);
+
+	if (mpdu->mhr.fs->fc.frame_pending) {
+		lpl_stay_awake(now, LPL_LISTEN_TIME);
+	} else {
+		/* Nothing else is coming, the window can be closed */
+		lpl.awake_until = now;
+		k_delayed_work_submit(&lpl.sleep, 0);
+	}
+
+	k_sem_give(&lpl.lock);
+
+	return NET_CONTINUE;
+}
+
+void ieee802154_lpl_init(struct net_if *iface)
+{
+	uint32_t now = k_uptime_get_32();
+
+	lpl.iface = iface;
+	lpl.radio_on = 1;
+
+	k_sem_init(&lpl.lock, 1, 1);
+	k_delayed_work_init(&lpl.wakeup, lpl_wakeup);
+	k_delayed_work_init(&lpl.sleep, lpl_sleep);
+
+	lpl.awake_until = now + LPL_RX_WINDOW;
+	k_delayed_work_submit(&lpl.sleep, LPL_RX_WINDOW);
+
+	lpl.next_wakeup = now + LPL_INTERVAL;
+	k_delayed_work_submit(&lpl.wakeup, LPL_INTERVAL);
+}
+
+static int lpl_radio_send(struct net_if *iface, struct net_buf *buf)
+{
+	NET_DBG("buf %p (frags %p)", buf, buf->frags);
+
+	return tx_buffer_fragments(iface, buf, lpl_tx_fragment);
+}
+
+static enum net_verdict lpl_radio_handle_ack(struct net_if *iface,
+					     struct net_buf *buf)
+{
+	struct ieee802154_context *ctx = net_if_l2_data(iface);
+
+	return handle_ack(ctx, buf);
+}
+
+/* Declare the public Radio driver function used by the HW drivers */
+FUNC_ALIAS(lpl_radio_send,
+	   ieee802154_radio_send, int);
+
+FUNC_ALIAS(lpl_radio_handle_ack,
+	   ieee802154_radio_handle_ack, enum net_verdict);
@@ -0,0 +1,53 @@
+/** @file
+ @brief IEEE 802.15.4 low-power listening radio protocol
+
+ This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __IEEE802154_RADIO_LPL_H__
+#define __IEEE802154_RADIO_LPL_H__
+
+#include <net/net_if.h>
+
+#include "ieee802154_frame.h"
+
+#if defined(CONFIG_NET_L2_IEEE802154_RADIO_LPL)
+/**
+ *  @brief Start duty cycling the radio of an interface
+ *
+ *  @details The radio, already started, is then only switched on
+ *  periodically to listen for incoming frames. Only one interface can
+ *  be duty cycled.
+ *
+ *  @param iface Network interface of the radio
+ */
+void ieee802154_lpl_init(struct net_if *iface);
+
+/**
+ *  @brief Handle a received data frame
+ *
+ *  @details Senders repeat a frame until it is acknowledged or, for a
+ *  broadcast one, during a whole wake-up interval: the repeated frames
+ *  are dropped here. The radio is kept listening while the sender tells
+ *  more frames are pending.
+ *
+ *  @param iface Network interface the frame was received on
+ *  @param mpdu Validated frame
+ *
+ *  @return NET_DROP if the frame was already received, NET_CONTINUE
+ *          otherwise.
+ */
+enum net_verdict ieee802154_lpl_recv(struct net_if *iface,
+				     struct ieee802154_mpdu *mpdu);
+#else
+#define ieee802154_lpl_init(...)
+#define ieee802154_lpl_recv(...) NET_CONTINUE
+#endif
+
+#endif /* __IEEE802154_RADIO_LPL_H__ */
@@ -0,0 +1,532 @@
+/** @file
+ * @brief IEEE 802.15.4 frame security
+ *
+ * Data frames are secured with CCM*, see Annex B. The AES-128 block
+ * encryption is done by the radio when it has an AES engine, by
+ * TinyCrypt otherwise, with the key schedule computed once per key.
+ * Frames are secured in place, within their own fragment.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_L2_IEEE802154)
+#define SYS_LOG_DOMAIN "net/ieee802154"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_mgmt.h>
+#include <net/nbuf.h>
+#include <net/ieee802154.h>
+#include <net/ieee802154_radio.h>
+
+#include <misc/byteorder.h>
+#include <misc/util.h>
+
+#include <string.h>
+#include <errno.h>
+
+#include <tinycrypt/aes.h>
+#include <tinycrypt/constants.h>
+
+#include "ieee802154_frame.h"
+#include "ieee802154_security.h"
+
+#define AES_BLOCK_SIZE		16
+#define CCM_NONCE_LENGTH	13
+
+#define SECURITY_KEYS		CONFIG_NET_L2_IEEE802154_SECURITY_KEYS
+#define SECURITY_DEVICES	CONFIG_NET_L2_IEEE802154_SECURITY_DEVICES
+
+struct security_key {
+	uint8_t key[IEEE802154_SECURITY_KEY_LENGTH];
+	struct tc_aes_key_sched_struct sched;
+	uint8_t index;
+	bool in_use;
+};
+
+/* Last frame counter received from a device, against replays */
+struct security_device {
+	uint8_t ext_addr[IEEE802154_EXT_ADDR_LENGTH];
+	uint32_t frame_counter;
+	bool in_use;
+};
+
+static struct {
+	struct security_key keys[SECURITY_KEYS];
+	struct security_device devices[SECURITY_DEVICES];
+	uint8_t device_next;
+	uint32_t frame_counter;
+	uint8_t level;
+	uint8_t key_mode;
+	uint8_t key_index;
+} sec;
+
+static inline uint8_t level_mic_len(uint8_t level)
+{
+	return (level & 0x3) ? 2 << (level & 0x3) : 0;
+}
+
+static inline bool level_encrypts(uint8_t level)
+{
+	return level & IEEE802154_SECURITY_LEVEL_ENC;
+}
+
+static struct security_key *key_find(uint8_t index)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sec.keys); i++) {
+		if (sec.keys[i].in_use && sec.keys[i].index == index) {
+			return &sec.keys[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int aes_block(struct net_if *iface, struct security_key *key,
+		     uint8_t *block)
+{
+	const struct ieee802154_radio_api *radio = iface->dev->driver_api;
+
+	if (radio->aes_encrypt) {
+		return radio->aes_encrypt(iface->dev, key->key, block);
+	}
+
+	if (tc_aes_encrypt(block, block, &key->sched) != TC_CRYPTO_SUCCESS) {
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/* CBC-MAC the data into x, *pos being the offset in the current block */
+static int ccm_cbc(struct net_if *iface, struct security_key *key,
+		   uint8_t *x, uint8_t *pos, const uint8_t *data, uint8_t len)
+{
+	int ret;
+
+	while (len--) {
+		x[(*pos)++] ^= *data++;
+
+		if (*pos == AES_BLOCK_SIZE) {
+			ret = aes_block(iface, key, x);
+			if (ret) {
+				return ret;
+			}
+
+			*pos = 0;
+		}
+	}
+
+	return 0;
+}
+
+/* Unencrypted MIC of a frame, the authentication tag T */
+static int ccm_auth(struct net_if *iface, struct security_key *key,
+		    const uint8_t *nonce, const uint8_t *a, uint8_t a_len,
+		    const uint8_t *m, uint8_t m_len, uint8_t mic_len,
+		    uint8_t *x)
+{
+	uint8_t a_hdr[2] = { 0, a_len };
+	uint8_t pos = 0;
+	int ret;
+
+	/* B0: flags, nonce and length of m, on 2 bytes */
+	x[0] = (a_len ? BIT(6) : 0) | (((mic_len - 2) / 2) << 3) | 1;
+	memcpy(x + 1, nonce, CCM_NONCE_LENGTH);
+	x[14] = 0;
+	x[15] = m_len;
+
+	ret = aes_block(iface, key, x);
+	if (ret) {
+		return ret;
+	}
+
+	if (a_len) {
+		ret = ccm_cbc(iface, key, x, &pos, a_hdr, sizeof(a_hdr));
+		if (!ret) {
+			ret = ccm_cbc(iface, key, x, &pos, a, a_len);
+		}
+
+		/* Zero padding leaves the block as is */
+		if (!ret && pos) {
+			ret = aes_block(iface, key, x);
+			pos = 0;
+		}
+
+		if (ret) {
+			return ret;
+		}
+	}
+
+	ret = ccm_cbc(iface, key, x, &pos, m, m_len);
+	if (!ret && pos) {
+		ret = aes_block(iface, key, x);
+	}
+
+	return ret;
+}
+
+/* Encrypt or decrypt m in counter mode, from counter 1. The tag is
+ * encrypted with counter 0.
+ */
+static int ccm_ctr(struct net_if *iface, struct security_key *key,
+		   const uint8_t *nonce, uint8_t *m, uint8_t m_len,
+		   uint8_t *tag, uint8_t mic_len)
+{
+	uint8_t s[AES_BLOCK_SIZE];
+	uint8_t counter = 0;
+	uint8_t i, len;
+	int ret;
+
+	do {
+		s[0] = 1;
+		memcpy(s + 1, nonce, CCM_NONCE_LENGTH);
+		s[14] = 0;
+		s[15] = counter;
+
+		ret = aes_block(iface, key, s);
+		if (ret) {
+			return ret;
+		}
+
+		if (!counter) {
+			for (i = 0; i < mic_len; i++) {
+				tag[i] ^= s[i];
+			}
+		} else {
+			len = min(m_len, AES_BLOCK_SIZE);
+
+			for (i = 0; i < len; i++) {
+				*m++ ^= s[i];
+			}
+
+			m_len -= len;
+		}
+
+		counter++;
+	} while (m_len);
+
+	return 0;
+}
+
+static void ccm_nonce(uint8_t *nonce, const uint8_t *ext_addr,
+		      struct ieee802154_aux_security_hdr *ash)
+{
+	uint32_t frame_counter = sys_le32_to_cpu(ash->frame_counter);
+
+	/* Big endian extended address and frame counter */
+	memcpy(nonce, ext_addr, IEEE802154_EXT_ADDR_LENGTH);
+	sys_put_be32(frame_counter, nonce + IEEE802154_EXT_ADDR_LENGTH);
+	nonce[12] = ash->control.security_level;
+}
+
+uint8_t ieee802154_security_hdr_len(struct net_if *iface)
+{
+	ARG_UNUSED(iface);
+
+	if (sec.level == IEEE802154_SECURITY_LEVEL_NONE) {
+		return 0;
+	}
+
+	return IEEE802154_AUX_SEC_HDR_LENGTH(sec.key_mode);
+}
+
+uint8_t ieee802154_security_mic_len(struct net_if *iface)
+{
+	ARG_UNUSED(iface);
+
+	return level_mic_len(sec.level);
+}
+
+uint8_t *ieee802154_security_write_hdr(struct net_if *iface,
+				       struct ieee802154_fcf_seq *fs,
+				       uint8_t *p_buf)
+{
+	struct ieee802154_aux_security_hdr *ash =
+		(struct ieee802154_aux_security_hdr *)p_buf;
+
+	ARG_UNUSED(iface);
+
+	if (sec.level == IEEE802154_SECURITY_LEVEL_NONE) {
+		return p_buf;
+	}
+
+	fs->fc.security_enabled = 1;
+
+	ash->control.security_level = sec.level;
+	ash->control.key_id_mode = sec.key_mode;
+	ash->control.reserved = 0;
+	ash->frame_counter = sys_cpu_to_le32(sec.frame_counter);
+
+	/* Frames sent after the counter exhausted are dropped */
+	if (sec.frame_counter != UINT32_MAX) {
+		sec.frame_counter++;
+	}
+
+	if (sec.key_mode == IEEE802154_KEY_ID_MODE_INDEX) {
+		ash->key_index = sec.key_index;
+	}
+
+	return p_buf + IEEE802154_AUX_SEC_HDR_LENGTH(sec.key_mode);
+}
+
+int ieee802154_encrypt_frame(struct net_if *iface, struct net_buf *buf)
+{
+	struct net_buf *frag = buf->frags;
+	uint8_t reserve = net_nbuf_ll_reserve(buf);
+	struct ieee802154_fcf_seq *fs =
+		(struct ieee802154_fcf_seq *)net_nbuf_ll(buf);
+	struct ieee802154_aux_security_hdr *ash;
+	uint8_t nonce[CCM_NONCE_LENGTH];
+	uint8_t x[AES_BLOCK_SIZE];
+	struct security_key *key;
+	uint8_t level, mic_len;
+	int ret;
+
+	if (!fs->fc.security_enabled) {
+		return 0;
+	}
+
+	ash = (struct ieee802154_aux_security_hdr *)((uint8_t *)fs + reserve -
+		IEEE802154_AUX_SEC_HDR_LENGTH(sec.key_mode));
+	level = ash->control.security_level;
+	mic_len = level_mic_len(level);
+
+	if (sys_le32_to_cpu(ash->frame_counter) == UINT32_MAX) {
+		return -EIO;
+	}
+
+	key = key_find(ash->control.key_id_mode ? ash->key_index : 0);
+	if (!key) {
+		return -EIO;
+	}
+
+	if (net_buf_tailroom(frag) < mic_len ||
+	    reserve + frag->len + mic_len + IEEE802154_MFR_LENGTH >
+	    IEEE802154_MTU) {
+		return -ENOBUFS;
+	}
+
+	ccm_nonce(nonce, iface->link_addr.addr, ash);
+
+	if (mic_len) {
+		/* The payload is only authenticated if not encrypted */
+		if (level_encrypts(level)) {
+			ret = ccm_auth(iface, key, nonce, (uint8_t *)fs,
+				       reserve, frag->data, frag->len,
+				       mic_len, x);
+		} else {
+			ret = ccm_auth(iface, key, nonce, (uint8_t *)fs,
+				       reserve + frag->len, NULL, 0,
+				       mic_len, x);
+		}
+
+		if (ret) {
+			return ret;
+		}
+	}
+
+	ret = ccm_ctr(iface, key, nonce, frag->data,
+		      level_encrypts(level) ? frag->len : 0, x, mic_len);
+	if (ret) {
+		return ret;
+	}
+
+	memcpy(net_buf_add(frag, mic_len), x, mic_len);
+
+	return 0;
+}
+
+static struct security_device *device_get(const uint8_t *ext_addr)
+{
+	struct security_device *dev;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sec.devices); i++) {
+		dev = &sec.devices[i];
+
+		if (dev->in_use &&
+		    !memcmp(dev->ext_addr, ext_addr, sizeof(dev->ext_addr))) {
+			return dev;
+		}
+	}
+
+	dev = &sec.devices[sec.device_next];
+	sec.device_next = (sec.device_next + 1) % ARRAY_SIZE(sec.devices);
+
+	memcpy(dev->ext_addr, ext_addr, sizeof(dev->ext_addr));
+	dev->frame_counter = 0;
+	dev->in_use = false;
+
+	return dev;
+}
+
+bool ieee802154_decrypt_frame(struct net_if *iface, struct net_buf *buf,
+			      struct ieee802154_mpdu *mpdu)
+{
+	struct ieee802154_aux_security_hdr *ash = mpdu->mhr.aux_sec;
+	struct ieee802154_fcf_seq *fs = mpdu->mhr.fs;
+	struct net_buf *frag = buf->frags;
+	uint8_t ext_addr[IEEE802154_EXT_ADDR_LENGTH];
+	uint8_t nonce[CCM_NONCE_LENGTH];
+	uint8_t x[AES_BLOCK_SIZE];
+	struct security_device *dev;
+	struct security_key *key;
+	uint8_t level, mic_len;
+	uint8_t hdr_len, len;
+	uint32_t frame_counter;
+	uint8_t *payload;
+	uint8_t diff = 0;
+	int i;
+
+	if (!ash) {
+		return true;
+	}
+
+	level = ash->control.security_level;
+	mic_len = level_mic_len(level);
+	payload = mpdu->payload;
+	hdr_len = payload - (uint8_t *)fs;
+
+	/* ToDo: get the extended address of a short one from the
+	 * neighbor cache
+	 */
+	if (frag->frags ||
+	    fs->fc.src_addr_mode != IEEE802154_ADDR_MODE_EXTENDED ||
+	    frag->len < hdr_len + mic_len) {
+		return false;
+	}
+
+	key = key_find(ash->control.key_id_mode ? ash->key_index : 0);
+	if (!key) {
+		NET_DBG("Unknown key");
+		return false;
+	}
+
+	sys_memcpy_swap(ext_addr, fs->fc.pan_id_comp ?
+			mpdu->mhr.src_addr->comp.addr.ext_addr :
+			mpdu->mhr.src_addr->plain.addr.ext_addr,
+			IEEE802154_EXT_ADDR_LENGTH);
+
+	frame_counter = sys_le32_to_cpu(ash->frame_counter);
+
+	dev = device_get(ext_addr);
+	if (frame_counter == UINT32_MAX ||
+	    (dev->in_use && frame_counter <= dev->frame_counter)) {
+		NET_DBG("Replayed frame %u", frame_counter);
+		return false;
+	}
+
+	len = frag->len - hdr_len - mic_len;
+
+	ccm_nonce(nonce, ext_addr, ash);
+
+	/* Recover the authentication tag, and the payload */
+	memcpy(x, payload + len, mic_len);
+
+	if (ccm_ctr(iface, key, nonce, payload,
+		    level_encrypts(level) ? len : 0, x, mic_len)) {
+		return false;
+	}
+
+	if (mic_len) {
+		uint8_t tag[AES_BLOCK_SIZE];
+
+		memcpy(tag, x, mic_len);
+
+		if (level_encrypts(level)) {
+			i = ccm_auth(iface, key, nonce, (uint8_t *)fs, hdr_len,
+				     payload, len, mic_len, x);
+		} else {
+			i = ccm_auth(iface, key, nonce, (uint8_t *)fs,
+				     hdr_len + len, NULL, 0, mic_len, x);
+		}
+
+		if (i) {
+			return false;
+		}
+
+		for (i = 0; i < mic_len; i++) {
+			diff |= tag[i] ^ x[i];
+		}
+
+		if (diff) {
+			NET_DBG("Wrong MIC");
+			return false;
+		}
+	}
+
+	dev->frame_counter = frame_counter;
+	dev->in_use = true;
+
+	frag->len -= mic_len;
+
+	return true;
+}
+
+static int ieee802154_set_security_settings(uint32_t mgmt_request,
+					    struct net_if *iface,
+					    void *data, size_t len)
+{
+	struct ieee802154_security_params *params = data;
+	struct security_key *key;
+	int i;
+
+	if (len != sizeof(struct ieee802154_security_params) ||
+	    params->level > IEEE802154_SECURITY_LEVEL_ENC_MIC_128 ||
+	    params->key_mode > IEEE802154_KEY_ID_MODE_INDEX ||
+	    (params->key_len &&
+	     params->key_len != IEEE802154_SECURITY_KEY_LENGTH)) {
+		return -EINVAL;
+	}
+
+	/* The implicit key is the one of index 0 */
+	if (params->key_mode == IEEE802154_KEY_ID_MODE_IMPLICIT) {
+		params->key_index = 0;
+	}
+
+	if (params->key_len) {
+		key = key_find(params->key_index);
+
+		for (i = 0; !key && i < ARRAY_SIZE(sec.keys); i++) {
+			if (!sec.keys[i].in_use) {
+				key = &sec.keys[i];
+			}
+		}
+
+		if (!key) {
+			return -ENOMEM;
+		}
+
+		if (tc_aes128_set_encrypt_key(&key->sched, params->key) !=
+		    TC_CRYPTO_SUCCESS) {
+			return -EINVAL;
+		}
+
+		memcpy(key->key, params->key, sizeof(key->key));
+		key->index = params->key_index;
+		key->in_use = true;
+	}
+
+	if (params->level != IEEE802154_SECURITY_LEVEL_NONE &&
+	    !key_find(params->key_index)) {
+		return -ENOENT;
+	}
+
+	sec.level = params->level;
+	sec.key_mode = params->key_mode;
+	sec.key_index = params->key_index;
+
+	return 0;
+}
+
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_IEEE802154_SET_SECURITY_SETTINGS,
+				  ieee802154_set_security_settings);
@@ -0,0 +1,84 @@
+/** @file
+ @brief IEEE 802.15.4 frame security
+
+ This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __IEEE802154_SECURITY_H__
+#define __IEEE802154_SECURITY_H__
+
+#include <net/net_if.h>
+#include <net/nbuf.h>
+
+#include "ieee802154_frame.h"
+
+#if defined(CONFIG_NET_L2_IEEE802154_SECURITY)
+/**
+ *  @brief Length of the auxiliary security header of the outgoing data
+ *  frames, 0 if they are not secured
+ */
+uint8_t ieee802154_security_hdr_len(struct net_if *iface);
+
+/**
+ *  @brief Length of the MIC of the outgoing data frames, which has to be
+ *  left at the end of each fragment
+ */
+uint8_t ieee802154_security_mic_len(struct net_if *iface);
+
+/**
+ *  @brief Write the auxiliary security header of an outgoing data frame
+ *
+ *  @details The frame counter is taken here, the frame itself is secured
+ *  by ieee802154_encrypt_frame() right before it is sent.
+ *
+ *  @param iface Network interface
+ *  @param fs Frame control field of the frame
+ *  @param p_buf Where to write the header, after the addressing fields
+ *
+ *  @return Where the payload starts.
+ */
+uint8_t *ieee802154_security_write_hdr(struct net_if *iface,
+				       struct ieee802154_fcf_seq *fs,
+				       uint8_t *p_buf);
+
+/**
+ *  @brief Secure the first frame of a buffer, its MIC is appended
+ *
+ *  @details The MAC header is authenticated as well, so nothing of the
+ *  frame can be changed afterwards.
+ *
+ *  @param iface Network interface to send from
+ *  @param buf Buffer whose first fragment is the frame
+ *
+ *  @return 0 if ok, -ENOBUFS if there is no room for the MIC, -EIO if
+ *          the frame cannot be secured.
+ */
+int ieee802154_encrypt_frame(struct net_if *iface, struct net_buf *buf);
+
+/**
+ *  @brief Check and decrypt a received data frame, its MIC is removed
+ *
+ *  @param iface Network interface the frame was received on
+ *  @param buf Buffer holding the frame
+ *  @param mpdu Validated frame
+ *
+ *  @return True if the frame is not secured or could be unsecured,
+ *          false if it has to be dropped.
+ */
+bool ieee802154_decrypt_frame(struct net_if *iface, struct net_buf *buf,
+			      struct ieee802154_mpdu *mpdu);
+#else
+#define ieee802154_security_hdr_len(...) 0
+#define ieee802154_security_mic_len(...) 0
+#define ieee802154_security_write_hdr(_iface, _fs, _p_buf) (_p_buf)
+#define ieee802154_encrypt_frame(...) 0
+#define ieee802154_decrypt_frame(_iface, _buf, _mpdu) (!(_mpdu)->mhr.aux_sec)
+#endif
+
+#endif /* __IEEE802154_SECURITY_H__ */
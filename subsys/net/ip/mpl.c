@@ -0,0 +1,551 @@
+/** @file
+ * @brief IPv6 multicast forwarding (MPL)
+ *
+ * This implements the data message forwarding of the Multicast Protocol
+ * for Low-Power and Lossy Networks as specified in RFC 7731.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_IPV6_MPL)
+#define SYS_LOG_DOMAIN "net/mpl"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <misc/util.h>
+
+#include <net/nbuf.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_stats.h>
+#include <net/net_ip.h>
+#include <net/trickle.h>
+
+#include "net_private.h"
+#include "net_stats.h"
+#include "ipv6.h"
+#include "route.h"
+#include "mpl.h"
+
+#define SEED_LIFETIME K_MINUTES(CONFIG_NET_IPV6_MPL_SEED_LIFETIME)
+
+/* Seed-id length in bytes for each value of the S field, 0 meaning
+ * that the seed is the source address.
+ */
+static const uint8_t seed_id_lens[] = { 0, 2, 8, 16 };
+
+struct mpl_seed {
+	/** Seed-id, zero padded */
+	struct in6_addr id;
+
+	/** When a packet from this seed was last received, in ms */
+	uint32_t heard;
+
+	/** Length of the seed-id in bytes */
+	uint8_t id_len;
+
+	/** Packets with a lower sequence number are ignored */
+	uint8_t min_seq;
+
+	/** Is this entry used or not */
+	bool is_used;
+};
+
+struct mpl_msg {
+	/** Retransmission timer */
+	struct net_trickle trickle;
+
+	/** Seed that originated the packet */
+	struct mpl_seed *seed;
+
+	/** Copy of the packet to retransmit, NULL once the retransmissions
+	 * are over or if it is not forwarded.
+	 */
+	struct net_buf *buf;
+
+	/** When the packet was buffered, in ms */
+	uint32_t time;
+
+	/** Sequence number of the packet */
+	uint8_t seq;
+
+	/** Number of Trickle intervals that expired */
+	uint8_t expirations;
+
+	/** Is this entry used or not */
+	bool is_used;
+};
+
+static struct mpl_seed seeds[CONFIG_NET_IPV6_MPL_SEED_SET_SIZE];
+static struct mpl_msg msgs[CONFIG_NET_IPV6_MPL_BUFFERED_MESSAGES];
+static struct k_sem mpl_lock;
+
+/* Sequence number of the packets originated by this node */
+static atomic_t mpl_seq;
+
+/* ff03::fc, see RFC 7731 ch 6.3 */
+static const struct in6_addr all_mpl_forwarders = { { {
+	0xff, 0x03, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xfc } } };
+
+/* Sequence numbers are compared with serial number arithmetic */
+static inline bool seq_lt(uint8_t a, uint8_t b)
+{
+	return (int8_t)(a - b) < 0;
+}
+
+static void msg_free(struct mpl_msg *msg)
+{
+	if (msg->buf) {
+		net_trickle_stop(&msg->trickle);
+		net_nbuf_unref(msg->buf);
+		msg->buf = NULL;
+	}
+
+	msg->is_used = false;
+}
+
+static struct mpl_seed *seed_lookup(struct in6_addr *id, uint8_t id_len)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV6_MPL_SEED_SET_SIZE; i++) {
+		struct mpl_seed *seed = &seeds[i];
+
+		if (!seed->is_used || seed->id_len != id_len ||
+		    memcmp(&seed->id, id, id_len)) {
+			continue;
+		}
+
+		/* A seed not heard of for long may have restarted its
+		 * sequence numbers.
+		 */
+		if (k_uptime_get_32() - seed->heard > SEED_LIFETIME) {
+			NET_DBG("Seed %p expired", seed);
+			break;
+		}
+
+		return seed;
+	}
+
+	return NULL;
+}
+
+static struct mpl_seed *seed_add(struct in6_addr *id, uint8_t id_len,
+				 uint8_t seq)
+{
+	struct mpl_seed *seed = NULL;
+	int i;
+
+	/* Reuse the same entry if the seed expired, otherwise
+	 * replace the least recently heard one.
+	 */
+	for (i = 0; i < CONFIG_NET_IPV6_MPL_SEED_SET_SIZE; i++) {
+		struct mpl_seed *entry = &seeds[i];
+
+		if (!entry->is_used) {
+			if (!seed) {
+				seed = entry;
+			}
+
+			continue;
+		}
+
+		if (entry->id_len == id_len &&
+		    !memcmp(&entry->id, id, id_len)) {
+			seed = entry;
+			break;
+		}
+
+		if (!seed || (seed->is_used &&
+			      (int32_t)(entry->heard - seed->heard) < 0)) {
+			seed = entry;
+		}
+	}
+
+	if (seed->is_used) {
+		NET_DBG("Removing seed %p", seed);
+
+		for (i = 0; i < CONFIG_NET_IPV6_MPL_BUFFERED_MESSAGES; i++) {
+			if (msgs[i].is_used && msgs[i].seed == seed) {
+				msg_free(&msgs[i]);
+			}
+		}
+	}
+
+	memset(&seed->id, 0, sizeof(seed->id));
+	memcpy(&seed->id, id, id_len);
+	seed->id_len = id_len;
+	seed->min_seq = seq;
+	seed->is_used = true;
+
+	return seed;
+}
+
+static struct mpl_msg *msg_lookup(struct mpl_seed *seed, uint8_t seq)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV6_MPL_BUFFERED_MESSAGES; i++) {
+		if (msgs[i].is_used && msgs[i].seed == seed &&
+		    msgs[i].seq == seq) {
+			return &msgs[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Prefer replacing a packet whose retransmissions are over, then the
+ * oldest one.
+ */
+static inline bool msg_is_better_victim(struct mpl_msg *msg,
+					struct mpl_msg *victim)
+{
+	if (!msg->buf != !victim->buf) {
+		return !msg->buf;
+	}
+
+	return (int32_t)(msg->time - victim->time) < 0;
+}
+
+static struct mpl_msg *msg_add(struct mpl_seed *seed, uint8_t seq)
+{
+	struct mpl_msg *msg = NULL;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV6_MPL_BUFFERED_MESSAGES; i++) {
+		if (!msgs[i].is_used) {
+			msg = &msgs[i];
+			break;
+		}
+
+		if (!msg || msg_is_better_victim(&msgs[i], msg)) {
+			msg = &msgs[i];
+		}
+	}
+
+	if (msg->is_used) {
+		NET_DBG("Removing seq %u of seed %p", msg->seq, msg->seed);
+
+		/* The packet would not be recognized as a duplicate
+		 * anymore, so do not accept it again.
+		 */
+		if (seq_lt(msg->seed->min_seq, msg->seq + 1)) {
+			msg->seed->min_seq = msg->seq + 1;
+		}
+
+		msg_free(msg);
+	}
+
+	msg->seed = seed;
+	msg->seq = seq;
+	msg->time = k_uptime_get_32();
+	msg->expirations = 0;
+	msg->is_used = true;
+
+	return msg;
+}
+
+/* Returns a copy of the packet, ready to be sent */
+static struct net_buf *msg_tx_copy(struct net_buf *buf)
+{
+	struct net_buf *tx, *frags;
+
+	tx = net_nbuf_get_reserve_tx(0);
+	if (!tx) {
+		return NULL;
+	}
+
+	frags = net_nbuf_copy_all(buf->frags, 0);
+	if (!frags) {
+		net_nbuf_unref(tx);
+		return NULL;
+	}
+
+	net_buf_frag_add(tx, frags);
+
+	net_nbuf_set_iface(tx, net_nbuf_iface(buf));
+	net_nbuf_set_family(tx, AF_INET6);
+	net_nbuf_set_ll_reserve(tx, net_nbuf_ll_reserve(buf));
+	net_nbuf_set_ip_hdr_len(tx, net_nbuf_ip_hdr_len(buf));
+	net_nbuf_set_ext_len(tx, net_nbuf_ext_len(buf));
+
+	return tx;
+}
+
+static void msg_timeout(struct net_trickle *trickle, bool tx_allowed,
+			void *user_data)
+{
+	struct mpl_msg *msg = user_data;
+	struct net_buf *buf = NULL;
+	struct net_buf *tx;
+
+	k_sem_take(&mpl_lock, K_FOREVER);
+
+	if (!msg->buf) {
+		k_sem_give(&mpl_lock);
+		return;
+	}
+
+	if (tx_allowed) {
+		buf = net_buf_ref(msg->buf);
+	}
+
+	if (++msg->expirations >= CONFIG_NET_IPV6_MPL_DATA_EXPIRATIONS) {
+		NET_DBG("Retransmissions of seq %u of seed %p over",
+			msg->seq, msg->seed);
+
+		net_trickle_stop(&msg->trickle);
+		net_nbuf_unref(msg->buf);
+		msg->buf = NULL;
+	}
+
+	k_sem_give(&mpl_lock);
+
+	if (!buf) {
+		return;
+	}
+
+	tx = msg_tx_copy(buf);
+	net_nbuf_unref(buf);
+
+	if (!tx) {
+		return;
+	}
+
+	if (net_send_data(tx) < 0) {
+		net_nbuf_unref(tx);
+		return;
+	}
+
+	net_stats_update_ipv6_mpl_forwarded();
+}
+
+/* Buffer a copy of the packet and start retransmitting it */
+static struct net_buf *msg_buffer(struct mpl_msg *msg, struct net_buf *buf)
+{
+	struct net_if *iface = net_nbuf_iface(buf);
+	struct net_buf *copy, *frag;
+
+	copy = net_nbuf_get_reserve_tx(0);
+	if (!copy) {
+		return NULL;
+	}
+
+	net_nbuf_set_iface(copy, iface);
+	net_nbuf_set_family(copy, AF_INET6);
+	net_nbuf_set_ll_reserve(copy,
+				net_if_get_ll_reserve(iface,
+						&NET_IPV6_BUF(buf)->dst));
+	net_nbuf_set_ip_hdr_len(copy, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ext_len(copy, net_nbuf_ext_len(buf));
+
+	for (frag = buf->frags; frag; frag = frag->frags) {
+		if (!net_nbuf_append(copy, frag->len, frag->data)) {
+			net_nbuf_unref(copy);
+			return NULL;
+		}
+	}
+
+	msg->buf = copy;
+
+	net_trickle_create(&msg->trickle, CONFIG_NET_IPV6_MPL_DATA_IMIN,
+			   CONFIG_NET_IPV6_MPL_DATA_IMAX,
+			   CONFIG_NET_IPV6_MPL_DATA_K);
+	net_trickle_start(&msg->trickle, msg_timeout, msg);
+
+	return copy;
+}
+
+static bool is_forwarded(struct in6_addr *dst)
+{
+	if (!net_is_ipv6_addr_mcast_realm(dst)) {
+		return false;
+	}
+
+	if (net_ipv6_addr_cmp(dst, &all_mpl_forwarders)) {
+		return true;
+	}
+
+	if (net_if_ipv6_maddr_lookup(dst, NULL)) {
+		return true;
+	}
+
+#if defined(CONFIG_NET_ROUTE_MCAST)
+	if (net_route_mcast_lookup(dst)) {
+		return true;
+	}
+#endif
+
+	return false;
+}
+
+enum net_verdict net_mpl_input(struct net_buf *buf, struct net_buf *frag,
+			       uint16_t pos, uint8_t opt_len)
+{
+	struct net_ipv6_hdr *hdr = NET_IPV6_BUF(buf);
+	enum net_verdict verdict = NET_CONTINUE;
+	struct mpl_seed *seed;
+	struct mpl_msg *msg;
+	struct net_buf *copy;
+	struct in6_addr id;
+	uint8_t flags, seq, id_len;
+
+	frag = net_nbuf_read_u8(frag, pos, &pos, &flags);
+	frag = net_nbuf_read_u8(frag, pos, &pos, &seq);
+
+	id_len = seed_id_lens[flags >> NET_MPL_OPT_S_SHIFT];
+
+	if ((!frag && pos == 0xffff) || (flags & NET_MPL_OPT_V) ||
+	    opt_len != NET_MPL_OPT_LEN + id_len) {
+		NET_DBG("Invalid MPL option flags 0x%x len %u",
+			flags, opt_len);
+		net_stats_update_ipv6_mpl_drop();
+		return NET_DROP;
+	}
+
+	if (id_len) {
+		memset(&id, 0, sizeof(id));
+
+		frag = net_nbuf_read(frag, pos, &pos, id_len, id.s6_addr);
+		if (!frag && pos == 0xffff) {
+			net_stats_update_ipv6_mpl_drop();
+			return NET_DROP;
+		}
+	} else {
+		net_ipaddr_copy(&id, &hdr->src);
+		id_len = sizeof(id);
+	}
+
+	net_stats_update_ipv6_mpl_recv();
+
+	k_sem_take(&mpl_lock, K_FOREVER);
+
+	seed = seed_lookup(&id, id_len);
+	if (seed) {
+		if (seq_lt(seq, seed->min_seq)) {
+			NET_DBG("Old seq %u of seed %p (min %u)",
+				seq, seed, seed->min_seq);
+			goto duplicate;
+		}
+
+		msg = msg_lookup(seed, seq);
+		if (msg) {
+			NET_DBG("Duplicate seq %u of seed %p", seq, seed);
+
+			if (msg->buf) {
+				net_trickle_consistency(&msg->trickle);
+			}
+
+			goto duplicate;
+		}
+	} else {
+		seed = seed_add(&id, id_len, seq);
+	}
+
+	seed->heard = k_uptime_get_32();
+
+	/* The packet is remembered even if it is not forwarded, so that
+	 * its duplicates are not delivered again.
+	 */
+	msg = msg_add(seed, seq);
+
+	if (hdr->hop_limit > 1 && is_forwarded(&hdr->dst)) {
+		copy = msg_buffer(msg, buf);
+		if (copy) {
+			NET_IPV6_BUF(copy)->hop_limit--;
+		}
+	}
+
+	NET_DBG("New seq %u of seed %p forwarded %d", seq, seed, !!msg->buf);
+
+	goto out;
+
+duplicate:
+	net_stats_update_ipv6_mpl_duplicate();
+	verdict = NET_DROP;
+
+out:
+	k_sem_give(&mpl_lock);
+
+	return verdict;
+}
+
+int net_mpl_insert_header(struct net_buf *buf)
+{
+	struct net_ipv6_hdr *hdr = NET_IPV6_BUF(buf);
+	uint8_t opt[NET_MPL_HBH_LEN];
+
+	/* The option is carried in the first hop-by-hop header */
+	if (!net_is_ipv6_addr_mcast_realm(&hdr->dst) ||
+	    net_nbuf_ext_len(buf)) {
+		return 0;
+	}
+
+	opt[0] = hdr->nexthdr;
+	opt[1] = 0;
+	opt[2] = NET_IPV6_EXT_HDR_OPT_MPL;
+	opt[3] = NET_MPL_OPT_LEN;
+	opt[4] = 0;
+	opt[5] = (uint8_t)atomic_inc(&mpl_seq);
+	opt[6] = NET_IPV6_EXT_HDR_OPT_PADN;
+	opt[7] = 0;
+
+	if (!net_nbuf_insert(buf, buf->frags, sizeof(struct net_ipv6_hdr),
+			     sizeof(opt), opt)) {
+		return -ENOMEM;
+	}
+
+	NET_IPV6_BUF(buf)->nexthdr = NET_IPV6_NEXTHDR_HBHO;
+	net_nbuf_set_ext_len(buf, net_nbuf_ext_len(buf) + sizeof(opt));
+
+	return 1;
+}
+
+void net_mpl_sent(struct net_buf *buf)
+{
+	struct in6_addr *src = &NET_IPV6_BUF(buf)->src;
+	struct mpl_seed *seed;
+	struct mpl_msg *msg;
+	uint16_t pos;
+	uint8_t seq;
+
+	if (!net_nbuf_read_u8(buf->frags, sizeof(struct net_ipv6_hdr) + 5,
+			      &pos, &seq) && pos == 0xffff) {
+		return;
+	}
+
+	net_stats_update_ipv6_mpl_sent();
+
+	k_sem_take(&mpl_lock, K_FOREVER);
+
+	seed = seed_lookup(src, sizeof(*src));
+	if (!seed) {
+		seed = seed_add(src, sizeof(*src), seq);
+	}
+
+	seed->heard = k_uptime_get_32();
+
+	msg = msg_lookup(seed, seq);
+	if (msg) {
+		/* The sequence numbers wrapped around meanwhile */
+		msg_free(msg);
+	}
+
+	msg_buffer(msg_add(seed, seq), buf);
+
+	k_sem_give(&mpl_lock);
+}
+
+void net_mpl_init(void)
+{
+	k_sem_init(&mpl_lock, 0, UINT_MAX);
+	k_sem_give(&mpl_lock);
+}
@@ -0,0 +1,87 @@
+/** @file
+ * @brief IPv6 multicast forwarding (MPL)
+ *
+ * This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __MPL_H
+#define __MPL_H
+
+#include <stdint.h>
+
+#include <net/buf.h>
+#include <net/net_core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Hop-by-hop header holding an MPL option where the seed is the source
+ * address, followed by a PadN option.
+ */
+#define NET_MPL_HBH_LEN 8
+
+/* Length of the MPL option data when the seed is the source address */
+#define NET_MPL_OPT_LEN 2
+
+/* MPL option flags */
+#define NET_MPL_OPT_S_SHIFT 6
+#define NET_MPL_OPT_M 0x20
+#define NET_MPL_OPT_V 0x10
+
+#if defined(CONFIG_NET_IPV6_MPL)
+/**
+ * @brief Process the MPL option of a received packet.
+ *
+ * @details Duplicates are dropped, a new packet is buffered for
+ * retransmission if it must be forwarded.
+ *
+ * @param buf Network buffer.
+ * @param frag Fragment where the option data starts.
+ * @param pos Position of the option data in the fragment.
+ * @param opt_len Length of the option data.
+ *
+ * @return NET_CONTINUE if the packet is to be processed further,
+ * NET_DROP otherwise.
+ */
+enum net_verdict net_mpl_input(struct net_buf *buf, struct net_buf *frag,
+			       uint16_t pos, uint8_t opt_len);
+
+/**
+ * @brief Add an MPL option to a packet originated by this node.
+ *
+ * @details Only packets sent to a realm-local scope multicast address,
+ * and without any extension header, get the option.
+ *
+ * @param buf Network buffer, with its headers set up.
+ *
+ * @return 1 if the option was added, 0 if it is not needed, <0 if error.
+ */
+int net_mpl_insert_header(struct net_buf *buf);
+
+/**
+ * @brief Buffer a finalized packet originated by this node for
+ * retransmission.
+ *
+ * @param buf Network buffer, the MPL option was added to it.
+ */
+void net_mpl_sent(struct net_buf *buf);
+
+void net_mpl_init(void);
+#else
+#define net_mpl_insert_header(...) 0
+#define net_mpl_sent(...)
+#define net_mpl_init(...)
+#endif /* CONFIG_NET_IPV6_MPL */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MPL_H */
@@ -154,6 +154,8 @@ int net_nbr_unlink(struct net_nbr *nbr, struct net_linkaddr *lladdr)
 	nbr->idx = NET_NBR_LLADDR_UNKNOWN;
 	nbr->iface = NULL;
 
+	net_context_udp_cache_flush();
+
 	return 0;
 }
 
@@ -22,11 +22,14 @@
 #include <sys/types.h>
 
 #include <misc/util.h>
+#include <misc/byteorder.h>
 
 #include <net/net_core.h>
 #include <net/net_ip.h>
 #include <net/buf.h>
 #include <net/nbuf.h>
+#include <net/net_mgmt.h>
+#include <net/net_event.h>
 
 #include "net_private.h"
 
@@ -207,7 +210,7 @@ static inline void dec_free_bufs(struct net_buf_pool *pool,
 		dec_free_rx_bufs(buf);
 	} else if (pool == &tx_buffers) {
 		dec_free_tx_bufs(buf);
-	} else {
+	} else if (pool == &data_buffers) {
 		dec_free_data_bufs(buf);
 	}
 }
@@ -237,9 +240,21 @@ static inline int get_frees(struct net_buf_pool *pool)
 #define NET_BUF_CHECK_IF_NOT_IN_USE(buf, ref)
 #endif /* CONFIG_NET_DEBUG_NET_BUF */
 
+/* Only the pools of data fragments store data: the RX and TX buffers,
+ * including the ones of the pools given to a context, do not.
+ */
+static inline bool is_data_pool(struct net_buf_pool *pool)
+{
+	return pool->buf_size > 0;
+}
+
+/* Fragments with external data, see net_nbuf_get_ext_data(), are data
+ * fragments too.
+ */
 static inline bool is_from_data_pool(struct net_buf *buf)
 {
-	return (buf->pool == &data_buffers);
+	return is_data_pool(buf->pool) ||
+		(buf->flags & NET_BUF_EXTERNAL_DATA);
 }
 
 static inline void free_rx_bufs_func(struct net_buf *buf)
@@ -263,6 +278,40 @@ static inline void free_data_bufs_func(struct net_buf *buf)
 	net_buf_destroy(buf);
 }
 
+/* The buffers are owned by the caller of the nbuf API, not by this file */
+#define OWNED(buf) set_owner(buf, __builtin_return_address(0))
+
+static inline struct net_buf *set_owner(struct net_buf *buf, void *owner)
+{
+	net_buf_set_owner(buf, owner);
+
+	return buf;
+}
+
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+/* Tell when the last buffer of a pool has been taken */
+static inline void check_empty(struct net_buf_pool *pool)
+{
+	uint32_t event;
+
+	if (pool->stats.used < pool->buf_count) {
+		return;
+	}
+
+	if (pool == &rx_buffers) {
+		event = NET_EVENT_NBUF_RX_EMPTY;
+	} else if (is_data_pool(pool)) {
+		event = NET_EVENT_NBUF_DATA_EMPTY;
+	} else {
+		event = NET_EVENT_NBUF_TX_EMPTY;
+	}
+
+	net_mgmt_event_notify(event, NULL);
+}
+#else
+#define check_empty(...)
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+
 #if defined(CONFIG_NET_DEBUG_NET_BUF)
 static inline const char *pool2str(struct net_buf_pool *pool)
 {
@@ -327,7 +376,9 @@ static struct net_buf *net_nbuf_get_reserve(struct net_buf_pool *pool,
 
 	buf = net_buf_alloc(pool, K_FOREVER);
 
-	if (pool == &data_buffers) {
+	check_empty(pool);
+
+	if (is_data_pool(pool)) {
 		/* The buf->data will point to the start of the L3
 		 * header (like IPv4 or IPv6 packet header).
 		 */
@@ -373,21 +424,47 @@ struct net_buf *net_nbuf_get_reserve_data_debug(uint16_t reserve_head,
 
 struct net_buf *net_nbuf_get_reserve_rx(uint16_t reserve_head)
 {
-	return net_nbuf_get_reserve(&rx_buffers, reserve_head);
+	return OWNED(net_nbuf_get_reserve(&rx_buffers, reserve_head));
 }
 
 struct net_buf *net_nbuf_get_reserve_tx(uint16_t reserve_head)
 {
-	return net_nbuf_get_reserve(&tx_buffers, reserve_head);
+	return OWNED(net_nbuf_get_reserve(&tx_buffers, reserve_head));
 }
 
 struct net_buf *net_nbuf_get_reserve_data(uint16_t reserve_head)
 {
-	return net_nbuf_get_reserve(&data_buffers, reserve_head);
+	return OWNED(net_nbuf_get_reserve(&data_buffers, reserve_head));
 }
 
 #endif /* CONFIG_NET_DEBUG_NET_BUF */
 
+#if defined(CONFIG_NET_DEBUG_NET_BUF)
+struct net_buf *net_nbuf_get_ext_data_debug(struct net_buf_pool *pool,
+					    uint8_t *data, uint16_t len,
+					    const char *caller, int line)
+#else
+struct net_buf *net_nbuf_get_ext_data(struct net_buf_pool *pool,
+				      uint8_t *data, uint16_t len)
+#endif /* CONFIG_NET_DEBUG_NET_BUF */
+{
+	struct net_buf *frag;
+
+	NET_ASSERT(pool->user_data_size >= NBUF_USER_DATA_LEN);
+
+	frag = net_buf_alloc_ext(pool, data, len, K_NO_WAIT);
+	if (!frag) {
+		return NULL;
+	}
+
+	NET_BUF_CHECK_IF_NOT_IN_USE(frag, frag->ref + 1);
+
+	NET_DBG("%s buf %p data %p len %u ref %d (%s():%d)",
+		pool2str(pool), frag, data, len, frag->ref, caller, line);
+
+	return frag;
+}
+
 
 #if defined(CONFIG_NET_DEBUG_NET_BUF)
 static struct net_buf *net_nbuf_get_debug(struct net_buf_pool *pool,
@@ -411,6 +488,14 @@ static struct net_buf *net_nbuf_get(struct net_buf_pool *pool,
 
 	NET_ASSERT(iface);
 
+#if defined(CONFIG_NET_CONTEXT_NBUF_POOL)
+	if (pool == &tx_buffers && context->tx_pool) {
+		pool = context->tx_pool;
+	} else if (pool == &data_buffers && context->data_pool) {
+		pool = context->data_pool;
+	}
+#endif /* CONFIG_NET_CONTEXT_NBUF_POOL */
+
 	if (net_context_get_family(context) == AF_INET6) {
 		addr6 = &((struct sockaddr_in6 *) &context->remote)->sin6_addr;
 	}
@@ -426,7 +511,7 @@ static struct net_buf *net_nbuf_get(struct net_buf_pool *pool,
 		return buf;
 	}
 
-	if (pool != &data_buffers) {
+	if (!is_data_pool(pool)) {
 		net_nbuf_set_context(buf, context);
 		net_nbuf_set_ll_reserve(buf, reserve);
 		net_nbuf_set_iface(buf, iface);
@@ -434,6 +519,7 @@ static struct net_buf *net_nbuf_get(struct net_buf_pool *pool,
 		if (context) {
 			net_nbuf_set_family(buf,
 					    net_context_get_family(context));
+			net_nbuf_set_priority(buf, context->priority);
 		}
 	}
 
@@ -465,21 +551,21 @@ struct net_buf *net_nbuf_get_rx(struct net_context *context)
 {
 	NET_ASSERT_INFO(context, "RX context not set");
 
-	return net_nbuf_get(&rx_buffers, context);
+	return OWNED(net_nbuf_get(&rx_buffers, context));
 }
 
 struct net_buf *net_nbuf_get_tx(struct net_context *context)
 {
 	NET_ASSERT_INFO(context, "TX context not set");
 
-	return net_nbuf_get(&tx_buffers, context);
+	return OWNED(net_nbuf_get(&tx_buffers, context));
 }
 
 struct net_buf *net_nbuf_get_data(struct net_context *context)
 {
 	NET_ASSERT_INFO(context, "Data context not set");
 
-	return net_nbuf_get(&data_buffers, context);
+	return OWNED(net_nbuf_get(&data_buffers, context));
 }
 
 #endif /* CONFIG_NET_DEBUG_NET_BUF */
@@ -556,6 +642,29 @@ struct net_buf *net_nbuf_ref(struct net_buf *buf)
 	return net_buf_ref(buf);
 }
 
+/* Allocate a data fragment to be added to buf, from the data pool of its
+ * context if it has one.
+ */
+static struct net_buf *get_frag(struct net_buf *buf, uint16_t reserve_head)
+{
+	struct net_buf_pool *pool = &data_buffers;
+
+#if defined(CONFIG_NET_CONTEXT_NBUF_POOL)
+	struct net_context *context = net_nbuf_context(buf);
+
+	if (context && context->data_pool) {
+		pool = context->data_pool;
+	}
+#endif /* CONFIG_NET_CONTEXT_NBUF_POOL */
+
+#if defined(CONFIG_NET_DEBUG_NET_BUF)
+	return net_nbuf_get_reserve_debug(pool, reserve_head, __func__,
+					  __LINE__);
+#else
+	return net_nbuf_get_reserve(pool, reserve_head);
+#endif
+}
+
 struct net_buf *net_nbuf_copy(struct net_buf *orig, size_t amount,
 			      size_t reserve)
 {
@@ -681,6 +790,44 @@ int net_nbuf_linear_copy(struct net_buf *dst, struct net_buf *src,
 	return 0;
 }
 
+int net_nbuf_linearize(struct net_buf *buf, uint8_t *dst, size_t len)
+{
+	struct net_buf *frag = buf->frags;
+	uint8_t *pos = dst;
+	size_t frag_len;
+
+	if (!frag) {
+		return 0;
+	}
+
+	/* The link layer header is in the headroom of the first fragment */
+	frag_len = net_nbuf_ll_reserve(buf) + frag->len;
+	if (frag_len > len) {
+		return -ENOBUFS;
+	}
+
+	memcpy(pos, net_nbuf_ll(buf), frag_len);
+
+	for (;;) {
+		pos += frag_len;
+		len -= frag_len;
+
+		frag = frag->frags;
+		if (!frag) {
+			break;
+		}
+
+		frag_len = frag->len;
+		if (frag_len > len) {
+			return -ENOBUFS;
+		}
+
+		memcpy(pos, frag->data, frag_len);
+	}
+
+	return pos - dst;
+}
+
 bool net_nbuf_is_compact(struct net_buf *buf)
 {
 	struct net_buf *last;
@@ -918,7 +1065,7 @@ static inline bool net_nbuf_append_bytes(struct net_buf *buf, uint8_t *value,
 			return true;
 		}
 
-		frag = net_nbuf_get_reserve_data(ll_reserve);
+		frag = get_frag(buf, ll_reserve);
 		if (!frag) {
 			return false;
 		}
@@ -947,7 +1094,7 @@ bool net_nbuf_append(struct net_buf *buf, uint16_t len, uint8_t *data)
 	}
 
 	if (!buf->frags) {
-		frag = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
+		frag = get_frag(buf, net_nbuf_ll_reserve(buf));
 		if (!frag) {
 			return false;
 		}
@@ -962,26 +1109,6 @@ bool net_nbuf_append(struct net_buf *buf, uint16_t len, uint8_t *data)
  * offset. If required byte is last byte in framgent then return
  * next fragment and set offset = 0.
  */
-static inline struct net_buf *net_nbuf_read_byte(struct net_buf *buf,
-						 uint16_t offset,
-						 uint16_t *pos,
-						 uint8_t *data)
-{
-	if (data) {
-		*data = buf->data[offset];
-	}
-
-	*pos = offset + 1;
-
-	if (*pos >= buf->len) {
-		*pos = 0;
-
-		return buf->frags;
-	}
-
-	return buf;
-}
-
 /* Helper function to adjust offset in net_nbuf_read() call
  * if given offset is more than current fragment length.
  */
@@ -1016,24 +1143,36 @@ static inline struct net_buf *adjust_offset(struct net_buf *buf,
 struct net_buf *net_nbuf_read(struct net_buf *buf, uint16_t offset,
 			      uint16_t *pos, uint16_t len, uint8_t *data)
 {
-	uint16_t copy = 0;
-
 	buf = adjust_offset(buf, offset, pos);
 	if (!buf) {
 		goto error;
 	}
 
-	while (len-- > 0 && buf) {
+	/* Copy fragment by fragment, the position stays in the fragment
+	 * returned so the next read continues from there.
+	 */
+	while (len > 0) {
+		uint16_t count = min(len, buf->len - *pos);
+
 		if (data) {
-			buf = net_nbuf_read_byte(buf, *pos, pos, data + copy++);
-		} else {
-			buf = net_nbuf_read_byte(buf, *pos, pos, NULL);
+			memcpy(data, buf->data + *pos, count);
+			data += count;
 		}
 
-		/* Error: Still reamining length to be read, but no data. */
-		if (!buf && len) {
-			NET_ERR("Not enough data to read");
-			goto error;
+		*pos += count;
+		len -= count;
+
+		if (*pos >= buf->len) {
+			*pos = 0;
+			buf = buf->frags;
+
+			/* Error: Still reamining length to be read, but no
+			 * data.
+			 */
+			if (!buf && len) {
+				NET_ERR("Not enough data to read");
+				goto error;
+			}
 		}
 	}
 
@@ -1071,6 +1210,183 @@ struct net_buf *net_nbuf_read_be32(struct net_buf *buf, uint16_t offset,
 	return retbuf;
 }
 
+/* Move the cursor out of the fragments it is at the end of */
+static inline void view_normalize(struct net_nbuf_view *view)
+{
+	while (view->frag && (view->pos > view->frag->len ||
+			      (view->len && view->pos == view->frag->len))) {
+		view->pos -= view->frag->len;
+		view->frag = view->frag->frags;
+	}
+}
+
+int net_nbuf_view_init(struct net_nbuf_view *view, struct net_buf *frag,
+		       uint16_t offset, uint16_t len)
+{
+	struct net_buf *tmp;
+	size_t avail = 0;
+
+	for (tmp = frag; tmp; tmp = tmp->frags) {
+		avail += tmp->len;
+	}
+
+	if (avail < (size_t)offset + len) {
+		return -ENODATA;
+	}
+
+	view->frag = frag;
+	view->pos = offset;
+	view->len = len;
+
+	view_normalize(view);
+
+	return 0;
+}
+
+int net_nbuf_view_appdata(struct net_nbuf_view *view, struct net_buf *buf)
+{
+	uint8_t *appdata = net_nbuf_appdata(buf);
+	struct net_buf *frag = buf->frags;
+
+	while (frag && (appdata < frag->data ||
+			appdata > frag->data + frag->len)) {
+		frag = frag->frags;
+	}
+
+	if (!frag) {
+		return -ENODATA;
+	}
+
+	return net_nbuf_view_init(view, frag, appdata - frag->data,
+				  net_nbuf_appdatalen(buf));
+}
+
+int net_nbuf_view_advance(struct net_nbuf_view *view, uint16_t len)
+{
+	if (len > view->len) {
+		return -ENODATA;
+	}
+
+	while (len) {
+		uint16_t count = min(view->frag->len - view->pos, len);
+
+		view->pos += count;
+		view->len -= count;
+		len -= count;
+
+		if (view->pos == view->frag->len && view->len) {
+			view->frag = view->frag->frags;
+			view->pos = 0;
+		}
+	}
+
+	view_normalize(view);
+
+	return 0;
+}
+
+int net_nbuf_view_peek(const struct net_nbuf_view *view, uint16_t offset,
+		       void *data, uint16_t len)
+{
+	struct net_nbuf_view tmp = *view;
+
+	if (net_nbuf_view_advance(&tmp, offset) < 0) {
+		return -ENODATA;
+	}
+
+	return net_nbuf_view_read(&tmp, data, len);
+}
+
+int net_nbuf_view_read(struct net_nbuf_view *view, void *data, uint16_t len)
+{
+	uint8_t *ptr = data;
+
+	if (len > view->len) {
+		return -ENODATA;
+	}
+
+	while (len) {
+		uint16_t count = min(view->frag->len - view->pos, len);
+
+		if (ptr) {
+			memcpy(ptr, view->frag->data + view->pos, count);
+			ptr += count;
+		}
+
+		net_nbuf_view_advance(view, count);
+		len -= count;
+	}
+
+	return 0;
+}
+
+int net_nbuf_view_read_u8(struct net_nbuf_view *view, uint8_t *value)
+{
+	return net_nbuf_view_read(view, value, sizeof(*value));
+}
+
+/* The fields mostly are in one fragment, only copy them when they are not */
+static uint8_t *view_field(struct net_nbuf_view *view, uint8_t *tmp,
+			   uint16_t len)
+{
+	uint8_t *ptr;
+	uint16_t span;
+
+	ptr = net_nbuf_view_span(view, &span);
+	if (span >= len) {
+		net_nbuf_view_advance(view, len);
+		return ptr;
+	}
+
+	if (net_nbuf_view_read(view, tmp, len) < 0) {
+		return NULL;
+	}
+
+	return tmp;
+}
+
+int net_nbuf_view_read_be16(struct net_nbuf_view *view, uint16_t *value)
+{
+	uint8_t tmp[sizeof(uint16_t)];
+	uint8_t *ptr;
+
+	ptr = view_field(view, tmp, sizeof(tmp));
+	if (!ptr) {
+		return -ENODATA;
+	}
+
+	*value = sys_get_be16(ptr);
+
+	return 0;
+}
+
+int net_nbuf_view_read_be32(struct net_nbuf_view *view, uint32_t *value)
+{
+	uint8_t tmp[sizeof(uint32_t)];
+	uint8_t *ptr;
+
+	ptr = view_field(view, tmp, sizeof(tmp));
+	if (!ptr) {
+		return -ENODATA;
+	}
+
+	*value = sys_get_be32(ptr);
+
+	return 0;
+}
+
+void net_nbuf_view_release(struct net_buf *buf, struct net_nbuf_view *view)
+{
+	while (buf->frags && buf->frags != view->frag) {
+		net_buf_frag_del(buf, buf->frags);
+	}
+
+	if (view->frag) {
+		net_buf_pull(view->frag, view->pos);
+		view->pos = 0;
+	}
+}
+
 static inline struct net_buf *check_and_create_data(struct net_buf *buf,
 						    struct net_buf *data)
 {
@@ -1080,7 +1396,7 @@ static inline struct net_buf *check_and_create_data(struct net_buf *buf,
 		return data;
 	}
 
-	frag = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
+	frag = get_frag(buf, net_nbuf_ll_reserve(buf));
 	if (!frag) {
 		return NULL;
 	}
@@ -1216,7 +1532,7 @@ struct net_buf *net_nbuf_write(struct net_buf *buf, struct net_buf *frag,
 		frag = frag->frags;
 
 		if (!frag) {
-			frag = net_nbuf_get_reserve_data(ll_reserve);
+			frag = get_frag(buf, ll_reserve);
 			if (!frag) {
 				goto error;
 			}
@@ -1265,7 +1581,7 @@ static inline bool insert_data(struct net_buf *buf, struct net_buf *frag,
 		data += count;
 		offset = 0;
 
-		insert = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
+		insert = get_frag(buf, net_nbuf_ll_reserve(buf));
 		if (!insert) {
 			return false;
 		}
@@ -1336,7 +1652,7 @@ bool net_nbuf_insert(struct net_buf *buf, struct net_buf *frag,
 	 */
 	bytes = frag->len - offset;
 	if (bytes) {
-		temp = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
+		temp = get_frag(buf, net_nbuf_ll_reserve(buf));
 		if (!temp) {
 			return false;
 		}
@@ -1369,6 +1685,10 @@ void net_nbuf_get_info(size_t *tx_size, size_t *rx_size, size_t *data_size,
 	*tx = get_frees(&tx_buffers);
 	*rx = get_frees(&rx_buffers);
 	*data = get_frees(&data_buffers);
+#elif defined(CONFIG_NET_BUF_POOL_USAGE)
+	*tx = tx_buffers.buf_count - tx_buffers.stats.used;
+	*rx = rx_buffers.buf_count - rx_buffers.stats.used;
+	*data = data_buffers.buf_count - data_buffers.stats.used;
 #else
 	*tx = BIT(31);
 	*rx = BIT(31);
@@ -1387,6 +1707,15 @@ void net_nbuf_print(void)
 }
 #endif /* CONFIG_NET_DEBUG_NET_BUF */
 
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+void net_nbuf_foreach_pool(net_nbuf_pool_cb_t cb, void *user_data)
+{
+	cb(&rx_buffers, "RX", user_data);
+	cb(&tx_buffers, "TX", user_data);
+	cb(&data_buffers, "DATA", user_data);
+}
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+
 void net_nbuf_init(void)
 {
 	NET_DBG("Allocating %u RX (%zu bytes), %u TX (%zu bytes) "
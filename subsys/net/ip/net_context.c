@@ -32,16 +32,27 @@
 #include "ipv4.h"
 #include "udp.h"
 #include "tcp.h"
+#include "net_stats.h"
 
 #define NET_MAX_CONTEXT CONFIG_NET_MAX_CONTEXTS
 
 static struct net_context contexts[NET_MAX_CONTEXT];
 
+/* Unused contexts, allocated without scanning the array */
+static sys_slist_t free_contexts;
+
 /* We need to lock the contexts array as these APIs are typically called
  * from applications which are usually run in task context.
  */
 static struct k_sem contexts_lock;
 
+#if defined(CONFIG_NET_CONTEXT_UDP_CACHE)
+/* Forgets the headers cached for the peer */
+#define udp_cache_clear(context) ((context)->udp_cache.hdr_len = 0)
+#else
+#define udp_cache_clear(...)
+#endif
+
 enum net_verdict packet_received(struct net_conn *conn,
 				 struct net_buf *buf,
 				 void *user_data);
@@ -84,7 +95,9 @@ int net_context_get(sa_family_t family,
 		    enum net_ip_protocol ip_proto,
 		    struct net_context **context)
 {
-	int i, ret = -ENOENT;
+	struct net_context *ctx;
+	sys_snode_t *node;
+	int ret = -ENOENT;
 
 #if defined(CONFIG_NET_CONTEXT_CHECK)
 
@@ -165,45 +178,54 @@ int net_context_get(sa_family_t family,
 
 	k_sem_take(&contexts_lock, K_FOREVER);
 
-	for (i = 0; i < NET_MAX_CONTEXT; i++) {
-		if (net_context_is_used(&contexts[i])) {
-			continue;
-		}
+	node = sys_slist_get(&free_contexts);
+	if (!node) {
+		goto out;
+	}
+
+	ctx = CONTAINER_OF(node, struct net_context, node);
 
 #if defined(CONFIG_NET_TCP)
-		if (ip_proto == IPPROTO_TCP) {
-			contexts[i].tcp = net_tcp_alloc(&contexts[i]);
-			if (!contexts[i].tcp) {
-				NET_ASSERT_INFO(contexts[i].tcp,
-						"Cannot allocate TCP context");
-				return -ENOBUFS;
-			}
+	if (ip_proto == IPPROTO_TCP) {
+		ctx->tcp = net_tcp_alloc(ctx);
+		if (!ctx->tcp) {
+			NET_ASSERT_INFO(ctx->tcp, "Cannot allocate TCP context");
+			sys_slist_prepend(&free_contexts, node);
+			ret = -ENOBUFS;
+			goto out;
 		}
+	}
 #endif /* CONFIG_NET_TCP */
 
-		contexts[i].flags = 0;
+	ctx->flags = 0;
 
-		net_context_set_family(&contexts[i], family);
-		net_context_set_type(&contexts[i], type);
-		net_context_set_ip_proto(&contexts[i], ip_proto);
+	net_context_set_family(ctx, family);
+	net_context_set_type(ctx, type);
+	net_context_set_ip_proto(ctx, ip_proto);
 
-		contexts[i].flags |= NET_CONTEXT_IN_USE;
-		contexts[i].iface = 0;
+	ctx->flags |= NET_CONTEXT_IN_USE;
+	ctx->iface = 0;
+	ctx->priority = NET_PRIORITY_BE;
 
-		memset(&contexts[i].remote, 0, sizeof(struct sockaddr));
-		memset(&contexts[i].local, 0, sizeof(struct sockaddr_ptr));
+#if defined(CONFIG_NET_CONTEXT_NBUF_POOL)
+	ctx->tx_pool = NULL;
+	ctx->data_pool = NULL;
+#endif /* CONFIG_NET_CONTEXT_NBUF_POOL */
+
+	memset(&ctx->remote, 0, sizeof(struct sockaddr));
+	memset(&ctx->local, 0, sizeof(struct sockaddr_ptr));
+	udp_cache_clear(ctx);
 
 #if defined(CONFIG_NET_CONTEXT_SYNC_RECV)
-		k_sem_init(&contexts[i].recv_data_wait, 0, UINT_MAX);
-		k_sem_give(&contexts[i].recv_data_wait);
+	k_sem_init(&ctx->recv_data_wait, 0, UINT_MAX);
+	k_sem_give(&ctx->recv_data_wait);
 #endif /* CONFIG_NET_CONTEXT_SYNC_RECV */
 
-		*context = &contexts[i];
+	*context = ctx;
 
-		ret = 0;
-		break;
-	}
+	ret = 0;
 
+out:
 	k_sem_give(&contexts_lock);
 
 #if defined(CONFIG_NET_L2_OFFLOAD_IP)
@@ -217,7 +239,10 @@ int net_context_get(sa_family_t family,
 					    ip_proto,
 					    context);
 		if (ret < 0) {
+			k_sem_take(&contexts_lock, K_FOREVER);
 			(*context)->flags &= ~NET_CONTEXT_IN_USE;
+			sys_slist_prepend(&free_contexts, &(*context)->node);
+			k_sem_give(&contexts_lock);
 			*context = NULL;
 		}
 
@@ -234,6 +259,7 @@ static inline int send_fin(struct net_context *context,
 static enum net_verdict tcp_active_close(struct net_conn *conn,
 					 struct net_buf *buf,
 					 void *user_data);
+static void syn_cache_flush(struct net_context *listener);
 
 static bool send_fin_if_active_close(struct net_context *context)
 {
@@ -242,6 +268,9 @@ static bool send_fin_if_active_close(struct net_context *context)
 	switch (net_tcp_get_state(context->tcp)) {
 	case NET_TCP_SYN_RCVD:
 	case NET_TCP_ESTABLISHED:
+		/* The data held back by the Nagle algorithm goes first */
+		net_tcp_push(context);
+
 		/* Sending a packet with the FIN flag automatically
 		 * transitions to FIN_WAIT_1
 		 */
@@ -265,9 +294,16 @@ int net_context_put(struct net_context *context)
 
 	k_sem_take(&contexts_lock, K_FOREVER);
 
+	if (!net_context_is_used(context)) {
+		k_sem_give(&contexts_lock);
+		return -EBADF;
+	}
+
 #if defined(CONFIG_NET_L2_OFFLOAD_IP)
 	if (net_if_is_ip_offloaded(net_context_get_iface(context))) {
 		context->flags &= ~NET_CONTEXT_IN_USE;
+		sys_slist_prepend(&free_contexts, &context->node);
+		k_sem_give(&contexts_lock);
 		return net_l2_offload_ip_put(
 			net_context_get_iface(context), context);
 	}
@@ -282,6 +318,7 @@ int net_context_put(struct net_context *context)
 		}
 
 		if (context->tcp) {
+			syn_cache_flush(context);
 			net_tcp_release(context->tcp);
 		}
 	}
@@ -292,6 +329,7 @@ int net_context_put(struct net_context *context)
 	}
 
 	context->flags &= ~NET_CONTEXT_IN_USE;
+	sys_slist_prepend(&free_contexts, &context->node);
 
 #if defined(CONFIG_NET_TCP)
 still_in_use:
@@ -364,6 +402,8 @@ int net_context_bind(struct net_context *context, const struct sockaddr *addr,
 	NET_ASSERT(addr);
 	NET_ASSERT(PART_OF_ARRAY(contexts, context));
 
+	udp_cache_clear(context);
+
 #if defined(CONFIG_NET_IPV6)
 	if (addr->family == AF_INET6) {
 		struct net_if *iface;
@@ -524,8 +564,6 @@ static inline struct net_context *find_context(void *conn_handler)
 
 int net_context_listen(struct net_context *context, int backlog)
 {
-	ARG_UNUSED(backlog);
-
 	NET_ASSERT(PART_OF_ARRAY(contexts, context));
 
 	if (!net_context_is_used(context)) {
@@ -541,6 +579,9 @@ int net_context_listen(struct net_context *context, int backlog)
 
 #if defined(CONFIG_NET_TCP)
 	if (net_context_get_ip_proto(context) == IPPROTO_TCP) {
+		context->tcp->backlog = min(max(backlog, 1),
+					     CONFIG_NET_TCP_SYN_CACHE_SIZE);
+
 		net_tcp_change_state(context->tcp, NET_TCP_LISTEN);
 		net_context_set_state(context, NET_CONTEXT_LISTENING);
 
@@ -638,15 +679,16 @@ static inline int send_fin_ack(struct net_context *context,
 }
 
 static inline int send_ack(struct net_context *context,
-			   struct sockaddr *remote)
+			   struct sockaddr *remote, bool force)
 {
 	struct net_buf *buf = NULL;
 	int ret;
 
 	/* Something (e.g. a data transmission under the user
-	 * callback) already sent the ACK, no need
+	 * callback) already sent the ACK, no need, unless a duplicate
+	 * ACK is wanted.
 	 */
-	if (context->tcp->send_ack == context->tcp->sent_ack) {
+	if (!force && context->tcp->send_ack == context->tcp->sent_ack) {
 		return 0;
 	}
 
@@ -731,8 +773,11 @@ static enum net_verdict tcp_established(struct net_conn *conn,
 					void *user_data)
 {
 	struct net_context *context = (struct net_context *)user_data;
+	struct net_buf *next;
 	enum net_verdict ret;
+	bool filled = false;
 	uint8_t tcp_flags;
+	uint32_t seq;
 
 	NET_ASSERT(context && context->tcp);
 
@@ -744,25 +789,53 @@ static enum net_verdict tcp_established(struct net_conn *conn,
 
 	net_tcp_print_recv_info("DATA", buf, NET_TCP_BUF(buf)->src_port);
 
+	set_appdata_values(buf, IPPROTO_TCP, net_buf_frags_len(buf));
+
 	tcp_flags = NET_TCP_FLAGS(buf);
 	if (tcp_flags & NET_TCP_ACK) {
-		net_tcp_ack_received(context,
-				     sys_get_be32(NET_TCP_BUF(buf)->ack));
+		net_tcp_ack_received(context, buf);
 	}
 
-	if (sys_get_be32(NET_TCP_BUF(buf)->seq) - context->tcp->send_ack) {
-		/* Don't try to reorder packets.  If it doesn't
-		 * match the next segment exactly, drop and wait for
-		 * retransmit
+	seq = sys_get_be32(NET_TCP_BUF(buf)->seq);
+	if (seq != context->tcp->send_ack) {
+		if (!net_nbuf_appdatalen(buf)) {
+			return NET_DROP;
+		}
+
+		/* Keep data following a hole for when the missing
+		 * segment is retransmitted, and tell the peer what is
+		 * missing with a duplicate ACK.  Partially duplicated
+		 * segments are not trimmed: they are dropped like
+		 * fully duplicated ones, for the peer to retransmit.
 		 */
-		return NET_DROP;
+		ret = NET_DROP;
+		if (!(tcp_flags & NET_TCP_FIN) &&
+		    net_tcp_queue_ooo(context->tcp, buf)) {
+			ret = NET_OK;
+		}
+
+		send_ack(context, &conn->remote_addr, true);
+
+		return ret;
 	}
 
-	set_appdata_values(buf, IPPROTO_TCP, net_buf_frags_len(buf));
 	context->tcp->send_ack += net_nbuf_appdatalen(buf);
 
 	ret = packet_received(conn, buf, context->tcp->recv_user_data);
 
+	/* The segment may have filled a hole: deliver the data queued
+	 * after it.
+	 */
+	while ((next = net_tcp_get_ooo(context->tcp))) {
+		context->tcp->send_ack += net_nbuf_appdatalen(next);
+		filled = true;
+
+		if (packet_received(conn, next,
+				    context->tcp->recv_user_data) == NET_DROP) {
+			net_nbuf_unref(next);
+		}
+	}
+
 	if (tcp_flags & NET_TCP_FIN) {
 		/* Sending an ACK in the CLOSE_WAIT state will transition to
 		 * LAST_ACK state
@@ -779,11 +852,27 @@ static enum net_verdict tcp_established(struct net_conn *conn,
 		}
 	}
 
-	send_ack(context, &conn->remote_addr);
+	/* The peer is told at once that a hole was filled or that we
+	 * are closing, other data may wait for a piggybacked ACK.
+	 */
+	if (filled || (tcp_flags & NET_TCP_FIN) ||
+	    !net_tcp_delay_ack(context->tcp)) {
+		send_ack(context, &conn->remote_addr, false);
+	}
 
 	return ret;
 }
 
+/* Only the addresses and sequence numbers of a connection in TIME_WAIT
+ * are kept, its contexts and buffers are released at once. The
+ * application has put the context already, this is an active close.
+ */
+static void tcp_time_wait(struct net_context *context)
+{
+	net_tcp_time_wait(context->tcp);
+	net_context_put(context);
+}
+
 static enum net_verdict tcp_active_close(struct net_conn *conn,
 					 struct net_buf *buf,
 					 void *user_data)
@@ -795,14 +884,19 @@ static enum net_verdict tcp_active_close(struct net_conn *conn,
 
 	tcp = context->tcp;
 
+	if (NET_TCP_FLAGS(buf) & NET_TCP_FIN) {
+		/* The FIN takes a sequence number to acknowledge */
+		tcp->send_ack = sys_get_be32(NET_TCP_BUF(buf)->seq) + 1;
+	}
+
 	if (NET_TCP_FLAGS(buf) == NET_TCP_FIN) {
 		if (net_tcp_get_state(tcp) == NET_TCP_FIN_WAIT_1 ||
 		    net_tcp_get_state(tcp) == NET_TCP_FIN_WAIT_2) {
 			/* Sending an ACK in FIN_WAIT_1 will transition
 			 * to CLOSING, and to TIME_WAIT if on FIN_WAIT_2
 			 */
-			send_ack(context, &context->remote);
-			return NET_DROP;
+			send_ack(context, &context->remote, false);
+			goto done;
 		}
 	} else if (NET_TCP_FLAGS(buf) == NET_TCP_ACK) {
 		if (net_tcp_get_state(tcp) == NET_TCP_FIN_WAIT_1) {
@@ -812,17 +906,29 @@ static enum net_verdict tcp_active_close(struct net_conn *conn,
 
 		if (net_tcp_get_state(tcp) == NET_TCP_CLOSING) {
 			net_tcp_change_state(tcp, NET_TCP_TIME_WAIT);
-			return NET_DROP;
+			goto done;
 		}
 	} else if (NET_TCP_FLAGS(buf) == (NET_TCP_FIN | NET_TCP_ACK)) {
 		if (net_tcp_get_state(tcp) == NET_TCP_FIN_WAIT_1) {
 			send_fin_ack(context, &context->remote);
-			return NET_DROP;
+			goto done;
+		}
+
+		if (net_tcp_get_state(tcp) == NET_TCP_FIN_WAIT_2) {
+			send_ack(context, &context->remote, false);
+			goto done;
 		}
 	}
 
 	NET_DBG("Context %p in wrong state %d", context, tcp->state);
 	return NET_DROP;
+
+done:
+	if (net_tcp_get_state(tcp) == NET_TCP_TIME_WAIT) {
+		tcp_time_wait(context);
+	}
+
+	return NET_DROP;
 }
 
 static enum net_verdict tcp_synack_received(struct net_conn *conn,
@@ -852,6 +958,9 @@ static enum net_verdict tcp_synack_received(struct net_conn *conn,
 		context->tcp->send_ack =
 			sys_get_be32(NET_TCP_BUF(buf)->seq) + 1;
 		context->tcp->recv_max_ack = context->tcp->send_seq + 1;
+
+		net_tcp_parse_syn_opt(context->tcp, buf);
+		net_tcp_update_send_wnd(context->tcp, buf);
 	}
 	/*
 	 * If we receive SYN, we send SYN-ACK and go to SYN_RCVD state.
@@ -927,7 +1036,7 @@ static enum net_verdict tcp_synack_received(struct net_conn *conn,
 		net_tcp_change_state(context->tcp, NET_TCP_ESTABLISHED);
 		net_context_set_state(context, NET_CONTEXT_CONNECTED);
 
-		send_ack(context, raddr);
+		send_ack(context, raddr, false);
 
 		k_sem_give(&context->tcp->connect_wait);
 	}
@@ -960,6 +1069,8 @@ int net_context_connect(struct net_context *context,
 		return -ENOENT;
 	}
 
+	udp_cache_clear(context);
+
 	if (addr->family != net_context_get_family(context)) {
 		NET_ASSERT_INFO(addr->family == \
 				net_context_get_family(context),
@@ -1126,18 +1237,118 @@ int net_context_connect(struct net_context *context,
 
 #if defined(CONFIG_NET_TCP)
 
+/* Time a half-open connection waits for the ACK of our SYN-ACK */
 #define ACK_TIMEOUT MSEC_PER_SEC
 
-static void ack_timeout(struct k_work *work)
+struct syn_cache_entry {
+	/** Listening context, NULL if the entry is free */
+	struct net_context *listener;
+	struct net_tcp_syn syn;
+};
+
+static struct syn_cache_entry syn_cache[CONFIG_NET_TCP_SYN_CACHE_SIZE];
+
+static bool syn_cache_match(const struct sockaddr *addr1,
+			    const struct sockaddr *addr2)
 {
-	/* This means that we did not receive ACK response in time. */
-	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, ack_timer);
+	if (addr1->family != addr2->family) {
+		return false;
+	}
 
-	NET_DBG("Did not receive ACK in %dms", ACK_TIMEOUT);
+#if defined(CONFIG_NET_IPV6)
+	if (addr1->family == AF_INET6) {
+		return net_sin6(addr1)->sin6_port ==
+			net_sin6(addr2)->sin6_port &&
+			net_ipv6_addr_cmp(&net_sin6(addr1)->sin6_addr,
+					  &net_sin6(addr2)->sin6_addr);
+	}
+#endif
 
-	send_reset(tcp->context, &tcp->context->remote);
+#if defined(CONFIG_NET_IPV4)
+	if (addr1->family == AF_INET) {
+		return net_sin(addr1)->sin_port == net_sin(addr2)->sin_port &&
+			net_ipv4_addr_cmp(&net_sin(addr1)->sin_addr,
+					  &net_sin(addr2)->sin_addr);
+	}
+#endif
 
-	net_tcp_change_state(tcp, NET_TCP_LISTEN);
+	return false;
+}
+
+static struct syn_cache_entry *syn_cache_lookup(struct net_context *listener,
+						const struct sockaddr *remote)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(syn_cache); i++) {
+		if (syn_cache[i].listener == listener &&
+		    syn_cache_match(&syn_cache[i].syn.remote, remote)) {
+			return &syn_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+static inline void syn_cache_free(struct syn_cache_entry *entry)
+{
+	entry->listener = NULL;
+}
+
+/* Gets a free entry for a new half-open connection, within the backlog
+ * of the listener. Entries that waited for their ACK too long are
+ * reclaimed on the way: the peer gets a RST if it eventually sends it.
+ */
+static struct syn_cache_entry *syn_cache_alloc(struct net_context *listener,
+					       const struct sockaddr *remote)
+{
+	struct syn_cache_entry *entry = NULL;
+	uint32_t now = k_uptime_get_32();
+	int i, count = 0, key;
+
+	key = irq_lock();
+
+	for (i = 0; i < ARRAY_SIZE(syn_cache); i++) {
+		if (syn_cache[i].listener &&
+		    now - syn_cache[i].syn.timestamp >= ACK_TIMEOUT) {
+			NET_DBG("Did not receive ACK in %dms", ACK_TIMEOUT);
+			syn_cache_free(&syn_cache[i]);
+		}
+
+		if (!syn_cache[i].listener) {
+			if (!entry) {
+				entry = &syn_cache[i];
+			}
+		} else if (syn_cache[i].listener == listener) {
+			count++;
+		}
+	}
+
+	if (entry && count < listener->tcp->backlog) {
+		entry->listener = listener;
+		memcpy(&entry->syn.remote, remote, sizeof(*remote));
+	} else {
+		entry = NULL;
+	}
+
+	irq_unlock(key);
+
+	return entry;
+}
+
+static void syn_cache_flush(struct net_context *listener)
+{
+	int i, key;
+
+	key = irq_lock();
+
+	for (i = 0; i < ARRAY_SIZE(syn_cache); i++) {
+		if (syn_cache[i].listener == listener) {
+			syn_cache_free(&syn_cache[i]);
+		}
+	}
+
+	irq_unlock(key);
 }
 
 static void buf_get_sockaddr(sa_family_t family, struct net_buf *buf,
@@ -1176,73 +1387,71 @@ static enum net_verdict tcp_syn_rcvd(struct net_conn *conn,
 				     void *user_data)
 {
 	struct net_context *context = (struct net_context *)user_data;
+	struct syn_cache_entry *entry;
 	struct net_tcp *tcp;
 	struct sockaddr_ptr buf_src_addr;
+	struct sockaddr peer, *remote;
 
 	NET_ASSERT(context && context->tcp);
 
 	tcp = context->tcp;
 
-	switch (net_tcp_get_state(tcp)) {
-	case NET_TCP_LISTEN:
-		net_context_set_iface(context, net_nbuf_iface(buf));
-		break;
-	case NET_TCP_SYN_RCVD:
-		if (net_nbuf_iface(buf) != net_context_get_iface(context)) {
-			return NET_DROP;
-		}
-		break;
-	default:
+	if (net_tcp_get_state(tcp) != NET_TCP_LISTEN) {
 		NET_DBG("Context %p in wrong state %d",
 			context, tcp->state);
 		return NET_DROP;
 	}
 
+	net_context_set_iface(context, net_nbuf_iface(buf));
 	net_nbuf_set_context(buf, context);
 
 	NET_ASSERT(net_nbuf_iface(buf));
 
+	remote = create_sockaddr(buf, &peer);
+	if (!remote) {
+		return NET_DROP;
+	}
+
+	entry = syn_cache_lookup(context, remote);
+
 	/*
-	 * If we receive SYN, we send SYN-ACK and go to SYN_RCVD state.
+	 * If we receive SYN, we send SYN-ACK and keep the connection in
+	 * the SYN cache until its ACK. The listening TCP only serves to
+	 * prepare the SYN-ACK, and stays in LISTEN state.
 	 */
 	if (NET_TCP_FLAGS(buf) == NET_TCP_SYN) {
-		struct sockaddr peer, *remote;
-
 		net_tcp_print_recv_info("SYN", buf, NET_TCP_BUF(buf)->src_port);
 
-		net_tcp_change_state(tcp, NET_TCP_SYN_RCVD);
+		/* A retransmitted SYN gets the same SYN-ACK again */
+		if (!entry) {
+			entry = syn_cache_alloc(context, remote);
+			if (!entry) {
+				/* The peer retransmits the SYN later */
+				NET_DBG("Backlog full, SYN dropped");
+				return NET_DROP;
+			}
 
-		remote = create_sockaddr(buf, &peer);
+			net_tcp_syn_init(&entry->syn, buf);
+		}
 
-		/* FIXME: Is this the correct place to set tcp->send_ack? */
-		context->tcp->send_ack =
-			sys_get_be32(NET_TCP_BUF(buf)->seq) + 1;
-		context->tcp->recv_max_ack = context->tcp->send_seq + 1;
+		net_tcp_syn_load(tcp, &entry->syn);
 
 		buf_get_sockaddr(net_context_get_family(context),
 				 buf, &buf_src_addr);
 		send_syn_ack(context, &buf_src_addr, remote);
 
-		/* We might be entering this section multiple times
-		 * if the SYN is sent more than once. So we need to cancel
-		 * any pending timers.
-		 */
-		k_delayed_work_cancel(&tcp->ack_timer);
-		k_delayed_work_init(&tcp->ack_timer, ack_timeout);
-		k_delayed_work_submit(&tcp->ack_timer, ACK_TIMEOUT);
-
 		return NET_DROP;
 	}
 
 	/*
-	 * If we receive RST, we go back to LISTEN state.
+	 * If we receive RST, we forget the half-open connection.
 	 */
 	if (NET_TCP_FLAGS(buf) == NET_TCP_RST) {
-		k_delayed_work_cancel(&tcp->ack_timer);
-
 		net_tcp_print_recv_info("RST", buf, NET_TCP_BUF(buf)->src_port);
 
-		net_tcp_change_state(tcp, NET_TCP_LISTEN);
+		if (entry) {
+			syn_cache_free(entry);
+		}
 
 		return NET_DROP;
 	}
@@ -1254,23 +1463,23 @@ static enum net_verdict tcp_syn_rcvd(struct net_conn *conn,
 		struct net_context *new_context;
 		struct sockaddr local_addr;
 		struct sockaddr remote_addr;
-		struct net_tcp *tmp_tcp;
 		socklen_t addrlen;
 		int ret;
 
-		/* We can only receive ACK if we have already received SYN.
-		 * So if we are not in SYN_RCVD state, then it is an error.
+		/* We can only receive ACK if we have already received SYN,
+		 * and it must acknowledge our SYN-ACK.
 		 */
-		if (net_tcp_get_state(tcp) != NET_TCP_SYN_RCVD) {
-			k_delayed_work_cancel(&tcp->ack_timer);
-			NET_DBG("Not in SYN_RCVD state, sending RST");
+		if (!entry || sys_get_be32(NET_TCP_BUF(buf)->ack) !=
+		    entry->syn.iss + 1) {
+			NET_DBG("No matching SYN received, sending RST");
 			goto reset;
 		}
 
 		net_tcp_print_recv_info("ACK", buf, NET_TCP_BUF(buf)->src_port);
 
-		if (!context->tcp->accept_cb) {
+		if (!tcp->accept_cb) {
 			NET_DBG("No accept callback, connection reset.");
+			syn_cache_free(entry);
 			goto reset;
 		}
 
@@ -1282,12 +1491,20 @@ static enum net_verdict tcp_syn_rcvd(struct net_conn *conn,
 		if (ret < 0) {
 			NET_DBG("Cannot get accepted context, "
 				"connection reset");
+			syn_cache_free(entry);
 			goto reset;
 		}
 
-		new_context->tcp->recv_max_ack = context->tcp->recv_max_ack;
-		new_context->tcp->send_seq = context->tcp->send_seq;
-		new_context->tcp->send_ack = context->tcp->send_ack;
+		/* The SYN-ACK took one sequence number */
+		net_tcp_syn_load(new_context->tcp, &entry->syn);
+		new_context->tcp->send_seq = entry->syn.iss + 1;
+		syn_cache_free(entry);
+
+		/* Accepted connections inherit the options of the listener */
+		new_context->tcp->flags |= context->tcp->flags &
+			(NET_TCP_NODELAY | NET_TCP_QUICKACK);
+
+		net_tcp_update_send_wnd(new_context->tcp, buf);
 
 #if defined(CONFIG_NET_IPV6)
 		if (net_context_get_family(context) == AF_INET6) {
@@ -1365,27 +1582,10 @@ static enum net_verdict tcp_syn_rcvd(struct net_conn *conn,
 			goto reset;
 		}
 
-		/* Swap the newly-created TCP states with the one that
-		 * was used to establish this connection. The new TCP
-		 * must be listening to accept other connections.
-		 */
-		tmp_tcp = new_context->tcp;
-		tmp_tcp->accept_cb = tcp->accept_cb;
-		tcp->accept_cb = NULL;
-		new_context->tcp = tcp;
-		context->tcp = tmp_tcp;
-
-		tcp->context = new_context;
-		tmp_tcp->context = context;
-
-		net_tcp_change_state(tmp_tcp, NET_TCP_LISTEN);
-
 		net_tcp_change_state(new_context->tcp, NET_TCP_ESTABLISHED);
 		net_context_set_state(new_context, NET_CONTEXT_CONNECTED);
 
-		k_delayed_work_cancel(&tcp->ack_timer);
-
-		context->tcp->accept_cb(new_context,
+		tcp->accept_cb(new_context,
 					&new_context->remote,
 					addrlen,
 					0,
@@ -1395,11 +1595,7 @@ static enum net_verdict tcp_syn_rcvd(struct net_conn *conn,
 	return NET_DROP;
 
 reset:
-	{
-		struct sockaddr peer;
-
-		send_reset(tcp->context, create_sockaddr(buf, &peer));
-	}
+	send_reset(context, remote);
 
 	return NET_DROP;
 }
@@ -1516,14 +1712,21 @@ static int send_data(struct net_context *context,
 	context->user_data = user_data;
 	net_nbuf_set_token(buf, token);
 
-	if (!timeout || net_context_get_ip_proto(context) == IPPROTO_UDP) {
+	if (net_context_get_ip_proto(context) == IPPROTO_UDP) {
 		return net_send_data(buf);
 	}
 
 #if defined(CONFIG_NET_TCP)
 	if (net_context_get_ip_proto(context) == IPPROTO_TCP) {
+		/* The buffer belongs to the sent list now, it must only
+		 * be transmitted from there.
+		 */
 		int ret = net_tcp_send_data(context);
 
+		if (!timeout) {
+			return ret;
+		}
+
 		/* Just make the callback synchronously even if it didn't
 		 * go over the wire.  In theory it would be nice to track
 		 * specific ACK locations in the stream and make the
@@ -1613,11 +1816,166 @@ static inline struct net_buf *update_ll_reserve(struct net_buf *buf,
 }
 
 #if defined(CONFIG_NET_UDP)
+#if defined(CONFIG_NET_CONTEXT_UDP_CACHE)
+static uint32_t udp_cache_gen;
+
+void net_context_udp_cache_flush(void)
+{
+	udp_cache_gen++;
+}
+
+/* Neighbor the Ethernet L2 would look up for the packet, the other L2s
+ * resolving the link address themselves.
+ */
+static void udp_cache_nbr(struct net_context *context, struct net_buf *buf)
+{
+#if defined(CONFIG_NET_IPV6) && defined(CONFIG_NET_L2_ETHERNET) && \
+	!defined(CONFIG_NET_RPL)
+	struct net_if *iface = net_nbuf_iface(buf);
+	struct net_nbr *nbr;
+
+	if (context->udp_cache.loopback ||
+	    net_nbuf_family(buf) != AF_INET6 ||
+	    iface->l2 != &NET_L2_GET_NAME(ETHERNET) ||
+	    net_is_ipv6_addr_mcast(&NET_IPV6_BUF(buf)->dst)) {
+		return;
+	}
+
+	nbr = net_ipv6_nbr_lookup(iface, &NET_IPV6_BUF(buf)->dst);
+	if (nbr && nbr->idx != NET_NBR_LLADDR_UNKNOWN) {
+		context->udp_cache.nbr = nbr;
+	}
+#endif
+}
+
+static void udp_cache_fill(struct net_context *context, struct net_buf *buf)
+{
+	uint8_t len = net_nbuf_ip_hdr_len(buf) + sizeof(struct net_udp_hdr);
+
+	context->udp_cache.hdr_len = 0;
+
+	/* Extension headers, like the RPL and MPL ones, are per packet */
+	if (net_nbuf_ext_len(buf) || buf->frags->len < len ||
+	    len > sizeof(context->udp_cache.hdr)) {
+		return;
+	}
+
+	memcpy(context->udp_cache.hdr, buf->frags->data, len);
+	context->udp_cache.hdr_len = len;
+	context->udp_cache.iface = net_nbuf_iface(buf);
+	context->udp_cache.gen = udp_cache_gen;
+	context->udp_cache.loopback = net_nbuf_loopback(buf);
+	context->udp_cache.nbr = NULL;
+
+	udp_cache_nbr(context, buf);
+}
+
+/* Builds the packet from the headers of the previous datagram to the
+ * connected peer, patching only its lengths and checksums: the source
+ * address selection and the neighbor lookup are skipped.
+ */
+static bool udp_cache_create(struct net_context *context,
+			     struct net_buf *buf)
+{
+	struct net_buf *header;
+	uint16_t len;
+
+	if (!context->udp_cache.hdr_len ||
+	    context->udp_cache.gen != udp_cache_gen ||
+	    context->udp_cache.iface != net_nbuf_iface(buf) ||
+	    net_nbuf_family(buf) != net_context_get_family(context)) {
+		return false;
+	}
+
+	header = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf));
+
+	net_buf_frag_insert(buf, header);
+
+	memcpy(net_buf_add(header, context->udp_cache.hdr_len),
+	       context->udp_cache.hdr, context->udp_cache.hdr_len);
+
+	net_nbuf_set_ip_hdr_len(buf, context->udp_cache.hdr_len -
+				sizeof(struct net_udp_hdr));
+	net_nbuf_set_appdata(buf, net_nbuf_udp_data(buf) +
+			     sizeof(struct net_udp_hdr));
+
+	net_nbuf_compact(buf);
+
+	len = net_buf_frags_len(buf->frags);
+
+	NET_UDP_BUF(buf)->len = htons(len - net_nbuf_ip_hdr_len(buf));
+	NET_UDP_BUF(buf)->chksum = 0;
+
+#if defined(CONFIG_NET_LOOPBACK_FAST_PATH)
+	net_nbuf_set_loopback(buf, context->udp_cache.loopback);
+#endif
+
+#if defined(CONFIG_NET_IPV6)
+	if (net_nbuf_family(buf) == AF_INET6) {
+		NET_IPV6_BUF(buf)->vtc = 0x60 | (net_nbuf_priority(buf) << 1);
+
+		len -= sizeof(struct net_ipv6_hdr);
+		NET_IPV6_BUF(buf)->len[0] = len / 256;
+		NET_IPV6_BUF(buf)->len[1] = (uint8_t)len;
+	}
+#endif /* CONFIG_NET_IPV6 */
+
+#if defined(CONFIG_NET_IPV4)
+	if (net_nbuf_family(buf) == AF_INET) {
+		NET_IPV4_BUF(buf)->tos = net_nbuf_priority(buf) << 5;
+
+		NET_IPV4_BUF(buf)->len[0] = len / 256;
+		NET_IPV4_BUF(buf)->len[1] = (uint8_t)len;
+
+		NET_IPV4_BUF(buf)->chksum = 0;
+		if (!net_nbuf_tx_chksum_offloaded(buf)) {
+			NET_IPV4_BUF(buf)->chksum = ~net_calc_chksum_ipv4(buf);
+		}
+	}
+#endif /* CONFIG_NET_IPV4 */
+
+	if (!net_nbuf_tx_chksum_offloaded(buf)) {
+		NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+	}
+
+	/* The neighbor may have been resolved since the headers were built */
+	if (!context->udp_cache.nbr) {
+		udp_cache_nbr(context, buf);
+	}
+
+#if defined(CONFIG_NET_IPV6)
+	if (context->udp_cache.nbr) {
+		struct net_nbr *nbr = context->udp_cache.nbr;
+		struct net_linkaddr_storage *lladdr;
+
+		lladdr = net_nbr_get_lladdr(nbr->idx);
+
+		net_nbuf_ll_dst(buf)->addr = lladdr->addr;
+		net_nbuf_ll_dst(buf)->len = lladdr->len;
+
+		net_ipv6_nbr_data(nbr)->last_used = k_uptime_get_32();
+	}
+#endif /* CONFIG_NET_IPV6 */
+
+	return true;
+}
+#endif /* CONFIG_NET_CONTEXT_UDP_CACHE */
+
 static int create_udp_packet(struct net_context *context,
 			     struct net_buf *buf,
 			     const struct sockaddr *dst_addr,
 			     struct net_buf **out_buf)
 {
+#if defined(CONFIG_NET_CONTEXT_UDP_CACHE)
+	/* Connected context, sending to its peer */
+	if (dst_addr == &context->remote) {
+		if (udp_cache_create(context, buf)) {
+			*out_buf = buf;
+			return 0;
+		}
+	}
+#endif /* CONFIG_NET_CONTEXT_UDP_CACHE */
+
 #if defined(CONFIG_NET_IPV6)
 	if (net_nbuf_family(buf) == AF_INET6) {
 		struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)dst_addr;
@@ -1641,6 +1999,12 @@ static int create_udp_packet(struct net_context *context,
 		return -EPROTONOSUPPORT;
 	}
 
+#if defined(CONFIG_NET_CONTEXT_UDP_CACHE)
+	if (dst_addr == &context->remote) {
+		udp_cache_fill(context, buf);
+	}
+#endif /* CONFIG_NET_CONTEXT_UDP_CACHE */
+
 	*out_buf = buf;
 
 	return 0;
@@ -1730,6 +2094,8 @@ static int sendto(struct net_buf *buf,
 
 #if defined(CONFIG_NET_TCP)
 	if (net_context_get_ip_proto(context) == IPPROTO_TCP) {
+		/* Segments split off the buffer inherit its token */
+		net_nbuf_set_token(buf, token);
 		ret = net_tcp_queue_data(context, buf);
 	} else
 #endif /* CONFIG_NET_TCP */
@@ -1882,6 +2248,8 @@ enum net_verdict packet_received(struct net_conn *conn,
 			net_nbuf_appdata(buf), net_nbuf_appdatalen(buf),
 			total_len);
 
+		net_stats_update_latency(buf, NET_STATS_LATENCY_RX_DELIVER);
+
 		context->recv_cb(context, buf, 0, user_data);
 
 #if defined(CONFIG_NET_CONTEXT_SYNC_RECV)
@@ -2025,6 +2393,127 @@ int net_context_recv(struct net_context *context,
 	return 0;
 }
 
+int net_context_set_option(struct net_context *context,
+			   enum net_context_option option,
+			   const void *value, size_t len)
+{
+	NET_ASSERT(context);
+
+	if (!net_context_is_used(context)) {
+		return -EBADF;
+	}
+
+	switch (option) {
+	case NET_OPT_PRIORITY:
+		if (len != sizeof(uint8_t) ||
+		    *(uint8_t *)value >= NET_MAX_PRIORITIES) {
+			return -EINVAL;
+		}
+
+		context->priority = *(uint8_t *)value;
+		return 0;
+
+	case NET_OPT_TCP_NODELAY:
+	case NET_OPT_TCP_QUICKACK:
+#if defined(CONFIG_NET_TCP)
+	{
+		uint16_t flag = option == NET_OPT_TCP_NODELAY ?
+			NET_TCP_NODELAY : NET_TCP_QUICKACK;
+
+		if (!context->tcp || len != sizeof(int)) {
+			return -EINVAL;
+		}
+
+		if (!*(int *)value) {
+			context->tcp->flags &= ~flag;
+			return 0;
+		}
+
+		context->tcp->flags |= flag;
+
+		/* What was waiting goes now */
+		if (flag == NET_TCP_NODELAY) {
+			net_tcp_push(context);
+		} else if (net_tcp_get_state(context->tcp) ==
+			   NET_TCP_ESTABLISHED) {
+			send_ack(context, &context->remote, false);
+		}
+
+		return 0;
+	}
+#else
+		break;
+#endif /* CONFIG_NET_TCP */
+	}
+
+	return -EINVAL;
+}
+
+int net_context_get_option(struct net_context *context,
+			   enum net_context_option option,
+			   void *value, size_t *len)
+{
+	NET_ASSERT(context);
+
+	if (!net_context_is_used(context)) {
+		return -EBADF;
+	}
+
+	switch (option) {
+	case NET_OPT_PRIORITY:
+		if (*len < sizeof(uint8_t)) {
+			return -EINVAL;
+		}
+
+		*(uint8_t *)value = context->priority;
+		*len = sizeof(uint8_t);
+		return 0;
+
+	case NET_OPT_TCP_NODELAY:
+	case NET_OPT_TCP_QUICKACK:
+#if defined(CONFIG_NET_TCP)
+		if (!context->tcp || *len < sizeof(int)) {
+			return -EINVAL;
+		}
+
+		*(int *)value = !!(context->tcp->flags &
+				   (option == NET_OPT_TCP_NODELAY ?
+				    NET_TCP_NODELAY : NET_TCP_QUICKACK));
+		*len = sizeof(int);
+		return 0;
+#else
+		break;
+#endif /* CONFIG_NET_TCP */
+	}
+
+	return -EINVAL;
+}
+
+#if defined(CONFIG_NET_CONTEXT_NBUF_POOL)
+int net_context_setup_pools(struct net_context *context,
+			    struct net_buf_pool *tx_pool,
+			    struct net_buf_pool *data_pool)
+{
+	NET_ASSERT(context);
+
+	if (tx_pool && (tx_pool->buf_size ||
+			tx_pool->user_data_size < sizeof(struct net_nbuf))) {
+		return -EINVAL;
+	}
+
+	if (data_pool &&
+	    (data_pool->buf_size != CONFIG_NET_NBUF_DATA_SIZE ||
+	     data_pool->user_data_size < CONFIG_NET_NBUF_USER_DATA_SIZE)) {
+		return -EINVAL;
+	}
+
+	context->tx_pool = tx_pool;
+	context->data_pool = data_pool;
+
+	return 0;
+}
+#endif /* CONFIG_NET_CONTEXT_NBUF_POOL */
+
 void net_context_foreach(net_context_cb_t cb, void *user_data)
 {
 	int i;
@@ -2044,6 +2533,14 @@ void net_context_foreach(net_context_cb_t cb, void *user_data)
 
 void net_context_init(void)
 {
+	int i;
+
+	sys_slist_init(&free_contexts);
+
+	for (i = 0; i < NET_MAX_CONTEXT; i++) {
+		sys_slist_append(&free_contexts, &contexts[i].node);
+	}
+
 	k_sem_init(&contexts_lock, 0, UINT_MAX);
 
 	k_sem_give(&contexts_lock);
@@ -1,8 +1,9 @@
 /** @file
  * @brief Network initialization
  *
- * Initialize the network IP stack. Create one thread for reading data
- * from IP stack and passing that data to applications (Rx thread).
+ * Initialize the network IP stack. Create the threads reading data
+ * from the network interfaces and passing that data to applications
+ * (Rx threads).
  */
 
 /*
@@ -37,10 +38,12 @@
 
 #if defined(CONFIG_NET_IPV4)
 #include "icmpv4.h"
+#include "ipv4.h"
 #endif
 
 #include "route.h"
 #include "rpl.h"
+#include "mpl.h"
 
 #include "connection.h"
 #include "udp.h"
@@ -48,17 +51,58 @@
 
 #include "net_stats.h"
 
-/* Stack for the rx thread.
+/* Stacks for the rx threads.
  */
 #if !defined(CONFIG_NET_RX_STACK_SIZE)
 #define CONFIG_NET_RX_STACK_SIZE 1024
 #endif
 
-NET_STACK_DEFINE(RX, rx_stack, CONFIG_NET_RX_STACK_SIZE,
-		 CONFIG_NET_RX_STACK_SIZE + CONFIG_NET_RX_STACK_RPL);
+#if !defined(CONFIG_NET_RX_THREADS)
+#define CONFIG_NET_RX_THREADS 1
+#endif
+
+#define RX_STACK_SIZE (CONFIG_NET_RX_STACK_SIZE + CONFIG_NET_RX_STACK_RPL)
+
+#if defined(CONFIG_CCM_NET_RX)
+#define RX_CCM_NOINIT __ccm_noinit_section
+#define RX_CCM_BSS __ccm_bss_section
+#else
+#define RX_CCM_NOINIT __noinit
+#define RX_CCM_BSS
+#endif
+
+static unsigned char RX_CCM_NOINIT __stack
+rx_stack[CONFIG_NET_RX_THREADS][RX_STACK_SIZE];
+
+NET_STACK_INFO_ADDR(RX, rx_stack, CONFIG_NET_RX_STACK_SIZE, RX_STACK_SIZE,
+		    rx_stack[0], 0);
+#if CONFIG_NET_RX_THREADS > 1
+NET_STACK_INFO_ADDR(RX, rx_stack, CONFIG_NET_RX_STACK_SIZE, RX_STACK_SIZE,
+		    rx_stack[1], 1);
+#endif
+#if CONFIG_NET_RX_THREADS > 2
+NET_STACK_INFO_ADDR(RX, rx_stack, CONFIG_NET_RX_STACK_SIZE, RX_STACK_SIZE,
+		    rx_stack[2], 2);
+#endif
+#if CONFIG_NET_RX_THREADS > 3
+NET_STACK_INFO_ADDR(RX, rx_stack, CONFIG_NET_RX_STACK_SIZE, RX_STACK_SIZE,
+		    rx_stack[3], 3);
+#endif
+
+/* Each interface has its own RX queue, served by the RX thread whose index
+ * is the index of the interface modulo the number of threads. The semaphore
+ * of a thread counts the packets queued to its interfaces, and the thread
+ * serves these in turn, one packet at a time.
+ */
+struct rx_thread {
+	/* Given when packets are queued to the interfaces of the thread */
+	struct k_sem pending;
+};
 
-static struct k_fifo rx_queue;
-static k_tid_t rx_tid;
+static struct rx_thread RX_CCM_BSS rx_threads[CONFIG_NET_RX_THREADS];
+
+extern struct net_if __net_if_start[];
+extern struct net_if __net_if_end[];
 
 #if defined(CONFIG_NET_IPV6)
 static inline enum net_verdict process_icmpv6_pkt(struct net_buf *buf,
@@ -154,7 +198,7 @@ static inline struct net_buf *handle_ext_hdr_options(struct net_buf *buf,
 			 */
 #if defined(CONFIG_NET_RPL)
 			NET_DBG("Processing RPL option");
-			if (!net_rpl_verify_header(buf, *pos, pos)) {
+			if (!net_rpl_verify_header(buf, frag, *pos, pos)) {
 				NET_DBG("RPL option error, packet dropped");
 				*verdict = NET_DROP;
 
@@ -163,6 +207,18 @@ static inline struct net_buf *handle_ext_hdr_options(struct net_buf *buf,
 #endif
 			*verdict = NET_CONTINUE;
 			return frag;
+#if defined(CONFIG_NET_IPV6_MPL)
+		case NET_IPV6_EXT_HDR_OPT_MPL:
+			NET_DBG("Processing MPL option");
+			*verdict = net_mpl_input(buf, frag, *pos, opt_len);
+			if (*verdict == NET_DROP) {
+				return NULL;
+			}
+
+			/* Skip the rest of the header */
+			return net_nbuf_skip(frag, *pos, pos,
+					     len - length - 2);
+#endif
 		default:
 			if (!check_unknown_option(frag, opt_type, length)) {
 				*verdict = NET_DROP;
@@ -193,7 +249,8 @@ static inline enum net_verdict process_ipv6_pkt(struct net_buf *buf)
 	struct net_buf *frag;
 	uint8_t next, next_hdr, length;
 	uint8_t first_option;
-	uint16_t offset;
+	uint16_t offset, start;
+	uint16_t nexthdr_off = offsetof(struct net_ipv6_hdr, nexthdr);
 
 	if (real_len != pkt_len) {
 		NET_DBG("IPv6 packet size %d buf len %d", pkt_len, real_len);
@@ -210,6 +267,9 @@ static inline enum net_verdict process_ipv6_pkt(struct net_buf *buf)
 	} while (0);
 #endif /* CONFIG_NET_DEBUG_CORE */
 
+	/* Forwarded packets keep the priority of their traffic class */
+	net_nbuf_set_priority(buf, (hdr->vtc & 0x0e) >> 1);
+
 	if (net_is_ipv6_addr_mcast(&hdr->src)) {
 		NET_DBG("Dropping src multicast packet");
 		net_stats_update_ipv6_drop();
@@ -260,6 +320,8 @@ static inline enum net_verdict process_ipv6_pkt(struct net_buf *buf)
 	while (frag) {
 		enum net_verdict verdict;
 
+		start = offset;
+
 		frag = net_nbuf_read_u8(frag, offset, &offset, &next_hdr);
 		frag = net_nbuf_read_u8(frag, offset, &offset, &length);
 		if (!frag) {
@@ -323,6 +385,38 @@ static inline enum net_verdict process_ipv6_pkt(struct net_buf *buf)
 
 			break;
 
+#if defined(CONFIG_NET_RPL_MOP1)
+		case NET_IPV6_NEXTHDR_ROUTING:
+			if (net_nbuf_ext_bitmap(buf) &
+			    NET_IPV6_EXT_HDR_BITMAP_ROUTING) {
+				goto bad_hdr;
+			}
+
+			net_nbuf_add_ext_bitmap(
+				buf, NET_IPV6_EXT_HDR_BITMAP_ROUTING);
+
+			verdict = net_rpl_srh_input(buf, frag, offset, length);
+			if (verdict != NET_CONTINUE) {
+				return verdict;
+			}
+
+			/* Skip the rest of the header */
+			frag = net_nbuf_skip(frag, offset, &offset,
+					     length - 2);
+			break;
+#endif
+
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+		case NET_IPV6_NEXTHDR_FRAG:
+			verdict = net_ipv6_reassemble(buf, start, nexthdr_off);
+			if (verdict != NET_CONTINUE) {
+				return verdict;
+			}
+
+			/* The packet is complete, process it from the start */
+			return process_ipv6_pkt(buf);
+#endif
+
 		/* The next header after the extensions can be also
 		 * one of the main protocols.
 		 */
@@ -357,6 +451,7 @@ static inline enum net_verdict process_ipv6_pkt(struct net_buf *buf)
 		}
 
 		next = next_hdr;
+		nexthdr_off = start;
 	}
 
 drop:
@@ -414,6 +509,15 @@ static inline enum net_verdict process_ipv4_pkt(struct net_buf *buf)
 
 	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv4_hdr));
 
+#if defined(CONFIG_NET_RX_CHKSUM)
+	if (!net_nbuf_rx_chksum_offloaded(buf) &&
+	    net_calc_chksum_ipv4(buf) != 0xffff) {
+		NET_DBG("IPv4 header checksum of buf %p is wrong", buf);
+		net_stats_update_ip_errors_chkerr();
+		goto drop;
+	}
+#endif
+
 	if (!net_is_my_ipv4_addr(&hdr->dst)) {
 #if defined(CONFIG_NET_DHCPV4)
 		if (hdr->proto == IPPROTO_UDP &&
@@ -430,6 +534,24 @@ static inline enum net_verdict process_ipv4_pkt(struct net_buf *buf)
 		goto drop;
 	}
 
+	if (net_ipv4_is_fragment(hdr)) {
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+		verdict = net_ipv4_reassemble(buf);
+		if (verdict == NET_OK) {
+			return verdict;
+		} else if (verdict == NET_DROP) {
+			goto drop;
+		}
+
+		hdr = NET_IPV4_BUF(buf);
+		verdict = NET_DROP;
+#else
+		NET_DBG("IPv4 fragment in buf %p not supported", buf);
+		net_stats_update_ip_errors_fragerr();
+		goto drop;
+#endif
+	}
+
 	switch (hdr->proto) {
 	case IPPROTO_ICMP:
 		verdict = process_icmpv4_pkt(buf, hdr);
@@ -516,46 +638,114 @@ static void processing_data(struct net_buf *buf, bool is_loopback)
 	case NET_DROP:
 	default:
 		NET_DBG("Dropping buf %p", buf);
+		net_stats_update_iface_rx_drop(net_nbuf_iface(buf));
 		net_nbuf_unref(buf);
 		break;
 	}
 }
 
-static void net_rx_thread(void)
+static inline struct rx_thread *iface_rx_thread(struct net_if *iface)
+{
+	return &rx_threads[net_if_get_by_iface(iface) % CONFIG_NET_RX_THREADS];
+}
+
+/* Process up to CONFIG_NET_RX_BATCH packets queued to an interface, returns
+ * the number of packets processed.
+ */
+static int rx_iface_batch(struct net_if *iface)
 {
 	struct net_buf *buf;
+	int count;
+
+	for (count = 0; count < CONFIG_NET_RX_BATCH; count++) {
+		buf = net_buf_get(&iface->rx_queue, K_NO_WAIT);
+		if (!buf) {
+			break;
+		}
+
+		atomic_dec(&iface->rx_queue_len);
+
+		net_stats_update_latency(buf, NET_STATS_LATENCY_RX_QUEUE);
+
+		NET_DBG("Received buf %p len %zu", buf,
+			net_buf_frags_len(buf));
+
+		processing_data(buf, false);
+	}
 
-	NET_DBG("Starting RX thread (stack %zu bytes)", sizeof(rx_stack));
+	return count;
+}
+
+static void net_rx_thread(struct rx_thread *rx)
+{
+	int id = rx - rx_threads;
+	struct net_if *iface;
+	int count;
+
+	NET_DBG("Starting RX thread %d (stack %zu bytes)", id,
+		sizeof(rx_stack[0]));
 
 	/* Starting TX side. The ordering is important here and the TX
 	 * can only be started when RX side is ready to receive packets.
 	 */
-	net_if_init();
+	if (rx == rx_threads) {
+		net_if_init();
+	}
 
 	while (1) {
-		buf = net_buf_get(&rx_queue, K_FOREVER);
+		k_sem_take(&rx->pending, K_FOREVER);
 
-		net_analyze_stack("RX thread", rx_stack, sizeof(rx_stack));
+		/* Serve the interfaces of the thread in turn, a batch of
+		 * packets each, until all their queues are empty. Packets
+		 * queued meanwhile give the semaphore again, so none is
+		 * left behind.
+		 */
+		do {
+			count = 0;
 
-		NET_DBG("Received buf %p len %zu", buf,
-			net_buf_frags_len(buf));
+			for (iface = __net_if_start + id; iface < __net_if_end;
+			     iface += CONFIG_NET_RX_THREADS) {
+				count += rx_iface_batch(iface);
+			}
 
-		processing_data(buf, false);
+			net_analyze_stack("RX thread", rx_stack[id],
+					  sizeof(rx_stack[0]));
 
-		net_print_statistics();
-		net_nbuf_print();
+			net_print_statistics();
+			net_nbuf_print();
 
-		k_yield();
+			k_yield();
+		} while (count);
 	}
 }
 
 static void init_rx_queue(void)
 {
-	k_fifo_init(&rx_queue);
+	struct net_if *iface;
+	int i, count;
+
+	for (iface = __net_if_start; iface != __net_if_end; iface++) {
+		k_fifo_init(&iface->rx_queue);
+		atomic_set(&iface->rx_queue_len, 0);
+	}
+
+	/* There is no need for more threads than interfaces */
+	count = min(CONFIG_NET_RX_THREADS, __net_if_end - __net_if_start);
+	if (!count) {
+		count = 1;
+	}
+
+	/* The first thread initializes the interfaces, so it is started
+	 * last, once all the threads are ready to receive packets.
+	 */
+	for (i = count - 1; i >= 0; i--) {
+		k_sem_init(&rx_threads[i].pending, 0, 1);
 
-	rx_tid = k_thread_spawn(rx_stack, sizeof(rx_stack),
-				(k_thread_entry_t)net_rx_thread,
-				NULL, NULL, NULL, K_PRIO_COOP(8), 0, 0);
+		k_thread_spawn(rx_stack[i], sizeof(rx_stack[i]),
+			       (k_thread_entry_t)net_rx_thread,
+			       &rx_threads[i], NULL, NULL,
+			       K_PRIO_COOP(8), 0, 0);
+	}
 }
 
 #if defined(CONFIG_NET_IP_ADDR_CHECK)
@@ -651,6 +841,8 @@ int net_send_data(struct net_buf *buf)
 		return -EINVAL;
 	}
 
+	net_stats_latency_start(buf);
+
 #if defined(CONFIG_NET_STATISTICS)
 	switch (net_nbuf_family(buf)) {
 	case AF_INET:
@@ -665,7 +857,7 @@ int net_send_data(struct net_buf *buf)
 	status = check_ip_addr(buf);
 	if (status < 0) {
 		return status;
-	} else if (status > 0) {
+	} else if (status > 0 || net_nbuf_loopback(buf)) {
 		/* Packet is destined back to us so send it directly
 		 * to RX processing.
 		 */
@@ -673,6 +865,30 @@ int net_send_data(struct net_buf *buf)
 		return 0;
 	}
 
+	/* Packets queued for TCP segmentation offload are split in
+	 * segments fitting in the MTU by the TX thread or the device.
+	 */
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+	if (net_nbuf_family(buf) == AF_INET6 && !net_nbuf_gso_size(buf)) {
+		uint16_t mtu = net_ipv6_pmtu_get(net_nbuf_iface(buf),
+						 &NET_IPV6_BUF(buf)->dst);
+
+		if (mtu && net_buf_frags_len(buf->frags) > mtu) {
+			return net_ipv6_send_fragments(buf, mtu);
+		}
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	if (net_nbuf_family(buf) == AF_INET && !net_nbuf_gso_size(buf)) {
+		uint16_t mtu = net_if_get_mtu(net_nbuf_iface(buf));
+
+		if (mtu && net_buf_frags_len(buf->frags) > mtu) {
+			return net_ipv4_send_fragments(buf, mtu);
+		}
+	}
+#endif
+
 	if (net_if_send_data(net_nbuf_iface(buf), buf) == NET_DROP) {
 		return -EIO;
 	}
@@ -680,28 +896,83 @@ int net_send_data(struct net_buf *buf)
 	return 0;
 }
 
-/* Called by driver when an IP packet has been received */
-int net_recv_data(struct net_if *iface, struct net_buf *buf)
+/* Account for a packet about to be queued to the RX queue of an interface */
+static int rx_queue_add(struct net_if *iface, struct net_buf *buf)
 {
+	atomic_val_t queued;
+
 	if (!buf->frags) {
 		return -ENODATA;
 	}
 
-	NET_DBG("fifo %p iface %p buf %p len %zu", &rx_queue, iface, buf,
+	NET_DBG("fifo %p iface %p buf %p len %zu", &iface->rx_queue, iface, buf,
 		net_buf_frags_len(buf));
 
+	queued = atomic_inc(&iface->rx_queue_len) + 1;
+
+#if CONFIG_NET_RX_QUEUE_LEN > 0
+	if (queued > CONFIG_NET_RX_QUEUE_LEN) {
+		atomic_dec(&iface->rx_queue_len);
+		net_stats_update_rx_queue_drop(iface);
+		return -ENOBUFS;
+	}
+#endif
+
+	net_stats_update_rx_queue_recv(iface, net_buf_frags_len(buf->frags),
+				       queued);
+
 	net_nbuf_set_iface(buf, iface);
+	net_stats_latency_start(buf);
+
+	return 0;
+}
+
+/* Called by driver when an IP packet has been received */
+int net_recv_data(struct net_if *iface, struct net_buf *buf)
+{
+	int ret;
+
+	ret = rx_queue_add(iface, buf);
+	if (ret < 0) {
+		return ret;
+	}
 
-	net_buf_put(&rx_queue, buf);
+	net_buf_put(&iface->rx_queue, buf);
+	k_sem_give(&iface_rx_thread(iface)->pending);
 
 	return 0;
 }
 
+/* Called by driver when several IP packets have been received */
+int net_recv_data_list(struct net_if *iface, struct net_buf **bufs, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (rx_queue_add(iface, bufs[i]) < 0) {
+			break;
+		}
+	}
+
+	if (!i) {
+		return count ? -ENOBUFS : 0;
+	}
+
+	net_buf_put_list(&iface->rx_queue, bufs, i);
+	k_sem_give(&iface_rx_thread(iface)->pending);
+
+	return i;
+}
+
 static inline void l3_init(void)
 {
 	net_icmpv6_init();
 	net_ipv6_init();
 
+#if defined(CONFIG_NET_IPV4)
+	net_ipv4_init();
+#endif
+
 #if defined(CONFIG_NET_UDP) || defined(CONFIG_NET_TCP)
 	net_conn_init();
 #endif
@@ -709,6 +980,7 @@ static inline void l3_init(void)
 	net_tcp_init();
 
 	net_route_init();
+	net_mpl_init();
 
 	NET_DBG("Network L3 init done");
 }
@@ -737,6 +1009,8 @@ static int net_init(struct device *unused)
 
 	init_rx_queue();
 
+	net_stats_rate_init();
+
 	return 0;
 }
 
@@ -17,11 +17,13 @@
 #include <net/nbuf.h>
 #include <net/net_if.h>
 #include <net/arp.h>
+#include <net/ethernet.h>
 #include <net/net_mgmt.h>
 
 #include "net_private.h"
 #include "ipv6.h"
 #include "rpl.h"
+#include "tcp.h"
 
 #include "net_stats.h"
 
@@ -67,14 +69,118 @@ static inline void net_context_send_cb(struct net_context *context,
 #endif
 }
 
+#if defined(CONFIG_NET_TC_SCHED_WRR)
+/* Weighted round robin: in each round, traffic class N may send up to N + 1
+ * packets, higher classes first. The round ends when none of the classes
+ * having packets has credit left.
+ */
+static struct net_buf *tx_queue_get(struct net_if *iface)
+{
+	struct net_buf *buf;
+	int tc;
+
+	k_sem_take(&iface->tx_pending, K_FOREVER);
+
+	while (1) {
+		for (tc = NET_TC_TX_COUNT - 1; tc >= 0; tc--) {
+			if (!iface->tx_credit[tc]) {
+				continue;
+			}
+
+			buf = net_buf_get(&iface->tx_queue[tc], K_NO_WAIT);
+			if (buf) {
+				iface->tx_credit[tc]--;
+				return buf;
+			}
+		}
+
+		for (tc = 0; tc < NET_TC_TX_COUNT; tc++) {
+			iface->tx_credit[tc] = tc + 1;
+		}
+	}
+}
+#else
+/* Strict priority: the highest traffic class having packets is served */
+static struct net_buf *tx_queue_get(struct net_if *iface)
+{
+	struct net_buf *buf;
+	int tc;
+
+	k_sem_take(&iface->tx_pending, K_FOREVER);
+
+	/* The semaphore guarantees that one of the queues holds a packet */
+	while (1) {
+		for (tc = NET_TC_TX_COUNT - 1; tc >= 0; tc--) {
+			buf = net_buf_get(&iface->tx_queue[tc], K_NO_WAIT);
+			if (buf) {
+				return buf;
+			}
+		}
+	}
+}
+#endif /* CONFIG_NET_TC_SCHED_WRR */
+
+void net_if_queue_tx(struct net_if *iface, struct net_buf *buf)
+{
+	uint8_t tc = net_tx_priority2tc(net_nbuf_priority(buf));
+
+	net_stats_update_latency(buf, NET_STATS_LATENCY_TX_PROCESS);
+
+	net_buf_put(&iface->tx_queue[tc], buf);
+	k_sem_give(&iface->tx_pending);
+
+	net_stats_update_iface_tx_queue(iface,
+					k_sem_count_get(&iface->tx_pending));
+}
+
+#if defined(CONFIG_NET_TCP_GSO)
+/* Send the segments of a packet queued for TCP segmentation offload,
+ * the packet is released if they all could be passed to the driver.
+ */
+static int gso_send(struct net_if *iface, struct net_buf *buf)
+{
+	const struct net_if_api *api = iface->dev->driver_api;
+	uint16_t total = net_nbuf_appdatalen(buf);
+	uint16_t offset;
+	struct net_buf *seg;
+	int status = 0;
+
+	for (offset = 0; offset < total; offset += net_nbuf_gso_size(buf)) {
+		seg = net_tcp_gso_segment(buf, offset);
+		if (!seg) {
+			return -ENOMEM;
+		}
+
+		status = api->send(iface, seg);
+		if (status < 0) {
+			net_nbuf_unref(seg);
+			return status;
+		}
+	}
+
+	net_nbuf_unref(buf);
+
+	return status;
+}
+
+static inline bool gso_needed(struct net_if *iface, struct net_buf *buf)
+{
+	return net_nbuf_gso_size(buf) &&
+		!atomic_test_bit(iface->flags, NET_IF_TX_TSO);
+}
+#else
+#define gso_send(iface, buf) 0
+#define gso_needed(iface, buf) false
+#endif /* CONFIG_NET_TCP_GSO */
+
 static void net_if_tx_thread(struct net_if *iface)
 {
 	const struct net_if_api *api = iface->dev->driver_api;
 
 	NET_ASSERT(api && api->init && api->send);
 
-	NET_DBG("Starting TX thread (stack %zu bytes) for driver %p queue %p",
-		sizeof(iface->tx_stack), api, &iface->tx_queue);
+	NET_DBG("Starting TX thread (stack %zu bytes) for driver %p queues %d",
+		sizeof(iface->tx_stack), api, NET_TC_TX_COUNT);
 
 	api->init(iface);
 	/* Attempt to bring the interface up */
@@ -85,10 +191,14 @@ static void net_if_tx_thread(struct net_if *iface)
 		struct net_context *context;
 		void *context_token;
 		struct net_buf *buf;
+		uint32_t start;
+		size_t len;
 		int status;
 
 		/* Get next packet from application - wait if necessary */
-		buf = net_buf_get(&iface->tx_queue, K_FOREVER);
+		buf = tx_queue_get(iface);
+
+		net_stats_update_latency(buf, NET_STATS_LATENCY_TX_QUEUE);
 
 		debug_check_packet(buf);
 
@@ -96,12 +206,31 @@ static void net_if_tx_thread(struct net_if *iface)
 		context = net_nbuf_context(buf);
 		context_token = net_nbuf_token(buf);
 
-		if (atomic_test_bit(iface->flags, NET_IF_UP)) {
-			status = api->send(iface, buf);
-		} else {
+		/* The driver may release the buffer */
+		len = net_buf_frags_len(buf->frags);
+
+		if (!atomic_test_bit(iface->flags, NET_IF_UP)) {
 			/* Drop packet if interface is not up */
 			NET_WARN("iface %p is down", iface);
+			net_stats_update_iface_tx_drop_down(iface);
 			status = -ENETDOWN;
+		} else {
+			start = net_stats_latency_now();
+
+			if (gso_needed(iface, buf)) {
+				status = gso_send(iface, buf);
+			} else {
+				status = api->send(iface, buf);
+			}
+
+			net_stats_update_latency_since(
+				buf, NET_STATS_LATENCY_TX_DRIVER, start);
+
+			if (status < 0) {
+				net_stats_update_iface_tx_drop_driver(iface);
+			} else {
+				net_stats_update_iface_tx(iface, len);
+			}
 		}
 
 		if (status < 0) {
@@ -127,9 +256,18 @@ static void net_if_tx_thread(struct net_if *iface)
 
 static inline void init_tx_queue(struct net_if *iface)
 {
+	int tc;
+
 	NET_DBG("On iface %p", iface);
 
-	k_fifo_init(&iface->tx_queue);
+	for (tc = 0; tc < NET_TC_TX_COUNT; tc++) {
+		k_fifo_init(&iface->tx_queue[tc]);
+#if defined(CONFIG_NET_TC_SCHED_WRR)
+		iface->tx_credit[tc] = tc + 1;
+#endif
+	}
+
+	k_sem_init(&iface->tx_pending, 0, UINT_MAX);
 
 	k_thread_spawn(iface->tx_stack, sizeof(iface->tx_stack),
 		       (k_thread_entry_t)net_if_tx_thread,
@@ -146,9 +284,13 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_buf *buf)
 
 	if (atomic_test_bit(iface->flags, NET_IF_UP)) {
 		verdict = iface->l2->send(iface, buf);
+		if (verdict == NET_DROP) {
+			net_stats_update_iface_tx_drop_l2(iface);
+		}
 	} else {
 		/* Drop packet if interface is not up */
 		NET_WARN("iface %p is down", iface);
+		net_stats_update_iface_tx_drop_down(iface);
 		verdict = NET_DROP;
 		status = -ENETDOWN;
 	}
@@ -210,6 +352,78 @@ struct net_if *net_if_get_default(void)
 
 #if defined(CONFIG_NET_IPV6)
 
+#if CONFIG_NET_IPV6_SRC_ADDR_CACHE_SIZE > 0
+struct src_cache_entry {
+	struct in6_addr dst;
+	struct net_if *iface;
+	struct in6_addr *src;
+};
+
+/* Source addresses selected for the recent global destinations, the
+ * entry of a destination being given by its hash.
+ */
+static struct src_cache_entry src_cache[CONFIG_NET_IPV6_SRC_ADDR_CACHE_SIZE];
+
+static inline struct src_cache_entry *src_cache_slot(struct in6_addr *dst)
+{
+	uint32_t hash = 0;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		hash = hash * 31 + dst->s6_addr[i];
+	}
+
+	return &src_cache[hash % CONFIG_NET_IPV6_SRC_ADDR_CACHE_SIZE];
+}
+
+static struct in6_addr *src_cache_get(struct net_if *iface,
+				      struct in6_addr *dst)
+{
+	struct src_cache_entry *entry = src_cache_slot(dst);
+	struct in6_addr *src = NULL;
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (entry->src && entry->iface == iface &&
+	    net_ipv6_addr_cmp(&entry->dst, dst)) {
+		src = entry->src;
+	}
+
+	irq_unlock(key);
+
+	return src;
+}
+
+static void src_cache_add(struct net_if *iface, struct in6_addr *dst,
+			  struct in6_addr *src)
+{
+	struct src_cache_entry *entry = src_cache_slot(dst);
+	unsigned int key;
+
+	key = irq_lock();
+
+	net_ipaddr_copy(&entry->dst, dst);
+	entry->iface = iface;
+	entry->src = src;
+
+	irq_unlock(key);
+}
+
+static inline void src_cache_clear(void)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	memset(src_cache, 0, sizeof(src_cache));
+	irq_unlock(key);
+}
+#else
+#define src_cache_get(...) NULL
+#define src_cache_add(...)
+#define src_cache_clear(...)
+#endif /* CONFIG_NET_IPV6_SRC_ADDR_CACHE_SIZE > 0 */
+
 #if defined(CONFIG_NET_IPV6_DAD)
 #define DAD_TIMEOUT (MSEC_PER_SEC / 10)
 
@@ -224,6 +438,7 @@ static void dad_timeout(struct k_work *work)
 		net_sprint_ipv6_addr(&ifaddr->address.in6_addr));
 
 	ifaddr->addr_state = NET_ADDR_PREFERRED;
+	src_cache_clear();
 }
 
 static void net_if_ipv6_start_dad(struct net_if *iface,
@@ -231,6 +446,7 @@ static void net_if_ipv6_start_dad(struct net_if *iface,
 {
 	ifaddr->addr_state = NET_ADDR_TENTATIVE;
 	ifaddr->dad_count = 1;
+	src_cache_clear();
 
 	NET_DBG("Interface %p ll addr %s tentative IPv6 addr %s", iface,
 		net_sprint_ll_addr(iface->link_addr.addr,
@@ -239,6 +455,7 @@ static void net_if_ipv6_start_dad(struct net_if *iface,
 
 	if (!net_ipv6_start_dad(iface, ifaddr)) {
 		k_delayed_work_init(&ifaddr->dad_timer, dad_timeout);
+		net_timer_slack_init(&ifaddr->dad_timer);
 		k_delayed_work_submit(&ifaddr->dad_timer, DAD_TIMEOUT);
 	}
 }
@@ -284,6 +501,7 @@ void net_if_start_rs(struct net_if *iface)
 
 	if (!net_ipv6_start_rs(iface)) {
 		k_delayed_work_init(&iface->rs_timer, rs_timeout);
+		net_timer_slack_init(&iface->rs_timer);
 		k_delayed_work_submit(&iface->rs_timer, RS_TIMEOUT);
 	}
 }
@@ -329,6 +547,7 @@ static void ipv6_addr_expired(struct k_work *work)
 		net_sprint_ipv6_addr(&ifaddr->address.in6_addr));
 
 	ifaddr->addr_state = NET_ADDR_DEPRECATED;
+	src_cache_clear();
 }
 
 void net_if_ipv6_addr_update_lifetime(struct net_if_addr *ifaddr,
@@ -361,12 +580,31 @@ static struct net_if_addr *ipv6_addr_find(struct net_if *iface,
 	return NULL;
 }
 
+#if defined(CONFIG_NET_L2_ETHERNET)
+/* Programs the multicast filter of the device once the interface is up,
+ * the Ethernet L2 doing it for the groups joined before
+ */
+static void ipv6_mcast_filter(struct net_if *iface, struct in6_addr *addr,
+			      bool add)
+{
+	if (iface->l2 != &NET_L2_GET_NAME(ETHERNET) ||
+	    !atomic_test_bit(iface->flags, NET_IF_UP)) {
+		return;
+	}
+
+	net_eth_ipv6_mcast_filter(iface, addr, add);
+}
+#else
+#define ipv6_mcast_filter(...)
+#endif
+
 struct net_if_addr *net_if_ipv6_addr_add(struct net_if *iface,
 					 struct in6_addr *addr,
 					 enum net_addr_type addr_type,
 					 uint32_t vlifetime)
 {
 	struct net_if_addr *ifaddr;
+	struct in6_addr maddr;
 	int i;
 
 	ifaddr = ipv6_addr_find(iface, addr);
@@ -384,7 +622,9 @@ struct net_if_addr *net_if_ipv6_addr_add(struct net_if *iface,
 		iface->ipv6.unicast[i].addr_type = addr_type;
 		memcpy(&iface->ipv6.unicast[i].address.in6_addr, addr, 16);
 
-		/* FIXME - set the mcast addr for this node */
+		/* Receive the neighbor solicitations for the address */
+		net_ipv6_addr_create_solicited_node(addr, &maddr);
+		ipv6_mcast_filter(iface, &maddr, true);
 
 		if (vlifetime) {
 			iface->ipv6.unicast[i].is_infinite = false;
@@ -392,6 +632,7 @@ struct net_if_addr *net_if_ipv6_addr_add(struct net_if *iface,
 			k_delayed_work_init(
 				&iface->ipv6.unicast[i].lifetime,
 				ipv6_addr_expired);
+			net_timer_slack_init(&iface->ipv6.unicast[i].lifetime);
 
 			NET_DBG("Expiring %s in %u secs",
 				net_sprint_ipv6_addr(addr), vlifetime);
@@ -408,6 +649,8 @@ struct net_if_addr *net_if_ipv6_addr_add(struct net_if *iface,
 
 		net_if_ipv6_start_dad(iface, &iface->ipv6.unicast[i]);
 
+		src_cache_clear();
+		net_context_udp_cache_flush();
 		net_mgmt_event_notify(NET_EVENT_IPV6_ADDR_ADD, iface);
 
 		return &iface->ipv6.unicast[i];
@@ -441,11 +684,14 @@ bool net_if_ipv6_addr_rm(struct net_if *iface, struct in6_addr *addr)
 
 		net_ipv6_addr_create_solicited_node(addr, &maddr);
 		net_if_ipv6_maddr_rm(iface, &maddr);
+		ipv6_mcast_filter(iface, &maddr, false);
 
 		NET_DBG("[%d] interface %p address %s type %s removed",
 			i, iface, net_sprint_ipv6_addr(addr),
 			net_addr_type2str(iface->ipv6.unicast[i].addr_type));
 
+		src_cache_clear();
+		net_context_udp_cache_flush();
 		net_mgmt_event_notify(NET_EVENT_IPV6_ADDR_DEL, iface);
 
 		return true;
@@ -474,6 +720,8 @@ struct net_if_mcast_addr *net_if_ipv6_maddr_add(struct net_if *iface,
 		iface->ipv6.mcast[i].address.family = AF_INET6;
 		memcpy(&iface->ipv6.mcast[i].address.in6_addr, addr, 16);
 
+		ipv6_mcast_filter(iface, addr, true);
+
 		NET_DBG("[%d] interface %p address %s added", i, iface,
 			net_sprint_ipv6_addr(addr));
 
@@ -502,6 +750,8 @@ bool net_if_ipv6_maddr_rm(struct net_if *iface, struct in6_addr *addr)
 
 		iface->ipv6.mcast[i].is_used = false;
 
+		ipv6_mcast_filter(iface, addr, false);
+
 		NET_DBG("[%d] interface %p address %s removed",
 			i, iface, net_sprint_ipv6_addr(addr));
 
@@ -717,6 +967,7 @@ void net_if_ipv6_prefix_set_timer(struct net_if_ipv6_prefix *prefix,
 	NET_DBG("Prefix lifetime %u ms", timeout);
 
 	k_delayed_work_init(&prefix->lifetime, prefix_lf_timeout);
+	net_timer_slack_init(&prefix->lifetime);
 	k_delayed_work_submit(&prefix->lifetime, timeout);
 }
 
@@ -818,6 +1069,7 @@ struct net_if_router *net_if_ipv6_router_add(struct net_if *iface,
 
 			k_delayed_work_init(&routers[i].lifetime,
 					    ipv6_router_expired);
+			net_timer_slack_init(&routers[i].lifetime);
 
 			NET_DBG("Expiring %s in %u secs",
 				net_sprint_ipv6_addr(addr), lifetime);
@@ -1019,6 +1271,11 @@ const struct in6_addr *net_if_ipv6_select_src_addr(struct net_if *dst_iface,
 
 	if (!net_is_ipv6_ll_addr(dst) && !net_is_ipv6_addr_mcast(dst)) {
 
+		src = src_cache_get(dst_iface, dst);
+		if (src) {
+			return src;
+		}
+
 		for (iface = __net_if_start;
 		     !dst_iface && iface != __net_if_end;
 		     iface++) {
@@ -1037,6 +1294,10 @@ const struct in6_addr *net_if_ipv6_select_src_addr(struct net_if *dst_iface,
 							 &best_match);
 		}
 
+		if (src) {
+			src_cache_add(dst_iface, dst, src);
+		}
+
 	} else {
 		for (iface = __net_if_start;
 		     !dst_iface && iface != __net_if_end;
@@ -1241,6 +1502,7 @@ struct net_if_addr *net_if_ipv4_addr_add(struct net_if *iface,
 			net_sprint_ipv4_addr(addr),
 			net_addr_type2str(addr_type));
 
+		net_context_udp_cache_flush();
 		net_mgmt_event_notify(NET_EVENT_IPV4_ADDR_ADD, iface);
 
 		return &iface->ipv4.unicast[i];
@@ -1269,6 +1531,7 @@ bool net_if_ipv4_addr_rm(struct net_if *iface, struct in_addr *addr)
 		NET_DBG("[%d] interface %p address %s removed",
 			i, iface, net_sprint_ipv4_addr(addr));
 
+		net_context_udp_cache_flush();
 		net_mgmt_event_notify(NET_EVENT_IPV4_ADDR_DEL, iface);
 
 		return true;
@@ -1365,6 +1628,7 @@ done:
 	net_if_start_rs(iface);
 #endif
 
+	net_context_udp_cache_flush();
 	net_mgmt_event_notify(NET_EVENT_IF_UP, iface);
 
 	return 0;
@@ -1390,6 +1654,7 @@ int net_if_down(struct net_if *iface)
 done:
 	atomic_clear_bit(iface->flags, NET_IF_UP);
 
+	net_context_udp_cache_flush();
 	net_mgmt_event_notify(NET_EVENT_IF_DOWN, iface);
 
 	return 0;
@@ -30,9 +30,34 @@ static uint32_t global_event_mask;
 static sys_slist_t event_callbacks;
 static uint16_t in_event;
 static uint16_t out_event;
+static uint16_t queued_events;
 
+#if defined(CONFIG_NET_MGMT_EVENT_SYNC)
+/* Called from net_mgmt_event_notify() itself, never queued */
+static sys_slist_t sync_callbacks;
+static uint32_t sync_event_mask;
+#endif
+
+/* The events are notified from any context, ISRs included. The ring is
+ * only touched with interrupts locked, for the few instructions moving
+ * an entry, and the thread copies an event out before running the
+ * callbacks so that the slot can be reused at once.
+ */
 static inline void mgmt_push_event(uint32_t mgmt_event, struct net_if *iface)
 {
+	unsigned int key = irq_lock();
+
+	if (queued_events == CONFIG_NET_MGMT_EVENT_QUEUE_SIZE) {
+		/* The oldest event is lost */
+		out_event++;
+
+		if (out_event == CONFIG_NET_MGMT_EVENT_QUEUE_SIZE) {
+			out_event = 0;
+		}
+
+		queued_events--;
+	}
+
 	events[in_event].event = mgmt_event;
 	events[in_event].iface = iface;
 
@@ -42,84 +67,103 @@ static inline void mgmt_push_event(uint32_t mgmt_event, struct net_if *iface)
 		in_event = 0;
 	}
 
-	if (in_event == out_event) {
-		uint16_t o_idx = out_event + 1;
-
-		if (o_idx == CONFIG_NET_MGMT_EVENT_QUEUE_SIZE) {
-			o_idx = 0;
-		}
+	queued_events++;
 
-		if (events[o_idx].event) {
-			out_event = o_idx;
-		}
-	}
+	irq_unlock(key);
 }
 
-static inline struct mgmt_event_entry *mgmt_pop_event(void)
+static inline bool mgmt_pop_event(struct mgmt_event_entry *mgmt_event)
 {
-	uint16_t o_idx;
+	unsigned int key = irq_lock();
 
-	if (!events[out_event].event) {
-		return NULL;
+	if (!queued_events) {
+		irq_unlock(key);
+		return false;
 	}
 
-	o_idx = out_event;
+	*mgmt_event = events[out_event];
+
 	out_event++;
 
 	if (out_event == CONFIG_NET_MGMT_EVENT_QUEUE_SIZE) {
 		out_event = 0;
 	}
 
-	return &events[o_idx];
+	queued_events--;
+
+	irq_unlock(key);
+
+	return true;
 }
 
-static inline void mgmt_clean_event(struct mgmt_event_entry *mgmt_event)
+static inline uint32_t mgmt_list_event_mask(sys_slist_t *list)
 {
-	mgmt_event->event = 0;
-	mgmt_event->iface = NULL;
+	uint32_t event_mask = 0;
+	sys_snode_t *sn, *sns;
+
+	SYS_SLIST_FOR_EACH_NODE_SAFE(list, sn, sns) {
+		struct net_mgmt_event_callback *cb =
+			CONTAINER_OF(sn, struct net_mgmt_event_callback, node);
+
+		event_mask |= cb->event_mask;
+	}
+
+	return event_mask;
 }
 
-static inline void mgmt_add_event_mask(uint32_t event_mask)
+static inline void mgmt_rebuild_global_event_mask(void)
 {
-	global_event_mask |= event_mask;
+	global_event_mask = mgmt_list_event_mask(&event_callbacks);
+
+#if defined(CONFIG_NET_MGMT_EVENT_SYNC)
+	sync_event_mask = mgmt_list_event_mask(&sync_callbacks);
+#endif
 }
 
-static inline void mgmt_rebuild_global_event_mask(void)
+static inline bool mgmt_is_event_handled(uint32_t mgmt_event,
+					 uint32_t event_mask)
 {
-	sys_snode_t *sn, *sns;
+	return ((mgmt_event & event_mask) == mgmt_event);
+}
 
-	global_event_mask = 0;
+/* The global mask is the union of the masks of the callbacks, so it can
+ * let an event through that no callback wants: check each one before
+ * queueing the event, rather than waking the thread for nothing.
+ */
+static inline bool mgmt_is_event_wanted(sys_slist_t *list, uint32_t mgmt_event)
+{
+	sys_snode_t *sn, *sns;
 
-	SYS_SLIST_FOR_EACH_NODE_SAFE(&event_callbacks, sn, sns) {
+	SYS_SLIST_FOR_EACH_NODE_SAFE(list, sn, sns) {
 		struct net_mgmt_event_callback *cb =
 			CONTAINER_OF(sn, struct net_mgmt_event_callback, node);
 
-		mgmt_add_event_mask(cb->event_mask);
+		if (mgmt_is_event_handled(mgmt_event, cb->event_mask)) {
+			return true;
+		}
 	}
-}
 
-static inline bool mgmt_is_event_handled(uint32_t mgmt_event)
-{
-	return ((mgmt_event & global_event_mask) == mgmt_event);
+	return false;
 }
 
-static inline void mgmt_run_callbacks(struct mgmt_event_entry *mgmt_event)
+static inline void mgmt_run_callbacks(sys_slist_t *list, uint32_t mgmt_event,
+				      struct net_if *iface)
 {
 	sys_snode_t *sn, *sns;
 
 	NET_DBG("Event layer %u code %u type %u",
-		NET_MGMT_GET_LAYER(mgmt_event->event),
-		NET_MGMT_GET_LAYER_CODE(mgmt_event->event),
-		NET_MGMT_GET_COMMAND(mgmt_event->event));
+		NET_MGMT_GET_LAYER(mgmt_event),
+		NET_MGMT_GET_LAYER_CODE(mgmt_event),
+		NET_MGMT_GET_COMMAND(mgmt_event));
 
-	SYS_SLIST_FOR_EACH_NODE_SAFE(&event_callbacks, sn, sns) {
+	SYS_SLIST_FOR_EACH_NODE_SAFE(list, sn, sns) {
 		struct net_mgmt_event_callback *cb =
 			CONTAINER_OF(sn, struct net_mgmt_event_callback, node);
 
 		NET_DBG("Running callback %p : %p", cb, cb->handler);
 
-		if ((mgmt_event->event & cb->event_mask) == mgmt_event->event) {
-			cb->handler(cb, mgmt_event->event, mgmt_event->iface);
+		if (mgmt_is_event_handled(mgmt_event, cb->event_mask)) {
+			cb->handler(cb, mgmt_event, iface);
 		}
 
 #ifdef CONFIG_NET_DEBUG_MGMT_EVENT_STACK
@@ -132,32 +176,20 @@ static inline void mgmt_run_callbacks(struct mgmt_event_entry *mgmt_event)
 
 static void mgmt_thread(void)
 {
-	struct mgmt_event_entry *mgmt_event;
+	struct mgmt_event_entry mgmt_event;
 
 	while (1) {
 		k_sem_take(&network_event, K_FOREVER);
 
 		NET_DBG("Handling events, forwarding it relevantly");
 
-		mgmt_event = mgmt_pop_event();
-		if (!mgmt_event) {
-			/* System is over-loaded?
-			 * At this point we have most probably notified
-			 * more events than we could handle
-			 */
-			NET_DBG("Some event got probably lost (%u)",
-				k_sem_count_get(&network_event));
+		/* The semaphore only tells that the ring is not empty */
+		while (mgmt_pop_event(&mgmt_event)) {
+			mgmt_run_callbacks(&event_callbacks, mgmt_event.event,
+					   mgmt_event.iface);
 
-			k_sem_init(&network_event, 0, UINT_MAX);
-
-			continue;
+			k_yield();
 		}
-
-		mgmt_run_callbacks(mgmt_event);
-
-		mgmt_clean_event(mgmt_event);
-
-		k_yield();
 	}
 }
 
@@ -167,8 +199,24 @@ void net_mgmt_add_event_callback(struct net_mgmt_event_callback *cb)
 
 	sys_slist_prepend(&event_callbacks, &cb->node);
 
-	mgmt_add_event_mask(cb->event_mask);
+	global_event_mask |= cb->event_mask;
+}
+
+#if defined(CONFIG_NET_MGMT_EVENT_SYNC)
+void net_mgmt_add_sync_event_callback(struct net_mgmt_event_callback *cb)
+{
+	unsigned int key;
+
+	NET_DBG("Adding sync event callback %p", cb);
+
+	key = irq_lock();
+
+	sys_slist_prepend(&sync_callbacks, &cb->node);
+	sync_event_mask |= cb->event_mask;
+
+	irq_unlock(key);
 }
+#endif
 
 void net_mgmt_del_event_callback(struct net_mgmt_event_callback *cb)
 {
@@ -176,12 +224,29 @@ void net_mgmt_del_event_callback(struct net_mgmt_event_callback *cb)
 
 	sys_slist_find_and_remove(&event_callbacks, &cb->node);
 
+#if defined(CONFIG_NET_MGMT_EVENT_SYNC)
+	do {
+		unsigned int key = irq_lock();
+
+		sys_slist_find_and_remove(&sync_callbacks, &cb->node);
+
+		irq_unlock(key);
+	} while (0);
+#endif
+
 	mgmt_rebuild_global_event_mask();
 }
 
 void net_mgmt_event_notify(uint32_t mgmt_event, struct net_if *iface)
 {
-	if (mgmt_is_event_handled(mgmt_event)) {
+#if defined(CONFIG_NET_MGMT_EVENT_SYNC)
+	if (mgmt_is_event_handled(mgmt_event, sync_event_mask)) {
+		mgmt_run_callbacks(&sync_callbacks, mgmt_event, iface);
+	}
+#endif
+
+	if (mgmt_is_event_handled(mgmt_event, global_event_mask) &&
+	    mgmt_is_event_wanted(&event_callbacks, mgmt_event)) {
 		NET_DBG("Notifying Event layer %u code %u type %u",
 			NET_MGMT_GET_LAYER(mgmt_event),
 			NET_MGMT_GET_LAYER_CODE(mgmt_event),
@@ -197,10 +262,16 @@ void net_mgmt_event_init(void)
 	sys_slist_init(&event_callbacks);
 	global_event_mask = 0;
 
+#if defined(CONFIG_NET_MGMT_EVENT_SYNC)
+	sys_slist_init(&sync_callbacks);
+	sync_event_mask = 0;
+#endif
+
 	in_event = 0;
 	out_event = 0;
+	queued_events = 0;
 
-	k_sem_init(&network_event, 0, UINT_MAX);
+	k_sem_init(&network_event, 0, 1);
 
 	memset(events, 0,
 	       CONFIG_NET_MGMT_EVENT_QUEUE_SIZE *
@@ -31,6 +31,15 @@ extern uint16_t net_calc_chksum(struct net_buf *buf, uint8_t proto);
 extern uint16_t net_calc_chksum_ipv4(struct net_buf *buf);
 #endif /* CONFIG_NET_IPV4 */
 
+#if defined(CONFIG_NET_CONTEXT_UDP_CACHE)
+/* The headers cached by the UDP contexts are rebuilt once the addresses,
+ * routes or neighbors they were built from change.
+ */
+extern void net_context_udp_cache_flush(void);
+#else
+#define net_context_udp_cache_flush(...)
+#endif /* CONFIG_NET_CONTEXT_UDP_CACHE */
+
 static inline uint16_t net_calc_chksum_icmpv6(struct net_buf *buf)
 {
 	return net_calc_chksum(buf, IPPROTO_ICMPV6);
@@ -51,6 +60,74 @@ static inline uint16_t net_calc_chksum_tcp(struct net_buf *buf)
 	return net_calc_chksum(buf, IPPROTO_TCP);
 }
 
+/* Let a protocol timer not needing precision expire with other timeouts */
+static inline void net_timer_slack_init(struct k_delayed_work *work)
+{
+#if defined(CONFIG_NET_TIMER_SLACK) && CONFIG_NET_TIMER_SLACK > 0
+	k_delayed_work_slack_set(work, CONFIG_NET_TIMER_SLACK);
+#endif
+}
+
+/* Whether the interface of the buffer computes the TX checksums itself.
+ * The packets looped back need none.
+ */
+static inline bool net_nbuf_tx_chksum_offloaded(struct net_buf *buf)
+{
+	struct net_if *iface = net_nbuf_iface(buf);
+
+	if (net_nbuf_loopback(buf)) {
+		return true;
+	}
+
+	return iface && atomic_test_bit(iface->flags, NET_IF_TX_CSUM);
+}
+
+/* Whether the interface of the buffer has verified the RX checksums */
+static inline bool net_nbuf_rx_chksum_offloaded(struct net_buf *buf)
+{
+	struct net_if *iface = net_nbuf_iface(buf);
+
+	if (net_nbuf_loopback(buf)) {
+		return true;
+	}
+
+	return iface && atomic_test_bit(iface->flags, NET_IF_RX_CSUM);
+}
+
+#if defined(CONFIG_NET_LOOPBACK_FAST_PATH)
+/* Called once the IP header of a packet to send is complete, and before
+ * its checksums are computed: the packets for the loopback address or
+ * for one of our addresses are marked so that net_send_data() delivers
+ * them directly.
+ */
+static inline void net_nbuf_check_loopback(struct net_buf *buf)
+{
+	bool loopback = false;
+
+#if defined(CONFIG_NET_IPV6)
+	if (net_nbuf_family(buf) == AF_INET6) {
+		struct in6_addr *dst = &NET_IPV6_BUF(buf)->dst;
+
+		loopback = net_is_ipv6_addr_loopback(dst) ||
+			net_if_ipv6_addr_lookup(dst, NULL);
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4)
+	if (net_nbuf_family(buf) == AF_INET) {
+		struct in_addr *dst = &NET_IPV4_BUF(buf)->dst;
+
+		loopback = net_is_ipv4_addr_loopback(dst) ||
+			net_if_ipv4_addr_lookup(dst, NULL);
+	}
+#endif
+
+	net_nbuf_set_loopback(buf, loopback);
+}
+#else
+#define net_nbuf_check_loopback(...)
+#endif
+
 #if NET_LOG_ENABLED > 0
 static inline char *net_sprint_ll_addr(const uint8_t *ll, uint8_t ll_len)
 {
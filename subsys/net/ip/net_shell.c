@@ -117,6 +117,25 @@ static void tx_stack(struct net_if *iface, unsigned char *stack,
 #endif
 }
 
+#if defined(CONFIG_NET_STATISTICS)
+static void net_shell_print_iface_stats(struct net_stats_iface *stats)
+{
+	printk("RX        : pkts %u bytes %u max queued %u\n",
+	       stats->rx_queue.recv, stats->rx_bytes, stats->rx_queue_max);
+	printk("RX drop   : queue full %u stack %u\n",
+	       stats->rx_queue.drop, stats->rx_drop);
+	printk("TX        : pkts %u bytes %u max queued %u\n",
+	       stats->tx_pkts, stats->tx_bytes, stats->tx_queue_max);
+	printk("TX drop   : down %u L2 %u driver %u\n",
+	       stats->tx_drop_down, stats->tx_drop_l2, stats->tx_drop_driver);
+#if defined(CONFIG_NET_STATISTICS_RATE)
+	printk("Rate      : RX %u pkts/s %u B/s, TX %u pkts/s %u B/s\n",
+	       stats->rate.rx_pkts, stats->rate.rx_bytes,
+	       stats->rate.tx_pkts, stats->rate.tx_bytes);
+#endif
+}
+#endif /* CONFIG_NET_STATISTICS */
+
 static void iface_cb(struct net_if *iface, void *user_data)
 {
 #if defined(CONFIG_NET_IPV6)
@@ -137,6 +156,26 @@ static void iface_cb(struct net_if *iface, void *user_data)
 	printk("Link addr : %s\n", net_sprint_ll_addr(iface->link_addr.addr,
 						      iface->link_addr.len));
 	printk("MTU       : %d\n", iface->mtu);
+	printk("TX        : %s\n",
+	       atomic_test_bit(iface->flags, NET_IF_TX_SG) ?
+	       "scatter-gather" : "copy");
+	printk("Checksum  : TX %s, RX %s\n",
+	       atomic_test_bit(iface->flags, NET_IF_TX_CSUM) ?
+	       "offloaded" : "software",
+	       atomic_test_bit(iface->flags, NET_IF_RX_CSUM) ?
+	       "offloaded" : "software");
+#if defined(CONFIG_NET_TCP_GSO)
+	printk("TCP segm. : %s\n",
+	       atomic_test_bit(iface->flags, NET_IF_TX_TSO) ?
+	       "offloaded" : "software");
+#endif
+	printk("TX queues : %d traffic class%s\n", NET_TC_TX_COUNT,
+	       NET_TC_TX_COUNT > 1 ? "es" : "");
+	printk("RX queue  : %d packets\n",
+	       (int)atomic_get(&iface->rx_queue_len));
+#if defined(CONFIG_NET_STATISTICS)
+	net_shell_print_iface_stats(&iface->stats);
+#endif
 
 #if defined(CONFIG_NET_IPV6)
 	count = 0;
@@ -367,6 +406,53 @@ static void iface_per_mcast_route_cb(struct net_if *iface, void *user_data)
 
 #if defined(CONFIG_NET_STATISTICS)
 
+#if defined(CONFIG_NET_STATISTICS_LATENCY)
+static const char * const latency_stages[NET_STATS_LATENCY_STAGES] = {
+	[NET_STATS_LATENCY_RX_QUEUE] = "RX queue",
+	[NET_STATS_LATENCY_RX_PROCESS] = "RX process",
+	[NET_STATS_LATENCY_RX_DELIVER] = "RX deliver",
+	[NET_STATS_LATENCY_TX_PROCESS] = "TX process",
+	[NET_STATS_LATENCY_TX_QUEUE] = "TX queue",
+	[NET_STATS_LATENCY_TX_DRIVER] = "TX driver",
+};
+
+static void net_shell_print_latency(void)
+{
+	struct net_stats_latency *latency;
+	int stage, i;
+
+	printk("Latency (us)\tcount\tavg\tmax\n");
+
+	for (stage = 0; stage < NET_STATS_LATENCY_STAGES; stage++) {
+		latency = &GET_STAT(latency[stage]);
+
+		printk("%s\t%u\t%u\t%u\n", latency_stages[stage],
+		       latency->count,
+		       latency->count ? latency->total / latency->count : 0,
+		       latency->max);
+
+		if (!latency->count) {
+			continue;
+		}
+
+		/* Only the buckets in use, by their upper bound */
+		printk("\t");
+
+		for (i = 0; i < NET_STATS_LATENCY_BUCKETS - 1; i++) {
+			if (latency->hist[i]) {
+				printk(" <%u:%u", 1 << i, latency->hist[i]);
+			}
+		}
+
+		if (latency->hist[i]) {
+			printk(" >=%u:%u", 1 << (i - 1), latency->hist[i]);
+		}
+
+		printk("\n");
+	}
+}
+#endif /* CONFIG_NET_STATISTICS_LATENCY */
+
 static inline void net_shell_print_statistics(void)
 {
 #if defined(CONFIG_NET_IPV6)
@@ -376,11 +462,31 @@ static inline void net_shell_print_statistics(void)
 	       GET_STAT(ipv6.drop),
 	       GET_STAT(ipv6.forwarded));
 #if defined(CONFIG_NET_IPV6_ND)
-	printk("IPv6 ND recv   %d\tsent\t%d\tdrop\t%d\n",
+	printk("IPv6 ND recv   %d\tsent\t%d\tdrop\t%d\tpending\t%d\n",
 	       GET_STAT(ipv6_nd.recv),
 	       GET_STAT(ipv6_nd.sent),
-	       GET_STAT(ipv6_nd.drop));
+	       GET_STAT(ipv6_nd.drop),
+	       GET_STAT(ipv6_nd.pending_drop));
 #endif /* CONFIG_NET_IPV6_ND */
+#if defined(CONFIG_NET_STATISTICS_IPV6) && defined(CONFIG_NET_IPV6_FRAGMENT)
+	printk("IPv6 frag recv %d\tsent\t%d\treass\t%d\n",
+	       GET_STAT(ipv6_frag.recv),
+	       GET_STAT(ipv6_frag.sent),
+	       GET_STAT(ipv6_frag.reassembled));
+	printk("IPv6 frag drop %d\ttimeout\t%d\tevicted\t%d\n",
+	       GET_STAT(ipv6_frag.drop),
+	       GET_STAT(ipv6_frag.timeout),
+	       GET_STAT(ipv6_frag.evicted));
+#endif
+#if defined(CONFIG_NET_STATISTICS_IPV6) && defined(CONFIG_NET_IPV6_MPL)
+	printk("IPv6 MPL recv  %d\tsent\t%d\tforwarded\t%d\n",
+	       GET_STAT(ipv6_mpl.recv),
+	       GET_STAT(ipv6_mpl.sent),
+	       GET_STAT(ipv6_mpl.forwarded));
+	printk("IPv6 MPL dup   %d\tdrop\t%d\n",
+	       GET_STAT(ipv6_mpl.duplicate),
+	       GET_STAT(ipv6_mpl.drop));
+#endif
 #endif /* CONFIG_NET_IPV6 */
 
 #if defined(CONFIG_NET_IPV4)
@@ -389,8 +495,22 @@ static inline void net_shell_print_statistics(void)
 	       GET_STAT(ipv4.sent),
 	       GET_STAT(ipv4.drop),
 	       GET_STAT(ipv4.forwarded));
+#if defined(CONFIG_NET_STATISTICS_IPV4) && defined(CONFIG_NET_IPV4_FRAGMENT)
+	printk("IPv4 frag recv %d\tsent\t%d\treass\t%d\n",
+	       GET_STAT(ipv4_frag.recv),
+	       GET_STAT(ipv4_frag.sent),
+	       GET_STAT(ipv4_frag.reassembled));
+	printk("IPv4 frag drop %d\ttimeout\t%d\tevicted\t%d\n",
+	       GET_STAT(ipv4_frag.drop),
+	       GET_STAT(ipv4_frag.timeout),
+	       GET_STAT(ipv4_frag.evicted));
+#endif
 #endif /* CONFIG_NET_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+	printk("ARP pending drop %d\n", GET_STAT(arp.pending_drop));
+#endif
+
 	printk("IP vhlerr      %d\thblener\t%d\tlblener\t%d\n",
 	       GET_STAT(ip_errors.vhlerr),
 	       GET_STAT(ip_errors.hblenerr),
@@ -399,6 +519,9 @@ static inline void net_shell_print_statistics(void)
 	       GET_STAT(ip_errors.fragerr),
 	       GET_STAT(ip_errors.chkerr),
 	       GET_STAT(ip_errors.protoerr));
+	printk("RX queue recv  %d\tdrop\t%d\n",
+	       GET_STAT(rx_queue.recv),
+	       GET_STAT(rx_queue.drop));
 
 	printk("ICMP recv      %d\tsent\t%d\tdrop\t%d\n",
 	       GET_STAT(icmp.recv),
@@ -417,20 +540,33 @@ static inline void net_shell_print_statistics(void)
 	       GET_STAT(udp.chkerr));
 #endif
 
-#if defined(CONFIG_NET_RPL_STATS)
+#if defined(CONFIG_NET_STATISTICS_TCP)
+	printk("TCP rexmit     %d\tchkerr\t%d\n",
+	       GET_STAT(tcp.rexmit),
+	       GET_STAT(tcp.chkerr));
+	printk("TCP SACK recv  %d\tsent\t%d\trexmit\t%d\n",
+	       GET_STAT(tcp.sackrecv),
+	       GET_STAT(tcp.sacksent),
+	       GET_STAT(tcp.sackrexmit));
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_RPL)
 	printk("RPL DIS recv   %d\tsent\t%d\tdrop\t%d\n",
 	       GET_STAT(rpl.dis.recv),
 	       GET_STAT(rpl.dis.sent),
 	       GET_STAT(rpl.dis.drop));
-	printk("RPL DIO recv   %d\tsent\t%d\tdrop\t%d\n",
+	printk("RPL DIO recv   %d\tsent\t%d\tdrop\t%d\tintervals\t%d\n",
 	       GET_STAT(rpl.dio.recv),
 	       GET_STAT(rpl.dio.sent),
-	       GET_STAT(rpl.dio.drop));
+	       GET_STAT(rpl.dio.drop),
+	       GET_STAT(rpl.dio.interval));
 	printk("RPL DAO recv   %d\tsent\t%d\tdrop\t%d\tforwarded\t%d\n",
 	       GET_STAT(rpl.dao.recv),
 	       GET_STAT(rpl.dao.sent),
 	       GET_STAT(rpl.dao.drop),
 	      GET_STAT(rpl.dao.forwarded));
+	printk("RPL DAO aggr   %d\n",
+	       GET_STAT(rpl.dao.aggregated));
 	printk("RPL DAOACK rcv %d\tsent\t%d\tdrop\t%d\n",
 	       GET_STAT(rpl.dao_ack.recv),
 	       GET_STAT(rpl.dao_ack.sent),
@@ -451,6 +587,10 @@ static inline void net_shell_print_statistics(void)
 	       GET_STAT(rpl.root_repairs));
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_LATENCY)
+	net_shell_print_latency();
+#endif
+
 	printk("Processing err %d\n", GET_STAT(processing_error));
 }
 #endif /* CONFIG_NET_STATISTICS */
@@ -572,13 +712,49 @@ static int shell_cmd_iface(int argc, char *argv[])
 	return 0;
 }
 
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+static void buf_used_cb(struct net_buf *buf, void *user_data)
+{
+#if defined(CONFIG_NET_BUF_POOL_OWNER)
+	printk("\t\t%p ref %u owner %p\n", buf, buf->ref, buf->owner);
+#else
+	printk("\t\t%p ref %u\n", buf, buf->ref);
+#endif
+}
+
+static void pool_usage_cb(struct net_buf_pool *pool, const char *name,
+			  void *user_data)
+{
+	struct net_buf_pool_stats stats;
+	bool *list_bufs = user_data;
+
+	net_buf_pool_stats_get(pool, &stats);
+
+	printk("\t%s\tused %u peak %u, allocated %u failed %u empty %u, "
+	       "waited %u times %u ms\n", name, stats.used, stats.peak,
+	       stats.alloc, stats.fail, stats.empty, stats.wait,
+	       stats.wait_ms);
+
+	if (*list_bufs) {
+		net_buf_pool_foreach_used(pool, buf_used_cb, NULL);
+	}
+}
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+
 static int shell_cmd_mem(int argc, char *argv[])
 {
 	size_t tx_size, rx_size, data_size;
 	int tx, rx, data;
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+	bool list_bufs;
+	int arg = strcmp(argv[0], "mem") ? 2 : 1;
 
+	/* "mem bufs" also lists the buffers in use */
+	list_bufs = argc > arg && !strcmp(argv[arg], "bufs");
+#else
 	ARG_UNUSED(argc);
 	ARG_UNUSED(argv);
+#endif
 
 	net_nbuf_get_info(&tx_size, &rx_size, &data_size, &tx, &rx, &data);
 
@@ -607,6 +783,12 @@ static int shell_cmd_mem(int argc, char *argv[])
 	}
 	printk("\n");
 
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+	printk("Network buffer pool usage:\n");
+
+	net_nbuf_foreach_pool(pool_usage_cb, &list_bufs);
+#endif
+
 	return 0;
 }
 
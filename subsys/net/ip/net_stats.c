@@ -17,8 +17,112 @@
 
 #include "net_stats.h"
 
+#if defined(CONFIG_NET_STATISTICS_LATENCY_EVENT_LOGGER)
+#include <logging/kernel_event_logger.h>
+#endif
+
 struct net_stats net_stats;
 
+#if defined(CONFIG_NET_STATISTICS_LATENCY)
+uint32_t net_stats_update_latency_since(struct net_buf *buf,
+					enum net_stats_latency_stage stage,
+					uint32_t start)
+{
+	struct net_stats_latency *latency = &net_stats.latency[stage];
+	uint32_t now = k_cycle_get_32();
+	uint32_t us;
+	int bucket;
+
+	us = SYS_CLOCK_HW_CYCLES_TO_NS64(now - start) / NSEC_PER_USEC;
+
+	bucket = find_msb_set(us);
+	if (bucket >= NET_STATS_LATENCY_BUCKETS) {
+		bucket = NET_STATS_LATENCY_BUCKETS - 1;
+	}
+
+	latency->count++;
+	latency->total += us;
+	latency->hist[bucket]++;
+
+	if (us > latency->max) {
+		latency->max = us;
+	}
+
+#if defined(CONFIG_NET_STATISTICS_LATENCY_EVENT_LOGGER)
+	if (sys_k_must_log_event(KERNEL_EVENT_LOGGER_NET_LATENCY_EVENT_ID)) {
+		uint32_t data[4];
+
+		data[0] = _sys_k_get_time();
+		data[1] = (uint32_t)buf;
+		data[2] = stage;
+		data[3] = now - start;
+
+		sys_k_event_logger_put(KERNEL_EVENT_LOGGER_NET_LATENCY_EVENT_ID,
+				       data, ARRAY_SIZE(data));
+	}
+#else
+	ARG_UNUSED(buf);
+#endif
+
+	return now;
+}
+#endif /* CONFIG_NET_STATISTICS_LATENCY */
+
+#if defined(CONFIG_NET_STATISTICS_RATE)
+static struct k_delayed_work rate_work;
+static int64_t rate_stamp;
+
+static inline net_stats_t rate_get(net_stats_t count, net_stats_t *last,
+				   uint32_t elapsed)
+{
+	/* The subtraction gives the right delta once count wrapped */
+	net_stats_t delta = count - *last;
+
+	*last = count;
+
+	return (uint64_t)delta * MSEC_PER_SEC / elapsed;
+}
+
+static void iface_rate_cb(struct net_if *iface, void *user_data)
+{
+	struct net_stats_iface *stats = &iface->stats;
+	uint32_t elapsed = POINTER_TO_UINT(user_data);
+
+	stats->rate.rx_pkts = rate_get(stats->rx_queue.recv,
+				       &stats->rate_last.rx_pkts, elapsed);
+	stats->rate.rx_bytes = rate_get(stats->rx_bytes,
+					&stats->rate_last.rx_bytes, elapsed);
+	stats->rate.tx_pkts = rate_get(stats->tx_pkts,
+				       &stats->rate_last.tx_pkts, elapsed);
+	stats->rate.tx_bytes = rate_get(stats->tx_bytes,
+					&stats->rate_last.tx_bytes, elapsed);
+}
+
+/* The counters are only sampled here, so that counting a packet stays a
+ * plain increment whatever the rate interval.
+ */
+static void rate_work_handler(struct k_work *work)
+{
+	uint32_t elapsed = k_uptime_delta(&rate_stamp);
+
+	ARG_UNUSED(work);
+
+	if (elapsed) {
+		net_if_foreach(iface_rate_cb, UINT_TO_POINTER(elapsed));
+	}
+
+	k_delayed_work_submit(&rate_work, CONFIG_NET_STATISTICS_RATE_INTERVAL);
+}
+
+void net_stats_rate_init(void)
+{
+	rate_stamp = k_uptime_get();
+
+	k_delayed_work_init(&rate_work, rate_work_handler);
+	k_delayed_work_submit(&rate_work, CONFIG_NET_STATISTICS_RATE_INTERVAL);
+}
+#endif /* CONFIG_NET_STATISTICS_RATE */
+
 #ifdef CONFIG_NET_STATISTICS_PERIODIC_OUTPUT
 
 #define PRINT_STATISTICS_INTERVAL (30 * MSEC_PER_SEC)
@@ -39,11 +143,31 @@ void net_print_statistics(void)
 			 GET_STAT(ipv6.drop),
 			 GET_STAT(ipv6.forwarded));
 #if defined(CONFIG_NET_STATISTICS_IPV6_ND)
-		NET_INFO("IPv6 ND recv   %d\tsent\t%d\tdrop\t%d",
+		NET_INFO("IPv6 ND recv   %d\tsent\t%d\tdrop\t%d\tpending\t%d",
 			 GET_STAT(ipv6_nd.recv),
 			 GET_STAT(ipv6_nd.sent),
-			 GET_STAT(ipv6_nd.drop));
+			 GET_STAT(ipv6_nd.drop),
+			 GET_STAT(ipv6_nd.pending_drop));
 #endif /* CONFIG_NET_STATISTICS_IPV6_ND */
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+		NET_INFO("IPv6 frag recv %d\tsent\t%d\treass\t%d",
+			 GET_STAT(ipv6_frag.recv),
+			 GET_STAT(ipv6_frag.sent),
+			 GET_STAT(ipv6_frag.reassembled));
+		NET_INFO("IPv6 frag drop %d\ttimeout\t%d\tevicted\t%d",
+			 GET_STAT(ipv6_frag.drop),
+			 GET_STAT(ipv6_frag.timeout),
+			 GET_STAT(ipv6_frag.evicted));
+#endif /* CONFIG_NET_IPV6_FRAGMENT */
+#if defined(CONFIG_NET_IPV6_MPL)
+		NET_INFO("IPv6 MPL recv  %d\tsent\t%d\tforwarded\t%d",
+			 GET_STAT(ipv6_mpl.recv),
+			 GET_STAT(ipv6_mpl.sent),
+			 GET_STAT(ipv6_mpl.forwarded));
+		NET_INFO("IPv6 MPL dup   %d\tdrop\t%d",
+			 GET_STAT(ipv6_mpl.duplicate),
+			 GET_STAT(ipv6_mpl.drop));
+#endif /* CONFIG_NET_IPV6_MPL */
 #endif /* CONFIG_NET_STATISTICS_IPV6 */
 
 #if defined(CONFIG_NET_STATISTICS_IPV4)
@@ -52,8 +176,22 @@ void net_print_statistics(void)
 			 GET_STAT(ipv4.sent),
 			 GET_STAT(ipv4.drop),
 			 GET_STAT(ipv4.forwarded));
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+		NET_INFO("IPv4 frag recv %d\tsent\t%d\treass\t%d",
+			 GET_STAT(ipv4_frag.recv),
+			 GET_STAT(ipv4_frag.sent),
+			 GET_STAT(ipv4_frag.reassembled));
+		NET_INFO("IPv4 frag drop %d\ttimeout\t%d\tevicted\t%d",
+			 GET_STAT(ipv4_frag.drop),
+			 GET_STAT(ipv4_frag.timeout),
+			 GET_STAT(ipv4_frag.evicted));
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+		NET_INFO("ARP pending drop %d", GET_STAT(arp.pending_drop));
+#endif /* CONFIG_NET_STATISTICS_ARP */
+
 		NET_INFO("IP vhlerr      %d\thblener\t%d\tlblener\t%d",
 			 GET_STAT(ip_errors.vhlerr),
 			 GET_STAT(ip_errors.hblenerr),
@@ -62,6 +200,9 @@ void net_print_statistics(void)
 			 GET_STAT(ip_errors.fragerr),
 			 GET_STAT(ip_errors.chkerr),
 			 GET_STAT(ip_errors.protoerr));
+		NET_INFO("RX queue recv  %d\tdrop\t%d",
+			 GET_STAT(rx_queue.recv),
+			 GET_STAT(rx_queue.drop));
 
 		NET_INFO("ICMP recv      %d\tsent\t%d\tdrop\t%d",
 			 GET_STAT(icmp.recv),
@@ -80,6 +221,16 @@ void net_print_statistics(void)
 			 GET_STAT(udp.chkerr));
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_TCP)
+		NET_INFO("TCP rexmit     %d\tchkerr\t%d",
+			 GET_STAT(tcp.rexmit),
+			 GET_STAT(tcp.chkerr));
+		NET_INFO("TCP SACK recv  %d\tsent\t%d\trexmit\t%d",
+			 GET_STAT(tcp.sackrecv),
+			 GET_STAT(tcp.sacksent),
+			 GET_STAT(tcp.sackrexmit));
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_RPL_STATS)
 		NET_INFO("RPL DIS recv   %d\tsent\t%d\tdrop\t%d",
 			 GET_STAT(rpl.dis.recv),
@@ -137,8 +288,6 @@ static int net_stats_get(uint32_t mgmt_request, struct net_if *iface,
 	size_t len_chk = 0;
 	void *src = NULL;
 
-	ARG_UNUSED(iface);
-
 	switch (NET_MGMT_GET_COMMAND(mgmt_request)) {
 	case NET_REQUEST_STATS_CMD_GET_ALL:
 		len_chk = sizeof(struct net_stats);
@@ -194,13 +343,21 @@ static int net_stats_get(uint32_t mgmt_request, struct net_if *iface,
 		src = &net_stats.rpl;
 		break;
 #endif
+	case NET_REQUEST_STATS_CMD_GET_RX_QUEUE:
+		len_chk = sizeof(struct net_stats_rx_queue);
+		src = iface ? &iface->stats.rx_queue : &net_stats.rx_queue;
+		break;
+	case NET_REQUEST_STATS_CMD_GET_IFACE:
+		len_chk = sizeof(struct net_stats_iface);
+		src = iface ? &iface->stats : NULL;
+		break;
 	}
 
 	if (len != len_chk || !src) {
 		return -EINVAL;
 	}
 
-	memcpy(src, data, len);
+	memcpy(data, src, len);
 
 	return 0;
 }
@@ -249,4 +406,10 @@ NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_RPL,
 				  net_stats_get);
 #endif
 
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_RX_QUEUE,
+				  net_stats_get);
+
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IFACE,
+				  net_stats_get);
+
 #endif /* CONFIG_NET_STATISTICS_USER_API */
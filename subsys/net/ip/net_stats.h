@@ -10,6 +10,7 @@
 #if defined(CONFIG_NET_STATISTICS)
 
 #include <net/net_stats.h>
+#include <net/net_if.h>
 
 extern struct net_stats net_stats;
 
@@ -31,12 +32,97 @@ static inline void net_stats_update_ip_errors_vhlerr(void)
 {
 	net_stats.ip_errors.vhlerr++;
 }
+
+static inline void net_stats_update_ip_errors_chkerr(void)
+{
+	net_stats.ip_errors.chkerr++;
+}
+
+static inline void net_stats_update_ip_errors_fragerr(void)
+{
+	net_stats.ip_errors.fragerr++;
+}
+
+/* A packet of len bytes was queued, leaving queued packets in the queue */
+static inline void net_stats_update_rx_queue_recv(struct net_if *iface,
+						  size_t len,
+						  unsigned int queued)
+{
+	net_stats.rx_queue.recv++;
+	iface->stats.rx_queue.recv++;
+	iface->stats.rx_bytes += len;
+
+	if (queued > iface->stats.rx_queue_max) {
+		iface->stats.rx_queue_max = queued;
+	}
+}
+
+static inline void net_stats_update_rx_queue_drop(struct net_if *iface)
+{
+	net_stats.rx_queue.drop++;
+	iface->stats.rx_queue.drop++;
+}
+
+/* Interface stats */
+
+static inline void net_stats_update_iface_rx_drop(struct net_if *iface)
+{
+	iface->stats.rx_drop++;
+}
+
+/* A packet was queued, leaving queued packets in the TX queues */
+static inline void net_stats_update_iface_tx_queue(struct net_if *iface,
+						   unsigned int queued)
+{
+	if (queued > iface->stats.tx_queue_max) {
+		iface->stats.tx_queue_max = queued;
+	}
+}
+
+static inline void net_stats_update_iface_tx(struct net_if *iface,
+					     size_t len)
+{
+	iface->stats.tx_pkts++;
+	iface->stats.tx_bytes += len;
+}
+
+static inline void net_stats_update_iface_tx_drop_down(struct net_if *iface)
+{
+	iface->stats.tx_drop_down++;
+}
+
+static inline void net_stats_update_iface_tx_drop_l2(struct net_if *iface)
+{
+	iface->stats.tx_drop_l2++;
+}
+
+static inline void net_stats_update_iface_tx_drop_driver(struct net_if *iface)
+{
+	iface->stats.tx_drop_driver++;
+}
 #else
 #define net_stats_update_processing_error()
 #define net_stats_update_ip_errors_protoerr()
 #define net_stats_update_ip_errors_vhlerr()
+#define net_stats_update_ip_errors_chkerr()
+#define net_stats_update_ip_errors_fragerr()
+#define net_stats_update_rx_queue_recv(iface, len, queued)
+#define net_stats_update_rx_queue_drop(iface)
+#define net_stats_update_iface_rx_drop(iface)
+#define net_stats_update_iface_tx_queue(iface, queued)
+#define net_stats_update_iface_tx(iface, len)
+#define net_stats_update_iface_tx_drop_down(iface)
+#define net_stats_update_iface_tx_drop_l2(iface)
+#define net_stats_update_iface_tx_drop_driver(iface)
 #endif /* CONFIG_NET_STATISTICS */
 
+#if defined(CONFIG_NET_STATISTICS_RATE)
+/* Start the periodic computation of the interface rates */
+void net_stats_rate_init(void);
+#else
+#define net_stats_rate_init()
+#endif /* CONFIG_NET_STATISTICS_RATE */
+
 #if defined(CONFIG_NET_STATISTICS_IPV6)
 /* IPv6 stats */
 
@@ -60,6 +146,82 @@ static inline void net_stats_update_ipv6_drop(void)
 #define net_stats_update_ipv6_recv()
 #endif /* CONFIG_NET_STATISTICS_IPV6 */
 
+#if defined(CONFIG_NET_STATISTICS_IPV6) && defined(CONFIG_NET_IPV6_FRAGMENT)
+/* IPv6 fragment stats */
+
+static inline void net_stats_update_ipv6_frag_recv(void)
+{
+	net_stats.ipv6_frag.recv++;
+}
+
+static inline void net_stats_update_ipv6_frag_sent(void)
+{
+	net_stats.ipv6_frag.sent++;
+}
+
+static inline void net_stats_update_ipv6_frag_reassembled(void)
+{
+	net_stats.ipv6_frag.reassembled++;
+}
+
+static inline void net_stats_update_ipv6_frag_drop(void)
+{
+	net_stats.ipv6_frag.drop++;
+}
+
+static inline void net_stats_update_ipv6_frag_timeout(void)
+{
+	net_stats.ipv6_frag.timeout++;
+}
+
+static inline void net_stats_update_ipv6_frag_evicted(void)
+{
+	net_stats.ipv6_frag.evicted++;
+}
+#else
+#define net_stats_update_ipv6_frag_recv()
+#define net_stats_update_ipv6_frag_sent()
+#define net_stats_update_ipv6_frag_reassembled()
+#define net_stats_update_ipv6_frag_drop()
+#define net_stats_update_ipv6_frag_timeout()
+#define net_stats_update_ipv6_frag_evicted()
+#endif /* CONFIG_NET_STATISTICS_IPV6 && CONFIG_NET_IPV6_FRAGMENT */
+
+#if defined(CONFIG_NET_STATISTICS_IPV6) && defined(CONFIG_NET_IPV6_MPL)
+/* IPv6 multicast forwarding stats */
+
+static inline void net_stats_update_ipv6_mpl_recv(void)
+{
+	net_stats.ipv6_mpl.recv++;
+}
+
+static inline void net_stats_update_ipv6_mpl_sent(void)
+{
+	net_stats.ipv6_mpl.sent++;
+}
+
+static inline void net_stats_update_ipv6_mpl_forwarded(void)
+{
+	net_stats.ipv6_mpl.forwarded++;
+}
+
+static inline void net_stats_update_ipv6_mpl_duplicate(void)
+{
+	net_stats.ipv6_mpl.duplicate++;
+}
+
+static inline void net_stats_update_ipv6_mpl_drop(void)
+{
+	net_stats.ipv6_mpl.drop++;
+}
+#else
+#define net_stats_update_ipv6_mpl_recv()
+#define net_stats_update_ipv6_mpl_sent()
+#define net_stats_update_ipv6_mpl_forwarded()
+#define net_stats_update_ipv6_mpl_duplicate()
+#define net_stats_update_ipv6_mpl_drop()
+#endif /* CONFIG_NET_STATISTICS_IPV6 && CONFIG_NET_IPV6_MPL */
+
 #if defined(CONFIG_NET_STATISTICS_IPV6_ND)
 /* IPv6 Neighbor Discovery stats*/
 
@@ -77,12 +239,29 @@ static inline void net_stats_update_ipv6_nd_drop(void)
 {
 	net_stats.ipv6_nd.drop++;
 }
+
+static inline void net_stats_update_ipv6_nd_pending_drop(void)
+{
+	net_stats.ipv6_nd.pending_drop++;
+}
 #else
 #define net_stats_update_ipv6_nd_sent()
 #define net_stats_update_ipv6_nd_recv()
 #define net_stats_update_ipv6_nd_drop()
+#define net_stats_update_ipv6_nd_pending_drop()
 #endif /* CONFIG_NET_STATISTICS_IPV6_ND */
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+/* ARP stats */
+
+static inline void net_stats_update_arp_pending_drop(void)
+{
+	net_stats.arp.pending_drop++;
+}
+#else
+#define net_stats_update_arp_pending_drop()
+#endif /* CONFIG_NET_STATISTICS_ARP */
+
 #if defined(CONFIG_NET_STATISTICS_IPV4)
 /* IPv4 stats */
 
@@ -106,6 +285,47 @@ static inline void net_stats_update_ipv4_recv(void)
 #define net_stats_update_ipv4_recv()
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_IPV4) && defined(CONFIG_NET_IPV4_FRAGMENT)
+/* IPv4 fragment stats */
+
+static inline void net_stats_update_ipv4_frag_recv(void)
+{
+	net_stats.ipv4_frag.recv++;
+}
+
+static inline void net_stats_update_ipv4_frag_sent(void)
+{
+	net_stats.ipv4_frag.sent++;
+}
+
+static inline void net_stats_update_ipv4_frag_reassembled(void)
+{
+	net_stats.ipv4_frag.reassembled++;
+}
+
+static inline void net_stats_update_ipv4_frag_drop(void)
+{
+	net_stats.ipv4_frag.drop++;
+}
+
+static inline void net_stats_update_ipv4_frag_timeout(void)
+{
+	net_stats.ipv4_frag.timeout++;
+}
+
+static inline void net_stats_update_ipv4_frag_evicted(void)
+{
+	net_stats.ipv4_frag.evicted++;
+}
+#else
+#define net_stats_update_ipv4_frag_recv()
+#define net_stats_update_ipv4_frag_sent()
+#define net_stats_update_ipv4_frag_reassembled()
+#define net_stats_update_ipv4_frag_drop()
+#define net_stats_update_ipv4_frag_timeout()
+#define net_stats_update_ipv4_frag_evicted()
+#endif /* CONFIG_NET_STATISTICS_IPV4 && CONFIG_NET_IPV4_FRAGMENT */
+
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 /* Common ICMPv4/ICMPv6 stats */
 static inline void net_stats_update_icmp_sent(void)
@@ -144,12 +364,52 @@ static inline void net_stats_update_udp_drop(void)
 {
 	net_stats.udp.drop++;
 }
+
+static inline void net_stats_update_udp_chkerr(void)
+{
+	net_stats.udp.chkerr++;
+}
 #else
 #define net_stats_update_udp_sent()
 #define net_stats_update_udp_recv()
 #define net_stats_update_udp_drop()
+#define net_stats_update_udp_chkerr()
 #endif /* CONFIG_NET_STATISTICS_UDP */
 
+#if defined(CONFIG_NET_STATISTICS_TCP)
+/* TCP stats */
+static inline void net_stats_update_tcp_rexmit(void)
+{
+	net_stats.tcp.rexmit++;
+}
+
+static inline void net_stats_update_tcp_sack_recv(void)
+{
+	net_stats.tcp.sackrecv++;
+}
+
+static inline void net_stats_update_tcp_sack_sent(void)
+{
+	net_stats.tcp.sacksent++;
+}
+
+static inline void net_stats_update_tcp_sack_rexmit(void)
+{
+	net_stats.tcp.sackrexmit++;
+}
+
+static inline void net_stats_update_tcp_chkerr(void)
+{
+	net_stats.tcp.chkerr++;
+}
+#else
+#define net_stats_update_tcp_rexmit()
+#define net_stats_update_tcp_sack_recv()
+#define net_stats_update_tcp_sack_sent()
+#define net_stats_update_tcp_sack_rexmit()
+#define net_stats_update_tcp_chkerr()
+#endif /* CONFIG_NET_STATISTICS_TCP */
+
 #if defined(CONFIG_NET_STATISTICS_RPL)
 /* RPL stats */
 static inline void net_stats_update_rpl_resets(void)
@@ -207,21 +467,56 @@ static inline void net_stats_update_rpl_dis_sent(void)
 	net_stats.rpl.dis.sent++;
 }
 
+static inline void net_stats_update_rpl_dis_recv(void)
+{
+	net_stats.rpl.dis.recv++;
+}
+
 static inline void net_stats_update_rpl_dio_sent(void)
 {
 	net_stats.rpl.dio.sent++;
 }
 
+static inline void net_stats_update_rpl_dio_recv(void)
+{
+	net_stats.rpl.dio.recv++;
+}
+
+static inline void net_stats_update_rpl_dio_drop(void)
+{
+	net_stats.rpl.dio.drop++;
+}
+
+static inline void net_stats_update_rpl_dio_interval(void)
+{
+	net_stats.rpl.dio.interval++;
+}
+
 static inline void net_stats_update_rpl_dao_sent(void)
 {
 	net_stats.rpl.dao.sent++;
 }
 
+static inline void net_stats_update_rpl_dao_recv(void)
+{
+	net_stats.rpl.dao.recv++;
+}
+
+static inline void net_stats_update_rpl_dao_drop(void)
+{
+	net_stats.rpl.dao.drop++;
+}
+
 static inline void net_stats_update_rpl_dao_forwarded(void)
 {
 	net_stats.rpl.dao.forwarded++;
 }
 
+static inline void net_stats_update_rpl_dao_aggregated(uint16_t count)
+{
+	net_stats.rpl.dao.aggregated += count;
+}
+
 static inline void net_stats_update_rpl_dao_ack_sent(void)
 {
 	net_stats.rpl.dao_ack.sent++;
@@ -243,13 +538,62 @@ static inline void net_stats_update_rpl_dao_ack_recv(void)
 #define net_stats_update_rpl_loop_errors()
 #define net_stats_update_rpl_loop_warnings()
 #define net_stats_update_rpl_dis_sent()
+#define net_stats_update_rpl_dis_recv()
 #define net_stats_update_rpl_dio_sent()
+#define net_stats_update_rpl_dio_recv()
+#define net_stats_update_rpl_dio_drop()
+#define net_stats_update_rpl_dio_interval()
 #define net_stats_update_rpl_dao_sent()
+#define net_stats_update_rpl_dao_recv()
+#define net_stats_update_rpl_dao_drop()
 #define net_stats_update_rpl_dao_forwarded()
+#define net_stats_update_rpl_dao_aggregated(...)
 #define net_stats_update_rpl_dao_ack_sent()
 #define net_stats_update_rpl_dao_ack_recv()
 #endif /* CONFIG_NET_STATISTICS_RPL */
 
+#if defined(CONFIG_NET_STATISTICS_LATENCY)
+/* Packet latency stats */
+#include <net/nbuf.h>
+
+#define net_stats_latency_now() k_cycle_get_32()
+
+/* Account for the time a packet spent in a stage since the cycle count
+ * start. The buffer only identifies the packet, so it may have been freed.
+ * Returns the current cycle count.
+ */
+uint32_t net_stats_update_latency_since(struct net_buf *buf,
+					enum net_stats_latency_stage stage,
+					uint32_t start);
+
+/* Start timing a packet entering the RX or TX path */
+static inline void net_stats_latency_start(struct net_buf *buf)
+{
+	net_nbuf_set_stamp(buf, k_cycle_get_32());
+}
+
+/* Account for the time a packet spent in a stage since it passed the
+ * previous one. Packets not timed from the start of the path, e.g.
+ * reassembled ones, are ignored.
+ */
+static inline void net_stats_update_latency(struct net_buf *buf,
+					    enum net_stats_latency_stage stage)
+{
+	uint32_t start = net_nbuf_stamp(buf);
+
+	if (start) {
+		net_nbuf_set_stamp(buf, net_stats_update_latency_since(buf,
+								       stage,
+								       start));
+	}
+}
+#else
+#define net_stats_latency_now() 0
+#define net_stats_update_latency_since(buf, stage, start)
+#define net_stats_latency_start(buf)
+#define net_stats_update_latency(buf, stage)
+#endif /* CONFIG_NET_STATISTICS_LATENCY */
+
 #if defined(CONFIG_NET_STATISTICS_PERIODIC_OUTPUT)
 /* A simple periodic statistic printer, used only in net core */
 void net_print_statistics(void);
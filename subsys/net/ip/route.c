@@ -38,7 +38,45 @@
 /* We keep track of the routes in a separate list so that we can remove
  * the oldest routes (at tail) if needed.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
+
+/* Longest prefix match index of the routes. This is a binary trie over
+ * the bits of the route prefixes, where the chains of nodes having a
+ * single child are compressed (PATRICIA trie). Each node covers a
+ * prefix, and the routes of that exact prefix, one per interface, are
+ * linked to it. Nodes without routes only exist where two branches
+ * split, so at most 2 * CONFIG_NET_MAX_ROUTES - 1 nodes are needed.
+ */
+struct route_trie_node {
+	struct route_trie_node *parent;
+	struct route_trie_node *child[2];
+
+	/** Routes having this prefix */
+	sys_slist_t routes;
+
+	struct in6_addr prefix;
+	uint8_t len;
+};
+
+#define ROUTE_TRIE_NODES (2 * CONFIG_NET_MAX_ROUTES)
+
+static struct route_trie_node trie_nodes[ROUTE_TRIE_NODES];
+static struct route_trie_node *trie_root;
+
+/* Unused nodes, linked through their parent pointer */
+static struct route_trie_node *trie_free;
+
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+/* Routes of the most recently looked up destinations */
+struct route_cache_entry {
+	struct in6_addr dst;
+	struct net_if *iface;
+	struct net_route_entry *route;
+};
+
+static struct route_cache_entry route_cache[CONFIG_NET_ROUTE_CACHE_SIZE];
+static uint8_t route_cache_next;
+#endif
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -252,39 +290,276 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 #define net_route_info(...)
 #endif /* CONFIG_NET_DEBUG_ROUTE */
 
-/* Route was accessed, so place it in front of the routes list */
-static inline void update_route_access(struct net_route_entry *route)
+static inline int prefix_bit(const struct in6_addr *addr, uint8_t bit)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	return (addr->s6_addr[bit / 8] >> (7 - (bit % 8))) & 1;
 }
 
-struct net_route_entry *net_route_lookup(struct net_if *iface,
-					 struct in6_addr *dst)
+/* Number of leading bits two addresses have in common, up to max */
+static uint8_t common_prefix_len(const struct in6_addr *addr1,
+				 const struct in6_addr *addr2,
+				 uint8_t max)
 {
-	struct net_route_entry *route, *found = NULL;
-	uint8_t longest_match = 0;
+	uint8_t len = 0;
 	int i;
 
-	for (i = 0; i < CONFIG_NET_MAX_ROUTES && longest_match < 128; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	for (i = 0; i < sizeof(struct in6_addr) && len < max; i++) {
+		uint8_t diff = addr1->s6_addr[i] ^ addr2->s6_addr[i];
 
-		if (!nbr->ref) {
-			continue;
+		if (diff) {
+			len += 8 - find_msb_set(diff);
+			break;
 		}
 
-		if (iface && nbr->iface != iface) {
-			continue;
+		len += 8;
+	}
+
+	return len < max ? len : max;
+}
+
+static struct route_trie_node *trie_node_alloc(struct route_trie_node *parent,
+					       const struct in6_addr *addr,
+					       uint8_t len)
+{
+	struct route_trie_node *node = trie_free;
+	int i;
+
+	if (!node) {
+		return NULL;
+	}
+
+	trie_free = node->parent;
+
+	memset(node, 0, sizeof(*node));
+
+	node->parent = parent;
+	node->len = len;
+
+	/* Only keep the prefix bits */
+	for (i = 0; len; i++) {
+		uint8_t bits = len < 8 ? len : 8;
+
+		node->prefix.s6_addr[i] = addr->s6_addr[i] &
+			(uint8_t)(0xff << (8 - bits));
+		len -= bits;
+	}
+
+	return node;
+}
+
+static inline void trie_node_free(struct route_trie_node *node)
+{
+	node->parent = trie_free;
+	trie_free = node;
+}
+
+static inline struct route_trie_node **trie_link(struct route_trie_node *node)
+{
+	if (!node->parent) {
+		return &trie_root;
+	}
+
+	return &node->parent->child[node->parent->child[1] == node];
+}
+
+static int trie_insert(struct net_route_entry *route)
+{
+	struct route_trie_node **link = &trie_root;
+	struct route_trie_node *parent = NULL, *node, *new, *split;
+	uint8_t len = route->prefix_len, common = 0;
+
+	while ((node = *link) != NULL) {
+		common = common_prefix_len(&node->prefix, &route->addr,
+					   min(node->len, len));
+		if (common < node->len) {
+			break;
+		}
+
+		if (node->len == len) {
+			sys_slist_append(&node->routes, &route->prefix_node);
+			return 0;
+		}
+
+		parent = node;
+		link = &node->child[prefix_bit(&route->addr, node->len)];
+	}
+
+	new = trie_node_alloc(parent, &route->addr, len);
+	if (!new) {
+		return -ENOMEM;
+	}
+
+	sys_slist_append(&new->routes, &route->prefix_node);
+
+	if (!node) {
+		*link = new;
+		return 0;
+	}
+
+	if (common == len) {
+		/* The new prefix covers the node */
+		new->child[prefix_bit(&node->prefix, len)] = node;
+		node->parent = new;
+		*link = new;
+		return 0;
+	}
+
+	/* The prefixes differ after common bits, branch there */
+	split = trie_node_alloc(parent, &route->addr, common);
+	if (!split) {
+		trie_node_free(new);
+		return -ENOMEM;
+	}
+
+	split->child[prefix_bit(&route->addr, common)] = new;
+	split->child[prefix_bit(&node->prefix, common)] = node;
+	new->parent = split;
+	node->parent = split;
+	*link = split;
+
+	return 0;
+}
+
+static struct route_trie_node *trie_find(const struct in6_addr *addr,
+					 uint8_t len)
+{
+	struct route_trie_node *node = trie_root;
+
+	while (node && node->len <= len) {
+		if (!net_is_ipv6_prefix((uint8_t *)addr,
+					(uint8_t *)&node->prefix, node->len)) {
+			break;
+		}
+
+		if (node->len == len) {
+			return node;
+		}
+
+		node = node->child[prefix_bit(addr, node->len)];
+	}
+
+	return NULL;
+}
+
+static void trie_remove(struct net_route_entry *route)
+{
+	struct route_trie_node *node, *child, *parent;
+
+	node = trie_find(&route->addr, route->prefix_len);
+	if (!node) {
+		return;
+	}
+
+	sys_slist_find_and_remove(&node->routes, &route->prefix_node);
+
+	/* Drop the nodes that are not needed anymore, i.e. the ones
+	 * without routes that do not branch.
+	 */
+	while (node && sys_slist_is_empty(&node->routes) &&
+	       !(node->child[0] && node->child[1])) {
+		child = node->child[0] ? node->child[0] : node->child[1];
+		parent = node->parent;
+
+		*trie_link(node) = child;
+		trie_node_free(node);
+
+		if (child) {
+			child->parent = parent;
+			break;
 		}
 
-		route = net_route_data(nbr);
+		node = parent;
+	}
+}
+
+static struct net_route_entry *trie_lookup(struct net_if *iface,
+					   struct in6_addr *dst)
+{
+	struct route_trie_node *node = trie_root;
+	struct net_route_entry *found = NULL;
+	sys_snode_t *sn;
+
+	while (node && net_is_ipv6_prefix((uint8_t *)dst,
+					  (uint8_t *)&node->prefix,
+					  node->len)) {
+		SYS_SLIST_FOR_EACH_NODE(&node->routes, sn) {
+			struct net_route_entry *route;
 
-		if (route->prefix_len >= longest_match &&
-		    net_is_ipv6_prefix((uint8_t *)dst,
-				       (uint8_t *)&route->addr,
-				       route->prefix_len)) {
-			found = route;
-			longest_match = route->prefix_len;
+			route = CONTAINER_OF(sn, struct net_route_entry,
+					     prefix_node);
+
+			if (!iface || route->iface == iface) {
+				found = route;
+				break;
+			}
+		}
+
+		if (node->len == 128) {
+			break;
+		}
+
+		node = node->child[prefix_bit(dst, node->len)];
+	}
+
+	return found;
+}
+
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+static struct net_route_entry *route_cache_get(struct net_if *iface,
+					       struct in6_addr *dst)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NET_ROUTE_CACHE_SIZE; i++) {
+		if (route_cache[i].route && route_cache[i].iface == iface &&
+		    net_ipv6_addr_cmp(&route_cache[i].dst, dst)) {
+			return route_cache[i].route;
+		}
+	}
+
+	return NULL;
+}
+
+static void route_cache_add(struct net_if *iface, struct in6_addr *dst,
+			    struct net_route_entry *route)
+{
+	struct route_cache_entry *entry = &route_cache[route_cache_next];
+
+	net_ipaddr_copy(&entry->dst, dst);
+	entry->iface = iface;
+	entry->route = route;
+
+	route_cache_next = (route_cache_next + 1) %
+		CONFIG_NET_ROUTE_CACHE_SIZE;
+}
+
+static inline void route_cache_clear(void)
+{
+	memset(route_cache, 0, sizeof(route_cache));
+}
+#else
+#define route_cache_get(...) NULL
+#define route_cache_add(...)
+#define route_cache_clear(...)
+#endif /* CONFIG_NET_ROUTE_CACHE_SIZE > 0 */
+
+/* Route was accessed, so place it in front of the routes list */
+static inline void update_route_access(struct net_route_entry *route)
+{
+	sys_dlist_remove(&route->node);
+	sys_dlist_prepend(&routes, &route->node);
+}
+
+struct net_route_entry *net_route_lookup(struct net_if *iface,
+					 struct in6_addr *dst)
+{
+	struct net_route_entry *found;
+
+	found = route_cache_get(iface, dst);
+	if (!found) {
+		found = trie_lookup(iface, dst);
+		if (found) {
+			route_cache_add(iface, dst, found);
 		}
 	}
 
@@ -350,9 +625,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -397,7 +670,17 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	route = net_route_data(nbr);
 	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+	if (trie_insert(route) < 0) {
+		NET_ERR("No route index node available!");
+		net_nbr_unref(tmp);
+		nbr_free(nbr);
+		return NULL;
+	}
+
+	route_cache_clear();
+	net_context_udp_cache_flush();
+
+	sys_dlist_prepend(&routes, &route->node);
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -424,13 +707,17 @@ int net_route_del(struct net_route_entry *route)
 		return -EINVAL;
 	}
 
-	sys_slist_find_and_remove(&routes, &route->node);
-
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
 		return -ENOENT;
 	}
 
+	sys_dlist_remove(&route->node);
+
+	trie_remove(route);
+	route_cache_clear();
+	net_context_udp_cache_flush();
+
 	net_route_info("Deleted", route, &route->addr);
 
 	SYS_SLIST_FOR_EACH_NODE(&route->nexthop, test) {
@@ -680,7 +967,7 @@ net_route_mcast_lookup(struct in6_addr *group)
 	for (i = 0; i < CONFIG_NET_MAX_MCAST_ROUTES; i++) {
 		struct net_route_entry_mcast *route = &route_mcast_entries[i];
 
-		if (!route->is_used) {
+		if (route->is_used) {
 			if (net_ipv6_addr_cmp(group, &route->group)) {
 				return route;
 			}
@@ -693,6 +980,12 @@ net_route_mcast_lookup(struct in6_addr *group)
 
 void net_route_init(void)
 {
+	int i;
+
+	for (i = 0; i < ROUTE_TRIE_NODES; i++) {
+		trie_node_free(&trie_nodes[i]);
+	}
+
 	NET_DBG("Allocated %d routing entries (%zu bytes)",
 		CONFIG_NET_MAX_ROUTES, sizeof(net_route_entries_pool));
 
@@ -79,11 +79,16 @@
 /* Special value indicating immediate removal. */
 #define NET_RPL_ZERO_LIFETIME		0
 
+/* Special value indicating a lifetime that does not expire. */
+#define NET_RPL_INFINITE_LIFETIME	0xff
+
 /* Expire DAOs from neighbors that do not respond in this time. (seconds) */
 #define NET_RPL_DAO_EXPIRATION_TIMEOUT      60
 
 #if defined(CONFIG_NET_RPL_MOP3)
 #define NET_RPL_MOP_DEFAULT		NET_RPL_MOP_STORING_MULTICAST
+#elif defined(CONFIG_NET_RPL_MOP1)
+#define NET_RPL_MOP_DEFAULT		NET_RPL_MOP_NON_STORING
 #else
 #define NET_RPL_MOP_DEFAULT		NET_RPL_MOP_STORING_NO_MULTICAST
 #endif
@@ -109,6 +114,22 @@ static enum net_rpl_mode rpl_mode = NET_RPL_MODE_MESH;
 static net_rpl_join_callback_t rpl_join_callback;
 static uint8_t rpl_dao_sequence;
 
+#if defined(CONFIG_NET_RPL_MOP1)
+/* In non-storing mode the root learns the parent of each node from the
+ * DAOs, and builds the source routes from these links.
+ */
+struct net_rpl_ns_node {
+	struct in6_addr addr;
+	struct in6_addr parent;
+	struct net_rpl_dag *dag;
+	/* Uptime in ms when the link expires, 0 if it does not */
+	int64_t expires;
+	bool is_used;
+};
+
+static struct net_rpl_ns_node rpl_ns_nodes[CONFIG_NET_RPL_NS_NODES];
+#endif
+
 #if defined(CONFIG_NET_RPL_DIS_SEND)
 /* DODAG Information Solicitation timer. */
 struct k_delayed_work dis_timer;
@@ -655,6 +676,8 @@ static void new_dio_interval(struct net_rpl_instance *instance)
 	 */
 	instance->dio_next_delay -= time;
 
+	net_stats_update_rpl_dio_interval();
+
 #if defined(CONFIG_NET_RPL_STATS)
 	instance->dio_intervals++;
 	instance->dio_recv_pkt += instance->dio_counter;
@@ -705,7 +728,7 @@ int net_rpl_dis_send(struct in6_addr *dst, struct net_if *iface)
 {
 	struct in6_addr addr, *dst_addr;
 	const struct in6_addr *src;
-	struct net_buf *buf;
+	struct net_buf *buf, *frag;
 	uint16_t pos;
 	int ret;
 
@@ -739,11 +762,11 @@ int net_rpl_dis_send(struct in6_addr *dst, struct net_if *iface)
 	setup_icmpv6_hdr(buf, NET_ICMPV6_RPL, NET_RPL_DODAG_SOLICIT);
 
 	/* Add flags and reserved fields */
-	net_nbuf_write_u8(buf, buf->frags,
-			  sizeof(struct net_ipv6_hdr) +
-			  sizeof(struct net_icmp_hdr),
-			  &pos, 0);
-	net_nbuf_write_u8(buf, buf->frags, pos, &pos, 0);
+	frag = net_nbuf_write_u8(buf, buf->frags,
+				 sizeof(struct net_ipv6_hdr) +
+				 sizeof(struct net_icmp_hdr),
+				 &pos, 0);
+	net_nbuf_write_u8(buf, frag, pos, &pos, 0);
 
 	buf = net_ipv6_finalize_raw(buf, IPPROTO_ICMPV6);
 
@@ -767,6 +790,8 @@ static enum net_verdict handle_dis(struct net_buf *buf)
 
 	net_rpl_info(buf, "DODAG Information Solicitation");
 
+	net_stats_update_rpl_dis_recv();
+
 	for (instance = &rpl_instances[0];
 	     instance < &rpl_instances[0] + CONFIG_NET_RPL_MAX_INSTANCES;
 	     instance++) {
@@ -1059,10 +1084,104 @@ static void route_mcast_rm_cb(struct net_route_entry_mcast *route,
 }
 #endif
 
+#if defined(CONFIG_NET_RPL_MOP1)
+static struct net_rpl_ns_node *ns_node_lookup(struct net_rpl_dag *dag,
+					      struct in6_addr *addr)
+{
+	int64_t now = k_uptime_get();
+	int i;
+
+	for (i = 0; i < CONFIG_NET_RPL_NS_NODES; i++) {
+		struct net_rpl_ns_node *node = &rpl_ns_nodes[i];
+
+		if (!node->is_used) {
+			continue;
+		}
+
+		if (node->expires && node->expires <= now) {
+			NET_DBG("Link of %s expired",
+				net_sprint_ipv6_addr(&node->addr));
+			node->is_used = false;
+			continue;
+		}
+
+		if (node->dag == dag && net_ipv6_addr_cmp(&node->addr, addr)) {
+			return node;
+		}
+	}
+
+	return NULL;
+}
+
+static int ns_node_update(struct net_rpl_dag *dag, struct in6_addr *addr,
+			  struct in6_addr *parent, uint8_t lifetime)
+{
+	struct net_rpl_ns_node *node;
+	int i;
+
+	node = ns_node_lookup(dag, addr);
+	if (!node) {
+		for (i = 0; i < CONFIG_NET_RPL_NS_NODES; i++) {
+			if (!rpl_ns_nodes[i].is_used) {
+				node = &rpl_ns_nodes[i];
+				break;
+			}
+		}
+
+		if (!node) {
+			NET_DBG("No room for the link of %s",
+				net_sprint_ipv6_addr(addr));
+			net_stats_update_rpl_mem_overflows();
+			return -ENOMEM;
+		}
+
+		net_ipaddr_copy(&node->addr, addr);
+		node->dag = dag;
+		node->is_used = true;
+	}
+
+	net_ipaddr_copy(&node->parent, parent);
+
+	if (lifetime == NET_RPL_INFINITE_LIFETIME) {
+		node->expires = 0;
+	} else {
+		node->expires = k_uptime_get() + MSEC_PER_SEC *
+			(int64_t)net_rpl_lifetime(dag->instance, lifetime);
+	}
+
+	return 0;
+}
+
+static void ns_node_remove(struct net_rpl_dag *dag, struct in6_addr *addr)
+{
+	struct net_rpl_ns_node *node;
+
+	node = ns_node_lookup(dag, addr);
+	if (node) {
+		node->is_used = false;
+	}
+}
+
+static void ns_nodes_remove(struct net_rpl_dag *dag)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NET_RPL_NS_NODES; i++) {
+		if (rpl_ns_nodes[i].dag == dag) {
+			rpl_ns_nodes[i].is_used = false;
+		}
+	}
+}
+#endif /* CONFIG_NET_RPL_MOP1 */
+
 static void net_rpl_remove_routes(struct net_rpl_dag *dag)
 {
 	net_route_foreach(route_rm_cb, dag);
 
+#if defined(CONFIG_NET_RPL_MOP1)
+	ns_nodes_remove(dag);
+#endif
+
 #if NET_RPL_MULTICAST
 	net_route_mcast_foreach(route_mcast_rm_cb, dag);
 #endif
@@ -2466,6 +2585,7 @@ static void net_rpl_process_dio(struct net_if *iface,
 #endif
 	{
 		NET_DBG("Ignoring a DIO with an unsupported MOP %d", dio->mop);
+		net_stats_update_rpl_dio_drop();
 		return;
 	}
 
@@ -2663,6 +2783,8 @@ static enum net_verdict handle_dio(struct net_buf *buf)
 
 	net_rpl_info(buf, "DODAG Information Object");
 
+	net_stats_update_rpl_dio_recv();
+
 	/* Default values can be overwritten by DIO config option.
 	 */
 	dio.dag_interval_doublings = CONFIG_NET_RPL_DIO_INTERVAL_DOUBLINGS;
@@ -2909,14 +3031,115 @@ static enum net_verdict handle_dio(struct net_buf *buf)
 	net_rpl_process_dio(net_nbuf_iface(buf), &NET_IPV6_BUF(buf)->src,
 			    &dio);
 
+	return NET_DROP;
+
 out:
+	net_stats_update_rpl_dio_drop();
+
 	return NET_DROP;
 }
 
-int net_rpl_dao_send(struct net_if *iface,
-		     struct net_rpl_parent *parent,
-		     struct in6_addr *prefix,
-		     uint8_t lifetime)
+static void dao_append_target(struct net_buf *buf, struct in6_addr *prefix,
+			      uint8_t prefixlen)
+{
+	uint8_t prefix_bytes = (prefixlen + 7) / CHAR_BIT;
+
+	net_nbuf_append_u8(buf, NET_RPL_OPTION_TARGET);
+	net_nbuf_append_u8(buf, 2 + prefix_bytes);
+	net_nbuf_append_u8(buf, 0); /* reserved */
+	net_nbuf_append_u8(buf, prefixlen);
+	net_nbuf_append(buf, prefix_bytes, prefix->s6_addr);
+}
+
+#if defined(CONFIG_NET_RPL_MOP1)
+/* The global address of a DAO parent, built from the DODAG prefix like the
+ * one of this node. The root is known by its DODAG ID.
+ */
+static bool get_parent_global_addr(struct net_if *iface,
+				   struct net_rpl_parent *parent,
+				   struct in6_addr *addr)
+{
+	struct net_rpl_dag *dag = parent->dag;
+	struct net_linkaddr_storage *storage;
+	struct net_linkaddr lladdr;
+	struct net_nbr *nbr;
+
+	if (parent->rank == NET_RPL_ROOT_RANK(dag->instance)) {
+		net_ipaddr_copy(addr, &dag->dag_id);
+		return true;
+	}
+
+	nbr = net_rpl_get_nbr(parent);
+	if (!nbr || nbr->idx == NET_NBR_LLADDR_UNKNOWN) {
+		return false;
+	}
+
+	storage = net_nbr_get_lladdr(nbr->idx);
+
+	lladdr.addr = storage->addr;
+	lladdr.len = storage->len;
+
+	set_ip_from_prefix(&lladdr, &dag->prefix_info, addr);
+
+	return true;
+}
+#endif /* CONFIG_NET_RPL_MOP1 */
+
+#if defined(CONFIG_NET_RPL_DAO_AGGREGATION)
+struct dao_targets {
+	struct net_buf *buf;
+	struct net_rpl_dag *dag;
+	/* Routes advertised by the previous DAOs */
+	uint16_t skip;
+	uint8_t room;
+	uint8_t count;
+	bool more;
+};
+
+/* The routes learned from the DAOs of the sub-DODAG are advertised in
+ * our own DAOs.
+ */
+static void dao_route_target_cb(struct net_route_entry *route,
+				void *user_data)
+{
+	struct dao_targets *targets = user_data;
+	struct net_rpl_route_entry *extra;
+
+	extra = net_nbr_extra_data(net_route_get_nbr(route));
+
+	if (extra->dag != targets->dag ||
+	    extra->route_source != NET_RPL_ROUTE_UNICAST_DAO ||
+	    extra->no_path_received) {
+		return;
+	}
+
+	if (targets->skip) {
+		targets->skip--;
+		return;
+	}
+
+	if (!targets->room) {
+		targets->more = true;
+		return;
+	}
+
+	dao_append_target(targets->buf, &route->addr, route->prefix_len);
+
+	targets->room--;
+	targets->count++;
+}
+#endif /* CONFIG_NET_RPL_DAO_AGGREGATION */
+
+/* Send a DAO for our prefix and, when aggregating, for the routes of the
+ * sub-DODAG after the *skip first ones. *more tells whether some routes
+ * did not fit in this DAO.
+ */
+static int dao_send_targets(struct net_if *iface,
+			    struct net_rpl_parent *parent,
+			    struct in6_addr *prefix,
+			    uint8_t lifetime,
+			    uint16_t *skip,
+			    bool *more)
 {
 	uint16_t value = 0;
 	struct net_rpl_instance *instance;
@@ -2924,10 +3147,10 @@ int net_rpl_dao_send(struct net_if *iface,
 	struct net_rpl_dag *dag;
 	struct in6_addr *dst;
 	struct net_buf *buf;
-	uint8_t prefix_bytes;
-	uint8_t prefixlen;
 	int ret;
 
+	*more = false;
+
 	/* No DAOs in feather mode. */
 	if (net_rpl_get_mode() == NET_RPL_MODE_FEATHER) {
 		return -EINVAL;
@@ -2993,27 +3216,65 @@ int net_rpl_dao_send(struct net_if *iface,
 	net_nbuf_append(buf, sizeof(dag->dag_id), dag->dag_id.s6_addr);
 #endif
 
-	prefixlen = sizeof(*prefix) * CHAR_BIT;
-	prefix_bytes = (prefixlen + 7) / CHAR_BIT;
+	if (prefix) {
+		dao_append_target(buf, prefix, sizeof(*prefix) * CHAR_BIT);
+	}
 
-	net_nbuf_append_u8(buf, NET_RPL_OPTION_TARGET);
-	net_nbuf_append_u8(buf, 2 + prefix_bytes);
-	net_nbuf_append_u8(buf, 0); /* reserved */
-	net_nbuf_append_u8(buf, prefixlen);
-	net_nbuf_append(buf, prefix_bytes, prefix->s6_addr);
+#if defined(CONFIG_NET_RPL_DAO_AGGREGATION)
+	if (lifetime != NET_RPL_ZERO_LIFETIME) {
+		struct dao_targets targets = {
+			.buf = buf,
+			.dag = dag,
+			.skip = *skip,
+			.room = CONFIG_NET_RPL_DAO_MAX_TARGETS - !!prefix,
+		};
 
+		net_route_foreach(dao_route_target_cb, &targets);
+
+		*skip += targets.count;
+		*more = targets.more;
+
+		net_stats_update_rpl_dao_aggregated(targets.count);
+	}
+#endif
+
+	/* The transit information applies to all the targets above */
 	net_nbuf_append_u8(buf, NET_RPL_OPTION_TRANSIT);
-	net_nbuf_append_u8(buf, 4); /* length */
-	net_nbuf_append_u8(buf, 0); /* flags */
-	net_nbuf_append_u8(buf, 0); /* path control */
-	net_nbuf_append_u8(buf, 0); /* path seq */
-	net_nbuf_append_u8(buf, lifetime);
+
+#if defined(CONFIG_NET_RPL_MOP1)
+	if (instance->mop == NET_RPL_MOP_NON_STORING) {
+		struct in6_addr parent_addr;
+
+		if (!get_parent_global_addr(iface, parent, &parent_addr)) {
+			NET_DBG("No global address for parent %p", parent);
+			net_nbuf_unref(buf);
+			return -EINVAL;
+		}
+
+		net_nbuf_append_u8(buf, 4 + sizeof(parent_addr)); /* length */
+		net_nbuf_append_u8(buf, 0); /* flags */
+		net_nbuf_append_u8(buf, 0); /* path control */
+		net_nbuf_append_u8(buf, 0); /* path seq */
+		net_nbuf_append_u8(buf, lifetime);
+		net_nbuf_append(buf, sizeof(parent_addr),
+				parent_addr.s6_addr);
+	} else
+#endif
+	{
+		net_nbuf_append_u8(buf, 4); /* length */
+		net_nbuf_append_u8(buf, 0); /* flags */
+		net_nbuf_append_u8(buf, 0); /* path control */
+		net_nbuf_append_u8(buf, 0); /* path seq */
+		net_nbuf_append_u8(buf, lifetime);
+	}
 
 	buf = net_ipv6_finalize_raw(buf, IPPROTO_ICMPV6);
 
 	ret = net_send_data(buf);
 	if (ret >= 0) {
-		net_rpl_dao_info(buf, src, dst, prefix);
+		if (prefix) {
+			net_rpl_dao_info(buf, src, dst, prefix);
+		}
 
 		net_stats_update_icmp_sent();
 		net_stats_update_rpl_dao_sent();
@@ -3024,6 +3285,25 @@ int net_rpl_dao_send(struct net_if *iface,
 	return ret;
 }
 
+int net_rpl_dao_send(struct net_if *iface,
+		     struct net_rpl_parent *parent,
+		     struct in6_addr *prefix,
+		     uint8_t lifetime)
+{
+	uint16_t skip = 0;
+	bool more;
+	int ret;
+
+	ret = dao_send_targets(iface, parent, prefix, lifetime, &skip, &more);
+
+	while (ret >= 0 && more) {
+		ret = dao_send_targets(iface, parent, NULL, lifetime, &skip,
+				       &more);
+	}
+
+	return ret;
+}
+
 static int dao_send(struct net_rpl_parent *parent,
 		    uint8_t lifetime,
 		    struct net_if *iface)
@@ -3060,6 +3340,7 @@ static inline int dao_forward(struct net_if *iface,
 	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, dst);
 
 	net_nbuf_set_iface(buf, iface);
+	net_nbuf_set_family(buf, AF_INET6);
 	net_nbuf_set_ll_reserve(buf, net_if_get_ll_reserve(iface, dst));
 
 	ret = net_send_data(buf);
@@ -3122,10 +3403,7 @@ static int dao_ack_send(struct net_buf *orig,
 
 static void forwarding_dao(struct net_rpl_instance *instance,
 			   struct net_rpl_dag *dag,
-			   struct in6_addr *dao_sender,
 			   struct net_buf *buf,
-			   uint8_t sequence,
-			   uint8_t flags,
 			   char *str)
 {
 	struct in6_addr *paddr;
@@ -3136,37 +3414,251 @@ static void forwarding_dao(struct net_rpl_instance *instance,
 		NET_DBG("%s %s", str, net_sprint_ipv6_addr(paddr));
 
 		dao_forward(dag->instance->iface, buf, paddr);
+	}
+}
+
+struct dao_target {
+	struct in6_addr addr;
+	uint8_t len;
+};
+
+/* State of the DAO being handled, shared by all its targets */
+struct dao_ctx {
+	struct net_buf *buf;
+	struct net_rpl_instance *instance;
+	struct net_rpl_dag *dag;
+	struct in6_addr *sender;
+	enum net_rpl_route_source learned_from;
+	/* The DAO is sent on to our parent */
+	bool forward;
+	/* The targets are advertised in our next DAO instead */
+	bool aggregate;
+	bool nbr_added;
+};
+
+static bool dao_add_nbr(struct net_buf *buf, struct in6_addr *addr)
+{
+	struct net_if *iface = net_nbuf_iface(buf);
+	struct net_nbr *nbr;
+
+	nbr = net_ipv6_nbr_lookup(iface, addr);
+	if (nbr) {
+		NET_DBG("Neighbor %s [%s] already in neighbor cache",
+			net_sprint_ipv6_addr(addr),
+			net_sprint_ll_addr(net_nbuf_ll_src(buf)->addr,
+					   net_nbuf_ll_src(buf)->len));
+		return true;
+	}
+
+	nbr = net_ipv6_nbr_add(iface, addr, net_nbuf_ll_src(buf), false,
+			       NET_NBR_REACHABLE);
+	if (!nbr) {
+		NET_DBG("Out of memory, dropping DAO from %s [%s]",
+			net_sprint_ipv6_addr(addr),
+			net_sprint_ll_addr(net_nbuf_ll_src(buf)->addr,
+					   net_nbuf_ll_src(buf)->len));
+		return false;
+	}
+
+	/* Set reachable timer */
+	net_ipv6_nbr_set_reachable_timer(iface, nbr);
+
+	NET_DBG("Neighbor %s [%s] added to neighbor cache",
+		net_sprint_ipv6_addr(addr),
+		net_sprint_ll_addr(net_nbuf_ll_src(buf)->addr,
+				   net_nbuf_ll_src(buf)->len));
+
+	return true;
+}
+
+static int dao_storing_target(struct dao_ctx *ctx, struct dao_target *target,
+			      uint8_t lifetime)
+{
+	struct net_if *iface = net_nbuf_iface(ctx->buf);
+	struct net_rpl_route_entry *extra;
+	struct net_route_entry *route;
 
-		if (flags & NET_RPL_DAO_K_FLAG) {
-			dao_ack_send(buf, instance, dao_sender, sequence);
+#if NET_RPL_MULTICAST
+	if (net_is_ipv6_addr_mcast_global(&target->addr)) {
+		struct net_route_entry_mcast *mcast_group;
+
+		mcast_group = net_route_mcast_add(iface, &target->addr);
+		if (mcast_group) {
+			mcast_group->data = (void *)ctx->dag;
+			mcast_group->lifetime =
+				net_rpl_lifetime(ctx->instance, lifetime);
 		}
+
+		ctx->forward = true;
+		return 0;
 	}
+#endif
+
+	route = net_route_lookup(iface, &target->addr);
+
+	if (lifetime == NET_RPL_ZERO_LIFETIME) {
+		struct in6_addr *nexthop;
+
+		NET_DBG("No-Path DAO received");
+
+		if (!route) {
+			return 0;
+		}
+
+		extra = net_nbr_extra_data(net_route_get_nbr(route));
+		nexthop = net_route_get_nexthop(route);
+
+		/* No-Path DAO received; invoke the route purging routine. */
+		if (!extra->no_path_received &&
+		    route->prefix_len == target->len && nexthop &&
+		    net_ipv6_addr_cmp(nexthop, ctx->sender)) {
+			NET_DBG("Setting expiration timer for target %s",
+				net_sprint_ipv6_addr(&target->addr));
+
+			extra->no_path_received = true;
+			extra->lifetime = NET_RPL_DAO_EXPIRATION_TIMEOUT;
+
+			/* We forward the incoming no-path DAO to our parent,
+			 * if we have one.
+			 */
+			ctx->forward = true;
+		}
+
+		return 0;
+	}
+
+	NET_DBG("Adding DAO route");
+
+	if (!ctx->nbr_added) {
+		if (!dao_add_nbr(ctx->buf, ctx->sender)) {
+			return -ENOMEM;
+		}
+
+		ctx->nbr_added = true;
+	}
+
+	route = net_rpl_add_route(ctx->dag, iface, &target->addr,
+				  target->len, ctx->sender);
+	if (!route) {
+		net_stats_update_rpl_mem_overflows();
+
+		NET_DBG("Could not add a route after receiving a DAO");
+		return -ENOMEM;
+	}
+
+	extra = net_nbr_extra_data(net_route_get_nbr(route));
+	extra->lifetime = net_rpl_lifetime(ctx->instance, lifetime);
+	extra->route_source = ctx->learned_from;
+	extra->no_path_received = false;
+
+#if defined(CONFIG_NET_RPL_DAO_AGGREGATION)
+	if (ctx->learned_from == NET_RPL_ROUTE_UNICAST_DAO) {
+		ctx->aggregate = true;
+		return 0;
+	}
+#endif
+
+	ctx->forward = true;
+
+	return 0;
+}
+
+#if defined(CONFIG_NET_RPL_MOP1)
+static int dao_non_storing_target(struct dao_ctx *ctx,
+				  struct dao_target *target,
+				  uint8_t lifetime,
+				  struct in6_addr *parent)
+{
+	struct net_if *iface;
+
+	/* A child of ours is reached on the link at its global address,
+	 * the routers of the path do not need any other state.
+	 */
+	if (lifetime != NET_RPL_ZERO_LIFETIME &&
+	    target->len == sizeof(target->addr) * CHAR_BIT &&
+	    net_if_ipv6_addr_lookup(parent, &iface)) {
+		if (!dao_add_nbr(ctx->buf, &target->addr)) {
+			return -ENOMEM;
+		}
+	}
+
+	if (ctx->dag->rank != NET_RPL_ROOT_RANK(ctx->instance)) {
+		ctx->forward = true;
+		return 0;
+	}
+
+	NET_DBG("Parent of %s/%d is %s", net_sprint_ipv6_addr(&target->addr),
+		target->len, net_sprint_ipv6_addr(parent));
+
+	if (lifetime == NET_RPL_ZERO_LIFETIME) {
+		ns_node_remove(ctx->dag, &target->addr);
+		return 0;
+	}
+
+	return ns_node_update(ctx->dag, &target->addr, parent, lifetime);
+}
+#endif /* CONFIG_NET_RPL_MOP1 */
+
+/* A transit option applies to the targets preceding it */
+static int dao_process_targets(struct dao_ctx *ctx,
+			       struct dao_target *targets, uint8_t count,
+			       uint8_t lifetime, struct in6_addr *parent)
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < count && !ret; i++) {
+		NET_DBG("DAO lifetime %d addr %s/%d", lifetime,
+			net_sprint_ipv6_addr(&targets[i].addr),
+			targets[i].len);
+
+#if defined(CONFIG_NET_RPL_MOP1)
+		if (ctx->instance->mop == NET_RPL_MOP_NON_STORING) {
+			if (!parent) {
+				NET_DBG("No parent address in DAO transit");
+				return -EINVAL;
+			}
+
+			ret = dao_non_storing_target(ctx, &targets[i],
+						     lifetime, parent);
+			continue;
+		}
+#endif
+
+		ret = dao_storing_target(ctx, &targets[i], lifetime);
+	}
+
+	return ret;
 }
 
 static enum net_verdict handle_dao(struct net_buf *buf)
 {
+	struct dao_target targets[CONFIG_NET_RPL_DAO_MAX_TARGETS];
 	struct in6_addr *dao_sender = &NET_IPV6_BUF(buf)->src;
-	struct net_rpl_route_entry *extra = NULL;
+	struct in6_addr *transit_parent;
 	struct net_rpl_parent *parent = NULL;
 	enum net_rpl_route_source learned_from;
 	struct net_rpl_instance *instance;
-	struct net_route_entry *route;
+	struct in6_addr parent_addr;
+	struct dao_target *target;
 	struct net_rpl_dag *dag;
+	struct dao_ctx ctx;
 	struct net_buf *frag;
 	struct in6_addr addr;
-	struct net_nbr *nbr;
 	uint16_t offset;
 	uint16_t pos;
 	uint8_t sequence;
 	uint8_t instance_id;
 	uint8_t lifetime;
-	uint8_t target_len;
+	uint8_t count = 0;
 	uint8_t flags;
 	uint8_t subopt_type;
 	int len;
 
 	net_rpl_info(buf, "Destination Advertisement Object");
 
+	net_stats_update_rpl_dao_recv();
+
 	/* offset tells now where the ICMPv6 header is starting */
 	offset = net_nbuf_icmp_data(buf) - net_nbuf_ip_data(buf);
 
@@ -3178,11 +3670,9 @@ static enum net_verdict handle_dao(struct net_buf *buf)
 	if (!instance) {
 		NET_DBG("Ignoring DAO for an unknown instance %d",
 			instance_id);
-		return NET_DROP;
+		goto out;
 	}
 
-	lifetime = instance->default_lifetime;
-
 	frag = net_nbuf_read_u8(frag, pos, &pos, &flags);
 	frag = net_nbuf_skip(frag, pos, &pos, 1); /* reserved */
 	frag = net_nbuf_read_u8(frag, pos, &pos, &sequence);
@@ -3197,7 +3687,7 @@ static enum net_verdict handle_dao(struct net_buf *buf)
 		if (memcmp(&dag->dag_id, &addr, sizeof(dag->dag_id))) {
 			NET_DBG("Ignoring DAO for a DAG %s different from ours",
 				net_sprint_ipv6_addr(&dag->dag_id));
-			return NET_DROP;
+			goto out;
 		}
 	}
 
@@ -3224,7 +3714,7 @@ static enum net_verdict handle_dao(struct net_buf *buf)
 				NET_RPL_DAG_RANK(dag->rank, instance));
 			parent->rank = NET_RPL_INFINITE_RANK;
 			parent->flags |= NET_RPL_PARENT_FLAG_UPDATED;
-			return NET_DROP;
+			goto out;
 		}
 
 		/* If we get the DAO from our parent, we also have a loop. */
@@ -3233,11 +3723,16 @@ static enum net_verdict handle_dao(struct net_buf *buf)
 				"from our parent");
 			parent->rank = NET_RPL_INFINITE_RANK;
 			parent->flags |= NET_RPL_PARENT_FLAG_UPDATED;
-			return NET_DROP;
+			goto out;
 		}
 	}
 
-	target_len = 0;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.buf = buf;
+	ctx.instance = instance;
+	ctx.dag = dag;
+	ctx.sender = dao_sender;
+	ctx.learned_from = learned_from;
 
 	/* Handle any DAO suboptions */
 	while (frag) {
@@ -3269,143 +3764,122 @@ static enum net_verdict handle_dao(struct net_buf *buf)
 		NET_DBG("DAO option %u length %d", subopt_type, len - 2);
 
 		switch (subopt_type) {
-		case NET_RPL_OPTION_TARGET:
-			frag = net_nbuf_skip(frag, pos, &pos, 1); /* reserved */
-			frag = net_nbuf_read_u8(frag, pos, &pos, &target_len);
-			frag = net_nbuf_read(frag, pos, &pos,
-					     (target_len + 7) / 8,
-					     addr.s6_addr);
-			break;
-		case NET_RPL_OPTION_TRANSIT:
-			/* The path sequence and control are ignored. */
-			frag = net_nbuf_skip(frag, pos, &pos, 2);
-			frag = net_nbuf_read_u8(frag, pos, &pos, &lifetime);
+		case NET_RPL_OPTION_PAD1:
 			break;
-		}
-	}
-
-	NET_DBG("DAO lifetime %d addr %s/%d", lifetime,
-		net_sprint_ipv6_addr(&addr), target_len);
-
-#if NET_RPL_MULTICAST
-	if (net_is_ipv6_addr_mcast_global(&addr)) {
-		struct net_route_entry_mcast *mcast_group;
+		case NET_RPL_OPTION_TARGET:
+			if (count == ARRAY_SIZE(targets)) {
+				NET_DBG("Too many targets in DAO, ignoring");
+				frag = net_nbuf_skip(frag, pos, &pos, len - 2);
+				break;
+			}
 
-		mcast_group = net_route_mcast_add(net_nbuf_iface(buf), &addr);
-		if (mcast_group) {
-			mcast_group->data = (void *)dag;
-			mcast_group->lifetime = net_rpl_lifetime(instance,
-								 lifetime);
-		}
+			target = &targets[count];
+			memset(&target->addr, 0, sizeof(target->addr));
 
-		goto fwd_dao;
-	}
-#endif
+			frag = net_nbuf_skip(frag, pos, &pos, 1); /* reserved */
+			frag = net_nbuf_read_u8(frag, pos, &pos, &target->len);
 
-	route = net_route_lookup(net_nbuf_iface(buf), &addr);
+			len -= 4;
+			if (target->len > sizeof(target->addr) * CHAR_BIT ||
+			    len < (target->len + 7) / 8) {
+				NET_DBG("Invalid DAO target length %d",
+					target->len);
+				net_stats_update_rpl_malformed_msgs();
+				goto out;
+			}
 
-	if (lifetime == NET_RPL_ZERO_LIFETIME) {
-		struct in6_addr *nexthop;
+			frag = net_nbuf_read(frag, pos, &pos,
+					     (target->len + 7) / 8,
+					     target->addr.s6_addr);
+			len -= (target->len + 7) / 8;
+			if (len) {
+				frag = net_nbuf_skip(frag, pos, &pos, len);
+			}
 
-		NET_DBG("No-Path DAO received");
+			count++;
+			break;
+		case NET_RPL_OPTION_TRANSIT:
+			if (len < 6) {
+				NET_DBG("Invalid DAO transit length %d", len);
+				net_stats_update_rpl_malformed_msgs();
+				goto out;
+			}
 
-		nbr = net_route_get_nbr(route);
-		extra = net_nbr_extra_data(nbr);
-		nexthop = net_route_get_nexthop(route);
+			/* The flags, path control and sequence are ignored. */
+			frag = net_nbuf_skip(frag, pos, &pos, 3);
+			frag = net_nbuf_read_u8(frag, pos, &pos, &lifetime);
 
-		/* No-Path DAO received; invoke the route purging routine. */
-		if (route && !extra->no_path_received &&
-		    route->prefix_len == target_len && nexthop &&
-		    net_ipv6_addr_cmp(nexthop, dao_sender)) {
-			NET_DBG("Setting expiration timer for target %s",
-				net_sprint_ipv6_addr(&addr));
+			len -= 6;
+			transit_parent = NULL;
 
-			extra->no_path_received = true;
-			extra->lifetime = NET_RPL_DAO_EXPIRATION_TIMEOUT;
+			if (len >= sizeof(parent_addr)) {
+				frag = net_nbuf_read(frag, pos, &pos,
+						     sizeof(parent_addr),
+						     parent_addr.s6_addr);
+				len -= sizeof(parent_addr);
+				transit_parent = &parent_addr;
+			}
 
-			/* We forward the incoming no-path DAO to our parent,
-			 * if we have one.
-			 */
-			if (dag->preferred_parent) {
-				forwarding_dao(instance, dag, dao_sender,
-					       buf, sequence, flags,
-#if defined(CONFIG_NET_DEBUG_RPL)
-					       "Forwarding no-path DAO to "
-					       "parent"
-#else
-					       ""
-#endif
-					);
+			if (len) {
+				frag = net_nbuf_skip(frag, pos, &pos, len);
 			}
-		}
 
-		return NET_DROP;
-	}
+			if (dao_process_targets(&ctx, targets, count,
+						lifetime, transit_parent) < 0) {
+				goto out;
+			}
 
-	NET_DBG("Adding DAO route");
+			count = 0;
+			break;
+		default:
+			frag = net_nbuf_skip(frag, pos, &pos, len - 2);
+		}
 
-	nbr = net_ipv6_nbr_lookup(net_nbuf_iface(buf), dao_sender);
-	if (!nbr) {
-		nbr = net_ipv6_nbr_add(net_nbuf_iface(buf), dao_sender,
-				       net_nbuf_ll_src(buf), false,
-				       NET_NBR_REACHABLE);
-		if (nbr) {
-			/* Set reachable timer */
-			net_ipv6_nbr_set_reachable_timer(net_nbuf_iface(buf),
-							 nbr);
-
-			NET_DBG("Neighbor %s [%s] added to neighbor cache",
-				net_sprint_ipv6_addr(dao_sender),
-				net_sprint_ll_addr(net_nbuf_ll_src(buf)->addr,
-						   net_nbuf_ll_src(buf)->len));
-		} else {
-			NET_DBG("Out of memory, dropping DAO from %s [%s]",
-				net_sprint_ipv6_addr(dao_sender),
-				net_sprint_ll_addr(net_nbuf_ll_src(buf)->addr,
-						   net_nbuf_ll_src(buf)->len));
-			return NET_DROP;
+		if (!frag && pos) {
+			NET_DBG("Invalid DAO packet");
+			net_stats_update_rpl_malformed_msgs();
+			goto out;
 		}
-	} else {
-		NET_DBG("Neighbor %s [%s] already in neighbor cache",
-			net_sprint_ipv6_addr(dao_sender),
-			net_sprint_ll_addr(net_nbuf_ll_src(buf)->addr,
-					   net_nbuf_ll_src(buf)->len));
 	}
 
-	route = net_rpl_add_route(dag, net_nbuf_iface(buf),
-				  &addr, target_len, dao_sender);
-	if (!route) {
-		net_stats_update_rpl_mem_overflows();
-
-		NET_DBG("Could not add a route after receiving a DAO");
-		return NET_DROP;
+	/* Targets without a transit option get the default lifetime */
+	if (count && dao_process_targets(&ctx, targets, count,
+					 instance->default_lifetime,
+					 NULL) < 0) {
+		goto out;
 	}
 
-	if (extra) {
-		extra->lifetime = net_rpl_lifetime(instance, lifetime);
-		extra->route_source = learned_from;
-		extra->no_path_received = false;
+	/* The ACK is sent before the frags are handed to the forwarded
+	 * DAO.
+	 */
+	if (learned_from == NET_RPL_ROUTE_UNICAST_DAO &&
+	    (flags & NET_RPL_DAO_K_FLAG)) {
+		dao_ack_send(buf, instance, dao_sender, sequence);
 	}
 
-#if NET_RPL_MULTICAST
-fwd_dao:
-#endif
-
-	if (learned_from == NET_RPL_ROUTE_UNICAST_DAO) {
-		if (dag->preferred_parent) {
-			forwarding_dao(instance, dag,
-				       dao_sender, buf,
-				       sequence, flags,
+	if (ctx.forward && learned_from == NET_RPL_ROUTE_UNICAST_DAO &&
+	    dag->preferred_parent) {
+		forwarding_dao(instance, dag, buf,
 #if defined(CONFIG_NET_DEBUG_RPL)
-				       "Forwarding DAO to parent"
+			       "Forwarding DAO to parent"
 #else
-				       ""
+			       ""
 #endif
-				);
-		}
+			);
 	}
 
+	if (ctx.aggregate) {
+		/* Our DAO is delayed so that the DAOs of the other children
+		 * are advertised along.
+		 */
+		net_rpl_schedule_dao(instance);
+	}
+
+	return NET_DROP;
+
 out:
+	net_stats_update_rpl_dao_drop();
+
 	return NET_DROP;
 }
 
@@ -3474,15 +3948,17 @@ int net_rpl_update_header(struct net_buf *buf, struct in6_addr *addr)
 		}
 
 		if (next == NET_RPL_EXT_HDR_OPT_RPL) {
+			struct net_buf *flags_frag;
 			uint16_t sender_rank, offset;
 
 			frag = net_nbuf_skip(frag, pos, &pos, 1); /* opt type */
 			frag = net_nbuf_skip(frag, pos, &pos, 1); /* opt len */
 
-			offset = pos; /* Where the flags is located in the
-				       * packet, that info is need few lines
-				       * below.
-				       */
+			/* Where the flags is located in the packet, that
+			 * info is need few lines below.
+			 */
+			flags_frag = frag;
+			offset = pos;
 
 			frag = net_nbuf_skip(frag, pos, &pos, 1); /* flags */
 			frag = net_nbuf_skip(frag, pos, &pos, 1); /* instance */
@@ -3513,17 +3989,18 @@ int net_rpl_update_header(struct net_buf *buf, struct in6_addr *addr)
 
 				if (!parent ||
 				    parent != parent->dag->preferred_parent) {
-					net_nbuf_write_u8(buf, buf->frags,
+					net_nbuf_write_u8(buf, flags_frag,
 							  offset, &pos,
 							  NET_RPL_HDR_OPT_DOWN);
 				}
 
 				offset++;
 
-				net_nbuf_write_u8(buf, buf->frags, offset, &pos,
+				frag = net_nbuf_write_u8(buf, flags_frag,
+					     offset, &pos,
 					     rpl_default_instance->instance_id);
 
-				net_nbuf_write_be16(buf, buf->frags, pos, &pos,
+				net_nbuf_write_be16(buf, frag, pos, &pos,
 					     htons(rpl_default_instance->
 						   current_dag->rank));
 			}
@@ -3533,20 +4010,20 @@ int net_rpl_update_header(struct net_buf *buf, struct in6_addr *addr)
 	return 0;
 }
 
-bool net_rpl_verify_header(struct net_buf *buf,
+bool net_rpl_verify_header(struct net_buf *buf, struct net_buf *frag,
 			   uint16_t offset, uint16_t *pos)
 {
 	struct net_rpl_instance *instance;
-	struct net_buf *frag;
-	uint16_t sender_rank;
+	struct net_buf *cur;
+	uint16_t sender_rank, tmp;
 	uint8_t instance_id, flags;
 	bool down, sender_closer;
 
-	frag = net_nbuf_read_u8(buf, offset, pos, &flags);
-	frag = net_nbuf_read_u8(frag, *pos, pos, &instance_id);
-	frag = net_nbuf_read_be16(frag, *pos, pos, &sender_rank);
+	cur = net_nbuf_read_u8(frag, offset, pos, &flags);
+	cur = net_nbuf_read_u8(cur, *pos, pos, &instance_id);
+	cur = net_nbuf_read_be16(cur, *pos, pos, &sender_rank);
 
-	if (!frag && *pos == 0xffff) {
+	if (!cur && *pos == 0xffff) {
 		return false;
 	}
 
@@ -3621,7 +4098,8 @@ bool net_rpl_verify_header(struct net_buf *buf,
 		NET_DBG("Single error tolerated.");
 		net_stats_update_rpl_loop_warnings();
 
-		net_nbuf_write_u8(buf, buf->frags, offset, pos,
+		/* The flags are at the start of the option */
+		net_nbuf_write_u8(buf, frag, offset, &tmp,
 				  flags | NET_RPL_HDR_OPT_RANK_ERR);
 
 		return true;
@@ -3697,10 +4175,11 @@ static int net_rpl_update_header_empty(struct net_buf *buf)
 	struct net_rpl_instance *instance;
 	struct net_rpl_parent *parent;
 	struct net_route_entry *route;
+	struct net_buf *flags_frag;
 	uint8_t next_hdr, len, length;
 	uint8_t opt_type = 0, opt_len;
 	uint8_t instance_id, flags;
-	uint16_t pos;
+	uint16_t pos, flags_pos;
 
 	NET_DBG("Verifying the presence of the RPL header option");
 
@@ -3750,7 +4229,11 @@ static int net_rpl_update_header_empty(struct net_buf *buf)
 		return 0;
 	}
 
-	frag = net_nbuf_read_u8(buf, offset, &offset, &flags);
+	/* The flags are updated below */
+	flags_frag = frag;
+	flags_pos = offset;
+
+	frag = net_nbuf_read_u8(frag, offset, &offset, &flags);
 	frag = net_nbuf_read_u8(frag, offset, &offset, &instance_id);
 
 	instance = net_rpl_get_instance(instance_id);
@@ -3772,8 +4255,6 @@ static int net_rpl_update_header_empty(struct net_buf *buf)
 	net_nbuf_write_be16(buf, frag, offset, &pos,
 			    instance->current_dag->rank);
 
-	offset -= 2; /* move back to flags */
-
 	route = net_route_lookup(net_nbuf_iface(buf), &NET_IPV6_BUF(buf)->dst);
 
 	/*
@@ -3786,7 +4267,7 @@ static int net_rpl_update_header_empty(struct net_buf *buf)
 		struct net_nbr *nbr;
 
 		if (!route) {
-			net_nbuf_write_u8(buf, frag, offset, &pos,
+			net_nbuf_write_u8(buf, flags_frag, flags_pos, &pos,
 					  flags |= NET_RPL_HDR_OPT_FWD_ERR);
 
 			NET_DBG("RPL forwarding error");
@@ -3828,7 +4309,7 @@ static int net_rpl_update_header_empty(struct net_buf *buf)
 		 * towards the RPL root. If so, we should not
 		 * set the down flag.
 		 */
-		net_nbuf_write_u8(buf, frag, offset, &pos,
+		net_nbuf_write_u8(buf, flags_frag, flags_pos, &pos,
 				  flags &= ~NET_RPL_HDR_OPT_DOWN);
 
 		NET_DBG("RPL option going up");
@@ -3836,7 +4317,7 @@ static int net_rpl_update_header_empty(struct net_buf *buf)
 		/* A DAO route was found so we set the down
 		 * flag.
 		 */
-		net_nbuf_write_u8(buf, frag, offset, &pos,
+		net_nbuf_write_u8(buf, flags_frag, flags_pos, &pos,
 				  flags |= NET_RPL_HDR_OPT_DOWN);
 
 		NET_DBG("RPL option going down");
@@ -3857,6 +4338,300 @@ int net_rpl_insert_header(struct net_buf *buf)
 	return 0;
 }
 
+#if defined(CONFIG_NET_RPL_MOP1)
+/* The routers of a non-storing DODAG only know their parent, the root
+ * adds a source routing header to the packets going down (RFC 6554).
+ */
+#define NET_RPL_SRH_TYPE	3
+#define NET_RPL_SRH_MAX_HOPS	16
+
+static uint8_t srh_common_prefix(struct in6_addr *a, struct in6_addr *b)
+{
+	uint8_t len = 0;
+
+	/* At least one byte of each address is carried */
+	while (len < 15 && a->s6_addr[len] == b->s6_addr[len]) {
+		len++;
+	}
+
+	return len;
+}
+
+int net_rpl_insert_srh(struct net_buf *buf)
+{
+	struct net_rpl_ns_node *path[NET_RPL_SRH_MAX_HOPS];
+	struct net_rpl_instance *instance = rpl_default_instance;
+	struct net_ipv6_hdr *hdr = NET_IPV6_BUF(buf);
+	uint16_t offset = sizeof(struct net_ipv6_hdr);
+	struct net_rpl_ns_node *node;
+	struct in6_addr *first;
+	struct net_rpl_dag *dag;
+	struct net_if *iface;
+	struct net_buf *frag;
+	uint8_t srh[8];
+	uint8_t count = 0;
+	uint8_t cmpr = 15;
+	uint16_t payload;
+	uint16_t pos;
+	uint8_t next;
+	uint8_t len;
+	uint8_t pad;
+	int i;
+
+	if (!instance || !instance->is_used ||
+	    instance->mop != NET_RPL_MOP_NON_STORING) {
+		return 0;
+	}
+
+	dag = instance->current_dag;
+	if (!dag || !dag->is_joined ||
+	    dag->rank != NET_RPL_ROOT_RANK(instance)) {
+		return 0;
+	}
+
+	if (net_is_ipv6_addr_mcast(&hdr->dst) ||
+	    net_is_my_ipv6_addr(&hdr->dst)) {
+		return 0;
+	}
+
+	next = hdr->nexthdr;
+	if (next == NET_IPV6_NEXTHDR_HBHO) {
+		frag = net_nbuf_read_u8(buf->frags, offset, &pos, &next);
+		frag = net_nbuf_read_u8(frag, pos, &pos, &len);
+		if (!frag) {
+			return -EMSGSIZE;
+		}
+
+		offset += (len + 1) * 8;
+	}
+
+	if (next == NET_IPV6_NEXTHDR_ROUTING) {
+		return 0;
+	}
+
+	/* Walk up from the destination until a child of ours */
+	node = ns_node_lookup(dag, &hdr->dst);
+	while (node) {
+		if (count == ARRAY_SIZE(path)) {
+			NET_DBG("Source route to %s is too long",
+				net_sprint_ipv6_addr(&hdr->dst));
+			return -EMSGSIZE;
+		}
+
+		path[count++] = node;
+
+		if (net_if_ipv6_addr_lookup(&node->parent, &iface)) {
+			break;
+		}
+
+		node = ns_node_lookup(dag, &node->parent);
+	}
+
+	if (!node) {
+		if (count) {
+			NET_DBG("No source route to %s",
+				net_sprint_ipv6_addr(&hdr->dst));
+		}
+
+		return 0;
+	}
+
+	net_nbuf_set_iface(buf, iface);
+
+	if (count == 1) {
+		/* The destination is our neighbor */
+		return 1;
+	}
+
+	/* The addresses all share the prefix elided from the first one */
+	first = &path[count - 1]->addr;
+
+	for (i = 0; i < count - 1; i++) {
+		cmpr = min(cmpr, srh_common_prefix(first, &path[i]->addr));
+	}
+
+	len = sizeof(srh) + (count - 1) * (sizeof(*first) - cmpr);
+	pad = (8 - len % 8) % 8;
+	len += pad;
+
+	srh[0] = next;
+	srh[1] = len / 8 - 1;
+	srh[2] = NET_RPL_SRH_TYPE;
+	srh[3] = count - 1; /* segments left */
+	srh[4] = cmpr << 4 | cmpr;
+	srh[5] = pad << 4;
+	srh[6] = 0;
+	srh[7] = 0;
+
+	if (!net_nbuf_insert(buf, buf->frags, offset, sizeof(srh), srh)) {
+		return -ENOMEM;
+	}
+
+	offset += sizeof(srh);
+
+	/* From the second hop to the destination */
+	for (i = count - 2; i >= 0; i--) {
+		if (!net_nbuf_insert(buf, buf->frags, offset,
+				     sizeof(*first) - cmpr,
+				     &path[i]->addr.s6_addr[cmpr])) {
+			return -ENOMEM;
+		}
+
+		offset += sizeof(*first) - cmpr;
+	}
+
+	if (pad) {
+		memset(srh, 0, sizeof(srh));
+
+		if (!net_nbuf_insert(buf, buf->frags, offset, pad, srh)) {
+			return -ENOMEM;
+		}
+	}
+
+	if (hdr->nexthdr == NET_IPV6_NEXTHDR_HBHO) {
+		net_nbuf_write_u8(buf, buf->frags, sizeof(struct net_ipv6_hdr),
+				  &pos, NET_IPV6_NEXTHDR_ROUTING);
+	} else {
+		hdr->nexthdr = NET_IPV6_NEXTHDR_ROUTING;
+	}
+
+	payload = (hdr->len[0] << 8) + hdr->len[1] + len;
+	hdr->len[0] = payload >> 8;
+	hdr->len[1] = payload;
+
+	net_nbuf_set_ext_len(buf, net_nbuf_ext_len(buf) + len);
+
+	NET_DBG("Source route to %s, %d hops via %s",
+		net_sprint_ipv6_addr(&hdr->dst), count,
+		net_sprint_ipv6_addr(first));
+
+	net_ipaddr_copy(&hdr->dst, first);
+
+	return 1;
+}
+
+enum net_verdict net_rpl_srh_input(struct net_buf *buf,
+				   struct net_buf *frag,
+				   uint16_t offset,
+				   uint16_t len)
+{
+	struct net_ipv6_hdr *hdr = NET_IPV6_BUF(buf);
+	struct net_buf *segments_frag, *addr_frag;
+	uint16_t segments_pos, addr_pos, pos;
+	uint8_t type, segments, cmpri, cmpre, pad;
+	struct in6_addr addr;
+	struct net_buf *tx;
+	uint8_t size, n, i;
+	uint8_t value;
+
+	frag = net_nbuf_read_u8(frag, offset, &pos, &type);
+
+	segments_frag = frag;
+	segments_pos = pos;
+
+	frag = net_nbuf_read_u8(frag, pos, &pos, &segments);
+	frag = net_nbuf_read_u8(frag, pos, &pos, &value);
+
+	cmpri = value >> 4;
+	cmpre = value & 0x0f;
+
+	frag = net_nbuf_read_u8(frag, pos, &pos, &pad);
+	frag = net_nbuf_skip(frag, pos, &pos, 2); /* reserved */
+	if (!frag) {
+		return NET_DROP;
+	}
+
+	pad >>= 4;
+
+	if (!segments) {
+		/* We are the destination */
+		return NET_CONTINUE;
+	}
+
+	if (type != NET_RPL_SRH_TYPE) {
+		NET_DBG("Unsupported routing header type %d", type);
+		goto bad_hdr;
+	}
+
+	if (len < 8 + pad + sizeof(addr) - cmpre) {
+		goto bad_hdr;
+	}
+
+	n = (len - 8 - pad - (sizeof(addr) - cmpre)) /
+		(sizeof(addr) - cmpri) + 1;
+	if (segments > n) {
+		offset++;
+		goto bad_hdr;
+	}
+
+	segments--;
+	i = n - segments - 1;
+	size = i == n - 1 ? sizeof(addr) - cmpre : sizeof(addr) - cmpri;
+
+	addr_frag = net_nbuf_skip(frag, pos, &addr_pos,
+				  i * (sizeof(addr) - cmpri));
+
+	/* The elided prefix is the one of the destination */
+	net_ipaddr_copy(&addr, &hdr->dst);
+
+	if (!net_nbuf_read(addr_frag, addr_pos, &pos, size,
+			   &addr.s6_addr[sizeof(addr) - size])) {
+		return NET_DROP;
+	}
+
+	if (net_is_ipv6_addr_mcast(&addr) || net_is_my_ipv6_addr(&addr)) {
+		NET_DBG("Invalid next hop %s", net_sprint_ipv6_addr(&addr));
+		return NET_DROP;
+	}
+
+	if (hdr->hop_limit <= 1) {
+		net_icmpv6_send_error(buf, NET_ICMPV6_TIME_EXCEEDED, 0, 0);
+		return NET_DROP;
+	}
+
+	net_nbuf_write(buf, addr_frag, addr_pos, &pos, size,
+		       &hdr->dst.s6_addr[sizeof(addr) - size]);
+	net_nbuf_write_u8(buf, segments_frag, segments_pos, &pos, segments);
+
+	net_ipaddr_copy(&hdr->dst, &addr);
+	hdr->hop_limit--;
+
+	NET_DBG("Forwarding to %s, %d segments left",
+		net_sprint_ipv6_addr(&addr), segments);
+
+	tx = net_nbuf_get_reserve_tx(0);
+	if (!tx) {
+		net_stats_update_rpl_forward_errors();
+		return NET_DROP;
+	}
+
+	/* Steal the fragment chain */
+	tx->frags = buf->frags;
+	buf->frags = NULL;
+
+	net_nbuf_set_iface(tx, net_nbuf_iface(buf));
+	net_nbuf_set_family(tx, AF_INET6);
+	net_nbuf_set_ip_hdr_len(tx, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ll_reserve(tx, net_if_get_ll_reserve(net_nbuf_iface(tx),
+							  &addr));
+
+	if (net_send_data(tx) < 0) {
+		net_stats_update_rpl_forward_errors();
+		net_nbuf_unref(tx);
+	}
+
+	net_nbuf_unref(buf);
+
+	return NET_OK;
+
+bad_hdr:
+	net_icmpv6_send_error(buf, NET_ICMPV6_PARAM_PROBLEM,
+			      NET_ICMPV6_PARAM_PROB_HEADER, offset);
+
+	return NET_DROP;
+}
+#endif /* CONFIG_NET_RPL_MOP1 */
+
 static inline void create_linklocal_rplnodes_mcast(struct in6_addr *addr)
 {
 	net_ipv6_addr_create(addr, 0xff02, 0, 0, 0, 0, 0, 0, 0x001a);
@@ -912,13 +912,14 @@ int net_rpl_update_header(struct net_buf *buf, struct in6_addr *addr);
  * @brief Verify RPL header in IPv6 packet.
  *
  * @param buf Network buffer.
- * @param offset Where the RPL header starts in the packet
+ * @param frag Fragment the RPL header starts in.
+ * @param offset Where the RPL header starts in the fragment
  * @param pos How long the RPL header was, this is returned to the caller.
  *
  * @return True if ok, false if error
  */
-bool net_rpl_verify_header(struct net_buf *buf, uint16_t offset,
-			   uint16_t *pos);
+bool net_rpl_verify_header(struct net_buf *buf, struct net_buf *frag,
+			   uint16_t offset, uint16_t *pos);
 
 /**
  * @brief Insert RPL extension header to IPv6 packet.
@@ -929,6 +930,43 @@ bool net_rpl_verify_header(struct net_buf *buf, uint16_t offset,
  */
 int net_rpl_insert_header(struct net_buf *buf);
 
+#if defined(CONFIG_NET_RPL_MOP1)
+/**
+ * @brief Insert a source routing header (RFC 6554) to IPv6 packet.
+ *
+ * @details Only the root of a non-storing DODAG does it, for the
+ * destinations below it. The destination of the packet becomes the first
+ * hop of the route.
+ *
+ * @param buf Network buffer.
+ *
+ * @return 1 if the destination is in the DODAG, 0 if the packet is not
+ * source routed, <0 if error.
+ */
+int net_rpl_insert_srh(struct net_buf *buf);
+
+/**
+ * @brief Process a routing header of a received IPv6 packet.
+ *
+ * @details The packet is sent on to the next address of the route when
+ * this node is not the destination.
+ *
+ * @param buf Network buffer.
+ * @param frag Fragment where the routing type is.
+ * @param offset Offset of the routing type in the fragment.
+ * @param len Length of the routing header.
+ *
+ * @return NET_CONTINUE if we are the destination, NET_OK if the packet
+ * was forwarded, NET_DROP otherwise.
+ */
+enum net_verdict net_rpl_srh_input(struct net_buf *buf,
+				   struct net_buf *frag,
+				   uint16_t offset,
+				   uint16_t len);
+#else
+#define net_rpl_insert_srh(...) 0
+#endif
+
 /**
  * @brief Get parent IPv6 address.
  *
@@ -961,6 +999,7 @@ void net_rpl_init(void);
 #define net_rpl_init(...)
 #define net_rpl_global_repair(...)
 #define net_rpl_update_header(...) 0
+#define net_rpl_insert_srh(...) 0
 #endif /* CONFIG_NET_RPL */
 
 #ifdef __cplusplus
@@ -0,0 +1,155 @@
+/** @file
+ * @brief TCP NewReno congestion control
+ *
+ * Slow start, congestion avoidance, fast retransmit and fast recovery as
+ * per RFC 5681 and RFC 6582.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_TCP)
+#define SYS_LOG_DOMAIN "net/tcp"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <kernel.h>
+#include <stdbool.h>
+
+#include <net/net_context.h>
+
+#include "net_private.h"
+#include "tcp.h"
+
+/* RFC 1122 default MSS, used when the interface MSS is unknown */
+#define DEFAULT_MSS 536
+
+#define DUP_ACK_THRESHOLD 3
+
+static inline uint32_t smss(struct net_tcp *tcp)
+{
+	uint32_t mss = net_tcp_get_send_mss(tcp);
+
+	return mss ? mss : DEFAULT_MSS;
+}
+
+/* Initial window, see RFC 5681 ch. 3.1 */
+static uint32_t initial_window(struct net_tcp *tcp)
+{
+	uint32_t mss = smss(tcp);
+
+	if (mss > 2190) {
+		return 2 * mss;
+	}
+
+	if (mss > 1095) {
+		return 3 * mss;
+	}
+
+	return 4 * mss;
+}
+
+/* ssthresh = max(FlightSize / 2, 2 * SMSS), see RFC 5681 ch. 3.1 */
+static inline uint32_t reduced_ssthresh(struct net_tcp *tcp)
+{
+	return max(net_tcp_flight_size(tcp) / 2, 2 * smss(tcp));
+}
+
+void net_tcp_cc_init(struct net_tcp *tcp)
+{
+	/* The interface is not known yet: cwnd is set on first use */
+	tcp->cwnd = 0;
+	tcp->ssthresh = UINT32_MAX;
+	tcp->recover = 0;
+	tcp->dup_acks = 0;
+	tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+}
+
+uint32_t net_tcp_cc_window(struct net_tcp *tcp)
+{
+	if (!tcp->cwnd) {
+		tcp->cwnd = initial_window(tcp);
+	}
+
+	return tcp->cwnd;
+}
+
+bool net_tcp_cc_ack(struct net_tcp *tcp, uint32_t ack, uint32_t acked)
+{
+	uint32_t mss = smss(tcp);
+	uint32_t cwnd = net_tcp_cc_window(tcp);
+
+	tcp->dup_acks = 0;
+
+	if (tcp->flags & NET_TCP_FAST_RECOVERY) {
+		if (!net_tcp_seq_greater(tcp->recover, ack)) {
+			/* Full ACK: deflate the window, RFC 6582 ch. 3.2 */
+			tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+			tcp->cwnd = min(tcp->ssthresh,
+					net_tcp_flight_size(tcp) + mss);
+
+			NET_DBG("Fast recovery done, cwnd %u", tcp->cwnd);
+			return false;
+		}
+
+		/* Partial ACK: retransmit the next hole and partially
+		 * deflate the window.
+		 */
+		cwnd = cwnd > acked ? cwnd - acked : 0;
+		if (acked >= mss) {
+			cwnd += mss;
+		}
+		tcp->cwnd = max(cwnd, mss);
+
+		return true;
+	}
+
+	if (cwnd < tcp->ssthresh) {
+		/* Slow start */
+		tcp->cwnd = cwnd + min(acked, mss);
+	} else {
+		/* Congestion avoidance: about one SMSS per RTT */
+		tcp->cwnd = cwnd + max(mss * mss / cwnd, 1);
+	}
+
+	return false;
+}
+
+bool net_tcp_cc_dup_ack(struct net_tcp *tcp, uint32_t ack)
+{
+	uint32_t mss = smss(tcp);
+
+	if (tcp->flags & NET_TCP_FAST_RECOVERY) {
+		/* Each duplicate ACK means a segment has left the network */
+		tcp->cwnd = net_tcp_cc_window(tcp) + mss;
+		return false;
+	}
+
+	if (++tcp->dup_acks < DUP_ACK_THRESHOLD) {
+		return false;
+	}
+
+	tcp->dup_acks = 0;
+	tcp->ssthresh = reduced_ssthresh(tcp);
+	tcp->recover = ack + net_tcp_flight_size(tcp);
+	tcp->cwnd = tcp->ssthresh + DUP_ACK_THRESHOLD * mss;
+	tcp->flags |= NET_TCP_FAST_RECOVERY;
+
+	NET_DBG("Fast retransmit, ssthresh %u cwnd %u", tcp->ssthresh,
+		tcp->cwnd);
+
+	return true;
+}
+
+void net_tcp_cc_timeout(struct net_tcp *tcp)
+{
+	tcp->ssthresh = reduced_ssthresh(tcp);
+	tcp->cwnd = smss(tcp);
+	tcp->dup_acks = 0;
+	tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+
+	NET_DBG("Retransmission timeout, ssthresh %u", tcp->ssthresh);
+}
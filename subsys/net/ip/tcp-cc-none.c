@@ -0,0 +1,53 @@
+/** @file
+ * @brief TCP without congestion control
+ *
+ * All queued data is sent at once, losses being recovered from by the
+ * retransmission timer only.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <stdbool.h>
+
+#include <net/net_context.h>
+
+#include "tcp.h"
+
+void net_tcp_cc_init(struct net_tcp *tcp)
+{
+	ARG_UNUSED(tcp);
+}
+
+uint32_t net_tcp_cc_window(struct net_tcp *tcp)
+{
+	ARG_UNUSED(tcp);
+
+	return UINT32_MAX;
+}
+
+bool net_tcp_cc_ack(struct net_tcp *tcp, uint32_t ack, uint32_t acked)
+{
+	ARG_UNUSED(tcp);
+	ARG_UNUSED(ack);
+	ARG_UNUSED(acked);
+
+	return false;
+}
+
+bool net_tcp_cc_dup_ack(struct net_tcp *tcp, uint32_t ack)
+{
+	ARG_UNUSED(tcp);
+	ARG_UNUSED(ack);
+
+	return false;
+}
+
+void net_tcp_cc_timeout(struct net_tcp *tcp)
+{
+	ARG_UNUSED(tcp);
+}
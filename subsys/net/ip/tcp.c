@@ -34,6 +34,7 @@
 #include "ipv6.h"
 #include "ipv4.h"
 #include "tcp.h"
+#include "net_stats.h"
 
 /*
  * Each TCP connection needs to be tracked by net_context, so
@@ -42,8 +43,18 @@
 #define NET_MAX_TCP_CONTEXT CONFIG_NET_MAX_CONTEXTS
 static struct net_tcp tcp_context[NET_MAX_TCP_CONTEXT];
 
+/* Unused TCP contexts, allocated without scanning the array */
+static sys_slist_t tcp_free;
+
 #define INIT_RETRY_MS 200
 
+/* Bounds of the retransmission timeout, see RFC 6298 */
+#define MIN_RTO_MS 200
+#define MAX_RTO_MS (60 * MSEC_PER_SEC)
+
+/* Backoff makes the timeout reach MAX_RTO_MS well before this */
+#define MAX_RETRY_SHIFT 15
+
 struct tcp_segment {
 	uint32_t seq;
 	uint32_t ack;
@@ -102,59 +113,147 @@ static inline uint32_t init_isn(void)
 
 static inline uint32_t retry_timeout(const struct net_tcp *tcp)
 {
-	return ((uint32_t)1 << tcp->retry_timeout_shift) * INIT_RETRY_MS;
+	return min(tcp->rto << tcp->retry_timeout_shift, MAX_RTO_MS);
+}
+
+/* Update the RTT estimation with a new sample, as per RFC 6298 */
+static void update_rtt(struct net_tcp *tcp, uint32_t rtt)
+{
+	int32_t delta;
+
+	if (!tcp->srtt) {
+		tcp->srtt = rtt << 3;
+		tcp->rttvar = rtt << 1;
+	} else {
+		/* SRTT += (R - SRTT) / 8, RTTVAR += (|R - SRTT| - RTTVAR) / 4,
+		 * both being kept scaled to avoid losing precision
+		 */
+		delta = (int32_t)rtt - (int32_t)(tcp->srtt >> 3);
+		tcp->srtt += delta;
+		if (delta < 0) {
+			delta = -delta;
+		}
+		delta -= tcp->rttvar >> 2;
+		tcp->rttvar += delta;
+	}
+
+	/* RTO = SRTT + max(G, 4 * RTTVAR), G being one millisecond */
+	tcp->rto = (tcp->srtt >> 3) + max(tcp->rttvar, 1);
+	tcp->rto = max(tcp->rto, MIN_RTO_MS);
+	tcp->rto = min(tcp->rto, MAX_RTO_MS);
+
+	NET_DBG("RTT %u ms, SRTT %u ms, RTTVAR %u ms, RTO %u ms", rtt,
+		tcp->srtt >> 3, tcp->rttvar >> 2, tcp->rto);
+}
+
+static inline struct net_buf *first_unacked(struct net_tcp *tcp)
+{
+	return CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
+			    struct net_buf, sent_list);
+}
+
+static void retransmit_first_unacked(struct net_tcp *tcp)
+{
+	/* Karn's algorithm: retransmitted segments give no RTT sample */
+	tcp->flags &= ~NET_TCP_RTT_MEASURING;
+
+	net_stats_update_tcp_rexmit();
+
+	net_tcp_send_buf(net_buf_ref(first_unacked(tcp)));
 }
 
 static void tcp_retry_expired(struct k_timer *timer)
 {
 	struct net_tcp *tcp = CONTAINER_OF(timer, struct net_tcp, retry_timer);
-	struct net_buf *buf;
 
 	/* Double the retry period for exponential backoff and resent
 	 * the first (only the first!) unack'd packet.
 	 */
 	if (!sys_slist_is_empty(&tcp->sent_list)) {
-		tcp->retry_timeout_shift++;
+		net_tcp_cc_timeout(tcp);
+
+		/* The peer may have discarded data it selectively
+		 * acknowledged, see RFC 2018 ch. 8.
+		 */
+		tcp->sacked_count = 0;
+
+		tcp->flags |= NET_TCP_RETRYING;
+		if (tcp->retry_timeout_shift < MAX_RETRY_SHIFT) {
+			tcp->retry_timeout_shift++;
+		}
 		k_timer_start(&tcp->retry_timer, retry_timeout(tcp), 0);
 
-		buf = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
-				   struct net_buf, sent_list);
-		net_tcp_send_buf(net_buf_ref(buf));
+		retransmit_first_unacked(tcp);
+	}
+}
+
+static void ack_timeout(struct k_work *work)
+{
+	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, ack_timer);
+	struct net_buf *buf = NULL;
+
+	/* Data sent meanwhile may have carried the ACK, and once we have
+	 * sent our FIN the ACK goes with it.
+	 */
+	if (!tcp->context || tcp->send_ack == tcp->sent_ack ||
+	    (net_tcp_get_state(tcp) != NET_TCP_ESTABLISHED &&
+	     net_tcp_get_state(tcp) != NET_TCP_CLOSE_WAIT)) {
+		return;
+	}
+
+	if (net_tcp_prepare_ack(tcp, &tcp->context->remote, &buf)) {
+		return;
+	}
+
+	if (net_tcp_send_buf(buf) < 0) {
+		net_nbuf_unref(buf);
 	}
 }
 
 struct net_tcp *net_tcp_alloc(struct net_context *context)
 {
-	int i, key;
+	struct net_tcp *tcp;
+	sys_snode_t *node;
+	int key;
 
 	key = irq_lock();
-	for (i = 0; i < NET_MAX_TCP_CONTEXT; i++) {
-		if (!net_tcp_is_used(&tcp_context[i])) {
-			tcp_context[i].flags |= NET_TCP_IN_USE;
-			break;
-		}
-	}
+	node = sys_slist_get(&tcp_free);
 	irq_unlock(key);
 
-	if (i >= NET_MAX_TCP_CONTEXT) {
+	if (!node) {
 		return NULL;
 	}
 
-	memset(&tcp_context[i], 0, sizeof(struct net_tcp));
+	tcp = CONTAINER_OF(node, struct net_tcp, node);
+
+	memset(tcp, 0, sizeof(struct net_tcp));
+
+	tcp->flags = NET_TCP_IN_USE;
+	net_tcp_set_state(tcp, NET_TCP_CLOSED);
+	tcp->context = context;
+
+	tcp->send_seq = init_isn();
+	tcp->recv_max_ack = tcp->send_seq + 1u;
+
+	tcp->accept_cb = NULL;
 
-	tcp_context[i].flags = NET_TCP_IN_USE;
-	net_tcp_set_state(&tcp_context[i], NET_TCP_CLOSED);
-	tcp_context[i].context = context;
+	tcp->rto = INIT_RETRY_MS;
+	net_tcp_cc_init(tcp);
 
-	tcp_context[i].send_seq = init_isn();
-	tcp_context[i].recv_max_ack = tcp_context[i].send_seq + 1u;
+	k_timer_init(&tcp->retry_timer, tcp_retry_expired, NULL);
+	k_delayed_work_init(&tcp->ack_timer, ack_timeout);
+	k_sem_init(&tcp->connect_wait, 0, UINT_MAX);
 
-	tcp_context[i].accept_cb = NULL;
+	return tcp;
+}
 
-	k_timer_init(&tcp_context[i].retry_timer, tcp_retry_expired, NULL);
-	k_sem_init(&tcp_context[i].connect_wait, 0, UINT_MAX);
+static void flush_list(sys_slist_t *list)
+{
+	sys_snode_t *node;
 
-	return &tcp_context[i];
+	while ((node = sys_slist_get(list))) {
+		net_nbuf_unref(CONTAINER_OF(node, struct net_buf, sent_list));
+	}
 }
 
 int net_tcp_release(struct net_tcp *tcp)
@@ -170,11 +269,20 @@ int net_tcp_release(struct net_tcp *tcp)
 	k_timer_stop(&tcp->retry_timer);
 	k_sem_reset(&tcp->connect_wait);
 
+	flush_list(&tcp->sent_list);
+	flush_list(&tcp->ooo_list);
+
+	if (tcp->nagle_buf) {
+		net_nbuf_unref(tcp->nagle_buf);
+		tcp->nagle_buf = NULL;
+	}
+
 	net_tcp_set_state(tcp, NET_TCP_CLOSED);
 	tcp->context = NULL;
 
 	key = irq_lock();
 	tcp->flags &= ~(NET_TCP_IN_USE | NET_TCP_RECV_MSS_SET);
+	sys_slist_prepend(&tcp_free, &tcp->node);
 	irq_unlock(key);
 
 	NET_DBG("Disposed of TCP connection state");
@@ -182,20 +290,26 @@ int net_tcp_release(struct net_tcp *tcp)
 	return 0;
 }
 
-static inline int net_tcp_add_options(struct net_buf *header, size_t len,
-				      void *data)
+static inline int net_tcp_add_options(struct net_buf *header,
+				      struct net_tcp_hdr *tcphdr,
+				      size_t len, void *data)
 {
 	uint8_t optlen;
 
 	memcpy(net_buf_add(header, len), data, len);
 
-	/* Set the length (this value is saved in 4-byte words format) */
+	/* Pad the options to a multiple of 4 bytes with END options */
 	if ((len & 0x3u) != 0u) {
 		optlen = (len & 0xfffCu) + 4u;
+		memset(net_buf_add(header, optlen - len), NET_TCP_OPT_END,
+		       optlen - len);
 	} else {
 		optlen = len;
 	}
 
+	/* Set the length (this value is saved in 4-byte words format) */
+	tcphdr->offset = (NET_TCPH_LEN + optlen) << 2;
+
 	return 0;
 }
 
@@ -274,7 +388,8 @@ static struct net_buf *prepare_segment(struct net_tcp *tcp,
 	tcphdr = (struct net_tcp_hdr *)net_buf_add(header, NET_TCPH_LEN);
 
 	if (segment->options && segment->optlen) {
-		net_tcp_add_options(header, segment->optlen, segment->options);
+		net_tcp_add_options(header, tcphdr, segment->optlen,
+				    segment->options);
 	} else {
 		tcphdr->offset = NET_TCPH_LEN << 2;
 	}
@@ -308,26 +423,393 @@ static struct net_buf *prepare_segment(struct net_tcp *tcp,
 	return buf;
 }
 
-static inline uint32_t get_recv_wnd(struct net_tcp *tcp)
+static inline uint16_t get_recv_wnd(struct net_tcp *tcp, uint8_t flags)
 {
-	ARG_UNUSED(tcp);
+	uint32_t wnd = NET_TCP_MAX_WIN;
 
 	/* We don't queue received data inside the stack, we hand off
-	 * packets to synchronous callbacks (who can queue if they
-	 * want, but it's not our business).  So the available window
-	 * size is always the same.  There are two configurables to
-	 * check though.
+	 * in-order packets to synchronous callbacks (who can queue if
+	 * they want, but it's not our business), and only keep the
+	 * ones received out of order within this window.  So the
+	 * available window size is always the same.
+	 *
+	 * The window of SYN segments is never scaled.
+	 */
+	if (!(flags & NET_TCP_SYN)) {
+		wnd >>= tcp->recv_wnd_scale;
+	}
+
+	return min(wnd, 0xffff);
+}
+
+/* Receive window in bytes, as advertised to the peer */
+static inline uint32_t get_recv_wnd_len(struct net_tcp *tcp)
+{
+	return (uint32_t)get_recv_wnd(tcp, 0) << tcp->recv_wnd_scale;
+}
+
+/* Smallest shift making our window fit in the 16-bit header field */
+static uint8_t get_recv_wnd_scale(void)
+{
+	uint8_t shift = 0;
+
+	while ((NET_TCP_MAX_WIN >> shift) > 0xffff &&
+	       shift < NET_TCP_MAX_WND_SCALE) {
+		shift++;
+	}
+
+	return shift;
+}
+
+/* Sequence numbers of a segment, from its TCP header */
+static inline uint32_t seg_seq(struct net_buf *buf)
+{
+	return sys_get_be32(NET_TCP_BUF(buf)->seq);
+}
+
+static inline uint32_t seg_end(struct net_buf *buf)
+{
+	return seg_seq(buf) + net_nbuf_appdatalen(buf);
+}
+
+struct tcp_options {
+	/** Received SACK blocks */
+	struct net_tcp_seq_block sack[NET_TCP_MAX_SACK_BLOCKS + 1];
+	/** Timestamps option data, NULL if absent */
+	uint8_t *ts;
+	uint32_t tsval;
+	uint32_t tsecr;
+	uint16_t mss;
+	uint8_t sack_blocks;
+	uint8_t wnd_scale;
+	bool has_wnd_scale;
+	bool sack_perm;
+};
+
+static void parse_options(struct net_buf *buf, struct tcp_options *opts)
+{
+	struct net_tcp_hdr *tcphdr = NET_TCP_BUF(buf);
+	uint8_t *opt = tcphdr->optdata;
+	uint8_t *end = (uint8_t *)tcphdr + 4 * (tcphdr->offset >> 4);
+	uint8_t len, i;
+
+	memset(opts, 0, sizeof(*opts));
+
+	/* Like the rest of the header, options are expected to be in the
+	 * first fragment.
+	 */
+	end = min(end, buf->frags->data + buf->frags->len);
+
+	while (opt < end && *opt != NET_TCP_OPT_END) {
+		if (*opt == NET_TCP_OPT_NOP) {
+			opt++;
+			continue;
+		}
+
+		if (opt + 1 >= end) {
+			break;
+		}
+
+		len = opt[1];
+		if (len < 2 || opt + len > end) {
+			NET_DBG("Invalid option %u length %u", opt[0], len);
+			break;
+		}
+
+		switch (opt[0]) {
+		case NET_TCP_OPT_MSS:
+			if (len == NET_TCP_MSS_SIZE) {
+				opts->mss = sys_get_be16(opt + 2);
+			}
+			break;
+		case NET_TCP_OPT_WND_SCALE:
+			if (len == NET_TCP_WINDOW_SIZE) {
+				opts->has_wnd_scale = true;
+				opts->wnd_scale = opt[2];
+			}
+			break;
+		case NET_TCP_OPT_SACK_PERM:
+			opts->sack_perm = (len == NET_TCP_SACK_PERM_SIZE);
+			break;
+		case NET_TCP_OPT_SACK:
+			for (i = 2; i + 8 <= len &&
+			     opts->sack_blocks < ARRAY_SIZE(opts->sack);
+			     i += 8) {
+				opts->sack[opts->sack_blocks].start =
+					sys_get_be32(opt + i);
+				opts->sack[opts->sack_blocks].end =
+					sys_get_be32(opt + i + 4);
+				opts->sack_blocks++;
+			}
+			break;
+		case NET_TCP_OPT_TIMESTAMP:
+			if (len == NET_TCP_TIMESTAMP_SIZE) {
+				opts->ts = opt + 2;
+				opts->tsval = sys_get_be32(opt + 2);
+				opts->tsecr = sys_get_be32(opt + 6);
+			}
+			break;
+		}
+
+		opt += len;
+	}
+}
+
+void net_tcp_parse_syn_opt(struct net_tcp *tcp, struct net_buf *buf)
+{
+	struct tcp_options opts;
+
+	parse_options(buf, &opts);
+
+	tcp->flags &= ~(NET_TCP_WND_SCALE | NET_TCP_SACK | NET_TCP_TIMESTAMPS);
+	tcp->send_wnd_scale = 0;
+	tcp->recv_wnd_scale = 0;
+	tcp->send_mss = opts.mss;
+
+	if (opts.has_wnd_scale) {
+		tcp->flags |= NET_TCP_WND_SCALE;
+		tcp->send_wnd_scale = min(opts.wnd_scale,
+					   NET_TCP_MAX_WND_SCALE);
+		tcp->recv_wnd_scale = get_recv_wnd_scale();
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) && opts.sack_perm) {
+		tcp->flags |= NET_TCP_SACK;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_TIMESTAMPS) && opts.ts) {
+		tcp->flags |= NET_TCP_TIMESTAMPS;
+		tcp->ts_recent = opts.tsval;
+	}
+
+	NET_DBG("MSS %u, window scale %u (ours %u), SACK %d, timestamps %d",
+		tcp->send_mss, tcp->send_wnd_scale, tcp->recv_wnd_scale,
+		!!(tcp->flags & NET_TCP_SACK),
+		!!(tcp->flags & NET_TCP_TIMESTAMPS));
+}
+
+void net_tcp_syn_init(struct net_tcp_syn *syn, struct net_buf *buf)
+{
+	struct tcp_options opts;
+
+	parse_options(buf, &opts);
+
+	syn->timestamp = k_uptime_get_32();
+	syn->iss = init_isn();
+	syn->send_ack = sys_get_be32(NET_TCP_BUF(buf)->seq) + 1;
+	syn->send_wnd = sys_get_be16(NET_TCP_BUF(buf)->wnd);
+	syn->send_mss = opts.mss;
+	syn->flags = 0;
+	syn->send_wnd_scale = 0;
+	syn->recv_wnd_scale = 0;
+	syn->ts_recent = 0;
+
+	if (opts.has_wnd_scale) {
+		syn->flags |= NET_TCP_WND_SCALE;
+		syn->send_wnd_scale = min(opts.wnd_scale,
+					   NET_TCP_MAX_WND_SCALE);
+		syn->recv_wnd_scale = get_recv_wnd_scale();
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) && opts.sack_perm) {
+		syn->flags |= NET_TCP_SACK;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_TIMESTAMPS) && opts.ts) {
+		syn->flags |= NET_TCP_TIMESTAMPS;
+		syn->ts_recent = opts.tsval;
+	}
+}
+
+void net_tcp_syn_load(struct net_tcp *tcp, const struct net_tcp_syn *syn)
+{
+	tcp->send_seq = syn->iss;
+	tcp->recv_max_ack = syn->iss + 1;
+	tcp->send_ack = syn->send_ack;
+
+	/* As net_tcp_update_send_wnd() would for the SYN */
+	tcp->send_wnd = syn->send_wnd;
+	tcp->send_wl1 = syn->send_ack - 1;
+	tcp->send_wl2 = 0;
+
+	tcp->send_mss = syn->send_mss;
+	tcp->send_wnd_scale = syn->send_wnd_scale;
+	tcp->recv_wnd_scale = syn->recv_wnd_scale;
+	tcp->ts_recent = syn->ts_recent;
+
+	tcp->flags &= ~(NET_TCP_WND_SCALE | NET_TCP_SACK | NET_TCP_TIMESTAMPS);
+	tcp->flags |= syn->flags;
+}
+
+static uint8_t *put_opt_timestamps(struct net_tcp *tcp, uint8_t *opt)
+{
+	*opt++ = NET_TCP_OPT_TIMESTAMP;
+	*opt++ = NET_TCP_TIMESTAMP_SIZE;
+
+	/* Our clock ticks every millisecond */
+	sys_put_be32(k_uptime_get_32(), opt);
+	sys_put_be32(tcp->ts_recent, opt + 4);
+
+	return opt + 8;
+}
+
+/* Get the block of contiguous data queued out of order starting at
+ * *node, moving *node past it.
+ */
+static bool ooo_next_block(sys_snode_t **node, struct net_tcp_seq_block *block)
+{
+	struct net_buf *buf;
+
+	if (!*node) {
+		return false;
+	}
+
+	buf = CONTAINER_OF(*node, struct net_buf, sent_list);
+	block->start = seg_seq(buf);
+	block->end = seg_end(buf);
+
+	for (*node = sys_slist_peek_next(*node); *node;
+	     *node = sys_slist_peek_next(*node)) {
+		buf = CONTAINER_OF(*node, struct net_buf, sent_list);
+		if (seg_seq(buf) != block->end) {
+			break;
+		}
+
+		block->end = seg_end(buf);
+	}
+
+	return true;
+}
+
+static inline bool in_block(uint32_t seq,
+			    const struct net_tcp_seq_block *block)
+{
+	return !net_tcp_seq_greater(block->start, seq) &&
+		net_tcp_seq_greater(block->end, seq);
+}
+
+static uint8_t *put_sack_block(uint8_t *opt,
+			       const struct net_tcp_seq_block *block)
+{
+	sys_put_be32(block->start, opt);
+	sys_put_be32(block->end, opt + 4);
+
+	return opt + 8;
+}
+
+static uint8_t *put_opt_sack(struct net_tcp *tcp, uint8_t *opt)
+{
+	struct net_tcp_seq_block block, recent;
+	bool has_recent = false;
+	uint8_t *len = opt + 1;
+	sys_snode_t *node;
+	int blocks = 0;
+
+	*opt++ = NET_TCP_OPT_SACK;
+	opt++;
+
+	/* The block holding the segment received last goes first, the
+	 * others follow, see RFC 2018 ch. 4.
+	 */
+	node = sys_slist_peek_head(&tcp->ooo_list);
+	while (ooo_next_block(&node, &block)) {
+		if (in_block(tcp->ooo_recent, &block)) {
+			recent = block;
+			has_recent = true;
+			opt = put_sack_block(opt, &block);
+			blocks++;
+			break;
+		}
+	}
+
+	node = sys_slist_peek_head(&tcp->ooo_list);
+	while (blocks < NET_TCP_MAX_SACK_BLOCKS &&
+	       ooo_next_block(&node, &block)) {
+		if (has_recent && block.start == recent.start) {
+			continue;
+		}
+
+		opt = put_sack_block(opt, &block);
+		blocks++;
+	}
+
+	*len = 2 + 8 * blocks;
+
+	return opt;
+}
+
+static void net_tcp_set_syn_opt(struct net_tcp *tcp, uint8_t flags,
+				uint8_t *options, uint8_t *optionlen)
+{
+	uint8_t *opt = options;
+	bool syn_ack = flags & NET_TCP_ACK;
+	bool sack, timestamps;
+	uint16_t recv_mss;
+
+	recv_mss = net_tcp_get_recv_mss(tcp);
+	tcp->flags |= NET_TCP_RECV_MSS_SET;
+
+	UNALIGNED_PUT(htonl((uint32_t)(recv_mss | NET_TCP_MSS_HEADER)),
+		      (uint32_t *)opt);
+	opt += NET_TCP_MSS_SIZE;
+
+	/* Offer the other options in a SYN, only accept them in a
+	 * SYN-ACK, see RFC 2018 ch. 2 and RFC 7323 ch. 2.2.
 	 */
-	return min(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
+	sack = IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+		(!syn_ack || (tcp->flags & NET_TCP_SACK));
+	timestamps = IS_ENABLED(CONFIG_NET_TCP_TIMESTAMPS) &&
+		(!syn_ack || (tcp->flags & NET_TCP_TIMESTAMPS));
+
+	if (sack != timestamps) {
+		/* keep the options below 4-byte aligned */
+		*opt++ = NET_TCP_OPT_NOP;
+		*opt++ = NET_TCP_OPT_NOP;
+	}
+
+	if (sack) {
+		*opt++ = NET_TCP_OPT_SACK_PERM;
+		*opt++ = NET_TCP_SACK_PERM_SIZE;
+	}
+
+	if (timestamps) {
+		opt = put_opt_timestamps(tcp, opt);
+	}
+
+	if (!syn_ack || (tcp->flags & NET_TCP_WND_SCALE)) {
+		UNALIGNED_PUT(htonl((uint32_t)(get_recv_wnd_scale() |
+					       NET_TCP_WINDOW_HEADER)),
+			      (uint32_t *)opt);
+		opt += NET_TCP_WINDOW_SIZE + 1;
+	}
+
+	*optionlen = opt - options;
 }
 
-/* True if the (signed!) difference "seq1 - seq2" is positive and less
- * than 2^29.  That is, seq1 is "after" seq2.
+/* Options of the other segments: timestamps, and SACK blocks in the ACKs
+ * not carrying data, since segments with data might be retransmitted.
  */
-static inline bool seq_greater(uint32_t seq1, uint32_t seq2)
+static void net_tcp_set_opt(struct net_tcp *tcp, bool has_data,
+			    uint8_t *options, uint8_t *optionlen)
 {
-	int d = (int)(seq1 - seq2);
-	return d > 0 && d < 0x20000000;
+	uint8_t *opt = options;
+
+	if (tcp->flags & NET_TCP_TIMESTAMPS) {
+		*opt++ = NET_TCP_OPT_NOP;
+		*opt++ = NET_TCP_OPT_NOP;
+		opt = put_opt_timestamps(tcp, opt);
+	}
+
+	if ((tcp->flags & NET_TCP_SACK) && !has_data &&
+	    !sys_slist_is_empty(&tcp->ooo_list)) {
+		*opt++ = NET_TCP_OPT_NOP;
+		*opt++ = NET_TCP_OPT_NOP;
+		opt = put_opt_sack(tcp, opt);
+
+		net_stats_update_tcp_sack_sent();
+	}
+
+	*optionlen = opt - options;
 }
 
 int net_tcp_prepare_segment(struct net_tcp *tcp, uint8_t flags,
@@ -336,6 +818,8 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, uint8_t flags,
 			    const struct sockaddr *remote,
 			    struct net_buf **send_buf)
 {
+	uint8_t opt_buf[NET_TCP_MAX_OPT_SIZE];
+	uint8_t opt_len;
 	uint32_t seq;
 	uint16_t wnd;
 	struct tcp_segment segment = { 0 };
@@ -344,6 +828,19 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, uint8_t flags,
 		local = &tcp->context->local;
 	}
 
+	/* Add the options negotiated, SYN segments always carry ours */
+	if (!options) {
+		if (flags & NET_TCP_SYN) {
+			net_tcp_set_syn_opt(tcp, flags, opt_buf, &opt_len);
+		} else {
+			net_tcp_set_opt(tcp, *send_buf != NULL, opt_buf,
+					&opt_len);
+		}
+
+		options = opt_buf;
+		optlen = opt_len;
+	}
+
 	seq = tcp->send_seq;
 
 	if (flags & NET_TCP_ACK) {
@@ -381,7 +878,7 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, uint8_t flags,
 		seq++;
 	}
 
-	wnd = get_recv_wnd(tcp);
+	wnd = get_recv_wnd(tcp, flags);
 
 	segment.src_addr = (struct sockaddr_ptr *)local;
 	segment.dst_addr = remote;
@@ -396,7 +893,7 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, uint8_t flags,
 
 	tcp->send_seq = seq;
 
-	if (seq_greater(tcp->send_seq, tcp->recv_max_ack)) {
+	if (net_tcp_seq_greater(tcp->send_seq, tcp->recv_max_ack)) {
 		tcp->recv_max_ack = tcp->send_seq;
 	}
 
@@ -416,23 +913,56 @@ static inline uint32_t get_size(uint32_t pos1, uint32_t pos2)
 	return size;
 }
 
-#if defined(CONFIG_NET_IPV4)
-#ifndef NET_IP_MAX_PACKET
-#define NET_IP_MAX_PACKET (10 * 1024)
-#endif
+/* MSS to assume when the peer did not send one, see RFC 1122 ch.
+ * 4.2.2.6 and RFC 2460 ch. 8.3.
+ */
+#define NET_TCP_DEFAULT_MSS_IPV4 536
+#define NET_TCP_DEFAULT_MSS_IPV6 1220
 
-#define NET_IP_MAX_OPTIONS 40 /* Maximum option field length */
+/* Largest IP packet that reaches the peer without being fragmented */
+static size_t ip_max_packet_len(const struct net_tcp *tcp)
+{
+	struct net_if *iface = net_context_get_iface(tcp->context);
+
+#if defined(CONFIG_NET_IPV6)
+	if (net_context_get_family(tcp->context) == AF_INET6) {
+		return net_ipv6_pmtu_get(iface,
+				&net_sin6(&tcp->context->remote)->sin6_addr);
+	}
+#endif /* CONFIG_NET_IPV6 */
+
+	return iface ? net_if_get_mtu(iface) : 0;
+}
 
-static inline size_t ip_max_packet_len(struct in_addr *dest_ip)
+uint16_t net_tcp_get_send_mss(const struct net_tcp *tcp)
 {
-	ARG_UNUSED(dest_ip);
+	size_t max_len = ip_max_packet_len(tcp);
+	size_t hdr_len;
+	uint16_t mss;
+
+	if (net_context_get_family(tcp->context) == AF_INET6) {
+		hdr_len = NET_IPV6TCPH_LEN;
+		mss = NET_TCP_DEFAULT_MSS_IPV6;
+	} else {
+		hdr_len = NET_IPV4TCPH_LEN;
+		mss = NET_TCP_DEFAULT_MSS_IPV4;
+	}
+
+	if (tcp->send_mss) {
+		mss = tcp->send_mss;
+	}
+
+	if (max_len > hdr_len && mss > max_len - hdr_len) {
+		mss = max_len - hdr_len;
+	}
+
+	/* The MSS does not account for options, see RFC 6691 */
+	if (tcp->flags & NET_TCP_TIMESTAMPS) {
+		mss -= NET_TCP_TIMESTAMP_SIZE + 2;
+	}
 
-	return (NET_IP_MAX_PACKET - (NET_IP_MAX_OPTIONS +
-		      sizeof(struct net_ipv4_hdr))) & (~0x3LU);
+	return mss;
 }
-#else /* CONFIG_NET_IPV4 */
-#define ip_max_packet_len(...) 0
-#endif /* CONFIG_NET_IPV4 */
 
 uint16_t net_tcp_get_recv_mss(const struct net_tcp *tcp)
 {
@@ -461,31 +991,33 @@ uint16_t net_tcp_get_recv_mss(const struct net_tcp *tcp)
 	return 0;
 }
 
-static void net_tcp_set_syn_opt(struct net_tcp *tcp, uint8_t *options,
-				uint8_t *optionlen)
+bool net_tcp_delay_ack(struct net_tcp *tcp)
 {
-	uint16_t recv_mss;
+#if CONFIG_NET_TCP_ACK_DELAY > 0
+	if ((tcp->flags & NET_TCP_QUICKACK) || tcp->send_ack == tcp->sent_ack) {
+		return false;
+	}
 
-	*optionlen = 0;
+	if (tcp->send_ack - tcp->sent_ack >= 2 * net_tcp_get_recv_mss(tcp)) {
+		k_delayed_work_cancel(&tcp->ack_timer);
+		return false;
+	}
 
-	if (!(tcp->flags & NET_TCP_RECV_MSS_SET)) {
-		recv_mss = net_tcp_get_recv_mss(tcp);
-		tcp->flags |= NET_TCP_RECV_MSS_SET;
-	} else {
-		recv_mss = 0;
+	/* The timer runs from the first segment left unacknowledged */
+	if (!k_delayed_work_remaining_get(&tcp->ack_timer)) {
+		k_delayed_work_submit(&tcp->ack_timer,
+				      CONFIG_NET_TCP_ACK_DELAY);
 	}
 
-	*((uint32_t *)(options + *optionlen)) =
-		htonl((uint32_t)(recv_mss | NET_TCP_MSS_HEADER));
-	*optionlen += NET_TCP_MSS_SIZE;
+	return true;
+#else
+	return false;
+#endif
 }
 
 int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 			struct net_buf **buf)
 {
-	uint8_t options[NET_TCP_MAX_OPT_SIZE];
-	uint8_t optionlen;
-
 	switch (net_tcp_get_state(tcp)) {
 	case NET_TCP_SYN_RCVD:
 		/* In the SYN_RCVD state acknowledgment must be with the
@@ -493,10 +1025,8 @@ int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 		 */
 		tcp->send_seq--;
 
-		net_tcp_set_syn_opt(tcp, options, &optionlen);
-
 		net_tcp_prepare_segment(tcp, NET_TCP_SYN | NET_TCP_ACK,
-					options, optionlen, NULL, remote, buf);
+					NULL, 0, NULL, remote, buf);
 		break;
 
 	case NET_TCP_FIN_WAIT_1:
@@ -585,7 +1115,47 @@ const char * const net_tcp_state_str(enum net_tcp_state state)
 	return "";
 }
 
-int net_tcp_queue_data(struct net_context *context, struct net_buf *buf)
+/* Move the first 'len' bytes of data of 'buf' to a new buffer. Whole
+ * fragments are moved, only the one straddling the limit is copied.
+ */
+static struct net_buf *split_data(struct net_context *context,
+				  struct net_buf *buf, uint16_t len)
+{
+	struct net_buf *seg, *frag;
+
+	seg = net_nbuf_get_tx(context);
+	if (!seg) {
+		return NULL;
+	}
+
+	net_nbuf_set_token(seg, net_nbuf_token(buf));
+
+	while (len) {
+		frag = buf->frags;
+
+		if (frag->len <= len) {
+			buf->frags = frag->frags;
+			frag->frags = NULL;
+			len -= frag->len;
+
+			net_buf_frag_add(seg, frag);
+			continue;
+		}
+
+		if (!net_nbuf_append(seg, len, frag->data)) {
+			net_nbuf_unref(seg);
+			return NULL;
+		}
+
+		net_buf_pull(frag, len);
+		len = 0;
+	}
+
+	return seg;
+}
+
+static int queue_segment(struct net_context *context, struct net_buf *buf,
+			 uint16_t mss)
 {
 	struct net_conn *conn = (struct net_conn *)context->conn_handler;
 	size_t data_len = net_buf_frags_len(buf);
@@ -602,13 +1172,158 @@ int net_tcp_queue_data(struct net_context *context, struct net_buf *buf)
 	}
 
 	context->tcp->send_seq += data_len;
+	net_nbuf_set_appdatalen(buf, data_len);
 
-	sys_slist_append(&context->tcp->sent_list, &buf->sent_list);
-	net_buf_ref(buf);
+#if defined(CONFIG_NET_TCP_GSO)
+	if (data_len > mss) {
+		net_nbuf_set_gso_size(buf, mss);
+	}
+#else
+	ARG_UNUSED(mss);
+#endif
+
+	/* The sent list now owns the buffer: each transmission of it
+	 * takes its own reference.
+	 */
+	sys_slist_append(&context->tcp->sent_list, &buf->sent_list);
 
 	return 0;
 }
 
+#if defined(CONFIG_NET_TCP_GSO)
+/* Whether the link layer passes the packets to the driver unchanged */
+static bool gso_l2(struct net_if *iface)
+{
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (iface->l2 == &NET_L2_GET_NAME(ETHERNET)) {
+		return true;
+	}
+#endif
+
+#if defined(CONFIG_NET_L2_DUMMY)
+	if (iface->l2 == &NET_L2_GET_NAME(DUMMY)) {
+		return true;
+	}
+#endif
+
+	return false;
+}
+
+/* Largest amount of data to queue in one packet, split in segments of
+ * 'mss' bytes when it is handed to the driver.
+ */
+static uint16_t gso_max_len(struct net_context *context, uint16_t mss)
+{
+	struct net_tcp *tcp = context->tcp;
+	struct net_if *iface = net_context_get_iface(context);
+	uint32_t window = min(net_tcp_cc_window(tcp), tcp->send_wnd);
+	uint32_t segs = min(window / mss, CONFIG_NET_TCP_GSO_MAX_SEGS);
+
+	if (!iface || segs < 2 || !gso_l2(iface)) {
+		return mss;
+	}
+
+	/* Looped back packets never reach a driver to be segmented */
+	if (net_context_get_family(context) == AF_INET6) {
+		if (net_is_ipv6_addr_loopback(
+			    &net_sin6(&context->remote)->sin6_addr)) {
+			return mss;
+		}
+	} else if (net_is_ipv4_addr_loopback(
+			   &net_sin(&context->remote)->sin_addr)) {
+		return mss;
+	}
+
+	return segs * mss;
+}
+#else
+#define gso_max_len(context, mss) (mss)
+#endif /* CONFIG_NET_TCP_GSO */
+
+/* Nagle algorithm, RFC 896: while data is unacknowledged, a write
+ * smaller than a segment waits for more data or for the ACK.
+ */
+static bool nagle_hold(struct net_tcp *tcp, struct net_buf *buf,
+		       uint16_t mss)
+{
+#if defined(CONFIG_NET_TCP_NAGLE)
+	return !(tcp->flags & NET_TCP_NODELAY) &&
+		!sys_slist_is_empty(&tcp->sent_list) &&
+		net_buf_frags_len(buf->frags) < mss;
+#else
+	return false;
+#endif
+}
+
+int net_tcp_push(struct net_context *context)
+{
+	struct net_tcp *tcp = context->tcp;
+	struct net_buf *buf = tcp->nagle_buf;
+	int ret;
+
+	if (!buf) {
+		return 0;
+	}
+
+	tcp->nagle_buf = NULL;
+
+	ret = queue_segment(context, buf, net_tcp_get_send_mss(tcp));
+	if (ret) {
+		net_nbuf_unref(buf);
+		return ret;
+	}
+
+	return net_tcp_send_data(context);
+}
+
+int net_tcp_queue_data(struct net_context *context, struct net_buf *buf)
+{
+	struct net_tcp *tcp = context->tcp;
+	uint16_t mss = net_tcp_get_send_mss(tcp);
+	uint16_t max_len = gso_max_len(context, mss);
+	struct net_buf *seg, *frags;
+	int ret;
+
+	/* The data held back goes first. The caller keeps using the
+	 * buffer it passed, which thus becomes the one holding the data.
+	 */
+	if (tcp->nagle_buf) {
+		frags = buf->frags;
+		buf->frags = tcp->nagle_buf->frags;
+		tcp->nagle_buf->frags = NULL;
+
+		if (frags) {
+			net_buf_frag_add(buf, frags);
+		}
+
+		net_nbuf_unref(tcp->nagle_buf);
+		tcp->nagle_buf = NULL;
+	}
+
+	/* Each segment must fit in the path MTU, or be split in segments
+	 * that do, the last one of them is the buffer itself.
+	 */
+	while (net_buf_frags_len(buf->frags) > max_len) {
+		seg = split_data(context, buf, max_len);
+		if (!seg) {
+			return -ENOMEM;
+		}
+
+		ret = queue_segment(context, seg, mss);
+		if (ret) {
+			net_nbuf_unref(seg);
+			return ret;
+		}
+	}
+
+	if (nagle_hold(tcp, buf, mss)) {
+		tcp->nagle_buf = buf;
+		return 0;
+	}
+
+	return queue_segment(context, buf, mss);
+}
+
 int net_tcp_send_buf(struct net_buf *buf)
 {
 	struct net_context *ctx = net_nbuf_context(buf);
@@ -627,97 +1342,623 @@ int net_tcp_send_buf(struct net_buf *buf)
 
 	ctx->tcp->sent_ack = ctx->tcp->send_ack;
 
+	if (ctx->tcp->flags & NET_TCP_TIMESTAMPS) {
+		struct tcp_options opts;
+
+		/* Retransmissions carry a new timestamp */
+		parse_options(buf, &opts);
+		if (opts.ts) {
+			sys_put_be32(k_uptime_get_32(), opts.ts);
+			sys_put_be32(ctx->tcp->ts_recent, opts.ts + 4);
+		}
+	}
+
+	/* The header has changed since the checksum was computed, the
+	 * segments of an offload packet get theirs when they are built.
+	 */
+	tcphdr->chksum = 0;
+	if (!net_nbuf_tx_chksum_offloaded(buf) && !net_nbuf_gso_size(buf)) {
+		tcphdr->chksum = ~net_calc_chksum_tcp(buf);
+	}
+
 	net_nbuf_set_buf_sent(buf, true);
 
 	return net_send_data(buf);
 }
 
+#if defined(CONFIG_NET_TCP_GSO)
+struct net_buf *net_tcp_gso_segment(struct net_buf *buf, uint16_t offset)
+{
+	uint16_t ll_reserve = net_nbuf_ll_reserve(buf);
+	uint16_t hdr_len = net_nbuf_ip_hdr_len(buf) + net_nbuf_ext_len(buf) +
+		((NET_TCP_BUF(buf)->offset >> 4) << 2);
+	uint16_t total = net_nbuf_appdatalen(buf);
+	uint16_t len = min(net_nbuf_gso_size(buf), total - offset);
+	struct net_buf *seg, *frag, *src = buf->frags;
+	uint16_t src_pos = hdr_len + offset;
+	struct net_tcp_hdr *tcphdr;
+	uint16_t left, count;
+
+	seg = net_nbuf_get_reserve_tx(0);
+	if (!seg) {
+		return NULL;
+	}
+
+	frag = net_nbuf_get_reserve_data(ll_reserve);
+	if (!frag) {
+		net_nbuf_unref(seg);
+		return NULL;
+	}
+
+	net_buf_frag_add(seg, frag);
+
+	net_nbuf_set_iface(seg, net_nbuf_iface(buf));
+	net_nbuf_set_family(seg, net_nbuf_family(buf));
+	net_nbuf_set_ll_reserve(seg, ll_reserve);
+	net_nbuf_set_ip_hdr_len(seg, net_nbuf_ip_hdr_len(buf));
+	net_nbuf_set_ext_len(seg, net_nbuf_ext_len(buf));
+	net_nbuf_set_priority(seg, net_nbuf_priority(buf));
+	*net_nbuf_ll_src(seg) = *net_nbuf_ll_src(buf);
+	*net_nbuf_ll_dst(seg) = *net_nbuf_ll_dst(buf);
+
+	/* The headers of the packet are the template of all segments */
+	memcpy(net_buf_add(frag, hdr_len), buf->frags->data, hdr_len);
+
+	for (left = len; left; left -= count) {
+		while (src_pos >= src->len) {
+			src_pos -= src->len;
+			src = src->frags;
+		}
+
+		count = min(left, src->len - src_pos);
+		if (!net_nbuf_append(seg, count, src->data + src_pos)) {
+			net_nbuf_unref(seg);
+			return NULL;
+		}
+
+		src_pos += count;
+	}
+
+	/* The link layer header was already set in the packet */
+	for (frag = seg->frags; frag; frag = frag->frags) {
+		memcpy(frag->data - ll_reserve, net_nbuf_ll(buf), ll_reserve);
+	}
+
+	tcphdr = NET_TCP_BUF(seg);
+	sys_put_be32(sys_get_be32(tcphdr->seq) + offset, tcphdr->seq);
+
+	if (offset + len < total) {
+		tcphdr->flags &= ~NET_TCP_FIN;
+	}
+
+	if (net_nbuf_family(seg) == AF_INET6) {
+		uint16_t payload_len = hdr_len + len - NET_IPV6H_LEN;
+
+		NET_IPV6_BUF(seg)->len[0] = payload_len >> 8;
+		NET_IPV6_BUF(seg)->len[1] = payload_len;
+	} else {
+		struct net_ipv4_hdr *hdr = NET_IPV4_BUF(seg);
+		uint16_t id = (hdr->id[0] << 8) + hdr->id[1] +
+			offset / net_nbuf_gso_size(buf);
+
+		hdr->len[0] = (hdr_len + len) >> 8;
+		hdr->len[1] = hdr_len + len;
+		hdr->id[0] = id >> 8;
+		hdr->id[1] = id;
+		hdr->chksum = 0;
+
+		if (!net_nbuf_tx_chksum_offloaded(seg)) {
+			hdr->chksum = ~net_calc_chksum_ipv4(seg);
+		}
+	}
+
+	tcphdr->chksum = 0;
+	if (!net_nbuf_tx_chksum_offloaded(seg)) {
+		tcphdr->chksum = ~net_calc_chksum_tcp(seg);
+	}
+
+	return seg;
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 static void restart_timer(struct net_tcp *tcp)
 {
-	if (sys_slist_is_empty(&tcp->sent_list)) {
-		tcp->flags |= NET_TCP_RETRYING;
-		tcp->retry_timeout_shift = 0;
+	if (!sys_slist_is_empty(&tcp->sent_list)) {
 		k_timer_start(&tcp->retry_timer, retry_timeout(tcp), 0);
 	} else {
 		k_timer_stop(&tcp->retry_timer);
-		tcp->flags &= ~NET_TCP_RETRYING;
 	}
 }
 
+uint32_t net_tcp_flight_size(struct net_tcp *tcp)
+{
+	struct net_buf *buf;
+	sys_snode_t *node;
+	uint32_t flight = 0;
+
+	SYS_SLIST_FOR_EACH_NODE(&tcp->sent_list, node) {
+		buf = CONTAINER_OF(node, struct net_buf, sent_list);
+		if (!net_nbuf_buf_sent(buf)) {
+			break;
+		}
+
+		flight += net_nbuf_appdatalen(buf);
+	}
+
+	return flight;
+}
+
 int net_tcp_send_data(struct net_context *context)
 {
+	struct net_tcp *tcp = context->tcp;
+	uint32_t window = min(net_tcp_cc_window(tcp), tcp->send_wnd);
+	uint32_t flight = 0;
 	struct net_buf *buf;
 	sys_snode_t *node;
+	uint16_t len;
 
-	/* For now, just send all queued data synchronously.  Need to
-	 * add window handling and retry/ACK logic.
+	/* Send queued data as long as both the congestion window and the
+	 * peer's window allow it, always allowing at least one segment in
+	 * flight: when the peer's window is closed, that segment probes
+	 * it, retransmitted with backoff until the window opens.
 	 */
-	SYS_SLIST_FOR_EACH_NODE(&context->tcp->sent_list, node) {
+	SYS_SLIST_FOR_EACH_NODE(&tcp->sent_list, node) {
 		buf = CONTAINER_OF(node, struct net_buf, sent_list);
+		len = net_nbuf_appdatalen(buf);
+
 		if (!net_nbuf_buf_sent(buf)) {
-			net_tcp_send_buf(buf);
+			if (flight && flight + len > window) {
+				break;
+			}
+
+			if (!(tcp->flags & NET_TCP_RTT_MEASURING)) {
+				tcp->flags |= NET_TCP_RTT_MEASURING;
+				tcp->rtt_seq = len +
+					sys_get_be32(NET_TCP_BUF(buf)->seq);
+				tcp->rtt_start = k_uptime_get_32();
+			}
+
+			if (!k_timer_remaining_get(&tcp->retry_timer)) {
+				k_timer_start(&tcp->retry_timer,
+					      retry_timeout(tcp), 0);
+			}
+
+			net_tcp_send_buf(net_buf_ref(buf));
 		}
+
+		flight += len;
 	}
 
 	return 0;
 }
 
-void net_tcp_ack_received(struct net_context *ctx, uint32_t ack)
+bool net_tcp_update_send_wnd(struct net_tcp *tcp, struct net_buf *buf)
+{
+	struct net_tcp_hdr *tcphdr = NET_TCP_BUF(buf);
+	uint32_t seq = sys_get_be32(tcphdr->seq);
+	uint32_t ack = sys_get_be32(tcphdr->ack);
+	uint32_t wnd = sys_get_be16(tcphdr->wnd);
+	bool changed;
+
+	if (NET_TCP_FLAGS(buf) & NET_TCP_SYN) {
+		/* The window of SYN segments is never scaled */
+		tcp->send_wl1 = seq;
+		tcp->send_wl2 = ack;
+	} else if (net_tcp_seq_greater(seq, tcp->send_wl1) ||
+		   (seq == tcp->send_wl1 &&
+		    !net_tcp_seq_greater(tcp->send_wl2, ack))) {
+		tcp->send_wl1 = seq;
+		tcp->send_wl2 = ack;
+		wnd <<= tcp->send_wnd_scale;
+	} else {
+		return false;
+	}
+
+	changed = wnd != tcp->send_wnd;
+	tcp->send_wnd = wnd;
+
+	return changed;
+}
+
+/* Forget the blocks acknowledged cumulatively */
+static void sack_prune(struct net_tcp *tcp, uint32_t ack)
+{
+	struct net_tcp_seq_block *block;
+	int i = 0;
+
+	while (i < tcp->sacked_count) {
+		block = &tcp->sacked[i];
+
+		if (!net_tcp_seq_greater(block->end, ack)) {
+			tcp->sacked_count--;
+			memmove(block, block + 1,
+				(tcp->sacked_count - i) * sizeof(*block));
+			continue;
+		}
+
+		if (net_tcp_seq_greater(ack, block->start)) {
+			block->start = ack;
+		}
+
+		i++;
+	}
+}
+
+/* Add a SACK block to the scoreboard, merging it with the blocks it
+ * overlaps or touches.  The scoreboard stays sorted.
+ */
+static void sack_add(struct net_tcp *tcp,
+		     const struct net_tcp_seq_block *sack)
+{
+	struct net_tcp_seq_block new = *sack, *block;
+	int i = 0;
+
+	while (i < tcp->sacked_count) {
+		block = &tcp->sacked[i];
+
+		if (!net_tcp_seq_greater(new.start, block->end) &&
+		    !net_tcp_seq_greater(block->start, new.end)) {
+			if (net_tcp_seq_greater(new.start, block->start)) {
+				new.start = block->start;
+			}
+
+			if (net_tcp_seq_greater(block->end, new.end)) {
+				new.end = block->end;
+			}
+
+			tcp->sacked_count--;
+			memmove(block, block + 1,
+				(tcp->sacked_count - i) * sizeof(*block));
+			continue;
+		}
+
+		i++;
+	}
+
+	if (tcp->sacked_count == NET_TCP_SACK_SCOREBOARD_SIZE) {
+		/* Only an optimization: the data will be retransmitted */
+		return;
+	}
+
+	for (i = 0; i < tcp->sacked_count; i++) {
+		if (net_tcp_seq_greater(tcp->sacked[i].start, new.start)) {
+			break;
+		}
+	}
+
+	memmove(&tcp->sacked[i + 1], &tcp->sacked[i],
+		(tcp->sacked_count - i) * sizeof(tcp->sacked[0]));
+	tcp->sacked[i] = new;
+	tcp->sacked_count++;
+}
+
+static void sack_update(struct net_tcp *tcp, struct tcp_options *opts,
+			uint32_t ack)
+{
+	struct net_tcp_seq_block *sack;
+	int i;
+
+	sack_prune(tcp, ack);
+
+	for (i = 0; i < opts->sack_blocks; i++) {
+		sack = &opts->sack[i];
+
+		/* Ignore blocks already acknowledged (D-SACK, RFC 2883)
+		 * and invalid ones.
+		 */
+		if (!net_tcp_seq_greater(sack->end, sack->start) ||
+		    !net_tcp_seq_greater(sack->start, ack) ||
+		    net_tcp_seq_greater(sack->end, tcp->send_seq)) {
+			continue;
+		}
+
+		sack_add(tcp, sack);
+	}
+}
+
+static bool is_sacked(struct net_tcp *tcp, struct net_buf *buf)
+{
+	uint32_t seq = seg_seq(buf), end = seg_end(buf);
+	int i;
+
+	for (i = 0; i < tcp->sacked_count; i++) {
+		if (!net_tcp_seq_greater(tcp->sacked[i].start, seq) &&
+		    !net_tcp_seq_greater(end, tcp->sacked[i].end)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Retransmit the next segment the scoreboard shows missing, i.e. not
+ * selectively acknowledged while data after it is, past the holes
+ * already retransmitted during this recovery.  This is a simplified
+ * version of the loss recovery of RFC 6675.
+ */
+static bool sack_retransmit(struct net_tcp *tcp)
 {
-	sys_slist_t *list = &ctx->tcp->sent_list;
-	sys_snode_t *head;
 	struct net_buf *buf;
+	sys_snode_t *node;
+	uint32_t highest;
+
+	if (!tcp->sacked_count) {
+		return false;
+	}
+
+	highest = tcp->sacked[tcp->sacked_count - 1].end;
+
+	SYS_SLIST_FOR_EACH_NODE(&tcp->sent_list, node) {
+		buf = CONTAINER_OF(node, struct net_buf, sent_list);
+
+		if (!net_nbuf_buf_sent(buf) ||
+		    !net_tcp_seq_greater(highest, seg_seq(buf))) {
+			break;
+		}
+
+		if (net_tcp_seq_greater(tcp->sack_rexmit_next, seg_seq(buf)) ||
+		    is_sacked(tcp, buf)) {
+			continue;
+		}
+
+		NET_DBG("SACK retransmit of seq %u", seg_seq(buf));
+
+		tcp->flags &= ~NET_TCP_RTT_MEASURING;
+		tcp->sack_rexmit_next = seg_end(buf);
+
+		net_stats_update_tcp_rexmit();
+		net_stats_update_tcp_sack_rexmit();
+
+		net_tcp_send_buf(net_buf_ref(buf));
+
+		return true;
+	}
+
+	return false;
+}
+
+/* Update the timestamp to echo, see RFC 7323 ch. 4.3 */
+static void update_ts_recent(struct net_tcp *tcp, struct net_buf *buf,
+			     struct tcp_options *opts)
+{
+	if ((int32_t)(opts->tsval - tcp->ts_recent) >= 0 &&
+	    !net_tcp_seq_greater(seg_seq(buf), tcp->sent_ack)) {
+		tcp->ts_recent = opts->tsval;
+	}
+}
+
+void net_tcp_ack_received(struct net_context *ctx, struct net_buf *buf)
+{
+	struct net_tcp *tcp = ctx->tcp;
+	sys_slist_t *list = &tcp->sent_list;
+	uint32_t ack = sys_get_be32(NET_TCP_BUF(buf)->ack);
+	uint16_t data_len = net_nbuf_appdatalen(buf);
+	struct tcp_options opts;
+	struct net_buf *sent;
+	sys_snode_t *head;
 	struct net_tcp_hdr *tcphdr;
 	uint32_t seq;
-	bool valid_ack = false;
+	uint32_t acked = 0;
+	bool wnd_changed;
+
+	wnd_changed = net_tcp_update_send_wnd(tcp, buf);
+
+	if (tcp->flags & (NET_TCP_SACK | NET_TCP_TIMESTAMPS)) {
+		parse_options(buf, &opts);
+	} else {
+		opts.ts = NULL;
+		opts.sack_blocks = 0;
+	}
+
+	if ((tcp->flags & NET_TCP_TIMESTAMPS) && opts.ts) {
+		update_ts_recent(tcp, buf, &opts);
+	}
 
 	while (!sys_slist_is_empty(list)) {
 		head = sys_slist_peek_head(list);
-		buf = CONTAINER_OF(head, struct net_buf, sent_list);
-		tcphdr = NET_TCP_BUF(buf);
+		sent = CONTAINER_OF(head, struct net_buf, sent_list);
+		tcphdr = NET_TCP_BUF(sent);
 
-		seq = sys_get_be32(tcphdr->seq) + net_nbuf_appdatalen(buf) - 1;
+		seq = sys_get_be32(tcphdr->seq) + net_nbuf_appdatalen(sent) - 1;
 
-		if (seq_greater(ack, seq)) {
+		if (net_tcp_seq_greater(ack, seq)) {
 			sys_slist_remove(list, NULL, head);
-			net_nbuf_unref(buf);
-			valid_ack = true;
+			acked += net_nbuf_appdatalen(sent);
+			net_nbuf_unref(sent);
 		} else {
 			break;
 		}
 	}
 
-	if (valid_ack) {
-		/* Restart the timer on a valid inbound ACK.  This
-		 * isn't quite the same behavior as per-packet retry
-		 * timers, but is close in practice (it starts retries
-		 * one timer period after the connection "got stuck")
-		 * and avoids the need to track per-packet timers or
-		 * sent times.
+	if (tcp->flags & NET_TCP_SACK) {
+		if (opts.sack_blocks) {
+			net_stats_update_tcp_sack_recv();
+		}
+
+		sack_update(tcp, &opts, ack);
+	}
+
+	if (!acked) {
+		/* A duplicate ACK acknowledges the first unacknowledged
+		 * segment again, without carrying data nor changing the
+		 * window, see RFC 5681.
 		 */
-		restart_timer(ctx->tcp);
+		if (wnd_changed) {
+			net_tcp_send_data(ctx);
+			return;
+		}
+
+		if (data_len || sys_slist_is_empty(list) ||
+		    !net_nbuf_buf_sent(first_unacked(tcp)) ||
+		    ack != sys_get_be32(NET_TCP_BUF(first_unacked(tcp))->seq)) {
+			return;
+		}
 
-		/* And, if we had been retrying, mark all packets
-		 * untransmitted and then resend them.  The stalled
-		 * pipe is uncorked again.
+		if (net_tcp_cc_dup_ack(tcp, ack)) {
+			NET_DBG("Fast retransmit of seq %u", ack);
+			retransmit_first_unacked(tcp);
+			tcp->sack_rexmit_next = seg_end(first_unacked(tcp));
+			restart_timer(tcp);
+		} else if (tcp->flags & NET_TCP_FAST_RECOVERY) {
+			/* Each duplicate ACK may tell of another hole */
+			sack_retransmit(tcp);
+		}
+
+		/* The window may have been inflated meanwhile */
+		net_tcp_send_data(ctx);
+		return;
+	}
+
+	if ((tcp->flags & NET_TCP_TIMESTAMPS) && opts.ts && opts.tsecr) {
+		/* The echoed timestamp gives an accurate sample even when
+		 * the data acknowledged was retransmitted.
 		 */
-		if (ctx->tcp->flags & NET_TCP_RETRYING) {
-			struct net_buf *buf;
-			sys_snode_t *node;
-
-			SYS_SLIST_FOR_EACH_NODE(&ctx->tcp->sent_list, node) {
-				buf = CONTAINER_OF(node, struct net_buf,
-						   sent_list);
-				net_nbuf_set_buf_sent(buf, false);
+		tcp->flags &= ~NET_TCP_RTT_MEASURING;
+		update_rtt(tcp, k_uptime_get_32() - opts.tsecr);
+	} else if ((tcp->flags & NET_TCP_RTT_MEASURING) &&
+		   !net_tcp_seq_greater(tcp->rtt_seq, ack)) {
+		tcp->flags &= ~NET_TCP_RTT_MEASURING;
+		update_rtt(tcp, k_uptime_get_32() - tcp->rtt_start);
+	}
+
+	tcp->retry_timeout_shift = 0;
+
+	if (net_tcp_cc_ack(tcp, ack, acked) && !sys_slist_is_empty(list)) {
+		/* partial ACK during fast recovery: the first segment is
+		 * missing, unless the peer has selectively acknowledged it
+		 */
+		if (!is_sacked(tcp, first_unacked(tcp))) {
+			retransmit_first_unacked(tcp);
+			if (net_tcp_seq_greater(seg_end(first_unacked(tcp)),
+						tcp->sack_rexmit_next)) {
+				tcp->sack_rexmit_next =
+					seg_end(first_unacked(tcp));
 			}
+		} else {
+			sack_retransmit(tcp);
+		}
+	}
 
-			net_tcp_send_data(ctx);
+	/* Restart the timer on a valid inbound ACK.  This isn't quite
+	 * the same behavior as per-packet retry timers, but is close in
+	 * practice (it starts retries one timer period after the
+	 * connection "got stuck") and avoids the need to track
+	 * per-packet timers or sent times.
+	 */
+	restart_timer(tcp);
+
+	/* And, if we had been retrying, mark all packets untransmitted
+	 * and then resend them, as the congestion window allows.  The
+	 * stalled pipe is uncorked again.
+	 */
+	if (tcp->flags & NET_TCP_RETRYING) {
+		sys_snode_t *node;
+
+		tcp->flags &= ~NET_TCP_RETRYING;
+
+		SYS_SLIST_FOR_EACH_NODE(list, node) {
+			sent = CONTAINER_OF(node, struct net_buf, sent_list);
+			net_nbuf_set_buf_sent(sent, false);
+		}
+	}
+
+	/* Everything sent is acknowledged, the small writes held back
+	 * by the Nagle algorithm can go.
+	 */
+	if (tcp->nagle_buf && sys_slist_is_empty(list)) {
+		net_tcp_push(ctx);
+		return;
+	}
+
+	/* The window may have opened */
+	net_tcp_send_data(ctx);
+}
+
+bool net_tcp_queue_ooo(struct net_tcp *tcp, struct net_buf *buf)
+{
+	uint32_t seq = seg_seq(buf);
+	uint16_t len = net_nbuf_appdatalen(buf);
+	sys_snode_t *node, *prev = NULL;
+	struct net_buf *queued;
+	int count = 0;
+
+	if (!len || !net_tcp_seq_greater(seq, tcp->send_ack) ||
+	    net_tcp_seq_greater(seq + len,
+				tcp->send_ack + get_recv_wnd_len(tcp))) {
+		return false;
+	}
+
+	SYS_SLIST_FOR_EACH_NODE(&tcp->ooo_list, node) {
+		queued = CONTAINER_OF(node, struct net_buf, sent_list);
+
+		if (net_tcp_seq_greater(seg_seq(queued) +
+					net_nbuf_appdatalen(queued), seq) &&
+		    net_tcp_seq_greater(seq + len, seg_seq(queued))) {
+			/* overlaps a queued segment, e.g. a retransmission */
+			return false;
+		}
+
+		if (net_tcp_seq_greater(seq, seg_seq(queued))) {
+			prev = node;
+		}
+
+		count++;
+	}
+
+	if (count >= CONFIG_NET_TCP_MAX_OOO_SEGMENTS) {
+		NET_DBG("Out-of-order queue full, dropping seq %u", seq);
+		return false;
+	}
+
+	/* Insert after the last segment preceding this one. Received
+	 * buffers do not use the sent list node otherwise.
+	 */
+	sys_slist_insert(&tcp->ooo_list, prev, &buf->sent_list);
+
+	tcp->ooo_recent = seq;
+
+	NET_DBG("Queued out-of-order seq %u len %u", seq, len);
+
+	return true;
+}
+
+struct net_buf *net_tcp_get_ooo(struct net_tcp *tcp)
+{
+	struct net_buf *buf;
+	sys_snode_t *head;
+
+	while ((head = sys_slist_peek_head(&tcp->ooo_list))) {
+		buf = CONTAINER_OF(head, struct net_buf, sent_list);
+
+		if (net_tcp_seq_greater(seg_seq(buf), tcp->send_ack)) {
+			/* there is still a hole before this segment */
+			return NULL;
+		}
+
+		sys_slist_remove(&tcp->ooo_list, NULL, head);
+
+		if (seg_seq(buf) == tcp->send_ack) {
+			return buf;
 		}
+
+		/* Data received meanwhile overlaps it: the peer will
+		 * retransmit what follows the next expected sequence number.
+		 */
+		net_nbuf_unref(buf);
 	}
+
+	return NULL;
 }
 
 void net_tcp_init(void)
 {
+	int i;
+
+	sys_slist_init(&tcp_free);
+
+	for (i = 0; i < NET_MAX_TCP_CONTEXT; i++) {
+		sys_slist_append(&tcp_free, &tcp_context[i].node);
+	}
 }
 
 #define FIN_TIMEOUT (2 * NET_TCP_MAX_SEG_LIFETIME * MSEC_PER_SEC)
@@ -735,6 +1976,239 @@ static void fin_timeout(struct k_work *work)
 	}
 }
 
+/* A connection in TIME_WAIT only needs its addresses and sequence
+ * numbers, to acknowledge a retransmitted FIN of the peer and to keep
+ * old segments off a new connection with the same addresses and ports.
+ */
+struct time_wait {
+	struct sockaddr local;
+	struct sockaddr remote;
+	struct net_if *iface;
+	uint32_t expiry;
+	uint32_t send_seq;
+	uint32_t send_ack;
+	bool in_use;
+};
+
+static struct time_wait time_wait[CONFIG_NET_TCP_TIME_WAIT_COUNT];
+
+static bool time_wait_expired(struct time_wait *tw, uint32_t now)
+{
+	return (int32_t)(now - tw->expiry) >= 0;
+}
+
+void net_tcp_time_wait(struct net_tcp *tcp)
+{
+	struct net_context *context = tcp->context;
+	struct time_wait *tw = NULL;
+	uint32_t now = k_uptime_get_32();
+	int i, key;
+
+	key = irq_lock();
+
+	for (i = 0; i < ARRAY_SIZE(time_wait); i++) {
+		if (!time_wait[i].in_use ||
+		    time_wait_expired(&time_wait[i], now)) {
+			tw = &time_wait[i];
+			break;
+		}
+
+		/* Under pressure the oldest one is reused early */
+		if (!tw || (int32_t)(tw->expiry - time_wait[i].expiry) > 0) {
+			tw = &time_wait[i];
+		}
+	}
+
+	tw->in_use = true;
+	irq_unlock(key);
+
+	NET_DBG("TIME_WAIT of TCP context %p in slot %d", tcp,
+		(int)(tw - time_wait));
+
+	tw->iface = net_context_get_iface(context);
+	tw->expiry = now + FIN_TIMEOUT;
+	tw->send_seq = tcp->send_seq;
+	tw->send_ack = tcp->send_ack;
+	memcpy(&tw->remote, &context->remote, sizeof(tw->remote));
+
+	tw->local.family = net_context_get_family(context);
+
+#if defined(CONFIG_NET_IPV6)
+	if (tw->local.family == AF_INET6) {
+		net_ipaddr_copy(&net_sin6(&tw->local)->sin6_addr,
+				net_sin6_ptr(&context->local)->sin6_addr);
+		net_sin6(&tw->local)->sin6_port =
+			net_sin6_ptr(&context->local)->sin6_port;
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4)
+	if (tw->local.family == AF_INET) {
+		net_ipaddr_copy(&net_sin(&tw->local)->sin_addr,
+				net_sin_ptr(&context->local)->sin_addr);
+		net_sin(&tw->local)->sin_port =
+			net_sin_ptr(&context->local)->sin_port;
+	}
+#endif
+}
+
+static bool time_wait_match(struct time_wait *tw, struct net_buf *buf)
+{
+	struct net_tcp_hdr *tcphdr = NET_TCP_BUF(buf);
+
+	if (tw->local.family != net_nbuf_family(buf)) {
+		return false;
+	}
+
+#if defined(CONFIG_NET_IPV6)
+	if (net_nbuf_family(buf) == AF_INET6) {
+		return tcphdr->dst_port == net_sin6(&tw->local)->sin6_port &&
+			tcphdr->src_port ==
+			net_sin6(&tw->remote)->sin6_port &&
+			net_ipv6_addr_cmp(&NET_IPV6_BUF(buf)->dst,
+					  &net_sin6(&tw->local)->sin6_addr) &&
+			net_ipv6_addr_cmp(&NET_IPV6_BUF(buf)->src,
+					  &net_sin6(&tw->remote)->sin6_addr);
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4)
+	if (net_nbuf_family(buf) == AF_INET) {
+		return tcphdr->dst_port == net_sin(&tw->local)->sin_port &&
+			tcphdr->src_port == net_sin(&tw->remote)->sin_port &&
+			net_ipv4_addr_cmp(&NET_IPV4_BUF(buf)->dst,
+					  &net_sin(&tw->local)->sin_addr) &&
+			net_ipv4_addr_cmp(&NET_IPV4_BUF(buf)->src,
+					  &net_sin(&tw->remote)->sin_addr);
+	}
+#endif
+
+	return false;
+}
+
+/* Without a context the ACK is built from the addresses of the entry */
+static int time_wait_send_ack(struct time_wait *tw)
+{
+	struct net_tcp_hdr tcphdr;
+	struct net_buf *buf;
+	uint16_t reserve;
+
+	buf = net_nbuf_get_reserve_tx(0);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+#if defined(CONFIG_NET_IPV6)
+	if (tw->local.family == AF_INET6) {
+		reserve = net_if_get_ll_reserve(tw->iface,
+					&net_sin6(&tw->remote)->sin6_addr);
+		buf = net_ipv6_create_raw(buf, reserve,
+					  &net_sin6(&tw->local)->sin6_addr,
+					  &net_sin6(&tw->remote)->sin6_addr,
+					  tw->iface, IPPROTO_TCP);
+		tcphdr.src_port = net_sin6(&tw->local)->sin6_port;
+		tcphdr.dst_port = net_sin6(&tw->remote)->sin6_port;
+	} else
+#endif
+#if defined(CONFIG_NET_IPV4)
+	if (tw->local.family == AF_INET) {
+		reserve = net_if_get_ll_reserve(tw->iface, NULL);
+		buf = net_ipv4_create_raw(buf, reserve,
+					  &net_sin(&tw->local)->sin_addr,
+					  &net_sin(&tw->remote)->sin_addr,
+					  tw->iface, IPPROTO_TCP);
+		tcphdr.src_port = net_sin(&tw->local)->sin_port;
+		tcphdr.dst_port = net_sin(&tw->remote)->sin_port;
+	} else
+#endif
+	{
+		net_nbuf_unref(buf);
+		return -EAFNOSUPPORT;
+	}
+
+	net_nbuf_set_ll_reserve(buf, reserve);
+	net_nbuf_set_iface(buf, tw->iface);
+
+	sys_put_be32(tw->send_seq, tcphdr.seq);
+	sys_put_be32(tw->send_ack, tcphdr.ack);
+	tcphdr.offset = NET_TCPH_LEN << 2;
+	tcphdr.flags = NET_TCP_ACK;
+	sys_put_be16(0, tcphdr.wnd);
+	tcphdr.chksum = 0;
+	tcphdr.urg[0] = 0;
+	tcphdr.urg[1] = 0;
+
+	if (!net_nbuf_append(buf, sizeof(tcphdr), (uint8_t *)&tcphdr)) {
+		net_nbuf_unref(buf);
+		return -ENOMEM;
+	}
+
+#if defined(CONFIG_NET_IPV6)
+	if (tw->local.family == AF_INET6) {
+		buf = net_ipv6_finalize_raw(buf, IPPROTO_TCP);
+	}
+#endif
+#if defined(CONFIG_NET_IPV4)
+	if (tw->local.family == AF_INET) {
+		buf = net_ipv4_finalize_raw(buf, IPPROTO_TCP);
+	}
+#endif
+
+	if (net_send_data(buf) < 0) {
+		net_nbuf_unref(buf);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+bool net_tcp_time_wait_input(struct net_buf *buf)
+{
+	uint8_t flags = NET_TCP_FLAGS(buf);
+	uint32_t seq = sys_get_be32(NET_TCP_BUF(buf)->seq);
+	uint32_t now = k_uptime_get_32();
+	struct time_wait *tw;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(time_wait); i++) {
+		tw = &time_wait[i];
+
+		if (!tw->in_use || !time_wait_match(tw, buf)) {
+			continue;
+		}
+
+		if (time_wait_expired(tw, now)) {
+			tw->in_use = false;
+			return false;
+		}
+
+		/* A new connection may start beyond the old sequence
+		 * numbers, as per RFC 1122 section 4.2.2.13.
+		 */
+		if (flags & NET_TCP_SYN) {
+			if (!net_tcp_seq_greater(seq, tw->send_ack)) {
+				return true;
+			}
+
+			tw->in_use = false;
+			return false;
+		}
+
+		/* The peer missed our ACK of its FIN, see RFC 793. Other
+		 * segments are old duplicates, and a RST is ignored as per
+		 * RFC 1337.
+		 */
+		if (flags & NET_TCP_FIN) {
+			tw->expiry = now + FIN_TIMEOUT;
+			time_wait_send_ack(tw);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
 #if defined(CONFIG_NET_DEBUG_TCP)
 static void validate_state_transition(enum net_tcp_state current,
 				      enum net_tcp_state new)
@@ -44,6 +44,27 @@ extern "C" {
 /** MSS option has been set already */
 #define NET_TCP_RECV_MSS_SET BIT(5)
 
+/** A round-trip time measurement is in progress */
+#define NET_TCP_RTT_MEASURING BIT(6)
+
+/** Fast recovery is in progress, see RFC 6582 */
+#define NET_TCP_FAST_RECOVERY BIT(7)
+
+/** Window scaling is in use, see RFC 7323 */
+#define NET_TCP_WND_SCALE BIT(8)
+
+/** Selective acknowledgments are in use, see RFC 2018 */
+#define NET_TCP_SACK BIT(9)
+
+/** Timestamps are in use, see RFC 7323 */
+#define NET_TCP_TIMESTAMPS BIT(10)
+
+/** Small segments are sent at once, without Nagle coalescing */
+#define NET_TCP_NODELAY BIT(11)
+
+/** Received data is acknowledged at once, without delayed ACK */
+#define NET_TCP_QUICKACK BIT(12)
+
 /*
  * TCP connection states
  */
@@ -73,35 +94,61 @@ enum net_tcp_state {
 #define NET_TCP_FLAGS(nbuf) (NET_TCP_BUF(nbuf)->flags & NET_TCP_CTL)
 
 /* TCP max window size */
-#define NET_TCP_MAX_WIN   (4 * 1024)
+#define NET_TCP_MAX_WIN   CONFIG_NET_TCP_RECV_WINDOW
+
+/* Largest window scale shift, see RFC 7323 ch. 2.3 */
+#define NET_TCP_MAX_WND_SCALE 14
 
 /* Maximal value of the sequence number */
 #define NET_TCP_MAX_SEQ   0xffffffff
 
-#define NET_TCP_MAX_OPT_SIZE  8
+#define NET_TCP_MAX_OPT_SIZE  40
 
 #define NET_TCP_MSS_HEADER    0x02040000 /* MSS option */
-#define NET_TCP_WINDOW_HEADER 0x30300    /* Window scale option */
+#define NET_TCP_WINDOW_HEADER 0x01030300 /* NOP, window scale option */
 
 #define NET_TCP_MSS_SIZE      4          /* MSS option size */
 #define NET_TCP_WINDOW_SIZE   3          /* Window scale option size */
+#define NET_TCP_SACK_PERM_SIZE 2         /* SACK permitted option size */
+#define NET_TCP_TIMESTAMP_SIZE 10        /* Timestamps option size */
+
+/* Option kinds, see RFC 793, RFC 2018 and RFC 7323 */
+#define NET_TCP_OPT_END       0
+#define NET_TCP_OPT_NOP       1
+#define NET_TCP_OPT_MSS       2
+#define NET_TCP_OPT_WND_SCALE 3
+#define NET_TCP_OPT_SACK_PERM 4
+#define NET_TCP_OPT_SACK      5
+#define NET_TCP_OPT_TIMESTAMP 8
 
-/* Max received bytes to buffer internally */
-#define NET_TCP_BUF_MAX_LEN 1280
+/* SACK blocks fitting in the option space along with timestamps */
+#define NET_TCP_MAX_SACK_BLOCKS 3
+
+/* Blocks of data the peer has selectively acknowledged we track */
+#define NET_TCP_SACK_SCOREBOARD_SIZE 4
 
 /* Max segment lifetime, in seconds */
 #define NET_TCP_MAX_SEG_LIFETIME 60
 
 struct net_context;
 
+/** Block of sequence numbers, from start up to end (excluded) */
+struct net_tcp_seq_block {
+	uint32_t start;
+	uint32_t end;
+};
+
 struct net_tcp {
+	/** Node in the list of unused TCP contexts */
+	sys_snode_t node;
+
 	/** Network context back pointer. */
 	struct net_context *context;
 
 	/** Cookie pointer passed to net_context_recv() */
 	void *recv_user_data;
 
-	/** ACK message timer */
+	/** Delayed ACK timer */
 	struct k_delayed_work ack_timer;
 
 	/** Active close timer */
@@ -113,6 +160,12 @@ struct net_tcp {
 	/** List pointer used for TCP retransmit buffering */
 	sys_slist_t sent_list;
 
+	/** Segments received out of order, sorted by sequence number */
+	sys_slist_t ooo_list;
+
+	/** Small writes held back by the Nagle algorithm, not a segment yet */
+	struct net_buf *nagle_buf;
+
 	/** Max acknowledgment. */
 	uint32_t recv_max_ack;
 
@@ -125,14 +178,80 @@ struct net_tcp {
 	/** Last ACK value sent */
 	uint32_t sent_ack;
 
+	/** Window advertised by the peer, in bytes */
+	uint32_t send_wnd;
+
+	/** Sequence number of the segment that last updated send_wnd */
+	uint32_t send_wl1;
+
+	/** ACK number of the segment that last updated send_wnd */
+	uint32_t send_wl2;
+
+	/** Shift applied to the windows advertised by the peer */
+	uint8_t send_wnd_scale;
+
+	/** Shift applied to the windows we advertise */
+	uint8_t recv_wnd_scale;
+
+	/** MSS advertised by the peer, 0 if it sent none */
+	uint16_t send_mss;
+
+	/** Last timestamp received from the peer, to be echoed */
+	uint32_t ts_recent;
+
+	/** Sequence number of the segment last queued out of order */
+	uint32_t ooo_recent;
+
+	/** Sent data the peer has selectively acknowledged, sorted */
+	struct net_tcp_seq_block sacked[NET_TCP_SACK_SCOREBOARD_SIZE];
+
+	/** Number of valid blocks in sacked */
+	uint8_t sacked_count;
+
+	/** Holes before this sequence number have been retransmitted
+	 * during the current fast recovery.
+	 */
+	uint32_t sack_rexmit_next;
+
+	/** Smoothed round-trip time, in milliseconds, scaled by 8 */
+	uint32_t srtt;
+
+	/** Round-trip time variation, in milliseconds, scaled by 4 */
+	uint32_t rttvar;
+
+	/** Retransmission timeout before backoff, in milliseconds */
+	uint32_t rto;
+
+	/** Sequence number whose ACK ends the current RTT measurement */
+	uint32_t rtt_seq;
+
+	/** Uptime when the current RTT measurement started */
+	uint32_t rtt_start;
+
+#if defined(CONFIG_NET_TCP_CC_NEWRENO)
+	/** Congestion window, in bytes, 0 until first used */
+	uint32_t cwnd;
+
+	/** Slow start threshold, in bytes */
+	uint32_t ssthresh;
+
+	/** Highest sequence number sent when fast recovery started */
+	uint32_t recover;
+
+	/** Number of duplicate ACKs received in a row */
+	uint8_t dup_acks;
+#endif
+
 	/** Current retransmit period */
 	uint32_t retry_timeout_shift : 5;
 	/** Flags for the TCP */
-	uint32_t flags : 8;
+	uint32_t flags : 13;
 	/** Current TCP state */
 	uint32_t state : 4;
+	/** Half-open connections a listening TCP may have in the SYN cache */
+	uint32_t backlog : 8;
 	/** Remaining bits in this uint32_t */
-	uint32_t _padding : 15;
+	uint32_t _padding : 2;
 
 	/** Accept callback to be called when the connection has been
 	 * established.
@@ -145,6 +264,49 @@ struct net_tcp {
 	struct k_sem connect_wait;
 };
 
+/** Half-open connection, from its SYN to the ACK of our SYN-ACK.
+ *
+ * Only what the handshake negotiated is kept, the net_tcp of the
+ * connection being allocated once the handshake completes.
+ */
+struct net_tcp_syn {
+	/** Address and port of the peer */
+	struct sockaddr remote;
+
+	/** Uptime when the SYN was received */
+	uint32_t timestamp;
+
+	/** Our initial sequence number */
+	uint32_t iss;
+
+	/** Initial sequence number of the peer, plus one */
+	uint32_t send_ack;
+
+	/** Window advertised by the peer in its SYN, in bytes */
+	uint32_t send_wnd;
+
+	/** Timestamp of the SYN, to be echoed */
+	uint32_t ts_recent;
+
+	/** MSS advertised by the peer, 0 if it sent none */
+	uint16_t send_mss;
+
+	/** NET_TCP_WND_SCALE, NET_TCP_SACK and NET_TCP_TIMESTAMPS */
+	uint16_t flags;
+
+	uint8_t send_wnd_scale;
+	uint8_t recv_wnd_scale;
+};
+
+/* True if the (signed!) difference "seq1 - seq2" is positive and less
+ * than 2^29.  That is, seq1 is "after" seq2.
+ */
+static inline bool net_tcp_seq_greater(uint32_t seq1, uint32_t seq2)
+{
+	int d = (int)(seq1 - seq2);
+	return d > 0 && d < 0x20000000;
+}
+
 static inline bool net_tcp_is_used(struct net_tcp *tcp)
 {
 	NET_ASSERT(tcp);
@@ -295,6 +457,32 @@ int net_tcp_send_data(struct net_context *context);
  */
 int net_tcp_queue_data(struct net_context *context, struct net_buf *buf);
 
+/**
+ * @brief Queue the data held back by the Nagle algorithm
+ *
+ * Small writes are coalesced while data is unacknowledged, unless the
+ * NET_TCP_NODELAY flag is set. This pushes them out regardless, e.g.
+ * before a FIN.
+ *
+ * @param context TCP context
+ *
+ * @return 0 if ok, < 0 if error
+ */
+int net_tcp_push(struct net_context *context);
+
+/**
+ * @brief Delay the acknowledgment of received data
+ *
+ * Every second full sized segment is acknowledged at once, the others
+ * after at most CONFIG_NET_TCP_ACK_DELAY milliseconds, unless data sent
+ * meanwhile carries the ACK (RFC 1122, section 4.2.3.2).
+ *
+ * @param tcp TCP context
+ *
+ * @return true if the ACK was delayed, false if it is to be sent now
+ */
+bool net_tcp_delay_ack(struct net_tcp *tcp);
+
 /**
  * @brief Sends one TCP packet initialized with the _prepare_*()
  *        family of functions.
@@ -303,13 +491,184 @@ int net_tcp_queue_data(struct net_context *context, struct net_buf *buf);
  */
 int net_tcp_send_buf(struct net_buf *buf);
 
+#if defined(CONFIG_NET_TCP_GSO)
+/**
+ * @brief Build a segment of a packet queued for segmentation offload
+ *
+ * The headers of the packet, link layer header included, are copied
+ * and updated for the segment, followed by a copy of at most
+ * gso_size bytes of data, see net_nbuf_gso_size().
+ *
+ * @param buf Packet holding several segments
+ * @param offset Offset of the segment in the data of the packet
+ *
+ * @return Segment ready to be passed to the driver, NULL if out of buffers
+ */
+struct net_buf *net_tcp_gso_segment(struct net_buf *buf, uint16_t offset);
+#endif
+
 /**
  * @brief Handle a received TCP ACK
  *
+ * Acknowledged data is released, the send window is updated and more
+ * queued data is sent if the windows allow it.
+ *
  * @param cts Context
- * @param seq Received ACK sequence number
+ * @param buf Received segment, its application data already set
+ */
+void net_tcp_ack_received(struct net_context *ctx, struct net_buf *buf);
+
+/**
+ * @brief Update the send window from a received segment
+ *
+ * The window is only updated by segments more recent than the last one
+ * that updated it, see RFC 793 ch. 3.9.
+ *
+ * @param tcp TCP context
+ * @param buf Received segment
+ *
+ * @return true if the send window has changed
  */
-void net_tcp_ack_received(struct net_context *ctx, uint32_t ack);
+bool net_tcp_update_send_wnd(struct net_tcp *tcp, struct net_buf *buf);
+
+/**
+ * @brief Parse the options of a received SYN segment
+ *
+ * Enables window scaling, selective acknowledgments and timestamps if
+ * the peer asks for them.
+ *
+ * @param tcp TCP context
+ * @param buf Received SYN segment
+ */
+void net_tcp_parse_syn_opt(struct net_tcp *tcp, struct net_buf *buf);
+
+/**
+ * @brief Set up a half-open connection from a received SYN segment
+ *
+ * Picks our initial sequence number and parses the options of the SYN,
+ * as net_tcp_parse_syn_opt() does.
+ *
+ * @param syn Half-open connection
+ * @param buf Received SYN segment
+ */
+void net_tcp_syn_init(struct net_tcp_syn *syn, struct net_buf *buf);
+
+/**
+ * @brief Load the state of a half-open connection into a TCP context
+ *
+ * The sequence number is set to our initial one, for a SYN-ACK to be
+ * prepared.
+ *
+ * @param tcp TCP context
+ * @param syn Half-open connection
+ */
+void net_tcp_syn_load(struct net_tcp *tcp, const struct net_tcp_syn *syn);
+
+/**
+ * @brief Queue a segment received out of order
+ *
+ * Only segments carrying data within the receive window, after the next
+ * expected sequence number and not overlapping already queued ones are
+ * queued, up to CONFIG_NET_TCP_MAX_OOO_SEGMENTS of them.
+ *
+ * @param tcp TCP context
+ * @param buf Received segment, its application data already set
+ *
+ * @return true if the segment has been queued, false if it must be dropped
+ */
+bool net_tcp_queue_ooo(struct net_tcp *tcp, struct net_buf *buf);
+
+/**
+ * @brief Get the next in-order segment from the out-of-order queue
+ *
+ * Queued segments made obsolete by data received meanwhile are dropped.
+ *
+ * @param tcp TCP context
+ *
+ * @return Segment starting at the next expected sequence number, or NULL
+ */
+struct net_buf *net_tcp_get_ooo(struct net_tcp *tcp);
+
+/**
+ * @brief Remember a connection entering the TIME_WAIT state
+ *
+ * The addresses and sequence numbers of the connection are kept in a
+ * compact table for 2 * MSL, so that its TCP and network contexts can be
+ * released at once. When the table is full, the entry closest to its
+ * expiry is reused.
+ *
+ * @param tcp TCP context in TIME_WAIT state
+ */
+void net_tcp_time_wait(struct net_tcp *tcp);
+
+/**
+ * @brief Handle a segment of a connection in TIME_WAIT state
+ *
+ * A retransmitted FIN is acknowledged again, other segments are
+ * dropped, except a SYN starting a new connection.
+ *
+ * @param buf Received TCP segment
+ *
+ * @return true if the segment was consumed, false if it is not for a
+ * connection in TIME_WAIT state
+ */
+bool net_tcp_time_wait_input(struct net_buf *buf);
+
+/**
+ * @brief Get the number of bytes sent but not acknowledged yet
+ *
+ * @param tcp TCP context
+ *
+ * @return Flight size, in bytes
+ */
+uint32_t net_tcp_flight_size(struct net_tcp *tcp);
+
+/**
+ * @brief Initialize the congestion control state of a TCP context
+ *
+ * The congestion control functions are implemented by the algorithm
+ * chosen with CONFIG_NET_TCP_CC_xxx.
+ *
+ * @param tcp TCP context
+ */
+void net_tcp_cc_init(struct net_tcp *tcp);
+
+/**
+ * @brief Get the number of bytes the congestion window allows in flight
+ *
+ * @param tcp TCP context
+ *
+ * @return Congestion window, in bytes
+ */
+uint32_t net_tcp_cc_window(struct net_tcp *tcp);
+
+/**
+ * @brief Update the congestion control state on an ACK of new data
+ *
+ * @param tcp TCP context
+ * @param ack Received ACK sequence number
+ * @param acked Number of bytes newly acknowledged
+ *
+ * @return true if the first unacknowledged segment must be retransmitted
+ */
+bool net_tcp_cc_ack(struct net_tcp *tcp, uint32_t ack, uint32_t acked);
+
+/**
+ * @brief Update the congestion control state on a duplicate ACK
+ *
+ * @param tcp TCP context
+ * @param ack Received ACK sequence number
+ *
+ * @return true if the first unacknowledged segment must be retransmitted
+ */
+bool net_tcp_cc_dup_ack(struct net_tcp *tcp, uint32_t ack);
+
+/**
+ * @brief Update the congestion control state on a retransmission timeout
+ *
+ * @param tcp TCP context
+ */
+void net_tcp_cc_timeout(struct net_tcp *tcp);
 
 /**
  * @brief Calculates and returns the MSS for a given TCP context
@@ -320,6 +679,19 @@ void net_tcp_ack_received(struct net_context *ctx, uint32_t ack);
  */
 uint16_t net_tcp_get_recv_mss(const struct net_tcp *tcp);
 
+/**
+ * @brief Calculates the size of the segments sent by a TCP context
+ *
+ * @details This is the MSS advertised by the peer, reduced to fit in
+ * the path MTU towards the peer, minus the space taken by the options
+ * of the data segments.
+ *
+ * @param tcp TCP context
+ *
+ * @return Maximum amount of data in a segment
+ */
+uint16_t net_tcp_get_send_mss(const struct net_tcp *tcp);
+
 /**
  * @brief Obtains the state for a TCP context
  *
@@ -49,20 +49,15 @@ static uint32_t get_t(uint32_t I)
 	return I + (sys_rand32_get() % I);
 }
 
+static void setup_new_interval(struct net_trickle *trickle);
+
 static void double_interval_timeout(struct k_work *work)
 {
 	struct net_trickle *trickle = CONTAINER_OF(work,
 						   struct net_trickle,
 						   timer);
-	uint32_t rand_time;
 
-#if defined(CONFIG_NET_DEBUG_TRICKLE)
-	uint32_t last_end = get_end(trickle);
-#endif
-
-	trickle->c = 0;
-
-	NET_DBG("now %u (was at %u)", k_uptime_get_32(), last_end);
+	NET_DBG("now %u (was at %u)", k_uptime_get_32(), get_end(trickle));
 
 	/* Check if we need to double the interval */
 	if (trickle->I <= (trickle->Imax_abs >> 1)) {
@@ -76,17 +71,8 @@ static void double_interval_timeout(struct k_work *work)
 		NET_DBG("I %u", trickle->I);
 	}
 
-	/* Random t in [I/2, I) */
-	rand_time = get_t(trickle->I);
-
-	NET_DBG("doubling time %u", rand_time);
-
-	trickle->Istart = k_uptime_get_32() + rand_time;
-
-	k_delayed_work_submit(&trickle->timer, rand_time);
-
-	NET_DBG("last end %u new end %u for %u I %u",
-		last_end, get_end(trickle), trickle->Istart, trickle->I);
+	/* The next interval starts now, its callback is due at t */
+	setup_new_interval(trickle);
 }
 
 static inline void reschedule(struct net_trickle *trickle)
@@ -137,6 +123,11 @@ static void setup_new_interval(struct net_trickle *trickle)
 
 	trickle->Istart = k_uptime_get_32();
 
+	/* The timer may still be set for the end of the previous
+	 * interval, e.g. on an inconsistency.
+	 */
+	k_delayed_work_cancel(&trickle->timer);
+	k_delayed_work_init(&trickle->timer, trickle_timeout);
 	k_delayed_work_submit(&trickle->timer, t);
 
 	NET_DBG("new interval at %d ends %d t %d I %d",
@@ -19,11 +19,19 @@
 #include <stdbool.h>
 #include <string.h>
 #include <errno.h>
+#include <misc/byteorder.h>
 
 #include <net/net_ip.h>
 #include <net/nbuf.h>
 #include <net/net_core.h>
 
+#if defined(CONFIG_RAMFUNC_NET_CHKSUM)
+#include <sections.h>
+#define CHKSUM_RAMFUNC __ramfunc
+#else
+#define CHKSUM_RAMFUNC
+#endif
+
 char *net_byte_to_hex(uint8_t *ptr, uint8_t byte, char base, bool pad)
 {
 	int i, val;
@@ -353,28 +361,49 @@ int net_addr_pton(sa_family_t family, const char *src,
 	return 0;
 }
 
-static uint16_t calc_chksum(uint16_t sum, const uint8_t *ptr, uint16_t len)
+/*
+ * The one's complement sum does not depend on the byte order (RFC 1071), so
+ * the data is added as native 32-bit words to a wide accumulator whose
+ * carries are only folded back at the end, and the result is swapped to the
+ * network order sum the callers expect.
+ */
+CHKSUM_RAMFUNC static uint16_t calc_chksum(uint16_t sum, const uint8_t *ptr,
+					  uint16_t len)
 {
+	uint64_t acc = 0;
 	uint16_t tmp;
-	const uint8_t *end;
 
-	end = ptr + len - 1;
+	while (len >= 16) {
+		acc += UNALIGNED_GET((uint32_t *)ptr);
+		acc += UNALIGNED_GET((uint32_t *)(ptr + 4));
+		acc += UNALIGNED_GET((uint32_t *)(ptr + 8));
+		acc += UNALIGNED_GET((uint32_t *)(ptr + 12));
+		ptr += 16;
+		len -= 16;
+	}
 
-	while (ptr < end) {
-		tmp = (ptr[0] << 8) + ptr[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	while (len >= 2) {
+		acc += UNALIGNED_GET((uint16_t *)ptr);
 		ptr += 2;
+		len -= 2;
 	}
 
-	if (ptr == end) {
-		tmp = ptr[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	if (len) {
+		/* The last byte is padded with a zero byte */
+		uint8_t last[2] = { ptr[0], 0 };
+
+		acc += UNALIGNED_GET((uint16_t *)last);
+	}
+
+	while (acc >> 16) {
+		acc = (acc & 0xffff) + (acc >> 16);
+	}
+
+	tmp = sys_be16_to_cpu((uint16_t)acc);
+
+	sum += tmp;
+	if (sum < tmp) {
+		sum++;
 	}
 
 	return sum;
@@ -422,7 +451,7 @@ static inline uint16_t calc_chksum_buf(uint16_t sum, struct net_buf *buf,
 	return sum;
 }
 
-uint16_t net_calc_chksum(struct net_buf *buf, uint8_t proto)
+CHKSUM_RAMFUNC uint16_t net_calc_chksum(struct net_buf *buf, uint8_t proto)
 {
 	uint16_t upper_layer_len;
 	uint16_t sum;
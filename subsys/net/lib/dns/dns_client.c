@@ -45,15 +45,190 @@
 #define DNS_IPV4_LEN		4
 #define DNS_IPV6_LEN		16
 
+#define DNS_RESOLVER_PARALLEL	CONFIG_DNS_RESOLVER_MAX_PARALLEL
+
+/* dns_read return code for a name without records of the query type */
+#define DNS_NEGATIVE_ANSWER	1
+
 NET_BUF_POOL_DEFINE(dns_msg_pool, DNS_RESOLVER_BUF_CTR,
 		    DNS_RESOLVER_MAX_BUF_SIZE, 0, NULL);
 
-NET_BUF_POOL_DEFINE(dns_qname_pool, DNS_RESOLVER_BUF_CTR, DNS_MAX_NAME_LEN,
-		    0, NULL);
+NET_BUF_POOL_DEFINE(dns_qname_pool,
+		    DNS_RESOLVER_BUF_CTR * DNS_RESOLVER_PARALLEL,
+		    DNS_MAX_NAME_LEN, 0, NULL);
+
+/* Query sent to the server, waiting for its response */
+struct dns_query {
+	sys_snode_t node;
+	struct dns_context *ctx;
+	/* QNAME of the query, the CNAME of the previous answer if any */
+	struct net_buf *qname;
+	/* Response, set by 'cb_recv' */
+	struct net_buf *rx;
+	struct k_sem rx_sem;
+	/* Uptime at which the response is not waited for anymore */
+	uint32_t deadline;
+	/* Lowest TTL of the RRs leading to the addresses */
+	uint32_t ttl;
+	uint16_t dns_id;
+	/* Number of queries sent, see DNS_RESOLVER_QUERIES */
+	uint8_t queries;
+	/* -EINPROGRESS while waiting, then the result */
+	int rc;
+};
+
+/* Queries waiting for their response, matched by transaction identifier.
+ * The list is changed with dns_lock held, and interrupts locked since
+ * 'cb_recv' walks it from the RX thread.
+ */
+static sys_slist_t dns_pending;
+
+/* Serializes the threads using the resolver: pending list and cache */
+K_MUTEX_DEFINE(dns_lock);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/* Answer cache entry, an entry without addresses caches a name without
+ * records of the query type: negative caching, RFC 2308.
+ */
+struct dns_cache_entry {
+	char name[CONFIG_DNS_RESOLVER_CACHE_NAME_LEN + 1];
+	uint8_t address[CONFIG_DNS_RESOLVER_CACHE_ADDRESSES][DNS_IPV6_LEN];
+	/* Uptime at which the entry expires */
+	uint32_t expiry;
+	uint16_t query_type;
+	uint8_t items;
+};
+
+static struct dns_cache_entry dns_cache[CONFIG_DNS_RESOLVER_CACHE_SIZE];
+
+static inline bool dns_cache_expired(struct dns_cache_entry *entry,
+				     uint32_t now)
+{
+	return entry->name[0] == '\0' || (int32_t)(entry->expiry - now) <= 0;
+}
+
+static inline int dns_address_size(struct dns_context *ctx)
+{
+	return ctx->query_type == DNS_QUERY_TYPE_A ? DNS_IPV4_LEN :
+						      DNS_IPV6_LEN;
+}
+
+static struct dns_cache_entry *dns_cache_find(struct dns_context *ctx,
+					      uint32_t now)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_SIZE; i++) {
+		struct dns_cache_entry *entry = &dns_cache[i];
+
+		if (!dns_cache_expired(entry, now) &&
+		    entry->query_type == ctx->query_type &&
+		    !strcmp(entry->name, ctx->name)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Returns 0 if the addresses of ctx were found in the cache, -EINVAL when
+ * the name is known to have no such addresses and -ENOENT otherwise.
+ * Must be called with dns_lock held.
+ */
+static int dns_cache_lookup(struct dns_context *ctx)
+{
+	int address_size = dns_address_size(ctx);
+	struct dns_cache_entry *entry;
+
+	entry = dns_cache_find(ctx, k_uptime_get_32());
+	if (!entry) {
+		return -ENOENT;
+	}
+
+	if (entry->items == 0) {
+		return -EINVAL;
+	}
+
+	for (ctx->items = 0; ctx->items < min(entry->items, ctx->elements);
+	     ctx->items++) {
+		memcpy((uint8_t *)ctx->address.ipv4 + ctx->items * address_size,
+		       entry->address[ctx->items], address_size);
+	}
+
+	return 0;
+}
+
+/*
+ * Stores the addresses of ctx, or a negative answer if ctx has none.
+ * The entry to reuse is the one expiring first. Must be called with
+ * dns_lock held.
+ */
+static void dns_cache_store(struct dns_context *ctx, uint32_t ttl)
+{
+	int address_size = dns_address_size(ctx);
+	struct dns_cache_entry *entry;
+	uint32_t now = k_uptime_get_32();
+	int i;
+
+	if (ttl == 0 ||
+	    strlen(ctx->name) > CONFIG_DNS_RESOLVER_CACHE_NAME_LEN) {
+		return;
+	}
+
+	ttl = min(ttl, CONFIG_DNS_RESOLVER_CACHE_MAX_TTL);
+
+	entry = dns_cache_find(ctx, now);
+	if (!entry) {
+		entry = &dns_cache[0];
+
+		for (i = 1; i < CONFIG_DNS_RESOLVER_CACHE_SIZE &&
+			    !dns_cache_expired(entry, now); i++) {
+			struct dns_cache_entry *other = &dns_cache[i];
+
+			if (dns_cache_expired(other, now) ||
+			    (int32_t)(other->expiry - entry->expiry) < 0) {
+				entry = other;
+			}
+		}
+	}
+
+	strcpy(entry->name, ctx->name);
+	entry->query_type = ctx->query_type;
+	entry->expiry = now + ttl * MSEC_PER_SEC;
+	entry->items = min(ctx->items, CONFIG_DNS_RESOLVER_CACHE_ADDRESSES);
+
+	for (i = 0; i < entry->items; i++) {
+		memcpy(entry->address[i],
+		       (uint8_t *)ctx->address.ipv4 + i * address_size,
+		       address_size);
+	}
+}
+
+void dns_cache_flush(void)
+{
+	int i;
+
+	k_mutex_lock(&dns_lock, K_FOREVER);
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_SIZE; i++) {
+		dns_cache[i].name[0] = '\0';
+	}
+
+	k_mutex_unlock(&dns_lock);
+}
+#else
+#define dns_cache_lookup(ctx) (-ENOENT)
+#define dns_cache_store(ctx, ttl)
+
+void dns_cache_flush(void)
+{
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
 
 int dns_init(struct dns_context *ctx)
 {
-	k_sem_init(&ctx->rx_sem, 0, UINT_MAX);
+	ARG_UNUSED(ctx);
 
 	return 0;
 }
@@ -63,14 +238,72 @@ int dns_write(struct dns_context *ctx, struct net_buf *dns_data,
 	      uint16_t dns_id, struct net_buf *dns_qname);
 
 static
-int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
-	     struct net_buf *cname);
+int dns_read(struct dns_query *query, struct net_buf *dns_data);
 
 /* net_context_recv callback */
 static
 void cb_recv(struct net_context *net_ctx, struct net_buf *buf, int status,
 	     void *data);
 
+static bool dns_pending_net_ctx(struct net_context *net_ctx)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(&dns_pending, node) {
+		struct dns_query *query = CONTAINER_OF(node, struct dns_query,
+						       node);
+
+		if (query->ctx->net_ctx == net_ctx) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* The receive callback is installed while queries are pending on the
+ * network context
+ */
+static void dns_pending_add(struct dns_query *query)
+{
+	struct net_context *net_ctx = query->ctx->net_ctx;
+	unsigned int key;
+	bool first;
+
+	k_mutex_lock(&dns_lock, K_FOREVER);
+
+	first = !dns_pending_net_ctx(net_ctx);
+
+	key = irq_lock();
+	sys_slist_append(&dns_pending, &query->node);
+	irq_unlock(key);
+
+	if (first) {
+		net_context_recv(net_ctx, cb_recv, K_NO_WAIT, NULL);
+	}
+
+	k_mutex_unlock(&dns_lock);
+}
+
+static void dns_pending_remove(struct dns_query *query)
+{
+	struct net_context *net_ctx = query->ctx->net_ctx;
+	unsigned int key;
+
+	k_mutex_lock(&dns_lock, K_FOREVER);
+
+	key = irq_lock();
+	sys_slist_find_and_remove(&dns_pending, &query->node);
+	irq_unlock(key);
+
+	if (!dns_pending_net_ctx(net_ctx)) {
+		/* uninstall the callback */
+		net_context_recv(net_ctx, NULL, 0, NULL);
+	}
+
+	k_mutex_unlock(&dns_lock);
+}
+
 /*
  * Note about the DNS transaction identifier:
  * The transaction identifier is randomized according to:
@@ -78,72 +311,193 @@ void cb_recv(struct net_context *net_ctx, struct net_buf *buf, int status,
  * Here we assume that even after the cast, dns_id = sys_rand32_get(), there is
  * enough entropy :)
  */
-int dns_resolve(struct dns_context *ctx)
+static int dns_query_send(struct dns_query *query, struct net_buf *dns_data)
 {
-	struct net_buf *dns_data = NULL;
-	struct net_buf *dns_qname = NULL;
-	uint16_t dns_id;
+	struct dns_context *ctx = query->ctx;
 	int rc;
-	int i;
-
-	k_sem_reset(&ctx->rx_sem);
 
-	dns_id = sys_rand32_get();
+	query->dns_id = sys_rand32_get();
+	query->rx = NULL;
+	query->deadline = k_uptime_get_32() + ctx->timeout;
+	k_sem_reset(&query->rx_sem);
 
-	net_context_recv(ctx->net_ctx, cb_recv, K_NO_WAIT, ctx);
+	/* The query is matched before it is sent, so the response can not
+	 * get in first
+	 */
+	dns_pending_add(query);
 
-	dns_data = net_buf_alloc(&dns_msg_pool, ctx->timeout);
-	if (dns_data == NULL) {
-		rc = -ENOMEM;
-		goto exit_resolve;
+	rc = dns_write(ctx, dns_data, query->dns_id, query->qname);
+	if (rc != 0) {
+		dns_pending_remove(query);
+		return rc;
 	}
 
-	dns_qname = net_buf_alloc(&dns_qname_pool, ctx->timeout);
-	if (dns_qname == NULL) {
-		rc = -ENOMEM;
-		goto exit_resolve;
+	query->queries++;
+
+	return 0;
+}
+
+static int dns_query_start(struct dns_query *query, struct dns_context *ctx,
+			   struct net_buf *dns_data)
+{
+	int rc;
+
+	query->ctx = ctx;
+	query->queries = 0;
+	query->ttl = UINT32_MAX;
+	k_sem_init(&query->rx_sem, 0, 1);
+
+	query->qname = net_buf_alloc(&dns_qname_pool, ctx->timeout);
+	if (query->qname == NULL) {
+		return -ENOMEM;
 	}
 
-	rc = dns_msg_pack_qname(&dns_qname->len, dns_qname->data,
+	rc = dns_msg_pack_qname(&query->qname->len, query->qname->data,
 				DNS_MAX_NAME_LEN, ctx->name);
 	if (rc != 0) {
+		return -EINVAL;
+	}
+
+	return dns_query_send(query, dns_data);
+}
+
+/*
+ * Waits for the response to the query, until its own deadline. When the
+ * answer only contains a CNAME, the next query is sent and query->rc is
+ * left to -EINPROGRESS.
+ */
+static void dns_query_wait(struct dns_query *query, struct net_buf *dns_data)
+{
+	struct dns_context *ctx = query->ctx;
+	int32_t timeout = ctx->timeout;
+	int rc;
+
+	if (timeout != K_FOREVER) {
+		timeout = max((int32_t)(query->deadline - k_uptime_get_32()),
+			      K_NO_WAIT);
+	}
+
+	k_sem_take(&query->rx_sem, timeout);
+
+	/* Once removed, 'cb_recv' can not set the response anymore */
+	dns_pending_remove(query);
+
+	/* If data is received, rx is set inside 'cb_recv'. Otherwise,
+	 * k_sem_take will expire while rx is still NULL
+	 */
+	if (!query->rx) {
+		rc = -EIO;
+		goto exit_wait;
+	}
+
+	rc = dns_read(query, dns_data);
+	if (rc == DNS_NEGATIVE_ANSWER) {
+		k_mutex_lock(&dns_lock, K_FOREVER);
+		dns_cache_store(ctx, CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL);
+		k_mutex_unlock(&dns_lock);
+
 		rc = -EINVAL;
-		goto exit_resolve;
+		goto exit_wait;
 	}
 
-	i = 0;
-	do {
-		rc = dns_write(ctx, dns_data, dns_id, dns_qname);
-		if (rc != 0) {
-			goto exit_resolve;
+	if (rc != 0) {
+		goto exit_wait;
+	}
+
+	/* Server response includes at least one IP address */
+	if (ctx->items > 0) {
+		k_mutex_lock(&dns_lock, K_FOREVER);
+		dns_cache_store(ctx, query->ttl);
+		k_mutex_unlock(&dns_lock);
+
+		goto exit_wait;
+	}
+
+	/* The CNAME is in qname: query it. Number of additional queries is
+	 * controlled via Kconfig.
+	 */
+	if (query->queries < DNS_RESOLVER_QUERIES) {
+		rc = dns_query_send(query, dns_data);
+		if (rc == 0) {
+			return;
 		}
+	} else {
+		rc = -EINVAL;
+	}
 
-		rc = dns_read(ctx, dns_data, dns_id, dns_qname);
-		if (rc != 0) {
-			goto exit_resolve;
+exit_wait:
+	query->rc = rc;
+}
+
+int dns_resolve_parallel(struct dns_context *ctx[], uint8_t count)
+{
+	struct dns_query queries[DNS_RESOLVER_PARALLEL];
+	struct net_buf *dns_data = NULL;
+	int resolved = 0;
+	int rc;
+	int i;
+
+	if (count == 0 || count > DNS_RESOLVER_PARALLEL) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < count; i++) {
+		queries[i].qname = NULL;
+		ctx[i]->items = 0;
+
+		if (ctx[i]->elements <= 0) {
+			queries[i].rc = -EINVAL;
+			continue;
 		}
 
-		/* Server response includes at least one IP address */
-		if (ctx->items > 0) {
-			break;
+		k_mutex_lock(&dns_lock, K_FOREVER);
+		queries[i].rc = dns_cache_lookup(ctx[i]);
+		k_mutex_unlock(&dns_lock);
+
+		if (queries[i].rc != -ENOENT) {
+			continue;
 		}
-	} while (++i < DNS_RESOLVER_QUERIES);
 
-	if (ctx->items > 0) {
-		rc = 0;
-	} else {
-		rc = -EINVAL;
+		/* dns_data is used in turn to pack each query and to read
+		 * each response
+		 */
+		if (dns_data == NULL) {
+			dns_data = net_buf_alloc(&dns_msg_pool,
+						 ctx[i]->timeout);
+			if (dns_data == NULL) {
+				queries[i].rc = -ENOMEM;
+				continue;
+			}
+		}
+
+		rc = dns_query_start(&queries[i], ctx[i], dns_data);
+		queries[i].rc = rc ? rc : -EINPROGRESS;
+	}
+
+	/* All the queries are outstanding, the responses are received in
+	 * any order while each query is waited for in turn
+	 */
+	for (i = 0; i < count; i++) {
+		while (queries[i].rc == -EINPROGRESS) {
+			dns_query_wait(&queries[i], dns_data);
+		}
+
+		/* qname may be NULL, however net_nbuf_unref supports that */
+		net_nbuf_unref(queries[i].qname);
+
+		if (queries[i].rc == 0) {
+			resolved++;
+		}
 	}
 
-exit_resolve:
-	/* dns_data may be NULL, however net_nbuf_unref supports that */
 	net_nbuf_unref(dns_data);
-	net_nbuf_unref(dns_qname);
 
-	/* uninstall the callback */
-	net_context_recv(ctx->net_ctx, NULL, 0, NULL);
+	return resolved ? 0 : queries[0].rc;
+}
 
-	return rc;
+int dns_resolve(struct dns_context *ctx)
+{
+	return dns_resolve_parallel(&ctx, 1);
 }
 
 static
@@ -198,26 +552,82 @@ static
 void cb_recv(struct net_context *net_ctx, struct net_buf *buf, int status,
 	     void *data)
 {
-	struct dns_context *ctx = (struct dns_context *)data;
+	struct net_nbuf_view view;
+	unsigned int key;
+	sys_snode_t *node;
+	uint16_t dns_id;
 
-	ARG_UNUSED(net_ctx);
+	ARG_UNUSED(data);
 
 	if (status != 0) {
 		return;
 	}
 
-	ctx->rx_buf = buf;
-	k_sem_give(&ctx->rx_sem);
+	if (net_nbuf_view_appdata(&view, buf) != 0 ||
+	    net_nbuf_view_peek(&view, 0, &dns_id, sizeof(dns_id)) != 0) {
+		goto exit_recv;
+	}
+
+	dns_id = ntohs(dns_id);
+
+	key = irq_lock();
+
+	SYS_SLIST_FOR_EACH_NODE(&dns_pending, node) {
+		struct dns_query *query = CONTAINER_OF(node, struct dns_query,
+						       node);
+
+		if (query->ctx->net_ctx == net_ctx &&
+		    query->dns_id == dns_id && !query->rx) {
+			query->rx = buf;
+			buf = NULL;
+			k_sem_give(&query->rx_sem);
+			break;
+		}
+	}
+
+	irq_unlock(key);
+
+exit_recv:
+	/* Not a response to a pending query: a late or a spoofed one */
+	net_nbuf_unref(buf);
+}
+
+/* NXDOMAIN, or a response without answers: the name has no records of
+ * the query type
+ */
+static bool dns_negative_answer(struct dns_msg_t *dns_msg)
+{
+	uint8_t *header = dns_msg->msg;
+
+	if (dns_msg->msg_size < DNS_MSG_HEADER_SIZE ||
+	    dns_header_qr(header) != DNS_RESPONSE) {
+		return false;
+	}
+
+	switch (dns_header_rcode(header)) {
+	case DNS_HEADER_NAMEERROR:
+		return true;
+	case DNS_HEADER_NOERROR:
+		return dns_header_ancount(header) == 0;
+	default:
+		return false;
+	}
 }
 
+/*
+ * Parses the response to the query. When the answer only contains CNAMEs,
+ * the last one is copied to query->qname and no address is returned.
+ * Returns DNS_NEGATIVE_ANSWER if the name has no records of the query type.
+ */
 static
-int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
-	     struct net_buf *cname)
+int dns_read(struct dns_query *query, struct net_buf *dns_data)
 {
+	struct dns_context *ctx = query->ctx;
+	struct net_buf *cname = query->qname;
 	/* helper struct to track the dns msg received from the server */
 	struct dns_msg_t dns_msg;
 	uint8_t *addresses;
-	/* RR ttl, so far it is not passed to caller */
+	/* RR ttl, the lowest one is kept for the cache */
 	uint32_t ttl;
 	uint8_t *src;
 	uint8_t *dst;
@@ -234,40 +644,25 @@ int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
 	 */
 	addresses = (uint8_t *)ctx->address.ipv4;
 
-	if (ctx->elements <= 0) {
-		rc = -EINVAL;
-		goto exit_error;
-	}
-
-	ctx->rx_buf = NULL;
-
-	/* Block until timeout or data is received, see the 'cb_recv' routine */
-	k_sem_take(&ctx->rx_sem, ctx->timeout);
-
-	/* If data is received, rx_buf is set inside 'cb_recv'. Otherwise,
-	 * k_sem_take will expire while ctx->rx_buf is still NULL
-	 */
-	if (!ctx->rx_buf) {
-		rc = -EIO;
-		goto exit_error;
-	}
-
-	data_len = min(net_nbuf_appdatalen(ctx->rx_buf),
+	data_len = min(net_nbuf_appdatalen(query->rx),
 		       DNS_RESOLVER_MAX_BUF_SIZE);
-	offset = net_buf_frags_len(ctx->rx_buf) - data_len;
+	offset = net_buf_frags_len(query->rx) - data_len;
 
-	rc = net_nbuf_linear_copy(dns_data, ctx->rx_buf, offset, data_len);
+	rc = net_nbuf_linear_copy(dns_data, query->rx, offset, data_len);
 	if (rc != 0) {
 		rc = -ENOMEM;
 		goto exit_error;
 	}
 
-	k_sem_give(&ctx->rx_sem);
-
 	dns_msg.msg = dns_data->data;
 	dns_msg.msg_size = data_len;
 
-	rc = dns_unpack_response_header(&dns_msg, dns_id);
+	if (dns_negative_answer(&dns_msg)) {
+		rc = DNS_NEGATIVE_ANSWER;
+		goto exit_error;
+	}
+
+	rc = dns_unpack_response_header(&dns_msg, query->dns_id);
 	if (rc != 0) {
 		rc = -EINVAL;
 		goto exit_error;
@@ -301,6 +696,8 @@ int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
 			goto exit_error;
 		}
 
+		query->ttl = min(query->ttl, ttl);
+
 		switch (dns_msg.response_type) {
 		case DNS_RESPONSE_IP:
 			if (dns_msg.response_length < address_size) {
@@ -362,7 +759,8 @@ exit_ok:
 	rc = 0;
 
 exit_error:
-	net_nbuf_unref(ctx->rx_buf);
+	net_nbuf_unref(query->rx);
+	query->rx = NULL;
 
 	return rc;
 }
@@ -0,0 +1,505 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <net/http_server.h>
+#include <net/nbuf.h>
+#include <misc/printk.h>
+#include <string.h>
+#include <errno.h>
+
+#define HTTP_CRLF		"\r\n"
+#define HTTP_LAST_CHUNK		"0\r\n\r\n"
+
+/* Longest chunk size line: 4 hex digits and CRLF */
+#define HTTP_CHUNK_HDR_SIZE	8
+
+static const char *http_status_str(int status)
+{
+	switch (status) {
+	case 200:
+		return "OK";
+	case 204:
+		return "No Content";
+	case 400:
+		return "Bad Request";
+	case 404:
+		return "Not Found";
+	case 405:
+		return "Method Not Allowed";
+	case 500:
+		return "Internal Server Error";
+	default:
+		return "";
+	}
+}
+
+static void conn_close(struct http_server_conn *conn)
+{
+	k_delayed_work_cancel(&conn->idle_timer);
+
+	net_nbuf_unref(conn->tx);
+	conn->tx = NULL;
+
+	net_context_put(conn->net_ctx);
+	conn->net_ctx = NULL;
+	conn->in_use = 0;
+}
+
+static int conn_flush(struct http_server_conn *conn)
+{
+	int rc;
+
+	if (!conn->tx) {
+		return 0;
+	}
+
+	rc = net_context_send(conn->tx, NULL, conn->server->timeout,
+			      NULL, NULL);
+	if (rc < 0) {
+		net_nbuf_unref(conn->tx);
+		rc = -EIO;
+	}
+
+	conn->tx = NULL;
+
+	return rc;
+}
+
+/* Appends data to the response, which is sent once it is big enough */
+static int conn_append(struct http_server_conn *conn, const void *data,
+		       uint16_t len)
+{
+	if (!conn->tx) {
+		conn->tx = net_nbuf_get_tx(conn->net_ctx);
+		if (!conn->tx) {
+			return -ENOMEM;
+		}
+	}
+
+	if (!net_nbuf_append(conn->tx, len, (uint8_t *)data)) {
+		return -ENOMEM;
+	}
+
+	if (net_buf_frags_len(conn->tx->frags) >=
+	    CONFIG_HTTP_SERVER_TX_THRESHOLD) {
+		return conn_flush(conn);
+	}
+
+	return 0;
+}
+
+/* Connection header of the response, none for the HTTP/1.1 default */
+static const char *conn_connection_hdr(struct http_server_conn *conn)
+{
+	if (conn->closing || !http_should_keep_alive(&conn->parser)) {
+		conn->closing = 1;
+		return "Connection: close" HTTP_CRLF;
+	}
+
+	if (conn->parser.http_major == 1 && conn->parser.http_minor == 0) {
+		return "Connection: keep-alive" HTTP_CRLF;
+	}
+
+	return "";
+}
+
+int http_server_response(struct http_server_conn *conn, int status,
+			 const char *content_type, ssize_t len)
+{
+	char headers[CONFIG_HTTP_SERVER_HEADERS_SIZE];
+	int pos;
+
+	if (conn->responded) {
+		return -EALREADY;
+	}
+
+	conn->responded = 1;
+
+	/* HTTP/1.0 has no chunked encoding: the end of the body is the end
+	 * of the connection
+	 */
+	if (len < 0 && conn->parser.http_major == 1 &&
+	    conn->parser.http_minor == 0) {
+		conn->closing = 1;
+	} else if (len < 0) {
+		conn->chunked = 1;
+	}
+
+	pos = snprintk(headers, sizeof(headers), "HTTP/1.1 %d %s" HTTP_CRLF,
+		       status, http_status_str(status));
+
+	if (content_type && pos < sizeof(headers)) {
+		pos += snprintk(headers + pos, sizeof(headers) - pos,
+				"Content-Type: %s" HTTP_CRLF, content_type);
+	}
+
+	if (len >= 0 && pos < sizeof(headers)) {
+		pos += snprintk(headers + pos, sizeof(headers) - pos,
+				"Content-Length: %u" HTTP_CRLF,
+				(unsigned int)len);
+	} else if (conn->chunked && pos < sizeof(headers)) {
+		pos += snprintk(headers + pos, sizeof(headers) - pos,
+				"Transfer-Encoding: chunked" HTTP_CRLF);
+	}
+
+	if (pos < sizeof(headers)) {
+		pos += snprintk(headers + pos, sizeof(headers) - pos,
+				"%s" HTTP_CRLF, conn_connection_hdr(conn));
+	}
+
+	if (pos >= sizeof(headers)) {
+		return -ENOMEM;
+	}
+
+	return conn_append(conn, headers, pos);
+}
+
+int http_server_write(struct http_server_conn *conn, const void *data,
+		      uint16_t len)
+{
+	char chunk_hdr[HTTP_CHUNK_HDR_SIZE];
+	int rc;
+
+	if (!conn->chunked) {
+		return conn_append(conn, data, len);
+	}
+
+	/* An empty chunk would end the body */
+	if (len == 0) {
+		return 0;
+	}
+
+	rc = conn_append(conn, chunk_hdr,
+			 snprintk(chunk_hdr, sizeof(chunk_hdr),
+				  "%x" HTTP_CRLF, len));
+	if (rc < 0) {
+		return rc;
+	}
+
+	rc = conn_append(conn, data, len);
+	if (rc < 0) {
+		return rc;
+	}
+
+	return conn_append(conn, HTTP_CRLF, sizeof(HTTP_CRLF) - 1);
+}
+
+static bool route_match(struct http_server_route *route, const char *url)
+{
+	size_t len = strlen(route->path);
+
+	if (len && route->path[len - 1] == '*') {
+		return !strncmp(route->path, url, len - 1);
+	}
+
+	return !strcmp(route->path, url);
+}
+
+/* Sends the precomputed response of a static route */
+static int route_static(struct http_server_conn *conn,
+			struct http_server_route *route)
+{
+	const char *connection;
+	int rc;
+
+	conn->responded = 1;
+
+	rc = conn_append(conn, route->headers, route->headers_len);
+	if (rc < 0) {
+		return rc;
+	}
+
+	connection = conn_connection_hdr(conn);
+
+	rc = conn_append(conn, connection, strlen(connection));
+	if (rc < 0) {
+		return rc;
+	}
+
+	rc = conn_append(conn, HTTP_CRLF, sizeof(HTTP_CRLF) - 1);
+	if (rc < 0) {
+		return rc;
+	}
+
+	if (http_server_method(conn) == HTTP_HEAD) {
+		return 0;
+	}
+
+	return conn_append(conn, route->body, route->body_len);
+}
+
+static int on_message_begin(struct http_parser *parser)
+{
+	struct http_server_conn *conn = parser->data;
+
+	conn->url_len = 0;
+	conn->route = NULL;
+	conn->responded = 0;
+	conn->chunked = 0;
+
+	return 0;
+}
+
+static int on_url(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_server_conn *conn = parser->data;
+
+	/* The URL may be split over several segments */
+	if (conn->url_len + length >= sizeof(conn->url)) {
+		return 1;
+	}
+
+	memcpy(conn->url + conn->url_len, at, length);
+	conn->url_len += length;
+
+	return 0;
+}
+
+static int on_headers_complete(struct http_parser *parser)
+{
+	struct http_server_conn *conn = parser->data;
+	struct http_server *server = conn->server;
+	char *query;
+	int i;
+
+	conn->url[conn->url_len] = '\0';
+
+	/* Routes do not depend on the query string */
+	query = strchr(conn->url, '?');
+	if (query) {
+		*query = '\0';
+	}
+
+	for (i = 0; i < server->routes_count; i++) {
+		struct http_server_route *route = &server->routes[i];
+
+		if (!route_match(route, conn->url)) {
+			continue;
+		}
+
+		/* Keep the first route of the path, for the 405 status */
+		if (!conn->route) {
+			conn->route = route;
+		}
+
+		if (route->method == parser->method ||
+		    (route->body && parser->method == HTTP_HEAD &&
+		     route->method == HTTP_GET)) {
+			conn->route = route;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static int on_body(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_server_conn *conn = parser->data;
+	struct http_server_route *route = conn->route;
+
+	if (!route || !route->body_cb || route->method != parser->method) {
+		return 0;
+	}
+
+	return route->body_cb(conn, (const uint8_t *)at, length) ? 1 : 0;
+}
+
+static int on_message_complete(struct http_parser *parser)
+{
+	struct http_server_conn *conn = parser->data;
+	struct http_server_route *route = conn->route;
+	int rc;
+
+	if (!route) {
+		rc = http_server_response(conn, 404, NULL, 0);
+	} else if (route->method != parser->method &&
+		   !(route->body && parser->method == HTTP_HEAD)) {
+		rc = http_server_response(conn, 405, NULL, 0);
+	} else if (route->body) {
+		rc = route_static(conn, route);
+	} else {
+		rc = route->handler(conn);
+		if (rc == 0 && !conn->responded) {
+			rc = http_server_response(conn, 500, NULL, 0);
+		}
+	}
+
+	if (rc == 0 && conn->chunked) {
+		rc = conn_append(conn, HTTP_LAST_CHUNK,
+				 sizeof(HTTP_LAST_CHUNK) - 1);
+	}
+
+	if (rc < 0) {
+		conn->closing = 1;
+	}
+
+	/* Stop there: the requests pipelined after this one are dropped */
+	return conn->closing ? 1 : 0;
+}
+
+static const struct http_parser_settings http_server_settings = {
+	.on_message_begin = on_message_begin,
+	.on_url = on_url,
+	.on_headers_complete = on_headers_complete,
+	.on_body = on_body,
+	.on_message_complete = on_message_complete,
+};
+
+static void http_server_recv(struct net_context *net_ctx,
+			     struct net_buf *buf, int status,
+			     void *user_data)
+{
+	struct http_server_conn *conn = user_data;
+	struct net_nbuf_view view;
+	uint16_t len;
+	size_t parsed;
+	char *span;
+
+	ARG_UNUSED(net_ctx);
+
+	/* The peer closed the connection */
+	if (!buf || status != 0) {
+		net_nbuf_unref(buf);
+		conn_close(conn);
+		return;
+	}
+
+	k_delayed_work_submit(&conn->idle_timer,
+			      CONFIG_HTTP_SERVER_IDLE_TIMEOUT);
+
+	/* Requests are parsed in place. Each one is handled as soon as it
+	 * is received, so the responses to pipelined requests are
+	 * written in order, before being sent at once.
+	 */
+	if (net_nbuf_view_appdata(&view, buf) == 0) {
+		while ((span = (char *)net_nbuf_view_span(&view, &len))) {
+			parsed = http_parser_execute(&conn->parser,
+						     &http_server_settings,
+						     span, len);
+			if (conn->closing) {
+				break;
+			}
+
+			if (HTTP_PARSER_ERRNO(&conn->parser) != HPE_OK ||
+			    parsed != len) {
+				conn->responded = 0;
+				conn->closing = 1;
+				(void)http_server_response(conn, 400, NULL, 0);
+				break;
+			}
+
+			net_nbuf_view_advance(&view, len);
+		}
+	}
+
+	net_nbuf_unref(buf);
+
+	if (conn_flush(conn) < 0 || conn->closing) {
+		conn_close(conn);
+	}
+}
+
+static void http_server_idle(struct k_work *work)
+{
+	struct http_server_conn *conn = CONTAINER_OF(work,
+						     struct http_server_conn,
+						     idle_timer.work);
+
+	if (conn->in_use) {
+		conn_close(conn);
+	}
+}
+
+static void http_server_accept(struct net_context *net_ctx,
+			       struct sockaddr *addr, socklen_t addrlen,
+			       int status, void *user_data)
+{
+	struct http_server *server = user_data;
+	struct http_server_conn *conn = NULL;
+	int i;
+
+	ARG_UNUSED(addr);
+	ARG_UNUSED(addrlen);
+
+	if (status != 0) {
+		net_context_put(net_ctx);
+		return;
+	}
+
+	for (i = 0; i < CONFIG_HTTP_SERVER_CONNECTIONS; i++) {
+		if (!server->conns[i].in_use) {
+			conn = &server->conns[i];
+			break;
+		}
+	}
+
+	if (!conn) {
+		net_context_put(net_ctx);
+		return;
+	}
+
+	memset(conn, 0, sizeof(*conn));
+	conn->server = server;
+	conn->net_ctx = net_ctx;
+	conn->in_use = 1;
+
+	http_parser_init(&conn->parser, HTTP_REQUEST);
+	conn->parser.data = conn;
+
+	k_delayed_work_init(&conn->idle_timer, http_server_idle);
+	k_delayed_work_submit(&conn->idle_timer,
+			      CONFIG_HTTP_SERVER_IDLE_TIMEOUT);
+
+	(void)net_context_recv(net_ctx, http_server_recv, K_NO_WAIT, conn);
+}
+
+int http_server_init(struct http_server *server,
+		     struct http_server_route *routes, uint16_t count)
+{
+	int len;
+	int i;
+
+	memset(server, 0, sizeof(*server));
+	server->routes = routes;
+	server->routes_count = count;
+	server->timeout = K_FOREVER;
+
+	for (i = 0; i < count; i++) {
+		struct http_server_route *route = &routes[i];
+
+		if (!route->body) {
+			continue;
+		}
+
+		len = snprintk(route->headers, sizeof(route->headers),
+			       "HTTP/1.1 200 OK" HTTP_CRLF
+			       "Content-Type: %s" HTTP_CRLF
+			       "Content-Length: %u" HTTP_CRLF,
+			       route->content_type,
+			       (unsigned int)route->body_len);
+		if (len < 0 || len >= sizeof(route->headers)) {
+			return -EINVAL;
+		}
+
+		route->headers_len = len;
+	}
+
+	return 0;
+}
+
+int http_server_start(struct http_server *server,
+		      struct net_context *net_ctx)
+{
+	int rc;
+
+	rc = net_context_listen(net_ctx, 0);
+	if (rc < 0) {
+		return rc;
+	}
+
+	return net_context_accept(net_ctx, http_server_accept, 0, server);
+}
@@ -13,15 +13,147 @@
 #include <errno.h>
 
 #define MSG_SIZE	CONFIG_MQTT_MSG_MAX_SIZE
-#define MQTT_BUF_CTR	(1 + CONFIG_MQTT_ADDITIONAL_BUFFER_CTR)
+#define MQTT_BUF_CTR	(1 + CONFIG_MQTT_ADDITIONAL_BUFFER_CTR + \
+			 CONFIG_MQTT_TX_QUEUE_SIZE)
+
+/* State of a stored PUBLISH message */
+enum mqtt_out_state {
+	/* In the outbound queue */
+	MQTT_OUT_QUEUED,
+	/* Sent, waiting for the PUBACK (QoS 1) or PUBREC (QoS 2) msg */
+	MQTT_OUT_PUBLISHED,
+	/* PUBREL sent, waiting for the PUBCOMP msg (QoS 2) */
+	MQTT_OUT_RELEASED,
+};
+
+/* Stored PUBLISH message, kept in the user data of its buffer */
+struct mqtt_out_msg {
+	sys_snode_t node;
+	struct net_buf *buf;
+	uint16_t pkt_id;
+	uint8_t qos;
+	uint8_t state;
+};
 
 /* Memory pool internally used to handle messages that may exceed the size of
  * system defined network buffer. By using this memory pool, routines don't deal
  * with fragmentation, so algorithms are more easy to implement.
+ *
+ * The PUBLISH messages stored by the MQTT contexts use this pool as well.
+ */
+NET_BUF_POOL_DEFINE(mqtt_msg_pool, MQTT_BUF_CTR, MSG_SIZE,
+		    sizeof(struct mqtt_out_msg), NULL);
+
+#define MQTT_OUT_MSG(_node) CONTAINER_OF(_node, struct mqtt_out_msg, node)
+
+/**
+ * @brief mqtt_tx_data		Sends a copy of the len bytes pointed to by data
+ * @param [in] ctx		MQTT context
+ * @param [in] data		Message to send
+ * @param [in] len		Message length
+ * @return			0 on success
+ * @return			-ENOMEM if a tx buffer is not available
+ * @return			-EIO on network error
  */
-NET_BUF_POOL_DEFINE(mqtt_msg_pool, MQTT_BUF_CTR, MSG_SIZE, 0, NULL);
+static
+int mqtt_tx_data(struct mqtt_ctx *ctx, uint8_t *data, uint16_t len)
+{
+	struct net_buf *tx;
+	int rc;
+
+	tx = net_nbuf_get_tx(ctx->net_ctx);
+	if (tx == NULL) {
+		return -ENOMEM;
+	}
+
+	if (!net_nbuf_append(tx, len, data)) {
+		net_nbuf_unref(tx);
+		return -ENOMEM;
+	}
+
+	rc = net_context_send(tx, NULL, ctx->net_timeout, NULL, NULL);
+	if (rc < 0) {
+		net_nbuf_unref(tx);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static void mqtt_inflight_clear(struct mqtt_ctx *ctx)
+{
+	sys_snode_t *node;
 
-#define MQTT_PUBLISHER_MIN_MSG_SIZE	2
+	while ((node = sys_slist_get(&ctx->inflight))) {
+		net_buf_unref(MQTT_OUT_MSG(node)->buf);
+	}
+
+	ctx->inflight_cnt = 0;
+}
+
+/**
+ * @brief mqtt_inflight_find	Looks for the message in flight with the
+ *				given packet identifier and QoS
+ * @param [in] ctx		MQTT context
+ * @param [in] pkt_id		MQTT packet identifier
+ * @param [in] qos		MQTT QoS
+ * @param [out] prev		Node preceding the message in the list
+ * @return			The message, or NULL if no message matches
+ */
+static
+struct mqtt_out_msg *mqtt_inflight_find(struct mqtt_ctx *ctx, uint16_t pkt_id,
+					enum mqtt_qos qos, sys_snode_t **prev)
+{
+	sys_snode_t *node;
+
+	*prev = NULL;
+
+	SYS_SLIST_FOR_EACH_NODE(&ctx->inflight, node) {
+		struct mqtt_out_msg *out = MQTT_OUT_MSG(node);
+
+		if (out->pkt_id == pkt_id && out->qos == qos) {
+			return out;
+		}
+
+		*prev = node;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief mqtt_inflight_resend	Sends again the messages in flight, after
+ *				the session was resumed
+ * @details			PUBLISH messages are sent with the DUP flag set,
+ *				the PUBREL msg is sent for the released ones.
+ * @param [in] ctx		MQTT context
+ * @return			0 on success
+ * @return			-ENOMEM if a tx buffer is not available
+ * @return			-EIO on network error
+ */
+static
+int mqtt_inflight_resend(struct mqtt_ctx *ctx)
+{
+	sys_snode_t *node;
+	int rc = 0;
+
+	SYS_SLIST_FOR_EACH_NODE(&ctx->inflight, node) {
+		struct mqtt_out_msg *out = MQTT_OUT_MSG(node);
+
+		if (out->state == MQTT_OUT_RELEASED) {
+			rc = mqtt_tx_pubrel(ctx, out->pkt_id);
+		} else {
+			out->buf->data[0] |= MQTT_PUBLISH_DUP;
+			rc = mqtt_tx_data(ctx, out->buf->data, out->buf->len);
+		}
+
+		if (rc != 0) {
+			break;
+		}
+	}
+
+	return rc;
+}
 
 int mqtt_tx_connect(struct mqtt_ctx *ctx, struct mqtt_connect_msg *msg)
 {
@@ -37,6 +169,13 @@ int mqtt_tx_connect(struct mqtt_ctx *ctx, struct mqtt_connect_msg *msg)
 
 	ctx->clean_session = msg->clean_session ? 1 : 0;
 
+	/* A new session: the messages in flight are not acknowledged anymore,
+	 * only the ones never sent remain.
+	 */
+	if (ctx->clean_session) {
+		mqtt_inflight_clear(ctx);
+	}
+
 	rc = mqtt_pack_connect(data->data, &data->len, MSG_SIZE, msg);
 	if (rc != 0) {
 		rc = -EINVAL;
@@ -200,49 +339,154 @@ int mqtt_tx_pubrel(struct mqtt_ctx *ctx, uint16_t id)
 	return mqtt_tx_pub_msgs(ctx, id, MQTT_PUBREL);
 }
 
-int mqtt_tx_publish(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg)
+int mqtt_tx_publish_queue(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg)
 {
-	struct net_buf *data = NULL;
-	struct net_buf *tx = NULL;
+	struct mqtt_out_msg *out;
+	struct net_buf *data;
 	int rc;
 
+	if (ctx->tx_queue_cnt + ctx->inflight_cnt >=
+	    CONFIG_MQTT_TX_QUEUE_SIZE) {
+		return -ENOMEM;
+	}
+
 	data = net_buf_alloc(&mqtt_msg_pool, ctx->net_timeout);
 	if (data == NULL) {
-		rc = -ENOMEM;
-		goto exit_publish;
+		return -ENOMEM;
 	}
 
 	rc = mqtt_pack_publish(data->data, &data->len, data->size, msg);
 	if (rc != 0) {
-		net_nbuf_unref(data);
-		rc = -EINVAL;
-		goto exit_publish;
+		net_buf_unref(data);
+		return -EINVAL;
 	}
 
-	tx = net_nbuf_get_tx(ctx->net_ctx);
-	if (tx == NULL) {
-		rc = -ENOMEM;
-		goto exit_publish;
+	out = net_buf_user_data(data);
+	out->buf = data;
+	out->pkt_id = msg->pkt_id;
+	out->qos = msg->qos;
+	out->state = MQTT_OUT_QUEUED;
+
+	sys_slist_append(&ctx->tx_queue, &out->node);
+	ctx->tx_queue_cnt++;
+
+	return 0;
+}
+
+/**
+ * @brief mqtt_tx_batch		Sends the messages at the head of the outbound
+ *				queue into one network buffer
+ * @details			The messages are only dequeued once the buffer
+ *				is sent, so they are kept on error.
+ * @param [in] ctx		MQTT context
+ * @return			Number of messages sent
+ * @return			-ENOMEM if a tx buffer is not available
+ * @return			-EIO on network error
+ */
+static
+int mqtt_tx_batch(struct mqtt_ctx *ctx)
+{
+	uint8_t inflight = ctx->inflight_cnt;
+	struct net_buf *tx = NULL;
+	sys_snode_t *node;
+	uint16_t len = 0;
+	int count = 0;
+	int rc;
+
+	SYS_SLIST_FOR_EACH_NODE(&ctx->tx_queue, node) {
+		struct mqtt_out_msg *out = MQTT_OUT_MSG(node);
+
+		if (out->qos != MQTT_QoS0 &&
+		    inflight >= CONFIG_MQTT_INFLIGHT_MAX) {
+			break;
+		}
+
+		if (count && len + out->buf->len > CONFIG_MQTT_TX_BATCH_SIZE) {
+			break;
+		}
+
+		if (tx == NULL) {
+			tx = net_nbuf_get_tx(ctx->net_ctx);
+			if (tx == NULL) {
+				return -ENOMEM;
+			}
+		}
+
+		if (!net_nbuf_append(tx, out->buf->len, out->buf->data)) {
+			rc = -ENOMEM;
+			goto exit_batch;
+		}
+
+		if (out->qos != MQTT_QoS0) {
+			inflight++;
+		}
+
+		len += out->buf->len;
+		count++;
 	}
 
-	net_buf_frag_add(tx, data);
-	data = NULL;
+	if (count == 0) {
+		return 0;
+	}
 
 	rc = net_context_send(tx, NULL, ctx->net_timeout, NULL, NULL);
 	if (rc < 0) {
 		rc = -EIO;
-		goto exit_publish;
+		goto exit_batch;
 	}
 
 	tx = NULL;
+	rc = count;
 
-exit_publish:
-	net_nbuf_unref(data);
+	while (count--) {
+		struct mqtt_out_msg *out;
+
+		out = MQTT_OUT_MSG(sys_slist_get_not_empty(&ctx->tx_queue));
+		ctx->tx_queue_cnt--;
+
+		if (out->qos == MQTT_QoS0) {
+			net_buf_unref(out->buf);
+			continue;
+		}
+
+		out->state = MQTT_OUT_PUBLISHED;
+		sys_slist_append(&ctx->inflight, &out->node);
+		ctx->inflight_cnt++;
+	}
+
+exit_batch:
 	net_nbuf_unref(tx);
 
 	return rc;
 }
 
+int mqtt_tx_flush(struct mqtt_ctx *ctx)
+{
+	int rc;
+
+	if (!ctx->connected) {
+		return 0;
+	}
+
+	do {
+		rc = mqtt_tx_batch(ctx);
+	} while (rc > 0);
+
+	return rc;
+}
+
+int mqtt_tx_publish(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg)
+{
+	int rc;
+
+	rc = mqtt_tx_publish_queue(ctx, msg);
+	if (rc != 0) {
+		return rc;
+	}
+
+	return mqtt_tx_flush(ctx);
+}
+
 int mqtt_tx_pingreq(struct mqtt_ctx *ctx)
 {
 	struct net_buf *tx = NULL;
@@ -367,17 +611,14 @@ exit_unsub:
 	return rc;
 }
 
-int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx, int clean_session)
+static
+int rx_connack(struct mqtt_ctx *ctx, uint8_t *data, uint16_t len,
+	       int clean_session)
 {
-	uint16_t len;
 	uint8_t connect_rc;
 	uint8_t session;
-	uint8_t *data;
 	int rc;
 
-	data = rx->data;
-	len = rx->len;
-
 	/* CONNACK is 4 bytes len */
 	rc = mqtt_unpack_connack(data, len, &session, &connect_rc);
 	if (rc != 0) {
@@ -400,8 +641,16 @@ int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx, int clean_session)
 		break;
 	/* previous session */
 	case 0:
-		/* TODO */
-		/* FALLTHROUGH */
+		/* when the server has no previous session, the messages
+		 * in flight are received as new ones
+		 */
+		if (connect_rc == 0) {
+			rc = 0;
+		} else {
+			rc = -EINVAL;
+			goto exit_connect;
+		}
+		break;
 	default:
 		rc = -EINVAL;
 		goto exit_connect;
@@ -413,31 +662,44 @@ int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx, int clean_session)
 		ctx->connect(ctx->connect_data);
 	}
 
+	rc = mqtt_inflight_resend(ctx);
+	if (rc != 0) {
+		goto exit_connect;
+	}
+
+	rc = mqtt_tx_flush(ctx);
+
 exit_connect:
 	return rc;
 }
 
+int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx, int clean_session)
+{
+	return rx_connack(ctx, rx->data, rx->len, clean_session);
+}
+
 /**
- * @brief mqtt_rx_pub_msgs	Parses and validates the MQTT PUBxxxx message
- *				contained in the rx buffer. It validates against
+ * @brief rx_pub_msgs		Parses and validates the MQTT PUBxxxx message
+ *				contained in data. It validates against
  *				message structure and Packet Identifier.
  * @details			For the MQTT PUBREC and PUBREL messages, this
  *				function writes the corresponding MQTT PUB msg.
  * @param ctx			MQTT context
- * @param rx			RX buffer
+ * @param data			Message
+ * @param len			Message length
  * @param type			MQTT Packet type
  * @return			0 on success
  * @return			-EINVAL on error
  */
 static
-int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_buf *rx,
-		     enum mqtt_packet type)
+int rx_pub_msgs(struct mqtt_ctx *ctx, uint8_t *data, uint16_t len,
+		enum mqtt_packet type)
 {
 	int (*unpack)(uint8_t *, uint16_t, uint16_t *) = NULL;
 	int (*response)(struct mqtt_ctx *, uint16_t) = NULL;
+	struct mqtt_out_msg *out = NULL;
+	sys_snode_t *prev;
 	uint16_t pkt_id;
-	uint16_t len;
-	uint8_t *data;
 	int rc;
 
 	switch (type) {
@@ -459,15 +721,36 @@ int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_buf *rx,
 		return -EINVAL;
 	}
 
-	data = rx->data;
-	len = rx->len;
-
 	/* 4 bytes message */
 	rc = unpack(data, len, &pkt_id);
 	if (rc != 0) {
 		return -EINVAL;
 	}
 
+	/* Acknowledgements must match a message in flight. A PUBREC msg may
+	 * be received again for a released message: PUBREL is sent again.
+	 */
+	switch (type) {
+	case MQTT_PUBACK:
+		out = mqtt_inflight_find(ctx, pkt_id, MQTT_QoS1, &prev);
+		break;
+	case MQTT_PUBREC:
+		out = mqtt_inflight_find(ctx, pkt_id, MQTT_QoS2, &prev);
+		break;
+	case MQTT_PUBCOMP:
+		out = mqtt_inflight_find(ctx, pkt_id, MQTT_QoS2, &prev);
+		if (out && out->state != MQTT_OUT_RELEASED) {
+			out = NULL;
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (type != MQTT_PUBREL && !out) {
+		return -EINVAL;
+	}
+
 	/* Only MQTT_APP_SUBSCRIBER, MQTT_APP_PUBLISHER_SUBSCRIBER and
 	 * MQTT_APP_SERVER apps must receive the MQTT_PUBREL msg.
 	 */
@@ -486,13 +769,22 @@ int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_buf *rx,
 		return -EINVAL;
 	}
 
-	if (!response)  {
-		return 0;
+	if (response) {
+		rc = response(ctx, pkt_id);
+		if (rc != 0) {
+			return -EINVAL;
+		}
 	}
 
-	rc = response(ctx, pkt_id);
-	if (rc != 0) {
-		return -EINVAL;
+	if (type == MQTT_PUBREC) {
+		out->state = MQTT_OUT_RELEASED;
+	} else if (out) {
+		/* The handshake is over: the window moves forward */
+		sys_slist_remove(&ctx->inflight, prev, &out->node);
+		ctx->inflight_cnt--;
+		net_buf_unref(out->buf);
+
+		return mqtt_tx_flush(ctx);
 	}
 
 	return 0;
@@ -500,32 +792,33 @@ int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_buf *rx,
 
 int mqtt_rx_puback(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	return mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBACK);
+	return rx_pub_msgs(ctx, rx->data, rx->len, MQTT_PUBACK);
 }
 
 int mqtt_rx_pubcomp(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	return mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBCOMP);
+	return rx_pub_msgs(ctx, rx->data, rx->len, MQTT_PUBCOMP);
 }
 
 int mqtt_rx_pubrec(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	return mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBREC);
+	return rx_pub_msgs(ctx, rx->data, rx->len, MQTT_PUBREC);
 }
 
 int mqtt_rx_pubrel(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	return mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBREL);
+	return rx_pub_msgs(ctx, rx->data, rx->len, MQTT_PUBREL);
 }
 
-int mqtt_rx_pingresp(struct mqtt_ctx *ctx, struct net_buf *rx)
+static
+int rx_pingresp(struct mqtt_ctx *ctx, uint8_t *data, uint16_t len)
 {
 	int rc;
 
 	ARG_UNUSED(ctx);
 
 	/* 2 bytes message */
-	rc = mqtt_unpack_pingresp(rx->data, rx->len);
+	rc = mqtt_unpack_pingresp(data, len);
 
 	if (rc != 0) {
 		return -EINVAL;
@@ -534,18 +827,19 @@ int mqtt_rx_pingresp(struct mqtt_ctx *ctx, struct net_buf *rx)
 	return 0;
 }
 
-int mqtt_rx_suback(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_rx_pingresp(struct mqtt_ctx *ctx, struct net_buf *rx)
+{
+	return rx_pingresp(ctx, rx->data, rx->len);
+}
+
+static
+int rx_suback(struct mqtt_ctx *ctx, uint8_t *data, uint16_t len)
 {
 	enum mqtt_qos suback_qos[CONFIG_MQTT_SUBSCRIBE_MAX_TOPICS];
 	uint16_t pkt_id;
-	uint16_t len;
 	uint8_t items;
-	uint8_t *data;
 	int rc;
 
-	data = rx->data;
-	len = rx->len;
-
 	rc = mqtt_unpack_suback(data, len, &pkt_id, &items,
 				CONFIG_MQTT_SUBSCRIBE_MAX_TOPICS, suback_qos);
 	if (rc != 0) {
@@ -564,16 +858,17 @@ int mqtt_rx_suback(struct mqtt_ctx *ctx, struct net_buf *rx)
 	return 0;
 }
 
-int mqtt_rx_unsuback(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_rx_suback(struct mqtt_ctx *ctx, struct net_buf *rx)
+{
+	return rx_suback(ctx, rx->data, rx->len);
+}
+
+static
+int rx_unsuback(struct mqtt_ctx *ctx, uint8_t *data, uint16_t len)
 {
 	uint16_t pkt_id;
-	uint16_t len;
-	uint8_t *data;
 	int rc;
 
-	data = rx->data;
-	len = rx->len;
-
 	/* 4 bytes message */
 	rc = mqtt_unpack_unsuback(data, len, &pkt_id);
 	if (rc != 0) {
@@ -592,28 +887,42 @@ int mqtt_rx_unsuback(struct mqtt_ctx *ctx, struct net_buf *rx)
 	return 0;
 }
 
-int mqtt_rx_publish(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_rx_unsuback(struct mqtt_ctx *ctx, struct net_buf *rx)
+{
+	return rx_unsuback(ctx, rx->data, rx->len);
+}
+
+/**
+ * @brief rx_publish		Delivers a chunk of a PUBLISH payload to the
+ *				application
+ * @details			The message is acknowledged once its last chunk
+ *				is delivered.
+ * @param ctx			MQTT context
+ * @param msg			PUBLISH message
+ * @return			0 on success
+ * @return			-EINVAL on error
+ */
+static
+int rx_publish(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg)
 {
-	struct mqtt_publish_msg msg;
 	int rc;
 
-	rc = mqtt_unpack_publish(rx->data, rx->len, &msg);
+	rc = ctx->publish_rx(ctx->publish_rx_data, msg, msg->pkt_id,
+			     MQTT_PUBLISH);
 	if (rc != 0) {
 		return -EINVAL;
 	}
 
-	rc = ctx->publish_rx(ctx->publish_rx_data, &msg, msg.pkt_id,
-			     MQTT_PUBLISH);
-	if (rc != 0) {
-		return -EINVAL;
+	if (msg->msg_offset + msg->msg_len < msg->msg_total_len) {
+		return 0;
 	}
 
-	switch (msg.qos) {
+	switch (msg->qos) {
 	case MQTT_QoS2:
-		rc = mqtt_tx_pubrec(ctx, msg.pkt_id);
+		rc = mqtt_tx_pubrec(ctx, msg->pkt_id);
 		break;
 	case MQTT_QoS1:
-		rc = mqtt_tx_puback(ctx, msg.pkt_id);
+		rc = mqtt_tx_puback(ctx, msg->pkt_id);
 		break;
 	case MQTT_QoS0:
 		break;
@@ -624,58 +933,25 @@ int mqtt_rx_publish(struct mqtt_ctx *ctx, struct net_buf *rx)
 	return rc;
 }
 
-/**
- * @brief mqtt_linearize_buffer		Linearize an IP fragmented buffer
- * @param [in] ctx			MQTT context structure
- * @param [in] rx			RX IP stack buffer
- * @param [in] min_size			Min message size allowed. This allows us
- *					to exit if the rx buffer is shorter
- *					than the expected msg size
- * @return				Data buffer
- * @return				NULL on error
- */
-static
-struct net_buf *mqtt_linearize_buffer(struct mqtt_ctx *ctx, struct net_buf *rx,
-				      uint16_t min_size)
+int mqtt_rx_publish(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	struct net_buf *data = NULL;
-	uint16_t data_len;
-	uint16_t offset;
+	struct mqtt_publish_msg msg;
 	int rc;
 
-	data = net_buf_alloc(&mqtt_msg_pool, ctx->net_timeout);
-	if (data == NULL) {
-		return NULL;
-	}
-
-	/* CONFIG_MQTT_MSG_MAX_SIZE is defined via Kconfig. So here it's
-	 * determined if the input buffer could fit our data buffer or if
-	 * it has the expected size.
-	 */
-	data_len = net_nbuf_appdatalen(rx);
-	if (data_len < min_size || data_len > CONFIG_MQTT_MSG_MAX_SIZE) {
-		goto exit_error;
-	}
-
-	offset = net_buf_frags_len(rx) - data_len;
-	rc = net_nbuf_linear_copy(data, rx, offset, data_len);
+	rc = mqtt_unpack_publish(rx->data, rx->len, &msg);
 	if (rc != 0) {
-		goto exit_error;
+		return -EINVAL;
 	}
 
-	return data;
-
-exit_error:
-	net_nbuf_unref(data);
-
-	return NULL;
+	return rx_publish(ctx, &msg);
 }
 
 /**
  * @brief mqtt_publisher_parser	Calls the appropriate rx routine for the MQTT
- *				message contained in rx
+ *				message contained in data
  * @param ctx			MQTT context
- * @param rx			RX buffer
+ * @param data			Message
+ * @param len			Message length
  * @return			0 on success
  * @return			-EINVAL if an unknown message is received
  * @return			-ENOMEM if no data buffer is available
@@ -684,145 +960,183 @@ exit_error:
  *				return codes
  */
 static
-int mqtt_publisher_parser(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_publisher_parser(struct mqtt_ctx *ctx, uint8_t *data, uint16_t len)
 {
 	uint16_t pkt_type = MQTT_INVALID;
-	struct net_buf *data = NULL;
 	int rc = -EINVAL;
 
-	data = mqtt_linearize_buffer(ctx, rx, MQTT_PUBLISHER_MIN_MSG_SIZE);
-	if (!data) {
-		rc = -ENOMEM;
-		goto exit_parser;
-	}
-
-	pkt_type = MQTT_PACKET_TYPE(data->data[0]);
+	pkt_type = MQTT_PACKET_TYPE(data[0]);
 
 	switch (pkt_type) {
 	case MQTT_CONNACK:
 		if (!ctx->connected) {
-			rc = mqtt_rx_connack(ctx, data, ctx->clean_session);
+			rc = rx_connack(ctx, data, len, ctx->clean_session);
 		} else {
 			rc = -EINVAL;
 		}
 		break;
 	case MQTT_PUBACK:
-		rc = mqtt_rx_puback(ctx, data);
+		rc = rx_pub_msgs(ctx, data, len, MQTT_PUBACK);
 		break;
 	case MQTT_PUBREC:
-		rc = mqtt_rx_pubrec(ctx, data);
+		rc = rx_pub_msgs(ctx, data, len, MQTT_PUBREC);
 		break;
 	case MQTT_PUBCOMP:
-		rc = mqtt_rx_pubcomp(ctx, data);
+		rc = rx_pub_msgs(ctx, data, len, MQTT_PUBCOMP);
 		break;
 	case MQTT_PINGRESP:
-		rc = mqtt_rx_pingresp(ctx, data);
+		rc = rx_pingresp(ctx, data, len);
 		break;
 	default:
 		rc = -EINVAL;
 		break;
 	}
 
-exit_parser:
 	/* TODO: add error handling via a user provided callback */
 
-	net_nbuf_unref(data);
-
 	return rc;
 }
 
 
 /**
  * @brief mqtt_subscriber_parser Calls the appropriate rx routine for the MQTT
- *				message contained in rx
- * @details			On error, this routine will execute the
- *				'ctx->malformed' callback (if defined)
+ *				message contained in data
+ * @details			PUBLISH messages are not handled here, their
+ *				payload is delivered in chunks by the parser,
+ *				see mqtt_parser_publish.
  * @param ctx			MQTT context
- * @param rx			RX buffer
+ * @param data			Message
+ * @param len			Message length
  * @return			0 on success
  * @return			-EINVAL if an unknown message is received
- * @return			-ENOMEM if no data buffer is available
- * @return			mqtt_rx_publish, mqtt_rx_pubrel, mqtt_rx_pubrel,
- *				mqtt_rx_suback
- *				return codes
+ * @return			mqtt_rx_pubrel, mqtt_rx_pingresp,
+ *				mqtt_rx_suback return codes
  */
 static
-int mqtt_subscriber_parser(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_subscriber_parser(struct mqtt_ctx *ctx, uint8_t *data, uint16_t len)
 {
 	uint16_t pkt_type = MQTT_INVALID;
-	struct net_buf *data = NULL;
 	int rc = 0;
 
-	data = mqtt_linearize_buffer(ctx, rx, MQTT_PUBLISHER_MIN_MSG_SIZE);
-	if (!data) {
-		rc = -EINVAL;
-		goto exit_parser;
-	}
-
-	pkt_type = MQTT_PACKET_TYPE(data->data[0]);
+	pkt_type = MQTT_PACKET_TYPE(data[0]);
 
 	switch (pkt_type) {
 	case MQTT_CONNACK:
 		if (!ctx->connected) {
-			rc = mqtt_rx_connack(ctx, data, ctx->clean_session);
+			rc = rx_connack(ctx, data, len, ctx->clean_session);
 		} else {
 			rc = -EINVAL;
 		}
 
-		break;
-	case MQTT_PUBLISH:
-		rc = mqtt_rx_publish(ctx, data);
 		break;
 	case MQTT_PUBREL:
-		rc = mqtt_rx_pubrel(ctx, data);
+		rc = rx_pub_msgs(ctx, data, len, MQTT_PUBREL);
 		break;
 	case MQTT_PINGRESP:
-		rc = mqtt_rx_pubrel(ctx, data);
+		rc = rx_pingresp(ctx, data, len);
 		break;
 	case MQTT_SUBACK:
-		rc = mqtt_rx_suback(ctx, data);
+		rc = rx_suback(ctx, data, len);
 		break;
 	default:
 		rc = -EINVAL;
 		break;
 	}
 
-exit_parser:
 	/* TODO: add error handling via a user provided callback */
 
-	net_nbuf_unref(data);
-
 	return rc;
 }
 
+static
+int mqtt_parser_message(struct mqtt_parser *parser, uint8_t *buf,
+			uint16_t len)
+{
+	struct mqtt_ctx *ctx = parser->user_data;
+
+	return ctx->rcv(ctx, buf, len);
+}
+
+static
+int mqtt_parser_publish(struct mqtt_parser *parser,
+			struct mqtt_publish_msg *msg)
+{
+	struct mqtt_ctx *ctx = parser->user_data;
+
+	/* Only MQTT_APP_SUBSCRIBER, MQTT_APP_PUBLISHER_SUBSCRIBER and
+	 * MQTT_APP_SERVER apps must receive the MQTT_PUBLISH msg.
+	 */
+	if (ctx->app_type == MQTT_APP_PUBLISHER) {
+		return -EINVAL;
+	}
+
+	return rx_publish(ctx, msg);
+}
+
 static
 void mqtt_recv(struct net_context *net_ctx, struct net_buf *buf, int status,
 	       void *data)
 {
 	struct mqtt_ctx *mqtt = (struct mqtt_ctx *)data;
+	struct net_nbuf_view view;
+	uint8_t *span;
+	uint16_t len;
 
 	/* net_ctx is already referenced to by the mqtt_ctx struct */
 	ARG_UNUSED(net_ctx);
 
-	if (status != 0) {
+	if (status != 0 || !buf) {
 		return;
 	}
 
-	mqtt->rcv(mqtt, buf);
+	/* The stream is parsed in place, fragment after fragment: a message
+	 * may span several fragments and TCP segments.
+	 */
+	if (net_nbuf_view_appdata(&view, buf) == 0) {
+		while ((span = net_nbuf_view_span(&view, &len))) {
+			/* Errors are handled by the rx routines, the parser
+			 * continues with the next message.
+			 */
+			(void)mqtt_parser_input(&mqtt->parser, span, len);
+			net_nbuf_view_advance(&view, len);
+		}
+	}
+
 	net_nbuf_unref(buf);
 }
 
-int mqtt_init(struct mqtt_ctx *ctx, enum mqtt_app app_type)
+int mqtt_attach(struct mqtt_ctx *ctx)
 {
-	/* So far, only clean session = 1 is supported */
-	ctx->clean_session = 1;
 	ctx->connected = 0;
 
+	/* A new stream starts */
+	mqtt_parser_reset(&ctx->parser);
+
 	/* Install the receiver callback, timeout is set to K_NO_WAIT.
 	 * In this case, no return code is evaluated.
 	 */
 	(void)net_context_recv(ctx->net_ctx, mqtt_recv, K_NO_WAIT, ctx);
 
+	return 0;
+}
+
+int mqtt_init(struct mqtt_ctx *ctx, enum mqtt_app app_type)
+{
+	/* The clean session parameter is set by mqtt_tx_connect */
+	ctx->clean_session = 1;
+
+	sys_slist_init(&ctx->tx_queue);
+	sys_slist_init(&ctx->inflight);
+	ctx->tx_queue_cnt = 0;
+	ctx->inflight_cnt = 0;
+
+	mqtt_parser_init(&ctx->parser, ctx->rx_buf, sizeof(ctx->rx_buf));
+	ctx->parser.message = mqtt_parser_message;
+	ctx->parser.publish = mqtt_parser_publish;
+	ctx->parser.user_data = ctx;
+
+	mqtt_attach(ctx);
+
 	ctx->app_type = app_type;
 
 	switch (ctx->app_type) {
@@ -16,6 +16,7 @@
 
 #include "mqtt_pkt.h"
 #include <net/net_ip.h>			/* for htons/ntohs */
+#include <misc/util.h>
 #include <string.h>
 #include <errno.h>
 
@@ -943,6 +944,8 @@ int mqtt_unpack_publish(uint8_t *buf, uint16_t length,
 
 	msg->msg_len = length - offset;
 	msg->msg = buf + offset;
+	msg->msg_offset = 0;
+	msg->msg_total_len = msg->msg_len;
 
 	return 0;
 }
@@ -1189,3 +1192,251 @@ int mqtt_unpack_disconnect(uint8_t *buf, uint16_t length)
 {
 	return unpack_zerolen_validate(buf, length, MQTT_DISCONNECT, 0x00);
 }
+
+/* States of the incremental parser */
+enum {
+	PARSER_TYPE,
+	PARSER_RLEN,
+	PARSER_BODY,
+	PARSER_PUBLISH_HDR,
+	PARSER_PUBLISH_PAYLOAD,
+	PARSER_SKIP
+};
+
+/* Max number of bits of the Remaining Length, see MQTT 2.2.3 */
+#define RLEN_MAX_SHIFT			21
+
+void mqtt_parser_init(struct mqtt_parser *parser, uint8_t *buf, uint16_t size)
+{
+	parser->buf = buf;
+	parser->size = size;
+
+	mqtt_parser_reset(parser);
+}
+
+void mqtt_parser_reset(struct mqtt_parser *parser)
+{
+	parser->len = 0;
+	parser->state = PARSER_TYPE;
+}
+
+/* Bytes of the current message in a piece of len bytes */
+static inline uint16_t parser_avail(struct mqtt_parser *parser, uint16_t len)
+{
+	return min(len, parser->rlen - parser->pos);
+}
+
+/* Bytes still missing to complete the variable header of PUBLISH */
+static uint32_t publish_hdr_need(struct mqtt_parser *parser)
+{
+	uint16_t stored = parser->len - parser->hdr_len;
+	uint32_t size = INT_SIZE;
+	uint16_t val_u16;
+
+	if (stored >= INT_SIZE) {
+		val_u16 = UNALIGNED_GET((uint16_t *)(parser->buf +
+						     parser->hdr_len));
+		size += ntohs(val_u16);
+
+		if ((parser->buf[0] & 0x06) != 0) {
+			size += PACKET_ID_SIZE;
+		}
+	}
+
+	return size - stored;
+}
+
+/* Fills the parser msg once the PUBLISH headers are stored */
+static int publish_hdr_parse(struct mqtt_parser *parser)
+{
+	struct mqtt_publish_msg *msg = &parser->msg;
+	uint8_t *buf = parser->buf;
+	uint16_t offset = parser->hdr_len;
+	uint16_t val_u16;
+
+	msg->dup = (buf[0] & 0x08) >> 3;
+	msg->qos = (buf[0] & 0x06) >> 1;
+	msg->retain = buf[0] & 0x01;
+
+	if (msg->qos > MQTT_QoS2) {
+		return -EINVAL;
+	}
+
+	val_u16 = UNALIGNED_GET((uint16_t *)(buf + offset));
+	msg->topic_len = ntohs(val_u16);
+	offset += INT_SIZE;
+
+	msg->topic = (char *)(buf + offset);
+	offset += msg->topic_len;
+
+	if (msg->qos == MQTT_QoS1 || msg->qos == MQTT_QoS2) {
+		val_u16 = UNALIGNED_GET((uint16_t *)(buf + offset));
+		msg->pkt_id = ntohs(val_u16);
+	} else {
+		msg->pkt_id = 0;
+	}
+
+	msg->msg = NULL;
+	msg->msg_len = 0;
+	msg->msg_offset = 0;
+	msg->msg_total_len = parser->rlen - parser->pos;
+
+	parser->hdr_len = parser->len;
+
+	return 0;
+}
+
+/**
+ * @brief parser_step		Consumes data according to the parser state
+ * @param [in] parser		Parser
+ * @param [in] data		Stream data
+ * @param [in] len		Length of data, at least one byte
+ * @param [out] err		Error returned by the callbacks, or detected in
+ *				the current message
+ * @return			Number of bytes consumed
+ * @return			-EINVAL if the stream is malformed
+ */
+static int parser_step(struct mqtt_parser *parser, uint8_t *data,
+		       uint16_t len, int *err)
+{
+	uint16_t used = 0;
+
+	switch (parser->state) {
+	case PARSER_TYPE:
+		parser->buf[0] = *data;
+		parser->len = 1;
+		parser->rlen = 0;
+		parser->shift = 0;
+		parser->state = PARSER_RLEN;
+		return 1;
+	case PARSER_RLEN:
+		parser->buf[parser->len++] = *data;
+		parser->rlen |= (uint32_t)(*data & 127) << parser->shift;
+
+		if (*data & 128) {
+			parser->shift += 7;
+			if (parser->shift > RLEN_MAX_SHIFT) {
+				return -EINVAL;
+			}
+
+			return 1;
+		}
+
+		parser->hdr_len = parser->len;
+		parser->pos = 0;
+
+		if (MQTT_PACKET_TYPE(parser->buf[0]) == MQTT_PUBLISH) {
+			parser->state = PARSER_PUBLISH_HDR;
+		} else if (parser->hdr_len + parser->rlen > parser->size) {
+			*err = -ENOMEM;
+			parser->state = PARSER_SKIP;
+		} else {
+			parser->state = PARSER_BODY;
+		}
+
+		return 1;
+	case PARSER_BODY:
+		used = parser_avail(parser, len);
+		memcpy(parser->buf + parser->len, data, used);
+		parser->len += used;
+		break;
+	case PARSER_PUBLISH_HDR:
+		used = min(parser_avail(parser, len), publish_hdr_need(parser));
+		if (parser->len + used > parser->size) {
+			*err = -ENOMEM;
+			parser->state = PARSER_SKIP;
+			return 0;
+		}
+
+		memcpy(parser->buf + parser->len, data, used);
+		parser->len += used;
+		parser->pos += used;
+
+		if (publish_hdr_need(parser) != 0) {
+			return used;
+		}
+
+		if (publish_hdr_parse(parser) != 0) {
+			*err = -EINVAL;
+			parser->state = PARSER_SKIP;
+			return used;
+		}
+
+		parser->state = PARSER_PUBLISH_PAYLOAD;
+
+		/* An empty payload is delivered as an empty chunk */
+		if (parser->msg.msg_total_len == 0) {
+			*err = parser->publish(parser, &parser->msg);
+		}
+
+		return used;
+	case PARSER_PUBLISH_PAYLOAD:
+		used = parser_avail(parser, len);
+		parser->msg.msg = data;
+		parser->msg.msg_len = used;
+
+		*err = parser->publish(parser, &parser->msg);
+		if (*err != 0) {
+			parser->state = PARSER_SKIP;
+		}
+
+		parser->msg.msg_offset += used;
+		break;
+	case PARSER_SKIP:
+		used = parser_avail(parser, len);
+		break;
+	}
+
+	parser->pos += used;
+
+	return used;
+}
+
+/* Called once the whole message is consumed */
+static int parser_end(struct mqtt_parser *parser)
+{
+	switch (parser->state) {
+	case PARSER_BODY:
+		return parser->message(parser, parser->buf, parser->len);
+	case PARSER_PUBLISH_HDR:
+		/* the message ends within the PUBLISH headers */
+		return -EINVAL;
+	default:
+		return 0;
+	}
+}
+
+int mqtt_parser_input(struct mqtt_parser *parser, uint8_t *data, uint16_t len)
+{
+	int first_err = 0;
+	int err;
+	int rc;
+
+	while (len > 0) {
+		err = 0;
+
+		rc = parser_step(parser, data, len, &err);
+		if (rc < 0) {
+			mqtt_parser_reset(parser);
+			return rc;
+		}
+
+		data += rc;
+		len -= rc;
+
+		if (parser->state > PARSER_RLEN &&
+		    parser->pos == parser->rlen) {
+			if (err == 0) {
+				err = parser_end(parser);
+			}
+
+			parser->state = PARSER_TYPE;
+		}
+
+		if (err != 0 && first_err == 0) {
+			first_err = err;
+		}
+	}
+
+	return first_err;
+}
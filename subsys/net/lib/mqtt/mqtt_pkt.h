@@ -24,6 +24,9 @@
 
 #define MQTT_PACKET_TYPE(first_byte)	(((first_byte) & 0xF0) >> 4)
 
+/* DUP flag in the fixed header of the PUBLISH message */
+#define MQTT_PUBLISH_DUP		0x08
+
 /**
  * @brief mqtt_pack_connack	Packs the MQTT CONNACK message
  * @details			See MQTT 3.2 CONNACK - Acknowledge connection
@@ -390,4 +393,42 @@ int mqtt_unpack_pingresp(uint8_t *buf, uint16_t length);
  */
 int mqtt_unpack_disconnect(uint8_t *buf, uint16_t length);
 
+/**
+ * @brief mqtt_parser_init	Initializes the incremental parser
+ * @details			The message and publish callbacks of the parser
+ *				must be set by the caller.
+ * @param [in] parser		Parser
+ * @param [in] buf		Buffer keeping the messages, but the PUBLISH
+ *				payloads. A message not fitting in this buffer
+ *				is dropped.
+ * @param [in] size		Buffer size, at least 5 bytes
+ */
+void mqtt_parser_init(struct mqtt_parser *parser, uint8_t *buf, uint16_t size);
+
+/**
+ * @brief mqtt_parser_reset	Drops the partial message kept by the parser,
+ *				the next byte is the start of a message
+ * @param [in] parser		Parser
+ */
+void mqtt_parser_reset(struct mqtt_parser *parser);
+
+/**
+ * @brief mqtt_parser_input	Consumes a piece of a stream of MQTT messages
+ * @details			Messages may start and end anywhere in the
+ *				piece. The parser callbacks are executed as the
+ *				messages, or the PUBLISH payload chunks, are
+ *				received. A message is dropped when a callback
+ *				fails, the parser continues with the next one.
+ * @param [in] parser		Parser
+ * @param [in] data		Stream data
+ * @param [in] len		Length of data
+ * @return			0 on success
+ * @return			-EINVAL if the stream is malformed, the parser
+ *				is reset then
+ * @return			-ENOMEM if a message did not fit in the parser
+ *				buffer
+ * @return			The first error returned by a callback
+ */
+int mqtt_parser_input(struct mqtt_parser *parser, uint8_t *data, uint16_t len);
+
 #endif
@@ -0,0 +1,555 @@
+/** @file
+ * @brief BSD Sockets compatible API
+ *
+ * The sockets are network contexts: their receive callback queues the
+ * buffers received for them, which recv() or accept() then dequeue.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_SOCKETS)
+#define SYS_LOG_DOMAIN "net/sock"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <misc/util.h>
+
+#include <net/nbuf.h>
+#include <net/net_core.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+
+/* The socket descriptor is the network context pointer */
+#define SOCK_CTX(sock) ((struct net_context *)INT_TO_POINTER(sock))
+#define SOCK_FD(ctx) POINTER_TO_INT(ctx)
+
+/* Socket flags */
+#define SOCK_NONBLOCK BIT(0)
+#define SOCK_EOF BIT(1)
+
+#define CONNECT_TIMEOUT CONFIG_NET_SOCKETS_CONNECT_TIMEOUT
+
+#define SET_ERRNO(x)				\
+	do {					\
+		int _err = x;			\
+						\
+		if (_err < 0) {			\
+			errno = -_err;		\
+			return -1;		\
+		}				\
+	} while (0)
+
+static inline bool sock_is_stream(struct net_context *ctx)
+{
+	return net_context_get_type(ctx) == SOCK_STREAM;
+}
+
+static inline int32_t sock_timeout(struct net_context *ctx, int flags)
+{
+	if ((ctx->sock_flags & SOCK_NONBLOCK) || (flags & ZSOCK_MSG_DONTWAIT)) {
+		return K_NO_WAIT;
+	}
+
+	return K_FOREVER;
+}
+
+static void sock_init(struct net_context *ctx)
+{
+	k_fifo_init(&ctx->recv_q);
+	ctx->recv_cur = NULL;
+	ctx->sock_flags = 0;
+}
+
+static void sock_received_cb(struct net_context *ctx, struct net_buf *buf,
+			     int status, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	NET_DBG("ctx %p buf %p status %d", ctx, buf, status);
+
+	/* The end of the stream, or an error, is marked by a buffer
+	 * without any fragment.
+	 */
+	if (!buf) {
+		buf = net_nbuf_get_reserve_rx(0);
+		if (!buf) {
+			return;
+		}
+	}
+
+	net_buf_put(&ctx->recv_q, buf);
+}
+
+static void sock_accepted_cb(struct net_context *new_ctx,
+			     struct sockaddr *addr, socklen_t addrlen,
+			     int status, void *user_data)
+{
+	struct net_context *parent = user_data;
+
+	NET_DBG("parent %p ctx %p status %d", parent, new_ctx, status);
+
+	if (status < 0) {
+		return;
+	}
+
+	sock_init(new_ctx);
+
+	/* Start queueing the data right away, not when accept() is
+	 * called.
+	 */
+	net_context_recv(new_ctx, sock_received_cb, K_NO_WAIT, NULL);
+
+	k_fifo_put(&parent->accept_q, new_ctx);
+}
+
+static void sock_addr(struct net_buf *buf, struct sockaddr *addr,
+		      socklen_t *addrlen)
+{
+	struct sockaddr src = { .family = net_nbuf_family(buf) };
+	socklen_t len = sizeof(src);
+
+#if defined(CONFIG_NET_IPV6)
+	if (net_nbuf_family(buf) == AF_INET6) {
+		net_ipaddr_copy(&net_sin6(&src)->sin6_addr,
+				&NET_IPV6_BUF(buf)->src);
+		net_sin6(&src)->sin6_port = NET_UDP_BUF(buf)->src_port;
+		len = sizeof(struct sockaddr_in6);
+	}
+#endif /* CONFIG_NET_IPV6 */
+
+#if defined(CONFIG_NET_IPV4)
+	if (net_nbuf_family(buf) == AF_INET) {
+		net_ipaddr_copy(&net_sin(&src)->sin_addr,
+				&NET_IPV4_BUF(buf)->src);
+		net_sin(&src)->sin_port = NET_UDP_BUF(buf)->src_port;
+		len = sizeof(struct sockaddr_in);
+	}
+#endif /* CONFIG_NET_IPV4 */
+
+	memcpy(addr, &src, min(*addrlen, len));
+	*addrlen = len;
+}
+
+/* Drop the fragments and bytes before the application data */
+static void strip_headers(struct net_buf *buf)
+{
+	uint8_t *appdata = net_nbuf_appdata(buf);
+	struct net_buf *frag = buf->frags;
+
+	while (frag && (appdata < frag->data ||
+			appdata > frag->data + frag->len)) {
+		frag = net_buf_frag_del(buf, frag);
+	}
+
+	if (frag) {
+		net_buf_pull(frag, appdata - frag->data);
+	}
+}
+
+/* Copy up to len bytes of data out of the buffer, consuming them */
+static size_t copy_out(struct net_buf *buf, uint8_t *data, size_t len)
+{
+	size_t copied = 0;
+
+	while (buf->frags && copied < len) {
+		struct net_buf *frag = buf->frags;
+		size_t frag_len = min(frag->len, len - copied);
+
+		memcpy(data + copied, frag->data, frag_len);
+		net_buf_pull(frag, frag_len);
+		copied += frag_len;
+
+		if (!frag->len) {
+			net_buf_frag_del(buf, frag);
+		}
+	}
+
+	return copied;
+}
+
+static void sock_flush(struct net_context *ctx)
+{
+	struct net_buf *buf;
+
+	if (ctx->recv_cur) {
+		net_nbuf_unref(ctx->recv_cur);
+		ctx->recv_cur = NULL;
+	}
+
+	while ((buf = net_buf_get(&ctx->recv_q, K_NO_WAIT))) {
+		net_nbuf_unref(buf);
+	}
+}
+
+static inline bool sock_is_readable(struct net_context *ctx)
+{
+	return ctx->recv_cur || (ctx->sock_flags & SOCK_EOF) ||
+		!k_fifo_is_empty(&ctx->recv_q);
+}
+
+/* Bind a datagram socket to a free port, for it to get the replies */
+static int sock_autobind(struct net_context *ctx)
+{
+	struct sockaddr local = {
+		.family = net_context_get_family(ctx),
+	};
+
+	if (net_sin_ptr(&ctx->local)->sin_port) {
+		return 0;
+	}
+
+	return net_context_bind(ctx, &local, sizeof(local));
+}
+
+int zsock_socket(int family, int type, int proto)
+{
+	struct net_context *ctx;
+
+	SET_ERRNO(net_context_get(family, type, proto, &ctx));
+
+	sock_init(ctx);
+
+	NET_DBG("new socket %p", ctx);
+
+	return SOCK_FD(ctx);
+}
+
+int zsock_close(int sock)
+{
+	struct net_context *ctx = SOCK_CTX(sock);
+	struct net_context *child;
+
+	NET_DBG("close socket %p", ctx);
+
+	if (net_context_get_state(ctx) == NET_CONTEXT_LISTENING) {
+		net_context_accept(ctx, NULL, K_NO_WAIT, NULL);
+
+		while ((child = k_fifo_get(&ctx->accept_q, K_NO_WAIT))) {
+			zsock_close(SOCK_FD(child));
+		}
+	} else {
+		/* Nothing is to be queued anymore, the context may stay
+		 * in use until the TCP connection is closed.
+		 */
+		net_context_recv(ctx, NULL, K_NO_WAIT, NULL);
+		sock_flush(ctx);
+	}
+
+	SET_ERRNO(net_context_put(ctx));
+
+	return 0;
+}
+
+int zsock_bind(int sock, const struct sockaddr *addr, socklen_t addrlen)
+{
+	struct net_context *ctx = SOCK_CTX(sock);
+
+	SET_ERRNO(net_context_bind(ctx, addr, addrlen));
+
+	/* A TCP socket gets its data once connected */
+	if (!sock_is_stream(ctx)) {
+		SET_ERRNO(net_context_recv(ctx, sock_received_cb, K_NO_WAIT,
+					   NULL));
+	}
+
+	return 0;
+}
+
+int zsock_connect(int sock, const struct sockaddr *addr, socklen_t addrlen)
+{
+	struct net_context *ctx = SOCK_CTX(sock);
+
+	if (sock_is_stream(ctx)) {
+		/* Register before connecting, not to miss any data */
+		SET_ERRNO(net_context_recv(ctx, sock_received_cb, K_NO_WAIT,
+					   NULL));
+		SET_ERRNO(net_context_connect(ctx, addr, addrlen, NULL,
+					      CONNECT_TIMEOUT, NULL));
+	} else {
+		SET_ERRNO(sock_autobind(ctx));
+		SET_ERRNO(net_context_connect(ctx, addr, addrlen, NULL,
+					      K_NO_WAIT, NULL));
+		/* Only the peer's datagrams are to be received */
+		SET_ERRNO(net_context_recv(ctx, sock_received_cb, K_NO_WAIT,
+					   NULL));
+	}
+
+	return 0;
+}
+
+int zsock_listen(int sock, int backlog)
+{
+	struct net_context *ctx = SOCK_CTX(sock);
+
+	SET_ERRNO(net_context_listen(ctx, backlog));
+	SET_ERRNO(net_context_accept(ctx, sock_accepted_cb, K_NO_WAIT, ctx));
+
+	return 0;
+}
+
+int zsock_accept(int sock, struct sockaddr *addr, socklen_t *addrlen)
+{
+	struct net_context *ctx = SOCK_CTX(sock);
+	struct net_context *new_ctx;
+
+	new_ctx = k_fifo_get(&ctx->accept_q, sock_timeout(ctx, 0));
+	if (!new_ctx) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	if (addr && addrlen) {
+		socklen_t len = sizeof(struct sockaddr_in);
+
+		if (new_ctx->remote.family == AF_INET6) {
+			len = sizeof(struct sockaddr_in6);
+		}
+
+		memcpy(addr, &new_ctx->remote, min(*addrlen, len));
+		*addrlen = len;
+	}
+
+	return SOCK_FD(new_ctx);
+}
+
+ssize_t zsock_send(int sock, const void *buf, size_t len, int flags)
+{
+	return zsock_sendto(sock, buf, len, flags, NULL, 0);
+}
+
+ssize_t zsock_sendto(int sock, const void *buf, size_t len, int flags,
+		     const struct sockaddr *dest_addr, socklen_t addrlen)
+{
+	struct net_context *ctx = SOCK_CTX(sock);
+	struct net_buf *send_buf;
+	int ret;
+
+	ARG_UNUSED(flags);
+
+	if (!sock_is_stream(ctx) && !net_sin_ptr(&ctx->local)->sin_port) {
+		SET_ERRNO(sock_autobind(ctx));
+		SET_ERRNO(net_context_recv(ctx, sock_received_cb, K_NO_WAIT,
+					   NULL));
+	}
+
+	send_buf = net_nbuf_get_tx(ctx);
+	if (!send_buf) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	if (!net_nbuf_append(send_buf, len, (uint8_t *)buf)) {
+		net_nbuf_unref(send_buf);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	if (dest_addr) {
+		ret = net_context_sendto(send_buf, dest_addr, addrlen, NULL,
+					 K_NO_WAIT, NULL, NULL);
+	} else {
+		ret = net_context_send(send_buf, NULL, K_NO_WAIT, NULL, NULL);
+	}
+
+	if (ret < 0) {
+		net_nbuf_unref(send_buf);
+		errno = -ret;
+		return -1;
+	}
+
+	return len;
+}
+
+static ssize_t recv_stream(struct net_context *ctx, uint8_t *data,
+			   size_t max_len, int32_t timeout)
+{
+	struct net_buf *buf;
+	size_t len;
+
+	do {
+		buf = ctx->recv_cur;
+		if (!buf) {
+			if (ctx->sock_flags & SOCK_EOF) {
+				return 0;
+			}
+
+			buf = net_buf_get(&ctx->recv_q, timeout);
+			if (!buf) {
+				errno = EAGAIN;
+				return -1;
+			}
+
+			if (!buf->frags) {
+				ctx->sock_flags |= SOCK_EOF;
+				net_nbuf_unref(buf);
+				return 0;
+			}
+
+			strip_headers(buf);
+		}
+
+		len = copy_out(buf, data, max_len);
+
+		if (buf->frags) {
+			ctx->recv_cur = buf;
+		} else {
+			ctx->recv_cur = NULL;
+			net_nbuf_unref(buf);
+		}
+	} while (!len && max_len);
+
+	return len;
+}
+
+static ssize_t recv_dgram(struct net_context *ctx, uint8_t *data,
+			  size_t max_len, int32_t timeout,
+			  struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	struct net_buf *buf;
+	size_t len;
+
+	buf = net_buf_get(&ctx->recv_q, timeout);
+	if (!buf) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	if (!buf->frags) {
+		net_nbuf_unref(buf);
+		errno = EIO;
+		return -1;
+	}
+
+	if (src_addr && addrlen) {
+		sock_addr(buf, src_addr, addrlen);
+	}
+
+	strip_headers(buf);
+	len = copy_out(buf, data, max_len);
+	net_nbuf_unref(buf);
+
+	return len;
+}
+
+ssize_t zsock_recv(int sock, void *buf, size_t max_len, int flags)
+{
+	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
+}
+
+ssize_t zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
+		       struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	struct net_context *ctx = SOCK_CTX(sock);
+
+	if (sock_is_stream(ctx)) {
+		return recv_stream(ctx, buf, max_len,
+				   sock_timeout(ctx, flags));
+	}
+
+	return recv_dgram(ctx, buf, max_len, sock_timeout(ctx, flags),
+			  src_addr, addrlen);
+}
+
+int zsock_fcntl(int sock, int cmd, int flags)
+{
+	struct net_context *ctx = SOCK_CTX(sock);
+
+	switch (cmd) {
+	case ZSOCK_F_GETFL:
+		return (ctx->sock_flags & SOCK_NONBLOCK) ? ZSOCK_O_NONBLOCK : 0;
+
+	case ZSOCK_F_SETFL:
+		if (flags & ZSOCK_O_NONBLOCK) {
+			ctx->sock_flags |= SOCK_NONBLOCK;
+		} else {
+			ctx->sock_flags &= ~SOCK_NONBLOCK;
+		}
+
+		return 0;
+
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
+{
+	struct k_poll_event events[CONFIG_NET_SOCKETS_POLL_MAX];
+	int32_t poll_timeout = timeout < 0 ? K_FOREVER : timeout;
+	int i, num_events = 0, ret = 0;
+
+	/* Sockets with events already need not be waited for */
+	for (i = 0; i < nfds; i++) {
+		struct net_context *ctx = SOCK_CTX(fds[i].fd);
+
+		if (fds[i].fd < 0) {
+			continue;
+		}
+
+		if ((fds[i].events & ZSOCK_POLLOUT) ||
+		    ((fds[i].events & ZSOCK_POLLIN) && sock_is_readable(ctx))) {
+			poll_timeout = K_NO_WAIT;
+			continue;
+		}
+
+		if (!(fds[i].events & ZSOCK_POLLIN)) {
+			continue;
+		}
+
+		if (num_events == ARRAY_SIZE(events)) {
+			errno = ENOMEM;
+			return -1;
+		}
+
+		/* recv_q and accept_q are the same queue */
+		k_poll_event_init(&events[num_events++],
+				  K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+				  K_POLL_MODE_NOTIFY_ONLY, &ctx->recv_q);
+	}
+
+	if (num_events) {
+		ret = k_poll(events, num_events, poll_timeout);
+		if (ret < 0 && ret != -EAGAIN) {
+			errno = -ret;
+			return -1;
+		}
+	} else if (poll_timeout == K_FOREVER) {
+		errno = EINVAL;
+		return -1;
+	} else if (poll_timeout != K_NO_WAIT) {
+		k_sleep(poll_timeout);
+	}
+
+	ret = 0;
+
+	for (i = 0; i < nfds; i++) {
+		struct net_context *ctx = SOCK_CTX(fds[i].fd);
+
+		fds[i].revents = 0;
+
+		if (fds[i].fd < 0) {
+			continue;
+		}
+
+		if (fds[i].events & ZSOCK_POLLOUT) {
+			fds[i].revents |= ZSOCK_POLLOUT;
+		}
+
+		if ((fds[i].events & ZSOCK_POLLIN) && sock_is_readable(ctx)) {
+			fds[i].revents |= ZSOCK_POLLIN;
+		}
+
+		if (fds[i].revents) {
+			ret++;
+		}
+	}
+
+	return ret;
+}
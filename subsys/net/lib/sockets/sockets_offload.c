@@ -0,0 +1,126 @@
+/** @file
+ * @brief BSD Sockets compatible API, offloaded
+ *
+ * The socket calls are passed on to the driver of a module running its
+ * own TCP/IP stack, which copies the data between the module and the
+ * buffers of the application. The native IP stack is not built.
+ */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <misc/__assert.h>
+
+#include <net/socket.h>
+#include <net/socket_offload.h>
+
+static const struct net_socket_offload *offload;
+
+#define SET_ERRNO(x)				\
+	do {					\
+		int _err = x;			\
+						\
+		if (_err < 0) {			\
+			errno = -_err;		\
+			return -1;		\
+		}				\
+		return _err;			\
+	} while (0)
+
+/* Operation of the registered driver, failing the call if missing */
+#define OFFLOAD_OP(op)				\
+	do {					\
+		if (!offload) {			\
+			errno = ENETDOWN;	\
+			return -1;		\
+		}				\
+		if (!offload->op) {		\
+			errno = EOPNOTSUPP;	\
+			return -1;		\
+		}				\
+	} while (0)
+
+void net_socket_offload_register(const struct net_socket_offload *ops)
+{
+	__ASSERT(!offload, "socket offload already registered");
+	__ASSERT(ops && ops->socket && ops->close, "incomplete socket offload");
+
+	offload = ops;
+}
+
+int zsock_socket(int family, int type, int proto)
+{
+	OFFLOAD_OP(socket);
+	SET_ERRNO(offload->socket(family, type, proto));
+}
+
+int zsock_close(int sock)
+{
+	OFFLOAD_OP(close);
+	SET_ERRNO(offload->close(sock));
+}
+
+int zsock_bind(int sock, const struct sockaddr *addr, socklen_t addrlen)
+{
+	OFFLOAD_OP(bind);
+	SET_ERRNO(offload->bind(sock, addr, addrlen));
+}
+
+int zsock_connect(int sock, const struct sockaddr *addr, socklen_t addrlen)
+{
+	OFFLOAD_OP(connect);
+	SET_ERRNO(offload->connect(sock, addr, addrlen));
+}
+
+int zsock_listen(int sock, int backlog)
+{
+	OFFLOAD_OP(listen);
+	SET_ERRNO(offload->listen(sock, backlog));
+}
+
+int zsock_accept(int sock, struct sockaddr *addr, socklen_t *addrlen)
+{
+	OFFLOAD_OP(accept);
+	SET_ERRNO(offload->accept(sock, addr, addrlen));
+}
+
+ssize_t zsock_send(int sock, const void *buf, size_t len, int flags)
+{
+	return zsock_sendto(sock, buf, len, flags, NULL, 0);
+}
+
+ssize_t zsock_sendto(int sock, const void *buf, size_t len, int flags,
+		     const struct sockaddr *dest_addr, socklen_t addrlen)
+{
+	OFFLOAD_OP(sendto);
+	SET_ERRNO(offload->sendto(sock, buf, len, flags, dest_addr, addrlen));
+}
+
+ssize_t zsock_recv(int sock, void *buf, size_t max_len, int flags)
+{
+	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
+}
+
+ssize_t zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
+		       struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	OFFLOAD_OP(recvfrom);
+	SET_ERRNO(offload->recvfrom(sock, buf, max_len, flags, src_addr,
+				    addrlen));
+}
+
+int zsock_fcntl(int sock, int cmd, int flags)
+{
+	OFFLOAD_OP(fcntl);
+	SET_ERRNO(offload->fcntl(sock, cmd, flags));
+}
+
+int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
+{
+	OFFLOAD_OP(poll);
+	SET_ERRNO(offload->poll(fds, nfds, timeout));
+}
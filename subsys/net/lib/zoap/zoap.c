@@ -622,6 +622,39 @@ static int get_observe_option(const struct zoap_packet *pkt)
 	return zoap_option_value_to_int(&option);
 }
 
+/* Returns whether @a response is for @a reply, not being an old
+ * notification.
+ */
+static bool reply_accept(struct zoap_reply *r,
+			 const struct zoap_packet *response,
+			 const uint8_t *token, uint8_t tkl)
+{
+	int age;
+
+	if (r->tkl != tkl) {
+		return false;
+	}
+
+	if (tkl > 0 && memcmp(r->token, token, tkl)) {
+		return false;
+	}
+
+	age = get_observe_option(response);
+	if (age > 0) {
+		/*
+		 * age == 2 means that the notifications wrapped,
+		 * or this is the first one
+		 */
+		if (r->age > age && age != 2) {
+			return false;
+		}
+
+		r->age = age;
+	}
+
+	return true;
+}
+
 struct zoap_reply *zoap_response_received(
 	const struct zoap_packet *response,
 	const struct sockaddr *from,
@@ -635,31 +668,10 @@ struct zoap_reply *zoap_response_received(
 	token = zoap_header_get_token(response, &tkl);
 
 	for (i = 0, r = replies; i < len; i++, r++) {
-		int age;
-
-		if (r->tkl != tkl) {
-			continue;
-		}
-
-		if (tkl > 0 && memcmp(r->token, token, tkl)) {
-			continue;
-		}
-
-		age = get_observe_option(response);
-		if (age > 0) {
-			/*
-			 * age == 2 means that the notifications wrapped,
-			 * or this is the first one
-			 */
-			if (r->age > age && age != 2) {
-				continue;
-			}
-
-			r->age = age;
+		if (reply_accept(r, response, token, tkl)) {
+			r->reply(response, r, from);
+			return r;
 		}
-
-		r->reply(response, r, from);
-		return r;
 	}
 
 	return NULL;
@@ -813,6 +825,408 @@ struct zoap_observer *zoap_find_observer_by_addr(
 	return NULL;
 }
 
+/* RFC 7252, 4.8 */
+#define ACK_TIMEOUT 2000
+#define MAX_RETRANSMIT 4
+
+enum pending_state {
+	PENDING_FREE,
+	PENDING_QUEUED,
+	PENDING_ACTIVE,
+};
+
+static unsigned int hash_bytes(unsigned int hash, const void *data,
+			       size_t len)
+{
+	const uint8_t *p = data;
+
+	while (len--) {
+		hash = (hash ^ *p++) * 16777619U;
+	}
+
+	return hash;
+}
+
+static sys_slist_t *bucket_by_id(sys_slist_t *buckets, uint16_t id)
+{
+	return &buckets[id % CONFIG_ZOAP_TABLE_BUCKETS];
+}
+
+static sys_slist_t *bucket_by_token(sys_slist_t *buckets,
+				    const uint8_t *token, uint8_t tkl)
+{
+	return &buckets[hash_bytes(2166136261U, token, tkl) %
+			CONFIG_ZOAP_TABLE_BUCKETS];
+}
+
+static sys_slist_t *bucket_by_addr(sys_slist_t *buckets,
+				   const struct sockaddr *addr)
+{
+	unsigned int hash = 2166136261U;
+
+	if (addr->family == AF_INET6) {
+		hash = hash_bytes(hash, &net_sin6(addr)->sin6_addr,
+				  sizeof(struct in6_addr));
+		hash = hash_bytes(hash, &net_sin6(addr)->sin6_port,
+				  sizeof(uint16_t));
+	} else if (addr->family == AF_INET) {
+		hash = hash_bytes(hash, &net_sin(addr)->sin_addr,
+				  sizeof(struct in_addr));
+		hash = hash_bytes(hash, &net_sin(addr)->sin_port,
+				  sizeof(uint16_t));
+	}
+
+	return &buckets[hash % CONFIG_ZOAP_TABLE_BUCKETS];
+}
+
+static void pending_timeout(struct k_work *work);
+
+void zoap_pending_table_init(struct zoap_pending_table *table,
+			     struct zoap_pending *pendings, size_t len,
+			     zoap_pending_send_t send,
+			     zoap_pending_expired_t expired)
+{
+	size_t i;
+
+	memset(table, 0, sizeof(*table));
+
+	table->pendings = pendings;
+	table->len = len;
+	table->send = send;
+	table->expired = expired;
+
+	for (i = 0; i < len; i++) {
+		memset(&pendings[i], 0, sizeof(pendings[i]));
+		pendings[i].table = table;
+		k_delayed_work_init(&pendings[i].work, pending_timeout);
+		sys_slist_append(&table->free, &pendings[i].node);
+	}
+}
+
+struct zoap_pending *zoap_pending_alloc(struct zoap_pending_table *table)
+{
+	unsigned int key = irq_lock();
+	sys_snode_t *node = sys_slist_get(&table->free);
+
+	irq_unlock(key);
+
+	if (!node) {
+		return NULL;
+	}
+
+	return CONTAINER_OF(node, struct zoap_pending, node);
+}
+
+/* Must be called with interrupts locked */
+static void pending_activate(struct zoap_pending_table *table,
+			     struct zoap_pending *pending)
+{
+	uint16_t id = zoap_header_get_id(&pending->request);
+
+	pending->state = PENDING_ACTIVE;
+	sys_slist_append(bucket_by_id(table->buckets, id), &pending->node);
+	table->in_flight++;
+}
+
+static void pending_transmit(struct zoap_pending_table *table,
+			     struct zoap_pending *pending)
+{
+	pending->retries = 0;
+	pending->timeout = ACK_TIMEOUT + sys_rand32_get() % (ACK_TIMEOUT / 2);
+
+	/* A failed transmission is handled as a lost one */
+	(void)table->send(pending);
+
+	k_delayed_work_submit(&pending->work, pending->timeout);
+}
+
+/* Releases @a pending, then transmits the next message queued if any */
+static void pending_release(struct zoap_pending_table *table,
+			    struct zoap_pending *pending)
+{
+	struct zoap_pending *next = NULL;
+	sys_snode_t *node;
+	unsigned int key;
+	uint16_t id;
+
+	k_delayed_work_cancel(&pending->work);
+
+	key = irq_lock();
+
+	if (pending->state == PENDING_FREE) {
+		irq_unlock(key);
+		return;
+	}
+
+	if (pending->state == PENDING_ACTIVE) {
+		id = zoap_header_get_id(&pending->request);
+		sys_slist_find_and_remove(bucket_by_id(table->buckets, id),
+					  &pending->node);
+		table->in_flight--;
+	} else {
+		sys_slist_find_and_remove(&table->queue, &pending->node);
+	}
+
+	pending->state = PENDING_FREE;
+
+	if (table->in_flight < CONFIG_ZOAP_NSTART) {
+		node = sys_slist_get(&table->queue);
+		if (node) {
+			next = CONTAINER_OF(node, struct zoap_pending, node);
+			pending_activate(table, next);
+		}
+	}
+
+	irq_unlock(key);
+
+	net_buf_unref(pending->request.buf);
+	pending->request.buf = NULL;
+	pending->timeout = 0;
+
+	key = irq_lock();
+	sys_slist_prepend(&table->free, &pending->node);
+	irq_unlock(key);
+
+	if (next) {
+		pending_transmit(table, next);
+	}
+}
+
+static void pending_timeout(struct k_work *work)
+{
+	struct zoap_pending *pending = CONTAINER_OF(work, struct zoap_pending,
+						    work);
+	struct zoap_pending_table *table = pending->table;
+
+	if (pending->state != PENDING_ACTIVE) {
+		return;
+	}
+
+	if (pending->retries == MAX_RETRANSMIT) {
+		if (table->expired) {
+			table->expired(pending);
+		}
+
+		pending_release(table, pending);
+		return;
+	}
+
+	pending->retries++;
+	pending->timeout *= 2;
+
+	(void)table->send(pending);
+
+	k_delayed_work_submit(&pending->work, pending->timeout);
+}
+
+int zoap_pending_submit(struct zoap_pending_table *table,
+			struct zoap_pending *pending,
+			const struct zoap_packet *request,
+			const struct sockaddr *addr)
+{
+	unsigned int key;
+	bool queued;
+
+	memcpy(&pending->request, request, sizeof(*request));
+	memcpy(&pending->addr, addr, sizeof(pending->addr));
+
+	key = irq_lock();
+
+	queued = table->in_flight >= CONFIG_ZOAP_NSTART;
+	if (queued) {
+		pending->state = PENDING_QUEUED;
+		sys_slist_append(&table->queue, &pending->node);
+	} else {
+		pending_activate(table, pending);
+	}
+
+	irq_unlock(key);
+
+	if (!queued) {
+		pending_transmit(table, pending);
+	}
+
+	return 0;
+}
+
+int zoap_pending_table_received(struct zoap_pending_table *table,
+				const struct zoap_packet *response,
+				const struct sockaddr *from)
+{
+	uint16_t id = zoap_header_get_id(response);
+	uint8_t type = zoap_header_get_type(response);
+	struct zoap_pending *pending = NULL;
+	sys_snode_t *node;
+	unsigned int key;
+
+	/* Acknowledgements and resets match by message id and endpoint */
+	if (type != ZOAP_TYPE_ACK && type != ZOAP_TYPE_RESET) {
+		return -ENOENT;
+	}
+
+	key = irq_lock();
+
+	SYS_SLIST_FOR_EACH_NODE(bucket_by_id(table->buckets, id), node) {
+		struct zoap_pending *p;
+
+		p = CONTAINER_OF(node, struct zoap_pending, node);
+
+		if (zoap_header_get_id(&p->request) == id &&
+		    (!from || sockaddr_equal(&p->addr, from))) {
+			pending = p;
+			break;
+		}
+	}
+
+	irq_unlock(key);
+
+	if (!pending) {
+		return -ENOENT;
+	}
+
+	pending_release(table, pending);
+
+	return 0;
+}
+
+void zoap_pending_cancel(struct zoap_pending_table *table,
+			 struct zoap_pending *pending)
+{
+	pending_release(table, pending);
+}
+
+void zoap_reply_table_init(struct zoap_reply_table *table,
+			   struct zoap_reply *replies, size_t len)
+{
+	size_t i;
+
+	memset(table, 0, sizeof(*table));
+
+	table->replies = replies;
+	table->len = len;
+
+	for (i = 0; i < len; i++) {
+		memset(&replies[i], 0, sizeof(replies[i]));
+		sys_slist_append(&table->free, &replies[i].node);
+	}
+}
+
+struct zoap_reply *zoap_reply_alloc(struct zoap_reply_table *table)
+{
+	sys_snode_t *node = sys_slist_get(&table->free);
+
+	if (!node) {
+		return NULL;
+	}
+
+	return CONTAINER_OF(node, struct zoap_reply, node);
+}
+
+void zoap_reply_table_add(struct zoap_reply_table *table,
+			  struct zoap_reply *reply)
+{
+	sys_slist_append(bucket_by_token(table->buckets, reply->token,
+					 reply->tkl), &reply->node);
+}
+
+struct zoap_reply *zoap_reply_table_received(
+	struct zoap_reply_table *table,
+	const struct zoap_packet *response,
+	const struct sockaddr *from)
+{
+	const uint8_t *token;
+	sys_snode_t *node;
+	uint8_t tkl;
+
+	token = zoap_header_get_token(response, &tkl);
+
+	SYS_SLIST_FOR_EACH_NODE(bucket_by_token(table->buckets, token, tkl),
+				node) {
+		struct zoap_reply *r = CONTAINER_OF(node, struct zoap_reply,
+						    node);
+
+		if (reply_accept(r, response, token, tkl)) {
+			r->reply(response, r, from);
+			return r;
+		}
+	}
+
+	return NULL;
+}
+
+void zoap_reply_table_remove(struct zoap_reply_table *table,
+			     struct zoap_reply *reply)
+{
+	sys_slist_find_and_remove(bucket_by_token(table->buckets, reply->token,
+						  reply->tkl), &reply->node);
+
+	zoap_reply_clear(reply);
+	sys_slist_prepend(&table->free, &reply->node);
+}
+
+void zoap_observer_table_init(struct zoap_observer_table *table,
+			      struct zoap_observer *observers, size_t len)
+{
+	size_t i;
+
+	memset(table, 0, sizeof(*table));
+
+	table->observers = observers;
+	table->len = len;
+
+	for (i = 0; i < len; i++) {
+		memset(&observers[i], 0, sizeof(observers[i]));
+		sys_slist_append(&table->free, &observers[i].index);
+	}
+}
+
+struct zoap_observer *zoap_observer_alloc(struct zoap_observer_table *table)
+{
+	sys_snode_t *node = sys_slist_get(&table->free);
+
+	if (!node) {
+		return NULL;
+	}
+
+	return CONTAINER_OF(node, struct zoap_observer, index);
+}
+
+void zoap_observer_table_add(struct zoap_observer_table *table,
+			     struct zoap_observer *observer)
+{
+	sys_slist_append(bucket_by_addr(table->buckets, &observer->addr),
+			 &observer->index);
+}
+
+struct zoap_observer *zoap_observer_table_find(
+	struct zoap_observer_table *table, const struct sockaddr *addr)
+{
+	sys_snode_t *node;
+
+	SYS_SLIST_FOR_EACH_NODE(bucket_by_addr(table->buckets, addr), node) {
+		struct zoap_observer *o = CONTAINER_OF(node,
+						       struct zoap_observer,
+						       index);
+
+		if (sockaddr_equal(&o->addr, addr)) {
+			return o;
+		}
+	}
+
+	return NULL;
+}
+
+void zoap_observer_table_remove(struct zoap_observer_table *table,
+				struct zoap_observer *observer)
+{
+	sys_slist_find_and_remove(bucket_by_addr(table->buckets,
+						 &observer->addr),
+				  &observer->index);
+
+	memset(&observer->addr, 0, sizeof(observer->addr));
+	sys_slist_prepend(&table->free, &observer->index);
+}
+
 uint8_t *zoap_packet_get_payload(struct zoap_packet *pkt, uint16_t *len)
 {
 	struct net_buf *frag = pkt->buf->frags;
@@ -1342,6 +1756,162 @@ size_t zoap_next_block(struct zoap_block_context *ctx)
 	return ctx->current;
 }
 
+enum zoap_block_size zoap_block_size_from_mtu(uint16_t mtu, uint16_t overhead)
+{
+	enum zoap_block_size block_size = ZOAP_BLOCK_1024;
+	int avail = mtu - NET_IPV6H_LEN - NET_UDPH_LEN - overhead;
+
+	while (block_size > ZOAP_BLOCK_16 &&
+	       zoap_block_size_to_bytes(block_size) > avail) {
+		block_size--;
+	}
+
+	return block_size;
+}
+
+void zoap_block_stream_source_init(struct zoap_block_stream *stream,
+				   enum zoap_block_size block_size,
+				   size_t total_size, zoap_block_read_t read,
+				   void *user_data)
+{
+	memset(stream, 0, sizeof(*stream));
+
+	zoap_block_transfer_init(&stream->ctx, block_size, total_size);
+	stream->read = read;
+	stream->user_data = user_data;
+}
+
+void zoap_block_stream_sink_init(struct zoap_block_stream *stream,
+				 enum zoap_block_size block_size,
+				 zoap_block_write_t write, void *user_data)
+{
+	memset(stream, 0, sizeof(*stream));
+
+	zoap_block_transfer_init(&stream->ctx, block_size, 0);
+	stream->write = write;
+	stream->user_data = user_data;
+}
+
+/*
+ * Room taken by the block options and the payload marker, at most: a
+ * BLOCK option with a 1 byte extended delta and a 3 bytes value, and a
+ * SIZE option with a 2 bytes extended delta and a 4 bytes value.
+ */
+#define BLOCK_OPTIONS_RESERVE (5 + 7 + 1)
+
+int zoap_block_stream_send(struct zoap_packet *pkt,
+			   struct zoap_block_stream *stream)
+{
+	struct zoap_block_context *ctx = &stream->ctx;
+	struct net_buf *frag = pkt->buf->frags;
+	int avail = net_buf_tailroom(frag) - BLOCK_OPTIONS_RESERVE;
+	uint16_t len;
+	uint8_t *payload;
+	bool first = !ctx->current;
+	int r;
+
+	if (ctx->current >= ctx->total_size) {
+		return -EINVAL;
+	}
+
+	/* Smaller blocks begin at the same offset, as sizes are powers of 2 */
+	while (ctx->block_size > ZOAP_BLOCK_16 &&
+	       zoap_block_size_to_bytes(ctx->block_size) > avail) {
+		ctx->block_size--;
+	}
+
+	len = min(zoap_block_size_to_bytes(ctx->block_size),
+		  ctx->total_size - ctx->current);
+	if (len > avail) {
+		return -ENOMEM;
+	}
+
+	if (is_request(pkt)) {
+		r = zoap_add_block1_option(pkt, ctx);
+		if (!r && first) {
+			r = zoap_add_size1_option(pkt, ctx);
+		}
+	} else {
+		r = zoap_add_block2_option(pkt, ctx);
+		if (!r && first) {
+			r = zoap_add_size2_option(pkt, ctx);
+		}
+	}
+
+	if (r < 0) {
+		return r;
+	}
+
+	payload = zoap_packet_get_payload(pkt, NULL);
+	if (!payload) {
+		return -ENOMEM;
+	}
+
+	r = stream->read(stream, ctx->current, payload, len);
+	if (r < 0) {
+		return r;
+	}
+
+	net_buf_add(frag, len);
+
+	return 0;
+}
+
+int zoap_block_stream_recv(struct zoap_packet *pkt,
+			   struct zoap_block_stream *stream)
+{
+	struct zoap_block_context *ctx = &stream->ctx;
+	struct net_buf *frag = pkt->buf->frags;
+	uint16_t len = 0;
+	unsigned int block;
+	bool last;
+	int r;
+
+	if (pkt->start) {
+		len = frag->data + frag->len - pkt->start;
+	}
+
+	r = zoap_update_from_block(pkt, ctx);
+	if (r == -ENOENT) {
+		/* Not block-wise, the body fits in the packet */
+		if (stream->received) {
+			return -EINVAL;
+		}
+
+		ctx->current = 0;
+		last = true;
+	} else if (r < 0) {
+		return r;
+	} else {
+		block = get_block_option(pkt, is_request(pkt) ?
+					 ZOAP_OPTION_BLOCK1 :
+					 ZOAP_OPTION_BLOCK2);
+		last = !GET_MORE(block);
+
+		/* All the blocks but the last one are full */
+		if (!last && len != zoap_block_size_to_bytes(ctx->block_size)) {
+			return -EINVAL;
+		}
+	}
+
+	if (ctx->current < stream->received) {
+		return -EALREADY;
+	}
+
+	if (ctx->current > stream->received) {
+		return -EINVAL;
+	}
+
+	r = stream->write(stream, ctx->current, pkt->start, len, last);
+	if (r < 0) {
+		return r;
+	}
+
+	stream->received += len;
+
+	return last;
+}
+
 uint8_t *zoap_next_token(void)
 {
 	static uint32_t rand[2];
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <kernel.h>
+#include <net/nbuf.h>
+#include <net/zoap.h>
+#include <net/zoap_dtls.h>
+
+static void dtls_received(struct net_context *context, struct net_buf *buf,
+			  int status, void *user_data)
+{
+	struct zoap_dtls *dtls = user_data;
+
+	ARG_UNUSED(context);
+	ARG_UNUSED(status);
+
+	if (!buf) {
+		return;
+	}
+
+	net_buf_put(&dtls->rx_queue, buf);
+}
+
+/* Copies the record mbed TLS wrote into the fragments of a datagram */
+static int dtls_tx(void *ctx, const unsigned char *data, size_t len)
+{
+	struct zoap_dtls *dtls = ctx;
+	struct net_buf *buf;
+	int r;
+
+	buf = net_nbuf_get_tx(dtls->net_ctx);
+	if (!buf) {
+		return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+	}
+
+	if (!net_nbuf_append(buf, len, (uint8_t *)data)) {
+		net_nbuf_unref(buf);
+		return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+	}
+
+	r = net_context_sendto(buf, &dtls->peer, dtls->peer_len, NULL,
+			       K_NO_WAIT, NULL, NULL);
+	if (r < 0) {
+		net_nbuf_unref(buf);
+		return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+	}
+
+	return len;
+}
+
+/*
+ * Copies a datagram from its fragments into the mbed TLS buffer. A
+ * datagram larger than the buffer is truncated, the record then failing
+ * its authentication: DTLS discards it.
+ */
+static int dtls_rx(void *ctx, unsigned char *data, size_t len,
+		   uint32_t timeout)
+{
+	struct zoap_dtls *dtls = ctx;
+	struct net_buf *buf, *frag;
+	uint8_t *ptr;
+	size_t pos = 0;
+	uint16_t remaining, n;
+
+	/* 0 outside of the handshake: the timeout of zoap_dtls_recv() */
+	buf = net_buf_get(&dtls->rx_queue,
+			  timeout ? (int32_t)timeout : dtls->rx_timeout);
+	if (!buf) {
+		return MBEDTLS_ERR_SSL_TIMEOUT;
+	}
+
+	remaining = net_nbuf_appdatalen(buf);
+	ptr = net_nbuf_appdata(buf);
+
+	/* Fragment holding the start of the UDP payload */
+	for (frag = buf->frags; frag; frag = frag->frags) {
+		if (ptr >= frag->data && ptr < frag->data + frag->len) {
+			break;
+		}
+	}
+
+	while (frag && remaining && pos < len) {
+		n = min(frag->len - (ptr - frag->data), remaining);
+		n = min(n, len - pos);
+		memcpy(data + pos, ptr, n);
+		pos += n;
+		remaining -= n;
+
+		frag = frag->frags;
+		if (frag) {
+			ptr = frag->data;
+		}
+	}
+
+	net_nbuf_unref(buf);
+
+	return pos;
+}
+
+static void dtls_timer_set(void *ctx, uint32_t int_ms, uint32_t fin_ms)
+{
+	struct zoap_dtls *dtls = ctx;
+
+	dtls->int_ms = int_ms;
+	dtls->fin_ms = fin_ms;
+
+	if (fin_ms) {
+		dtls->timer_start = k_uptime_get_32();
+	}
+}
+
+static int dtls_timer_get(void *ctx)
+{
+	struct zoap_dtls *dtls = ctx;
+	uint32_t elapsed;
+
+	if (!dtls->fin_ms) {
+		return -1;
+	}
+
+	elapsed = k_uptime_get_32() - dtls->timer_start;
+
+	if (elapsed >= dtls->fin_ms) {
+		return 2;
+	}
+
+	if (elapsed >= dtls->int_ms) {
+		return 1;
+	}
+
+	return 0;
+}
+
+int zoap_dtls_init(struct zoap_dtls *dtls, struct net_context *net_ctx,
+		   const struct sockaddr *peer,
+		   const mbedtls_ssl_config *conf,
+		   struct zoap_dtls_cache *cache)
+{
+	int r;
+
+	if (peer->family == AF_INET6) {
+		dtls->peer_len = sizeof(struct sockaddr_in6);
+	} else {
+		dtls->peer_len = sizeof(struct sockaddr_in);
+	}
+
+	memcpy(&dtls->peer, peer, dtls->peer_len);
+	dtls->net_ctx = net_ctx;
+	dtls->cache = cache;
+	dtls->rx_timeout = K_FOREVER;
+	dtls->fin_ms = 0;
+	k_fifo_init(&dtls->rx_queue);
+
+	mbedtls_ssl_init(&dtls->ssl);
+
+	r = mbedtls_ssl_setup(&dtls->ssl, conf);
+	if (r) {
+		mbedtls_ssl_free(&dtls->ssl);
+		return -ENOMEM;
+	}
+
+	mbedtls_ssl_set_bio(&dtls->ssl, dtls, dtls_tx, NULL, dtls_rx);
+	mbedtls_ssl_set_timer_cb(&dtls->ssl, dtls, dtls_timer_set,
+				 dtls_timer_get);
+
+	r = net_context_recv(net_ctx, dtls_received, K_NO_WAIT, dtls);
+	if (r < 0) {
+		mbedtls_ssl_free(&dtls->ssl);
+		return r;
+	}
+
+	return 0;
+}
+
+int zoap_dtls_handshake(struct zoap_dtls *dtls)
+{
+	struct zoap_dtls_cache *cache = dtls->cache;
+	int r;
+
+	/* A session the peer does not know gives a full handshake */
+	if (cache && cache->valid &&
+	    mbedtls_ssl_set_session(&dtls->ssl, &cache->session)) {
+		zoap_dtls_cache_clear(cache);
+	}
+
+	do {
+		r = mbedtls_ssl_handshake(&dtls->ssl);
+	} while (r == MBEDTLS_ERR_SSL_WANT_READ ||
+		 r == MBEDTLS_ERR_SSL_WANT_WRITE);
+
+	if (r == MBEDTLS_ERR_SSL_TIMEOUT) {
+		return -ETIMEDOUT;
+	}
+
+	if (r) {
+		return -ECONNREFUSED;
+	}
+
+	if (cache) {
+		zoap_dtls_cache_clear(cache);
+		cache->valid = !mbedtls_ssl_get_session(&dtls->ssl,
+							&cache->session);
+	}
+
+	return 0;
+}
+
+int zoap_dtls_send(struct zoap_dtls *dtls, struct zoap_packet *pkt)
+{
+	struct net_buf *frag = pkt->buf->frags;
+	int r;
+
+	/* One record, and so one datagram, for the message */
+	do {
+		r = mbedtls_ssl_write(&dtls->ssl, frag->data, frag->len);
+	} while (r == MBEDTLS_ERR_SSL_WANT_WRITE);
+
+	if (r < 0) {
+		return -EIO;
+	}
+
+	net_nbuf_unref(pkt->buf);
+
+	return 0;
+}
+
+int zoap_dtls_recv(struct zoap_dtls *dtls, struct zoap_packet *pkt,
+		   int32_t timeout)
+{
+	struct net_buf *buf, *frag;
+	int r;
+
+	buf = net_nbuf_get_rx(dtls->net_ctx);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	frag = net_nbuf_get_data(dtls->net_ctx);
+	if (!frag) {
+		net_nbuf_unref(buf);
+		return -ENOMEM;
+	}
+
+	net_buf_frag_add(buf, frag);
+
+	/* Deciphered straight into the fragment zoap parses */
+	dtls->rx_timeout = timeout;
+
+	do {
+		r = mbedtls_ssl_read(&dtls->ssl, frag->data,
+				     net_buf_tailroom(frag));
+	} while (r == MBEDTLS_ERR_SSL_WANT_READ ||
+		 r == MBEDTLS_ERR_SSL_WANT_WRITE);
+
+	dtls->rx_timeout = K_FOREVER;
+
+	if (r <= 0) {
+		net_nbuf_unref(buf);
+
+		if (r == MBEDTLS_ERR_SSL_TIMEOUT) {
+			return -EAGAIN;
+		}
+
+		if (r == 0 || r == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+			return -ENOTCONN;
+		}
+
+		return -EIO;
+	}
+
+	net_buf_add(frag, r);
+
+	r = zoap_packet_parse(pkt, buf);
+	if (r < 0) {
+		net_nbuf_unref(buf);
+		return r;
+	}
+
+	return 0;
+}
+
+void zoap_dtls_release(struct zoap_dtls *dtls, bool notify)
+{
+	struct net_buf *buf;
+
+	if (notify) {
+		mbedtls_ssl_close_notify(&dtls->ssl);
+	}
+
+	net_context_recv(dtls->net_ctx, NULL, K_NO_WAIT, NULL);
+
+	while ((buf = net_buf_get(&dtls->rx_queue, K_NO_WAIT))) {
+		net_nbuf_unref(buf);
+	}
+
+	mbedtls_ssl_free(&dtls->ssl);
+}
+
+void zoap_dtls_cache_clear(struct zoap_dtls_cache *cache)
+{
+	if (cache->valid) {
+		mbedtls_ssl_session_free(&cache->session);
+	}
+
+	mbedtls_ssl_session_init(&cache->session);
+	cache->valid = false;
+}
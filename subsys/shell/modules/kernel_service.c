@@ -5,6 +5,7 @@
  */
 
 #include <misc/printk.h>
+#include <string.h>
 #include <shell/shell.h>
 #include <init.h>
 #include <debug/object_tracing.h>
@@ -68,6 +69,247 @@ static int shell_cmd_tasks(int argc, char *argv[])
 #endif
 
 
+#if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_THREAD_MONITOR) && \
+	defined(CONFIG_THREAD_STATS)
+static int shell_cmd_threads(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+	struct k_thread *thread_list = NULL;
+	struct k_thread_stats stats;
+
+	printk("threads:\n");
+
+	thread_list   = (struct k_thread *)SYS_THREAD_MONITOR_HEAD;
+	while (thread_list != NULL) {
+		k_thread_stats_get(thread_list, &stats);
+		printk("%s%p: priority: %d run: %u us switches: %u "
+		       "preemptions: %u stack: %u / %u\n",
+		       (thread_list == k_current_get()) ? "*" : " ",
+		       thread_list,
+		       k_thread_priority_get(thread_list),
+		       (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(stats.cycles) /
+				  NSEC_PER_USEC),
+		       stats.num_switches, stats.num_preemptions,
+		       stats.stack_used, stats.stack_size);
+		thread_list = (struct k_thread *)SYS_THREAD_MONITOR_NEXT(thread_list);
+	}
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_MEM_POOL_STATS)
+static int shell_cmd_mem_pools(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+	struct k_mem_pool *pool;
+	struct k_mem_pool_stats stats;
+	size_t block_size;
+	uint32_t num_used;
+
+	printk("memory pools:\n");
+
+	pool = SYS_TRACING_HEAD(struct k_mem_pool, k_mem_pool);
+	while (pool != NULL) {
+		k_mem_pool_stats_get(pool, &stats);
+		printk("%p: used: %u peak: %u largest free: %u failures: %u\n",
+		       pool, stats.bytes_used, stats.max_bytes_used,
+		       stats.largest_free_block, stats.num_failures);
+
+		for (int i = 0; k_mem_pool_block_stats_get(pool, i, &block_size,
+							 &num_used) == 0; i++) {
+			if (num_used) {
+				printk("    %u-byte blocks: %u\n",
+				       block_size, num_used);
+			}
+		}
+		pool = SYS_TRACING_NEXT(struct k_mem_pool, k_mem_pool, pool);
+	}
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_MEM_SLAB_STATS)
+static int shell_cmd_mem_slabs(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+	struct k_mem_slab *slab;
+
+	printk("memory slabs:\n");
+
+	slab = SYS_TRACING_HEAD(struct k_mem_slab, k_mem_slab);
+	while (slab != NULL) {
+		printk("%p: blocks: %u x %u bytes used: %u peak: %u "
+		       "failures: %u\n",
+		       slab, slab->num_blocks, slab->block_size,
+		       k_mem_slab_num_used_get(slab),
+		       k_mem_slab_max_used_get(slab),
+		       k_mem_slab_num_failures_get(slab));
+		slab = SYS_TRACING_NEXT(struct k_mem_slab, k_mem_slab, slab);
+	}
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_IRQ_STATS)
+static uint32_t cycles_to_us(uint64_t cycles)
+{
+	return (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) / NSEC_PER_USEC);
+}
+
+static void print_histogram(const char *name, const uint32_t *buckets)
+{
+	printk("    %s cycles:", name);
+	for (int i = 0; i < K_IRQ_STATS_BUCKETS; i++) {
+		if (!buckets[i]) {
+			continue;
+		}
+
+		/* the last bucket also counts longer times */
+		if (i == K_IRQ_STATS_BUCKETS - 1) {
+			printk(" >=%u: %u", 1 << (i - 1), buckets[i]);
+		} else {
+			printk(" <%u: %u", 1 << i, buckets[i]);
+		}
+	}
+	printk("\n");
+}
+
+static int shell_cmd_irqs(int argc, char *argv[])
+{
+	struct k_irq_stats stats;
+
+	if (argc > 1 && !strcmp(argv[1], "reset")) {
+		k_irq_stats_reset();
+		return 0;
+	}
+
+	printk("interrupts:\n");
+
+	for (int i = 0; k_irq_stats_get(i, &stats) == 0; i++) {
+		printk("irq %u isr %p: count: %u latency max: %u us "
+		       "duration max: %u us total: %u us\n",
+		       stats.irq, stats.isr, stats.count,
+		       cycles_to_us(stats.max_latency),
+		       cycles_to_us(stats.max_duration),
+		       cycles_to_us(stats.total_duration));
+		print_histogram("latency", stats.latency);
+		print_histogram("duration", stats.duration);
+	}
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_PERF_COUNTER)
+#include <perf_counter.h>
+#include <errno.h>
+
+static const char * const perf_event_names[PERF_EVENT_COUNT] = {
+	[PERF_EVENT_CYCLES] = "cycles",
+	[PERF_EVENT_INSTRUCTIONS] = "instructions",
+	[PERF_EVENT_STALL_CYCLES] = "stalls",
+	[PERF_EVENT_LSU_CYCLES] = "lsu",
+	[PERF_EVENT_EXC_CYCLES] = "exceptions",
+	[PERF_EVENT_SLEEP_CYCLES] = "sleep",
+	[PERF_EVENT_FOLDED] = "folded",
+	[PERF_EVENT_CACHE_MISSES] = "cache-misses",
+	[PERF_EVENT_BRANCH_MISSES] = "branch-misses",
+};
+
+static void print_perf_counts(uint32_t events,
+			      struct perf_counter_values *values)
+{
+	uint64_t count;
+	int event;
+
+	for (event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (!(events & PERF_EVENT_BIT(event))) {
+			continue;
+		}
+
+		/* printk has no 64-bit conversion */
+		count = values->count[event];
+		if (count >= 1000000000) {
+			printk(" %s: %u%09u", perf_event_names[event],
+			       (uint32_t)(count / 1000000000),
+			       (uint32_t)(count % 1000000000));
+		} else {
+			printk(" %s: %u", perf_event_names[event],
+			       (uint32_t)count);
+		}
+	}
+	printk("\n");
+}
+
+static int shell_cmd_perf(int argc, char *argv[])
+{
+	static uint32_t events;
+	struct perf_counter_values values;
+	uint32_t start = 0;
+	int i, event;
+
+	if (argc > 1 && !strcmp(argv[1], "stop")) {
+		perf_counter_stop();
+		return 0;
+	}
+
+	if (argc > 1 && !strcmp(argv[1], "start")) {
+		for (i = 2; i < argc; i++) {
+			for (event = 0; event < PERF_EVENT_COUNT; event++) {
+				if (!strcmp(argv[i], perf_event_names[event])) {
+					start |= PERF_EVENT_BIT(event);
+					break;
+				}
+			}
+
+			if (event == PERF_EVENT_COUNT) {
+				printk("unknown event %s\n", argv[i]);
+				return -EINVAL;
+			}
+		}
+
+		i = perf_counter_start(start);
+		if (i) {
+			printk("cannot count these events (%d)\n", i);
+			return i;
+		}
+
+		events = start;
+		return 0;
+	}
+
+	printk("events:");
+	for (event = 0; event < PERF_EVENT_COUNT; event++) {
+		if (perf_counter_events() & PERF_EVENT_BIT(event)) {
+			printk(" %s", perf_event_names[event]);
+		}
+	}
+	printk("\n");
+
+	perf_counter_read(&values);
+	printk("total:");
+	print_perf_counts(events, &values);
+
+#if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_THREAD_MONITOR) && \
+	defined(CONFIG_PERF_COUNTER_THREAD)
+	struct k_thread *thread_list;
+
+	thread_list = (struct k_thread *)SYS_THREAD_MONITOR_HEAD;
+	while (thread_list != NULL) {
+		perf_counter_thread_read(thread_list, &values);
+		printk("%s%p:", (thread_list == k_current_get()) ? "*" : " ",
+		       thread_list);
+		print_perf_counts(events, &values);
+		thread_list = (struct k_thread *)SYS_THREAD_MONITOR_NEXT(
+			thread_list);
+	}
+#endif
+	return 0;
+}
+#endif
+
 #if defined(CONFIG_INIT_STACKS)
 static int shell_cmd_stack(int argc, char *argv[])
 {
@@ -83,6 +325,25 @@ struct shell_cmd kernel_commands[] = {
 #if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_THREAD_MONITOR)
 	{ "tasks", shell_cmd_tasks, "show running tasks" },
 #endif
+#if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_THREAD_MONITOR) && \
+	defined(CONFIG_THREAD_STATS)
+	{ "threads", shell_cmd_threads, "show thread runtime statistics" },
+#endif
+#if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_MEM_POOL_STATS)
+	{ "mempools", shell_cmd_mem_pools, "show memory pool usage" },
+#endif
+#if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_MEM_SLAB_STATS)
+	{ "memslabs", shell_cmd_mem_slabs, "show memory slab usage" },
+#endif
+#if defined(CONFIG_IRQ_STATS)
+	{ "irqs", shell_cmd_irqs,
+	  "show interrupt statistics, 'irqs reset' to clear them" },
+#endif
+#if defined(CONFIG_PERF_COUNTER)
+	{ "perf", shell_cmd_perf,
+	  "show hardware event counts, 'perf start <event>...' or "
+	  "'perf stop' to count events" },
+#endif
 #if defined(CONFIG_INIT_STACKS)
 	{ "stacks", shell_cmd_stack, "show system stacks" },
 #endif
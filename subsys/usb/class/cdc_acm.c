@@ -42,6 +42,10 @@
 #include <uart.h>
 #include <string.h>
 #include <misc/byteorder.h>
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+#include <misc/byte_ring.h>
+#include <usb/cdc_acm.h>
+#endif
 #include "cdc_acm.h"
 #include "usb_device.h"
 #include "usb_common.h"
@@ -70,6 +74,17 @@ static struct uart_driver_api cdc_acm_driver_api;
 #define LOW_BYTE(x)  ((x) & 0xFF)
 #define HIGH_BYTE(x) ((x) >> 8)
 
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+/* Ring sizes must be powers of 2 */
+BUILD_ASSERT(!(CONFIG_CDC_ACM_TX_RING_SIZE &
+	       (CONFIG_CDC_ACM_TX_RING_SIZE - 1)));
+BUILD_ASSERT(!(CONFIG_CDC_ACM_RX_RING_SIZE &
+	       (CONFIG_CDC_ACM_RX_RING_SIZE - 1)));
+
+static uint8_t cdc_acm_tx_data[CONFIG_CDC_ACM_TX_RING_SIZE];
+static uint8_t cdc_acm_rx_data[CONFIG_CDC_ACM_RX_RING_SIZE];
+#endif
+
 struct device *cdc_acm_dev;
 
 static struct k_sem poll_wait_sem;
@@ -98,6 +113,21 @@ struct cdc_acm_dev_data_t {
 	uint8_t serial_state;
 	/* CDC ACM notification sent status */
 	uint8_t notification_sent;
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	/* Written data, sent as large bulk transfers */
+	struct byte_ring tx_ring;
+	/* Received data */
+	struct byte_ring rx_ring;
+	/* Sends what is left once no more data came in for a while */
+	struct k_timer tx_timer;
+	/* Bytes of the ongoing IN transfer, 0 if none */
+	uint32_t tx_in_flight;
+	uint8_t tx_timer_armed;
+	/* Part of a packet is kept in the controller until the ring has
+	 * room, the endpoint NAKs the host meanwhile.
+	 */
+	uint8_t rx_stalled;
+#endif
 };
 
 /* Structure representing the global USB description */
@@ -295,6 +325,135 @@ int cdc_acm_class_handle_req(struct usb_setup_packet *pSetup,
 	return 0;
 }
 
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+/**
+ * @brief Start an IN transfer with the data of the TX ring
+ *
+ * Less than a packet is only sent once the flush timeout expired, so
+ * that small writes are coalesced. Must be called with interrupts locked.
+ *
+ * @param dev_data CDC ACM device data.
+ * @param flush    Send even less than a packet.
+ *
+ * @return  N/A.
+ */
+static void cdc_acm_tx_start(struct cdc_acm_dev_data_t *dev_data, bool flush)
+{
+	uint32_t len, written;
+	uint8_t *data;
+
+	if (dev_data->tx_in_flight ||
+	    dev_data->usb_status != USB_DC_CONFIGURED) {
+		return;
+	}
+
+	len = sys_byte_ring_used_get(&dev_data->tx_ring);
+	if (!len) {
+		return;
+	}
+
+	if (len < CDC_BULK_EP_MPS && !flush &&
+	    CONFIG_CDC_ACM_TX_FLUSH_TIMEOUT) {
+		if (!dev_data->tx_timer_armed) {
+			dev_data->tx_timer_armed = 1;
+			k_timer_start(&dev_data->tx_timer,
+				      CONFIG_CDC_ACM_TX_FLUSH_TIMEOUT, 0);
+		}
+		return;
+	}
+
+	/* Released once the transfer is done, the controller may still
+	 * read from it until then.
+	 */
+	len = sys_byte_ring_get_claim(&dev_data->tx_ring, &data, len);
+	if (usb_write(CDC_ENDP_IN, data, len, &written) == 0) {
+		dev_data->tx_in_flight = written;
+	}
+}
+
+static void cdc_acm_tx_timeout(struct k_timer *timer)
+{
+	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(cdc_acm_dev);
+	unsigned int key;
+
+	key = irq_lock();
+	dev_data->tx_timer_armed = 0;
+	cdc_acm_tx_start(dev_data, true);
+	irq_unlock(key);
+}
+
+/**
+ * @brief Move the packet received on the OUT endpoint to the RX ring
+ *
+ * The endpoint is only armed again once the whole packet is in the ring.
+ * Must be called with interrupts locked.
+ *
+ * @param dev_data CDC ACM device data.
+ *
+ * @return  Number of bytes moved.
+ */
+static uint32_t cdc_acm_rx_drain(struct cdc_acm_dev_data_t *dev_data)
+{
+	uint32_t avail, len, total = 0;
+	uint8_t tmp_buf[4];
+	uint8_t *data;
+
+	usb_ep_read_wait(CDC_ENDP_OUT, NULL, 0, &avail);
+
+	while (avail) {
+		len = sys_byte_ring_put_claim(&dev_data->rx_ring, &data, avail);
+
+		/*
+		 * Quark SE USB controller is always storing data
+		 * in the FIFOs per 32-bit words, a partial read drops
+		 * the rest of the word.
+		 */
+		if (len < avail) {
+			len &= ~3;
+		}
+
+		if (len) {
+			usb_ep_read_wait(CDC_ENDP_OUT, data, len, &len);
+			sys_byte_ring_put_finish(&dev_data->rx_ring, len);
+		} else {
+			/* Less than a word left before the end of the ring */
+			len = min(avail, sizeof(tmp_buf));
+			if (sys_byte_ring_space_get(&dev_data->rx_ring) < len) {
+				break;
+			}
+
+			usb_ep_read_wait(CDC_ENDP_OUT, tmp_buf, len, &len);
+			sys_byte_ring_put(&dev_data->rx_ring, tmp_buf, len);
+		}
+
+		avail -= len;
+		total += len;
+	}
+
+	dev_data->rx_stalled = (avail != 0);
+	if (!avail) {
+		usb_ep_read_continue(CDC_ENDP_OUT);
+	}
+
+	if (total) {
+		dev_data->rx_ready = 1;
+	}
+
+	return total;
+}
+
+static void cdc_acm_rx_resume(struct cdc_acm_dev_data_t *dev_data)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	if (dev_data->rx_stalled) {
+		cdc_acm_rx_drain(dev_data);
+	}
+	irq_unlock(key);
+}
+#endif /* CONFIG_CDC_ACM_RING_BUFFERS */
+
 /**
  * @brief EP Bulk IN handler, used to send data to the Host
  *
@@ -310,6 +469,16 @@ static void cdc_acm_bulk_in(uint8_t ep, enum usb_dc_ep_cb_status_code ep_status)
 	ARG_UNUSED(ep_status);
 	ARG_UNUSED(ep);
 
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	if (dev_data->tx_in_flight) {
+		sys_byte_ring_get_finish(&dev_data->tx_ring,
+					 dev_data->tx_in_flight);
+		dev_data->tx_in_flight = 0;
+	}
+
+	cdc_acm_tx_start(dev_data, false);
+#endif
+
 	dev_data->tx_ready = 1;
 	k_sem_give(&poll_wait_sem);
 	/* Call callback only if tx irq ena */
@@ -335,6 +504,17 @@ static void cdc_acm_bulk_out(uint8_t ep,
 
 	ARG_UNUSED(ep_status);
 
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	ARG_UNUSED(bytes_to_read);
+	ARG_UNUSED(i);
+	ARG_UNUSED(j);
+	ARG_UNUSED(buf_head);
+	ARG_UNUSED(tmp_buf);
+
+	if (!cdc_acm_rx_drain(dev_data)) {
+		return;
+	}
+#else
 	/* Check how many bytes were received */
 	usb_read(ep, NULL, 0, &bytes_to_read);
 
@@ -366,6 +546,7 @@ static void cdc_acm_bulk_out(uint8_t ep,
 
 	dev_data->rx_buf_head = buf_head;
 	dev_data->rx_ready = 1;
+#endif
 	/* Call callback only if rx irq ena */
 	if (dev_data->cb && dev_data->rx_irq_ena) {
 		dev_data->cb(cdc_acm_dev);
@@ -400,10 +581,26 @@ static void cdc_acm_int_in(uint8_t ep, enum usb_dc_ep_cb_status_code ep_status)
 static void cdc_acm_dev_status_cb(enum usb_dc_status_code status)
 {
 	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(cdc_acm_dev);
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	unsigned int key;
+#endif
 
 	/* Store the new status */
 	dev_data->usb_status = status;
 
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	key = irq_lock();
+	if (status == USB_DC_RESET || status == USB_DC_DISCONNECTED) {
+		/* The ongoing transfer will never complete, drop its data */
+		sys_byte_ring_get_finish(&dev_data->tx_ring,
+					 dev_data->tx_in_flight);
+		dev_data->tx_in_flight = 0;
+	} else if (status == USB_DC_CONFIGURED) {
+		cdc_acm_tx_start(dev_data, true);
+	}
+	irq_unlock(key);
+#endif
+
 	/* Check the USB status and do needed action if required */
 	switch (status) {
 	case USB_DC_ERROR:
@@ -515,6 +712,14 @@ static int cdc_acm_init(struct device *dev)
 	dev->driver_api = &cdc_acm_driver_api;
 	k_sem_init(&poll_wait_sem, 0, UINT_MAX);
 
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	sys_byte_ring_init(&dev_data->tx_ring, sizeof(cdc_acm_tx_data),
+			   cdc_acm_tx_data);
+	sys_byte_ring_init(&dev_data->rx_ring, sizeof(cdc_acm_rx_data),
+			   cdc_acm_rx_data);
+	k_timer_init(&dev_data->tx_timer, cdc_acm_tx_timeout, NULL);
+#endif
+
 	return 0;
 }
 
@@ -538,7 +743,18 @@ static int cdc_acm_fifo_fill(struct device *dev,
 	}
 
 	dev_data->tx_ready = 0;
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	{
+		unsigned int key = irq_lock();
+
+		bytes_written = sys_byte_ring_put(&dev_data->tx_ring,
+						  tx_data, len);
+		cdc_acm_tx_start(dev_data, !CONFIG_CDC_ACM_TX_FLUSH_TIMEOUT);
+		irq_unlock(key);
+	}
+#else
 	usb_write(CDC_ENDP_IN, tx_data, len, &bytes_written);
+#endif
 
 	return bytes_written;
 }
@@ -558,6 +774,20 @@ static int cdc_acm_fifo_read(struct device *dev, uint8_t *rx_data,
 	uint32_t avail_data, bytes_read, i;
 	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(dev);
 
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	ARG_UNUSED(avail_data);
+	ARG_UNUSED(i);
+
+	bytes_read = sys_byte_ring_get(&dev_data->rx_ring, rx_data, size);
+	if (sys_byte_ring_is_empty(&dev_data->rx_ring)) {
+		dev_data->rx_ready = 0;
+	}
+
+	cdc_acm_rx_resume(dev_data);
+
+	return bytes_read;
+#endif
+
 	avail_data = (CDC_ACM_BUFFER_SIZE + dev_data->rx_buf_head -
 		      dev_data->rx_buf_tail) % CDC_ACM_BUFFER_SIZE;
 	if (avail_data > size) {
@@ -870,12 +1100,44 @@ static int cdc_acm_poll_in(struct device *dev, unsigned char *c)
 static unsigned char cdc_acm_poll_out(struct device *dev,
 				      unsigned char c)
 {
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+	/* Only wait when the TX ring is full */
+	while (!cdc_acm_fifo_fill(dev, &c, 1)) {
+		if (DEV_DATA(dev)->usb_status != USB_DC_CONFIGURED ||
+		    k_sem_take(&poll_wait_sem, K_MSEC(100))) {
+			break;
+		}
+	}
+#else
 	cdc_acm_fifo_fill(dev, &c, 1);
 	k_sem_take(&poll_wait_sem, K_MSEC(100));
+#endif
 
 	return c;
 }
 
+#ifdef CONFIG_CDC_ACM_RING_BUFFERS
+uint32_t cdc_acm_rx_claim(struct device *dev, uint8_t **data)
+{
+	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(dev);
+
+	return sys_byte_ring_get_claim(&dev_data->rx_ring, data,
+				       sizeof(cdc_acm_rx_data));
+}
+
+void cdc_acm_rx_finish(struct device *dev, uint32_t size)
+{
+	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(dev);
+
+	sys_byte_ring_get_finish(&dev_data->rx_ring, size);
+	if (sys_byte_ring_is_empty(&dev_data->rx_ring)) {
+		dev_data->rx_ready = 0;
+	}
+
+	cdc_acm_rx_resume(dev_data);
+}
+#endif
+
 static struct uart_driver_api cdc_acm_driver_api = {
 	.poll_in = cdc_acm_poll_in,
 	.poll_out = cdc_acm_poll_out,
@@ -56,12 +56,43 @@
 #define DISK_THREAD_STACK_SZ	512
 #define DISK_THREAD_PRIO	-5
 
+#define BUF_SIZE	(CONFIG_USB_MASS_STORAGE_BUF_SECTORS * BLOCK_SIZE)
+
 static volatile int thread_op;
 static char __stack mass_thread_stack[DISK_THREAD_STACK_SZ];
 static struct k_sem disk_wait_sem;
-static volatile uint32_t defered_wr_sz;
 
-static uint8_t page[BLOCK_SIZE];
+/*
+ * Sectors go through two buffers: while one of them is on the bus, the
+ * thread reads the next sectors from the disk into the other one, or
+ * writes the previous ones.
+ */
+struct msd_buf {
+	uint8_t data[BUF_SIZE];
+	/* first sector of a write */
+	uint32_t lba;
+	/* bytes read from the disk or expected from the host, 0 if free */
+	uint32_t len;
+	/* bytes already on the bus */
+	uint32_t off;
+	/* filled by the host, to be written by the thread */
+	bool ready;
+};
+
+static struct msd_buf bufs[2];
+/* buffer on the bus */
+static uint8_t usb_idx;
+/* next buffer of the thread */
+static uint8_t disk_idx;
+
+/* next byte to read from the disk, and how many are left */
+static uint32_t disk_addr;
+static uint32_t disk_length;
+
+/* the bus is idle until the thread has read the next sectors */
+static bool usb_waiting;
+/* OUT packets are NAKed until the thread has freed a buffer */
+static bool out_nak;
 
 /* Initialized during mass_storage_init() */
 static uint32_t memory_size;
@@ -203,7 +234,11 @@ static void msd_init(void)
 {
 	memset((void *)&cbw, 0, sizeof(struct CBW));
 	memset((void *)&csw, 0, sizeof(struct CSW));
-	memset(page, 0, sizeof(page));
+	memset(bufs, 0, sizeof(bufs));
+	usb_idx = 0;
+	disk_idx = 0;
+	usb_waiting = false;
+	out_nak = false;
 	addr = 0;
 	length = 0;
 }
@@ -382,57 +417,140 @@ static bool readCapacity(void)
 	return true;
 }
 
-static void thread_memory_read_done(void)
+static void bufs_reset(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(bufs); i++) {
+		bufs[i].len = 0;
+		bufs[i].off = 0;
+		bufs[i].ready = false;
+	}
+
+	usb_idx = 0;
+	disk_idx = 0;
+	usb_waiting = false;
+	out_nak = false;
+}
+
+/* Called on each IN completion, and by the thread once it has read the
+ * sectors the bus was waiting for.
+ */
+static void memoryRead(void)
 {
+	struct msd_buf *buf = &bufs[usb_idx];
+	unsigned int key;
 	uint32_t n;
 
-	n = (length > MAX_PACKET) ? MAX_PACKET : length;
-	if ((addr + n) > memory_size) {
-		n = memory_size - addr;
+	key = irq_lock();
+
+	/* All of it went out, the thread can read the next sectors in it */
+	if (buf->len && buf->off == buf->len) {
+		buf->len = 0;
+		usb_idx ^= 1;
+		buf = &bufs[usb_idx];
+		k_sem_give(&disk_wait_sem);
+	}
+
+	if (!buf->len) {
+		if (disk_length) {
+			usb_waiting = true;
+			irq_unlock(key);
+			return;
+		}
+
+		/* The host asked for more than the memory holds */
+		irq_unlock(key);
 		stage = ERROR;
+		csw.Status = CSW_FAILED;
+		usb_ep_set_stall(EPBULK_IN);
+		sendCSW();
+		return;
 	}
 
-	if (usb_write(EPBULK_IN, &page[addr % BLOCK_SIZE], n, NULL) != 0) {
+	/* The buffer holds whole sectors, so the controller may split it in
+	 * full packets only. Accounted before the completion can be handled.
+	 */
+	if (usb_write(EPBULK_IN, buf->data + buf->off, buf->len - buf->off,
+		      &n) != 0) {
+		irq_unlock(key);
 		SYS_LOG_ERR("usb write failure");
+		return;
 	}
+
+	buf->off += n;
 	addr += n;
 	length -= n;
 
 	csw.DataResidue -= n;
 
-	if (!length || (stage != PROCESS_CBW)) {
-		csw.Status = (stage == PROCESS_CBW) ? CSW_PASSED : CSW_FAILED;
-		stage = (stage == PROCESS_CBW) ? SEND_CSW : stage;
+	if (!length) {
+		csw.Status = CSW_PASSED;
+		stage = SEND_CSW;
 	}
-}
 
+	irq_unlock(key);
+}
 
-static void memoryRead(void)
+static void memoryReadStart(void)
 {
-	uint32_t n;
-
-	n = (length > MAX_PACKET) ? MAX_PACKET : length;
-	if ((addr + n) > memory_size) {
-		n = memory_size - addr;
-		stage = ERROR;
+	bufs_reset();
+
+	disk_addr = addr;
+	disk_length = length;
+	if (addr >= memory_size) {
+		disk_length = 0;
+	} else if (addr + length > memory_size) {
+		disk_length = memory_size - addr;
 	}
 
-	/* we read an entire block */
-	if (!(addr % BLOCK_SIZE)) {
-		thread_op = THREAD_OP_READ_QUEUED;
-		SYS_LOG_DBG("Signal thread for %d", (addr/BLOCK_SIZE));
-		k_sem_give(&disk_wait_sem);
+	if (!disk_length) {
+		memoryRead();
 		return;
 	}
-	usb_write(EPBULK_IN, &page[addr % BLOCK_SIZE], n, NULL);
-	addr += n;
-	length -= n;
 
-	csw.DataResidue -= n;
+	usb_waiting = true;
+	thread_op = THREAD_OP_READ_QUEUED;
+	k_sem_give(&disk_wait_sem);
+}
 
-	if (!length || (stage != PROCESS_CBW)) {
-		csw.Status = (stage == PROCESS_CBW) ? CSW_PASSED : CSW_FAILED;
-		stage = (stage == PROCESS_CBW) ? SEND_CSW : stage;
+/* Keep both buffers filled, ahead of the bus */
+static void thread_memory_read(void)
+{
+	struct msd_buf *buf;
+	unsigned int key;
+	bool resume;
+	uint32_t n;
+
+	while (1) {
+		key = irq_lock();
+		buf = &bufs[disk_idx];
+		if (!disk_length || buf->len) {
+			irq_unlock(key);
+			return;
+		}
+		n = min(disk_length, BUF_SIZE);
+		irq_unlock(key);
+
+		if (disk_access_read(buf->data, disk_addr / BLOCK_SIZE,
+				     n / BLOCK_SIZE)) {
+			SYS_LOG_ERR("!! Disk Read Error %d !",
+				    disk_addr / BLOCK_SIZE);
+		}
+
+		key = irq_lock();
+		buf->off = 0;
+		buf->len = n;
+		disk_addr += n;
+		disk_length -= n;
+		disk_idx ^= 1;
+		resume = usb_waiting;
+		usb_waiting = false;
+		irq_unlock(key);
+
+		if (resume) {
+			memoryRead();
+		}
 	}
 }
 
@@ -547,7 +665,7 @@ static void CBWDecode(uint8_t *buf, uint16_t size)
 			if (infoTransfer()) {
 				if ((cbw.Flags & 0x80)) {
 					stage = PROCESS_CBW;
-					memoryRead();
+					memoryReadStart();
 				} else {
 					usb_ep_set_stall(EPBULK_OUT);
 					SYS_LOG_DBG("BO-STALL");
@@ -562,6 +680,8 @@ static void CBWDecode(uint8_t *buf, uint16_t size)
 			if (infoTransfer()) {
 				if (!(cbw.Flags & 0x80)) {
 					stage = PROCESS_CBW;
+					bufs_reset();
+					thread_op = THREAD_OP_WRITE_QUEUED;
 				} else {
 					usb_ep_set_stall(EPBULK_IN);
 					SYS_LOG_DBG("BI-STALL");
@@ -617,14 +737,14 @@ static void memoryVerify(uint8_t *buf, uint16_t size)
 	/* beginning of a new block -> load a whole block in RAM */
 	if (!(addr % BLOCK_SIZE)) {
 		SYS_LOG_DBG("Disk READ sector %d", addr/BLOCK_SIZE);
-		if (disk_access_read(page, addr/BLOCK_SIZE, 1)) {
+		if (disk_access_read(bufs[0].data, addr/BLOCK_SIZE, 1)) {
 			SYS_LOG_ERR("---- Disk Read Error %d", addr/BLOCK_SIZE);
 		}
 	}
 
 	/* info are in RAM -> no need to re-read memory */
 	for (n = 0; n < size; n++) {
-		if (page[addr%BLOCK_SIZE + n] != buf[n]) {
+		if (bufs[0].data[addr%BLOCK_SIZE + n] != buf[n]) {
 			SYS_LOG_DBG("Mismatch sector %d offset %d",
 					addr/BLOCK_SIZE, n);
 			memOK = false;
@@ -645,6 +765,8 @@ static void memoryVerify(uint8_t *buf, uint16_t size)
 
 static void memoryWrite(uint8_t *buf, uint16_t size)
 {
+	struct msd_buf *wbuf = &bufs[usb_idx];
+
 	if ((addr + size) > memory_size) {
 		size = memory_size - addr;
 		stage = ERROR;
@@ -652,32 +774,38 @@ static void memoryWrite(uint8_t *buf, uint16_t size)
 		SYS_LOG_WRN("BO - STall > MemSz");
 	}
 
-	/* we fill an array in RAM of 1 block before writing it in memory */
-	for (int i = 0; i < size; i++) {
-		page[addr % BLOCK_SIZE + i] = buf[i];
+	if (!wbuf->len) {
+		wbuf->lba = addr / BLOCK_SIZE;
+		wbuf->len = min(length, BUF_SIZE);
+		wbuf->off = 0;
 	}
 
-	/* if the array is filled, write it in memory */
-	if (!((addr + size) % BLOCK_SIZE)) {
-		if (!(disk_access_status() & DISK_STATUS_WR_PROTECT)) {
-			SYS_LOG_DBG("Disk WRITE Qd %d", (addr/BLOCK_SIZE));
-			thread_op = THREAD_OP_WRITE_QUEUED;  /* write_queued */
-			defered_wr_sz = size;
-			k_sem_give(&disk_wait_sem);
-			return;
-		}
+	if (size > wbuf->len - wbuf->off) {
+		size = wbuf->len - wbuf->off;
 	}
 
+	/* we fill an array in RAM of a few blocks before writing them */
+	memcpy(wbuf->data + wbuf->off, buf, size);
+	wbuf->off += size;
+
 	addr += size;
 	length -= size;
 	csw.DataResidue -= size;
 
-	if ((!length) || (stage != PROCESS_CBW)) {
-		csw.Status = (stage == ERROR) ? CSW_FAILED : CSW_PASSED;
-		sendCSW();
+	if (wbuf->off < wbuf->len && length && stage == PROCESS_CBW) {
+		return;
 	}
-}
 
+	/* Written by the thread while the host fills the other buffer. The
+	 * CSW is sent once everything reached the disk.
+	 */
+	SYS_LOG_DBG("Disk WRITE Qd %d", wbuf->lba);
+	wbuf->len = wbuf->off;
+	wbuf->ready = true;
+	usb_idx ^= 1;
+	out_nak = bufs[usb_idx].ready;
+	k_sem_give(&disk_wait_sem);
+}
 
 static void mass_storage_bulk_out(uint8_t ep,
 		enum usb_dc_ep_cb_status_code ep_status)
@@ -724,7 +852,7 @@ static void mass_storage_bulk_out(uint8_t ep,
 		break;
 	}
 
-	if (thread_op != THREAD_OP_WRITE_QUEUED) {
+	if (!out_nak) {
 		usb_ep_read_continue(ep);
 	} else {
 		SYS_LOG_DBG("> BO not clearing NAKs yet");
@@ -732,23 +860,41 @@ static void mass_storage_bulk_out(uint8_t ep,
 
 }
 
-static void thread_memory_write_done(void)
+static void thread_memory_write(void)
 {
-	uint32_t size = defered_wr_sz;
-
-	addr += size;
-	length -= size;
-	csw.DataResidue -= size;
+	struct msd_buf *buf;
+	unsigned int key;
+	bool resume, done;
+
+	while (bufs[disk_idx].ready) {
+		buf = &bufs[disk_idx];
+
+		if (!(disk_access_status() & DISK_STATUS_WR_PROTECT) &&
+		    buf->len && disk_access_write(buf->data, buf->lba,
+						  buf->len / BLOCK_SIZE)) {
+			SYS_LOG_ERR("!!!!! Disk Write Error %d !!!!!",
+				    buf->lba);
+		}
 
+		key = irq_lock();
+		buf->ready = false;
+		buf->len = 0;
+		disk_idx ^= 1;
+		resume = out_nak;
+		out_nak = false;
+		done = (!length || (stage != PROCESS_CBW)) &&
+		       !bufs[disk_idx].ready;
+		irq_unlock(key);
+
+		if (done) {
+			csw.Status = (stage == ERROR) ? CSW_FAILED : CSW_PASSED;
+			sendCSW();
+		}
 
-	if ((!length) || (stage != PROCESS_CBW)) {
-		csw.Status = (stage == ERROR) ? CSW_FAILED : CSW_PASSED;
-		sendCSW();
+		if (resume) {
+			usb_ep_read_continue(EPBULK_OUT);
+		}
 	}
-
-	thread_op = THREAD_OP_WRITE_DONE;
-
-	usb_ep_read_continue(EPBULK_OUT);
 }
 
 /**
@@ -881,19 +1027,10 @@ static void mass_thread_main(int arg1, int unused)
 
 		switch (thread_op) {
 		case THREAD_OP_READ_QUEUED:
-			if (disk_access_read(page, (addr/BLOCK_SIZE), 1)) {
-				SYS_LOG_ERR("!! Disk Read Error %d !",
-						addr/BLOCK_SIZE);
-			}
-
-			thread_memory_read_done();
+			thread_memory_read();
 			break;
 		case THREAD_OP_WRITE_QUEUED:
-			if (disk_access_write(page, (addr/BLOCK_SIZE), 1)) {
-				SYS_LOG_ERR("!!!!! Disk Write Error %d !!!!!",
-					    addr/BLOCK_SIZE);
-			}
-			thread_memory_write_done();
+			thread_memory_write();
 			break;
 		default:
 			SYS_LOG_ERR("XXXXXX thread_op  %d ! XXXXX", thread_op);
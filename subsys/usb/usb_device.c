@@ -58,6 +58,7 @@
 
 #include <errno.h>
 #include <stddef.h>
+#include <kernel.h>
 #include <misc/util.h>
 #include <misc/__assert.h>
 #include <board.h>
@@ -96,6 +97,38 @@
 #define USB_CONTROL_OUT_EP0         0
 #define USB_CONTROL_IN_EP0          0x80
 
+/* Internal transfer flag, a zero length packet is left to send */
+#define USB_TRANS_ZLP               BIT(31)
+
+/* Transfer state, status is -EBUSY while the transfer is running, and
+ * the slot is in use until the completion callback returned.
+ */
+struct usb_transfer_data {
+	/** slot allocated */
+	bool in_use;
+	/** endpoint associated to the transfer */
+	uint8_t ep;
+	/** max packet size of the endpoint */
+	uint16_t mps;
+	/** transfer flags */
+	unsigned int flags;
+	/** current buffer position */
+	uint8_t *buffer;
+	/** number of bytes left to transfer */
+	size_t bsize;
+	/** number of bytes transferred */
+	size_t tsize;
+	/** transfer status, 0 once done or negative errno code */
+	int status;
+	/** completion callback and its argument */
+	usb_transfer_callback cb;
+	void *priv;
+	/** calls back in thread context */
+	struct k_work work;
+};
+
+static struct usb_transfer_data ut_data[CONFIG_USB_MAX_NUM_TRANSFERS];
+
 static struct usb_dev_priv {
 	/** Setup packet */
 	struct usb_setup_packet setup;
@@ -821,6 +854,21 @@ int usb_deconfig(void)
 	return 0;
 }
 
+static void usb_cancel_transfers(void);
+
+/* Running transfers do not survive a reset nor a disconnection */
+static void usb_forward_status_cb(enum usb_dc_status_code status)
+{
+	if (status == USB_DC_RESET || status == USB_DC_DISCONNECTED ||
+	    status == USB_DC_ERROR) {
+		usb_cancel_transfers();
+	}
+
+	if (usb_dev.status_callback) {
+		usb_dev.status_callback(status);
+	}
+}
+
 int usb_enable(struct usb_cfg_data *config)
 {
 	int ret;
@@ -836,7 +884,7 @@ int usb_enable(struct usb_cfg_data *config)
 	if (ret < 0)
 		return ret;
 
-	ret = usb_dc_set_status_callback(config->cb_usb_status);
+	ret = usb_dc_set_status_callback(usb_forward_status_cb);
 	if (ret < 0)
 		return ret;
 
@@ -943,3 +991,271 @@ int usb_ep_read_continue(uint8_t ep)
 {
 	return usb_dc_ep_read_continue(ep);
 }
+
+/*
+ * @brief get the max packet size of an endpoint from the descriptors
+ */
+static uint16_t usb_ep_mps(uint8_t ep)
+{
+	const uint8_t *p = usb_dev.descriptors;
+
+	while (p && p[DESC_bLength] != 0) {
+		if (p[DESC_bDescriptorType] == DESC_ENDPOINT &&
+		    p[ENDP_DESC_bEndpointAddress] == ep) {
+			return p[ENDP_DESC_wMaxPacketSize] |
+			       (p[ENDP_DESC_wMaxPacketSize + 1] << 8);
+		}
+
+		p += p[DESC_bLength];
+	}
+
+	return 0;
+}
+
+static struct usb_transfer_data *usb_ep_get_transfer(uint8_t ep)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ut_data); i++) {
+		if (ut_data[i].ep == ep && ut_data[i].status == -EBUSY) {
+			return &ut_data[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void usb_transfer_work(struct k_work *item)
+{
+	struct usb_transfer_data *trans;
+	usb_transfer_callback cb;
+	void *priv;
+	int tsize;
+	uint8_t ep;
+
+	trans = CONTAINER_OF(item, struct usb_transfer_data, work);
+
+	cb = trans->cb;
+	priv = trans->priv;
+	ep = trans->ep;
+	tsize = trans->status ? trans->status : trans->tsize;
+
+	/* the callback can queue the next transfer in this slot */
+	trans->in_use = false;
+
+	if (cb) {
+		cb(ep, tsize, priv);
+	}
+}
+
+/* Must be called with interrupts locked */
+static void usb_transfer_done(struct usb_transfer_data *trans, int status)
+{
+	trans->status = status;
+	k_work_submit(&trans->work);
+}
+
+/* Must be called with interrupts locked */
+static void usb_transfer_write(struct usb_transfer_data *trans)
+{
+	uint32_t bytes;
+	int ret;
+
+	if (!trans->bsize) {
+		if (!(trans->flags & USB_TRANS_ZLP)) {
+			usb_transfer_done(trans, 0);
+			return;
+		}
+
+		/* a full last packet is followed by a zero length one */
+		trans->flags &= ~USB_TRANS_ZLP;
+	}
+
+	/* The controller takes as many packets as it can at once */
+	ret = usb_dc_ep_write(trans->ep, trans->buffer, trans->bsize, &bytes);
+	if (ret) {
+		usb_transfer_done(trans, ret);
+		return;
+	}
+
+	trans->buffer += bytes;
+	trans->bsize -= bytes;
+	trans->tsize += bytes;
+}
+
+/* Must be called with interrupts locked */
+static void usb_transfer_read(struct usb_transfer_data *trans)
+{
+	uint32_t bytes;
+	int ret;
+
+	ret = usb_dc_ep_read_wait(trans->ep, trans->buffer, trans->bsize,
+				  &bytes);
+	if (ret) {
+		usb_transfer_done(trans, ret);
+		return;
+	}
+
+	trans->buffer += bytes;
+	trans->bsize -= bytes;
+	trans->tsize += bytes;
+
+	/* A short packet ends the transfer, the endpoint is left NAKing
+	 * until the next transfer so that the host waits meanwhile.
+	 */
+	if (!trans->bsize || bytes < trans->mps) {
+		usb_transfer_done(trans, 0);
+		return;
+	}
+
+	usb_dc_ep_read_continue(trans->ep);
+}
+
+void usb_transfer_ep_callback(uint8_t ep,
+			      enum usb_dc_ep_cb_status_code status)
+{
+	struct usb_transfer_data *trans;
+	unsigned int key;
+
+	key = irq_lock();
+
+	trans = usb_ep_get_transfer(ep);
+	if (!trans) {
+		/* OUT data is left in the endpoint for the next transfer */
+		irq_unlock(key);
+		return;
+	}
+
+	if (status == USB_DC_EP_DATA_IN) {
+		usb_transfer_write(trans);
+	} else if (status == USB_DC_EP_DATA_OUT) {
+		usb_transfer_read(trans);
+	}
+
+	irq_unlock(key);
+}
+
+int usb_transfer(uint8_t ep, uint8_t *data, size_t dlen, unsigned int flags,
+		 usb_transfer_callback cb, void *priv)
+{
+	struct usb_transfer_data *trans = NULL;
+	bool write = (flags & USB_TRANS_WRITE);
+	uint32_t avail;
+	unsigned int key;
+	int i;
+
+	if (!(flags & (USB_TRANS_READ | USB_TRANS_WRITE)) ||
+	    write != ((ep & USB_EP_DIR_IN) == USB_EP_DIR_IN)) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (usb_ep_get_transfer(ep)) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(ut_data); i++) {
+		if (!ut_data[i].in_use) {
+			trans = &ut_data[i];
+			break;
+		}
+	}
+
+	if (!trans) {
+		irq_unlock(key);
+		return -ENOMEM;
+	}
+
+	trans->in_use = true;
+	trans->ep = ep;
+	trans->mps = usb_ep_mps(ep);
+	trans->flags = flags & ~USB_TRANS_ZLP;
+	trans->buffer = data;
+	trans->bsize = dlen;
+	trans->tsize = 0;
+	trans->status = -EBUSY;
+	trans->cb = cb;
+	trans->priv = priv;
+	k_work_init(&trans->work, usb_transfer_work);
+
+	if (write) {
+		/* zero length transfers also send a zero length packet */
+		if (!dlen || (trans->mps && !(dlen % trans->mps) &&
+			      !(flags & USB_TRANS_NO_ZLP))) {
+			trans->flags |= USB_TRANS_ZLP;
+		}
+
+		usb_transfer_write(trans);
+	} else if (usb_dc_ep_read_wait(ep, NULL, 0, &avail) == 0 && avail) {
+		/* received before the transfer was queued */
+		usb_transfer_read(trans);
+	} else {
+		usb_dc_ep_read_continue(ep);
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+struct usb_transfer_sync_priv {
+	int tsize;
+	struct k_sem sem;
+};
+
+static void usb_transfer_sync_cb(uint8_t ep, int tsize, void *priv)
+{
+	struct usb_transfer_sync_priv *pdata = priv;
+
+	pdata->tsize = tsize;
+	k_sem_give(&pdata->sem);
+}
+
+int usb_transfer_sync(uint8_t ep, uint8_t *data, size_t dlen,
+		      unsigned int flags)
+{
+	struct usb_transfer_sync_priv pdata;
+	int ret;
+
+	k_sem_init(&pdata.sem, 0, 1);
+
+	ret = usb_transfer(ep, data, dlen, flags, usb_transfer_sync_cb,
+			   &pdata);
+	if (ret) {
+		return ret;
+	}
+
+	k_sem_take(&pdata.sem, K_FOREVER);
+
+	return pdata.tsize;
+}
+
+void usb_cancel_transfer(uint8_t ep)
+{
+	struct usb_transfer_data *trans;
+	unsigned int key;
+
+	key = irq_lock();
+
+	trans = usb_ep_get_transfer(ep);
+	if (trans) {
+		if (ep & USB_EP_DIR_IN) {
+			usb_dc_ep_flush(ep);
+		}
+
+		usb_transfer_done(trans, -ECANCELED);
+	}
+
+	irq_unlock(key);
+}
+
+static void usb_cancel_transfers(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ut_data); i++) {
+		usb_cancel_transfer(ut_data[i].ep);
+	}
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <ztest.h>
+
+#define WARMUP 10
+#define RUNS 200
+
+#define BENCH_STACK_SIZE 512
+#define BENCH(name, fn, data) \
+	ztest_benchmark_run(name, fn, data, WARMUP, RUNS, NULL)
+
+void test_sched(void);
+void test_ipc(void);
+void test_mem(void);
+void test_timing(void);
+void test_lookup(void);
+
+#endif /* __BENCH_H__ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bench.h"
+
+#define PIPE_XFER 16
+#define MSGQ_BATCH 4
+
+static K_SEM_DEFINE(sem, 0, 1);
+static K_MUTEX_DEFINE(mutex);
+static K_FIFO_DEFINE(fifo);
+static K_LIFO_DEFINE(lifo);
+static K_STACK_DEFINE(stack, 4);
+K_MSGQ_DEFINE(msgq, sizeof(uint32_t), MSGQ_BATCH, 4);
+K_PIPE_DEFINE(pipe, 64, 4);
+
+struct item {
+	void *reserved;
+	uint32_t value;
+};
+
+static struct item item;
+
+static void sem_give_take(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_sem_give(&sem);
+	k_sem_take(&sem, K_NO_WAIT);
+}
+
+static void mutex_lock_unlock(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_mutex_lock(&mutex, K_NO_WAIT);
+	k_mutex_unlock(&mutex);
+}
+
+static void fifo_put_get(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_fifo_put(&fifo, &item);
+	k_fifo_get(&fifo, K_NO_WAIT);
+}
+
+static void lifo_put_get(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_lifo_put(&lifo, &item);
+	k_lifo_get(&lifo, K_NO_WAIT);
+}
+
+static void stack_push_pop(void *data)
+{
+	uint32_t value;
+
+	ARG_UNUSED(data);
+
+	k_stack_push(&stack, 1);
+	k_stack_pop(&stack, &value, K_NO_WAIT);
+}
+
+static void msgq_put_get(void *data)
+{
+	uint32_t msg = 0;
+
+	ARG_UNUSED(data);
+
+	k_msgq_put(&msgq, &msg, K_NO_WAIT);
+	k_msgq_get(&msgq, &msg, K_NO_WAIT);
+}
+
+static void msgq_put_get_batch(void *data)
+{
+	uint32_t msgs[MSGQ_BATCH] = { 0 };
+
+	ARG_UNUSED(data);
+
+	k_msgq_put_batch(&msgq, msgs, MSGQ_BATCH, K_NO_WAIT);
+	k_msgq_get_batch(&msgq, msgs, MSGQ_BATCH, K_NO_WAIT);
+}
+
+static void pipe_put_get(void *data)
+{
+	uint8_t buf[PIPE_XFER];
+	size_t bytes;
+
+	ARG_UNUSED(data);
+
+	k_pipe_put(&pipe, buf, sizeof(buf), &bytes, sizeof(buf), K_NO_WAIT);
+	k_pipe_get(&pipe, buf, sizeof(buf), &bytes, sizeof(buf), K_NO_WAIT);
+}
+
+void test_ipc(void)
+{
+	BENCH("sem_give_take", sem_give_take, NULL);
+	BENCH("mutex_lock_unlock", mutex_lock_unlock, NULL);
+	BENCH("fifo_put_get", fifo_put_get, NULL);
+	BENCH("lifo_put_get", lifo_put_get, NULL);
+	BENCH("stack_push_pop", stack_push_pop, NULL);
+	BENCH("msgq_put_get", msgq_put_get, NULL);
+	BENCH("msgq_put_get_batch4", msgq_put_get_batch, NULL);
+	BENCH("pipe_put_get16", pipe_put_get, NULL);
+
+	assert_equal(k_msgq_num_used_get(&msgq), 0, "message left behind");
+}
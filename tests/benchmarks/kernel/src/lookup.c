@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bench.h"
+
+#include <misc/rbtree.h>
+#include <misc/hash_map.h>
+
+#define LOOKUP_COUNT 64
+
+struct entry {
+	uint32_t key;
+	sys_rbnode_t rbnode;
+	sys_hnode_t hnode;
+};
+
+static struct entry entries[LOOKUP_COUNT];
+
+static sys_rbtree_t tree;
+SYS_HASH_MAP_DEFINE_POW2(map, 7);
+
+static int rb_cmp(const sys_rbnode_t *a, const sys_rbnode_t *b)
+{
+	uint32_t key_a = CONTAINER_OF(a, struct entry, rbnode)->key;
+	uint32_t key_b = CONTAINER_OF(b, struct entry, rbnode)->key;
+
+	return (key_a > key_b) - (key_a < key_b);
+}
+
+static int rb_key_cmp(const void *key, const sys_rbnode_t *node)
+{
+	uint32_t key_a = *(const uint32_t *)key;
+	uint32_t key_b = CONTAINER_OF(node, struct entry, rbnode)->key;
+
+	return (key_a > key_b) - (key_a < key_b);
+}
+
+static bool hash_match(const void *key, const sys_hnode_t *node)
+{
+	return *(const uint32_t *)key ==
+	       CONTAINER_OF(node, struct entry, hnode)->key;
+}
+
+/* The last key, the worst case of the array scans the subsystems do */
+static uint32_t last_key(void)
+{
+	return entries[LOOKUP_COUNT - 1].key;
+}
+
+static void linear_find(void *data)
+{
+	volatile uint32_t key = last_key();
+	int i;
+
+	ARG_UNUSED(data);
+
+	for (i = 0; i < LOOKUP_COUNT; i++) {
+		if (entries[i].key == key) {
+			break;
+		}
+	}
+}
+
+static void rb_find(void *data)
+{
+	volatile uint32_t key = last_key();
+
+	ARG_UNUSED(data);
+
+	sys_rb_find(&tree, (const void *)&key, rb_key_cmp);
+}
+
+static void rb_remove_insert(void *data)
+{
+	struct entry *entry = &entries[LOOKUP_COUNT / 2];
+
+	ARG_UNUSED(data);
+
+	sys_rb_remove(&tree, &entry->rbnode);
+	sys_rb_insert(&tree, &entry->rbnode);
+}
+
+static void hash_find(void *data)
+{
+	volatile uint32_t key = last_key();
+
+	ARG_UNUSED(data);
+
+	sys_hash_map_find(&map, sys_hash32_u32(key), (const void *)&key,
+			  hash_match);
+}
+
+static void hash_remove_insert(void *data)
+{
+	struct entry *entry = &entries[LOOKUP_COUNT / 2];
+
+	ARG_UNUSED(data);
+
+	sys_hash_map_remove(&map, &entry->hnode);
+	sys_hash_map_insert(&map, &entry->hnode, sys_hash32_u32(entry->key));
+}
+
+void test_lookup(void)
+{
+	int i;
+
+	sys_rb_init(&tree, rb_cmp);
+
+	for (i = 0; i < LOOKUP_COUNT; i++) {
+		entries[i].key = i * 2654435761u;
+		sys_rb_insert(&tree, &entries[i].rbnode);
+		sys_hash_map_insert(&map, &entries[i].hnode,
+				    sys_hash32_u32(entries[i].key));
+	}
+
+	BENCH("lookup_linear64", linear_find, NULL);
+	BENCH("lookup_rbtree64", rb_find, NULL);
+	BENCH("lookup_hash_map64", hash_find, NULL);
+	BENCH("rbtree_remove_insert64", rb_remove_insert, NULL);
+	BENCH("hash_map_remove_insert64", hash_remove_insert, NULL);
+
+	assert_equal(sys_hash_map_count(&map), LOOKUP_COUNT, "entry lost");
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_benchmark
+ * @{
+ * @defgroup t_benchmark_kernel test_benchmark_kernel
+ * @brief TestPurpose: time the kernel primitives in cycles, to compare
+ * boards and track scheduler and timeout changes
+ * @}
+ */
+
+#include "bench.h"
+
+void test_main(void)
+{
+	ztest_test_suite(kernel_benchmarks,
+			 ztest_unit_test(test_sched),
+			 ztest_unit_test(test_ipc),
+			 ztest_unit_test(test_mem),
+			 ztest_unit_test(test_timing),
+			 ztest_unit_test(test_lookup)
+			 );
+
+	ztest_run_test_suite(kernel_benchmarks);
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bench.h"
+
+K_MEM_SLAB_DEFINE(slab, 64, 4, 4);
+K_MEM_POOL_DEFINE(pool, 16, 256, 2, 4);
+
+static void slab_alloc_free(void *data)
+{
+	void *block;
+
+	ARG_UNUSED(data);
+
+	k_mem_slab_alloc(&slab, &block, K_NO_WAIT);
+	k_mem_slab_free(&slab, &block);
+}
+
+static void pool_alloc_free(void *data)
+{
+	struct k_mem_block block;
+
+	k_mem_pool_alloc(&pool, &block, (uintptr_t)data, K_NO_WAIT);
+	k_mem_pool_free(&block);
+}
+
+void test_mem(void)
+{
+	BENCH("mem_slab_alloc_free", slab_alloc_free, NULL);
+
+	/* Largest block, and smallest block split from a large one */
+	BENCH("mem_pool_alloc_free256", pool_alloc_free, (void *)256);
+	BENCH("mem_pool_alloc_free16", pool_alloc_free, (void *)16);
+
+	assert_equal(k_mem_slab_num_used_get(&slab), 0, "block leaked");
+}
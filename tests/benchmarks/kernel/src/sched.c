@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <irq_offload.h>
+
+#include "bench.h"
+
+static char __stack helper_stack[BENCH_STACK_SIZE];
+
+static K_SEM_DEFINE(ping, 0, 1);
+static K_SEM_DEFINE(pong, 0, 1);
+static K_SEM_DEFINE(wake, 0, 1);
+
+static volatile int stop;
+static uint32_t wake_start;
+static uint32_t wake_samples[RUNS];
+static int wake_count;
+
+static k_tid_t helper_start(void (*entry)(void *, void *, void *),
+			    int prio_offset)
+{
+	int prio = k_thread_priority_get(k_current_get()) + prio_offset;
+
+	stop = 0;
+
+	return k_thread_spawn(helper_stack, sizeof(helper_stack), entry,
+			      NULL, NULL, NULL, prio, 0, K_NO_WAIT);
+}
+
+static void irq_lock_unlock(void *data)
+{
+	unsigned int key;
+
+	ARG_UNUSED(data);
+
+	key = irq_lock();
+	irq_unlock(key);
+}
+
+static void offload_isr(void *param)
+{
+	ARG_UNUSED(param);
+}
+
+static void irq_entry_exit(void *data)
+{
+	ARG_UNUSED(data);
+
+	irq_offload(offload_isr, NULL);
+}
+
+static void yield_helper(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (!stop) {
+		k_yield();
+	}
+}
+
+/* Two context switches, to the helper and back */
+static void yield(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_yield();
+}
+
+static void ping_pong_helper(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&ping, K_FOREVER);
+		k_sem_give(&pong);
+	}
+}
+
+static void ping_pong(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_sem_give(&ping);
+	k_sem_take(&pong, K_FOREVER);
+}
+
+static void wake_helper(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&wake, K_FOREVER);
+		wake_samples[wake_count++] = k_cycle_get_32() - wake_start;
+	}
+}
+
+void test_sched(void)
+{
+	struct ztest_benchmark_stats stats;
+	k_tid_t helper;
+	int i;
+
+	BENCH("irq_lock_unlock", irq_lock_unlock, NULL);
+	BENCH("irq_entry_exit", irq_entry_exit, NULL);
+
+	helper = helper_start(yield_helper, 0);
+	BENCH("thread_yield", yield, NULL);
+	stop = 1;
+	k_thread_abort(helper);
+
+	helper = helper_start(ping_pong_helper, 0);
+	BENCH("sem_ping_pong", ping_pong, NULL);
+	k_thread_abort(helper);
+
+	/* From the give to the higher priority thread running */
+	helper = helper_start(wake_helper, -1);
+	k_yield();
+
+	wake_count = 0;
+	for (i = 0; i < RUNS; i++) {
+		wake_start = k_cycle_get_32();
+		k_sem_give(&wake);
+	}
+
+	k_thread_abort(helper);
+
+	assert_equal(wake_count, RUNS, "waiting thread not woken up");
+
+	ztest_benchmark_compute(wake_samples, wake_count, &stats);
+	ztest_benchmark_report("sem_wake_thread", &stats);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bench.h"
+
+static K_TIMER_DEFINE(timer, NULL, NULL);
+
+static char __stack work_q_stack[BENCH_STACK_SIZE];
+static struct k_work_q work_q;
+static struct k_work work;
+static int work_count;
+
+static void timer_start_stop(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_timer_start(&timer, K_SECONDS(1), 0);
+	k_timer_stop(&timer);
+}
+
+static void work_handler(struct k_work *item)
+{
+	ARG_UNUSED(item);
+
+	work_count++;
+}
+
+/* The work queue preempts the submitter: the handler runs in the call */
+static void work_submit(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_work_submit_to_queue(&work_q, &work);
+}
+
+void test_timing(void)
+{
+	BENCH("timer_start_stop", timer_start_stop, NULL);
+
+	k_work_q_start(&work_q, work_q_stack, sizeof(work_q_stack),
+		       k_thread_priority_get(k_current_get()) - 1);
+	k_work_init(&work, work_handler);
+
+	work_count = 0;
+	BENCH("work_submit_run", work_submit, NULL);
+
+	assert_equal(work_count, WARMUP + RUNS, "work not run");
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_crypto
+ * @{
+ * @defgroup t_mbedtls_arena test_mbedtls_arena
+ * @brief TestPurpose: verify that the mbed TLS allocations of a thread are
+ * bounded by its arena, and the usage statistics
+ * @}
+ */
+
+#include <ztest.h>
+#include <mbedtls_arena.h>
+
+#if !defined(CONFIG_MBEDTLS_CFG_FILE)
+#include "mbedtls/config.h"
+#else
+#include CONFIG_MBEDTLS_CFG_FILE
+#endif
+
+#include <mbedtls/platform.h>
+#include <mbedtls/bignum.h>
+
+#define ARENA_SIZE 2048
+
+K_MEM_POOL_DEFINE(arena_pool, 64, ARENA_SIZE, 2, 4);
+
+static struct mbedtls_arena arena;
+
+void test_bounded(void)
+{
+	struct mbedtls_arena_stats stats;
+	void *ptr[4];
+	int i;
+
+	assert_equal(mbedtls_arena_init(&arena, &arena_pool, ARENA_SIZE,
+					K_NO_WAIT), 0, "no arena memory");
+
+	/* No arena entered */
+	assert_true(mbedtls_calloc(1, 16) == NULL, "allocation without arena");
+
+	assert_equal(mbedtls_arena_enter(&arena), 0, "arena not entered");
+
+	for (i = 0; i < ARRAY_SIZE(ptr); i++) {
+		ptr[i] = mbedtls_calloc(1, 400);
+		assert_not_null(ptr[i], "allocation failed");
+	}
+
+	/* Beyond the arena */
+	assert_true(mbedtls_calloc(1, ARENA_SIZE / 2) == NULL,
+		    "arena overflowed");
+
+	/* Freed out of order, everything merges back */
+	mbedtls_free(ptr[1]);
+	mbedtls_free(ptr[3]);
+	mbedtls_free(ptr[0]);
+	mbedtls_free(ptr[2]);
+
+	mbedtls_arena_stats_get(&arena, &stats, 0);
+	assert_equal(stats.bytes_used, 0, "memory leaked");
+	assert_true(stats.max_bytes_used >= 4 * 400, "wrong peak usage");
+	assert_equal(stats.failures, 1, "failure not counted");
+
+	ptr[0] = mbedtls_calloc(1, ARENA_SIZE / 2);
+	assert_not_null(ptr[0], "arena fragmented");
+	mbedtls_free(ptr[0]);
+
+	assert_equal(mbedtls_arena_enter(NULL), 0, "arena not left");
+	assert_true(mbedtls_calloc(1, 16) == NULL, "allocation after leaving");
+
+	mbedtls_arena_release(&arena);
+}
+
+void test_mbedtls_usage(void)
+{
+	struct mbedtls_arena_stats stats;
+	mbedtls_mpi x, y;
+
+	assert_equal(mbedtls_arena_init(&arena, &arena_pool, ARENA_SIZE,
+					K_NO_WAIT), 0, "no arena memory");
+	assert_equal(mbedtls_arena_enter(&arena), 0, "arena not entered");
+
+	mbedtls_mpi_init(&x);
+	mbedtls_mpi_init(&y);
+	assert_equal(mbedtls_mpi_lset(&x, 3), 0, "lset failed");
+	assert_equal(mbedtls_mpi_shift_l(&x, 1000), 0, "shift failed");
+	assert_equal(mbedtls_mpi_mul_mpi(&y, &x, &x), 0, "mul failed");
+
+	/* Peak of the phase after the clear only */
+	mbedtls_arena_stats_get(&arena, &stats, 1);
+	assert_true(stats.bytes_used > 0, "mbed TLS not using the arena");
+	mbedtls_arena_stats_get(&arena, &stats, 0);
+	assert_equal(stats.max_bytes_used, stats.bytes_used, "peak not cleared");
+
+	mbedtls_mpi_free(&x);
+	mbedtls_mpi_free(&y);
+
+	mbedtls_arena_stats_get(&arena, &stats, 0);
+	assert_equal(stats.bytes_used, 0, "memory leaked");
+
+	/* Dropping everything at once */
+	assert_not_null(mbedtls_calloc(1, 100), "allocation failed");
+	mbedtls_arena_reset(&arena);
+	mbedtls_arena_stats_get(&arena, &stats, 0);
+	assert_equal(stats.bytes_used, 0, "arena not reset");
+
+	mbedtls_arena_enter(NULL);
+	mbedtls_arena_release(&arena);
+}
+
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(mbedtls_arena_test,
+			 ztest_unit_test(test_bounded),
+			 ztest_unit_test(test_mbedtls_usage));
+
+	ztest_run_test_suite(mbedtls_arena_test);
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_driver_crypto
+ * @{
+ * @defgroup t_crypto_tinycrypt_shim test_crypto_tinycrypt_shim
+ * @brief TestPurpose: verify the crypto driver API on the TinyCrypt
+ * software device, with the FIPS-197, SP 800-38A and RFC 3610 vectors
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <crypto/cipher.h>
+#include <crypto/hash.h>
+#include <crypto/ecc.h>
+
+static const uint8_t aes_key[16] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static const uint8_t ecb_plain[16] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+
+static const uint8_t ecb_cipher[16] = {
+	0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+	0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+static const uint8_t ctr_key[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+static const uint8_t ctr_plain[32] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+	0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+	0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51
+};
+
+static const uint8_t ctr_cipher[32] = {
+	0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26,
+	0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+	0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff,
+	0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff
+};
+
+static const uint8_t ccm_key[16] = {
+	0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+	0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf
+};
+
+static uint8_t ccm_nonce[13] = {
+	0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0,
+	0xa1, 0xa2, 0xa3, 0xa4, 0xa5
+};
+
+static const uint8_t ccm_hdr[8] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07
+};
+
+static const uint8_t ccm_plain[23] = {
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+	0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e
+};
+
+/* Ciphertext followed by the 8 byte tag */
+static const uint8_t ccm_cipher[31] = {
+	0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2,
+	0xf0, 0x66, 0xd0, 0xc2, 0xc0, 0xf9, 0x89, 0x80,
+	0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84, 0x17,
+	0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0
+};
+
+static const uint8_t sha256_abc[32] = {
+	0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+	0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+	0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+	0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+};
+
+static struct device *crypto_dev(void)
+{
+	struct device *dev;
+
+	dev = device_get_binding(CONFIG_CRYPTO_TINYCRYPT_SHIM_DRV_NAME);
+	assert_not_null(dev, "no crypto device");
+
+	return dev;
+}
+
+static void cipher_session(struct device *dev, struct cipher_ctx *ctx,
+			   const uint8_t *key, enum cipher_mode mode,
+			   enum cipher_op op)
+{
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->key = key;
+	ctx->keylen = 16;
+	ctx->mode = mode;
+	ctx->op = op;
+	ctx->tag_len = 8;
+	ctx->nonce_len = sizeof(ccm_nonce);
+
+	assert_equal(cipher_begin_session(dev, ctx), 0, "no session");
+}
+
+void test_caps(void)
+{
+	uint32_t caps = crypto_query_hwcaps(crypto_dev());
+
+	assert_true(caps & CRYPTO_CAP_SYNC_OPS, "no synchronous ops");
+	assert_true(caps & CRYPTO_CAP_AES_CCM, "no CCM");
+	assert_true(caps & CRYPTO_CAP_SHA256, "no SHA-256");
+	assert_true(caps & CRYPTO_CAP_ECC_P256, "no P-256");
+}
+
+void test_ecb(void)
+{
+	struct device *dev = crypto_dev();
+	struct cipher_ctx ctx;
+	struct cipher_pkt pkt = { 0 };
+	uint8_t out[16];
+
+	cipher_session(dev, &ctx, aes_key, CRYPTO_CIPHER_MODE_ECB,
+		       CRYPTO_CIPHER_OP_ENCRYPT);
+	pkt.in_buf = ecb_plain;
+	pkt.in_len = sizeof(ecb_plain);
+	pkt.out_buf = out;
+	pkt.out_buf_max = sizeof(out);
+	assert_equal(cipher_op(&ctx, &pkt), 0, "encryption failed");
+	assert_equal(pkt.out_len, 16, "wrong length");
+	assert_true(!memcmp(out, ecb_cipher, sizeof(out)), "wrong ciphertext");
+
+	/* Only whole blocks */
+	pkt.in_len = 15;
+	assert_equal(cipher_op(&ctx, &pkt), -EINVAL, "partial block taken");
+	cipher_free_session(dev, &ctx);
+
+	cipher_session(dev, &ctx, aes_key, CRYPTO_CIPHER_MODE_ECB,
+		       CRYPTO_CIPHER_OP_DECRYPT);
+	pkt.in_buf = out;
+	pkt.in_len = sizeof(out);
+	assert_equal(cipher_op(&ctx, &pkt), 0, "decryption failed");
+	assert_true(!memcmp(out, ecb_plain, sizeof(out)), "wrong plaintext");
+	cipher_free_session(dev, &ctx);
+}
+
+void test_ctr(void)
+{
+	struct device *dev = crypto_dev();
+	uint8_t iv[16] = {
+		0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+		0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+	};
+	struct cipher_pkt pkts[2];
+	struct cipher_ctx ctx;
+	uint8_t out[32];
+	int i;
+
+	cipher_session(dev, &ctx, ctr_key, CRYPTO_CIPHER_MODE_CTR,
+		       CRYPTO_CIPHER_OP_ENCRYPT);
+
+	/* The second packet continues the counter of the first one */
+	memset(pkts, 0, sizeof(pkts));
+	for (i = 0; i < 2; i++) {
+		pkts[i].in_buf = &ctr_plain[16 * i];
+		pkts[i].in_len = 16;
+		pkts[i].out_buf = &out[16 * i];
+		pkts[i].out_buf_max = 16;
+		pkts[i].iv = iv;
+	}
+
+	assert_equal(cipher_batch(&ctx, pkts, 2), 0, "encryption failed");
+	assert_true(!memcmp(out, ctr_cipher, sizeof(out)), "wrong ciphertext");
+	assert_equal(iv[15], 0x01, "counter not incremented");
+	cipher_free_session(dev, &ctx);
+}
+
+void test_ccm(void)
+{
+	struct device *dev = crypto_dev();
+	struct cipher_pkt pkt = { 0 };
+	struct cipher_ctx ctx;
+	uint8_t out[31];
+
+	cipher_session(dev, &ctx, ccm_key, CRYPTO_CIPHER_MODE_CCM,
+		       CRYPTO_CIPHER_OP_ENCRYPT);
+	pkt.in_buf = ccm_plain;
+	pkt.in_len = sizeof(ccm_plain);
+	pkt.out_buf = out;
+	pkt.out_buf_max = sizeof(out);
+	pkt.iv = ccm_nonce;
+	pkt.ad = ccm_hdr;
+	pkt.ad_len = sizeof(ccm_hdr);
+	assert_equal(cipher_op(&ctx, &pkt), 0, "encryption failed");
+	assert_equal(pkt.out_len, sizeof(ccm_cipher), "wrong length");
+	assert_true(!memcmp(out, ccm_cipher, sizeof(out)), "wrong ciphertext");
+	cipher_free_session(dev, &ctx);
+
+	cipher_session(dev, &ctx, ccm_key, CRYPTO_CIPHER_MODE_CCM,
+		       CRYPTO_CIPHER_OP_DECRYPT);
+	pkt.in_buf = ccm_cipher;
+	pkt.in_len = sizeof(ccm_cipher);
+	assert_equal(cipher_op(&ctx, &pkt), 0, "decryption failed");
+	assert_equal(pkt.out_len, sizeof(ccm_plain), "wrong length");
+	assert_true(!memcmp(out, ccm_plain, sizeof(ccm_plain)),
+		    "wrong plaintext");
+
+	/* Authentication of the header */
+	pkt.ad_len--;
+	assert_equal(cipher_op(&ctx, &pkt), -EBADMSG, "tag not checked");
+	cipher_free_session(dev, &ctx);
+}
+
+static int async_status;
+static int async_calls;
+
+static void async_cb(struct cipher_pkt *pkt, int status)
+{
+	assert_equal(pkt->user_data, &async_calls, "wrong packet");
+	async_status = status;
+	async_calls++;
+}
+
+void test_async(void)
+{
+	struct device *dev = crypto_dev();
+	struct cipher_pkt pkt = { 0 };
+	struct cipher_ctx ctx;
+	uint8_t out[16];
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.key = aes_key;
+	ctx.keylen = 16;
+	ctx.mode = CRYPTO_CIPHER_MODE_ECB;
+	ctx.op = CRYPTO_CIPHER_OP_ENCRYPT;
+	ctx.cb = async_cb;
+	assert_equal(cipher_begin_session(dev, &ctx), 0, "no session");
+
+	pkt.in_buf = ecb_plain;
+	pkt.in_len = sizeof(ecb_plain);
+	pkt.out_buf = out;
+	pkt.out_buf_max = sizeof(out);
+	pkt.user_data = &async_calls;
+	async_status = -1;
+	assert_equal(cipher_op(&ctx, &pkt), 0, "not queued");
+
+	/* The software device completes before returning */
+	assert_equal(async_calls, 1, "no callback");
+	assert_equal(async_status, 0, "encryption failed");
+	assert_true(!memcmp(out, ecb_cipher, sizeof(out)), "wrong ciphertext");
+	cipher_free_session(dev, &ctx);
+}
+
+void test_sessions(void)
+{
+	struct cipher_ctx ctx[CONFIG_CRYPTO_TINYCRYPT_SHIM_MAX_SESSION + 1];
+	struct device *dev = crypto_dev();
+	int i;
+
+	for (i = 0; i < CONFIG_CRYPTO_TINYCRYPT_SHIM_MAX_SESSION; i++) {
+		cipher_session(dev, &ctx[i], aes_key, CRYPTO_CIPHER_MODE_ECB,
+			       CRYPTO_CIPHER_OP_ENCRYPT);
+	}
+
+	ctx[i] = ctx[0];
+	assert_equal(cipher_begin_session(dev, &ctx[i]), -ENOMEM,
+		     "too many sessions");
+
+	for (i = 0; i < CONFIG_CRYPTO_TINYCRYPT_SHIM_MAX_SESSION; i++) {
+		cipher_free_session(dev, &ctx[i]);
+	}
+}
+
+void test_sha256(void)
+{
+	struct device *dev = crypto_dev();
+	struct hash_pkt pkt = { 0 };
+	struct hash_ctx ctx = { 0 };
+	uint8_t digest[32];
+	int i;
+
+	ctx.algo = CRYPTO_HASH_ALGO_SHA256;
+	assert_equal(hash_begin_session(dev, &ctx), 0, "no session");
+
+	/* Twice, the session restarting after each digest */
+	for (i = 0; i < 2; i++) {
+		pkt.in_buf = (const uint8_t *)"a";
+		pkt.in_len = 1;
+		assert_equal(hash_update(&ctx, &pkt), 0, "update failed");
+
+		pkt.in_buf = (const uint8_t *)"bc";
+		pkt.in_len = 2;
+		pkt.out_buf = digest;
+		assert_equal(hash_compute(&ctx, &pkt), 0, "compute failed");
+		assert_true(!memcmp(digest, sha256_abc, sizeof(digest)),
+			    "wrong digest");
+	}
+
+	hash_free_session(dev, &ctx);
+}
+
+void test_ecc_p256(void)
+{
+	static uint8_t private_a[32], public_a[64], secret_a[32];
+	static uint8_t private_b[32], public_b[64], secret_b[32];
+	struct device *dev = crypto_dev();
+	struct ecc_pkt pkt = { 0 };
+
+	pkt.private_key = private_a;
+	pkt.public_key = public_a;
+	assert_equal(ecc_p256_gen_key(dev, &pkt), 0, "key A failed");
+
+	pkt.private_key = private_b;
+	pkt.public_key = public_b;
+	assert_equal(ecc_p256_gen_key(dev, &pkt), 0, "key B failed");
+
+	pkt.private_key = private_a;
+	pkt.public_key = public_b;
+	pkt.secret = secret_a;
+	assert_equal(ecc_p256_dh(dev, &pkt), 0, "secret A failed");
+
+	pkt.private_key = private_b;
+	pkt.public_key = public_a;
+	pkt.secret = secret_b;
+	assert_equal(ecc_p256_dh(dev, &pkt), 0, "secret B failed");
+
+	assert_true(!memcmp(secret_a, secret_b, sizeof(secret_a)),
+		    "secrets differ");
+
+	/* A point which is not on the curve */
+	public_a[63] ^= 1;
+	assert_equal(ecc_p256_dh(dev, &pkt), -EINVAL, "invalid key taken");
+}
+
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_crypto_tinycrypt_shim,
+			 ztest_unit_test(test_caps),
+			 ztest_unit_test(test_ecb),
+			 ztest_unit_test(test_ctr),
+			 ztest_unit_test(test_ccm),
+			 ztest_unit_test(test_async),
+			 ztest_unit_test(test_sessions),
+			 ztest_unit_test(test_sha256),
+			 ztest_unit_test(test_ecc_p256));
+	ztest_run_test_suite(test_crypto_tinycrypt_shim);
+}
@@ -0,0 +1,141 @@
+/* dma.c - DMA chained transfer test source file */
+
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+
+#include <device.h>
+#include <dma.h>
+#include <misc/printk.h>
+#include <string.h>
+
+/* in millisecond */
+#define SLEEPTIME  1000
+
+#define BLOCKS (3)
+#define RX_BUFF_SIZE (50)
+#define COPY_SIZE (1024)
+
+static const char tx_data[] = "The quick brown fox jumps over the lazy dog";
+static char rx_data[BLOCKS][RX_BUFF_SIZE] = {{ 0 } };
+
+static uint32_t copy_src[COPY_SIZE / 4];
+static uint32_t copy_dst[COPY_SIZE / 4];
+
+#define DMA_DEVICE_NAME "DMA_0"
+
+volatile uint8_t transfer_count;
+
+static void test_transfer(struct device *dev, void *data)
+{
+	transfer_count++;
+}
+
+static void test_error(struct device *dev, void *data)
+{
+	printk("DMA could not proceed, an error occurred\n");
+}
+
+static int test_chain(struct device *dma, uint32_t chan_id)
+{
+	struct dma_channel_config dma_chan_cfg = {0};
+	struct dma_block_config blocks[BLOCKS];
+	int i;
+
+	dma_chan_cfg.channel_direction = MEMORY_TO_MEMORY;
+	dma_chan_cfg.source_transfer_width = TRANS_WIDTH_8;
+	dma_chan_cfg.destination_transfer_width = TRANS_WIDTH_8;
+	dma_chan_cfg.source_burst_length = BURST_TRANS_LENGTH_1;
+	dma_chan_cfg.destination_burst_length = BURST_TRANS_LENGTH_1;
+	dma_chan_cfg.transfer_type = TRANSFER_TYPE_LIST;
+	dma_chan_cfg.dma_transfer = test_transfer;
+	dma_chan_cfg.dma_error = test_error;
+
+	if (dma_channel_config(dma, chan_id, &dma_chan_cfg)) {
+		printk("Error: configuration\n");
+		return -1;
+	}
+
+	for (i = 0; i < BLOCKS; i++) {
+		blocks[i].block_size = strlen(tx_data);
+		blocks[i].source_address = (uint32_t *)tx_data;
+		blocks[i].destination_address = (uint32_t *)rx_data[i];
+		blocks[i].next_block = i + 1 < BLOCKS ? &blocks[i + 1] : NULL;
+	}
+
+	if (dma_block_config(dma, chan_id, blocks)) {
+		printk("ERROR: block config\n");
+		return -1;
+	}
+
+	if (dma_transfer_start(dma, chan_id)) {
+		printk("ERROR: transfer start\n");
+		return -1;
+	}
+
+	k_sleep(SLEEPTIME);
+
+	/* A single callback for the whole chain */
+	if (transfer_count != 1) {
+		printk("ERROR: %u callbacks instead of 1\n", transfer_count);
+		dma_transfer_stop(dma, chan_id);
+		return -1;
+	}
+
+	for (i = 0; i < BLOCKS; i++) {
+		if (strcmp(rx_data[i], tx_data)) {
+			printk("ERROR: block %d: %s\n", i, rx_data[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int test_memcpy(struct device *dma, uint32_t chan_id)
+{
+	static struct dma_memcpy ctx;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(copy_src); i++) {
+		copy_src[i] = i * 0x01010101;
+	}
+
+	dma_memcpy_init(&ctx, dma, chan_id);
+
+	if (dma_memcpy(&ctx, copy_dst, copy_src, sizeof(copy_src))) {
+		printk("ERROR: memcpy\n");
+		return -1;
+	}
+
+	if (memcmp(copy_dst, copy_src, sizeof(copy_src))) {
+		printk("ERROR: memcpy data mismatch\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+void main(void)
+{
+	struct device *dma;
+
+	printk("DMA chained transfer started on %s\n", DMA_DEVICE_NAME);
+
+	dma = device_get_binding(DMA_DEVICE_NAME);
+	if (!dma) {
+		printk("Cannot get dma controller\n");
+		return;
+	}
+
+	if (test_chain(dma, 0) || test_memcpy(dma, 1)) {
+		printk("FAIL: DMA\n");
+		return;
+	}
+
+	printk("Finished: DMA\n");
+}
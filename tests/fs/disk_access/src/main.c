@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_disk
+ * @{
+ * @defgroup t_disk_access test_disk_access
+ * @brief TestPurpose: verify the disk registry and asynchronous requests
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <disk_access.h>
+
+#define SECTOR_SIZE 512
+#define NUM_REQ 4
+
+/* A disk recording the backend calls */
+static int num_reads;
+static uint32_t last_count;
+
+static int mock_init(struct disk_info *disk)
+{
+	return 0;
+}
+
+static int mock_status(struct disk_info *disk)
+{
+	return DISK_STATUS_OK;
+}
+
+static int mock_read(struct disk_info *disk, uint8_t *buf,
+		     uint32_t start_sector, uint32_t num_sector)
+{
+	uint32_t i;
+
+	for (i = 0; i < num_sector; i++) {
+		memset(buf + i * SECTOR_SIZE, start_sector + i, SECTOR_SIZE);
+	}
+
+	num_reads++;
+	last_count = num_sector;
+
+	return 0;
+}
+
+static int mock_write(struct disk_info *disk, const uint8_t *buf,
+		      uint32_t start_sector, uint32_t num_sector)
+{
+	return -EIO;
+}
+
+static int mock_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
+{
+	switch (cmd) {
+	case DISK_IOCTL_CTRL_SYNC:
+		return 0;
+	case DISK_IOCTL_GET_SECTOR_SIZE:
+		*(uint32_t *)buff = SECTOR_SIZE;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+static const struct disk_operations mock_ops = {
+	.init = mock_init,
+	.status = mock_status,
+	.read = mock_read,
+	.write = mock_write,
+	.ioctl = mock_ioctl,
+};
+
+static struct disk_info mock_disk = {
+	.name = "MOCK",
+	.ops = &mock_ops,
+};
+
+static uint8_t buf[NUM_REQ * SECTOR_SIZE];
+static struct disk_request reqs[NUM_REQ];
+static int results[NUM_REQ];
+static K_SEM_DEFINE(done_sem, 0, NUM_REQ);
+
+static void request_done(struct disk_request *req, int result)
+{
+	results[req - reqs] = result;
+	k_sem_give(&done_sem);
+}
+
+static void test_disk_registry(void)
+{
+	struct disk_info dup = { .name = "RAM", .ops = &mock_ops };
+	uint32_t sector_size;
+
+	/**TESTPOINT: the default disk is the registered RAM disk*/
+	assert_not_null(disk_access_get("RAM"), NULL);
+	assert_equal(disk_access_init(), 0, NULL);
+	assert_equal(disk_access_ioctl(DISK_IOCTL_GET_SECTOR_SIZE,
+				       &sector_size), 0, NULL);
+	assert_equal(sector_size, SECTOR_SIZE, NULL);
+
+	/**TESTPOINT: disk names are unique*/
+	assert_equal(disk_access_register(&dup), -EEXIST, NULL);
+
+	assert_equal(disk_access_register(&mock_disk), 0, NULL);
+	assert_equal_ptr(disk_access_get("MOCK"), &mock_disk, NULL);
+	assert_equal(disk_access_dev_init(&mock_disk), 0, NULL);
+}
+
+static void submit_reads(uint32_t first_sector, int gap)
+{
+	int i;
+
+	num_reads = 0;
+	memset(buf, 0xff, sizeof(buf));
+
+	/* queued while the disk work queue cannot run */
+	k_sched_lock();
+	for (i = 0; i < NUM_REQ; i++) {
+		reqs[i].type = DISK_REQUEST_READ;
+		reqs[i].buf = buf + i * SECTOR_SIZE;
+		reqs[i].start_sector = first_sector + i * (1 + gap);
+		reqs[i].num_sector = 1;
+		reqs[i].cb = request_done;
+		results[i] = 1;
+		assert_equal(disk_access_dev_submit(&mock_disk, &reqs[i]), 0,
+			     NULL);
+	}
+	k_sched_unlock();
+
+	for (i = 0; i < NUM_REQ; i++) {
+		assert_equal(k_sem_take(&done_sem, 100), 0, NULL);
+	}
+
+	for (i = 0; i < NUM_REQ; i++) {
+		assert_equal(results[i], 0, NULL);
+		assert_equal(buf[i * SECTOR_SIZE],
+			     (uint8_t)(first_sector + i * (1 + gap)), NULL);
+	}
+}
+
+static void test_disk_request_merge(void)
+{
+	/**TESTPOINT: consecutive reads make a single backend call*/
+	submit_reads(10, 0);
+	assert_equal(num_reads, 1, NULL);
+	assert_equal(last_count, NUM_REQ, NULL);
+
+	/**TESTPOINT: reads of scattered sectors are not merged*/
+	submit_reads(10, 1);
+	assert_equal(num_reads, NUM_REQ, NULL);
+	assert_equal(last_count, 1, NULL);
+}
+
+static void test_disk_request_error(void)
+{
+	struct disk_request req = {
+		.type = DISK_REQUEST_WRITE,
+		.buf = buf,
+		.start_sector = 0,
+		.num_sector = 1,
+		.cb = request_done,
+	};
+
+	/**TESTPOINT: requests without callback are rejected*/
+	req.cb = NULL;
+	assert_equal(disk_access_dev_submit(&mock_disk, &req), -EINVAL, NULL);
+
+	/**TESTPOINT: backend errors reach the callback*/
+	req.cb = request_done;
+	memcpy(&reqs[0], &req, sizeof(req));
+	assert_equal(disk_access_dev_submit(&mock_disk, &reqs[0]), 0, NULL);
+	assert_equal(k_sem_take(&done_sem, 100), 0, NULL);
+	assert_equal(results[0], -EIO, NULL);
+
+	assert_equal(disk_access_unregister(&mock_disk), 0, NULL);
+	assert_is_null(disk_access_get("MOCK"), NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(disk_access_test,
+		ztest_unit_test(test_disk_registry),
+		ztest_unit_test(test_disk_request_merge),
+		ztest_unit_test(test_disk_request_error));
+	ztest_run_test_suite(disk_access_test);
+}
@@ -506,7 +506,7 @@ static void vol_tests(void)
 	struct fs_statvfs stat;
 	int res;
 
-	res = fs_statvfs(&stat);
+	res = fs_statvfs("/", &stat);
 	if (res) {
 		printk("Error getting volume stats [%d]\n", res);
 		return;
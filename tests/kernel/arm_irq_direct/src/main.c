@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Connect ISRs directly in the vector table with IRQ_DIRECT_CONNECT(), next
+ * to ISRs connected in the software table, and verify they run: a direct
+ * ISR pending while interrupts are locked runs once they are unlocked, a
+ * zero-latency one runs at once.
+ */
+
+#if !defined(CONFIG_CPU_CORTEX_M)
+  #error project can only run on Cortex-M
+#endif
+
+#include <ztest.h>
+#include <irq.h>
+#include <arch/arm/cortex_m/cmsis.h>
+
+#define IRQ_SW		0
+#define IRQ_DIRECT	1
+#define IRQ_ZLI		2
+
+#define IRQ_PRIO	1
+
+static struct k_sem sw_sem;
+static struct k_sem direct_sem;
+static volatile int zli_count;
+
+static void irq_trigger(unsigned int irq)
+{
+#if defined(CONFIG_SOC_TI_LM3S6965_QEMU)
+	/* the QEMU does not simulate the STIR register: this is a workaround */
+	NVIC_SetPendingIRQ(irq);
+#else
+	NVIC->STIR = irq;
+#endif
+}
+
+static void sw_isr(void *arg)
+{
+	k_sem_give(arg);
+}
+
+ISR_DIRECT_DECLARE(direct_isr)
+{
+	k_sem_give(&direct_sem);
+	ISR_DIRECT_PM();
+
+	/* a thread may pend on the semaphore */
+	return 1;
+}
+
+/* not known to the kernel: no kernel API allowed */
+static void zli_isr(void)
+{
+	zli_count++;
+}
+
+void test_irq_direct(void)
+{
+	unsigned int key;
+
+	k_sem_init(&sw_sem, 0, UINT_MAX);
+	k_sem_init(&direct_sem, 0, UINT_MAX);
+
+	IRQ_CONNECT(IRQ_SW, IRQ_PRIO, sw_isr, &sw_sem, 0);
+	IRQ_DIRECT_CONNECT(IRQ_DIRECT, IRQ_PRIO, direct_isr, 0);
+	irq_enable(IRQ_SW);
+	irq_enable(IRQ_DIRECT);
+
+	/** TESTPOINT: both kinds of ISRs run */
+	irq_trigger(IRQ_SW);
+	irq_trigger(IRQ_DIRECT);
+	assert_equal(k_sem_take(&sw_sem, 100), 0, NULL);
+	assert_equal(k_sem_take(&direct_sem, 100), 0, NULL);
+
+	/** TESTPOINT: a direct ISR is masked by irq_lock() */
+	key = irq_lock();
+	irq_trigger(IRQ_DIRECT);
+	assert_equal(k_sem_count_get(&direct_sem), 0, NULL);
+	irq_unlock(key);
+	assert_equal(k_sem_take(&direct_sem, 100), 0, NULL);
+
+	irq_disable(IRQ_SW);
+	irq_disable(IRQ_DIRECT);
+}
+
+void test_irq_direct_zero_latency(void)
+{
+	unsigned int key;
+	int count;
+
+	IRQ_DIRECT_CONNECT(IRQ_ZLI, 0, zli_isr, IRQ_ZERO_LATENCY);
+	irq_enable(IRQ_ZLI);
+
+	/** TESTPOINT: a zero-latency ISR is not masked by irq_lock() */
+	key = irq_lock();
+	count = zli_count;
+	irq_trigger(IRQ_ZLI);
+	__DSB();
+	__ISB();
+	assert_equal(zli_count, count + 1, NULL);
+	irq_unlock(key);
+
+	irq_disable(IRQ_ZLI);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(irq_direct_test,
+			 ztest_unit_test(test_irq_direct),
+			 ztest_unit_test(test_irq_direct_zero_latency));
+
+	ztest_run_test_suite(irq_direct_test);
+}
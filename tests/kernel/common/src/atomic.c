@@ -128,4 +128,50 @@ void atomic_test(void)
 		assert_true(target == (orig | (1 << i)), "atomic_set_bit");
 	}
 
+	/* atomic_find_and_set_bit() */
+	{
+		ATOMIC_DEFINE(bitmap, 40);
+
+		bitmap[0] = 0xFFFFFFFF;
+		bitmap[1] = 0x5;
+		assert_true(atomic_find_and_set_bit(bitmap, 40) == 33,
+			    "atomic_find_and_set_bit");
+		assert_true(bitmap[1] == 0x7, "atomic_find_and_set_bit");
+		assert_true(atomic_find_and_set_bit(bitmap, 35) == -1,
+			    "atomic_find_and_set_bit");
+		assert_true(atomic_find_and_set_bit(bitmap, 40) == 35,
+			    "atomic_find_and_set_bit");
+		assert_true(bitmap[1] == 0xF, "atomic_find_and_set_bit");
+	}
+
+	/* atomic64_*() */
+	{
+		atomic64_t target64 = 0x00000001FFFFFFFFLL;
+
+		assert_true(atomic64_inc(&target64) == 0x00000001FFFFFFFFLL,
+			    "atomic64_inc");
+		assert_true(atomic64_get(&target64) == 0x0000000200000000LL,
+			    "atomic64_get");
+		assert_true(atomic64_dec(&target64) == 0x0000000200000000LL,
+			    "atomic64_dec");
+		assert_true(atomic64_add(&target64, 0x100000001LL) ==
+			    0x00000001FFFFFFFFLL, "atomic64_add");
+		assert_true(atomic64_sub(&target64, 2) == 0x0000000300000000LL,
+			    "atomic64_sub");
+		assert_true(atomic64_cas(&target64, 0, 1) == 0,
+			    "atomic64_cas");
+		assert_true(atomic64_cas(&target64, 0x00000002FFFFFFFELL,
+					 0x1000000000000000LL) == 1,
+			    "atomic64_cas");
+		assert_true(atomic64_or(&target64, 0xF0) ==
+			    0x1000000000000000LL, "atomic64_or");
+		assert_true(atomic64_and(&target64, 0xFFFFFFFF) ==
+			    0x10000000000000F0LL, "atomic64_and");
+		assert_true(atomic64_xor(&target64, 0x1000000000000000LL) ==
+			    0xF0, "atomic64_xor");
+		assert_true(atomic64_set(&target64, 5) == 0x10000000000000F0LL,
+			    "atomic64_set");
+		assert_true(atomic64_clear(&target64) == 5, "atomic64_clear");
+		assert_true(target64 == 0, "atomic64_clear");
+	}
 }
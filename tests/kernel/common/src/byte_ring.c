@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+#include <misc/byte_ring.h>
+
+#define RING_POW 5
+#define RING_SIZE (1 << RING_POW)
+
+SYS_BYTE_RING_DECLARE_POW2(byte_ring, RING_POW);
+SYS_BYTE_RING_MP_DECLARE_POW2(byte_ring_mp, RING_POW);
+
+static const uint8_t pattern[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+void byte_ring_test(void)
+{
+	uint8_t getdata[RING_SIZE];
+	uint8_t *area;
+	uint32_t n;
+
+	assert_true(sys_byte_ring_is_empty(&byte_ring), "not empty");
+
+	/* all of the data area can be used */
+	n = sys_byte_ring_put(&byte_ring, pattern, sizeof(pattern));
+	assert_equal(n, RING_SIZE, "wrong number of bytes written");
+	assert_equal(sys_byte_ring_space_get(&byte_ring), 0, "not full");
+	assert_equal(sys_byte_ring_put(&byte_ring, pattern, 1), 0,
+		     "wrote to a full ring");
+
+	n = sys_byte_ring_get(&byte_ring, getdata, 10);
+	assert_equal(n, 10, "wrong number of bytes read");
+	assert_true(memcmp(getdata, pattern, 10) == 0, "data corrupted");
+
+	/* claims are contiguous, so they stop at the end of the data area */
+	n = sys_byte_ring_get_claim(&byte_ring, &area, RING_SIZE);
+	assert_equal(n, RING_SIZE - 10, "wrong claim size");
+	assert_true(memcmp(area, pattern + 10, n) == 0, "data corrupted");
+	sys_byte_ring_get_finish(&byte_ring, 4);
+	assert_equal(sys_byte_ring_used_get(&byte_ring), RING_SIZE - 14,
+		     "partial finish not accounted for");
+
+	n = sys_byte_ring_put_claim(&byte_ring, &area, RING_SIZE);
+	assert_equal(n, 14, "wrong claim size");
+	assert_equal(area, byte_ring.buf, "claim does not wrap around");
+	memcpy(area, pattern, n);
+	sys_byte_ring_put_finish(&byte_ring, n);
+
+	/* copying reads go across the end of the data area */
+	n = sys_byte_ring_get(&byte_ring, getdata, sizeof(getdata));
+	assert_equal(n, RING_SIZE, "wrong number of bytes read");
+	assert_true(memcmp(getdata, pattern + 14, RING_SIZE - 14) == 0,
+		    "data corrupted");
+	assert_true(memcmp(getdata + RING_SIZE - 14, pattern, 14) == 0,
+		    "data corrupted");
+	assert_true(sys_byte_ring_is_empty(&byte_ring), "not empty");
+}
+
+static void mp_isr_put(void *arg)
+{
+	assert_equal(sys_byte_ring_mp_put(&byte_ring_mp, arg, 3), 0,
+		     "put from ISR failed");
+}
+
+void byte_ring_mp_test(void)
+{
+	uint8_t getdata[RING_SIZE];
+	uint8_t *area;
+	int len;
+
+	assert_equal(sys_byte_ring_mp_get(&byte_ring_mp, getdata,
+					  sizeof(getdata)), -EAGAIN,
+		     "got a record from an empty ring");
+	assert_equal(sys_byte_ring_mp_put(&byte_ring_mp, pattern,
+					  RING_SIZE / 2), -EMSGSIZE,
+		     "accepted a record that cannot fit");
+
+	/* a record claimed first hides the ones committed after it */
+	assert_equal(sys_byte_ring_mp_put_claim(&byte_ring_mp, &area, 5), 0,
+		     "claim failed");
+	irq_offload(mp_isr_put, (void *)(pattern + 5));
+	assert_equal(sys_byte_ring_mp_get(&byte_ring_mp, getdata,
+					  sizeof(getdata)), -EAGAIN,
+		     "got a record before the first one was committed");
+
+	memcpy(area, pattern, 5);
+	sys_byte_ring_mp_put_finish(&byte_ring_mp, area);
+
+	/* records are read back whole and in order */
+	assert_equal(sys_byte_ring_mp_get(&byte_ring_mp, getdata, 4),
+		     -EMSGSIZE, "record was truncated");
+	len = sys_byte_ring_mp_get(&byte_ring_mp, getdata, sizeof(getdata));
+	assert_equal(len, 5, "wrong record size");
+	assert_true(memcmp(getdata, pattern, 5) == 0, "data corrupted");
+	len = sys_byte_ring_mp_get_claim(&byte_ring_mp, &area);
+	assert_equal(len, 3, "wrong record size");
+	assert_true(memcmp(area, pattern + 5, 3) == 0, "data corrupted");
+	sys_byte_ring_mp_get_finish(&byte_ring_mp);
+
+	/* 4 bytes left before the end: the next record is padded to wrap */
+	assert_equal(sys_byte_ring_mp_put(&byte_ring_mp, pattern, 4), 0,
+		     "put failed");
+	assert_equal(sys_byte_ring_mp_put(&byte_ring_mp, pattern + 8, 11), 0,
+		     "put failed");
+	assert_equal(sys_byte_ring_mp_get(&byte_ring_mp, getdata,
+					  sizeof(getdata)), 4,
+		     "wrong record size");
+	len = sys_byte_ring_mp_get_claim(&byte_ring_mp, &area);
+	assert_equal(len, 11, "wrong record size");
+	assert_equal(area, (uint8_t *)byte_ring_mp.buf + sizeof(uint32_t),
+		     "record wraps around");
+	assert_true(memcmp(area, pattern + 8, 11) == 0, "data corrupted");
+	sys_byte_ring_mp_get_finish(&byte_ring_mp);
+
+	assert_equal(sys_byte_ring_mp_get(&byte_ring_mp, getdata,
+					  sizeof(getdata)), -EAGAIN,
+		     "ring not empty");
+}
@@ -13,8 +13,11 @@ extern void byteorder_test_mem_swap(void);
 extern void atomic_test(void);
 extern void bitfield_test(void);
 extern void intmath_test(void);
+extern void mem_test(void);
 extern void printk_test(void);
 extern void ring_buffer_test(void);
+extern void byte_ring_test(void);
+extern void byte_ring_mp_test(void);
 extern void slist_test(void);
 extern void rand32_test(void);
 
@@ -28,9 +31,12 @@ void test_main(void)
 			 ztest_unit_test(printk_test),
 #endif
 			 ztest_unit_test(ring_buffer_test),
+			 ztest_unit_test(byte_ring_test),
+			 ztest_unit_test(byte_ring_mp_test),
 			 ztest_unit_test(slist_test),
 			 ztest_unit_test(rand32_test),
-			 ztest_unit_test(intmath_test)
+			 ztest_unit_test(intmath_test),
+			 ztest_unit_test(mem_test)
 			 );
 
 	ztest_run_test_suite(common_test);
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#define BUF_SIZE 256
+#define MAX_OFFSET 8
+
+static unsigned char src[BUF_SIZE];
+static unsigned char dst[BUF_SIZE];
+static unsigned char ref[BUF_SIZE];
+
+static void fill(void)
+{
+	int i;
+
+	for (i = 0; i < BUF_SIZE; i++) {
+		src[i] = i;
+		dst[i] = ~i;
+		ref[i] = ~i;
+	}
+}
+
+/* Every alignment combination, lengths around the unrolled loop sizes */
+void mem_test(void)
+{
+	static const size_t lengths[] = { 0, 1, 3, 4, 15, 16, 17, 31, 32, 33,
+					  63, 64, 65, 127, 200 };
+	size_t n, i, k;
+	int so, d;
+
+	for (k = 0; k < ARRAY_SIZE(lengths); k++) {
+		n = lengths[k];
+
+		for (so = 0; so < MAX_OFFSET; so++) {
+			for (d = 0; d < MAX_OFFSET; d++) {
+				fill();
+				for (i = 0; i < n; i++) {
+					ref[d + i] = src[so + i];
+				}
+				memcpy(dst + d, src + so, n);
+				assert_true(!memcmp(dst, ref, BUF_SIZE),
+					    "memcpy failed");
+
+				fill();
+				for (i = 0; i < n; i++) {
+					ref[d + i] = 0xa5;
+				}
+				memset(dst + d, 0xa5, n);
+				assert_true(!memcmp(dst, ref, BUF_SIZE),
+					    "memset failed");
+
+				/* Overlapping, in both directions */
+				fill();
+				for (i = 0; i < n; i++) {
+					ref[d + i] = ~(so + i);
+				}
+				memmove(dst + d, dst + so, n);
+				assert_true(!memcmp(dst, ref, BUF_SIZE),
+					    "memmove failed");
+			}
+		}
+	}
+}
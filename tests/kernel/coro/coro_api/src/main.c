@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_coro
+ * @{
+ * @defgroup t_coro_api test_coro_api
+ * @}
+ */
+
+#include <ztest.h>
+extern void test_coro_setup(void);
+extern void test_coro_yield(void);
+extern void test_coro_sem(void);
+extern void test_coro_sem_isr(void);
+extern void test_coro_sem_timeout(void);
+extern void test_coro_fifo(void);
+extern void test_coro_sleep(void);
+extern void test_coro_many(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	test_coro_setup();
+
+	ztest_test_suite(test_coro_api,
+			 ztest_unit_test(test_coro_yield),
+			 ztest_unit_test(test_coro_sem),
+			 ztest_unit_test(test_coro_sem_isr),
+			 ztest_unit_test(test_coro_sem_timeout),
+			 ztest_unit_test(test_coro_fifo),
+			 ztest_unit_test(test_coro_sleep),
+			 ztest_unit_test(test_coro_many));
+	ztest_run_test_suite(test_coro_api);
+}
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_coro_api
+ * @{
+ * @defgroup t_coro_api_basic test_coro_api_basic
+ * @brief TestPurpose: verify zephyr coroutine apis
+ * - API coverage
+ *   -# k_coro_init k_coro_start
+ *   -# K_CORO_YIELD K_CORO_SLEEP K_CORO_SEM_TAKE K_CORO_FIFO_GET
+ * @}
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+
+#define STACK_SIZE 1024
+#define TIMEOUT 100
+#define NUM_YIELDS 3
+#define NUM_FIFO_ITEMS 2
+#define NUM_COROS 8
+
+/* higher priority than the ztest thread, so each wait is handled at once */
+#define WORK_Q_PRIO (-2)
+
+struct test_coro {
+	struct k_coro coro;
+	struct k_sem *sem;
+	struct k_fifo *fifo;
+	int32_t timeout;
+	int rc;
+	int count;
+	void *data[NUM_FIFO_ITEMS];
+	uint32_t start;
+};
+
+struct fifo_item {
+	void *private;
+	uint32_t value;
+};
+
+static char __noinit __stack work_q_stack[STACK_SIZE];
+static struct k_work_q work_q;
+
+K_SEM_DEFINE(done_sem, 0, NUM_COROS);
+
+static struct test_coro tcoro;
+static struct test_coro many[NUM_COROS];
+static struct k_sem many_sems[NUM_COROS];
+static struct k_sem sem;
+static struct k_fifo fifo;
+static struct fifo_item items[NUM_FIFO_ITEMS];
+
+void test_coro_setup(void)
+{
+	k_work_q_start(&work_q, work_q_stack, STACK_SIZE, WORK_Q_PRIO);
+}
+
+static void wait_done(void)
+{
+	assert_equal(k_sem_take(&done_sem, TIMEOUT), 0, "");
+}
+
+static void assert_not_done(void)
+{
+	assert_equal(k_sem_take(&done_sem, K_NO_WAIT), -EBUSY, "");
+}
+
+/* test cases */
+
+static struct k_work other_work;
+static int other_work_ran;
+
+static void other_work_handler(struct k_work *work)
+{
+	other_work_ran = tcoro.count;
+}
+
+static int yield_entry(struct k_coro *coro)
+{
+	struct test_coro *t = CONTAINER_OF(coro, struct test_coro, coro);
+
+	K_CORO_BEGIN(coro);
+
+	for (t->count = 0; t->count < NUM_YIELDS; t->count++) {
+		if (t->count == 1) {
+			k_work_submit_to_queue(&work_q, &other_work);
+		}
+		K_CORO_YIELD(coro);
+	}
+
+	k_sem_give(&done_sem);
+
+	K_CORO_END(coro);
+}
+
+void test_coro_yield(void)
+{
+	k_work_init(&other_work, other_work_handler);
+	other_work_ran = -1;
+
+	k_coro_init(&tcoro.coro, yield_entry);
+	k_coro_start(&tcoro.coro, &work_q);
+
+	/**TESTPOINT: the coroutine resumes after each yield, then exits */
+	wait_done();
+	assert_equal(tcoro.count, NUM_YIELDS, "");
+	assert_equal(tcoro.coro.resume, 0, "");
+
+	/**TESTPOINT: other work items run while the coroutine yields */
+	assert_equal(other_work_ran, 1, "");
+}
+
+static int sem_entry(struct k_coro *coro)
+{
+	struct test_coro *t = CONTAINER_OF(coro, struct test_coro, coro);
+
+	K_CORO_BEGIN(coro);
+
+	K_CORO_SEM_TAKE(coro, t->sem, t->timeout, t->rc);
+
+	k_sem_give(&done_sem);
+
+	K_CORO_END(coro);
+}
+
+static void start_sem_coro(int32_t timeout)
+{
+	k_sem_init(&sem, 0, 1);
+
+	tcoro.sem = &sem;
+	tcoro.timeout = timeout;
+	tcoro.rc = 1;
+
+	k_coro_init(&tcoro.coro, sem_entry);
+	k_coro_start(&tcoro.coro, &work_q);
+}
+
+void test_coro_sem(void)
+{
+	start_sem_coro(K_FOREVER);
+
+	/**TESTPOINT: the coroutine waits without blocking its workqueue */
+	k_sleep(TIMEOUT);
+	assert_not_done();
+	assert_equal(tcoro.coro.waiting, 1, "");
+	assert_not_null(sem.poll_event, "");
+
+	/**TESTPOINT: giving the semaphore resumes the coroutine */
+	k_sem_give(&sem);
+	wait_done();
+	assert_equal(tcoro.rc, 0, "");
+	assert_equal(k_sem_count_get(&sem), 0, "");
+	assert_equal(sem.poll_event, NULL, "");
+
+	/**TESTPOINT: semaphore already available */
+	start_sem_coro(K_NO_WAIT);
+	k_sem_give(&sem);
+	wait_done();
+	assert_equal(tcoro.rc, 0, "");
+
+	/**TESTPOINT: semaphore not available, no waiting */
+	start_sem_coro(K_NO_WAIT);
+	wait_done();
+	assert_equal(tcoro.rc, -EBUSY, "");
+}
+
+static void isr_give(void *p)
+{
+	k_sem_give((struct k_sem *)p);
+}
+
+void test_coro_sem_isr(void)
+{
+	start_sem_coro(K_FOREVER);
+	k_sleep(TIMEOUT);
+	assert_not_done();
+
+	/**TESTPOINT: giving the semaphore from an ISR resumes the coroutine */
+	irq_offload(isr_give, &sem);
+	wait_done();
+	assert_equal(tcoro.rc, 0, "");
+}
+
+void test_coro_sem_timeout(void)
+{
+	start_sem_coro(TIMEOUT);
+
+	/**TESTPOINT: the wait times out */
+	k_sleep(TIMEOUT / 2);
+	assert_not_done();
+	wait_done();
+	assert_equal(tcoro.rc, -EAGAIN, "");
+
+	/**TESTPOINT: the registration is cleared after timing out */
+	assert_equal(sem.poll_event, NULL, "");
+	assert_equal(tcoro.coro.waiting, 0, "");
+
+	/**TESTPOINT: the timeout is cancelled when the semaphore is given */
+	start_sem_coro(TIMEOUT);
+	k_sem_give(&sem);
+	wait_done();
+	assert_equal(tcoro.rc, 0, "");
+	assert_equal(tcoro.coro.timeout.delta_ticks_from_prev, _INACTIVE, "");
+}
+
+static int fifo_entry(struct k_coro *coro)
+{
+	struct test_coro *t = CONTAINER_OF(coro, struct test_coro, coro);
+
+	K_CORO_BEGIN(coro);
+
+	for (t->count = 0; t->count < NUM_FIFO_ITEMS; t->count++) {
+		K_CORO_FIFO_GET(coro, t->fifo, K_FOREVER, t->data[t->count]);
+	}
+
+	K_CORO_FIFO_GET(coro, t->fifo, TIMEOUT, t->data[0]);
+
+	k_sem_give(&done_sem);
+
+	K_CORO_END(coro);
+}
+
+void test_coro_fifo(void)
+{
+	k_fifo_init(&fifo);
+	tcoro.fifo = &fifo;
+
+	k_coro_init(&tcoro.coro, fifo_entry);
+	k_coro_start(&tcoro.coro, &work_q);
+
+	/**TESTPOINT: each item put resumes the coroutine */
+	for (int i = 0; i < NUM_FIFO_ITEMS; i++) {
+		k_sleep(TIMEOUT / 2);
+		assert_equal(tcoro.count, i, "");
+		items[i].value = i;
+		k_fifo_put(&fifo, &items[i]);
+	}
+
+	/**TESTPOINT: getting an item times out */
+	wait_done();
+	assert_equal(tcoro.data[0], NULL, "");
+	assert_equal(tcoro.data[1], &items[1], "");
+	assert_equal(fifo._queue.poll_event, NULL, "");
+}
+
+static int sleep_entry(struct k_coro *coro)
+{
+	struct test_coro *t = CONTAINER_OF(coro, struct test_coro, coro);
+
+	K_CORO_BEGIN(coro);
+
+	t->start = k_uptime_get_32();
+	K_CORO_SLEEP(coro, TIMEOUT / 2);
+	t->rc = k_uptime_get_32() - t->start;
+
+	k_sem_give(&done_sem);
+
+	K_CORO_END(coro);
+}
+
+void test_coro_sleep(void)
+{
+	k_coro_init(&tcoro.coro, sleep_entry);
+	k_coro_start(&tcoro.coro, &work_q);
+
+	/**TESTPOINT: the coroutine sleeps for at least the duration given */
+	wait_done();
+	assert_true(tcoro.rc >= TIMEOUT / 2, "");
+}
+
+void test_coro_many(void)
+{
+	for (int i = 0; i < NUM_COROS; i++) {
+		k_sem_init(&many_sems[i], 0, 1);
+		many[i].sem = &many_sems[i];
+		many[i].timeout = K_FOREVER;
+		many[i].rc = 1;
+		k_coro_init(&many[i].coro, sem_entry);
+		k_coro_start(&many[i].coro, &work_q);
+	}
+
+	/**TESTPOINT: many coroutines wait concurrently on one workqueue */
+	k_sleep(TIMEOUT / 2);
+	assert_not_done();
+
+	for (int i = NUM_COROS - 1; i >= 0; i--) {
+		k_sem_give(&many_sems[i]);
+	}
+
+	for (int i = 0; i < NUM_COROS; i++) {
+		wait_done();
+		assert_equal(many[i].rc, 0, "");
+	}
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_device
+ * @{
+ * @defgroup t_device_init_async test_device_init_async
+ * @}
+ */
+
+#include <ztest.h>
+extern void test_device_init_all_done(void);
+extern void test_device_init_concurrent(void);
+extern void test_device_init_dependencies(void);
+extern void test_device_init_profiling(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_device_init_async,
+			 ztest_unit_test(test_device_init_all_done),
+			 ztest_unit_test(test_device_init_concurrent),
+			 ztest_unit_test(test_device_init_dependencies),
+			 ztest_unit_test(test_device_init_profiling));
+	ztest_run_test_suite(test_device_init_async);
+}
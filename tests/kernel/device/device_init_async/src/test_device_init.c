@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_device_init_async
+ * @{
+ * @defgroup t_device_init_async_basic test_device_init_async_basic
+ * @brief TestPurpose: verify ASYNC level device initialization
+ * - API coverage
+ *   -# DEVICE_INIT at ASYNC level, DEVICE_INIT_DEPENDS_ON
+ *   -# device_init_profile_print
+ * @}
+ */
+
+#include <ztest.h>
+#include <device.h>
+#include <init.h>
+#include <atomic.h>
+
+#define SLOW_INIT_MS 100
+
+struct init_record {
+	int start;
+	int end;
+};
+
+static atomic_t sequence;
+static struct init_record early, slow_a, slow_b, after_ab, after_early;
+
+static void record_start(struct init_record *record)
+{
+	record->start = atomic_inc(&sequence) + 1;
+}
+
+static void record_end(struct init_record *record)
+{
+	record->end = atomic_inc(&sequence) + 1;
+}
+
+static int early_init(struct device *dev)
+{
+	record_start(&early);
+	record_end(&early);
+	return 0;
+}
+
+static int slow_a_init(struct device *dev)
+{
+	record_start(&slow_a);
+	k_sleep(SLOW_INIT_MS);
+	record_end(&slow_a);
+	return 0;
+}
+
+static int slow_b_init(struct device *dev)
+{
+	record_start(&slow_b);
+	k_sleep(SLOW_INIT_MS);
+	record_end(&slow_b);
+	return 0;
+}
+
+static int after_ab_init(struct device *dev)
+{
+	record_start(&after_ab);
+	record_end(&after_ab);
+	return 0;
+}
+
+static int after_early_init(struct device *dev)
+{
+	record_start(&after_early);
+	record_end(&after_early);
+	return 0;
+}
+
+/* defined in reverse dependency order, to show link order does not matter */
+DEVICE_INIT(after_ab, "after_ab", after_ab_init, NULL, NULL, ASYNC, 0);
+DEVICE_INIT_DEPENDS_ON(after_ab, "slow_a");
+DEVICE_INIT_DEPENDS_ON(after_ab, "slow_b");
+
+DEVICE_INIT(slow_a, "slow_a", slow_a_init, NULL, NULL, ASYNC, 1);
+DEVICE_INIT(slow_b, "slow_b", slow_b_init, NULL, NULL, ASYNC, 2);
+
+/* dependency on a device of another level: always met */
+DEVICE_INIT(early, "early", early_init, NULL, NULL, POST_KERNEL, 99);
+DEVICE_INIT(after_early, "after_early", after_early_init, NULL, NULL,
+	    ASYNC, 3);
+DEVICE_INIT_DEPENDS_ON(after_early, "early");
+
+/* test cases */
+
+void test_device_init_all_done(void)
+{
+	/**TESTPOINT: all devices are initialized before main() */
+	assert_not_equal(early.end, 0, "");
+	assert_not_equal(slow_a.end, 0, "");
+	assert_not_equal(slow_b.end, 0, "");
+	assert_not_equal(after_ab.end, 0, "");
+	assert_not_equal(after_early.end, 0, "");
+
+	/**TESTPOINT: the ASYNC level runs after the other levels */
+	assert_true(early.end < after_early.start, "");
+	assert_true(early.end < slow_a.start, "");
+}
+
+void test_device_init_concurrent(void)
+{
+	/**TESTPOINT: independent devices initialize concurrently */
+	assert_true(slow_a.start < slow_b.end, "");
+	assert_true(slow_b.start < slow_a.end, "");
+}
+
+void test_device_init_dependencies(void)
+{
+	/**TESTPOINT: a device waits for all the devices it depends on */
+	assert_true(after_ab.start > slow_a.end, "");
+	assert_true(after_ab.start > slow_b.end, "");
+
+	/**TESTPOINT: a device without pending dependencies does not wait */
+	assert_true(after_early.end < slow_a.end, "");
+}
+
+void test_device_init_profiling(void)
+{
+	uint64_t ns = SYS_CLOCK_HW_CYCLES_TO_NS64(
+		DEVICE_GET(slow_a)->init_cycles);
+
+	/**TESTPOINT: the time spent in init functions is measured */
+	assert_true(ns >= (uint64_t)SLOW_INIT_MS / 2 * NSEC_PER_SEC /
+		    MSEC_PER_SEC, "");
+	assert_true(DEVICE_GET(after_ab)->init_cycles <
+		    DEVICE_GET(slow_a)->init_cycles, "");
+
+	device_init_profile_print();
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_device
+ * @{
+ * @defgroup t_device_lookup test_device_lookup
+ * @}
+ */
+
+#include <ztest.h>
+extern void test_device_lookup_literal(void);
+extern void test_device_lookup_copy(void);
+extern void test_device_lookup_missing(void);
+extern void test_device_lookup_no_api(void);
+extern void test_device_lookup_duplicate(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_device_lookup,
+			 ztest_unit_test(test_device_lookup_literal),
+			 ztest_unit_test(test_device_lookup_copy),
+			 ztest_unit_test(test_device_lookup_missing),
+			 ztest_unit_test(test_device_lookup_no_api),
+			 ztest_unit_test(test_device_lookup_duplicate));
+	ztest_run_test_suite(test_device_lookup);
+}
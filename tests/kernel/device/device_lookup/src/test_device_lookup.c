@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_device_lookup
+ * @{
+ * @defgroup t_device_lookup_basic test_device_lookup_basic
+ * @brief TestPurpose: verify device lookup by name
+ * - API coverage
+ *   -# device_get_binding
+ * @}
+ */
+
+#include <ztest.h>
+#include <device.h>
+#include <string.h>
+#include <errno.h>
+
+#define DEV_A_NAME "lookup_a"
+#define DEV_B_NAME "lookup_b"
+#define DEV_NO_API_NAME "lookup_no_api"
+#define DEV_DUP_NAME "lookup_dup"
+
+static const int dummy_api;
+
+static int dummy_init(struct device *dev)
+{
+	return 0;
+}
+
+static int failing_init(struct device *dev)
+{
+	dev->driver_api = NULL;
+	return -EIO;
+}
+
+DEVICE_AND_API_INIT(lookup_a, DEV_A_NAME, dummy_init, NULL, NULL,
+		    POST_KERNEL, 0, &dummy_api);
+DEVICE_AND_API_INIT(lookup_b, DEV_B_NAME, dummy_init, NULL, NULL,
+		    POST_KERNEL, 1, &dummy_api);
+DEVICE_AND_API_INIT(lookup_no_api, DEV_NO_API_NAME, failing_init, NULL,
+		    NULL, POST_KERNEL, 2, &dummy_api);
+
+/* the first one in link order, the lower init priority, fails */
+DEVICE_AND_API_INIT(lookup_dup_1, DEV_DUP_NAME, failing_init, NULL, NULL,
+		    APPLICATION, 0, &dummy_api);
+DEVICE_AND_API_INIT(lookup_dup_2, DEV_DUP_NAME, dummy_init, NULL, NULL,
+		    APPLICATION, 1, &dummy_api);
+DEVICE_AND_API_INIT(lookup_dup_3, DEV_DUP_NAME, dummy_init, NULL, NULL,
+		    APPLICATION, 2, &dummy_api);
+
+/* test cases */
+
+void test_device_lookup_literal(void)
+{
+	/**TESTPOINT: the registered name finds its device */
+	assert_equal(device_get_binding(DEV_A_NAME), DEVICE_GET(lookup_a), "");
+	assert_equal(device_get_binding(DEV_B_NAME), DEVICE_GET(lookup_b), "");
+}
+
+void test_device_lookup_copy(void)
+{
+	char name[sizeof(DEV_B_NAME)];
+
+	/**TESTPOINT: a copy of the name finds the device too */
+	strcpy(name, DEV_B_NAME);
+	assert_equal(device_get_binding(name), DEVICE_GET(lookup_b), "");
+}
+
+void test_device_lookup_missing(void)
+{
+	/**TESTPOINT: unknown names are not found */
+	assert_is_null(device_get_binding("lookup_none"), "");
+	assert_is_null(device_get_binding("lookup_"), "");
+	assert_is_null(device_get_binding(""), "");
+}
+
+void test_device_lookup_no_api(void)
+{
+	/**TESTPOINT: devices whose initialization failed are not found */
+	assert_is_null(device_get_binding(DEV_NO_API_NAME), "");
+}
+
+void test_device_lookup_duplicate(void)
+{
+	/**TESTPOINT: the first usable device of a name is found */
+	assert_equal(device_get_binding(DEV_DUP_NAME), DEVICE_GET(lookup_dup_2),
+		     "");
+}
@@ -47,6 +47,7 @@ static enum mmsg_type {
 	ASYNC_PUT_GET_BLOCK,
 	TARGET_SOURCE_THREAD_BUFFER,
 	TARGET_SOURCE_THREAD_BLOCK,
+	ASYNC_PUT_WAITING_RECEIVER,
 	MAX_INFO_TYPE
 } info_type;
 
@@ -56,7 +57,8 @@ static char data[MAX_INFO_TYPE][MAIL_LEN] = {
 	"async send/recv msg using a buffer",
 	"async send/recv msg using a memory block",
 	"specify target/source thread, using a buffer",
-	"specify target/source thread, using a memory block"
+	"specify target/source thread, using a memory block",
+	"async send to a waiting receiver, without semaphore"
 };
 
 static void tmbox_put(struct k_mbox *pmbox)
@@ -119,6 +121,16 @@ static void tmbox_put(struct k_mbox *pmbox)
 		k_sem_take(&sync_sema, K_FOREVER);
 		k_mem_pool_free(&mmsg.tx_block);
 		break;
+	case ASYNC_PUT_WAITING_RECEIVER:
+		/*let the receiver wait first*/
+		k_sleep(TIMEOUT);
+		/**TESTPOINT: mbox async put to a waiting receiver*/
+		mmsg.info = ASYNC_PUT_WAITING_RECEIVER;
+		mmsg.size = sizeof(data[info_type]);
+		mmsg.tx_data = data[info_type];
+		mmsg.tx_target_thread = receiver_tid;
+		k_mbox_async_put(pmbox, &mmsg, NULL);
+		break;
 	default:
 		break;
 	}
@@ -194,6 +206,17 @@ static void tmbox_get(struct k_mbox *pmbox)
 			== 0, NULL);
 		k_mem_pool_free(&rxblock);
 		break;
+	case ASYNC_PUT_WAITING_RECEIVER:
+		/**TESTPOINT: mbox get from an async put without semaphore*/
+		mmsg.size = sizeof(rxdata);
+		mmsg.rx_source_thread = sender_tid;
+		assert_true(k_mbox_get(pmbox, &mmsg, rxdata, K_FOREVER) == 0,
+			NULL);
+		assert_equal(mmsg.info, ASYNC_PUT_WAITING_RECEIVER, NULL);
+		assert_equal(mmsg.size, sizeof(data[info_type]), NULL);
+		assert_true(memcmp(rxdata, data[info_type], MAIL_LEN) == 0,
+			NULL);
+		break;
 	default:
 		break;
 	}
@@ -274,3 +297,9 @@ void test_mbox_target_source_thread_block(void)
 	info_type = TARGET_SOURCE_THREAD_BLOCK;
 	tmbox(&mbox);
 }
+
+void test_mbox_async_put_waiting_receiver(void)
+{
+	info_type = ASYNC_PUT_WAITING_RECEIVER;
+	tmbox(&mbox);
+}
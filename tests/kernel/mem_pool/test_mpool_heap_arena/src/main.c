@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+extern void test_heap_arena_malloc(void);
+extern void test_heap_arena_inherit(void);
+extern void test_heap_arena_unset(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_mpool_heap_arena,
+		ztest_unit_test(test_heap_arena_malloc),
+		ztest_unit_test(test_heap_arena_inherit),
+		ztest_unit_test(test_heap_arena_unset));
+	ztest_run_test_suite(test_mpool_heap_arena);
+}
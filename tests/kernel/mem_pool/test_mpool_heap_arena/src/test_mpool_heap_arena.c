@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_mpool
+ * @{
+ * @defgroup t_mpool_heap_arena test_mpool_heap_arena
+ * @brief TestPurpose: verify k_malloc() from per-thread heap arenas
+ * - API coverage
+ *   -# k_thread_heap_arena_set
+ *   -# k_thread_heap_arena_get
+ *   -# k_mem_pool_malloc
+ * - Configure options covered
+ *   - CONFIG_HEAP_ARENAS
+ * @}
+ */
+
+#include <ztest.h>
+
+#define STACK_SIZE 512
+#define ALLOC_SIZE 100
+
+K_MEM_POOL_DEFINE(arena, 64, 1024, 1, 4);
+extern struct k_mem_pool _heap_mem_pool;
+
+static char __stack tstack[STACK_SIZE];
+static struct k_mem_pool *child_arena;
+static struct k_mem_pool_stats child_stats;
+
+static size_t bytes_used(struct k_mem_pool *pool)
+{
+	struct k_mem_pool_stats stats;
+
+	k_mem_pool_stats_get(pool, &stats);
+	return stats.bytes_used;
+}
+
+static void child_entry(void *p1, void *p2, void *p3)
+{
+	void *ptr;
+
+	child_arena = k_thread_heap_arena_get(k_current_get());
+
+	ptr = k_malloc(ALLOC_SIZE);
+	k_mem_pool_stats_get(&arena, &child_stats);
+	k_free(ptr);
+}
+
+/*test cases*/
+void test_heap_arena_malloc(void)
+{
+	size_t heap_used = bytes_used(&_heap_mem_pool);
+	void *ptr;
+
+	assert_is_null(k_thread_heap_arena_get(k_current_get()), NULL);
+	k_thread_heap_arena_set(k_current_get(), &arena);
+	assert_equal_ptr(k_thread_heap_arena_get(k_current_get()), &arena,
+			 NULL);
+
+	/**TESTPOINT: k_malloc() draws from the arena, not the heap*/
+	ptr = k_malloc(ALLOC_SIZE);
+	assert_not_null(ptr, NULL);
+	assert_true(bytes_used(&arena) >= ALLOC_SIZE, NULL);
+	assert_equal(bytes_used(&_heap_mem_pool), heap_used, NULL);
+
+	/**TESTPOINT: k_free() returns the memory to the arena*/
+	k_free(ptr);
+	assert_equal(bytes_used(&arena), 0, NULL);
+
+	/**TESTPOINT: k_mem_pool_malloc() draws from the given pool*/
+	ptr = k_mem_pool_malloc(&_heap_mem_pool, ALLOC_SIZE);
+	assert_not_null(ptr, NULL);
+	assert_equal(bytes_used(&arena), 0, NULL);
+	assert_true(bytes_used(&_heap_mem_pool) > heap_used, NULL);
+	k_free(ptr);
+	assert_equal(bytes_used(&_heap_mem_pool), heap_used, NULL);
+}
+
+void test_heap_arena_inherit(void)
+{
+	k_thread_heap_arena_set(k_current_get(), &arena);
+
+	/**TESTPOINT: a spawned thread allocates from its parent's arena*/
+	k_thread_spawn(tstack, STACK_SIZE, child_entry, NULL, NULL, NULL,
+		       K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(100);
+
+	assert_equal_ptr(child_arena, &arena, NULL);
+	assert_true(child_stats.bytes_used >= ALLOC_SIZE, NULL);
+	assert_equal(bytes_used(&arena), 0, NULL);
+}
+
+void test_heap_arena_unset(void)
+{
+	size_t heap_used = bytes_used(&_heap_mem_pool);
+	void *ptr;
+
+	/**TESTPOINT: without an arena, k_malloc() draws from the heap*/
+	k_thread_heap_arena_set(k_current_get(), NULL);
+	ptr = k_malloc(ALLOC_SIZE);
+	assert_not_null(ptr, NULL);
+	assert_equal(bytes_used(&arena), 0, NULL);
+	assert_true(bytes_used(&_heap_mem_pool) > heap_used, NULL);
+	k_free(ptr);
+}
@@ -14,6 +14,7 @@
  *   - CONFIG_MEM_POOL_SPLIT_BEFORE_DEFRAG
  *   - CONFIG_MEM_POOL_DEFRAG_BEFORE_SPLIT
  *   - CONFIG_MEM_POOL_SPLIT_ONLY
+ *   - CONFIG_MEM_POOL_TLSF
  * @}
  */
 
@@ -119,6 +120,33 @@ static void tmpool_split_only(void)
 }
 #endif
 
+#ifdef CONFIG_MEM_POOL_TLSF
+static void tmpool_tlsf(void)
+{
+	struct k_mem_block block_merged, block_max;
+	/**
+	 * TESTPOINT: This option replaces the quad-block allocator with a
+	 * two-level segregated fit allocator, and freed blocks are merged
+	 * with their free neighbours immediately.
+	 * Test steps: mpool1 initial status (F for free, U for used)
+	 *             4F 4F 4F 4F 16U 16U 16U ...F
+	 *             1. request a mid-size (16) block, verify it is carved
+	 *                out of the already merged block[0~3]
+	 *             2. verify a max-size block can still be allocated
+	 */
+	TC_PRINT("CONFIG_MEM_POOL_TLSF\n");
+	/* 1. request a mid-size block*/
+	assert_true(k_mem_pool_alloc(&mpool1, &block_merged, BLK_SIZE_MID,
+		K_NO_WAIT) == 0, NULL);
+	assert_equal(block_merged.data, block[0].data, NULL);
+	/* 2. verify the rest of the pool is still available*/
+	assert_true(k_mem_pool_alloc(&mpool1, &block_max, BLK_SIZE_MAX,
+		K_NO_WAIT) == 0, NULL);
+	k_mem_pool_free(&block_merged);
+	k_mem_pool_free(&block_max);
+}
+#endif
+
 /* test cases*/
 void test_mpool_alloc_options(void)
 {
@@ -141,6 +169,9 @@ void test_mpool_alloc_options(void)
 	#ifdef CONFIG_MEM_POOL_SPLIT_ONLY
 	tmpool_split_only();
 	#endif
+	#ifdef CONFIG_MEM_POOL_TLSF
+	tmpool_tlsf();
+	#endif
 
 	/* test case tear down*/
 	for (int i = 4; i < block_count; i++) {
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+extern void test_mpool_stats_usage(void);
+extern void test_mpool_stats_block(void);
+extern void test_mpool_stats_exhausted(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_mpool_stats,
+		ztest_unit_test(test_mpool_stats_usage),
+		ztest_unit_test(test_mpool_stats_block),
+		ztest_unit_test(test_mpool_stats_exhausted));
+	ztest_run_test_suite(test_mpool_stats);
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_mpool
+ * @{
+ * @defgroup t_mpool_stats test_mpool_stats
+ * @brief TestPurpose: verify memory pool usage statistics
+ * - API coverage
+ *   -# k_mem_pool_stats_get
+ *   -# k_mem_pool_block_stats_get
+ * - Configure options covered
+ *   - CONFIG_MEM_POOL_STATS
+ * @}
+ */
+
+#include <ztest.h>
+
+#define TIMEOUT 100
+#define BLK_SIZE_MIN 8
+#define BLK_SIZE_MID 32
+#define BLK_SIZE_MAX 128
+#define BLK_NUM_MIN 32
+#define BLK_NUM_MAX 2
+#define BLK_ALIGN BLK_SIZE_MIN
+
+K_MEM_POOL_DEFINE(mpool_stats, BLK_SIZE_MIN, BLK_SIZE_MAX, BLK_NUM_MAX,
+		  BLK_ALIGN);
+
+static struct k_mem_block block[BLK_NUM_MIN];
+
+/*test cases*/
+void test_mpool_stats_usage(void)
+{
+	struct k_mem_block block_max, block_mid;
+	struct k_mem_pool_stats stats;
+
+	/**TESTPOINT: a pool that has not been used is all free*/
+	k_mem_pool_stats_get(&mpool_stats, &stats);
+	assert_equal(stats.bytes_used, 0, NULL);
+	assert_equal(stats.max_bytes_used, 0, NULL);
+	assert_equal(stats.num_failures, 0, NULL);
+	assert_true(stats.largest_free_block >= BLK_SIZE_MAX, NULL);
+
+	assert_equal(k_mem_pool_alloc(&mpool_stats, &block_max, BLK_SIZE_MAX,
+				      K_NO_WAIT), 0, NULL);
+	assert_equal(k_mem_pool_alloc(&mpool_stats, &block_mid, BLK_SIZE_MID,
+				      K_NO_WAIT), 0, NULL);
+
+	/**TESTPOINT: allocated bytes are accounted for*/
+	k_mem_pool_stats_get(&mpool_stats, &stats);
+	assert_equal(stats.bytes_used, BLK_SIZE_MAX + BLK_SIZE_MID, NULL);
+	assert_equal(stats.max_bytes_used, BLK_SIZE_MAX + BLK_SIZE_MID, NULL);
+
+	/**TESTPOINT: the peak usage is kept once blocks are freed*/
+	k_mem_pool_free(&block_max);
+	k_mem_pool_stats_get(&mpool_stats, &stats);
+	assert_equal(stats.bytes_used, BLK_SIZE_MID, NULL);
+	assert_equal(stats.max_bytes_used, BLK_SIZE_MAX + BLK_SIZE_MID, NULL);
+
+	k_mem_pool_free(&block_mid);
+	k_mem_pool_stats_get(&mpool_stats, &stats);
+	assert_equal(stats.bytes_used, 0, NULL);
+	assert_equal(stats.num_failures, 0, NULL);
+}
+
+void test_mpool_stats_block(void)
+{
+	struct k_mem_block block_mid;
+	size_t block_size;
+	uint32_t num_used, total = 0;
+	int i;
+
+	assert_equal(k_mem_pool_alloc(&mpool_stats, &block_mid, BLK_SIZE_MID,
+				      K_NO_WAIT), 0, NULL);
+
+	/**TESTPOINT: the block is counted in a class large enough for it*/
+	for (i = 0; k_mem_pool_block_stats_get(&mpool_stats, i, &block_size,
+					       &num_used) == 0; i++) {
+		if (num_used) {
+			assert_true(block_size >= BLK_SIZE_MID, NULL);
+		}
+		total += num_used;
+	}
+	assert_equal(total, 1, NULL);
+
+	/**TESTPOINT: there is no class past the last one*/
+	assert_true(i > 0, NULL);
+	assert_equal(k_mem_pool_block_stats_get(&mpool_stats, i, &block_size,
+						&num_used), -EINVAL, NULL);
+
+	k_mem_pool_free(&block_mid);
+
+	/**TESTPOINT: freed blocks are not counted anymore*/
+	for (i = 0; k_mem_pool_block_stats_get(&mpool_stats, i, &block_size,
+					       &num_used) == 0; i++) {
+		assert_equal(num_used, 0, NULL);
+	}
+}
+
+void test_mpool_stats_exhausted(void)
+{
+	struct k_mem_block fblock;
+	struct k_mem_pool_stats stats;
+	int i;
+
+	/* allocate minimum sized blocks until the pool is exhausted */
+	for (i = 0; i < BLK_NUM_MIN; i++) {
+		assert_equal(k_mem_pool_alloc(&mpool_stats, &block[i],
+					      BLK_SIZE_MIN, K_NO_WAIT),
+			     0, NULL);
+	}
+
+	k_mem_pool_stats_get(&mpool_stats, &stats);
+	assert_equal(stats.bytes_used, BLK_NUM_MIN * BLK_SIZE_MIN, NULL);
+
+	/**TESTPOINT: failed allocations are counted, waiting or not*/
+	assert_equal(k_mem_pool_alloc(&mpool_stats, &fblock, BLK_SIZE_MIN,
+				      K_NO_WAIT), -ENOMEM, NULL);
+	assert_equal(k_mem_pool_alloc(&mpool_stats, &fblock, BLK_SIZE_MIN,
+				      TIMEOUT), -EAGAIN, NULL);
+
+	k_mem_pool_stats_get(&mpool_stats, &stats);
+	assert_equal(stats.num_failures, 2, NULL);
+	assert_true(stats.largest_free_block < BLK_SIZE_MIN, NULL);
+
+	for (i = 0; i < BLK_NUM_MIN; i++) {
+		k_mem_pool_free(&block[i]);
+	}
+	k_mem_pool_defrag(&mpool_stats);
+
+	/**TESTPOINT: the pool is free again*/
+	k_mem_pool_stats_get(&mpool_stats, &stats);
+	assert_equal(stats.bytes_used, 0, NULL);
+	assert_true(stats.largest_free_block >= BLK_SIZE_MAX, NULL);
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+extern void test_mslab_stats_max_used(void);
+extern void test_mslab_stats_failures(void);
+extern void test_mslab_stats_kinit(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_mslab_stats,
+		ztest_unit_test(test_mslab_stats_max_used),
+		ztest_unit_test(test_mslab_stats_failures),
+		ztest_unit_test(test_mslab_stats_kinit));
+	ztest_run_test_suite(test_mslab_stats);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_mslab
+ * @{
+ * @defgroup t_mslab_stats test_mslab_stats
+ * @brief TestPurpose: verify memory slab usage statistics
+ * - API coverage
+ *   -# k_mem_slab_max_used_get
+ *   -# k_mem_slab_num_failures_get
+ * - Configure options covered
+ *   - CONFIG_MEM_SLAB_STATS
+ * @}
+ */
+
+#include <ztest.h>
+
+#define TIMEOUT 100
+#define BLK_NUM 4
+#define BLK_SIZE 16
+#define BLK_ALIGN 4
+
+K_MEM_SLAB_DEFINE(mslab_stats, BLK_SIZE, BLK_NUM, BLK_ALIGN);
+
+static char __aligned(BLK_ALIGN) tslab_buf[BLK_NUM * BLK_SIZE];
+static struct k_mem_slab tslab;
+
+static void *block[BLK_NUM];
+
+/*test cases*/
+void test_mslab_stats_max_used(void)
+{
+	/**TESTPOINT: a slab that has not been used has no peak usage*/
+	assert_equal(k_mem_slab_max_used_get(&mslab_stats), 0, NULL);
+	assert_equal(k_mem_slab_num_failures_get(&mslab_stats), 0, NULL);
+
+	for (int i = 0; i < 3; i++) {
+		assert_equal(k_mem_slab_alloc(&mslab_stats, &block[i],
+					      K_NO_WAIT), 0, NULL);
+	}
+	assert_equal(k_mem_slab_max_used_get(&mslab_stats), 3, NULL);
+
+	/**TESTPOINT: the peak usage is kept once blocks are freed*/
+	k_mem_slab_free(&mslab_stats, &block[2]);
+	k_mem_slab_free(&mslab_stats, &block[1]);
+	assert_equal(k_mem_slab_num_used_get(&mslab_stats), 1, NULL);
+	assert_equal(k_mem_slab_max_used_get(&mslab_stats), 3, NULL);
+
+	assert_equal(k_mem_slab_alloc(&mslab_stats, &block[1], K_NO_WAIT), 0,
+		     NULL);
+	assert_equal(k_mem_slab_max_used_get(&mslab_stats), 3, NULL);
+
+	k_mem_slab_free(&mslab_stats, &block[1]);
+	k_mem_slab_free(&mslab_stats, &block[0]);
+	assert_equal(k_mem_slab_num_failures_get(&mslab_stats), 0, NULL);
+}
+
+void test_mslab_stats_failures(void)
+{
+	void *fblock;
+
+	for (int i = 0; i < BLK_NUM; i++) {
+		assert_equal(k_mem_slab_alloc(&mslab_stats, &block[i],
+					      K_NO_WAIT), 0, NULL);
+	}
+	assert_equal(k_mem_slab_max_used_get(&mslab_stats), BLK_NUM, NULL);
+
+	/**TESTPOINT: failed allocations are counted, waiting or not*/
+	assert_equal(k_mem_slab_alloc(&mslab_stats, &fblock, K_NO_WAIT),
+		     -ENOMEM, NULL);
+	assert_equal(k_mem_slab_num_failures_get(&mslab_stats), 1, NULL);
+	assert_equal(k_mem_slab_alloc(&mslab_stats, &fblock, TIMEOUT),
+		     -EAGAIN, NULL);
+	assert_equal(k_mem_slab_num_failures_get(&mslab_stats), 2, NULL);
+
+	for (int i = 0; i < BLK_NUM; i++) {
+		k_mem_slab_free(&mslab_stats, &block[i]);
+	}
+}
+
+void test_mslab_stats_kinit(void)
+{
+	k_mem_slab_init(&tslab, tslab_buf, BLK_SIZE, BLK_NUM);
+
+	/**TESTPOINT: a slab initialized at runtime starts with no stats*/
+	assert_equal(k_mem_slab_max_used_get(&tslab), 0, NULL);
+	assert_equal(k_mem_slab_num_failures_get(&tslab), 0, NULL);
+
+	assert_equal(k_mem_slab_alloc(&tslab, &block[0], K_NO_WAIT), 0, NULL);
+	assert_equal(k_mem_slab_max_used_get(&tslab), 1, NULL);
+	k_mem_slab_free(&tslab, &block[0]);
+}
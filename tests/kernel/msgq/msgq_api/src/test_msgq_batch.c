@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_msgq_api
+ * @{
+ * @defgroup t_msgq_batch test_msgq_batch
+ * @brief TestPurpose: verify zephyr msgq batch and peek apis
+ * - API coverage
+ *   -# k_msgq_put_batch k_msgq_get_batch k_msgq_peek
+ * @}
+ */
+
+#include "test_msgq.h"
+
+#define BATCH_LEN 4
+#define BATCH_MSGS 6
+
+static char __noinit __stack tstack[STACK_SIZE];
+static char __aligned(4) bbuffer[MSG_SIZE * BATCH_LEN];
+static struct k_msgq bmsgq;
+static uint32_t reader_rx[BATCH_MSGS];
+static int reader_rc;
+
+static void fill_data(uint32_t *data, int num, uint32_t first)
+{
+	for (int i = 0; i < num; i++) {
+		data[i] = first + i;
+	}
+}
+
+static void check_data(uint32_t *data, int num, uint32_t first)
+{
+	for (int i = 0; i < num; i++) {
+		assert_equal(data[i], first + i, NULL);
+	}
+}
+
+static void writer_entry(void *p1, void *p2, void *p3)
+{
+	uint32_t msg = (uint32_t)p1;
+
+	assert_equal(k_msgq_put(&bmsgq, &msg, K_FOREVER), 0, NULL);
+}
+
+static void reader_entry(void *p1, void *p2, void *p3)
+{
+	reader_rc = k_msgq_get_batch(&bmsgq, reader_rx, BATCH_MSGS,
+				     K_FOREVER);
+}
+
+/*test cases*/
+void test_msgq_batch(void)
+{
+	uint32_t tx[BATCH_MSGS], rx[BATCH_MSGS], msg;
+
+	k_msgq_init(&bmsgq, bbuffer, MSG_SIZE, BATCH_LEN);
+	fill_data(tx, BATCH_MSGS, MSG0);
+
+	/**TESTPOINT: nothing to peek at or to get in an empty queue*/
+	assert_equal(k_msgq_peek(&bmsgq, &msg), -ENOMSG, NULL);
+	assert_equal(k_msgq_get_batch(&bmsgq, rx, BATCH_MSGS, K_NO_WAIT),
+		     -ENOMSG, NULL);
+
+	/**TESTPOINT: batch put stops when the queue is full*/
+	assert_equal(k_msgq_put_batch(&bmsgq, tx, BATCH_MSGS, K_NO_WAIT),
+		     BATCH_LEN, NULL);
+	assert_equal(k_msgq_num_used_get(&bmsgq), BATCH_LEN, NULL);
+	assert_equal(k_msgq_put_batch(&bmsgq, tx, BATCH_MSGS, K_NO_WAIT),
+		     -ENOMSG, NULL);
+	assert_equal(k_msgq_put_batch(&bmsgq, tx, BATCH_MSGS, TIMEOUT),
+		     -EAGAIN, NULL);
+
+	/**TESTPOINT: peek does not remove the message*/
+	assert_equal(k_msgq_peek(&bmsgq, &msg), 0, NULL);
+	assert_equal(msg, MSG0, NULL);
+	assert_equal(k_msgq_num_used_get(&bmsgq), BATCH_LEN, NULL);
+
+	/**TESTPOINT: batch get, in fifo order, wrapping around the buffer*/
+	assert_equal(k_msgq_get_batch(&bmsgq, rx, 1, K_NO_WAIT), 1, NULL);
+	check_data(rx, 1, MSG0);
+	assert_equal(k_msgq_put_batch(&bmsgq, &tx[BATCH_LEN], 1, K_NO_WAIT),
+		     1, NULL);
+	assert_equal(k_msgq_get_batch(&bmsgq, rx, BATCH_MSGS, K_NO_WAIT),
+		     BATCH_LEN, NULL);
+	check_data(rx, BATCH_LEN, MSG0 + 1);
+	assert_equal(k_msgq_num_used_get(&bmsgq), 0, NULL);
+}
+
+void test_msgq_batch_waiters(void)
+{
+	uint32_t tx[BATCH_MSGS], rx[BATCH_MSGS];
+	k_tid_t tid;
+
+	k_msgq_init(&bmsgq, bbuffer, MSG_SIZE, BATCH_LEN);
+	fill_data(tx, BATCH_MSGS, MSG1);
+
+	/**TESTPOINT: batch get refills the queue from a waiting writer*/
+	assert_equal(k_msgq_put_batch(&bmsgq, tx, BATCH_LEN, K_NO_WAIT),
+		     BATCH_LEN, NULL);
+	tid = k_thread_spawn(tstack, STACK_SIZE, writer_entry,
+			     (void *)(MSG1 + BATCH_LEN), NULL, NULL,
+			     K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(TIMEOUT >> 1);
+	assert_equal(k_msgq_get_batch(&bmsgq, rx, BATCH_MSGS, K_NO_WAIT),
+		     BATCH_LEN + 1, NULL);
+	check_data(rx, BATCH_LEN + 1, MSG1);
+	k_thread_abort(tid);
+
+	/**TESTPOINT: batch put hands the first message to a waiting reader*/
+	reader_rc = 0;
+	tid = k_thread_spawn(tstack, STACK_SIZE, reader_entry,
+			     NULL, NULL, NULL,
+			     K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(TIMEOUT >> 1);
+	assert_equal(k_msgq_put_batch(&bmsgq, tx, 3, K_NO_WAIT), 3, NULL);
+	k_sleep(TIMEOUT >> 1);
+	assert_equal(reader_rc, 1, NULL);
+	check_data(reader_rx, 1, MSG1);
+	assert_equal(k_msgq_get_batch(&bmsgq, rx, BATCH_MSGS, K_NO_WAIT),
+		     2, NULL);
+	check_data(rx, 2, MSG1 + 1);
+	k_thread_abort(tid);
+}
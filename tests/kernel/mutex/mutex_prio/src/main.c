@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_mutex
+ * @{
+ * @defgroup t_mutex_prio test_mutex_prio
+ * @}
+ */
+
+#include <ztest.h>
+extern void test_mutex_prio_inherit_chain(void);
+extern void test_mutex_prio_ceiling(void);
+extern void test_mutex_stats(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_mutex_prio,
+			 ztest_unit_test(test_mutex_prio_inherit_chain),
+			 ztest_unit_test(test_mutex_prio_ceiling),
+			 ztest_unit_test(test_mutex_stats));
+	ztest_run_test_suite(test_mutex_prio);
+}
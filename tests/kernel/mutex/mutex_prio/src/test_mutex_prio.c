@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_mutex_prio
+ * @{
+ * @defgroup t_mutex_prio_basic test_mutex_prio_basic
+ * @brief TestPurpose: verify transitive priority inheritance, priority
+ * ceilings and contention statistics of mutexes
+ * - API coverage
+ *   -# k_mutex_lock k_mutex_unlock
+ *   -# k_mutex_ceiling_set k_mutex_num_conflicts_get
+ * @}
+ */
+
+#include <ztest.h>
+
+#define STACK_SIZE 512
+#define TIMEOUT 100
+
+#define LOW_PRIO K_PRIO_PREEMPT(10)
+#define MID_PRIO K_PRIO_PREEMPT(8)
+#define HIGH_PRIO K_PRIO_PREEMPT(5)
+#define CEILING_PRIO K_PRIO_PREEMPT(3)
+
+static char __noinit __stack mid_stack[STACK_SIZE];
+static char __noinit __stack high_stack[STACK_SIZE];
+
+K_MUTEX_DEFINE(mutex1);
+K_MUTEX_DEFINE(mutex2);
+K_MUTEX_DEFINE(ceiling_mutex);
+K_MUTEX_DEFINE(stats_mutex);
+
+static int mid_done;
+static int high_rc;
+
+static void mid_entry(void *p1, void *p2, void *p3)
+{
+	k_mutex_lock(&mutex2, K_FOREVER);
+	k_mutex_lock(&mutex1, K_FOREVER);
+	k_mutex_unlock(&mutex1);
+	k_mutex_unlock(&mutex2);
+	mid_done = 1;
+}
+
+static void high_entry(void *p1, void *p2, void *p3)
+{
+	high_rc = k_mutex_lock(&mutex2, TIMEOUT);
+}
+
+/*test cases*/
+void test_mutex_prio_inherit_chain(void)
+{
+	k_tid_t self = k_current_get();
+	int old_prio = k_thread_priority_get(self);
+
+	k_thread_priority_set(self, LOW_PRIO);
+	k_mutex_lock(&mutex1, K_FOREVER);
+
+	/* runs right away, then waits on mutex1 while holding mutex2 */
+	k_thread_spawn(mid_stack, STACK_SIZE, mid_entry, NULL, NULL, NULL,
+		       MID_PRIO, 0, 0);
+
+	/**TESTPOINT: owner inherits the priority of its waiter*/
+	assert_equal(k_thread_priority_get(self), MID_PRIO, "");
+
+	/* runs right away, then waits on mutex2 */
+	k_tid_t high = k_thread_spawn(high_stack, STACK_SIZE, high_entry,
+				      NULL, NULL, NULL, HIGH_PRIO, 0, 0);
+
+	/**TESTPOINT: inheritance follows the chain of waiting owners*/
+	assert_equal(k_thread_priority_get(self), HIGH_PRIO, "");
+
+	/* let the high priority thread time out */
+	k_sleep(2 * TIMEOUT);
+
+	/**TESTPOINT: priorities are lowered down the chain on timeout*/
+	assert_equal(high_rc, -EAGAIN, "");
+	assert_equal(k_thread_priority_get(self), MID_PRIO, "");
+
+	k_mutex_unlock(&mutex1);
+
+	/**TESTPOINT: owner gets back its own priority on unlock*/
+	assert_equal(k_thread_priority_get(self), LOW_PRIO, "");
+	assert_equal(mid_done, 1, "");
+
+	k_thread_abort(high);
+	k_thread_priority_set(self, old_prio);
+}
+
+void test_mutex_prio_ceiling(void)
+{
+	k_tid_t self = k_current_get();
+	int old_prio = k_thread_priority_get(self);
+
+	k_thread_priority_set(self, LOW_PRIO);
+	k_mutex_ceiling_set(&ceiling_mutex, CEILING_PRIO);
+
+	/**TESTPOINT: owner runs at the ceiling right after locking*/
+	k_mutex_lock(&ceiling_mutex, K_FOREVER);
+	assert_equal(k_thread_priority_get(self), CEILING_PRIO, "");
+
+	/**TESTPOINT: recursive locking keeps the ceiling*/
+	k_mutex_lock(&ceiling_mutex, K_FOREVER);
+	k_mutex_unlock(&ceiling_mutex);
+	assert_equal(k_thread_priority_get(self), CEILING_PRIO, "");
+
+	/**TESTPOINT: owner gets back its own priority on unlock*/
+	k_mutex_unlock(&ceiling_mutex);
+	assert_equal(k_thread_priority_get(self), LOW_PRIO, "");
+
+	k_thread_priority_set(self, old_prio);
+}
+
+static int stats_rc;
+
+static void stats_entry(void *p1, void *p2, void *p3)
+{
+	stats_rc = k_mutex_lock(&stats_mutex, K_NO_WAIT);
+}
+
+void test_mutex_stats(void)
+{
+	k_tid_t self = k_current_get();
+	int old_prio = k_thread_priority_get(self);
+
+	k_thread_priority_set(self, LOW_PRIO);
+
+	/**TESTPOINT: uncontended locking is not a conflict*/
+	k_mutex_lock(&stats_mutex, K_FOREVER);
+	assert_equal(k_mutex_num_conflicts_get(&stats_mutex), 0, "");
+
+	/* runs right away and fails to lock the mutex */
+	k_tid_t tid = k_thread_spawn(high_stack, STACK_SIZE, stats_entry,
+				     NULL, NULL, NULL, HIGH_PRIO, 0, 0);
+
+	/**TESTPOINT: trying to lock a locked mutex is a conflict*/
+	assert_equal(stats_rc, -EBUSY, "");
+	assert_equal(k_mutex_num_conflicts_get(&stats_mutex), 1, "");
+
+	k_mutex_unlock(&stats_mutex);
+	k_thread_abort(tid);
+	k_thread_priority_set(self, old_prio);
+}
@@ -16,6 +16,9 @@ extern void test_pipe_thread2thread(void);
 extern void test_pipe_thread2isr(void);
 extern void test_pipe_put_fail(void);
 extern void test_pipe_get_fail(void);
+extern void test_pipe_iov_buffered(void);
+extern void test_pipe_iov_direct_to_reader(void);
+extern void test_pipe_iov_lent_to_reader(void);
 
 /*test case main entry*/
 void test_main(void *p1, void *p2, void *p3)
@@ -24,6 +27,9 @@ void test_main(void *p1, void *p2, void *p3)
 		ztest_unit_test(test_pipe_thread2thread),
 		ztest_unit_test(test_pipe_thread2isr),
 		ztest_unit_test(test_pipe_put_fail),
-		ztest_unit_test(test_pipe_get_fail));
+		ztest_unit_test(test_pipe_get_fail),
+		ztest_unit_test(test_pipe_iov_buffered),
+		ztest_unit_test(test_pipe_iov_direct_to_reader),
+		ztest_unit_test(test_pipe_iov_lent_to_reader));
 	ztest_run_test_suite(test_pipe_api);
 }
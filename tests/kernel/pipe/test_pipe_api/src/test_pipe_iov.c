@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_pipe_api
+ * @{
+ * @defgroup t_pipe_api_iov test_pipe_api_iov
+ * @brief TestPurpose: verify zephyr pipe scatter/gather apis
+ * - API coverage
+ *   -# k_pipe_put_iov
+ *   -# k_pipe_get_iov
+ * @}
+ */
+
+#include <ztest.h>
+
+#define STACK_SIZE 512
+#define PIPE_LEN 16
+
+static const char msg[] = "0123456789abcdefghij";
+#define MSG_LEN (sizeof(msg) - 1)
+
+K_PIPE_DEFINE(kpipe_iov, PIPE_LEN, 4);
+/* no ring buffer: data can only go straight from a writer to a reader */
+K_PIPE_DEFINE(kpipe_direct, 0, 4);
+
+static char __noinit __stack tstack[STACK_SIZE];
+
+static char rx_a[3], rx_b[12], rx_c[5];
+
+static void rx_clear(void)
+{
+	memset(rx_a, 0, sizeof(rx_a));
+	memset(rx_b, 0, sizeof(rx_b));
+	memset(rx_c, 0, sizeof(rx_c));
+}
+
+static void rx_check(size_t len)
+{
+	char rx[sizeof(rx_a) + sizeof(rx_b) + sizeof(rx_c)];
+
+	memcpy(rx, rx_a, sizeof(rx_a));
+	memcpy(rx + sizeof(rx_a), rx_b, sizeof(rx_b));
+	memcpy(rx + sizeof(rx_a) + sizeof(rx_b), rx_c, sizeof(rx_c));
+
+	assert_equal(memcmp(rx, msg, len), 0, NULL);
+}
+
+static const struct k_pipe_iov tx_iov[] = {
+	{ (void *)&msg[0], 5 },
+	{ (void *)&msg[5], 0 },
+	{ (void *)&msg[5], 7 },
+	{ (void *)&msg[12], MSG_LEN - 12 },
+};
+
+static const struct k_pipe_iov rx_iov[] = {
+	{ rx_a, sizeof(rx_a) },
+	{ rx_b, sizeof(rx_b) },
+	{ rx_c, sizeof(rx_c) },
+};
+
+static void tpipe_put_iov(void *p1, void *p2, void *p3)
+{
+	size_t wt_byte;
+
+	assert_equal(k_pipe_put_iov((struct k_pipe *)p1, tx_iov,
+				    ARRAY_SIZE(tx_iov), &wt_byte, MSG_LEN,
+				    K_NO_WAIT), 0, NULL);
+	assert_equal(wt_byte, MSG_LEN, NULL);
+}
+
+static void tpipe_get(void *p1, void *p2, void *p3)
+{
+	char rx[MSG_LEN];
+	size_t rd_byte;
+
+	assert_equal(k_pipe_get((struct k_pipe *)p1, rx, MSG_LEN, &rd_byte,
+				MSG_LEN, K_NO_WAIT), 0, NULL);
+	assert_equal(rd_byte, MSG_LEN, NULL);
+	assert_equal(memcmp(rx, msg, MSG_LEN), 0, NULL);
+}
+
+/*test cases*/
+void test_pipe_iov_buffered(void)
+{
+	size_t wt_byte, rd_byte;
+
+	rx_clear();
+
+	/**TESTPOINT: gathered data is written to the ring buffer in order*/
+	assert_equal(k_pipe_put_iov(&kpipe_iov, tx_iov, ARRAY_SIZE(tx_iov),
+				    &wt_byte, 1, K_NO_WAIT), 0, NULL);
+	assert_equal(wt_byte, PIPE_LEN, NULL);
+
+	/**TESTPOINT: data is scattered across the buffers in order*/
+	assert_equal(k_pipe_get_iov(&kpipe_iov, rx_iov, ARRAY_SIZE(rx_iov),
+				    &rd_byte, 1, K_NO_WAIT), 0, NULL);
+	assert_equal(rd_byte, PIPE_LEN, NULL);
+	rx_check(PIPE_LEN);
+
+	/**TESTPOINT: nothing left to read, return without waiting*/
+	assert_equal(k_pipe_get_iov(&kpipe_iov, rx_iov, ARRAY_SIZE(rx_iov),
+				    &rd_byte, 1, K_NO_WAIT), -EIO, NULL);
+	assert_equal(rd_byte, 0, NULL);
+}
+
+void test_pipe_iov_direct_to_reader(void)
+{
+	size_t rd_byte;
+
+	rx_clear();
+
+	/* the writer runs once this thread waits for data */
+	k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE, tpipe_put_iov,
+				     &kpipe_direct, NULL, NULL,
+				     K_PRIO_PREEMPT(0), 0, 0);
+
+	/**TESTPOINT: the writer's buffers are copied into the reader's*/
+	assert_equal(k_pipe_get_iov(&kpipe_direct, rx_iov, ARRAY_SIZE(rx_iov),
+				    &rd_byte, MSG_LEN, K_FOREVER), 0, NULL);
+	assert_equal(rd_byte, MSG_LEN, NULL);
+	rx_check(MSG_LEN);
+
+	k_thread_abort(tid);
+}
+
+void test_pipe_iov_lent_to_reader(void)
+{
+	size_t wt_byte;
+
+	/* the reader runs once this thread waits for it */
+	k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE, tpipe_get,
+				     &kpipe_direct, NULL, NULL,
+				     K_PRIO_PREEMPT(0), 0, 0);
+
+	/**TESTPOINT: the reader copies data out of the waiting writer's*/
+	assert_equal(k_pipe_put_iov(&kpipe_direct, tx_iov, ARRAY_SIZE(tx_iov),
+				    &wt_byte, MSG_LEN, K_FOREVER), 0, NULL);
+	assert_equal(wt_byte, MSG_LEN, NULL);
+
+	k_thread_abort(tid);
+}
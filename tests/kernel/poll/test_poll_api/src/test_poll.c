@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_poll_api
+ * @{
+ * @defgroup t_poll_api_basic test_poll_api_basic
+ * @brief TestPurpose: verify zephyr k_poll apis
+ * - API coverage
+ *   -# k_poll_event_init K_POLL_EVENT_INITIALIZER
+ *   -# k_poll k_poll_signal_init k_poll_signal
+ * @}
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+
+#define STACK_SIZE 512
+#define TIMEOUT 100
+#define MSG_SIZE 4
+#define MSGQ_LEN 2
+
+struct fifo_msg {
+	void *private;
+	uint32_t msg;
+};
+
+#define SIGNAL_RESULT 0x1ee7d00d
+#define FIFO_MSG_VALUE 0xdeadbeef
+#define MSGQ_MSG_VALUE 0x12345678
+
+static char __noinit __stack tstack[STACK_SIZE];
+
+static struct k_sem no_wait_sem;
+static struct k_fifo no_wait_fifo;
+static struct k_msgq no_wait_msgq;
+static struct k_poll_signal no_wait_signal;
+static char __aligned(4) no_wait_msgq_buf[MSG_SIZE * MSGQ_LEN];
+
+K_SEM_DEFINE(wait_sem, 0, 1);
+K_FIFO_DEFINE(wait_fifo);
+K_MSGQ_DEFINE(wait_msgq, MSG_SIZE, MSGQ_LEN, 4);
+static struct k_poll_signal wait_signal = K_POLL_SIGNAL_INITIALIZER();
+
+static struct fifo_msg wait_msg = { NULL, FIFO_MSG_VALUE };
+
+/*test cases*/
+void test_poll_no_wait(void)
+{
+	struct fifo_msg msg = { NULL, FIFO_MSG_VALUE }, *msg_ptr;
+	uint32_t msgq_data = MSGQ_MSG_VALUE, rx_data;
+
+	k_sem_init(&no_wait_sem, 1, 1);
+	k_fifo_init(&no_wait_fifo);
+	k_msgq_init(&no_wait_msgq, no_wait_msgq_buf, MSG_SIZE, MSGQ_LEN);
+	k_poll_signal_init(&no_wait_signal);
+
+	struct k_poll_event events[] = {
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SEM_AVAILABLE,
+					 K_POLL_MODE_NOTIFY_ONLY,
+					 &no_wait_sem),
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+					 K_POLL_MODE_NOTIFY_ONLY,
+					 &no_wait_fifo),
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+					 K_POLL_MODE_NOTIFY_ONLY,
+					 &no_wait_msgq),
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL,
+					 K_POLL_MODE_NOTIFY_ONLY,
+					 &no_wait_signal),
+	};
+
+	k_fifo_put(&no_wait_fifo, &msg);
+	k_msgq_put(&no_wait_msgq, &msgq_data, K_NO_WAIT);
+	k_poll_signal(&no_wait_signal, SIGNAL_RESULT);
+
+	/**TESTPOINT: all objects available, no need to wait*/
+	assert_equal(k_poll(events, ARRAY_SIZE(events), K_NO_WAIT), 0, "");
+
+	assert_equal(events[0].state, K_POLL_STATE_SEM_AVAILABLE, "");
+	assert_equal(k_sem_take(&no_wait_sem, K_NO_WAIT), 0, "");
+
+	assert_equal(events[1].state, K_POLL_STATE_FIFO_DATA_AVAILABLE, "");
+	msg_ptr = k_fifo_get(&no_wait_fifo, K_NO_WAIT);
+	assert_not_null(msg_ptr, "");
+	assert_equal(msg_ptr, &msg, "");
+	assert_equal(msg_ptr->msg, FIFO_MSG_VALUE, "");
+
+	assert_equal(events[2].state, K_POLL_STATE_MSGQ_DATA_AVAILABLE, "");
+	assert_equal(k_msgq_get(&no_wait_msgq, &rx_data, K_NO_WAIT), 0, "");
+	assert_equal(rx_data, MSGQ_MSG_VALUE, "");
+
+	assert_equal(events[3].state, K_POLL_STATE_SIGNALED, "");
+	assert_equal(no_wait_signal.signaled, 1, "");
+	assert_equal(no_wait_signal.result, SIGNAL_RESULT, "");
+
+	/**TESTPOINT: no objects available, return without waiting*/
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		events[i].state = K_POLL_STATE_NOT_READY;
+	}
+	no_wait_signal.signaled = 0;
+
+	assert_equal(k_poll(events, ARRAY_SIZE(events), K_NO_WAIT),
+		     -EAGAIN, "");
+
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		assert_equal(events[i].state, K_POLL_STATE_NOT_READY, "");
+	}
+}
+
+static void poll_wait_helper(void *p1, void *p2, void *p3)
+{
+	int which = (int)p1;
+
+	switch (which) {
+	case 0:
+		k_sem_give(&wait_sem);
+		break;
+	case 1:
+		k_fifo_put(&wait_fifo, &wait_msg);
+		break;
+	case 2: {
+		uint32_t data = MSGQ_MSG_VALUE;
+
+		k_msgq_put(&wait_msgq, &data, K_NO_WAIT);
+		break;
+	}
+	default:
+		k_poll_signal(&wait_signal, SIGNAL_RESULT);
+		break;
+	}
+}
+
+void test_poll_wait(void)
+{
+	struct k_poll_event events[4];
+	static const uint32_t expected[] = {
+		K_POLL_STATE_SEM_AVAILABLE,
+		K_POLL_STATE_FIFO_DATA_AVAILABLE,
+		K_POLL_STATE_MSGQ_DATA_AVAILABLE,
+		K_POLL_STATE_SIGNALED,
+	};
+	uint32_t rx_data;
+
+	k_poll_event_init(&events[0], K_POLL_TYPE_SEM_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &wait_sem);
+	k_poll_event_init(&events[1], K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &wait_fifo);
+	k_poll_event_init(&events[2], K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &wait_msgq);
+	k_poll_event_init(&events[3], K_POLL_TYPE_SIGNAL,
+			  K_POLL_MODE_NOTIFY_ONLY, &wait_signal);
+
+	/**TESTPOINT: each object wakes up a thread waiting on all of them*/
+	for (int which = 0; which < ARRAY_SIZE(events); which++) {
+		for (int i = 0; i < ARRAY_SIZE(events); i++) {
+			events[i].state = K_POLL_STATE_NOT_READY;
+		}
+
+		k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE,
+					     poll_wait_helper,
+					     (void *)which, NULL, NULL,
+					     K_PRIO_PREEMPT(0), 0, 0);
+
+		assert_equal(k_poll(events, ARRAY_SIZE(events), K_FOREVER),
+			     0, "");
+
+		for (int i = 0; i < ARRAY_SIZE(events); i++) {
+			assert_equal(events[i].state,
+				     i == which ? expected[i] :
+						  K_POLL_STATE_NOT_READY, "");
+		}
+
+		k_thread_abort(tid);
+	}
+
+	assert_equal(k_sem_take(&wait_sem, K_NO_WAIT), 0, "");
+	assert_equal(k_fifo_get(&wait_fifo, K_NO_WAIT), &wait_msg, "");
+	assert_equal(k_msgq_get(&wait_msgq, &rx_data, K_NO_WAIT), 0, "");
+	assert_equal(wait_signal.result, SIGNAL_RESULT, "");
+	wait_signal.signaled = 0;
+
+	/**TESTPOINT: nothing happens, waiting period times out*/
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		events[i].state = K_POLL_STATE_NOT_READY;
+	}
+
+	assert_equal(k_poll(events, ARRAY_SIZE(events), TIMEOUT), -EAGAIN, "");
+
+	/**TESTPOINT: registrations are cleared after timing out*/
+	assert_equal(wait_sem.poll_event, NULL, "");
+	assert_equal(wait_fifo._queue.poll_event, NULL, "");
+	assert_equal(wait_msgq.poll_event, NULL, "");
+	assert_equal(wait_signal.poll_event, NULL, "");
+}
+
+static struct k_poll_signal isr_signal;
+
+static void isr_entry(void *p)
+{
+	k_poll_signal((struct k_poll_signal *)p, SIGNAL_RESULT);
+}
+
+static void isr_helper(void *p1, void *p2, void *p3)
+{
+	irq_offload(isr_entry, p1);
+}
+
+void test_poll_isr(void)
+{
+	struct k_poll_event event;
+
+	k_poll_signal_init(&isr_signal);
+	k_poll_event_init(&event, K_POLL_TYPE_SIGNAL,
+			  K_POLL_MODE_NOTIFY_ONLY, &isr_signal);
+
+	k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE, isr_helper,
+				     &isr_signal, NULL, NULL,
+				     K_PRIO_PREEMPT(0), 0, 0);
+
+	/**TESTPOINT: signal raised from ISR wakes up the poller*/
+	assert_equal(k_poll(&event, 1, K_FOREVER), 0, "");
+	assert_equal(event.state, K_POLL_STATE_SIGNALED, "");
+	assert_equal(isr_signal.result, SIGNAL_RESULT, "");
+
+	k_thread_abort(tid);
+}
+
+static struct k_sem eaddrinuse_sem;
+static int eaddrinuse_rc;
+
+static void eaddrinuse_helper(void *p1, void *p2, void *p3)
+{
+	struct k_poll_event event;
+
+	k_poll_event_init(&event, K_POLL_TYPE_SEM_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &eaddrinuse_sem);
+
+	/* the main thread is already polling on the semaphore */
+	eaddrinuse_rc = k_poll(&event, 1, TIMEOUT);
+
+	k_sem_give(&eaddrinuse_sem);
+}
+
+void test_poll_eaddrinuse(void)
+{
+	struct k_poll_event event;
+
+	k_sem_init(&eaddrinuse_sem, 0, 1);
+	eaddrinuse_rc = 0;
+
+	k_poll_event_init(&event, K_POLL_TYPE_SEM_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &eaddrinuse_sem);
+
+	/* lower priority: runs once we are pending in k_poll() */
+	k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE, eaddrinuse_helper,
+				     NULL, NULL, NULL,
+				     K_PRIO_PREEMPT(1), 0, 0);
+
+	/**TESTPOINT: a second poller cannot register on the same object*/
+	assert_equal(k_poll(&event, 1, K_FOREVER), 0, "");
+	assert_equal(event.state, K_POLL_STATE_SEM_AVAILABLE, "");
+	assert_equal(eaddrinuse_rc, -EADDRINUSE, "");
+
+	k_thread_abort(tid);
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_queue
+ * @{
+ * @defgroup t_queue_api test_queue_api
+ * @}
+ */
+
+#include <ztest.h>
+extern void test_queue_append_prepend(void);
+extern void test_queue_get_all(void);
+extern void test_queue_get_all_wait(void);
+extern void test_queue_lockless_isr(void);
+extern void test_queue_lockless_wakeup(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_queue_api,
+		ztest_unit_test(test_queue_append_prepend),
+		ztest_unit_test(test_queue_get_all),
+		ztest_unit_test(test_queue_get_all_wait),
+		ztest_unit_test(test_queue_lockless_isr),
+		ztest_unit_test(test_queue_lockless_wakeup));
+	ztest_run_test_suite(test_queue_api);
+}
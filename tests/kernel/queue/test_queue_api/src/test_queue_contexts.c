@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_queue_api
+ * @{
+ * @defgroup t_queue_api_basic test_queue_api_basic
+ * @brief TestPurpose: verify zephyr queue apis under different context
+ * - API coverage
+ *   -# k_queue_init K_QUEUE_DEFINE
+ *   -# k_queue_append k_queue_prepend k_queue_append_list
+ *   -# k_queue_merge_slist k_queue_append_lockless
+ *   -# k_queue_get k_queue_get_all k_queue_is_empty
+ * @}
+ */
+
+#include "test_queue.h"
+
+#define STACK_SIZE 512
+#define LIST_LEN 4
+#define TIMEOUT 100
+/**TESTPOINT: init via K_QUEUE_DEFINE*/
+K_QUEUE_DEFINE(kqueue);
+
+static struct k_queue queue;
+static qdata_t data[LIST_LEN];
+
+static char __noinit __stack tstack[STACK_SIZE];
+static struct k_sem end_sema;
+static void *rx_list;
+
+static void tqueue_check_list(void *head)
+{
+	for (int i = 0; i < LIST_LEN; i++) {
+		assert_equal(head, (void *)&data[i], NULL);
+		head = *(void **)head;
+	}
+	assert_is_null(head, NULL);
+}
+
+static void tIsr_entry_lockless(void *p)
+{
+	for (int i = 0; i < LIST_LEN; i++) {
+		/**TESTPOINT: queue append without locking from ISR*/
+		k_queue_append_lockless((struct k_queue *)p, &data[i]);
+	}
+}
+
+static void tThread_entry_get_all(void *p1, void *p2, void *p3)
+{
+	rx_list = k_queue_get_all((struct k_queue *)p1, K_FOREVER);
+	k_sem_give(&end_sema);
+}
+
+static void tThread_entry_get(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < LIST_LEN; i++) {
+		assert_equal(k_queue_get((struct k_queue *)p1, K_FOREVER),
+			     (void *)&data[i], NULL);
+	}
+	k_sem_give(&end_sema);
+}
+
+static void tqueue_spawn(k_thread_entry_t entry, struct k_queue *pqueue)
+{
+	k_sem_init(&end_sema, 0, 1);
+	k_thread_spawn(tstack, STACK_SIZE, entry, pqueue, NULL, NULL,
+		       K_PRIO_PREEMPT(0), 0, 0);
+}
+
+/*test cases*/
+void test_queue_append_prepend(void)
+{
+	k_queue_init(&queue);
+
+	/**TESTPOINT: append and prepend order*/
+	k_queue_append(&queue, &data[1]);
+	k_queue_append(&queue, &data[2]);
+	k_queue_prepend(&queue, &data[0]);
+	assert_false(k_queue_is_empty(&queue), NULL);
+
+	for (int i = 0; i < 3; i++) {
+		assert_equal(k_queue_get(&queue, K_NO_WAIT), (void *)&data[i],
+			     NULL);
+	}
+	assert_true(k_queue_is_empty(&queue), NULL);
+	assert_is_null(k_queue_get(&queue, TIMEOUT), NULL);
+}
+
+void test_queue_get_all(void)
+{
+	sys_slist_t slist;
+
+	/**TESTPOINT: get all items of a list and a slist at once*/
+	data[0].snode.next = &data[1].snode;
+	data[1].snode.next = NULL;
+	k_queue_append_list(&kqueue, &data[0], &data[1]);
+
+	sys_slist_init(&slist);
+	sys_slist_append(&slist, &data[2].snode);
+	sys_slist_append(&slist, &data[3].snode);
+	k_queue_merge_slist(&kqueue, &slist);
+
+	tqueue_check_list(k_queue_get_all(&kqueue, K_NO_WAIT));
+	assert_true(k_queue_is_empty(&kqueue), NULL);
+	assert_is_null(k_queue_get_all(&kqueue, K_NO_WAIT), NULL);
+}
+
+void test_queue_get_all_wait(void)
+{
+	k_queue_init(&queue);
+
+	/**TESTPOINT: a waiting thread takes a whole list in one wakeup*/
+	tqueue_spawn(tThread_entry_get_all, &queue);
+	k_sleep(TIMEOUT);
+
+	for (int i = 0; i < LIST_LEN - 1; i++) {
+		data[i].snode.next = &data[i + 1].snode;
+	}
+	data[LIST_LEN - 1].snode.next = NULL;
+	k_queue_append_list(&queue, &data[0], &data[LIST_LEN - 1]);
+
+	k_sem_take(&end_sema, K_FOREVER);
+	tqueue_check_list(rx_list);
+}
+
+void test_queue_lockless_isr(void)
+{
+	k_queue_init(&queue);
+
+	/**TESTPOINT: items appended from ISR keep their order*/
+	irq_offload(tIsr_entry_lockless, &queue);
+	assert_false(k_queue_is_empty(&queue), NULL);
+
+	tqueue_check_list(k_queue_get_all(&queue, K_NO_WAIT));
+}
+
+void test_queue_lockless_wakeup(void)
+{
+	k_queue_init(&queue);
+
+	/**TESTPOINT: items appended from ISR wake up a waiting thread*/
+	tqueue_spawn(tThread_entry_get, &queue);
+	k_sleep(TIMEOUT);
+
+	irq_offload(tIsr_entry_lockless, &queue);
+
+	assert_equal(k_sem_take(&end_sema, TIMEOUT), 0, NULL);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Semaphore wait queue ordering
+ *
+ * Threads of mixed priorities pend on a semaphore in scrambled order and
+ * must be woken up by priority, and in pend order within a priority,
+ * whichever wait queue implementation is selected.
+ */
+
+#include <ztest.h>
+
+#define NUM_WAITERS 12
+#define STACK_SIZE 512
+
+/* All higher than the cooperative priority of the test thread */
+static const int waiter_prio[NUM_WAITERS] = {
+	-3, -5, -2, -3, -4, -2, -5, -3, -4, -2, -5, -3
+};
+
+static char __stack waiter_stacks[NUM_WAITERS][STACK_SIZE];
+static K_SEM_DEFINE(wait_sem, 0, NUM_WAITERS);
+
+static int woken[NUM_WAITERS];
+static int num_woken;
+
+static void waiter_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	k_sem_take(&wait_sem, K_FOREVER);
+	woken[num_woken++] = (int)p1;
+}
+
+static void test_sema_wait_order(void)
+{
+	int i, prev, cur;
+
+	for (i = 0; i < NUM_WAITERS; i++) {
+		k_thread_spawn(waiter_stacks[i], STACK_SIZE, waiter_entry,
+			       (void *)i, NULL, NULL, waiter_prio[i], 0, 0);
+		/* let it pend, so that pend order is spawn order */
+		k_sleep(1);
+	}
+
+	for (i = 0; i < NUM_WAITERS; i++) {
+		k_sem_give(&wait_sem);
+		k_sleep(1);
+		assert_equal(num_woken, i + 1, "waiter not woken");
+	}
+
+	for (i = 1; i < NUM_WAITERS; i++) {
+		prev = woken[i - 1];
+		cur = woken[i];
+
+		assert_true(waiter_prio[prev] <= waiter_prio[cur],
+			    "lower priority waiter woken first");
+		if (waiter_prio[prev] == waiter_prio[cur]) {
+			assert_true(prev < cur, "not woken in pend order");
+		}
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_sema_wait_order,
+			 ztest_unit_test(test_sema_wait_order));
+	ztest_run_test_suite(test_sema_wait_order);
+}
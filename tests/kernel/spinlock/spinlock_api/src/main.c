@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_spinlock
+ * @{
+ * @defgroup t_spinlock_api test_spinlock_api
+ * @}
+ */
+
+#include <ztest.h>
+extern void test_spinlock_thread(void);
+extern void test_spinlock_isr(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_spinlock_api,
+			 ztest_unit_test(test_spinlock_thread),
+			 ztest_unit_test(test_spinlock_isr));
+	ztest_run_test_suite(test_spinlock_api);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_spinlock_api
+ * @{
+ * @defgroup t_spinlock_api_basic test_spinlock_api_basic
+ * @brief TestPurpose: verify zephyr spinlock apis
+ * - API coverage
+ *   -# K_SPINLOCK_DEFINE k_spin_lock k_spin_unlock
+ * @}
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+#include <spinlock.h>
+
+static K_SPINLOCK_DEFINE(lock);
+static volatile int counter;
+
+/*test cases*/
+void test_spinlock_thread(void)
+{
+	unsigned int key;
+
+	/**TESTPOINT: spinlock can be taken and given again*/
+	for (int i = 0; i < 2; i++) {
+		key = k_spin_lock(&lock);
+		counter++;
+		k_spin_unlock(&lock, key);
+	}
+
+	assert_equal(counter, 2, "");
+}
+
+static void isr_entry(void *p)
+{
+	unsigned int key = k_spin_lock(&lock);
+
+	counter++;
+	k_spin_unlock(&lock, key);
+}
+
+void test_spinlock_isr(void)
+{
+	counter = 0;
+
+	/**TESTPOINT: spinlock can be taken from an ISR*/
+	irq_offload(isr_entry, NULL);
+	assert_equal(counter, 1, "");
+
+	/**TESTPOINT: spinlock given in the ISR can be taken by a thread*/
+	unsigned int key = k_spin_lock(&lock);
+
+	counter++;
+	k_spin_unlock(&lock, key);
+	assert_equal(counter, 2, "");
+}
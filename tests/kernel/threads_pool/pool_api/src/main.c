@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+extern void test_pool_recycle(void);
+extern void test_pool_exhausted(void);
+extern void test_pool_wait(void);
+extern void test_pool_abort(void);
+extern void test_pool_cancel(void);
+extern void test_pool_no_refill(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_thread_pool,
+			 ztest_unit_test(test_pool_recycle),
+			 ztest_unit_test(test_pool_exhausted),
+			 ztest_unit_test(test_pool_wait),
+			 ztest_unit_test(test_pool_abort),
+			 ztest_unit_test(test_pool_cancel),
+			 ztest_unit_test(test_pool_no_refill));
+	ztest_run_test_suite(test_thread_pool);
+}
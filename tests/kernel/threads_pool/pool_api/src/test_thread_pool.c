@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_thread_pool
+ * @{
+ * @defgroup t_thread_pool_api test_thread_pool_api
+ * @brief TestPurpose: verify thread pools
+ * - API coverage
+ *   -# K_THREAD_POOL_DEFINE
+ *   -# k_thread_pool_spawn
+ *   -# k_thread_pool_num_used_get
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#define STACK_SIZE 1024
+#define NUM_STACKS 2
+#define SLEEP_MS 10
+#define STACK_DEPTH 256
+#define PRIO K_PRIO_PREEMPT(1)
+
+K_THREAD_POOL_DEFINE(tpool, STACK_SIZE, NUM_STACKS);
+
+static struct k_sem sync_sema;
+
+static void noop_entry(void *p1, void *p2, void *p3)
+{
+}
+
+static void blocking_entry(void *p1, void *p2, void *p3)
+{
+	k_sem_take(&sync_sema, K_FOREVER);
+}
+
+static void sleeping_entry(void *p1, void *p2, void *p3)
+{
+	k_sleep((int32_t)p1);
+}
+
+static void stack_entry(void *p1, void *p2, void *p3)
+{
+	volatile char buf[STACK_DEPTH];
+
+	memset((char *)buf, 0x55, sizeof(buf));
+	k_sem_take(&sync_sema, K_FOREVER);
+}
+
+/*test cases*/
+void test_pool_recycle(void)
+{
+	k_tid_t tid, tid2;
+
+	tid = k_thread_pool_spawn(&tpool, noop_entry, NULL, NULL, NULL,
+				  PRIO, 0, 0, K_NO_WAIT);
+	assert_not_null(tid, NULL);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 1, NULL);
+
+	/**TESTPOINT: the stack goes back to the pool on exit*/
+	k_sleep(SLEEP_MS);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 0, NULL);
+
+	/**TESTPOINT: the last stack given back is taken first*/
+	tid2 = k_thread_pool_spawn(&tpool, noop_entry, NULL, NULL, NULL,
+				   PRIO, 0, 0, K_NO_WAIT);
+	assert_equal(tid2, tid, NULL);
+	k_sleep(SLEEP_MS);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 0, NULL);
+}
+
+void test_pool_exhausted(void)
+{
+	int i;
+
+	k_sem_init(&sync_sema, 0, NUM_STACKS);
+
+	for (i = 0; i < NUM_STACKS; i++) {
+		assert_not_null(k_thread_pool_spawn(&tpool, blocking_entry,
+						    NULL, NULL, NULL, PRIO,
+						    0, 0, K_NO_WAIT), NULL);
+	}
+	k_sleep(SLEEP_MS);
+
+	/**TESTPOINT: no stack left*/
+	assert_is_null(k_thread_pool_spawn(&tpool, noop_entry, NULL, NULL,
+					   NULL, PRIO, 0, 0, K_NO_WAIT), NULL);
+	assert_is_null(k_thread_pool_spawn(&tpool, noop_entry, NULL, NULL,
+					   NULL, PRIO, 0, 0, SLEEP_MS), NULL);
+
+	for (i = 0; i < NUM_STACKS; i++) {
+		k_sem_give(&sync_sema);
+	}
+	k_sleep(SLEEP_MS);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 0, NULL);
+}
+
+void test_pool_wait(void)
+{
+	k_tid_t tid;
+	int i;
+
+	for (i = 0; i < NUM_STACKS; i++) {
+		tid = k_thread_pool_spawn(&tpool, sleeping_entry,
+					  (void *)SLEEP_MS, NULL, NULL,
+					  PRIO, 0, 0, K_NO_WAIT);
+		assert_not_null(tid, NULL);
+	}
+
+	/**TESTPOINT: a stack given back is handed to a waiting spawn*/
+	tid = k_thread_pool_spawn(&tpool, noop_entry, NULL, NULL, NULL,
+				  PRIO, 0, 0, K_FOREVER);
+	assert_not_null(tid, NULL);
+
+	k_sleep(SLEEP_MS * 2);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 0, NULL);
+}
+
+void test_pool_abort(void)
+{
+	k_tid_t tid;
+
+	k_sem_init(&sync_sema, 0, 1);
+	tid = k_thread_pool_spawn(&tpool, blocking_entry, NULL, NULL, NULL,
+				  PRIO, 0, 0, K_NO_WAIT);
+	k_sleep(SLEEP_MS);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 1, NULL);
+
+	/**TESTPOINT: the stack goes back to the pool on abort*/
+	k_thread_abort(tid);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 0, NULL);
+}
+
+void test_pool_cancel(void)
+{
+	k_tid_t tid;
+
+	tid = k_thread_pool_spawn(&tpool, noop_entry, NULL, NULL, NULL,
+				  PRIO, 0, SLEEP_MS * 10, K_NO_WAIT);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 1, NULL);
+
+	/**TESTPOINT: the stack goes back to the pool on cancel*/
+	assert_equal(k_thread_cancel(tid), 0, NULL);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 0, NULL);
+}
+
+void test_pool_no_refill(void)
+{
+	struct k_thread_stats stats;
+	k_tid_t tid, tid2;
+
+	k_sem_init(&sync_sema, 0, 1);
+	tid = k_thread_pool_spawn(&tpool, stack_entry, NULL, NULL, NULL,
+				  PRIO, 0, 0, K_NO_WAIT);
+	k_sleep(SLEEP_MS);
+	k_sem_give(&sync_sema);
+	k_sleep(SLEEP_MS);
+
+	tid2 = k_thread_pool_spawn(&tpool, blocking_entry, NULL, NULL, NULL,
+				   PRIO, 0, 0, K_NO_WAIT);
+	assert_equal(tid2, tid, NULL);
+	k_sleep(SLEEP_MS);
+
+	/**TESTPOINT: a recycled stack keeps the high-water of its threads*/
+	k_thread_stats_get(tid2, &stats);
+	assert_true(stats.stack_used >= STACK_DEPTH, NULL);
+
+	k_sem_give(&sync_sema);
+	k_sleep(SLEEP_MS);
+	assert_equal(k_thread_pool_num_used_get(&tpool), 0, NULL);
+}
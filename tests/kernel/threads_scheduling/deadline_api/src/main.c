@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_kernel_threads
+ * @{
+ * @defgroup t_threads_deadline test_threads_deadline
+ * @brief TestPurpose: verify earliest-deadline-first scheduling of threads
+ * of equal priority
+ * @}
+ */
+
+#include <ztest.h>
+extern void test_deadline_order(void);
+extern void test_deadline_preempt(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_threads_deadline,
+			 ztest_unit_test(test_deadline_order),
+			 ztest_unit_test(test_deadline_preempt));
+	ztest_run_test_suite(test_threads_deadline);
+}
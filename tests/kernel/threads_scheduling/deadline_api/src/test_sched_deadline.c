@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#define STACK_SIZE 512
+#define NUM_THREADS 4
+#define THREAD_PRIO K_PRIO_PREEMPT(5)
+
+static char __noinit __stack tstack[NUM_THREADS][STACK_SIZE];
+static k_tid_t tid[NUM_THREADS];
+
+static int run_order[NUM_THREADS];
+static int num_run;
+
+static void thread_entry(void *p1, void *p2, void *p3)
+{
+	run_order[num_run++] = (int)p1;
+}
+
+/*test cases*/
+void test_deadline_order(void)
+{
+	/* deadline of each thread, -1 for none */
+	static const int32_t deadlines[NUM_THREADS] = { 300, -1, 100, 200 };
+	static const int expected[NUM_THREADS] = { 2, 3, 0, 1 };
+
+	num_run = 0;
+
+	/* lower priority than us: the threads do not run until we sleep */
+	for (int i = 0; i < NUM_THREADS; i++) {
+		tid[i] = k_thread_spawn(tstack[i], STACK_SIZE, thread_entry,
+					(void *)i, NULL, NULL,
+					THREAD_PRIO, 0, 0);
+		k_thread_deadline_set(tid[i], deadlines[i]);
+	}
+
+	assert_equal(num_run, 0, "");
+
+	k_sleep(100);
+
+	/**TESTPOINT: equal priority threads run by earliest deadline,
+	 * threads without a deadline last
+	 */
+	assert_equal(num_run, NUM_THREADS, "");
+	for (int i = 0; i < NUM_THREADS; i++) {
+		assert_equal(run_order[i], expected[i], "");
+	}
+}
+
+void test_deadline_preempt(void)
+{
+	int old_prio = k_thread_priority_get(k_current_get());
+
+	num_run = 0;
+
+	k_thread_priority_set(k_current_get(), THREAD_PRIO);
+	k_thread_deadline_set(k_current_get(), 200);
+
+	tid[0] = k_thread_spawn(tstack[0], STACK_SIZE, thread_entry,
+				(void *)0, NULL, NULL, THREAD_PRIO, 0, 0);
+
+	/**TESTPOINT: no preemption by a thread with no earlier deadline*/
+	assert_equal(num_run, 0, "");
+	k_thread_deadline_set(tid[0], 300);
+	assert_equal(num_run, 0, "");
+
+	/**TESTPOINT: preemption by a thread given an earlier deadline*/
+	k_thread_deadline_set(tid[0], 100);
+	assert_equal(num_run, 1, "");
+
+	/* restore environment */
+	k_thread_deadline_set(k_current_get(), -1);
+	k_thread_priority_set(k_current_get(), old_prio);
+}
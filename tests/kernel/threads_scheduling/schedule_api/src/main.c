@@ -26,6 +26,8 @@ void test_main(void *p1, void *p2, void *p3)
 		ztest_unit_test(test_sleep_wakeup_preemptible),
 		ztest_unit_test(test_time_slicing_preemptible),
 		ztest_unit_test(test_time_slicing_disable_preemptible),
+		ztest_unit_test(test_time_slicing_thread_budget),
+		ztest_unit_test(test_time_slicing_thread_override),
 		ztest_unit_test(test_lock_preemptible),
 		ztest_unit_test(test_unlock_preemptible)
 		);
@@ -29,6 +29,8 @@ void test_sleep_cooperative(void);
 void test_sleep_wakeup_preemptible(void);
 void test_time_slicing_preemptible(void);
 void test_time_slicing_disable_preemptible(void);
+void test_time_slicing_thread_budget(void);
+void test_time_slicing_thread_override(void);
 void test_lock_preemptible(void);
 void test_unlock_preemptible(void);
 
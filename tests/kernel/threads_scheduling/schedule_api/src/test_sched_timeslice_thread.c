@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_threads_scheduling
+ * @{
+ * @defgroup t_sched_timeslice_thread test_sched_timeslice_thread
+ * @brief TestPurpose: verify per-thread time slices
+ * - API coverage
+ *   -# k_thread_time_slice_set
+ * @}
+ */
+
+#include "test_sched.h"
+
+static char __noinit __stack tstack[STACK_SIZE];
+static volatile int executed;
+
+static void thread_entry(void *p1, void *p2, void *p3)
+{
+	executed = 1;
+}
+
+static int run_with_peer(void)
+{
+	int old_prio = k_thread_priority_get(k_current_get());
+	k_tid_t tid;
+
+	/* set current thread to a preemptible priority */
+	k_thread_priority_set(k_current_get(), 0);
+
+	executed = 0;
+	tid = k_thread_spawn(tstack, STACK_SIZE, thread_entry, NULL, NULL, NULL,
+			     0, 0, 0);
+	k_busy_wait(500000); /* 500 ms */
+
+	k_thread_abort(tid);
+	k_thread_priority_set(k_current_get(), old_prio);
+
+	return executed;
+}
+
+/*test cases*/
+void test_time_slicing_thread_budget(void)
+{
+	k_sched_time_slice_set(0, 0); /* disable time slice */
+	k_thread_time_slice_set(k_current_get(), 200); /* 200 ms */
+
+	/**TESTPOINT: a thread with a budget is sliced on its own*/
+	assert_true(run_with_peer() == 1, NULL);
+
+	k_thread_time_slice_set(k_current_get(), 0);
+}
+
+void test_time_slicing_thread_override(void)
+{
+	k_sched_time_slice_set(200, 0); /* 200 ms */
+	k_thread_time_slice_set(k_current_get(), 1000); /* 1 s */
+
+	/**TESTPOINT: a thread budget overrides the global slice size*/
+	assert_true(run_with_peer() == 0, NULL);
+
+	/**TESTPOINT: a zero budget falls back to the global slice size*/
+	k_thread_time_slice_set(k_current_get(), 0);
+	assert_true(run_with_peer() == 1, NULL);
+
+	k_sched_time_slice_set(0, 0); /* disable time slice */
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+extern void test_stats_cycles(void);
+extern void test_stats_switches(void);
+extern void test_stats_yield(void);
+extern void test_stats_stack(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_thread_stats,
+			 ztest_unit_test(test_stats_cycles),
+			 ztest_unit_test(test_stats_switches),
+			 ztest_unit_test(test_stats_yield),
+			 ztest_unit_test(test_stats_stack));
+	ztest_run_test_suite(test_thread_stats);
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_thread_stats
+ * @{
+ * @defgroup t_thread_stats_api test_thread_stats_api
+ * @brief TestPurpose: verify thread runtime statistics
+ * - API coverage
+ *   -# k_thread_stats_get
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#define STACK_SIZE 1024
+#define SLEEP_MS 10
+#define BUSY_US 1000
+#define STACK_DEPTH 256
+
+static char __noinit __stack tstack[STACK_SIZE];
+static struct k_sem sync_sema;
+static volatile int stop;
+
+static void blocking_spinning_entry(void *p1, void *p2, void *p3)
+{
+	/* voluntary switch out */
+	k_sem_take(&sync_sema, K_FOREVER);
+
+	/* preempted by the main thread waking up */
+	while (!stop) {
+		;
+	}
+}
+
+static void noop_entry(void *p1, void *p2, void *p3)
+{
+}
+
+static void stack_entry(void *p1, void *p2, void *p3)
+{
+	volatile char buf[STACK_DEPTH];
+
+	memset((char *)buf, 0x55, sizeof(buf));
+	k_sem_take(&sync_sema, K_FOREVER);
+}
+
+/*test cases*/
+void test_stats_cycles(void)
+{
+	struct k_thread_stats before, after;
+
+	k_thread_stats_get(k_current_get(), &before);
+	k_busy_wait(BUSY_US);
+	k_thread_stats_get(k_current_get(), &after);
+
+	/**TESTPOINT: the ongoing run of the current thread is accounted*/
+	assert_true(after.cycles - before.cycles >=
+		    (uint64_t)sys_clock_hw_cycles_per_tick *
+		    BUSY_US / sys_clock_us_per_tick, NULL);
+}
+
+void test_stats_switches(void)
+{
+	struct k_thread_stats stats;
+	k_tid_t tid;
+
+	k_sem_init(&sync_sema, 0, 1);
+	stop = 0;
+	tid = k_thread_spawn(tstack, STACK_SIZE, blocking_spinning_entry,
+			     NULL, NULL, NULL, K_PRIO_PREEMPT(1), 0, 0);
+
+	/**TESTPOINT: blocking is a voluntary switch out*/
+	k_sleep(SLEEP_MS);
+	k_thread_stats_get(tid, &stats);
+	assert_equal(stats.num_switches, 1, NULL);
+	assert_equal(stats.num_preemptions, 0, NULL);
+	assert_true(stats.cycles > 0, NULL);
+
+	/**TESTPOINT: being switched out while ready is a preemption*/
+	k_sem_give(&sync_sema);
+	k_sleep(SLEEP_MS);
+	k_thread_stats_get(tid, &stats);
+	assert_equal(stats.num_switches, 2, NULL);
+	assert_equal(stats.num_preemptions, 1, NULL);
+
+	stop = 1;
+	k_sleep(SLEEP_MS);
+}
+
+void test_stats_yield(void)
+{
+	struct k_thread_stats before, after;
+
+	k_thread_stats_get(k_current_get(), &before);
+
+	/* same priority as the main thread: runs when it yields */
+	k_thread_spawn(tstack, STACK_SIZE, noop_entry, NULL, NULL, NULL,
+		       k_thread_priority_get(k_current_get()), 0, 0);
+	k_yield();
+
+	k_thread_stats_get(k_current_get(), &after);
+
+	/**TESTPOINT: yielding is a voluntary switch out*/
+	assert_equal(after.num_switches, before.num_switches + 1, NULL);
+	assert_equal(after.num_preemptions, before.num_preemptions, NULL);
+}
+
+void test_stats_stack(void)
+{
+	struct k_thread_stats stats;
+	k_tid_t tid;
+
+	k_sem_init(&sync_sema, 0, 1);
+	tid = k_thread_spawn(tstack, STACK_SIZE, stack_entry, NULL, NULL, NULL,
+			     K_PRIO_PREEMPT(1), 0, 0);
+	k_sleep(SLEEP_MS);
+
+	/**TESTPOINT: stack high-water covers the deepest local buffer*/
+	k_thread_stats_get(tid, &stats);
+	assert_true(stats.stack_size < STACK_SIZE, NULL);
+	assert_true(stats.stack_used >= STACK_DEPTH, NULL);
+	assert_true(stats.stack_used <= stats.stack_size, NULL);
+
+	k_thread_abort(tid);
+}
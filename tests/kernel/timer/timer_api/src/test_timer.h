@@ -22,5 +22,13 @@ void test_timer_status_get_anytime(void);
 void test_timer_status_sync(void);
 void test_timer_k_define(void);
 void test_timer_user_data(void);
+void test_timer_hires_conversion(void);
+void test_timer_hires_sleep(void);
+void test_timer_hires_period(void);
+void test_timer_aligned_period(void);
+void test_timer_aligned_overrun(void);
+void test_timer_slack(void);
+void test_timer_cycle_64(void);
+void test_timer_cycle_to_ns(void);
 
 #endif /* __TEST_TIMER_H__ */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_timer.h"
+#include <ztest.h>
+
+#define ALIGNED_DURATION 100
+#define ALIGNED_PERIOD 50
+#define ALIGNED_EXPIRE_TIMES 4
+
+static struct k_timer aligned_timer;
+
+/* test cases */
+void test_timer_aligned_period(void)
+{
+	int64_t start, elapsed;
+	uint32_t expired = 0;
+
+	k_timer_init(&aligned_timer, NULL, NULL);
+
+	/** TESTPOINT: aligned timer expires once per period */
+	start = k_uptime_get();
+	k_timer_start_aligned(&aligned_timer, ALIGNED_DURATION,
+			      ALIGNED_PERIOD);
+
+	while (expired < ALIGNED_EXPIRE_TIMES) {
+		expired += k_timer_status_sync(&aligned_timer);
+	}
+
+	elapsed = k_uptime_get() - start;
+	k_timer_stop(&aligned_timer);
+
+	assert_true(elapsed >= ALIGNED_DURATION +
+		    (ALIGNED_EXPIRE_TIMES - 1) * ALIGNED_PERIOD, NULL);
+
+	/** TESTPOINT: no period missed when processed on time */
+	assert_equal(k_timer_overruns_get(&aligned_timer), 0, NULL);
+}
+
+void test_timer_aligned_overrun(void)
+{
+	uint32_t overruns;
+	unsigned int key;
+
+	k_timer_init(&aligned_timer, NULL, NULL);
+	k_timer_start_aligned(&aligned_timer, ALIGNED_PERIOD, ALIGNED_PERIOD);
+
+	/* delay the processing of the timer by several periods */
+	key = irq_lock();
+	k_busy_wait((ALIGNED_PERIOD * 7 / 2) * USEC_PER_MSEC);
+	irq_unlock(key);
+
+	k_timer_status_sync(&aligned_timer);
+	k_timer_stop(&aligned_timer);
+
+	overruns = k_timer_overruns_get(&aligned_timer);
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	/** TESTPOINT: late processing is reported as missed periods */
+	assert_true(overruns > 0, NULL);
+#endif
+
+	/** TESTPOINT: reading the overruns resets them */
+	assert_equal(k_timer_overruns_get(&aligned_timer), 0, NULL);
+
+	/** TESTPOINT: restarting the timer resets the overruns */
+	aligned_timer.overruns = overruns + 1;
+	k_timer_start_aligned(&aligned_timer, ALIGNED_PERIOD, ALIGNED_PERIOD);
+	k_timer_stop(&aligned_timer);
+	assert_equal(k_timer_overruns_get(&aligned_timer), 0, NULL);
+}
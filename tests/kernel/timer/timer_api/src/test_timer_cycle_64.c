@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_timer.h"
+#include <ztest.h>
+
+#define CYCLE_64_SLEEP 50
+#define CYCLE_64_READS 1000
+
+/* test cases */
+void test_timer_cycle_64(void)
+{
+	uint64_t prev, now;
+	uint32_t now_32;
+	int i;
+
+	/** TESTPOINT: the 64-bit count extends the 32-bit one */
+	prev = k_cycle_get_64();
+	now_32 = k_cycle_get_32();
+	now = k_cycle_get_64();
+	assert_true(now_32 - (uint32_t)prev <= (uint32_t)(now - prev), NULL);
+
+	/** TESTPOINT: the 64-bit count never goes backwards */
+	for (i = 0; i < CYCLE_64_READS; i++) {
+		now = k_cycle_get_64();
+		assert_true(now >= prev, NULL);
+		prev = now;
+	}
+
+	/** TESTPOINT: it keeps counting across ticks */
+	prev = k_cycle_get_64();
+	k_sleep(CYCLE_64_SLEEP);
+	now = k_cycle_get_64();
+	assert_true(k_cycle_to_ns_64(now - prev) >=
+		    (uint64_t)(CYCLE_64_SLEEP - 1) * NSEC_PER_USEC *
+		    USEC_PER_MSEC, NULL);
+}
+
+void test_timer_cycle_to_ns(void)
+{
+	uint64_t cycles;
+
+	/** TESTPOINT: matches the division, up to rounding */
+	cycles = sys_clock_hw_cycles_per_sec;
+	assert_true(k_cycle_to_ns_64(cycles) <= NSEC_PER_SEC, NULL);
+	assert_true(k_cycle_to_ns_64(cycles) >= NSEC_PER_SEC - 1, NULL);
+
+	/** TESTPOINT: the conversion does not overflow past 32-bit cycles */
+	cycles = (uint64_t)sys_clock_hw_cycles_per_sec * 3600;
+	assert_true(k_cycle_to_ns_64(cycles) <=
+		    (uint64_t)NSEC_PER_SEC * 3600, NULL);
+	assert_true(k_cycle_to_ns_64(cycles) >=
+		    (uint64_t)NSEC_PER_SEC * 3600 - 3600, NULL);
+
+	assert_equal(k_cycle_to_ns_64(0), 0, NULL);
+}
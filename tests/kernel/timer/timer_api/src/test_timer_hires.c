@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_timer.h"
+#include <ztest.h>
+
+#define HIRES_TICKS 3
+#define HIRES_EXPIRE_TIMES 4
+
+static struct k_timer hires_timer;
+static volatile int hires_expire_cnt;
+
+static uint32_t ticks_to_us(int32_t ticks)
+{
+	return (uint32_t)ticks * sys_clock_us_per_tick;
+}
+
+static uint32_t ticks_to_cycles(int32_t ticks)
+{
+	return (uint32_t)ticks * sys_clock_hw_cycles_per_tick;
+}
+
+static void hires_expire(struct k_timer *timer)
+{
+	hires_expire_cnt++;
+}
+
+/* test cases */
+void test_timer_hires_conversion(void)
+{
+	uint32_t now;
+
+	/** TESTPOINT: high-resolution timeouts are not special values */
+	assert_true(K_USEC(0) != K_NO_WAIT, NULL);
+	assert_true(K_USEC(_K_TIMEOUT_VALUE_MASK) != K_FOREVER, NULL);
+	assert_true(K_CYCLES_ABS(0xffffffff) != K_FOREVER, NULL);
+
+	/** TESTPOINT: relative timeouts are rounded up to ticks */
+	assert_equal(_timeout_to_ticks(K_USEC(1)), 1, NULL);
+	assert_equal(_timeout_to_ticks(K_USEC(ticks_to_us(HIRES_TICKS))),
+		     HIRES_TICKS, NULL);
+	assert_equal(_timeout_to_ticks(K_USEC(ticks_to_us(HIRES_TICKS) + 1)),
+		     HIRES_TICKS + 1, NULL);
+	assert_equal(_timeout_to_ticks(K_CYCLES(1)), 1, NULL);
+	assert_equal(_timeout_to_ticks(K_CYCLES(ticks_to_cycles(HIRES_TICKS))),
+		     HIRES_TICKS, NULL);
+
+	/** TESTPOINT: millisecond timeouts are unchanged */
+	assert_equal(_timeout_to_ticks(K_MSEC(100)), _ms_to_ticks(100), NULL);
+
+	/** TESTPOINT: absolute deadlines are relative to the hardware clock */
+	now = k_cycle_get_32();
+	assert_equal(_timeout_to_ticks(K_CYCLES_ABS(now - 1)), 0, NULL);
+
+	now = k_cycle_get_32();
+	int32_t ticks = _timeout_to_ticks(
+		K_CYCLES_ABS(now + ticks_to_cycles(HIRES_TICKS)));
+
+	assert_true(ticks <= HIRES_TICKS && ticks >= HIRES_TICKS - 1, NULL);
+}
+
+void test_timer_hires_sleep(void)
+{
+	uint32_t start, elapsed;
+
+	/** TESTPOINT: sleep for a duration given in microseconds */
+	start = k_cycle_get_32();
+	k_sleep(K_USEC(ticks_to_us(HIRES_TICKS)));
+	elapsed = k_cycle_get_32() - start;
+	assert_true(elapsed >= ticks_to_cycles(HIRES_TICKS), NULL);
+
+	/** TESTPOINT: sleep until an absolute deadline */
+	start = k_cycle_get_32();
+	k_sleep(K_CYCLES_ABS(start + ticks_to_cycles(HIRES_TICKS)));
+	elapsed = k_cycle_get_32() - start;
+	assert_true(elapsed >= ticks_to_cycles(HIRES_TICKS), NULL);
+
+	/** TESTPOINT: a deadline already past does not sleep */
+	start = k_cycle_get_32();
+	k_sleep(K_CYCLES_ABS(start - 1));
+	elapsed = k_cycle_get_32() - start;
+	assert_true(elapsed < ticks_to_cycles(1), NULL);
+}
+
+void test_timer_hires_period(void)
+{
+	uint32_t start, elapsed;
+
+	hires_expire_cnt = 0;
+	k_timer_init(&hires_timer, hires_expire, NULL);
+
+	/** TESTPOINT: periodic timer with a period given in microseconds */
+	start = k_cycle_get_32();
+	k_timer_start(&hires_timer, K_USEC(ticks_to_us(HIRES_TICKS)),
+		      K_USEC(ticks_to_us(HIRES_TICKS)));
+
+	while (hires_expire_cnt < HIRES_EXPIRE_TIMES) {
+		k_timer_status_sync(&hires_timer);
+	}
+
+	elapsed = k_cycle_get_32() - start;
+	k_timer_stop(&hires_timer);
+
+	assert_true(elapsed >=
+		    ticks_to_cycles(HIRES_TICKS * HIRES_EXPIRE_TIMES), NULL);
+}
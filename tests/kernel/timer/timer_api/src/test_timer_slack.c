@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_timer.h"
+#include <ztest.h>
+
+#define EXACT_DURATION 100
+#define SLACK_DURATION 80
+#define SLACK 40
+
+/* tick alignment and rounding of the durations */
+#define TICK_MARGIN (2 * MSEC_PER_SEC / CONFIG_SYS_CLOCK_TICKS_PER_SEC)
+
+static struct k_timer exact_timer, slack_timer;
+static int64_t exact_expiry, slack_expiry;
+
+static void exact_expire(struct k_timer *timer)
+{
+	exact_expiry = k_uptime_get();
+}
+
+static void slack_expire(struct k_timer *timer)
+{
+	slack_expiry = k_uptime_get();
+}
+
+/* test cases */
+void test_timer_slack(void)
+{
+	int64_t start;
+
+	k_timer_init(&exact_timer, exact_expire, NULL);
+	k_timer_init(&slack_timer, slack_expire, NULL);
+	k_timer_slack_set(&slack_timer, SLACK);
+
+	start = k_uptime_get();
+	k_timer_start(&exact_timer, EXACT_DURATION, 0);
+	k_timer_start(&slack_timer, SLACK_DURATION, 0);
+
+	k_timer_status_sync(&exact_timer);
+	k_timer_status_sync(&slack_timer);
+
+	/** TESTPOINT: a timer with slack does not expire early */
+	assert_true(slack_expiry - start >= SLACK_DURATION, NULL);
+
+	/** TESTPOINT: nor later than its slack allows */
+	assert_true(slack_expiry - start <=
+		    SLACK_DURATION + SLACK + TICK_MARGIN, NULL);
+
+#ifndef CONFIG_TIMEOUT_WHEEL
+	/** TESTPOINT: it expires with a timeout queued in its slack */
+	assert_equal(slack_expiry, exact_expiry, NULL);
+#endif
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+extern void test_workq_pool_parallel(void);
+extern void test_workq_pool_ordered(void);
+extern void test_sys_workq_pool(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_workq_pool,
+		ztest_unit_test(test_workq_pool_parallel),
+		ztest_unit_test(test_workq_pool_ordered),
+		ztest_unit_test(test_sys_workq_pool));
+	ztest_run_test_suite(test_workq_pool);
+}
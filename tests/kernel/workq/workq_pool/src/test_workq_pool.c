@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2017 Wind River Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_workq
+ * @{
+ * @defgroup t_workq_pool test_workq_pool
+ * @brief TestPurpose: verify work queues backed by several threads
+ * - API coverage
+ *   -# k_work_q_start_pool
+ *   -# k_work_submit_to_queue
+ *   -# k_work_submit
+ * @}
+ */
+
+#include <ztest.h>
+
+#define TIMEOUT 100
+#define STACK_SIZE 512
+#define NUM_THREADS 2
+
+static char __noinit __stack pool_stacks[NUM_THREADS][STACK_SIZE];
+static char __noinit __stack ordered_stacks[NUM_THREADS][STACK_SIZE];
+static struct k_work_q pool_workq, ordered_workq;
+static struct k_work slow_work, fast_work;
+static struct k_sem release_sema, slow_done_sema, fast_done_sema;
+static int seq, slow_seq, fast_seq;
+
+static void slow_handler(struct k_work *w)
+{
+	/* stands for a long operation, e.g. a flash erase */
+	k_sem_take(&release_sema, K_FOREVER);
+	slow_seq = ++seq;
+	k_sem_give(&slow_done_sema);
+}
+
+static void fast_handler(struct k_work *w)
+{
+	fast_seq = ++seq;
+	k_sem_give(&fast_done_sema);
+}
+
+static void reset(void)
+{
+	k_sem_init(&release_sema, 0, 1);
+	k_sem_init(&slow_done_sema, 0, 1);
+	k_sem_init(&fast_done_sema, 0, 1);
+	k_work_init(&slow_work, slow_handler);
+	k_work_init(&fast_work, fast_handler);
+	seq = slow_seq = fast_seq = 0;
+}
+
+static void check_not_stalled(void)
+{
+	/**TESTPOINT: a blocked handler does not stall the other items*/
+	assert_equal(k_sem_take(&fast_done_sema, TIMEOUT), 0, NULL);
+	assert_equal(fast_seq, 1, NULL);
+	assert_equal(slow_seq, 0, NULL);
+
+	k_sem_give(&release_sema);
+	assert_equal(k_sem_take(&slow_done_sema, TIMEOUT), 0, NULL);
+	assert_equal(slow_seq, 2, NULL);
+}
+
+/*test cases*/
+void test_workq_pool_parallel(void)
+{
+	reset();
+	k_work_q_start_pool(&pool_workq, pool_stacks[0], STACK_SIZE,
+			    NUM_THREADS, K_PRIO_PREEMPT(0), 0);
+
+	k_work_submit_to_queue(&pool_workq, &slow_work);
+	k_work_submit_to_queue(&pool_workq, &fast_work);
+	check_not_stalled();
+}
+
+void test_workq_pool_ordered(void)
+{
+	reset();
+	k_work_q_start_pool(&ordered_workq, ordered_stacks[0], STACK_SIZE,
+			    NUM_THREADS, K_PRIO_PREEMPT(0), K_WORK_Q_ORDERED);
+
+	k_work_submit_to_queue(&ordered_workq, &slow_work);
+	k_work_submit_to_queue(&ordered_workq, &fast_work);
+
+	/**TESTPOINT: an ordered pool processes items one at a time*/
+	assert_equal(k_sem_take(&fast_done_sema, TIMEOUT), -EAGAIN, NULL);
+
+	k_sem_give(&release_sema);
+	assert_equal(k_sem_take(&slow_done_sema, TIMEOUT), 0, NULL);
+	assert_equal(k_sem_take(&fast_done_sema, TIMEOUT), 0, NULL);
+
+	/**TESTPOINT: an ordered pool processes items in submission order*/
+	assert_equal(slow_seq, 1, NULL);
+	assert_equal(fast_seq, 2, NULL);
+}
+
+void test_sys_workq_pool(void)
+{
+	reset();
+
+	k_work_submit(&slow_work);
+	k_work_submit(&fast_work);
+	check_not_stalled();
+}
@@ -0,0 +1,589 @@
+/* main.c - Networking stack benchmarks */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Each benchmark runs its operation BENCH_ITERATIONS times and only the
+ * cycles spent in the measured code are counted, the packets being built
+ * beforehand. A line is printed per benchmark, to be parsed by scripts:
+ *
+ * BENCH name=<name> ops=<n> cycles_per_op=<c> ns_per_op=<t>
+ *       ops_per_sec=<p> [bytes_per_sec=<b>]
+ *
+ * (on one line), then "BENCH done failures=<n>" once all are run.
+ */
+
+#include <zephyr.h>
+#include <sections.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <device.h>
+#include <init.h>
+#include <misc/printk.h>
+#include <net/net_core.h>
+#include <net/nbuf.h>
+#include <net/net_ip.h>
+#include <net/net_context.h>
+
+#include <tc_util.h>
+
+#include "net_private.h"
+#include "connection.h"
+#include "udp.h"
+#include "tcp.h"
+#include "6lo.h"
+#include "ipv6.h"
+#include "route.h"
+
+#define BENCH_ITERATIONS 1000
+
+/* Size of the UDP payloads: a full IPv6 minimum MTU packet, and what a
+ * single 802.15.4 frame can carry once compressed.
+ */
+#define CHKSUM_PAYLOAD_LEN (NET_IPV6_MTU - NET_IPV6UDPH_LEN)
+#define SMALL_PAYLOAD_LEN 40
+#define UDP_PAYLOAD_LEN 512
+
+/* A few connections are registered, the packets are for the last one */
+#define DEMUX_CONNS 8
+#define DEMUX_PORT 5000
+#define LOOPBACK_PORT 6000
+#define PEER_PORT 7000
+
+static uint8_t src_mac[8] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xaa, 0xbb };
+static uint8_t dst_mac[8] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xbb, 0xaa };
+
+/* Link local addresses derived from the MAC addresses above, so that the
+ * 6LoWPAN header compression is the best one.
+ */
+static struct in6_addr src_ll = { { { 0xfe, 0x80, 0, 0, 0, 0, 0, 0,
+				      0, 0, 0, 0, 0, 0, 0xaa, 0xbb } } };
+static struct in6_addr dst_ll = { { { 0xfe, 0x80, 0, 0, 0, 0, 0, 0,
+				      0, 0, 0, 0, 0, 0, 0xbb, 0xaa } } };
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+static struct in6_addr loopback_addr = { { { 0, 0, 0, 0, 0, 0, 0, 0,
+					     0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+
+/* The routes go through the peer, the route looked up is the last one */
+static struct in6_addr route_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 0,
+					  0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+
+static uint8_t payload[CHKSUM_PAYLOAD_LEN];
+
+static struct net_if *iface;
+static struct net_buf *chksum_buf;
+static struct net_context *udp_tx_ctx;
+static struct net_context *udp_rx_ctx;
+
+/* What the receiving ends got, checked by the benchmarks */
+static uint32_t rx_count;
+static uint32_t rx_bytes;
+static uint32_t tx_count;
+
+static int bench_dev_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+static void bench_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, src_mac, sizeof(src_mac));
+}
+
+static int bench_iface_send(struct net_if *iface, struct net_buf *buf)
+{
+	tx_count++;
+
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static struct net_if_api bench_iface_api = {
+	.init = bench_iface_init,
+	.send = bench_iface_send,
+};
+
+NET_DEVICE_INIT(net_bench, "net_bench",
+		bench_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&bench_iface_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2),
+		NET_IPV6_MTU);
+
+/* Build an IPv6 packet with an UDP or TCP header, and the given length of
+ * payload after it.
+ */
+static struct net_buf *build_ipv6(enum net_ip_protocol proto,
+				  struct in6_addr *src, struct in6_addr *dst,
+				  uint16_t src_port, uint16_t dst_port,
+				  uint16_t len)
+{
+	uint16_t hdr_len = proto == IPPROTO_UDP ? NET_UDPH_LEN : NET_TCPH_LEN;
+	struct net_buf *buf, *frag;
+
+	buf = net_nbuf_get_reserve_tx(0);
+	if (!buf) {
+		return NULL;
+	}
+
+	frag = net_nbuf_get_reserve_data(0);
+	if (!frag) {
+		net_nbuf_unref(buf);
+		return NULL;
+	}
+
+	net_buf_frag_add(buf, frag);
+
+	net_nbuf_set_iface(buf, iface);
+	net_nbuf_set_family(buf, AF_INET6);
+	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ext_len(buf, 0);
+
+	net_nbuf_ll_src(buf)->addr = src_mac;
+	net_nbuf_ll_src(buf)->len = sizeof(src_mac);
+	net_nbuf_ll_dst(buf)->addr = dst_mac;
+	net_nbuf_ll_dst(buf)->len = sizeof(dst_mac);
+
+	memset(net_buf_add(frag, NET_IPV6H_LEN + hdr_len), 0,
+	       NET_IPV6H_LEN + hdr_len);
+
+	NET_IPV6_BUF(buf)->vtc = 0x60;
+	NET_IPV6_BUF(buf)->len[0] = (hdr_len + len) >> 8;
+	NET_IPV6_BUF(buf)->len[1] = (uint8_t)(hdr_len + len);
+	NET_IPV6_BUF(buf)->nexthdr = proto;
+	NET_IPV6_BUF(buf)->hop_limit = 64;
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->src, src);
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, dst);
+
+	if (proto == IPPROTO_UDP) {
+		NET_UDP_BUF(buf)->src_port = htons(src_port);
+		NET_UDP_BUF(buf)->dst_port = htons(dst_port);
+		NET_UDP_BUF(buf)->len = htons(NET_UDPH_LEN + len);
+	} else {
+		NET_TCP_BUF(buf)->src_port = htons(src_port);
+		NET_TCP_BUF(buf)->dst_port = htons(dst_port);
+		NET_TCP_BUF(buf)->offset = NET_TCPH_LEN << 2;
+		NET_TCP_BUF(buf)->flags = NET_TCP_ACK;
+		NET_TCP_BUF(buf)->wnd[0] = 0x10;
+	}
+
+	if (len && !net_nbuf_append(buf, len, payload)) {
+		net_nbuf_unref(buf);
+		return NULL;
+	}
+
+	return buf;
+}
+
+static enum net_verdict demux_cb(struct net_conn *conn, struct net_buf *buf,
+				 void *user_data)
+{
+	rx_count++;
+
+	net_nbuf_unref(buf);
+
+	return NET_OK;
+}
+
+static void udp_recv_cb(struct net_context *context, struct net_buf *buf,
+			int status, void *user_data)
+{
+	if (!buf) {
+		return;
+	}
+
+	rx_count++;
+	rx_bytes += net_nbuf_appdatalen(buf);
+
+	net_nbuf_unref(buf);
+}
+
+static int bench_nbuf_alloc_free(uint32_t *cycles)
+{
+	struct net_buf *buf, *frag;
+	uint32_t start;
+
+	start = k_cycle_get_32();
+
+	buf = net_nbuf_get_reserve_tx(0);
+	frag = net_nbuf_get_reserve_data(0);
+
+	if (buf && frag) {
+		net_buf_frag_add(buf, frag);
+		frag = NULL;
+	}
+
+	if (buf) {
+		net_nbuf_unref(buf);
+	}
+
+	if (frag) {
+		net_nbuf_unref(frag);
+	}
+
+	*cycles += k_cycle_get_32() - start;
+
+	return buf ? 0 : -ENOMEM;
+}
+
+static int bench_chksum(uint32_t *cycles)
+{
+	uint32_t start;
+
+	start = k_cycle_get_32();
+	net_calc_chksum_udp(chksum_buf);
+	*cycles += k_cycle_get_32() - start;
+
+	return 0;
+}
+
+static int bench_6lo(uint32_t *cycles, bool uncompress)
+{
+	struct net_buf *buf;
+	uint32_t start;
+	bool ok;
+
+	buf = build_ipv6(IPPROTO_UDP, &src_ll, &dst_ll, 0xf0b1, 0xf0b2,
+			 SMALL_PAYLOAD_LEN);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	start = k_cycle_get_32();
+	ok = net_6lo_compress(buf, true, NULL);
+	if (!uncompress) {
+		*cycles += k_cycle_get_32() - start;
+	}
+
+	if (ok && uncompress) {
+		start = k_cycle_get_32();
+		ok = net_6lo_uncompress(buf);
+		*cycles += k_cycle_get_32() - start;
+	}
+
+	net_nbuf_unref(buf);
+
+	return ok ? 0 : -EINVAL;
+}
+
+static int bench_6lo_compress(uint32_t *cycles)
+{
+	return bench_6lo(cycles, false);
+}
+
+static int bench_6lo_uncompress(uint32_t *cycles)
+{
+	return bench_6lo(cycles, true);
+}
+
+static int bench_demux(uint32_t *cycles, enum net_ip_protocol proto)
+{
+	uint32_t count = rx_count;
+	struct net_buf *buf;
+	uint32_t start;
+
+	buf = build_ipv6(proto, &peer_addr, &my_addr, PEER_PORT,
+			 DEMUX_PORT + DEMUX_CONNS - 1, SMALL_PAYLOAD_LEN);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	start = k_cycle_get_32();
+
+	if (net_conn_input(proto, buf) != NET_OK) {
+		net_nbuf_unref(buf);
+	}
+
+	*cycles += k_cycle_get_32() - start;
+
+	return rx_count != count ? 0 : -ENOENT;
+}
+
+static int bench_udp_demux(uint32_t *cycles)
+{
+	return bench_demux(cycles, IPPROTO_UDP);
+}
+
+static int bench_tcp_demux(uint32_t *cycles)
+{
+	return bench_demux(cycles, IPPROTO_TCP);
+}
+
+static int bench_route_lookup(uint32_t *cycles)
+{
+	struct net_route_entry *route;
+	uint32_t start;
+
+	start = k_cycle_get_32();
+	route = net_route_lookup(iface, &route_addr);
+	*cycles += k_cycle_get_32() - start;
+
+	return route ? 0 : -ENOENT;
+}
+
+static int bench_udp_send(uint32_t *cycles, struct sockaddr_in6 *dst)
+{
+	struct net_buf *buf;
+	uint32_t start;
+	int ret;
+
+	buf = net_nbuf_get_tx(udp_tx_ctx);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	if (!net_nbuf_append(buf, UDP_PAYLOAD_LEN, payload)) {
+		net_nbuf_unref(buf);
+		return -ENOMEM;
+	}
+
+	start = k_cycle_get_32();
+
+	ret = net_context_sendto(buf, (struct sockaddr *)dst, sizeof(*dst),
+				 NULL, K_NO_WAIT, NULL, NULL);
+	if (ret < 0) {
+		net_nbuf_unref(buf);
+	}
+
+	*cycles += k_cycle_get_32() - start;
+
+	return ret;
+}
+
+/* Sent to the peer through the dummy L2, which drops the packets */
+static int bench_udp_tx(uint32_t *cycles)
+{
+	struct sockaddr_in6 dst = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(PEER_PORT),
+	};
+	uint32_t count = tx_count;
+	int ret;
+
+	net_ipaddr_copy(&dst.sin6_addr, &peer_addr);
+
+	ret = bench_udp_send(cycles, &dst);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The TX thread has a higher priority, it has sent the packet */
+	return tx_count != count ? 0 : -EIO;
+}
+
+/* Sent to the loopback address, received by the other context */
+static int bench_udp_loopback(uint32_t *cycles)
+{
+	struct sockaddr_in6 dst = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(LOOPBACK_PORT),
+	};
+	uint32_t count = rx_count;
+	int ret;
+
+	net_ipaddr_copy(&dst.sin6_addr, &loopback_addr);
+
+	ret = bench_udp_send(cycles, &dst);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return rx_count != count ? 0 : -EIO;
+}
+
+static const struct {
+	const char *name;
+	int (*func)(uint32_t *cycles);
+	/* Payload per operation, for the throughput */
+	uint16_t bytes;
+} benchmarks[] = {
+	{ "nbuf_alloc_free", bench_nbuf_alloc_free, 0 },
+	{ "chksum_udp", bench_chksum, CHKSUM_PAYLOAD_LEN },
+	{ "6lo_compress", bench_6lo_compress, SMALL_PAYLOAD_LEN },
+	{ "6lo_uncompress", bench_6lo_uncompress, SMALL_PAYLOAD_LEN },
+	{ "udp_demux", bench_udp_demux, SMALL_PAYLOAD_LEN },
+	{ "tcp_demux", bench_tcp_demux, SMALL_PAYLOAD_LEN },
+	{ "route_lookup", bench_route_lookup, 0 },
+	{ "udp_tx", bench_udp_tx, UDP_PAYLOAD_LEN },
+	{ "udp_loopback", bench_udp_loopback, UDP_PAYLOAD_LEN },
+};
+
+/* Cycles of a measurement of nothing, removed from each operation */
+static uint32_t overhead_cycles(void)
+{
+	uint32_t min = UINT32_MAX;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		uint32_t cycles, start;
+
+		start = k_cycle_get_32();
+		cycles = k_cycle_get_32() - start;
+
+		if (cycles < min) {
+			min = cycles;
+		}
+	}
+
+	return min;
+}
+
+static int run_benchmark(int idx, uint32_t overhead)
+{
+	uint32_t cycles = 0;
+	uint32_t per_op, ops_per_sec;
+	int i, ret;
+
+	for (i = 0; i < BENCH_ITERATIONS; i++) {
+		ret = benchmarks[idx].func(&cycles);
+		if (ret < 0) {
+			printk("BENCH name=%s error=%d iteration=%d\n",
+			       benchmarks[idx].name, ret, i);
+			return ret;
+		}
+	}
+
+	per_op = cycles / BENCH_ITERATIONS;
+	per_op = per_op > overhead ? per_op - overhead : 1;
+
+	ops_per_sec = (uint32_t)((uint64_t)sys_clock_hw_cycles_per_sec /
+				 per_op);
+
+	printk("BENCH name=%s ops=%u cycles_per_op=%u ns_per_op=%u "
+	       "ops_per_sec=%u", benchmarks[idx].name, BENCH_ITERATIONS,
+	       per_op, (uint32_t)SYS_CLOCK_HW_CYCLES_TO_NS(per_op),
+	       ops_per_sec);
+
+	if (benchmarks[idx].bytes) {
+		printk(" bytes_per_sec=%u",
+		       ops_per_sec * benchmarks[idx].bytes);
+	}
+
+	printk("\n");
+
+	return 0;
+}
+
+static bool setup(void)
+{
+	struct sockaddr_in6 any = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(LOOPBACK_PORT),
+	};
+	struct net_linkaddr lladdr = {
+		.addr = dst_mac,
+		.len = sizeof(dst_mac),
+	};
+	struct in6_addr addr;
+	int i;
+
+	iface = net_if_get_default();
+
+	for (i = 0; i < sizeof(payload); i++) {
+		payload[i] = i;
+	}
+
+	if (!net_if_ipv6_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0)) {
+		TC_ERROR("Cannot add the address\n");
+		return false;
+	}
+
+	if (!net_ipv6_nbr_add(iface, &peer_addr, &lladdr, false,
+			      NET_NBR_REACHABLE)) {
+		TC_ERROR("Cannot add the peer\n");
+		return false;
+	}
+
+	chksum_buf = build_ipv6(IPPROTO_UDP, &my_addr, &peer_addr,
+				PEER_PORT, PEER_PORT, CHKSUM_PAYLOAD_LEN);
+	if (!chksum_buf) {
+		TC_ERROR("Cannot build the checksum packet\n");
+		return false;
+	}
+
+	for (i = 0; i < DEMUX_CONNS; i++) {
+		if (net_udp_register(NULL, NULL, 0, DEMUX_PORT + i,
+				     demux_cb, NULL, NULL) ||
+		    net_tcp_register(NULL, NULL, 0, DEMUX_PORT + i,
+				     demux_cb, NULL, NULL)) {
+			TC_ERROR("Cannot register connection %d\n", i);
+			return false;
+		}
+	}
+
+	for (i = 0; i < CONFIG_NET_MAX_ROUTES; i++) {
+		net_ipaddr_copy(&addr, &route_addr);
+		addr.s6_addr[15] = CONFIG_NET_MAX_ROUTES - i;
+
+		if (!net_route_add(iface, &addr, 128, &peer_addr)) {
+			TC_ERROR("Cannot add route %d\n", i);
+			return false;
+		}
+	}
+
+	if (net_context_get(AF_INET6, SOCK_DGRAM, IPPROTO_UDP,
+			    &udp_tx_ctx) ||
+	    net_context_get(AF_INET6, SOCK_DGRAM, IPPROTO_UDP,
+			    &udp_rx_ctx)) {
+		TC_ERROR("Cannot get the UDP contexts\n");
+		return false;
+	}
+
+	if (net_context_bind(udp_rx_ctx, (struct sockaddr *)&any,
+			     sizeof(any)) ||
+	    net_context_recv(udp_rx_ctx, udp_recv_cb, K_NO_WAIT, NULL)) {
+		TC_ERROR("Cannot receive on the UDP context\n");
+		return false;
+	}
+
+	return true;
+}
+
+void main(void)
+{
+	int status = TC_FAIL;
+	int failures = 0;
+	uint32_t overhead;
+	int i;
+
+	TC_START("Network stack benchmarks");
+
+	if (!setup()) {
+		goto end;
+	}
+
+	overhead = overhead_cycles();
+
+	printk("BENCH cycles_per_sec=%u overhead_cycles=%u\n",
+	       sys_clock_hw_cycles_per_sec, overhead);
+
+	for (i = 0; i < ARRAY_SIZE(benchmarks); i++) {
+		if (run_benchmark(i, overhead) < 0) {
+			failures++;
+		}
+	}
+
+	printk("BENCH done failures=%d\n", failures);
+
+	if (!failures) {
+		status = TC_PASS;
+	}
+
+end:
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
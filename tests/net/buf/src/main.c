@@ -63,11 +63,17 @@ static int frag_destroy_called;
 static void buf_destroy(struct net_buf *buf);
 static void frag_destroy(struct net_buf *buf);
 static void frag_destroy_big(struct net_buf *buf);
+static void ext_recycle(struct net_buf *buf);
 
 NET_BUF_POOL_DEFINE(bufs_pool, 22, 74, sizeof(struct bt_data), buf_destroy);
 NET_BUF_POOL_DEFINE(no_data_pool, 1, 0, sizeof(struct bt_data), NULL);
 NET_BUF_POOL_DEFINE(frags_pool, 13, 128, 0, frag_destroy);
 NET_BUF_POOL_DEFINE(big_frags_pool, 1, 1280, 0, frag_destroy_big);
+NET_BUF_POOL_EXT_DEFINE(ext_pool, 2, sizeof(struct bt_data), ext_recycle);
+NET_BUF_POOL_DEFINE(usage_pool, 2, 8, 0, NULL);
+
+static uint8_t ext_data[64];
+static uint8_t *ext_recycled;
 
 static void buf_destroy(struct net_buf *buf)
 {
@@ -98,6 +104,13 @@ static void frag_destroy_big(struct net_buf *buf)
 	net_buf_destroy(buf);
 }
 
+static void ext_recycle(struct net_buf *buf)
+{
+	assert_equal(buf->pool, &ext_pool, "Invalid free ext pointer");
+	ext_recycled = net_buf_ext_data(buf);
+	net_buf_destroy(buf);
+}
+
 static const char example_data[] = "0123456789"
 				   "abcdefghijklmnopqrstuvxyz"
 				   "!#¤%&/()=?";
@@ -402,6 +415,99 @@ static void net_buf_test_multi_frags(void)
 		     "Incorrect big frag destroy callback count");
 }
 
+static void net_buf_test_ext_data(void)
+{
+	struct net_buf *buf, *frag;
+	struct bt_data *ud;
+
+	buf = net_buf_alloc(&no_data_pool, K_FOREVER);
+
+	frag = net_buf_alloc_ext(&ext_pool, ext_data, sizeof(ext_data),
+				 K_NO_WAIT);
+	assert_not_null(frag, "Failed to get ext buffer");
+	assert_equal(frag->data, ext_data, "Invalid ext data");
+	assert_equal(frag->len, sizeof(ext_data), "Invalid ext length");
+	assert_equal(net_buf_headroom(frag), 0, "Invalid ext headroom");
+	assert_equal(net_buf_tailroom(frag), 0, "Invalid ext tailroom");
+
+	/* The user data is not affected by the external data length */
+	ud = net_buf_user_data(frag);
+	assert_equal((uint8_t *)ud,
+		     frag->__buf + ROUND_UP(sizeof(uint8_t *), sizeof(int)),
+		     "Invalid ext user data");
+
+	net_buf_pull(frag, 10);
+	assert_equal(net_buf_headroom(frag), 10, "Invalid pulled headroom");
+	assert_equal(net_buf_tailroom(frag), 0, "Invalid pulled tailroom");
+	assert_is_null(net_buf_clone(frag, K_NO_WAIT), "Ext buffer cloned");
+
+	net_buf_frag_add(buf, frag);
+	ext_recycled = NULL;
+	net_buf_unref(buf);
+
+	/* Releasing the buffer recycles the external data */
+	assert_equal(ext_recycled, ext_data, "Ext data not recycled");
+}
+
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+static void count_used(struct net_buf *buf, void *user_data)
+{
+	int *count = user_data;
+
+#if defined(CONFIG_NET_BUF_POOL_OWNER)
+	assert_not_null(buf->owner, "Owner not set");
+#endif
+
+	(*count)++;
+}
+
+static void net_buf_test_pool_usage(void)
+{
+	struct net_buf_pool_stats stats;
+	struct net_buf *a, *b;
+	int count = 0;
+
+	a = net_buf_alloc(&usage_pool, K_NO_WAIT);
+	b = net_buf_alloc(&usage_pool, K_NO_WAIT);
+	assert_not_null(a, "Failed to get buffer");
+	assert_not_null(b, "Failed to get buffer");
+
+	net_buf_pool_stats_get(&usage_pool, &stats);
+	assert_equal(stats.alloc, 2, "Wrong allocation count");
+	assert_equal(stats.used, 2, "Wrong used count");
+	assert_equal(stats.empty, 1, "Exhaustion not counted");
+
+	assert_is_null(net_buf_alloc(&usage_pool, K_NO_WAIT),
+		       "Allocated from an empty pool");
+	assert_is_null(net_buf_alloc(&usage_pool, 10),
+		       "Allocated from an empty pool");
+
+	net_buf_pool_stats_get(&usage_pool, &stats);
+	assert_equal(stats.fail, 2, "Wrong failure count");
+	assert_equal(stats.wait, 1, "Wrong wait count");
+	assert_true(stats.wait_ms >= 10, "Wait time not counted");
+
+	net_buf_pool_foreach_used(&usage_pool, count_used, &count);
+	assert_equal(count, 2, "Wrong number of buffers in use");
+
+	net_buf_unref(a);
+
+	count = 0;
+	net_buf_pool_foreach_used(&usage_pool, count_used, &count);
+	assert_equal(count, 1, "Freed buffer listed");
+
+	net_buf_pool_stats_get(&usage_pool, &stats);
+	assert_equal(stats.used, 1, "Wrong used count");
+	assert_equal(stats.peak, 2, "Wrong peak");
+
+	net_buf_unref(b);
+}
+#else
+static void net_buf_test_pool_usage(void)
+{
+}
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+
 void test_main(void)
 {
 	ztest_test_suite(net_buf_test,
@@ -410,7 +516,9 @@ void test_main(void)
 			 ztest_unit_test(net_buf_test_3),
 			 ztest_unit_test(net_buf_test_4),
 			 ztest_unit_test(net_buf_test_big_buf),
-			 ztest_unit_test(net_buf_test_multi_frags)
+			 ztest_unit_test(net_buf_test_multi_frags),
+			 ztest_unit_test(net_buf_test_ext_data),
+			 ztest_unit_test(net_buf_test_pool_usage)
 			 );
 
 	ztest_run_test_suite(net_buf_test);
@@ -141,6 +141,13 @@ static bool net_ctx_get_success(void)
 		return false;
 	}
 
+	/* The context is back in the free list only once */
+	ret = net_context_put(context);
+	if (ret != -EBADF) {
+		TC_ERROR("Context double put test failed.\n");
+		return false;
+	}
+
 	return true;
 }
 
@@ -471,6 +478,117 @@ static bool net_ctx_accept_v4(void)
 	return true;
 }
 
+static bool net_ctx_priority(void)
+{
+	uint8_t prio = NET_PRIORITY_VO;
+	size_t len = sizeof(prio);
+	struct net_buf *buf;
+	int ret;
+
+	ret = net_context_set_option(udp_v6_ctx, NET_OPT_PRIORITY,
+				     &prio, sizeof(prio));
+	if (ret) {
+		TC_ERROR("Context set priority failed (%d)\n", ret);
+		return false;
+	}
+
+	prio = NET_MAX_PRIORITIES;
+	ret = net_context_set_option(udp_v6_ctx, NET_OPT_PRIORITY,
+				     &prio, sizeof(prio));
+	if (ret != -EINVAL) {
+		TC_ERROR("Context set invalid priority succeeded\n");
+		return false;
+	}
+
+	ret = net_context_get_option(udp_v6_ctx, NET_OPT_PRIORITY,
+				     &prio, &len);
+	if (ret || len != sizeof(prio) || prio != NET_PRIORITY_VO) {
+		TC_ERROR("Context get priority failed (%d)\n", ret);
+		return false;
+	}
+
+	buf = net_nbuf_get_tx(udp_v6_ctx);
+	if (net_nbuf_priority(buf) != NET_PRIORITY_VO) {
+		TC_ERROR("Buffer priority %d, should be %d\n",
+			 net_nbuf_priority(buf), NET_PRIORITY_VO);
+		net_nbuf_unref(buf);
+		return false;
+	}
+
+	net_nbuf_unref(buf);
+
+	if (net_tx_priority2tc(NET_PRIORITY_BK) != 0 ||
+	    net_tx_priority2tc(NET_PRIORITY_NC) != NET_TC_TX_COUNT - 1 ||
+	    net_tx_priority2tc(NET_PRIORITY_BE) >
+	    net_tx_priority2tc(NET_PRIORITY_EE)) {
+		TC_ERROR("Invalid priority to traffic class mapping\n");
+		return false;
+	}
+
+	prio = NET_PRIORITY_BE;
+	ret = net_context_set_option(udp_v6_ctx, NET_OPT_PRIORITY,
+				     &prio, sizeof(prio));
+
+	return ret == 0;
+}
+
+NET_NBUF_TX_POOL_DEFINE(ctx_tx_pool, 1);
+NET_NBUF_DATA_POOL_DEFINE(ctx_data_pool, 2);
+
+static bool net_ctx_pools(void)
+{
+	static uint8_t data[CONFIG_NET_NBUF_DATA_SIZE + 1];
+	struct net_buf *buf, *frag;
+	int ret;
+
+	ret = net_context_setup_pools(udp_v6_ctx, &ctx_data_pool, NULL);
+	if (ret != -EINVAL) {
+		TC_ERROR("Context accepted a data pool as TX pool\n");
+		return false;
+	}
+
+	ret = net_context_setup_pools(udp_v6_ctx, &ctx_tx_pool,
+				      &ctx_data_pool);
+	if (ret) {
+		TC_ERROR("Context setup pools failed (%d)\n", ret);
+		return false;
+	}
+
+	buf = net_nbuf_get_tx(udp_v6_ctx);
+	frag = net_nbuf_get_data(udp_v6_ctx);
+	net_buf_frag_add(buf, frag);
+
+	if (buf->pool != &ctx_tx_pool || frag->pool != &ctx_data_pool) {
+		TC_ERROR("Buffers not allocated from the context pools\n");
+		net_nbuf_unref(buf);
+		return false;
+	}
+
+	/* Fragments added while appending come from the context pool too */
+	if (!net_nbuf_append(buf, sizeof(data), data) ||
+	    frag->frags->pool != &ctx_data_pool) {
+		TC_ERROR("Appended fragment not from the context pool\n");
+		net_nbuf_unref(buf);
+		return false;
+	}
+
+	net_nbuf_unref(buf);
+
+	/* Other contexts still use the global pools */
+	buf = net_nbuf_get_tx(udp_v4_ctx);
+	if (buf->pool == &ctx_tx_pool) {
+		TC_ERROR("Other context allocated from the context pool\n");
+		net_nbuf_unref(buf);
+		return false;
+	}
+
+	net_nbuf_unref(buf);
+
+	ret = net_context_setup_pools(udp_v6_ctx, NULL, NULL);
+
+	return ret == 0;
+}
+
 static void send_cb(struct net_context *context, int status,
 		    void *token, void *user_data)
 {
@@ -1192,8 +1310,12 @@ static const struct {
 	{ "net_context_connect IPv4", net_ctx_connect_v4 },
 	{ "net_context_accept IPv6", net_ctx_accept_v6 },
 	{ "net_context_accept IPv4", net_ctx_accept_v4 },
+	{ "net_context priority", net_ctx_priority },
+	{ "net_context pools", net_ctx_pools },
 	{ "net_context_send IPv6", net_ctx_send_v6 },
 	{ "net_context_send IPv4", net_ctx_send_v4 },
+	{ "net_context_send IPv6 cached", net_ctx_send_v6 },
+	{ "net_context_send IPv4 cached", net_ctx_send_v4 },
 	{ "net_context_sendto IPv6", net_ctx_sendto_v6 },
 	{ "net_context_sendto IPv4", net_ctx_sendto_v4 },
 	{ "net_context_recv IPv6", net_ctx_recv_v6 },
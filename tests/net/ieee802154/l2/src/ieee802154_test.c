@@ -230,6 +230,87 @@ static inline int test_ack_reply(struct ieee802154_pkt_test *t)
 	return TC_PASS;
 }
 
+static inline int test_mesh_forwarding(void)
+{
+	static uint8_t mesh_pkt[] = {
+		0x41, 0xcc, 0x01, 0xcd, 0xab, 0xc2, 0xa3, 0x9e, 0x00, 0x00,
+		0x4b, 0x12, 0x00, 0x26, 0x18, 0x32, 0x00, 0x00, 0x4b, 0x12,
+		0x00, 0x85, 0x00, 0x12, 0x4b, 0x00, 0x00, 0x32, 0x18, 0x26,
+		0x00, 0x12, 0x4b, 0x00, 0x00, 0x32, 0x11, 0x26, 0x41, 0x60,
+		0x00, 0x00, 0x00
+	};
+	/* Final destination of the frame, in network order */
+	static uint8_t final_addr[] = {
+		0x00, 0x12, 0x4b, 0x00, 0x00, 0x32, 0x11, 0x26
+	};
+	struct net_linkaddr lladdr = {
+		.addr = final_addr,
+		.len = sizeof(final_addr),
+	};
+	struct ieee802154_mpdu mpdu;
+	struct net_buf *buf, *frag;
+	struct in6_addr addr;
+	uint8_t i;
+
+	TC_PRINT("- Forwarding a mesh frame\n");
+
+	net_ipv6_addr_create_iid(&addr, &lladdr);
+
+	if (!net_ipv6_nbr_add(iface, &addr, &lladdr, false,
+			      NET_NBR_REACHABLE)) {
+		TC_ERROR("*** Could not add the final destination\n");
+		return TC_FAIL;
+	}
+
+	buf = net_nbuf_get_reserve_rx(0);
+	frag = net_nbuf_get_reserve_rx(0);
+
+	memcpy(frag->data, mesh_pkt, sizeof(mesh_pkt));
+	frag->len = sizeof(mesh_pkt);
+
+	net_buf_frag_add(buf, frag);
+
+	net_recv_data(iface, buf);
+
+	k_sem_take(&driver_lock, 20);
+
+	if (!current_buf->frags) {
+		TC_ERROR("*** Mesh frame not forwarded\n");
+		return TC_FAIL;
+	}
+
+	pkt_hexdump(net_nbuf_ll(current_buf), net_buf_frags_len(current_buf));
+
+	if (!ieee802154_validate_frame(net_nbuf_ll(current_buf),
+				       net_nbuf_ll_reserve(current_buf) +
+				       net_buf_frags_len(current_buf), &mpdu)) {
+		TC_ERROR("*** Forwarded frame is invalid\n");
+		return TC_FAIL;
+	}
+
+	/* Sent to the final destination, MAC addresses are little endian */
+	for (i = 0; i < sizeof(final_addr); i++) {
+		if (mpdu.mhr.dst_addr->plain.addr.ext_addr[i] !=
+		    final_addr[sizeof(final_addr) - 1 - i]) {
+			TC_ERROR("*** Forwarded to the wrong node\n");
+			return TC_FAIL;
+		}
+	}
+
+	/* One hop less, the rest of the frame untouched */
+	if (((uint8_t *)mpdu.payload)[0] != 0x84 ||
+	    memcmp((uint8_t *)mpdu.payload + 1, mesh_pkt + 22,
+		   sizeof(mesh_pkt) - 22)) {
+		TC_ERROR("*** Forwarded frame payload was modified\n");
+		return TC_FAIL;
+	}
+
+	net_buf_unref(current_buf->frags);
+	current_buf->frags = NULL;
+
+	return TC_PASS;
+}
+
 static inline int initialize_test_environment(void)
 {
 	struct device *dev;
@@ -291,6 +372,10 @@ void main(void)
 		goto end;
 	}
 
+	if (test_mesh_forwarding() != TC_PASS) {
+		goto end;
+	}
+
 	status = TC_PASS;
 
 end:
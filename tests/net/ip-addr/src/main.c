@@ -414,6 +414,16 @@ static bool run_tests(void)
 		}
 	}
 
+	/* The selection cached for the destination goes with the address */
+	net_if_ipv6_addr_rm(net_if_get_default(), &addr6_pref2);
+
+	out = net_if_ipv6_select_src_addr(net_if_get_default(), &addr6_pref1);
+	if (out && !memcmp(out->s6_addr, &addr6_pref2.s6_addr,
+			   sizeof(struct in6_addr))) {
+		printk("IPv6 removed src address selected\n");
+		return false;
+	}
+
 	iface = net_if_get_default();
 
 	net_if_ipv4_set_gw(iface, &gw);
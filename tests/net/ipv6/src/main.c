@@ -25,6 +25,7 @@
 
 #define NET_LOG_ENABLED 1
 #include "net_private.h"
+#include "net_stats.h"
 
 static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
 				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
@@ -119,6 +120,26 @@ static const unsigned char ipv6_hbho[] = {
 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,              /* ...... */
 };
 
+#if defined(CONFIG_NET_IPV6_MPL)
+/* MPL option in the hop-by-hop header, sent to ff03::fc */
+static const unsigned char ipv6_mpl[] = {
+/* IPv6 header starts here */
+0x60, 0x00, 0x00, 0x00, 0x00, 0x12, 0x00, 0x3f,
+0x20, 0x01, 0x0D, 0xB8, 0x00, 0x00, 0x00, 0x00,
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+0xff, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc,
+/* Hop-by-hop option starts here */
+0x11, 0x00,
+/* MPL sub-option (seed is the source address, seq 7), then PadN */
+0x6d, 0x02, 0x00, 0x07, 0x01, 0x00,
+/* UDP header starts here (checksum is not valid) */
+0xaa, 0xdc, 0xbf, 0xd7, 0x00, 0x0a, 0x00, 0x00,
+/* User data starts here */
+0x01, 0x02,
+};
+#endif
+
 static bool test_failed;
 static struct k_sem wait_data;
 
@@ -599,6 +620,65 @@ static bool net_test_hbho_message(void)
 	return true;
 }
 
+#if defined(CONFIG_NET_IPV6_MPL)
+static bool net_test_mpl_duplicate(void)
+{
+	net_stats_t recv = net_stats.ipv6_mpl.recv;
+	net_stats_t duplicate = net_stats.ipv6_mpl.duplicate;
+	struct net_buf *buf, *frag;
+	struct net_if *iface;
+	uint16_t reserve;
+	int i;
+
+	iface = net_if_get_default();
+
+	reserve = net_if_get_ll_reserve(iface, NULL);
+
+	for (i = 0; i < 2; i++) {
+		buf = net_nbuf_get_reserve_rx(0);
+
+		NET_ASSERT_INFO(buf, "Out of RX buffers");
+
+		frag = net_nbuf_get_reserve_data(reserve);
+
+		net_buf_frag_add(buf, frag);
+
+		net_nbuf_set_ll_reserve(buf, reserve);
+		net_nbuf_set_iface(buf, iface);
+		net_nbuf_set_family(buf, AF_INET6);
+		net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+
+		net_nbuf_ll_clear(buf);
+
+		memcpy(net_buf_add(frag, sizeof(ipv6_mpl)),
+		       ipv6_mpl, sizeof(ipv6_mpl));
+
+		if (net_recv_data(iface, buf) < 0) {
+			TC_ERROR("Data receive for MPL failed.");
+			return false;
+		}
+
+		k_sleep(WAIT_TIME / 10);
+	}
+
+	/* Retransmissions are looped back, so they are duplicates too */
+	if (net_stats.ipv6_mpl.recv - recv < 2) {
+		TC_ERROR("MPL packets not received\n");
+		return false;
+	}
+
+	if (net_stats.ipv6_mpl.duplicate - duplicate !=
+	    net_stats.ipv6_mpl.recv - recv - 1) {
+		TC_ERROR("MPL duplicates %u received %u\n",
+			 net_stats.ipv6_mpl.duplicate - duplicate,
+			 net_stats.ipv6_mpl.recv - recv);
+		return false;
+	}
+
+	return true;
+}
+#endif
+
 static bool net_test_change_ll_addr(void)
 {
 	uint8_t new_mac[] = { 00, 01, 02, 03, 04, 05 };
@@ -688,6 +768,9 @@ static const struct {
 	{ "IPv6 send NS no options", net_test_send_ns_no_options },
 	{ "IPv6 handle RA message", net_test_ra_message },
 	{ "IPv6 parse Hop-By-Hop Option", net_test_hbho_message },
+#if defined(CONFIG_NET_IPV6_MPL)
+	{ "IPv6 MPL duplicate suppression", net_test_mpl_duplicate },
+#endif
 	{ "IPv6 change ll address", net_test_change_ll_addr },
 	{ "IPv6 prefix timeout", net_test_prefix_timeout },
 	/*{ "IPv6 prefix timeout overflow", net_test_prefix_timeout_overflow },*/
@@ -167,6 +167,16 @@ static int eval_msg_pubrel(struct mqtt_test *mqtt_test);
  */
 static int eval_msg_unsuback(struct mqtt_test *mqtt_test);
 
+/**
+ * @brief eval_parser		Evaluate the incremental parser, feeding it
+ *				a stream of messages in pieces of the size
+ *				given by mqtt_test->msg
+ * @param [in] mqtt_test	MQTT test structure
+ * @return			TC_PASS on success
+ * @return			TC_FAIL on error
+ */
+static int eval_parser(struct mqtt_test *mqtt_test);
+
 /**
  * @brief eval_msg_disconnect	Evaluate the given mqtt_test against the
  *				disconnect routines.
@@ -523,6 +533,28 @@ uint8_t pingreq1[] = {0xc0, 0x00};
 static
 uint8_t pingresp1[] = {0xd0, 0x00};
 
+static uint16_t parser_piece1 = 1;
+static uint16_t parser_piece7 = 7;
+static uint16_t parser_piece_all = BUF_SIZE;
+
+/* Smaller than some of the messages of the parser test */
+#define PARSER_BUF_SIZE		16
+#define PARSER_PAYLOAD_SIZE	200
+
+/* SUBACK msg not fitting in the parser buffer */
+#define PARSER_SUBACK_ITEMS	(PARSER_BUF_SIZE + 1)
+
+static uint8_t parser_buf[PARSER_BUF_SIZE];
+
+static struct parser_result {
+	int messages;
+	uint8_t types[4];
+	int publish_ok;
+	uint32_t payload_len;
+	int payload_err;
+	int last_offset_ok;
+} parser_result;
+
 static
 uint8_t puback1[] = {0x40, 0x02, 0x00, 0x01};
 static struct msg_pkt_id msg_puback1 = {.pkt_id = 1};
@@ -645,6 +677,15 @@ struct mqtt_test mqtt_tests[] = {
 	 .msg = &msg_unsuback1, .eval_fcn = eval_msg_unsuback,
 	 .expected = unsuback1, .expected_len = sizeof(unsuback1)},
 
+	{.test_name = "Parser, stream in pieces of 1 byte",
+	 .msg = &parser_piece1, .eval_fcn = eval_parser},
+
+	{.test_name = "Parser, stream in pieces of 7 bytes",
+	 .msg = &parser_piece7, .eval_fcn = eval_parser},
+
+	{.test_name = "Parser, stream in one piece",
+	 .msg = &parser_piece_all, .eval_fcn = eval_parser},
+
 	/* last test case, do not remove it */
 	{.test_name = NULL}
 };
@@ -983,6 +1024,148 @@ static int eval_msg_unsuback(struct mqtt_test *mqtt_test)
 	return eval_msg_packet_id(mqtt_test, MQTT_UNSUBACK);
 }
 
+static int parser_message(struct mqtt_parser *parser, uint8_t *data,
+			  uint16_t len)
+{
+	struct parser_result *res = parser->user_data;
+
+	if (res->messages < sizeof(res->types)) {
+		res->types[res->messages] = MQTT_PACKET_TYPE(data[0]);
+	}
+
+	res->messages++;
+
+	return 0;
+}
+
+static int parser_publish(struct mqtt_parser *parser,
+			  struct mqtt_publish_msg *msg)
+{
+	struct parser_result *res = parser->user_data;
+	uint16_t i;
+
+	if (msg->qos == MQTT_QoS1) {
+		/* publish3, received in up to two chunks */
+		if (msg->pkt_id != 1 || msg->topic_len != 7 ||
+		    memcmp(msg->topic, "sensors", 7) != 0 ||
+		    msg->msg_total_len != 2 ||
+		    memcmp(msg->msg, "OK" + msg->msg_offset,
+			   msg->msg_len) != 0) {
+			return -EINVAL;
+		}
+
+		if (msg->msg_offset + msg->msg_len == msg->msg_total_len) {
+			res->publish_ok++;
+		}
+
+		return 0;
+	}
+
+	if (msg->msg_total_len != PARSER_PAYLOAD_SIZE) {
+		res->payload_err++;
+		return -EINVAL;
+	}
+
+	for (i = 0; i < msg->msg_len; i++) {
+		if (msg->msg[i] != (uint8_t)(msg->msg_offset + i)) {
+			res->payload_err++;
+		}
+	}
+
+	res->payload_len += msg->msg_len;
+	res->last_offset_ok = (msg->msg_offset + msg->msg_len ==
+			       msg->msg_total_len);
+
+	return 0;
+}
+
+static int eval_parser(struct mqtt_test *mqtt_test)
+{
+	uint16_t piece = *(uint16_t *)mqtt_test->msg;
+	struct mqtt_parser parser;
+	uint16_t offset;
+	uint16_t len;
+	int enomem = 0;
+	int rc;
+	int i;
+
+	/* PUBACK, PUBLISH QoS 1, SUBACK too big, PINGRESP,
+	 * PUBLISH QoS 0 with a payload bigger than the parser buffer
+	 */
+	buf_len = 0;
+	memcpy(buf + buf_len, puback1, sizeof(puback1));
+	buf_len += sizeof(puback1);
+	memcpy(buf + buf_len, publish3, sizeof(publish3));
+	buf_len += sizeof(publish3);
+
+	buf[buf_len++] = MQTT_SUBACK << 4;
+	/* packet id and the QoS values */
+	buf[buf_len++] = 2 + PARSER_SUBACK_ITEMS;
+	buf[buf_len++] = 0x00;
+	buf[buf_len++] = 0x01;
+	for (i = 0; i < PARSER_SUBACK_ITEMS; i++) {
+		buf[buf_len++] = MQTT_QoS0;
+	}
+
+	memcpy(buf + buf_len, pingresp1, sizeof(pingresp1));
+	buf_len += sizeof(pingresp1);
+
+	buf[buf_len++] = MQTT_PUBLISH << 4;
+	/* Remaining length in two bytes: 2 + 7 + payload */
+	buf[buf_len++] = 0x80 | ((2 + 7 + PARSER_PAYLOAD_SIZE) & 0x7F);
+	buf[buf_len++] = (2 + 7 + PARSER_PAYLOAD_SIZE) >> 7;
+	buf[buf_len++] = 0x00;
+	buf[buf_len++] = 0x07;
+	memcpy(buf + buf_len, "sensors", 7);
+	buf_len += 7;
+	for (i = 0; i < PARSER_PAYLOAD_SIZE; i++) {
+		buf[buf_len++] = i;
+	}
+
+	memset(&parser_result, 0, sizeof(parser_result));
+
+	mqtt_parser_init(&parser, parser_buf, sizeof(parser_buf));
+	parser.message = parser_message;
+	parser.publish = parser_publish;
+	parser.user_data = &parser_result;
+
+	for (offset = 0; offset < buf_len; offset += len) {
+		len = min(piece, buf_len - offset);
+
+		rc = mqtt_parser_input(&parser, buf + offset, len);
+		if (rc == -ENOMEM) {
+			enomem++;
+		} else if (rc != 0) {
+			return TC_FAIL;
+		}
+	}
+
+	if (enomem != 1 || parser_result.messages != 2 ||
+	    parser_result.types[0] != MQTT_PUBACK ||
+	    parser_result.types[1] != MQTT_PINGRESP ||
+	    parser_result.publish_ok != 1 ||
+	    parser_result.payload_err != 0 ||
+	    parser_result.payload_len != PARSER_PAYLOAD_SIZE ||
+	    !parser_result.last_offset_ok) {
+		return TC_FAIL;
+	}
+
+	/* A malformed Remaining Length resets the parser */
+	buf[0] = MQTT_PUBACK << 4;
+	memset(buf + 1, 0xFF, 5);
+	rc = mqtt_parser_input(&parser, buf, 6);
+	if (rc != -EINVAL) {
+		return TC_FAIL;
+	}
+
+	rc = mqtt_parser_input(&parser, puback1, sizeof(puback1));
+	if (rc != 0 || parser_result.messages != 3) {
+		return TC_FAIL;
+	}
+
+	return TC_PASS;
+}
+
 static int run_tests(void)
 {
 	int rc;
@@ -1039,6 +1039,327 @@ done:
 	return result;
 }
 
+#define STREAM_BODY_SIZE 200
+
+static uint8_t stream_body[STREAM_BODY_SIZE];
+static uint8_t stream_copy[STREAM_BODY_SIZE];
+
+static int stream_read(struct zoap_block_stream *stream, size_t offset,
+		       uint8_t *data, uint16_t len)
+{
+	memcpy(data, stream_body + offset, len);
+
+	return 0;
+}
+
+static int stream_write(struct zoap_block_stream *stream, size_t offset,
+			const uint8_t *data, uint16_t len, bool last)
+{
+	if (offset + len > sizeof(stream_copy)) {
+		return -ENOMEM;
+	}
+
+	memcpy(stream_copy + offset, data, len);
+
+	return 0;
+}
+
+static int test_block_stream(void)
+{
+	struct zoap_block_stream src, sink;
+	struct zoap_packet req, rcvd;
+	struct net_buf *frag, *buf = NULL;
+	int result = TC_FAIL;
+	int blocks = 0;
+	int i, r;
+
+	if (zoap_block_size_from_mtu(1280, 20) != ZOAP_BLOCK_1024 ||
+	    zoap_block_size_from_mtu(127, 0) != ZOAP_BLOCK_64 ||
+	    zoap_block_size_from_mtu(60, 0) != ZOAP_BLOCK_16) {
+		TC_PRINT("Wrong block size for the MTU\n");
+		goto done;
+	}
+
+	for (i = 0; i < sizeof(stream_body); i++) {
+		stream_body[i] = i;
+	}
+
+	memset(stream_copy, 0, sizeof(stream_copy));
+
+	/* Too big for the buffers, the block size must be reduced */
+	zoap_block_stream_source_init(&src, ZOAP_BLOCK_1024,
+				      sizeof(stream_body), stream_read, NULL);
+	zoap_block_stream_sink_init(&sink, ZOAP_BLOCK_1024, stream_write,
+				    NULL);
+
+	do {
+		buf = net_buf_alloc(&zoap_nbuf_pool, K_NO_WAIT);
+		if (!buf) {
+			TC_PRINT("Could not get buffer from pool\n");
+			goto done;
+		}
+
+		frag = net_buf_alloc(&zoap_data_pool, K_NO_WAIT);
+		if (!frag) {
+			TC_PRINT("Could not get buffer from pool\n");
+			goto done;
+		}
+
+		net_buf_frag_add(buf, frag);
+
+		r = zoap_packet_init(&req, buf);
+		if (r < 0) {
+			TC_PRINT("Unable to initialize request\n");
+			goto done;
+		}
+
+		zoap_header_set_version(&req, 1);
+		zoap_header_set_type(&req, ZOAP_TYPE_CON);
+		zoap_header_set_code(&req, ZOAP_METHOD_PUT);
+		zoap_header_set_id(&req, zoap_next_id());
+
+		r = zoap_block_stream_send(&req, &src);
+		if (r < 0) {
+			TC_PRINT("Could not add block %d\n", blocks);
+			goto done;
+		}
+
+		if (src.ctx.block_size != ZOAP_BLOCK_64) {
+			TC_PRINT("Block size not adapted to the buffer\n");
+			goto done;
+		}
+
+		r = zoap_packet_parse(&rcvd, buf);
+		if (r < 0) {
+			TC_PRINT("Could not parse block %d\n", blocks);
+			goto done;
+		}
+
+		r = zoap_block_stream_recv(&rcvd, &sink);
+		if (r < 0) {
+			TC_PRINT("Could not receive block %d\n", blocks);
+			goto done;
+		}
+
+		/* A retransmitted block is not passed again */
+		if (zoap_block_stream_recv(&rcvd, &sink) != -EALREADY) {
+			TC_PRINT("Duplicate block %d not detected\n", blocks);
+			goto done;
+		}
+
+		net_buf_unref(buf);
+		buf = NULL;
+
+		blocks++;
+		zoap_next_block(&src.ctx);
+	} while (r == 0);
+
+	if (blocks != 4 || sink.received != sizeof(stream_body)) {
+		TC_PRINT("Wrong number of blocks %d\n", blocks);
+		goto done;
+	}
+
+	if (memcmp(stream_body, stream_copy, sizeof(stream_body))) {
+		TC_PRINT("Body not transferred correctly\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	if (buf) {
+		net_buf_unref(buf);
+	}
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+static int table_sent;
+static int table_replied;
+
+static int table_send(struct zoap_pending *pending)
+{
+	table_sent++;
+
+	return 0;
+}
+
+static int table_reply_cb(const struct zoap_packet *response,
+			  struct zoap_reply *reply,
+			  const struct sockaddr *from)
+{
+	table_replied++;
+
+	return 0;
+}
+
+static struct net_buf *build_message(struct zoap_packet *pkt, uint8_t type,
+				     uint16_t id, const char *token)
+{
+	struct net_buf *buf, *frag;
+
+	buf = net_buf_alloc(&zoap_nbuf_pool, K_NO_WAIT);
+	if (!buf) {
+		return NULL;
+	}
+
+	frag = net_buf_alloc(&zoap_data_pool, K_NO_WAIT);
+	if (!frag) {
+		net_buf_unref(buf);
+		return NULL;
+	}
+
+	net_buf_frag_add(buf, frag);
+
+	if (zoap_packet_init(pkt, buf) < 0) {
+		net_buf_unref(buf);
+		return NULL;
+	}
+
+	zoap_header_set_version(pkt, 1);
+	zoap_header_set_type(pkt, type);
+	zoap_header_set_code(pkt, type == ZOAP_TYPE_CON ? ZOAP_METHOD_GET :
+			     ZOAP_RESPONSE_CODE_CONTENT);
+	zoap_header_set_id(pkt, id);
+	zoap_header_set_token(pkt, (const uint8_t *)token, strlen(token));
+
+	return buf;
+}
+
+static int test_tables(void)
+{
+	struct zoap_pending_table pending_table;
+	struct zoap_reply_table reply_table;
+	struct zoap_observer_table observer_table;
+	struct zoap_packet req1, req2, rsp;
+	struct zoap_pending *p1, *p2;
+	struct zoap_observer *o;
+	struct zoap_reply *r;
+	struct net_buf *rsp_buf = NULL;
+	int result = TC_FAIL;
+
+	table_sent = 0;
+	table_replied = 0;
+
+	zoap_pending_table_init(&pending_table, pendings, NUM_PENDINGS,
+				table_send, NULL);
+	zoap_reply_table_init(&reply_table, replies, NUM_REPLIES);
+	zoap_observer_table_init(&observer_table, observers, NUM_OBSERVERS);
+
+	/* Only CONFIG_ZOAP_NSTART requests are outstanding at a time */
+	p1 = zoap_pending_alloc(&pending_table);
+	p2 = zoap_pending_alloc(&pending_table);
+	if (!p1 || !p2 || !build_message(&req1, ZOAP_TYPE_CON, 1, "tok1") ||
+	    !build_message(&req2, ZOAP_TYPE_CON, 2, "tok2")) {
+		TC_PRINT("Could not allocate the requests\n");
+		goto done;
+	}
+
+	r = zoap_reply_alloc(&reply_table);
+	if (!r) {
+		TC_PRINT("Could not allocate a reply\n");
+		goto done;
+	}
+
+	zoap_reply_init(r, &req1);
+	r->reply = table_reply_cb;
+	zoap_reply_table_add(&reply_table, r);
+
+	zoap_pending_submit(&pending_table, p1, &req1,
+			    (const struct sockaddr *)&dummy_addr);
+	zoap_pending_submit(&pending_table, p2, &req2,
+			    (const struct sockaddr *)&dummy_addr);
+
+	if (table_sent != 1 || pending_table.in_flight != 1) {
+		TC_PRINT("Wrong number of requests in flight\n");
+		goto done;
+	}
+
+	/* The response of the first request lets the second one go */
+	rsp_buf = build_message(&rsp, ZOAP_TYPE_ACK, 1, "tok1");
+	if (!rsp_buf) {
+		TC_PRINT("Could not allocate the response\n");
+		goto done;
+	}
+
+	if (zoap_pending_table_received(&pending_table, &rsp,
+					(const struct sockaddr *)&dummy_addr)) {
+		TC_PRINT("Request not acknowledged\n");
+		goto done;
+	}
+
+	if (table_sent != 2 || pending_table.in_flight != 1) {
+		TC_PRINT("Queued request not sent\n");
+		goto done;
+	}
+
+	if (zoap_pending_table_received(&pending_table, &rsp,
+					(const struct sockaddr *)&dummy_addr)
+	    != -ENOENT) {
+		TC_PRINT("Request acknowledged twice\n");
+		goto done;
+	}
+
+	if (zoap_reply_table_received(&reply_table, &rsp,
+				      (const struct sockaddr *)&dummy_addr)
+	    != r || table_replied != 1) {
+		TC_PRINT("Reply not found by token\n");
+		goto done;
+	}
+
+	zoap_reply_table_remove(&reply_table, r);
+
+	if (zoap_reply_table_received(&reply_table, &rsp,
+				      (const struct sockaddr *)&dummy_addr)) {
+		TC_PRINT("Reply not removed\n");
+		goto done;
+	}
+
+	zoap_pending_cancel(&pending_table, p2);
+
+	if (pending_table.in_flight) {
+		TC_PRINT("Request not cancelled\n");
+		goto done;
+	}
+
+	o = zoap_observer_alloc(&observer_table);
+	if (!o) {
+		TC_PRINT("Could not allocate an observer\n");
+		goto done;
+	}
+
+	zoap_observer_init(o, &req1, (const struct sockaddr *)&dummy_addr);
+	zoap_observer_table_add(&observer_table, o);
+
+	if (zoap_observer_table_find(&observer_table,
+				     (const struct sockaddr *)&dummy_addr)
+	    != o) {
+		TC_PRINT("Observer not found by address\n");
+		goto done;
+	}
+
+	zoap_observer_table_remove(&observer_table, o);
+
+	if (zoap_observer_table_find(&observer_table,
+				     (const struct sockaddr *)&dummy_addr)) {
+		TC_PRINT("Observer not removed\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	if (rsp_buf) {
+		net_buf_unref(rsp_buf);
+	}
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
 static const struct {
 	const char *name;
 	int (*func)(void);
@@ -1052,6 +1373,8 @@ static const struct {
 	{ "Test observer server", test_observer_server, },
 	{ "Test observer client", test_observer_client, },
 	{ "Test block sized transfer", test_block_size, },
+	{ "Test block-wise streaming", test_block_stream, },
+	{ "Test indexed tables", test_tables, },
 };
 
 int main(int argc, char *argv[])
@@ -152,6 +152,36 @@ static inline int test_sending_event(uint32_t times, bool receiver)
 	return ret;
 }
 
+static inline int test_sync_event(void)
+{
+	int ret = TC_PASS;
+
+	TC_PRINT("- Sending event to a synchronous receiver\n");
+
+	net_mgmt_add_sync_event_callback(&rx_cb);
+
+	/* The callback has run once the notification returns */
+	net_mgmt_event_notify(TEST_MGMT_EVENT_UNHANDLED, NULL);
+	net_mgmt_event_notify(TEST_MGMT_EVENT, NULL);
+
+	if (rx_event != TEST_MGMT_EVENT || rx_calls != 1) {
+		ret = TC_FAIL;
+	}
+
+	net_mgmt_del_event_callback(&rx_cb);
+	rx_event = rx_calls = 0;
+
+	net_mgmt_event_notify(TEST_MGMT_EVENT, NULL);
+
+	k_yield();
+
+	if (rx_calls) {
+		ret = TC_FAIL;
+	}
+
+	return ret;
+}
+
 static void initialize_event_tests(void)
 {
 	event2throw = 0;
@@ -249,6 +279,10 @@ void main(void)
 		goto end;
 	}
 
+	if (test_sync_event() != TC_PASS) {
+		goto end;
+	}
+
 	if (test_core_event(NET_EVENT_IPV6_ADDR_ADD,
 			    _iface_ip6_add) != TC_PASS) {
 		goto end;
@@ -11,6 +11,7 @@
 #include <string.h>
 #include <errno.h>
 #include <misc/printk.h>
+#include <misc/byteorder.h>
 #include <stdio.h>
 
 #include <tc_util.h>
@@ -1161,6 +1162,144 @@ static int test_nbuf_read_write_insert(void)
 	return 0;
 }
 
+static int test_nbuf_linearize(void)
+{
+	struct net_buf *buf, *frag;
+	uint8_t flat[LL_RESERVE + 2 * sizeof(test_data)];
+	int len, i;
+
+	buf = net_nbuf_get_reserve_tx(0);
+	net_nbuf_set_ll_reserve(buf, LL_RESERVE);
+
+	for (i = 0; i < 2; i++) {
+		frag = net_nbuf_get_reserve_data(LL_RESERVE);
+		memcpy(net_buf_add(frag, sizeof(test_data)), test_data,
+		       sizeof(test_data));
+		net_buf_frag_add(buf, frag);
+	}
+
+	memset(net_nbuf_ll(buf), 0xaa, LL_RESERVE);
+
+	len = net_nbuf_linearize(buf, flat, sizeof(flat) - 1);
+	if (len != -ENOBUFS) {
+		printk("Linearize into a too small buffer returned %d\n", len);
+		return -EINVAL;
+	}
+
+	len = net_nbuf_linearize(buf, flat, sizeof(flat));
+	if (len != sizeof(flat)) {
+		printk("Linearize returned %d, expected %zd\n", len,
+		       sizeof(flat));
+		return -EINVAL;
+	}
+
+	for (i = 0; i < LL_RESERVE; i++) {
+		if (flat[i] != 0xaa) {
+			printk("Link layer header not copied\n");
+			return -EINVAL;
+		}
+	}
+
+	if (memcmp(flat + LL_RESERVE, test_data, sizeof(test_data)) ||
+	    memcmp(flat + LL_RESERVE + sizeof(test_data), test_data,
+		   sizeof(test_data))) {
+		printk("Linearized data mismatch\n");
+		return -EINVAL;
+	}
+
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static int test_nbuf_view(void)
+{
+	struct net_buf *buf, *frag;
+	struct net_nbuf_view view;
+	uint8_t data[sizeof(test_data)];
+	uint16_t span, u16;
+	uint32_t u32;
+	uint8_t u8;
+	int i;
+
+	/* Two fragments with test_data, a 16 bit field is split between
+	 * them.
+	 */
+	buf = net_nbuf_get_reserve_rx(0);
+
+	for (i = 0; i < 2; i++) {
+		frag = net_nbuf_get_reserve_data(0);
+		memcpy(net_buf_add(frag, sizeof(test_data)), test_data,
+		       sizeof(test_data));
+		net_buf_frag_add(buf, frag);
+	}
+
+	if (net_nbuf_view_init(&view, buf->frags, 1,
+			       2 * sizeof(test_data)) != -ENODATA) {
+		printk("View beyond the data accepted\n");
+		return -EINVAL;
+	}
+
+	if (net_nbuf_view_init(&view, buf->frags, sizeof(test_data) - 1,
+			       8)) {
+		printk("View init failed\n");
+		return -EINVAL;
+	}
+
+	if (!net_nbuf_view_span(&view, &span) || span != 1) {
+		printk("Wrong span length %u\n", span);
+		return -EINVAL;
+	}
+
+	if (net_nbuf_view_peek(&view, 0, data, 2) ||
+	    data[0] != test_data[sizeof(test_data) - 1] ||
+	    data[1] != test_data[0]) {
+		printk("Peek across fragments failed\n");
+		return -EINVAL;
+	}
+
+	if (net_nbuf_view_read_be16(&view, &u16) ||
+	    u16 != (test_data[sizeof(test_data) - 1] << 8 | test_data[0])) {
+		printk("Read be16 across fragments failed\n");
+		return -EINVAL;
+	}
+
+	if (net_nbuf_view_read_be32(&view, &u32) ||
+	    u32 != sys_get_be32((uint8_t *)&test_data[1])) {
+		printk("Read be32 failed\n");
+		return -EINVAL;
+	}
+
+	if (net_nbuf_view_read_u8(&view, &u8) || u8 != test_data[5]) {
+		printk("Read u8 failed\n");
+		return -EINVAL;
+	}
+
+	if (net_nbuf_view_len(&view) != 1 ||
+	    net_nbuf_view_read_be16(&view, &u16) != -ENODATA ||
+	    net_nbuf_view_len(&view) != 1) {
+		printk("Read beyond the view not detected\n");
+		return -EINVAL;
+	}
+
+	/* The first fragment is consumed and freed */
+	net_nbuf_view_release(buf, &view);
+
+	if (buf->frags != frag || frag->len != 2 || view.pos) {
+		printk("Consumed data not released\n");
+		return -EINVAL;
+	}
+
+	if (net_nbuf_view_read(&view, data, 1) ||
+	    data[0] != test_data[6] || net_nbuf_view_len(&view)) {
+		printk("Read after release failed\n");
+		return -EINVAL;
+	}
+
+	net_nbuf_unref(buf);
+
+	return 0;
+}
 
 void main(void)
 {
@@ -1188,6 +1327,14 @@ void main(void)
 		goto fail;
 	}
 
+	if (test_nbuf_linearize() < 0) {
+		goto fail;
+	}
+
+	if (test_nbuf_view() < 0) {
+		goto fail;
+	}
+
 	printk("nbuf tests passed\n");
 
 	TC_END_REPORT(TC_PASS);
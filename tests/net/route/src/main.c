@@ -653,6 +653,66 @@ static bool route_del_many(void)
 	return true;
 }
 
+static bool route_lookup_longest_prefix(void)
+{
+	struct net_route_entry *host, *prefix, *found;
+	bool ret = false;
+
+	host = net_route_add(my_iface, &dest_addr, 128, &peer_addr);
+	if (!host) {
+		TC_ERROR("Host route add failed\n");
+		return false;
+	}
+
+	prefix = net_route_add(my_iface, &generic_addr, 64, &peer_addr);
+	if (!prefix || prefix == host) {
+		TC_ERROR("Prefix route add failed\n");
+		goto out;
+	}
+
+	found = net_route_lookup(my_iface, &dest_addr);
+	if (found != host) {
+		TC_ERROR("Host route not found (%p vs %p)\n", found, host);
+		goto out;
+	}
+
+	found = net_route_lookup(my_iface, &generic_addr);
+	if (found != prefix) {
+		TC_ERROR("Prefix route not found (%p vs %p)\n", found,
+			 prefix);
+		goto out;
+	}
+
+	/* Once the host route is gone, the prefix one is used for it */
+	net_route_del(host);
+	host = NULL;
+
+	found = net_route_lookup(my_iface, &dest_addr);
+	if (found != prefix) {
+		TC_ERROR("Prefix route not used (%p vs %p)\n", found,
+			 prefix);
+		goto out;
+	}
+
+	ret = true;
+
+out:
+	if (host) {
+		net_route_del(host);
+	}
+
+	if (prefix && prefix != host) {
+		net_route_del(prefix);
+	}
+
+	if (net_route_lookup(my_iface, &dest_addr)) {
+		TC_ERROR("Route found after deleting all routes\n");
+		return false;
+	}
+
+	return ret;
+}
+
 static const struct {
 	const char *name;
 	bool (*func)(void);
@@ -674,6 +734,7 @@ static const struct {
 	{ "Populate neighbor cache again", populate_nbr_cache },
 	{ "Add many routes", route_add_many },
 	{ "Del many routes", route_del_many },
+	{ "Lookup longest prefix", route_lookup_longest_prefix },
 };
 
 void main(void)
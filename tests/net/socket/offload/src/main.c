@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/socket.h>
+#include <net/socket_offload.h>
+
+#define TEST_DATA "test data"
+#define MODEM_SOCK 3
+
+/* Receive buffer of the fake module, looped back from what is sent */
+static uint8_t modem_buf[32];
+static size_t modem_len;
+static bool modem_open;
+
+static int modem_socket(int family, int type, int proto)
+{
+	if (family != AF_INET6 || type != SOCK_DGRAM) {
+		return -EAFNOSUPPORT;
+	}
+
+	modem_open = true;
+
+	return MODEM_SOCK;
+}
+
+static int modem_close(int sock)
+{
+	if (sock != MODEM_SOCK || !modem_open) {
+		return -EBADF;
+	}
+
+	modem_open = false;
+
+	return 0;
+}
+
+static ssize_t modem_sendto(int sock, const void *buf, size_t len, int flags,
+			    const struct sockaddr *dest_addr,
+			    socklen_t addrlen)
+{
+	if (len > sizeof(modem_buf)) {
+		return -EMSGSIZE;
+	}
+
+	memcpy(modem_buf, buf, len);
+	modem_len = len;
+
+	return len;
+}
+
+static ssize_t modem_recvfrom(int sock, void *buf, size_t max_len, int flags,
+			      struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	size_t len = min(max_len, modem_len);
+
+	if (!modem_len) {
+		return -EAGAIN;
+	}
+
+	memcpy(buf, modem_buf, len);
+	modem_len = 0;
+
+	return len;
+}
+
+/* No TCP on this module */
+static const struct net_socket_offload modem_ops = {
+	.socket = modem_socket,
+	.close = modem_close,
+	.sendto = modem_sendto,
+	.recvfrom = modem_recvfrom,
+};
+
+static int sock;
+
+static void test_not_registered(void)
+{
+	assert_equal(socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP), -1,
+		     "socket() without driver");
+	assert_equal(errno, ENETDOWN, "wrong errno");
+
+	net_socket_offload_register(&modem_ops);
+}
+
+static void test_socket(void)
+{
+	assert_equal(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP), -1,
+		     "unsupported family accepted");
+	assert_equal(errno, EAFNOSUPPORT, "errno not set from the driver");
+
+	sock = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	assert_equal(sock, MODEM_SOCK, "not the module socket");
+}
+
+static void test_send_recv(void)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(4242),
+	};
+	char buf[32];
+
+	assert_equal(sendto(sock, TEST_DATA, sizeof(TEST_DATA) - 1, 0,
+			    (struct sockaddr *)&addr, sizeof(addr)),
+		     sizeof(TEST_DATA) - 1, "sendto() failed");
+
+	assert_equal(recv(sock, buf, sizeof(buf), 0), sizeof(TEST_DATA) - 1,
+		     "recv() failed");
+	assert_true(!memcmp(buf, TEST_DATA, sizeof(TEST_DATA) - 1),
+		    "wrong data");
+
+	assert_equal(recv(sock, buf, sizeof(buf), 0), -1, "no data expected");
+	assert_equal(errno, EAGAIN, "wrong errno");
+}
+
+static void test_unsupported(void)
+{
+	assert_equal(listen(sock, 1), -1, "listen() without driver op");
+	assert_equal(errno, EOPNOTSUPP, "wrong errno");
+}
+
+static void test_close(void)
+{
+	assert_equal(close(sock), 0, "close() failed");
+	assert_equal(close(sock), -1, "closed twice");
+	assert_equal(errno, EBADF, "wrong errno");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_socket_offload,
+			 ztest_unit_test(test_not_registered),
+			 ztest_unit_test(test_socket),
+			 ztest_unit_test(test_send_recv),
+			 ztest_unit_test(test_unsupported),
+			 ztest_unit_test(test_close));
+
+	ztest_run_test_suite(net_socket_offload);
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/nbuf.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/socket.h>
+
+#define TEST_DATA "test data"
+#define MY_PORT 4242
+#define PEER_PORT 4243
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+
+static uint8_t mac_addr[6] = { 0x10, 0x00, 0x00, 0x00, 0x00, 0x01 };
+
+static int dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr));
+}
+
+/* Everything sent is sent to ourselves */
+static int tester_send(struct net_if *iface, struct net_buf *buf)
+{
+	if (!buf->frags) {
+		return -ENODATA;
+	}
+
+	return net_recv_data(iface, buf);
+}
+
+static struct net_if_api tester_if_api = {
+	.init = iface_init,
+	.send = tester_send,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(net_socket_test, "net_socket_test", dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &tester_if_api,
+		_ETH_L2_LAYER, _ETH_L2_CTX_TYPE, 127);
+
+static int my_sock, peer_sock;
+
+static void prepare_addr(struct sockaddr_in6 *addr, uint16_t port)
+{
+	memset(addr, 0, sizeof(*addr));
+	addr->sin6_family = AF_INET6;
+	addr->sin6_port = htons(port);
+	net_ipaddr_copy(&addr->sin6_addr, &my_addr);
+}
+
+static void test_setup(void)
+{
+	struct sockaddr_in6 addr;
+
+	assert_not_null(net_if_ipv6_addr_add(net_if_get_default(), &my_addr,
+					     NET_ADDR_MANUAL, 0),
+			"Cannot add address");
+
+	my_sock = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	assert_true(my_sock >= 0, "socket() failed");
+
+	peer_sock = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	assert_true(peer_sock >= 0, "socket() failed");
+
+	prepare_addr(&addr, MY_PORT);
+	assert_equal(bind(my_sock, (struct sockaddr *)&addr, sizeof(addr)), 0,
+		     "bind() failed");
+
+	prepare_addr(&addr, PEER_PORT);
+	assert_equal(bind(peer_sock, (struct sockaddr *)&addr, sizeof(addr)),
+		     0, "bind() failed");
+}
+
+static void test_sendto_recvfrom(void)
+{
+	struct sockaddr_in6 addr, src;
+	socklen_t addrlen = sizeof(src);
+	struct pollfd pfd = { .fd = peer_sock, .events = POLLIN };
+	char data[sizeof(TEST_DATA)];
+
+	prepare_addr(&addr, PEER_PORT);
+	assert_equal(sendto(my_sock, TEST_DATA, sizeof(TEST_DATA), 0,
+			    (struct sockaddr *)&addr, sizeof(addr)),
+		     sizeof(TEST_DATA), "sendto() failed");
+
+	assert_equal(poll(&pfd, 1, 100), 1, "Socket not readable");
+	assert_equal(pfd.revents, POLLIN, "Wrong events");
+
+	assert_equal(recvfrom(peer_sock, data, sizeof(data), 0,
+			      (struct sockaddr *)&src, &addrlen),
+		     sizeof(TEST_DATA), "recvfrom() failed");
+	assert_equal(memcmp(data, TEST_DATA, sizeof(TEST_DATA)), 0,
+		     "Wrong data");
+	assert_equal(addrlen, sizeof(struct sockaddr_in6), "Wrong length");
+	assert_equal(src.sin6_port, htons(MY_PORT), "Wrong source port");
+	assert_true(net_ipv6_addr_cmp(&src.sin6_addr, &my_addr),
+		    "Wrong source address");
+}
+
+static void test_truncate(void)
+{
+	struct sockaddr_in6 addr;
+	char data[4];
+
+	prepare_addr(&addr, PEER_PORT);
+	assert_equal(sendto(my_sock, TEST_DATA, sizeof(TEST_DATA), 0,
+			    (struct sockaddr *)&addr, sizeof(addr)),
+		     sizeof(TEST_DATA), "sendto() failed");
+
+	/* The rest of the datagram is dropped */
+	assert_equal(recv(peer_sock, data, sizeof(data), 0), sizeof(data),
+		     "recv() failed");
+	assert_equal(memcmp(data, TEST_DATA, sizeof(data)), 0, "Wrong data");
+
+	assert_equal(recv(peer_sock, data, sizeof(data), MSG_DONTWAIT), -1,
+		     "Datagram not dropped");
+	assert_equal(errno, EAGAIN, "Wrong errno");
+}
+
+static void test_nonblock(void)
+{
+	struct pollfd pfd = { .fd = peer_sock, .events = POLLIN };
+	char data[sizeof(TEST_DATA)];
+
+	assert_equal(poll(&pfd, 1, 0), 0, "Socket readable");
+	assert_equal(pfd.revents, 0, "Wrong events");
+
+	assert_equal(fcntl(peer_sock, F_SETFL, O_NONBLOCK), 0,
+		     "fcntl() failed");
+	assert_equal(fcntl(peer_sock, F_GETFL, 0), O_NONBLOCK,
+		     "Not non-blocking");
+
+	assert_equal(recv(peer_sock, data, sizeof(data), 0), -1,
+		     "recv() did not fail");
+	assert_equal(errno, EAGAIN, "Wrong errno");
+
+	assert_equal(fcntl(peer_sock, F_SETFL, 0), 0, "fcntl() failed");
+}
+
+static void test_connected(void)
+{
+	struct sockaddr_in6 addr;
+	char data[sizeof(TEST_DATA)];
+	int sock;
+
+	/* An unbound socket gets a port when connecting */
+	sock = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	assert_true(sock >= 0, "socket() failed");
+
+	prepare_addr(&addr, PEER_PORT);
+	assert_equal(connect(sock, (struct sockaddr *)&addr, sizeof(addr)), 0,
+		     "connect() failed");
+
+	assert_equal(send(sock, TEST_DATA, sizeof(TEST_DATA), 0),
+		     sizeof(TEST_DATA), "send() failed");
+	assert_equal(recv(peer_sock, data, sizeof(data), 0),
+		     sizeof(TEST_DATA), "recv() failed");
+
+	assert_equal(close(sock), 0, "close() failed");
+}
+
+static void test_close(void)
+{
+	assert_equal(close(my_sock), 0, "close() failed");
+	assert_equal(close(peer_sock), 0, "close() failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_socket_udp,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_sendto_recvfrom),
+			 ztest_unit_test(test_truncate),
+			 ztest_unit_test(test_nonblock),
+			 ztest_unit_test(test_connected),
+			 ztest_unit_test(test_close));
+
+	ztest_run_test_suite(net_socket_udp);
+}
@@ -326,6 +326,52 @@ static bool send_ipv4_udp_msg(struct net_if *iface,
 	return !fail;
 }
 
+#define BATCH_COUNT 3
+
+static bool send_ipv4_udp_batch(struct net_if *iface,
+				struct in_addr *src,
+				struct in_addr *dst,
+				uint16_t src_port,
+				uint16_t dst_port,
+				struct ud *ud)
+{
+	struct net_buf *bufs[BATCH_COUNT];
+	int i, ret;
+
+	for (i = 0; i < BATCH_COUNT; i++) {
+		bufs[i] = net_nbuf_get_reserve_tx(0);
+		net_buf_frag_add(bufs[i], net_nbuf_get_reserve_data(0));
+
+		net_nbuf_set_iface(bufs[i], iface);
+		net_nbuf_set_ll_reserve(bufs[i],
+					net_buf_headroom(bufs[i]->frags));
+
+		setup_ipv4_udp(bufs[i], src, dst, src_port, dst_port);
+	}
+
+	ret = net_recv_data_list(iface, bufs, BATCH_COUNT);
+	if (ret != BATCH_COUNT) {
+		printk("Cannot recv batch, ret %d\n", ret);
+		return false;
+	}
+
+	for (i = 0; i < BATCH_COUNT; i++) {
+		if (k_sem_take(&recv_lock, TIMEOUT)) {
+			printk("Timeout, packet %d of batch not received\n",
+			       i);
+			return false;
+		}
+
+		if (ud != returned_ud) {
+			printk("IPv4 wrong user data %p returned, "
+			       "expected %p\n", returned_ud, ud);
+			return false;
+		}
+	}
+
+	return !fail;
+}
+
 static void set_port(sa_family_t family, struct sockaddr *raddr,
 		     struct sockaddr *laddr, uint16_t rport,
 		     uint16_t lport)
@@ -356,7 +402,7 @@ static bool run_tests(void)
 	struct net_conn_handle *handlers[CONFIG_NET_MAX_CONN];
 	struct net_if *iface = net_if_get_default();
 	struct net_if_addr *ifaddr;
-	struct ud *ud;
+	struct ud *ud, *ud2;
 	int ret, i = 0;
 	bool st;
 
@@ -532,6 +578,24 @@ static bool run_tests(void)
 	TEST_IPV4_OK(ud, &in4addr_peer, &in4addr_my, 1234, 4242);
 	TEST_IPV4_FAIL(ud, &in4addr_peer, &in4addr_my, 1234, 4243);
 
+	/* Packets received in a batch are all delivered */
+	if (!send_ipv4_udp_batch(iface, &in4addr_peer, &in4addr_my, 1234,
+				 4242, ud)) {
+		printk("%d: UDP batch test \"%s\" fail\n", __LINE__,
+		       ud->test);
+		return false;
+	}
+
+	/* A connected entry wins over a listener of the same port */
+	ud = REGISTER(AF_INET6, &any_addr6, NULL, 0, 4250);
+	TEST_IPV6_OK(ud, &in6addr_peer, &in6addr_my, 1234, 4250);
+	ud2 = REGISTER(AF_INET6, &peer_addr6, NULL, 1234, 4250);
+	TEST_IPV6_OK(ud2, &in6addr_peer, &in6addr_my, 1234, 4250);
+	TEST_IPV6_OK(ud, &in6addr_peer, &in6addr_my, 1235, 4250);
+	UNREGISTER(ud2);
+	TEST_IPV6_OK(ud, &in6addr_peer, &in6addr_my, 1234, 4250);
+	UNREGISTER(ud);
+
 	ud = REGISTER(AF_UNSPEC, NULL, NULL, 1234, 42423);
 	TEST_IPV4_OK(ud, &in4addr_peer, &in4addr_my, 1234, 42423);
 	TEST_IPV6_OK(ud, &in6addr_peer, &in6addr_my, 1234, 42423);
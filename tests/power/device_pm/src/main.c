@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+extern void test_pm_autosuspend_at_boot(void);
+extern void test_pm_refcount(void);
+extern void test_pm_autosuspend_delay(void);
+extern void test_pm_resume_latency(void);
+extern void test_pm_state_select(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_device_pm,
+			 ztest_unit_test(test_pm_autosuspend_at_boot),
+			 ztest_unit_test(test_pm_refcount),
+			 ztest_unit_test(test_pm_autosuspend_delay),
+			 ztest_unit_test(test_pm_resume_latency),
+			 ztest_unit_test(test_pm_state_select));
+	ztest_run_test_suite(test_device_pm);
+}
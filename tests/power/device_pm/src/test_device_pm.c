@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_power
+ * @{
+ * @defgroup t_device_pm test_device_pm
+ * @brief TestPurpose: verify the device runtime power management
+ * - API coverage
+ *   -# device_pm_enable
+ *   -# device_pm_get, device_pm_put
+ *   -# device_pm_resume_latency_get, sys_pm_state_select
+ * @}
+ */
+
+#include <ztest.h>
+#include <device.h>
+#include <power.h>
+
+#define BUS_AUTOSUSPEND_MS	0
+#define CHILD_AUTOSUSPEND_MS	20
+#define CHILD_RESUME_US		500
+
+/* long enough for both devices to suspend once unused */
+#define SUSPEND_WAIT_MS		100
+
+struct test_dev_data {
+	struct device_pm pm;
+	uint32_t state;
+	int resumes;
+	int suspends;
+	uint32_t resume_us;
+};
+
+static struct test_dev_data bus_data = {
+	.state = DEVICE_PM_ACTIVE_STATE,
+};
+
+static struct test_dev_data child_data = {
+	.state = DEVICE_PM_ACTIVE_STATE,
+	.resume_us = CHILD_RESUME_US,
+};
+
+static int test_dev_pm_control(struct device *dev, uint32_t command,
+			       void *context)
+{
+	struct test_dev_data *data = dev->driver_data;
+	uint32_t state;
+
+	if (command == DEVICE_PM_GET_POWER_STATE) {
+		*((uint32_t *)context) = data->state;
+		return 0;
+	}
+
+	state = *((uint32_t *)context);
+	if (state == DEVICE_PM_ACTIVE_STATE) {
+		k_busy_wait(data->resume_us);
+		data->resumes++;
+	} else {
+		data->suspends++;
+	}
+
+	data->state = state;
+
+	return 0;
+}
+
+static int test_bus_init(struct device *dev)
+{
+	device_pm_enable(dev, &bus_data.pm, NULL, BUS_AUTOSUSPEND_MS);
+
+	return 0;
+}
+
+DEVICE_DEFINE(test_bus, "test_bus", test_bus_init, test_dev_pm_control,
+	      &bus_data, NULL, APPLICATION, 0, NULL);
+
+static int test_child_init(struct device *dev)
+{
+	device_pm_enable(dev, &child_data.pm, DEVICE_GET(test_bus),
+			 CHILD_AUTOSUSPEND_MS);
+
+	return 0;
+}
+
+DEVICE_DEFINE(test_child, "test_child", test_child_init, test_dev_pm_control,
+	      &child_data, NULL, APPLICATION, 1, NULL);
+
+/*test cases*/
+void test_pm_autosuspend_at_boot(void)
+{
+	k_sleep(SUSPEND_WAIT_MS);
+
+	/**TESTPOINT: unused devices are suspended, child first*/
+	assert_equal(child_data.state, DEVICE_PM_SUSPEND_STATE, NULL);
+	assert_equal(bus_data.state, DEVICE_PM_SUSPEND_STATE, NULL);
+	assert_equal(child_data.suspends, 1, NULL);
+	assert_equal(bus_data.suspends, 1, NULL);
+}
+
+void test_pm_refcount(void)
+{
+	struct device *child = DEVICE_GET(test_child);
+	int resumes = child_data.resumes;
+
+	/**TESTPOINT: getting a device resumes its parent too*/
+	assert_equal(device_pm_get(child), 0, NULL);
+	assert_equal(child_data.state, DEVICE_PM_ACTIVE_STATE, NULL);
+	assert_equal(bus_data.state, DEVICE_PM_ACTIVE_STATE, NULL);
+
+	/**TESTPOINT: an active device is not resumed again*/
+	assert_equal(device_pm_get(child), 0, NULL);
+	assert_equal(child_data.resumes, resumes + 1, NULL);
+
+	/**TESTPOINT: the device stays active until its last put*/
+	assert_equal(device_pm_put(child), 0, NULL);
+	k_sleep(SUSPEND_WAIT_MS);
+	assert_equal(child_data.state, DEVICE_PM_ACTIVE_STATE, NULL);
+
+	assert_equal(device_pm_put(child), 0, NULL);
+	k_sleep(SUSPEND_WAIT_MS);
+	assert_equal(child_data.state, DEVICE_PM_SUSPEND_STATE, NULL);
+	assert_equal(bus_data.state, DEVICE_PM_SUSPEND_STATE, NULL);
+
+	/**TESTPOINT: unbalanced puts are rejected*/
+	assert_equal(device_pm_put(child), -EINVAL, NULL);
+}
+
+void test_pm_autosuspend_delay(void)
+{
+	struct device *child = DEVICE_GET(test_child);
+	int resumes = child_data.resumes;
+	int suspends = child_data.suspends;
+
+	assert_equal(device_pm_get(child), 0, NULL);
+	assert_equal(device_pm_put(child), 0, NULL);
+
+	/**TESTPOINT: a device gotten again within the delay stays active*/
+	assert_equal(device_pm_get(child), 0, NULL);
+	assert_equal(device_pm_put(child), 0, NULL);
+	assert_equal(child_data.resumes, resumes + 1, NULL);
+	assert_equal(child_data.suspends, suspends, NULL);
+
+	k_sleep(SUSPEND_WAIT_MS);
+	assert_equal(child_data.suspends, suspends + 1, NULL);
+}
+
+void test_pm_resume_latency(void)
+{
+	struct device *child = DEVICE_GET(test_child);
+
+	/**TESTPOINT: the resume latency of the devices is measured*/
+	assert_true(child_data.pm.resume_latency_us >= CHILD_RESUME_US, NULL);
+	assert_true(child_data.pm.max_resume_latency_us >= CHILD_RESUME_US,
+		    NULL);
+
+	/**TESTPOINT: only suspended devices count for the state policy*/
+	assert_true(device_pm_resume_latency_get() >= CHILD_RESUME_US, NULL);
+
+	assert_equal(device_pm_get(child), 0, NULL);
+	assert_equal(device_pm_resume_latency_get(), 0, NULL);
+	assert_equal(device_pm_put(child), 0, NULL);
+
+	k_sleep(SUSPEND_WAIT_MS);
+	assert_true(device_pm_resume_latency_get() >= CHILD_RESUME_US, NULL);
+}
+
+void test_pm_state_select(void)
+{
+	static const struct sys_pm_state states[] = {
+		{ 0, CHILD_RESUME_US + 1, 0 },
+	};
+	struct sys_pm_qos_request req;
+	struct device *child = DEVICE_GET(test_child);
+
+	sys_pm_states_set(states, ARRAY_SIZE(states));
+	sys_pm_qos_request_add(&req, 2 * CHILD_RESUME_US);
+
+	/**TESTPOINT: the state exit plus the device resume break the
+	 * constraint while the device is suspended
+	 */
+	assert_is_null(sys_pm_state_select(K_FOREVER), NULL);
+
+	assert_equal(device_pm_get(child), 0, NULL);
+	assert_equal(sys_pm_state_select(K_FOREVER), &states[0], NULL);
+	assert_equal(device_pm_put(child), 0, NULL);
+
+	sys_pm_qos_request_remove(&req);
+	sys_pm_states_set(NULL, 0);
+}
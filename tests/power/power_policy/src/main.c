@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+extern void test_policy_no_states(void);
+extern void test_policy_residency(void);
+extern void test_policy_qos(void);
+extern void test_policy_predict(void);
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ztest_test_suite(test_power_policy,
+			 ztest_unit_test(test_policy_no_states),
+			 ztest_unit_test(test_policy_residency),
+			 ztest_unit_test(test_policy_qos),
+			 ztest_unit_test(test_policy_predict));
+	ztest_run_test_suite(test_power_policy);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_power
+ * @{
+ * @defgroup t_power_policy test_power_policy
+ * @brief TestPurpose: verify the low power state selection policy
+ * - API coverage
+ *   -# sys_pm_states_set
+ *   -# sys_pm_qos_request_add, sys_pm_qos_request_update,
+ *      sys_pm_qos_request_remove, sys_pm_qos_latency_get
+ *   -# sys_pm_idle_predict, sys_pm_state_select
+ * @}
+ */
+
+#include <ztest.h>
+#include <power.h>
+
+#define TICKS_FOR_US(us) (((us) + sys_clock_us_per_tick - 1) / \
+			  sys_clock_us_per_tick)
+
+enum test_state_id {
+	STATE_SHALLOW,
+	STATE_MEDIUM,
+	STATE_DEEP,
+};
+
+static const struct sys_pm_state test_states[] = {
+	{ STATE_SHALLOW, 10, 100 },
+	{ STATE_MEDIUM, 1000, 20000 },
+	{ STATE_DEEP, 100000, 1000000 },
+};
+
+static int selected(int32_t ticks)
+{
+	const struct sys_pm_state *state = sys_pm_state_select(ticks);
+
+	return state ? state->id : -1;
+}
+
+/*test cases*/
+void test_policy_no_states(void)
+{
+	/**TESTPOINT: nothing is selected without states*/
+	assert_equal(selected(K_FOREVER), -1, NULL);
+	assert_equal(sys_pm_qos_latency_get(), SYS_PM_NO_CONSTRAINT, NULL);
+}
+
+void test_policy_residency(void)
+{
+	sys_pm_states_set(test_states, ARRAY_SIZE(test_states));
+
+	/* the predicted idle time depends on the previous idle periods */
+	if (IS_ENABLED(CONFIG_SYS_POWER_STATE_PREDICT)) {
+		return;
+	}
+
+	/**TESTPOINT: the deepest state worth the idle time is selected*/
+	assert_equal(selected(0), -1, NULL);
+	assert_equal(selected(TICKS_FOR_US(100)), STATE_SHALLOW, NULL);
+	assert_equal(selected(TICKS_FOR_US(20000)), STATE_MEDIUM, NULL);
+	assert_equal(selected(TICKS_FOR_US(1000000)), STATE_DEEP, NULL);
+	assert_equal(selected(K_FOREVER), STATE_DEEP, NULL);
+}
+
+void test_policy_qos(void)
+{
+	struct sys_pm_qos_request req1, req2;
+
+	sys_pm_states_set(test_states, ARRAY_SIZE(test_states));
+
+	/**TESTPOINT: the lowest latency of the requests applies*/
+	sys_pm_qos_request_add(&req1, 5000);
+	sys_pm_qos_request_add(&req2, 50);
+	assert_equal(sys_pm_qos_latency_get(), 50, NULL);
+
+	sys_pm_qos_request_update(&req2, 500000);
+	assert_equal(sys_pm_qos_latency_get(), 5000, NULL);
+
+	if (!IS_ENABLED(CONFIG_SYS_POWER_STATE_PREDICT)) {
+		/**TESTPOINT: states exiting too slowly are not selected*/
+		assert_equal(selected(K_FOREVER), STATE_MEDIUM, NULL);
+	}
+
+	sys_pm_qos_request_update(&req1, 0);
+	assert_equal(selected(K_FOREVER), -1, NULL);
+
+	sys_pm_qos_request_remove(&req1);
+	assert_equal(sys_pm_qos_latency_get(), 500000, NULL);
+	sys_pm_qos_request_remove(&req2);
+	assert_equal(sys_pm_qos_latency_get(), SYS_PM_NO_CONSTRAINT, NULL);
+}
+
+void test_policy_predict(void)
+{
+	int32_t ticks = TICKS_FOR_US(1000000);
+
+	/* idle periods are measured while the test thread sleeps */
+	k_sleep(1);
+
+	/**TESTPOINT: the idle time is never predicted past the timeout*/
+	assert_true(sys_pm_idle_predict(ticks) <=
+		    (uint32_t)ticks * sys_clock_us_per_tick, NULL);
+	assert_equal(sys_pm_idle_predict(0), 0, NULL);
+
+	if (!IS_ENABLED(CONFIG_SYS_POWER_STATE_PREDICT)) {
+		assert_equal(sys_pm_idle_predict(K_FOREVER), UINT32_MAX, NULL);
+		return;
+	}
+
+	/**TESTPOINT: short idle periods lower the prediction*/
+	assert_true(sys_pm_idle_predict(K_FOREVER) < UINT32_MAX, NULL);
+}
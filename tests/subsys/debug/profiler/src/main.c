@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <ztest.h>
+#include <debug/profiler.h>
+
+#define OUTER_CALLS 10
+
+/* Not inlined nor optimized out, so that their calls are instrumented */
+__attribute__((noinline)) void profiled_leaf(void)
+{
+	k_busy_wait(10);
+	__asm__ volatile ("" ::: "memory");
+}
+
+__attribute__((noinline)) void profiled_outer(void)
+{
+	profiled_leaf();
+	k_busy_wait(10);
+	profiled_leaf();
+}
+
+static int find(void *fn, struct profiler_func *func)
+{
+	unsigned int i;
+
+	for (i = 0; !profiler_get(i, func); i++) {
+		if (func->fn == fn) {
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static void test_accounting(void)
+{
+	struct profiler_func outer, leaf;
+	int i;
+
+	profiler_reset();
+	profiler_enable(1);
+	for (i = 0; i < OUTER_CALLS; i++) {
+		profiled_outer();
+	}
+	profiler_enable(0);
+
+	assert_equal(find(profiled_outer, &outer), 0, "outer not accounted");
+	assert_equal(find(profiled_leaf, &leaf), 0, "leaf not accounted");
+
+	assert_equal(outer.calls, OUTER_CALLS, "wrong outer calls");
+	assert_equal(leaf.calls, 2 * OUTER_CALLS, "wrong leaf calls");
+
+	assert_equal(leaf.inclusive, leaf.exclusive, "leaf has children");
+	assert_true(outer.inclusive >= outer.exclusive + leaf.inclusive,
+		    "children not excluded");
+	assert_true(outer.exclusive > 0, "no exclusive cycles");
+}
+
+static void test_disabled(void)
+{
+	struct profiler_func func;
+
+	profiler_reset();
+	profiled_outer();
+
+	assert_equal(profiler_get(0, &func), -ENOENT,
+		     "accounted while disabled");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(profiler_test,
+			 ztest_unit_test(test_accounting),
+			 ztest_unit_test(test_disabled));
+
+	ztest_run_test_suite(profiler_test);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define SYS_LOG_DOMAIN "test"
+#define SYS_LOG_LEVEL 4
+#define SYS_LOG_NO_NEWLINE
+#include <logging/sys_log.h>
+
+#include <errno.h>
+#include <string.h>
+#include <ztest.h>
+
+/* Longer than the logging thread needs to drain the buffer */
+#define LOG_WAIT 100
+
+static char last_line[CONFIG_SYS_LOG_CORE_LINE_SIZE];
+static int lines;
+
+static void test_backend_put(const char *line, size_t len)
+{
+	memcpy(last_line, line, len);
+	last_line[len] = '\0';
+	lines++;
+}
+
+static struct sys_log_backend test_backend = {
+	.put = test_backend_put,
+};
+
+/* The line starts with the timestamp, compare after it */
+static const char *line_body(void)
+{
+	const char *body = strchr(last_line, ' ');
+
+	assert_not_null(body, "no timestamp");
+
+	return body + 1;
+}
+
+static void test_output(void)
+{
+	SYS_LOG_INF("%d %x %s", -3, 0xab, "str");
+	k_sleep(LOG_WAIT);
+
+	assert_equal(lines, 1, "line not output");
+	assert_true(!strcmp(line_body(),
+			    "[test] [INF] test_output: -3 ab str"),
+		    "wrong line");
+}
+
+static void test_filtering(void)
+{
+	lines = 0;
+
+	assert_equal(sys_log_core_level_set("test", SYS_LOG_LEVEL_WARNING),
+		     0, "module not registered");
+	SYS_LOG_DBG("filtered");
+	SYS_LOG_WRN("kept");
+	k_sleep(LOG_WAIT);
+
+	assert_equal(lines, 1, "level not applied");
+	assert_true(!strcmp(line_body(), "[test] [WRN] test_filtering: kept"),
+		    "wrong line");
+
+	assert_equal(sys_log_core_level_set("none", SYS_LOG_LEVEL_DEBUG),
+		     -ENOENT, "unknown module found");
+	assert_equal(sys_log_core_level_set(NULL, SYS_LOG_LEVEL_DEBUG),
+		     0, "level not restored");
+}
+
+static void test_drops(void)
+{
+	uint32_t dropped = sys_log_core_dropped_get();
+	int i;
+
+	/* The logging thread cannot run while the buffer fills up */
+	k_sched_lock();
+	for (i = 0; i < 64; i++) {
+		SYS_LOG_ERR("%d", i);
+	}
+	k_sched_unlock();
+
+	assert_true(sys_log_core_dropped_get() > dropped,
+		    "no message dropped");
+	k_sleep(LOG_WAIT);
+	assert_not_null(strstr(last_line, "messages dropped"),
+			"drops not reported");
+}
+
+void test_main(void)
+{
+	sys_log_backend_register(&test_backend);
+
+	ztest_test_suite(sys_log_core_test,
+			 ztest_unit_test(test_output),
+			 ztest_unit_test(test_filtering),
+			 ztest_unit_test(test_drops));
+
+	ztest_run_test_suite(sys_log_core_test);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#include <misc/util.h>
+#include <misc/hash_map.h>
+
+#define TEST_MAP_POW 6
+#define TEST_NODE_COUNT ((1 << TEST_MAP_POW) - 1)
+
+struct container {
+	uint32_t key;
+	sys_hnode_t node;
+};
+
+static struct container items[TEST_NODE_COUNT + 1];
+
+SYS_HASH_MAP_DEFINE_POW2(map, TEST_MAP_POW);
+
+static bool key_match(const void *key, const sys_hnode_t *node)
+{
+	return *(const uint32_t *)key ==
+	       CONTAINER_OF(node, struct container, node)->key;
+}
+
+/* Few hash values, so that the probe sequences overlap and wrap */
+static uint32_t bad_hash(uint32_t key)
+{
+	return (key % 5) * 13 + 60;
+}
+
+static struct container *find(uint32_t key, uint32_t hash)
+{
+	sys_hnode_t *node = sys_hash_map_find(&map, hash, &key, key_match);
+
+	return node ? CONTAINER_OF(node, struct container, node) : NULL;
+}
+
+/* Check the keys, the odd ones up to removed_last being removed */
+static void check_all(uint32_t (*hash)(uint32_t), int removed_last)
+{
+	int i;
+
+	for (i = 0; i < TEST_NODE_COUNT; i++) {
+		if (i <= removed_last && (i & 1)) {
+			assert_is_null(find(items[i].key, hash(items[i].key)),
+				       "Removed key found");
+		} else {
+			assert_equal_ptr(find(items[i].key,
+					      hash(items[i].key)),
+					 &items[i], "Key not found");
+		}
+	}
+}
+
+static void fill_remove(uint32_t (*hash)(uint32_t))
+{
+	sys_hnode_t *node;
+	uint32_t i, count;
+
+	assert_equal(sys_hash_map_count(&map), 0, "Map not empty");
+
+	for (i = 0; i < TEST_NODE_COUNT; i++) {
+		items[i].key = i * 7919;
+		assert_equal(sys_hash_map_insert(&map, &items[i].node,
+						 hash(items[i].key)), 0,
+			     "Insertion failed");
+	}
+
+	items[i].key = i * 7919;
+	assert_equal(sys_hash_map_insert(&map, &items[i].node,
+					 hash(items[i].key)), -ENOSPC,
+		     "Insertion in a full map");
+	assert_false(sys_hash_map_remove(&map, &items[i].node),
+		     "Unknown node removed");
+
+	check_all(hash, -1);
+
+	for (i = 1; i < TEST_NODE_COUNT; i += 2) {
+		assert_true(sys_hash_map_remove(&map, &items[i].node),
+			    "Removal failed");
+		check_all(hash, i);
+	}
+
+	count = 0;
+	SYS_HASH_MAP_FOR_EACH_NODE(&map, i, node) {
+		count++;
+	}
+	assert_equal(count, sys_hash_map_count(&map), "Invalid node count");
+
+	for (i = 0; i < TEST_NODE_COUNT; i += 2) {
+		assert_true(sys_hash_map_remove(&map, &items[i].node),
+			    "Removal failed");
+	}
+
+	assert_equal(sys_hash_map_count(&map), 0, "Map not empty");
+}
+
+static void test_hash_map_spread(void)
+{
+	fill_remove(sys_hash32_u32);
+}
+
+static void test_hash_map_collisions(void)
+{
+	fill_remove(bad_hash);
+}
+
+static void test_hash_map_init(void)
+{
+	static sys_hnode_t *slots[4];
+	sys_hash_map_t small;
+	uint32_t key = 1;
+
+	sys_hash_map_init(&small, slots, 2);
+	items[0].key = key;
+
+	assert_equal(sys_hash_map_insert(&small, &items[0].node,
+					 sys_hash32_bytes(&key, sizeof(key))),
+		     0, "Insertion failed");
+	assert_equal_ptr(sys_hash_map_find(&small,
+					   sys_hash32_bytes(&key, sizeof(key)),
+					   &key, key_match),
+			 &items[0].node, "Key not found");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(hash_map_test,
+		ztest_unit_test(test_hash_map_spread),
+		ztest_unit_test(test_hash_map_collisions),
+		ztest_unit_test(test_hash_map_init)
+	);
+
+	ztest_run_test_suite(hash_map_test);
+}
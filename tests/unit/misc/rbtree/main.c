@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#include <misc/util.h>
+#include <misc/rbtree.h>
+
+#define TEST_NODE_COUNT 256
+
+struct container {
+	int key;
+	sys_rbnode_t node;
+};
+
+static struct container items[TEST_NODE_COUNT];
+static sys_rbtree_t tree;
+
+static int node_cmp(const sys_rbnode_t *a, const sys_rbnode_t *b)
+{
+	return CONTAINER_OF(a, struct container, node)->key -
+	       CONTAINER_OF(b, struct container, node)->key;
+}
+
+static int key_cmp(const void *key, const sys_rbnode_t *node)
+{
+	return *(const int *)key - CONTAINER_OF(node, struct container,
+						node)->key;
+}
+
+/* Check the red-black properties below node, return its black height */
+static int check_subtree(sys_rbnode_t *node, sys_rbnode_t *parent)
+{
+	int left, right;
+
+	if (!node) {
+		return 1;
+	}
+
+	assert_equal_ptr(_rb_parent(node), parent, "Invalid parent");
+
+	if (_rb_is_red(node)) {
+		assert_false(_rb_is_red(node->child[0]) ||
+			     _rb_is_red(node->child[1]), "Red node has red child");
+	}
+
+	if (node->child[0]) {
+		assert_true(node_cmp(node->child[0], node) < 0,
+			    "Left child not lower");
+	}
+	if (node->child[1]) {
+		assert_true(node_cmp(node->child[1], node) > 0,
+			    "Right child not greater");
+	}
+
+	left = check_subtree(node->child[0], node);
+	right = check_subtree(node->child[1], node);
+	assert_equal(left, right, "Unbalanced black height");
+
+	return left + !_rb_is_red(node);
+}
+
+static int check_tree(void)
+{
+	sys_rbnode_t *node, *prev = NULL;
+	int count = 0;
+
+	assert_false(_rb_is_red(tree.root), "Red root");
+	check_subtree(tree.root, NULL);
+
+	SYS_RB_FOR_EACH_NODE(&tree, node) {
+		if (prev) {
+			assert_true(node_cmp(prev, node) < 0, "Unordered walk");
+			assert_equal_ptr(sys_rb_prev(node), prev,
+					 "Invalid previous node");
+		}
+		prev = node;
+		count++;
+	}
+
+	assert_equal_ptr(sys_rb_max(&tree), prev, "Invalid last node");
+
+	return count;
+}
+
+/* Keys in a pseudo-random order: 97 and TEST_NODE_COUNT are coprime */
+static int shuffled_key(int i)
+{
+	return (i * 97) % TEST_NODE_COUNT;
+}
+
+static void test_rb_insert(void)
+{
+	struct container dup = { .key = 42 };
+	int i;
+
+	sys_rb_init(&tree, node_cmp);
+	assert_true(sys_rb_is_empty(&tree), "Tree not empty");
+	assert_is_null(sys_rb_min(&tree), "Empty tree has a node");
+
+	for (i = 0; i < TEST_NODE_COUNT; i++) {
+		items[i].key = shuffled_key(i);
+		assert_is_null(sys_rb_insert(&tree, &items[i].node),
+			       "Insertion failed");
+		assert_equal(check_tree(), i + 1, "Invalid node count");
+	}
+
+	assert_equal_ptr(sys_rb_insert(&tree, &dup.node),
+			 sys_rb_find(&tree, &dup.key, key_cmp),
+			 "Duplicate inserted");
+	assert_equal(check_tree(), TEST_NODE_COUNT, "Invalid node count");
+}
+
+static void test_rb_find(void)
+{
+	sys_rbnode_t *node;
+	int key;
+
+	for (key = 0; key < TEST_NODE_COUNT; key++) {
+		node = sys_rb_find(&tree, &key, key_cmp);
+		assert_not_null(node, "Key not found");
+		assert_equal(CONTAINER_OF(node, struct container, node)->key,
+			     key, "Wrong node found");
+	}
+
+	key = TEST_NODE_COUNT;
+	assert_is_null(sys_rb_find(&tree, &key, key_cmp), "Unknown key found");
+	key = -1;
+	assert_is_null(sys_rb_find(&tree, &key, key_cmp), "Unknown key found");
+
+	node = sys_rb_min(&tree);
+	assert_equal(CONTAINER_OF(node, struct container, node)->key, 0,
+		     "Invalid first node");
+}
+
+static void test_rb_remove(void)
+{
+	sys_rbnode_t *node, *next;
+	int i, count = TEST_NODE_COUNT;
+
+	/* Remove every other node in insertion order, then the others
+	 * while walking the tree
+	 */
+	for (i = 0; i < TEST_NODE_COUNT; i += 2) {
+		sys_rb_remove(&tree, &items[i].node);
+		assert_equal(check_tree(), --count, "Invalid node count");
+	}
+
+	for (i = 0; i < TEST_NODE_COUNT; i += 2) {
+		assert_is_null(sys_rb_find(&tree, &items[i].key, key_cmp),
+			       "Removed key found");
+	}
+
+	SYS_RB_FOR_EACH_NODE_SAFE(&tree, node, next) {
+		sys_rb_remove(&tree, node);
+		assert_equal(check_tree(), --count, "Invalid node count");
+	}
+
+	assert_true(sys_rb_is_empty(&tree), "Tree not empty");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(rbtree_test,
+		ztest_unit_test(test_rb_insert),
+		ztest_unit_test(test_rb_find),
+		ztest_unit_test(test_rb_remove)
+	);
+
+	ztest_run_test_suite(rbtree_test);
+}
@@ -41,6 +41,7 @@
 
 #include <ztest_assert.h>
 #include <ztest_mock.h>
+#include <ztest_benchmark.h>
 #include <ztest_test.h>
 #include <tc_util.h>
 
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief Ztest benchmark support
+ */
+
+#ifndef __ZTEST_BENCHMARK_H__
+#define __ZTEST_BENCHMARK_H__
+
+/**
+ * @defgroup ztest_benchmark Ztest benchmark support
+ * @ingroup ztest
+ *
+ * This module runs an operation repeatedly, timing it with the hardware
+ * cycle counter, and reports statistics of its duration in cycles. These
+ * need CONFIG_ZTEST_BENCHMARK=y.
+ *
+ * The statistics are printed on one line, collected by sanitycheck:
+ *
+ * BENCHMARK <name> runs=<n> min=<c> max=<c> mean=<c> median=<c> p90=<c>
+ * p99=<c> hz=<cycles per second>
+ *
+ * @{
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Statistics of a benchmark, in hardware cycles
+ */
+struct ztest_benchmark_stats {
+	uint32_t runs;
+	uint32_t min;
+	uint32_t max;
+	uint32_t mean;
+	uint32_t median;
+	uint32_t p90;
+	uint32_t p99;
+};
+
+/**
+ * @brief Operation to benchmark
+ *
+ * @param data Argument given to ztest_benchmark_run()
+ */
+typedef void (*ztest_benchmark_fn_t)(void *data);
+
+/**
+ * @brief Benchmark an operation
+ *
+ * Runs @a fn @a warmup times untimed, to fill the caches and reach the
+ * steady state, then @a runs times timed. The cost of the timing itself is
+ * subtracted from each sample. The statistics are reported.
+ *
+ * @param name Name of the benchmark, without spaces
+ * @param fn Operation to benchmark
+ * @param data Argument of @a fn
+ * @param warmup Number of untimed runs
+ * @param runs Number of timed runs, at most CONFIG_ZTEST_BENCHMARK_SAMPLES
+ * @param stats Statistics of the benchmark, NULL if not needed
+ */
+void ztest_benchmark_run(const char *name, ztest_benchmark_fn_t fn,
+			 void *data, uint32_t warmup, uint32_t runs,
+			 struct ztest_benchmark_stats *stats);
+
+/**
+ * @brief Compute the statistics of samples
+ *
+ * For benchmarks timing themselves, such as context switches measured in
+ * another thread. The samples are sorted in place.
+ *
+ * @param samples Durations in cycles
+ * @param count Number of samples
+ * @param stats Statistics of the samples
+ */
+void ztest_benchmark_compute(uint32_t *samples, uint32_t count,
+			     struct ztest_benchmark_stats *stats);
+
+/**
+ * @brief Report the statistics of a benchmark
+ *
+ * @param name Name of the benchmark, without spaces
+ * @param stats Statistics of the benchmark
+ */
+void ztest_benchmark_report(const char *name,
+			    const struct ztest_benchmark_stats *stats);
+
+/**
+ * @}
+ */
+
+#endif /* __ZTEST_BENCHMARK_H__ */
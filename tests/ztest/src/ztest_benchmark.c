@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+static uint32_t samples[CONFIG_ZTEST_BENCHMARK_SAMPLES];
+
+static void nop(void *data)
+{
+	ARG_UNUSED(data);
+}
+
+/* Cycles spent timing an empty operation */
+static uint32_t timing_overhead(void)
+{
+	ztest_benchmark_fn_t volatile fn = nop;
+	uint32_t start, overhead = UINT32_MAX;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		start = k_cycle_get_32();
+		fn(NULL);
+		overhead = min(overhead, k_cycle_get_32() - start);
+	}
+
+	return overhead;
+}
+
+static void sort(uint32_t *values, uint32_t count)
+{
+	uint32_t i, j, value;
+
+	for (i = 1; i < count; i++) {
+		value = values[i];
+
+		for (j = i; j > 0 && values[j - 1] > value; j--) {
+			values[j] = values[j - 1];
+		}
+
+		values[j] = value;
+	}
+}
+
+/* Nearest rank percentile of sorted values */
+static uint32_t percentile(const uint32_t *values, uint32_t count,
+			   unsigned int percent)
+{
+	uint32_t rank = (percent * count + 99) / 100;
+
+	return values[rank ? rank - 1 : 0];
+}
+
+void ztest_benchmark_compute(uint32_t *values, uint32_t count,
+			     struct ztest_benchmark_stats *stats)
+{
+	uint64_t sum = 0;
+	uint32_t i;
+
+	memset(stats, 0, sizeof(*stats));
+
+	if (!count) {
+		return;
+	}
+
+	sort(values, count);
+
+	for (i = 0; i < count; i++) {
+		sum += values[i];
+	}
+
+	stats->runs = count;
+	stats->min = values[0];
+	stats->max = values[count - 1];
+	stats->mean = sum / count;
+	stats->median = percentile(values, count, 50);
+	stats->p90 = percentile(values, count, 90);
+	stats->p99 = percentile(values, count, 99);
+}
+
+void ztest_benchmark_report(const char *name,
+			    const struct ztest_benchmark_stats *stats)
+{
+	PRINT("BENCHMARK %s runs=%u min=%u max=%u mean=%u median=%u "
+	      "p90=%u p99=%u hz=%u\n", name, stats->runs, stats->min,
+	      stats->max, stats->mean, stats->median, stats->p90, stats->p99,
+	      (uint32_t)sys_clock_hw_cycles_per_sec);
+}
+
+void ztest_benchmark_run(const char *name, ztest_benchmark_fn_t fn,
+			 void *data, uint32_t warmup, uint32_t runs,
+			 struct ztest_benchmark_stats *stats)
+{
+	struct ztest_benchmark_stats result;
+	uint32_t overhead, start, cycles, i;
+
+	__ASSERT(runs <= ARRAY_SIZE(samples), "too many runs");
+	runs = min(runs, ARRAY_SIZE(samples));
+
+	while (warmup--) {
+		fn(data);
+	}
+
+	overhead = timing_overhead();
+
+	for (i = 0; i < runs; i++) {
+		start = k_cycle_get_32();
+		fn(data);
+		cycles = k_cycle_get_32() - start;
+
+		samples[i] = cycles > overhead ? cycles - overhead : 0;
+	}
+
+	ztest_benchmark_compute(samples, runs, &result);
+	ztest_benchmark_report(name, &result);
+
+	if (stats) {
+		*stats = result;
+	}
+}
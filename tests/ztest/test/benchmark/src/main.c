@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+static K_SEM_DEFINE(sem, 0, 1);
+
+static void stats_test(void)
+{
+	struct ztest_benchmark_stats stats;
+	uint32_t samples[10] = { 7, 3, 9, 1, 5, 10, 2, 8, 4, 6 };
+
+	ztest_benchmark_compute(samples, ARRAY_SIZE(samples), &stats);
+
+	assert_equal(stats.runs, 10, NULL);
+	assert_equal(stats.min, 1, NULL);
+	assert_equal(stats.max, 10, NULL);
+	assert_equal(stats.mean, 5, NULL);
+	assert_equal(stats.median, 5, NULL);
+	assert_equal(stats.p90, 9, NULL);
+	assert_equal(stats.p99, 10, NULL);
+
+	/* Sorted in place */
+	assert_equal(samples[0], 1, NULL);
+	assert_equal(samples[9], 10, NULL);
+}
+
+static void sem_give_take(void *data)
+{
+	ARG_UNUSED(data);
+
+	k_sem_give(&sem);
+	k_sem_take(&sem, K_NO_WAIT);
+}
+
+static void run_test(void)
+{
+	struct ztest_benchmark_stats stats;
+
+	ztest_benchmark_run("sem_give_take", sem_give_take, NULL, 10, 100,
+			    &stats);
+
+	assert_equal(stats.runs, 100, NULL);
+	assert_true(stats.min <= stats.median, NULL);
+	assert_true(stats.median <= stats.p90, NULL);
+	assert_true(stats.p90 <= stats.p99, NULL);
+	assert_true(stats.p99 <= stats.max, NULL);
+	assert_true(stats.min <= stats.mean && stats.mean <= stats.max, NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(benchmark_tests,
+			 ztest_unit_test(stats_test),
+			 ztest_unit_test(run_test)
+			 );
+
+	ztest_run_test_suite(benchmark_tests);
+}